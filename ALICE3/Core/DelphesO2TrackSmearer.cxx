@@ -34,6 +34,10 @@
 // #include <iostream>
 // #include <fstream>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
 #include "ALICE3/Core/DelphesO2TrackSmearer.h"
 
 namespace o2
@@ -78,26 +82,41 @@ bool TrackSmearer::loadTable(int pdg, const char* filename, bool forceReload)
     mLUTHeader[ipdg] = nullptr;
     return false;
   }
-  const int nnch = mLUTHeader[ipdg]->nchmap.nbins;
-  const int nrad = mLUTHeader[ipdg]->radmap.nbins;
-  const int neta = mLUTHeader[ipdg]->etamap.nbins;
-  const int npt = mLUTHeader[ipdg]->ptmap.nbins;
-  mLUTEntry[ipdg] = new lutEntry_t****[nnch];
-  for (int inch = 0; inch < nnch; ++inch) {
-    mLUTEntry[ipdg][inch] = new lutEntry_t***[nrad];
-    for (int irad = 0; irad < nrad; ++irad) {
-      mLUTEntry[ipdg][inch][irad] = new lutEntry_t**[neta];
-      for (int ieta = 0; ieta < neta; ++ieta) {
-        mLUTEntry[ipdg][inch][irad][ieta] = new lutEntry_t*[npt];
-        for (int ipt = 0; ipt < npt; ++ipt) {
-          mLUTEntry[ipdg][inch][irad][ieta][ipt] = new lutEntry_t;
-          lutFile.read(reinterpret_cast<char*>(mLUTEntry[ipdg][inch][irad][ieta][ipt]), sizeof(lutEntry_t));
-          if (lutFile.gcount() != sizeof(lutEntry_t)) {
-            std::cout << " --- troubles reading covariance matrix entry for PDG " << pdg << ": " << filename << std::endl;
-            return false;
-          }
-        }
-      }
+  const std::size_t nnch = mLUTHeader[ipdg]->nchmap.nbins;
+  const std::size_t nrad = mLUTHeader[ipdg]->radmap.nbins;
+  const std::size_t neta = mLUTHeader[ipdg]->etamap.nbins;
+  const std::size_t npt = mLUTHeader[ipdg]->ptmap.nbins;
+  const std::size_t nEntries = nnch * nrad * neta * npt;
+  const std::size_t tableSize = sizeof(lutHeader_t) + nEntries * sizeof(lutEntry_t);
+  lutFile.seekg(0, std::ifstream::end);
+  if (!lutFile || static_cast<std::size_t>(lutFile.tellg()) < tableSize) {
+    std::cout << " --- troubles reading covariance matrix entry for PDG " << pdg << ": " << filename << std::endl;
+    delete mLUTHeader[ipdg];
+    mLUTHeader[ipdg] = nullptr;
+    return false;
+  }
+  // the entries follow the header in the file, in the nch, rad, eta, pt order of the lookup:
+  // the file is mapped and the pages are only read when they are accessed
+  mLUTEntry[ipdg].reset();
+  void* map = MAP_FAILED;
+  int fd = open(filename, O_RDONLY);
+  if (fd >= 0) {
+    map = mmap(nullptr, tableSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+  }
+  if (map != MAP_FAILED) {
+    std::shared_ptr<char> mapped(static_cast<char*>(map), [tableSize](char* p) { munmap(p, tableSize); });
+    mLUTEntry[ipdg] = std::shared_ptr<lutEntry_t>(mapped, reinterpret_cast<lutEntry_t*>(mapped.get() + sizeof(lutHeader_t)));
+  } else {
+    mLUTEntry[ipdg] = std::shared_ptr<lutEntry_t>(new lutEntry_t[nEntries], std::default_delete<lutEntry_t[]>());
+    lutFile.seekg(sizeof(lutHeader_t), std::ifstream::beg);
+    lutFile.read(reinterpret_cast<char*>(mLUTEntry[ipdg].get()), nEntries * sizeof(lutEntry_t));
+    if (static_cast<std::size_t>(lutFile.gcount()) != nEntries * sizeof(lutEntry_t)) {
+      std::cout << " --- troubles reading covariance matrix entry for PDG " << pdg << ": " << filename << std::endl;
+      mLUTEntry[ipdg].reset();
+      delete mLUTHeader[ipdg];
+      mLUTHeader[ipdg] = nullptr;
+      return false;
     }
   }
   std::cout << " --- read covariance matrix table for PDG " << pdg << ": " << filename << std::endl;
@@ -120,54 +139,58 @@ lutEntry_t*
   auto ieta = mLUTHeader[ipdg]->etamap.find(eta);
   auto ipt = mLUTHeader[ipdg]->ptmap.find(pt);
 
+  auto entry = getEntry(ipdg, inch, irad, ieta, ipt);
+
   // Interpolate if requested
   auto fraction = mLUTHeader[ipdg]->nchmap.fracPositionWithinBin(nch);
   if (mInterpolateEfficiency) {
     if (fraction > 0.5) {
       if (mWhatEfficiency == 1) {
         if (inch < mLUTHeader[ipdg]->nchmap.nbins - 1) {
-          interpolatedEff = (1.5f - fraction) * mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff + (-0.5f + fraction) * mLUTEntry[ipdg][inch + 1][irad][ieta][ipt]->eff;
+          interpolatedEff = (1.5f - fraction) * entry->eff + (-0.5f + fraction) * getEntry(ipdg, inch + 1, irad, ieta, ipt)->eff;
         } else {
-          interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff;
+          interpolatedEff = entry->eff;
         }
       }
       if (mWhatEfficiency == 2) {
         if (inch < mLUTHeader[ipdg]->nchmap.nbins - 1) {
-          interpolatedEff = (1.5f - fraction) * mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2 + (-0.5f + fraction) * mLUTEntry[ipdg][inch + 1][irad][ieta][ipt]->eff2;
+          interpolatedEff = (1.5f - fraction) * entry->eff2 + (-0.5f + fraction) * getEntry(ipdg, inch + 1, irad, ieta, ipt)->eff2;
         } else {
-          interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2;
+          interpolatedEff = entry->eff2;
         }
       }
     } else {
       float comparisonValue = mLUTHeader[ipdg]->nchmap.log ? log10(nch) : nch;
       if (mWhatEfficiency == 1) {
         if (inch > 0 && comparisonValue < mLUTHeader[ipdg]->nchmap.max) {
-          interpolatedEff = (0.5f + fraction) * mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff + (0.5f - fraction) * mLUTEntry[ipdg][inch - 1][irad][ieta][ipt]->eff;
+          interpolatedEff = (0.5f + fraction) * entry->eff + (0.5f - fraction) * getEntry(ipdg, inch - 1, irad, ieta, ipt)->eff;
         } else {
-          interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff;
+          interpolatedEff = entry->eff;
         }
       }
       if (mWhatEfficiency == 2) {
         if (inch > 0 && comparisonValue < mLUTHeader[ipdg]->nchmap.max) {
-          interpolatedEff = (0.5f + fraction) * mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2 + (0.5f - fraction) * mLUTEntry[ipdg][inch - 1][irad][ieta][ipt]->eff2;
+          interpolatedEff = (0.5f + fraction) * entry->eff2 + (0.5f - fraction) * getEntry(ipdg, inch - 1, irad, ieta, ipt)->eff2;
         } else {
-          interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2;
+          interpolatedEff = entry->eff2;
         }
       }
     }
   } else {
     if (mWhatEfficiency == 1)
-      interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff;
+      interpolatedEff = entry->eff;
     if (mWhatEfficiency == 2)
-      interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2;
+      interpolatedEff = entry->eff2;
   }
-  return mLUTEntry[ipdg][inch][irad][ieta][ipt];
+  return entry;
 } //;
 
 /*****************************************************************/
 
-bool TrackSmearer::smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float interpolatedEff)
+bool TrackSmearer::smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float interpolatedEff, TRandom* random)
 {
+  if (!random)
+    random = gRandom;
   // generate efficiency
   if (mUseEfficiency) {
     auto eff = 0.;
@@ -177,7 +200,7 @@ bool TrackSmearer::smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float inte
       eff = lutEntry->eff2;
     if (mInterpolateEfficiency)
       eff = interpolatedEff;
-    if (gRandom->Uniform() > eff)
+    if (random->Uniform() > eff)
       return false;
   }
   // transform params vector and smear
@@ -186,7 +209,7 @@ bool TrackSmearer::smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float inte
     double val = 0.;
     for (int j = 0; j < 5; ++j)
       val += lutEntry->eigvec[j][i] * o2track.getParam(j);
-    params_[i] = gRandom->Gaus(val, sqrt(lutEntry->eigval[i]));
+    params_[i] = random->Gaus(val, sqrt(lutEntry->eigval[i]));
   }
   // transform back params vector
   for (int i = 0; i < 5; ++i) {
@@ -207,7 +230,7 @@ bool TrackSmearer::smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float inte
 
 /*****************************************************************/
 
-bool TrackSmearer::smearTrack(O2Track& o2track, int pdg, float nch)
+bool TrackSmearer::smearTrack(O2Track& o2track, int pdg, float nch, TRandom* random)
 {
 
   auto pt = o2track.getPt();
@@ -219,7 +242,7 @@ bool TrackSmearer::smearTrack(O2Track& o2track, int pdg, float nch)
   auto lutEntry = getLUTEntry(pdg, nch, 0., eta, pt, interpolatedEff);
   if (!lutEntry || !lutEntry->valid)
     return false;
-  return smearTrack(o2track, lutEntry, interpolatedEff);
+  return smearTrack(o2track, lutEntry, interpolatedEff, random);
 }
 
 /*****************************************************************/
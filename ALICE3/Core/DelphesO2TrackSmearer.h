@@ -25,6 +25,7 @@
 #define ALICE3_CORE_DELPHESO2TRACKSMEARER_H_
 
 #include <map>
+#include <memory>
 #include <iostream>
 #include <fstream>
 
@@ -183,8 +184,9 @@ class TrackSmearer
   lutHeader_t* getLUTHeader(int pdg) { return mLUTHeader[getIndexPDG(pdg)]; } //;
   lutEntry_t* getLUTEntry(int pdg, float nch, float radius, float eta, float pt, float& interpolatedEff);
 
-  bool smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float interpolatedEff);
-  bool smearTrack(O2Track& o2track, int pdg, float nch);
+  /// the random numbers are drawn from random, or from gRandom if null, e.g. one generator per thread
+  bool smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float interpolatedEff, TRandom* random = nullptr);
+  bool smearTrack(O2Track& o2track, int pdg, float nch, TRandom* random = nullptr);
   // bool smearTrack(Track& track, bool atDCA = true); // Only in DelphesO2
   double getPtRes(int pdg, float nch, float eta, float pt);
   double getEtaRes(int pdg, float nch, float eta, float pt);
@@ -217,9 +219,19 @@ class TrackSmearer
   void setdNdEta(float val) { mdNdEta = val; } //;
 
  protected:
+  lutEntry_t* getEntry(int ipdg, int inch, int irad, int ieta, int ipt)
+  {
+    const auto* header = mLUTHeader[ipdg];
+    const std::size_t index = ((static_cast<std::size_t>(inch) * header->radmap.nbins + irad) * header->etamap.nbins + ieta) * header->ptmap.nbins + ipt;
+    return mLUTEntry[ipdg].get() + index;
+  }
+
+
   static constexpr unsigned int nLUTs = 8; // Number of LUT available
   lutHeader_t* mLUTHeader[nLUTs] = {nullptr};
-  lutEntry_t***** mLUTEntry[nLUTs] = {nullptr};
+  /// entries of each LUT in a single block, row-major in nch, rad, eta and pt as in the file,
+  /// either mapped from the file or read into one allocation when the file cannot be mapped
+  std::shared_ptr<lutEntry_t> mLUTEntry[nLUTs];
   bool mUseEfficiency = true;
   bool mInterpolateEfficiency = false;
   int mWhatEfficiency = 1;
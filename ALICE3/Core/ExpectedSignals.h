@@ -0,0 +1,173 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   ExpectedSignals.h
+/// \brief  Expected PID signals of a track for a set of mass hypotheses, computed together
+///
+/// The track lengths to several cylindrical layers are computed from a single evaluation of the helix of the
+/// track, and the velocities of all the mass hypotheses are computed in one loop, from which the expected times
+/// of flight to each layer, their resolutions and the expected Cherenkov angles follow. The loops over the
+/// hypotheses have no branches, so that they can be vectorised.
+///
+
+#ifndef ALICE3_CORE_EXPECTEDSIGNALS_H_
+#define ALICE3_CORE_EXPECTEDSIGNALS_H_
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+#include "CommonConstants/PhysicsConstants.h"
+#include "ReconstructionDataFormats/Track.h"
+
+namespace o2::pid::alice3
+{
+
+/// speed of light in cm/ps
+static constexpr float kLightSpeedCmPs = o2::constants::physics::LightSpeedCm2NS / 1e+3;
+
+/// Lengths of the track, from its current point, to the cylindrical layers of the given radii
+/// The circle of the track and its start point are computed once for all the layers.
+/// \param track the input track
+/// \param radii the radii of the layers you're calculating the length to
+/// \param magneticField the magnetic field to use when propagating
+/// \return the lengths, -100 for the layers which are not reached
+template <std::size_t N>
+std::array<float, N> trackLengths(o2::track::TrackParCov const& track, std::array<float, N> const& radii, float magneticField)
+{
+  std::array<float, N> lengths;
+  lengths.fill(-100.f);
+
+  o2::math_utils::CircleXYf_t trcCircle;
+  float sna, csa;
+  track.getCircleParams(magneticField, trcCircle, sna, csa);
+  std::array<float, 3> mom;
+  track.getPxPyPzGlo(mom);
+  std::array<float, 3> startPoint;
+  track.getXYZGlo(startPoint);
+  const float sqrtTgl = std::sqrt(1.0f + track.getTgl() * track.getTgl());
+
+  // distance between circle centers (one circle is at origin -> easy)
+  const float centerDistance = std::hypot(trcCircle.xC, trcCircle.yC);
+  const float startDistance = std::hypot(startPoint[0] - trcCircle.xC, startPoint[1] - trcCircle.yC);
+  // base radical direction, and perpendicular vector (normalized) for +/- displacement
+  const float ux = trcCircle.xC / centerDistance;
+  const float uy = trcCircle.yC / centerDistance;
+  const float vx = -uy;
+  const float vy = +ux;
+
+  for (std::size_t i = 0; i < N; i++) {
+    const float radius = radii[i];
+    // condition of circles touching - if not satisfied returned length will be -100
+    if (!(centerDistance < trcCircle.rC + radius && centerDistance > std::fabs(trcCircle.rC - radius))) {
+      continue;
+    }
+    // calculate coordinate for radical line
+    const float radical = (centerDistance * centerDistance - trcCircle.rC * trcCircle.rC + radius * radius) / (2.0f * centerDistance);
+    // calculate absolute displacement from center-to-center axis
+    const float displace = (0.5f / centerDistance) * std::sqrt(
+                                                       (-centerDistance + trcCircle.rC - radius) *
+                                                       (-centerDistance - trcCircle.rC + radius) *
+                                                       (-centerDistance + trcCircle.rC + radius) *
+                                                       (centerDistance + trcCircle.rC + radius));
+
+    // possible intercept points of track and layer in 2D plane
+    const float point1[2] = {radical * ux + displace * vx, radical * uy + displace * vy};
+    const float point2[2] = {radical * ux - displace * vx, radical * uy - displace * vy};
+
+    // decide on correct intercept point
+    const float scalarProduct1 = point1[0] * mom[0] + point1[1] * mom[1];
+    const float scalarProduct2 = point2[0] * mom[0] + point2[1] * mom[1];
+    const float* point = scalarProduct1 > scalarProduct2 ? point1 : point2;
+
+    const float modulus = std::hypot(point[0] - trcCircle.xC, point[1] - trcCircle.yC) * startDistance;
+    const float cosAngle = ((point[0] - trcCircle.xC) * (startPoint[0] - trcCircle.xC) + (point[1] - trcCircle.yC) * (startPoint[0] - trcCircle.yC)) / modulus;
+    lengths[i] = trcCircle.rC * std::acos(cosAngle) * sqrtTgl;
+  }
+  return lengths;
+}
+
+/// Mass hypotheses for which the expected signals of a track are computed together
+template <std::size_t N>
+class MassHypotheses
+{
+ public:
+  MassHypotheses() = default;
+  explicit MassHypotheses(std::array<float, N> const& masses) { setMasses(masses); }
+
+  void setMasses(std::array<float, N> const& masses)
+  {
+    for (std::size_t i = 0; i < N; i++) {
+      mMasses2[i] = masses[i] * masses[i];
+    }
+  }
+
+  /// \return 1/beta = sqrt(1 + m^2/p^2) of each hypothesis for the momentum p
+  std::array<float, N> inverseBetas(float momentum) const
+  {
+    std::array<float, N> invBetas;
+    const float invP2 = 1.f / (momentum * momentum);
+    for (std::size_t i = 0; i < N; i++) {
+      invBetas[i] = std::sqrt(1.f + mMasses2[i] * invP2);
+    }
+    return invBetas;
+  }
+
+  /// \return expected times of flight, in ps, over the length in cm
+  static std::array<float, N> expectedTimes(std::array<float, N> const& invBetas, float length, float lightSpeed = kLightSpeedCmPs)
+  {
+    std::array<float, N> times;
+    const float lc = length / lightSpeed;
+    for (std::size_t i = 0; i < N; i++) {
+      times[i] = lc * invBetas[i];
+    }
+    return times;
+  }
+
+  /// \return resolutions of the times of flight with the TOFResoALICE3 parametrization: the intrinsic time resolution,
+  /// the event time resolution and the propagation of the momentum resolution, all summed in quadrature
+  std::array<float, N> timeResolutions(float momentum, float momentumError, float evTimeReso, float length, float timeReso) const
+  {
+    std::array<float, N> sigmas;
+    if (momentum <= 0) {
+      sigmas.fill(-999.f);
+      return sigmas;
+    }
+    const float p2 = momentum * momentum;
+    const float lc = length / 0.0299792458f;
+    const float ep = momentumError * momentum;
+    const float constTerm = timeReso * timeReso + evTimeReso * evTimeReso;
+    for (std::size_t i = 0; i < N; i++) {
+      const float etexp = lc * mMasses2[i] / p2 / std::sqrt(mMasses2[i] + p2) * ep;
+      sigmas[i] = std::sqrt(etexp * etexp + constTerm);
+    }
+    return sigmas;
+  }
+
+  /// \return expected cos of the Cherenkov angle in a radiator of refractive index n, 1/(n beta), above 1 below threshold
+  static std::array<float, N> cherenkovCosAngles(std::array<float, N> const& invBetas, float n)
+  {
+    std::array<float, N> cosAngles;
+    const float invN = 1.f / n;
+    for (std::size_t i = 0; i < N; i++) {
+      cosAngles[i] = invBetas[i] * invN;
+    }
+    return cosAngles;
+  }
+
+ private:
+  std::array<float, N> mMasses2{};
+};
+
+} // namespace o2::pid::alice3
+
+#endif // ALICE3_CORE_EXPECTEDSIGNALS_H_
@@ -19,10 +19,12 @@
 
 #include <cmath>
 #include <array>
+#include <algorithm>
 #include <cstdlib>
 #include <map>
 #include <iterator>
 #include <utility>
+#include <vector>
 
 #include "Framework/runDataProcessing.h"
 #include "Framework/RunningWorkflowInfo.h"
@@ -63,6 +65,7 @@ using FullTracksExt = soa::Join<aod::Tracks, aod::TracksCov>;
 using labeledTracks = soa::Join<aod::Tracks, aod::McTrackLabels>;
 using tofTracks = soa::Join<aod::Tracks, aod::UpgradeTofs>;
 using richTracks = soa::Join<aod::Tracks, aod::RICHs>;
+using pidTracks = soa::Join<aod::Tracks, aod::UpgradeTofs, aod::RICHs>;
 using alice3tracks = soa::Join<aod::Tracks, aod::TracksCov, aod::Alice3DecayMaps, aod::McTrackLabels>;
 
 struct alice3decayPreselector {
@@ -161,6 +164,32 @@ struct alice3decayPreselector {
       bitoff(selectionMap[track.globalIndex()], kRICHProton);
   }
   //*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*
+  /// inner TOF, outer TOF and RICH selections of all the species in a single pass over the tracks
+  void processFilterAllPID(pidTracks const& tracks)
+  {
+    for (auto const& track : tracks) {
+      auto& map = selectionMap[track.globalIndex()];
+      if (std::abs(track.nSigmaPionInnerTOF()) > nSigmaTOF)
+        bitoff(map, kInnerTOFPion);
+      if (std::abs(track.nSigmaKaonInnerTOF()) > nSigmaTOF)
+        bitoff(map, kInnerTOFKaon);
+      if (std::abs(track.nSigmaProtonInnerTOF()) > nSigmaTOF)
+        bitoff(map, kInnerTOFProton);
+      if (std::abs(track.nSigmaPionOuterTOF()) > nSigmaTOF)
+        bitoff(map, kOuterTOFPion);
+      if (std::abs(track.nSigmaKaonOuterTOF()) > nSigmaTOF)
+        bitoff(map, kOuterTOFKaon);
+      if (std::abs(track.nSigmaProtonOuterTOF()) > nSigmaTOF)
+        bitoff(map, kOuterTOFProton);
+      if (std::abs(track.richNsigmaPi()) > nSigmaRICH)
+        bitoff(map, kRICHPion);
+      if (std::abs(track.richNsigmaKa()) > nSigmaRICH)
+        bitoff(map, kRICHKaon);
+      if (std::abs(track.richNsigmaPr()) > nSigmaRICH)
+        bitoff(map, kRICHProton);
+    }
+  }
+  //*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*
   void processFilterOnMonteCarloTruth(labeledTracks const& tracks, aod::McParticles const&)
   {
     for (auto const& track : tracks) {
@@ -199,19 +228,19 @@ struct alice3decayPreselector {
   PROCESS_SWITCH(alice3decayPreselector, processFilterInnerTOF, "Switch to use inner TOF PID", false);
   PROCESS_SWITCH(alice3decayPreselector, processFilterOuterTOF, "Switch to use outer TOF PID", false);
   PROCESS_SWITCH(alice3decayPreselector, processFilterRICH, "Switch to use RICH", false);
+  PROCESS_SWITCH(alice3decayPreselector, processFilterAllPID, "Switch to use inner TOF, outer TOF and RICH PID in one pass", false);
   PROCESS_SWITCH(alice3decayPreselector, processFilterOnMonteCarloTruth, "Switch to use MC truth", false);
   PROCESS_SWITCH(alice3decayPreselector, processPublishDecision, "Fill decision mask table (MUST be on)", true);
   //*>-~-<*>-~-<*>-~-<*>-~-<*>-~-<*>-~-<*>-~-<*>-~-<*
 };
 
 struct alice3decayFinder {
-  SliceCache cache;
-
   // Operation and minimisation criteria
   Configurable<float> magneticField{"magneticField", 20.0f, "Magnetic field (in kilogauss)"};
   Configurable<bool> doDCAplots{"doDCAplots", true, "do daughter prong DCA plots"};
   Configurable<bool> mcSameMotherCheck{"mcSameMotherCheck", true, "check if tracks come from the same MC mother"};
   Configurable<float> dcaDaughtersSelection{"dcaDaughtersSelection", 1000.0f, "DCA between daughters (cm)"};
+  Configurable<float> minDmesonPt{"minDmesonPt", 0.0f, "minimum pT of the D meson candidates (GeV/c)"};
 
   ConfigurableAxis axisEta{"axisEta", {8, -4.0f, +4.0f}, "#eta"};
   ConfigurableAxis axisPt{"axisPt", {VARIABLE_WIDTH, 0.0f, 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f, 0.7f, 0.8f, 0.9f, 1.0f, 1.1f, 1.2f, 1.3f, 1.4f, 1.5f, 1.6f, 1.7f, 1.8f, 1.9f, 2.0f, 2.2f, 2.4f, 2.6f, 2.8f, 3.0f, 3.2f, 3.4f, 3.6f, 3.8f, 4.0f, 4.4f, 4.8f, 5.2f, 5.6f, 6.0f, 6.5f, 7.0f, 7.5f, 8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f, 17.0f, 19.0f, 21.0f, 23.0f, 25.0f, 30.0f, 35.0f, 40.0f, 50.0f}, "pt axis for QA histograms"};
@@ -231,17 +260,11 @@ struct alice3decayFinder {
   static constexpr uint32_t trackSelectionKaPlusFromD = 1 << kInnerTOFKaon | 1 << kOuterTOFKaon | 1 << kRICHKaon | 1 << kTrueKaPlusFromD;
   static constexpr uint32_t trackSelectionKaMinusFromD = 1 << kInnerTOFKaon | 1 << kOuterTOFKaon | 1 << kRICHKaon | 1 << kTrueKaMinusFromD;
 
-  Partition<alice3tracks> tracksPiPlusFromD =
-    ((aod::a3DecayMap::decayMap & trackSelectionPiPlusFromD) == trackSelectionPiPlusFromD) && aod::track::signed1Pt > 0.0f;
-
-  Partition<alice3tracks> tracksPiMinusFromD =
-    ((aod::a3DecayMap::decayMap & trackSelectionPiMinusFromD) == trackSelectionPiMinusFromD) && aod::track::signed1Pt < 0.0f;
-
-  Partition<alice3tracks> tracksKaPlusFromD =
-    ((aod::a3DecayMap::decayMap & trackSelectionKaPlusFromD) == trackSelectionKaPlusFromD) && aod::track::signed1Pt > 0.0f;
-
-  Partition<alice3tracks> tracksKaMinusFromD =
-    ((aod::a3DecayMap::decayMap & trackSelectionKaMinusFromD) == trackSelectionKaMinusFromD) && aod::track::signed1Pt < 0.0f;
+  // daughter candidates of the collision for each species and charge, in decreasing pT
+  std::vector<alice3tracks::iterator> tracksPiPlusFromD;
+  std::vector<alice3tracks::iterator> tracksPiMinusFromD;
+  std::vector<alice3tracks::iterator> tracksKaPlusFromD;
+  std::vector<alice3tracks::iterator> tracksKaMinusFromD;
 
   // Helper struct to pass candidate information
   struct {
@@ -350,30 +373,62 @@ struct alice3decayFinder {
     for (auto const& mcParticle : trueDbar)
       histos.fill(HIST("h2dGenDbar"), mcParticle.pt(), mcParticle.eta());
 
-    // group with this collision
-    auto tracksPiPlusFromDgrouped = tracksPiPlusFromD->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
-    auto tracksKaMinusFromDgrouped = tracksKaMinusFromD->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
-    auto tracksKaPlusFromDgrouped = tracksKaPlusFromD->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
-    auto tracksPiMinusFromDgrouped = tracksPiMinusFromD->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
+    // split the tracks of this collision by species and charge in one pass
+    tracksPiPlusFromD.clear();
+    tracksPiMinusFromD.clear();
+    tracksKaPlusFromD.clear();
+    tracksKaMinusFromD.clear();
+    for (auto const& track : tracks) {
+      const auto decayMap = track.decayMap();
+      if (track.signed1Pt() > 0.0f) {
+        if ((decayMap & trackSelectionPiPlusFromD) == trackSelectionPiPlusFromD)
+          tracksPiPlusFromD.push_back(track);
+        if ((decayMap & trackSelectionKaPlusFromD) == trackSelectionKaPlusFromD)
+          tracksKaPlusFromD.push_back(track);
+      } else if (track.signed1Pt() < 0.0f) {
+        if ((decayMap & trackSelectionPiMinusFromD) == trackSelectionPiMinusFromD)
+          tracksPiMinusFromD.push_back(track);
+        if ((decayMap & trackSelectionKaMinusFromD) == trackSelectionKaMinusFromD)
+          tracksKaMinusFromD.push_back(track);
+      }
+    }
+    // the pT of a pair is at most the sum of the pT of its daughters: with the daughters in decreasing pT,
+    // the loop over the negative daughters stops at the first one for which this sum is below minDmesonPt
+    auto decreasingPt = [](auto const& track1, auto const& track2) { return track1.pt() > track2.pt(); };
+    for (auto* daughters : {&tracksPiPlusFromD, &tracksPiMinusFromD, &tracksKaPlusFromD, &tracksKaMinusFromD}) {
+      std::sort(daughters->begin(), daughters->end(), decreasingPt);
+    }
 
     // D mesons
-    for (auto const& posTrackRow : tracksPiPlusFromDgrouped) {
-      for (auto const& negTrackRow : tracksKaMinusFromDgrouped) {
+    for (auto const& posTrackRow : tracksPiPlusFromD) {
+      if (!tracksKaMinusFromD.empty() && posTrackRow.pt() + tracksKaMinusFromD.front().pt() < minDmesonPt)
+        break;
+      for (auto const& negTrackRow : tracksKaMinusFromD) {
+        if (posTrackRow.pt() + negTrackRow.pt() < minDmesonPt)
+          break;
         if (mcSameMotherCheck && !checkSameMother(posTrackRow, negTrackRow))
           continue;
         if (!buildDecayCandidate(posTrackRow, negTrackRow, o2::constants::physics::MassPionCharged, o2::constants::physics::MassKaonCharged))
           continue;
+        if (dmeson.pt < minDmesonPt)
+          continue;
         histos.fill(HIST("hMassD"), dmeson.mass);
         histos.fill(HIST("h3dRecD"), dmeson.pt, dmeson.eta, dmeson.mass);
       }
     }
     // D mesons
-    for (auto const& posTrackRow : tracksKaPlusFromDgrouped) {
-      for (auto const& negTrackRow : tracksPiMinusFromDgrouped) {
+    for (auto const& posTrackRow : tracksKaPlusFromD) {
+      if (!tracksPiMinusFromD.empty() && posTrackRow.pt() + tracksPiMinusFromD.front().pt() < minDmesonPt)
+        break;
+      for (auto const& negTrackRow : tracksPiMinusFromD) {
+        if (posTrackRow.pt() + negTrackRow.pt() < minDmesonPt)
+          break;
         if (mcSameMotherCheck && !checkSameMother(posTrackRow, negTrackRow))
           continue;
         if (!buildDecayCandidate(posTrackRow, negTrackRow, o2::constants::physics::MassKaonCharged, o2::constants::physics::MassPionCharged))
           continue;
+        if (dmeson.pt < minDmesonPt)
+          continue;
         histos.fill(HIST("hMassDbar"), dmeson.mass);
         histos.fill(HIST("h3dRecDbar"), dmeson.pt, dmeson.eta, dmeson.mass);
       }
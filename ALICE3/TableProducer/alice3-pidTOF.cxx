@@ -23,6 +23,7 @@
 #include "CCDB/BasicCCDBManager.h"
 #include "Common/DataModel/PIDResponse.h"
 #include "ALICE3/Core/TOFResoALICE3.h"
+#include "ALICE3/Core/ExpectedSignals.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "Framework/RunningWorkflowInfo.h"
 #include "Framework/StaticFor.h"
@@ -91,8 +92,17 @@ struct ALICE3pidTOFTask {
   Configurable<std::string> url{"ccdb-url", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
   Configurable<int64_t> timestamp{"ccdb-timestamp", -1, "timestamp of the object"};
 
+  // all the species of the tables, from the electron to the alpha
+  static constexpr int nSpecies = PID::Alpha + 1;
+  o2::pid::alice3::MassHypotheses<nSpecies> hypotheses;
+
   void init(o2::framework::InitContext&)
   {
+    std::array<float, nSpecies> masses;
+    for (int id = 0; id < nSpecies; id++) {
+      masses[id] = o2::track::pid_constants::sMasses2Z[id];
+    }
+    hypotheses.setMasses(masses);
     ccdb->setURL(url.value);
     ccdb->setTimestamp(timestamp.value);
     ccdb->setCaching(true);
@@ -112,21 +122,6 @@ struct ALICE3pidTOFTask {
     }
   }
 
-  template <o2::track::PID::ID id>
-  float sigma(Trks::iterator track)
-  {
-    return o2::pid::tof::TOFResoALICE3ParamTrack<id>(track, resoParameters);
-  }
-  template <o2::track::PID::ID id>
-  float nsigma(Trks::iterator track)
-  {
-    if (!track.hasTOF()) {
-      return -999.f;
-    }
-    return ((track.trackTime() - track.collision().collisionTime()) * 1000.f - o2::pid::tof::ExpTimes<Trks::iterator, id>::ComputeExpectedTime(track.tofExpMom() / o2::pid::tof::kCSPEED,
-                                                                                                                                               track.length())) /
-           sigma<id>(track);
-  }
   void process(Trks const& tracks, Coll const&)
   {
     tablePIDEl.reserve(tracks.size());
@@ -139,15 +134,30 @@ struct ALICE3pidTOFTask {
     tablePIDHe.reserve(tracks.size());
     tablePIDAl.reserve(tracks.size());
     for (auto const& trk : tracks) {
-      tablePIDEl(sigma<PID::Electron>(trk), nsigma<PID::Electron>(trk));
-      tablePIDMu(sigma<PID::Muon>(trk), nsigma<PID::Muon>(trk));
-      tablePIDPi(sigma<PID::Pion>(trk), nsigma<PID::Pion>(trk));
-      tablePIDKa(sigma<PID::Kaon>(trk), nsigma<PID::Kaon>(trk));
-      tablePIDPr(sigma<PID::Proton>(trk), nsigma<PID::Proton>(trk));
-      tablePIDDe(sigma<PID::Deuteron>(trk), nsigma<PID::Deuteron>(trk));
-      tablePIDTr(sigma<PID::Triton>(trk), nsigma<PID::Triton>(trk));
-      tablePIDHe(sigma<PID::Helium3>(trk), nsigma<PID::Helium3>(trk));
-      tablePIDAl(sigma<PID::Alpha>(trk), nsigma<PID::Alpha>(trk));
+      // the momentum resolution and the collision are the same for all the species,
+      // and the expected times and resolutions of all of them are computed together
+      const float BETA = tan(0.25f * static_cast<float>(M_PI) - 0.5f * atan(trk.tgl()));
+      const float sigmaP = sqrt(trk.pt() * trk.pt() * trk.sigma1Pt() * trk.sigma1Pt() + (BETA * BETA - 1.f) / (BETA * (BETA * BETA + 1.f)) * (trk.tgl() / sqrt(trk.tgl() * trk.tgl() + 1.f) - 1.f) * trk.sigmaTgl() * trk.sigmaTgl());
+      const auto collision = trk.collision();
+      const auto sigmas = hypotheses.timeResolutions(trk.p(), sigmaP, collision.collisionTimeRes() * 1000.f, trk.length(), resoParameters[0]);
+      std::array<float, nSpecies> nsigmas;
+      nsigmas.fill(-999.f);
+      if (trk.hasTOF()) {
+        const float deltaTime = (trk.trackTime() - collision.collisionTime()) * 1000.f;
+        const auto expTimes = hypotheses.expectedTimes(hypotheses.inverseBetas(trk.tofExpMom() / o2::pid::tof::kCSPEED), trk.length(), o2::pid::tof::kCSPEED);
+        for (int id = 0; id < nSpecies; id++) {
+          nsigmas[id] = (deltaTime - expTimes[id]) / sigmas[id];
+        }
+      }
+      tablePIDEl(sigmas[PID::Electron], nsigmas[PID::Electron]);
+      tablePIDMu(sigmas[PID::Muon], nsigmas[PID::Muon]);
+      tablePIDPi(sigmas[PID::Pion], nsigmas[PID::Pion]);
+      tablePIDKa(sigmas[PID::Kaon], nsigmas[PID::Kaon]);
+      tablePIDPr(sigmas[PID::Proton], nsigmas[PID::Proton]);
+      tablePIDDe(sigmas[PID::Deuteron], nsigmas[PID::Deuteron]);
+      tablePIDTr(sigmas[PID::Triton], nsigmas[PID::Triton]);
+      tablePIDHe(sigmas[PID::Helium3], nsigmas[PID::Helium3]);
+      tablePIDAl(sigmas[PID::Alpha], nsigmas[PID::Alpha]);
     }
   }
 };
@@ -34,6 +34,7 @@
 #include "CommonConstants/PhysicsConstants.h"
 #include "TRandom3.h"
 #include "ALICE3/DataModel/OTFTOF.h"
+#include "ALICE3/Core/ExpectedSignals.h"
 #include "DetectorsVertexing/HelixHelper.h"
 
 /// \file onTheFlyTOFPID.cxx
@@ -82,10 +83,23 @@ struct OnTheFlyTOFPID {
   // for handling basic QA histograms if requested
   HistogramRegistry histos{"Histos", {}, OutputObjHandlingPolicy::AnalysisObject};
 
+  // mass hypotheses of the NSigmas, and radii of the inner and outer TOF layers
+  static constexpr int nHypotheses = 5;
+  static constexpr int hypothesisPdgs[nHypotheses] = {kElectron, kMuonMinus, kPiPlus, kKPlus, kProton};
+  o2::pid::alice3::MassHypotheses<nHypotheses> hypotheses;
+  std::array<float, 2> tofRadii;
+
   void init(o2::framework::InitContext& initContext)
   {
     pRandomNumberGenerator.SetSeed(0); // fully randomize
 
+    std::array<float, nHypotheses> masses;
+    for (int ii = 0; ii < nHypotheses; ii++) {
+      masses[ii] = pdg->GetParticle(hypothesisPdgs[ii])->Mass();
+    }
+    hypotheses.setMasses(masses);
+    tofRadii = {innerTOFRadius, outerTOFRadius};
+
     if (doQAplots) {
       const AxisSpec axisMomentum{static_cast<int>(nBinsP), 0.0f, +4.0f, "#it{p} (GeV/#it{c})"};
       const AxisSpec axisMomentumSmall{static_cast<int>(nBinsP), 0.0f, +1.0f, "#it{p} (GeV/#it{c})"};
@@ -134,81 +148,6 @@ struct OnTheFlyTOFPID {
     new (&o2track)(o2::track::TrackParCov)(x, particle.phi(), params, covm);
   }
 
-  /// function to calculate track length of this track up to a certain radius
-  /// \param track the input track
-  /// \param radius the radius of the layer you're calculating the length to
-  /// \param magneticField the magnetic field to use when propagating
-  float trackLength(o2::track::TrackParCov track, float radius, float magneticField)
-  {
-    // don't make use of the track parametrization
-    float length = -100;
-
-    o2::math_utils::CircleXYf_t trcCircle;
-    float sna, csa;
-    track.getCircleParams(magneticField, trcCircle, sna, csa);
-
-    // distance between circle centers (one circle is at origin -> easy)
-    float centerDistance = std::hypot(trcCircle.xC, trcCircle.yC);
-
-    // condition of circles touching - if not satisfied returned length will be -100
-    if (centerDistance < trcCircle.rC + radius && centerDistance > fabs(trcCircle.rC - radius)) {
-      length = 0.0f;
-
-      // base radical direction
-      float ux = trcCircle.xC / centerDistance;
-      float uy = trcCircle.yC / centerDistance;
-      // calculate perpendicular vector (normalized) for +/- displacement
-      float vx = -uy;
-      float vy = +ux;
-      // calculate coordinate for radical line
-      float radical = (centerDistance * centerDistance - trcCircle.rC * trcCircle.rC + radius * radius) / (2.0f * centerDistance);
-      // calculate absolute displacement from center-to-center axis
-      float displace = (0.5f / centerDistance) * TMath::Sqrt(
-                                                   (-centerDistance + trcCircle.rC - radius) *
-                                                   (-centerDistance - trcCircle.rC + radius) *
-                                                   (-centerDistance + trcCircle.rC + radius) *
-                                                   (centerDistance + trcCircle.rC + radius));
-
-      // possible intercept points of track and TOF layer in 2D plane
-      float point1[2] = {radical * ux + displace * vx, radical * uy + displace * vy};
-      float point2[2] = {radical * ux - displace * vx, radical * uy - displace * vy};
-
-      // decide on correct intercept point
-      std::array<float, 3> mom;
-      track.getPxPyPzGlo(mom);
-      float scalarProduct1 = point1[0] * mom[0] + point1[1] * mom[1];
-      float scalarProduct2 = point2[0] * mom[0] + point2[1] * mom[1];
-
-      // get start point
-      std::array<float, 3> startPoint;
-      track.getXYZGlo(startPoint);
-
-      float cosAngle = -1000, modulus = -1000;
-
-      if (scalarProduct1 > scalarProduct2) {
-        modulus = std::hypot(point1[0] - trcCircle.xC, point1[1] - trcCircle.yC) * std::hypot(startPoint[0] - trcCircle.xC, startPoint[1] - trcCircle.yC);
-        cosAngle = (point1[0] - trcCircle.xC) * (startPoint[0] - trcCircle.xC) + (point1[1] - trcCircle.yC) * (startPoint[0] - trcCircle.yC);
-      } else {
-        modulus = std::hypot(point2[0] - trcCircle.xC, point2[1] - trcCircle.yC) * std::hypot(startPoint[0] - trcCircle.xC, startPoint[1] - trcCircle.yC);
-        cosAngle = (point2[0] - trcCircle.xC) * (startPoint[0] - trcCircle.xC) + (point2[1] - trcCircle.yC) * (startPoint[0] - trcCircle.yC);
-      }
-      cosAngle /= modulus;
-      length = trcCircle.rC * TMath::ACos(cosAngle);
-      length *= sqrt(1.0f + track.getTgl() * track.getTgl());
-    }
-    return length;
-  }
-
-  /// returns velocity in centimeters per picoseconds
-  /// \param momentum the momentum of the tarck
-  /// \param mass the mass of the particle
-  float velocity(float momentum, float mass)
-  {
-    float a = std::pow(momentum / mass, 2);
-    // uses light speed in cm/ps so output is in those units
-    return (o2::constants::physics::LightSpeedCm2NS / 1e+3) * std::sqrt(a / (1 + a));
-  }
-
   void process(soa::Join<aod::Collisions, aod::McCollisionLabels>::iterator const& collision, soa::Join<aod::Tracks, aod::TracksCov, aod::McTrackLabels> const& tracks, aod::McParticles const&, aod::McCollisions const&)
   {
     o2::dataformats::VertexBase pvVtx({collision.posX(), collision.posY(), collision.posZ()},
@@ -233,12 +172,14 @@ struct OnTheFlyTOFPID {
       auto mcParticle = track.mcParticle();
       convertMCParticleToO2Track(mcParticle, o2track);
 
+      // lengths to both layers from a single evaluation of the helix
       float xPv = -100, trackLengthInnerTOF = -1, trackLengthOuterTOF = -1;
       if (o2track.propagateToDCA(mcPvVtx, dBz))
         xPv = o2track.getX();
       if (xPv > -99.) {
-        trackLengthInnerTOF = trackLength(o2track, innerTOFRadius, dBz);
-        trackLengthOuterTOF = trackLength(o2track, outerTOFRadius, dBz);
+        const auto lengths = o2::pid::alice3::trackLengths(o2track, tofRadii, dBz);
+        trackLengthInnerTOF = lengths[0];
+        trackLengthOuterTOF = lengths[1];
       }
 
       // get mass to calculate velocity
@@ -246,8 +187,10 @@ struct OnTheFlyTOFPID {
       if (pdgInfo == nullptr) {
         continue;
       }
-      float expectedTimeInnerTOF = trackLengthInnerTOF / velocity(o2track.getP(), pdgInfo->Mass());
-      float expectedTimeOuterTOF = trackLengthOuterTOF / velocity(o2track.getP(), pdgInfo->Mass());
+      const float massOverP = pdgInfo->Mass() / o2track.getP();
+      const float inverseBeta = std::sqrt(1.f + massOverP * massOverP);
+      float expectedTimeInnerTOF = trackLengthInnerTOF * inverseBeta / o2::pid::alice3::kLightSpeedCmPs;
+      float expectedTimeOuterTOF = trackLengthOuterTOF * inverseBeta / o2::pid::alice3::kLightSpeedCmPs;
 
       // Smear with expected resolutions
       float measuredTimeInnerTOF = pRandomNumberGenerator.Gaus(expectedTimeInnerTOF, innerTOFTimeReso);
@@ -260,15 +203,17 @@ struct OnTheFlyTOFPID {
       if (recoTrack.propagateToDCA(pvVtx, dBz))
         xPv = recoTrack.getX();
       if (xPv > -99.) {
-        trackLengthRecoInnerTOF = trackLength(recoTrack, innerTOFRadius, dBz);
-        trackLengthRecoOuterTOF = trackLength(recoTrack, outerTOFRadius, dBz);
+        const auto lengths = o2::pid::alice3::trackLengths(recoTrack, tofRadii, dBz);
+        trackLengthRecoInnerTOF = lengths[0];
+        trackLengthRecoOuterTOF = lengths[1];
       }
 
-      // Straight to Nsigma
-      float deltaTimeInnerTOF[5], nSigmaInnerTOF[5];
-      float deltaTimeOuterTOF[5], nSigmaOuterTOF[5];
-      int lpdg_array[5] = {kElectron, kMuonMinus, kPiPlus, kKPlus, kProton};
-      float masses[5];
+      // Straight to Nsigma, with the velocities of all the hypotheses computed once for both layers
+      float deltaTimeInnerTOF[nHypotheses], nSigmaInnerTOF[nHypotheses];
+      float deltaTimeOuterTOF[nHypotheses], nSigmaOuterTOF[nHypotheses];
+      const auto inverseBetas = hypotheses.inverseBetas(recoTrack.getP());
+      const auto expectedTimesInnerTOF = hypotheses.expectedTimes(inverseBetas, trackLengthRecoInnerTOF);
+      const auto expectedTimesOuterTOF = hypotheses.expectedTimes(inverseBetas, trackLengthRecoOuterTOF);
 
       if (doQAplots) {
         float momentum = recoTrack.getP();
@@ -287,14 +232,12 @@ struct OnTheFlyTOFPID {
         }
       }
 
-      for (int ii = 0; ii < 5; ii++) {
+      for (int ii = 0; ii < nHypotheses; ii++) {
         nSigmaInnerTOF[ii] = -100;
         nSigmaOuterTOF[ii] = -100;
 
-        auto pdgInfoThis = pdg->GetParticle(lpdg_array[ii]);
-        masses[ii] = pdgInfoThis->Mass();
-        deltaTimeInnerTOF[ii] = trackLengthRecoInnerTOF / velocity(recoTrack.getP(), masses[ii]) - measuredTimeInnerTOF;
-        deltaTimeOuterTOF[ii] = trackLengthRecoOuterTOF / velocity(recoTrack.getP(), masses[ii]) - measuredTimeOuterTOF;
+        deltaTimeInnerTOF[ii] = expectedTimesInnerTOF[ii] - measuredTimeInnerTOF;
+        deltaTimeOuterTOF[ii] = expectedTimesOuterTOF[ii] - measuredTimeOuterTOF;
 
         // Fixme: assumes dominant resolution effect is the TOF resolution
         // and not the tracking itself. It's *probably* a fair assumption
@@ -23,9 +23,15 @@
 /// \author Roberto Preghenella preghenella@bo.infn.it
 ///
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include <TGeoGlobalMagField.h>
+#include <TRandom3.h>
 
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/AnalysisTask.h"
@@ -88,6 +94,11 @@ struct OnTheFlyTracker {
 
   Configurable<bool> doExtraQA{"doExtraQA", false, "do extra 2D QA plots"};
 
+  // batched mode: the particles of a collision are smeared in chunks by a pool of threads
+  Configurable<int> smearingThreads{"smearingThreads", 1, "number of threads smearing the particles of a collision, batched mode if more than 1"};
+  Configurable<int> smearingChunkSize{"smearingChunkSize", 256, "number of particles of a chunk in the batched mode"};
+  Configurable<int> smearingSeed{"smearingSeed", 1, "seed of the random streams of the chunks in the batched mode"};
+
   Configurable<std::string> lutEl{"lutEl", "lutCovm.el.dat", "LUT for electrons"};
   Configurable<std::string> lutMu{"lutMu", "lutCovm.mu.dat", "LUT for muons"};
   Configurable<std::string> lutPi{"lutPi", "lutCovm.pi.dat", "LUT for pions"};
@@ -138,6 +149,15 @@ struct OnTheFlyTracker {
   o2::steer::InteractionSampler irSampler;
   o2::vertexing::PVertexer vertexer;
 
+  // particles of the collision to be smeared in the batched mode, and the output of the smearing,
+  // and DCAs of the reconstructed tracks to the primary vertex, with the pT and X at the DCA for the QA
+  std::vector<o2::track::TrackParCov> batchTracks;
+  std::vector<int> batchPdgs;
+  std::vector<float> batchPts;
+  std::vector<int64_t> batchLabels;
+  std::vector<uint8_t> batchSmeared;
+  std::vector<std::array<float, 4>> tracksDCAs;
+
   void init(o2::framework::InitContext& initContext)
   {
     if (enableLUT) {
@@ -262,11 +282,63 @@ struct OnTheFlyTracker {
     new (&o2track)(o2::track::TrackParCov)(x, particle.phi(), params, covm);
   }
 
+  /// Calls work(first, last, chunk) for the chunks of [0, n), taken in order by the first free thread
+  template <typename TWork>
+  void runInChunks(size_t n, TWork work)
+  {
+    const size_t chunk = std::max(smearingChunkSize.value, 1);
+    const size_t nChunks = (n + chunk - 1) / chunk;
+    std::atomic<size_t> nextChunk{0};
+    auto chunkWorker = [&]() {
+      for (size_t iChunk = nextChunk++; iChunk < nChunks; iChunk = nextChunk++) {
+        work(iChunk * chunk, std::min(n, (iChunk + 1) * chunk), iChunk);
+      }
+    };
+    const size_t nWorkers = std::min(static_cast<size_t>(std::max(smearingThreads.value, 1)), nChunks);
+    std::vector<std::thread> workers;
+    for (size_t iWorker = 1; iWorker < nWorkers; iWorker++) {
+      workers.emplace_back(chunkWorker);
+    }
+    chunkWorker();
+    for (auto& thread : workers) {
+      thread.join();
+    }
+  }
+
+  /// Seed of the random stream of a chunk, depending only on the configured seed, the collision and the chunk,
+  /// so that the smearing does not depend on the number of threads nor on which thread takes the chunk
+  UInt_t chunkSeed(int64_t collision, size_t chunk)
+  {
+    uint64_t x = (static_cast<uint64_t>(smearingSeed.value) << 48) ^ (static_cast<uint64_t>(collision) << 20) ^ chunk;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return static_cast<UInt_t>(x) | 1u; // TRandom3 seeds 0 from the clock
+  }
+
+  /// Smears the gathered particles of the collision, with one random stream per chunk
+  void smearBatch(int64_t collision)
+  {
+    batchSmeared.assign(batchTracks.size(), 0);
+    runInChunks(batchTracks.size(), [&](size_t first, size_t last, size_t chunk) {
+      TRandom3 random(chunkSeed(collision, chunk));
+      for (size_t i = first; i < last; i++) {
+        // capture rare smearing mistakes / corrupted tracks
+        batchSmeared[i] = mSmearer.smearTrack(batchTracks[i], batchPdgs[i], dNdEta, &random) && !TMath::IsNaN(batchTracks[i].getZ());
+      }
+    });
+  }
+
   float dNdEta = 0.f; // Charged particle multiplicity to use in the efficiency evaluation
   void process(aod::McCollision const& mcCollision, aod::McParticles const& mcParticles)
   {
     tracksAlice3.clear();
     bcData.clear();
+    batchTracks.clear();
+    batchPdgs.clear();
+    batchPts.clear();
+    batchLabels.clear();
+    const bool batched = smearingThreads > 1;
 
     o2::dataformats::DCA dcaInfo;
     o2::dataformats::VertexBase vtx;
@@ -302,6 +374,27 @@ struct OnTheFlyTracker {
     uint32_t multiplicityCounter = 0;
     histos.fill(HIST("hLUTMultiplicity"), dNdEta);
 
+    auto addReconstructedTrack = [&](o2::track::TrackParCov const& trackParCov, int pdgCode, float generatedPt, int64_t mcLabel) {
+      // Base QA (note: reco pT here)
+      histos.fill(HIST("hPtReconstructed"), trackParCov.getPt());
+      if (TMath::Abs(pdgCode) == 11)
+        histos.fill(HIST("hPtReconstructedEl"), generatedPt);
+      if (TMath::Abs(pdgCode) == 211)
+        histos.fill(HIST("hPtReconstructedPi"), generatedPt);
+      if (TMath::Abs(pdgCode) == 321)
+        histos.fill(HIST("hPtReconstructedKa"), generatedPt);
+      if (TMath::Abs(pdgCode) == 2212)
+        histos.fill(HIST("hPtReconstructedPr"), generatedPt);
+
+      if (doExtraQA) {
+        histos.fill(HIST("hRecoTrackX"), trackParCov.getX());
+      }
+
+      // populate vector with track if we reco-ed it
+      const float t = (ir.bc2ns() + gRandom->Gaus(0., 100.)) * 1e-3;
+      tracksAlice3.push_back(TrackAlice3{trackParCov, mcLabel, t, 100.f * 1e-3});
+    };
+
     for (const auto& mcParticle : mcParticles) {
       if (!mcParticle.isPhysicalPrimary()) {
         continue;
@@ -335,6 +428,13 @@ struct OnTheFlyTracker {
         histos.fill(HIST("hSimTrackX"), trackParCov.getX());
       }
 
+      if (batched) {
+        batchTracks.push_back(trackParCov);
+        batchPdgs.push_back(mcParticle.pdgCode());
+        batchPts.push_back(mcParticle.pt());
+        batchLabels.push_back(mcParticle.globalIndex());
+        continue;
+      }
       if (!mSmearer.smearTrack(trackParCov, mcParticle.pdgCode(), dNdEta)) {
         continue;
       }
@@ -342,25 +442,16 @@ struct OnTheFlyTracker {
         // capture rare smearing mistakes / corrupted tracks
         continue;
       }
+      addReconstructedTrack(trackParCov, mcParticle.pdgCode(), mcParticle.pt(), mcParticle.globalIndex());
+    }
 
-      // Base QA (note: reco pT here)
-      histos.fill(HIST("hPtReconstructed"), trackParCov.getPt());
-      if (TMath::Abs(mcParticle.pdgCode()) == 11)
-        histos.fill(HIST("hPtReconstructedEl"), mcParticle.pt());
-      if (TMath::Abs(mcParticle.pdgCode()) == 211)
-        histos.fill(HIST("hPtReconstructedPi"), mcParticle.pt());
-      if (TMath::Abs(mcParticle.pdgCode()) == 321)
-        histos.fill(HIST("hPtReconstructedKa"), mcParticle.pt());
-      if (TMath::Abs(mcParticle.pdgCode()) == 2212)
-        histos.fill(HIST("hPtReconstructedPr"), mcParticle.pt());
-
-      if (doExtraQA) {
-        histos.fill(HIST("hRecoTrackX"), trackParCov.getX());
+    if (batched) {
+      smearBatch(mcCollision.globalIndex());
+      for (size_t i = 0; i < batchTracks.size(); i++) {
+        if (batchSmeared[i]) {
+          addReconstructedTrack(batchTracks[i], batchPdgs[i], batchPts[i], batchLabels[i]);
+        }
       }
-
-      // populate vector with track if we reco-ed it
-      const float t = (ir.bc2ns() + gRandom->Gaus(0., 100.)) * 1e-3;
-      tracksAlice3.push_back(TrackAlice3{trackParCov, mcParticle.globalIndex(), t, 100.f * 1e-3});
     }
 
     // *+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*
@@ -436,11 +527,45 @@ struct OnTheFlyTracker {
 
     // *+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*+~+*
     // populate tracks
-    for (const auto& trackParCov : tracksAlice3) {
+    // in the batched mode the DCAs are propagated in the threads, and the rows are then written in the track order
+    const bool batchedDCA = batched && populateTracksDCA;
+    if (batchedDCA) {
+      tracksDCAs.resize(tracksAlice3.size());
+      runInChunks(tracksAlice3.size(), [&](size_t first, size_t last, size_t) {
+        o2::dataformats::DCA chunkDCAInfo;
+        for (size_t i = first; i < last; i++) {
+          float dcaXY = 1e+10, dcaZ = 1e+10;
+          o2::track::TrackParCov trackParametrization(tracksAlice3[i]);
+          if (trackParametrization.propagateToDCA(primaryVertex, magneticField, &chunkDCAInfo)) {
+            dcaXY = chunkDCAInfo.getY();
+            dcaZ = chunkDCAInfo.getZ();
+          }
+          tracksDCAs[i] = {dcaXY, dcaZ, trackParametrization.getPt(), trackParametrization.getX()};
+        }
+      });
+    }
+    const auto nTracks = tracksAlice3.size();
+    tracksPar.reserve(nTracks);
+    tracksParExtension.reserve(nTracks);
+    tracksParCov.reserve(nTracks);
+    tracksParCovExtension.reserve(nTracks);
+    tracksLabels.reserve(nTracks);
+    if (populateTracksDCA) {
+      tracksDCA.reserve(nTracks);
+    }
+    for (size_t iTrack = 0; iTrack < nTracks; iTrack++) {
+      const auto& trackParCov = tracksAlice3[iTrack];
       // Fixme: collision index could be changeable
       aod::track::TrackTypeEnum trackType = aod::track::Track;
 
-      if (populateTracksDCA) {
+      if (batchedDCA) {
+        const auto& [dcaXY, dcaZ, ptAtDCA, xAtDCA] = tracksDCAs[iTrack];
+        if (doExtraQA) {
+          histos.fill(HIST("h2dDCAxy"), ptAtDCA, dcaXY * 1e+4); // in microns, please
+          histos.fill(HIST("hTrackXatDCA"), xAtDCA);
+        }
+        tracksDCA(dcaXY, dcaZ);
+      } else if (populateTracksDCA) {
         float dcaXY = 1e+10, dcaZ = 1e+10;
         o2::track::TrackParCov trackParametrization(trackParCov);
         if (trackParametrization.propagateToDCA(primaryVertex, magneticField, &dcaInfo)) {
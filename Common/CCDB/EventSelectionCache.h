@@ -0,0 +1,123 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef COMMON_CCDB_EVENTSELECTIONCACHE_H_
+#define COMMON_CCDB_EVENTSELECTIONCACHE_H_
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "Common/CCDB/EventSelectionParams.h"
+#include "Common/CCDB/TriggerAliases.h"
+#include "Framework/Logger.h"
+
+/// Trigger aliases converted into lookup tables indexed by the bytes of the trigger-class masks.
+/// Each entry holds the bits of the aliases fired by the classes of that byte, so the aliases of
+/// a bc are the OR of one lookup per byte instead of a loop over the alias map.
+class TriggerAliasMasks
+{
+ public:
+  TriggerAliasMasks() = default;
+  explicit TriggerAliasMasks(const TriggerAliases& aliases) { set(aliases); }
+
+  void set(const TriggerAliases& aliases)
+  {
+    fill(mLUT, aliases.GetAliasToTriggerMaskMap());
+    fill(mLUTNext50, aliases.GetAliasToTriggerMaskNext50Map());
+  }
+
+  /// Fired aliases for the given trigger-class masks
+  /// \param triggerMask mask of the first 50 trigger classes
+  /// \param triggerMaskNext50 mask of the next 50 trigger classes (Run 2 only)
+  uint32_t getAliases(uint64_t triggerMask, uint64_t triggerMaskNext50 = 0) const
+  {
+    uint32_t alias = 0;
+    for (int iByte = 0; iByte < kNbytes; iByte++) {
+      alias |= mLUT[iByte][(triggerMask >> (8 * iByte)) & 0xff];
+      alias |= mLUTNext50[iByte][(triggerMaskNext50 >> (8 * iByte)) & 0xff];
+    }
+    return alias;
+  }
+
+ private:
+  static constexpr int kNbytes = 8;
+  using LUT = std::array<std::array<uint32_t, 256>, kNbytes>;
+
+  static void fill(LUT& lut, const std::map<uint32_t, ULong64_t>& aliasToMask)
+  {
+    for (auto& byteLUT : lut) {
+      byteLUT.fill(0);
+    }
+    for (const auto& [aliasId, mask] : aliasToMask) {
+      for (int iByte = 0; iByte < kNbytes; iByte++) {
+        const uint64_t byteMask = (mask >> (8 * iByte)) & 0xff;
+        for (uint64_t value = 0; value < 256; value++) {
+          if (value & byteMask) {
+            lut[iByte][value] |= 1u << aliasId;
+          }
+        }
+      }
+    }
+  }
+
+  LUT mLUT{};
+  LUT mLUTNext50{};
+};
+
+/// Event selection parameters and trigger-alias masks of one run
+struct EventSelectionRunInfo {
+  EventSelectionParams params;
+  TriggerAliasMasks aliasMasks;
+};
+
+/// Process-wide read-through cache of the event selection CCDB objects: each run is
+/// fetched and converted once, and then shared by all the tasks running in the process.
+class EventSelectionCache
+{
+ public:
+  static EventSelectionCache& instance()
+  {
+    static EventSelectionCache cache;
+    return cache;
+  }
+
+  /// Returns the objects for the run, fetching them with the given CCDB manager the first time the run is requested
+  /// \param ccdb CCDB manager, a pointer-like object to o2::ccdb::BasicCCDBManager
+  /// \param runNumber run number, the key of the cache
+  /// \param timestamp timestamp used for the CCDB query
+  template <typename TCCDB>
+  EventSelectionRunInfo& get(TCCDB& ccdb, int runNumber, uint64_t timestamp)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto& info = mRuns[runNumber];
+    if (!info) {
+      EventSelectionParams* par = ccdb->template getForTimeStamp<EventSelectionParams>("EventSelection/EventSelectionParams", timestamp);
+      TriggerAliases* aliases = ccdb->template getForTimeStamp<TriggerAliases>("EventSelection/TriggerAliases", timestamp);
+      if (par == nullptr || aliases == nullptr) {
+        LOGF(fatal, "Event selection parameters or trigger aliases not available for run %d at timestamp %llu", runNumber, timestamp);
+      }
+      info = std::make_unique<EventSelectionRunInfo>();
+      info->params = *par;
+      info->aliasMasks.set(*aliases);
+    }
+    return *info;
+  }
+
+ private:
+  EventSelectionCache() = default;
+
+  std::mutex mMutex;
+  std::map<int, std::unique_ptr<EventSelectionRunInfo>> mRuns;
+};
+
+#endif // COMMON_CCDB_EVENTSELECTIONCACHE_H_
@@ -0,0 +1,88 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file AsyncPrefetcher.h
+/// \brief Cache of values, e.g. CCDB objects of a run, fetched in background threads
+///
+/// The values are requested with prefetch() as soon as their key, e.g. a run number, is known, and are fetched
+/// concurrently while the task goes on. get() waits only for the remaining time of the fetch, and fetches the value
+/// on the spot if it was not prefetched. The fetch function is called from other threads: it must not use objects
+/// shared with the task which are not thread safe, such as the BasicCCDBManager service, but e.g. its own CcdbApi.
+
+#ifndef COMMON_CORE_ASYNCPREFETCHER_H_
+#define COMMON_CORE_ASYNCPREFETCHER_H_
+
+#include <functional>
+#include <future>
+#include <map>
+#include <utility>
+
+namespace o2::common
+{
+
+template <typename TKey, typename TValue>
+class AsyncPrefetcher
+{
+ public:
+  using Fetcher = std::function<TValue(TKey const&)>;
+
+  AsyncPrefetcher() = default;
+  explicit AsyncPrefetcher(Fetcher fetcher) : mFetcher(std::move(fetcher)) {}
+  AsyncPrefetcher(AsyncPrefetcher const&) = delete;
+  AsyncPrefetcher& operator=(AsyncPrefetcher const&) = delete;
+
+  /// Waits for the fetches still running, which use the fetch function
+  ~AsyncPrefetcher()
+  {
+    for (auto& [key, pending] : mPending) {
+      pending.wait();
+    }
+  }
+
+  void setFetcher(Fetcher fetcher) { mFetcher = std::move(fetcher); }
+
+  /// \return whether the value of the key is available or being fetched
+  bool contains(TKey const& key) const { return mValues.count(key) || mPending.count(key); }
+
+  /// Starts the fetch of the value of the key in a background thread, if not already available or being fetched
+  void prefetch(TKey const& key)
+  {
+    if (contains(key)) {
+      return;
+    }
+    mPending.emplace(key, std::async(std::launch::async, mFetcher, key));
+  }
+
+  /// \return the value of the key, waiting for its fetch to finish or fetching it if it was not prefetched
+  TValue const& get(TKey const& key)
+  {
+    auto value = mValues.find(key);
+    if (value != mValues.end()) {
+      return value->second;
+    }
+    auto pending = mPending.find(key);
+    if (pending != mPending.end()) {
+      auto result = mValues.emplace(key, pending->second.get());
+      mPending.erase(pending);
+      return result.first->second;
+    }
+    return mValues.emplace(key, mFetcher(key)).first->second;
+  }
+
+ private:
+  Fetcher mFetcher{};
+  std::map<TKey, TValue> mValues{};               ///< fetched values
+  std::map<TKey, std::future<TValue>> mPending{}; ///< values being fetched
+};
+
+} // namespace o2::common
+
+#endif // COMMON_CORE_ASYNCPREFETCHER_H_
@@ -20,8 +20,12 @@
 #ifndef COMMON_CORE_COLLISIONASSOCIATION_H_
 #define COMMON_CORE_COLLISIONASSOCIATION_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <utility>
 #include <vector>
-#include <memory>
 #include "CommonConstants/LHCConstants.h"
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/ASoAHelpers.h"
@@ -58,6 +62,9 @@ class CollisionAssociation
   void setIncludeUnassigned(bool enable = true) { mIncludeUnassigned = enable; }
   void setFillTableOfCollIdsPerTrack(bool fill = true) { mFillTableOfCollIdsPerTrack = fill; }
 
+  /// Number of associations of each collision in the last run of the association, whose rows are filled in the order of the collisions
+  std::vector<int> const& getNAssocPerCollision() const { return mNAssocPerCollision; }
+
   template <typename TTracks, typename Slice, typename Assoc, typename RevIndices>
   void runStandardAssoc(Collisions const& collisions,
                         TTracks const& tracks,
@@ -66,6 +73,7 @@ class CollisionAssociation
                         RevIndices& reverseIndices)
   {
     // we do it for all tracks, to be compatible with Run 2 analyses
+    mNAssocPerCollision.assign(collisions.size(), 0);
     for (const auto& collision : collisions) {
       auto tracksThisCollision = tracks.sliceBy(perCollisions, collision.globalIndex());
       for (const auto& track : tracksThisCollision) {
@@ -97,9 +105,11 @@ class CollisionAssociation
           }
           if (hasGoodQuality) {
             association(collision.globalIndex(), track.globalIndex());
+            ++mNAssocPerCollision[collision.globalIndex()];
           }
         } else {
           association(collision.globalIndex(), track.globalIndex());
+          ++mNAssocPerCollision[collision.globalIndex()];
         }
       }
     }
@@ -125,121 +135,154 @@ class CollisionAssociation
                         Assoc& association,
                         RevIndices& reverseIndices)
   {
-    // cache globalBC
-    std::vector<uint64_t> globalBC;
+    // lookup of the first compatible BC of ambiguous tracks, indexed by track global index
+    constexpr uint64_t noBC = std::numeric_limits<uint64_t>::max();
+    std::vector<uint64_t> ambTrackBC(tracksUnfiltered.size(), noBC);
+    for (const auto& ambTrack : ambiguousTracks) {
+      int64_t trackIdx = -1;
+      if constexpr (isCentralBarrel) { // FIXME: to be removed as soon as it is possible to use getId<Table>() for joined tables
+        trackIdx = ambTrack.trackId();
+      } else {
+        trackIdx = ambTrack.template getId<TTracks>();
+      }
+      if (trackIdx >= 0 && trackIdx < static_cast<int64_t>(ambTrackBC.size()) && ambTrackBC[trackIdx] == noBC) {
+        ambTrackBC[trackIdx] = ambTrack.bc().begin().globalBC();
+      }
+    }
+
+    // cache the quantities needed for the time compatibility, indexed by track filtered index
+    const auto nTracks = tracks.size();
+    std::vector<uint64_t> globalBC(nTracks, noBC);
+    std::vector<int> trackIndex(nTracks);
+    std::vector<float> trackTime(nTracks);
+    std::vector<float> trackTimeRes(nTracks);
+    std::vector<uint8_t> thresholdType(nTracks, ThresholdNSigma);
+    std::vector<uint8_t> skipTrack(nTracks, 0);
     for (const auto& track : tracks) {
+      const auto iTrack = track.filteredIndex();
+      trackIndex[iTrack] = track.globalIndex();
       if (track.has_collision()) {
-        globalBC.push_back(track.collision().bc().globalBC());
+        globalBC[iTrack] = track.collision().bc().globalBC();
       } else {
-        for (const auto& ambTrack : ambiguousTracks) {
-          if constexpr (isCentralBarrel) { // FIXME: to be removed as soon as it is possible to use getId<Table>() for joined tables
-            if (ambTrack.trackId() == track.globalIndex()) {
-              globalBC.push_back(ambTrack.bc().begin().globalBC());
-              break;
-            }
-          } else {
-            if (ambTrack.template getId<TTracks>() == track.globalIndex()) {
-              globalBC.push_back(ambTrack.bc().begin().globalBC());
-              break;
-            }
-          }
+        globalBC[iTrack] = ambTrackBC[track.globalIndex()];
+        skipTrack[iTrack] = !mIncludeUnassigned;
+      }
+      trackTime[iTrack] = track.trackTime();
+      trackTimeRes[iTrack] = track.trackTimeRes();
+      if constexpr (isCentralBarrel) {
+        if (mUsePvAssociation && track.isPVContributor()) {
+          trackTime[iTrack] = track.collision().collisionTime();    // if PV contributor, we assume the time to be the one of the collision
+          trackTimeRes[iTrack] = constants::lhc::LHCBunchSpacingNS; // 1 BC
+          thresholdType[iTrack] = ThresholdPvContributor;
+        } else if (TESTBIT(track.flags(), track::TrackTimeResIsRange)) {
+          thresholdType[iTrack] = ThresholdRange;
         }
       }
+      if (globalBC[iTrack] == noBC) { // no BC found for this track
+        skipTrack[iTrack] = 1;
+      }
     }
 
-    // define vector of vectors to store indices of compatible collisions per track
-    std::vector<std::unique_ptr<std::vector<int>>> collsPerTrack(tracksUnfiltered.size());
+    // sort tracks by BC to restrict the search to the BC window of each collision
+    std::vector<int> tracksSortedByBC(nTracks);
+    std::iota(tracksSortedByBC.begin(), tracksSortedByBC.end(), 0);
+    std::stable_sort(tracksSortedByBC.begin(), tracksSortedByBC.end(), [&globalBC](int a, int b) { return globalBC[a] < globalBC[b]; });
+    std::vector<uint64_t> sortedBC(nTracks);
+    for (std::size_t i = 0; i < nTracks; ++i) {
+      sortedBC[i] = globalBC[tracksSortedByBC[i]];
+    }
+
+    // (track, collision) pairs of compatible collisions per track
+    std::vector<std::pair<int, int>> collsPerTrack;
 
     // loop over collisions to find time-compatible tracks
-    auto trackBegin = tracks.begin();
     constexpr auto bOffsetMax = 241; // 6 mus (ITS)
+    std::vector<int> compatibleTracks;
+    mNAssocPerCollision.assign(collisions.size(), 0);
     for (const auto& collision : collisions) {
       const float collTime = collision.collisionTime();
       const float collTimeRes2 = collision.collisionTimeRes() * collision.collisionTimeRes();
       uint64_t collBC = collision.bc().globalBC();
-      // bool iteratorMoved = false;
-      for (auto track = trackBegin; track != tracks.end(); ++track) {
-        if (!mIncludeUnassigned && !track.has_collision()) {
-          continue;
-        }
-        const int64_t bcOffset = (int64_t)globalBC[track.filteredIndex()] - (int64_t)collBC;
-        if (std::abs(bcOffset) > bOffsetMax) {
+      const uint64_t bcMin = collBC > bOffsetMax ? collBC - bOffsetMax : 0;
+      const uint64_t bcMax = collBC + bOffsetMax;
+      compatibleTracks.clear();
+      for (auto iSorted = std::lower_bound(sortedBC.begin(), sortedBC.end(), bcMin) - sortedBC.begin(); iSorted < static_cast<int64_t>(nTracks) && sortedBC[iSorted] <= bcMax; ++iSorted) {
+        const auto iTrack = tracksSortedByBC[iSorted];
+        if (skipTrack[iTrack]) {
           continue;
         }
+        const int64_t bcOffset = (int64_t)globalBC[iTrack] - (int64_t)collBC;
 
-        float trackTime = track.trackTime();
-        float trackTimeRes = track.trackTimeRes();
-        if constexpr (isCentralBarrel) {
-          if (mUsePvAssociation && track.isPVContributor()) {
-            trackTime = track.collision().collisionTime();    // if PV contributor, we assume the time to be the one of the collision
-            trackTimeRes = constants::lhc::LHCBunchSpacingNS; // 1 BC
-          }
-        }
-
-        const float deltaTime = trackTime - collTime + bcOffset * constants::lhc::LHCBunchSpacingNS;
-        float sigmaTimeRes2 = collTimeRes2 + trackTimeRes * trackTimeRes;
-        LOGP(debug, "collision time={}, collision time res={}, track time={}, track time res={}, bc collision={}, bc track={}, delta time={}", collTime, collision.collisionTimeRes(), track.trackTime(), track.trackTimeRes(), collBC, globalBC[track.filteredIndex()], deltaTime);
-
-        // optimization to avoid looping over the full track list each time. This assumes that tracks are sorted by BCs (which they should be because collisions are sorted by BCs)
-        // NOTE this does not work anymore if mIncludeUnassigned is set as the unassigned blocks can be somewhere (and we can have merged DFs, too)
-        // if (!iteratorMoved && bcOffset > -bOffsetMax) {
-        //   trackBegin.setCursor(track.filteredIndex());
-        //   iteratorMoved = true;
-        //   LOGP(debug, "Moving iterator begin {}", track.globalIndex());
-        // } else if (bcOffset > bOffsetMax) {
-        //   LOGP(debug, "Stopping iterator {}", track.globalIndex());
-        //   break;
-        // }
+        const float deltaTime = trackTime[iTrack] - collTime + bcOffset * constants::lhc::LHCBunchSpacingNS;
+        float sigmaTimeRes2 = collTimeRes2 + trackTimeRes[iTrack] * trackTimeRes[iTrack];
+        LOGP(debug, "collision time={}, collision time res={}, track time={}, track time res={}, bc collision={}, bc track={}, delta time={}", collTime, collision.collisionTimeRes(), trackTime[iTrack], trackTimeRes[iTrack], collBC, globalBC[iTrack], deltaTime);
 
         float thresholdTime = 0.;
-        if constexpr (isCentralBarrel) {
-          if (mUsePvAssociation && track.isPVContributor()) {
-            thresholdTime = trackTimeRes;
-          } else if (TESTBIT(track.flags(), track::TrackTimeResIsRange)) {
+        switch (thresholdType[iTrack]) {
+          case ThresholdPvContributor:
+            thresholdTime = trackTimeRes[iTrack];
+            break;
+          case ThresholdRange:
             thresholdTime = std::sqrt(sigmaTimeRes2) + mTimeMargin;
-          } else {
+            break;
+          default:
             thresholdTime = mNumSigmaForTimeCompat * std::sqrt(sigmaTimeRes2) + mTimeMargin;
-          }
-        } else {
-          thresholdTime = mNumSigmaForTimeCompat * std::sqrt(sigmaTimeRes2) + mTimeMargin;
         }
 
         if (std::abs(deltaTime) < thresholdTime) {
-          const auto collIdx = collision.globalIndex();
-          const auto trackIdx = track.globalIndex();
-          LOGP(debug, "Filling track id {} for coll id {}", trackIdx, collIdx);
-          association(collIdx, trackIdx);
-          if (mFillTableOfCollIdsPerTrack) {
-            if (collsPerTrack[trackIdx] == nullptr) {
-              collsPerTrack[trackIdx] = std::make_unique<std::vector<int>>();
-            }
-            collsPerTrack[trackIdx].get()->push_back(collIdx);
-          }
+          compatibleTracks.push_back(iTrack);
+        }
+      }
+      // fill in the order of the track table
+      std::sort(compatibleTracks.begin(), compatibleTracks.end());
+      const auto collIdx = collision.globalIndex();
+      mNAssocPerCollision[collIdx] = compatibleTracks.size();
+      for (const auto iTrack : compatibleTracks) {
+        const auto trackIdx = trackIndex[iTrack];
+        LOGP(debug, "Filling track id {} for coll id {}", trackIdx, collIdx);
+        association(collIdx, trackIdx);
+        if (mFillTableOfCollIdsPerTrack) {
+          collsPerTrack.emplace_back(trackIdx, collIdx);
         }
       }
     }
     // create reverse index track to collisions if enabled
     if (mFillTableOfCollIdsPerTrack) {
-      std::vector<int> empty{};
+      // flat (CSR) list of compatible collisions per track, keeping the collision order
+      std::vector<int> offsets(tracksUnfiltered.size() + 1, 0);
+      for (const auto& [trackIdx, collIdx] : collsPerTrack) {
+        ++offsets[trackIdx + 1];
+      }
+      std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+      std::vector<int> collIds(collsPerTrack.size());
+      std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+      for (const auto& [trackIdx, collIdx] : collsPerTrack) {
+        collIds[fill[trackIdx]++] = collIdx;
+      }
+      std::vector<int> collIdsThisTrack{};
       for (const auto& track : tracksUnfiltered) {
-
         const auto trackId = track.globalIndex();
-        if (collsPerTrack[trackId] == nullptr) {
-          reverseIndices(empty);
-        } else {
-          reverseIndices(*collsPerTrack[trackId].get());
-        }
+        collIdsThisTrack.assign(collIds.begin() + offsets[trackId], collIds.begin() + offsets[trackId + 1]);
+        reverseIndices(collIdsThisTrack);
       }
     }
   }
 
  private:
+  // type of threshold for the time compatibility of a track
+  enum ThresholdType : uint8_t {
+    ThresholdNSigma = 0,   // number of sigmas of the time resolution plus margin
+    ThresholdRange,        // time resolution is a range, plus margin
+    ThresholdPvContributor // PV contributor with collision time
+  };
+
   float mNumSigmaForTimeCompat{4.};                                         // number of sigma for time compatibility
   float mTimeMargin{500.};                                                  // additional time margin in ns
   int mTrackSelection{track_association::TrackSelection::GlobalTrackWoDCA}; // track selection for central barrel tracks (standard association only)
   bool mUsePvAssociation{true};                                             // use the information of PV contributors
   bool mIncludeUnassigned{true};                                            // include tracks that were originally not assigned to any collision
   bool mFillTableOfCollIdsPerTrack{false};                                  // fill additional table with vectors of compatible collisions per track
+  std::vector<int> mNAssocPerCollision{};                                   // number of associations per collision of the last run
 };
 
 #endif // COMMON_CORE_COLLISIONASSOCIATION_H_
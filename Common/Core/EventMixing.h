@@ -12,6 +12,12 @@
 #ifndef ANALYSIS_CORE_EVENTMIXING_H_
 #define ANALYSIS_CORE_EVENTMIXING_H_
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
 namespace eventmixing
 {
 /// Calculate hash for an element based on 2 properties and their bins.
@@ -45,6 +51,114 @@ static int getMixingBin(const T1& vtxBins, const T1& multBins, const T2& vtx, co
   // overflow
   return -1;
 }
+
+/// Binning of one event-mixing variable defined by its bin edges.
+/// Values are located by binary search, or by direct computation when the edges are equidistant.
+/// \tparam T Data type of the bin edges and of the values
+template <typename T = float>
+class MixingAxis
+{
+ public:
+  MixingAxis() = default;
+
+  /// \param edges Bin edges in increasing order (at least two)
+  explicit MixingAxis(const std::vector<T>& edges) : mEdges(edges)
+  {
+    if (mEdges.size() < 2) {
+      mEdges.clear();
+      return;
+    }
+    const auto width = static_cast<double>(mEdges[1] - mEdges[0]);
+    mIsUniform = width > 0.;
+    for (std::size_t i = 2; i < mEdges.size() && mIsUniform; i++) {
+      mIsUniform = std::abs(static_cast<double>(mEdges[i] - mEdges[i - 1]) - width) <= 1.e-5 * width;
+    }
+    if (mIsUniform) {
+      mInvWidth = 1. / width;
+    }
+  }
+
+  /// \return Number of bins
+  int getNBins() const { return mEdges.empty() ? 0 : static_cast<int>(mEdges.size()) - 1; }
+
+  /// \return Whether the bin edges are equidistant
+  bool isUniform() const { return mIsUniform; }
+
+  /// Find the bin of a value.
+  /// \param value Value of the variable
+  /// \return Bin index in [0, getNBins()), -1 in case of underflow or overflow
+  int getBin(T value) const
+  {
+    if (mEdges.empty() || !(value >= mEdges.front()) || !(value < mEdges.back())) {
+      return -1;
+    }
+    if (mIsUniform) {
+      int bin = std::min(static_cast<int>((static_cast<double>(value) - mEdges.front()) * mInvWidth), getNBins() - 1);
+      // correct for the finite precision of the edges
+      if (value < mEdges[bin]) {
+        bin--;
+      } else if (value >= mEdges[bin + 1]) {
+        bin++;
+      }
+      return bin;
+    }
+    return static_cast<int>(std::upper_bound(mEdges.begin(), mEdges.end(), value) - mEdges.begin()) - 1;
+  }
+
+ private:
+  std::vector<T> mEdges{}; ///< Bin edges
+  bool mIsUniform = false; ///< Whether the bin edges are equidistant
+  double mInvWidth = 0.;   ///< Inverse of the bin width for equidistant edges
+};
+
+/// Binning of events in N mixing variables (e.g. z-vertex, multiplicity, event-plane angle).
+/// \tparam N Number of variables
+/// \tparam T Data type of the bin edges and of the values
+template <std::size_t N, typename T = float>
+class MixingBinning
+{
+ public:
+  MixingBinning() = default;
+
+  /// \param edges Bin edges of each variable
+  template <typename... V>
+  explicit MixingBinning(const V&... edges) : mAxes{MixingAxis<T>(edges)...}
+  {
+    static_assert(sizeof...(V) == N, "Number of binnings must match the number of variables");
+  }
+
+  /// \return Total number of bins
+  int getNBins() const
+  {
+    int nBins = 1;
+    for (const auto& axis : mAxes) {
+      nBins *= axis.getNBins();
+    }
+    return nBins;
+  }
+
+  /// Calculate the dense linear bin index of an event.
+  /// \param values Values of the variables, in the same order as the binnings
+  /// \return Bin index in [0, getNBins()), -1 in case of underflow or overflow in any variable
+  template <typename... V>
+  int getBin(const V&... values) const
+  {
+    static_assert(sizeof...(V) == N, "Number of values must match the number of variables");
+    const std::array<T, N> arrValues{static_cast<T>(values)...};
+    int bin = 0;
+    for (std::size_t i = N; i-- > 0;) {
+      const int binAxis = mAxes[i].getBin(arrValues[i]);
+      if (binAxis < 0) {
+        return -1;
+      }
+      bin = bin * mAxes[i].getNBins() + binAxis;
+    }
+    return bin;
+  }
+
+ private:
+  std::array<MixingAxis<T>, N> mAxes{}; ///< Binnings of the variables
+};
 }; // namespace eventmixing
 
 #endif /* ANALYSIS_CORE_EVENTMIXING_H_ */
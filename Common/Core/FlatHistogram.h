@@ -0,0 +1,115 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   FlatHistogram.h
+/// \brief  Flat, self-contained copy of a 1D calibration histogram for fast per-collision lookups
+///
+
+#ifndef COMMON_CORE_FLATHISTOGRAM_H_
+#define COMMON_CORE_FLATHISTOGRAM_H_
+
+#include <algorithm>
+#include <vector>
+
+#include <TH1.h>
+
+/// Flattened 1D histogram. The bin contents (including underflow and overflow) and the
+/// bin edges are copied into contiguous arrays so that the object does not depend on the
+/// lifetime of the source histogram (e.g. an object owned by the CCDB manager cache).
+/// The lookups reproduce TH1::FindFixBin, TH1::GetBinContent and TH1::Interpolate.
+class FlatHistogram
+{
+ public:
+  FlatHistogram() = default;
+  explicit FlatHistogram(const TH1* h) { set(h); }
+
+  /// Copies the binning and the contents of the histogram
+  /// \param h source histogram, if nullptr the object is reset
+  void set(const TH1* h)
+  {
+    mContent.clear();
+    mEdges.clear();
+    if (h == nullptr) {
+      return;
+    }
+    const TAxis* axis = h->GetXaxis();
+    mNbins = axis->GetNbins();
+    mMin = axis->GetXmin();
+    mMax = axis->GetXmax();
+    mVariableBins = axis->GetXbins()->fN != 0;
+    mContent.resize(mNbins + 2);
+    for (int i = 0; i < mNbins + 2; i++) {
+      mContent[i] = h->GetBinContent(i);
+    }
+    if (mVariableBins) {
+      mEdges.assign(axis->GetXbins()->GetArray(), axis->GetXbins()->GetArray() + axis->GetXbins()->fN);
+    }
+  }
+
+  /// True if a histogram has been copied
+  bool isValid() const { return !mContent.empty(); }
+
+  /// Bin index as given by TAxis::FindFixBin, 0 for underflow and nbins + 1 for overflow
+  int findBin(double x) const
+  {
+    if (x < mMin) {
+      return 0;
+    }
+    if (!(x < mMax)) {
+      return mNbins + 1;
+    }
+    if (mVariableBins) {
+      return static_cast<int>(std::upper_bound(mEdges.begin(), mEdges.end(), x) - mEdges.begin());
+    }
+    return 1 + static_cast<int>(mNbins * (x - mMin) / (mMax - mMin));
+  }
+
+  /// Content of the bin containing x
+  double getBinContent(double x) const { return mContent[findBin(x)]; }
+
+  /// Linear interpolation between the centers of the neighbouring bins, as TH1::Interpolate
+  double interpolate(double x) const
+  {
+    if (x <= binCenter(1)) {
+      return mContent[1];
+    }
+    if (x >= binCenter(mNbins)) {
+      return mContent[mNbins];
+    }
+    int bin = findBin(x);
+    if (x <= binCenter(bin)) {
+      bin--;
+    }
+    const double xLow = binCenter(bin);
+    const double xUp = binCenter(bin + 1);
+    return mContent[bin] + (x - xLow) * (mContent[bin + 1] - mContent[bin]) / (xUp - xLow);
+  }
+
+ private:
+  double binCenter(int bin) const
+  {
+    if (mVariableBins) {
+      return 0.5 * (mEdges[bin - 1] + mEdges[bin]);
+    }
+    const double width = (mMax - mMin) / mNbins;
+    return mMin + (bin - 1) * width + 0.5 * width;
+  }
+
+  int mNbins = 0;
+  double mMin = 0.;
+  double mMax = 0.;
+  bool mVariableBins = false;
+  std::vector<double> mEdges;   /// Bin edges, only filled for variable binning
+  std::vector<double> mContent; /// Bin contents, including underflow and overflow
+};
+
+#endif // COMMON_CORE_FLATHISTOGRAM_H_
@@ -0,0 +1,379 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file McDecayGraph.h
+/// \brief Precomputed index of the MC decay tree for fast MC matching
+///
+/// The index is built once per data frame from the MC particle table and stores mothers and daughters
+/// of all particles in compressed sparse row (CSR) arrays. The MC-matching queries mirror the ones of RecoDecay
+/// (getMother, getDaughters, getMatchedMCRec, isMatchedMCGen) and give identical results,
+/// but they do not walk the table iterators and do not allocate memory once the internal buffers have grown.
+
+#ifndef COMMON_CORE_MCDECAYGRAPH_H_
+#define COMMON_CORE_MCDECAYGRAPH_H_
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/// Decay-graph index of a table of MC particles
+/// \note Queries use internal buffers and are therefore not thread-safe. Use one instance per thread.
+
+class McDecayGraph
+{
+ public:
+  /// Default constructor
+  McDecayGraph() = default;
+
+  /// Default destructor
+  ~McDecayGraph() = default;
+
+  /// Builds the index from a table of MC particles.
+  /// \note Must be called for every new data frame before any query. Previous content (including the memoised ancestors) is discarded.
+  /// \param particlesMC  table with MC particles
+  template <typename T>
+  void build(const T& particlesMC)
+  {
+    mOffset = particlesMC.offset();
+    const auto nParticles = static_cast<std::size_t>(particlesMC.size());
+    mPdg.resize(nParticles);
+    mMothersStart.assign(nParticles + 1, 0);
+    mDaughtersStart.assign(nParticles + 1, 0);
+    mMothers.clear();
+    mDaughters.clear();
+    mCacheAncestor.clear();
+    for (const auto& particle : particlesMC) {
+      const auto iPart = static_cast<std::size_t>(particle.globalIndex() - mOffset);
+      mPdg[iPart] = particle.pdgCode();
+      if (particle.has_mothers()) {
+        for (auto iMother = particle.mothersIds().front(); iMother <= particle.mothersIds().back(); ++iMother) {
+          mMothers.push_back(static_cast<int32_t>(iMother - mOffset));
+        }
+      }
+      mMothersStart[iPart + 1] = static_cast<int32_t>(mMothers.size());
+      if (particle.has_daughters()) {
+        for (auto iDaughter = particle.daughtersIds().front(); iDaughter <= particle.daughtersIds().back(); ++iDaughter) {
+          mDaughters.push_back(static_cast<int32_t>(iDaughter - mOffset));
+        }
+      }
+      mDaughtersStart[iPart + 1] = static_cast<int32_t>(mDaughters.size());
+    }
+  }
+
+  /// \return number of indexed particles
+  std::size_t size() const { return mPdg.size(); }
+
+  /// \param index  global index of an MC particle
+  /// \return PDG code of the particle
+  int pdgCode(int64_t index) const { return mPdg[index - mOffset]; }
+
+  /// \param index  global index of an MC particle
+  /// \return number of direct daughters of the particle
+  int nDaughters(int64_t index) const
+  {
+    const auto iPart = index - mOffset;
+    return mDaughtersStart[iPart + 1] - mDaughtersStart[iPart];
+  }
+
+  /// Finds the mother of an MC particle by looking for the expected PDG code in the mother chain.
+  /// \note Same as RecoDecay::getMother. Results are memoised per (PDGMother, acceptAntiParticles, depthMax).
+  /// \param index  global index of the MC particle
+  /// \param PDGMother  expected mother PDG code
+  /// \param acceptAntiParticles  switch to accept the antiparticle of the expected mother
+  /// \param sign  antiparticle indicator of the found mother w.r.t. PDGMother; 1 if particle, -1 if antiparticle, 0 if mother not found
+  /// \param depthMax  maximum decay tree level to check; Mothers up to this level will be considered. If -1, all levels are considered.
+  /// \return global index of the mother particle if found, -1 otherwise
+  int getMother(int64_t index,
+                int PDGMother,
+                bool acceptAntiParticles = false,
+                int8_t* sign = nullptr,
+                int8_t depthMax = -1)
+  {
+    const auto iPart = static_cast<std::size_t>(index - mOffset);
+    auto& cache = mCacheAncestor[keyAncestor(PDGMother, acceptAntiParticles, depthMax)];
+    if (cache.empty()) {
+      cache.assign(mPdg.size(), {NotComputed, 0});
+    }
+    auto& entry = cache[iPart];
+    if (entry.first == NotComputed) {
+      entry.first = findMother(iPart, PDGMother, acceptAntiParticles, &entry.second, depthMax);
+    }
+    if (sign) {
+      *sign = entry.second;
+    }
+    return entry.first;
+  }
+
+  /// Gets the complete list of indices of final-state daughters of an MC particle.
+  /// \note Same as RecoDecay::getDaughters, implemented without recursion.
+  /// \param index  global index of the MC particle
+  /// \param list  vector where the global indices of final-state daughters will be added
+  /// \param arrPDGFinal  array of PDG codes of particles to be considered final if found
+  /// \param depthMax  maximum decay tree level; Daughters at this level (or beyond) will be considered final. If -1, all levels are considered.
+  template <std::size_t N>
+  void getDaughters(int64_t index,
+                    std::vector<int>* list,
+                    const std::array<int, N>& arrPDGFinal,
+                    int8_t depthMax = -1)
+  {
+    if (!list) {
+      return;
+    }
+    mStack.clear();
+    mStack.emplace_back(static_cast<int32_t>(index - mOffset), 0);
+    while (!mStack.empty()) {
+      const auto [iPart, stage] = mStack.back();
+      mStack.pop_back();
+      const auto iDauStart = mDaughtersStart[iPart];
+      const auto iDauEnd = mDaughtersStart[iPart + 1];
+      bool isFinal = depthMax > -1 && stage >= depthMax; // Maximum depth has been reached (or exceeded).
+      if (!isFinal && iDauStart == iDauEnd) {
+        // If the original particle has no daughters, we do nothing and exit.
+        if (stage == 0) {
+          return;
+        }
+        // If this is not the original particle, we are at the end of this branch and this particle is final.
+        isFinal = true;
+      }
+      // If this is not the original particle, check its PDG code.
+      if (!isFinal && stage > 0) {
+        const auto PDGParticle = std::abs(mPdg[iPart]);
+        for (auto PDGi : arrPDGFinal) {
+          if (PDGParticle == std::abs(PDGi)) { // Accept antiparticles.
+            isFinal = true;
+            break;
+          }
+        }
+      }
+      if (isFinal) {
+        list->push_back(static_cast<int>(iPart + mOffset));
+        continue;
+      }
+      // Follow the daughter tree. Daughters are pushed in reverse order to keep the order of the recursive implementation.
+      for (auto iDau = iDauEnd; iDau-- > iDauStart;) {
+        mStack.emplace_back(mDaughters[iDau], stage + 1);
+      }
+    }
+  }
+
+  /// Checks whether the reconstructed decay candidate is the expected decay.
+  /// \note Same as RecoDecay::getMatchedMCRec.
+  /// \param arrDaughters  array of candidate daughters
+  /// \param PDGMother  expected mother PDG code
+  /// \param arrPDGDaughters  array of expected daughter PDG codes
+  /// \param acceptAntiParticles  switch to accept the antiparticle version of the expected decay
+  /// \param sign  antiparticle indicator of the found mother w.r.t. PDGMother; 1 if particle, -1 if antiparticle, 0 if mother not found
+  /// \param depthMax  maximum decay tree level to check; Daughters up to this level will be considered. If -1, all levels are considered.
+  /// \return global index of the mother particle if the mother and daughters are correct, -1 otherwise
+  template <std::size_t N, typename U>
+  int getMatchedMCRec(const std::array<U, N>& arrDaughters,
+                      int PDGMother,
+                      std::array<int, N> arrPDGDaughters,
+                      bool acceptAntiParticles = false,
+                      int8_t* sign = nullptr,
+                      int depthMax = 1)
+  {
+    int8_t sgn = 0;                       // 1 if the expected mother is particle, -1 if antiparticle (w.r.t. PDGMother)
+    int indexMother = -1;                 // index of the mother particle
+    std::array<int, N> arrDaughtersIndex; // array of indices of provided daughters
+    if (sign) {
+      *sign = sgn;
+    }
+    // Loop over decay candidate prongs
+    for (std::size_t iProng = 0; iProng < N; ++iProng) {
+      if (!arrDaughters[iProng].has_mcParticle()) {
+        return -1;
+      }
+      arrDaughtersIndex[iProng] = arrDaughters[iProng].mcParticleId();
+      // Get the list of daughter indices from the mother of the first prong.
+      if (iProng == 0) {
+        // PDG code of the first daughter's mother determines whether the expected mother is a particle or antiparticle.
+        indexMother = getMother(arrDaughtersIndex[iProng], PDGMother, acceptAntiParticles, &sgn, depthMax);
+        if (indexMother <= -1) {
+          return -1;
+        }
+        // Check that the mother has daughters and that the number of direct daughters is not larger than the number of expected final daughters.
+        const auto nDaughtersMother = nDaughters(indexMother);
+        if (nDaughtersMother == 0 || nDaughtersMother > static_cast<int>(N)) {
+          return -1;
+        }
+        // Get the list of actual final daughters and check that their number is equal to the number of provided prongs.
+        mListDaughters.clear();
+        getDaughters(indexMother, &mListDaughters, arrPDGDaughters, depthMax);
+        if (mListDaughters.size() != N) {
+          return -1;
+        }
+      }
+      // Check that the daughter is in the list of final daughters.
+      bool isDaughterFound = false;
+      for (auto& indexDaughter : mListDaughters) {
+        if (arrDaughtersIndex[iProng] == indexDaughter) {
+          indexDaughter = -1; // Rejects twin daughters, i.e. particle considered twice as a daughter.
+          isDaughterFound = true;
+          break;
+        }
+      }
+      if (!isDaughterFound) {
+        return -1;
+      }
+      // Check daughter's PDG code.
+      if (!removePDG(arrPDGDaughters, pdgCode(arrDaughtersIndex[iProng]), sgn)) {
+        return -1;
+      }
+    }
+    if (sign) {
+      *sign = sgn;
+    }
+    return indexMother;
+  }
+
+  /// Checks whether the MC particle is the expected one and whether it decayed via the expected decay channel.
+  /// \note Same as RecoDecay::isMatchedMCGen.
+  /// \param index  global index of the candidate MC particle
+  /// \param PDGParticle  expected particle PDG code
+  /// \param arrPDGDaughters  array of expected PDG codes of daughters
+  /// \param acceptAntiParticles  switch to accept the antiparticle
+  /// \param sign  antiparticle indicator of the candidate w.r.t. PDGParticle; 1 if particle, -1 if antiparticle, 0 if not matched
+  /// \param depthMax  maximum decay tree level to check; Daughters up to this level will be considered. If -1, all levels are considered.
+  /// \param listIndexDaughters  vector of indices of found daughter
+  /// \return true if PDG codes of the particle and its daughters are correct, false otherwise
+  template <std::size_t N>
+  bool isMatchedMCGen(int64_t index,
+                      int PDGParticle,
+                      std::array<int, N> arrPDGDaughters,
+                      bool acceptAntiParticles = false,
+                      int8_t* sign = nullptr,
+                      int depthMax = 1,
+                      std::vector<int>* listIndexDaughters = nullptr)
+  {
+    int8_t sgn = 0; // 1 if the expected mother is particle, -1 if antiparticle (w.r.t. PDGParticle)
+    if (sign) {
+      *sign = sgn;
+    }
+    // Check the PDG code of the particle.
+    const auto PDGCandidate = pdgCode(index);
+    if (PDGCandidate == PDGParticle) { // exact PDG match
+      sgn = 1;
+    } else if (acceptAntiParticles && PDGCandidate == -PDGParticle) { // antiparticle PDG match
+      sgn = -1;
+    } else {
+      return false;
+    }
+    // Check the PDG codes of the decay products.
+    if constexpr (N > 0) {
+      const auto nDaughtersCandidate = nDaughters(index);
+      if (nDaughtersCandidate == 0 || nDaughtersCandidate > static_cast<int>(N)) {
+        return false;
+      }
+      mListDaughters.clear();
+      getDaughters(index, &mListDaughters, arrPDGDaughters, depthMax);
+      if (mListDaughters.size() != N) {
+        return false;
+      }
+      for (auto indexDaughterI : mListDaughters) {
+        if (!removePDG(arrPDGDaughters, pdgCode(indexDaughterI), sgn)) {
+          return false;
+        }
+      }
+      if (listIndexDaughters) {
+        *listIndexDaughters = mListDaughters;
+      }
+    }
+    if (sign) {
+      *sign = sgn;
+    }
+    return true;
+  }
+
+ private:
+  static constexpr int NotComputed = -2; ///< marker of ancestors which have not been searched yet
+
+  /// Encodes the key of the cache of ancestors.
+  static int64_t keyAncestor(int PDGMother, bool acceptAntiParticles, int8_t depthMax)
+  {
+    return (static_cast<int64_t>(PDGMother) << 9) | (static_cast<int64_t>(static_cast<uint8_t>(depthMax)) << 1) | static_cast<int64_t>(acceptAntiParticles);
+  }
+
+  /// Removes PDG code from the array of expected ones.
+  /// \return true if the PDG code was found
+  template <std::size_t N>
+  static bool removePDG(std::array<int, N>& arrPDG, int PDGParticle, int8_t sgn)
+  {
+    for (auto& PDGExpected : arrPDG) {
+      if (PDGParticle == sgn * PDGExpected) {
+        PDGExpected = 0;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// Breadth-first search of the mother, stage by stage, as in RecoDecay::getMother.
+  /// \param iPart  local index of the particle
+  int findMother(std::size_t iPart, int PDGMother, bool acceptAntiParticles, int8_t* sign, int8_t depthMax)
+  {
+    int8_t sgn = 0;
+    int indexMother = -1;
+    int stage = 0;
+    bool motherFound = false;
+    mStageCurrent.clear();
+    mStageCurrent.push_back(static_cast<int32_t>(iPart));
+    while (!motherFound && !mStageCurrent.empty() && (depthMax < 0 || stage < depthMax)) {
+      mStageNext.clear();
+      for (auto iCurrent : mStageCurrent) {
+        for (auto iM = mMothersStart[iCurrent]; iM < mMothersStart[iCurrent + 1]; ++iM) {
+          const auto iMother = mMothers[iM];
+          if (std::find(mStageNext.begin(), mStageNext.end(), iMother) != mStageNext.end()) { // if a mother is still present in the vector, do not check it again
+            continue;
+          }
+          const auto PDGParticleIMother = mPdg[iMother];
+          if (PDGParticleIMother == PDGMother) { // exact PDG match
+            sgn = 1;
+            indexMother = static_cast<int>(iMother + mOffset);
+            motherFound = true;
+            break;
+          } else if (acceptAntiParticles && PDGParticleIMother == -PDGMother) { // antiparticle PDG match
+            sgn = -1;
+            indexMother = static_cast<int>(iMother + mOffset);
+            motherFound = true;
+            break;
+          }
+          mStageNext.push_back(iMother);
+        }
+      }
+      std::swap(mStageCurrent, mStageNext);
+      ++stage;
+    }
+    if (sign) {
+      *sign = sgn;
+    }
+    return indexMother;
+  }
+
+  int64_t mOffset = 0;                                                             ///< global index of the first particle of the indexed table
+  std::vector<int> mPdg;                                                           ///< PDG codes of particles
+  std::vector<int32_t> mMothersStart;                                              ///< CSR row offsets of mothers
+  std::vector<int32_t> mMothers;                                                   ///< CSR local indices of mothers
+  std::vector<int32_t> mDaughtersStart;                                            ///< CSR row offsets of daughters
+  std::vector<int32_t> mDaughters;                                                 ///< CSR local indices of daughters
+  std::unordered_map<int64_t, std::vector<std::pair<int, int8_t>>> mCacheAncestor; ///< memoised (mother index, sign) per particle for each (PDG code, antiparticle switch, depth)
+  // buffers reused between queries
+  std::vector<int32_t> mStageCurrent;             ///< particles of the current stage of the mother search
+  std::vector<int32_t> mStageNext;                ///< particles of the next stage of the mother search
+  std::vector<std::pair<int32_t, int8_t>> mStack; ///< (particle, stage) stack of the daughter search
+  std::vector<int> mListDaughters;                ///< list of final daughters for the matching functions
+};
+
+#endif // COMMON_CORE_MCDECAYGRAPH_H_
@@ -19,6 +19,9 @@
 #ifndef COMMON_CORE_PID_PIDTOF_H_
 #define COMMON_CORE_PID_PIDTOF_H_
 
+#include <array>
+#include <cmath>
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -123,6 +126,53 @@ class TOFMass
   static float GetTOFMass(const TrackType& track) { return track.hasTOF() ? GetTOFMass(track.p(), Beta<TrackType>::GetBeta(track)) : defaultReturnValue; }
 };
 
+/// \brief Columnar computation of the TOF beta, of its expected uncertainty and of the TOF mass.
+/// The inputs are contiguous arrays, e.g. the value buffers of the track table columns, and the outputs are preallocated arrays of the same size.
+/// The results are identical to the ones of Beta::GetBeta, Beta::GetExpectedSigma and TOFMass::GetTOFMass, the loop has no branches and can be vectorised.
+class BetaKernel
+{
+ public:
+  /// Computes beta, beta uncertainty and TOF mass of a set of tracks
+  /// \param n number of tracks
+  /// \param length length in cm of the tracks
+  /// \param tofSignal TOF signal in ps of the tracks
+  /// \param collisionTime event time in ps of the tracks
+  /// \param detectorMap detector map of the tracks, the TOF bit is used to flag the tracks without a TOF measurement
+  /// \param expectedResolution expected time resolution for the uncertainty on beta
+  /// \param beta output beta, can be nullptr
+  /// \param betaError output uncertainty on beta, can be nullptr
+  /// \param momentum momentum of the tracks for the TOF mass, can be nullptr if the mass is not requested
+  /// \param mass output TOF mass, can be nullptr
+  static void Compute(const int64_t n,
+                      const float* length,
+                      const float* tofSignal,
+                      const float* collisionTime,
+                      const uint8_t* detectorMap,
+                      const float expectedResolution,
+                      float* beta,
+                      float* betaError,
+                      const float* momentum = nullptr,
+                      float* mass = nullptr)
+  {
+    const bool doBetaError = betaError != nullptr;
+    const bool doMass = momentum != nullptr && mass != nullptr;
+    for (int64_t i = 0; i < n; i++) {
+      const float deltaT = tofSignal[i] - collisionTime[i];
+      const float b = length[i] / deltaT * kCSPEDDInv;
+      const bool hasTOF = detectorMap[i] & o2::aod::track::TOF;
+      if (beta != nullptr) {
+        beta[i] = hasTOF ? b : defaultReturnValue;
+      }
+      if (doBetaError) {
+        betaError[i] = b / deltaT * expectedResolution;
+      }
+      if (doMass) {
+        mass[i] = hasTOF ? (momentum[i] / b) * std::sqrt(std::abs(1.f - b * b)) : defaultReturnValue;
+      }
+    }
+  }
+};
+
 /// \brief Next implementation class to store TOF response parameters for exp. times
 class TOFResoParamsV2 : public o2::tof::Parameters<13>
 {
@@ -326,6 +376,144 @@ class ExpTimes
   static float GetSeparation(const TOFResoParamsV2& parameters, const TrackType& track) { return GetSeparation(parameters, track, track.tofEvTime(), track.tofEvTimeErr()); }
 };
 
+/// \brief Class to compute the TOF response for several mass hypotheses in a single pass over a block of tracks
+/// The terms that do not depend on the mass hypothesis (expected momentum and its eta dependent shift, time shift, event time and its resolution)
+/// are evaluated once per track and shared among the hypotheses. Results are stored per hypothesis in contiguous buffers, indexed by the position of the track in the block.
+template <typename TrackType>
+class ExpTimesAll
+{
+ public:
+  ExpTimesAll() = default;
+  ~ExpTimesAll() = default;
+  static constexpr int nSpecies = o2::track::PID::NIDs;
+  static constexpr std::array<float, nSpecies> mMassZ = {o2::track::pid_constants::sMasses2Z[o2::track::PID::Electron],
+                                                         o2::track::pid_constants::sMasses2Z[o2::track::PID::Muon],
+                                                         o2::track::pid_constants::sMasses2Z[o2::track::PID::Pion],
+                                                         o2::track::pid_constants::sMasses2Z[o2::track::PID::Kaon],
+                                                         o2::track::pid_constants::sMasses2Z[o2::track::PID::Proton],
+                                                         o2::track::pid_constants::sMasses2Z[o2::track::PID::Deuteron],
+                                                         o2::track::pid_constants::sMasses2Z[o2::track::PID::Triton],
+                                                         o2::track::pid_constants::sMasses2Z[o2::track::PID::Helium3],
+                                                         o2::track::pid_constants::sMasses2Z[o2::track::PID::Alpha]}; /// Mass hypotheses divided by the charge (in units of e): M/z
+
+  /// Prepares the buffers for a block of tracks
+  /// \param size number of tracks in the block
+  /// \param ids mass hypotheses to compute
+  void reset(const int64_t size, const std::vector<int>& ids)
+  {
+    mIds = ids;
+    for (const int& id : mIds) {
+      mExpSignal[id].resize(size);
+      mExpSigma[id].resize(size);
+      mDelta[id].resize(size);
+    }
+    mHasTOF.resize(size);
+    mEvTimeErr.resize(size);
+  }
+
+  /// Computes the response for all the requested mass hypotheses for one track of the block
+  /// Tracks not assigned to a collision have no event time, all their values are set to the default return value
+  /// \param parameters Detector response parameters
+  /// \param track Track of interest
+  /// \param index position of the track in the block
+  void computeTrack(const TOFResoParamsV2& parameters, const TrackType& track, const int64_t index)
+  {
+    if (!track.has_collision()) {
+      mHasTOF[index] = false;
+      mEvTimeErr[index] = defaultReturnValue;
+      for (const int& id : mIds) {
+        mExpSignal[id][index] = defaultReturnValue;
+        mExpSigma[id][index] = defaultReturnValue;
+      }
+      return;
+    }
+    const bool hasTOF = track.hasTOF();
+    const float tofSignal = track.tofSignal();
+    const float evTimeErr = track.tofEvTimeErr();
+    mHasTOF[index] = hasTOF;
+    mEvTimeErr[index] = evTimeErr;
+
+    // Expected times, sharing the expected momentum and the shifts
+    if (hasTOF) {
+      const float eta = track.eta();
+      const short sign = track.sign();
+      const float length = track.length();
+      const float deltaT = tofSignal - track.tofEvTime();
+      const bool isRun2 = track.trackType() == o2::aod::track::Run2Track;
+      const float expMom = (isRun2 ? track.tofExpMom() * kCSPEDDInv : track.tofExpMom()) / (1.f + sign * parameters.getShift(eta));
+      const float timeShift = isRun2 ? 0.f : parameters.getTimeShift(eta, sign);
+      const float expMom2 = expMom * expMom;
+      const float den = kCSPEED * expMom;
+      for (const int& id : mIds) {
+        const float expTime = static_cast<float>(length * sqrt(mMassZ[id] * mMassZ[id] + expMom2) / den) + timeShift;
+        mExpSignal[id][index] = expTime;
+        mDelta[id][index] = deltaT - expTime;
+      }
+    } else {
+      for (const int& id : mIds) {
+        mExpSignal[id][index] = defaultReturnValue;
+      }
+    }
+
+    // Expected resolutions, sharing the momentum terms
+    const float mom = track.p();
+    if (mom <= 0) {
+      for (const int& id : mIds) {
+        mExpSigma[id][index] = -999.f;
+      }
+      return;
+    }
+    const float timeReso2 = parameters[4] * parameters[4];
+    const float evTimeErr2 = evTimeErr * evTimeErr;
+    const float mom2 = mom * mom;
+    for (const int& id : mIds) {
+      // Pion parameters are used up to the pion mass, then kaon and proton parameters
+      const int offset = id <= o2::track::PID::Pion ? 0 : (id == o2::track::PID::Kaon ? 5 : 9);
+      const float dpp = parameters[offset] + parameters[offset + 1] * mom + parameters[offset + 2] * mMassZ[id] / mom; // mean relative pt resolution;
+      const float sigma = dpp * tofSignal / (1. + mom2 / (mMassZ[id] * mMassZ[id]));
+      mExpSigma[id][index] = std::sqrt(sigma * sigma + parameters[offset + 3] * parameters[offset + 3] / mom / mom + timeReso2 + evTimeErr2);
+    }
+  }
+
+  /// Computes the response for all the requested mass hypotheses for a contiguous block of tracks
+  /// \param parameters Detector response parameters
+  /// \param tracks Tracks of the block
+  /// \param ids mass hypotheses to compute
+  template <typename TrackTableType>
+  void compute(const TOFResoParamsV2& parameters, const TrackTableType& tracks, const std::vector<int>& ids)
+  {
+    reset(tracks.size(), ids);
+    int64_t index = 0;
+    for (const auto& track : tracks) {
+      computeTrack(parameters, track, index++);
+    }
+  }
+
+  /// Gets the expected signal of a track of the block, equivalent to ExpTimes::GetCorrectedExpectedSignal
+  float getExpectedSignal(const int id, const int64_t index) const { return mExpSignal[id][index]; }
+
+  /// Gets the expected resolution of a track of the block, equivalent to ExpTimes::GetExpectedSigma
+  float getExpectedSigma(const int id, const int64_t index) const { return mExpSigma[id][index]; }
+
+  /// Gets the number of sigmas of a track of the block with respect to the expected time
+  /// \param resolution resolution to normalise the separation
+  float getSeparation(const int id, const int64_t index, const float resolution) const { return mHasTOF[index] ? mDelta[id][index] / resolution : defaultReturnValue; }
+
+  /// Gets the number of sigmas of a track of the block with respect to the expected time, normalised to the event time resolution as in ExpTimes::GetSeparation
+  float getSeparation(const int id, const int64_t index) const { return getSeparation(id, index, mEvTimeErr[index]); }
+
+  /// Gets the number of sigmas of a track of the block with respect to the expected time, normalised to the expected resolution
+  float getSeparationExpectedSigma(const int id, const int64_t index) const { return getSeparation(id, index, mExpSigma[id][index]); }
+
+ private:
+  std::vector<int> mIds;                               /// Mass hypotheses computed
+  std::array<std::vector<float>, nSpecies> mExpSignal; /// Expected signal per hypothesis
+  std::array<std::vector<float>, nSpecies> mExpSigma;  /// Expected resolution per hypothesis
+  std::array<std::vector<float>, nSpecies> mDelta;     /// t - t0 - texp per hypothesis
+  std::vector<bool> mHasTOF;                           /// Whether the track has a TOF measurement and a collision
+  std::vector<float> mEvTimeErr;                       /// Event time resolution per track
+};
+
 /// \brief Class to convert the trackTime to the tofSignal used for PID
 template <typename TrackType>
 class TOFSignal
@@ -17,6 +17,7 @@
 #ifndef COMMON_CORE_PID_TPCPIDRESPONSE_H_
 #define COMMON_CORE_PID_TPCPIDRESPONSE_H_
 
+#include <algorithm>
 #include <array>
 #include <vector>
 #include <cmath>
@@ -39,7 +40,11 @@ class Response
   ~Response() = default;
 
   /// Setter and Getter for the private parameters
-  void SetBetheBlochParams(const std::array<float, 5>& betheBlochParams) { mBetheBlochParams = betheBlochParams; }
+  void SetBetheBlochParams(const std::array<float, 5>& betheBlochParams)
+  {
+    mBetheBlochParams = betheBlochParams;
+    UpdateBetheBlochLUT();
+  }
   void SetResolutionParamsDefault(const std::array<float, 2>& resolutionParamsDefault) { mResolutionParamsDefault = resolutionParamsDefault; }
   void SetResolutionParams(const std::vector<double>& resolutionParams) { mResolutionParams = resolutionParams; }
   void SetMIP(const float mip) { mMIP = mip; }
@@ -57,8 +62,29 @@ class Response
     mChargeFactor = response->GetChargeFactor();
     mMultNormalization = response->GetMultiplicityNormalization();
     mUseDefaultResolutionParam = response->GetUseDefaultResolutionParam();
+    UpdateBetheBlochLUT();
   }
 
+  /// Enables the evaluation of the Bethe-Bloch parametrization from a lookup table in log(betagamma) with linear interpolation.
+  /// The table is (re)built every time the Bethe-Bloch parameters change and is validated against the analytic parametrization:
+  /// if the maximum relative deviation exceeds the tolerance the analytic parametrization is used instead.
+  /// Values of betagamma outside of the table range are always evaluated analytically.
+  /// \param nBins number of intervals of the table, 0 disables the table
+  /// \param tolerance maximum relative deviation allowed with respect to the analytic parametrization
+  /// \param bgMin lower edge of the table in betagamma
+  /// \param bgMax upper edge of the table in betagamma
+  void EnableBetheBlochLUT(const int nBins, const float tolerance = 1.e-4f, const float bgMin = 0.05f, const float bgMax = 1.e4f)
+  {
+    mLUTNBins = nBins;
+    mLUTTolerance = tolerance;
+    mLUTLogBgMin = std::log(bgMin);
+    mLUTLogBgMax = std::log(bgMax);
+    mLUTParams.fill(0.f);
+    mBetheBlochLUT.clear();
+    UpdateBetheBlochLUT();
+  }
+  const bool IsBetheBlochLUTActive() const { return !mBetheBlochLUT.empty(); }
+
   const std::array<float, 5> GetBetheBlochParams() const { return mBetheBlochParams; }
   const std::array<float, 2> GetResolutionParamsDefault() const { return mResolutionParamsDefault; }
   const std::vector<double> GetResolutionParams() const { return mResolutionParams; }
@@ -82,6 +108,10 @@ class Response
   float GetSignalDelta(const TrackType& trk, const o2::track::PID::ID id) const;
   /// Gets relative dEdx resolution contribution due to relative pt resolution
   float GetRelativeResolutiondEdx(const float p, const float mass, const float charge, const float resol) const;
+  /// Gets the Bethe-Bloch parametrization for a given betagamma, from the lookup table if enabled
+  float GetBetheBloch(const float bg) const;
+  /// Gets the maximum relative deviation of the lookup table from the analytic Bethe-Bloch parametrization
+  float ValidateBetheBlochLUT(const int nPoints = 4) const;
 
   void PrintAll() const;
 
@@ -95,6 +125,18 @@ class Response
   bool mUseDefaultResolutionParam = true;
   float nClNorm = 152.f;
 
+  // Bethe-Bloch lookup table, not persistent
+  int mLUTNBins = 0;                       //! Number of intervals of the lookup table, 0 means disabled
+  float mLUTTolerance = 1.e-4f;            //! Maximum relative deviation accepted when validating the lookup table
+  float mLUTLogBgMin = 0.f;                //! Lower edge of the lookup table in log(betagamma)
+  float mLUTLogBgMax = 0.f;                //! Upper edge of the lookup table in log(betagamma)
+  float mLUTInvStep = 0.f;                 //! Inverse of the interval width in log(betagamma)
+  std::array<float, 5> mLUTParams = {};    //! Bethe-Bloch parameters used to build the lookup table
+  std::vector<float> mBetheBlochLUT;       //! Values of the Bethe-Bloch at the nodes of the lookup table
+
+  /// Builds the lookup table if enabled and not built for the current Bethe-Bloch parameters
+  void UpdateBetheBlochLUT();
+
   ClassDefNV(Response, 3);
 
 }; // class Response
@@ -106,7 +148,7 @@ inline float Response::GetExpectedSignal(const TrackType& track, const o2::track
   if (!track.hasTPC()) {
     return -999.f;
   }
-  const float bethe = mMIP * o2::tpc::BetheBlochAleph(track.tpcInnerParam() / o2::track::pid_constants::sMasses[id], mBetheBlochParams[0], mBetheBlochParams[1], mBetheBlochParams[2], mBetheBlochParams[3], mBetheBlochParams[4]) * std::pow(static_cast<float>(o2::track::pid_constants::sCharges[id]), mChargeFactor);
+  const float bethe = mMIP * GetBetheBloch(track.tpcInnerParam() / o2::track::pid_constants::sMasses[id]) * std::pow(static_cast<float>(o2::track::pid_constants::sCharges[id]), mChargeFactor);
   return bethe >= 0.f ? bethe : -999.f;
 }
 
@@ -127,7 +169,7 @@ inline float Response::GetExpectedSigma(const CollisionType& collision, const Tr
     const double p = track.tpcInnerParam();
     const double mass = o2::track::pid_constants::sMasses[id];
     const double bg = p / mass;
-    const double dEdx = o2::tpc::BetheBlochAleph(static_cast<float>(bg), mBetheBlochParams[0], mBetheBlochParams[1], mBetheBlochParams[2], mBetheBlochParams[3], mBetheBlochParams[4]) * std::pow(static_cast<float>(o2::track::pid_constants::sCharges[id]), mChargeFactor);
+    const double dEdx = GetBetheBloch(static_cast<float>(bg)) * std::pow(static_cast<float>(o2::track::pid_constants::sCharges[id]), mChargeFactor);
     const double relReso = GetRelativeResolutiondEdx(p, mass, o2::track::pid_constants::sCharges[id], mResolutionParams[3]);
 
     const std::vector<double> values{1.f / dEdx, track.tgl(), std::sqrt(ncl), relReso, track.signed1Pt(), collision.multTPC() / mMultNormalization};
@@ -171,14 +213,75 @@ inline float Response::GetSignalDelta(const TrackType& trk, const o2::track::PID
 inline float Response::GetRelativeResolutiondEdx(const float p, const float mass, const float charge, const float resol) const
 {
   const float bg = p / mass;
-  const float dEdx = o2::tpc::BetheBlochAleph(bg, mBetheBlochParams[0], mBetheBlochParams[1], mBetheBlochParams[2], mBetheBlochParams[3], mBetheBlochParams[4]) * std::pow(charge, mChargeFactor);
+  const float dEdx = GetBetheBloch(bg) * std::pow(charge, mChargeFactor);
   const float deltaP = resol * std::sqrt(dEdx);
   const float bgDelta = p * (1 + deltaP) / mass;
-  const float dEdx2 = o2::tpc::BetheBlochAleph(bgDelta, mBetheBlochParams[0], mBetheBlochParams[1], mBetheBlochParams[2], mBetheBlochParams[3], mBetheBlochParams[4]) * std::pow(charge, mChargeFactor);
+  const float dEdx2 = GetBetheBloch(bgDelta) * std::pow(charge, mChargeFactor);
   const float deltaRel = std::abs(dEdx2 - dEdx) / dEdx;
   return deltaRel;
 }
 
+/// Gets the Bethe-Bloch parametrization, interpolating the lookup table if available and betagamma is inside its range
+inline float Response::GetBetheBloch(const float bg) const
+{
+  if (!mBetheBlochLUT.empty() && bg > 0.f) {
+    const float x = (std::log(bg) - mLUTLogBgMin) * mLUTInvStep;
+    if (x >= 0.f && x < mLUTNBins) {
+      const int bin = static_cast<int>(x);
+      const float frac = x - bin;
+      return mBetheBlochLUT[bin] + frac * (mBetheBlochLUT[bin + 1] - mBetheBlochLUT[bin]);
+    }
+  }
+  return o2::tpc::BetheBlochAleph(bg, mBetheBlochParams[0], mBetheBlochParams[1], mBetheBlochParams[2], mBetheBlochParams[3], mBetheBlochParams[4]);
+}
+
+/// Gets the maximum relative deviation of the lookup table from the analytic parametrization, evaluated at nPoints points inside each interval
+inline float Response::ValidateBetheBlochLUT(const int nPoints) const
+{
+  if (mBetheBlochLUT.empty()) {
+    return 0.f;
+  }
+  const float step = 1.f / mLUTInvStep;
+  float maxDeviation = 0.f;
+  for (int bin = 0; bin < mLUTNBins; bin++) {
+    for (int i = 1; i <= nPoints; i++) {
+      const float bg = std::exp(mLUTLogBgMin + (bin + static_cast<float>(i) / (nPoints + 1)) * step);
+      const float analytic = o2::tpc::BetheBlochAleph(bg, mBetheBlochParams[0], mBetheBlochParams[1], mBetheBlochParams[2], mBetheBlochParams[3], mBetheBlochParams[4]);
+      if (analytic == 0.f) {
+        continue;
+      }
+      maxDeviation = std::max(maxDeviation, std::abs(GetBetheBloch(bg) / analytic - 1.f));
+    }
+  }
+  return maxDeviation;
+}
+
+inline void Response::UpdateBetheBlochLUT()
+{
+  if (mLUTNBins <= 0) {
+    mBetheBlochLUT.clear();
+    return;
+  }
+  if (mLUTParams == mBetheBlochParams) { // Table already built (or rejected) for these parameters
+    return;
+  }
+  mLUTParams = mBetheBlochParams;
+  mLUTInvStep = mLUTNBins / (mLUTLogBgMax - mLUTLogBgMin);
+  std::vector<float> lut(mLUTNBins + 1);
+  for (int i = 0; i <= mLUTNBins; i++) {
+    const float bg = std::exp(mLUTLogBgMin + i / mLUTInvStep);
+    lut[i] = o2::tpc::BetheBlochAleph(bg, mBetheBlochParams[0], mBetheBlochParams[1], mBetheBlochParams[2], mBetheBlochParams[3], mBetheBlochParams[4]);
+  }
+  mBetheBlochLUT.swap(lut);
+  const float deviation = ValidateBetheBlochLUT();
+  if (deviation > mLUTTolerance) {
+    LOGP(warning, "Bethe-Bloch lookup table with {} intervals deviates by {} from the analytic parametrization (tolerance {}), using the analytic parametrization", mLUTNBins, deviation, mLUTTolerance);
+    mBetheBlochLUT.clear();
+    return;
+  }
+  LOGP(info, "Built Bethe-Bloch lookup table with {} intervals in betagamma [{}, {}], maximum relative deviation {}", mLUTNBins, std::exp(mLUTLogBgMin), std::exp(mLUTLogBgMax), deviation);
+}
+
 inline void Response::PrintAll() const
 {
   LOGP(info, "==== TPC PID response parameters: ====");
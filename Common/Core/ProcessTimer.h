@@ -0,0 +1,138 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file ProcessTimer.h
+/// \brief Timing instrumentation of the process functions of the tasks
+///
+/// A ProcessTimer books its histograms in the ProcessTiming/<name> directory of the registry of the task and a
+/// ScopedTimer fills them at the end of its scope, typically the body of a process function called once per data frame:
+/// the wall time of the call, the time per processed row if the number of rows is given, and the net growth of the heap
+/// during the call. The instrumentation is compiled only with O2PHYSICS_PROCESS_TIMING defined (cmake option
+/// ENABLE_PROCESS_TIMING), otherwise both classes are empty and no histogram is booked.
+
+#ifndef COMMON_CORE_PROCESSTIMER_H_
+#define COMMON_CORE_PROCESSTIMER_H_
+
+#include <cstdint>
+#include <string>
+
+#ifdef O2PHYSICS_PROCESS_TIMING
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <vector>
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+#define O2PHYSICS_PROCESS_TIMING_HEAP
+#endif
+
+#include <TH1.h>
+#endif
+
+#include "Framework/HistogramRegistry.h"
+
+namespace o2::common
+{
+
+class ProcessTimer
+{
+ public:
+  /// Books the histograms of the timer
+  /// \param name is the name of the directory of the histograms, e.g. the name of the process function
+  void init([[maybe_unused]] o2::framework::HistogramRegistry& registry, [[maybe_unused]] std::string const& name)
+  {
+#ifdef O2PHYSICS_PROCESS_TIMING
+    using o2::framework::AxisSpec;
+    using o2::framework::HistType;
+    // logarithmic binning, 10 bins per decade
+    auto logAxis = [](int decadeMin, int decadeMax, std::string const& title) {
+      std::vector<double> edges;
+      for (int i = 10 * decadeMin; i <= 10 * decadeMax; i++) {
+        edges.push_back(std::pow(10., 0.1 * i));
+      }
+      return AxisSpec{edges, title};
+    };
+    const std::string dir = "ProcessTiming/" + name + "/";
+    mTime = std::get<std::shared_ptr<TH1>>(registry.add((dir + "hTime").c_str(), "wall time per call;#it{t} (#mus);entries", HistType::kTH1F, {logAxis(0, 8, "#it{t} (#mus)")}));
+    mTimePerRow = std::get<std::shared_ptr<TH1>>(registry.add((dir + "hTimePerRow").c_str(), "wall time per processed row;#it{t} / row (ns);entries", HistType::kTH1F, {logAxis(0, 7, "#it{t} / row (ns)")}));
+    mRows = std::get<std::shared_ptr<TH1>>(registry.add((dir + "hRows").c_str(), "processed rows per call;rows;entries", HistType::kTH1F, {logAxis(0, 7, "rows")}));
+#ifdef O2PHYSICS_PROCESS_TIMING_HEAP
+    mHeap = std::get<std::shared_ptr<TH1>>(registry.add((dir + "hHeapGrowth").c_str(), "net heap growth per call;#Delta heap (MB);entries", HistType::kTH1F, {{400, -200., 200., "#Delta heap (MB)"}}));
+#endif
+#endif
+  }
+
+#ifdef O2PHYSICS_PROCESS_TIMING
+  void fill(double microseconds, int64_t rows, double heapGrowth)
+  {
+    if (!mTime) {
+      return;
+    }
+    mTime->Fill(microseconds);
+    if (rows > 0) {
+      mRows->Fill(rows);
+      mTimePerRow->Fill(1.e3 * microseconds / rows);
+    }
+    if (mHeap) {
+      mHeap->Fill(heapGrowth / (1024. * 1024.));
+    }
+  }
+
+ private:
+  std::shared_ptr<TH1> mTime{};
+  std::shared_ptr<TH1> mTimePerRow{};
+  std::shared_ptr<TH1> mRows{};
+  std::shared_ptr<TH1> mHeap{};
+#endif
+};
+
+/// Measures its lifetime and fills it in a ProcessTimer at its destruction
+class ScopedTimer
+{
+ public:
+  /// \param rows is the number of rows processed in the scope, e.g. the size of the main input table, 0 if not relevant
+  explicit ScopedTimer([[maybe_unused]] ProcessTimer& timer, [[maybe_unused]] int64_t rows = 0)
+#ifdef O2PHYSICS_PROCESS_TIMING
+    : mTimer(timer), mRows(rows), mHeapStart(heapInUse()), mStart(std::chrono::steady_clock::now())
+#endif
+  {
+  }
+  ScopedTimer(ScopedTimer const&) = delete;
+  ScopedTimer& operator=(ScopedTimer const&) = delete;
+
+#ifdef O2PHYSICS_PROCESS_TIMING
+  ~ScopedTimer()
+  {
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - mStart;
+    mTimer.fill(elapsed.count(), mRows, heapInUse() - mHeapStart);
+  }
+
+ private:
+  static double heapInUse()
+  {
+#ifdef O2PHYSICS_PROCESS_TIMING_HEAP
+    auto info = mallinfo2();
+    return static_cast<double>(info.uordblks) + static_cast<double>(info.hblkhd);
+#else
+    return 0.;
+#endif
+  }
+
+  ProcessTimer& mTimer;
+  int64_t mRows;
+  double mHeapStart;
+  std::chrono::steady_clock::time_point mStart;
+#endif
+};
+
+} // namespace o2::common
+
+#endif // COMMON_CORE_PROCESSTIMER_H_
@@ -0,0 +1,122 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file PropagatorServices.h
+/// \brief Material budget LUT and magnetic field of the propagator, shared by the tasks of a process
+///
+/// The material LUT is read from CCDB and rectified once per process and path, whatever the number of tasks and
+/// process functions asking for it, and the magnetic field of the propagator is set from the GRP once per run:
+/// the GRP objects are not fetched again and the field is not set up again when the run does not change.
+
+#ifndef COMMON_CORE_PROPAGATORSERVICES_H_
+#define COMMON_CORE_PROPAGATORSERVICES_H_
+
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "CCDB/BasicCCDBManager.h"
+#include "DataFormatsParameters/GRPMagField.h"
+#include "DataFormatsParameters/GRPObject.h"
+#include "DetectorsBase/MatLayerCylSet.h"
+#include "DetectorsBase/Propagator.h"
+#include "Framework/Logger.h"
+
+namespace o2::common::propagator
+{
+
+namespace detail
+{
+/// State of the propagator of the process
+struct PropagatorState {
+  std::mutex mutex;
+  std::map<std::string, o2::base::MatLayerCylSet*> luts; ///< rectified LUTs, by CCDB path
+  int runNumber = -1;                                      ///< run for which the field has been set
+  bool isRun2 = false;                                     ///< type of GRP object of the field
+  o2::base::MatLayerCylSet* lut = nullptr;                 ///< LUT given to the propagator
+  o2::parameters::GRPObject* grpo = nullptr;               ///< GRP of the run, for Run 2
+  o2::parameters::GRPMagField* grpmag = nullptr;           ///< GRP of the magnetic field of the run, for Run 3
+};
+
+inline PropagatorState& state()
+{
+  static PropagatorState instance;
+  return instance;
+}
+} // namespace detail
+
+/// Material budget LUT, fetched from CCDB and rectified only at the first call for a given path
+/// \param ccdb is the CCDB manager of the task, the object stays owned by its cache
+/// \param path is the CCDB path of the LUT
+template <typename TCcdb>
+o2::base::MatLayerCylSet* getMatLut(TCcdb const& ccdb, std::string const& path)
+{
+  auto& st = detail::state();
+  std::lock_guard<std::mutex> lock(st.mutex);
+  auto& lut = st.luts[path];
+  if (lut == nullptr) {
+    LOGP(info, "Loading the material LUT from {}", path);
+    lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->template get<o2::base::MatLayerCylSet>(path));
+  }
+  return lut;
+}
+
+/// Sets the magnetic field of the propagator from the GRP of the run, and its material LUT
+/// The GRP is fetched and the field set up only when the run or the LUT change with respect to the previous call of any task.
+/// \param ccdb is the CCDB manager of the task
+/// \param pathGrp is the CCDB path of the GRPObject, for Run 2, or of the GRPMagField, for Run 3
+/// \param runNumber is the run of the bunch crossing
+/// \param timestamp is the timestamp of the bunch crossing
+/// \param lut is the material LUT to use, nullptr for none
+/// \param isRun2 tells whether the GRP object is a GRPObject (Run 2) or a GRPMagField (Run 3)
+/// \return the nominal Bz of the propagator, in kG
+template <typename TCcdb>
+float setMagField(TCcdb const& ccdb, std::string const& pathGrp, int runNumber, uint64_t timestamp, o2::base::MatLayerCylSet* lut, bool isRun2)
+{
+  auto& st = detail::state();
+  std::lock_guard<std::mutex> lock(st.mutex);
+  if (st.runNumber == runNumber && st.isRun2 == isRun2 && st.lut == lut) {
+    return o2::base::Propagator::Instance()->getNominalBz();
+  }
+  if (st.runNumber != runNumber || st.isRun2 != isRun2) {
+    if (isRun2) {
+      st.grpo = ccdb->template getForTimeStamp<o2::parameters::GRPObject>(pathGrp, timestamp);
+      if (st.grpo == nullptr) {
+        LOGF(fatal, "Run 2 GRP object (type o2::parameters::GRPObject) is not available in CCDB for run=%d at timestamp=%llu", runNumber, timestamp);
+      }
+      o2::base::Propagator::initFieldFromGRP(st.grpo);
+      LOGF(info, "Setting magnetic field to %d kG for run %d from its GRP CCDB object (type o2::parameters::GRPObject)", st.grpo->getNominalL3Field(), runNumber);
+    } else {
+      st.grpmag = ccdb->template getForTimeStamp<o2::parameters::GRPMagField>(pathGrp, timestamp);
+      if (st.grpmag == nullptr) {
+        LOGF(fatal, "Run 3 GRP object (type o2::parameters::GRPMagField) is not available in CCDB for run=%d at timestamp=%llu", runNumber, timestamp);
+      }
+      o2::base::Propagator::initFieldFromGRP(st.grpmag);
+      LOGF(info, "Setting magnetic field to current %f A for run %d from its GRP CCDB object (type o2::parameters::GRPMagField)", st.grpmag->getL3Current(), runNumber);
+    }
+    st.runNumber = runNumber;
+    st.isRun2 = isRun2;
+  }
+  // setMatLUT only after the field has been initialised, it would otherwise set up a field on its own
+  o2::base::Propagator::Instance()->setMatLUT(lut);
+  st.lut = lut;
+  return o2::base::Propagator::Instance()->getNominalBz();
+}
+
+/// \return the GRPMagField of the run of the last call of setMagField(), nullptr for Run 2
+inline o2::parameters::GRPMagField* getGrpMagField()
+{
+  return detail::state().grpmag;
+}
+
+} // namespace o2::common::propagator
+
+#endif // COMMON_CORE_PROPAGATORSERVICES_H_
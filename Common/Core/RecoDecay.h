@@ -17,13 +17,18 @@
 #ifndef COMMON_CORE_RECODECAY_H_
 #define COMMON_CORE_RECODECAY_H_
 
+#include <algorithm>
 #include <tuple>
 #include <vector>
 #include <array>
 #include <cmath>
+#include <span>
+#include <unordered_map>
+#include <mutex>
 #include <utility>
 
 #include <TDatabasePDG.h>
+#include <THashList.h>
 #include <TPDGCode.h>
 
 #include "CommonConstants/MathConstants.h"
@@ -452,6 +457,125 @@ class RecoDecay
     return std::sqrt(m2(args...));
   }
 
+  // Batched (structure-of-arrays) calculation of kinematic and topological quantities
+  //
+  // The following functions process a whole block of candidates in one call.
+  // Inputs are provided as spans of components (one span per quantity and prong), outputs are written in the result span.
+  // All input spans must have at least the size of the result span.
+  // The loop bodies are free of branches and function calls so that the compiler can auto-vectorise them.
+
+  /// Calculates transverse momenta of a block of candidates.
+  /// \param px,py  spans of {x, y} momentum components
+  /// \param result  span of transverse momenta
+  template <typename T>
+  static void ptBatch(std::span<const T> px, std::span<const T> py, std::span<double> result)
+  {
+    const auto n = result.size();
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto x = static_cast<double>(px[i]);
+      const auto y = static_cast<double>(py[i]);
+      result[i] = std::sqrt(x * x + y * y);
+    }
+  }
+
+  /// Calculates invariant masses squared of a block of candidates from momenta and masses of their prongs.
+  /// \param N  number of prongs
+  /// \param arrPx,arrPy,arrPz  arrays of N spans of {x, y, z} momentum components of the prongs
+  /// \param arrMass  array of N masses (in the same order as the momentum spans)
+  /// \param result  span of invariant masses squared
+  template <std::size_t N, typename T, typename U>
+  static void m2Batch(const array<std::span<const T>, N>& arrPx,
+                      const array<std::span<const T>, N>& arrPy,
+                      const array<std::span<const T>, N>& arrPz,
+                      const array<U, N>& arrMass,
+                      std::span<double> result)
+  {
+    array<double, N> arrMass2;
+    for (std::size_t iProng = 0; iProng < N; ++iProng) {
+      arrMass2[iProng] = sq(arrMass[iProng]);
+    }
+    const auto n = result.size();
+    for (std::size_t i = 0; i < n; ++i) {
+      double pxTot{0.}, pyTot{0.}, pzTot{0.}, energyTot{0.};
+      for (std::size_t iProng = 0; iProng < N; ++iProng) {
+        const auto x = static_cast<double>(arrPx[iProng][i]);
+        const auto y = static_cast<double>(arrPy[iProng][i]);
+        const auto z = static_cast<double>(arrPz[iProng][i]);
+        pxTot += x;
+        pyTot += y;
+        pzTot += z;
+        energyTot += std::sqrt(x * x + y * y + z * z + arrMass2[iProng]);
+      } // loop over prongs
+      result[i] = energyTot * energyTot - (pxTot * pxTot + pyTot * pyTot + pzTot * pzTot);
+    }
+  }
+
+  /// Calculates invariant masses of a block of candidates from momenta and masses of their prongs.
+  /// \note Negative values of the invariant mass squared (numerical precision) result in NaN as in m.
+  /// \param N  number of prongs
+  /// \param arrPx,arrPy,arrPz  arrays of N spans of {x, y, z} momentum components of the prongs
+  /// \param arrMass  array of N masses (in the same order as the momentum spans)
+  /// \param result  span of invariant masses
+  template <std::size_t N, typename T, typename U>
+  static void mBatch(const array<std::span<const T>, N>& arrPx,
+                     const array<std::span<const T>, N>& arrPy,
+                     const array<std::span<const T>, N>& arrPz,
+                     const array<U, N>& arrMass,
+                     std::span<double> result)
+  {
+    m2Batch(arrPx, arrPy, arrPz, arrMass, result);
+    for (auto& value : result) {
+      value = std::sqrt(value);
+    }
+  }
+
+  /// Calculates cosines of pointing angle of a block of candidates originating from the same primary vertex.
+  /// \param posPV  {x, y, z} position of the primary vertex
+  /// \param xSV,ySV,zSV  spans of {x, y, z} positions of the secondary vertices
+  /// \param px,py,pz  spans of {x, y, z} candidate momentum components
+  /// \param result  span of cosines of pointing angle
+  template <typename T, typename U, typename V>
+  static void cpaBatch(const T& posPV,
+                       std::span<const U> xSV, std::span<const U> ySV, std::span<const U> zSV,
+                       std::span<const V> px, std::span<const V> py, std::span<const V> pz,
+                       std::span<double> result)
+  {
+    const auto xPV = static_cast<double>(posPV[0]);
+    const auto yPV = static_cast<double>(posPV[1]);
+    const auto zPV = static_cast<double>(posPV[2]);
+    const auto n = result.size();
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto lx = static_cast<double>(xSV[i]) - xPV;
+      const auto ly = static_cast<double>(ySV[i]) - yPV;
+      const auto lz = static_cast<double>(zSV[i]) - zPV;
+      const auto x = static_cast<double>(px[i]);
+      const auto y = static_cast<double>(py[i]);
+      const auto z = static_cast<double>(pz[i]);
+      const auto cos = (lx * x + ly * y + lz * z) / std::sqrt((lx * lx + ly * ly + lz * lz) * (x * x + y * y + z * z));
+      result[i] = std::clamp(cos, -1., 1.);
+    }
+  }
+
+  /// Calculates proper lifetimes times c of a block of candidates.
+  /// \param px,py,pz  spans of {x, y, z} candidate momentum components
+  /// \param length  span of decay lengths
+  /// \param mass  mass
+  /// \param result  span of proper lifetimes times c
+  template <typename T, typename U, typename V>
+  static void ctBatch(std::span<const T> px, std::span<const T> py, std::span<const T> pz,
+                      std::span<const U> length, V mass,
+                      std::span<double> result)
+  {
+    const auto massD = static_cast<double>(mass);
+    const auto n = result.size();
+    for (std::size_t i = 0; i < n; ++i) {
+      const auto x = static_cast<double>(px[i]);
+      const auto y = static_cast<double>(py[i]);
+      const auto z = static_cast<double>(pz[i]);
+      result[i] = static_cast<double>(length[i]) * massD / std::sqrt(x * x + y * y + z * z);
+    }
+  }
+
   // Calculation of topological quantities
 
   /// Calculates impact parameter in the bending plane of the particle w.r.t. a point
@@ -523,51 +647,40 @@ class RecoDecay
   }
 
   /// Adds particle mass in the list.
+  /// \note Masses already present in the table are not overwritten.
   /// \param pdg  PDG code
   /// \param mass  particle mass
   static void addMassPDG(int pdg, double mass)
   {
-    mListMass.push_back(std::make_tuple(pdg, mass));
+    std::lock_guard<std::mutex> lock(mMutexMassExtra);
+    mListMassExtra.emplace(pdg, mass);
   }
 
   /// Returns particle mass based on PDG code.
+  /// \note The mass table is built once from TDatabasePDG on the first call (see buildMassTablePDG) and is read-only afterwards,
+  /// so that the lookup is O(1) and safe to use from several threads.
+  /// Only PDG codes unknown at the time of the initialisation are looked up in TDatabasePDG (under lock) and cached separately.
   /// \param pdg  PDG code
   /// \return particle mass
   static double getMassPDG(int pdg)
   {
-    // Try to get the particle mass from the list first.
-    for (const auto& particle : mListMass) {
-      if (std::get<0>(particle) == pdg) {
-        return std::get<1>(particle);
-      }
+    // Try to get the particle mass from the table first.
+    static const std::unordered_map<int, double> tableMass = buildMassTablePDG();
+    if (const auto it = tableMass.find(pdg); it != tableMass.end()) {
+      return it->second;
     }
-    // Get the mass of the new particle and add it in the list.
-    double mass = 0.;
-    switch (pdg) {
-      // Particles that cannot be taken from ROOT ($ROOTSYS/etc/pdg_table.txt)
-      case 4422: {      // Ξcc (wrong mass in ROOT)
-        mass = 3.62155; // https://pdg.lbl.gov/ (2021)
-        break;
-      }
-      case 9920443: {   // χc1 aka X(3872)
-        mass = 3.87165; // https://pdg.lbl.gov/ (2021)
-        break;
-      }
-      case 4332: {     // Ω0c (wrong mass in ROOT)
-        mass = 2.6952; // https://pdg.lbl.gov/ (2022)
-        break;
-      }
-      // Take the rest from ROOT.
-      default: {
-        const TParticlePDG* particle = TDatabasePDG::Instance()->GetParticle(pdg);
-        if (!particle) { // Check that it's there.
-          LOGF(fatal, "Cannot find particle mass for PDG code %i", pdg);
-          return 999.;
-        }
-        mass = particle->Mass();
-      }
+    // Particle not known at initialisation: get its mass from the list of additional particles or from ROOT.
+    std::lock_guard<std::mutex> lock(mMutexMassExtra);
+    if (const auto it = mListMassExtra.find(pdg); it != mListMassExtra.end()) {
+      return it->second;
+    }
+    const TParticlePDG* particle = TDatabasePDG::Instance()->GetParticle(pdg);
+    if (!particle) { // Check that it's there.
+      LOGF(fatal, "Cannot find particle mass for PDG code %i", pdg);
+      return 999.;
     }
-    addMassPDG(pdg, mass);
+    double mass = particle->Mass();
+    mListMassExtra.emplace(pdg, mass);
     return mass;
   }
 
@@ -999,9 +1112,36 @@ class RecoDecay
   }
 
  private:
-  static std::vector<std::tuple<int, double>> mListMass; ///< list of particle masses in form (PDG code, mass)
-};
+  /// Particles that cannot be taken from ROOT ($ROOTSYS/etc/pdg_table.txt) in form (PDG code, mass)
+  /// \note Applied to antiparticles as well.
+  static constexpr std::array<std::pair<int, double>, 3> mListMassOverride{{
+    {4422, 3.62155},    // Ξcc (wrong mass in ROOT), https://pdg.lbl.gov/ (2021)
+    {9920443, 3.87165}, // χc1 aka X(3872), https://pdg.lbl.gov/ (2021)
+    {4332, 2.6952}      // Ω0c (wrong mass in ROOT), https://pdg.lbl.gov/ (2022)
+  }};
+
+  /// Builds the table of particle masses from all particles known to TDatabasePDG and from mListMassOverride.
+  /// \return hash table of particle masses in form (PDG code, mass)
+  static std::unordered_map<int, double> buildMassTablePDG()
+  {
+    std::unordered_map<int, double> table;
+    if (const auto* listParticles = TDatabasePDG::Instance()->ParticleList()) {
+      table.reserve(listParticles->GetSize() + 2 * mListMassOverride.size());
+      for (const auto* obj : *listParticles) {
+        if (const auto* particle = dynamic_cast<const TParticlePDG*>(obj)) {
+          table.emplace(particle->PdgCode(), particle->Mass());
+        }
+      }
+    }
+    for (const auto& [pdg, mass] : mListMassOverride) {
+      table[pdg] = mass;
+      table[-pdg] = mass;
+    }
+    return table;
+  }
 
-std::vector<std::tuple<int, double>> RecoDecay::mListMass;
+  static inline std::unordered_map<int, double> mListMassExtra{}; ///< particle masses unknown at initialisation of the table in form (PDG code, mass)
+  static inline std::mutex mMutexMassExtra{};                     ///< mutex protecting mListMassExtra
+};
 
 #endif // COMMON_CORE_RECODECAY_H_
@@ -19,6 +19,10 @@
 #define COMMON_CORE_TABLEHELPER_H_
 
 #include <string>
+#include <vector>
+
+#include <arrow/array.h>
+#include <arrow/table.h>
 
 #include "Framework/InitContext.h"
 #include "Framework/RunningWorkflowInfo.h"
@@ -103,4 +107,30 @@ bool getTaskOptionValue(o2::framework::InitContext& initContext, const std::stri
   return false;
 }
 
+/// Gets the values of a stored column of a table as a contiguous array.
+/// If the column is held in a single Arrow chunk the values are read in place (valid as long as the table),
+/// otherwise the chunks are copied into the buffer.
+/// \param table table holding the column
+/// \param buffer buffer used if the column is made of several chunks
+/// \return pointer to the first value of the column
+template <typename ColumnType, typename TableType>
+const typename ColumnType::type* getColumnValues(TableType const& table, std::vector<typename ColumnType::type>& buffer)
+{
+  using ArrayType = arrow::NumericArray<typename arrow::CTypeTraits<typename ColumnType::type>::ArrowType>;
+  const auto column = table.asArrowTable()->GetColumnByName(ColumnType::mLabel);
+  if (column == nullptr) {
+    LOG(fatal) << "Column " << ColumnType::mLabel << " not found in the table";
+  }
+  if (column->num_chunks() == 1) {
+    return std::static_pointer_cast<ArrayType>(column->chunk(0))->raw_values();
+  }
+  buffer.clear();
+  buffer.reserve(column->length());
+  for (auto const& chunk : column->chunks()) {
+    const auto values = std::static_pointer_cast<ArrayType>(chunk)->raw_values();
+    buffer.insert(buffer.end(), values, values + chunk->length());
+  }
+  return buffer.data();
+}
+
 #endif // COMMON_CORE_TABLEHELPER_H_
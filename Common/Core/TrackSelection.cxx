@@ -16,19 +16,19 @@
 #include "Framework/Logger.h"
 #include "Common/Core/TrackSelection.h"
 
-bool TrackSelection::FulfillsITSHitRequirements(uint8_t itsClusterMap) const
+namespace
+{
+// pack the set of ITS layers in a bit pattern, layer 0 corresponding to the least significant bit
+uint8_t getITSLayersMask(const std::set<uint8_t>& layers)
 {
   constexpr uint8_t bit = 1;
-  for (auto& itsRequirement : mRequiredITSHits) {
-    auto hits = std::count_if(itsRequirement.second.begin(), itsRequirement.second.end(), [&](auto&& requiredLayer) { return itsClusterMap & (bit << requiredLayer); });
-    if ((itsRequirement.first == -1) && (hits > 0)) {
-      return false; // no hits were required in specified layers
-    } else if (hits < itsRequirement.first) {
-      return false; // not enough hits found in specified layers
-    }
+  uint8_t mask = 0;
+  for (auto& layer : layers) {
+    mask |= (bit << layer);
   }
-  return true;
+  return mask;
 }
+} // namespace
 
 const std::string TrackSelection::mCutNames[static_cast<int>(TrackSelection::TrackCuts::kNCuts)] = {"TrackType", "PtRange", "EtaRange", "TPCNCls", "TPCCrossedRows", "TPCCrossedRowsOverNCls", "TPCChi2NDF", "TPCRefit", "ITSNCls", "ITSChi2NDF", "ITSRefit", "ITSHits", "GoldenChi2", "DCAxy", "DCAz"};
 
@@ -115,11 +115,13 @@ void TrackSelection::SetRequireHitsInITSLayers(int8_t minNRequiredHits, std::set
 {
   // layer 0 corresponds to the the innermost ITS layer
   mRequiredITSHits.push_back(std::make_pair(minNRequiredHits, requiredLayers));
+  mRequiredITSHitsMask.push_back(std::make_pair(minNRequiredHits, getITSLayersMask(requiredLayers)));
   LOG(info) << "Track selection, set require hits in ITS layers: " << static_cast<int>(minNRequiredHits);
 }
 void TrackSelection::SetRequireNoHitsInITSLayers(std::set<uint8_t> excludedLayers)
 {
   mRequiredITSHits.push_back(std::make_pair(-1, excludedLayers));
+  mRequiredITSHitsMask.push_back(std::make_pair(-1, getITSLayersMask(excludedLayers)));
   LOG(info) << "Track selection, set require no hits in ITS layers";
 }
 
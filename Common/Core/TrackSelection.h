@@ -16,6 +16,7 @@
 #ifndef COMMON_CORE_TRACKSELECTION_H_
 #define COMMON_CORE_TRACKSELECTION_H_
 
+#include <bit>
 #include <set>
 #include <vector>
 #include <utility>
@@ -147,6 +148,53 @@ class TrackSelection
     return flag;
   }
 
+  // Evaluate the selection mask of all tracks of a table. The cuts are evaluated one at a time for the whole table,
+  // so that each pass only reads the columns needed for one cut. The results are identical to IsSelectedMask(track).
+  template <typename T>
+  void IsSelectedMask(T const& tracks, std::vector<uint16_t>& masks) const
+  {
+    masks.assign(tracks.size(), 0);
+
+    auto setFlags = [&](const TrackCuts& cut) {
+      const uint16_t bit = 1UL << static_cast<int>(cut);
+      auto mask = masks.begin();
+      for (auto const& track : tracks) {
+        *mask++ |= IsSelected(track, cut) ? bit : 0;
+      }
+    };
+
+    setFlags(TrackCuts::kTrackType);
+    setFlags(TrackCuts::kPtRange);
+    setFlags(TrackCuts::kEtaRange);
+    setFlags(TrackCuts::kTPCNCls);
+    setFlags(TrackCuts::kTPCCrossedRows);
+    setFlags(TrackCuts::kTPCCrossedRowsOverNCls);
+    setFlags(TrackCuts::kTPCChi2NDF);
+    setFlags(TrackCuts::kTPCRefit);
+    setFlags(TrackCuts::kITSNCls);
+    setFlags(TrackCuts::kITSChi2NDF);
+    setFlags(TrackCuts::kITSRefit);
+    setFlags(TrackCuts::kITSHits);
+    setFlags(TrackCuts::kGoldenChi2);
+    if (mMaxDcaXYPtDep) {
+      setFlags(TrackCuts::kDCAxy);
+    } else { // pT-independent cut: no need to evaluate pT
+      const uint16_t bit = 1UL << static_cast<int>(TrackCuts::kDCAxy);
+      auto mask = masks.begin();
+      for (auto const& track : tracks) {
+        *mask++ |= abs(track.dcaXY()) <= mMaxDcaXY ? bit : 0;
+      }
+    }
+    setFlags(TrackCuts::kDCAz);
+  }
+
+  // Check whether all selection criteria are fulfilled in a mask returned by IsSelectedMask
+  static bool IsSelected(uint16_t mask)
+  {
+    constexpr uint16_t allCuts = (1UL << static_cast<int>(TrackCuts::kNCuts)) - 1;
+    return (mask & allCuts) == allCuts;
+  }
+
   // Temporary function to check if track passes a given selection criteria. To be replaced by framework filters.
   template <typename T>
   bool IsSelected(T const& track, const TrackCuts& cut) const
@@ -223,13 +271,29 @@ class TrackSelection
   void SetRequireHitsInITSLayers(int8_t minNRequiredHits, std::set<uint8_t> requiredLayers);
   void SetRequireNoHitsInITSLayers(std::set<uint8_t> excludedLayers);
   /// @brief Reset ITS requirements
-  void ResetITSRequirements() { mRequiredITSHits.clear(); }
+  void ResetITSRequirements()
+  {
+    mRequiredITSHits.clear();
+    mRequiredITSHitsMask.clear();
+  }
 
   /// @brief Print the track selection
   void print() const;
 
  private:
-  bool FulfillsITSHitRequirements(uint8_t itsClusterMap) const;
+  // ITS requirements are evaluated on the bit patterns of the required layers
+  bool FulfillsITSHitRequirements(uint8_t itsClusterMap) const
+  {
+    for (auto const& itsRequirement : mRequiredITSHitsMask) {
+      auto hits = std::popcount(static_cast<uint8_t>(itsClusterMap & itsRequirement.second));
+      if ((itsRequirement.first == -1) && (hits > 0)) {
+        return false; // no hits were required in specified layers
+      } else if (hits < itsRequirement.first) {
+        return false; // not enough hits found in specified layers
+      }
+    }
+    return true;
+  }
 
   o2::aod::track::TrackTypeEnum mTrackType{o2::aod::track::TrackTypeEnum::Track};
 
@@ -255,8 +319,46 @@ class TrackSelection
 
   // vector of ITS requirements (minNRequiredHits in specific requiredLayers)
   std::vector<std::pair<int8_t, std::set<uint8_t>>> mRequiredITSHits{};
+  // same ITS requirements with the layers packed in a bit pattern (bit i for layer i)
+  std::vector<std::pair<int8_t, uint8_t>> mRequiredITSHitsMask{};
 
-  ClassDefNV(TrackSelection, 1);
+  ClassDefNV(TrackSelection, 2);
+};
+
+// Track selection with the list of active cuts fixed at compile time.
+// The cut parameters are taken from a TrackSelection object, while only the cuts in the parameter pack are evaluated,
+// such that IsSelected can be fully inlined without checks of unused cuts.
+// Cuts which are not active are flagged as fulfilled in the mask returned by IsSelectedMask.
+template <TrackSelection::TrackCuts... Cuts>
+class StaticTrackSelection
+{
+ public:
+  StaticTrackSelection() = default;
+  explicit StaticTrackSelection(const TrackSelection& trackSelection) : mTrackSelection(trackSelection) {}
+
+  template <typename T>
+  bool IsSelected(T const& track) const
+  {
+    return (mTrackSelection.IsSelected(track, Cuts) && ...);
+  }
+
+  template <typename T>
+  uint16_t IsSelectedMask(T const& track) const
+  {
+    constexpr uint16_t activeCuts = ((1UL << static_cast<int>(Cuts)) | ...);
+    constexpr uint16_t allCuts = (1UL << static_cast<int>(TrackSelection::TrackCuts::kNCuts)) - 1;
+    return (allCuts & ~activeCuts) | ((mTrackSelection.IsSelected(track, Cuts) ? (1UL << static_cast<int>(Cuts)) : 0) | ...);
+  }
+
+  // Access to the cut parameters
+  TrackSelection& get() { return mTrackSelection; }
+  const TrackSelection& get() const { return mTrackSelection; }
+
+  /// @brief Print the track selection
+  void print() const { mTrackSelection.print(); }
+
+ private:
+  TrackSelection mTrackSelection{};
 };
 
 #endif // COMMON_CORE_TRACKSELECTION_H_
@@ -28,6 +28,22 @@ TrackSelection getGlobalTrackSelection();
 TrackSelection getGlobalTrackSelectionRun3ITSMatch(int matching,
                                                    TrackSelection::GlobalTrackRun3DCAxyCut passFlag = TrackSelection::GlobalTrackRun3DCAxyCut::Default);
 
+// Compile-time version of the default Run 3 global-track selection (getGlobalTrackSelectionRun3ITSMatch).
+// The ITS cluster number and golden chi2 cuts are not evaluated since they are always fulfilled by Run 3 tracks with the default settings.
+using GlobalTrackSelectionRun3 = StaticTrackSelection<TrackSelection::TrackCuts::kTrackType,
+                                                      TrackSelection::TrackCuts::kPtRange,
+                                                      TrackSelection::TrackCuts::kEtaRange,
+                                                      TrackSelection::TrackCuts::kTPCNCls,
+                                                      TrackSelection::TrackCuts::kTPCCrossedRows,
+                                                      TrackSelection::TrackCuts::kTPCCrossedRowsOverNCls,
+                                                      TrackSelection::TrackCuts::kTPCChi2NDF,
+                                                      TrackSelection::TrackCuts::kTPCRefit,
+                                                      TrackSelection::TrackCuts::kITSChi2NDF,
+                                                      TrackSelection::TrackCuts::kITSRefit,
+                                                      TrackSelection::TrackCuts::kITSHits,
+                                                      TrackSelection::TrackCuts::kDCAxy,
+                                                      TrackSelection::TrackCuts::kDCAz>;
+
 // Default track selection requiring no hit in the SPD and one in the innermost
 // SDD -> complementary tracks to global selection
 TrackSelection getGlobalTrackSelectionSDD();
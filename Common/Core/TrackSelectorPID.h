@@ -19,6 +19,9 @@
 
 #include <TPDGCode.h>
 
+#include <array>
+#include <experimental/type_traits>
+
 #include "Framework/Logger.h"
 #include "ReconstructionDataFormats/PID.h"
 
@@ -440,7 +443,15 @@ class TrackSelectorPID
   {
     int statusTPC = getStatusTrackPIDTPC(track);
     int statusTOF = getStatusTrackPIDTOF(track);
+    return combineStatusTpcOrTof(statusTPC, statusTOF);
+  }
 
+  /// Combines the TPC and TOF selection statuses with the logic of getStatusTrackPIDTpcOrTof.
+  /// \param statusTPC  TPC selection status
+  /// \param statusTOF  TOF selection status
+  /// \return status of combined PID (TPC or TOF) (see TrackSelectorPID::Status)
+  static int combineStatusTpcOrTof(int statusTPC, int statusTOF)
+  {
     if (statusTPC == Status::PIDAccepted || statusTOF == Status::PIDAccepted) {
       return Status::PIDAccepted;
     }
@@ -468,7 +479,15 @@ class TrackSelectorPID
     if (track.hasTOF()) {
       statusTOF = getStatusTrackPIDTOF(track);
     }
+    return combineStatusTpcAndTof(statusTPC, statusTOF);
+  }
 
+  /// Combines the TPC and TOF selection statuses with the logic of getStatusTrackPIDTpcAndTof.
+  /// \param statusTPC  TPC selection status, PIDNotApplicable if the track has no TPC information
+  /// \param statusTOF  TOF selection status, PIDNotApplicable if the track has no TOF information
+  /// \return status of combined PID (TPC and TOF) (see TrackSelectorPID::Status)
+  static int combineStatusTpcAndTof(int statusTPC, int statusTOF)
+  {
     if (statusTPC == Status::PIDAccepted && statusTOF == Status::PIDAccepted) {
       return Status::PIDAccepted;
     }
@@ -650,7 +669,99 @@ class TrackSelectorPID
     }
   }
 
+  // Status from precomputed quantities, used by the batched evaluation (see TrackSelectorPIDMulti)
+
+  /// Returns status of TPC PID selection for given track pT and TPC nσ of the expected species.
+  int getStatusPIDTPC(float pt, float nSigma) const
+  {
+    if (!(mPtTPCMin <= pt && pt <= mPtTPCMax)) {
+      return Status::PIDNotApplicable;
+    }
+    return statusFromNSigma(nSigma, mNSigmaTPCMin, mNSigmaTPCMax, mNSigmaTPCMinCondTOF, mNSigmaTPCMaxCondTOF);
+  }
+
+  /// Returns status of TOF PID selection for given track pT and TOF nσ of the expected species.
+  int getStatusPIDTOF(float pt, float nSigma) const
+  {
+    if (!(mPtTOFMin <= pt && pt <= mPtTOFMax)) {
+      return Status::PIDNotApplicable;
+    }
+    return statusFromNSigma(nSigma, mNSigmaTOFMin, mNSigmaTOFMax, mNSigmaTOFMinCondTPC, mNSigmaTOFMaxCondTPC);
+  }
+
+  /// Returns status of Bayesian PID selection for given track pT and index of the most probable species.
+  int getStatusBayesPID(float pt, int bayesID) const
+  {
+    if (!(mPtBayesMin <= pt && pt <= mPtBayesMax)) {
+      return Status::PIDNotApplicable;
+    }
+    return bayesID == static_cast<int>(mSpecies) ? Status::PIDAccepted : Status::PIDRejected;
+  }
+
+  /// Returns status of Bayesian PID selection for given track pT and Bayesian probability of the expected species.
+  int getStatusBayesProbPID(float pt, float prob) const
+  {
+    if (!(mPtBayesMin <= pt && pt <= mPtBayesMax)) {
+      return Status::PIDNotApplicable;
+    }
+    return (mProbBayesMin < 0. || mProbBayesMin <= prob) ? Status::PIDAccepted : Status::PIDRejected;
+  }
+
+  /// Expected species of the track (see o2::track::PID)
+  uint getSpecies() const { return mSpecies; }
+
+  // Packed status word
+  //
+  // The statuses of several species and detectors (or combinations) are packed in a 64-bit word,
+  // kNBitsStatus bits per status, grouped by detector: bit offset = kNBitsStatus * (detector * kNSpeciesPacked + species).
+
+  /// Detectors and detector combinations stored in the packed status word
+  enum PackedDetector {
+    PackedTPC = 0,
+    PackedTOF,
+    PackedTpcOrTof,
+    PackedTpcAndTof,
+    PackedBayes,
+    PackedBayesProb,
+    NPackedDetectors
+  };
+
+  static constexpr int kNBitsStatus = 2;                           ///< bits per status (see TrackSelectorPID::Status)
+  static constexpr int kNSpeciesPacked = o2::track::PID::Proton + 1; ///< species stored in the packed word (electron to proton)
+
+  /// Stores a status in the packed word.
+  static void setPackedStatus(uint64_t& word, uint species, int detector, int status)
+  {
+    const int offset = kNBitsStatus * (detector * kNSpeciesPacked + species);
+    word = (word & ~(static_cast<uint64_t>(3) << offset)) | (static_cast<uint64_t>(status) << offset);
+  }
+
+  /// Extracts a status from the packed word.
+  /// \param word  packed status word
+  /// \param species  species index (see o2::track::PID)
+  /// \param detector  detector or combination (see TrackSelectorPID::PackedDetector)
+  /// \return selection status (see TrackSelectorPID::Status)
+  static int getPackedStatus(uint64_t word, uint species, int detector)
+  {
+    return static_cast<int>((word >> (kNBitsStatus * (detector * kNSpeciesPacked + species))) & 3);
+  }
+
  private:
+  static int statusFromNSigma(float nSigma, float nsMin, float nsMax, float nsMinCond, float nsMaxCond)
+  {
+    // Accept if selection is disabled via large values.
+    if (nsMin < -999. && nsMax > 999.) {
+      return Status::PIDAccepted;
+    }
+    if (nsMin <= nSigma && nSigma <= nsMax) {
+      return Status::PIDAccepted;
+    }
+    if ((nsMinCond < -999. && nsMaxCond > 999.) || (nsMinCond <= nSigma && nSigma <= nsMaxCond)) {
+      return Status::PIDConditional;
+    }
+    return Status::PIDRejected;
+  }
+
   uint mPdg = kPiPlus;                  ///< PDG code of the expected particle
   uint mSpecies = o2::track::PID::Pion; ///< Expected species of the track
 
@@ -684,4 +795,179 @@ class TrackSelectorPID
   float mProbBayesMin = -1.; ///< minium Bayesian probability [%]
 };
 
+/// Batched evaluation of several species hypotheses and detectors
+///
+/// Holds one TrackSelectorPID per species and returns the statuses of all requested
+/// hypotheses and detectors packed in one word (see TrackSelectorPID::getPackedStatus).
+/// The track pT and the nσ of each species are read once, and the combined statuses
+/// are derived from the single-detector ones.
+
+class TrackSelectorPIDMulti
+{
+ public:
+  /// Default constructor
+  TrackSelectorPIDMulti() = default;
+
+  /// Adds (or replaces) the selector of a species, identified by the PDG code of the selector.
+  void setSelector(const TrackSelectorPID& selector)
+  {
+    auto species = selector.getSpecies();
+    if (species >= static_cast<uint>(TrackSelectorPID::kNSpeciesPacked)) {
+      LOGF(error, "ERROR: Species %d cannot be packed in the PID status word", species);
+      assert(false);
+    }
+    mSelectors[species] = selector;
+    mSpeciesMask |= 1u << species;
+  }
+
+  /// Returns the selector of a species.
+  /// \param species  species index (see o2::track::PID)
+  TrackSelectorPID& getSelector(uint species) { return mSelectors[species]; }
+
+  /// Sets the detectors (or combinations) to evaluate.
+  /// \param mask  bit mask of TrackSelectorPID::PackedDetector values
+  void setDetectors(uint32_t mask) { mDetectorMask = mask; }
+
+  /// Returns the packed statuses of all the configured species and detectors for a given track.
+  /// \param track  track
+  /// \return packed status word, statuses of the species and detectors not requested are PIDNotApplicable
+  template <typename T>
+  uint64_t getStatusWord(const T& track) const
+  {
+    uint64_t word = 0;
+    const float pt = track.pt();
+    const bool doTPC = mDetectorMask & ((1u << TrackSelectorPID::PackedTPC) | (1u << TrackSelectorPID::PackedTpcOrTof) | (1u << TrackSelectorPID::PackedTpcAndTof));
+    const bool doTOF = mDetectorMask & ((1u << TrackSelectorPID::PackedTOF) | (1u << TrackSelectorPID::PackedTpcOrTof) | (1u << TrackSelectorPID::PackedTpcAndTof));
+    const bool hasTPC = doTPC && track.hasTPC();
+    const bool hasTOF = doTOF && track.hasTOF();
+    int bayesID = -1;
+    if constexpr (std::experimental::is_detected<hasBayesID, T>::value) {
+      if (mDetectorMask & (1u << TrackSelectorPID::PackedBayes)) {
+        bayesID = track.bayesID();
+      }
+    }
+
+    for (uint species = 0; species < static_cast<uint>(TrackSelectorPID::kNSpeciesPacked); species++) {
+      if (!(mSpeciesMask & (1u << species))) {
+        continue;
+      }
+      const auto& selector = mSelectors[species];
+      if (doTPC || doTOF) {
+        const int statusTPC = doTPC ? selector.getStatusPIDTPC(pt, nSigmaTPC(track, species)) : TrackSelectorPID::Status::PIDNotApplicable;
+        const int statusTOF = doTOF ? selector.getStatusPIDTOF(pt, nSigmaTOF(track, species)) : TrackSelectorPID::Status::PIDNotApplicable;
+        if (mDetectorMask & (1u << TrackSelectorPID::PackedTPC)) {
+          TrackSelectorPID::setPackedStatus(word, species, TrackSelectorPID::PackedTPC, statusTPC);
+        }
+        if (mDetectorMask & (1u << TrackSelectorPID::PackedTOF)) {
+          TrackSelectorPID::setPackedStatus(word, species, TrackSelectorPID::PackedTOF, statusTOF);
+        }
+        if (mDetectorMask & (1u << TrackSelectorPID::PackedTpcOrTof)) {
+          TrackSelectorPID::setPackedStatus(word, species, TrackSelectorPID::PackedTpcOrTof, TrackSelectorPID::combineStatusTpcOrTof(statusTPC, statusTOF));
+        }
+        if (mDetectorMask & (1u << TrackSelectorPID::PackedTpcAndTof)) {
+          TrackSelectorPID::setPackedStatus(word, species, TrackSelectorPID::PackedTpcAndTof,
+                                            TrackSelectorPID::combineStatusTpcAndTof(hasTPC ? statusTPC : TrackSelectorPID::Status::PIDNotApplicable,
+                                                                                     hasTOF ? statusTOF : TrackSelectorPID::Status::PIDNotApplicable));
+        }
+      }
+      if constexpr (std::experimental::is_detected<hasBayesID, T>::value) {
+        if (mDetectorMask & (1u << TrackSelectorPID::PackedBayes)) {
+          TrackSelectorPID::setPackedStatus(word, species, TrackSelectorPID::PackedBayes, selector.getStatusBayesPID(pt, bayesID));
+        }
+        if (mDetectorMask & (1u << TrackSelectorPID::PackedBayesProb)) {
+          TrackSelectorPID::setPackedStatus(word, species, TrackSelectorPID::PackedBayesProb, selector.getStatusBayesProbPID(pt, probBayes(track, species)));
+        }
+      }
+    }
+    return word;
+  }
+
+ private:
+  template <typename T>
+  using hasBayesID = decltype(std::declval<T&>().bayesID());
+
+  template <typename T>
+  static float nSigmaTPC(const T& track, uint species)
+  {
+    switch (species) {
+      case o2::track::PID::Electron:
+        return track.tpcNSigmaEl();
+      case o2::track::PID::Muon:
+        return track.tpcNSigmaMu();
+      case o2::track::PID::Pion:
+        return track.tpcNSigmaPi();
+      case o2::track::PID::Kaon:
+        return track.tpcNSigmaKa();
+      default:
+        return track.tpcNSigmaPr();
+    }
+  }
+
+  template <typename T>
+  static float nSigmaTOF(const T& track, uint species)
+  {
+    switch (species) {
+      case o2::track::PID::Electron:
+        return track.tofNSigmaEl();
+      case o2::track::PID::Muon:
+        return track.tofNSigmaMu();
+      case o2::track::PID::Pion:
+        return track.tofNSigmaPi();
+      case o2::track::PID::Kaon:
+        return track.tofNSigmaKa();
+      default:
+        return track.tofNSigmaPr();
+    }
+  }
+
+  template <typename T>
+  using hasBayesEl = decltype(std::declval<T&>().bayesEl());
+  template <typename T>
+  using hasBayesMu = decltype(std::declval<T&>().bayesMu());
+  template <typename T>
+  using hasBayesPi = decltype(std::declval<T&>().bayesPi());
+  template <typename T>
+  using hasBayesKa = decltype(std::declval<T&>().bayesKa());
+  template <typename T>
+  using hasBayesPr = decltype(std::declval<T&>().bayesPr());
+
+  /// Bayesian probability of a species, -1 if the table of the species is not joined
+  template <typename T>
+  static float probBayes(const T& track, uint species)
+  {
+    switch (species) {
+      case o2::track::PID::Electron:
+        if constexpr (std::experimental::is_detected<hasBayesEl, T>::value) {
+          return track.bayesEl();
+        }
+        break;
+      case o2::track::PID::Muon:
+        if constexpr (std::experimental::is_detected<hasBayesMu, T>::value) {
+          return track.bayesMu();
+        }
+        break;
+      case o2::track::PID::Pion:
+        if constexpr (std::experimental::is_detected<hasBayesPi, T>::value) {
+          return track.bayesPi();
+        }
+        break;
+      case o2::track::PID::Kaon:
+        if constexpr (std::experimental::is_detected<hasBayesKa, T>::value) {
+          return track.bayesKa();
+        }
+        break;
+      case o2::track::PID::Proton:
+        if constexpr (std::experimental::is_detected<hasBayesPr, T>::value) {
+          return track.bayesPr();
+        }
+        break;
+    }
+    return -1.f;
+  }
+
+  std::array<TrackSelectorPID, TrackSelectorPID::kNSpeciesPacked> mSelectors{}; ///< selectors per species
+  uint32_t mSpeciesMask = 0;                                                    ///< species with a selector
+  uint32_t mDetectorMask = (1u << TrackSelectorPID::PackedTpcOrTof) | (1u << TrackSelectorPID::PackedTpcAndTof); ///< detectors to evaluate
+};
+
 #endif // COMMON_CORE_TRACKSELECTORPID_H_
@@ -11,10 +11,13 @@
 
 #include <map>
 #include <list>
+#include <vector>
 #include <fstream>
+#include <future>
 #include <getopt.h>
 
 #include "TSystem.h"
+#include "TROOT.h"
 #include "TFile.h"
 #include "TTree.h"
 #include "TList.h"
@@ -37,7 +40,10 @@ int main(int argc, char* argv[])
   bool skipNonExistingFiles = false;
   bool skipParentFilesList = false;
   int verbosity = 2;
-  int exitCode = 0; // 0: success, >0: failure
+  int prefetch = 0;                         // number of input files opened in advance in parallel
+  long fastCopyThreshold = 10000000;        // minimal tree size for fast copy
+  bool fastCopyWithoutIndexColumns = false; // fast copy all trees without index columns
+  int exitCode = 0;                         // 0: success, >0: failure
 
   int option_index = 0;
   static struct option long_options[] = {
@@ -48,6 +54,9 @@ int main(int argc, char* argv[])
     {"skip-parent-files-list", no_argument, nullptr, 4},
     {"verbosity", required_argument, nullptr, 5},
     {"help", no_argument, nullptr, 6},
+    {"prefetch", required_argument, nullptr, 7},
+    {"fast-copy-threshold", required_argument, nullptr, 8},
+    {"fast-copy-without-index", no_argument, nullptr, 9},
     {nullptr, 0, nullptr, 0}};
 
   while (true) {
@@ -74,7 +83,16 @@ int main(int argc, char* argv[])
       printf("  --skip-non-existing-files    Flag to allow skipping of non-existing files in the input list.\n");
       printf("  --skip-parent-files-list     Flag to allow skipping the merging of the parent files list.\n");
       printf("  --verbosity <flag>           Verbosity of output (default: %d).\n", verbosity);
+      printf("  --prefetch <n>               Number of input files opened in advance in parallel threads (default: %d).\n", prefetch);
+      printf("  --fast-copy-threshold <size> Minimal tree size in Bytes for fast copy of baskets (default: %ld).\n", fastCopyThreshold);
+      printf("  --fast-copy-without-index    Flag to fast copy baskets of all trees without index columns independently of their size.\n");
       return -1;
+    } else if (c == 7) {
+      prefetch = atoi(optarg);
+    } else if (c == 8) {
+      fastCopyThreshold = atol(optarg);
+    } else if (c == 9) {
+      fastCopyWithoutIndexColumns = true;
     } else {
       return -2;
     }
@@ -87,6 +105,10 @@ int main(int argc, char* argv[])
   if (skipNonExistingFiles) {
     printf("  WARNING: Skipping non-existing files.\n");
   }
+  if (prefetch > 0) {
+    printf("  Opening %d input files in advance\n", prefetch);
+    ROOT::EnableThreadSafety();
+  }
 
   std::map<std::string, TTree*> trees;
   std::map<std::string, uint64_t> sizeCompressed;
@@ -101,12 +123,9 @@ int main(int argc, char* argv[])
   std::ifstream in;
   in.open(inputCollection);
   TString line;
+  std::vector<TString> inputFiles;
   bool connectedToAliEn = false;
-  TMap* metaData = nullptr;
-  TMap* parentFiles = nullptr;
-  int totalMergedDFs = 0;
-  int mergedDFs = 0;
-  while (in.good() && exitCode == 0) {
+  while (in.good()) {
     in >> line;
 
     if (line.Length() == 0) {
@@ -118,10 +137,30 @@ int main(int argc, char* argv[])
       TGrid::Connect("alien:");
       connectedToAliEn = true; // Only try once
     }
+    inputFiles.push_back(line);
+  }
+
+  // input files are opened asynchronously up to prefetch files in advance
+  std::vector<std::future<TFile*>> openedFiles(inputFiles.size());
+  std::size_t nextFileToOpen = 0;
+  auto openFiles = [&](std::size_t lastFile) {
+    for (; nextFileToOpen < inputFiles.size() && nextFileToOpen <= lastFile; ++nextFileToOpen) {
+      auto fileName = inputFiles[nextFileToOpen];
+      openedFiles[nextFileToOpen] = std::async((prefetch > 0) ? std::launch::async : std::launch::deferred, [fileName]() { return TFile::Open(fileName); });
+    }
+  };
+
+  TMap* metaData = nullptr;
+  TMap* parentFiles = nullptr;
+  int totalMergedDFs = 0;
+  int mergedDFs = 0;
+  for (std::size_t iFile = 0; iFile < inputFiles.size() && exitCode == 0; ++iFile) {
+    line = inputFiles[iFile];
+    openFiles(iFile + prefetch);
 
     printf("Processing input file: %s\n", line.Data());
 
-    auto inputFile = TFile::Open(line);
+    auto inputFile = openedFiles[iFile].get();
     if (!inputFile) {
       printf("Error: Could not open input file %s.\n", line.Data());
       if (skipNonExistingFiles) {
@@ -220,7 +259,10 @@ int main(int argc, char* argv[])
         foundTrees.push_back(treeName);
 
         auto inputTree = (TTree*)inputFile->Get(Form("%s/%s", dfName, treeName));
-        bool fastCopy = (inputTree->GetTotBytes() > 10000000); // Only do this for large enough trees to avoid that baskets are too small
+        bool fastCopy = (inputTree->GetTotBytes() > fastCopyThreshold); // Only do this for large enough trees to avoid that baskets are too small
+        if (fastCopyWithoutIndexColumns && !fastCopy) {
+          fastCopy = !hasIndexColumns(inputTree); // baskets of trees without index columns can always be copied unchanged
+        }
         if (verbosity > 1) {
           printf("    Processing tree %s with %lld entries with total size %lld (fast copy: %d)\n", treeName, inputTree->GetEntries(), inputTree->GetTotBytes(), fastCopy);
         }
@@ -411,6 +453,15 @@ int main(int argc, char* argv[])
     inputFile->Close();
   }
 
+  // close files opened in advance which were not processed
+  for (auto& openedFile : openedFiles) {
+    if (openedFile.valid()) {
+      if (auto file = openedFile.get()) {
+        file->Close();
+      }
+    }
+  }
+
   if (parentFiles) {
     outputFile->cd();
     parentFiles->Write("parentFiles", TObject::kSingleKey);
@@ -10,6 +10,9 @@
 // or submit itself to any jurisdiction.
 
 #include <TString.h>
+#include <TTree.h>
+#include <TBranch.h>
+#include <TObjArray.h>
 
 const char* removeVersionSuffix(const char* treeName)
 {
@@ -22,6 +25,19 @@ const char* removeVersionSuffix(const char* treeName)
   return tmp;
 }
 
+bool hasIndexColumns(TTree* tree)
+{
+  // true if any branch of the tree is an index column (fIndex*)
+  TObjArray* branches = tree->GetListOfBranches();
+  for (int i = 0; i < branches->GetEntriesFast(); ++i) {
+    TString branchName(((TBranch*)branches->UncheckedAt(i))->GetName());
+    if (branchName.BeginsWith("fIndex")) {
+      return true;
+    }
+  }
+  return false;
+}
+
 const char* getTableName(const char* branchName, const char* treeName)
 {
   // Syntax for branchName:
@@ -202,22 +202,46 @@ int main(int argc, char* argv[])
         outputDir = outputFile->mkdir(dfName);
         printf("Writing to output folder %s\n", dfName);
       }
-      outputDir->cd();
-      auto outputTree = inputTree->CloneTree(0);
-      outputTree->SetAutoFlush(0);
 
-      std::vector<int*> indexList;
-      std::vector<char*> vlaPointers;
-      std::vector<int*> indexPointers;
+      bool processingTracks = memcmp(treeName, "O2track", 7) == 0; // matches any of the track tables
+      bool processingCascades = memcmp(treeName, "O2cascade", 9) == 0;
+      bool processingV0s = memcmp(treeName, "O2v0", 4) == 0;
+      bool processingAmbiguousTracks = memcmp(treeName, "O2ambiguoustrack", 16) == 0;
+
+      // find the index columns pointing to tracks
+      std::vector<TBranch*> trackIndexBranches;
       TObjArray* branches = inputTree->GetListOfBranches();
       for (int i = 0; i < branches->GetEntriesFast(); ++i) {
         TBranch* br = (TBranch*)branches->UncheckedAt(i);
         TString branchName(br->GetName());
         TString tableName(getTableName(branchName, treeName));
         // register index of track index ONLY
-        if (!tableName.EqualTo("O2track")) {
-          continue;
+        if (tableName.EqualTo("O2track")) {
+          trackIndexBranches.push_back(br);
         }
+      }
+
+      // Tables which are not thinned and have no index to tracks are copied basket by basket without decompression
+      if (!processingTracks && !processingCascades && !processingV0s && !processingAmbiguousTracks && trackIndexBranches.empty()) {
+        outputDir->cd();
+        auto outputTree = inputTree->CloneTree(-1, "fast");
+        outputTree->SetAutoFlush(0);
+        delete inputTree;
+        outputDir->cd();
+        outputTree->Write();
+        delete outputTree;
+        continue;
+      }
+
+      outputDir->cd();
+      auto outputTree = inputTree->CloneTree(0);
+      outputTree->SetAutoFlush(0);
+
+      std::vector<int*> indexList;
+      std::vector<char*> vlaPointers;
+      std::vector<int*> indexPointers;
+      for (auto br : trackIndexBranches) {
+        TString branchName(br->GetName());
         // detect VLA
         if (((TLeaf*)br->GetListOfLeaves()->First())->GetLeafCount() != nullptr) {
           printf("  *** FATAL ***: VLA detection is not supported\n");
@@ -243,11 +267,6 @@ int main(int argc, char* argv[])
         }
       }
 
-      bool processingTracks = memcmp(treeName, "O2track", 7) == 0; // matches any of the track tables
-      bool processingCascades = memcmp(treeName, "O2cascade", 9) == 0;
-      bool processingV0s = memcmp(treeName, "O2v0", 4) == 0;
-      bool processingAmbiguousTracks = memcmp(treeName, "O2ambiguoustrack", 16) == 0;
-
       auto indexV0s = -1;
       if (processingCascades) {
         inputTree->SetBranchAddress("fIndexV0s", &indexV0s);
@@ -256,6 +275,10 @@ int main(int argc, char* argv[])
 
       auto entries = inputTree->GetEntries();
       for (int i = 0; i < entries; i++) {
+        // Entries removed based on the precomputed masks do not need to be read
+        if ((processingTracks && acceptedTracks[i] < 0) || (processingAmbiguousTracks && hasCollision[i])) {
+          continue;
+        }
         inputTree->GetEntry(i);
         bool fillThisEntry = true;
         // Special case for Tracks, TracksExtra, TracksCov
@@ -0,0 +1,306 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file benchCore.cxx
+/// \brief Micro-benchmarks of the kernels of Common/Core
+///
+/// The kernels are run over blocks of synthetic tracks and candidates, generated once with a fixed seed.
+/// Each benchmark reports the time per track (or candidate) and the throughput, so that the scalar
+/// and the batched variants of a kernel can be compared, e.g.
+///   o2-bench-analysis-core --benchmark_filter=RecoDecay
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "Common/Core/EventMixing.h"
+#include "Common/Core/PID/PIDTOF.h"
+#include "Common/Core/PID/TPCPIDResponse.h"
+#include "Common/Core/RecoDecay.h"
+#include "Common/Core/TrackSelection.h"
+#include "Common/Core/TrackSelectionDefaults.h"
+
+namespace
+{
+/// Track with the getters used by the benchmarked kernels
+struct SyntheticTrack {
+  float mPt, mEta, mDcaXY, mDcaZ, mTpcInnerParam, mTofExpMom, mLength;
+  int16_t mTpcNClsFound, mTpcNClsCrossedRows;
+  float mTpcCrossedRowsOverFindableCls, mTpcChi2NCl, mItsChi2NCl;
+  uint8_t mItsNCls, mItsClusterMap;
+
+  uint8_t trackType() const { return o2::aod::track::Track; }
+  uint32_t flags() const { return 0; }
+  float pt() const { return mPt; }
+  float eta() const { return mEta; }
+  float dcaXY() const { return mDcaXY; }
+  float dcaZ() const { return mDcaZ; }
+  int16_t tpcNClsFound() const { return mTpcNClsFound; }
+  int16_t tpcNClsCrossedRows() const { return mTpcNClsCrossedRows; }
+  float tpcCrossedRowsOverFindableCls() const { return mTpcCrossedRowsOverFindableCls; }
+  float tpcChi2NCl() const { return mTpcChi2NCl; }
+  uint8_t itsNCls() const { return mItsNCls; }
+  float itsChi2NCl() const { return mItsChi2NCl; }
+  uint8_t itsClusterMap() const { return mItsClusterMap; }
+  bool hasTPC() const { return true; }
+  bool hasITS() const { return true; }
+  bool hasTOF() const { return true; }
+  float tpcInnerParam() const { return mTpcInnerParam; }
+  float tofExpMom() const { return mTofExpMom; }
+  float length() const { return mLength; }
+};
+
+std::vector<SyntheticTrack> generateTracks(std::size_t n)
+{
+  std::mt19937 gen(42);
+  std::exponential_distribution<float> pt(1.f);
+  std::uniform_real_distribution<float> eta(-1.2f, 1.2f);
+  std::normal_distribution<float> dca(0.f, 0.05f);
+  std::uniform_int_distribution<int> nClsTpc(40, 159);
+  std::uniform_int_distribution<int> nClsIts(1, 7);
+  std::uniform_real_distribution<float> chi2(0.f, 6.f);
+  std::uniform_real_distribution<float> length(370.f, 450.f);
+  std::vector<SyntheticTrack> tracks(n);
+  for (auto& track : tracks) {
+    track.mPt = 0.1f + pt(gen);
+    track.mEta = eta(gen);
+    track.mDcaXY = dca(gen);
+    track.mDcaZ = dca(gen);
+    track.mTpcInnerParam = track.mPt * std::cosh(track.mEta);
+    track.mTofExpMom = track.mTpcInnerParam;
+    track.mLength = length(gen);
+    track.mTpcNClsFound = nClsTpc(gen);
+    track.mTpcNClsCrossedRows = track.mTpcNClsFound;
+    track.mTpcCrossedRowsOverFindableCls = 0.9f;
+    track.mTpcChi2NCl = chi2(gen);
+    track.mItsChi2NCl = chi2(gen) * 6.f;
+    track.mItsNCls = nClsIts(gen);
+    track.mItsClusterMap = (1 << track.mItsNCls) - 1;
+  }
+  return tracks;
+}
+
+/// Block of 3-prong candidates in structure-of-arrays layout
+struct CandidateBlock {
+  std::array<std::vector<float>, 3> px, py, pz;
+  std::vector<float> xSV, ySV, zSV, pxCand, pyCand, pzCand;
+
+  explicit CandidateBlock(std::size_t n)
+  {
+    std::mt19937 gen(7);
+    std::normal_distribution<float> mom(0.f, 1.f);
+    std::normal_distribution<float> pos(0.f, 0.02f);
+    for (int iProng = 0; iProng < 3; ++iProng) {
+      px[iProng].resize(n);
+      py[iProng].resize(n);
+      pz[iProng].resize(n);
+      for (std::size_t i = 0; i < n; ++i) {
+        px[iProng][i] = mom(gen);
+        py[iProng][i] = mom(gen);
+        pz[iProng][i] = mom(gen);
+      }
+    }
+    xSV.resize(n);
+    ySV.resize(n);
+    zSV.resize(n);
+    pxCand.resize(n);
+    pyCand.resize(n);
+    pzCand.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      xSV[i] = pos(gen);
+      ySV[i] = pos(gen);
+      zSV[i] = pos(gen);
+      pxCand[i] = px[0][i] + px[1][i] + px[2][i];
+      pyCand[i] = py[0][i] + py[1][i] + py[2][i];
+      pzCand[i] = pz[0][i] + pz[1][i] + pz[2][i];
+    }
+  }
+};
+
+constexpr std::array<double, 3> MassesPiKPi{0.13957, 0.49368, 0.13957};
+constexpr std::array<float, 3> PosPV{0.f, 0.f, 0.f};
+
+/// Reports the time per processed element and the throughput
+void setCounters(benchmark::State& state, std::size_t n)
+{
+  state.SetItemsProcessed(state.iterations() * n);
+  state.counters["ns/item"] = benchmark::Counter(static_cast<double>(n) * 1.e-9, benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+} // namespace
+
+static void BM_RecoDecayM(benchmark::State& state)
+{
+  const std::size_t n = state.range(0);
+  CandidateBlock cands(n);
+  std::vector<double> result(n);
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < n; ++i) {
+      result[i] = RecoDecay::m(std::array{std::array{cands.px[0][i], cands.py[0][i], cands.pz[0][i]},
+                                          std::array{cands.px[1][i], cands.py[1][i], cands.pz[1][i]},
+                                          std::array{cands.px[2][i], cands.py[2][i], cands.pz[2][i]}},
+                               MassesPiKPi);
+    }
+    benchmark::DoNotOptimize(result.data());
+    benchmark::ClobberMemory();
+  }
+  setCounters(state, n);
+}
+BENCHMARK(BM_RecoDecayM)->Arg(1 << 10)->Arg(1 << 16);
+
+static void BM_RecoDecayMBatch(benchmark::State& state)
+{
+  const std::size_t n = state.range(0);
+  CandidateBlock cands(n);
+  std::vector<double> result(n);
+  auto spans = [](auto const& arr) { return std::array<std::span<const float>, 3>{arr[0], arr[1], arr[2]}; };
+  for (auto _ : state) {
+    RecoDecay::mBatch(spans(cands.px), spans(cands.py), spans(cands.pz), MassesPiKPi, std::span<double>(result));
+    benchmark::DoNotOptimize(result.data());
+    benchmark::ClobberMemory();
+  }
+  setCounters(state, n);
+}
+BENCHMARK(BM_RecoDecayMBatch)->Arg(1 << 10)->Arg(1 << 16);
+
+static void BM_RecoDecayCpa(benchmark::State& state)
+{
+  const std::size_t n = state.range(0);
+  CandidateBlock cands(n);
+  std::vector<double> result(n);
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < n; ++i) {
+      result[i] = RecoDecay::cpa(PosPV, std::array{cands.xSV[i], cands.ySV[i], cands.zSV[i]}, std::array{cands.pxCand[i], cands.pyCand[i], cands.pzCand[i]});
+    }
+    benchmark::DoNotOptimize(result.data());
+    benchmark::ClobberMemory();
+  }
+  setCounters(state, n);
+}
+BENCHMARK(BM_RecoDecayCpa)->Arg(1 << 10)->Arg(1 << 16);
+
+static void BM_RecoDecayCpaBatch(benchmark::State& state)
+{
+  const std::size_t n = state.range(0);
+  CandidateBlock cands(n);
+  std::vector<double> result(n);
+  for (auto _ : state) {
+    RecoDecay::cpaBatch(PosPV,
+                        std::span<const float>(cands.xSV), std::span<const float>(cands.ySV), std::span<const float>(cands.zSV),
+                        std::span<const float>(cands.pxCand), std::span<const float>(cands.pyCand), std::span<const float>(cands.pzCand),
+                        std::span<double>(result));
+    benchmark::DoNotOptimize(result.data());
+    benchmark::ClobberMemory();
+  }
+  setCounters(state, n);
+}
+BENCHMARK(BM_RecoDecayCpaBatch)->Arg(1 << 10)->Arg(1 << 16);
+
+static void BM_TrackSelectionIsSelected(benchmark::State& state)
+{
+  const std::size_t n = state.range(0);
+  auto tracks = generateTracks(n);
+  const TrackSelection selection = getGlobalTrackSelection();
+  std::vector<uint16_t> masks(n);
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < n; ++i) {
+      masks[i] = selection.IsSelectedMask(tracks[i]);
+    }
+    benchmark::DoNotOptimize(masks.data());
+    benchmark::ClobberMemory();
+  }
+  setCounters(state, n);
+}
+BENCHMARK(BM_TrackSelectionIsSelected)->Arg(1 << 10)->Arg(1 << 16);
+
+static void BM_TrackSelectionIsSelectedTable(benchmark::State& state)
+{
+  const std::size_t n = state.range(0);
+  auto tracks = generateTracks(n);
+  const TrackSelection selection = getGlobalTrackSelection();
+  std::vector<uint16_t> masks;
+  for (auto _ : state) {
+    selection.IsSelectedMask(tracks, masks);
+    benchmark::DoNotOptimize(masks.data());
+    benchmark::ClobberMemory();
+  }
+  setCounters(state, n);
+}
+BENCHMARK(BM_TrackSelectionIsSelectedTable)->Arg(1 << 10)->Arg(1 << 16);
+
+static void BM_EventMixingGetMixingBin(benchmark::State& state)
+{
+  const std::size_t n = state.range(0);
+  const std::vector<float> vtxBins{-10.f, -8.f, -6.f, -4.f, -2.f, 0.f, 2.f, 4.f, 6.f, 8.f, 10.f};
+  const std::vector<float> multBins{0.f, 5.f, 10.f, 20.f, 30.f, 40.f, 50.f, 70.f, 100.f, 200.f, 1000.f};
+  std::mt19937 gen(3);
+  std::uniform_real_distribution<float> vtx(-10.f, 10.f);
+  std::exponential_distribution<float> mult(0.02f);
+  std::vector<float> vtxs(n), mults(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    vtxs[i] = vtx(gen);
+    mults[i] = mult(gen);
+  }
+  std::vector<int> bins(n);
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < n; ++i) {
+      bins[i] = eventmixing::getMixingBin(vtxBins, multBins, vtxs[i], mults[i]);
+    }
+    benchmark::DoNotOptimize(bins.data());
+    benchmark::ClobberMemory();
+  }
+  setCounters(state, n);
+}
+BENCHMARK(BM_EventMixingGetMixingBin)->Arg(1 << 10)->Arg(1 << 16);
+
+/// \param state.range(1) is the number of intervals of the Bethe-Bloch lookup table, 0 for the analytic parametrisation
+static void BM_TpcExpectedSignal(benchmark::State& state)
+{
+  const std::size_t n = state.range(0);
+  auto tracks = generateTracks(n);
+  o2::pid::tpc::Response response;
+  response.SetBetheBlochParams({0.0320981f, 19.9768f, 2.52666e-16f, 2.72123f, 6.08092f});
+  response.SetMIP(50.f);
+  response.SetChargeFactor(2.3f);
+  response.EnableBetheBlochLUT(state.range(1));
+  std::vector<float> result(n);
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < n; ++i) {
+      result[i] = response.GetExpectedSignal(tracks[i], o2::track::PID::Pion);
+    }
+    benchmark::DoNotOptimize(result.data());
+    benchmark::ClobberMemory();
+  }
+  setCounters(state, n);
+}
+BENCHMARK(BM_TpcExpectedSignal)->Args({1 << 16, 0})->Args({1 << 16, 4096});
+
+static void BM_TofExpectedSignal(benchmark::State& state)
+{
+  const std::size_t n = state.range(0);
+  auto tracks = generateTracks(n);
+  std::vector<float> result(n);
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < n; ++i) {
+      result[i] = o2::pid::tof::ExpTimes<SyntheticTrack, o2::track::PID::Pion>::GetExpectedSignal(tracks[i]);
+    }
+    benchmark::DoNotOptimize(result.data());
+    benchmark::ClobberMemory();
+  }
+  setCounters(state, n);
+}
+BENCHMARK(BM_TofExpectedSignal)->Arg(1 << 10)->Arg(1 << 16);
+
+BENCHMARK_MAIN();
@@ -32,6 +32,8 @@ DECLARE_SOA_INDEX_COLUMN(Track, track);                    //! Track index
 DECLARE_SOA_INDEX_COLUMN(FwdTrack, fwdtrack);              //! FwdTrack index
 DECLARE_SOA_INDEX_COLUMN(MFTTrack, mfttrack);              //! MFTTrack index
 DECLARE_SOA_ARRAY_INDEX_COLUMN(Collision, compatibleColl); //! Array of collision indices
+DECLARE_SOA_COLUMN(FirstAssoc, firstAssoc, int);           //! First row of the association table for the collision
+DECLARE_SOA_COLUMN(NAssoc, nAssoc, int);                   //! Number of rows of the association table for the collision
 } // namespace track_association
 
 DECLARE_SOA_TABLE(TrackAssoc, "AOD", "TRACKASSOC", //! Table for track-to-collision association for e.g. HF vertex finding - tracks can appear for several collisions
@@ -41,6 +43,12 @@ DECLARE_SOA_TABLE(TrackAssoc, "AOD", "TRACKASSOC", //! Table for track-to-collis
 DECLARE_SOA_TABLE(TrackCompColls, "AOD", "TRACKCOMPCOLL", //! Table with vectors of collision indices stored per track
                   track_association::CollisionIds);
 
+// The rows of TrackAssoc are sorted by collision: the associations of a collision are the contiguous rows
+// [firstAssoc, firstAssoc + nAssoc), e.g. trackIndices.iteratorAt(range.firstAssoc())
+DECLARE_SOA_TABLE(TrackAssocRanges, "AOD", "TRACKASSOCRNG", //! Range of the rows of TrackAssoc per collision, to be joined with Collisions
+                  track_association::FirstAssoc,
+                  track_association::NAssoc);
+
 DECLARE_SOA_TABLE(FwdTrackAssoc, "AOD", "FWDTRACKASSOC", //! Table for fwdtrack-to-collision association
                   track_association::CollisionId,
                   track_association::FwdTrackId);
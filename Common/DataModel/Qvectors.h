@@ -0,0 +1,63 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file Qvectors.h
+/// \brief Harmonic Q-vectors of the barrel tracks of each collision, filled by the qvectors-table producer
+///
+/// For each harmonic n and eta region, Q_n = sum_i w_i^p exp(i n phi_i) over the selected tracks, with the weights
+/// w_i correcting for the efficiency and the non-uniform acceptance and the power p of the producer, together
+/// with the sum of the weights sum_i w_i^p. The regions are the full acceptance and the two sides of the eta gap.
+
+#ifndef COMMON_DATAMODEL_QVECTORS_H_
+#define COMMON_DATAMODEL_QVECTORS_H_
+
+#include "Framework/AnalysisDataModel.h"
+
+namespace o2::aod
+{
+namespace qvec
+{
+DECLARE_SOA_COLUMN(Q2XFull, q2xFull, float);   //! Re(Q2), full acceptance
+DECLARE_SOA_COLUMN(Q2YFull, q2yFull, float);   //! Im(Q2), full acceptance
+DECLARE_SOA_COLUMN(Q2XNeg, q2xNeg, float);     //! Re(Q2), negative side of the eta gap
+DECLARE_SOA_COLUMN(Q2YNeg, q2yNeg, float);     //! Im(Q2), negative side of the eta gap
+DECLARE_SOA_COLUMN(Q2XPos, q2xPos, float);     //! Re(Q2), positive side of the eta gap
+DECLARE_SOA_COLUMN(Q2YPos, q2yPos, float);     //! Im(Q2), positive side of the eta gap
+DECLARE_SOA_COLUMN(Q3XFull, q3xFull, float);   //! Re(Q3), full acceptance
+DECLARE_SOA_COLUMN(Q3YFull, q3yFull, float);   //! Im(Q3), full acceptance
+DECLARE_SOA_COLUMN(Q3XNeg, q3xNeg, float);     //! Re(Q3), negative side of the eta gap
+DECLARE_SOA_COLUMN(Q3YNeg, q3yNeg, float);     //! Im(Q3), negative side of the eta gap
+DECLARE_SOA_COLUMN(Q3XPos, q3xPos, float);     //! Re(Q3), positive side of the eta gap
+DECLARE_SOA_COLUMN(Q3YPos, q3yPos, float);     //! Im(Q3), positive side of the eta gap
+DECLARE_SOA_COLUMN(Q4XFull, q4xFull, float);   //! Re(Q4), full acceptance
+DECLARE_SOA_COLUMN(Q4YFull, q4yFull, float);   //! Im(Q4), full acceptance
+DECLARE_SOA_COLUMN(Q4XNeg, q4xNeg, float);     //! Re(Q4), negative side of the eta gap
+DECLARE_SOA_COLUMN(Q4YNeg, q4yNeg, float);     //! Im(Q4), negative side of the eta gap
+DECLARE_SOA_COLUMN(Q4XPos, q4xPos, float);     //! Re(Q4), positive side of the eta gap
+DECLARE_SOA_COLUMN(Q4YPos, q4yPos, float);     //! Im(Q4), positive side of the eta gap
+DECLARE_SOA_COLUMN(SumWFull, sumWFull, float); //! Sum of the weights, full acceptance
+DECLARE_SOA_COLUMN(SumWNeg, sumWNeg, float);   //! Sum of the weights, negative side of the eta gap
+DECLARE_SOA_COLUMN(SumWPos, sumWPos, float);   //! Sum of the weights, positive side of the eta gap
+DECLARE_SOA_COLUMN(NTrkFull, nTrkFull, int);   //! Number of tracks, full acceptance
+DECLARE_SOA_COLUMN(NTrkNeg, nTrkNeg, int);     //! Number of tracks, negative side of the eta gap
+DECLARE_SOA_COLUMN(NTrkPos, nTrkPos, int);     //! Number of tracks, positive side of the eta gap
+} // namespace qvec
+
+DECLARE_SOA_TABLE(Qvectors, "AOD", "QVECTOR", //! Q-vectors of the barrel tracks, one row per collision, to be joined with Collisions
+                  qvec::Q2XFull, qvec::Q2YFull, qvec::Q2XNeg, qvec::Q2YNeg, qvec::Q2XPos, qvec::Q2YPos,
+                  qvec::Q3XFull, qvec::Q3YFull, qvec::Q3XNeg, qvec::Q3YNeg, qvec::Q3XPos, qvec::Q3YPos,
+                  qvec::Q4XFull, qvec::Q4YFull, qvec::Q4XNeg, qvec::Q4YNeg, qvec::Q4XPos, qvec::Q4YPos,
+                  qvec::SumWFull, qvec::SumWNeg, qvec::SumWPos,
+                  qvec::NTrkFull, qvec::NTrkNeg, qvec::NTrkPos);
+using Qvector = Qvectors::iterator;
+} // namespace o2::aod
+
+#endif // COMMON_DATAMODEL_QVECTORS_H_
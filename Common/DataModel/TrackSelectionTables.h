@@ -12,6 +12,11 @@
 #ifndef COMMON_DATAMODEL_TRACKSELECTIONTABLES_H_
 #define COMMON_DATAMODEL_TRACKSELECTIONTABLES_H_
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
 #include "Framework/AnalysisDataModel.h"
 
 namespace o2::aod
@@ -49,6 +54,7 @@ struct TrackSelectionFlags {
   static constexpr flagtype kGoldenChi2 = 1 << 12;
   static constexpr flagtype kDCAxy = 1 << 13;
   static constexpr flagtype kDCAz = 1 << 14;
+  static constexpr flagtype kTrackSelectionRequest = 1 << 15; // passed the loosest of the trackSelectionRequests of the workflow, if any
   // Combo masks
   static constexpr flagtype kQualityTracks = kTrackType | kTPCNCls | kTPCCrossedRows | kTPCCrossedRowsOverNCls | kTPCChi2NDF | kTPCRefit | kITSNCls | kITSChi2NDF | kITSRefit | kITSHits;
   static constexpr flagtype kQualityTracksITS = kTrackType | kITSNCls | kITSChi2NDF | kITSRefit | kITSHits;
@@ -145,6 +151,60 @@ DECLARE_SOA_TABLE(TracksDCACov, "AOD", "TRACKDCACOV",
                   track::SigmaDcaXY2,
                   track::SigmaDcaZ2); //! DCA cov. matrix information for the track
 
+// Quantised DCA columns, for the derived data: the DCAs are stored in fixed point and their variances on a logarithmic scale.
+// The dynamic columns decode them with the getters of TracksDCA and TracksDCACov, so that the tasks read both the same way.
+// The DCAs which are not available or out of range are decoded to InvalidValue.
+namespace trackcompact
+{
+constexpr float InvalidValue = 999.f;
+constexpr float DcaStep = 1.e-4f;                                       // cm, i.e. 1 um, range +-3.2767 cm
+constexpr int16_t DcaCodeInvalid = std::numeric_limits<int16_t>::min(); // DCA not available or out of range
+constexpr float SigmaDca2Min = 1.e-10f;                                 // cm^2, i.e. sigma of 0.1 um
+constexpr float SigmaDca2LogStep = 4.2163e-4f;                          // log(1e12) / 65534, relative precision of the variance, i.e. up to 100 cm^2
+constexpr uint16_t SigmaDca2CodeInvalid = 65535;                        // variance not available or out of range
+
+inline int16_t encodeDca(float dca)
+{
+  const float code = std::round(dca / DcaStep);
+  return (std::abs(code) > 32767.f || std::isnan(code)) ? DcaCodeInvalid : static_cast<int16_t>(code);
+}
+inline float decodeDca(int16_t code) { return code == DcaCodeInvalid ? InvalidValue : code * DcaStep; }
+
+inline uint16_t encodeSigmaDca2(float sigma2)
+{
+  if (!(sigma2 > 0.f) || sigma2 >= InvalidValue) {
+    return SigmaDca2CodeInvalid;
+  }
+  const float code = std::round(std::log(std::max(sigma2, SigmaDca2Min) / SigmaDca2Min) / SigmaDca2LogStep);
+  return code >= SigmaDca2CodeInvalid ? SigmaDca2CodeInvalid : static_cast<uint16_t>(code);
+}
+inline float decodeSigmaDca2(uint16_t code) { return code == SigmaDca2CodeInvalid ? InvalidValue : SigmaDca2Min * std::exp(code * SigmaDca2LogStep); }
+
+DECLARE_SOA_COLUMN(DcaXYCode, dcaXYCode, int16_t);              //! Fixed-point impact parameter in XY
+DECLARE_SOA_COLUMN(DcaZCode, dcaZCode, int16_t);                //! Fixed-point impact parameter in Z
+DECLARE_SOA_COLUMN(SigmaDcaXY2Code, sigmaDcaXY2Code, uint16_t); //! Log-encoded impact parameter sigma^2 in XY
+DECLARE_SOA_COLUMN(SigmaDcaZ2Code, sigmaDcaZ2Code, uint16_t);   //! Log-encoded impact parameter sigma^2 in Z
+DECLARE_SOA_DYNAMIC_COLUMN(DcaXY, dcaXY,                        //! Impact parameter in XY of the track to the primary vertex
+                           [](int16_t code) -> float { return decodeDca(code); });
+DECLARE_SOA_DYNAMIC_COLUMN(DcaZ, dcaZ, //! Impact parameter in Z of the track to the primary vertex
+                           [](int16_t code) -> float { return decodeDca(code); });
+DECLARE_SOA_DYNAMIC_COLUMN(SigmaDcaXY2, sigmaDcaXY2, //! Impact parameter sigma^2 in XY of the track to the primary vertex
+                           [](uint16_t code) -> float { return decodeSigmaDca2(code); });
+DECLARE_SOA_DYNAMIC_COLUMN(SigmaDcaZ2, sigmaDcaZ2, //! Impact parameter sigma^2 in Z of the track to the primary vertex
+                           [](uint16_t code) -> float { return decodeSigmaDca2(code); });
+} // namespace trackcompact
+
+DECLARE_SOA_TABLE(TracksDCACompact, "AOD", "TRACKDCACMP", //! Quantised DCA information for the track
+                  trackcompact::DcaXYCode,
+                  trackcompact::DcaZCode,
+                  trackcompact::DcaXY<trackcompact::DcaXYCode>,
+                  trackcompact::DcaZ<trackcompact::DcaZCode>);
+DECLARE_SOA_TABLE(TracksDCACovCompact, "AOD", "TRACKDCACOVCMP", //! Quantised DCA cov. matrix information for the track
+                  trackcompact::SigmaDcaXY2Code,
+                  trackcompact::SigmaDcaZ2Code,
+                  trackcompact::SigmaDcaXY2<trackcompact::SigmaDcaXY2Code>,
+                  trackcompact::SigmaDcaZ2<trackcompact::SigmaDcaZ2Code>);
+
 DECLARE_SOA_TABLE(TrackSelection, "AOD", "TRACKSELECTION", //! Information on the track selection decision + split dynamic information
                   track::IsGlobalTrackSDD,
                   track::TrackCutFlag,
@@ -30,6 +30,11 @@
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "Common/DataModel/PIDResponse.h"
 
+#include <algorithm>
+#include <limits>
+
+#include "TH2.h"
+
 #include "pidTOFBase.h"
 
 using namespace o2;
@@ -91,6 +96,7 @@ struct bayesPid {
   Configurable<std::string> ccdbPathTOF{"ccdbPathTOF", "TOF/Calib", "Path of the TOF parametrization on the CCDB"};
   Configurable<std::string> ccdbPathTPC{"ccdbPathTPC", "Analysis/PID/TPC/Response", "Path of the TPC parametrization on the CCDB"};
   Configurable<int64_t> timestamp{"ccdb-timestamp", -1, "timestamp of the object"};
+  Configurable<std::string> ccdbPathPriors{"ccdbPathPriors", "", "Path of the prior probabilities on the CCDB (TH2 of pT vs species index), if empty flat priors are used. Only used with processNSigma"};
 
   // Configuration flags to include and exclude particle hypotheses
   // Configurable<LabeledArray<int>> pid{"pid",
@@ -135,6 +141,9 @@ struct bayesPid {
 
   void init(o2::framework::InitContext& initContext)
   {
+    if (doprocessResponse && doprocessNSigma) {
+      LOGP(fatal, "Only one process function between processResponse and processNSigma can be enabled at a time.");
+    }
     for (int i = 0; i < kNProb; i++) { // Setting all probabilities to the default value
       for (int j = 0; j < PID::NIDs; j++) {
         Probability[i][j] = 1.f;
@@ -217,6 +226,9 @@ struct bayesPid {
     } else { // All ok
       LOG(info) << enabledSpecies.size() << " species enabled for the Bayesian PID computation";
     }
+    if (doprocessNSigma && enabledSpecies.back() > PID::Proton) {
+      LOG(fatal) << "Only species up to the proton can be computed from the nsigma tables, disable " << PID::getName(enabledSpecies.back());
+    }
     // Getting the parametrization parameters
     ccdb->setURL(url.value);
     ccdb->setTimestamp(timestamp.value);
@@ -224,6 +236,9 @@ struct bayesPid {
     ccdb->setLocalObjectValidityChecking();
     // Not later than now objects
     ccdb->setCreatedNotAfter(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+    if (doprocessNSigma) { // The detector responses are already applied in the nsigma tables
+      return;
+    }
     //
     const std::vector<float> p = {0.008, 0.008, 0.002, 40.0};
     Response[kTOF].SetParameters(DetectorResponse::kSigma, p);
@@ -433,7 +448,7 @@ struct bayesPid {
     }
   }
 
-  void process(Coll const& collisions, Trks const& tracks)
+  void processResponse(Coll const& collisions, Trks const& tracks)
   {
 
     // Check and fill enabled tables
@@ -513,6 +528,139 @@ struct bayesPid {
       tableBayes((*mostProbable) * 100.f, std::distance(Probability[kBayesian].begin(), mostProbable));
     }
   }
+  PROCESS_SWITCH(bayesPid, processResponse, "Compute the detector responses of each track and species", false);
+
+  // Bayesian PID from the nsigma tables produced by the TPC and TOF PID tasks
+
+  /// Species computed from the nsigma tables (electron to proton)
+  static constexpr int kNSpeciesNSigma = PID::Proton + 1;
+  using TrksNSigma = soa::Join<aod::Tracks, aod::TracksExtra,
+                               aod::pidTPCFullEl, aod::pidTPCFullMu, aod::pidTPCFullPi, aod::pidTPCFullKa, aod::pidTPCFullPr,
+                               aod::pidTOFFullEl, aod::pidTOFFullMu, aod::pidTOFFullPi, aod::pidTOFFullKa, aod::pidTOFFullPr>;
+
+  std::vector<float> priorPtEdges; /// Upper pT edges of the prior bins, the last one is open
+  std::vector<float> priors;       /// Prior probabilities normalised to the enabled species, [pT bin][species] (0 for disabled species)
+  int priorsRunNumber = -1;        /// Run for which the priors are loaded
+
+  /// Loads the priors of the run of the bc, once per run
+  void loadPriors(aod::BCsWithTimestamps::iterator const& bc)
+  {
+    if (priorsRunNumber == bc.runNumber()) {
+      return;
+    }
+    priorsRunNumber = bc.runNumber();
+
+    TH2* hPriors = nullptr;
+    if (!ccdbPathPriors.value.empty()) {
+      hPriors = ccdb->getForTimeStamp<TH2>(ccdbPathPriors.value, bc.timestamp());
+      if (!hPriors) {
+        LOGP(warning, "Priors not found in {} for run {}, using flat priors", ccdbPathPriors.value, priorsRunNumber);
+      }
+    }
+    const int nPtBins = hPriors ? hPriors->GetNbinsX() : 1;
+    priorPtEdges.resize(nPtBins);
+    priors.assign(nPtBins * kNSpeciesNSigma, 0.f);
+    for (int iPt = 0; iPt < nPtBins; iPt++) {
+      priorPtEdges[iPt] = iPt < nPtBins - 1 ? hPriors->GetXaxis()->GetBinUpEdge(iPt + 1) : std::numeric_limits<float>::max();
+      float* prior = &priors[iPt * kNSpeciesNSigma];
+      float sum = 0.f;
+      for (const auto enabledPid : enabledSpecies) {
+        prior[enabledPid] = hPriors ? hPriors->GetBinContent(iPt + 1, enabledPid + 1) : 1.f;
+        sum += prior[enabledPid];
+      }
+      for (const auto enabledPid : enabledSpecies) {
+        prior[enabledPid] = sum > 0.f ? prior[enabledPid] / sum : 1.f / enabledSpecies.size();
+      }
+    }
+    LOGP(info, "Loaded priors for run {} with {} pT bins", priorsRunNumber, nPtBins);
+  }
+
+  /// TPC likelihood, same shape as in ComputeTPCProbability
+  float likelihoodTPC(float nSigma) const
+  {
+    if (std::abs(nSigma) > fRange) {
+      return 1.f / PID::NIDs; // mismatch
+    }
+    return std::exp(-0.5f * nSigma * nSigma);
+  }
+
+  /// TOF likelihood, gaussian core with exponential tail as in ComputeTOFProbability
+  float likelihoodTOF(float nSigma) const
+  {
+    const float meanCorrFactor = 0.07f / fTOFtail; // Correction factor on the mean because of the tail
+    nSigma += meanCorrFactor;
+    if (nSigma < fTOFtail) {
+      return std::exp(-0.5f * nSigma * nSigma) + fgTOFmismatchProb;
+    }
+    return std::exp(-(nSigma - fTOFtail * 0.5f) * fTOFtail) + fgTOFmismatchProb;
+  }
+
+  void processNSigma(TrksNSigma const& tracks, aod::BCsWithTimestamps const& bcs)
+  {
+    auto makeTable = [&tracks](const Configurable<int>& flag, auto& table) {
+      if (flag.value == 1) {
+        table.reserve(tracks.size());
+      }
+    };
+    tableBayes.reserve(tracks.size());
+    makeTable(pidEl, tablePIDEl);
+    makeTable(pidMu, tablePIDMu);
+    makeTable(pidPi, tablePIDPi);
+    makeTable(pidKa, tablePIDKa);
+    makeTable(pidPr, tablePIDPr);
+
+    if (bcs.size() > 0) {
+      loadPriors(bcs.begin());
+    }
+
+    std::array<float, kNSpeciesNSigma> nSigmaTPC;
+    std::array<float, kNSpeciesNSigma> nSigmaTOF;
+    std::array<float, kNSpeciesNSigma> posterior;
+    for (auto const& trk : tracks) {
+      const bool useTPC = enabledDet[kTPC] && trk.hasTPC();
+      const bool useTOF = enabledDet[kTOF] && trk.hasTOF();
+      nSigmaTPC = {trk.tpcNSigmaEl(), trk.tpcNSigmaMu(), trk.tpcNSigmaPi(), trk.tpcNSigmaKa(), trk.tpcNSigmaPr()};
+      nSigmaTOF = {trk.tofNSigmaEl(), trk.tofNSigmaMu(), trk.tofNSigmaPi(), trk.tofNSigmaKa(), trk.tofNSigmaPr()};
+
+      const int iPt = std::upper_bound(priorPtEdges.begin(), priorPtEdges.end() - 1, trk.pt()) - priorPtEdges.begin();
+      const float* prior = &priors[iPt * kNSpeciesNSigma];
+
+      // All species at once: disabled species have a null prior
+      float sum = 0.f;
+      for (int id = 0; id < kNSpeciesNSigma; id++) {
+        posterior[id] = prior[id] * (useTPC ? likelihoodTPC(nSigmaTPC[id]) : 1.f) * (useTOF ? likelihoodTOF(nSigmaTOF[id]) : 1.f);
+        sum += posterior[id];
+      }
+      if (sum > 0.f) {
+        for (int id = 0; id < kNSpeciesNSigma; id++) {
+          posterior[id] /= sum;
+        }
+      } else {
+        for (int id = 0; id < kNSpeciesNSigma; id++) {
+          posterior[id] = prior[id] > 0.f ? 1.f / enabledSpecies.size() : 0.f;
+        }
+      }
+
+      if (pidEl == 1) {
+        tablePIDEl(posterior[PID::Electron] * 100.f);
+      }
+      if (pidMu == 1) {
+        tablePIDMu(posterior[PID::Muon] * 100.f);
+      }
+      if (pidPi == 1) {
+        tablePIDPi(posterior[PID::Pion] * 100.f);
+      }
+      if (pidKa == 1) {
+        tablePIDKa(posterior[PID::Kaon] * 100.f);
+      }
+      if (pidPr == 1) {
+        tablePIDPr(posterior[PID::Proton] * 100.f);
+      }
+      const auto mostProbable = std::max_element(posterior.begin(), posterior.end());
+      tableBayes((*mostProbable) * 100.f, std::distance(posterior.begin(), mostProbable));
+    }
+  }
+  PROCESS_SWITCH(bayesPid, processNSigma, "Compute the probabilities from the TPC and TOF nsigma tables", true);
 };
 
 struct bayesPidQa {
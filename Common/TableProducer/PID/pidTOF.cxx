@@ -242,23 +242,56 @@ struct tofPid {
     }
   }
 
+  // Fills the table for the given particle ID with the response computed for a block of tracks
+  template <typename ResponseType>
+  void fillTable(const int id, const ResponseType& response, const int64_t& size)
+  {
+    auto fill = [&](auto& table) {
+      for (int64_t i = 0; i < size; i++) {
+        aod::pidutils::packInTable<aod::pidtof_tiny::binning>(response.getSeparation(id, i),
+                                                              table);
+      }
+    };
+    switch (id) {
+      case 0:
+        fill(tablePIDEl);
+        break;
+      case 1:
+        fill(tablePIDMu);
+        break;
+      case 2:
+        fill(tablePIDPi);
+        break;
+      case 3:
+        fill(tablePIDKa);
+        break;
+      case 4:
+        fill(tablePIDPr);
+        break;
+      case 5:
+        fill(tablePIDDe);
+        break;
+      case 6:
+        fill(tablePIDTr);
+        break;
+      case 7:
+        fill(tablePIDHe);
+        break;
+      case 8:
+        fill(tablePIDAl);
+        break;
+      default:
+        LOG(fatal) << "Wrong particle ID in fillTable()";
+        break;
+    }
+  }
+
   using Trks = soa::Join<aod::Tracks, aod::TracksExtra, aod::TOFSignal, aod::TOFEvTime, aod::pidEvTimeFlags>;
   // Define slice per collision
   Preslice<Trks> perCollision = aod::track::collisionId;
-  template <o2::track::PID::ID pid>
-  using ResponseImplementation = o2::pid::tof::ExpTimes<Trks::iterator, pid>;
+  o2::pid::tof::ExpTimesAll<Trks::iterator> responseAll; // Response for all the enabled mass hypotheses, computed in one pass per block of tracks
   void processWSlice(Trks const& tracks, aod::Collisions const&, aod::BCsWithTimestamps const&)
   {
-    constexpr auto responseEl = ResponseImplementation<PID::Electron>();
-    constexpr auto responseMu = ResponseImplementation<PID::Muon>();
-    constexpr auto responsePi = ResponseImplementation<PID::Pion>();
-    constexpr auto responseKa = ResponseImplementation<PID::Kaon>();
-    constexpr auto responsePr = ResponseImplementation<PID::Proton>();
-    constexpr auto responseDe = ResponseImplementation<PID::Deuteron>();
-    constexpr auto responseTr = ResponseImplementation<PID::Triton>();
-    constexpr auto responseHe = ResponseImplementation<PID::Helium3>();
-    constexpr auto responseAl = ResponseImplementation<PID::Alpha>();
-
     for (auto const& pidId : mEnabledParticles) {
       reserveTable(pidId, tracks.size());
     }
@@ -291,84 +324,27 @@ struct tofPid {
       }
 
       const auto& tracksInCollision = tracks.sliceBy(perCollision, lastCollisionId);
-      for (auto const& trkInColl : tracksInCollision) { // Loop on tracks
-        for (auto const& pidId : mEnabledParticles) {   // Loop on enabled particle hypotheses
-          switch (pidId) {
-            case 0:
-              aod::pidutils::packInTable<aod::pidtof_tiny::binning>(responseEl.GetSeparation(mRespParamsV2, trkInColl),
-                                                                    tablePIDEl);
-              break;
-            case 1:
-              aod::pidutils::packInTable<aod::pidtof_tiny::binning>(responseMu.GetSeparation(mRespParamsV2, trkInColl),
-                                                                    tablePIDMu);
-              break;
-            case 2:
-              aod::pidutils::packInTable<aod::pidtof_tiny::binning>(responsePi.GetSeparation(mRespParamsV2, trkInColl),
-                                                                    tablePIDPi);
-              break;
-            case 3:
-              aod::pidutils::packInTable<aod::pidtof_tiny::binning>(responseKa.GetSeparation(mRespParamsV2, trkInColl),
-                                                                    tablePIDKa);
-              break;
-            case 4:
-              aod::pidutils::packInTable<aod::pidtof_tiny::binning>(responsePr.GetSeparation(mRespParamsV2, trkInColl),
-                                                                    tablePIDPr);
-              break;
-            case 5:
-              aod::pidutils::packInTable<aod::pidtof_tiny::binning>(responseDe.GetSeparation(mRespParamsV2, trkInColl),
-                                                                    tablePIDDe);
-              break;
-            case 6:
-              aod::pidutils::packInTable<aod::pidtof_tiny::binning>(responseTr.GetSeparation(mRespParamsV2, trkInColl),
-                                                                    tablePIDTr);
-              break;
-            case 7:
-              aod::pidutils::packInTable<aod::pidtof_tiny::binning>(responseHe.GetSeparation(mRespParamsV2, trkInColl),
-                                                                    tablePIDHe);
-              break;
-            case 8:
-              aod::pidutils::packInTable<aod::pidtof_tiny::binning>(responseAl.GetSeparation(mRespParamsV2, trkInColl),
-                                                                    tablePIDAl);
-              break;
-            default:
-              LOG(fatal) << "Wrong particle ID in processWSlice()";
-              break;
-          }
-        }
+      responseAll.compute(mRespParamsV2, tracksInCollision, mEnabledParticles);
+      for (auto const& pidId : mEnabledParticles) { // Loop on enabled particle hypotheses
+        fillTable(pidId, responseAll, tracksInCollision.size());
       }
     }
   }
   PROCESS_SWITCH(tofPid, processWSlice, "Process with track slices", true);
 
   using TrksIU = soa::Join<aod::TracksIU, aod::TracksExtra, aod::TOFSignal, aod::TOFEvTime, aod::pidEvTimeFlags>;
-  template <o2::track::PID::ID pid>
-  using ResponseImplementationIU = o2::pid::tof::ExpTimes<TrksIU::iterator, pid>;
+  o2::pid::tof::ExpTimesAll<TrksIU::iterator> responseAllIU; // Response for all the enabled mass hypotheses, computed in one pass over the tracks
   void processWoSlice(TrksIU const& tracks, aod::Collisions const&, aod::BCsWithTimestamps const&)
   {
-    constexpr auto responseEl = ResponseImplementationIU<PID::Electron>();
-    constexpr auto responseMu = ResponseImplementationIU<PID::Muon>();
-    constexpr auto responsePi = ResponseImplementationIU<PID::Pion>();
-    constexpr auto responseKa = ResponseImplementationIU<PID::Kaon>();
-    constexpr auto responsePr = ResponseImplementationIU<PID::Proton>();
-    constexpr auto responseDe = ResponseImplementationIU<PID::Deuteron>();
-    constexpr auto responseTr = ResponseImplementationIU<PID::Triton>();
-    constexpr auto responseHe = ResponseImplementationIU<PID::Helium3>();
-    constexpr auto responseAl = ResponseImplementationIU<PID::Alpha>();
-
     for (auto const& pidId : mEnabledParticles) {
       reserveTable(pidId, tracks.size());
     }
 
-    for (auto const& track : tracks) { // Loop on all tracks
-      if (!track.has_collision()) {    // Track was not assigned, cannot compute NSigma (no event time) -> filling with empty table
-        for (auto const& pidId : mEnabledParticles) {
-          makeTableEmpty(pidId);
-        }
-        continue;
-      }
-
-      if (enableTimeDependentResponse && (track.collisionId() != mLastCollisionId)) { // Time dependent calib is enabled and this is a new collision
-        mLastCollisionId = track.collisionId();                                       // Cache last collision ID
+    responseAllIU.reset(tracks.size(), mEnabledParticles);
+    int64_t index = 0;
+    for (auto const& track : tracks) { // Loop on all tracks, tracks not assigned have no event time and are filled with empty values
+      if (enableTimeDependentResponse && track.has_collision() && (track.collisionId() != mLastCollisionId)) { // Time dependent calib is enabled and this is a new collision
+        mLastCollisionId = track.collisionId();                                                                // Cache last collision ID
         timestamp.value = track.collision().bc_as<aod::BCsWithTimestamps>().timestamp();
         LOG(debug) << "Updating parametrization from path '" << parametrizationPath.value << "' and timestamp " << timestamp.value;
         if (!ccdb->getForTimeStamp<o2::tof::ParameterCollection>(parametrizationPath.value, timestamp.value)->retrieveParameters(mRespParamsV2, passName.value)) {
@@ -379,50 +355,11 @@ struct tofPid {
           }
         }
       }
+      responseAllIU.computeTrack(mRespParamsV2, track, index++);
+    }
 
-      for (auto const& pidId : mEnabledParticles) { // Loop on enabled particle hypotheses
-        switch (pidId) {
-          case 0:
-            aod::pidutils::packInTable<aod::pidtof_tiny::binning>(responseEl.GetSeparation(mRespParamsV2, track),
-                                                                  tablePIDEl);
-            break;
-          case 1:
-            aod::pidutils::packInTable<aod::pidtof_tiny::binning>(responseMu.GetSeparation(mRespParamsV2, track),
-                                                                  tablePIDMu);
-            break;
-          case 2:
-            aod::pidutils::packInTable<aod::pidtof_tiny::binning>(responsePi.GetSeparation(mRespParamsV2, track),
-                                                                  tablePIDPi);
-            break;
-          case 3:
-            aod::pidutils::packInTable<aod::pidtof_tiny::binning>(responseKa.GetSeparation(mRespParamsV2, track),
-                                                                  tablePIDKa);
-            break;
-          case 4:
-            aod::pidutils::packInTable<aod::pidtof_tiny::binning>(responsePr.GetSeparation(mRespParamsV2, track),
-                                                                  tablePIDPr);
-            break;
-          case 5:
-            aod::pidutils::packInTable<aod::pidtof_tiny::binning>(responseDe.GetSeparation(mRespParamsV2, track),
-                                                                  tablePIDDe);
-            break;
-          case 6:
-            aod::pidutils::packInTable<aod::pidtof_tiny::binning>(responseTr.GetSeparation(mRespParamsV2, track),
-                                                                  tablePIDTr);
-            break;
-          case 7:
-            aod::pidutils::packInTable<aod::pidtof_tiny::binning>(responseHe.GetSeparation(mRespParamsV2, track),
-                                                                  tablePIDHe);
-            break;
-          case 8:
-            aod::pidutils::packInTable<aod::pidtof_tiny::binning>(responseAl.GetSeparation(mRespParamsV2, track),
-                                                                  tablePIDAl);
-            break;
-          default:
-            LOG(fatal) << "Wrong particle ID in processWoSlice()";
-            break;
-        }
-      }
+    for (auto const& pidId : mEnabledParticles) { // Loop on enabled particle hypotheses
+      fillTable(pidId, responseAllIU, tracks.size());
     }
   }
   PROCESS_SWITCH(tofPid, processWoSlice, "Process without track slices and on TrackIU (faster but only Run3)", false);
@@ -15,6 +15,11 @@
 /// \brief  Base to build tasks for TOF PID tasks.
 ///
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <thread>
 #include <utility>
 #include <vector>
 #include <string>
@@ -103,6 +108,14 @@ bool filterForTOFEventTime(const trackType& tr)
   return (tr.hasTOF() && tr.p() > trackSampleMinMomentum && tr.p() < trackSampleMaxMomentum && (tr.trackType() == o2::aod::track::TrackTypeEnum::Track || tr.trackType() == o2::aod::track::TrackTypeEnum::TrackIU));
 } // accept all
 
+/// Subsample of the tracks used for the TOF event time of the collision being processed by this thread (sorted global indices), nullptr if all the tracks are used
+thread_local const std::vector<int64_t>* trackSampleSubsample = nullptr;
+template <typename trackType>
+bool filterForTOFEventTimeSubsample(const trackType& tr)
+{
+  return filterForTOFEventTime(tr) && (trackSampleSubsample == nullptr || std::binary_search(trackSampleSubsample->begin(), trackSampleSubsample->end(), tr.globalIndex()));
+}
+
 /// Specialization of TOF event time maker
 template <typename trackType,
           bool (*trackFilter)(const trackType&),
@@ -116,6 +129,47 @@ o2::tof::eventTimeContainer evTimeMakerForTracks(const trackTypeContainer& track
   return o2::tof::evTimeMakerFromParam<trackTypeContainer, trackType, trackFilter, response, responseParametersType>(tracks, responseParameters, diamond);
 }
 
+/// Work buffers of the reentrant TOF event time maker, one per thread
+struct evTimeMakerBuffers {
+  std::vector<o2::tof::eventTimeTrack> tracks; /// Tracks of the sample
+  std::vector<int> index;                      /// Position of the tracks of the sample in the input container
+};
+
+/// Reentrant version of the TOF event time maker. The maker of O2 keeps its work buffers in static
+/// variables and cannot be used on several collisions at the same time: here they are owned by the caller.
+template <typename trackType,
+          bool (*trackFilter)(const trackType&),
+          template <typename T, o2::track::PID::ID> typename response,
+          typename trackTypeContainer,
+          typename responseParametersType>
+o2::tof::eventTimeContainer evTimeMakerForTracksReentrant(const trackTypeContainer& tracks,
+                                                          const responseParametersType& responseParameters,
+                                                          evTimeMakerBuffers& buffers,
+                                                          const float& diamond = 6.0)
+{
+  buffers.tracks.clear();
+  buffers.index.clear();
+  float expTimes[3];
+  float expSigmas[3];
+  int nTracks = 0;
+  for (auto const& track : tracks) {
+    if (trackFilter(track)) {
+      expTimes[0] = response<trackType, o2::track::PID::Pion>::GetExpectedSignal(track);
+      expTimes[1] = response<trackType, o2::track::PID::Kaon>::GetExpectedSignal(track);
+      expTimes[2] = response<trackType, o2::track::PID::Proton>::GetExpectedSignal(track);
+      expSigmas[0] = response<trackType, o2::track::PID::Pion>::GetExpectedSigmaTracking(responseParameters, track);
+      expSigmas[1] = response<trackType, o2::track::PID::Kaon>::GetExpectedSigmaTracking(responseParameters, track);
+      expSigmas[2] = response<trackType, o2::track::PID::Proton>::GetExpectedSigmaTracking(responseParameters, track);
+      buffers.tracks.emplace_back(track.tofSignal(), expTimes, expSigmas);
+      buffers.index.push_back(nTracks);
+    }
+    nTracks++;
+  }
+  o2::tof::eventTimeContainer evTime(0.f, 0.f, diamond);
+  o2::tof::computeEvTime(buffers.tracks, buffers.index, evTime);
+  return evTime;
+}
+
 /// Task to produce the TOF event time table
 struct tofEventTime {
   // Tables to produce
@@ -144,6 +198,21 @@ struct tofEventTime {
   Configurable<bool> fatalOnPassNotAvailable{"fatalOnPassNotAvailable", true, "Flag to throw a fatal if the pass is not available in the retrieved CCDB object"};
   Configurable<bool> sel8TOFEvTime{"sel8TOFEvTime", false, "Flag to compute the ev. time only for events that pass the sel8 ev. selection"};
   Configurable<int> maxNtracksInSet{"maxNtracksInSet", 10, "Size of the set to consider for the TOF ev. time computation"};
+  Configurable<int> nThreads{"nThreads", 1, "Number of threads computing the TOF ev. time of the collisions of a data frame, 1: serial"};
+  Configurable<int> maxNtracksForEvTime{"maxNtracksForEvTime", 0, "Maximum number of tracks of a collision used for the TOF ev. time, above it an evenly spaced subsample is used. 0: no limit"};
+  Configurable<bool> enableTimingHistogram{"enableTimingHistogram", false, "Fill the computing time of the TOF ev. time per collision"};
+
+  HistogramRegistry histos{"Histos", {}, OutputObjHandlingPolicy::AnalysisObject};
+
+  /// TOF event time of a collision, computed for all the collisions of the data frame before filling the tables
+  struct collisionEvTimeInfo {
+    int collisionId = -1;                              /// Collision index
+    std::vector<int64_t> subsample;                    /// Global indices of the tracks used, only filled if the sample is capped
+    std::optional<o2::tof::eventTimeContainer> evTime; /// TOF event time
+    int nTracksInSample = 0;                           /// Tracks of the collision passing the track selection (before the cap)
+    float computingTime = 0.f;                         /// Time spent in the event time maker [us]
+  };
+  std::vector<collisionEvTimeInfo> collisionEvTimes;
 
   void init(o2::framework::InitContext& initContext)
   {
@@ -187,6 +256,15 @@ struct tofEventTime {
     if (sel8TOFEvTime.value == true) {
       LOG(info) << "TOF event time will be computed for collisions that pass the event selection only!";
     }
+    if (nThreads > 1) {
+      LOG(info) << "TOF event time will be computed with " << nThreads.value << " threads";
+    }
+    if (maxNtracksForEvTime > 0) {
+      LOG(info) << "TOF event time will be computed with at most " << maxNtracksForEvTime.value << " tracks per collision";
+    }
+    if (enableTimingHistogram) {
+      histos.add("hEvTimeComputingTime", "Computing time of the TOF ev. time;Tracks in the ev. time sample;Time (#mus)", kTH2F, {{200, 0, 2000}, {1000, 0, 100000}});
+    }
     // Getting the parametrization parameters
     ccdb->setURL(url.value);
     ccdb->setTimestamp(timestamp.value);
@@ -276,6 +354,93 @@ struct tofEventTime {
   template <o2::track::PID::ID pid>
   using ResponseImplementationEvTime = o2::pid::tof::ExpTimes<TrksEvTime::iterator, pid>;
   using EvTimeCollisions = soa::Join<aod::Collisions, aod::EvSels>;
+
+  /// Computes the TOF event time of all the collisions of the data frame, in the order in which their tracks are filled.
+  /// With nThreads > 1 the collisions are distributed dynamically to a pool of threads.
+  template <typename CollisionsType>
+  void computeEvTimes(TrksEvTime const& tracks)
+  {
+    collisionEvTimes.clear();
+    std::vector<decltype(tracks.sliceBy(perCollision, 0))> slices;
+    int lastCollisionId = -1;
+    for (auto const& t : tracks) {
+      if (!t.has_collision() || ((sel8TOFEvTime.value == true) && !t.template collision_as<CollisionsType>().sel8())) {
+        continue;
+      }
+      if (t.collisionId() == lastCollisionId) {
+        continue;
+      }
+      lastCollisionId = t.collisionId();
+      collisionEvTimes.emplace_back();
+      collisionEvTimes.back().collisionId = lastCollisionId;
+      slices.push_back(tracks.sliceBy(perCollision, lastCollisionId));
+    }
+
+    const size_t nCollisions = collisionEvTimes.size();
+    auto compute = [&](size_t iCollision, evTimeMakerBuffers* buffers) {
+      auto& collision = collisionEvTimes[iCollision];
+      const auto& tracksInCollision = slices[iCollision];
+      for (auto const& trk : tracksInCollision) {
+        collision.nTracksInSample += filterForTOFEventTime(trk);
+      }
+      // Deterministic cap of the sample: evenly spaced tracks, in the order of the table
+      if (maxNtracksForEvTime > 0 && collision.nTracksInSample > maxNtracksForEvTime) {
+        const int64_t nSample = collision.nTracksInSample;
+        const int64_t nKept = maxNtracksForEvTime;
+        int64_t rank = 0;
+        collision.subsample.reserve(nKept);
+        for (auto const& trk : tracksInCollision) {
+          if (!filterForTOFEventTime(trk)) {
+            continue;
+          }
+          if ((rank + 1) * nKept / nSample != rank * nKept / nSample) {
+            collision.subsample.push_back(trk.globalIndex());
+          }
+          rank++;
+        }
+        trackSampleSubsample = &collision.subsample;
+      }
+      const auto start = std::chrono::steady_clock::now();
+      if (buffers) {
+        collision.evTime.emplace(evTimeMakerForTracksReentrant<TrksEvTime::iterator, filterForTOFEventTimeSubsample, o2::pid::tof::ExpTimes>(tracksInCollision, mRespParamsV2, *buffers, diamond));
+      } else {
+        collision.evTime.emplace(evTimeMakerForTracks<TrksEvTime::iterator, filterForTOFEventTimeSubsample, o2::pid::tof::ExpTimes>(tracksInCollision, mRespParamsV2, diamond));
+      }
+      collision.computingTime = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+      trackSampleSubsample = nullptr;
+    };
+
+    if (nThreads <= 1 || nCollisions <= 1) {
+      for (size_t iCollision = 0; iCollision < nCollisions; iCollision++) {
+        compute(iCollision, nullptr);
+      }
+    } else {
+      std::atomic<size_t> nextCollision{0};
+      auto worker = [&]() {
+        evTimeMakerBuffers buffers;
+        for (size_t iCollision = nextCollision++; iCollision < nCollisions; iCollision = nextCollision++) {
+          compute(iCollision, &buffers);
+        }
+      };
+      std::vector<std::thread> workers;
+      const size_t nWorkers = std::min(static_cast<size_t>(nThreads.value), nCollisions);
+      for (size_t iWorker = 1; iWorker < nWorkers; iWorker++) {
+        workers.emplace_back(worker);
+      }
+      worker();
+      for (auto& thread : workers) {
+        thread.join();
+      }
+    }
+
+    if (enableTimingHistogram) {
+      for (const auto& collision : collisionEvTimes) {
+        const int nUsed = maxNtracksForEvTime > 0 ? std::min(collision.nTracksInSample, maxNtracksForEvTime.value) : collision.nTracksInSample;
+        histos.fill(HIST("hEvTimeComputingTime"), nUsed, collision.computingTime);
+      }
+    }
+  }
+
   void processNoFT0(TrksEvTime const& tracks,
                     EvTimeCollisions const&)
   {
@@ -289,6 +454,8 @@ struct tofEventTime {
       tableEvTimeTOFOnly.reserve(tracks.size());
     }
 
+    computeEvTimes<EvTimeCollisions>(tracks);
+    size_t iCollision = 0;                                                                                       // Index of the collision in collisionEvTimes
     int lastCollisionId = -1;                                                                                    // Last collision ID analysed
     for (auto const& t : tracks) {                                                                               // Loop on collisions
       if (!t.has_collision() || ((sel8TOFEvTime.value == true) && !t.collision_as<EvTimeCollisions>().sel8())) { // Track was not assigned, cannot compute event time or event did not pass the event selection
@@ -308,14 +475,16 @@ struct tofEventTime {
       const auto& tracksInCollision = tracks.sliceBy(perCollision, lastCollisionId);
 
       // First make table for event time
-      const auto evTimeTOF = evTimeMakerForTracks<TrksEvTime::iterator, filterForTOFEventTime, o2::pid::tof::ExpTimes>(tracksInCollision, mRespParamsV2, diamond);
+      const auto& collisionEvTime = collisionEvTimes[iCollision++];
+      const auto& evTimeTOF = *collisionEvTime.evTime;
+      trackSampleSubsample = collisionEvTime.subsample.empty() ? nullptr : &collisionEvTime.subsample;
       int nGoodTracksForTOF = 0;
       float et = evTimeTOF.mEventTime;
       float erret = evTimeTOF.mEventTimeError;
 
       for (auto const& trk : tracksInCollision) { // Loop on Tracks
         if constexpr (removeTOFEvTimeBias) {
-          evTimeTOF.removeBias<TrksEvTime::iterator, filterForTOFEventTime>(trk, nGoodTracksForTOF, et, erret, 2);
+          evTimeTOF.removeBias<TrksEvTime::iterator, filterForTOFEventTimeSubsample>(trk, nGoodTracksForTOF, et, erret, 2);
         }
         uint8_t flags = 0;
         if (erret < errDiamond && (maxEvTimeTOF <= 0.f || abs(et) < maxEvTimeTOF)) {
@@ -327,10 +496,11 @@ struct tofEventTime {
         tableFlags(flags);
         tableEvTime(et, erret);
         if (enableTableTOFOnly) {
-          tableEvTimeTOFOnly((uint8_t)filterForTOFEventTime(trk), et, erret, evTimeTOF.mEventTimeMultiplicity);
+          tableEvTimeTOFOnly((uint8_t)filterForTOFEventTimeSubsample(trk), et, erret, evTimeTOF.mEventTimeMultiplicity);
         }
       }
     }
+    trackSampleSubsample = nullptr;
   }
   PROCESS_SWITCH(tofEventTime, processNoFT0, "Process without FT0", true);
 
@@ -351,6 +521,8 @@ struct tofEventTime {
       tableEvTimeTOFOnly.reserve(tracks.size());
     }
 
+    computeEvTimes<EvTimeCollisionsFT0>(tracks);
+    size_t iCollision = 0;                                                                                          // Index of the collision in collisionEvTimes
     int lastCollisionId = -1;                                                                                       // Last collision ID analysed
     for (auto const& t : tracks) {                                                                                  // Loop on collisions
       if (!t.has_collision() || ((sel8TOFEvTime.value == true) && !t.collision_as<EvTimeCollisionsFT0>().sel8())) { // Track was not assigned, cannot compute event time or event did not pass the event selection
@@ -370,8 +542,10 @@ struct tofEventTime {
       const auto& tracksInCollision = tracks.sliceBy(perCollision, lastCollisionId);
       const auto& collision = t.collision_as<EvTimeCollisionsFT0>();
 
-      // Compute the TOF event time
-      const auto evTimeTOF = evTimeMakerForTracks<TrksEvTime::iterator, filterForTOFEventTime, o2::pid::tof::ExpTimes>(tracksInCollision, mRespParamsV2, diamond);
+      // TOF event time
+      const auto& collisionEvTime = collisionEvTimes[iCollision++];
+      const auto& evTimeTOF = *collisionEvTime.evTime;
+      trackSampleSubsample = collisionEvTime.subsample.empty() ? nullptr : &collisionEvTime.subsample;
 
       float t0AC[2] = {.0f, 999.f};                                                                                   // Value and error of T0A or T0C or T0AC
       float t0TOF[2] = {static_cast<float_t>(evTimeTOF.mEventTime), static_cast<float_t>(evTimeTOF.mEventTimeError)}; // Value and error of TOF
@@ -391,7 +565,7 @@ struct tofEventTime {
         weight = 0.f;
         // Remove the bias on TOF ev. time
         if constexpr (removeTOFEvTimeBias) {
-          evTimeTOF.removeBias<TrksEvTime::iterator, filterForTOFEventTime>(trk, nGoodTracksForTOF, t0TOF[0], t0TOF[1], 2);
+          evTimeTOF.removeBias<TrksEvTime::iterator, filterForTOFEventTimeSubsample>(trk, nGoodTracksForTOF, t0TOF[0], t0TOF[1], 2);
         }
         if (t0TOF[1] < errDiamond && (maxEvTimeTOF <= 0 || abs(t0TOF[0]) < maxEvTimeTOF)) {
           flags |= o2::aod::pidflags::enums::PIDFlags::EvTimeTOF;
@@ -423,10 +597,11 @@ struct tofEventTime {
         }
         tableEvTime(eventTime / sumOfWeights, sqrt(1. / sumOfWeights));
         if (enableTableTOFOnly) {
-          tableEvTimeTOFOnly((uint8_t)filterForTOFEventTime(trk), t0TOF[0], t0TOF[1], evTimeTOF.mEventTimeMultiplicity);
+          tableEvTimeTOFOnly((uint8_t)filterForTOFEventTimeSubsample(trk), t0TOF[0], t0TOF[1], evTimeTOF.mEventTimeMultiplicity);
         }
       }
     }
+    trackSampleSubsample = nullptr;
   }
   PROCESS_SWITCH(tofEventTime, processFT0, "Process with FT0", false);
 
@@ -15,6 +15,8 @@
 /// \brief  Task to produce TOF beta and TOF mass tables
 ///
 
+#include <vector>
+
 // O2 includes
 #include "CCDB/BasicCCDBManager.h"
 #include "Framework/AnalysisTask.h"
@@ -127,26 +129,60 @@ struct tofPidBeta {
   o2::pid::tof::Beta<Trks::iterator> responseBeta;
   template <o2::track::PID::ID pid>
   using ResponseImplementation = o2::pid::tof::ExpTimes<Trks::iterator, pid>;
+
+  // Buffers of the columnar computation, reused across data frames
+  std::vector<float> bufferLength;
+  std::vector<float> bufferTOFSignal;
+  std::vector<float> bufferEvTime;
+  std::vector<uint8_t> bufferDetectorMap;
+  std::vector<float> momentum;
+  std::vector<float> beta;
+  std::vector<float> betaError;
+  std::vector<float> mass;
+
   void process(Trks const& tracks)
   {
     if (!enableTableBeta && !enableTableMass) {
       return;
     }
-    float beta = 0.f;
-    tablePIDBeta.reserve(tracks.size());
-    for (auto const& trk : tracks) {
-      beta = responseBeta.GetBeta(trk);
-      if (enableTableBeta) {
-        tablePIDBeta(beta,
-                     responseBeta.GetExpectedSigma(trk));
-      }
-      if (enableTableMass) {
-        if (enableTOFParams) {
-          tablePIDTOFMass(o2::pid::tof::TOFMass<Trks::iterator>::GetTOFMass(trk.tofExpMom() / (1.f + trk.sign() * mRespParamsV2.getShift(trk.eta())), beta));
-        } else {
-          tablePIDTOFMass(o2::pid::tof::TOFMass<Trks::iterator>::GetTOFMass(trk, beta));
+    const int64_t nTracks = tracks.size();
+    // Input columns read in place from the table
+    const float* length = getColumnValues<aod::track::Length>(tracks, bufferLength);
+    const float* tofSignal = getColumnValues<aod::pidtofsignal::TOFSignal>(tracks, bufferTOFSignal);
+    const float* evTime = getColumnValues<aod::pidtofevtime::TOFEvTime>(tracks, bufferEvTime);
+    const uint8_t* detectorMap = getColumnValues<aod::track::DetectorMap>(tracks, bufferDetectorMap);
+    // The momentum is a dynamic column and is filled from the tracks
+    if (enableTableMass) {
+      momentum.resize(nTracks);
+      int64_t i = 0;
+      if (enableTOFParams) {
+        for (auto const& trk : tracks) {
+          momentum[i++] = trk.tofExpMom() / (1.f + trk.sign() * mRespParamsV2.getShift(trk.eta()));
+        }
+      } else {
+        for (auto const& trk : tracks) {
+          momentum[i++] = trk.p();
         }
       }
+      mass.resize(nTracks);
+    }
+    beta.resize(nTracks);
+    betaError.resize(nTracks);
+    o2::pid::tof::BetaKernel::Compute(nTracks, length, tofSignal, evTime, detectorMap, responseBeta.mExpectedResolution,
+                                      beta.data(), enableTableBeta ? betaError.data() : nullptr,
+                                      enableTableMass ? momentum.data() : nullptr, enableTableMass ? mass.data() : nullptr);
+
+    if (enableTableBeta) {
+      tablePIDBeta.reserve(nTracks);
+      for (int64_t i = 0; i < nTracks; i++) {
+        tablePIDBeta(beta[i], betaError[i]);
+      }
+    }
+    if (enableTableMass) {
+      tablePIDTOFMass.reserve(nTracks);
+      for (int64_t i = 0; i < nTracks; i++) {
+        tablePIDTOFMass(mass[i]);
+      }
     }
   }
 };
@@ -84,6 +84,10 @@ struct tpcPidFull {
   Configurable<std::string> url{"ccdb-url", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
   Configurable<std::string> ccdbPath{"ccdbPath", "Analysis/PID/TPC/Response", "Path of the TPC parametrization on the CCDB"};
   Configurable<int64_t> ccdbTimestamp{"ccdb-timestamp", 0, "timestamp of the object used to query in CCDB the detector response. Exceptions: -1 gets the latest object, 0 gets the run dependent timestamp"};
+  // Parameters for the Bethe-Bloch lookup table
+  Configurable<bool> useBetheBlochLUT{"useBetheBlochLUT", false, "(bool) Evaluate the Bethe-Bloch parametrization from a lookup table in log(betagamma), built when the response parameters are loaded"};
+  Configurable<int> betheBlochLUTBins{"betheBlochLUTBins", 4096, "Number of intervals of the Bethe-Bloch lookup table"};
+  Configurable<float> betheBlochLUTTolerance{"betheBlochLUTTolerance", 1.e-4f, "Maximum relative deviation of the Bethe-Bloch lookup table from the analytic parametrization, otherwise the analytic parametrization is used"};
   // Parameters for loading network from a file / downloading the file
   Configurable<bool> useNetworkCorrection{"useNetworkCorrection", 0, "(bool) Wether or not to use the network correction for the TPC dE/dx signal"};
   Configurable<bool> autofetchNetworks{"autofetchNetworks", 1, "(bool) Automatically fetches networks from CCDB for the correct run number"};
@@ -91,6 +95,7 @@ struct tpcPidFull {
   Configurable<std::string> networkPathCCDB{"networkPathCCDB", "Analysis/PID/TPC/ML", "Path on CCDB"};
   Configurable<bool> enableNetworkOptimizations{"enableNetworkOptimizations", 1, "(bool) If the neural network correction is used, this enables GraphOptimizationLevel::ORT_ENABLE_EXTENDED in the ONNX session"};
   Configurable<int> networkSetNumThreads{"networkSetNumThreads", 0, "Especially important for running on a SLURM cluster. Sets the number of threads used for execution."};
+  Configurable<int64_t> networkMaxBatchSize{"networkMaxBatchSize", 0, "Maximum number of rows (tracks x mass hypotheses) evaluated by the network in one call, to bound the memory usage. 0 evaluates all rows at once"};
   // Configuration flags to include and exclude particle hypotheses
   Configurable<int> pidEl{"pid-el", -1, {"Produce PID information for the Electron mass hypothesis, overrides the automatic setup: the corresponding table can be set off (0) or on (1)"}};
   Configurable<int> pidMu{"pid-mu", -1, {"Produce PID information for the Muon mass hypothesis, overrides the automatic setup: the corresponding table can be set off (0) or on (1)"}};
@@ -104,6 +109,9 @@ struct tpcPidFull {
 
   // Paramatrization configuration
   bool useCCDBParam = false;
+  // Position of each mass hypothesis in the inputs of the network, -1 if its table is not produced
+  std::array<int, 9> hypothesisSlots{};
+  int nEnabledHypotheses = 0;
 
   void init(o2::framework::InitContext& initContext)
   {
@@ -120,8 +128,19 @@ struct tpcPidFull {
     enableFlag("Tr", pidTr);
     enableFlag("He", pidHe);
     enableFlag("Al", pidAl);
+    // Only the hypotheses of the produced tables are evaluated, e.g. by the network correction
+    const std::array<int, 9> flags{pidEl.value, pidMu.value, pidPi.value, pidKa.value, pidPr.value, pidDe.value, pidTr.value, pidHe.value, pidAl.value};
+    for (int i = 0; i < 9; i++) {
+      hypothesisSlots[i] = flags[i] == 1 ? nEnabledHypotheses++ : -1;
+    }
+    if (nEnabledHypotheses == 0) {
+      LOG(info) << "No TPC PID table is required in the workflow, the tables will be sent empty";
+    }
 
     /// TPC PID Response
+    if (useBetheBlochLUT) {
+      response.EnableBetheBlochLUT(betheBlochLUTBins.value, betheBlochLUTTolerance.value);
+    }
     const TString fname = paramfile.value;
     if (fname != "") { // Loading the parametrization from file
       LOGP(info, "Loading TPC response from file {}", fname);
@@ -209,6 +228,9 @@ struct tpcPidFull {
     reserveTable(pidTr, tablePIDTr);
     reserveTable(pidHe, tablePIDHe);
     reserveTable(pidAl, tablePIDAl);
+    if (nEnabledHypotheses == 0) {
+      return;
+    }
 
     std::vector<float> network_prediction;
 
@@ -232,21 +254,20 @@ struct tpcPidFull {
 
       // Defining some network parameters
       int input_dimensions = network.getNumInputNodes();
-      int output_dimensions = network.getNumOutputNodes();
       const uint64_t track_prop_size = input_dimensions * tracks_size;
-      const uint64_t prediction_size = output_dimensions * tracks_size;
 
-      network_prediction = std::vector<float>(prediction_size * 9); // For each mass hypotheses
       const float nNclNormalization = response.GetNClNormalization();
       float duration_network = 0;
 
-      std::vector<float> track_properties(track_prop_size);
+      std::vector<float> track_properties(track_prop_size * nEnabledHypotheses); // For each enabled mass hypothesis
       uint64_t counter_track_props = 0;
-      int loop_counter = 0;
 
-      // Filling a std::vector<float> to be evaluated by the network
-      // Evaluation on single tracks brings huge overhead: Thus evaluation is done on one large vector
+      // Filling a contiguous std::vector<float> with the inputs of all tracks and mass hypotheses to be evaluated by the network
+      // Evaluation on single tracks brings huge overhead: Thus evaluation is done on one large vector, in batches of at most networkMaxBatchSize rows
       for (int i = 0; i < 9; i++) { // Loop over particle number for which network correction is used
+        if (hypothesisSlots[i] < 0) {
+          continue;
+        }
         for (auto const& trk : tracks) {
           track_properties[counter_track_props] = trk.tpcInnerParam();
           track_properties[counter_track_props + 1] = trk.tgl();
@@ -256,25 +277,19 @@ struct tpcPidFull {
           track_properties[counter_track_props + 5] = std::sqrt(nNclNormalization / trk.tpcNClsFound());
           counter_track_props += input_dimensions;
         }
+      }
 
-        auto start_network_eval = std::chrono::high_resolution_clock::now();
-        float* output_network = network.evalModel(track_properties);
-        auto stop_network_eval = std::chrono::high_resolution_clock::now();
-        duration_network += std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_eval - start_network_eval).count();
-        for (uint64_t i = 0; i < prediction_size; i += output_dimensions) {
-          for (int j = 0; j < output_dimensions; j++) {
-            network_prediction[i + j + prediction_size * loop_counter] = output_network[i + j];
-          }
-        }
-
-        counter_track_props = 0;
-        loop_counter += 1;
+      auto start_network_eval = std::chrono::high_resolution_clock::now();
+      if (!network.evalModelBatched(track_properties, network_prediction, networkMaxBatchSize.value)) {
+        LOG(fatal) << "Error encountered while evaluating the network for the TPC PID response correction";
       }
+      auto stop_network_eval = std::chrono::high_resolution_clock::now();
+      duration_network += std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_eval - start_network_eval).count();
       track_properties.clear();
 
       auto stop_network_total = std::chrono::high_resolution_clock::now();
-      LOG(debug) << "Neural Network for the TPC PID response correction: Time per track (eval ONNX): " << duration_network / (tracks_size * 9) << "ns ; Total time (eval ONNX): " << duration_network / 1000000000 << " s";
-      LOG(debug) << "Neural Network for the TPC PID response correction: Time per track (eval + overhead): " << std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_total - start_network_total).count() / (tracks_size * 9) << "ns ; Total time (eval + overhead): " << std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_total - start_network_total).count() / 1000000000 << " s";
+      LOG(debug) << "Neural Network for the TPC PID response correction: Time per track (eval ONNX): " << duration_network / (tracks_size * nEnabledHypotheses) << "ns ; Total time (eval ONNX): " << duration_network / 1000000000 << " s";
+      LOG(debug) << "Neural Network for the TPC PID response correction: Time per track (eval + overhead): " << std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_total - start_network_total).count() / (tracks_size * nEnabledHypotheses) << "ns ; Total time (eval + overhead): " << std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_total - start_network_total).count() / 1000000000 << " s";
     }
 
     int lastCollisionId = -1; // Last collision ID analysed
@@ -299,17 +314,17 @@ struct tpcPidFull {
           // For now only the option 2: sigma will be used. The other options are kept if there would be demand later on
           if (network.getNumOutputNodes() == 1) {
             table(response.GetExpectedSigma(collisions.iteratorAt(trk.collisionId()), trk, pid),
-                  (trk.tpcSignal() - network_prediction[count_tracks + tracks_size * pid] * response.GetExpectedSignal(trk, pid)) / response.GetExpectedSigma(collisions.iteratorAt(trk.collisionId()), trk, pid));
+                  (trk.tpcSignal() - network_prediction[count_tracks + tracks_size * hypothesisSlots[pid]] * response.GetExpectedSignal(trk, pid)) / response.GetExpectedSigma(collisions.iteratorAt(trk.collisionId()), trk, pid));
           } else if (network.getNumOutputNodes() == 2) {
-            table((network_prediction[2 * (count_tracks + tracks_size * pid) + 1] - network_prediction[2 * (count_tracks + tracks_size * pid)]) * response.GetExpectedSignal(trk, pid),
-                  (trk.tpcSignal() / response.GetExpectedSignal(trk, pid) - network_prediction[2 * (count_tracks + tracks_size * pid)]) / (network_prediction[2 * (count_tracks + tracks_size * pid) + 1] - network_prediction[2 * (count_tracks + tracks_size * pid)]));
+            table((network_prediction[2 * (count_tracks + tracks_size * hypothesisSlots[pid]) + 1] - network_prediction[2 * (count_tracks + tracks_size * hypothesisSlots[pid])]) * response.GetExpectedSignal(trk, pid),
+                  (trk.tpcSignal() / response.GetExpectedSignal(trk, pid) - network_prediction[2 * (count_tracks + tracks_size * hypothesisSlots[pid])]) / (network_prediction[2 * (count_tracks + tracks_size * hypothesisSlots[pid]) + 1] - network_prediction[2 * (count_tracks + tracks_size * hypothesisSlots[pid])]));
           } else if (network.getNumOutputNodes() == 3) {
-            if (trk.tpcSignal() / response.GetExpectedSignal(trk, pid) >= network_prediction[3 * (count_tracks + tracks_size * pid)]) {
-              table((network_prediction[3 * (count_tracks + tracks_size * pid) + 1] - network_prediction[3 * (count_tracks + tracks_size * pid)]) * response.GetExpectedSignal(trk, pid),
-                    (trk.tpcSignal() / response.GetExpectedSignal(trk, pid) - network_prediction[3 * (count_tracks + tracks_size * pid)]) / (network_prediction[3 * (count_tracks + tracks_size * pid) + 1] - network_prediction[3 * (count_tracks + tracks_size * pid)]));
+            if (trk.tpcSignal() / response.GetExpectedSignal(trk, pid) >= network_prediction[3 * (count_tracks + tracks_size * hypothesisSlots[pid])]) {
+              table((network_prediction[3 * (count_tracks + tracks_size * hypothesisSlots[pid]) + 1] - network_prediction[3 * (count_tracks + tracks_size * hypothesisSlots[pid])]) * response.GetExpectedSignal(trk, pid),
+                    (trk.tpcSignal() / response.GetExpectedSignal(trk, pid) - network_prediction[3 * (count_tracks + tracks_size * hypothesisSlots[pid])]) / (network_prediction[3 * (count_tracks + tracks_size * hypothesisSlots[pid]) + 1] - network_prediction[3 * (count_tracks + tracks_size * hypothesisSlots[pid])]));
             } else {
-              table((network_prediction[3 * (count_tracks + tracks_size * pid)] - network_prediction[3 * (count_tracks + tracks_size * pid) + 2]) * response.GetExpectedSignal(trk, pid),
-                    (trk.tpcSignal() / response.GetExpectedSignal(trk, pid) - network_prediction[3 * (count_tracks + tracks_size * pid)]) / (network_prediction[3 * (count_tracks + tracks_size * pid)] - network_prediction[3 * (count_tracks + tracks_size * pid) + 2]));
+              table((network_prediction[3 * (count_tracks + tracks_size * hypothesisSlots[pid])] - network_prediction[3 * (count_tracks + tracks_size * hypothesisSlots[pid]) + 2]) * response.GetExpectedSignal(trk, pid),
+                    (trk.tpcSignal() / response.GetExpectedSignal(trk, pid) - network_prediction[3 * (count_tracks + tracks_size * hypothesisSlots[pid])]) / (network_prediction[3 * (count_tracks + tracks_size * hypothesisSlots[pid])] - network_prediction[3 * (count_tracks + tracks_size * hypothesisSlots[pid]) + 2]));
             }
           } else {
             LOGF(fatal, "Network output-dimensions incompatible!");
@@ -51,6 +51,10 @@ struct caloClusterProducerTask {
   std::vector<o2::phos::CluElement> outputCluElements;
   std::vector<o2::phos::Cluster> outputPHOSClusters;
   std::vector<o2::phos::TriggerRecord> outputPHOSClusterTrigRecs;
+  // calibration objects given to the clusterizer, owned by the CCDB cache
+  const o2::phos::BadChannelsMap* currentBadMap = nullptr;
+  const o2::phos::CalibParams* currentCalibParams = nullptr;
+  const std::vector<int>* currentL1phase = nullptr;
   static constexpr int16_t kCpvX = 7; // grid 13 steps along z and 7 along phi as largest match ellips 20x10 cm
   static constexpr int16_t kCpvZ = 13;
   static constexpr int16_t kCpvCells = 4 * kCpvX * kCpvZ; // 4 modules
@@ -91,72 +95,47 @@ struct caloClusterProducerTask {
     clusterizerPHOS = std::make_unique<o2::phos::Clusterer>();
   }
 
-  void processStandalone(o2::aod::BCsWithTimestamps const& bcs,
-                         o2::aod::Collisions const& colls,
-                         o2::aod::Calos const& cells,
-                         o2::aod::CaloTriggers const& ctrs,
-                         o2::aod::CPVClusters const& cpvs)
+  /// Sets the bad map, the calibration and the L1 phase of the clusterizer, only when the CCDB objects change
+  void updateCalibration(int64_t timestamp)
   {
-
-    int64_t timestamp = 0;
-    if (bcs.begin() != bcs.end()) {
-      timestamp = bcs.begin().timestamp(); // timestamp for CCDB object retrieval
-    }
-    std::map<int64_t, int> bcMap;
-    int bcId = 0;
-    for (auto bc : bcs) {
-      bcMap[bc.globalBC()] = bcId;
-      bcId++;
-    }
-
-    // If several collisions appear in BC, choose one with largers number of contributors
-    std::map<int64_t, int> colMap;
-    int colId = 0;
-    for (auto cl : colls) {
-      auto colbc = colMap.find(cl.bc_as<aod::BCsWithTimestamps>().globalBC());
-      if (colbc == colMap.end()) { // single collision per BC
-        colMap[cl.bc_as<aod::BCsWithTimestamps>().globalBC()] = colId;
-      } else { // not unique collision per BC
-        auto coll2 = colls.begin() + colbc->second;
-        if (cl.numContrib() > coll2.numContrib()) {
-          colMap[cl.bc_as<aod::BCsWithTimestamps>().globalBC()] = colId;
-        }
-      }
-      colId++;
-    }
-
-    // Fill list of cells and cell TrigRecs per TF as an input for clusterizer
-    // clusterize
-    // Fill output table
-
     // calibration may be updated by CCDB fetcher
     const o2::phos::BadChannelsMap* badMap = ccdb->getForTimeStamp<o2::phos::BadChannelsMap>("PHS/Calib/BadMap", timestamp);
     const o2::phos::CalibParams* calibParams = ccdb->getForTimeStamp<o2::phos::CalibParams>("PHS/Calib/CalibParams", timestamp);
 
     if (!isMC && !skipL1phase) {
       const std::vector<int>* vec = ccdb->getForTimeStamp<std::vector<int>>("PHS/Calib/L1phase", timestamp);
-      if (vec) {
-        clusterizerPHOS->setL1phase((*vec)[0]);
-      } else {
+      if (!vec) {
         LOG(fatal) << "Can not get PHOS L1phase calibration";
       }
+      if (vec != currentL1phase) {
+        clusterizerPHOS->setL1phase((*vec)[0]);
+        currentL1phase = vec;
+      }
     }
 
-    if (badMap) {
-      clusterizerPHOS->setBadMap(badMap);
-    } else {
+    if (!badMap) {
       LOG(fatal) << "Can not get PHOS Bad Map";
     }
-    if (calibParams) {
-      clusterizerPHOS->setCalibration(calibParams);
-    } else {
+    if (badMap != currentBadMap) {
+      clusterizerPHOS->setBadMap(badMap);
+      currentBadMap = badMap;
+    }
+    if (!calibParams) {
       LOG(fatal) << "Can not get PHOS calibration";
     }
+    if (calibParams != currentCalibParams) {
+      clusterizerPHOS->setCalibration(calibParams);
+      currentCalibParams = calibParams;
+    }
+  }
 
+  /// Fills the PHOS cells and their trigger records, one per BC, and clusterizes them
+  void clusterizeCells(o2::aod::Calos const& cells, std::size_t nBCs)
+  {
     phosCells.clear();
     phosCells.reserve(cells.size());
     phosCellTRs.clear();
-    phosCellTRs.reserve(bcs.size());
+    phosCellTRs.reserve(nBCs);
     outputCluElements.clear();
     outputPHOSClusters.clear();
     outputPHOSClusterTrigRecs.clear();
@@ -170,15 +149,16 @@ struct caloClusterProducerTask {
       if ((c.cellType() == phos::TRU2x2 || c.cellType() == phos::TRU4x4) && c.cellNumber() == 0) {
         continue;
       }
+      const uint64_t globalBC = c.bc_as<aod::BCsWithTimestamps>().globalBC();
       if (phosCellTRs.size() == 0) { // first cell, first TrigRec
-        ir.setFromLong(c.bc_as<aod::BCsWithTimestamps>().globalBC());
+        ir.setFromLong(globalBC);
         phosCellTRs.emplace_back(ir, 0, 0); // BC,first cell, ncells
       }
-      if (static_cast<uint64_t>(phosCellTRs.back().getBCData().toLong()) != c.bc_as<aod::BCsWithTimestamps>().globalBC()) { // switch to new BC
+      if (static_cast<uint64_t>(phosCellTRs.back().getBCData().toLong()) != globalBC) { // switch to new BC
         // switch to another BC: set size and create next TriRec
         phosCellTRs.back().setNumberOfObjects(phosCells.size() - phosCellTRs.back().getFirstEntry());
         // Next event/trig rec.
-        ir.setFromLong(c.bc_as<aod::BCsWithTimestamps>().globalBC());
+        ir.setFromLong(globalBC);
         phosCellTRs.emplace_back(ir, phosCells.size(), 0);
       }
       phosCells.emplace_back(c.cellNumber(), c.amplitude(), c.time(),
@@ -201,6 +181,48 @@ struct caloClusterProducerTask {
       clusterizerPHOS->processCells(phosCells, phosCellTRs, nullptr,
                                     outputPHOSClusters, outputCluElements, outputPHOSClusterTrigRecs, dummyMC);
     }
+  }
+
+  void processStandalone(o2::aod::BCsWithTimestamps const& bcs,
+                         o2::aod::Collisions const& colls,
+                         o2::aod::Calos const& cells,
+                         o2::aod::CaloTriggers const& ctrs,
+                         o2::aod::CPVClusters const& cpvs)
+  {
+
+    int64_t timestamp = 0;
+    if (bcs.begin() != bcs.end()) {
+      timestamp = bcs.begin().timestamp(); // timestamp for CCDB object retrieval
+    }
+    std::map<int64_t, int> bcMap;
+    int bcId = 0;
+    for (auto bc : bcs) {
+      bcMap[bc.globalBC()] = bcId;
+      bcId++;
+    }
+
+    // If several collisions appear in BC, choose one with largers number of contributors
+    std::map<int64_t, int> colMap;
+    int colId = 0;
+    for (auto cl : colls) {
+      auto colbc = colMap.find(cl.bc_as<aod::BCsWithTimestamps>().globalBC());
+      if (colbc == colMap.end()) { // single collision per BC
+        colMap[cl.bc_as<aod::BCsWithTimestamps>().globalBC()] = colId;
+      } else { // not unique collision per BC
+        auto coll2 = colls.begin() + colbc->second;
+        if (cl.numContrib() > coll2.numContrib()) {
+          colMap[cl.bc_as<aod::BCsWithTimestamps>().globalBC()] = colId;
+        }
+      }
+      colId++;
+    }
+
+    // Fill list of cells and cell TrigRecs per TF as an input for clusterizer
+    // clusterize
+    // Fill output table
+
+    updateCalibration(timestamp);
+    clusterizeCells(cells, bcs.size());
 
     // Find  CPV clusters corresponding to PHOS trigger records
     std::vector<std::pair<float, float>> cpvMatchPoints[kCpvCells];
@@ -430,78 +452,8 @@ struct caloClusterProducerTask {
     // clusterize
     // Fill output table
 
-    // calibration may be updated by CCDB fetcher
-    const o2::phos::BadChannelsMap* badMap = ccdb->getForTimeStamp<o2::phos::BadChannelsMap>("PHS/Calib/BadMap", timestamp);
-    const o2::phos::CalibParams* calibParams = ccdb->getForTimeStamp<o2::phos::CalibParams>("PHS/Calib/CalibParams", timestamp);
-
-    if (!isMC && !skipL1phase) {
-      const std::vector<int>* vec = ccdb->getForTimeStamp<std::vector<int>>("PHS/Calib/L1phase", timestamp);
-      if (vec) {
-        clusterizerPHOS->setL1phase((*vec)[0]);
-      } else {
-        LOG(fatal) << "Can not get PHOS L1phase calibration";
-      }
-    }
-
-    if (badMap) {
-      clusterizerPHOS->setBadMap(badMap);
-    } else {
-      LOG(fatal) << "Can not get PHOS Bad Map";
-    }
-    if (calibParams) {
-      clusterizerPHOS->setCalibration(calibParams);
-    } else {
-      LOG(fatal) << "Can not get PHOS calibration";
-    }
-
-    phosCells.clear();
-    phosCells.reserve(cells.size());
-    phosCellTRs.clear();
-    phosCellTRs.reserve(bcs.size());
-    outputCluElements.clear();
-    outputPHOSClusters.clear();
-    outputPHOSClusterTrigRecs.clear();
-
-    o2::InteractionRecord ir;
-    const int kPHOS = 0;
-    for (auto& c : cells) {
-      if (c.caloType() != kPHOS) // PHOS
-        continue;
-      // Fix for bug in trigger digits
-      if ((c.cellType() == phos::TRU2x2 || c.cellType() == phos::TRU4x4) && c.cellNumber() == 0) {
-        continue;
-      }
-      if (phosCellTRs.size() == 0) { // first cell, first TrigRec
-        ir.setFromLong(c.bc_as<aod::BCsWithTimestamps>().globalBC());
-        phosCellTRs.emplace_back(ir, 0, 0); // BC,first cell, ncells
-      }
-      if (static_cast<uint64_t>(phosCellTRs.back().getBCData().toLong()) != c.bc_as<aod::BCsWithTimestamps>().globalBC()) { // switch to new BC
-        // switch to another BC: set size and create next TriRec
-        phosCellTRs.back().setNumberOfObjects(phosCells.size() - phosCellTRs.back().getFirstEntry());
-        // Next event/trig rec.
-        ir.setFromLong(c.bc_as<aod::BCsWithTimestamps>().globalBC());
-        phosCellTRs.emplace_back(ir, phosCells.size(), 0);
-      }
-      phosCells.emplace_back(c.cellNumber(), c.amplitude(), c.time(),
-                             static_cast<o2::phos::ChannelType_t>(c.cellType()));
-      // TODO process MC info
-    }
-    // Set number of cells in last TrigRec
-    if (phosCellTRs.size() > 0) {
-      phosCellTRs.back().setNumberOfObjects(phosCells.size() - phosCellTRs.back().getFirstEntry());
-    }
-
-    // clusterize
-    if (isMC) {
-      o2::dataformats::MCTruthContainer<o2::phos::MCLabel> cellTruth;
-      o2::dataformats::MCTruthContainer<o2::phos::MCLabel> outputTruthCont;
-      clusterizerPHOS->processCells(phosCells, phosCellTRs, &cellTruth,
-                                    outputPHOSClusters, outputCluElements, outputPHOSClusterTrigRecs, outputTruthCont);
-    } else {
-      o2::dataformats::MCTruthContainer<o2::phos::MCLabel> dummyMC;
-      clusterizerPHOS->processCells(phosCells, phosCellTRs, nullptr,
-                                    outputPHOSClusters, outputCluElements, outputPHOSClusterTrigRecs, dummyMC);
-    }
+    updateCalibration(timestamp);
+    clusterizeCells(cells, bcs.size());
 
     // Find  CPV clusters corresponding to PHOS trigger records
     std::vector<std::pair<float, float>> cpvMatchPoints[kCpvCells];
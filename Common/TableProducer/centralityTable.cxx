@@ -18,9 +18,11 @@
 #include "Framework/RunningWorkflowInfo.h"
 #include "Common/DataModel/Multiplicity.h"
 #include "Common/DataModel/Centrality.h"
+#include "Common/Core/FlatHistogram.h"
 #include <CCDB/BasicCCDBManager.h>
 #include <TH1F.h>
 #include <TFormula.h>
+#include <map>
 
 using namespace o2;
 using namespace o2::framework;
@@ -59,45 +61,45 @@ struct CentralityTable {
   int mRunNumber;
   struct tagRun2V0MCalibration {
     bool mCalibrationStored = false;
-    TFormula* mMCScale = nullptr;
+    bool mMCScaleStored = false;
     float mMCScalePars[6] = {0.0};
-    TH1* mhVtxAmpCorrV0A = nullptr;
-    TH1* mhVtxAmpCorrV0C = nullptr;
-    TH1* mhMultSelCalib = nullptr;
+    FlatHistogram mhVtxAmpCorrV0A;
+    FlatHistogram mhVtxAmpCorrV0C;
+    FlatHistogram mhMultSelCalib;
   } Run2V0MInfo;
   struct tagRun2SPDTrackletsCalibration {
     bool mCalibrationStored = false;
-    TH1* mhVtxAmpCorr = nullptr;
-    TH1* mhMultSelCalib = nullptr;
+    FlatHistogram mhVtxAmpCorr;
+    FlatHistogram mhMultSelCalib;
   } Run2SPDTksInfo;
   struct tagRun2SPDClustersCalibration {
     bool mCalibrationStored = false;
-    TH1* mhVtxAmpCorrCL0 = nullptr;
-    TH1* mhVtxAmpCorrCL1 = nullptr;
-    TH1* mhMultSelCalib = nullptr;
+    FlatHistogram mhVtxAmpCorrCL0;
+    FlatHistogram mhVtxAmpCorrCL1;
+    FlatHistogram mhMultSelCalib;
   } Run2SPDClsInfo;
   struct tagRun2CL0Calibration {
     bool mCalibrationStored = false;
-    TH1* mhVtxAmpCorr = nullptr;
-    TH1* mhMultSelCalib = nullptr;
+    FlatHistogram mhVtxAmpCorr;
+    FlatHistogram mhMultSelCalib;
   } Run2CL0Info;
   struct tagRun2CL1Calibration {
     bool mCalibrationStored = false;
-    TH1* mhVtxAmpCorr = nullptr;
-    TH1* mhMultSelCalib = nullptr;
+    FlatHistogram mhVtxAmpCorr;
+    FlatHistogram mhMultSelCalib;
   } Run2CL1Info;
   struct calibrationInfo {
     std::string name = "";
     bool mCalibrationStored = false;
-    TH1* mhMultSelCalib = nullptr;
+    FlatHistogram mhMultSelCalib;
     float mMCScalePars[6] = {0.0};
-    TFormula* mMCScale = nullptr;
+    bool mMCScaleStored = false;
     calibrationInfo(std::string name)
       : name(name),
         mCalibrationStored(false),
-        mhMultSelCalib(nullptr),
+        mhMultSelCalib(),
         mMCScalePars{0.0},
-        mMCScale(nullptr)
+        mMCScaleStored(false)
     {
     }
   };
@@ -108,6 +110,27 @@ struct CentralityTable {
   calibrationInfo FDDMInfo = calibrationInfo("FDD");
   calibrationInfo NTPVInfo = calibrationInfo("NTracksPV");
 
+  /* per-run calibration cache, kept across data frames: the calibration objects are
+     fetched once per run and flattened, so that switching back and forth between runs
+     in merged AO2Ds does not trigger new CCDB queries nor TH1 lookups */
+  struct run2Calibration {
+    tagRun2V0MCalibration V0M;
+    tagRun2SPDTrackletsCalibration SPDTks;
+    tagRun2SPDClustersCalibration SPDCls;
+    tagRun2CL0Calibration CL0;
+    tagRun2CL1Calibration CL1;
+  };
+  struct run3Calibration {
+    calibrationInfo FV0A = calibrationInfo("FV0");
+    calibrationInfo FT0M = calibrationInfo("FT0");
+    calibrationInfo FT0A = calibrationInfo("FT0A");
+    calibrationInfo FT0C = calibrationInfo("FT0C");
+    calibrationInfo FDDM = calibrationInfo("FDD");
+    calibrationInfo NTPV = calibrationInfo("NTracksPV");
+  };
+  std::map<int, run2Calibration> mRun2Calibrations;
+  std::map<int, run3Calibration> mRun3Calibrations;
+
   void init(InitContext& context)
   {
     if (doprocessRun2 == false && doprocessRun3 == false) {
@@ -157,103 +180,116 @@ struct CentralityTable {
 
   using BCsWithTimestampsAndRun2Infos = soa::Join<aod::BCs, aod::Run2BCInfos, aod::Timestamps>;
 
-  void processRun2(soa::Join<aod::Collisions, aod::Mults>::iterator const& collision, BCsWithTimestampsAndRun2Infos const&)
+  /// Fetches and flattens the Run 2 calibration of the enabled estimators for a given run
+  run2Calibration fetchRun2Calibration(int runNumber, uint64_t timestamp)
   {
-    /* check the previous run number */
-    auto bc = collision.bc_as<BCsWithTimestampsAndRun2Infos>();
-    if (bc.runNumber() != mRunNumber) {
-      LOGF(debug, "timestamp=%llu", bc.timestamp());
-      TList* callst = ccdb->getForTimeStamp<TList>(ccdbPath, bc.timestamp());
+    run2Calibration calibration;
+    LOGF(debug, "timestamp=%llu", timestamp);
+    TList* callst = ccdb->getForTimeStamp<TList>(ccdbPath, timestamp);
 
-      Run2V0MInfo.mCalibrationStored = false;
-      Run2SPDTksInfo.mCalibrationStored = false;
-      Run2SPDClsInfo.mCalibrationStored = false;
-      Run2CL0Info.mCalibrationStored = false;
-      Run2CL1Info.mCalibrationStored = false;
-      if (callst != nullptr) {
-        auto getccdb = [callst](const char* ccdbhname) {
-          TH1* h = (TH1*)callst->FindObject(ccdbhname);
-          return h;
-        };
-        auto getformulaccdb = [callst](const char* ccdbhname) {
-          TFormula* f = (TFormula*)callst->FindObject(ccdbhname);
-          return f;
-        };
-        if (estRun2V0M == 1) {
-          LOGF(debug, "Getting new histograms with %d run number for %d run number", mRunNumber, bc.runNumber());
-          Run2V0MInfo.mhVtxAmpCorrV0A = getccdb("hVtx_fAmplitude_V0A_Normalized");
-          Run2V0MInfo.mhVtxAmpCorrV0C = getccdb("hVtx_fAmplitude_V0C_Normalized");
-          Run2V0MInfo.mhMultSelCalib = getccdb("hMultSelCalib_V0M");
-          Run2V0MInfo.mMCScale = getformulaccdb(TString::Format("%s-V0M", genName->c_str()).Data());
-          if ((Run2V0MInfo.mhVtxAmpCorrV0A != nullptr) and (Run2V0MInfo.mhVtxAmpCorrV0C != nullptr) and (Run2V0MInfo.mhMultSelCalib != nullptr)) {
-            if (genName->length() != 0) {
-              if (Run2V0MInfo.mMCScale != nullptr) {
-                for (int ixpar = 0; ixpar < 6; ++ixpar) {
-                  Run2V0MInfo.mMCScalePars[ixpar] = Run2V0MInfo.mMCScale->GetParameter(ixpar);
-                }
-              } else {
-                LOGF(fatal, "MC Scale information from V0M for run %d not available", bc.runNumber());
+    if (callst != nullptr) {
+      auto getccdb = [callst](const char* ccdbhname) {
+        TH1* h = (TH1*)callst->FindObject(ccdbhname);
+        return h;
+      };
+      auto getformulaccdb = [callst](const char* ccdbhname) {
+        TFormula* f = (TFormula*)callst->FindObject(ccdbhname);
+        return f;
+      };
+      if (estRun2V0M == 1) {
+        LOGF(debug, "Getting new histograms with %d run number for %d run number", mRunNumber, runNumber);
+        TH1* hVtxAmpCorrV0A = getccdb("hVtx_fAmplitude_V0A_Normalized");
+        TH1* hVtxAmpCorrV0C = getccdb("hVtx_fAmplitude_V0C_Normalized");
+        TH1* hMultSelCalib = getccdb("hMultSelCalib_V0M");
+        TFormula* mcScale = getformulaccdb(TString::Format("%s-V0M", genName->c_str()).Data());
+        if ((hVtxAmpCorrV0A != nullptr) and (hVtxAmpCorrV0C != nullptr) and (hMultSelCalib != nullptr)) {
+          if (genName->length() != 0) {
+            if (mcScale != nullptr) {
+              for (int ixpar = 0; ixpar < 6; ++ixpar) {
+                calibration.V0M.mMCScalePars[ixpar] = mcScale->GetParameter(ixpar);
               }
+            } else {
+              LOGF(fatal, "MC Scale information from V0M for run %d not available", runNumber);
             }
-            Run2V0MInfo.mCalibrationStored = true;
-          } else {
-            LOGF(fatal, "Calibration information from V0M for run %d corrupted", bc.runNumber());
-          }
-        }
-        if (estRun2SPDTrklets == 1) {
-          LOGF(debug, "Getting new histograms with %d run number for %d run number", mRunNumber, bc.runNumber());
-          Run2SPDTksInfo.mhVtxAmpCorr = getccdb("hVtx_fnTracklets_Normalized");
-          Run2SPDTksInfo.mhMultSelCalib = getccdb("hMultSelCalib_SPDTracklets");
-          if ((Run2SPDTksInfo.mhVtxAmpCorr != nullptr) and (Run2SPDTksInfo.mhMultSelCalib != nullptr)) {
-            Run2SPDTksInfo.mCalibrationStored = true;
-          } else {
-            LOGF(fatal, "Calibration information from SPD tracklets for run %d corrupted", bc.runNumber());
           }
+          calibration.V0M.mMCScaleStored = (mcScale != nullptr);
+          calibration.V0M.mhVtxAmpCorrV0A.set(hVtxAmpCorrV0A);
+          calibration.V0M.mhVtxAmpCorrV0C.set(hVtxAmpCorrV0C);
+          calibration.V0M.mhMultSelCalib.set(hMultSelCalib);
+          calibration.V0M.mCalibrationStored = true;
+        } else {
+          LOGF(fatal, "Calibration information from V0M for run %d corrupted", runNumber);
         }
-        if (estRun2SPDClusters == 1) {
-          LOGF(debug, "Getting new histograms with %d run number for %d run number", mRunNumber, bc.runNumber());
-          Run2SPDClsInfo.mhVtxAmpCorrCL0 = getccdb("hVtx_fnSPDClusters0_Normalized");
-          Run2SPDClsInfo.mhVtxAmpCorrCL1 = getccdb("hVtx_fnSPDClusters1_Normalized");
-          Run2SPDClsInfo.mhMultSelCalib = getccdb("hMultSelCalib_SPDClusters");
-          if ((Run2SPDClsInfo.mhVtxAmpCorrCL0 != nullptr) and (Run2SPDClsInfo.mhVtxAmpCorrCL1 != nullptr) and (Run2SPDClsInfo.mhMultSelCalib != nullptr)) {
-            Run2SPDClsInfo.mCalibrationStored = true;
-          } else {
-            LOGF(fatal, "Calibration information from SPD clusters for run %d corrupted", bc.runNumber());
-          }
+      }
+      /* estimators made of one vertex-z correction and one percentile calibration */
+      auto getccdbSimple = [&getccdb](auto& estimator, const char* vtxname, const char* calibname) {
+        TH1* hVtxAmpCorr = getccdb(vtxname);
+        TH1* hMultSelCalib = getccdb(calibname);
+        if ((hVtxAmpCorr != nullptr) and (hMultSelCalib != nullptr)) {
+          estimator.mhVtxAmpCorr.set(hVtxAmpCorr);
+          estimator.mhMultSelCalib.set(hMultSelCalib);
+          estimator.mCalibrationStored = true;
         }
-        if (estRun2CL0 == 1) {
-          LOGF(debug, "Getting new histograms with %d run number for %d run number", mRunNumber, bc.runNumber());
-          Run2CL0Info.mhVtxAmpCorr = getccdb("hVtx_fnSPDClusters0_Normalized");
-          Run2CL0Info.mhMultSelCalib = getccdb("hMultSelCalib_CL0");
-          if ((Run2CL0Info.mhVtxAmpCorr != nullptr) and (Run2CL0Info.mhMultSelCalib != nullptr)) {
-            Run2CL0Info.mCalibrationStored = true;
-          } else {
-            LOGF(fatal, "Calibration information from CL0 multiplicity for run %d corrupted", bc.runNumber());
-          }
+        return estimator.mCalibrationStored;
+      };
+      if (estRun2SPDTrklets == 1) {
+        LOGF(debug, "Getting new histograms with %d run number for %d run number", mRunNumber, runNumber);
+        if (!getccdbSimple(calibration.SPDTks, "hVtx_fnTracklets_Normalized", "hMultSelCalib_SPDTracklets")) {
+          LOGF(fatal, "Calibration information from SPD tracklets for run %d corrupted", runNumber);
         }
-        if (estRun2CL1 == 1) {
-          LOGF(debug, "Getting new histograms with %d run number for %d run number", mRunNumber, bc.runNumber());
-          Run2CL1Info.mhVtxAmpCorr = getccdb("hVtx_fnSPDClusters1_Normalized");
-          Run2CL1Info.mhMultSelCalib = getccdb("hMultSelCalib_CL1");
-          if ((Run2CL1Info.mhVtxAmpCorr != nullptr) and (Run2CL1Info.mhMultSelCalib != nullptr)) {
-            Run2CL1Info.mCalibrationStored = true;
-          } else {
-            LOGF(fatal, "Calibration information from CL1 multiplicity for run %d corrupted", bc.runNumber());
-          }
+      }
+      if (estRun2SPDClusters == 1) {
+        LOGF(debug, "Getting new histograms with %d run number for %d run number", mRunNumber, runNumber);
+        TH1* hVtxAmpCorrCL0 = getccdb("hVtx_fnSPDClusters0_Normalized");
+        TH1* hVtxAmpCorrCL1 = getccdb("hVtx_fnSPDClusters1_Normalized");
+        TH1* hMultSelCalib = getccdb("hMultSelCalib_SPDClusters");
+        if ((hVtxAmpCorrCL0 != nullptr) and (hVtxAmpCorrCL1 != nullptr) and (hMultSelCalib != nullptr)) {
+          calibration.SPDCls.mhVtxAmpCorrCL0.set(hVtxAmpCorrCL0);
+          calibration.SPDCls.mhVtxAmpCorrCL1.set(hVtxAmpCorrCL1);
+          calibration.SPDCls.mhMultSelCalib.set(hMultSelCalib);
+          calibration.SPDCls.mCalibrationStored = true;
+        } else {
+          LOGF(fatal, "Calibration information from SPD clusters for run %d corrupted", runNumber);
         }
-        if (Run2V0MInfo.mCalibrationStored or Run2SPDTksInfo.mCalibrationStored or Run2SPDClsInfo.mCalibrationStored or Run2CL0Info.mCalibrationStored or Run2CL1Info.mCalibrationStored) {
-          mRunNumber = bc.runNumber();
+      }
+      if (estRun2CL0 == 1) {
+        LOGF(debug, "Getting new histograms with %d run number for %d run number", mRunNumber, runNumber);
+        if (!getccdbSimple(calibration.CL0, "hVtx_fnSPDClusters0_Normalized", "hMultSelCalib_CL0")) {
+          LOGF(fatal, "Calibration information from CL0 multiplicity for run %d corrupted", runNumber);
         }
-      } else {
-        if (!doNotCrashOnNull) { // default behaviour: crash
-          LOGF(fatal, "Centrality calibration is not available in CCDB for run=%d at timestamp=%llu", bc.runNumber(), bc.timestamp());
-        } else { // only if asked: continue filling with non-valid values (105)
-          LOGF(info, "Centrality calibration is not available in CCDB for run=%d at timestamp=%llu, will fill tables with dummy values", bc.runNumber(), bc.timestamp());
-          mRunNumber = bc.runNumber();
+      }
+      if (estRun2CL1 == 1) {
+        LOGF(debug, "Getting new histograms with %d run number for %d run number", mRunNumber, runNumber);
+        if (!getccdbSimple(calibration.CL1, "hVtx_fnSPDClusters1_Normalized", "hMultSelCalib_CL1")) {
+          LOGF(fatal, "Calibration information from CL1 multiplicity for run %d corrupted", runNumber);
         }
       }
+    } else {
+      if (!doNotCrashOnNull) { // default behaviour: crash
+        LOGF(fatal, "Centrality calibration is not available in CCDB for run=%d at timestamp=%llu", runNumber, timestamp);
+      } else { // only if asked: continue filling with non-valid values (105)
+        LOGF(info, "Centrality calibration is not available in CCDB for run=%d at timestamp=%llu, will fill tables with dummy values", runNumber, timestamp);
+      }
     }
+    return calibration;
+  }
 
+  void processRun2(soa::Join<aod::Collisions, aod::Mults>::iterator const& collision, BCsWithTimestampsAndRun2Infos const&)
+  {
+    /* check the previous run number */
+    auto bc = collision.bc_as<BCsWithTimestampsAndRun2Infos>();
+    if (bc.runNumber() != mRunNumber) {
+      auto calibration = mRun2Calibrations.find(bc.runNumber());
+      if (calibration == mRun2Calibrations.end()) {
+        calibration = mRun2Calibrations.emplace(bc.runNumber(), fetchRun2Calibration(bc.runNumber(), bc.timestamp())).first;
+      }
+      Run2V0MInfo = calibration->second.V0M;
+      Run2SPDTksInfo = calibration->second.SPDTks;
+      Run2SPDClsInfo = calibration->second.SPDCls;
+      Run2CL0Info = calibration->second.CL0;
+      Run2CL1Info = calibration->second.CL1;
+      mRunNumber = bc.runNumber();
+    }
     auto scaleMC = [](float x, float pars[6]) {
       return pow(((pars[0] + pars[1] * pow(x, pars[2])) - pars[3]) / pars[4], 1.0f / pars[5]);
     };
@@ -262,14 +298,14 @@ struct CentralityTable {
       float cV0M = 105.0f;
       if (Run2V0MInfo.mCalibrationStored) {
         float v0m;
-        if (Run2V0MInfo.mMCScale != nullptr) {
+        if (Run2V0MInfo.mMCScaleStored) {
           v0m = scaleMC(collision.multFV0M(), Run2V0MInfo.mMCScalePars);
           LOGF(debug, "Unscaled v0m: %f, scaled v0m: %f", collision.multFV0M(), v0m);
         } else {
-          v0m = collision.multFV0A() * Run2V0MInfo.mhVtxAmpCorrV0A->GetBinContent(Run2V0MInfo.mhVtxAmpCorrV0A->FindFixBin(collision.posZ())) +
-                collision.multFV0C() * Run2V0MInfo.mhVtxAmpCorrV0C->GetBinContent(Run2V0MInfo.mhVtxAmpCorrV0C->FindFixBin(collision.posZ()));
+          v0m = collision.multFV0A() * Run2V0MInfo.mhVtxAmpCorrV0A.getBinContent(collision.posZ()) +
+                collision.multFV0C() * Run2V0MInfo.mhVtxAmpCorrV0C.getBinContent(collision.posZ());
         }
-        cV0M = Run2V0MInfo.mhMultSelCalib->GetBinContent(Run2V0MInfo.mhMultSelCalib->FindFixBin(v0m));
+        cV0M = Run2V0MInfo.mhMultSelCalib.getBinContent(v0m);
       }
       LOGF(debug, "centRun2V0M=%.0f", cV0M);
       // fill centrality columns
@@ -278,8 +314,8 @@ struct CentralityTable {
     if (estRun2SPDTrklets == 1) {
       float cSPD = 105.0f;
       if (Run2SPDTksInfo.mCalibrationStored) {
-        float spdm = collision.multTracklets() * Run2SPDTksInfo.mhVtxAmpCorr->GetBinContent(Run2SPDTksInfo.mhVtxAmpCorr->FindFixBin(collision.posZ()));
-        cSPD = Run2SPDTksInfo.mhMultSelCalib->GetBinContent(Run2SPDTksInfo.mhMultSelCalib->FindFixBin(spdm));
+        float spdm = collision.multTracklets() * Run2SPDTksInfo.mhVtxAmpCorr.getBinContent(collision.posZ());
+        cSPD = Run2SPDTksInfo.mhMultSelCalib.getBinContent(spdm);
       }
       LOGF(debug, "centSPDTracklets=%.0f", cSPD);
       centRun2SPDTracklets(cSPD);
@@ -287,9 +323,9 @@ struct CentralityTable {
     if (estRun2SPDClusters == 1) {
       float cSPD = 105.0f;
       if (Run2SPDClsInfo.mCalibrationStored) {
-        float spdm = bc.spdClustersL0() * Run2SPDClsInfo.mhVtxAmpCorrCL0->GetBinContent(Run2SPDClsInfo.mhVtxAmpCorrCL0->FindFixBin(collision.posZ())) +
-                     bc.spdClustersL1() * Run2SPDClsInfo.mhVtxAmpCorrCL1->GetBinContent(Run2SPDClsInfo.mhVtxAmpCorrCL1->FindFixBin(collision.posZ()));
-        cSPD = Run2SPDClsInfo.mhMultSelCalib->GetBinContent(Run2SPDClsInfo.mhMultSelCalib->FindFixBin(spdm));
+        float spdm = bc.spdClustersL0() * Run2SPDClsInfo.mhVtxAmpCorrCL0.getBinContent(collision.posZ()) +
+                     bc.spdClustersL1() * Run2SPDClsInfo.mhVtxAmpCorrCL1.getBinContent(collision.posZ());
+        cSPD = Run2SPDClsInfo.mhMultSelCalib.getBinContent(spdm);
       }
       LOGF(debug, "centSPDClusters=%.0f", cSPD);
       centRun2SPDClusters(cSPD);
@@ -297,8 +333,8 @@ struct CentralityTable {
     if (estRun2CL0 == 1) {
       float cCL0 = 105.0f;
       if (Run2CL0Info.mCalibrationStored) {
-        float cl0m = bc.spdClustersL0() * Run2CL0Info.mhVtxAmpCorr->GetBinContent(Run2CL0Info.mhVtxAmpCorr->FindFixBin(collision.posZ()));
-        cCL0 = Run2CL0Info.mhMultSelCalib->GetBinContent(Run2CL0Info.mhMultSelCalib->FindFixBin(cl0m));
+        float cl0m = bc.spdClustersL0() * Run2CL0Info.mhVtxAmpCorr.getBinContent(collision.posZ());
+        cCL0 = Run2CL0Info.mhMultSelCalib.getBinContent(cl0m);
       }
       LOGF(debug, "centCL0=%.0f", cCL0);
       centRun2CL0(cCL0);
@@ -306,8 +342,8 @@ struct CentralityTable {
     if (estRun2CL1 == 1) {
       float cCL1 = 105.0f;
       if (Run2CL1Info.mCalibrationStored) {
-        float cl1m = bc.spdClustersL1() * Run2CL1Info.mhVtxAmpCorr->GetBinContent(Run2CL1Info.mhVtxAmpCorr->FindFixBin(collision.posZ()));
-        cCL1 = Run2CL1Info.mhMultSelCalib->GetBinContent(Run2CL1Info.mhMultSelCalib->FindFixBin(cl1m));
+        float cl1m = bc.spdClustersL1() * Run2CL1Info.mhVtxAmpCorr.getBinContent(collision.posZ());
+        cCL1 = Run2CL1Info.mhMultSelCalib.getBinContent(cl1m);
       }
       LOGF(debug, "centCL1=%.0f", cCL1);
       centRun2CL1(cCL1);
@@ -317,6 +353,63 @@ struct CentralityTable {
 
   using BCsWithTimestamps = soa::Join<aod::BCs, aod::Timestamps>;
 
+  /// Fetches and flattens the Run 3 calibration of the enabled estimators for a given run
+  run3Calibration fetchRun3Calibration(int runNumber, uint64_t timestamp)
+  {
+    run3Calibration calibration;
+    LOGF(info, "timestamp=%llu, run number=%d", timestamp, runNumber);
+    TList* callst = ccdb->getForTimeStamp<TList>(ccdbPath, timestamp);
+
+    if (callst != nullptr) {
+      LOGF(info, "Getting new histograms with %d run number for %d run number", mRunNumber, runNumber);
+      auto getccdb = [callst, runNumber](struct calibrationInfo& estimator, const Configurable<std::string> generatorName) { // TODO: to consider the name inside the estimator structure
+        TH1* hMultSelCalib = (TH1*)callst->FindObject(TString::Format("hCalibZeq%s", estimator.name.c_str()).Data());
+        TFormula* mcScale = (TFormula*)callst->FindObject(TString::Format("%s-%s", generatorName->c_str(), estimator.name.c_str()).Data());
+        if (hMultSelCalib != nullptr) {
+          if (generatorName->length() != 0) {
+            if (mcScale != nullptr) {
+              for (int ixpar = 0; ixpar < 6; ++ixpar) {
+                estimator.mMCScalePars[ixpar] = mcScale->GetParameter(ixpar);
+              }
+            } else {
+              LOGF(warning, "MC Scale information from %s for run %d not available", estimator.name.c_str(), runNumber);
+            }
+          }
+          estimator.mMCScaleStored = (mcScale != nullptr);
+          estimator.mhMultSelCalib.set(hMultSelCalib);
+          estimator.mCalibrationStored = true;
+        } else {
+          LOGF(error, "Calibration information from %s for run %d not available", estimator.name.c_str(), runNumber);
+        }
+      };
+      if (estFV0A == 1) {
+        getccdb(calibration.FV0A, genName);
+      }
+      if (estFT0M == 1) {
+        getccdb(calibration.FT0M, genName);
+      }
+      if (estFT0A == 1) {
+        getccdb(calibration.FT0A, genName);
+      }
+      if (estFT0C == 1) {
+        getccdb(calibration.FT0C, genName);
+      }
+      if (estFDDM == 1) {
+        getccdb(calibration.FDDM, genName);
+      }
+      if (estNTPV == 1) {
+        getccdb(calibration.NTPV, genName);
+      }
+    } else {
+      if (!doNotCrashOnNull) { // default behaviour: crash
+        LOGF(fatal, "Centrality calibration is not available in CCDB for run=%d at timestamp=%llu", runNumber, timestamp);
+      } else { // only if asked: continue filling with non-valid values (105)
+        LOGF(info, "Centrality calibration is not available in CCDB for run=%d at timestamp=%llu, will fill tables with dummy values", runNumber, timestamp);
+      }
+    }
+    return calibration;
+  }
+
   void processRun3(soa::Join<aod::Collisions, aod::Mults, aod::MultZeqs> const& collisions, BCsWithTimestamps const&)
   {
     // do memory reservation for the relevant tables only, please
@@ -338,66 +431,29 @@ struct CentralityTable {
     if (estNTPV == 1) {
       centNTPV.reserve(collisions.size());
     }
+    /* prefetch the calibration of the runs first seen in this data frame */
+    int lastRunNumber = mRunNumber;
+    for (auto const& collision : collisions) {
+      auto bc = collision.bc_as<BCsWithTimestamps>();
+      if (bc.runNumber() != lastRunNumber) {
+        lastRunNumber = bc.runNumber();
+        if (mRun3Calibrations.find(bc.runNumber()) == mRun3Calibrations.end()) {
+          mRun3Calibrations.emplace(bc.runNumber(), fetchRun3Calibration(bc.runNumber(), bc.timestamp()));
+        }
+      }
+    }
     for (auto const& collision : collisions) {
       /* check the previous run number */
       auto bc = collision.bc_as<BCsWithTimestamps>();
       if (bc.runNumber() != mRunNumber) {
-        LOGF(info, "timestamp=%llu, run number=%d", bc.timestamp(), bc.runNumber());
-        TList* callst = ccdb->getForTimeStamp<TList>(ccdbPath, bc.timestamp());
-
-        FV0AInfo.mCalibrationStored = false;
-        FT0MInfo.mCalibrationStored = false;
-        FT0AInfo.mCalibrationStored = false;
-        FT0CInfo.mCalibrationStored = false;
-        FDDMInfo.mCalibrationStored = false;
-        NTPVInfo.mCalibrationStored = false;
-        if (callst != nullptr) {
-          LOGF(info, "Getting new histograms with %d run number for %d run number", mRunNumber, bc.runNumber());
-          auto getccdb = [callst, bc](struct calibrationInfo& estimator, const Configurable<std::string> generatorName) { // TODO: to consider the name inside the estimator structure
-            estimator.mhMultSelCalib = (TH1*)callst->FindObject(TString::Format("hCalibZeq%s", estimator.name.c_str()).Data());
-            estimator.mMCScale = (TFormula*)callst->FindObject(TString::Format("%s-%s", generatorName->c_str(), estimator.name.c_str()).Data());
-            if (estimator.mhMultSelCalib != nullptr) {
-              if (generatorName->length() != 0) {
-                if (estimator.mMCScale != nullptr) {
-                  for (int ixpar = 0; ixpar < 6; ++ixpar) {
-                    estimator.mMCScalePars[ixpar] = estimator.mMCScale->GetParameter(ixpar);
-                  }
-                } else {
-                  LOGF(warning, "MC Scale information from %s for run %d not available", estimator.name.c_str(), bc.runNumber());
-                }
-              }
-              estimator.mCalibrationStored = true;
-            } else {
-              LOGF(error, "Calibration information from %s for run %d not available", estimator.name.c_str(), bc.runNumber());
-            }
-          };
-          if (estFV0A == 1) {
-            getccdb(FV0AInfo, genName);
-          }
-          if (estFT0M == 1) {
-            getccdb(FT0MInfo, genName);
-          }
-          if (estFT0A == 1) {
-            getccdb(FT0AInfo, genName);
-          }
-          if (estFT0C == 1) {
-            getccdb(FT0CInfo, genName);
-          }
-          if (estFDDM == 1) {
-            getccdb(FDDMInfo, genName);
-          }
-          if (estNTPV == 1) {
-            getccdb(NTPVInfo, genName);
-          }
-          mRunNumber = bc.runNumber();
-        } else {
-          if (!doNotCrashOnNull) { // default behaviour: crash
-            LOGF(fatal, "Centrality calibration is not available in CCDB for run=%d at timestamp=%llu", bc.runNumber(), bc.timestamp());
-          } else { // only if asked: continue filling with non-valid values (105)
-            LOGF(info, "Centrality calibration is not available in CCDB for run=%d at timestamp=%llu, will fill tables with dummy values", bc.runNumber(), bc.timestamp());
-            mRunNumber = bc.runNumber();
-          }
-        }
+        auto& calibration = mRun3Calibrations.at(bc.runNumber());
+        FV0AInfo = calibration.FV0A;
+        FT0MInfo = calibration.FT0M;
+        FT0AInfo = calibration.FT0A;
+        FT0CInfo = calibration.FT0C;
+        FDDMInfo = calibration.FDDM;
+        NTPVInfo = calibration.NTPV;
+        mRunNumber = bc.runNumber();
       }
 
       auto populateTable = [](auto& table, struct calibrationInfo& estimator, float multiplicity, bool assignOutOfRange) {
@@ -408,11 +464,11 @@ struct CentralityTable {
         float percentile = 105.0f;
         float scaledMultiplicity = multiplicity;
         if (estimator.mCalibrationStored) {
-          if (estimator.mMCScale != nullptr) {
+          if (estimator.mMCScaleStored) {
             scaledMultiplicity = scaleMC(multiplicity, estimator.mMCScalePars);
             LOGF(debug, "Unscaled %s multiplicity: %f, scaled %s multiplicity: %f", estimator.name.c_str(), multiplicity, estimator.name.c_str(), scaledMultiplicity);
           }
-          percentile = estimator.mhMultSelCalib->GetBinContent(estimator.mhMultSelCalib->FindFixBin(scaledMultiplicity));
+          percentile = estimator.mhMultSelCalib.getBinContent(scaledMultiplicity);
           if (assignOutOfRange)
             percentile = 100.5f;
         }
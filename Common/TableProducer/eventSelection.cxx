@@ -19,12 +19,15 @@ using namespace o2::framework;
 #include "Common/DataModel/EventSelection.h"
 #include "Common/CCDB/EventSelectionParams.h"
 #include "Common/CCDB/TriggerAliases.h"
+#include "Common/CCDB/EventSelectionCache.h"
 #include "CCDB/BasicCCDBManager.h"
 #include "CommonConstants/LHCConstants.h"
 #include "Framework/HistogramRegistry.h"
 #include "DataFormatsFT0/Digit.h"
 #include "DataFormatsParameters/GRPLHCIFData.h"
 #include "TH1D.h"
+#include <algorithm>
+#include <vector>
 using namespace evsel;
 
 using BCsWithRun2InfosTimestampsAndMatches = soa::Join<aod::BCs, aod::Run2BCInfos, aod::Timestamps, aod::Run2MatchedToBCSparse>;
@@ -48,6 +51,19 @@ struct BcSelectionTask {
     histos.add("hCounterTVX", "", kTH1D, {{1, 0., 1.}});
   }
 
+  int runInfoRunNumber = -1;                // run number of runInfo
+  EventSelectionRunInfo* runInfo = nullptr; // event selection parameters and trigger-alias masks of the current run
+
+  template <typename TBC>
+  EventSelectionRunInfo& getRunInfo(TBC const& bc)
+  {
+    if (bc.runNumber() != runInfoRunNumber) {
+      runInfo = &EventSelectionCache::instance().get(ccdb, bc.runNumber(), bc.timestamp());
+      runInfoRunNumber = bc.runNumber();
+    }
+    return *runInfo;
+  }
+
   void processRun2(
     BCsWithRun2InfosTimestampsAndMatches const& bcs,
     aod::Zdcs const&,
@@ -59,22 +75,9 @@ struct BcSelectionTask {
     bcsel.reserve(bcs.size());
 
     for (auto& bc : bcs) {
-      EventSelectionParams* par = ccdb->getForTimeStamp<EventSelectionParams>("EventSelection/EventSelectionParams", bc.timestamp());
-      TriggerAliases* aliases = ccdb->getForTimeStamp<TriggerAliases>("EventSelection/TriggerAliases", bc.timestamp());
+      EventSelectionParams* par = &getRunInfo(bc).params;
       // fill fired aliases
-      uint32_t alias{0};
-      uint64_t triggerMask = bc.triggerMask();
-      for (auto& al : aliases->GetAliasToTriggerMaskMap()) {
-        if (triggerMask & al.second) {
-          alias |= BIT(al.first);
-        }
-      }
-      uint64_t triggerMaskNext50 = bc.triggerMaskNext50();
-      for (auto& al : aliases->GetAliasToTriggerMaskNext50Map()) {
-        if (triggerMaskNext50 & al.second) {
-          alias |= BIT(al.first);
-        }
-      }
+      uint32_t alias = runInfo->aliasMasks.getAliases(bc.triggerMask(), bc.triggerMaskNext50());
       alias |= BIT(kALL);
 
       // get timing info from ZDC, FV0, FT0 and FDD
@@ -199,10 +202,22 @@ struct BcSelectionTask {
   {
     bcsel.reserve(bcs.size());
 
-    // map from GlobalBC to BcId needed to find triggerBc
-    std::map<uint64_t, int32_t> mapGlobalBCtoBcId;
+    // one pass over the BC table to build the array of global BCs (sorted, as the BC table)
+    // and the per-BC FV0/FT0/FDD times used for the beam-gas checks in the neighbouring BCs
+    std::vector<uint64_t> globalBCs(bcs.size());
+    std::vector<float> timesV0A(bcs.size());
+    std::vector<float> timesT0A(bcs.size());
+    std::vector<float> timesT0C(bcs.size());
+    std::vector<float> timesFDA(bcs.size());
+    std::vector<float> timesFDC(bcs.size());
     for (auto& bc : bcs) {
-      mapGlobalBCtoBcId[bc.globalBC()] = bc.globalIndex();
+      auto index = bc.globalIndex();
+      globalBCs[index] = bc.globalBC();
+      timesV0A[index] = bc.has_fv0a() ? bc.fv0a().time() : -999.f;
+      timesT0A[index] = bc.has_ft0() ? bc.ft0().timeA() : -999.f;
+      timesT0C[index] = bc.has_ft0() ? bc.ft0().timeC() : -999.f;
+      timesFDA[index] = bc.has_fdd() ? bc.fdd().timeA() : -999.f;
+      timesFDC[index] = bc.has_fdd() ? bc.fdd().timeC() : -999.f;
     }
     int triggerBcShift = confTriggerBcShift;
     if (confTriggerBcShift == 999) {
@@ -210,31 +225,31 @@ struct BcSelectionTask {
       triggerBcShift = (run <= 526766 || (run >= 526886 && run <= 527237) || (run >= 527259 && run <= 527518) || run == 527523 || run == 527734) ? 0 : 294;
     }
 
+    // index of the trigger bc, moving only forward since the BC table is sorted in global BC
+    int64_t triggerBcId = 0;
     for (auto bc : bcs) {
-      EventSelectionParams* par = ccdb->getForTimeStamp<EventSelectionParams>("EventSelection/EventSelectionParams", bc.timestamp());
-      TriggerAliases* aliases = ccdb->getForTimeStamp<TriggerAliases>("EventSelection/TriggerAliases", bc.timestamp());
+      EventSelectionParams* par = &getRunInfo(bc).params;
       uint32_t alias{0};
       // workaround for pp2022 apass2-apass3 (trigger info is shifted by -294 bcs)
-      int32_t triggerBcId = mapGlobalBCtoBcId[bc.globalBC() + triggerBcShift];
-      if (triggerBcId) {
+      uint64_t triggerGlobalBC = bc.globalBC() + triggerBcShift;
+      while (triggerBcId < bcs.size() && globalBCs[triggerBcId] < triggerGlobalBC) {
+        ++triggerBcId;
+      }
+      if (triggerBcId < bcs.size() && globalBCs[triggerBcId] == triggerGlobalBC) {
         auto triggerBc = bcs.iteratorAt(triggerBcId);
-        uint64_t triggerMask = triggerBc.triggerMask();
-        for (auto& al : aliases->GetAliasToTriggerMaskMap()) {
-          if (triggerMask & al.second) {
-            alias |= BIT(al.first);
-          }
-        }
+        alias = runInfo->aliasMasks.getAliases(triggerBc.triggerMask());
       }
       alias |= BIT(kALL);
 
       // get timing info from ZDC, FV0, FT0 and FDD
+      int64_t bcIndex = bc.globalIndex();
       float timeZNA = bc.has_zdc() ? bc.zdc().timeZNA() : -999.f;
       float timeZNC = bc.has_zdc() ? bc.zdc().timeZNC() : -999.f;
-      float timeV0A = bc.has_fv0a() ? bc.fv0a().time() : -999.f;
-      float timeT0A = bc.has_ft0() ? bc.ft0().timeA() : -999.f;
-      float timeT0C = bc.has_ft0() ? bc.ft0().timeC() : -999.f;
-      float timeFDA = bc.has_fdd() ? bc.fdd().timeA() : -999.f;
-      float timeFDC = bc.has_fdd() ? bc.fdd().timeC() : -999.f;
+      float timeV0A = timesV0A[bcIndex];
+      float timeT0A = timesT0A[bcIndex];
+      float timeT0C = timesT0C[bcIndex];
+      float timeFDA = timesFDA[bcIndex];
+      float timeFDC = timesFDC[bcIndex];
       float timeV0ABG = -999.f;
       float timeT0ABG = -999.f;
       float timeT0CBG = -999.f;
@@ -244,27 +259,19 @@ struct BcSelectionTask {
       float znDif = timeZNA - timeZNC;
 
       uint64_t globalBC = bc.globalBC();
-      // move to previous bcs to check beam-gas in FT0, FV0 and FDD
-      int64_t backwardMoveCount = 0;
+      // look at previous bcs to check beam-gas in FT0, FV0 and FDD
       int64_t deltaBC = 6; // up to 6 bcs back
-      while (bc.globalBC() + deltaBC >= globalBC) {
-        if (bc == bcs.begin()) {
-          break;
-        }
-        --bc;
-        backwardMoveCount++;
-        if (bc.globalBC() + 1 == globalBC) {
-          timeV0ABG = bc.has_fv0a() ? bc.fv0a().time() : -999.f;
-          timeT0ABG = bc.has_ft0() ? bc.ft0().timeA() : -999.f;
-          timeT0CBG = bc.has_ft0() ? bc.ft0().timeC() : -999.f;
+      for (int64_t i = bcIndex - 1; i >= 0 && globalBCs[i] + deltaBC >= globalBC; i--) {
+        if (globalBCs[i] + 1 == globalBC) {
+          timeV0ABG = timesV0A[i];
+          timeT0ABG = timesT0A[i];
+          timeT0CBG = timesT0C[i];
         }
-        if (bc.globalBC() + 5 == globalBC) {
-          timeFDABG = bc.has_fdd() ? bc.fdd().timeA() : -999.f;
-          timeFDCBG = bc.has_fdd() ? bc.fdd().timeC() : -999.f;
+        if (globalBCs[i] + 5 == globalBC) {
+          timeFDABG = timesFDA[i];
+          timeFDCBG = timesFDC[i];
         }
       }
-      // move back to initial position
-      bc.moveByIndex(backwardMoveCount);
 
       // applying timing selections
       bool bbV0A = timeV0A > par->fV0ABBlower && timeV0A < par->fV0ABBupper;
@@ -348,18 +355,26 @@ struct EventSelectionTask {
   int lastRun = -1;                                          // last run number (needed to access ccdb only if run!=lastRun)
   std::bitset<o2::constants::lhc::LHCMaxBunches> bcPatternB; // bc pattern of colliding bunches
 
-  int32_t findClosest(int64_t globalBC, std::map<int64_t, int32_t>& bcs)
+  // sorted global BCs and bc indices of the bcs with TVX and FT0-OR, filled once per data frame
+  std::vector<int64_t> globalBcWithTVX;
+  std::vector<int32_t> indexBcWithTVX;
+  std::vector<int64_t> globalBcWithTOR;
+  std::vector<int32_t> indexBcWithTOR;
+
+  /// Returns the index of the bc closest to globalBC, -1 if there are no bcs
+  int32_t findClosest(int64_t globalBC, std::vector<int64_t> const& globalBCs, std::vector<int32_t> const& indices)
   {
-    auto it = bcs.lower_bound(globalBC);
-    int64_t bc1 = it->first;
-    int32_t index1 = it->second;
-    if (it != bcs.begin())
-      --it;
-    int64_t bc2 = it->first;
-    int32_t index2 = it->second;
-    int64_t dbc1 = std::abs(bc1 - globalBC);
-    int64_t dbc2 = std::abs(bc2 - globalBC);
-    return (dbc1 <= dbc2) ? index1 : index2;
+    if (globalBCs.empty()) {
+      return -1;
+    }
+    size_t i1 = std::lower_bound(globalBCs.begin(), globalBCs.end(), globalBC) - globalBCs.begin();
+    if (i1 == globalBCs.size()) {
+      i1--;
+    }
+    size_t i2 = i1 > 0 ? i1 - 1 : i1;
+    int64_t dbc1 = std::abs(globalBCs[i1] - globalBC);
+    int64_t dbc2 = std::abs(globalBCs[i2] - globalBC);
+    return (dbc1 <= dbc2) ? indices[i1] : indices[i2];
   }
 
   void init(InitContext&)
@@ -381,8 +396,10 @@ struct EventSelectionTask {
   void processRun2(aod::Collision const& col, BCsWithBcSels const& bcs, aod::Tracks const& tracks)
   {
     auto bc = col.bc_as<BCsWithBcSels>();
-    EventSelectionParams* par = ccdb->getForTimeStamp<EventSelectionParams>("EventSelection/EventSelectionParams", bc.timestamp());
-    bool* applySelection = par->GetSelection(muonSelection);
+    EventSelectionParams* par = &EventSelectionCache::instance().get(ccdb, bc.runNumber(), bc.timestamp()).params;
+    // local copy, since the MC settings below must not change the shared parameters
+    bool applySelection[kNsel];
+    std::copy_n(par->GetSelection(muonSelection), kNsel, applySelection);
     if (isMC) {
       applySelection[kIsBBZAC] = 0;
       applySelection[kNoV0MOnVsOfPileup] = 0;
@@ -477,10 +494,12 @@ struct EventSelectionTask {
       bcPatternB = grplhcif->getBunchFilling().getBCPattern();
     }
 
-    // create maps from globalBC to bc index for TVX or FT0-OR fired bcs
+    // create sorted arrays of globalBC and bc index for TVX or FT0-OR fired bcs
     // to be used for closest TVX (FT0-OR) searches
-    std::map<int64_t, int32_t> mapGlobalBcWithTVX;
-    std::map<int64_t, int32_t> mapGlobalBcWithTOR;
+    globalBcWithTVX.clear();
+    indexBcWithTVX.clear();
+    globalBcWithTOR.clear();
+    indexBcWithTOR.clear();
     for (auto& bc : bcs) {
       int64_t globalBC = bc.globalBC();
       // skip non-colliding bcs for data and anchored runs
@@ -488,10 +507,12 @@ struct EventSelectionTask {
         continue;
       }
       if (bc.selection_bit(kIsBBT0A) || bc.selection_bit(kIsBBT0C)) {
-        mapGlobalBcWithTOR[globalBC] = bc.globalIndex();
+        globalBcWithTOR.push_back(globalBC);
+        indexBcWithTOR.push_back(bc.globalIndex());
       }
       if (bc.selection_bit(kIsTriggerTVX)) {
-        mapGlobalBcWithTVX[globalBC] = bc.globalIndex();
+        globalBcWithTVX.push_back(globalBC);
+        indexBcWithTVX.push_back(bc.globalIndex());
       }
     }
 
@@ -539,14 +560,14 @@ struct EventSelectionTask {
       int64_t minBC = meanBC - deltaBC;
       int64_t maxBC = meanBC + deltaBC;
 
-      int32_t indexClosestTVX = findClosest(meanBC, mapGlobalBcWithTVX);
-      int64_t tvxBC = bcs.iteratorAt(indexClosestTVX).globalBC();
-      if (tvxBC >= minBC && tvxBC <= maxBC) { // closest TVX within search region
+      int32_t indexClosestTVX = findClosest(meanBC, globalBcWithTVX, indexBcWithTVX);
+      int64_t tvxBC = indexClosestTVX >= 0 ? bcs.iteratorAt(indexClosestTVX).globalBC() : -1;
+      if (indexClosestTVX >= 0 && tvxBC >= minBC && tvxBC <= maxBC) { // closest TVX within search region
         bc.setCursor(indexClosestTVX);
       } else { // no TVX within search region, searching for TOR = T0A | T0C
-        int32_t indexClosestTOR = findClosest(meanBC, mapGlobalBcWithTOR);
-        int64_t torBC = bcs.iteratorAt(indexClosestTOR).globalBC();
-        if (torBC >= minBC && torBC <= maxBC) {
+        int32_t indexClosestTOR = findClosest(meanBC, globalBcWithTOR, indexBcWithTOR);
+        int64_t torBC = indexClosestTOR >= 0 ? bcs.iteratorAt(indexClosestTOR).globalBC() : -1;
+        if (indexClosestTOR >= 0 && torBC >= minBC && torBC <= maxBC) {
           bc.setCursor(indexClosestTOR);
         }
       }
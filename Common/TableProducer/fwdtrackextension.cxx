@@ -24,37 +24,41 @@
 #include "DetectorsBase/Propagator.h"
 #include "CommonUtils/NameConf.h"
 
-#include "Math/SMatrix.h"
-#include "ReconstructionDataFormats/TrackFwd.h"
+#include <array>
+#include <cmath>
+#include <vector>
 
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::framework::expressions;
 
-using SMatrix55 = ROOT::Math::SMatrix<double, 5, 5, ROOT::Math::MatRepSym<double, 5>>;
-using SMatrix5 = ROOT::Math::SVector<double, 5>;
-
 struct FwdTrackExtension {
   Produces<aod::FwdTracksDCA> extendedTrackQuantities;
 
-  void process(aod::FwdTracks const& tracks, aod::Collisions const&)
+  std::vector<std::array<float, 3>> vertices; // positions of the collisions of the data frame
+
+  void process(aod::FwdTracks const& tracks, aod::Collisions const& collisions)
   {
+    // The vertex positions are read once per collision instead of once per track
+    vertices.clear();
+    vertices.reserve(collisions.size());
+    for (auto const& collision : collisions) {
+      vertices.push_back({collision.posX(), collision.posY(), collision.posZ()});
+    }
+
+    extendedTrackQuantities.reserve(tracks.size());
     for (auto& track : tracks) {
       float dcaX = -999;
       float dcaY = -999;
       if (track.has_collision()) {
         if (track.trackType() == o2::aod::fwdtrack::ForwardTrackTypeEnum::GlobalMuonTrack || track.trackType() == o2::aod::fwdtrack::ForwardTrackTypeEnum::GlobalForwardTrack) {
 
-          auto const& collision = track.collision();
-          double chi2 = track.chi2();
-          SMatrix5 tpars(track.x(), track.y(), track.phi(), track.tgl(), track.signed1Pt());
-          std::vector<double> v1;
-          SMatrix55 tcovs(v1.begin(), v1.end());
-          o2::track::TrackParCovFwd pars1{track.z(), tpars, tcovs, chi2};
-          pars1.propagateToZlinear(collision.posZ());
-
-          dcaX = (pars1.getX() - collision.posX());
-          dcaY = (pars1.getY() - collision.posY());
+          auto const& vertex = vertices[track.collisionId()];
+          // Linear extrapolation of o2::track::TrackParFwd to the z of the vertex, the covariance matrix is not needed for the DCA
+          const double n = (vertex[2] - track.z()) / track.tgl();
+          const double phi = track.phi();
+          dcaX = (track.x() + n * std::cos(phi) - vertex[0]);
+          dcaY = (track.y() + n * std::sin(phi) - vertex[1]);
         }
       }
       extendedTrackQuantities(dcaX, dcaY);
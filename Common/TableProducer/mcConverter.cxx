@@ -22,9 +22,11 @@ struct McConverter {
 
   void process(aod::StoredMcParticles_000 const& mcParticles_000)
   {
+    mcParticles_001.reserve(mcParticles_000.size());
+    std::vector<int> mothers; // reused for all the particles
     for (auto& p : mcParticles_000) {
 
-      std::vector<int> mothers;
+      mothers.clear();
       if (p.mother0Id() >= 0) {
         mothers.push_back(p.mother0Id());
       }
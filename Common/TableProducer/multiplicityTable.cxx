@@ -19,6 +19,8 @@ using namespace o2::framework;
 #include <CCDB/BasicCCDBManager.h>
 #include "Common/DataModel/EventSelection.h"
 #include "Common/DataModel/Multiplicity.h"
+#include "Common/Core/FlatHistogram.h"
+#include <map>
 #include "iostream"
 
 struct MultiplicityTableTaskIndexed {
@@ -41,14 +43,17 @@ struct MultiplicityTableTaskIndexed {
   Configurable<int> doVertexZeq{"doVertexZeq", 1, "if 1: do vertex Z eq mult table"};
 
   int mRunNumber;
-  bool lCalibLoaded;
-  TList* lCalibObjects;
-  TProfile* hVtxZFV0A;
-  TProfile* hVtxZFT0A;
-  TProfile* hVtxZFT0C;
-  TProfile* hVtxZFDDA;
-  TProfile* hVtxZFDDC;
-  TProfile* hVtxZNTracks;
+  struct vertexZCalibration {
+    bool lCalibLoaded = false;
+    FlatHistogram hVtxZFV0A;
+    FlatHistogram hVtxZFT0A;
+    FlatHistogram hVtxZFT0C;
+    FlatHistogram hVtxZFDDA;
+    FlatHistogram hVtxZFDDC;
+    FlatHistogram hVtxZNTracks;
+  } mCalib;
+  // per-run cache of the flattened vertex-Z calibration, kept across data frames
+  std::map<int, vertexZCalibration> mCalibCache;
 
   void init(InitContext& context)
   {
@@ -60,14 +65,8 @@ struct MultiplicityTableTaskIndexed {
     }
 
     mRunNumber = 0;
-    lCalibLoaded = false;
-    lCalibObjects = nullptr;
-    hVtxZFV0A = nullptr;
-    hVtxZFT0A = nullptr;
-    hVtxZFT0C = nullptr;
-    hVtxZFDDA = nullptr;
-    hVtxZFDDC = nullptr;
-    hVtxZNTracks = nullptr;
+    mCalib = vertexZCalibration{};
+    mCalibCache.clear();
 
     ccdb->setURL("http://alice-ccdb.cern.ch");
     ccdb->setCaching(true);
@@ -75,6 +74,36 @@ struct MultiplicityTableTaskIndexed {
     ccdb->setFatalWhenNull(false); // don't fatal, please - exception is caught explicitly (as it should)
   }
 
+  /// Fetches the vertex-Z calibration for a given run and copies it into flat arrays
+  vertexZCalibration fetchVertexZCalibration(uint64_t timestamp)
+  {
+    vertexZCalibration calib;
+    TList* lCalibObjects = ccdb->getForTimeStamp<TList>("Centrality/Calibration", timestamp);
+    if (lCalibObjects) {
+      TProfile* hVtxZFV0A = (TProfile*)lCalibObjects->FindObject("hVtxZFV0A");
+      TProfile* hVtxZFT0A = (TProfile*)lCalibObjects->FindObject("hVtxZFT0A");
+      TProfile* hVtxZFT0C = (TProfile*)lCalibObjects->FindObject("hVtxZFT0C");
+      TProfile* hVtxZFDDA = (TProfile*)lCalibObjects->FindObject("hVtxZFDDA");
+      TProfile* hVtxZFDDC = (TProfile*)lCalibObjects->FindObject("hVtxZFDDC");
+      TProfile* hVtxZNTracks = (TProfile*)lCalibObjects->FindObject("hVtxZNTracksPV");
+      // Capture error
+      if (!hVtxZFV0A || !hVtxZFT0A || !hVtxZFT0C || !hVtxZFDDA || !hVtxZFDDC || !hVtxZNTracks) {
+        LOGF(error, "Problem loading CCDB objects! Please check");
+        return calib;
+      }
+      calib.hVtxZFV0A.set(hVtxZFV0A);
+      calib.hVtxZFT0A.set(hVtxZFT0A);
+      calib.hVtxZFT0C.set(hVtxZFT0C);
+      calib.hVtxZFDDA.set(hVtxZFDDA);
+      calib.hVtxZFDDC.set(hVtxZFDDC);
+      calib.hVtxZNTracks.set(hVtxZNTracks);
+      calib.lCalibLoaded = true;
+    } else {
+      LOGF(error, "Problem loading CCDB object! Please check");
+    }
+    return calib;
+  }
+
   void processRun2(aod::Run2MatchedSparse::iterator const& collision,
                    Run2Tracks const& tracksExtra,
                    aod::BCs const&,
@@ -131,10 +160,6 @@ struct MultiplicityTableTaskIndexed {
   PROCESS_SWITCH(MultiplicityTableTaskIndexed, processRun2, "Produce Run 2 multiplicity tables", true);
 
   using Run3Tracks = soa::Join<aod::TracksIU, aod::TracksExtra>;
-  Partition<Run3Tracks> tracksIUWithTPC = (aod::track::tpcNClsFindable > (uint8_t)0);
-  Partition<Run3Tracks> pvContribTracksIU = (nabs(aod::track::eta) < 0.8f) && ((aod::track::flags & (uint32_t)o2::aod::track::PVContributor) == (uint32_t)o2::aod::track::PVContributor);
-  Partition<Run3Tracks> pvContribTracksIUEta1 = (nabs(aod::track::eta) < 1.0f) && ((aod::track::flags & (uint32_t)o2::aod::track::PVContributor) == (uint32_t)o2::aod::track::PVContributor);
-  Partition<Run3Tracks> pvContribTracksIUEtaHalf = (nabs(aod::track::eta) < 0.5f) && ((aod::track::flags & (uint32_t)o2::aod::track::PVContributor) == (uint32_t)o2::aod::track::PVContributor);
   void processRun3(soa::Join<aod::Collisions, aod::EvSels> const& collisions,
                    Run3Tracks const& tracksExtra,
                    soa::Join<aod::BCs, aod::Timestamps> const& bcs,
@@ -146,6 +171,19 @@ struct MultiplicityTableTaskIndexed {
     // reserve memory
     mult.reserve(collisions.size());
     multzeq.reserve(collisions.size());
+    // prefetch the calibration of the runs first seen in this data frame
+    if (doVertexZeq > 0) {
+      int lastRunNumber = mRunNumber;
+      for (auto const& collision : collisions) {
+        auto bc = collision.bc_as<soa::Join<aod::BCs, aod::Timestamps>>();
+        if (bc.runNumber() != lastRunNumber) {
+          lastRunNumber = bc.runNumber();
+          if (mCalibCache.find(bc.runNumber()) == mCalibCache.end()) {
+            mCalibCache.emplace(bc.runNumber(), fetchVertexZCalibration(bc.timestamp()));
+          }
+        }
+      }
+    }
     for (auto const& collision : collisions) {
       float multFV0A = 0.f;
       float multFV0C = 0.f;
@@ -164,38 +202,37 @@ struct MultiplicityTableTaskIndexed {
       float multZeqFDDC = 0.f;
       float multZeqNContribs = 0.f;
 
-      auto tracksGrouped = tracksIUWithTPC->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
-      auto pvContribsGrouped = pvContribTracksIU->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
-      auto pvContribsEta1Grouped = pvContribTracksIUEta1->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
-      auto pvContribsEtaHalfGrouped = pvContribTracksIUEtaHalf->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
-      int multTPC = tracksGrouped.size();
-      int multNContribs = pvContribsGrouped.size();
-      int multNContribsEta1 = pvContribsEta1Grouped.size();
-      int multNContribsEtaHalf = pvContribsEtaHalfGrouped.size();
+      // single sweep over the tracks of the collision for all the barrel estimators
+      int multTPC = 0;
+      int multNContribs = 0;
+      int multNContribsEta1 = 0;
+      int multNContribsEtaHalf = 0;
+      auto tracksGrouped = tracksExtra.sliceBy(perColIU, collision.globalIndex());
+      for (auto const& track : tracksGrouped) {
+        if (track.tpcNClsFindable() > 0) {
+          multTPC++;
+        }
+        if ((track.flags() & o2::aod::track::PVContributor) != o2::aod::track::PVContributor) {
+          continue;
+        }
+        const float absEta = std::abs(track.eta());
+        if (absEta < 1.0f) {
+          multNContribsEta1++;
+          if (absEta < 0.8f) {
+            multNContribs++;
+            if (absEta < 0.5f) {
+              multNContribsEtaHalf++;
+            }
+          }
+        }
+      }
 
       /* check the previous run number */
       auto bc = collision.bc_as<soa::Join<aod::BCs, aod::Timestamps>>();
       if (doVertexZeq > 0) {
         if (bc.runNumber() != mRunNumber) {
-          mRunNumber = bc.runNumber(); // mark this run as at least tried
-          lCalibObjects = ccdb->getForTimeStamp<TList>("Centrality/Calibration", bc.timestamp());
-          if (lCalibObjects) {
-            hVtxZFV0A = (TProfile*)lCalibObjects->FindObject("hVtxZFV0A");
-            hVtxZFT0A = (TProfile*)lCalibObjects->FindObject("hVtxZFT0A");
-            hVtxZFT0C = (TProfile*)lCalibObjects->FindObject("hVtxZFT0C");
-            hVtxZFDDA = (TProfile*)lCalibObjects->FindObject("hVtxZFDDA");
-            hVtxZFDDC = (TProfile*)lCalibObjects->FindObject("hVtxZFDDC");
-            hVtxZNTracks = (TProfile*)lCalibObjects->FindObject("hVtxZNTracksPV");
-            lCalibLoaded = true;
-            // Capture error
-            if (!hVtxZFV0A || !hVtxZFT0A || !hVtxZFT0C || !hVtxZFDDA || !hVtxZFDDC || !hVtxZNTracks) {
-              LOGF(error, "Problem loading CCDB objects! Please check");
-              lCalibLoaded = false;
-            }
-          } else {
-            LOGF(error, "Problem loading CCDB object! Please check");
-            lCalibLoaded = false;
-          }
+          mRunNumber = bc.runNumber();
+          mCalib = mCalibCache.at(mRunNumber);
         }
       }
       // using FT0 row index from event selection task
@@ -225,13 +262,13 @@ struct MultiplicityTableTaskIndexed {
           multFV0A += amplitude;
         }
       }
-      if (fabs(collision.posZ()) < 15.0f && lCalibLoaded) {
-        multZeqFV0A = hVtxZFV0A->Interpolate(0.0) * multFV0A / hVtxZFV0A->Interpolate(collision.posZ());
-        multZeqFT0A = hVtxZFT0A->Interpolate(0.0) * multFT0A / hVtxZFT0A->Interpolate(collision.posZ());
-        multZeqFT0C = hVtxZFT0C->Interpolate(0.0) * multFT0C / hVtxZFT0C->Interpolate(collision.posZ());
-        multZeqFDDA = hVtxZFDDA->Interpolate(0.0) * multFDDA / hVtxZFDDA->Interpolate(collision.posZ());
-        multZeqFDDC = hVtxZFDDC->Interpolate(0.0) * multFDDC / hVtxZFDDC->Interpolate(collision.posZ());
-        multZeqNContribs = hVtxZNTracks->Interpolate(0.0) * multNContribs / hVtxZNTracks->Interpolate(collision.posZ());
+      if (fabs(collision.posZ()) < 15.0f && mCalib.lCalibLoaded) {
+        multZeqFV0A = mCalib.hVtxZFV0A.interpolate(0.0) * multFV0A / mCalib.hVtxZFV0A.interpolate(collision.posZ());
+        multZeqFT0A = mCalib.hVtxZFT0A.interpolate(0.0) * multFT0A / mCalib.hVtxZFT0A.interpolate(collision.posZ());
+        multZeqFT0C = mCalib.hVtxZFT0C.interpolate(0.0) * multFT0C / mCalib.hVtxZFT0C.interpolate(collision.posZ());
+        multZeqFDDA = mCalib.hVtxZFDDA.interpolate(0.0) * multFDDA / mCalib.hVtxZFDDA.interpolate(collision.posZ());
+        multZeqFDDC = mCalib.hVtxZFDDC.interpolate(0.0) * multFDDC / mCalib.hVtxZFDDC.interpolate(collision.posZ());
+        multZeqNContribs = mCalib.hVtxZNTracks.interpolate(0.0) * multNContribs / mCalib.hVtxZNTracks.interpolate(collision.posZ());
       }
 
       LOGF(debug, "multFV0A=%5.0f multFV0C=%5.0f multFT0A=%5.0f multFT0C=%5.0f multFDDA=%5.0f multFDDC=%5.0f multZNA=%6.0f multZNC=%6.0f multTracklets=%i multTPC=%i", multFV0A, multFV0C, multFT0A, multFT0C, multFDDA, multFDDC, multZNA, multZNC, multTracklets, multTPC);
@@ -0,0 +1,133 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file qVectorsTable.cxx
+/// \brief Task to produce the harmonic Q-vectors of the barrel tracks of each collision
+///
+/// The Q-vectors of the harmonics 2, 3 and 4 are computed once per collision in the full acceptance and on both
+/// sides of an eta gap, with the efficiency and acceptance (GFWWeights) corrections, so that the event-plane and
+/// scalar-product analyses read them from the Qvectors table instead of looping again over the tracks.
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <string>
+
+#include <CCDB/BasicCCDBManager.h>
+#include <TH1.h>
+
+#include "Framework/runDataProcessing.h"
+#include "Framework/AnalysisTask.h"
+#include "Framework/AnalysisDataModel.h"
+#include "Common/DataModel/Qvectors.h"
+#include "Common/DataModel/TrackSelectionTables.h"
+#include "PWGCF/GenericFramework/GFWWeights.h"
+
+using namespace o2;
+using namespace o2::framework;
+using namespace o2::framework::expressions;
+
+struct QvectorsTable {
+  Produces<aod::Qvectors> qVectors;
+
+  Configurable<float> cfgCutPtMin{"cfgCutPtMin", 0.2f, "Minimal pT for tracks"};
+  Configurable<float> cfgCutPtMax{"cfgCutPtMax", 12.0f, "Maximal pT for tracks"};
+  Configurable<float> cfgCutEta{"cfgCutEta", 0.8f, "Eta range for tracks"};
+  Configurable<float> cfgEtaGap{"cfgEtaGap", 0.4f, "Eta gap between the negative and positive regions, centred at eta = 0"};
+  Configurable<int> cfgWeightPower{"cfgWeightPower", 1, "Power of the weights of the tracks in the Q-vectors"};
+
+  // Access to the efficiencies and acceptances from CCDB
+  Service<ccdb::BasicCCDBManager> ccdb;
+  Configurable<std::string> ccdbPathEfficiency{"ccdb-path-efficiency", "", "CCDB path to efficiency object, empty for none"};
+  Configurable<std::string> ccdbPathAcceptance{"ccdb-path-acceptance", "", "CCDB path to GFWWeights object, empty for none"};
+  Configurable<std::string> ccdbUrl{"ccdb-url", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
+  Configurable<int64_t> ccdbNoLaterThan{"ccdb-no-later-than", std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count(), "latest acceptable timestamp of creation for the object"};
+
+  Filter trackFilter = (nabs(aod::track::eta) < cfgCutEta) && (aod::track::pt > cfgCutPtMin) && (aod::track::pt < cfgCutPtMax) && ((requireGlobalTrackInFilter()) || (aod::track::isGlobalTrackSDD == (uint8_t) true));
+  using MyTracks = soa::Filtered<soa::Join<aod::Tracks, aod::TrackSelection>>;
+
+  TH1D* efficiency = nullptr;
+  GFWWeights* acceptance = nullptr;
+
+  static constexpr int NHarmonics = 3; // harmonics 2, 3 and 4
+  enum Region { kFull = 0,
+                kNeg,
+                kPos,
+                kNRegions };
+
+  void init(InitContext const&)
+  {
+    ccdb->setURL(ccdbUrl.value);
+    ccdb->setCaching(true);
+    ccdb->setLocalObjectValidityChecking();
+    ccdb->setCreatedNotAfter(ccdbNoLaterThan.value);
+
+    if (!ccdbPathEfficiency.value.empty()) {
+      efficiency = ccdb->getForTimeStamp<TH1D>(ccdbPathEfficiency.value, ccdbNoLaterThan.value);
+    }
+    if (!ccdbPathAcceptance.value.empty()) {
+      acceptance = ccdb->getForTimeStamp<GFWWeights>(ccdbPathAcceptance.value, ccdbNoLaterThan.value);
+    }
+  }
+
+  void process(aod::Collision const& collision, MyTracks const& tracks)
+  {
+    std::array<std::array<double, kNRegions>, NHarmonics> qx{}, qy{};
+    std::array<double, kNRegions> sumW{};
+    std::array<int, kNRegions> nTrk{};
+
+    const float halfGap = 0.5f * cfgEtaGap;
+    for (auto const& track : tracks) {
+      double weight = 1.;
+      if (efficiency) {
+        const double eff = efficiency->GetBinContent(efficiency->FindBin(track.pt()));
+        if (eff == 0) {
+          continue;
+        }
+        weight /= eff;
+      }
+      if (acceptance) {
+        weight *= acceptance->GetNUA(track.phi(), track.eta(), collision.posZ());
+      }
+      weight = std::pow(weight, cfgWeightPower.value);
+
+      const int side = track.eta() < -halfGap ? kNeg : (track.eta() > halfGap ? kPos : -1);
+      const double phi = track.phi();
+      for (int iHarm = 0; iHarm < NHarmonics; iHarm++) {
+        const double cosPhi = weight * std::cos((iHarm + 2) * phi);
+        const double sinPhi = weight * std::sin((iHarm + 2) * phi);
+        qx[iHarm][kFull] += cosPhi;
+        qy[iHarm][kFull] += sinPhi;
+        if (side >= 0) {
+          qx[iHarm][side] += cosPhi;
+          qy[iHarm][side] += sinPhi;
+        }
+      }
+      sumW[kFull] += weight;
+      nTrk[kFull]++;
+      if (side >= 0) {
+        sumW[side] += weight;
+        nTrk[side]++;
+      }
+    }
+
+    qVectors(qx[0][kFull], qy[0][kFull], qx[0][kNeg], qy[0][kNeg], qx[0][kPos], qy[0][kPos],
+             qx[1][kFull], qy[1][kFull], qx[1][kNeg], qy[1][kNeg], qx[1][kPos], qy[1][kPos],
+             qx[2][kFull], qy[2][kFull], qx[2][kNeg], qy[2][kNeg], qx[2][kPos], qy[2][kPos],
+             sumW[kFull], sumW[kNeg], sumW[kPos],
+             nTrk[kFull], nTrk[kNeg], nTrk[kPos]);
+  }
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{adaptAnalysisTask<QvectorsTable>(cfgc)};
+}
@@ -18,11 +18,18 @@
 ///
 #include <vector>
 #include <map>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <string>
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
 #include "CCDB/BasicCCDBManager.h"
 #include "CommonDataFormat/InteractionRecord.h"
 #include "DetectorsRaw/HBFUtils.h"
+#include "Common/Core/AsyncPrefetcher.h"
 
 using namespace o2::framework;
 using namespace o2::header;
@@ -36,24 +43,198 @@ struct TimestampTask {
   int lastRunNumber = 0;                     /// Last run number processed
   int64_t orbitResetTimestamp = 0;           /// Orbit-reset timestamp in us
 
+  /// Record of the on-disk cache of the run timestamps, stored as fixed-size binary entries
+  struct RunTimestampRecord {
+    int32_t runNumber = 0;           /// Run number
+    int32_t reserved = 0;            /// Padding, kept to zero
+    int64_t sorTimestamp = 0;        /// Start-of-run timestamp in ms
+    int64_t eorTimestamp = 0;        /// End-of-run timestamp in ms
+    int64_t orbitResetTimestamp = 0; /// Orbit-reset timestamp in us
+    int64_t creationTime = 0;        /// Time at which the record was written, in s since epoch
+    uint64_t configHash = 0;         /// Hash of the configuration used to compute the record
+    uint64_t checksum = 0;           /// Checksum of the fields above
+  };
+  static constexpr char cacheMagic[8] = {'O', '2', 'T', 'S', 'C', 'H', '0', '1'}; /// Header of the cache file
+  std::map<int, RunTimestampRecord> mapRunToDiskRecord;                          /// Valid records read from the disk cache
+  uint64_t cacheConfigHash = 0;                                                  /// Hash of the current configuration
+  bool cacheWritable = false;                                                    /// Flag to enable the writing of new records
+
+  /// Timestamps of a run read from CCDB
+  struct RunTimestamps {
+    int64_t sorTimestamp = 0;        /// Start-of-run timestamp in ms
+    int64_t eorTimestamp = 0;        /// End-of-run timestamp in ms
+    int64_t orbitResetTimestamp = 0; /// Orbit-reset timestamp in us
+    std::string error;               /// Reason of the failure of the query, empty if successful
+  };
+  o2::common::AsyncPrefetcher<int, RunTimestamps> runTimestamps; /// Timestamps of the runs of the data frames, queried in the background
+
   // Configurables
   Configurable<bool> verbose{"verbose", false, "verbose mode"};
   Configurable<std::string> rct_path{"rct-path", "RCT/Info/RunInformation", "path to the ccdb RCT objects for the SOR timestamps"};
   Configurable<std::string> orbit_reset_path{"orbit-reset-path", "CTP/Calib/OrbitReset", "path to the ccdb orbit-reset objects"};
   Configurable<std::string> url{"ccdb-url", "http://alice-ccdb.cern.ch", "URL of the CCDB database"};
   Configurable<bool> isRun2MC{"isRun2MC", false, "Running mode: enable only for Run 2 MC. Timestamps are set to SOR timestamp"};
+  Configurable<std::string> cacheFile{"cache-file", "", "Path of the local file caching the SOR/EOR and orbit-reset timestamps per run. Empty: disabled"};
+  Configurable<int64_t> cacheValidity{"cache-validity", 604800, "Validity in seconds of the entries of the local cache file. 0 or negative values: no expiration"};
+
+  /// FNV-1a hash, used for the configuration hash and the checksum of the cache records
+  static uint64_t hashBytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ULL)
+  {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+      hash ^= bytes[i];
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+
+  static uint64_t recordChecksum(const RunTimestampRecord& record)
+  {
+    return hashBytes(&record, offsetof(RunTimestampRecord, checksum));
+  }
+
+  static int64_t now()
+  {
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+  }
+
+  /// Reads the local cache file, keeping only the records that are consistent, not expired and computed with the same configuration
+  void readCacheFile()
+  {
+    const std::string config = url.value + ";" + rct_path.value + ";" + orbit_reset_path.value + ";" + (isRun2MC.value ? "1" : "0");
+    cacheConfigHash = hashBytes(config.data(), config.size());
+
+    std::ifstream file(cacheFile.value, std::ios::binary);
+    if (!file.is_open()) { // No cache yet: create it with its header
+      std::ofstream out(cacheFile.value, std::ios::binary);
+      if (!out.is_open()) {
+        LOGF(warning, "Cannot create timestamp cache file '%s', cache disabled", cacheFile.value.data());
+        return;
+      }
+      out.write(cacheMagic, sizeof(cacheMagic));
+      cacheWritable = out.good();
+      return;
+    }
+    char magic[sizeof(cacheMagic)] = {0};
+    file.read(magic, sizeof(magic));
+    if (!file.good() || !std::equal(magic, magic + sizeof(magic), cacheMagic)) {
+      LOGF(warning, "Timestamp cache file '%s' has an unknown format, cache disabled", cacheFile.value.data());
+      return;
+    }
+    cacheWritable = true;
+    const int64_t currentTime = now();
+    RunTimestampRecord record;
+    int nRejected = 0;
+    while (file.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+      if (record.checksum != recordChecksum(record) || record.configHash != cacheConfigHash) {
+        nRejected++;
+        continue;
+      }
+      if (cacheValidity.value > 0 && currentTime - record.creationTime > cacheValidity.value) {
+        nRejected++;
+        continue;
+      }
+      mapRunToDiskRecord[record.runNumber] = record;
+    }
+    LOGF(info, "Read %i valid records from timestamp cache file '%s', %i rejected", static_cast<int>(mapRunToDiskRecord.size()), cacheFile.value.data(), nRejected);
+  }
+
+  /// Appends a record to the local cache file
+  void writeCacheRecord(int runNumber, int64_t sorTimestamp, int64_t eorTimestamp, int64_t orbitReset)
+  {
+    if (!cacheWritable) {
+      return;
+    }
+    RunTimestampRecord record;
+    record.runNumber = runNumber;
+    record.sorTimestamp = sorTimestamp;
+    record.eorTimestamp = eorTimestamp;
+    record.orbitResetTimestamp = orbitReset;
+    record.creationTime = now();
+    record.configHash = cacheConfigHash;
+    record.checksum = recordChecksum(record);
+    std::ofstream out(cacheFile.value, std::ios::binary | std::ios::app);
+    out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    if (!out.good()) {
+      LOGF(warning, "Cannot write to timestamp cache file '%s', cache writing disabled", cacheFile.value.data());
+      cacheWritable = false;
+    }
+  }
+
+  /// Queries the timestamps of a run from CCDB, with its own CCDB API so that it can run in a background thread
+  static RunTimestamps fetchRunTimestamps(int runNumber, std::string const& ccdbUrl, std::string const& rctPath, std::string const& orbitResetPath, bool run2MC)
+  {
+    RunTimestamps result;
+    o2::ccdb::CcdbApi api;
+    api.init(ccdbUrl);
+    std::map<std::string, std::string> metadata, headers;
+    const std::string run_path = Form("%s/%i", rctPath.data(), runNumber);
+    headers = api.retrieveHeaders(run_path, metadata, -1);
+    if (headers.count("SOR") == 0) {
+      result.error = Form("Cannot find start-of-run timestamp for run number in path '%s'.", run_path.data());
+      return result;
+    }
+    if (headers.count("EOR") == 0) {
+      result.error = Form("Cannot find end-of-run timestamp for run number in path '%s'.", run_path.data());
+      return result;
+    }
+
+    result.sorTimestamp = atol(headers["SOR"].c_str()); // timestamp of the SOR in ms
+    result.eorTimestamp = atol(headers["EOR"].c_str()); // timestamp of the EOR in ms
+
+    bool isUnanchoredRun3MC = runNumber >= 300000 && runNumber < 500000;
+    if (run2MC || isUnanchoredRun3MC) {
+      // isRun2MC: bc/orbit distributions are not simulated in Run2 MC. All bcs are set to 0.
+      // isUnanchoredRun3MC: assuming orbit-reset is done in the beginning of each run
+      // Setting orbit-reset timestamp to start-of-run timestamp
+      result.orbitResetTimestamp = result.sorTimestamp * 1000; // from ms to us
+      return result;
+    }
+    // Run 2: the orbit-reset timestamp is queried with the start-of-run timestamp
+    // Run 3: sometimes orbit is reset after SOR. Using EOR timestamps for orbitReset query is more reliable
+    const int64_t queryTimestamp = runNumber < 300000 ? result.sorTimestamp : result.eorTimestamp;
+    std::unique_ptr<std::vector<Long64_t>> ctp(api.retrieveFromTFileAny<std::vector<Long64_t>>(orbitResetPath, metadata, queryTimestamp));
+    if (!ctp || ctp->empty()) {
+      result.error = Form("Cannot find orbit-reset timestamp in path '%s' for timestamp %lld.", orbitResetPath.data(), static_cast<long long>(queryTimestamp));
+      return result;
+    }
+    result.orbitResetTimestamp = (*ctp)[0];
+    return result;
+  }
 
   void init(o2::framework::InitContext&)
   {
     LOGF(info, "Initializing TimestampTask");
     ccdb->setURL(url.value); // Setting URL of CCDB manager from configuration
     ccdb_api.init(url.value);
+    if (!cacheFile.value.empty()) {
+      readCacheFile();
+    }
     if (!ccdb_api.isHostReachable()) {
       LOGF(fatal, "CCDB host %s is not reacheable, cannot go forward", url.value.data());
     }
+    runTimestamps.setFetcher([ccdbUrl = url.value, rctPath = rct_path.value, orbitResetPath = orbit_reset_path.value, run2MC = isRun2MC.value](int runNumber) {
+      return fetchRunTimestamps(runNumber, ccdbUrl, rctPath, orbitResetPath, run2MC);
+    });
   }
 
-  void process(aod::BC const& bc)
+  void process(aod::BCs const& bcs)
+  {
+    // The runs of the data frame which are not cached yet are all queried from CCDB at once, in the background
+    int lastPrefetchedRun = lastRunNumber;
+    for (auto const& bc : bcs) {
+      const int runNumber = bc.runNumber();
+      if (runNumber != lastPrefetchedRun && !mapRunToOrbitReset.count(runNumber) && !mapRunToDiskRecord.count(runNumber)) {
+        runTimestamps.prefetch(runNumber);
+      }
+      lastPrefetchedRun = runNumber;
+    }
+    for (auto const& bc : bcs) {
+      fillTimestamp(bc);
+    }
+  }
+
+  void fillTimestamp(aod::BC const& bc)
   {
     int runNumber = bc.runNumber();
     // We need to set the orbit-reset timestamp for the run number.
@@ -64,37 +245,20 @@ struct TimestampTask {
     } else if (mapRunToOrbitReset.count(runNumber)) { // The run number was already requested before: getting it from cache!
       LOGF(debug, "Getting orbit-reset timestamp from cache");
       orbitResetTimestamp = mapRunToOrbitReset[runNumber];
+    } else if (mapRunToDiskRecord.count(runNumber)) { // The run is in the local cache file: no need to access CCDB
+      LOGF(debug, "Getting orbit-reset timestamp from local cache file");
+      orbitResetTimestamp = mapRunToDiskRecord[runNumber].orbitResetTimestamp;
+      mapRunToOrbitReset[runNumber] = orbitResetTimestamp;
+      LOGF(info, "Add run number %i with orbit-reset timestamp %llu from local cache file", runNumber, orbitResetTimestamp);
     } else { // The run was not requested before: need to acccess CCDB!
-      LOGF(debug, "Getting start-of-run and end-of-run timestamps from CCDB");
-      std::map<std::string, std::string> metadata, headers;
-      const std::string run_path = Form("%s/%i", rct_path.value.data(), runNumber);
-      headers = ccdb_api.retrieveHeaders(run_path, metadata, -1);
-      if (headers.count("SOR") == 0) {
-        LOGF(fatal, "Cannot find start-of-run timestamp for run number in path '%s'.", run_path.data());
-      }
-      if (headers.count("EOR") == 0) {
-        LOGF(fatal, "Cannot find end-of-run timestamp for run number in path '%s'.", run_path.data());
-      }
-
-      int64_t sorTimestamp = atol(headers["SOR"].c_str()); // timestamp of the SOR in ms
-      int64_t eorTimestamp = atol(headers["EOR"].c_str()); // timestamp of the EOR in ms
-
-      bool isUnanchoredRun3MC = runNumber >= 300000 && runNumber < 500000;
-      if (isRun2MC || isUnanchoredRun3MC) {
-        // isRun2MC: bc/orbit distributions are not simulated in Run2 MC. All bcs are set to 0.
-        // isUnanchoredRun3MC: assuming orbit-reset is done in the beginning of each run
-        // Setting orbit-reset timestamp to start-of-run timestamp
-        orbitResetTimestamp = sorTimestamp * 1000; // from ms to us
-      } else if (runNumber < 300000) {             // Run 2
-        LOGF(debug, "Getting orbit-reset timestamp using start-of-run timestamp from CCDB");
-        auto ctp = ccdb->getForTimeStamp<std::vector<Long64_t>>(orbit_reset_path.value.data(), sorTimestamp);
-        orbitResetTimestamp = (*ctp)[0];
-      } else {
-        // sometimes orbit is reset after SOR. Using EOR timestamps for orbitReset query is more reliable
-        LOGF(debug, "Getting orbit-reset timestamp using end-of-run timestamp from CCDB");
-        auto ctp = ccdb->getForTimeStamp<std::vector<Long64_t>>(orbit_reset_path.value.data(), eorTimestamp);
-        orbitResetTimestamp = (*ctp)[0];
+      LOGF(debug, "Getting start-of-run, end-of-run and orbit-reset timestamps from CCDB");
+      const auto& timestamps = runTimestamps.get(runNumber);
+      if (!timestamps.error.empty()) {
+        LOGF(fatal, "%s", timestamps.error.data());
       }
+      const int64_t sorTimestamp = timestamps.sorTimestamp;
+      const int64_t eorTimestamp = timestamps.eorTimestamp;
+      orbitResetTimestamp = timestamps.orbitResetTimestamp;
 
       // Adding the timestamp to the cache map
       std::pair<std::map<int, int64_t>::iterator, bool> check;
@@ -103,6 +267,7 @@ struct TimestampTask {
         LOGF(fatal, "Run number %i already existed with a orbit-reset timestamp of %llu", runNumber, check.first->second);
       }
       LOGF(info, "Add new run number %i with orbit-reset timestamp %llu to cache", runNumber, orbitResetTimestamp);
+      writeCacheRecord(runNumber, sorTimestamp, eorTimestamp, orbitResetTimestamp);
     }
 
     if (verbose.value) {
@@ -18,6 +18,7 @@
 #include "Framework/runDataProcessing.h"
 #include "Framework/RunningWorkflowInfo.h"
 #include "Common/DataModel/TrackSelectionTables.h"
+#include "Common/Core/PropagatorServices.h"
 #include "Common/Core/trackUtilities.h"
 #include "ReconstructionDataFormats/DCA.h"
 #include "DetectorsBase/Propagator.h"
@@ -29,6 +30,10 @@
 #include "Framework/HistogramRegistry.h"
 #include "DataFormatsCalibration/MeanVertexObject.h"
 #include "CommonConstants/GeomConstants.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 // The Run 3 AO2D stores the tracks at the point of innermost update. For a track with ITS this is the innermost (or second innermost)
 // ITS layer. For a track without ITS, this is the TPC inner wall or for loopers in the TPC even a radius beyond that.
@@ -51,12 +56,26 @@ struct TrackPropagation {
 
   Produces<aod::TracksDCA> tracksDCA;
   Produces<aod::TracksDCACov> tracksDCACov;
+  Produces<aod::TracksDCACompact> tracksDCACompact;
+  Produces<aod::TracksDCACovCompact> tracksDCACovCompact;
 
   Service<o2::ccdb::BasicCCDBManager> ccdb;
 
+  HistogramRegistry histos{"Histos", {}, OutputObjHandlingPolicy::AnalysisObject};
+
   bool fillTracksDCA = false;
   bool fillTracksDCACov = false;
+  bool fillTracksDCACompact = false;
+  bool fillTracksDCACovCompact = false;
   int runNumber = -1;
+  float mBz = 0.f;
+
+  // Propagation mode of each track
+  enum PropagationMode : uint8_t {
+    kNoPropagation = 0, // track filled unpropagated
+    kFullPropagation,   // propagation with field map and material corrections
+    kHelixPropagation   // analytical helix in the nominal field, for tracks already close to the vertex
+  };
 
   o2::base::Propagator::MatCorrType matCorr = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
 
@@ -70,6 +89,19 @@ struct TrackPropagation {
   Configurable<std::string> grpmagPath{"grpmagPath", "GLO/Config/GRPMagField", "CCDB path of the GRPMagField object"};
   Configurable<std::string> mVtxPath{"mVtxPath", "GLO/Calib/MeanVertex", "Path of the mean vertex file"};
   Configurable<float> minPropagationRadius{"minPropagationDistance", o2::constants::geom::XTPCInnerRef + 0.1, "Only tracks which are at a smaller radius will be propagated, defaults to TPC inner wall"};
+  Configurable<int> nThreads{"nThreads", 1, "Number of threads used to propagate the tracks, 1: serial propagation"};
+  Configurable<int> chunkSize{"chunkSize", 1000, "Number of tracks propagated by a thread at a time when running with several threads"};
+  Configurable<float> helixPropagationRadius{"helixPropagationRadius", 0.f, "Tracks with inner parameters within this radius (cm) are propagated with an analytical helix without material corrections, 0: disabled"};
+  Configurable<bool> doHelixPropagationQA{"doHelixPropagationQA", false, "Also propagate the helix-propagated tracks with the full propagator and fill the DCA residuals"};
+
+  // Per-track buffers, filled before the propagation and read back in the original order to fill the tables
+  std::vector<o2::track::TrackPar> mTrackPars;
+  std::vector<o2::track::TrackParCov> mTrackParCovs;
+  std::vector<o2::dataformats::VertexBase> mVertices;
+  std::vector<gpu::gpustd::array<float, 2>> mDCAs;
+  std::vector<o2::dataformats::DCA> mDCACovs;
+  std::vector<uint8_t> mToPropagate;
+  std::vector<gpu::gpustd::array<float, 2>> mDCAResiduals;
 
   void init(o2::framework::InitContext& initContext)
   {
@@ -87,6 +119,12 @@ struct TrackPropagation {
         if (input.matcher.binding == "TracksDCACov") {
           fillTracksDCACov = true;
         }
+        if (input.matcher.binding == "TracksDCACompact") {
+          fillTracksDCACompact = true;
+        }
+        if (input.matcher.binding == "TracksDCACovCompact") {
+          fillTracksDCACovCompact = true;
+        }
       }
     }
 
@@ -94,7 +132,13 @@ struct TrackPropagation {
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
 
-    lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(lutPath));
+    lut = o2::common::propagator::getMatLut(ccdb, lutPath);
+
+    if (helixPropagationRadius > 0.f && doHelixPropagationQA) {
+      const AxisSpec axisPt{100, 0.f, 10.f, "#it{p}_{T} (GeV/#it{c})"};
+      histos.add("hDCAxyResidualHelix", "DCA_{xy} helix - full propagation", kTH2F, {axisPt, {200, -0.01f, 0.01f, "#Delta DCA_{xy} (cm)"}});
+      histos.add("hDCAzResidualHelix", "DCA_{z} helix - full propagation", kTH2F, {axisPt, {200, -0.01f, 0.01f, "#Delta DCA_{z} (cm)"}});
+    }
   }
 
   void initCCDB(aod::BCsWithTimestamps::iterator const& bc)
@@ -102,10 +146,8 @@ struct TrackPropagation {
     if (runNumber == bc.runNumber()) {
       return;
     }
-    grpmag = ccdb->getForTimeStamp<o2::parameters::GRPMagField>(grpmagPath, bc.timestamp());
-    LOG(info) << "Setting magnetic field to current " << grpmag->getL3Current() << " A for run " << bc.runNumber() << " from its GRPMagField CCDB object";
-    o2::base::Propagator::initFieldFromGRP(grpmag);
-    o2::base::Propagator::Instance()->setMatLUT(lut);
+    mBz = o2::common::propagator::setMagField(ccdb, grpmagPath, bc.runNumber(), bc.timestamp(), lut, false);
+    grpmag = o2::common::propagator::getGrpMagField();
     mVtx = ccdb->getForTimeStamp<o2::dataformats::MeanVertexObject>(mVtxPath, bc.timestamp());
     runNumber = bc.runNumber();
   }
@@ -117,6 +159,81 @@ struct TrackPropagation {
     tracksParExtensionPropagated(trackPar.getPt(), trackPar.getP(), trackPar.getEta(), trackPar.getPhi());
   }
 
+  /// Calls propagate(i) for all the tracks i to be propagated. With more than one thread, the tracks are split in chunks
+  /// which are picked up by the workers. The propagator is only read, each call works on its own track and vertex copies.
+  template <typename TPropagate>
+  void runPropagation(TPropagate const& propagate)
+  {
+    const size_t nTracks = mToPropagate.size();
+    const size_t chunk = std::max(chunkSize.value, 1);
+    auto worker = [&, this](size_t first, size_t last) {
+      for (size_t i = first; i < last; i++) {
+        if (mToPropagate[i] != kNoPropagation) {
+          propagate(i);
+        }
+      }
+    };
+    if (nThreads <= 1 || nTracks <= chunk) {
+      worker(0, nTracks);
+      return;
+    }
+    std::atomic<size_t> nextChunk{0};
+    auto chunkWorker = [&]() {
+      for (size_t first = nextChunk.fetch_add(chunk); first < nTracks; first = nextChunk.fetch_add(chunk)) {
+        worker(first, std::min(first + chunk, nTracks));
+      }
+    };
+    std::vector<std::thread> workers;
+    const size_t nWorkers = std::min(static_cast<size_t>(nThreads.value), (nTracks + chunk - 1) / chunk);
+    for (size_t iWorker = 1; iWorker < nWorkers; iWorker++) {
+      workers.emplace_back(chunkWorker);
+    }
+    chunkWorker();
+    for (auto& thread : workers) {
+      thread.join();
+    }
+  }
+
+  /// Full propagation, or helix propagation for the tracks whose inner parameters are within helixPropagationRadius
+  template <typename TTrack>
+  PropagationMode propagationMode(TTrack const& track)
+  {
+    if (helixPropagationRadius > 0.f && std::hypot(track.x(), track.y()) < helixPropagationRadius) {
+      return kHelixPropagation;
+    }
+    return kFullPropagation;
+  }
+
+  /// Fills the QA of the DCA residuals between the helix and the full propagation
+  void fillHelixPropagationQA()
+  {
+    if (!doHelixPropagationQA || helixPropagationRadius <= 0.f) {
+      return;
+    }
+    for (size_t i = 0; i < mToPropagate.size(); i++) {
+      if (mToPropagate[i] != kHelixPropagation) {
+        continue;
+      }
+      const float pt = mTrackParCovs.empty() ? mTrackPars[i].getPt() : mTrackParCovs[i].getPt();
+      histos.fill(HIST("hDCAxyResidualHelix"), pt, mDCAResiduals[i][0]);
+      histos.fill(HIST("hDCAzResidualHelix"), pt, mDCAResiduals[i][1]);
+    }
+  }
+
+  /// Stores the vertex to which the track is propagated: the collision vertex or the mean vertex for unassigned tracks
+  template <typename TTrack>
+  void setVertex(TTrack const& track, o2::dataformats::VertexBase& vtx)
+  {
+    if (track.has_collision()) {
+      auto const& collision = track.collision();
+      vtx.setPos({collision.posX(), collision.posY(), collision.posZ()});
+      vtx.setCov(collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ());
+    } else {
+      vtx.setPos({mVtx->getX(), mVtx->getY(), mVtx->getZ()});
+      vtx.setCov(mVtx->getSigmaX() * mVtx->getSigmaX(), 0.0f, mVtx->getSigmaY() * mVtx->getSigmaY(), 0.0f, 0.0f, mVtx->getSigmaZ() * mVtx->getSigmaZ());
+    }
+  }
+
   void processStandard(aod::StoredTracksIU const& tracks, aod::Collisions const&, aod::BCsWithTimestamps const& bcs)
   {
     if (bcs.size() == 0) {
@@ -124,27 +241,53 @@ struct TrackPropagation {
     }
     initCCDB(bcs.begin());
 
-    gpu::gpustd::array<float, 2> dcaInfo;
-
+    mTrackPars.clear();
+    mTrackPars.reserve(tracks.size());
+    mVertices.resize(tracks.size());
+    mDCAs.assign(tracks.size(), {999, 999});
+    mToPropagate.assign(tracks.size(), 0);
+    size_t iTrack = 0;
     for (auto& track : tracks) {
-      dcaInfo[0] = 999;
-      dcaInfo[1] = 999;
-      aod::track::TrackTypeEnum trackType = (aod::track::TrackTypeEnum)track.trackType();
-      auto trackPar = getTrackPar(track);
+      mTrackPars.emplace_back(getTrackPar(track));
       // Only propagate tracks which have passed the innermost wall of the TPC (e.g. skipping loopers etc). Others fill unpropagated.
       if (track.trackType() == aod::track::TrackIU && track.x() < minPropagationRadius) {
-        if (track.has_collision()) {
-          auto const& collision = track.collision();
-          o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackPar, 2.f, matCorr, &dcaInfo);
-        } else {
-          o2::base::Propagator::Instance()->propagateToDCABxByBz({mVtx->getX(), mVtx->getY(), mVtx->getZ()}, trackPar, 2.f, matCorr, &dcaInfo);
+        mToPropagate[iTrack] = propagationMode(track);
+        setVertex(track, mVertices[iTrack]);
+      }
+      iTrack++;
+    }
+
+    mDCAResiduals.resize(tracks.size());
+    runPropagation([this](size_t i) {
+      if (mToPropagate[i] == kHelixPropagation) {
+        gpu::gpustd::array<float, 2> dcaFull{999, 999};
+        if (doHelixPropagationQA) {
+          auto trackPar = mTrackPars[i];
+          o2::base::Propagator::Instance()->propagateToDCABxByBz(mVertices[i].getXYZ(), trackPar, 2.f, matCorr, &dcaFull);
         }
-        trackType = aod::track::Track;
+        if (mTrackPars[i].propagateParamToDCA(mVertices[i].getXYZ(), mBz, &mDCAs[i])) {
+          mDCAResiduals[i] = {mDCAs[i][0] - dcaFull[0], mDCAs[i][1] - dcaFull[1]};
+          return;
+        }
+        mToPropagate[i] = kFullPropagation; // helix propagation failed, fall back to the full propagation
       }
-      FillTracksPar(track, trackType, trackPar);
+      o2::base::Propagator::Instance()->propagateToDCABxByBz(mVertices[i].getXYZ(), mTrackPars[i], 2.f, matCorr, &mDCAs[i]);
+    });
+    fillHelixPropagationQA();
+
+    tracksParPropagated.reserve(tracks.size());
+    tracksParExtensionPropagated.reserve(tracks.size());
+    iTrack = 0;
+    for (auto& track : tracks) {
+      aod::track::TrackTypeEnum trackType = mToPropagate[iTrack] != kNoPropagation ? aod::track::Track : (aod::track::TrackTypeEnum)track.trackType();
+      FillTracksPar(track, trackType, mTrackPars[iTrack]);
       if (fillTracksDCA) {
-        tracksDCA(dcaInfo[0], dcaInfo[1]);
+        tracksDCA(mDCAs[iTrack][0], mDCAs[iTrack][1]);
+      }
+      if (fillTracksDCACompact) {
+        tracksDCACompact(aod::trackcompact::encodeDca(mDCAs[iTrack][0]), aod::trackcompact::encodeDca(mDCAs[iTrack][1]));
       }
+      iTrack++;
     }
   }
   PROCESS_SWITCH(TrackPropagation, processStandard, "Process without covariance", true);
@@ -156,32 +299,53 @@ struct TrackPropagation {
     }
     initCCDB(bcs.begin());
 
-    o2::dataformats::DCA dcaInfoCov;
-    o2::dataformats::VertexBase vtx;
+    mTrackParCovs.clear();
+    mTrackParCovs.reserve(tracks.size());
+    mVertices.resize(tracks.size());
+    mDCACovs.resize(tracks.size());
+    mToPropagate.assign(tracks.size(), 0);
+    size_t iTrack = 0;
+    for (auto& track : tracks) {
+      mTrackParCovs.emplace_back(getTrackParCov(track));
+      mDCACovs[iTrack].set(999, 999, 999, 999, 999);
+      // Only propagate tracks which have passed the innermost wall of the TPC (e.g. skipping loopers etc). Others fill unpropagated.
+      if (track.trackType() == aod::track::TrackIU && track.x() < minPropagationRadius) {
+        mToPropagate[iTrack] = propagationMode(track);
+        setVertex(track, mVertices[iTrack]);
+      }
+      iTrack++;
+    }
+
+    mDCAResiduals.resize(tracks.size());
+    runPropagation([this](size_t i) {
+      if (mToPropagate[i] == kHelixPropagation) {
+        o2::dataformats::DCA dcaFull;
+        dcaFull.set(999, 999, 999, 999, 999);
+        if (doHelixPropagationQA) {
+          auto trackParCov = mTrackParCovs[i];
+          o2::base::Propagator::Instance()->propagateToDCABxByBz(mVertices[i], trackParCov, 2.f, matCorr, &dcaFull);
+        }
+        if (mTrackParCovs[i].propagateToDCA(mVertices[i], mBz, &mDCACovs[i])) {
+          mDCAResiduals[i] = {mDCACovs[i].getY() - dcaFull.getY(), mDCACovs[i].getZ() - dcaFull.getZ()};
+          return;
+        }
+        mToPropagate[i] = kFullPropagation; // helix propagation failed, fall back to the full propagation
+      }
+      o2::base::Propagator::Instance()->propagateToDCABxByBz(mVertices[i], mTrackParCovs[i], 2.f, matCorr, &mDCACovs[i]);
+    });
+    fillHelixPropagationQA();
 
     tracksParPropagated.reserve(tracks.size());
     tracksParExtensionPropagated.reserve(tracks.size());
     tracksParCovPropagated.reserve(tracks.size());
     tracksParCovExtensionPropagated.reserve(tracks.size());
 
+    iTrack = 0;
     for (auto& track : tracks) {
-      dcaInfoCov.set(999, 999, 999, 999, 999);
-      auto trackParCov = getTrackParCov(track);
-      aod::track::TrackTypeEnum trackType = (aod::track::TrackTypeEnum)track.trackType();
-      // Only propagate tracks which have passed the innermost wall of the TPC (e.g. skipping loopers etc). Others fill unpropagated.
-      if (track.trackType() == aod::track::TrackIU && track.x() < minPropagationRadius) {
-        if (track.has_collision()) {
-          auto const& collision = track.collision();
-          vtx.setPos({collision.posX(), collision.posY(), collision.posZ()});
-          vtx.setCov(collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ());
-          o2::base::Propagator::Instance()->propagateToDCABxByBz(vtx, trackParCov, 2.f, matCorr, &dcaInfoCov);
-        } else {
-          vtx.setPos({mVtx->getX(), mVtx->getY(), mVtx->getZ()});
-          vtx.setCov(mVtx->getSigmaX() * mVtx->getSigmaX(), 0.0f, mVtx->getSigmaY() * mVtx->getSigmaY(), 0.0f, 0.0f, mVtx->getSigmaZ() * mVtx->getSigmaZ());
-          o2::base::Propagator::Instance()->propagateToDCABxByBz(vtx, trackParCov, 2.f, matCorr, &dcaInfoCov);
-        }
-        trackType = aod::track::Track;
-      }
+      auto const& trackParCov = mTrackParCovs[iTrack];
+      auto const& dcaInfoCov = mDCACovs[iTrack];
+      aod::track::TrackTypeEnum trackType = mToPropagate[iTrack] != kNoPropagation ? aod::track::Track : (aod::track::TrackTypeEnum)track.trackType();
+      iTrack++;
       FillTracksPar(track, trackType, trackParCov);
       if (fillTracksDCA) {
         tracksDCA(dcaInfoCov.getY(), dcaInfoCov.getZ());
@@ -189,6 +353,12 @@ struct TrackPropagation {
       if (fillTracksDCACov) {
         tracksDCACov(dcaInfoCov.getSigmaY2(), dcaInfoCov.getSigmaZ2());
       }
+      if (fillTracksDCACompact) {
+        tracksDCACompact(aod::trackcompact::encodeDca(dcaInfoCov.getY()), aod::trackcompact::encodeDca(dcaInfoCov.getZ()));
+      }
+      if (fillTracksDCACovCompact) {
+        tracksDCACovCompact(aod::trackcompact::encodeSigmaDca2(dcaInfoCov.getSigmaY2()), aod::trackcompact::encodeSigmaDca2(dcaInfoCov.getSigmaZ2()));
+      }
       // TODO do we keep the rho as 0? Also the sigma's are duplicated information
       tracksParCovPropagated(std::sqrt(trackParCov.getSigmaY2()), std::sqrt(trackParCov.getSigmaZ2()), std::sqrt(trackParCov.getSigmaSnp2()),
                              std::sqrt(trackParCov.getSigmaTgl2()), std::sqrt(trackParCov.getSigma1Pt2()), 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
@@ -31,6 +31,7 @@ struct TrackToCollisionAssociation {
 
   Produces<TrackAssoc> association;
   Produces<TrackCompColls> reverseIndices;
+  Produces<TrackAssocRanges> associationRanges;
 
   Configurable<float> nSigmaForTimeCompat{"nSigmaForTimeCompat", 4.f, "number of sigmas for time compatibility"};
   Configurable<float> timeMargin{"timeMargin", 0.f, "time margin in ns added to uncertainty because of uncalibrated TPC"};
@@ -63,15 +64,29 @@ struct TrackToCollisionAssociation {
     collisionAssociator.setFillTableOfCollIdsPerTrack(fillTableOfCollIdsPerTrack);
   }
 
+  /// Fills the range of the rows of the association table of each collision, which are filled in the order of the collisions
+  void fillAssociationRanges()
+  {
+    const auto& nAssocPerCollision = collisionAssociator.getNAssocPerCollision();
+    associationRanges.reserve(nAssocPerCollision.size());
+    int firstAssoc = 0;
+    for (const auto nAssoc : nAssocPerCollision) {
+      associationRanges(firstAssoc, nAssoc);
+      firstAssoc += nAssoc;
+    }
+  }
+
   void processAssocWithTime(Collisions const& collisions, TracksWithSel const& tracksUnfiltered, TracksWithSelFilter const& tracks, AmbiguousTracks const& ambiguousTracks, BCs const& bcs)
   {
     collisionAssociator.runAssocWithTime(collisions, tracksUnfiltered, tracks, ambiguousTracks, bcs, association, reverseIndices);
+    fillAssociationRanges();
   }
   PROCESS_SWITCH(TrackToCollisionAssociation, processAssocWithTime, "Use track-to-collision association based on time", true);
 
   void processStandardAssoc(Collisions const& collisions, TracksWithSel const& tracksUnfiltered)
   {
     collisionAssociator.runStandardAssoc(collisions, tracksUnfiltered, tracksPerCollisions, association, reverseIndices);
+    fillAssociationRanges();
   }
   PROCESS_SWITCH(TrackToCollisionAssociation, processStandardAssoc, "Use standard track-to-collision association", false);
 };
@@ -16,6 +16,8 @@
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
+#include "Framework/RunningWorkflowInfo.h"
+#include "Common/Core/PropagatorServices.h"
 #include "Common/Core/TrackSelection.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "Common/DataModel/Multiplicity.h"
@@ -52,22 +54,34 @@ const char* ccdburl = "http://alice-ccdb.cern.ch"; /* test  "http://alice-ccdb.c
 
 struct TrackExtension {
   Produces<aod::TracksDCA> extendedTrackQuantities;
+  Produces<aod::TracksDCACompact> extendedTrackQuantitiesCompact;
   Service<o2::ccdb::BasicCCDBManager> ccdb;
   Configurable<bool> compatibilityIU{"compatibilityIU", false, "compatibility option to allow the processing of tracks before the introduction of IU tracks"};
 
   o2::base::MatLayerCylSet* lut;
   int mRunNumber;
   float mMagField;
+  bool fillTracksDCACompact = false;
 
   void init(InitContext& context)
   {
     using namespace analysis::trackextension;
 
+    // the quantised DCAs are filled only if a task of the workflow reads them
+    auto& workflows = context.services().get<RunningWorkflowInfo const>();
+    for (DeviceSpec const& device : workflows.devices) {
+      for (auto const& input : device.inputs) {
+        if (input.matcher.binding == "TracksDCACompact") {
+          fillTracksDCACompact = true;
+        }
+      }
+    }
+
     ccdb->setURL(ccdburl);
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
 
-    lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(ccdbpath_lut));
+    lut = o2::common::propagator::getMatLut(ccdb, ccdbpath_lut);
 
     mRunNumber = 0;
     mMagField = 0.0;
@@ -98,6 +112,9 @@ struct TrackExtension {
         }
       }
       extendedTrackQuantities(dca[0], dca[1]);
+      if (fillTracksDCACompact) {
+        extendedTrackQuantitiesCompact(aod::trackcompact::encodeDca(dca[0]), aod::trackcompact::encodeDca(dca[1]));
+      }
     }
   }
   PROCESS_SWITCH(TrackExtension, processRun2, "Process Run2 track extension task", true);
@@ -142,6 +159,9 @@ struct TrackExtension {
         }
       }
       extendedTrackQuantities(dca[0], dca[1]);
+      if (fillTracksDCACompact) {
+        extendedTrackQuantitiesCompact(aod::trackcompact::encodeDca(dca[0]), aod::trackcompact::encodeDca(dca[1]));
+      }
     }
   }
   PROCESS_SWITCH(TrackExtension, processRun3, "Process Run3 track extension task", false);
@@ -17,6 +17,9 @@
 /// \brief Task performing basic track selection.
 ///
 
+#include <map>
+#include <string>
+
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
@@ -25,6 +28,7 @@
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "Common/Core/trackUtilities.h"
 #include "TableHelper.h"
+#include "trackSelectionRequest.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -47,22 +51,96 @@ struct TrackSelectionTask {
   Configurable<float> ptMax{"ptMax", 1e10f, "Upper cut on pt for the track selected"};
   Configurable<float> etaMin{"etaMin", -0.8, "Lower cut on eta for the track selected"};
   Configurable<float> etaMax{"etaMax", 0.8, "Upper cut on eta for the track selected"};
+  Configurable<bool> evaluateRequestedTracksOnly{"evaluateRequestedTracksOnly", false, "evaluate the filter bits only for the tracks passing the loosest of the trackSelectionRequests of the workflow, the others are flagged as not selected"};
 
   Produces<aod::TrackSelection> filterTable;
   Produces<aod::TrackSelectionExtension> filterTableDetail;
   TrackSelection globalTracks;
   TrackSelection globalTracksSDD;
-  TrackSelection filtBit1;
-  TrackSelection filtBit2;
+  GlobalTrackSelectionRun3 filtBit1;
+  GlobalTrackSelectionRun3 filtBit2;
   TrackSelection filtBit3;
   TrackSelection filtBit4;
   TrackSelection filtBit5;
+  std::vector<uint16_t> globalTracksMasks; // selection masks of the global tracks, evaluated for the whole table
+  trackSelectionRequest requestedTracks;   // logical OR of the trackSelectionRequests of the workflow
+  bool hasTrackSelectionRequests = false;
+
+  static bool hasEnding(std::string const& fullString, std::string const& ending)
+  {
+    return fullString.length() >= ending.length() && fullString.compare(fullString.length() - ending.length(), ending.length(), ending) == 0;
+  }
+
+  /// Combines with a logical OR the trackSelectionRequests configured in the devices of the workflow
+  /// Each request is identified by the options of its members, with the name of the request as prefix.
+  void combineTrackSelectionRequests(InitContext& initContext)
+  {
+    auto& workflows = initContext.services().get<RunningWorkflowInfo const>();
+    std::map<std::string, trackSelectionRequest> requests;
+    for (DeviceSpec const& device : workflows.devices) {
+      for (auto const& option : device.options) {
+        if (!hasEnding(option.name, ".minTPCcrossedrowsoverfindable")) {
+          continue;
+        }
+        const std::string prefix = option.name.substr(0, option.name.length() - std::string("minTPCcrossedrowsoverfindable").length());
+        auto& request = requests[device.name + "/" + prefix];
+        for (auto const& member : device.options) {
+          if (member.name.compare(0, prefix.length(), prefix) != 0) {
+            continue;
+          }
+          const std::string name = member.name.substr(prefix.length());
+          if (name == "minPt") {
+            request.setMinPt(member.defaultValue.get<float>());
+          } else if (name == "maxPt") {
+            request.setMaxPt(member.defaultValue.get<float>());
+          } else if (name == "minEta") {
+            request.setMinEta(member.defaultValue.get<float>());
+          } else if (name == "maxEta") {
+            request.setMaxEta(member.defaultValue.get<float>());
+          } else if (name == "maxDCAz") {
+            request.setMaxDCAz(member.defaultValue.get<float>());
+          } else if (name == "maxDCAxyPtDep") {
+            request.setMaxDCAxyPtDep(member.defaultValue.get<float>());
+          } else if (name == "requireTPC") {
+            request.setRequireTPC(member.defaultValue.get<bool>());
+          } else if (name == "minTPCclusters") {
+            request.setMinTPCClusters(member.defaultValue.get<int>());
+          } else if (name == "minTPCcrossedrows") {
+            request.setMinTPCCrossedRows(member.defaultValue.get<int>());
+          } else if (name == "minTPCcrossedrowsoverfindable") {
+            request.setMinTPCCrossedRowsOverFindable(member.defaultValue.get<float>());
+          } else if (name == "requireITS") {
+            request.setRequireITS(member.defaultValue.get<bool>());
+          } else if (name == "minITSclusters") {
+            request.setMinITSClusters(member.defaultValue.get<int>());
+          } else if (name == "maxITSChi2percluster") {
+            request.setMaxITSChi2PerCluster(member.defaultValue.get<float>());
+          }
+        }
+      }
+    }
+    hasTrackSelectionRequests = !requests.empty();
+    if (!hasTrackSelectionRequests) {
+      return;
+    }
+    requestedTracks.SetTightSelections(); // Only loosen from this point forward
+    for (auto const& [name, request] : requests) {
+      LOG(info) << "Found the track selection request " << name;
+      requestedTracks.CombineWithLogicalOR(request);
+    }
+    LOG(info) << "Loosest of the track selection requests of the workflow:";
+    requestedTracks.PrintSelections();
+  }
 
   void init(InitContext& initContext)
   {
     // Check which tables are used
     enableFlagIfTableRequired(initContext, "TrackSelection", produceTable);
     enableFlagIfTableRequired(initContext, "TrackSelectionExtension", produceFBextendedTable);
+    combineTrackSelectionRequests(initContext);
+    if (evaluateRequestedTracksOnly && !hasTrackSelectionRequests) {
+      LOG(warning) << "evaluateRequestedTracksOnly is enabled but no trackSelectionRequest is found in the workflow: evaluating all the tracks";
+    }
 
     // Set up the track cuts
     switch (itsMatching) {
@@ -113,9 +191,9 @@ struct TrackSelectionTask {
     globalTracksSDD.SetPtRange(ptMin, ptMax);
     globalTracksSDD.SetEtaRange(etaMin, etaMax);
 
-    filtBit1 = getGlobalTrackSelectionRun3ITSMatch(TrackSelection::GlobalTrackRun3ITSMatching::Run3ITSibAny);
+    filtBit1 = GlobalTrackSelectionRun3(getGlobalTrackSelectionRun3ITSMatch(TrackSelection::GlobalTrackRun3ITSMatching::Run3ITSibAny));
 
-    filtBit2 = getGlobalTrackSelectionRun3ITSMatch(TrackSelection::GlobalTrackRun3ITSMatching::Run3ITSibTwo);
+    filtBit2 = GlobalTrackSelectionRun3(getGlobalTrackSelectionRun3ITSMatch(TrackSelection::GlobalTrackRun3ITSMatching::Run3ITSibTwo));
 
     filtBit3 = getGlobalTrackSelectionRun3HF();
 
@@ -136,22 +214,32 @@ struct TrackSelectionTask {
     if (produceTable == 0 && produceFBextendedTable == 0) {
       return;
     }
+    globalTracks.IsSelectedMask(tracks, globalTracksMasks);
+    auto trackMaskGlob = globalTracksMasks.cbegin();
     if (isRun3) {
       for (auto& track : tracks) {
+        o2::aod::track::TrackSelectionFlags::flagtype trackflagGlob = *trackMaskGlob++;
+        bool isRequested = true;
+        if (hasTrackSelectionRequests) {
+          isRequested = requestedTracks.IsTrackSelected(track);
+          if (isRequested) {
+            trackflagGlob |= o2::aod::track::TrackSelectionFlags::kTrackSelectionRequest;
+          }
+        }
+        const bool evaluateFilterBits = isRequested || !evaluateRequestedTracksOnly; // the tracks rejected by all the requests are flagged as not selected
 
         if (produceTable == 1) {
           filterTable((uint8_t)0,
-                      globalTracks.IsSelectedMask(track),
-                      filtBit1.IsSelected(track),
-                      filtBit2.IsSelected(track),
-                      filtBit3.IsSelected(track),
-                      filtBit4.IsSelected(track),
-                      filtBit5.IsSelected(track));
+                      trackflagGlob,
+                      evaluateFilterBits && filtBit1.IsSelected(track),
+                      evaluateFilterBits && filtBit2.IsSelected(track),
+                      evaluateFilterBits && filtBit3.IsSelected(track),
+                      evaluateFilterBits && filtBit4.IsSelected(track),
+                      evaluateFilterBits && filtBit5.IsSelected(track));
         }
         if (produceFBextendedTable == 1) {
-          o2::aod::track::TrackSelectionFlags::flagtype trackflagGlob = globalTracks.IsSelectedMask(track);
-          o2::aod::track::TrackSelectionFlags::flagtype trackflagFB1 = filtBit1.IsSelectedMask(track);
-          o2::aod::track::TrackSelectionFlags::flagtype trackflagFB2 = filtBit2.IsSelectedMask(track);
+          o2::aod::track::TrackSelectionFlags::flagtype trackflagFB1 = evaluateFilterBits ? filtBit1.IsSelectedMask(track) : 0;
+          o2::aod::track::TrackSelectionFlags::flagtype trackflagFB2 = evaluateFilterBits ? filtBit2.IsSelectedMask(track) : 0;
           // o2::aod::track::TrackSelectionFlags::flagtype trackflagFB3 = filtBit3.IsSelectedMask(track); // only temporarily commented, will be used
           // o2::aod::track::TrackSelectionFlags::flagtype trackflagFB4 = filtBit4.IsSelectedMask(track);
           // o2::aod::track::TrackSelectionFlags::flagtype trackflagFB5 = filtBit5.IsSelectedMask(track);
@@ -179,15 +267,23 @@ struct TrackSelectionTask {
     }
 
     for (auto& track : tracks) {
-      o2::aod::track::TrackSelectionFlags::flagtype trackflagGlob = globalTracks.IsSelectedMask(track);
+      o2::aod::track::TrackSelectionFlags::flagtype trackflagGlob = *trackMaskGlob++;
+      bool isRequested = true;
+      if (hasTrackSelectionRequests) {
+        isRequested = requestedTracks.IsTrackSelected(track);
+        if (isRequested) {
+          trackflagGlob |= o2::aod::track::TrackSelectionFlags::kTrackSelectionRequest;
+        }
+      }
+      const bool evaluateFilterBits = isRequested || !evaluateRequestedTracksOnly; // the tracks rejected by all the requests are flagged as not selected
       if (produceTable == 1) {
-        filterTable((uint8_t)globalTracksSDD.IsSelected(track),
-                    globalTracks.IsSelectedMask(track),
-                    filtBit1.IsSelected(track),
-                    filtBit2.IsSelected(track),
-                    filtBit3.IsSelected(track),
-                    filtBit4.IsSelected(track),
-                    filtBit5.IsSelected(track));
+        filterTable((uint8_t)(evaluateFilterBits && globalTracksSDD.IsSelected(track)),
+                    trackflagGlob,
+                    evaluateFilterBits && filtBit1.IsSelected(track),
+                    evaluateFilterBits && filtBit2.IsSelected(track),
+                    evaluateFilterBits && filtBit3.IsSelected(track),
+                    evaluateFilterBits && filtBit4.IsSelected(track),
+                    evaluateFilterBits && filtBit5.IsSelected(track));
       }
       if (produceFBextendedTable == 1) {
         filterTableDetail(o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTrackType),
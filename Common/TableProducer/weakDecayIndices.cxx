@@ -11,6 +11,7 @@
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
+#include <vector>
 
 using namespace o2;
 using namespace o2::framework;
@@ -18,16 +19,36 @@ using namespace o2::framework;
 // Converts V0 and cascade version 000 to 001
 // Build indices to group V0s and cascades to collisions
 
+// The output tables are row-by-row conversions of the input ones (the cascades refer to the V0s by row),
+// so the rows are kept in their original order. The per-row index dereferencing is replaced by lookups
+// in the collision-index column of the tracks, read once per data frame.
+
+/// Copies the collision index of each track into a flat array
+template <typename TTracks>
+void fillTrackCollisionIds(TTracks const& tracks, std::vector<int32_t>& collisionIds)
+{
+  collisionIds.resize(tracks.size());
+  for (auto const& track : tracks) {
+    collisionIds[track.globalIndex()] = track.collisionId();
+  }
+}
+
 struct WeakDecayIndicesV0 {
   Produces<aod::V0s_001> v0s_001;
 
+  std::vector<int32_t> trackCollisionIds; // collision index of each track
+
   void process(aod::V0s_000 const& v0s, aod::Tracks const& tracks)
   {
+    fillTrackCollisionIds(tracks, trackCollisionIds);
+    v0s_001.reserve(v0s.size());
     for (auto& v0 : v0s) {
-      if (v0.posTrack().collisionId() != v0.negTrack().collisionId()) {
-        LOGF(fatal, "V0 %d has inconsistent collision information (%d, %d)", v0.globalIndex(), v0.posTrack().collisionId(), v0.negTrack().collisionId());
+      const int32_t posCollisionId = trackCollisionIds[v0.posTrackId()];
+      const int32_t negCollisionId = trackCollisionIds[v0.negTrackId()];
+      if (posCollisionId != negCollisionId) {
+        LOGF(fatal, "V0 %d has inconsistent collision information (%d, %d)", v0.globalIndex(), posCollisionId, negCollisionId);
       }
-      v0s_001(v0.posTrack().collisionId(), v0.posTrackId(), v0.negTrackId());
+      v0s_001(posCollisionId, v0.posTrackId(), v0.negTrackId());
     }
   }
 };
@@ -36,14 +57,22 @@ struct WeakDecayIndicesV0 {
 struct WeakDecayIndicesCascades {
   Produces<aod::Cascades_001> cascades_001;
 
+  std::vector<int32_t> trackCollisionIds; // collision index of each track
+
   void process(aod::V0s const& v0s, aod::Cascades_000 const& cascades, aod::Tracks const& tracks)
   {
+    fillTrackCollisionIds(tracks, trackCollisionIds);
+    cascades_001.reserve(cascades.size());
     for (auto& cascade : cascades) {
-      if (cascade.bachelor().collisionId() != cascade.v0().posTrack().collisionId() || cascade.v0().posTrack().collisionId() != cascade.v0().negTrack().collisionId()) {
-        LOGF(fatal, "Cascade %d has inconsistent collision information (%d, %d, %d) track ids %d %d %d", cascade.globalIndex(), cascade.bachelor().collisionId(),
-             cascade.v0().posTrack().collisionId(), cascade.v0().negTrack().collisionId(), cascade.bachelorId(), cascade.v0().posTrackId(), cascade.v0().negTrackId());
+      auto v0 = v0s.rawIteratorAt(cascade.v0Id());
+      const int32_t bachelorCollisionId = trackCollisionIds[cascade.bachelorId()];
+      const int32_t posCollisionId = trackCollisionIds[v0.posTrackId()];
+      const int32_t negCollisionId = trackCollisionIds[v0.negTrackId()];
+      if (bachelorCollisionId != posCollisionId || posCollisionId != negCollisionId) {
+        LOGF(fatal, "Cascade %d has inconsistent collision information (%d, %d, %d) track ids %d %d %d", cascade.globalIndex(), bachelorCollisionId,
+             posCollisionId, negCollisionId, cascade.bachelorId(), v0.posTrackId(), v0.negTrackId());
       }
-      cascades_001(cascade.bachelor().collisionId(), cascade.v0Id(), cascade.bachelorId());
+      cascades_001(bachelorCollisionId, cascade.v0Id(), cascade.bachelorId());
     }
   }
 };
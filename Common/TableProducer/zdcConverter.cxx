@@ -26,9 +26,13 @@ struct zdcConverter {
 
   void process(aod::Zdcs_000 const& zdcLegacy, aod::BCs const&)
   {
+    Zdcs_001.reserve(zdcLegacy.size());
+    // Buffers of the new table, reused for all the rows
+    std::vector<float> zdcEnergy, zdcAmplitudes, zdcTime;
+    std::vector<uint8_t> zdcChannelsE, zdcChannelsT;
     for (auto& zdcData : zdcLegacy) {
       // Get legacy information, please
-      auto bc = zdcData.bc();
+      auto bc = zdcData.bcId();
       auto energyZEM1 = zdcData.energyZEM1();
       auto energyZEM2 = zdcData.energyZEM2();
       auto energyCommonZNA = zdcData.energyCommonZNA();
@@ -46,9 +50,12 @@ struct zdcConverter {
       auto timeZPA = zdcData.timeZPA();
       auto timeZPC = zdcData.timeZPC();
 
-      // Create variables to initialize Zdcs_001 table
-      std::vector<float> zdcEnergy, zdcAmplitudes, zdcTime;
-      std::vector<uint8_t> zdcChannelsE, zdcChannelsT;
+      // Reset the variables to initialize Zdcs_001 table
+      zdcEnergy.clear();
+      zdcAmplitudes.clear();
+      zdcTime.clear();
+      zdcChannelsE.clear();
+      zdcChannelsT.clear();
 
       // Tie variables in such that they get read correctly later
       zdcEnergy.emplace_back(energyZEM1);
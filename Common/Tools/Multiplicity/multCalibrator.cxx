@@ -25,6 +25,9 @@
 #include "TStopwatch.h"
 #include "TArrayL64.h"
 #include "TArrayF.h"
+#include "TKey.h"
+#include "TTree.h"
+#include "TMath.h"
 #include "multCalibrator.h"
 
 const TString multCalibrator::fCentEstimName[kNCentEstim] = {
@@ -40,12 +43,16 @@ multCalibrator::multCalibrator() : TNamed(),
                                    fAnchorPointValue(-1),
                                    fAnchorPointPercentage(90),
                                    fCalibHists(0x0),
-                                   fPrecisionHistogram(0x0)
+                                   fPrecisionHistogram(0x0),
+                                   fStreamNEvents(0),
+                                   fStreamINELgtZERO(kTRUE),
+                                   fStreamVertexZCut(10.0)
 {
   // Constructor
   // Make sure the TList owns its objects
   fCalibHists = new TList();
   fCalibHists->SetOwner(kTRUE);
+  SetStandardStreamingBinning();
 }
 
 multCalibrator::multCalibrator(const char* name, const char* title) : TNamed(name, title),
@@ -57,12 +64,16 @@ multCalibrator::multCalibrator(const char* name, const char* title) : TNamed(nam
                                                                       fAnchorPointValue(-1),
                                                                       fAnchorPointPercentage(90),
                                                                       fCalibHists(0x0),
-                                                                      fPrecisionHistogram(0x0)
+                                                                      fPrecisionHistogram(0x0),
+                                                                      fStreamNEvents(0),
+                                                                      fStreamINELgtZERO(kTRUE),
+                                                                      fStreamVertexZCut(10.0)
 {
   // Named Constructor
   // Make sure the TList owns its objects
   fCalibHists = new TList();
   fCalibHists->SetOwner(kTRUE);
+  SetStandardStreamingBinning();
 }
 //________________________________________________________________
 multCalibrator::~multCalibrator()
@@ -76,6 +87,12 @@ multCalibrator::~multCalibrator()
     delete fPrecisionHistogram;
     fPrecisionHistogram = 0x0;
   }
+  for (Int_t iv = 0; iv < kNCentEstim; iv++) {
+    if (fStreamHists[iv]) {
+      delete fStreamHists[iv];
+      fStreamHists[iv] = 0x0;
+    }
+  }
 }
 
 //________________________________________________________________
@@ -109,11 +126,22 @@ Bool_t multCalibrator::Calibrate()
   }
 
   cout << "Histograms loaded! Will now calibrate..." << endl;
+  TH1* hInput[kNCentEstim];
+  for (Int_t iv = 0; iv < kNCentEstim; iv++)
+    hInput[iv] = hRaw[iv];
+  return WriteCalibrationFile(hInput);
+}
 
-  //Create output file
+//________________________________________________________________
+Bool_t multCalibrator::WriteCalibrationFile(TH1** hRaw)
+{
+  //Calibrates all estimators for which a raw histogram is provided
+  //and stores the calibration histograms in fOutputFileName
   TFile* fOut = new TFile(fOutputFileName.Data(), "RECREATE");
   TH1F* hCalib[kNCentEstim];
   for (Int_t iv = 0; iv < kNCentEstim; iv++) {
+    if (!hRaw[iv])
+      continue;
     cout << Form("Calibrating estimator: %s", fCentEstimName[iv].Data()) << endl;
     hCalib[iv] = GetCalibrationHistogram(hRaw[iv], Form("hCalib%s", fCentEstimName[iv].Data()));
     hCalib[iv]->Write();
@@ -125,6 +153,305 @@ Bool_t multCalibrator::Calibrate()
   return kTRUE;
 }
 
+//________________________________________________________________
+void multCalibrator::SetStandardStreamingBinning()
+{
+  //Fine binning of the streaming accumulators: at least 8 times finer than
+  //the default multiplicity QA axes, 0.64 MB per estimator
+  const Double_t lDefaultMax[kNCentEstim] = {500000, 40000, 4000, 500,
+                                             500000, 40000, 4000, 500};
+  for (Int_t iv = 0; iv < kNCentEstim; iv++) {
+    fStreamNBins[iv] = 80000;
+    fStreamMax[iv] = lDefaultMax[iv];
+    fStreamHists[iv] = 0x0;
+  }
+}
+
+//________________________________________________________________
+void multCalibrator::SetStreamingBinning(Int_t lEstim, Long_t lNBins, Double_t lMax)
+{
+  if (lEstim < 0 || lEstim >= kNCentEstim || lNBins < 1 || lMax <= 0) {
+    cout << "Invalid streaming binning requested, ignoring!" << endl;
+    return;
+  }
+  if (fStreamHists[lEstim]) {
+    cout << "Streaming accumulators already booked: binning of " << fCentEstimName[lEstim].Data() << " will only change after InitStreaming()!" << endl;
+  }
+  fStreamNBins[lEstim] = lNBins;
+  fStreamMax[lEstim] = lMax;
+}
+
+//________________________________________________________________
+void multCalibrator::InitStreaming()
+{
+  //Books the accumulators. Memory is fixed by the binning only, not by the
+  //number of collisions consumed
+  for (Int_t iv = 0; iv < kNCentEstim; iv++) {
+    if (fStreamHists[iv])
+      delete fStreamHists[iv];
+    fStreamHists[iv] = new TH1D(Form("h%s", fCentEstimName[iv].Data()), "", fStreamNBins[iv], 0, fStreamMax[iv]);
+    fStreamHists[iv]->SetDirectory(0);
+  }
+  fStreamNEvents = 0;
+}
+
+//________________________________________________________________
+void multCalibrator::Fill(Int_t lEstim, Double_t lValue, Double_t lWeight)
+{
+  if (!fStreamHists[lEstim])
+    InitStreaming();
+  fStreamHists[lEstim]->Fill(lValue, lWeight);
+}
+
+//________________________________________________________________
+void multCalibrator::FillChunk(Int_t lEstim, Long64_t lN, const Double_t* lValues, const Double_t* lWeights)
+{
+  if (lN < 1)
+    return;
+  if (!fStreamHists[lEstim])
+    InitStreaming();
+  fStreamHists[lEstim]->FillN(static_cast<Int_t>(lN), lValues, lWeights);
+}
+
+//________________________________________________________________
+Long64_t multCalibrator::ConsumeAO2D(TString lFile, Long64_t lChunkSize)
+{
+  //Adds the collisions of an AO2D file (multiplicity tables O2mult and,
+  //if present, O2multzeq, one pair per DF directory) to the accumulators.
+  //Rows are read in chunks of lChunkSize and filled in one go per estimator.
+  //Event selection is expected to be applied when producing the tables,
+  //only INEL>0 and the vertex-z cut (if collisions are saved) are applied here.
+  if (!fStreamHists[0])
+    InitStreaming();
+  if (lChunkSize < 1)
+    lChunkSize = 100000;
+
+  TFile* fileInput = TFile::Open(lFile.Data(), "READ");
+  if (!fileInput || fileInput->IsZombie()) {
+    cout << "Input file " << lFile.Data() << " not found!" << endl;
+    return 0;
+  }
+
+  std::vector<Double_t> lValues[kNCentEstim];
+  for (Int_t iv = 0; iv < kNCentEstim; iv++)
+    lValues[iv].reserve(lChunkSize);
+
+  Long64_t lAccepted = 0;
+  TIter lNextKey(fileInput->GetListOfKeys());
+  TKey* lKey = 0x0;
+  while ((lKey = (TKey*)lNextKey())) {
+    if (!TString(lKey->GetName()).BeginsWith("DF_"))
+      continue;
+    TDirectory* lDF = (TDirectory*)fileInput->Get(lKey->GetName());
+    if (!lDF)
+      continue;
+    TTree* lMult = (TTree*)lDF->Get("O2mult");
+    if (!lMult) {
+      cout << lKey->GetName() << " does not contain the multiplicity table, skipping!" << endl;
+      continue;
+    }
+    TTree* lMultZeq = (TTree*)lDF->Get("O2multzeq");
+    if (lMultZeq && lMultZeq->GetEntries() != lMult->GetEntries())
+      lMultZeq = 0x0;
+    TTree* lCollisions = 0x0;
+    if (fStreamVertexZCut > 0) {
+      lCollisions = (TTree*)lDF->Get("O2collision");
+      if (!lCollisions)
+        lCollisions = (TTree*)lDF->Get("O2collision_001");
+      if (lCollisions && lCollisions->GetEntries() != lMult->GetEntries())
+        lCollisions = 0x0;
+    }
+
+    Float_t lFV0A = 0, lFV0C = 0, lFT0A = 0, lFT0C = 0, lFDDA = 0, lFDDC = 0;
+    Int_t lNTracksPV = 0, lNTracksPVeta1 = 0;
+    Float_t lZeqFV0A = 0, lZeqFT0A = 0, lZeqFT0C = 0, lZeqFDDA = 0, lZeqFDDC = 0, lZeqNTracksPV = 0;
+    Float_t lPosZ = 0;
+
+    //only read what is needed
+    lMult->SetBranchStatus("*", 0);
+    const char* lMultBranches[8] = {"fMultFV0A", "fMultFV0C", "fMultFT0A", "fMultFT0C", "fMultFDDA", "fMultFDDC", "fMultNTracksPV", "fMultNTracksPVeta1"};
+    void* lMultAddresses[8] = {&lFV0A, &lFV0C, &lFT0A, &lFT0C, &lFDDA, &lFDDC, &lNTracksPV, &lNTracksPVeta1};
+    for (Int_t ib = 0; ib < 8; ib++) {
+      lMult->SetBranchStatus(lMultBranches[ib], 1);
+      lMult->SetBranchAddress(lMultBranches[ib], lMultAddresses[ib]);
+    }
+    if (lMultZeq) {
+      lMultZeq->SetBranchStatus("*", 0);
+      const char* lZeqBranches[6] = {"fMultZeqFV0A", "fMultZeqFT0A", "fMultZeqFT0C", "fMultZeqFDDA", "fMultZeqFDDC", "fMultZeqNTracksPV"};
+      void* lZeqAddresses[6] = {&lZeqFV0A, &lZeqFT0A, &lZeqFT0C, &lZeqFDDA, &lZeqFDDC, &lZeqNTracksPV};
+      for (Int_t ib = 0; ib < 6; ib++) {
+        lMultZeq->SetBranchStatus(lZeqBranches[ib], 1);
+        lMultZeq->SetBranchAddress(lZeqBranches[ib], lZeqAddresses[ib]);
+      }
+    }
+    if (lCollisions) {
+      lCollisions->SetBranchStatus("*", 0);
+      lCollisions->SetBranchStatus("fPosZ", 1);
+      lCollisions->SetBranchAddress("fPosZ", &lPosZ);
+    }
+
+    const Long64_t lNRows = lMult->GetEntries();
+    for (Long64_t lChunkStart = 0; lChunkStart < lNRows; lChunkStart += lChunkSize) {
+      const Long64_t lChunkEnd = TMath::Min(lChunkStart + lChunkSize, lNRows);
+      for (Int_t iv = 0; iv < kNCentEstim; iv++)
+        lValues[iv].clear();
+      for (Long64_t iRow = lChunkStart; iRow < lChunkEnd; iRow++) {
+        lMult->GetEntry(iRow);
+        if (fStreamINELgtZERO && lNTracksPVeta1 < 1)
+          continue;
+        if (lCollisions) {
+          lCollisions->GetEntry(iRow);
+          if (TMath::Abs(lPosZ) > fStreamVertexZCut)
+            continue;
+        }
+        lValues[kCentRawV0M].push_back(lFV0A + lFV0C);
+        lValues[kCentRawT0M].push_back(lFT0A + lFT0C);
+        lValues[kCentRawFDD].push_back(lFDDA + lFDDC);
+        lValues[kCentRawNTracks].push_back(lNTracksPV);
+        if (lMultZeq) {
+          lMultZeq->GetEntry(iRow);
+          lValues[kCentZeqV0M].push_back(lZeqFV0A);
+          lValues[kCentZeqT0M].push_back(lZeqFT0A + lZeqFT0C);
+          lValues[kCentZeqFDD].push_back(lZeqFDDA + lZeqFDDC);
+          lValues[kCentZeqNTracks].push_back(lZeqNTracksPV);
+        }
+      }
+      for (Int_t iv = 0; iv < kNCentEstim; iv++)
+        FillChunk(iv, lValues[iv].size(), lValues[iv].data());
+      lAccepted += lValues[kCentRawV0M].size();
+    }
+  }
+  fileInput->Close();
+  delete fileInput;
+
+  fStreamNEvents += lAccepted;
+  cout << "Consumed " << lFile.Data() << ": accepted collisions " << lAccepted << ", total so far " << fStreamNEvents << endl;
+  return lAccepted;
+}
+
+//________________________________________________________________
+Bool_t multCalibrator::Merge(const multCalibrator* lOther)
+{
+  //Adds the accumulators of another calibrator (e.g. a different subset of
+  //runs of the same period). Binnings have to be identical.
+  if (!lOther)
+    return kFALSE;
+  if (!fStreamHists[0])
+    InitStreaming();
+  for (Int_t iv = 0; iv < kNCentEstim; iv++) {
+    if (!lOther->fStreamHists[iv])
+      continue;
+    if (lOther->fStreamNBins[iv] != fStreamNBins[iv] || TMath::Abs(lOther->fStreamMax[iv] - fStreamMax[iv]) > 1e-6) {
+      cout << "Cannot merge " << fCentEstimName[iv].Data() << ": different streaming binning!" << endl;
+      return kFALSE;
+    }
+  }
+  for (Int_t iv = 0; iv < kNCentEstim; iv++) {
+    if (lOther->fStreamHists[iv])
+      fStreamHists[iv]->Add(lOther->fStreamHists[iv]);
+  }
+  fStreamNEvents += lOther->fStreamNEvents;
+  return kTRUE;
+}
+
+//________________________________________________________________
+Bool_t multCalibrator::SaveStreamingState(TString lFile)
+{
+  //Stores the accumulators. Files from different subsets can be merged
+  //with hadd or re-loaded with LoadStreamingState
+  if (!fStreamHists[0]) {
+    cout << "Nothing accumulated yet!" << endl;
+    return kFALSE;
+  }
+  TFile* fOut = new TFile(lFile.Data(), "RECREATE");
+  if (!fOut || fOut->IsZombie()) {
+    cout << "Could not create " << lFile.Data() << "!" << endl;
+    return kFALSE;
+  }
+  for (Int_t iv = 0; iv < kNCentEstim; iv++)
+    fStreamHists[iv]->Write();
+  fOut->Close();
+  delete fOut;
+  return kTRUE;
+}
+
+//________________________________________________________________
+Bool_t multCalibrator::LoadStreamingState(TString lFile)
+{
+  TFile* fileInput = TFile::Open(lFile.Data(), "READ");
+  if (!fileInput || fileInput->IsZombie()) {
+    cout << "Input file " << lFile.Data() << " not found!" << endl;
+    return kFALSE;
+  }
+  TH1D* hState[kNCentEstim];
+  for (Int_t iv = 0; iv < kNCentEstim; iv++) {
+    hState[iv] = (TH1D*)fileInput->Get(Form("h%s", fCentEstimName[iv].Data()));
+    if (!hState[iv]) {
+      cout << Form("File does not contain histogram h%s, not a streaming state!", fCentEstimName[iv].Data()) << endl;
+      fileInput->Close();
+      delete fileInput;
+      return kFALSE;
+    }
+  }
+  //adopt the binning of the state if nothing has been accumulated yet
+  Bool_t lEmpty = kTRUE;
+  for (Int_t iv = 0; iv < kNCentEstim; iv++) {
+    if (fStreamHists[iv] && fStreamHists[iv]->GetEntries() > 0)
+      lEmpty = kFALSE;
+  }
+  if (lEmpty) {
+    for (Int_t iv = 0; iv < kNCentEstim; iv++) {
+      fStreamNBins[iv] = hState[iv]->GetNbinsX();
+      fStreamMax[iv] = hState[iv]->GetXaxis()->GetXmax();
+    }
+    InitStreaming();
+  }
+  Bool_t lSuccess = kTRUE;
+  for (Int_t iv = 0; iv < kNCentEstim; iv++) {
+    if (hState[iv]->GetNbinsX() != fStreamNBins[iv] || TMath::Abs(hState[iv]->GetXaxis()->GetXmax() - fStreamMax[iv]) > 1e-6) {
+      cout << "Cannot load " << fCentEstimName[iv].Data() << ": different streaming binning!" << endl;
+      lSuccess = kFALSE;
+      continue;
+    }
+    fStreamHists[iv]->Add(hState[iv]);
+  }
+  fStreamNEvents += static_cast<Long64_t>(hState[kCentRawV0M]->GetEntries());
+  fileInput->Close();
+  delete fileInput;
+  return lSuccess;
+}
+
+//________________________________________________________________
+Bool_t multCalibrator::CalibrateStreaming()
+{
+  //Same as Calibrate(), but starting from the streaming accumulators.
+  //Can be called at any time to produce a (partial) calibration
+  cout << "=== STARTING CALIBRATION PROCEDURE (STREAMING) ===" << endl;
+  cout << " * Collisions.....: " << fStreamNEvents << endl;
+  cout << " * Output File....: " << fOutputFileName.Data() << endl;
+  cout << endl;
+
+  TH1* hInput[kNCentEstim];
+  Bool_t lAny = kFALSE;
+  for (Int_t iv = 0; iv < kNCentEstim; iv++) {
+    hInput[iv] = 0x0;
+    if (!fStreamHists[iv] || fStreamHists[iv]->GetEntries() < 1) {
+      cout << Form("No entries for estimator %s, skipping!", fCentEstimName[iv].Data()) << endl;
+      continue;
+    }
+    if (fStreamHists[iv]->GetBinContent(fStreamHists[iv]->GetNbinsX() + 1) > 0) {
+      cout << Form("WARNING: estimator %s has entries above %.1f, please enlarge the streaming range!", fCentEstimName[iv].Data(), fStreamMax[iv]) << endl;
+    }
+    hInput[iv] = fStreamHists[iv];
+    lAny = kTRUE;
+  }
+  if (!lAny) {
+    cout << "Nothing accumulated yet!" << endl;
+    return kFALSE;
+  }
+  return WriteCalibrationFile(hInput);
+}
+
 Double_t multCalibrator::GetRawMax(TH1* histo)
 {
   //This function gets the max X value (right edge) which is filled.
@@ -23,6 +23,7 @@
 #include "TNamed.h"
 #include "TH1D.h"
 #include <map>
+#include <vector>
 
 using namespace std;
 
@@ -70,6 +71,28 @@ class multCalibrator : public TNamed
   Double_t GetRawMax(TH1* histo);
   Double_t GetBoundaryForPercentile(TH1* histo, Double_t lPercentileRequested, Double_t& lPrecisionEstimate);
 
+  //_________________________________________________________________________
+  //Streaming mode: the estimators are accumulated chunk by chunk into
+  //fixed, fine-binned histograms (memory does not grow with statistics)
+  //that can be merged, saved and calibrated at any point
+  void SetStreamingBinning(Int_t lEstim, Long_t lNBins, Double_t lMax);
+  void SetStreamingINELgtZERO(Bool_t lOpt) { fStreamINELgtZERO = lOpt; }
+  void SetStreamingVertexZCut(Float_t lVtxZ) { fStreamVertexZCut = lVtxZ; } //negative: no cut
+  void InitStreaming();                                                    //books (or resets) the accumulators
+
+  void Fill(Int_t lEstim, Double_t lValue, Double_t lWeight = 1.0);
+  void FillChunk(Int_t lEstim, Long64_t lN, const Double_t* lValues, const Double_t* lWeights = 0x0);
+  Long64_t ConsumeAO2D(TString lFile, Long64_t lChunkSize = 100000); //returns accepted collisions
+  Bool_t Merge(const multCalibrator* lOther);
+  Bool_t SaveStreamingState(TString lFile);
+  Bool_t LoadStreamingState(TString lFile); //adds to the current accumulators
+
+  TH1D* GetStreamingHistogram(Int_t lEstim) { return fStreamHists[lEstim]; }
+  Long64_t GetStreamingNEvents() const { return fStreamNEvents; }
+
+  //Calibration from whatever has been accumulated so far
+  Bool_t CalibrateStreaming();
+
   //Precision bookkeeping
   TH1D* GetPrecisionHistogram() { return fPrecisionHistogram; }; //gets precision histogram from current object
   void ResetPrecisionHistogram();                                //Reset precision histogram, if it exists
@@ -108,7 +131,18 @@ class multCalibrator : public TNamed
 
   TH1D* fPrecisionHistogram; //for bookkeeping of precision report
 
-  ClassDef(multCalibrator, 1);
+  // Streaming mode accumulators
+  Long_t fStreamNBins[kNCentEstim];  // fine binning of the accumulators
+  Double_t fStreamMax[kNCentEstim];  // upper edge of the accumulators
+  TH1D* fStreamHists[kNCentEstim];   // accumulated raw estimators
+  Long64_t fStreamNEvents;           // accepted collisions
+  Bool_t fStreamINELgtZERO;          // require one PV contributor in |eta|<1
+  Float_t fStreamVertexZCut;         // max |vertex z| (cm), if collisions available
+
+  void SetStandardStreamingBinning();
+  Bool_t WriteCalibrationFile(TH1** hRaw);
+
+  ClassDef(multCalibrator, 2);
   //(this classdef is only for bookkeeping, class will not usually
   // be streamed according to current workflow except in very specific
   // tests!)
@@ -33,6 +33,13 @@
 #include "TVirtualFitter.h"
 #include "TProfile.h"
 #include "TFitResult.h"
+#include "TROOT.h"
+#include "Math/MinimizerOptions.h"
+#include "Math/PdfFuncMathCore.h"
+#include <atomic>
+#include <functional>
+#include <map>
+#include <thread>
 
 ClassImp(multGlauberNBDFitter);
 
@@ -176,6 +183,18 @@ Double_t multGlauberNBDFitter::ProbDistrib(Double_t* x, Double_t* par)
     fhNanc->Scale(1. / fhNanc->Integral());
   }
   //______________________________________________________
+  //Use the evaluation of all the input bins for this set of parameters
+  //when evaluating at a bin center, as done in the fit
+  if (fUseCache && fhV0M) {
+    Int_t lBin = fhV0M->FindBin(lMultValue);
+    if (lMultValue == fhV0M->GetBinCenter(lBin)) {
+      if (ffChanged || fCachePars.size() != 3 || fCachePars[0] != par[0] || fCachePars[1] != par[1] || fCachePars[2] != par[2])
+        FillEvaluationCache(par);
+      if (lBin >= fCacheFirstBin && lBin <= fCacheLastBin)
+        return par[3] * fCacheValues[lBin - fCacheFirstBin];
+    }
+  }
+  //______________________________________________________
   //Actually evaluate function
   Int_t lStartBin = fhNanc->FindBin(0.0) + 1;
   for (Long_t iNanc = lStartBin; iNanc < fhNanc->GetNbinsX() + 1; iNanc++) {
@@ -215,6 +234,7 @@ Bool_t multGlauberNBDFitter::SetInputV0M(TH1* hV0M)
   Bool_t lReturnValue = kTRUE;
   if (hV0M) {
     fhV0M = (TH1*)hV0M;
+    fCachePars.clear();
   } else {
     lReturnValue = kFALSE;
   }
@@ -237,6 +257,7 @@ TF1* multGlauberNBDFitter::GetGlauberNBD()
 void multGlauberNBDFitter::SetFitRange(Double_t lMin, Double_t lMax)
 {
   fGlauberNBD->SetRange(lMin, lMax);
+  fCachePars.clear();
 }
 
 //________________________________________________________________
@@ -280,9 +301,11 @@ Bool_t multGlauberNBDFitter::DoFit()
   cout << "---> Now fitting, please wait..." << endl;
 
   fGlauberNBD->SetNpx(fFitNpx);
+  fCachePars.clear();
   TFitResultPtr fitptr;
   fFitOptions.Append("S");
-  fitptr = fhV0M->Fit("fGlauberNBD", fFitOptions.Data());
+  //pass the function itself: several fitters may exist, all with a function named fGlauberNBD
+  fitptr = fhV0M->Fit(fGlauberNBD, fFitOptions.Data());
 
   timer->Stop();
   Double_t lTotalTime = timer->RealTime();
@@ -324,6 +347,161 @@ Bool_t multGlauberNBDFitter::InitializeNpNc()
   return lReturnValue;
 }
 
+//________________________________________________________________
+std::vector<Bool_t> multGlauberNBDFitter::DoFits(const std::vector<multGlauberNBDFitter*>& lFitters, Int_t lNThreads)
+{
+  //Fits running concurrently need ROOT thread safety and a minimiser without global state
+  ROOT::EnableThreadSafety();
+  ROOT::Math::MinimizerOptions::SetDefaultMinimizer("Minuit2");
+  if (lNThreads <= 0)
+    lNThreads = TMath::Max(1U, std::thread::hardware_concurrency());
+
+  //Fitting modifies the input histogram: inputs shared by several fitters are cloned
+  std::map<TH1*, Int_t> lInputUsage;
+  std::vector<TH1*> lOriginalInputs(lFitters.size(), 0x0);
+  for (size_t iFit = 0; iFit < lFitters.size(); iFit++) {
+    TH1* lInput = lFitters[iFit]->fhV0M;
+    if (lInput && lInputUsage[lInput]++ > 0) {
+      lOriginalInputs[iFit] = lInput;
+      lFitters[iFit]->fhV0M = (TH1*)lInput->Clone(Form("%s_fit%zu", lInput->GetName(), iFit));
+      lFitters[iFit]->fhV0M->SetDirectory(0x0);
+    }
+  }
+
+  std::vector<char> lResults(lFitters.size(), 0);
+  std::atomic<size_t> lNextFit{0};
+  auto lWorker = [&]() {
+    for (size_t iFit = lNextFit++; iFit < lFitters.size(); iFit = lNextFit++) {
+      lResults[iFit] = lFitters[iFit]->DoFit();
+    }
+  };
+  std::vector<std::thread> lThreads;
+  for (Int_t iThread = 1; iThread < TMath::Min(lNThreads, (Int_t)lFitters.size()); iThread++) {
+    lThreads.emplace_back(lWorker);
+  }
+  lWorker();
+  for (auto& lThread : lThreads) {
+    lThread.join();
+  }
+
+  for (size_t iFit = 0; iFit < lFitters.size(); iFit++) {
+    if (lOriginalInputs[iFit]) {
+      delete lFitters[iFit]->fhV0M;
+      lFitters[iFit]->fhV0M = lOriginalInputs[iFit];
+    }
+  }
+  return std::vector<Bool_t>(lResults.begin(), lResults.end());
+}
+
+//________________________________________________________________
+void multGlauberNBDFitter::FillEvaluationCache(Double_t* par)
+{
+  //Evaluates the sum over ancestors for all the input bins in the fit range
+  //The ancestor bins are split in chunks over fNThreads threads
+  fCachePars.assign(par, par + 3);
+  Double_t lLoRange, lHiRange;
+  fGlauberNBD->GetRange(lLoRange, lHiRange);
+  fCacheFirstBin = TMath::Max(fhV0M->FindBin(lLoRange), 1);
+  fCacheLastBin = TMath::Min(fhV0M->FindBin(lHiRange), fhV0M->GetNbinsX());
+  const Int_t lNBins = fCacheLastBin - fCacheFirstBin + 1;
+  fCacheValues.assign(TMath::Max(lNBins, 0), 0.0);
+  if (lNBins <= 0)
+    return;
+
+  //terms depending only on the number of ancestors, computed once per set of parameters
+  struct AncestorTerms {
+    Double_t fCount, fMu, fk, fpval, fLnGammak, fGammak, fLogMuOverk, fLog1PlusMuOverk;
+  };
+  std::vector<AncestorTerms> lAncestors;
+  Int_t lStartBin = fhNanc->FindBin(0.0) + 1;
+  for (Long_t iNanc = lStartBin; iNanc < fhNanc->GetNbinsX() + 1; iNanc++) {
+    Double_t lNancestorCount = fhNanc->GetBinContent(iNanc);
+    if (lNancestorCount == 0)
+      continue; //no contribution
+    Double_t lNancestors = fhNanc->GetBinCenter(iNanc);
+    AncestorTerms lTerms;
+    lTerms.fCount = lNancestorCount;
+    lTerms.fMu = (((Double_t)lNancestors)) * par[0];
+    lTerms.fk = (((Double_t)lNancestors)) * par[1];
+    lTerms.fpval = TMath::Power(1.0 + lTerms.fMu / lTerms.fk, -1);
+    lTerms.fLnGammak = TMath::LnGamma(lTerms.fk);
+    lTerms.fGammak = lTerms.fk <= 100.0 ? TMath::Gamma(lTerms.fk) : 0.0;
+    lTerms.fLogMuOverk = TMath::Log(lTerms.fMu / lTerms.fk);
+    lTerms.fLog1PlusMuOverk = TMath::Log(1.0 + lTerms.fMu / lTerms.fk);
+    lAncestors.push_back(lTerms);
+  }
+
+  //terms depending only on the multiplicity
+  std::vector<Double_t> lMultValues(lNBins), lLnGammaN1(lNBins), lGammaN1(lNBins);
+  for (Int_t iBin = 0; iBin < lNBins; iBin++) {
+    lMultValues[iBin] = fhV0M->GetBinCenter(fCacheFirstBin + iBin);
+    lLnGammaN1[iBin] = TMath::LnGamma(lMultValues[iBin] + 1.);
+    lGammaN1[iBin] = lMultValues[iBin] <= 100.0 ? TMath::Gamma(lMultValues[iBin] + 1.) : 0.0;
+  }
+
+  auto lSumAncestors = [&](size_t lFirst, size_t lLast, std::vector<Double_t>& lSums) {
+    for (Int_t iBin = 0; iBin < lNBins; iBin++) {
+      Double_t lMultValue = lMultValues[iBin];
+      if (lMultValue <= 1e-6)
+        continue;
+      Double_t lProbability = 0.0;
+      for (size_t iAnc = lFirst; iAnc < lLast; iAnc++) {
+        const AncestorTerms& lTerms = lAncestors[iAnc];
+        Double_t lMult = fAncestorMode != 2 ? ROOT::Math::negative_binomial_pdf(static_cast<unsigned int>(lMultValue), lTerms.fpval, lTerms.fk) : ContinuousNBD(lMultValue, lLnGammaN1[iBin], lGammaN1[iBin], lTerms.fk, lTerms.fLnGammak, lTerms.fGammak, lTerms.fLogMuOverk, lTerms.fLog1PlusMuOverk);
+        lProbability += lTerms.fCount * lMult;
+      }
+      lSums[iBin] = lProbability;
+    }
+  };
+
+  Int_t lNThreads = fNThreads > 0 ? fNThreads : TMath::Max(1U, std::thread::hardware_concurrency());
+  lNThreads = TMath::Min(lNThreads, TMath::Max((Int_t)lAncestors.size(), 1));
+  if (lNThreads == 1) {
+    lSumAncestors(0, lAncestors.size(), fCacheValues);
+    return;
+  }
+  //one partial sum per chunk, added in chunk order so that the result does not depend on scheduling
+  std::vector<std::vector<Double_t>> lPartialSums(lNThreads, std::vector<Double_t>(lNBins, 0.0));
+  std::vector<std::thread> lThreads;
+  const size_t lChunk = (lAncestors.size() + lNThreads - 1) / lNThreads;
+  for (Int_t iThread = 0; iThread < lNThreads; iThread++) {
+    size_t lFirst = TMath::Min(iThread * lChunk, lAncestors.size());
+    size_t lLast = TMath::Min(lFirst + lChunk, lAncestors.size());
+    lThreads.emplace_back(lSumAncestors, lFirst, lLast, std::ref(lPartialSums[iThread]));
+  }
+  for (auto& lThread : lThreads) {
+    lThread.join();
+  }
+  for (Int_t iThread = 0; iThread < lNThreads; iThread++) {
+    for (Int_t iBin = 0; iBin < lNBins; iBin++) {
+      fCacheValues[iBin] += lPartialSums[iThread][iBin];
+    }
+  }
+}
+
+//________________________________________________________________
+Double_t multGlauberNBDFitter::ContinuousNBD(Double_t n, Double_t lnGammaN1, Double_t gammaN1, Double_t k, Double_t lnGammak, Double_t gammak, Double_t logMuOverk, Double_t log1PlusMuOverk)
+{
+  //Same as ContinuousNBD(n, mu, k), with LnGamma(n+1), Gamma(n+1), LnGamma(k), Gamma(k),
+  //Log(mu/k) and Log(1+mu/k) provided by the caller
+  Double_t F;
+  Double_t f;
+
+  if (n + k > 100.0) {
+    // log method for handling large numbers
+    F = TMath::LnGamma(n + k) - lnGammaN1 - lnGammak;
+    f = n * logMuOverk - (n + k) * log1PlusMuOverk;
+    F = F + f;
+    F = TMath::Exp(F);
+  } else {
+    F = TMath::Gamma(n + k) / (gammaN1 * gammak);
+    f = n * logMuOverk - (n + k) * log1PlusMuOverk;
+    f = TMath::Exp(f);
+    F *= f;
+  }
+  return F;
+}
+
 //________________________________________________________________
 Double_t multGlauberNBDFitter::ContinuousNBD(Double_t n, Double_t mu, Double_t k)
 {
@@ -13,6 +13,7 @@
 #define MULTGLAUBERNBDFITTER_H
 
 #include <iostream>
+#include <vector>
 #include "TNamed.h"
 #include "TF1.h"
 #include "TH1.h"
@@ -38,6 +39,17 @@ class multGlauberNBDFitter : public TNamed
   //Do Fit: where everything happens
   Bool_t DoFit();
 
+  //Batch mode: fit several configurations (anchor points, periods) concurrently
+  //Each fitter has to be fully configured beforehand
+  static std::vector<Bool_t> DoFits(const std::vector<multGlauberNBDFitter*>& lFitters, Int_t lNThreads = 0);
+
+  //Number of threads to evaluate the fit function, partitioning over ancestor bins
+  void SetNThreads(Int_t lNThreads) { fNThreads = lNThreads; }
+  Int_t GetNThreads() { return fNThreads; }
+
+  //Evaluate the fit function for all input bins at once when parameters change
+  void SetUseEvaluationCache(Bool_t lOpt = kTRUE) { fUseCache = lOpt; }
+
   //Set input characteristics: the 2D plot with Npart, Nanc
   Bool_t SetNpartNcollCorrelation(TH2* hNpNc);
 
@@ -74,6 +86,8 @@ class multGlauberNBDFitter : public TNamed
 
   //For ancestor mode 2
   Double_t ContinuousNBD(Double_t n, Double_t mu, Double_t k);
+  //Same as above, with the terms depending only on mu and k precomputed
+  static Double_t ContinuousNBD(Double_t n, Double_t lnGammaN1, Double_t gammaN1, Double_t k, Double_t lnGammak, Double_t gammak, Double_t logMuOverk, Double_t log1PlusMuOverk);
 
   //For estimating Npart, Ncoll in multiplicity bins
   void CalculateAvNpNc(TProfile* lNPartProf, TProfile* lNCollProf);
@@ -115,6 +129,16 @@ class multGlauberNBDFitter : public TNamed
   TString fFitOptions;
   Long_t fFitNpx;
 
+  //Cached evaluation of the fit function for all the bins of the input histogram
+  void FillEvaluationCache(Double_t* par);
+
+  Int_t fNThreads = 1;                //! threads used in the evaluation of the fit function
+  Bool_t fUseCache = kTRUE;           //! use the cached evaluation
+  std::vector<Double_t> fCachePars;   //! parameters (mu, k, f) of the cached evaluation
+  std::vector<Double_t> fCacheValues; //! cached sum over ancestors, per bin of the input histogram
+  Int_t fCacheFirstBin = 0;           //! first input bin in the cache
+  Int_t fCacheLastBin = -1;           //! last input bin in the cache
+
   ClassDef(multGlauberNBDFitter, 1);
 };
 #endif
@@ -33,6 +33,10 @@
 #include "TEfficiency.h"
 #include "THashList.h"
 
+#include <array>
+#include <type_traits>
+#include <utility>
+
 using namespace o2::framework;
 
 struct QaEfficiency {
@@ -934,6 +938,12 @@ struct QaEfficiency {
       LOG(info) << "Making limits from " << min << ", " << max << " size " << a.getNbins();
     };
 
+    const std::array<bool, nSpecies> doSpecies = {doEl, doMu, doPi, doKa, doPr, doDe, doTr, doHe, doAl};
+    for (int i = 0; i < nSpecies; i++) {
+      doHistograms[i] = doSpecies[i] && doPositivePDG;
+      doHistograms[i + nSpecies] = doSpecies[i] && doNegativePDG;
+    }
+
     doLimits(ptMin, ptMax, ptBins);
     doLimits(etaMin, etaMax, etaBins);
     doLimits(phiMin, phiMax, phiBins);
@@ -967,38 +977,87 @@ struct QaEfficiency {
     }
   }
 
-  template <int pdgSign, o2::track::PID::ID id, typename particleType>
-  bool isPdgSelected(const particleType& mcParticle)
+  // Category of a MC particle, computed once per particle: index of the histograms of its species in the
+  // lowest bits (nHistograms if the species is not studied) and its origin in the highest ones
+  enum ParticleOrigin : uint8_t { kPrimary = 0,
+                                  kFromDecay,
+                                  kFromMaterial };
+  static constexpr uint8_t categoryIndexMask = 0x1F;
+  static constexpr int categoryOriginShift = 5;
+  std::array<bool, nHistograms> doHistograms{}; // Histograms enabled for each species and PDG sign
+
+  template <typename particleType>
+  uint8_t particleCategory(const particleType& mcParticle)
   {
-    static_assert(pdgSign == 0 || pdgSign == 1);
-    static_assert(id > 0 || id < nSpecies);
+    const int pdgCode = mcParticle.pdgCode();
+    int histogramIndex = nHistograms;
+    for (int i = 0; i < nSpecies; i++) {
+      if (pdgCode == PDGs[i]) {
+        histogramIndex = i;
+        break;
+      }
+      if (pdgCode == -PDGs[i]) {
+        histogramIndex = i + nSpecies;
+        break;
+      }
+    }
+    if (histogramIndex == nHistograms || !doHistograms[histogramIndex]) {
+      return nHistograms;
+    }
 
-    // Selecting a specific PDG
-    if constexpr (pdgSign == 0) {
-      return mcParticle.pdgCode() == PDGs[id];
-    } else {
-      return mcParticle.pdgCode() == -PDGs[id];
+    bool isPhysicalPrimary = mcParticle.isPhysicalPrimary();
+    if (maxProdRadius < 999.f) {
+      if ((mcParticle.vx() * mcParticle.vx() + mcParticle.vy() * mcParticle.vy()) > maxProdRadius * maxProdRadius) {
+        isPhysicalPrimary = false;
+      }
     }
+    const uint8_t origin = isPhysicalPrimary ? kPrimary : (mcParticle.getProcess() == 4 ? kFromDecay : kFromMaterial); // 4: particle decay
+    return static_cast<uint8_t>(histogramIndex | origin << categoryOriginShift);
   }
+  static int categoryIndex(const uint8_t category) { return category & categoryIndexMask; }
+  static ParticleOrigin categoryOrigin(const uint8_t category) { return static_cast<ParticleOrigin>(category >> categoryOriginShift); }
 
-  template <int pdgSign, o2::track::PID::ID id, typename trackType>
-  void fillMCTrackHistograms(const trackType& track, const bool doMakeHistograms)
+  // Dispatch tables of the histogram filling of each species and PDG sign, indexed as the histograms
+  template <typename trackType, typename particleType, std::size_t... I>
+  static constexpr auto makeMCTrackFillers(std::index_sequence<I...>)
   {
-    static_assert(pdgSign == 0 || pdgSign == 1);
-    if (!doMakeHistograms) {
+    return std::array{&QaEfficiency::fillMCTrackHistograms<I / nSpecies, static_cast<o2::track::PID::ID>(I % nSpecies), trackType, particleType>...};
+  }
+  template <typename particleType, std::size_t... I>
+  static constexpr auto makeMCParticleFillers(std::index_sequence<I...>)
+  {
+    return std::array{&QaEfficiency::fillMCParticleHistograms<I / nSpecies, static_cast<o2::track::PID::ID>(I % nSpecies), particleType>...};
+  }
+
+  // Fills the histograms of the species of the particle matched to the track, if studied
+  template <typename trackType>
+  void dispatchMCTrackHistograms(const trackType& track)
+  {
+    const auto mcParticle = track.mcParticle();
+    const auto category = particleCategory(mcParticle);
+    if (categoryIndex(category) == nHistograms) {
       return;
     }
+    static constexpr auto fillers = makeMCTrackFillers<trackType, std::decay_t<decltype(mcParticle)>>(std::make_index_sequence<nHistograms>{});
+    (this->*fillers[categoryIndex(category)])(track, mcParticle, categoryOrigin(category));
+  }
 
-    if constexpr (pdgSign == 0) {
-      if (!doPositivePDG) {
-        return;
-      }
-    } else {
-      if (!doNegativePDG) {
-        return;
-      }
+  // Fills the histograms of the species of the particle, if studied
+  template <typename particleType>
+  void dispatchMCParticleHistograms(const particleType& mcParticle)
+  {
+    const auto category = particleCategory(mcParticle);
+    if (categoryIndex(category) == nHistograms) {
+      return;
     }
+    static constexpr auto fillers = makeMCParticleFillers<particleType>(std::make_index_sequence<nHistograms>{});
+    (this->*fillers[categoryIndex(category)])(mcParticle, categoryOrigin(category));
+  }
 
+  template <int pdgSign, o2::track::PID::ID id, typename trackType, typename particleType>
+  void fillMCTrackHistograms(const trackType& track, const particleType& mcParticle, const ParticleOrigin origin)
+  {
+    static_assert(pdgSign == 0 || pdgSign == 1);
     HistogramRegistry* h = &histosPosPdg;
     if constexpr (pdgSign == 1) {
       h = &histosNegPdg;
@@ -1006,11 +1065,6 @@ struct QaEfficiency {
 
     constexpr int histogramIndex = id + pdgSign * nSpecies;
     LOG(debug) << "fillMCTrackHistograms for pdgSign '" << pdgSign << "' and id '" << static_cast<int>(id) << "' " << particleName(pdgSign, id) << " with index " << histogramIndex;
-    const auto mcParticle = track.mcParticle();
-
-    if (!isPdgSelected<pdgSign, id>(mcParticle)) { // Selecting PDG code
-      return;
-    }
 
     histos.fill(HIST("MC/trackSelection"), 19 + id);
 
@@ -1060,14 +1114,7 @@ struct QaEfficiency {
       h->fill(HIST(hPtItsTpcTrdTof[histogramIndex]), mcParticle.p());
     }
 
-    bool isPhysicalPrimary = mcParticle.isPhysicalPrimary();
-    if (maxProdRadius < 999.f) {
-      if ((mcParticle.vx() * mcParticle.vx() + mcParticle.vy() * mcParticle.vy()) > maxProdRadius * maxProdRadius) {
-        isPhysicalPrimary = false;
-      }
-    }
-
-    if (isPhysicalPrimary) {
+    if (origin == kPrimary) {
       if (passedITS) {
         h->fill(HIST(hPtItsPrm[histogramIndex]), mcParticle.pt());
       }
@@ -1084,7 +1131,7 @@ struct QaEfficiency {
           h->fill(HIST(hPhiItsTpcTofPrm[histogramIndex]), mcParticle.phi());
         }
       }
-    } else if (mcParticle.getProcess() == 4) { // Particle decay
+    } else if (origin == kFromDecay) { // Particle decay
       if (passedITS && passedTPC) {
         h->fill(HIST(hPtItsTpcStr[histogramIndex]), mcParticle.pt());
         h->fill(HIST(hPtTrkItsTpcStr[histogramIndex]), track.pt());
@@ -1104,23 +1151,9 @@ struct QaEfficiency {
   }
 
   template <int pdgSign, o2::track::PID::ID id, typename particleType>
-  void fillMCParticleHistograms(const particleType& mcParticle, const bool doMakeHistograms)
+  void fillMCParticleHistograms(const particleType& mcParticle, const ParticleOrigin origin)
   {
     static_assert(pdgSign == 0 || pdgSign == 1);
-    if (!doMakeHistograms) {
-      return;
-    }
-
-    if constexpr (pdgSign == 0) {
-      if (!doPositivePDG) {
-        return;
-      }
-    } else {
-      if (!doNegativePDG) {
-        return;
-      }
-    }
-
     HistogramRegistry* h = &histosPosPdg;
     if (pdgSign == 1) {
       h = &histosNegPdg;
@@ -1128,27 +1161,17 @@ struct QaEfficiency {
 
     constexpr int histogramIndex = id + pdgSign * nSpecies;
     LOG(debug) << "fillMCParticleHistograms for pdgSign '" << pdgSign << "' and id '" << static_cast<int>(id) << "' " << particleName(pdgSign, id) << " with index " << histogramIndex;
-    if (!isPdgSelected<pdgSign, id>(mcParticle)) { // Selecting PDG code
-      return;
-    }
     histos.fill(HIST("MC/particleSelection"), 6 + id);
 
     h->fill(HIST(hPGenerated[histogramIndex]), mcParticle.p());
     h->fill(HIST(hPtGenerated[histogramIndex]), mcParticle.pt());
 
-    bool isPhysicalPrimary = mcParticle.isPhysicalPrimary();
-    if (maxProdRadius < 999.f) {
-      if ((mcParticle.vx() * mcParticle.vx() + mcParticle.vy() * mcParticle.vy()) > maxProdRadius * maxProdRadius) {
-        isPhysicalPrimary = false;
-      }
-    }
-
-    if (isPhysicalPrimary) {
+    if (origin == kPrimary) {
       h->fill(HIST(hPtGeneratedPrm[histogramIndex]), mcParticle.pt());
       h->fill(HIST(hEtaGeneratedPrm[histogramIndex]), mcParticle.eta());
       h->fill(HIST(hPhiGeneratedPrm[histogramIndex]), mcParticle.phi());
     } else {
-      if (mcParticle.getProcess() == 4) { // Particle deday
+      if (origin == kFromDecay) { // Particle deday
         h->fill(HIST(hPtGeneratedStr[histogramIndex]), mcParticle.pt());
       } else { // Material
         h->fill(HIST(hPtGeneratedMat[histogramIndex]), mcParticle.pt());
@@ -1496,17 +1519,7 @@ struct QaEfficiency {
         }
         // Filling variable histograms
         histos.fill(HIST("MC/trackLength"), track.length());
-        static_for<0, 1>([&](auto pdgSign) {
-          fillMCTrackHistograms<pdgSign, o2::track::PID::Electron>(track, doEl);
-          fillMCTrackHistograms<pdgSign, o2::track::PID::Muon>(track, doMu);
-          fillMCTrackHistograms<pdgSign, o2::track::PID::Pion>(track, doPi);
-          fillMCTrackHistograms<pdgSign, o2::track::PID::Kaon>(track, doKa);
-          fillMCTrackHistograms<pdgSign, o2::track::PID::Proton>(track, doPr);
-          fillMCTrackHistograms<pdgSign, o2::track::PID::Deuteron>(track, doDe);
-          fillMCTrackHistograms<pdgSign, o2::track::PID::Triton>(track, doTr);
-          fillMCTrackHistograms<pdgSign, o2::track::PID::Helium3>(track, doHe);
-          fillMCTrackHistograms<pdgSign, o2::track::PID::Alpha>(track, doAl);
-        });
+        dispatchMCTrackHistograms(track);
       }
     }
 
@@ -1520,17 +1533,7 @@ struct QaEfficiency {
         continue;
       }
 
-      static_for<0, 1>([&](auto pdgSign) {
-        fillMCParticleHistograms<pdgSign, o2::track::PID::Electron>(mcParticle, doEl);
-        fillMCParticleHistograms<pdgSign, o2::track::PID::Muon>(mcParticle, doMu);
-        fillMCParticleHistograms<pdgSign, o2::track::PID::Pion>(mcParticle, doPi);
-        fillMCParticleHistograms<pdgSign, o2::track::PID::Kaon>(mcParticle, doKa);
-        fillMCParticleHistograms<pdgSign, o2::track::PID::Proton>(mcParticle, doPr);
-        fillMCParticleHistograms<pdgSign, o2::track::PID::Deuteron>(mcParticle, doDe);
-        fillMCParticleHistograms<pdgSign, o2::track::PID::Triton>(mcParticle, doTr);
-        fillMCParticleHistograms<pdgSign, o2::track::PID::Helium3>(mcParticle, doHe);
-        fillMCParticleHistograms<pdgSign, o2::track::PID::Alpha>(mcParticle, doAl);
-      });
+      dispatchMCParticleHistograms(mcParticle);
     }
     histos.fill(HIST("MC/eventMultiplicity"), dNdEta * 0.5f / 2.f);
 
@@ -1560,17 +1563,7 @@ struct QaEfficiency {
       }
       // Filling variable histograms
       histos.fill(HIST("MC/trackLength"), track.length());
-      static_for<0, 1>([&](auto pdgSign) {
-        fillMCTrackHistograms<pdgSign, o2::track::PID::Electron>(track, doEl);
-        fillMCTrackHistograms<pdgSign, o2::track::PID::Muon>(track, doMu);
-        fillMCTrackHistograms<pdgSign, o2::track::PID::Pion>(track, doPi);
-        fillMCTrackHistograms<pdgSign, o2::track::PID::Kaon>(track, doKa);
-        fillMCTrackHistograms<pdgSign, o2::track::PID::Proton>(track, doPr);
-        fillMCTrackHistograms<pdgSign, o2::track::PID::Deuteron>(track, doDe);
-        fillMCTrackHistograms<pdgSign, o2::track::PID::Triton>(track, doTr);
-        fillMCTrackHistograms<pdgSign, o2::track::PID::Helium3>(track, doHe);
-        fillMCTrackHistograms<pdgSign, o2::track::PID::Alpha>(track, doAl);
-      });
+      dispatchMCTrackHistograms(track);
     }
 
     for (const auto& mcParticle : mcParticles) {
@@ -1578,17 +1571,7 @@ struct QaEfficiency {
         continue;
       }
 
-      static_for<0, 1>([&](auto pdgSign) {
-        fillMCParticleHistograms<pdgSign, o2::track::PID::Electron>(mcParticle, doEl);
-        fillMCParticleHistograms<pdgSign, o2::track::PID::Muon>(mcParticle, doMu);
-        fillMCParticleHistograms<pdgSign, o2::track::PID::Pion>(mcParticle, doPi);
-        fillMCParticleHistograms<pdgSign, o2::track::PID::Kaon>(mcParticle, doKa);
-        fillMCParticleHistograms<pdgSign, o2::track::PID::Proton>(mcParticle, doPr);
-        fillMCParticleHistograms<pdgSign, o2::track::PID::Deuteron>(mcParticle, doDe);
-        fillMCParticleHistograms<pdgSign, o2::track::PID::Triton>(mcParticle, doTr);
-        fillMCParticleHistograms<pdgSign, o2::track::PID::Helium3>(mcParticle, doHe);
-        fillMCParticleHistograms<pdgSign, o2::track::PID::Alpha>(mcParticle, doAl);
-      });
+      dispatchMCParticleHistograms(mcParticle);
     }
 
     // Fill TEfficiencies
@@ -34,6 +34,8 @@
 #include "Common/Core/TrackSelectionDefaults.h"
 #include "Common/TableProducer/PID/pidTOFBase.h"
 
+#include "array"
+#include "memory"
 #include "string"
 #include "vector"
 
@@ -75,6 +77,11 @@ struct qaEventTrack {
   // options to check the track variables only for PV contributors
   Configurable<bool> checkOnlyPVContributor{"checkOnlyPVContributor", false, "check the track variables only for primary vertex contributors"};
 
+  // deterministic sampling of the tracks for the expensive correlation histograms, which are not rescaled
+  Configurable<float> fractionTrackCorrelations{"fractionTrackCorrelations", 1.f, "fraction of the tracks used for the 2D/3D track histograms (kinematics, DCA, TPC clusters)"};
+  Configurable<float> fractionIUCorrelations{"fractionIUCorrelations", 1.f, "fraction of the tracks used for the IU vs DCA and IU TPC cluster histograms"};
+  Configurable<float> fractionIUFilteredCorrelations{"fractionIUFilteredCorrelations", 1.f, "fraction of the tracks used for the filtered IU vs DCA histograms"};
+
   // configurable binning of histograms
   ConfigurableAxis binsPt{"binsPt", {VARIABLE_WIDTH, 0.0, 0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 1.0, 1.1, 1.2, 1.3, 1.4, 1.5, 2.0, 5.0, 10.0, 20.0, 50.0}, ""};
   ConfigurableAxis binsDeltaPt{"binsDeltaPt", {100, -0.495, 0.505}, ""};
@@ -114,6 +121,36 @@ struct qaEventTrack {
 
   HistogramRegistry histos;
 
+  // intervals of the TPC cluster maps of the IU tracks, filled through the histogram pointers
+  static constexpr int nPtCuts = 15;
+  static constexpr float ptCutMin[nPtCuts] = {0., .2, 0., .3, .4, .3, .5, .6, .5, .8, 1., 2., 3., 6., 10.};
+  static constexpr float ptCutMax[nPtCuts] = {.2, .3, .3, .4, .5, .5, .6, .8, .8, 1., 2., 3., 6., 10., 15.};
+  static constexpr int nNContribCuts = 5;
+  static constexpr float nContribCutEdges[nNContribCuts + 1] = {0., 20., 60., 100., 150., 200.};
+  static constexpr int nPhiCuts = 8;
+  static constexpr const char* phiCutLabels[nPhiCuts] = {"#pi,5#pi/4", "5#pi/4,3#pi/2", "3#pi/2,7#pi/4", "7#pi/4,2#pi", "0,#pi/4", "#pi/4,#pi/2", "#pi/2,3#pi/4", "3#pi/4,#pi"};
+  static constexpr int nPtResoCuts = 9;
+  static constexpr float ptResoCutEdges[nPtResoCuts + 1] = {.01, .02, .03, .04, .05, .06, .07, .08, .09, .1};
+  std::array<std::shared_ptr<TH2>, nPtCuts> hTPCNClsFoundVsEtaPtCut;
+  std::array<std::shared_ptr<TH2>, nPtCuts> hTPCNClsFoundVsEtaPtCutPositive;
+  std::array<std::shared_ptr<TH2>, nPtCuts> hTPCNClsFoundVsEtaPtCutNegative;
+  std::array<std::shared_ptr<TH2>, nNContribCuts> hTPCNClsFoundVsEtaNContribCut;
+  std::array<std::shared_ptr<TH2>, nPhiCuts> hTPCNClsFoundVsEtaPhiCut; // in the order of the labels, from phi = pi
+  std::array<std::shared_ptr<TH2>, nPtResoCuts> hTPCNClsFoundVsEtaPtResoCut;
+
+  /// Deterministic selection of a fraction of the tracks from their index, the same in every job and rerun
+  static bool isSampled(int64_t globalIndex, float fraction)
+  {
+    if (fraction >= 1.f) {
+      return true;
+    }
+    uint64_t x = static_cast<uint64_t>(globalIndex) + 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return static_cast<float>(x >> 40) * (1.f / (1 << 24)) < fraction;
+  }
+
   Preslice<aod::McParticles> perMcCollision = aod::mcparticle::mcCollisionId;
   Preslice<aod::Tracks> perRecoCollision = aod::track::collisionId;
 
@@ -390,78 +427,22 @@ struct qaEventTrack {
 
       histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPt", "tracks with at least 1 TPC cluster; #eta; #it{p}_{T}^{IU}; # clusters TPC", kTH3D, {axisEta, axisPt, {165, -0.5, 164.5}});
 
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut1", "tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (0.0,0.2) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut2", "tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (0.2,0.3) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut3", "tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (0.0,0.3) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut4", "tracks with at least 1 TPC cluster,#it{p}_{T}^{IU} #in (0.3,0.4) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut5", "tracks with at least 1 TPC cluster,#it{p}_{T}^{IU} #in (0.4,0.5) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut6", "tracks with at least 1 TPC cluster,#it{p}_{T}^{IU} #in (0.3,0.5) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut7", "tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (0.5,0.6) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut8", "tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (0.6,0.8) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut9", "tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (0.5,0.8) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut10", "tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (0.8,1) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut11", "tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (1,2) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut12", "tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (2,3) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut13", "tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (3,6) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut14", "tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (6,10) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut15", "tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (10,15) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut1Postive", "positive charged tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (0.0,0.2) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut2Postive", "positive charged tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (0.2,0.3) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut3Postive", "positive charged tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (0.0,0.3) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut4Postive", "positive charged tracks with at least 1 TPC cluster,#it{p}_{T}^{IU} #in (0.3,0.4) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut5Postive", "positive charged tracks with at least 1 TPC cluster,#it{p}_{T}^{IU} #in (0.4,0.5) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut6Postive", "positive charged tracks with at least 1 TPC cluster,#it{p}_{T}^{IU} #in (0.3,0.5) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut7Postive", "positive charged tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (0.5,0.6) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut8Postive", "positive charged tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (0.6,0.8) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut9Postive", "positive charged tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (0.5,0.8) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut10Postive", "positive charged tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (0.8,1) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut11Postive", "positive charged tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (1,2) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut12Postive", "positive charged tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (2,3) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut13Postive", "positive charged tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (3,6) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut14Postive", "positive charged tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (6,10) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut15Postive", "positive charged tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (10,15) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut1Negative", "negative charged tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (0.0,0.2) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut2Negative", "negative charged tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (0.2,0.3) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut3Negative", "negative charged tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (0.0,0.3) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut4Negative", "negative charged tracks with at least 1 TPC cluster,#it{p}_{T}^{IU} #in (0.3,0.4) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut5Negative", "negative charged tracks with at least 1 TPC cluster,#it{p}_{T}^{IU} #in (0.4,0.5) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut6Negative", "negative charged tracks with at least 1 TPC cluster,#it{p}_{T}^{IU} #in (0.3,0.5) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut7Negative", "negative charged tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (0.5,0.6) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut8Negative", "negative charged tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (0.6,0.8) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut9Negative", "negative charged tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (0.5,0.8) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut10Negative", "negative charged tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (0.8,1) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut11Negative", "negative charged tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (1,2) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut12Negative", "negative charged tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (2,3) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut13Negative", "negative charged tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (3,6) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut14Negative", "negative charged tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (6,10) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut15Negative", "negative charged tracks with at least 1 TPC cluster, #it{p}_{T}^{IU} #in (10,15) GeV/#it{c}; #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaVsNcontribCut1", "tracks with at least 1 TPC cluster, nContrib #in (0,20); #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaVsNcontribCut2", "tracks with at least 1 TPC cluster, nContrib #in (20,60); #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaVsNcontribCut3", "tracks with at least 1 TPC cluster, nContrib #in (60,100); #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaVsNcontribCut4", "tracks with at least 1 TPC cluster, nContrib #in (100,150); #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaVsNcontribCut5", "tracks with at least 1 TPC cluster, nContrib #in (150,200); #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPhiCut1", "tracks with at least 1 TPC cluster, #phi #in (#pi,5#pi/4); #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPhiCut2", "tracks with at least 1 TPC cluster, #phi #in (5#pi/4,3#pi/2); #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPhiCut3", "tracks with at least 1 TPC cluster, #phi #in (3#pi/2,7#pi/4); #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPhiCut4", "tracks with at least 1 TPC cluster, #phi #in (7#pi/4,2#pi); #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPhiCut5", "tracks with at least 1 TPC cluster, #phi #in (0,#pi/4); #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPhiCut6", "tracks with at least 1 TPC cluster, #phi #in (#pi/4,#pi/2); #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPhiCut7", "tracks with at least 1 TPC cluster, #phi #in (#pi/2,3#pi/4); #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPhiCut8", "tracks with at least 1 TPC cluster, #phi #in (3#pi/4,#pi); #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPtResoCut1", "tracks with at least 1 TPC cluster, #sigma (#it{p}_{T}^{IU})/#it{p}_{T}^{IU} #in (0.01,0.02); #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPtResoCut2", "tracks with at least 1 TPC cluster, #sigma (#it{p}_{T}^{IU})/#it{p}_{T}^{IU} #in (0.02,0.03); #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPtResoCut3", "tracks with at least 1 TPC cluster, #sigma (#it{p}_{T}^{IU})/#it{p}_{T}^{IU} #in (0.03,0.04); #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPtResoCut4", "tracks with at least 1 TPC cluster, #sigma (#it{p}_{T}^{IU})/#it{p}_{T}^{IU} #in (0.04,0.05); #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPtResoCut5", "tracks with at least 1 TPC cluster, #sigma (#it{p}_{T}^{IU})/#it{p}_{T}^{IU} #in (0.05,0.06); #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPtResoCut6", "tracks with at least 1 TPC cluster, #sigma (#it{p}_{T}^{IU})/#it{p}_{T}^{IU} #in (0.06,0.07); #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPtResoCut7", "tracks with at least 1 TPC cluster, #sigma (#it{p}_{T}^{IU})/#it{p}_{T}^{IU} #in (0.07,0.08); #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPtResoCut8", "tracks with at least 1 TPC cluster, #sigma (#it{p}_{T}^{IU})/#it{p}_{T}^{IU} #in (0.08,0.09); #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
-      histos.add("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPtResoCut9", "tracks with at least 1 TPC cluster, #sigma (#it{p}_{T}^{IU})/#it{p}_{T}^{IU} #in (0.09,0.1); #eta; # clusters TPC", kTH2D, {axisEta, {165, -0.5, 164.5}});
+      const AxisSpec axisTPCNClsFound{165, -0.5, 164.5};
+      for (int i = 0; i < nPtCuts; i++) {
+        const std::string ptRange = Form("#it{p}_{T}^{IU} #in (%g,%g) GeV/#it{c}; #eta; # clusters TPC", ptCutMin[i], ptCutMax[i]);
+        hTPCNClsFoundVsEtaPtCut[i] = histos.add<TH2>(Form("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut%d", i + 1), Form("tracks with at least 1 TPC cluster, %s", ptRange.data()), kTH2D, {axisEta, axisTPCNClsFound});
+        hTPCNClsFoundVsEtaPtCutPositive[i] = histos.add<TH2>(Form("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut%dPostive", i + 1), Form("positive charged tracks with at least 1 TPC cluster, %s", ptRange.data()), kTH2D, {axisEta, axisTPCNClsFound});
+        hTPCNClsFoundVsEtaPtCutNegative[i] = histos.add<TH2>(Form("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut%dNegative", i + 1), Form("negative charged tracks with at least 1 TPC cluster, %s", ptRange.data()), kTH2D, {axisEta, axisTPCNClsFound});
+      }
+      for (int i = 0; i < nNContribCuts; i++) {
+        hTPCNClsFoundVsEtaNContribCut[i] = histos.add<TH2>(Form("Tracks/IU/TPC/tpcNClsFoundVsEtaVsNcontribCut%d", i + 1), Form("tracks with at least 1 TPC cluster, nContrib #in (%g,%g); #eta; # clusters TPC", nContribCutEdges[i], nContribCutEdges[i + 1]), kTH2D, {axisEta, axisTPCNClsFound});
+      }
+      for (int i = 0; i < nPhiCuts; i++) {
+        hTPCNClsFoundVsEtaPhiCut[i] = histos.add<TH2>(Form("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPhiCut%d", i + 1), Form("tracks with at least 1 TPC cluster, #phi #in (%s); #eta; # clusters TPC", phiCutLabels[i]), kTH2D, {axisEta, axisTPCNClsFound});
+      }
+      for (int i = 0; i < nPtResoCuts; i++) {
+        hTPCNClsFoundVsEtaPtResoCut[i] = histos.add<TH2>(Form("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPtResoCut%d", i + 1), Form("tracks with at least 1 TPC cluster, #sigma (#it{p}_{T}^{IU})/#it{p}_{T}^{IU} #in (%g,%g); #eta; # clusters TPC", ptResoCutEdges[i], ptResoCutEdges[i + 1]), kTH2D, {axisEta, axisTPCNClsFound});
+      }
     }
 
     // filtered tracks @ IU
@@ -675,6 +656,9 @@ struct qaEventTrack {
       histos.fill(HIST("Tracks/IU/snp"), trkIU.snp());
       histos.fill(HIST("Tracks/IU/tgl"), trkIU.tgl());
 
+      if (!isSampled(trkIU.globalIndex(), fractionIUCorrelations)) {
+        continue;
+      }
       histos.fill(HIST("Tracks/IU/deltaDCA/Pt"), trk.pt(), trkIU.pt() - trk.pt());
       histos.fill(HIST("Tracks/IU/deltaDCA/Eta"), trk.eta(), trkIU.eta() - trk.eta());
       histos.fill(HIST("Tracks/IU/deltaDCA/Phi"), trk.phi(), trkIU.phi() - trk.phi());
@@ -688,159 +672,35 @@ struct qaEventTrack {
         histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEta"), trkIU.eta(), nClstTPC);
         histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPt"), trkIU.eta(), trkIU.pt(), nClstTPC);
 
-        if (trkIU.pt() > 0. && trkIU.pt() <= .2) {
-          if (trkIU.sign() > 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut1Postive"), trkIU.eta(), trkIU.tpcNClsFound());
-          else if (trkIU.sign() < 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut1Negative"), trkIU.eta(), trkIU.tpcNClsFound());
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut1"), trkIU.eta(), trkIU.tpcNClsFound());
-        }
-        if (trkIU.pt() > .2 && trkIU.pt() <= .3) {
-          if (trkIU.sign() > 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut2Postive"), trkIU.eta(), trkIU.tpcNClsFound());
-          else if (trkIU.sign() < 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut2Negative"), trkIU.eta(), trkIU.tpcNClsFound());
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut2"), trkIU.eta(), trkIU.tpcNClsFound());
-        }
-        if (trkIU.pt() > 0. && trkIU.pt() <= .3) {
-          if (trkIU.sign() > 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut3Postive"), trkIU.eta(), trkIU.tpcNClsFound());
-          else if (trkIU.sign() < 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut3Negative"), trkIU.eta(), trkIU.tpcNClsFound());
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut3"), trkIU.eta(), trkIU.tpcNClsFound());
-        }
-        if (trkIU.pt() > .3 && trkIU.pt() <= .4) {
-          if (trkIU.sign() > 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut4Postive"), trkIU.eta(), trkIU.tpcNClsFound());
-          else if (trkIU.sign() < 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut4Negative"), trkIU.eta(), trkIU.tpcNClsFound());
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut4"), trkIU.eta(), trkIU.tpcNClsFound());
-        }
-        if (trkIU.pt() > .4 && trkIU.pt() <= .5) {
-          if (trkIU.sign() > 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut5Postive"), trkIU.eta(), trkIU.tpcNClsFound());
-          else if (trkIU.sign() < 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut5Negative"), trkIU.eta(), trkIU.tpcNClsFound());
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut5"), trkIU.eta(), trkIU.tpcNClsFound());
-        }
-        if (trkIU.pt() > .3 && trkIU.pt() <= .5) {
-          if (trkIU.sign() > 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut6Postive"), trkIU.eta(), trkIU.tpcNClsFound());
-          else if (trkIU.sign() < 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut6Negative"), trkIU.eta(), trkIU.tpcNClsFound());
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut6"), trkIU.eta(), trkIU.tpcNClsFound());
-        }
-        if (trkIU.pt() > .5 && trkIU.pt() <= .6) {
-          if (trkIU.sign() > 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut7Postive"), trkIU.eta(), trkIU.tpcNClsFound());
-          else if (trkIU.sign() < 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut7Negative"), trkIU.eta(), trkIU.tpcNClsFound());
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut7"), trkIU.eta(), trkIU.tpcNClsFound());
-        }
-        if (trkIU.pt() > .6 && trkIU.pt() <= .8) {
-          if (trkIU.sign() > 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut8Postive"), trkIU.eta(), trkIU.tpcNClsFound());
-          else if (trkIU.sign() < 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut8Negative"), trkIU.eta(), trkIU.tpcNClsFound());
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut8"), trkIU.eta(), trkIU.tpcNClsFound());
-        }
-        if (trkIU.pt() > .5 && trkIU.pt() <= .8) {
-          if (trkIU.sign() > 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut9Postive"), trkIU.eta(), trkIU.tpcNClsFound());
-          else if (trkIU.sign() < 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut9Negative"), trkIU.eta(), trkIU.tpcNClsFound());
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut9"), trkIU.eta(), trkIU.tpcNClsFound());
-        }
-        if (trkIU.pt() > .8 && trkIU.pt() <= 1.) {
-          if (trkIU.sign() > 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut10Postive"), trkIU.eta(), trkIU.tpcNClsFound());
-          else if (trkIU.sign() < 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut10Negative"), trkIU.eta(), trkIU.tpcNClsFound());
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut10"), trkIU.eta(), trkIU.tpcNClsFound());
-        }
-        if (trkIU.pt() > 1. && trkIU.pt() <= 2.) {
-          if (trkIU.sign() > 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut11Postive"), trkIU.eta(), trkIU.tpcNClsFound());
-          else if (trkIU.sign() < 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut11Negative"), trkIU.eta(), trkIU.tpcNClsFound());
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut11"), trkIU.eta(), trkIU.tpcNClsFound());
-        }
-        if (trkIU.pt() > 2. && trkIU.pt() <= 3.) {
-          if (trkIU.sign() > 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut12Postive"), trkIU.eta(), trkIU.tpcNClsFound());
-          else if (trkIU.sign() < 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut12Negative"), trkIU.eta(), trkIU.tpcNClsFound());
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut12"), trkIU.eta(), trkIU.tpcNClsFound());
-        }
-        if (trkIU.pt() > 3. && trkIU.pt() <= 6.) {
-          if (trkIU.sign() > 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut13Postive"), trkIU.eta(), trkIU.tpcNClsFound());
-          else if (trkIU.sign() < 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut13Negative"), trkIU.eta(), trkIU.tpcNClsFound());
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut13"), trkIU.eta(), trkIU.tpcNClsFound());
+        const auto eta = trkIU.eta();
+        const auto pt = trkIU.pt();
+        for (int i = 0; i < nPtCuts; i++) {
+          if (pt > ptCutMin[i] && pt <= ptCutMax[i]) {
+            if (trkIU.sign() > 0)
+              hTPCNClsFoundVsEtaPtCutPositive[i]->Fill(eta, nClstTPC);
+            else if (trkIU.sign() < 0)
+              hTPCNClsFoundVsEtaPtCutNegative[i]->Fill(eta, nClstTPC);
+            hTPCNClsFoundVsEtaPtCut[i]->Fill(eta, nClstTPC);
+          }
         }
-        if (trkIU.pt() > 6. && trkIU.pt() <= 10.) {
-          if (trkIU.sign() > 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut14Postive"), trkIU.eta(), trkIU.tpcNClsFound());
-          else if (trkIU.sign() < 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut14Negative"), trkIU.eta(), trkIU.tpcNClsFound());
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut14"), trkIU.eta(), trkIU.tpcNClsFound());
+
+        for (int i = 0; i < nNContribCuts; i++) {
+          if (collision.numContrib() > nContribCutEdges[i] && collision.numContrib() <= nContribCutEdges[i + 1])
+            hTPCNClsFoundVsEtaNContribCut[i]->Fill(eta, nClstTPC);
         }
-        if (trkIU.pt() > 10. && trkIU.pt() <= 15.) {
-          if (trkIU.sign() > 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut15Postive"), trkIU.eta(), trkIU.tpcNClsFound());
-          else if (trkIU.sign() < 0)
-            histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut15Negative"), trkIU.eta(), trkIU.tpcNClsFound());
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaPtcut15"), trkIU.eta(), trkIU.tpcNClsFound());
+
+        // octants of pi/4 from phi = 0, the histograms start from phi = pi
+        const auto phi = trkIU.phi();
+        for (int i = 0; i < nPhiCuts; i++) {
+          if (phi > i * 3.1415 / 4 && phi <= (i + 1) * 3.1415 / 4)
+            hTPCNClsFoundVsEtaPhiCut[(i + nPhiCuts / 2) % nPhiCuts]->Fill(eta, nClstTPC);
         }
 
-        if (collision.numContrib() > 0. && collision.numContrib() <= 20.)
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaVsNcontribCut1"), trkIU.eta(), trkIU.tpcNClsFound());
-        if (collision.numContrib() > 20. && collision.numContrib() <= 60.)
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaVsNcontribCut2"), trkIU.eta(), trkIU.tpcNClsFound());
-        if (collision.numContrib() > 60. && collision.numContrib() <= 100.)
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaVsNcontribCut3"), trkIU.eta(), trkIU.tpcNClsFound());
-        if (collision.numContrib() > 100. && collision.numContrib() <= 150.)
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaVsNcontribCut4"), trkIU.eta(), trkIU.tpcNClsFound());
-        if (collision.numContrib() > 150. && collision.numContrib() <= 200.)
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaVsNcontribCut5"), trkIU.eta(), trkIU.tpcNClsFound());
-
-        if (trkIU.phi() > 0. && trkIU.phi() <= 3.1415 / 4)
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPhiCut5"), trkIU.eta(), trkIU.tpcNClsFound());
-        if (trkIU.phi() > 3.1415 / 4 && trkIU.phi() <= 3.1415 / 2)
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPhiCut6"), trkIU.eta(), trkIU.tpcNClsFound());
-        if (trkIU.phi() > 3.1415 / 2 && trkIU.phi() <= 3 * 3.1415 / 4)
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPhiCut7"), trkIU.eta(), trkIU.tpcNClsFound());
-        if (trkIU.phi() > 3 * 3.1415 / 4 && trkIU.phi() <= 3.1415)
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPhiCut8"), trkIU.eta(), trkIU.tpcNClsFound());
-        if (trkIU.phi() > 3.1415 && trkIU.phi() <= 5 * 3.1415 / 4)
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPhiCut1"), trkIU.eta(), trkIU.tpcNClsFound());
-        if (trkIU.phi() > 5 * 3.1415 / 4 && trkIU.phi() <= 6 * 3.1415 / 4)
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPhiCut2"), trkIU.eta(), trkIU.tpcNClsFound());
-        if (trkIU.phi() > 6 * 3.1415 / 4 && trkIU.phi() <= 7 * 3.1415 / 4)
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPhiCut3"), trkIU.eta(), trkIU.tpcNClsFound());
-        if (trkIU.phi() > 7 * 3.1415 / 4 && trkIU.phi() <= 2 * 3.1415)
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPhiCut4"), trkIU.eta(), trkIU.tpcNClsFound());
-
-        auto trkReso = trkIU.pt() * std::sqrt(trkIU.c1Pt21Pt2());
-        if (trkReso > .01 && trkReso <= .02)
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPtResoCut1"), trkIU.eta(), trkIU.tpcNClsFound());
-        if (trkReso > .02 && trkReso <= .03)
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPtResoCut2"), trkIU.eta(), trkIU.tpcNClsFound());
-        if (trkReso > .03 && trkReso <= .04)
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPtResoCut3"), trkIU.eta(), trkIU.tpcNClsFound());
-        if (trkReso > .04 && trkReso <= .05)
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPtResoCut4"), trkIU.eta(), trkIU.tpcNClsFound());
-        if (trkReso > .05 && trkReso <= .06)
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPtResoCut5"), trkIU.eta(), trkIU.tpcNClsFound());
-        if (trkReso > .06 && trkReso <= .07)
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPtResoCut6"), trkIU.eta(), trkIU.tpcNClsFound());
-        if (trkReso > .07 && trkReso <= .08)
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPtResoCut7"), trkIU.eta(), trkIU.tpcNClsFound());
-        if (trkReso > .08 && trkReso <= .09)
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPtResoCut8"), trkIU.eta(), trkIU.tpcNClsFound());
-        if (trkReso > .09 && trkReso <= .1)
-          histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaVsPtResoCut9"), trkIU.eta(), trkIU.tpcNClsFound());
+        auto trkReso = pt * std::sqrt(trkIU.c1Pt21Pt2());
+        for (int i = 0; i < nPtResoCuts; i++) {
+          if (trkReso > ptResoCutEdges[i] && trkReso <= ptResoCutEdges[i + 1])
+            hTPCNClsFoundVsEtaPtResoCut[i]->Fill(eta, nClstTPC);
+        }
 
         if (nClstTPC > 25) {
           histos.fill(HIST("Tracks/IU/TPC/tpcNClsFoundVsEtaGtr25"), trkIU.eta(), nClstTPC);
@@ -882,6 +742,9 @@ struct qaEventTrack {
       histos.fill(HIST("Tracks/IUFiltered/snp"), trkIU.snp());
       histos.fill(HIST("Tracks/IUFiltered/tgl"), trkIU.tgl());
 
+      if (!isSampled(trkIU.globalIndex(), fractionIUFilteredCorrelations)) {
+        continue;
+      }
       histos.fill(HIST("Tracks/IUFiltered/deltaDCA/Pt"), trkDCA.pt(), trkIU.pt() - trkDCA.pt());
       histos.fill(HIST("Tracks/IUFiltered/deltaDCA/Eta"), trkDCA.eta(), trkIU.eta() - trkDCA.eta());
       histos.fill(HIST("Tracks/IUFiltered/deltaDCA/Phi"), trkDCA.phi(), trkIU.phi() - trkDCA.phi());
@@ -1358,9 +1221,12 @@ void qaEventTrack::fillRecoHistogramsGroupedTracks(const C& collision, const T&
     histos.fill(HIST("Tracks/Kine/pt"), track.pt());
     histos.fill(HIST("Tracks/Kine/eta"), track.eta());
     histos.fill(HIST("Tracks/Kine/phi"), track.phi());
-    histos.fill(HIST("Tracks/Kine/etavsphi"), track.eta(), track.phi());
-    histos.fill(HIST("Tracks/Kine/etavspt"), track.pt(), track.eta());
-    histos.fill(HIST("Tracks/Kine/phivspt"), track.pt(), track.phi());
+    const bool fillCorrelations = isSampled(track.globalIndex(), fractionTrackCorrelations);
+    if (fillCorrelations) {
+      histos.fill(HIST("Tracks/Kine/etavsphi"), track.eta(), track.phi());
+      histos.fill(HIST("Tracks/Kine/etavspt"), track.pt(), track.eta());
+      histos.fill(HIST("Tracks/Kine/phivspt"), track.pt(), track.phi());
+    }
     histos.fill(HIST("Tracks/Kine/relativeResoPt"), track.pt(), track.pt() * std::sqrt(track.c1Pt21Pt2()));
     histos.fill(HIST("Tracks/Kine/relativeResoPtMean"), track.pt(), track.pt() * std::sqrt(track.c1Pt21Pt2()));
     auto eta = track.eta();
@@ -1395,9 +1261,11 @@ void qaEventTrack::fillRecoHistogramsGroupedTracks(const C& collision, const T&
     }
     histos.fill(HIST("Tracks/dcaXY"), track.dcaXY());
     histos.fill(HIST("Tracks/dcaZ"), track.dcaZ());
-    histos.fill(HIST("Tracks/dcaXYvsPt"), track.dcaXY(), track.pt());
-    histos.fill(HIST("Tracks/dcaZvsPt"), track.dcaZ(), track.pt());
-    histos.fill(HIST("Tracks/dcaZvsEta"), track.dcaZ(), track.eta());
+    if (fillCorrelations) {
+      histos.fill(HIST("Tracks/dcaXYvsPt"), track.dcaXY(), track.pt());
+      histos.fill(HIST("Tracks/dcaZvsPt"), track.dcaZ(), track.pt());
+      histos.fill(HIST("Tracks/dcaZvsEta"), track.dcaZ(), track.eta());
+    }
     histos.fill(HIST("Tracks/length"), track.length());
 
     // fill ITS variables
@@ -1423,8 +1291,10 @@ void qaEventTrack::fillRecoHistogramsGroupedTracks(const C& collision, const T&
     // fill TPC variables
     histos.fill(HIST("Tracks/TPC/tpcNClsFindable"), track.tpcNClsFindable());
     histos.fill(HIST("Tracks/TPC/tpcNClsFound"), track.tpcNClsFound());
-    histos.fill(HIST("Tracks/TPC/tpcNClsFoundVsEta"), track.eta(), track.tpcNClsFound());
-    histos.fill(HIST("Tracks/TPC/tpcNClsFoundVsEtaVtxZ"), track.eta(), track.tpcNClsFound(), collision.posZ());
+    if (fillCorrelations) {
+      histos.fill(HIST("Tracks/TPC/tpcNClsFoundVsEta"), track.eta(), track.tpcNClsFound());
+      histos.fill(HIST("Tracks/TPC/tpcNClsFoundVsEtaVtxZ"), track.eta(), track.tpcNClsFound(), collision.posZ());
+    }
     histos.fill(HIST("Tracks/TPC/tpcNClsShared"), track.tpcNClsShared());
     histos.fill(HIST("Tracks/TPC/tpcCrossedRows"), track.tpcNClsCrossedRows());
     histos.fill(HIST("Tracks/TPC/tpcCrossedRowsOverFindableCls"), track.tpcCrossedRowsOverFindableCls());
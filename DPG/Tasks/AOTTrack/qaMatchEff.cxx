@@ -27,6 +27,9 @@
 #include "Framework/AnalysisTask.h"
 #include "Framework/RunningWorkflowInfo.h"
 #include "Framework/runDataProcessing.h"
+//
+#include <memory>
+#include <vector>
 
 //
 // base namespaces
@@ -144,6 +147,9 @@ struct qaMatchEff {
   Configurable<bool> isPIDKaonRequired{"isPIDKaonRequired", false, "choose if apply kaon PID"};
   Configurable<bool> isPIDProtonRequired{"isPIDProtonRequired", false, "choose if apply proton PID"};
   //
+  // compact summary of the matching categories vs pt
+  Configurable<bool> makeSummary{"makeSummary", false, "choose if produce the compact summary of the matching categories vs pt"};
+  //
   //
   // Init function
   //
@@ -157,6 +163,15 @@ struct qaMatchEff {
       initMC();
     else
       initData();
+    //
+    // compact summary: counts accumulated in a fixed array, added to the histogram once per data frame
+    if (makeSummary) {
+      hSummary = histos.add<TH2>("summary/categoryVsPt", "Tracks per matching category;;#it{p}_{T} (GeV/#it{c})", kTH2D, {{nSummaryCategories, -0.5, nSummaryCategories - 0.5}, axisPt});
+      for (int i = 0; i < nSummaryCategories; i++) {
+        hSummary->GetXaxis()->SetBinLabel(i + 1, Form("%s%s%s%s", (i & kTPCTag) ? "TPC" : "", (i & kITSTag) ? "+ITS" : "", (i & kTOFTag) ? "+TOF" : "", (i & kPositive) ? " pos" : " neg"));
+      }
+      summaryCounts.assign(nSummaryCategories * (hSummary->GetYaxis()->GetNbins() + 2), 0);
+    }
 
     if ((!isitMC && (doprocessMC || doprocessMCNoColl || doprocessTrkIUMC)) || (isitMC && (doprocessData && doprocessDataNoColl && doprocessTrkIUMC)))
       LOGF(fatal, "Initialization set for MC and processData function flagged  (or viceversa)! Fix the configuration.");
@@ -906,6 +921,55 @@ struct qaMatchEff {
     return true;
   }
 
+  // matching category of a track, computed once per track
+  enum MatchCategory : uint32_t {
+    kTPCTag = 1 << 0,  // TPC track passing the TPC selections
+    kITSTag = 1 << 1,  // ITS track passing the ITS selections
+    kTOFTag = 1 << 2,  // track with TOF
+    kPositive = 1 << 3,
+    kNegative = 1 << 4,
+    kPt05 = 1 << 5 // pt > 0.5 GeV/c
+  };
+  static constexpr int nSummaryCategories = kPositive << 1; // combinations of the TPC, ITS, TOF and positive bits
+  std::shared_ptr<TH2> hSummary;
+  std::vector<uint64_t> summaryCounts; // counts per summary category and pt bin, underflow and overflow included
+
+  template <typename T>
+  uint32_t matchCategory(T& track, float trackPt)
+  {
+    uint32_t category = 0;
+    if (track.hasTPC() && isTrackSelectedTPCCuts(track))
+      category |= kTPCTag;
+    if (track.hasITS() && isTrackSelectedITSCuts(track))
+      category |= kITSTag;
+    if (track.hasTOF())
+      category |= kTOFTag;
+    if (track.signed1Pt() > 0)
+      category |= kPositive;
+    if (track.signed1Pt() < 0)
+      category |= kNegative;
+    if (trackPt > 0.5)
+      category |= kPt05;
+    return category;
+  }
+
+  /// Adds the counts of the summary to its histogram, and resets them
+  void flushSummary()
+  {
+    const int nPtBins = hSummary->GetYaxis()->GetNbins() + 2;
+    for (int i = 0; i < nSummaryCategories; i++) {
+      for (int ipt = 0; ipt < nPtBins; ipt++) {
+        auto& counts = summaryCounts[i * nPtBins + ipt];
+        if (counts > 0) {
+          const int bin = hSummary->GetBin(i + 1, ipt);
+          hSummary->AddBinContent(bin, counts);
+          hSummary->SetEntries(hSummary->GetEntries() + counts);
+          counts = 0;
+        }
+      }
+    }
+  }
+
   // define global variables
   int count = 0;
   int countData = 0;
@@ -982,6 +1046,13 @@ struct qaMatchEff {
       if (track.signed1Pt() > 0)
         positiveTrack = true;
       //
+      // TPC and ITS selections evaluated once for all the histograms
+      const uint32_t category = matchCategory(track, trackPt);
+      if (makeSummary) {
+        const int nPtBins = hSummary->GetYaxis()->GetNbins() + 2;
+        summaryCounts[(category & (nSummaryCategories - 1)) * nPtBins + hSummary->GetYaxis()->FindFixBin(trackPt)]++;
+      }
+      //
       // PID sigmas
       if constexpr (!IS_MC) {
         tpcNSigmaPion = track.tpcNSigmaPi();
@@ -1070,7 +1141,7 @@ struct qaMatchEff {
       //
       // all tracks, no conditions
       /*
-      if (trkWITS && isTrackSelectedITSCuts(track)) {
+      if (category & kITSTag) {
         if constexpr (IS_MC) { // MC
           // pt comparison plot
           if (makept2d) {
@@ -1211,7 +1282,7 @@ struct qaMatchEff {
       } // end ITS-only tag
       */
       //
-      if (trkWTPC && isTrackSelectedTPCCuts(track)) {
+      if (category & kTPCTag) {
         if constexpr (IS_MC) { // MC
           if (makept2d) {
             histos.fill(HIST("MC/control/ptptconfTPCall"), reco_pt, tpcinner_pt);
@@ -1352,7 +1423,7 @@ struct qaMatchEff {
           } // not pions, nor kaons, nor protons
         }   // end if DATA
         //
-        if (trkWITS && isTrackSelectedITSCuts(track)) { //   ITS tag inside TPC tagged
+        if (category & kITSTag) { //   ITS tag inside TPC tagged
           if constexpr (IS_MC) {                        // MC
             if (makept2d)
               histos.fill(HIST("MC/control/ptptconfTPCITS"), reco_pt, tpcinner_pt);
@@ -1517,9 +1588,9 @@ struct qaMatchEff {
       }   //  end if TPC
       //
       // all tracks with pt>0.5
-      if (trackPt > 0.5) {
+      if (category & kPt05) {
         /*
-        if (trkWITS && isTrackSelectedITSCuts(track)) {
+        if (category & kITSTag) {
           if constexpr (IS_MC) {
             histos.get<TH1>(HIST("MC/pthist_its_05"))->Fill(ITStrackPt);
             histos.get<TH1>(HIST("MC/phihist_its_05"))->Fill(track.phi());
@@ -1531,7 +1602,7 @@ struct qaMatchEff {
           }
         } //  end if ITS
         */
-        if (trkWTPC && isTrackSelectedTPCCuts(track)) {
+        if (category & kTPCTag) {
           if constexpr (IS_MC) {
             histos.get<TH1>(HIST("MC/pthist_tpc_05"))->Fill(trackPt);
             histos.get<TH1>(HIST("MC/phihist_tpc_05"))->Fill(track.phi());
@@ -1541,7 +1612,7 @@ struct qaMatchEff {
             histos.get<TH1>(HIST("data/phihist_tpc_05"))->Fill(track.phi());
             histos.get<TH1>(HIST("data/etahist_tpc_05"))->Fill(track.eta());
           }
-          if (trkWITS && isTrackSelectedITSCuts(track)) {
+          if (category & kITSTag) {
             if constexpr (IS_MC) {
               histos.get<TH1>(HIST("MC/pthist_tpcits_05"))->Fill(trackPt);
               histos.get<TH1>(HIST("MC/phihist_tpcits_05"))->Fill(track.phi());
@@ -1556,9 +1627,9 @@ struct qaMatchEff {
       }     //  end if pt > 0.5
       //
       // positive only
-      if (track.signed1Pt() > 0) {
+      if (category & kPositive) {
         /*
-        if (trkWITS && isTrackSelectedITSCuts(track)) {
+        if (category & kITSTag) {
           if constexpr (IS_MC) { // MC
             histos.get<TH1>(HIST("MC/pthist_its_pos"))->Fill(ITStrackPt);
             histos.get<TH1>(HIST("MC/phihist_its_pos"))->Fill(track.phi());
@@ -1570,7 +1641,7 @@ struct qaMatchEff {
           }
         } //  end if ITS
         */
-        if (trkWTPC && isTrackSelectedTPCCuts(track)) {
+        if (category & kTPCTag) {
           if constexpr (IS_MC) {
             histos.get<TH1>(HIST("MC/pthist_tpc_pos"))->Fill(trackPt);
             histos.get<TH1>(HIST("MC/phihist_tpc_pos"))->Fill(track.phi());
@@ -1580,7 +1651,7 @@ struct qaMatchEff {
             histos.get<TH1>(HIST("data/phihist_tpc_pos"))->Fill(track.phi());
             histos.get<TH1>(HIST("data/etahist_tpc_pos"))->Fill(track.eta());
           }
-          if (trkWITS && isTrackSelectedITSCuts(track)) {
+          if (category & kITSTag) {
             if constexpr (IS_MC) {
               histos.get<TH1>(HIST("MC/pthist_tpcits_pos"))->Fill(trackPt);
               histos.get<TH1>(HIST("MC/phihist_tpcits_pos"))->Fill(track.phi());
@@ -1596,9 +1667,9 @@ struct qaMatchEff {
       }     // end positive
       //
       // negative only
-      if (track.signed1Pt() < 0) {
+      if (category & kNegative) {
         /*
-        if (trkWITS && isTrackSelectedITSCuts(track)) {
+        if (category & kITSTag) {
           if constexpr (IS_MC) {
             histos.get<TH1>(HIST("MC/pthist_its_neg"))->Fill(ITStrackPt);
             histos.get<TH1>(HIST("MC/phihist_its_neg"))->Fill(track.phi());
@@ -1610,7 +1681,7 @@ struct qaMatchEff {
           }
         } //  end if ITS
         */
-        if (trkWTPC && isTrackSelectedTPCCuts(track)) {
+        if (category & kTPCTag) {
           if constexpr (IS_MC) {
             histos.get<TH1>(HIST("MC/pthist_tpc_neg"))->Fill(trackPt);
             histos.get<TH1>(HIST("MC/phihist_tpc_neg"))->Fill(track.phi());
@@ -1620,7 +1691,7 @@ struct qaMatchEff {
             histos.get<TH1>(HIST("data/phihist_tpc_neg"))->Fill(track.phi());
             histos.get<TH1>(HIST("data/etahist_tpc_neg"))->Fill(track.eta());
           }
-          if (trkWITS && isTrackSelectedITSCuts(track)) {
+          if (category & kITSTag) {
             if constexpr (IS_MC) {
               histos.get<TH1>(HIST("MC/pthist_tpcits_neg"))->Fill(trackPt);
               histos.get<TH1>(HIST("MC/phihist_tpcits_neg"))->Fill(track.phi());
@@ -1641,19 +1712,19 @@ struct qaMatchEff {
         // only primaries
         if (mcpart.isPhysicalPrimary()) {
           /*
-          if (trkWITS && isTrackSelectedITSCuts(track)) {
+          if (category & kITSTag) {
             histos.get<TH1>(HIST("MC/primsec/qopthist_its_prim"))->Fill(track.signed1Pt());
             histos.get<TH1>(HIST("MC/primsec/pthist_its_prim"))->Fill(ITStrackPt);
             histos.get<TH1>(HIST("MC/primsec/phihist_its_prim"))->Fill(track.phi());
             histos.get<TH1>(HIST("MC/primsec/etahist_its_prim"))->Fill(track.eta());
           } //  end if ITS
           */
-          if (trkWTPC && isTrackSelectedTPCCuts(track)) {
+          if (category & kTPCTag) {
             histos.get<TH1>(HIST("MC/primsec/qopthist_tpc_prim"))->Fill(track.signed1Pt());
             histos.get<TH1>(HIST("MC/primsec/pthist_tpc_prim"))->Fill(trackPt);
             histos.get<TH1>(HIST("MC/primsec/phihist_tpc_prim"))->Fill(track.phi());
             histos.get<TH1>(HIST("MC/primsec/etahist_tpc_prim"))->Fill(track.eta());
-            if (trkWITS && isTrackSelectedITSCuts(track)) {
+            if (category & kITSTag) {
               histos.get<TH1>(HIST("MC/primsec/qopthist_tpcits_prim"))->Fill(track.signed1Pt());
               histos.get<TH1>(HIST("MC/primsec/pthist_tpcits_prim"))->Fill(trackPt);
               histos.get<TH1>(HIST("MC/primsec/phihist_tpcits_prim"))->Fill(track.phi());
@@ -1665,19 +1736,19 @@ struct qaMatchEff {
           //
           // only secondaries from decay
           /*
-          if (trkWITS && isTrackSelectedITSCuts(track)) {
+          if (category & kITSTag) {
             histos.get<TH1>(HIST("MC/primsec/qopthist_its_secd"))->Fill(track.signed1Pt());
             histos.get<TH1>(HIST("MC/primsec/pthist_its_secd"))->Fill(ITStrackPt);
             histos.get<TH1>(HIST("MC/primsec/phihist_its_secd"))->Fill(track.phi());
             histos.get<TH1>(HIST("MC/primsec/etahist_its_secd"))->Fill(track.eta());
           } //  end if ITS
           */
-          if (trkWTPC && isTrackSelectedTPCCuts(track)) {
+          if (category & kTPCTag) {
             histos.get<TH1>(HIST("MC/primsec/qopthist_tpc_secd"))->Fill(track.signed1Pt());
             histos.get<TH1>(HIST("MC/primsec/pthist_tpc_secd"))->Fill(trackPt);
             histos.get<TH1>(HIST("MC/primsec/phihist_tpc_secd"))->Fill(track.phi());
             histos.get<TH1>(HIST("MC/primsec/etahist_tpc_secd"))->Fill(track.eta());
-            if (trkWITS && isTrackSelectedITSCuts(track)) {
+            if (category & kITSTag) {
               histos.get<TH1>(HIST("MC/primsec/qopthist_tpcits_secd"))->Fill(track.signed1Pt());
               histos.get<TH1>(HIST("MC/primsec/pthist_tpcits_secd"))->Fill(trackPt);
               histos.get<TH1>(HIST("MC/primsec/phihist_tpcits_secd"))->Fill(track.phi());
@@ -1689,19 +1760,19 @@ struct qaMatchEff {
           //
           // only secondaries from material
           /*
-          if (trkWITS && isTrackSelectedITSCuts(track)) {
+          if (category & kITSTag) {
             histos.get<TH1>(HIST("MC/primsec/qopthist_its_secm"))->Fill(track.signed1Pt());
             histos.get<TH1>(HIST("MC/primsec/pthist_its_secm"))->Fill(ITStrackPt);
             histos.get<TH1>(HIST("MC/primsec/phihist_its_secm"))->Fill(track.phi());
             histos.get<TH1>(HIST("MC/primsec/etahist_its_secm"))->Fill(track.eta());
           } //  end if ITS
           */
-          if (trkWTPC && isTrackSelectedTPCCuts(track)) {
+          if (category & kTPCTag) {
             histos.get<TH1>(HIST("MC/primsec/qopthist_tpc_secm"))->Fill(track.signed1Pt());
             histos.get<TH1>(HIST("MC/primsec/pthist_tpc_secm"))->Fill(trackPt);
             histos.get<TH1>(HIST("MC/primsec/phihist_tpc_secm"))->Fill(track.phi());
             histos.get<TH1>(HIST("MC/primsec/etahist_tpc_secm"))->Fill(track.eta());
-            if (trkWITS && isTrackSelectedITSCuts(track)) {
+            if (category & kITSTag) {
               histos.get<TH1>(HIST("MC/primsec/qopthist_tpcits_secm"))->Fill(track.signed1Pt());
               histos.get<TH1>(HIST("MC/primsec/pthist_tpcits_secm"))->Fill(trackPt);
               histos.get<TH1>(HIST("MC/primsec/phihist_tpcits_secm"))->Fill(track.phi());
@@ -1713,7 +1784,7 @@ struct qaMatchEff {
         // protons only
         if (tpPDGCode == 2212) {
           /*
-          if (trkWITS && isTrackSelectedITSCuts(track)) {
+          if (category & kITSTag) {
             histos.get<TH1>(HIST("MC/PID/pthist_its_pr"))->Fill(ITStrackPt);
             histos.get<TH1>(HIST("MC/PID/phihist_its_pr"))->Fill(track.phi());
             histos.get<TH1>(HIST("MC/PID/etahist_its_pr"))->Fill(track.eta());
@@ -1728,7 +1799,7 @@ struct qaMatchEff {
             }
           } //  end if ITS
           */
-          if (trkWTPC && isTrackSelectedTPCCuts(track)) {
+          if (category & kTPCTag) {
             histos.get<TH1>(HIST("MC/PID/pthist_tpc_pr"))->Fill(trackPt);
             histos.get<TH1>(HIST("MC/PID/phihist_tpc_pr"))->Fill(track.phi());
             histos.get<TH1>(HIST("MC/PID/etahist_tpc_pr"))->Fill(track.eta());
@@ -1741,7 +1812,7 @@ struct qaMatchEff {
               histos.get<TH1>(HIST("MC/PID/phihist_tpc_prminus"))->Fill(track.phi());
               histos.get<TH1>(HIST("MC/PID/etahist_tpc_prminus"))->Fill(track.eta());
             }
-            if (trkWITS && isTrackSelectedITSCuts(track)) {
+            if (category & kITSTag) {
               histos.get<TH1>(HIST("MC/PID/pthist_tpcits_pr"))->Fill(trackPt);
               histos.get<TH1>(HIST("MC/PID/phihist_tpcits_pr"))->Fill(track.phi());
               histos.get<TH1>(HIST("MC/PID/etahist_tpcits_pr"))->Fill(track.eta());
@@ -1763,7 +1834,7 @@ struct qaMatchEff {
           /*
           //
           // ITS tracks
-          if (trkWITS && isTrackSelectedITSCuts(track)) {
+          if (category & kITSTag) {
             histos.get<TH1>(HIST("MC/PID/pthist_its_pi"))->Fill(ITStrackPt);
             histos.get<TH1>(HIST("MC/PID/phihist_its_pi"))->Fill(track.phi());
             histos.get<TH1>(HIST("MC/PID/etahist_its_pi"))->Fill(track.eta());
@@ -1778,7 +1849,7 @@ struct qaMatchEff {
             }
           } //  end if ITS
           */
-          if (trkWTPC && isTrackSelectedTPCCuts(track)) {
+          if (category & kTPCTag) {
             histos.get<TH1>(HIST("MC/PID/pthist_tpc_pi"))->Fill(trackPt);
             histos.get<TH1>(HIST("MC/PID/phihist_tpc_pi"))->Fill(track.phi());
             histos.get<TH1>(HIST("MC/PID/etahist_tpc_pi"))->Fill(track.eta());
@@ -1791,7 +1862,7 @@ struct qaMatchEff {
               histos.get<TH1>(HIST("MC/PID/phihist_tpc_piminus"))->Fill(track.phi());
               histos.get<TH1>(HIST("MC/PID/etahist_tpc_piminus"))->Fill(track.eta());
             }
-            if (trkWITS && isTrackSelectedITSCuts(track)) {
+            if (category & kITSTag) {
               histos.get<TH1>(HIST("MC/PID/pthist_tpcits_pi"))->Fill(trackPt);
               histos.get<TH1>(HIST("MC/PID/phihist_tpcits_pi"))->Fill(track.phi());
               histos.get<TH1>(HIST("MC/PID/etahist_tpcits_pi"))->Fill(track.eta());
@@ -1810,17 +1881,17 @@ struct qaMatchEff {
           // only primary pions
           if (mcpart.isPhysicalPrimary()) {
             /*
-            if (trkWITS && isTrackSelectedITSCuts(track)) {
+            if (category & kITSTag) {
               histos.get<TH1>(HIST("MC/PID/pthist_its_pi_prim"))->Fill(ITStrackPt);
               histos.get<TH1>(HIST("MC/PID/phihist_its_pi_prim"))->Fill(track.phi());
               histos.get<TH1>(HIST("MC/PID/etahist_its_pi_prim"))->Fill(track.eta());
             } //  end if ITS
             */
-            if (trkWTPC && isTrackSelectedTPCCuts(track)) {
+            if (category & kTPCTag) {
               histos.get<TH1>(HIST("MC/PID/pthist_tpc_pi_prim"))->Fill(trackPt);
               histos.get<TH1>(HIST("MC/PID/phihist_tpc_pi_prim"))->Fill(track.phi());
               histos.get<TH1>(HIST("MC/PID/etahist_tpc_pi_prim"))->Fill(track.eta());
-              if (trkWITS && isTrackSelectedITSCuts(track)) {
+              if (category & kITSTag) {
                 histos.get<TH1>(HIST("MC/PID/pthist_tpcits_pi_prim"))->Fill(trackPt);
                 histos.get<TH1>(HIST("MC/PID/phihist_tpcits_pi_prim"))->Fill(track.phi());
                 histos.get<TH1>(HIST("MC/PID/etahist_tpcits_pi_prim"))->Fill(track.eta());
@@ -1831,17 +1902,17 @@ struct qaMatchEff {
             //
             // only secondary pions from decay
             /*
-            if (trkWITS && isTrackSelectedITSCuts(track)) {
+            if (category & kITSTag) {
               histos.get<TH1>(HIST("MC/PID/pthist_its_pi_secd"))->Fill(ITStrackPt);
               histos.get<TH1>(HIST("MC/PID/phihist_its_pi_secd"))->Fill(track.phi());
               histos.get<TH1>(HIST("MC/PID/etahist_its_pi_secd"))->Fill(track.eta());
             } //  end if ITS
             */
-            if (trkWTPC && isTrackSelectedTPCCuts(track)) {
+            if (category & kTPCTag) {
               histos.get<TH1>(HIST("MC/PID/pthist_tpc_pi_secd"))->Fill(trackPt);
               histos.get<TH1>(HIST("MC/PID/phihist_tpc_pi_secd"))->Fill(track.phi());
               histos.get<TH1>(HIST("MC/PID/etahist_tpc_pi_secd"))->Fill(track.eta());
-              if (trkWITS && isTrackSelectedITSCuts(track)) {
+              if (category & kITSTag) {
                 histos.get<TH1>(HIST("MC/PID/pthist_tpcits_pi_secd"))->Fill(trackPt);
                 histos.get<TH1>(HIST("MC/PID/phihist_tpcits_pi_secd"))->Fill(track.phi());
                 histos.get<TH1>(HIST("MC/PID/etahist_tpcits_pi_secd"))->Fill(track.eta());
@@ -1852,17 +1923,17 @@ struct qaMatchEff {
             //
             // only secondary pions from material
             /*
-            if (trkWITS && isTrackSelectedITSCuts(track)) {
+            if (category & kITSTag) {
               histos.get<TH1>(HIST("MC/PID/pthist_its_pi_secm"))->Fill(ITStrackPt);
               histos.get<TH1>(HIST("MC/PID/phihist_its_pi_secm"))->Fill(track.phi());
               histos.get<TH1>(HIST("MC/PID/etahist_its_pi_secm"))->Fill(track.eta());
             } //  end if ITS
             */
-            if (trkWTPC && isTrackSelectedTPCCuts(track)) {
+            if (category & kTPCTag) {
               histos.get<TH1>(HIST("MC/PID/pthist_tpc_pi_secm"))->Fill(trackPt);
               histos.get<TH1>(HIST("MC/PID/phihist_tpc_pi_secm"))->Fill(track.phi());
               histos.get<TH1>(HIST("MC/PID/etahist_tpc_pi_secm"))->Fill(track.eta());
-              if (trkWITS && isTrackSelectedITSCuts(track)) {
+              if (category & kITSTag) {
                 histos.get<TH1>(HIST("MC/PID/pthist_tpcits_pi_secm"))->Fill(trackPt);
                 histos.get<TH1>(HIST("MC/PID/phihist_tpcits_pi_secm"))->Fill(track.phi());
                 histos.get<TH1>(HIST("MC/PID/etahist_tpcits_pi_secm"))->Fill(track.eta());
@@ -1883,19 +1954,19 @@ struct qaMatchEff {
             pdg_fill = -10.0;
           //
           /*
-          if (trkWITS && isTrackSelectedITSCuts(track)) {
+          if (category & kITSTag) {
             histos.get<TH1>(HIST("MC/PID/pthist_its_nopi"))->Fill(ITStrackPt);
             histos.get<TH1>(HIST("MC/PID/phihist_its_nopi"))->Fill(track.phi());
             histos.get<TH1>(HIST("MC/PID/etahist_its_nopi"))->Fill(track.eta());
             histos.get<TH1>(HIST("MC/PID/pdghist_denits"))->Fill(pdg_fill);
           } //  end if ITS
           */
-          if (trkWTPC && isTrackSelectedTPCCuts(track)) {
+          if (category & kTPCTag) {
             histos.get<TH1>(HIST("MC/PID/pthist_tpc_nopi"))->Fill(trackPt);
             histos.get<TH1>(HIST("MC/PID/phihist_tpc_nopi"))->Fill(track.phi());
             histos.get<TH1>(HIST("MC/PID/etahist_tpc_nopi"))->Fill(track.eta());
             histos.get<TH1>(HIST("MC/PID/pdghist_den"))->Fill(pdg_fill);
-            if (trkWITS && isTrackSelectedITSCuts(track)) {
+            if (category & kITSTag) {
               histos.get<TH1>(HIST("MC/PID/pthist_tpcits_nopi"))->Fill(trackPt);
               histos.get<TH1>(HIST("MC/PID/phihist_tpcits_nopi"))->Fill(track.phi());
               histos.get<TH1>(HIST("MC/PID/etahist_tpcits_nopi"))->Fill(track.eta());
@@ -1907,7 +1978,7 @@ struct qaMatchEff {
         // kaons only
         if (tpPDGCode == 321) {
           /*
-          if (trkWITS && isTrackSelectedITSCuts(track)) {
+          if (category & kITSTag) {
             histos.get<TH1>(HIST("MC/PID/pthist_its_ka"))->Fill(ITStrackPt);
             histos.get<TH1>(HIST("MC/PID/phihist_its_ka"))->Fill(track.phi());
             histos.get<TH1>(HIST("MC/PID/etahist_its_ka"))->Fill(track.eta());
@@ -1922,7 +1993,7 @@ struct qaMatchEff {
             }
           } //  end if ITS
           */
-          if (trkWTPC && isTrackSelectedTPCCuts(track)) {
+          if (category & kTPCTag) {
             histos.get<TH1>(HIST("MC/PID/pthist_tpc_ka"))->Fill(trackPt);
             histos.get<TH1>(HIST("MC/PID/phihist_tpc_ka"))->Fill(track.phi());
             histos.get<TH1>(HIST("MC/PID/etahist_tpc_ka"))->Fill(track.eta());
@@ -1935,7 +2006,7 @@ struct qaMatchEff {
               histos.get<TH1>(HIST("MC/PID/phihist_tpc_kaminus"))->Fill(track.phi());
               histos.get<TH1>(HIST("MC/PID/etahist_tpc_kaminus"))->Fill(track.eta());
             }
-            if (trkWITS && isTrackSelectedITSCuts(track)) {
+            if (category & kITSTag) {
               histos.get<TH1>(HIST("MC/PID/pthist_tpcits_ka"))->Fill(trackPt);
               histos.get<TH1>(HIST("MC/PID/phihist_tpcits_ka"))->Fill(track.phi());
               histos.get<TH1>(HIST("MC/PID/etahist_tpcits_ka"))->Fill(track.eta());
@@ -1955,17 +2026,17 @@ struct qaMatchEff {
         // pions and kaons together
         if (tpPDGCode == 211 || tpPDGCode == 321) {
           /*
-          if (trkWITS && isTrackSelectedITSCuts(track)) {
+          if (category & kITSTag) {
             histos.get<TH1>(HIST("MC/PID/pthist_its_piK"))->Fill(ITStrackPt);
             histos.get<TH1>(HIST("MC/PID/phihist_its_piK"))->Fill(track.phi());
             histos.get<TH1>(HIST("MC/PID/etahist_its_piK"))->Fill(track.eta());
           } //  end if ITS
           */
-          if (trkWTPC && isTrackSelectedTPCCuts(track)) {
+          if (category & kTPCTag) {
             histos.get<TH1>(HIST("MC/PID/pthist_tpc_piK"))->Fill(trackPt);
             histos.get<TH1>(HIST("MC/PID/phihist_tpc_piK"))->Fill(track.phi());
             histos.get<TH1>(HIST("MC/PID/etahist_tpc_piK"))->Fill(track.eta());
-            if (trkWITS && isTrackSelectedITSCuts(track)) {
+            if (category & kITSTag) {
               histos.get<TH1>(HIST("MC/PID/pthist_tpcits_piK"))->Fill(trackPt);
               histos.get<TH1>(HIST("MC/PID/phihist_tpcits_piK"))->Fill(track.phi());
               histos.get<TH1>(HIST("MC/PID/etahist_tpcits_piK"))->Fill(track.eta());
@@ -1977,6 +2048,8 @@ struct qaMatchEff {
       //
     } //  end loop on tracks
     //
+    if (makeSummary)
+      flushSummary();
     //
     if (doDebug) {
       LOGF(info, "Selected tracks: %d ", countData);
@@ -18,7 +18,11 @@
 
 #include "tpcSkimsTableCreator.h"
 #include <CCDB/BasicCCDBManager.h>
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <limits>
+#include <vector>
 /// ROOT
 #include "TRandom3.h"
 /// O2
@@ -40,6 +44,90 @@ using namespace o2::framework::expressions;
 using namespace o2::track;
 using namespace o2::dataformats;
 
+/// Tsalis/Hagedorn spectra fit of charged particles, (1 + mT / (n T))^-n
+double tsalisCharged(double pt, double mass, double sqrts)
+{
+  const double a = 6.81, b = 59.24;
+  const double c = 0.082, d = 0.151;
+  const double mt = std::sqrt(mass * mass + pt * pt);
+  const double n = a + b / sqrts;
+  const double T = c + d / sqrts;
+  const double p0 = n * T;
+  return std::pow((1. + mt / p0), -n);
+}
+
+/// Weight pT^3 f(pT) / f(1) of the pT dependent downsampling of a species, tabulated once on a fine pT grid
+/// and linearly interpolated, the tracks being kept with probability factor / weight
+class TsalisWeights
+{
+ public:
+  static constexpr int NPoints = 4001;
+  static constexpr double PtMax = 20.;
+  static constexpr double Step = PtMax / (NPoints - 1);
+
+  void init(double mass, double sqrts)
+  {
+    mMass = mass;
+    mSqrts = sqrts;
+    for (int i = 0; i < NPoints; i++) {
+      mWeights[i] = compute(i * Step);
+    }
+  }
+
+  double weight(double pt) const
+  {
+    if (pt >= PtMax) {
+      return compute(pt);
+    }
+    const double x = pt / Step;
+    const int i = static_cast<int>(x);
+    const double f = x - i;
+    return mWeights[i] + f * (mWeights[i + 1] - mWeights[i]);
+  }
+
+ private:
+  double compute(double pt) const
+  {
+    return tsalisCharged(pt, mMass, mSqrts) * pt * pt * pt / tsalisCharged(1., mMass, mSqrts);
+  }
+
+  double mMass = 0.;
+  double mSqrts = 0.;
+  std::array<double, NPoints> mWeights{};
+};
+
+/// Reservoir sampling of at most a fixed number of elements out of a stream of unknown length
+template <typename T>
+class Reservoir
+{
+ public:
+  void clear()
+  {
+    mSeen = 0;
+    mElements.clear();
+  }
+
+  template <typename TRandom>
+  void add(T const& element, std::size_t size, TRandom& rndm)
+  {
+    ++mSeen;
+    if (mElements.size() < size) {
+      mElements.push_back(element);
+      return;
+    }
+    const auto j = static_cast<std::size_t>(rndm.Integer(mSeen));
+    if (j < size) {
+      mElements[j] = element;
+    }
+  }
+
+  std::vector<T> const& elements() const { return mElements; }
+
+ private:
+  unsigned int mSeen = 0;
+  std::vector<T> mElements;
+};
+
 struct TreeWriterTpcV0 {
 
   using Trks = soa::Join<aod::Tracks, aod::V0Bits, aod::TracksExtra, aod::pidTPCFullEl, aod::pidTPCFullPi, aod::pidTPCFullKa, aod::pidTPCFullPr, aod::pidTOFFullEl, aod::pidTOFFullPi, aod::pidTOFFullKa, aod::pidTOFFullPr, aod::TrackSelection>;
@@ -114,18 +202,6 @@ struct TreeWriterTpcV0 {
     }
   };
 
-  double tsalisCharged(double pt, double mass, double sqrts)
-  {
-    const double a = 6.81, b = 59.24;
-    const double c = 0.082, d = 0.151;
-    const double mt = std::sqrt(mass * mass + pt * pt);
-    const double n = a + b / sqrts;
-    const double T = c + d / sqrts;
-    const double p0 = n * T;
-    const double result = std::pow((1. + mt / p0), -n);
-    return result;
-  };
-
   /// Random downsampling trigger function using Tsalis/Hagedorn spectra fit (sqrt(s) = 62.4 GeV to 13 TeV)
   /// as in https://iopscience.iop.org/article/10.1088/2399-6528/aab00f/pdf
   TRandom3* fRndm = new TRandom3(0);
@@ -251,6 +327,9 @@ struct TreeWriterTPCTOF {
   Configurable<float> downsamplingTsalisProtons{"downsamplingTsalisProtons", -1., "Downsampling factor to reduce the number of protons"};
   Configurable<float> downsamplingTsalisKaons{"downsamplingTsalisKaons", -1., "Downsampling factor to reduce the number of kaons"};
   Configurable<float> downsamplingTsalisPions{"downsamplingTsalisPions", -1., "Downsampling factor to reduce the number of pions"};
+  /// Reservoir sampling
+  Configurable<int> reservoirSize{"reservoirSize", 100, "Number of tracks of each species kept per pT bin and time frame by processReservoir"};
+  Configurable<std::vector<float>> binsPtReservoir{"binsPtReservoir", {0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.8, 1.0, 1.2, 1.5, 2.0, 2.5, 3.0, 4.0, 5.0, 7.0, 10.0, 20.0}, "pT bin edges of the reservoirs of processReservoir"};
 
   Filter trackFilter = (trackSelection.node() == 0) ||
                        ((trackSelection.node() == 1) && requireGlobalTrackInFilter()) ||
@@ -259,33 +338,35 @@ struct TreeWriterTPCTOF {
                        ((trackSelection.node() == 4) && requireQualityTracksInFilter()) ||
                        ((trackSelection.node() == 5) && requireTrackCutInFilter(TrackSelectionFlags::kInAcceptanceTracks));
 
-  double tsalisCharged(double pt, double mass, double sqrts)
-  {
-    const double a = 6.81, b = 59.24;
-    const double c = 0.082, d = 0.151;
-    double mt = std::sqrt(mass * mass + pt * pt);
-    double n = a + b / sqrts;
-    double T = c + d / sqrts;
-    double p0 = n * T;
-    double result = pow((1. + mt / p0), -n);
-    return result;
+  /// Species written in the tree, in the order in which they are selected
+  static constexpr int NSpecies = 5;
+  static constexpr std::array<o2::track::PID::ID, NSpecies> Species = {o2::track::PID::Triton, o2::track::PID::Deuteron, o2::track::PID::Proton, o2::track::PID::Kaon, o2::track::PID::Pion};
+
+  /// Selection and downsampling of a species
+  struct SpeciesSelection {
+    float maxMomTPCOnly;
+    float maxMomHardCut;
+    float nSigmaTPCOnly;
+    float nSigmaTPC_TPCTOF;
+    float nSigmaTOF_TPCTOF;
+    double dwnSmplFactor;
+    float downsamplingTsalis;
+    TsalisWeights tsalisWeights;
   };
+  std::array<SpeciesSelection, NSpecies> selections;
+
+  using TrackReservoir = Reservoir<soa::Filtered<Trks>::iterator>;
+  std::vector<TrackReservoir> reservoirs; ///< one per species and pT bin
 
   /// Random downsampling trigger function using Tsalis/Hagedorn spectra fit (sqrt(s) = 62.4 GeV to 13 TeV)
   /// as in https://iopscience.iop.org/article/10.1088/2399-6528/aab00f/pdf
   TRandom3* fRndm = new TRandom3(0);
-  bool downsampleTsalisCharged(double pt, float factor1Pt, double sqrts, double mass)
+  bool downsampleTsalisCharged(double pt, float factor1Pt, TsalisWeights const& weights)
   {
     if (factor1Pt < 0.) {
       return true;
     }
-    const double prob = tsalisCharged(pt, mass, sqrts) * pt;
-    const double probNorm = tsalisCharged(1., mass, sqrts);
-    if ((fRndm->Rndm() * ((prob / probNorm) * pt * pt)) > factor1Pt) {
-      return false;
-    } else {
-      return true;
-    }
+    return (fRndm->Rndm() * weights.weight(pt)) <= factor1Pt;
   };
 
   /// Function to fill trees
@@ -320,6 +401,55 @@ struct TreeWriterTPCTOF {
     }
   };
 
+  /// TPC and TOF n-sigma of the track for a species
+  template <typename T>
+  std::array<float, 2> nSigmas(T const& trk, const o2::track::PID::ID id)
+  {
+    switch (id) {
+      case o2::track::PID::Triton:
+        return {trk.tpcNSigmaTr(), trk.tofNSigmaTr()};
+      case o2::track::PID::Deuteron:
+        return {trk.tpcNSigmaDe(), trk.tofNSigmaDe()};
+      case o2::track::PID::Proton:
+        return {trk.tpcNSigmaPr(), trk.tofNSigmaPr()};
+      case o2::track::PID::Kaon:
+        return {trk.tpcNSigmaKa(), trk.tofNSigmaKa()};
+      default:
+        return {trk.tpcNSigmaPi(), trk.tofNSigmaPi()};
+    }
+  }
+
+  /// Expected TPC signal of the track for a species
+  template <typename T>
+  float expectedSignal(T const& trk, const o2::track::PID::ID id)
+  {
+    switch (id) {
+      case o2::track::PID::Triton:
+        return trk.tpcExpSignalTr(trk.tpcSignal());
+      case o2::track::PID::Deuteron:
+        return trk.tpcExpSignalDe(trk.tpcSignal());
+      case o2::track::PID::Proton:
+        return trk.tpcExpSignalPr(trk.tpcSignal());
+      case o2::track::PID::Kaon:
+        return trk.tpcExpSignalKa(trk.tpcSignal());
+      default:
+        return trk.tpcExpSignalPi(trk.tpcSignal());
+    }
+  }
+
+  /// TPC only selection below maxMomTPCOnly, TPC and TOF combined selection above
+  template <typename T>
+  bool isSpeciesSelected(T const& trk, SpeciesSelection const& sel, std::array<float, 2> const& nSigma)
+  {
+    if (trk.tpcInnerParam() >= sel.maxMomHardCut) {
+      return false;
+    }
+    if (trk.tpcInnerParam() <= sel.maxMomTPCOnly) {
+      return std::abs(nSigma[0]) < sel.nSigmaTPCOnly;
+    }
+    return std::abs(nSigma[1]) < sel.nSigmaTOF_TPCTOF && std::abs(nSigma[0]) < sel.nSigmaTPC_TPCTOF;
+  }
+
   /// Event selection
   template <typename CollisionType, typename TrackType>
   bool isEventSelected(const CollisionType& collision, const TrackType& tracks)
@@ -338,9 +468,27 @@ struct TreeWriterTPCTOF {
 
   void init(o2::framework::InitContext& initContext)
   {
+    constexpr float noHardCut = std::numeric_limits<float>::max();
+    // the light nuclei are downsampled with the factor of the protons
+    selections[0] = {maxMomTPCOnlyTr, noHardCut, nSigmaTPCOnlyTr, nSigmaTPC_TPCTOF_Tr, nSigmaTOF_TPCTOF_Tr, dwnSmplFactor_Tr, downsamplingTsalisProtons, {}};
+    selections[1] = {maxMomTPCOnlyDe, noHardCut, nSigmaTPCOnlyDe, nSigmaTPC_TPCTOF_De, nSigmaTOF_TPCTOF_De, dwnSmplFactor_De, downsamplingTsalisProtons, {}};
+    selections[2] = {maxMomTPCOnlyPr, noHardCut, nSigmaTPCOnlyPr, nSigmaTPC_TPCTOF_Pr, nSigmaTOF_TPCTOF_Pr, dwnSmplFactor_Pr, downsamplingTsalisProtons, {}};
+    selections[3] = {maxMomTPCOnlyKa, maxMomHardCutOnlyKa, nSigmaTPCOnlyKa, nSigmaTPC_TPCTOF_Ka, nSigmaTOF_TPCTOF_Ka, dwnSmplFactor_Ka, downsamplingTsalisKaons, {}};
+    selections[4] = {maxMomTPCOnlyPi, noHardCut, nSigmaTPCOnlyPi, nSigmaTPC_TPCTOF_Pi, nSigmaTOF_TPCTOF_Pi, dwnSmplFactor_Pi, downsamplingTsalisPions, {}};
+    for (int i = 0; i < NSpecies; i++) {
+      if (selections[i].downsamplingTsalis >= 0.) {
+        selections[i].tsalisWeights.init(o2::track::pid_constants::sMasses[Species[i]], sqrtSNN);
+      }
+    }
+    if (doprocessReservoir) {
+      if (binsPtReservoir->size() < 2 || !std::is_sorted(binsPtReservoir->begin(), binsPtReservoir->end())) {
+        LOG(fatal) << "binsPtReservoir needs at least two increasing bin edges";
+      }
+      reservoirs.resize(NSpecies * (binsPtReservoir->size() - 1));
+    }
   }
 
-  void process(Coll::iterator const& collision, soa::Filtered<Trks> const& tracks, aod::BCsWithTimestamps const&)
+  void processStandard(Coll::iterator const& collision, soa::Filtered<Trks> const& tracks, aod::BCsWithTimestamps const&)
   {
     /// Check event selection
     if (!isEventSelected(collision, tracks)) {
@@ -351,39 +499,59 @@ struct TreeWriterTPCTOF {
     const int runnumber = bc.runNumber();
     rowTPCTOFTree.reserve(tracks.size());
     for (auto const& trk : tracks) {
-      /// Fill tree for tritons
-      if (trk.tpcInnerParam() <= maxMomTPCOnlyTr && std::abs(trk.tpcNSigmaTr()) < nSigmaTPCOnlyTr && downsampleTsalisCharged(trk.pt(), downsamplingTsalisProtons, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Triton])) {
-        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaTr(), trk.tofNSigmaTr(), trk.tpcExpSignalTr(trk.tpcSignal()), o2::track::PID::Triton, runnumber, dwnSmplFactor_Tr);
-      } else if (trk.tpcInnerParam() > maxMomTPCOnlyTr && std::abs(trk.tofNSigmaTr()) < nSigmaTOF_TPCTOF_Tr && std::abs(trk.tpcNSigmaTr()) < nSigmaTPC_TPCTOF_Tr && downsampleTsalisCharged(trk.pt(), downsamplingTsalisProtons, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Triton])) {
-        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaTr(), trk.tofNSigmaTr(), trk.tpcExpSignalTr(trk.tpcSignal()), o2::track::PID::Triton, runnumber, dwnSmplFactor_Tr);
+      for (int i = 0; i < NSpecies; i++) {
+        auto const& sel = selections[i];
+        const auto nSigma = nSigmas(trk, Species[i]);
+        if (isSpeciesSelected(trk, sel, nSigma) && downsampleTsalisCharged(trk.pt(), sel.downsamplingTsalis, sel.tsalisWeights)) {
+          fillSkimmedTPCTOFTable(trk, collision, nSigma[0], nSigma[1], expectedSignal(trk, Species[i]), Species[i], runnumber, sel.dwnSmplFactor);
+        }
       }
-      /// Fill tree for deuterons
-      if (trk.tpcInnerParam() <= maxMomTPCOnlyDe && std::abs(trk.tpcNSigmaDe()) < nSigmaTPCOnlyDe && downsampleTsalisCharged(trk.pt(), downsamplingTsalisProtons, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Deuteron])) {
-        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaDe(), trk.tofNSigmaDe(), trk.tpcExpSignalDe(trk.tpcSignal()), o2::track::PID::Deuteron, runnumber, dwnSmplFactor_De);
-      } else if (trk.tpcInnerParam() > maxMomTPCOnlyDe && std::abs(trk.tofNSigmaDe()) < nSigmaTOF_TPCTOF_De && std::abs(trk.tpcNSigmaDe()) < nSigmaTPC_TPCTOF_De && downsampleTsalisCharged(trk.pt(), downsamplingTsalisProtons, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Deuteron])) {
-        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaDe(), trk.tofNSigmaDe(), trk.tpcExpSignalDe(trk.tpcSignal()), o2::track::PID::Deuteron, runnumber, dwnSmplFactor_De);
+    } /// Loop tracks
+  }   /// processStandard
+  PROCESS_SWITCH(TreeWriterTPCTOF, processStandard, "Write the selected tracks, downsampled per track", true);
+
+  /// Keeps a fixed number of the selected tracks of each species per pT bin and time frame, instead of the per track downsampling
+  void processReservoir(Coll const& collisions, soa::Filtered<Trks> const& tracks, aod::BCsWithTimestamps const&)
+  {
+    std::vector<bool> selectedCollisions(collisions.size());
+    for (auto const& collision : collisions) {
+      selectedCollisions[collision.globalIndex()] = isEventSelected(collision, tracks);
+    }
+    for (auto& reservoir : reservoirs) {
+      reservoir.clear();
+    }
+
+    auto const& ptEdges = binsPtReservoir.value;
+    const int nPtBins = ptEdges.size() - 1;
+    const std::size_t size = reservoirSize;
+    for (auto const& trk : tracks) {
+      if (!trk.has_collision() || !selectedCollisions[trk.collisionId()]) {
+        continue;
       }
-      /// Fill tree for protons
-      if (trk.tpcInnerParam() <= maxMomTPCOnlyPr && std::abs(trk.tpcNSigmaPr()) < nSigmaTPCOnlyPr && downsampleTsalisCharged(trk.pt(), downsamplingTsalisProtons, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Proton])) {
-        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaPr(), trk.tofNSigmaPr(), trk.tpcExpSignalPr(trk.tpcSignal()), o2::track::PID::Proton, runnumber, dwnSmplFactor_Pr);
-      } else if (trk.tpcInnerParam() > maxMomTPCOnlyPr && std::abs(trk.tofNSigmaPr()) < nSigmaTOF_TPCTOF_Pr && std::abs(trk.tpcNSigmaPr()) < nSigmaTPC_TPCTOF_Pr && downsampleTsalisCharged(trk.pt(), downsamplingTsalisProtons, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Proton])) {
-        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaPr(), trk.tofNSigmaPr(), trk.tpcExpSignalPr(trk.tpcSignal()), o2::track::PID::Proton, runnumber, dwnSmplFactor_Pr);
+      const int ptBin = std::upper_bound(ptEdges.begin(), ptEdges.end(), trk.pt()) - ptEdges.begin() - 1;
+      if (ptBin < 0 || ptBin >= nPtBins) {
+        continue;
       }
-      /// Fill tree for kaons
-      if (trk.tpcInnerParam() < maxMomHardCutOnlyKa && trk.tpcInnerParam() <= maxMomTPCOnlyKa && std::abs(trk.tpcNSigmaKa()) < nSigmaTPCOnlyKa && downsampleTsalisCharged(trk.pt(), downsamplingTsalisKaons, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Kaon])) {
-        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaKa(), trk.tofNSigmaKa(), trk.tpcExpSignalKa(trk.tpcSignal()), o2::track::PID::Kaon, runnumber, dwnSmplFactor_Ka);
-      } else if (trk.tpcInnerParam() < maxMomHardCutOnlyKa && trk.tpcInnerParam() > maxMomTPCOnlyKa && std::abs(trk.tofNSigmaKa()) < nSigmaTOF_TPCTOF_Ka && std::abs(trk.tpcNSigmaKa()) < nSigmaTPC_TPCTOF_Ka && downsampleTsalisCharged(trk.pt(), downsamplingTsalisKaons, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Kaon])) {
-        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaKa(), trk.tofNSigmaKa(), trk.tpcExpSignalKa(trk.tpcSignal()), o2::track::PID::Kaon, runnumber, dwnSmplFactor_Ka);
+      for (int i = 0; i < NSpecies; i++) {
+        if (isSpeciesSelected(trk, selections[i], nSigmas(trk, Species[i]))) {
+          reservoirs[i * nPtBins + ptBin].add(trk, size, *fRndm);
+        }
       }
-      /// Fill tree pions
-      if (trk.tpcInnerParam() <= maxMomTPCOnlyPi && std::abs(trk.tpcNSigmaPi()) < nSigmaTPCOnlyPi && downsampleTsalisCharged(trk.pt(), downsamplingTsalisPions, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Pion])) {
-        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaPi(), trk.tofNSigmaPi(), trk.tpcExpSignalPi(trk.tpcSignal()), o2::track::PID::Pion, runnumber, dwnSmplFactor_Pi);
-      } else if (trk.tpcInnerParam() > maxMomTPCOnlyPi && std::abs(trk.tofNSigmaPi()) < nSigmaTOF_TPCTOF_Pi && std::abs(trk.tpcNSigmaPi()) < nSigmaTPC_TPCTOF_Pi && downsampleTsalisCharged(trk.pt(), downsamplingTsalisPions, sqrtSNN, o2::track::pid_constants::sMasses[o2::track::PID::Pion])) {
-        fillSkimmedTPCTOFTable(trk, collision, trk.tpcNSigmaPi(), trk.tofNSigmaPi(), trk.tpcExpSignalPi(trk.tpcSignal()), o2::track::PID::Pion, runnumber, dwnSmplFactor_Pi);
+    }
+
+    for (int i = 0; i < NSpecies; i++) {
+      for (int ptBin = 0; ptBin < nPtBins; ptBin++) {
+        for (auto const& trk : reservoirs[i * nPtBins + ptBin].elements()) {
+          auto collision = collisions.iteratorAt(trk.collisionId());
+          const int runnumber = collision.bc_as<aod::BCsWithTimestamps>().runNumber();
+          const auto nSigma = nSigmas(trk, Species[i]);
+          fillSkimmedTPCTOFTable(trk, collision, nSigma[0], nSigma[1], expectedSignal(trk, Species[i]), Species[i], runnumber, 1.);
+        }
       }
-    } /// Loop tracks
-  }   /// process
-};    /// struct TreeWriterTPCTOF
+    }
+  } /// processReservoir
+  PROCESS_SWITCH(TreeWriterTPCTOF, processReservoir, "Write a fixed number of the selected tracks per species, pT bin and time frame", false);
+};  /// struct TreeWriterTPCTOF
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
 {
@@ -24,6 +24,7 @@
 #include <string>
 
 #include "../filterTables.h"
+#include "CFFilterHelpers.h"
 
 #include "Framework/ASoAHelpers.h"
 #include "Framework/AnalysisDataModel.h"
@@ -176,6 +177,10 @@ struct CFFilter {
     "ConfAutocorRejection",
     true,
     "Rejection autocorrelation pL pairs"};
+  Configurable<bool> ConfPruneCombinations{
+    "ConfPruneCombinations",
+    true,
+    "Skip the pairs and triplets whose k* or Q3 is provably above the trigger limit (the same event distributions are then not filled for them)"};
 
   // Configs for tracks
   Configurable<bool> ConfDeuteronThPVMom{
@@ -428,6 +433,8 @@ struct CFFilter {
     {CFTrigger::KstarLimits[0], 1, CFTrigger::kNTwoBodyTriggers, std::vector<std::string>{"Limit"}, CFTrigger::TwoBodyFilterNames},
     "kstar limit for two body trigger"};
 
+  CFTrigger::FemtoCombinationKernel femtoKernel;
+
   HistogramRegistry registry{"registry", {}, OutputObjHandlingPolicy::AnalysisObject};
   // HistogramRegistry registryQA{"registryQA", {}, OutputObjHandlingPolicy::AnalysisObject};
 
@@ -460,6 +467,11 @@ struct CFFilter {
       registry.get<TH1>(HIST("fProcessedEvents"))->GetXaxis()->SetBinLabel(iBin + 1, eventTitles[iBin].data());
     }
 
+    registry.add("fPrunedCombinations", "CF - pruned combinations;;Combinations", HistType::kTH1F, {{CFTrigger::nAllTriggers, -0.5, CFTrigger::nAllTriggers - 0.5}});
+    for (int iTrigger = 0; iTrigger < CFTrigger::nAllTriggers; iTrigger++) {
+      registry.get<TH1>(HIST("fPrunedCombinations"))->GetXaxis()->SetBinLabel(iTrigger + 1, CFTrigger::CFTriggerNamesALL[iTrigger].data());
+    }
+
     // event cuts
     registry.add("EventCuts/fMultiplicityBefore", "Multiplicity of all processed events;Mult;Entries", HistType::kTH1F, {{1000, 0, 1000}});
     registry.add("EventCuts/fMultiplicityAfter", "Multiplicity after event cuts;Mult;Entries", HistType::kTH1F, {{1000, 0, 1000}});
@@ -1158,6 +1170,9 @@ struct CFFilter {
     bool keepEvent2N[CFTrigger::kNTwoBodyTriggers] = {false, false};
     int lowKstarPairs[CFTrigger::kNTwoBodyTriggers] = {0, 0};
 
+    // number of pruned combinations of each trigger
+    int64_t prunedCombinations[CFTrigger::nAllTriggers] = {0, 0, 0, 0, 0, 0};
+
     if (isSelectedEvent(col)) {
 
       registry.fill(HIST("EventCuts/fMultiplicityAfter"), col.multNTracksPV());
@@ -1452,235 +1467,171 @@ struct CFFilter {
         }
       }
 
+      // sort the particles, so that the combinations above the limits are pruned
+      femtoKernel.setPruning(ConfPruneCombinations.value);
+      femtoKernel.sortParticles(protons, ProtonIndex);
+      femtoKernel.sortParticles(antiprotons, AntiProtonIndex);
+      femtoKernel.sortParticles(deuterons);
+      femtoKernel.sortParticles(antideuterons);
+      femtoKernel.sortParticles(lambdas, LambdaPosDaughIndex, LambdaNegDaughIndex);
+      femtoKernel.sortParticles(antilambdas, AntiLambdaPosDaughIndex, AntiLambdaNegDaughIndex);
+
       float Q3 = 999.f, kstar = 999.f;
       // if(ConfTriggerSwitches->get(static_cast<uint>(0), CFTrigger::)>0.){
       if (ConfTriggerSwitches->get("Switch", "ppp") > 0.) {
         // ppp trigger
-        for (auto iProton1 = protons.begin(); iProton1 != protons.end(); ++iProton1) {
-          auto iProton2 = iProton1 + 1;
-          for (; iProton2 != protons.end(); ++iProton2) {
-            auto iProton3 = iProton2 + 1;
-            for (; iProton3 != protons.end(); ++iProton3) {
-              Q3 = getQ3(*iProton1, *iProton2, *iProton3);
-              registry.fill(HIST("ppp/fSE_particle"), Q3);
-              if (Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPPP)) {
-                lowQ3Triplets[CFTrigger::kPPP] += 1;
-              }
-            }
+        const float q3Limit = ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPPP);
+        prunedCombinations[CFTrigger::kPPP] += femtoKernel.forEachTriplet(protons, q3Limit, [&](std::size_t i1, std::size_t i2, std::size_t i3) {
+          Q3 = getQ3(protons[i1], protons[i2], protons[i3]);
+          registry.fill(HIST("ppp/fSE_particle"), Q3);
+          if (Q3 < q3Limit) {
+            lowQ3Triplets[CFTrigger::kPPP] += 1;
           }
-        }
-        for (auto iAntiProton1 = antiprotons.begin(); iAntiProton1 != antiprotons.end(); ++iAntiProton1) {
-          auto iAntiProton2 = iAntiProton1 + 1;
-          for (; iAntiProton2 != antiprotons.end(); ++iAntiProton2) {
-            auto iAntiProton3 = iAntiProton2 + 1;
-            for (; iAntiProton3 != antiprotons.end(); ++iAntiProton3) {
-              Q3 = getQ3(*iAntiProton1, *iAntiProton2, *iAntiProton3);
-              registry.fill(HIST("ppp/fSE_antiparticle"), Q3);
-              if (Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPPP)) {
-                lowQ3Triplets[CFTrigger::kPPP] += 1;
-              }
-            }
+        });
+        prunedCombinations[CFTrigger::kPPP] += femtoKernel.forEachTriplet(antiprotons, q3Limit, [&](std::size_t i1, std::size_t i2, std::size_t i3) {
+          Q3 = getQ3(antiprotons[i1], antiprotons[i2], antiprotons[i3]);
+          registry.fill(HIST("ppp/fSE_antiparticle"), Q3);
+          if (Q3 < q3Limit) {
+            lowQ3Triplets[CFTrigger::kPPP] += 1;
           }
-        }
+        });
       }
       if (ConfTriggerSwitches->get("Switch", "ppL") > 0.) {
         // ppl trigger
-        for (auto iProton1 = protons.begin(); iProton1 != protons.end(); ++iProton1) {
-          auto iProton2 = iProton1 + 1;
-          auto i1 = std::distance(protons.begin(), iProton1);
-          for (; iProton2 != protons.end(); ++iProton2) {
-            auto i2 = std::distance(protons.begin(), iProton2);
-            for (auto iLambda1 = lambdas.begin(); iLambda1 != lambdas.end(); ++iLambda1) {
-              auto i3 = std::distance(lambdas.begin(), iLambda1);
-              if (ConfAutocorRejection.value &&
-                  (ProtonIndex.at(i1) == LambdaPosDaughIndex.at(i3) ||
-                   ProtonIndex.at(i2) == LambdaPosDaughIndex.at(i3))) {
-                continue;
-              }
-              Q3 = getQ3(*iProton1, *iProton2, *iLambda1);
-              registry.fill(HIST("ppl/fSE_particle"), Q3);
-              if (Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPPL)) {
-                lowQ3Triplets[CFTrigger::kPPL] += 1;
-              }
-            }
+        const float q3Limit = ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPPL);
+        prunedCombinations[CFTrigger::kPPL] += femtoKernel.forEachTriplet(protons, lambdas, q3Limit, [&](std::size_t i1, std::size_t i2, std::size_t i3) {
+          if (ConfAutocorRejection.value &&
+              (ProtonIndex.at(i1) == LambdaPosDaughIndex.at(i3) ||
+               ProtonIndex.at(i2) == LambdaPosDaughIndex.at(i3))) {
+            return;
           }
-        }
-        for (auto iAntiProton1 = antiprotons.begin(); iAntiProton1 != antiprotons.end(); ++iAntiProton1) {
-          auto iAntiProton2 = iAntiProton1 + 1;
-          auto i1 = std::distance(antiprotons.begin(), iAntiProton1);
-          for (; iAntiProton2 != antiprotons.end(); ++iAntiProton2) {
-            auto i2 = std::distance(antiprotons.begin(), iAntiProton2);
-            for (auto iAntiLambda1 = antilambdas.begin(); iAntiLambda1 != antilambdas.end(); ++iAntiLambda1) {
-              auto i3 = std::distance(antilambdas.begin(), iAntiLambda1);
-              if (ConfAutocorRejection.value &&
-                  (AntiProtonIndex.at(i1) == AntiLambdaNegDaughIndex.at(i3) ||
-                   AntiProtonIndex.at(i2) == AntiLambdaNegDaughIndex.at(i3))) {
-                continue;
-              }
-              Q3 = getQ3(*iAntiProton1, *iAntiProton2, *iAntiLambda1);
-              registry.fill(HIST("ppl/fSE_antiparticle"), Q3);
-              if (Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPPL)) {
-                lowQ3Triplets[CFTrigger::kPPL] += 1;
-              }
-            }
+          Q3 = getQ3(protons[i1], protons[i2], lambdas[i3]);
+          registry.fill(HIST("ppl/fSE_particle"), Q3);
+          if (Q3 < q3Limit) {
+            lowQ3Triplets[CFTrigger::kPPL] += 1;
           }
-        }
+        });
+        prunedCombinations[CFTrigger::kPPL] += femtoKernel.forEachTriplet(antiprotons, antilambdas, q3Limit, [&](std::size_t i1, std::size_t i2, std::size_t i3) {
+          if (ConfAutocorRejection.value &&
+              (AntiProtonIndex.at(i1) == AntiLambdaNegDaughIndex.at(i3) ||
+               AntiProtonIndex.at(i2) == AntiLambdaNegDaughIndex.at(i3))) {
+            return;
+          }
+          Q3 = getQ3(antiprotons[i1], antiprotons[i2], antilambdas[i3]);
+          registry.fill(HIST("ppl/fSE_antiparticle"), Q3);
+          if (Q3 < q3Limit) {
+            lowQ3Triplets[CFTrigger::kPPL] += 1;
+          }
+        });
       }
       if (ConfTriggerSwitches->get("Switch", "pLL") > 0.) {
         // pll trigger
-        for (auto iLambda1 = lambdas.begin(); iLambda1 != lambdas.end(); ++iLambda1) {
-          auto iLambda2 = iLambda1 + 1;
-          auto i1 = std::distance(lambdas.begin(), iLambda1);
-          for (; iLambda2 != lambdas.end(); ++iLambda2) {
-            auto i2 = std::distance(lambdas.begin(), iLambda2);
-            if (ConfAutocorRejection.value &&
-                (LambdaPosDaughIndex.at(i1) == LambdaPosDaughIndex.at(i2) ||
-                 LambdaNegDaughIndex.at(i1) == LambdaNegDaughIndex.at(i2))) {
-              continue;
-            }
-            for (auto iProton1 = protons.begin(); iProton1 != protons.end(); ++iProton1) {
-              auto i3 = std::distance(protons.begin(), iProton1);
-              if (ConfAutocorRejection.value &&
-                  (LambdaPosDaughIndex.at(i1) == ProtonIndex.at(i3) ||
-                   LambdaPosDaughIndex.at(i2) == ProtonIndex.at(i3))) {
-                continue;
-              }
-              Q3 = getQ3(*iLambda1, *iLambda2, *iProton1);
-              registry.fill(HIST("pll/fSE_particle"), Q3);
-              if (Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPLL)) {
-                lowQ3Triplets[CFTrigger::kPLL] += 1;
-              }
-            }
+        const float q3Limit = ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPLL);
+        prunedCombinations[CFTrigger::kPLL] += femtoKernel.forEachTriplet(lambdas, protons, q3Limit, [&](std::size_t i1, std::size_t i2, std::size_t i3) {
+          if (ConfAutocorRejection.value &&
+              (LambdaPosDaughIndex.at(i1) == LambdaPosDaughIndex.at(i2) ||
+               LambdaNegDaughIndex.at(i1) == LambdaNegDaughIndex.at(i2) ||
+               LambdaPosDaughIndex.at(i1) == ProtonIndex.at(i3) ||
+               LambdaPosDaughIndex.at(i2) == ProtonIndex.at(i3))) {
+            return;
           }
-        }
-        for (auto iAntiLambda1 = antilambdas.begin(); iAntiLambda1 != antilambdas.end(); ++iAntiLambda1) {
-          auto iAntiLambda2 = iAntiLambda1 + 1;
-          auto i1 = std::distance(antilambdas.begin(), iAntiLambda1);
-          for (; iAntiLambda2 != antilambdas.end(); ++iAntiLambda2) {
-            auto i2 = std::distance(antilambdas.begin(), iAntiLambda2);
-            if (ConfAutocorRejection.value &&
-                (AntiLambdaPosDaughIndex.at(i1) == AntiLambdaPosDaughIndex.at(i2) ||
-                 AntiLambdaNegDaughIndex.at(i1) == AntiLambdaNegDaughIndex.at(i2))) {
-              continue;
-            }
-            for (auto iAntiProton1 = antiprotons.begin(); iAntiProton1 != antiprotons.end(); ++iAntiProton1) {
-              auto i3 = std::distance(antiprotons.begin(), iAntiProton1);
-              if (ConfAutocorRejection.value &&
-                  (AntiLambdaNegDaughIndex.at(i1) == AntiProtonIndex.at(i3) ||
-                   AntiLambdaNegDaughIndex.at(i2) == AntiProtonIndex.at(i3))) {
-                continue;
-              }
-              Q3 = getQ3(*iAntiLambda1, *iAntiLambda2, *iAntiProton1);
-              registry.fill(HIST("pll/fSE_antiparticle"), Q3);
-              if (Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPLL)) {
-                lowQ3Triplets[CFTrigger::kPLL] += 1;
-              }
-            }
+          Q3 = getQ3(lambdas[i1], lambdas[i2], protons[i3]);
+          registry.fill(HIST("pll/fSE_particle"), Q3);
+          if (Q3 < q3Limit) {
+            lowQ3Triplets[CFTrigger::kPLL] += 1;
           }
-        }
+        });
+        prunedCombinations[CFTrigger::kPLL] += femtoKernel.forEachTriplet(antilambdas, antiprotons, q3Limit, [&](std::size_t i1, std::size_t i2, std::size_t i3) {
+          if (ConfAutocorRejection.value &&
+              (AntiLambdaPosDaughIndex.at(i1) == AntiLambdaPosDaughIndex.at(i2) ||
+               AntiLambdaNegDaughIndex.at(i1) == AntiLambdaNegDaughIndex.at(i2) ||
+               AntiLambdaNegDaughIndex.at(i1) == AntiProtonIndex.at(i3) ||
+               AntiLambdaNegDaughIndex.at(i2) == AntiProtonIndex.at(i3))) {
+            return;
+          }
+          Q3 = getQ3(antilambdas[i1], antilambdas[i2], antiprotons[i3]);
+          registry.fill(HIST("pll/fSE_antiparticle"), Q3);
+          if (Q3 < q3Limit) {
+            lowQ3Triplets[CFTrigger::kPLL] += 1;
+          }
+        });
       }
       if (ConfTriggerSwitches->get("Switch", "LLL") > 0.) {
         // lll trigger
-        for (auto iLambda1 = lambdas.begin(); iLambda1 != lambdas.end(); ++iLambda1) {
-          auto iLambda2 = iLambda1 + 1;
-          auto i1 = std::distance(lambdas.begin(), iLambda1);
-          for (; iLambda2 != lambdas.end(); ++iLambda2) {
-            auto i2 = std::distance(lambdas.begin(), iLambda2);
-            if (ConfAutocorRejection.value &&
-                (LambdaPosDaughIndex.at(i1) == LambdaPosDaughIndex.at(i2) ||
-                 LambdaNegDaughIndex.at(i1) == LambdaNegDaughIndex.at(i2))) {
-              continue;
-            }
-            auto iLambda3 = iLambda2 + 1;
-            for (; iLambda3 != lambdas.end(); ++iLambda3) {
-              auto i3 = std::distance(lambdas.begin(), iLambda3);
-              if (ConfAutocorRejection.value &&
-                  (LambdaPosDaughIndex.at(i1) == LambdaPosDaughIndex.at(i3) ||
-                   LambdaNegDaughIndex.at(i1) == LambdaNegDaughIndex.at(i3) ||
-                   LambdaPosDaughIndex.at(i2) == LambdaPosDaughIndex.at(i3) ||
-                   LambdaNegDaughIndex.at(i2) == LambdaNegDaughIndex.at(i3))) {
-                continue;
-              }
-              Q3 = getQ3(*iLambda1, *iLambda2, *iLambda3);
-              registry.fill(HIST("lll/fSE_particle"), Q3);
-              if (Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kLLL)) {
-                lowQ3Triplets[CFTrigger::kLLL] += 1;
-              }
-            }
+        const float q3Limit = ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kLLL);
+        prunedCombinations[CFTrigger::kLLL] += femtoKernel.forEachTriplet(lambdas, q3Limit, [&](std::size_t i1, std::size_t i2, std::size_t i3) {
+          if (ConfAutocorRejection.value &&
+              (LambdaPosDaughIndex.at(i1) == LambdaPosDaughIndex.at(i2) ||
+               LambdaNegDaughIndex.at(i1) == LambdaNegDaughIndex.at(i2) ||
+               LambdaPosDaughIndex.at(i1) == LambdaPosDaughIndex.at(i3) ||
+               LambdaNegDaughIndex.at(i1) == LambdaNegDaughIndex.at(i3) ||
+               LambdaPosDaughIndex.at(i2) == LambdaPosDaughIndex.at(i3) ||
+               LambdaNegDaughIndex.at(i2) == LambdaNegDaughIndex.at(i3))) {
+            return;
           }
-        }
-        for (auto iAntiLambda1 = antilambdas.begin(); iAntiLambda1 != antilambdas.end(); ++iAntiLambda1) {
-          auto iAntiLambda2 = iAntiLambda1 + 1;
-          auto i1 = std::distance(antilambdas.begin(), iAntiLambda1);
-          for (; iAntiLambda2 != antilambdas.end(); ++iAntiLambda2) {
-            auto i2 = std::distance(antilambdas.begin(), iAntiLambda2);
-            if (ConfAutocorRejection.value &&
-                (AntiLambdaPosDaughIndex.at(i1) == AntiLambdaPosDaughIndex.at(i2) ||
-                 AntiLambdaNegDaughIndex.at(i1) == AntiLambdaNegDaughIndex.at(i2))) {
-              continue;
-            }
-            auto iAntiLambda3 = iAntiLambda2 + 1;
-            for (; iAntiLambda3 != antilambdas.end(); ++iAntiLambda3) {
-              auto i3 = std::distance(antilambdas.begin(), iAntiLambda3);
-              if (ConfAutocorRejection.value &&
-                  (AntiLambdaPosDaughIndex.at(i1) == AntiLambdaPosDaughIndex.at(i3) ||
-                   AntiLambdaNegDaughIndex.at(i1) == AntiLambdaNegDaughIndex.at(i3) ||
-                   AntiLambdaPosDaughIndex.at(i2) == AntiLambdaPosDaughIndex.at(i3) ||
-                   AntiLambdaNegDaughIndex.at(i2) == AntiLambdaNegDaughIndex.at(i3))) {
-                continue;
-              }
-              Q3 = getQ3(*iAntiLambda1, *iAntiLambda2, *iAntiLambda3);
-              registry.fill(HIST("lll/fSE_antiparticle"), Q3);
-              if (Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kLLL)) {
-                lowQ3Triplets[CFTrigger::kLLL] += 1;
-              }
-            }
+          Q3 = getQ3(lambdas[i1], lambdas[i2], lambdas[i3]);
+          registry.fill(HIST("lll/fSE_particle"), Q3);
+          if (Q3 < q3Limit) {
+            lowQ3Triplets[CFTrigger::kLLL] += 1;
           }
-        }
+        });
+        prunedCombinations[CFTrigger::kLLL] += femtoKernel.forEachTriplet(antilambdas, q3Limit, [&](std::size_t i1, std::size_t i2, std::size_t i3) {
+          if (ConfAutocorRejection.value &&
+              (AntiLambdaPosDaughIndex.at(i1) == AntiLambdaPosDaughIndex.at(i2) ||
+               AntiLambdaNegDaughIndex.at(i1) == AntiLambdaNegDaughIndex.at(i2) ||
+               AntiLambdaPosDaughIndex.at(i1) == AntiLambdaPosDaughIndex.at(i3) ||
+               AntiLambdaNegDaughIndex.at(i1) == AntiLambdaNegDaughIndex.at(i3) ||
+               AntiLambdaPosDaughIndex.at(i2) == AntiLambdaPosDaughIndex.at(i3) ||
+               AntiLambdaNegDaughIndex.at(i2) == AntiLambdaNegDaughIndex.at(i3))) {
+            return;
+          }
+          Q3 = getQ3(antilambdas[i1], antilambdas[i2], antilambdas[i3]);
+          registry.fill(HIST("lll/fSE_antiparticle"), Q3);
+          if (Q3 < q3Limit) {
+            lowQ3Triplets[CFTrigger::kLLL] += 1;
+          }
+        });
       }
       if (ConfTriggerSwitches->get("Switch", "pd") > 0.) {
         // pd trigger
-        for (auto iProton = protons.begin(); iProton != protons.end(); ++iProton) {
-          for (auto iDeuteron = deuterons.begin(); iDeuteron != deuterons.end(); ++iDeuteron) {
-            kstar = getkstar(*iProton, *iDeuteron);
-            registry.fill(HIST("pd/fSE_particle"), kstar);
-            if (kstar < ConfKstarLimits->get(static_cast<uint>(0), CFTrigger::kPD)) {
-              lowKstarPairs[CFTrigger::kPD] += 1;
-            }
+        const float kstarLimit = ConfKstarLimits->get(static_cast<uint>(0), CFTrigger::kPD);
+        prunedCombinations[CFTrigger::kNThreeBodyTriggers + CFTrigger::kPD] += femtoKernel.forEachPair(protons, deuterons, kstarLimit, [&](std::size_t i1, std::size_t i2) {
+          kstar = getkstar(protons[i1], deuterons[i2]);
+          registry.fill(HIST("pd/fSE_particle"), kstar);
+          if (kstar < kstarLimit) {
+            lowKstarPairs[CFTrigger::kPD] += 1;
           }
-        }
-        for (auto iAntiProton = antiprotons.begin(); iAntiProton != antiprotons.end(); ++iAntiProton) {
-          for (auto iAntiDeuteron = antideuterons.begin(); iAntiDeuteron != antideuterons.end(); ++iAntiDeuteron) {
-            kstar = getkstar(*iAntiProton, *iAntiDeuteron);
-            registry.fill(HIST("pd/fSE_antiparticle"), kstar);
-            if (kstar < ConfKstarLimits->get(static_cast<uint>(0), CFTrigger::kPD)) {
-              lowKstarPairs[CFTrigger::kPD] += 1;
-            }
+        });
+        prunedCombinations[CFTrigger::kNThreeBodyTriggers + CFTrigger::kPD] += femtoKernel.forEachPair(antiprotons, antideuterons, kstarLimit, [&](std::size_t i1, std::size_t i2) {
+          kstar = getkstar(antiprotons[i1], antideuterons[i2]);
+          registry.fill(HIST("pd/fSE_antiparticle"), kstar);
+          if (kstar < kstarLimit) {
+            lowKstarPairs[CFTrigger::kPD] += 1;
           }
-        }
+        });
       }
       if (ConfTriggerSwitches->get("Switch", "Ld") > 0.) {
         // ld trigger
-        for (auto iDeuteron = deuterons.begin(); iDeuteron != deuterons.end(); ++iDeuteron) {
-          for (auto iLambda = lambdas.begin(); iLambda != lambdas.end(); ++iLambda) {
-            kstar = getkstar(*iDeuteron, *iLambda);
-            registry.fill(HIST("ld/fSE_particle"), kstar);
-            if (kstar < ConfKstarLimits->get(static_cast<uint>(0), CFTrigger::kLD)) {
-              lowKstarPairs[CFTrigger::kLD] += 1;
-            }
+        const float kstarLimit = ConfKstarLimits->get(static_cast<uint>(0), CFTrigger::kLD);
+        prunedCombinations[CFTrigger::kNThreeBodyTriggers + CFTrigger::kLD] += femtoKernel.forEachPair(deuterons, lambdas, kstarLimit, [&](std::size_t i1, std::size_t i2) {
+          kstar = getkstar(deuterons[i1], lambdas[i2]);
+          registry.fill(HIST("ld/fSE_particle"), kstar);
+          if (kstar < kstarLimit) {
+            lowKstarPairs[CFTrigger::kLD] += 1;
           }
-        }
-        for (auto iAntiDeuteron = antideuterons.begin(); iAntiDeuteron != antideuterons.end(); ++iAntiDeuteron) {
-          for (auto iAntiLambda = antilambdas.begin(); iAntiLambda != antilambdas.end(); ++iAntiLambda) {
-            kstar = getkstar(*iAntiDeuteron, *iAntiLambda);
-            registry.fill(HIST("ld/fSE_antiparticle"), kstar);
-            if (kstar < ConfKstarLimits->get(static_cast<uint>(0), CFTrigger::kLD)) {
-              lowKstarPairs[CFTrigger::kLD] += 1;
-            }
+        });
+        prunedCombinations[CFTrigger::kNThreeBodyTriggers + CFTrigger::kLD] += femtoKernel.forEachPair(antideuterons, antilambdas, kstarLimit, [&](std::size_t i1, std::size_t i2) {
+          kstar = getkstar(antideuterons[i1], antilambdas[i2]);
+          registry.fill(HIST("ld/fSE_antiparticle"), kstar);
+          if (kstar < kstarLimit) {
+            lowKstarPairs[CFTrigger::kLD] += 1;
           }
-        }
+        });
       }
 
+      for (int iTrigger = 0; iTrigger < CFTrigger::nAllTriggers; iTrigger++) {
+        registry.fill(HIST("fPrunedCombinations"), iTrigger, static_cast<double>(prunedCombinations[iTrigger]));
+      }
     } // if(isSelectedEvent)
 
     // create tags for three body triggers
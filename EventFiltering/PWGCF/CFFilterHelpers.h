@@ -0,0 +1,234 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file CFFilterHelpers.h
+/// \brief Loops over the pairs and triplets of the femtoscopic triggers, with pruning of the combinations above the limits
+
+#ifndef EVENTFILTERING_PWGCF_CFFILTERHELPERS_H_
+#define EVENTFILTERING_PWGCF_CFFILTERHELPERS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include <Math/Vector4D.h>
+
+namespace CFTrigger
+{
+
+/// \brief Loops over the pairs and triplets of particles, skipping the combinations whose k* or Q3 is provably above the trigger limit
+///
+/// With zeta = asinh(p/m), E1 E2 - p1.p2 >= E1 E2 - |p1||p2| = m1 m2 cosh(zeta1 - zeta2), hence the invariant mass squared of a pair
+/// is s >= m1^2 + m2^2 + 2 m1 m2 cosh(zeta1 - zeta2). Since k* increases with s, k* >= m1 m2 sinh|zeta1 - zeta2| / sqrt(s_min),
+/// which increases with |zeta1 - zeta2| and with the masses, and Q3 = 2 sqrt(k*12^2 + k*23^2 + k*31^2).
+/// The particles of each species are sorted by zeta with sortParticles(), so that the particles which can form a combination below
+/// the limit with a given one lie in a zeta window, and the loops stop at the edges of the window.
+/// With the pruning disabled, all the combinations are passed to the callbacks.
+class FemtoCombinationKernel
+{
+ public:
+  using Vector = ROOT::Math::PtEtaPhiMVector;
+
+  /// \param usePruning enables the pruning of the combinations
+  void setPruning(bool usePruning) { mUsePruning = usePruning; }
+
+  /// Sorts the particles of a species by zeta, the vectors of indices attached to the particles are reordered accordingly
+  template <typename... TIndices>
+  void sortParticles(std::vector<Vector>& particles, TIndices&... indices)
+  {
+    if (!mUsePruning || particles.size() < 2) {
+      return;
+    }
+    fillZetas(particles, mZetas1);
+    mOrder.resize(particles.size());
+    std::iota(mOrder.begin(), mOrder.end(), 0);
+    std::sort(mOrder.begin(), mOrder.end(), [this](const std::size_t& i1, const std::size_t& i2) { return mZetas1[i1] < mZetas1[i2]; });
+    reorder(particles);
+    (reorder(indices), ...);
+  }
+
+  /// Calls process(i1, i2) for the pairs of particles of two species which can have a k* below the limit
+  /// \return the number of pruned pairs
+  template <typename TProcess>
+  int64_t forEachPair(const std::vector<Vector>& particles1, const std::vector<Vector>& particles2, float kstarLimit, TProcess process)
+  {
+    const auto nParticles1 = particles1.size();
+    const auto nParticles2 = particles2.size();
+    if (nParticles1 == 0 || nParticles2 == 0) {
+      return 0;
+    }
+    fillZetas(particles1, mZetas1);
+    fillZetas(particles2, mZetas2);
+    const float deltaZetaMax = getDeltaZetaMax(kstarLimit, getMinMass(particles1), getMinMass(particles2));
+
+    int64_t nEvaluated = 0;
+    std::size_t first2 = 0;
+    for (std::size_t i1 = 0; i1 < nParticles1; ++i1) {
+      while (first2 < nParticles2 && mZetas2[first2] < mZetas1[i1] - deltaZetaMax) {
+        ++first2;
+      }
+      for (auto i2 = first2; i2 < nParticles2 && mZetas2[i2] <= mZetas1[i1] + deltaZetaMax; ++i2) {
+        ++nEvaluated;
+        process(i1, i2);
+      }
+    }
+    return static_cast<int64_t>(nParticles1 * nParticles2) - nEvaluated;
+  }
+
+  /// Calls process(i1, i2, i3), with i1 < i2 < i3, for the triplets of particles of one species which can have a Q3 below the limit
+  /// \return the number of pruned triplets
+  template <typename TProcess>
+  int64_t forEachTriplet(const std::vector<Vector>& particles, float q3Limit, TProcess process)
+  {
+    const auto nParticles = particles.size();
+    if (nParticles < 3) {
+      return 0;
+    }
+    fillZetas(particles, mZetas1);
+    const float mass = getMinMass(particles);
+    const float deltaZetaMax = getDeltaZetaMax(0.5f * q3Limit, mass, mass);
+    const float sumKstar2Max = getSumKstar2Max(q3Limit);
+
+    int64_t nEvaluated = 0;
+    for (std::size_t i1 = 0; i1 < nParticles; ++i1) {
+      for (auto i2 = i1 + 1; i2 < nParticles && mZetas1[i2] - mZetas1[i1] <= deltaZetaMax; ++i2) {
+        const float kstar2Min12 = getKstar2Min(mZetas1[i2] - mZetas1[i1], mass, mass);
+        for (auto i3 = i2 + 1; i3 < nParticles && mZetas1[i3] - mZetas1[i1] <= deltaZetaMax; ++i3) {
+          // the bound increases with i3
+          if (kstar2Min12 + getKstar2Min(mZetas1[i3] - mZetas1[i1], mass, mass) + getKstar2Min(mZetas1[i3] - mZetas1[i2], mass, mass) > sumKstar2Max) {
+            break;
+          }
+          ++nEvaluated;
+          process(i1, i2, i3);
+        }
+      }
+    }
+    return static_cast<int64_t>(nParticles * (nParticles - 1) * (nParticles - 2) / 6) - nEvaluated;
+  }
+
+  /// Calls process(i1, i2, i3), with i1 < i2 indices of particles and i3 index of others, for the triplets made of two particles
+  /// of one species and one particle of another species which can have a Q3 below the limit
+  /// \return the number of pruned triplets
+  template <typename TProcess>
+  int64_t forEachTriplet(const std::vector<Vector>& particles, const std::vector<Vector>& others, float q3Limit, TProcess process)
+  {
+    const auto nParticles = particles.size();
+    const auto nOthers = others.size();
+    if (nParticles < 2 || nOthers == 0) {
+      return 0;
+    }
+    fillZetas(particles, mZetas1);
+    fillZetas(others, mZetas2);
+    const float mass = getMinMass(particles);
+    const float massOther = getMinMass(others);
+    const float deltaZetaMax = getDeltaZetaMax(0.5f * q3Limit, mass, mass);
+    const float deltaZetaMaxOther = getDeltaZetaMax(0.5f * q3Limit, mass, massOther);
+    const float sumKstar2Max = getSumKstar2Max(q3Limit);
+
+    int64_t nEvaluated = 0;
+    for (std::size_t i1 = 0; i1 < nParticles; ++i1) {
+      for (auto i2 = i1 + 1; i2 < nParticles && mZetas1[i2] - mZetas1[i1] <= deltaZetaMax; ++i2) {
+        const float kstar2Min12 = getKstar2Min(mZetas1[i2] - mZetas1[i1], mass, mass);
+        // the other particle has to be in the windows of both particles
+        auto i3 = static_cast<std::size_t>(std::lower_bound(mZetas2.begin(), mZetas2.end(), mZetas1[i2] - deltaZetaMaxOther) - mZetas2.begin());
+        for (; i3 < nOthers && mZetas2[i3] <= mZetas1[i1] + deltaZetaMaxOther; ++i3) {
+          if (kstar2Min12 + getKstar2Min(mZetas2[i3] - mZetas1[i1], mass, massOther) + getKstar2Min(mZetas2[i3] - mZetas1[i2], mass, massOther) > sumKstar2Max) {
+            continue;
+          }
+          ++nEvaluated;
+          process(i1, i2, i3);
+        }
+      }
+    }
+    return static_cast<int64_t>(nParticles * (nParticles - 1) / 2 * nOthers) - nEvaluated;
+  }
+
+  /// \return the lower bound of k* for a pair with a given zeta difference
+  static float getKstarMin(float deltaZeta, float mass1, float mass2)
+  {
+    const float s = mass1 * mass1 + mass2 * mass2 + 2.f * mass1 * mass2 * std::cosh(deltaZeta);
+    return mass1 * mass2 * std::sinh(std::abs(deltaZeta)) / std::sqrt(s);
+  }
+
+ private:
+  static constexpr float kRelativeTolerance = 1.e-3f; // relative margin on the limits, covering the rounding of k* and Q3 in single precision
+
+  /// \return the largest zeta difference of a pair which can have a k* below the limit
+  float getDeltaZetaMax(float kstarLimit, float mass1, float mass2) const
+  {
+    if (!mUsePruning) {
+      return std::numeric_limits<float>::max();
+    }
+    const float kstar = kstarLimit * (1.f + kRelativeTolerance);
+    const float sqrtS = std::sqrt(mass1 * mass1 + kstar * kstar) + std::sqrt(mass2 * mass2 + kstar * kstar);
+    const float coshDeltaZeta = (sqrtS * sqrtS - mass1 * mass1 - mass2 * mass2) / (2.f * mass1 * mass2);
+    return std::acosh(std::max(coshDeltaZeta, 1.f));
+  }
+
+  /// \return the largest sum of the k*^2 of the three pairs of a triplet which can have a Q3 below the limit
+  float getSumKstar2Max(float q3Limit) const
+  {
+    if (!mUsePruning) {
+      return std::numeric_limits<float>::max();
+    }
+    const float q3 = q3Limit * (1.f + kRelativeTolerance);
+    return 0.25f * q3 * q3;
+  }
+
+  float getKstar2Min(float deltaZeta, float mass1, float mass2) const
+  {
+    if (!mUsePruning) {
+      return 0.f;
+    }
+    const float kstar = getKstarMin(deltaZeta, mass1, mass2);
+    return kstar * kstar;
+  }
+
+  static float getMinMass(const std::vector<Vector>& particles)
+  {
+    float mass = std::numeric_limits<float>::max();
+    for (const auto& particle : particles) {
+      mass = std::min(mass, static_cast<float>(particle.M()));
+    }
+    return mass;
+  }
+
+  static void fillZetas(const std::vector<Vector>& particles, std::vector<float>& zetas)
+  {
+    zetas.resize(particles.size());
+    for (std::size_t i = 0; i < particles.size(); ++i) {
+      zetas[i] = std::asinh(particles[i].P() / particles[i].M());
+    }
+  }
+
+  template <typename T>
+  void reorder(std::vector<T>& values)
+  {
+    std::vector<T> sorted;
+    sorted.reserve(values.size());
+    for (const auto& i : mOrder) {
+      sorted.push_back(values[i]);
+    }
+    values.swap(sorted);
+  }
+
+  bool mUsePruning = true;           // skip the combinations above the limits
+  std::vector<std::size_t> mOrder{}; // order of the particles by zeta
+  std::vector<float> mZetas1{};      // zetas of the first species of the current loop
+  std::vector<float> mZetas2{};      // zetas of the second species of the current loop
+};
+
+} // namespace CFTrigger
+
+#endif // EVENTFILTERING_PWGCF_CFFILTERHELPERS_H_
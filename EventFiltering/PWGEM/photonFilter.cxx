@@ -10,6 +10,8 @@
 // or submit itself to any jurisdiction.
 // O2 includes
 
+#include <vector>
+
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
@@ -31,6 +33,18 @@ struct photonFilter {
                kEl,
                kPair,
                kNbar };
+  // selections passed by a cluster, evaluated once per cluster
+  enum cluBits : uint8_t { kCluPhot = 1 << 0,
+                           kCluEl = 1 << 1,
+                           kCluNbar = 1 << 2,
+                           kCluPairCharged = 1 << 3,
+                           kCluPairNeutral = 1 << 4 };
+
+  // cluster kinematics for the pair trigger
+  struct CluKine {
+    int index; // position of the cluster in the collision
+    float e, px, py, pz;
+  };
 
   Produces<aod::PhotFilters> tags;
 
@@ -41,6 +55,10 @@ struct photonFilter {
 
   HistogramRegistry mHistManager{"events", {}, OutputObjHandlingPolicy::AnalysisObject, true, true};
 
+  // clusters entering the pair trigger, kept between the collisions to avoid reallocations
+  std::vector<CluKine> mPairCharged;
+  std::vector<CluKine> mPairNeutral;
+
   void init(o2::framework::InitContext&)
   {
     auto scalers{std::get<std::shared_ptr<TH1>>(mHistManager.add("fProcessedEvents", "Number of filtered events", HistType::kTH1F, {{8, -0.5, 7.5}}))};
@@ -69,37 +87,56 @@ struct photonFilter {
     // PHOS part
     int nPHOSclu = 0;
     int nPHOSnbar = 0;
+    uint8_t cluSelected = 0;
+    mPairCharged.clear();
+    mPairNeutral.clear();
     for (const auto& clu : clusters) {
-      nPHOSclu++;
-
-      // Scan current cluster
+      // Scan current cluster, all selections at once
+      uint8_t bits = 0;
       //  photons
-      keepEvent[kPhot] |= (clu.e() > ePhot);
+      if (clu.e() > ePhot) {
+        bits |= kCluPhot;
+      }
       // charged clusters above threshold
-      keepEvent[kEl] |= (clu.trackdist() < 2. && clu.e() > eEl); // 2: Distance to CPV cluster in sigmas
+      if (clu.trackdist() < 2. && clu.e() > eEl) { // 2: Distance to CPV cluster in sigmas
+        bits |= kCluEl;
+      }
       // antineutrons
       if ((clu.ncell() > 2 && clu.m02() > 0.2 && clu.e() > 0.7 && clu.trackdist() > 2.) &&
           ((clu.e() < 2. && clu.m02() > 4.5 - clu.m20()) ||
            (clu.e() > 2. && clu.m02() > 4. - clu.m20()))) {
+        bits |= kCluNbar;
         nPHOSnbar++;
       }
-
-      // inv mass
-      if (clu.trackdist() < 1.) {
-        auto clu2 = clu;
-        ++clu2;
-        for (; !keepEvent[kPair] && clu2 != clusters.end(); clu2++) {
-          // cluster selections
-          if (clu2.trackdist() < 1.) { // select neutral clusters. Disp, Ncell cuts?
-            continue;
-          }
-          double m = pow(clu.e() + clu2.e(), 2) - pow(clu.px() + clu2.px(), 2) -
-                     pow(clu.py() + clu2.py(), 2) - pow(clu.pz() + clu2.pz(), 2);
-          if (m > ePair * ePair) {
-            keepEvent[kPair] |= true;
-            break;
-          }
+      // inv mass: clusters with trackdist < 1 are paired with the following clusters with trackdist >= 1
+      bits |= (clu.trackdist() < 1.) ? kCluPairCharged : kCluPairNeutral;
+      if (bits & kCluPairCharged) {
+        mPairCharged.push_back({nPHOSclu, clu.e(), clu.px(), clu.py(), clu.pz()});
+      } else if (!mPairCharged.empty()) { // a neutral cluster before all the charged ones is never paired
+        mPairNeutral.push_back({nPHOSclu, clu.e(), clu.px(), clu.py(), clu.pz()});
+      }
+      cluSelected |= bits;
+      nPHOSclu++;
+    }
+    keepEvent[kPhot] = cluSelected & kCluPhot;
+    keepEvent[kEl] = cluSelected & kCluEl;
+
+    // pairs, formed once per collision from the selected clusters
+    const double m2Min = ePair * ePair;
+    for (const auto& clu : mPairCharged) {
+      for (const auto& clu2 : mPairNeutral) {
+        if (clu2.index < clu.index) {
+          continue;
         }
+        double m = pow(clu.e + clu2.e, 2) - pow(clu.px + clu2.px, 2) -
+                   pow(clu.py + clu2.py, 2) - pow(clu.pz + clu2.pz, 2);
+        if (m > m2Min) {
+          keepEvent[kPair] = true;
+          break;
+        }
+      }
+      if (keepEvent[kPair]) {
+        break;
       }
     }
     keepEvent[kNbar] = (nPHOSnbar >= nNbar);
@@ -153,6 +153,19 @@ struct HfFilter { // Main struct for HF triggers
     Ort::Env{ORT_LOGGING_LEVEL_ERROR, "ml-model-xic-triggers"}};
   std::array<Ort::SessionOptions, kNCharmParticles> sessionOptions{Ort::SessionOptions(), Ort::SessionOptions(), Ort::SessionOptions(), Ort::SessionOptions(), Ort::SessionOptions()};
   std::array<int, kNCharmParticles> dataTypeML{};
+  std::array<bool, kNCharmParticles> isDynamicBatchML{}; // models accepting all the candidates of a collision in one tensor
+  std::array<std::string, kNCharmParticles> eTagML{};     // CCDB ETags of the loaded models, to reload them only if they change
+
+  // preselected candidates of a collision, with the inputs and outputs of the ML inference
+  std::vector<HfFilterCandidateProngs<2>> cands2ProngProngs{};
+  std::vector<int> cands2ProngPresel{};
+  std::vector<std::array<float, 3>> cands2ProngScores{};
+  std::vector<HfFilterCandidateProngs<3>> cands3ProngProngs{};
+  std::vector<std::array<int8_t, kNCharmParticles - 1>> cands3ProngPresel{};
+  std::array<std::vector<std::array<float, 3>>, kNCharmParticles - 1> cands3ProngScores{};
+  std::vector<float> inputFeaturesML{};
+  std::vector<double> inputFeaturesDoML{};
+  std::vector<int> indicesML{};
 
   // material correction for track propagation
   o2::base::MatLayerCylSet* lut;
@@ -243,7 +256,7 @@ struct HfFilter { // Main struct for HF triggers
     if (applyML && (!loadModelsFromCCDB || timestampCCDB != 0)) {
       for (auto iCharmPart{0}; iCharmPart < kNCharmParticles; ++iCharmPart) {
         if (onnxFiles[iCharmPart] != "") {
-          sessionML[iCharmPart].reset(InitONNXSession(onnxFiles[iCharmPart], charmParticleNames[iCharmPart], envML[iCharmPart], sessionOptions[iCharmPart], inputShapesML[iCharmPart], dataTypeML[iCharmPart], loadModelsFromCCDB, ccdbApi, mlModelPathCCDB.value, timestampCCDB));
+          initSessionML(iCharmPart, timestampCCDB);
         }
       }
     }
@@ -253,6 +266,38 @@ struct HfFilter { // Main struct for HF triggers
     }
   }
 
+  /// Creates the ONNX session of the model of a charm hadron species
+  /// \param iCharmPart is the index of the charm hadron species
+  /// \param timestamp is the timestamp used to query the model from CCDB
+  void initSessionML(int iCharmPart, int64_t timestamp)
+  {
+    sessionML[iCharmPart].reset(InitONNXSession(onnxFiles[iCharmPart], charmParticleNames[iCharmPart], envML[iCharmPart], sessionOptions[iCharmPart], inputShapesML[iCharmPart], dataTypeML[iCharmPart], loadModelsFromCCDB, ccdbApi, mlModelPathCCDB.value, timestamp));
+    isDynamicBatchML[iCharmPart] = sessionML[iCharmPart]->GetInputShapes()[0][0] < 0;
+  }
+
+  /// Scores the candidates of a charm hadron species at once
+  /// \param iCharmPart is the index of the charm hadron species
+  /// \param nCandidates is the number of candidates, whose input features are in inputFeaturesML (or inputFeaturesDoML)
+  /// \param scores are the output scores, filled at the positions in indicesML
+  void predictCandidatesML(int iCharmPart, int nCandidates, std::vector<std::array<float, 3>>& scores)
+  {
+    if (dataTypeML[iCharmPart] == 1) {
+      auto scoresCands = PredictONNXBatch(inputFeaturesML, nCandidates, sessionML[iCharmPart], inputShapesML[iCharmPart], isDynamicBatchML[iCharmPart]);
+      for (int iCand{0}; iCand < nCandidates; ++iCand) {
+        scores[indicesML[iCand]] = scoresCands[iCand];
+      }
+    } else if (dataTypeML[iCharmPart] == 11) {
+      auto scoresCands = PredictONNXBatch(inputFeaturesDoML, nCandidates, sessionML[iCharmPart], inputShapesML[iCharmPart], isDynamicBatchML[iCharmPart]);
+      for (int iCand{0}; iCand < nCandidates; ++iCand) {
+        for (int iScore{0}; iScore < 3; ++iScore) {
+          scores[indicesML[iCand]][iScore] = scoresCands[iCand][iScore];
+        }
+      }
+    } else {
+      LOG(fatal) << "Error running model inference for " << charmParticleNames[iCharmPart].data() << ": Unexpected input data type.";
+    }
+  }
+
   using BigTracksMCPID = soa::Join<aod::Tracks, aod::TracksExtra, aod::TracksDCA, aod::pidTPCFullPi, aod::pidTOFFullPi, aod::pidTPCFullKa, aod::pidTOFFullKa, aod::pidTPCFullPr, aod::pidTOFFullPr, aod::McTrackLabels>;
   using BigTracksPID = soa::Join<aod::Tracks, aod::TracksExtra, aod::TracksDCA, aod::TrackSelection, aod::pidTPCFullPi, aod::pidTOFFullPi, aod::pidTPCFullKa, aod::pidTOFFullKa, aod::pidTPCFullPr, aod::pidTOFFullPr>;
 
@@ -260,17 +305,21 @@ struct HfFilter { // Main struct for HF triggers
   Preslice<aod::V0Datas> v0sPerCollision = aod::v0data::collisionId;
   Preslice<aod::Hf2Prongs> hf2ProngPerCollision = aod::track_association::collisionId;
   Preslice<aod::Hf3Prongs> hf3ProngPerCollision = aod::track_association::collisionId;
+  Preslice<aod::HfCand2Prong> cand2ProngPerCollision = aod::hf_cand::collisionId;
+  Preslice<aod::HfCand3Prong> cand3ProngPerCollision = aod::hf_cand::collisionId;
   Preslice<aod::CascDatas> cascPerCollision = aod::cascdata::collisionId;
 
-  void process(aod::Collisions const& collisions,
-               aod::BCsWithTimestamps const&,
-               aod::V0Datas const& theV0s,
-               aod::V0sLinked const& v0Links,
-               aod::CascDatas const& cascades,
-               aod::Hf2Prongs const& cand2Prongs,
-               aod::Hf3Prongs const& cand3Prongs,
-               aod::TrackAssoc const& trackIndices,
-               BigTracksPID const& tracks)
+  /// Trigger selections
+  /// \tparam useFittedCandidates selects whether the 2- and 3-prong candidates are HF candidates with fitted secondary vertex
+  ///         (the momenta of the prongs at the secondary vertex are then used) or the track indices of the HF skim
+  template <bool useFittedCandidates, typename TCand2Prongs, typename TCand3Prongs>
+  void runFilter(aod::Collisions const& collisions,
+                 aod::V0Datas const& theV0s,
+                 aod::CascDatas const& cascades,
+                 TCand2Prongs const& cand2Prongs,
+                 TCand3Prongs const& cand3Prongs,
+                 aod::TrackAssoc const& trackIndices,
+                 BigTracksPID const& tracks)
   {
     for (const auto& collision : collisions) {
       auto thisCollId = collision.globalIndex();
@@ -281,16 +330,22 @@ struct HfFilter { // Main struct for HF triggers
 
       auto bc = collision.template bc_as<aod::BCsWithTimestamps>();
 
-      if (applyML && (loadModelsFromCCDB && timestampCCDB == 0) && !sessionML[kD0]) {
-        for (auto iCharmPart{0}; iCharmPart < kNCharmParticles; ++iCharmPart) {
-          if (onnxFiles[iCharmPart] != "") {
-            sessionML[iCharmPart].reset(InitONNXSession(onnxFiles[iCharmPart], charmParticleNames[iCharmPart], envML[iCharmPart], sessionOptions[iCharmPart], inputShapesML[iCharmPart], dataTypeML[iCharmPart], loadModelsFromCCDB, ccdbApi, mlModelPathCCDB.value, bc.timestamp()));
+      if (currentRun != bc.runNumber()) {
+        // ML models valid for the run, the sessions are kept if the models did not change
+        if (applyML && (loadModelsFromCCDB && timestampCCDB == 0)) {
+          for (auto iCharmPart{0}; iCharmPart < kNCharmParticles; ++iCharmPart) {
+            if (onnxFiles[iCharmPart] != "") {
+              std::map<std::string, std::string> metadata;
+              auto headers = ccdbApi.retrieveHeaders(mlModelPathCCDB.value + charmParticleNames[iCharmPart], metadata, bc.timestamp());
+              if (!sessionML[iCharmPart] || headers["ETag"] != eTagML[iCharmPart]) {
+                initSessionML(iCharmPart, bc.timestamp());
+                eTagML[iCharmPart] = headers["ETag"];
+              }
+            }
           }
         }
-      }
 
-      // needed for track propagation
-      if (currentRun != bc.runNumber()) {
+        // needed for track propagation
         o2::parameters::GRPMagField* grpo = ccdb->getForTimeStamp<o2::parameters::GRPMagField>("GLO/Config/GRPMagField", bc.timestamp());
         o2::base::Propagator::initFieldFromGRP(grpo);
 
@@ -330,34 +385,84 @@ struct HfFilter { // Main struct for HF triggers
 
       std::vector<std::vector<int64_t>> indicesDau2Prong{};
 
-      auto cand2ProngsThisColl = cand2Prongs.sliceBy(hf2ProngPerCollision, thisCollId);
-      for (const auto& cand2Prong : cand2ProngsThisColl) {                                // start loop over 2 prongs
+      auto cand2ProngsThisColl = [&]() {
+        if constexpr (useFittedCandidates) {
+          return cand2Prongs.sliceBy(cand2ProngPerCollision, thisCollId);
+        } else {
+          return cand2Prongs.sliceBy(hf2ProngPerCollision, thisCollId);
+        }
+      }();
+
+      // preselections and prong quantities of the 2-prong candidates, needed to score all of them at once
+      const int nCand2Prongs = cand2ProngsThisColl.size();
+      cands2ProngProngs.resize(nCand2Prongs);
+      cands2ProngPresel.assign(nCand2Prongs, 0);
+      cands2ProngScores.assign(nCand2Prongs, std::array<float, 3>{-1., -1., -1.});
+      inputFeaturesML.clear();
+      inputFeaturesDoML.clear();
+      indicesML.clear();
+      int iCand2Prong{0};
+      for (const auto& cand2Prong : cand2ProngsThisColl) {                                // start preselection loop over 2 prongs
         if (!TESTBIT(cand2Prong.hfflag(), o2::aod::hf_cand_2prong::DecayType::D0ToPiK)) { // check if it's a D0
+          ++iCand2Prong;
           continue;
         }
 
-        auto trackPos = cand2Prong.prong0_as<BigTracksPID>(); // positive daughter
-        auto trackNeg = cand2Prong.prong1_as<BigTracksPID>(); // negative daughter
+        auto trackPos = cand2Prong.template prong0_as<BigTracksPID>(); // positive daughter
+        auto trackNeg = cand2Prong.template prong1_as<BigTracksPID>(); // negative daughter
 
-        auto preselD0 = isDzeroPreselected(trackPos, trackNeg, nSigmaPidCuts->get(0u, 1u), nSigmaPidCuts->get(1u, 1u), setTPCCalib, hMapPion, hBBPion, hBBKaon);
-        if (!preselD0) {
+        cands2ProngPresel[iCand2Prong] = isDzeroPreselected(trackPos, trackNeg, nSigmaPidCuts->get(0u, 1u), nSigmaPidCuts->get(1u, 1u), setTPCCalib, hMapPion, hBBPion, hBBKaon);
+        if (!cands2ProngPresel[iCand2Prong]) {
+          ++iCand2Prong;
           continue;
         }
 
-        auto trackParPos = getTrackPar(trackPos);
-        auto trackParNeg = getTrackPar(trackNeg);
-        o2::gpu::gpustd::array<float, 2> dcaPos{trackPos.dcaXY(), trackPos.dcaZ()};
-        o2::gpu::gpustd::array<float, 2> dcaNeg{trackNeg.dcaXY(), trackNeg.dcaZ()};
-        std::array<float, 3> pVecPos{trackPos.px(), trackPos.py(), trackPos.pz()};
-        std::array<float, 3> pVecNeg{trackNeg.px(), trackNeg.py(), trackNeg.pz()};
+        auto& prongs = cands2ProngProngs[iCand2Prong];
+        prongs.trackPar = {getTrackPar(trackPos), getTrackPar(trackNeg)};
+        prongs.dca = {o2::gpu::gpustd::array<float, 2>{trackPos.dcaXY(), trackPos.dcaZ()}, o2::gpu::gpustd::array<float, 2>{trackNeg.dcaXY(), trackNeg.dcaZ()}};
+        prongs.pVec = {std::array<float, 3>{trackPos.px(), trackPos.py(), trackPos.pz()}, std::array<float, 3>{trackNeg.px(), trackNeg.py(), trackNeg.pz()}};
         if (trackPos.collisionId() != thisCollId) {
-          o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParPos, 2.f, noMatCorr, &dcaPos);
-          getPxPyPz(trackParPos, pVecPos);
+          o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, prongs.trackPar[0], 2.f, noMatCorr, &prongs.dca[0]);
+          getPxPyPz(prongs.trackPar[0], prongs.pVec[0]);
         }
         if (trackNeg.collisionId() != thisCollId) {
-          o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParNeg, 2.f, noMatCorr, &dcaNeg);
-          getPxPyPz(trackParNeg, pVecNeg);
+          o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, prongs.trackPar[1], 2.f, noMatCorr, &prongs.dca[1]);
+          getPxPyPz(prongs.trackPar[1], prongs.pVec[1]);
         }
+        if constexpr (useFittedCandidates) {
+          prongs.pVec = {std::array<float, 3>{cand2Prong.pxProng0(), cand2Prong.pyProng0(), cand2Prong.pzProng0()}, std::array<float, 3>{cand2Prong.pxProng1(), cand2Prong.pyProng1(), cand2Prong.pzProng1()}};
+        }
+
+        if (applyML && onnxFiles[kD0] != "") {
+          // TODO: add more feature configurations
+          for (int iProng{0}; iProng < 2; ++iProng) {
+            std::array<float, 3> features{prongs.trackPar[iProng].getPt(), prongs.dca[iProng][0], prongs.dca[iProng][1]};
+            inputFeaturesML.insert(inputFeaturesML.end(), features.begin(), features.end());
+            inputFeaturesDoML.insert(inputFeaturesDoML.end(), features.begin(), features.end());
+          }
+          indicesML.push_back(iCand2Prong);
+        }
+        ++iCand2Prong;
+      } // end preselection loop over 2 prongs
+
+      // apply ML models to all the preselected candidates at once
+      if (!indicesML.empty()) {
+        predictCandidatesML(kD0, indicesML.size(), cands2ProngScores);
+      }
+
+      iCand2Prong = -1;
+      for (const auto& cand2Prong : cand2ProngsThisColl) { // start loop over 2 prongs
+        ++iCand2Prong;
+        auto preselD0 = cands2ProngPresel[iCand2Prong];
+        if (!preselD0) {
+          continue;
+        }
+
+        auto trackPos = cand2Prong.template prong0_as<BigTracksPID>(); // positive daughter
+        auto trackNeg = cand2Prong.template prong1_as<BigTracksPID>(); // negative daughter
+        const auto& prongs = cands2ProngProngs[iCand2Prong];
+        auto pVecPos = prongs.pVec[0];
+        auto pVecNeg = prongs.pVec[1];
 
         bool isCharmTagged{true}, isBeautyTagged{true};
 
@@ -368,24 +473,10 @@ struct HfFilter { // Main struct for HF triggers
           isCharmTagged = false;
           isBeautyTagged = false;
 
-          // TODO: add more feature configurations
-          std::vector<float> inputFeaturesD0{trackParPos.getPt(), dcaPos[0], dcaPos[1], trackParNeg.getPt(), dcaNeg[0], dcaNeg[1]};
-          std::vector<double> inputFeaturesDoD0{trackParPos.getPt(), dcaPos[0], dcaPos[1], trackParNeg.getPt(), dcaNeg[0], dcaNeg[1]};
-
-          if (dataTypeML[kD0] == 1) {
-            auto scores = PredictONNX(inputFeaturesD0, sessionML[kD0], inputShapesML[kD0]);
-            tagBDT = isBDTSelected(scores, thresholdBDTScores[kD0]);
-            for (int iScore{0}; iScore < 3; ++iScore) {
-              scoresToFill[iScore] = scores[iScore];
-            }
-          } else if (dataTypeML[kD0] == 11) {
-            auto scores = PredictONNX(inputFeaturesDoD0, sessionML[kD0], inputShapesML[kD0]);
-            tagBDT = isBDTSelected(scores, thresholdBDTScores[kD0]);
-            for (int iScore{0}; iScore < 3; ++iScore) {
-              scoresToFill[iScore] = scores[iScore];
-            }
-          } else {
-            LOG(fatal) << "Error running model inference for D0: Unexpected input data type.";
+          const auto& scores = cands2ProngScores[iCand2Prong];
+          tagBDT = isBDTSelected(scores, thresholdBDTScores[kD0]);
+          for (int iScore{0}; iScore < 3; ++iScore) {
+            scoresToFill[iScore] = scores[iScore];
           }
 
           if (applyML && activateQA > 1) {
@@ -624,48 +715,62 @@ struct HfFilter { // Main struct for HF triggers
       } // end loop over 2-prong candidates
 
       std::vector<std::vector<int64_t>> indicesDau3Prong{};
-      auto cand3ProngsThisColl = cand3Prongs.sliceBy(hf3ProngPerCollision, thisCollId);
-      for (const auto& cand3Prong : cand3ProngsThisColl) { // start loop over 3 prongs
+      auto cand3ProngsThisColl = [&]() {
+        if constexpr (useFittedCandidates) {
+          return cand3Prongs.sliceBy(cand3ProngPerCollision, thisCollId);
+        } else {
+          return cand3Prongs.sliceBy(hf3ProngPerCollision, thisCollId);
+        }
+      }();
+
+      // preselections and prong quantities of the 3-prong candidates, needed to score all of them at once
+      const int nCand3Prongs = cand3ProngsThisColl.size();
+      cands3ProngProngs.resize(nCand3Prongs);
+      cands3ProngPresel.assign(nCand3Prongs, std::array<int8_t, kNCharmParticles - 1>{0});
+      for (auto& scores : cands3ProngScores) {
+        scores.assign(nCand3Prongs, std::array<float, 3>{-1., -1., -1.});
+      }
+      int iCand3Prong{0};
+      for (const auto& cand3Prong : cand3ProngsThisColl) { // start preselection loop over 3 prongs
         std::array<int8_t, kNCharmParticles - 1> is3Prong = {
           TESTBIT(cand3Prong.hfflag(), o2::aod::hf_cand_3prong::DecayType::DplusToPiKPi),
           TESTBIT(cand3Prong.hfflag(), o2::aod::hf_cand_3prong::DecayType::DsToKKPi),
           TESTBIT(cand3Prong.hfflag(), o2::aod::hf_cand_3prong::DecayType::LcToPKPi),
           TESTBIT(cand3Prong.hfflag(), o2::aod::hf_cand_3prong::DecayType::XicToPKPi)};
         if (!std::accumulate(is3Prong.begin(), is3Prong.end(), 0)) { // check if it's a D+, Ds+, Lc+ or Xic+
+          ++iCand3Prong;
           continue;
         }
 
-        auto trackFirst = cand3Prong.prong0_as<BigTracksPID>();
-        auto trackSecond = cand3Prong.prong1_as<BigTracksPID>();
-        auto trackThird = cand3Prong.prong2_as<BigTracksPID>();
-
-        auto trackParFirst = getTrackPar(trackFirst);
-        auto trackParSecond = getTrackPar(trackSecond);
-        auto trackParThird = getTrackPar(trackThird);
-        o2::gpu::gpustd::array<float, 2> dcaFirst{trackFirst.dcaXY(), trackFirst.dcaZ()};
-        o2::gpu::gpustd::array<float, 2> dcaSecond{trackSecond.dcaXY(), trackSecond.dcaZ()};
-        o2::gpu::gpustd::array<float, 2> dcaThird{trackThird.dcaXY(), trackThird.dcaZ()};
-        std::array<float, 3> pVecFirst = {trackFirst.px(), trackFirst.py(), trackFirst.pz()};
-        std::array<float, 3> pVecSecond = {trackSecond.px(), trackSecond.py(), trackSecond.pz()};
-        std::array<float, 3> pVecThird = {trackThird.px(), trackThird.py(), trackThird.pz()};
+        auto trackFirst = cand3Prong.template prong0_as<BigTracksPID>();
+        auto trackSecond = cand3Prong.template prong1_as<BigTracksPID>();
+        auto trackThird = cand3Prong.template prong2_as<BigTracksPID>();
+
+        auto& prongs = cands3ProngProngs[iCand3Prong];
+        prongs.trackPar = {getTrackPar(trackFirst), getTrackPar(trackSecond), getTrackPar(trackThird)};
+        prongs.dca = {o2::gpu::gpustd::array<float, 2>{trackFirst.dcaXY(), trackFirst.dcaZ()}, o2::gpu::gpustd::array<float, 2>{trackSecond.dcaXY(), trackSecond.dcaZ()}, o2::gpu::gpustd::array<float, 2>{trackThird.dcaXY(), trackThird.dcaZ()}};
+        prongs.pVec = {std::array<float, 3>{trackFirst.px(), trackFirst.py(), trackFirst.pz()}, std::array<float, 3>{trackSecond.px(), trackSecond.py(), trackSecond.pz()}, std::array<float, 3>{trackThird.px(), trackThird.py(), trackThird.pz()}};
         if (trackFirst.collisionId() != thisCollId) {
-          o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParFirst, 2.f, noMatCorr, &dcaFirst);
-          getPxPyPz(trackParFirst, pVecFirst);
+          o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, prongs.trackPar[0], 2.f, noMatCorr, &prongs.dca[0]);
+          getPxPyPz(prongs.trackPar[0], prongs.pVec[0]);
         }
         if (trackSecond.collisionId() != thisCollId) {
-          o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParSecond, 2.f, noMatCorr, &dcaSecond);
-          getPxPyPz(trackParSecond, pVecSecond);
+          o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, prongs.trackPar[1], 2.f, noMatCorr, &prongs.dca[1]);
+          getPxPyPz(prongs.trackPar[1], prongs.pVec[1]);
         }
         if (trackThird.collisionId() != thisCollId) {
-          o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParThird, 2.f, noMatCorr, &dcaThird);
-          getPxPyPz(trackParThird, pVecThird);
+          o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, prongs.trackPar[2], 2.f, noMatCorr, &prongs.dca[2]);
+          getPxPyPz(prongs.trackPar[2], prongs.pVec[2]);
+        }
+        if constexpr (useFittedCandidates) {
+          prongs.pVec = {std::array<float, 3>{cand3Prong.pxProng0(), cand3Prong.pyProng0(), cand3Prong.pzProng0()}, std::array<float, 3>{cand3Prong.pxProng1(), cand3Prong.pyProng1(), cand3Prong.pzProng1()}, std::array<float, 3>{cand3Prong.pxProng2(), cand3Prong.pyProng2(), cand3Prong.pzProng2()}};
         }
 
         if (is3Prong[0]) { // D+ preselections
           is3Prong[0] = isDplusPreselected(trackSecond, nSigmaPidCuts->get(0u, 2u), nSigmaPidCuts->get(1u, 2u), setTPCCalib, hMapPion, hBBKaon);
         }
         if (is3Prong[1]) { // Ds preselections
-          is3Prong[1] = isDsPreselected(pVecFirst, pVecThird, pVecSecond, trackSecond, nSigmaPidCuts->get(0u, 2u), nSigmaPidCuts->get(1u, 2u), setTPCCalib, hMapPion, hBBKaon);
+          is3Prong[1] = isDsPreselected(prongs.pVec[0], prongs.pVec[2], prongs.pVec[1], trackSecond, nSigmaPidCuts->get(0u, 2u), nSigmaPidCuts->get(1u, 2u), setTPCCalib, hMapPion, hBBKaon);
         }
         if (is3Prong[2] || is3Prong[3]) { // charm baryon preselections
           auto presel = isCharmBaryonPreselected(trackFirst, trackThird, trackSecond, nSigmaPidCuts->get(0u, 0u), nSigmaPidCuts->get(1u, 0u), nSigmaPidCuts->get(0u, 2u), nSigmaPidCuts->get(1u, 2u), setTPCCalib, hMapProton, hBBProton, hMapPion, hBBKaon);
@@ -676,6 +781,53 @@ struct HfFilter { // Main struct for HF triggers
             is3Prong[3] = presel;
           }
         }
+        cands3ProngPresel[iCand3Prong] = is3Prong;
+        ++iCand3Prong;
+      } // end preselection loop over 3 prongs
+
+      // apply ML models to all the preselected candidates at once, one species at a time
+      if (applyML) {
+        for (auto iCharmPart{0}; iCharmPart < kNCharmParticles - 1; ++iCharmPart) {
+          if (onnxFiles[iCharmPart + 1] == "") {
+            continue;
+          }
+          inputFeaturesML.clear();
+          inputFeaturesDoML.clear();
+          indicesML.clear();
+          for (auto iCand{0}; iCand < nCand3Prongs; ++iCand) {
+            if (!cands3ProngPresel[iCand][iCharmPart]) {
+              continue;
+            }
+            // TODO: add more feature configurations
+            const auto& prongs = cands3ProngProngs[iCand];
+            for (int iProng{0}; iProng < 3; ++iProng) {
+              std::array<float, 3> features{prongs.trackPar[iProng].getPt(), prongs.dca[iProng][0], prongs.dca[iProng][1]};
+              inputFeaturesML.insert(inputFeaturesML.end(), features.begin(), features.end());
+              inputFeaturesDoML.insert(inputFeaturesDoML.end(), features.begin(), features.end());
+            }
+            indicesML.push_back(iCand);
+          }
+          if (!indicesML.empty()) {
+            predictCandidatesML(iCharmPart + 1, indicesML.size(), cands3ProngScores[iCharmPart]);
+          }
+        }
+      }
+
+      iCand3Prong = -1;
+      for (const auto& cand3Prong : cand3ProngsThisColl) { // start loop over 3 prongs
+        ++iCand3Prong;
+        auto is3Prong = cands3ProngPresel[iCand3Prong];
+        if (!std::accumulate(is3Prong.begin(), is3Prong.end(), 0)) { // check if it's a preselected D+, Ds+, Lc+ or Xic+
+          continue;
+        }
+
+        auto trackFirst = cand3Prong.template prong0_as<BigTracksPID>();
+        auto trackSecond = cand3Prong.template prong1_as<BigTracksPID>();
+        auto trackThird = cand3Prong.template prong2_as<BigTracksPID>();
+        const auto& prongs = cands3ProngProngs[iCand3Prong];
+        auto pVecFirst = prongs.pVec[0];
+        auto pVecSecond = prongs.pVec[1];
+        auto pVecThird = prongs.pVec[2];
 
         std::array<int8_t, kNCharmParticles - 1> isCharmTagged = is3Prong;
         std::array<int8_t, kNCharmParticles - 1> isBeautyTagged = is3Prong;
@@ -689,29 +841,15 @@ struct HfFilter { // Main struct for HF triggers
           isCharmTagged = std::array<int8_t, kNCharmParticles - 1>{0};
           isBeautyTagged = std::array<int8_t, kNCharmParticles - 1>{0};
 
-          // TODO: add more feature configurations
-          std::vector<float> inputFeatures{trackParFirst.getPt(), dcaFirst[0], dcaFirst[1], trackParSecond.getPt(), dcaSecond[0], dcaSecond[1], trackParThird.getPt(), dcaThird[0], dcaThird[1]};
-          std::vector<double> inputFeaturesD{trackParFirst.getPt(), dcaFirst[0], dcaFirst[1], trackParSecond.getPt(), dcaSecond[0], dcaSecond[1], trackParThird.getPt(), dcaThird[0], dcaThird[1]};
           for (auto iCharmPart{0}; iCharmPart < kNCharmParticles - 1; ++iCharmPart) {
             if (!is3Prong[iCharmPart] || onnxFiles[iCharmPart + 1] == "") {
               continue;
             }
 
-            int tagBDT = 0;
-            if (dataTypeML[iCharmPart + 1] == 1) {
-              auto scores = PredictONNX(inputFeatures, sessionML[iCharmPart + 1], inputShapesML[iCharmPart + 1]);
-              tagBDT = isBDTSelected(scores, thresholdBDTScores[iCharmPart + 1]);
-              for (int iScore{0}; iScore < 3; ++iScore) {
-                scoresToFill[iCharmPart][iScore] = scores[iScore];
-              }
-            } else if (dataTypeML[iCharmPart + 1] == 11) {
-              auto scores = PredictONNX(inputFeaturesD, sessionML[iCharmPart + 1], inputShapesML[iCharmPart + 1]);
-              tagBDT = isBDTSelected(scores, thresholdBDTScores[iCharmPart + 1]);
-              for (int iScore{0}; iScore < 3; ++iScore) {
-                scoresToFill[iCharmPart][iScore] = scores[iScore];
-              }
-            } else {
-              LOG(error) << "Error running model inference for " << charmParticleNames[iCharmPart + 1].data() << ": Unexpected input data type.";
+            const auto& scores = cands3ProngScores[iCharmPart][iCand3Prong];
+            int tagBDT = isBDTSelected(scores, thresholdBDTScores[iCharmPart + 1]);
+            for (int iScore{0}; iScore < 3; ++iScore) {
+              scoresToFill[iCharmPart][iScore] = scores[iScore];
             }
 
             isCharmTagged[iCharmPart] = TESTBIT(tagBDT, RecoDecay::OriginType::Prompt);
@@ -1027,6 +1165,36 @@ struct HfFilter { // Main struct for HF triggers
       }
     }
   }
+
+  void processTrackIndices(aod::Collisions const& collisions,
+                           aod::BCsWithTimestamps const&,
+                           aod::V0Datas const& theV0s,
+                           aod::V0sLinked const&,
+                           aod::CascDatas const& cascades,
+                           aod::Hf2Prongs const& cand2Prongs,
+                           aod::Hf3Prongs const& cand3Prongs,
+                           aod::TrackAssoc const& trackIndices,
+                           BigTracksPID const& tracks)
+  {
+    runFilter<false>(collisions, theV0s, cascades, cand2Prongs, cand3Prongs, trackIndices, tracks);
+  }
+
+  PROCESS_SWITCH(HfFilter, processTrackIndices, "Use the 2- and 3-prong track indices of the HF skim", true);
+
+  void processFittedCandidates(aod::Collisions const& collisions,
+                               aod::BCsWithTimestamps const&,
+                               aod::V0Datas const& theV0s,
+                               aod::V0sLinked const&,
+                               aod::CascDatas const& cascades,
+                               aod::HfCand2Prong const& cand2Prongs,
+                               aod::HfCand3Prong const& cand3Prongs,
+                               aod::TrackAssoc const& trackIndices,
+                               BigTracksPID const& tracks)
+  {
+    runFilter<true>(collisions, theV0s, cascades, cand2Prongs, cand3Prongs, trackIndices, tracks);
+  }
+
+  PROCESS_SWITCH(HfFilter, processFittedCandidates, "Use the 2- and 3-prong candidates with secondary vertex fitted by the HF candidate creators", false);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfg)
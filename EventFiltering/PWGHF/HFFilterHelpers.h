@@ -1209,6 +1209,60 @@ std::array<T, 3> PredictONNX(std::vector<T>& inputFeatures, std::shared_ptr<Ort:
   return scores;
 }
 
+/// Inference of the ONNX model for several candidates at once
+/// \param inputFeatures is the vector with the input features of all the candidates, one candidate after the other
+/// \param nCandidates is the number of candidates
+/// \param session is the ONNX Ort::Experimental::Session
+/// \param inputShapes is the input shape
+/// \param isDynamicBatch tells whether the model accepts a variable number of candidates, otherwise they are scored one by one
+/// \return the vector with the three output scores of each candidate
+template <typename T>
+std::vector<std::array<T, 3>> PredictONNXBatch(std::vector<T>& inputFeatures, int nCandidates, std::shared_ptr<Ort::Experimental::Session>& session, std::vector<std::vector<int64_t>>& inputShapes, bool isDynamicBatch)
+{
+  std::vector<std::array<T, 3>> scores(nCandidates, std::array<T, 3>{-1., 2., 2.});
+  if (nCandidates == 0) {
+    return scores;
+  }
+  const int nFeatures = inputFeatures.size() / nCandidates;
+
+  if (!isDynamicBatch) {
+    std::vector<T> inputFeaturesCand(nFeatures);
+    for (int iCand{0}; iCand < nCandidates; ++iCand) {
+      std::copy_n(inputFeatures.begin() + iCand * nFeatures, nFeatures, inputFeaturesCand.begin());
+      scores[iCand] = PredictONNX(inputFeaturesCand, session, inputShapes);
+    }
+    return scores;
+  }
+
+  std::vector<int64_t> inputShapeBatch{nCandidates, nFeatures};
+  std::vector<Ort::Value> inputTensor{};
+  inputTensor.push_back(Ort::Experimental::Value::CreateTensor<T>(inputFeatures.data(), inputFeatures.size(), inputShapeBatch));
+  try {
+    auto outputTensor = session->Run(session->GetInputNames(), inputTensor, session->GetOutputNames());
+    assert(outputTensor.size() == session->GetOutputNames().size() && outputTensor[1].IsTensor());
+    auto typeInfo = outputTensor[1].GetTensorTypeAndShapeInfo();
+    assert(typeInfo.GetElementCount() == 3 * nCandidates); // we need multiclass
+    const T* outputScores = outputTensor[1].GetTensorMutableData<T>();
+    for (int iCand{0}; iCand < nCandidates; ++iCand) {
+      for (int iScore{0}; iScore < 3; ++iScore) {
+        scores[iCand][iScore] = outputScores[3 * iCand + iScore];
+      }
+    }
+  } catch (const Ort::Exception& exception) {
+    LOG(error) << "Error running model inference: " << exception.what();
+  }
+
+  return scores;
+}
+
+/// Quantities of the prongs of a preselected candidate, computed once for the ML inference and the selections
+template <int nProngs>
+struct HfFilterCandidateProngs {
+  std::array<o2::track::TrackPar, nProngs> trackPar{};         // track parametrisations at the primary vertex
+  std::array<o2::gpu::gpustd::array<float, 2>, nProngs> dca{}; // DCAs (xy, z) to the primary vertex
+  std::array<std::array<float, 3>, nProngs> pVec{};            // momenta at the primary vertex
+};
+
 /// PID postcalibrations
 
 /// compute TPC postcalibrated nsigma based on calibration histograms from CCDB
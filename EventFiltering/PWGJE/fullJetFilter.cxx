@@ -150,6 +150,7 @@ struct fullJetFilter {
   // Declare filters
   o2::aod::EMCALClusterDefinition clusDef = o2::aod::emcalcluster::getClusterDefinitionFromString(mClusterDefinition.value);
   Filter clusterDefinitionSelection = o2::aod::emcalcluster::definition == static_cast<int>(clusDef);
+  // the jets are the ones clustered by the full (or neutral) jet finder of the workflow, selected by R
   Filter jetRadiusSelection = o2::aod::jet::r == f_jetR;
 
   Bool_t isJetInEmcal(filteredJets::iterator const& jet)
@@ -93,6 +93,8 @@ struct jetFilter {
   // declare filters on tracks
   // Filter collisionFilter = nabs(aod::collision::posZ) < cfgVertexCut;
 
+  // the jets are the ones clustered by the jet finder of the workflow (no clustering here),
+  // the radius selects the jet finder output with the same R
   Filter jetRadiusSelection = o2::aod::jet::r == nround(cfgJetR.node() * 100.0f);
   using filteredJets = o2::soa::Filtered<o2::aod::ChargedJets>;
 
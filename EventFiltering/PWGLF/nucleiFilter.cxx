@@ -24,6 +24,8 @@
 #include "Framework/runDataProcessing.h"
 #include "ReconstructionDataFormats/Track.h"
 
+#include "PWGLF/DataModel/LFSlimNucleiTables.h"
+
 #include "../filterTables.h"
 
 using namespace o2;
@@ -110,66 +112,69 @@ struct nucleiFilter {
 
   Filter trackFilter = (nabs(aod::track::eta) < cfgCutEta);
 
-  using TrackCandidates = soa::Filtered<soa::Join<aod::Tracks, aod::TracksExtra, aod::TrackSelection, aod::TracksDCA, aod::pidTPCFullDe, aod::pidTPCFullTr, aod::pidTPCFullHe, aod::pidTPCFullAl, aod::pidTOFFullDe, aod::pidTOFFullTr, aod::pidTOFFullHe, aod::pidTOFFullAl>>;
-  void process(aod::Collisions::iterator const& collision, TrackCandidates const& tracks)
+  using TracksWithPID = soa::Join<aod::Tracks, aod::TracksExtra, aod::TrackSelection, aod::TracksDCA, aod::pidTPCFullDe, aod::pidTPCFullTr, aod::pidTPCFullHe, aod::pidTPCFullAl, aod::pidTOFFullDe, aod::pidTOFFullTr, aod::pidTOFFullHe, aod::pidTOFFullAl>;
+  using TrackCandidates = soa::Filtered<TracksWithPID>;
+
+  /// Selects the track as a nucleus of each species, with its TPC n-sigma recomputed from the Bethe-Bloch parameterisation
+  /// of the task unless they come from the preselection
+  template <bool nSigmaFromCandidate, typename TT>
+  void selectTrack(TT const& track, float nSigmaTPC[nNuclei], const double bgScalings[nNuclei][2], bool keepEvent[nNuclei])
   {
-    // collision process loop
-    bool keepEvent[nNuclei]{false};
-    //
-    qaHists.fill(HIST("fCollZpos"), collision.posZ());
-    qaHists.fill(HIST("fProcessedEvents"), 0);
-    //
-    const double bgScalings[nNuclei][2]{
-      {charges[0] * cfgMomentumScalingBetheBloch->get(0u, 0u) / masses[0], charges[0] * cfgMomentumScalingBetheBloch->get(0u, 1u) / masses[0]},
-      {charges[1] * cfgMomentumScalingBetheBloch->get(1u, 0u) / masses[1], charges[1] * cfgMomentumScalingBetheBloch->get(1u, 1u) / masses[1]},
-      {charges[2] * cfgMomentumScalingBetheBloch->get(2u, 0u) / masses[2], charges[2] * cfgMomentumScalingBetheBloch->get(2u, 1u) / masses[2]}};
+    if (track.itsNCls() < cfgCutNclusITS ||
+        track.tpcNClsFound() < cfgCutNclusTPC) {
+      return;
+    }
+    if (track.sign() > 0 && (std::abs(track.dcaXY()) > cfgCutDCAxy ||
+                             std::abs(track.dcaZ()) > cfgCutDCAz)) {
+      return;
+    }
+    const float nSigmaTOF[nNuclei]{
+      track.tofNSigmaDe(), track.tofNSigmaTr(), track.tofNSigmaHe()};
+    const int iC{track.sign() < 0};
 
-    for (auto& track : tracks) { // start loop over tracks
-      if (track.itsNCls() < cfgCutNclusITS ||
-          track.tpcNClsFound() < cfgCutNclusTPC) {
+    for (int iN{0}; iN < nNuclei; ++iN) {
+      /// Cheap checks first
+      if (track.tpcInnerParam() < cfgMinTPCmom->get(iN, iC)) {
+        continue;
+      }
+
+      if (!nSigmaFromCandidate && cfgBetheBlochParams->get(iN, 5u) > 0.f) {
+        double expBethe{tpc::BetheBlochAleph(static_cast<double>(track.tpcInnerParam() * bgScalings[iN][iC]), cfgBetheBlochParams->get(iN, 0u), cfgBetheBlochParams->get(iN, 1u), cfgBetheBlochParams->get(iN, 2u), cfgBetheBlochParams->get(iN, 3u), cfgBetheBlochParams->get(iN, 4u))};
+        double expSigma{expBethe * cfgBetheBlochParams->get(iN, 5u)};
+        nSigmaTPC[iN] = static_cast<float>((track.tpcSignal() - expBethe) / expSigma);
+      }
+      h2TPCnSigma[iN]->Fill(track.sign() * track.tpcInnerParam(), nSigmaTPC[iN]);
+      if (nSigmaTPC[iN] < cfgCutsPID->get(iN, 0u) || nSigmaTPC[iN] > cfgCutsPID->get(iN, 1u)) {
         continue;
       }
-      if (track.sign() > 0 && (std::abs(track.dcaXY()) > cfgCutDCAxy ||
-                               std::abs(track.dcaZ()) > cfgCutDCAz)) {
+      if (track.pt() > cfgCutsPID->get(iN, 4u) && (nSigmaTOF[iN] < cfgCutsPID->get(iN, 2u) || nSigmaTOF[iN] > cfgCutsPID->get(iN, 3u))) {
         continue;
       }
-      float nSigmaTPC[nNuclei]{
-        track.tpcNSigmaDe(), track.tpcNSigmaTr(), track.tpcNSigmaHe()};
-      const float nSigmaTOF[nNuclei]{
-        track.tofNSigmaDe(), track.tofNSigmaTr(), track.tofNSigmaHe()};
-      const int iC{track.sign() < 0};
-
-      for (int iN{0}; iN < nNuclei; ++iN) {
-        /// Cheap checks first
-        if (track.tpcInnerParam() < cfgMinTPCmom->get(iN, iC)) {
-          continue;
-        }
-
-        if (cfgBetheBlochParams->get(iN, 5u) > 0.f) {
-          double expBethe{tpc::BetheBlochAleph(static_cast<double>(track.tpcInnerParam() * bgScalings[iN][iC]), cfgBetheBlochParams->get(iN, 0u), cfgBetheBlochParams->get(iN, 1u), cfgBetheBlochParams->get(iN, 2u), cfgBetheBlochParams->get(iN, 3u), cfgBetheBlochParams->get(iN, 4u))};
-          double expSigma{expBethe * cfgBetheBlochParams->get(iN, 5u)};
-          nSigmaTPC[iN] = static_cast<float>((track.tpcSignal() - expBethe) / expSigma);
-        }
-        h2TPCnSigma[iN]->Fill(track.sign() * track.tpcInnerParam(), nSigmaTPC[iN]);
-        if (nSigmaTPC[iN] < cfgCutsPID->get(iN, 0u) || nSigmaTPC[iN] > cfgCutsPID->get(iN, 1u)) {
-          continue;
-        }
-        if (track.pt() > cfgCutsPID->get(iN, 4u) && (nSigmaTOF[iN] < cfgCutsPID->get(iN, 2u) || nSigmaTOF[iN] > cfgCutsPID->get(iN, 3u))) {
-          continue;
-        }
-        keepEvent[iN] = true;
-        if (keepEvent[iN]) {
-          h2TPCsignal[iN]->Fill(track.sign() * track.tpcInnerParam(), track.tpcSignal());
-        }
+      keepEvent[iN] = true;
+      if (keepEvent[iN]) {
+        h2TPCsignal[iN]->Fill(track.sign() * track.tpcInnerParam(), track.tpcSignal());
       }
+    }
 
-      //
-      // fill QA histograms
-      //
-      qaHists.fill(HIST("fTPCsignal"), track.sign() * track.tpcInnerParam(), track.tpcSignal());
-
-    } // end loop over tracks
     //
+    // fill QA histograms
+    //
+    qaHists.fill(HIST("fTPCsignal"), track.sign() * track.tpcInnerParam(), track.tpcSignal());
+  }
+
+  void initCollision(aod::Collisions::iterator const& collision, double bgScalings[nNuclei][2])
+  {
+    qaHists.fill(HIST("fCollZpos"), collision.posZ());
+    qaHists.fill(HIST("fProcessedEvents"), 0);
+    for (int iN{0}; iN < nNuclei; ++iN) {
+      for (int iC{0}; iC < 2; ++iC) {
+        bgScalings[iN][iC] = charges[iN] * cfgMomentumScalingBetheBloch->get(iN, iC) / masses[iN];
+      }
+    }
+  }
+
+  void fillDecisions(bool keepEvent[nNuclei])
+  {
     for (int iDecision{0}; iDecision < 3; ++iDecision) {
       if (keepEvent[iDecision]) {
         qaHists.fill(HIST("fProcessedEvents"), iDecision + 1);
@@ -177,6 +182,42 @@ struct nucleiFilter {
     }
     tags(keepEvent[0], keepEvent[1], keepEvent[2]);
   }
+
+  void processTracks(aod::Collisions::iterator const& collision, TrackCandidates const& tracks)
+  {
+    // collision process loop
+    bool keepEvent[nNuclei]{false};
+    double bgScalings[nNuclei][2];
+    initCollision(collision, bgScalings);
+
+    for (auto& track : tracks) { // start loop over tracks
+      float nSigmaTPC[nNuclei]{
+        track.tpcNSigmaDe(), track.tpcNSigmaTr(), track.tpcNSigmaHe()};
+      selectTrack<false>(track, nSigmaTPC, bgScalings, keepEvent);
+    } // end loop over tracks
+    fillDecisions(keepEvent);
+  }
+  PROCESS_SWITCH(nucleiFilter, processTracks, "Trigger on all the tracks of the collision", true);
+
+  /// Same as processTracks, for the light nuclei candidates of the nuclei-preselection task and with their TPC n-sigma
+  void processCandidates(aod::Collisions::iterator const& collision, aod::NucleiCandidates const& candidates, TracksWithPID const&)
+  {
+    bool keepEvent[nNuclei]{false};
+    double bgScalings[nNuclei][2];
+    initCollision(collision, bgScalings);
+
+    for (auto& candidate : candidates) {
+      auto track = candidate.track_as<TracksWithPID>();
+      if (std::abs(track.eta()) >= cfgCutEta) {
+        continue;
+      }
+      float nSigmaTPC[nNuclei]{
+        candidate.tpcNsigmaDe(), candidate.tpcNsigmaTr(), candidate.tpcNsigmaHe()};
+      selectTrack<true>(track, nSigmaTPC, bgScalings, keepEvent);
+    }
+    fillDecisions(keepEvent);
+  }
+  PROCESS_SWITCH(nucleiFilter, processCandidates, "Trigger on the light nuclei candidates of the preselection", false);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfg)
@@ -90,6 +90,7 @@ struct strangenessFilter {
   Configurable<float> minPtTrackedCascade{"minPtTrackedCascade", 0., "Min. pt for tracked cascades"};
   Configurable<float> minPtTrackedV0{"minPtTrackedV0", 0., "Min. pt for tracked V0"};
   Configurable<float> minPtTracked3Body{"minPtTracked3Body", 0., "Min. pt for tracked 3Body"};
+  Configurable<bool> useColumnarPreselection{"useColumnarPreselection", true, "Apply the cascade selections available as table columns to the whole table before the loops over the cascades (the candidate QA then starts from the preselected cascades)"};
 
   // Selections criteria for tracks
   Configurable<float> hEta{"hEta", 0.9f, "Eta range for trigger particles"};
@@ -243,6 +244,17 @@ struct strangenessFilter {
 
   // Filters
   Filter trackFilter = (nabs(aod::track::eta) < hEta) && (aod::track::pt > hMinPt);
+  // Selections of the cascade loops which only need the columns of the cascade table, evaluated on the whole table at once.
+  // A cascade rejected here would be rejected by the same selections in the loops, before contributing to any trigger.
+  Filter cascadeFilter = (useColumnarPreselection.node() == false) ||
+                         (ifnode(aod::cascdata::sign > 0,
+                                 nabs(aod::cascdata::dcapostopv) >= dcamesontopv && nabs(aod::cascdata::dcanegtopv) >= dcabaryontopv,
+                                 nabs(aod::cascdata::dcanegtopv) >= dcamesontopv && nabs(aod::cascdata::dcapostopv) >= dcabaryontopv) &&
+                          nabs(aod::cascdata::dcabachtopv) >= dcabachtopv &&
+                          nsqrt(aod::cascdata::xlambda * aod::cascdata::xlambda + aod::cascdata::ylambda * aod::cascdata::ylambda) >= v0radius &&
+                          nsqrt(aod::cascdata::x * aod::cascdata::x + aod::cascdata::y * aod::cascdata::y) >= cascradius &&
+                          aod::cascdata::dcaV0daughters <= dcav0dau &&
+                          aod::cascdata::dcacascdaughters <= dcacascdau);
 
   // Tables
   using CollisionCandidates = soa::Join<aod::Collisions, aod::EvSels, aod::CentRun2V0Ms>::iterator;
@@ -250,7 +262,7 @@ struct strangenessFilter {
   using CollisionCandidatesRun3 = soa::Join<aod::Collisions, aod::EvSels, aod::MultZeqs>::iterator;
   using TrackCandidates = soa::Filtered<soa::Join<aod::Tracks, aod::TracksExtra, aod::TracksDCA>>;
   using DaughterTracks = soa::Join<aod::Tracks, aod::TracksExtra, aod::TracksDCA, aod::pidTPCFullPi, aod::pidTPCFullPr, aod::pidTPCFullKa>;
-  using Cascades = aod::CascDataExt;
+  using Cascades = soa::Filtered<aod::CascDataExt>;
 
   ////////////////////////////////////////////////////////
   ////////// Strangeness Filter - Run 2 conv /////////////
@@ -86,6 +86,9 @@ struct multFilter {
     "GlobalTrk", "FV0", "1-flatencity_FV0", "FT0", "1-flatencityFT0", "FT0C_FV0", "1-flatencity_FT0C_FV0", "pT^{trig} (GeV/#it{c})"};
 
   int RunNumber = 0;
+  float fac_FT0A_ebe = 1.;
+  float fac_FT0C_ebe = 1.;
+  float fac_FV0_ebe = 1.;
   o2::ccdb::CcdbApi ccdbApi;
   Service<o2::ccdb::BasicCCDBManager> ccdb;
 
@@ -198,27 +201,14 @@ struct multFilter {
   Filter trackFilter = (nabs(aod::track::eta) < cfgTrkEtaCut) && (aod::track::pt > cfgTrkLowPtCut);
   using TrackCandidates = soa::Filtered<soa::Join<aod::Tracks, aod::TracksExtra, aod::TracksDCA, aod::TrackSelection>>;
 
+  // sectors of 4 consecutive channels, -1 for the channels out of the 24 (A side) or 28 (C side) sectors
   int getT0ASector(int i_ch)
   {
-    int i_sec_t0a = -1;
-    for (int i_sec = 0; i_sec < 24; ++i_sec) {
-      if (i_ch >= 4 * i_sec && i_ch <= 3 + 4 * i_sec) {
-        i_sec_t0a = i_sec;
-        break;
-      }
-    }
-    return i_sec_t0a;
+    return (i_ch >= 0 && i_ch < 4 * 24) ? i_ch / 4 : -1;
   }
   int getT0CSector(int i_ch)
   {
-    int i_sec_t0c = -1;
-    for (int i_sec = 0; i_sec < 28; ++i_sec) {
-      if (i_ch >= 4 * i_sec && i_ch <= 3 + 4 * i_sec) {
-        i_sec_t0c = i_sec;
-        break;
-      }
-    }
-    return i_sec_t0c;
+    return (i_ch >= 0 && i_ch < 4 * 28) ? i_ch / 4 : -1;
   }
   float GetFlatenicity(float signals[], int entries)
   {
@@ -248,27 +238,31 @@ struct multFilter {
   {
     auto bc = collision.template bc_as<aod::BCsWithTimestamps>();
 
-    meanMultT0C = 0.f;
-    auto vMeanMultT0C = ccdb->getForTimeStamp<std::vector<double>>("Users/e/ekryshen/meanT0C", bc.timestamp());
-    meanMultT0C = (*vMeanMultT0C)[0];
-    meanMultT0A = 0.f;
-    auto vMeanMultT0A = ccdb->getForTimeStamp<std::vector<double>>("Users/e/ekryshen/meanT0A", bc.timestamp());
-    meanMultT0A = (*vMeanMultT0A)[0];
-    meanMultV0A = 0.f;
-    auto vMeanMultV0A = ccdb->getForTimeStamp<std::vector<double>>("Users/e/ekryshen/meanV0A", bc.timestamp());
-    meanMultV0A = (*vMeanMultV0A)[0];
-
-    float fac_FT0A_ebe = 1.;
-    float fac_FT0C_ebe = 1.;
-    float fac_FV0_ebe = 1.;
-    if (meanMultT0A > 0) {
-      fac_FT0A_ebe = avPyT0A / meanMultT0A;
-    }
-    if (meanMultT0C > 0) {
-      fac_FT0C_ebe = avPyT0C / meanMultT0C;
-    }
-    if (meanMultV0A > 0) {
-      fac_FV0_ebe = avPyFV0 / meanMultV0A;
+    // the mean multiplicities are calibrated per run, so they are read only when the run changes, not for each collision
+    if (bc.runNumber() != RunNumber) {
+      RunNumber = bc.runNumber();
+      meanMultT0C = 0.f;
+      auto vMeanMultT0C = ccdb->getForTimeStamp<std::vector<double>>("Users/e/ekryshen/meanT0C", bc.timestamp());
+      meanMultT0C = (*vMeanMultT0C)[0];
+      meanMultT0A = 0.f;
+      auto vMeanMultT0A = ccdb->getForTimeStamp<std::vector<double>>("Users/e/ekryshen/meanT0A", bc.timestamp());
+      meanMultT0A = (*vMeanMultT0A)[0];
+      meanMultV0A = 0.f;
+      auto vMeanMultV0A = ccdb->getForTimeStamp<std::vector<double>>("Users/e/ekryshen/meanV0A", bc.timestamp());
+      meanMultV0A = (*vMeanMultV0A)[0];
+
+      fac_FT0A_ebe = 1.;
+      fac_FT0C_ebe = 1.;
+      fac_FV0_ebe = 1.;
+      if (meanMultT0A > 0) {
+        fac_FT0A_ebe = avPyT0A / meanMultT0A;
+      }
+      if (meanMultT0C > 0) {
+        fac_FT0C_ebe = avPyT0C / meanMultT0C;
+      }
+      if (meanMultV0A > 0) {
+        fac_FV0_ebe = avPyFV0 / meanMultV0A;
+      }
     }
 
     bool keepEvent[kNtriggersMM]{false};
@@ -278,6 +272,16 @@ struct multFilter {
 
     float sumAmpFT0A = 0.f;
     float sumAmpFT0C = 0.f;
+    const int nCellsT0A = 24;
+    float RhoLatticeT0A[nCellsT0A];
+    for (int iCh = 0; iCh < nCellsT0A; iCh++) {
+      RhoLatticeT0A[iCh] = 0.0;
+    }
+    const int nCellsT0C = 28;
+    float RhoLatticeT0C[nCellsT0C];
+    for (int iCh = 0; iCh < nCellsT0C; iCh++) {
+      RhoLatticeT0C[iCh] = 0.0;
+    }
     bool isOkTimeFT0 = false;
     bool isOkvtxtrig = false;
     bool isOkFV0OrA = false;
@@ -293,13 +297,26 @@ struct multFilter {
       multiplicity.fill(HIST("hT0C_time"), t0_c);
       multiplicity.fill(HIST("hT0A_time"), t0_a);
 
-      for (std::size_t i_a = 0; i_a < ft0.amplitudeA().size(); i_a++) {
-        float amplitude = ft0.amplitudeA()[i_a];
+      // sums and sector lattices of the amplitudes in a single pass over the channels
+      const auto ampA = ft0.amplitudeA();
+      const auto chA = ft0.channelA();
+      for (std::size_t i_a = 0; i_a < ampA.size(); i_a++) {
+        float amplitude = ampA[i_a];
         sumAmpFT0A += amplitude;
+        int sector = getT0ASector(chA[i_a]);
+        if (sector >= 0) {
+          RhoLatticeT0A[sector] += amplitude;
+        }
       }
-      for (std::size_t i_c = 0; i_c < ft0.amplitudeC().size(); i_c++) {
-        float amplitude = ft0.amplitudeC()[i_c];
+      const auto ampC = ft0.amplitudeC();
+      const auto chC = ft0.channelC();
+      for (std::size_t i_c = 0; i_c < ampC.size(); i_c++) {
+        float amplitude = ampC[i_c];
         sumAmpFT0C += amplitude;
+        int sector = getT0CSector(chC[i_c]);
+        if (sector >= 0) {
+          RhoLatticeT0C[sector] += amplitude;
+        }
       }
       multiplicity.fill(HIST("hMultFT0A"), sumAmpFT0A);
       multiplicity.fill(HIST("hMultFT0C"), sumAmpFT0C);
@@ -322,10 +339,12 @@ struct multFilter {
       std::bitset<8> fV0Triggers = fv0.triggerMask();
       isOkFV0OrA = fV0Triggers[o2::fit::Triggers::bitA];
       // LOGP(info, "amplitude.size()={}", fv0.amplitude().size());
-      for (std::size_t ich = 0; ich < fv0.amplitude().size(); ich++) {
+      const auto ampV0 = fv0.amplitude();
+      const auto chV0 = fv0.channel();
+      for (std::size_t ich = 0; ich < ampV0.size(); ich++) {
 
-        int channelv0 = fv0.channel()[ich];
-        float ampl_ch = fv0.amplitude()[ich];
+        int channelv0 = chV0[ich];
+        float ampl_ch = ampV0[ich];
         sumAmpFV0 += ampl_ch;
         if (channelv0 < innerFV0) {
           RhoLattice[channelv0] = ampl_ch;
@@ -364,16 +383,6 @@ struct multFilter {
     int multTrack = 0;
     float flPt = 0; // leading pT
 
-    const int nCellsT0A = 24;
-    float RhoLatticeT0A[nCellsT0A];
-    for (int iCh = 0; iCh < nCellsT0A; iCh++) {
-      RhoLatticeT0A[iCh] = 0.0;
-    }
-    const int nCellsT0C = 28;
-    float RhoLatticeT0C[nCellsT0C];
-    for (int iCh = 0; iCh < nCellsT0C; iCh++) {
-      RhoLatticeT0C[iCh] = 0.0;
-    }
     if (collision.has_foundFT0()) {
       auto ft0 = collision.foundFT0();
       float t0_a = ft0.timeA();
@@ -381,24 +390,23 @@ struct multFilter {
       multiplicity.fill(HIST("hT0Cafter_time"), t0_c);
       multiplicity.fill(HIST("hT0Aafter_time"), t0_a);
 
-      for (std::size_t i_a = 0; i_a < ft0.amplitudeA().size(); i_a++) {
-        float amplitude = ft0.amplitudeA()[i_a];
-        uint8_t channel = ft0.channelA()[i_a];
-        int sector = getT0ASector(channel);
-        if (sector >= 0 && sector < 24) {
-          RhoLatticeT0A[sector] += amplitude;
+      // QA of the channels of the selected events, the lattices are filled before the event selection
+      const auto ampA = ft0.amplitudeA();
+      const auto chA = ft0.channelA();
+      for (std::size_t i_a = 0; i_a < ampA.size(); i_a++) {
+        float amplitude = ampA[i_a];
+        int sector = getT0ASector(chA[i_a]);
+        if (sector >= 0) {
           multiplicity.fill(HIST("hAmpT0AVsCh"), sector, amplitude);
         }
-        // sumAmpFT0A += amplitude;
         multiplicity.fill(HIST("hFT0A"), amplitude);
       }
-      for (std::size_t i_c = 0; i_c < ft0.amplitudeC().size(); i_c++) {
-        float amplitude = ft0.amplitudeC()[i_c];
-        // sumAmpFT0C += amplitude;
-        uint8_t channel = ft0.channelC()[i_c];
-        int sector = getT0CSector(channel);
-        if (sector >= 0 && sector < 28) {
-          RhoLatticeT0C[sector] += amplitude;
+      const auto ampC = ft0.amplitudeC();
+      const auto chC = ft0.channelC();
+      for (std::size_t i_c = 0; i_c < ampC.size(); i_c++) {
+        float amplitude = ampC[i_c];
+        int sector = getT0CSector(chC[i_c]);
+        if (sector >= 0) {
           multiplicity.fill(HIST("hAmpT0CVsCh"), sector, amplitude);
         }
         multiplicity.fill(HIST("hFT0C"), amplitude);
@@ -412,11 +420,11 @@ struct multFilter {
     // Globaltracks
 
     for (auto& track : tracks) {
-      if (!mTrackSelector.IsSelected(track)) {
+      // Has this track contributed to the collision vertex fit, checked first as it is cheaper than the track selection
+      if (!track.isPVContributor()) {
         continue;
       }
-      // Has this track contributed to the collision vertex fit
-      if (!track.isPVContributor()) {
+      if (!mTrackSelector.IsSelected(track)) {
         continue;
       }
       float eta_a = track.eta();
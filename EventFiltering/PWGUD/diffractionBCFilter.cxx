@@ -14,6 +14,9 @@
 // \author P. Buehler, paul.buehler@oeaw.ac.at
 // \since December, 2022
 
+#include <algorithm>
+#include <vector>
+
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
 #include "PWGUD/TableProducer/DGBCCandProducer.h"
@@ -298,6 +301,24 @@ struct DGBCFilterRun3 {
     auto lasttibc = tibcs.iteratorAt(tibcs.size() - 1);
     auto lastftibc = ftibcs.iteratorAt(ftibcs.size() - 1);
 
+    // evaluate the FIT condition once per BC
+    // nNotCleanFIT[i] is the number of BCs with FIT activity among the first i BCs, so that the
+    // condition in a range of compatible BCs is a difference of two entries
+    const auto nBCs = bcs.size();
+    std::vector<uint64_t> globalBCs(nBCs);
+    std::vector<int> nNotCleanFIT(nBCs + 1, 0);
+    int64_t iBC = 0;
+    for (auto const& bc : bcs) {
+      globalBCs[iBC] = bc.globalBC();
+      nNotCleanFIT[iBC + 1] = nNotCleanFIT[iBC] + (udhelpers::cleanFIT(bc, diffCuts.maxFITtime(), diffCuts.FITAmpLimits()) ? 0 : 1);
+      ++iBC;
+    }
+
+    // limits [firstBC, lastBC) of the range of compatible BCs, moving along with the BCs
+    const auto deltaBC = static_cast<uint64_t>(diffCuts.minNBCs());
+    int64_t firstBC = 0;
+    int64_t lastBC = 0;
+
     // loop over bcs
     int isDGBC;
     for (auto bc : bcs) {
@@ -314,8 +335,17 @@ struct DGBCFilterRun3 {
         // get tracks associated with BC
         auto tracksArray = tibc.track_as<TCs>();
 
-        // obtain slice of compatible BCs
-        auto bcRange = udhelpers::compatibleBCs(bc, bcnum, diffCuts.minNBCs(), bcs);
+        // range of compatible BCs, [bcnum - minNBCs, bcnum + minNBCs]
+        const uint64_t minBC = deltaBC < bcnum ? bcnum - deltaBC : 0;
+        const uint64_t maxBC = bcnum + deltaBC;
+        while (firstBC < nBCs && globalBCs[firstBC] < minBC) {
+          ++firstBC;
+        }
+        lastBC = std::max(lastBC, firstBC);
+        while (lastBC < nBCs && globalBCs[lastBC] <= maxBC) {
+          ++lastBC;
+        }
+        const bool isCleanFIT = nNotCleanFIT[lastBC] == nNotCleanFIT[firstBC];
 
         // find BC in FTIBCs table
         while (ftibc.bcnum() < bcnum && ftibc != lastftibc) {
@@ -325,10 +355,10 @@ struct DGBCFilterRun3 {
         // apply DG selection
         if (ftibc.bcnum() == bcnum) {
           auto fwdTracksArray = ftibc.fwdtrack_as<FTCs>();
-          isDGBC = dgSelector.IsSelected(diffCuts, bcRange, tracksArray, fwdTracksArray);
+          isDGBC = dgSelector.IsSelected(diffCuts, isCleanFIT, tracksArray, fwdTracksArray);
         } else {
           auto fwdTracksArray = FTCs{{fwdtracks.asArrowTable()->Slice(0, 0)}, (uint64_t)0};
-          isDGBC = dgSelector.IsSelected(diffCuts, bcRange, tracksArray, fwdTracksArray);
+          isDGBC = dgSelector.IsSelected(diffCuts, isCleanFIT, tracksArray, fwdTracksArray);
         }
 
         // save decision
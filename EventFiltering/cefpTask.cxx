@@ -10,9 +10,11 @@
 // or submit itself to any jurisdiction.
 // O2 includes
 
+#include <algorithm>
+#include <array>
 #include <iostream>
 #include <cstdio>
-#include <random>
+#include <cstring>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -66,6 +68,33 @@ bool readJsonFile(std::string& config, Document& d)
   return true;
 }
 
+/// Reads the values of a boolean array from position iS on, up to 64 of them, as a word: bit i is the value at iS + i
+uint64_t getBooleanWord(const uint8_t* bits, int64_t offset, int64_t iS, int64_t length)
+{
+  uint64_t word{0};
+  const int64_t nBits{std::min<int64_t>(64, length - iS)};
+  const int64_t first{offset + iS};
+  if (first % 8 == 0) {
+    std::memcpy(&word, bits + first / 8, (nBits + 7) / 8); // the bitmaps are little-endian, as the hosts
+  } else {
+    for (int64_t iB{0}; iB < nBits; ++iB) {
+      word |= static_cast<uint64_t>((bits[(first + iB) / 8] >> ((first + iB) % 8)) & 1) << iB;
+    }
+  }
+  return nBits < 64 ? word & ((uint64_t{1} << nBits) - 1) : word;
+}
+
+/// Counter-based uniform random number in [0, 1) for the downscaling, reproducible for a given event and trigger
+double getUniformRandom(uint64_t globalBC, uint64_t entry, uint64_t triggerBit)
+{
+  // splitmix64 finaliser of the counter
+  uint64_t z{globalBC * 0x9e3779b97f4a7c15ULL + (entry << 7 | triggerBit)};
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  z ^= z >> 31;
+  return (z >> 11) * 0x1.0p-53;
+}
+
 std::unordered_map<std::string, std::unordered_map<std::string, float>> mDownscaling;
 static const std::vector<std::string> downscalingName{"Downscaling"};
 static const float defaultDownscaling[128][1]{
@@ -267,6 +296,20 @@ struct centralEventFilterTask {
     auto mFiltered{scalers.get<TH1>(HIST("mFiltered"))};
     auto mCovariance{scalers.get<TH2>(HIST("mCovariance"))};
 
+    auto bcTabConsumer = pc.inputs().get<TableConsumer>(aod::MetadataTrait<std::decay_t<aod::BCs>>::metadata::tableLabel());
+    auto bcTabPtr{bcTabConsumer->asArrowTable()};
+    auto collTabConsumer = pc.inputs().get<TableConsumer>(aod::MetadataTrait<std::decay_t<aod::Collisions>>::metadata::tableLabel());
+    auto collTabPtr{collTabConsumer->asArrowTable()};
+    auto evSelConsumer = pc.inputs().get<TableConsumer>(aod::MetadataTrait<std::decay_t<aod::EvSels>>::metadata::tableLabel());
+    auto evSelTabPtr{evSelConsumer->asArrowTable()};
+
+    auto columnGloBCId{bcTabPtr->GetColumnByName(aod::BC::GlobalBC::mLabel)};
+    auto columnBCId{collTabPtr->GetColumnByName(aod::Collision::BCId::mLabel)};
+    auto chunkBC{columnBCId->chunk(0)};
+    auto chunkGloBC{columnGloBCId->chunk(0)};
+    auto BCArray = std::static_pointer_cast<arrow::NumericArray<arrow::Int32Type>>(chunkBC);
+    auto GloBCArray = std::static_pointer_cast<arrow::NumericArray<arrow::UInt64Type>>(chunkGloBC);
+
     int64_t nEvents{-1};
     std::vector<uint64_t> outTrigger, outDecision;
     int64_t nSelected{0};
@@ -295,56 +338,78 @@ struct centralEventFilterTask {
         auto column{tablePtr->GetColumnByName(colName.first)};
         double downscaling{colName.second};
         if (column) {
-          int entry = 0;
+          int64_t nFired{0}, nFiltered{0};
+          int64_t entry = 0;
           for (int64_t iC{0}; iC < column->num_chunks(); ++iC) {
             auto chunk{column->chunk(iC)};
             auto boolArray = std::static_pointer_cast<arrow::BooleanArray>(chunk);
-            for (int64_t iS{0}; iS < chunk->length(); ++iS) {
-              if (boolArray->Value(iS)) {
-                mScalers->Fill(binCenter);
-                outTrigger[entry] |= triggerBit;
-                if (mUniformGenerator(mGeneratorEngine) < downscaling) {
-                  mFiltered->Fill(binCenter);
-                  outDecision[entry] |= triggerBit;
-                  nSelected++;
+            const uint8_t* bits{boolArray->values()->data()};
+            // the decisions are read 64 rows at a time, only the fired ones are looked at
+            for (int64_t iS{0}; iS < chunk->length(); iS += 64) {
+              uint64_t word{getBooleanWord(bits, boolArray->offset(), iS, chunk->length())};
+              nFired += __builtin_popcountll(word);
+              while (word) {
+                int64_t iE{entry + iS + __builtin_ctzll(word)};
+                word &= word - 1;
+                outTrigger[iE] |= triggerBit;
+                uint64_t globalBC{iE < BCArray->length() && BCArray->Value(iE) >= 0 && BCArray->Value(iE) < GloBCArray->length() ? GloBCArray->Value(BCArray->Value(iE)) : 0};
+                if (getUniformRandom(globalBC, iE, bin - 2) < downscaling) {
+                  outDecision[iE] |= triggerBit;
+                  nFiltered++;
                 }
               }
-              entry++;
             }
+            entry += chunk->length();
           }
+          mScalers->Fill(binCenter, nFired);
+          mFiltered->Fill(binCenter, nFiltered);
+          nSelected += nFiltered;
         }
       }
     }
     mScalers->SetBinContent(1, mScalers->GetBinContent(1) + nEvents);
     mFiltered->SetBinContent(1, mFiltered->GetBinContent(1) + nEvents);
 
+    // events firing each trigger, as bit words of 64 events, and number of triggered and filtered events
+    const uint64_t nWords{(outTrigger.size() + 63) / 64};
+    uint64_t firedTriggers{0};
+    for (auto& events : mEventsPerTrigger) {
+      events.assign(nWords, 0u);
+    }
+    int64_t nTriggered{0}, nFilteredEvents{0};
     for (uint64_t iE{0}; iE < outTrigger.size(); ++iE) {
-      for (int iB{0}; iB < 64; ++iB) {
-        if (!(outTrigger[iE] & BIT(iB))) {
+      uint64_t triggers{outTrigger[iE]};
+      firedTriggers |= triggers;
+      while (triggers) {
+        mEventsPerTrigger[__builtin_ctzll(triggers)][iE / 64] |= uint64_t{1} << (iE % 64);
+        triggers &= triggers - 1;
+      }
+      nTriggered += outTrigger[iE] != 0;
+      nFilteredEvents += outDecision[iE] != 0;
+    }
+    mScalers->Fill(mScalers->GetNbinsX() - 1, nTriggered);
+    mFiltered->Fill(mFiltered->GetNbinsX() - 1, nFilteredEvents);
+
+    // selection covariance from the number of events firing each pair of triggers, filled once per time frame
+    for (int iB{0}; iB < 64; ++iB) {
+      if (!(firedTriggers & (uint64_t{1} << iB))) {
+        continue;
+      }
+      for (int iC{iB}; iC < 64; ++iC) {
+        if (!(firedTriggers & (uint64_t{1} << iC))) {
           continue;
         }
-        for (int iC{iB}; iC < 64; ++iC) {
-          if (outTrigger[iE] & BIT(iC)) {
-            mCovariance->Fill(iB, iC);
-          }
+        int64_t nCoincidences{0};
+        for (uint64_t iW{0}; iW < nWords; ++iW) {
+          nCoincidences += __builtin_popcountll(mEventsPerTrigger[iB][iW] & mEventsPerTrigger[iC][iW]);
+        }
+        if (nCoincidences) {
+          mCovariance->Fill(iB, iC, nCoincidences);
         }
-      }
-      if (outTrigger[iE]) {
-        mScalers->Fill(mScalers->GetNbinsX() - 1);
-      }
-      if (outDecision[iE]) {
-        mFiltered->Fill(mFiltered->GetNbinsX() - 1);
       }
     }
 
     // Filling output table
-    auto bcTabConsumer = pc.inputs().get<TableConsumer>(aod::MetadataTrait<std::decay_t<aod::BCs>>::metadata::tableLabel());
-    auto bcTabPtr{bcTabConsumer->asArrowTable()};
-    auto collTabConsumer = pc.inputs().get<TableConsumer>(aod::MetadataTrait<std::decay_t<aod::Collisions>>::metadata::tableLabel());
-    auto collTabPtr{collTabConsumer->asArrowTable()};
-    auto evSelConsumer = pc.inputs().get<TableConsumer>(aod::MetadataTrait<std::decay_t<aod::EvSels>>::metadata::tableLabel());
-    auto evSelTabPtr{evSelConsumer->asArrowTable()};
-
     if (outDecision.size() != static_cast<uint64_t>(collTabPtr->num_rows())) {
       LOG(fatal) << "Inconsistent number of rows across Collision table and CEFP decision vector.";
     }
@@ -352,22 +417,16 @@ struct centralEventFilterTask {
       LOG(fatal) << "Inconsistent number of rows across EvSel table and CEFP decision vector.";
     }
 
-    auto columnGloBCId{bcTabPtr->GetColumnByName(aod::BC::GlobalBC::mLabel)};
-    auto columnBCId{collTabPtr->GetColumnByName(aod::Collision::BCId::mLabel)};
     auto columnCollTime{collTabPtr->GetColumnByName(aod::Collision::CollisionTime::mLabel)};
     auto columnCollTimeRes{collTabPtr->GetColumnByName(aod::Collision::CollisionTimeRes::mLabel)};
     auto columnFoundBC{evSelTabPtr->GetColumnByName(o2::aod::evsel::FoundBCId::mLabel)};
 
-    auto chunkBC{columnBCId->chunk(0)};
     auto chunkCollTime{columnCollTime->chunk(0)};
     auto chunkCollTimeRes{columnCollTimeRes->chunk(0)};
-    auto chunkGloBC{columnGloBCId->chunk(0)};
     auto chunkFoundBC{columnFoundBC->chunk(0)};
 
-    auto BCArray = std::static_pointer_cast<arrow::NumericArray<arrow::Int32Type>>(chunkBC);
     auto CollTimeArray = std::static_pointer_cast<arrow::NumericArray<arrow::FloatType>>(chunkCollTime);
     auto CollTimeResArray = std::static_pointer_cast<arrow::NumericArray<arrow::FloatType>>(chunkCollTimeRes);
-    auto GloBCArray = std::static_pointer_cast<arrow::NumericArray<arrow::UInt64Type>>(chunkGloBC);
     auto FoundBCArray = std::static_pointer_cast<arrow::NumericArray<arrow::Int32Type>>(chunkFoundBC);
 
     for (uint64_t iD{0}; iD < outDecision.size(); ++iD) {
@@ -384,8 +443,7 @@ struct centralEventFilterTask {
   {
   }
 
-  std::mt19937_64 mGeneratorEngine;
-  std::uniform_real_distribution<double> mUniformGenerator = std::uniform_real_distribution<double>(0., 1.);
+  std::array<std::vector<uint64_t>, 64> mEventsPerTrigger; // events firing each trigger bit in the time frame, 64 events per word
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfg)
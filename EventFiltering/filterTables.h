@@ -11,9 +11,12 @@
 #ifndef EVENTFILTERING_FILTERTABLES_H_
 #define EVENTFILTERING_FILTERTABLES_H_
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
 #include <unordered_map>
 #include <string>
+#include <utility>
 #include <vector>
 #include "Framework/AnalysisDataModel.h"
 
@@ -228,6 +231,38 @@ unsigned int NumberOfColumns()
   return o2::framework::pack_size(typename T::iterator::persistent_columns_t{});
 }
 
+/// BC range [first, second], as stored in the BCRanges table
+using BCRangeLimits = std::pair<uint64_t, uint64_t>;
+
+/// Sorts the BC ranges and coalesces in place the overlapping and adjacent ones, leaving the minimal set of disjoint ranges
+inline void mergeBCRanges(std::vector<BCRangeLimits>& ranges)
+{
+  std::sort(ranges.begin(), ranges.end());
+  size_t nMerged{0};
+  for (size_t iR{0}; iR < ranges.size(); ++iR) {
+    if (nMerged > 0 && ranges[iR].first <= ranges[nMerged - 1].second + 1) {
+      ranges[nMerged - 1].second = std::max(ranges[nMerged - 1].second, ranges[iR].second);
+    } else {
+      ranges[nMerged++] = ranges[iR];
+    }
+  }
+  ranges.resize(nMerged);
+}
+
+/// Finds the range containing a BC, in O(log n)
+/// \param ranges are sorted disjoint BC ranges, as given by mergeBCRanges
+/// \return index of the range containing the BC, -1 if there is none
+inline int64_t findBCRange(const std::vector<BCRangeLimits>& ranges, uint64_t bc)
+{
+  auto range = std::upper_bound(ranges.begin(), ranges.end(), bc, [](uint64_t value, const BCRangeLimits& limits) {
+    return value < limits.first;
+  });
+  if (range == ranges.begin() || bc > (--range)->second) {
+    return -1;
+  }
+  return range - ranges.begin();
+}
+
 } // namespace o2::aod
 
 #endif // EVENTFILTERING_FILTERTABLES_H_
@@ -107,22 +107,17 @@ struct BCRangeSelector {
     }
 
     /// We cannot merge the ranges in the previous loop because while collisions are sorted by time, the corresponding minBCs can be unsorted as the collision time resolution is not constant
-    std::sort(bcRanges.begin(), bcRanges.end(), [](const IRFrame& a, const IRFrame& b) {
-      return a.getMin() < b.getMin();
-    });
-
-    std::vector<IRFrame> bcRangesMerged(1, bcRanges[0]);
-    for (uint64_t iR{1}; iR < bcRanges.size(); ++iR) {
-      if (bcRangesMerged.back().getMax() >= bcRanges[iR].getMin()) {
-        bcRangesMerged.back().getMax() = std::max(bcRangesMerged.back().getMax(), bcRanges[iR].getMax());
-      } else {
-        bcRangesMerged.push_back(bcRanges[iR]);
-      }
+    std::vector<aod::BCRangeLimits> bcRangesMerged;
+    bcRangesMerged.reserve(bcRanges.size());
+    for (auto& range : bcRanges) {
+      bcRangesMerged.emplace_back(range.getMin().toLong(), range.getMax().toLong());
     }
-    bcRanges.swap(bcRangesMerged);
+    aod::mergeBCRanges(bcRangesMerged);
+    LOGF(debug, "%zu BC ranges merged into %zu disjoint ranges", bcRanges.size(), bcRangesMerged.size());
 
-    for (auto& range : bcRanges) {
-      tags(range.getMin().toLong(), range.getMax().toLong());
+    tags.reserve(bcRangesMerged.size());
+    for (auto& range : bcRangesMerged) {
+      tags(range.first, range.second);
     }
   }
 
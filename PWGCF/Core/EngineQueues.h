@@ -0,0 +1,89 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef O2_ANALYSIS_ENGINEQUEUES_H
+#define O2_ANALYSIS_ENGINEQUEUES_H
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Queues of work items for a set of engines owning disjoint outputs, e.g. one per centrality class
+//
+// The items are queued on the calling thread and the queues are drained by a pool of threads. A queue is
+// drained by a single thread, in the order of the items, so the engines do not need any locking of their
+// outputs. The threads take the next not started queue, the longest ones first, until all of them are drained.
+
+namespace o2::analysis
+{
+
+template <typename TItem>
+class EngineQueues
+{
+ public:
+  /// \param nEngines number of engines, each gets its own queue
+  void init(int nEngines)
+  {
+    mQueues.clear();
+    mQueues.resize(nEngines);
+  }
+
+  void push(int engine, TItem item) { mQueues[engine].push_back(std::move(item)); }
+
+  /// Calls process(engine, item) for all the queued items and empties the queues
+  /// \param nThreads maximum number of threads, with one thread the items are processed on the calling thread
+  template <typename TProcess>
+  void drain(int nThreads, TProcess process)
+  {
+    const int nQueues = mQueues.size();
+    auto drainQueue = [&](int engine) {
+      for (auto& item : mQueues[engine]) {
+        process(engine, item);
+      }
+      mQueues[engine].clear();
+    };
+
+    const int nWorkers = std::min(nThreads, static_cast<int>(std::count_if(mQueues.begin(), mQueues.end(), [](const auto& queue) { return !queue.empty(); })));
+    if (nWorkers <= 1) {
+      for (int engine = 0; engine < nQueues; ++engine) {
+        drainQueue(engine);
+      }
+      return;
+    }
+    mOrder.resize(nQueues);
+    for (int engine = 0; engine < nQueues; ++engine) {
+      mOrder[engine] = engine;
+    }
+    std::stable_sort(mOrder.begin(), mOrder.end(), [this](int e1, int e2) { return mQueues[e1].size() > mQueues[e2].size(); });
+    std::atomic<int> nextQueue{0};
+    std::vector<std::thread> workers;
+    for (int i = 0; i < nWorkers; ++i) {
+      workers.emplace_back([&]() {
+        for (int next = nextQueue++; next < nQueues; next = nextQueue++) {
+          drainQueue(mOrder[next]);
+        }
+      });
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  }
+
+ private:
+  std::vector<std::vector<TItem>> mQueues;
+  std::vector<int> mOrder; // order in which the queues are taken by the threads
+};
+
+} // namespace o2::analysis
+
+#endif
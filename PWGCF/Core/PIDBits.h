@@ -0,0 +1,82 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef O2_ANALYSIS_PIDBITS_H
+#define O2_ANALYSIS_PIDBITS_H
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+// Packed n_sigma selections of a track, shared by the femto producers through the FemtoPIDBits table
+//
+// The layout is the one of the PID container of FemtoDream: for each threshold, from the loosest one, and for
+// each species, the bit of the TPC selection and then the bit of the combined TPC-TOF selection. The first
+// bit is the highest one and the lowest bit is always zero, so that the masks of the cutculator stay valid.
+
+namespace o2::analysis::pidbits
+{
+
+/// Sorts the thresholds from the loosest one, as they are ordered in the container
+inline std::vector<float> sortThresholds(std::vector<float> thresholds)
+{
+  std::sort(thresholds.begin(), thresholds.end(), std::greater<float>());
+  return thresholds;
+}
+
+/// \param nSigmaTPC, nSigmaTOF n_sigma of the track for each species, 999 for the TOF of a track without TOF signal
+/// \param thresholds upper limits of |n_sigma|, sorted by sortThresholds
+template <typename T>
+T pack(const float* nSigmaTPC, const float* nSigmaTOF, size_t nSpecies, const std::vector<float>& thresholds, float offsetTPC, float offsetTOF)
+{
+  T bits = 0;
+  for (auto threshold : thresholds) {
+    for (size_t i = 0; i < nSpecies; ++i) {
+      const float tpc = nSigmaTPC[i] - offsetTPC;
+      const float tof = nSigmaTOF[i] - offsetTOF;
+      const float comb = std::sqrt(tpc * tpc + tof * tof);
+      if (std::abs(tpc) < threshold) {
+        bits |= 1U;
+      }
+      bits <<= 1;
+      if (comb < threshold) {
+        bits |= 1U;
+      }
+      bits <<= 1;
+    }
+  }
+  return bits;
+}
+
+/// \return whether the TPC selection of a species at a threshold is fulfilled
+template <typename T>
+bool tpcBit(T bits, size_t nSpecies, size_t nThresholds, size_t iThreshold, size_t iSpecies)
+{
+  const size_t position = 2 * (nThresholds * nSpecies - iThreshold * nSpecies - iSpecies);
+  return (bits >> position) & 1U;
+}
+
+/// \return whether the TPC selection at the loosest threshold is fulfilled for any of the species
+template <typename T>
+bool passesLoosestTPC(T bits, size_t nSpecies, size_t nThresholds)
+{
+  for (size_t i = 0; i < nSpecies; ++i) {
+    if (tpcBit(bits, nSpecies, nThresholds, 0, i)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace o2::analysis::pidbits
+
+#endif
@@ -13,10 +13,12 @@
 #define O2_ANALYSIS_PAIRCUTS_H
 
 #include <cmath>
+#include <vector>
 
 #include "Framework/Logger.h"
 #include "Framework/HistogramRegistry.h"
 #include "CommonConstants/MathConstants.h"
+#include "PWGCF/Core/PhiStar.h"
 
 // Functions which cut on particle pairs (decays, conversions, two-track cuts)
 //
@@ -52,6 +54,7 @@ class PairCuts
     LOGF(info, "Enabled two-track cut with distance %f and radius %f", distance, radius);
     mTwoTrackDistance = distance;
     mTwoTrackRadius = radius;
+    setTwoTrackRadii();
 
     if (histogramRegistry != nullptr && histogramRegistry->contains(HIST("TwoTrackDistancePt_0")) == false) {
       histogramRegistry->add("TwoTrackDistancePt_0", "", {HistType::kTH3F, {{100, -0.15, 0.15, "#Delta#eta"}, {100, -0.05, 0.05, "#Delta#varphi^{*}_{min}"}, {20, 0, 10, "#Delta p_{T}"}}});
@@ -65,6 +68,18 @@ class PairCuts
   template <typename T>
   bool twoTrackCut(T const& track1, T const& track2, int magField);
 
+  /// Charge-signed bendings of a track at the radii of the two-track cut, filled on first use.
+  /// The caller owns getNTwoTrackRadii() values per track and reuses them for all the pairs of the track in an event.
+  struct TwoTrackShifts {
+    double* values = nullptr;
+    int nFilled = 0;
+  };
+  int getNTwoTrackRadii() const { return mTwoTrackRadii.size(); }
+
+  /// Same as twoTrackCut above, with the bendings of the tracks kept across the pairs
+  template <typename T>
+  bool twoTrackCut(T const& track1, T const& track2, int magField, TwoTrackShifts& shifts1, TwoTrackShifts& shifts2);
+
  protected:
   float mCuts[ParticlesLastEntry] = {-1};
   float mTwoTrackDistance = -1; // distance below which the pair is flagged as to be removed
@@ -72,6 +87,22 @@ class PairCuts
 
   HistogramRegistry* histogramRegistry = nullptr; // if set, control histograms are stored here
 
+  std::vector<float> mTwoTrackRadii = {};     // mTwoTrackRadius, 2.5 and the scanned radii of the two-track cut
+  std::vector<double> mScratchShifts[2] = {}; // bendings of the pair for the two-track cut without kept bendings
+
+  void setTwoTrackRadii()
+  {
+    mTwoTrackRadii = {mTwoTrackRadius, 2.5f};
+    for (Double_t rad = mTwoTrackRadius; rad < 2.51; rad += 0.01) {
+      mTwoTrackRadii.push_back(rad);
+    }
+  }
+
+  template <typename T>
+  void fillTwoTrackShifts(T const& track, int magField, TwoTrackShifts& shifts, int nRadii);
+
+  static float foldDPhiStar(float dphistar);
+
   template <typename T>
   bool conversionCut(T const& track1, T const& track2, Particle conv, double cut);
 
@@ -112,27 +143,59 @@ bool PairCuts::conversionCuts(T const& track1, T const& track2)
 
 template <typename T>
 bool PairCuts::twoTrackCut(T const& track1, T const& track2, int magField)
+{
+  if (mTwoTrackRadii.empty()) {
+    setTwoTrackRadii();
+  }
+  for (auto& scratch : mScratchShifts) {
+    scratch.resize(mTwoTrackRadii.size());
+  }
+  TwoTrackShifts shifts1{mScratchShifts[0].data(), 0};
+  TwoTrackShifts shifts2{mScratchShifts[1].data(), 0};
+  return twoTrackCut(track1, track2, magField, shifts1, shifts2);
+}
+
+template <typename T>
+void PairCuts::fillTwoTrackShifts(T const& track, int magField, TwoTrackShifts& shifts, int nRadii)
+{
+  if (shifts.nFilled >= nRadii) {
+    return;
+  }
+  o2::analysis::phistar::fillShifts(0.015 * magField, track.pt(), track.sign(), mTwoTrackRadii.data() + shifts.nFilled, nRadii - shifts.nFilled, shifts.values + shifts.nFilled);
+  shifts.nFilled = nRadii;
+}
+
+template <typename T>
+bool PairCuts::twoTrackCut(T const& track1, T const& track2, int magField, TwoTrackShifts& shifts1, TwoTrackShifts& shifts2)
 {
   // the variables & cut have been developed in Run 1 by the CF - HBT group
   //
   // Parameters:
   //   magField: B field in kG
+  //
+  // Same as getDPhiStar at each radius, with the bendings of the tracks computed once
 
   auto deta = track1.eta() - track2.eta();
 
   // optimization
   if (std::fabs(deta) < mTwoTrackDistance * 2.5 * 3) {
     // check first boundaries to see if is worth to loop and find the minimum
-    float dphistar1 = getDPhiStar(track1, track2, mTwoTrackRadius, magField);
-    float dphistar2 = getDPhiStar(track1, track2, 2.5, magField);
+    fillTwoTrackShifts(track1, magField, shifts1, 2);
+    fillTwoTrackShifts(track2, magField, shifts2, 2);
+    const float dphi = track1.phi() - track2.phi();
+    float dphistar1 = foldDPhiStar(dphi - shifts1.values[0] + shifts2.values[0]);
+    float dphistar2 = foldDPhiStar(dphi - shifts1.values[1] + shifts2.values[1]);
 
     const float kLimit = mTwoTrackDistance * 3;
 
     if (std::fabs(dphistar1) < kLimit || std::fabs(dphistar2) < kLimit || dphistar1 * dphistar2 < 0) {
+      const int nRadii = mTwoTrackRadii.size();
+      fillTwoTrackShifts(track1, magField, shifts1, nRadii);
+      fillTwoTrackShifts(track2, magField, shifts2, nRadii);
       float dphistarminabs = 1e5;
       float dphistarmin = 1e5;
-      for (Double_t rad = mTwoTrackRadius; rad < 2.51; rad += 0.01) {
-        float dphistar = getDPhiStar(track1, track2, rad, magField);
+      for (int i = 2; i < nRadii; i++) {
+        float dphistar = foldDPhiStar(dphi - shifts1.values[i] + shifts2.values[i]);
 
         float dphistarabs = std::fabs(dphistar);
 
@@ -326,6 +389,11 @@ float PairCuts::getDPhiStar(T const& track1, T const& track2, float radius, int
 
   float dphistar = phi1 - phi2 - charge1 * std::asin(0.015 * magField * radius / pt1) + charge2 * std::asin(0.015 * magField * radius / pt2);
 
+  return foldDPhiStar(dphistar);
+}
+
+inline float PairCuts::foldDPhiStar(float dphistar)
+{
   if (dphistar > PI) {
     dphistar = TwoPI - dphistar;
   }
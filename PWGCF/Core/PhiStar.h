@@ -0,0 +1,55 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef O2_ANALYSIS_PHISTAR_H
+#define O2_ANALYSIS_PHISTAR_H
+
+#include <cmath>
+
+// Azimuthal angle of the tracks at given radii (phi*), shared by the two-track and close-pair cuts
+//
+// The bending asin(scale * R / pT) of a track is computed once per track and event for all the radii,
+// so that the pair loops only combine precomputed values. The loops over the radii are plain loops over
+// contiguous arrays, which the compiler vectorises.
+
+namespace o2::analysis::phistar
+{
+
+/// Fills the bending of a unit-charge track at each radius
+/// \param scale is the factor of the curvature, e.g. 0.015 * B for B in kG and R in m
+/// \param bendings has to hold nRadii values
+inline void fillBendings(double scale, float pt, const float* radii, int nRadii, double* bendings)
+{
+  for (int i = 0; i < nRadii; i++) {
+    bendings[i] = std::asin(scale * radii[i] / pt);
+  }
+}
+
+/// Fills the charge-signed bending of a track at each radius, phi*(R) - phi = -shifts[R]
+inline void fillShifts(double scale, float pt, int charge, const float* radii, int nRadii, double* shifts)
+{
+  fillBendings(scale, pt, radii, nRadii, shifts);
+  for (int i = 0; i < nRadii; i++) {
+    shifts[i] *= charge;
+  }
+}
+
+/// Fills phi* of a track at each radius from its charge-signed bendings
+inline void fillPhiStar(float phi, const double* shifts, int nRadii, float* phiStar)
+{
+  for (int i = 0; i < nRadii; i++) {
+    phiStar[i] = phi - shifts[i];
+  }
+}
+
+} // namespace o2::analysis::phistar
+
+#endif
@@ -250,6 +250,14 @@ DECLARE_SOA_COLUMN(Bin, bin, int); //! Hash for the event mixing
 DECLARE_SOA_TABLE(Hashes, "AOD", "HASH", hash::Bin);
 using Hash = Hashes::iterator;
 
+/// PID bits of the tracks, computed once for all the femto producers of a workflow
+namespace femtopidbits
+{
+DECLARE_SOA_COLUMN(PIDBits, pidBits, femtodreamparticle::cutContainerType); //! n_sigma selections of the track, in the layout of pidbits::pack
+} // namespace femtopidbits
+DECLARE_SOA_TABLE(FemtoPIDBits, "AOD", "FEMTOPIDBITS", //! Table joinable to the tracks with their packed PID selections
+                  femtopidbits::PIDBits);
+
 } // namespace o2::aod
 
 #endif // PWGCF_DATAMODEL_FEMTODERIVED_H_
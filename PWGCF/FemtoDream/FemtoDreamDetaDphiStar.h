@@ -18,9 +18,11 @@
 
 #include <memory>
 #include <string>
+#include <array>
 #include <vector>
 #include "PWGCF/DataModel/FemtoDerived.h"
 #include "Framework/HistogramRegistry.h"
+#include "PWGCF/Core/PhiStar.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -103,26 +105,34 @@ class FemtoDreamDetaDphiStar
         return false;
       }
 
-      bool pass = false;
-      for (int i = 0; i < 2; i++) {
-        auto indexOfDaughter = part2.index() - 2 + i;
-        auto daughter = particles.begin() + indexOfDaughter;
-        auto deta = part1.eta() - daughter.eta();
-        auto dphiAvg = AveragePhiStar(part1, *daughter, i);
-        histdetadpi[i][0]->Fill(deta, dphiAvg);
-        if (pow(dphiAvg, 2) / pow(deltaPhiMax, 2) + pow(deta, 2) / pow(deltaEtaMax, 2) < 1.) {
-          pass = true;
-        } else {
-          histdetadpi[i][1]->Fill(deta, dphiAvg);
-        }
-      }
-      return pass;
+      return isClosePairToChildren(part1, *(particles.begin() + part2.index() - 2), *(particles.begin() + part2.index() - 1), lmagfield);
     } else {
       LOG(fatal) << "FemtoDreamPairCleaner: Combination of objects not defined - quitting!";
       return false;
     }
   }
 
+  ///  Check if a track is close to one of the children of a V0
+  /// The children are passed explicitly, e.g. for the V0s of pooled mixed events
+  template <typename Part, typename Child>
+  bool isClosePairToChildren(Part const& part1, Child const& posChild, Child const& negChild, float lmagfield)
+  {
+    magfield = lmagfield;
+    bool pass = false;
+    for (int i = 0; i < 2; i++) {
+      const auto& daughter = i == 0 ? posChild : negChild;
+      auto deta = part1.eta() - daughter.eta();
+      auto dphiAvg = AveragePhiStar(part1, daughter, i);
+      histdetadpi[i][0]->Fill(deta, dphiAvg);
+      if (pow(dphiAvg, 2) / pow(deltaPhiMax, 2) + pow(deta, 2) / pow(deltaEtaMax, 2) < 1.) {
+        pass = true;
+      } else {
+        histdetadpi[i][1]->Fill(deta, dphiAvg);
+      }
+    }
+    return pass;
+  }
+
  private:
   HistogramRegistry* mHistogramRegistry = nullptr;   ///< For main output
   HistogramRegistry* mHistogramRegistryQA = nullptr; ///< For QA output
@@ -140,7 +150,8 @@ class FemtoDreamDetaDphiStar
   static constexpr o2::aod::femtodreamparticle::ParticleType mPartOneType = partOne; ///< Type of particle 1
   static constexpr o2::aod::femtodreamparticle::ParticleType mPartTwoType = partTwo; ///< Type of particle 2
 
-  static constexpr float tmpRadiiTPC[9] = {85., 105., 125., 145., 165., 185., 205., 225., 245.};
+  static constexpr int kNRadiiTPC = 9;
+  static constexpr float tmpRadiiTPC[kNRadiiTPC] = {85., 105., 125., 145., 165., 185., 205., 225., 245.};
 
   static constexpr uint32_t kSignMinusMask = 1;
   static constexpr uint32_t kSignPlusMask = 1 << 1;
@@ -154,10 +165,17 @@ class FemtoDreamDetaDphiStar
   std::array<std::array<std::shared_ptr<TH2>, 2>, 2> histdetadpi{};
   std::array<std::array<std::shared_ptr<TH2>, 9>, 2> histdetadpiRadii{};
 
+  /// phi* of the last first particle, reused while the pair loop keeps the same first particle
+  std::array<float, kNRadiiTPC> phiStarPart1{};
+  int64_t phiStarPart1Index = -1;
+  float phiStarPart1Phi = 0.;
+  float phiStarPart1Pt = 0.;
+  float phiStarPart1Magfield = 0.;
+
   ///  Calculate phi at all required radii stored in tmpRadiiTPC
   /// Magnetic field to be provided in Tesla
   template <typename T>
-  void PhiAtRadiiTPC(const T& part, std::vector<float>& tmpVec)
+  void PhiAtRadiiTPC(const T& part, std::array<float, kNRadiiTPC>& phiStar)
   {
 
     float phi0 = part.phi();
@@ -173,31 +191,36 @@ class FemtoDreamDetaDphiStar
       LOG(fatal) << "FemtoDreamDetaDphiStar: Charge bits are set wrong!";
     }
     // End: Get the charge from cutcontainer using masks
-    float pt = part.pt();
-    for (size_t i = 0; i < 9; i++) {
-      tmpVec.push_back(phi0 - std::asin(0.3 * charge * 0.1 * magfield * tmpRadiiTPC[i] * 0.01 / (2. * pt)));
-    }
+    // phi* = phi0 - asin(0.3 * charge * 0.1 * magfield * R * 0.01 / (2 * pt)), with one asin per radius
+    double shifts[kNRadiiTPC];
+    o2::analysis::phistar::fillShifts(0.3 * 0.1 * magfield * 0.01 / 2., part.pt(), static_cast<int>(charge), tmpRadiiTPC, kNRadiiTPC, shifts);
+    o2::analysis::phistar::fillPhiStar(phi0, shifts, kNRadiiTPC, phiStar.data());
   }
 
   ///  Calculate average phi
   template <typename T1, typename T2>
   float AveragePhiStar(const T1& part1, const T2& part2, int iHist)
   {
-    std::vector<float> tmpVec1;
-    std::vector<float> tmpVec2;
-    PhiAtRadiiTPC(part1, tmpVec1);
-    PhiAtRadiiTPC(part2, tmpVec2);
-    int num = tmpVec1.size();
+    // the kinematics are compared as well, the indices restart with each data frame
+    if (part1.globalIndex() != phiStarPart1Index || part1.phi() != phiStarPart1Phi || part1.pt() != phiStarPart1Pt || magfield != phiStarPart1Magfield) {
+      PhiAtRadiiTPC(part1, phiStarPart1);
+      phiStarPart1Index = part1.globalIndex();
+      phiStarPart1Phi = part1.phi();
+      phiStarPart1Pt = part1.pt();
+      phiStarPart1Magfield = magfield;
+    }
+    std::array<float, kNRadiiTPC> phiStarPart2;
+    PhiAtRadiiTPC(part2, phiStarPart2);
     float dPhiAvg = 0;
-    for (int i = 0; i < num; i++) {
-      float dphi = tmpVec1.at(i) - tmpVec2.at(i);
+    for (int i = 0; i < kNRadiiTPC; i++) {
+      float dphi = phiStarPart1[i] - phiStarPart2[i];
       dphi = TVector2::Phi_mpi_pi(dphi);
       dPhiAvg += dphi;
       if (plotForEveryRadii) {
         histdetadpiRadii[iHist][i]->Fill(part1.eta() - part2.eta(), dphi);
       }
     }
-    return dPhiAvg / num;
+    return dPhiAvg / static_cast<float>(kNRadiiTPC);
   }
 };
 
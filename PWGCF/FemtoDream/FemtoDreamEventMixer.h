@@ -0,0 +1,178 @@
+// Copyright 2019-2022 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file FemtoDreamEventMixer.h
+/// \brief FemtoDreamEventMixer - Pools of the last events of each mixing bin, stored as compact particle records
+
+#ifndef PWGCF_FEMTODREAM_FEMTODREAMEVENTMIXER_H_
+#define PWGCF_FEMTODREAM_FEMTODREAMEVENTMIXER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "PWGCF/DataModel/FemtoDerived.h"
+
+namespace o2::analysis::femtoDream
+{
+
+namespace femtoDreamEventMixer
+{
+
+/// Monte Carlo truth of a particle record, with the accessors of the femtodreamMCparticle table
+struct MCParticleRecord {
+  float mPt = 0.f;
+  float mEta = 0.f;
+  float mPhi = 0.f;
+  int mPDG = 0;
+
+  float pt() const { return mPt; }
+  float eta() const { return mEta; }
+  float phi() const { return mPhi; }
+  int pdgMCTruth() const { return mPDG; }
+};
+
+/// Particle of a pooled event, with the accessors of the femtodreamparticle table used by the pair containers,
+/// the close pair rejection and the pair cleaner
+struct ParticleRecord {
+  float mPt = 0.f;
+  float mEta = 0.f;
+  float mPhi = 0.f;
+  aod::femtodreamparticle::cutContainerType mCut = 0;
+  int64_t mGlobalIndex = -1;
+  uint8_t mPartType = 0;
+  bool mHasMC = false;
+  MCParticleRecord mMC{};
+
+  float pt() const { return mPt; }
+  float eta() const { return mEta; }
+  float phi() const { return mPhi; }
+  aod::femtodreamparticle::cutContainerType cut() const { return mCut; }
+  int64_t globalIndex() const { return mGlobalIndex; }
+  uint8_t partType() const { return mPartType; }
+  bool has_fdMCParticle() const { return mHasMC; }
+  const MCParticleRecord& fdMCParticle() const { return mMC; }
+
+  /// Fills the record from a row of the femtodreamparticle table
+  /// \tparam isMC also stores the Monte Carlo truth, the row has to be joined with the labels
+  template <bool isMC, typename T>
+  void set(T const& part)
+  {
+    mPt = part.pt();
+    mEta = part.eta();
+    mPhi = part.phi();
+    mCut = part.cut();
+    mGlobalIndex = part.globalIndex();
+    mPartType = part.partType();
+    if constexpr (isMC) {
+      mHasMC = part.has_fdMCParticle();
+      if (mHasMC) {
+        const auto& mcPart = part.fdMCParticle();
+        mMC = {mcPart.pt(), mcPart.eta(), mcPart.phi(), mcPart.pdgMCTruth()};
+      }
+    }
+  }
+};
+
+/// Event of a pool: the selected particles of both species and, for the V0s of partsTwo, their children
+/// The children of partsTwo[i] are children[2 * i] (positive) and children[2 * i + 1] (negative)
+struct Event {
+  float mMagField = 0.f;
+  int mMult = 0;
+  std::vector<ParticleRecord> partsOne;
+  std::vector<ParticleRecord> partsTwo;
+  std::vector<ParticleRecord> children;
+
+  void clear(float magField, int mult)
+  {
+    mMagField = magField;
+    mMult = mult;
+    partsOne.clear();
+    partsTwo.clear();
+    children.clear();
+  }
+};
+
+} // namespace femtoDreamEventMixer
+
+/// \class FemtoDreamEventMixer
+/// \brief Keeps, for each mixing bin, a ring buffer with the last events of the bin
+/// Each new event is mixed with the pooled events of its bin, and then takes the place of the oldest one.
+/// With the events passed in the order of the collision table, this gives the pairs of events of
+/// soa::selfCombinations with the same number of neighbours, and the particles of an event are read from
+/// the tables only once. The record vectors of the pools are reused from one event to the next.
+class FemtoDreamEventMixer
+{
+ public:
+  using Event = femtoDreamEventMixer::Event;
+
+  /// \param depth number of events of a bin each event is mixed with
+  void init(int depth)
+  {
+    mDepth = depth > 0 ? depth : 1;
+    mPools.clear();
+  }
+
+  /// Empties the pools, without releasing the memory of the records
+  void reset()
+  {
+    for (auto& pool : mPools) {
+      pool.next = 0;
+      pool.nFilled = 0;
+    }
+  }
+
+  /// \param bin mixing bin of the collision, the pools are created when the bins are first used
+  /// \return the event to be filled with the particles of the current collision of the bin
+  Event& newEvent(int bin, float magField, int mult)
+  {
+    if (bin >= static_cast<int>(mPools.size())) {
+      mPools.resize(bin + 1);
+    }
+    auto& pool = mPools[bin];
+    if (pool.events.empty()) {
+      pool.events.resize(mDepth + 1);
+    }
+    auto& event = pool.events[pool.next];
+    event.clear(magField, mult);
+    return event;
+  }
+
+  /// Calls process(pooled, current) for each pooled event of the bin, from the oldest, with the event filled
+  /// last by newEvent(), and adds the current event to the pool
+  template <typename TProcess>
+  void mixEvent(int bin, TProcess process)
+  {
+    auto& pool = mPools[bin];
+    const int nSlots = mDepth + 1;
+    const auto& current = pool.events[pool.next];
+    for (int i = pool.nFilled; i > 0; --i) {
+      process(pool.events[(pool.next + nSlots - i) % nSlots], current);
+    }
+    pool.next = (pool.next + 1) % nSlots;
+    if (pool.nFilled < mDepth) {
+      pool.nFilled++;
+    }
+  }
+
+ private:
+  struct Pool {
+    std::vector<Event> events; ///< ring buffer, with one slot for the current event
+    int next = 0;              ///< slot of the next event
+    int nFilled = 0;           ///< number of pooled events
+  };
+
+  int mDepth = 1;
+  std::vector<Pool> mPools;
+};
+
+} // namespace o2::analysis::femtoDream
+
+#endif // PWGCF_FEMTODREAM_FEMTODREAMEVENTMIXER_H_
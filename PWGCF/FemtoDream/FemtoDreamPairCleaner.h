@@ -16,6 +16,10 @@
 #ifndef PWGCF_FEMTODREAM_FEMTODREAMPAIRCLEANER_H_
 #define PWGCF_FEMTODREAM_FEMTODREAMPAIRCLEANER_H_
 
+#include <array>
+#include <cstdint>
+#include <vector>
+
 #include "PWGCF/DataModel/FemtoDerived.h"
 #include "Framework/HistogramRegistry.h"
 
@@ -45,6 +49,44 @@ class FemtoDreamPairCleaner
     }
   }
 
+  /// Stores which tracks of a collision are children of its V0s, for the Track-V0 combination
+  /// The children of a V0 are stored in the two rows before it, and their childrenIds give the position of
+  /// the corresponding track among the rows of the collision. With the map, the cleaning of a pair is a
+  /// lookup instead of reading the children rows.
+  /// \tparam Parts Data type of the collection of particles of the collision
+  /// \param particlesOfCollision All the particles of the collision, in the order of the table
+  template <typename Parts>
+  void setCollision(Parts const& particlesOfCollision)
+  {
+    if constexpr (mPartOneType == o2::aod::femtodreamparticle::ParticleType::kTrack && mPartTwoType == o2::aod::femtodreamparticle::ParticleType::kV0) {
+      const int64_t nRows = particlesOfCollision.size();
+      mFirstRow = -1;
+      mIsV0Child.assign(nRows, false);
+      mV0Children.assign(nRows, {-1, -1});
+      // the positive child stores its track in the first entry of childrenIds, the negative one in the second
+      int64_t posChildTrack = -1;  // first entry of the children row before the last one
+      int64_t lastFirstEntry = -1; // first entry of the last children row
+      int64_t negChildTrack = -1;  // second entry of the last children row
+      for (auto const& part : particlesOfCollision) {
+        if (mFirstRow < 0) {
+          mFirstRow = part.globalIndex();
+        }
+        if (part.partType() == o2::aod::femtodreamparticle::ParticleType::kV0Child) {
+          posChildTrack = lastFirstEntry;
+          lastFirstEntry = part.childrenIds()[0];
+          negChildTrack = part.childrenIds()[1];
+        } else if (part.partType() == o2::aod::femtodreamparticle::ParticleType::kV0) {
+          mV0Children[part.globalIndex() - mFirstRow] = {posChildTrack, negChildTrack};
+          for (const auto& child : mV0Children[part.globalIndex() - mFirstRow]) {
+            if (child >= 0 && child < nRows) {
+              mIsV0Child[child] = true;
+            }
+          }
+        }
+      }
+    }
+  }
+
   /// Check whether a given pair has shared tracks
   /// \tparam Part Data type of the particle
   /// \tparam Parts Data type of the collection of all particles
@@ -68,6 +110,18 @@ class FemtoDreamPairCleaner
         LOG(fatal) << "FemtoDreamPairCleaner: passed arguments don't agree with FemtoDreamPairCleaner instantiation! Please provide second argument kV0 candidate.";
         return false;
       }
+      if (mFirstRow >= 0) {
+        // lookup in the map of the collision set by setCollision
+        const int64_t track = part1.globalIndex() - mFirstRow;
+        if (track < 0 || track >= static_cast<int64_t>(mIsV0Child.size()) || !mIsV0Child[track]) {
+          return true;
+        }
+        const int64_t v0 = part2.globalIndex() - mFirstRow;
+        if (v0 < 0 || v0 >= static_cast<int64_t>(mV0Children.size())) {
+          return true;
+        }
+        return track != mV0Children[v0][0] && track != mV0Children[v0][1];
+      }
       const auto& posChild = particles.iteratorAt(part2.index() - 2);
       const auto& negChild = particles.iteratorAt(part2.index() - 1);
       if (part1.globalIndex() != posChild.globalIndex() || part2.globalIndex() != negChild.globalIndex()) {
@@ -82,6 +136,9 @@ class FemtoDreamPairCleaner
 
  private:
   HistogramRegistry* mHistogramRegistry;                                             ///< For QA output
+  int64_t mFirstRow = -1;                                                            ///< First row of the collision set by setCollision, -1 if none
+  std::vector<bool> mIsV0Child;                                                      ///< Whether the row of the collision is a track used as V0 child
+  std::vector<std::array<int64_t, 2>> mV0Children;                                   ///< Rows of the tracks of the children of the V0 rows of the collision
   static constexpr o2::aod::femtodreamparticle::ParticleType mPartOneType = partOne; ///< Type of particle 1
   static constexpr o2::aod::femtodreamparticle::ParticleType mPartTwoType = partTwo; ///< Type of particle 2
 };
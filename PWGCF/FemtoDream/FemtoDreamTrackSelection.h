@@ -130,21 +130,26 @@ class FemtoDreamTrackSelection : public FemtoDreamObjectSelection<float, femtoDr
   auto getNsigmaTOF(T const& track, o2::track::PID pid);
 
   /// Checks whether the most open combination of all selection criteria is fulfilled
+  /// \tparam checkPID Whether the PID selection is checked, otherwise it is left to the PID bits of the FemtoPIDBits table
   /// \tparam T Data type of the track
   /// \param track Track
   /// \return Whether the most open combination of all selection criteria is fulfilled
-  template <typename T>
+  template <bool checkPID = true, typename T>
   bool isSelectedMinimal(T const& track);
 
   /// Obtain the bit-wise container for the selections
   /// \todo For the moment, PID is separated from the other selections, hence instead of a single value an std::array of size two is returned
   /// \tparam cutContainerType Data type of the bit-wise container for the selections
+  /// \tparam computePID Whether the PID container is computed, otherwise it is left empty for the PID bits of the FemtoPIDBits table
   /// \tparam T Data type of the track
   /// \param track Track
   /// \return The bit-wise container for the selections, separately with all selection criteria, and the PID
-  template <typename cutContainerType, typename T>
+  template <typename cutContainerType, bool computePID = true, typename T>
   std::array<cutContainerType, 2> getCutContainer(T const& track);
 
+  /// Number of particle species of the PID selection
+  size_t getNPIDSpecies() const { return mPIDspecies.size(); }
+
   /// Some basic QA histograms
   /// \tparam part Type of the particle for proper naming of the folders for QA
   /// \tparam tracktype Type of track (track, positive child, negative child) for proper naming of the folders for QA
@@ -242,6 +247,8 @@ class FemtoDreamTrackSelection : public FemtoDreamObjectSelection<float, femtoDr
   float nSigmaPIDOffsetTPC;
   float nSigmaPIDOffsetTOF;
   std::vector<o2::track::PID> mPIDspecies; ///< All the particle species for which the n_sigma values need to be stored
+  std::vector<float> mPidTPC;              ///< TPC n_sigma of the species for the current track
+  std::vector<float> mPidTOF;              ///< TOF n_sigma of the species for the current track
   static constexpr int kNtrackSelection = 14;
   static constexpr std::string_view mSelectionNames[kNtrackSelection] = {"Sign",
                                                                          "PtMin",
@@ -380,7 +387,7 @@ auto FemtoDreamTrackSelection::getNsigmaTOF(T const& track, o2::track::PID pid)
   return o2::aod::pidutils::tofNSigma(pid, track);
 }
 
-template <typename T>
+template <bool checkPID, typename T>
 bool FemtoDreamTrackSelection::isSelectedMinimal(T const& track)
 {
   const auto pT = track.pt();
@@ -395,12 +402,6 @@ bool FemtoDreamTrackSelection::isSelectedMinimal(T const& track)
   const auto dcaZ = track.dcaZ();
   const auto dca = track.dcaXY(); // Accordingly to FemtoDream in AliPhysics  as well as LF analysis,
                                   // only dcaXY should be checked; NOT std::sqrt(pow(dcaXY, 2.) + pow(dcaZ, 2.))
-  std::vector<float> pidTPC, pidTOF;
-  for (auto it : mPIDspecies) {
-    pidTPC.push_back(getNsigmaTPC(track, it));
-    pidTOF.push_back(getNsigmaTOF(track, it));
-  }
-
   if (nPtMinSel > 0 && pT < pTMin) {
     return false;
   }
@@ -441,11 +442,10 @@ bool FemtoDreamTrackSelection::isSelectedMinimal(T const& track)
     return false;
   }
 
-  if (nPIDnSigmaSel > 0) {
+  if (checkPID && nPIDnSigmaSel > 0) {
     bool isFulfilled = false;
-    for (size_t i = 0; i < pidTPC.size(); ++i) {
-      auto pidTPCVal = pidTPC.at(i);
-      if (std::abs(pidTPCVal - nSigmaPIDOffsetTPC) < nSigmaPIDMax) {
+    for (auto it : mPIDspecies) {
+      if (std::abs(getNsigmaTPC(track, it) - nSigmaPIDOffsetTPC) < nSigmaPIDMax) {
         isFulfilled = true;
       }
     }
@@ -456,88 +456,55 @@ bool FemtoDreamTrackSelection::isSelectedMinimal(T const& track)
   return true;
 }
 
-template <typename cutContainerType, typename T>
+template <typename cutContainerType, bool computePID, typename T>
 std::array<cutContainerType, 2> FemtoDreamTrackSelection::getCutContainer(T const& track)
 {
   cutContainerType output = 0;
   size_t counter = 0;
   cutContainerType outputPID = 0;
-  const auto sign = track.sign();
-  const auto pT = track.pt();
-  const auto eta = track.eta();
-  const auto tpcNClsF = track.tpcNClsFound();
-  const auto tpcRClsC = track.tpcCrossedRowsOverFindableCls();
-  const auto tpcNClsC = track.tpcNClsCrossedRows();
-  const auto tpcNClsS = track.tpcNClsShared();
-  const auto itsNCls = track.itsNCls();
-  const auto itsNClsIB = track.itsNClsInnerBarrel();
-  const auto dcaXY = track.dcaXY();
-  const auto dcaZ = track.dcaZ();
-  const auto dca = std::sqrt(pow(dcaXY, 2.) + pow(dcaZ, 2.));
-
-  std::vector<float> pidTPC, pidTOF;
-  for (auto it : mPIDspecies) {
-    pidTPC.push_back(getNsigmaTPC(track, it));
-    pidTOF.push_back(getNsigmaTOF(track, it));
+  /// the observables are stored by selection variable, so that the selections read them without dispatching
+  float observables[kNtrackSelection];
+  observables[femtoDreamTrackSelection::kSign] = track.sign();
+  observables[femtoDreamTrackSelection::kpTMin] = track.pt();
+  observables[femtoDreamTrackSelection::kpTMax] = track.pt();
+  observables[femtoDreamTrackSelection::kEtaMax] = track.eta();
+  observables[femtoDreamTrackSelection::kTPCnClsMin] = track.tpcNClsFound();
+  observables[femtoDreamTrackSelection::kTPCfClsMin] = track.tpcCrossedRowsOverFindableCls();
+  observables[femtoDreamTrackSelection::kTPCcRowsMin] = track.tpcNClsCrossedRows();
+  observables[femtoDreamTrackSelection::kTPCsClsMax] = track.tpcNClsShared();
+  observables[femtoDreamTrackSelection::kITSnClsMin] = track.itsNCls();
+  observables[femtoDreamTrackSelection::kITSnClsIbMin] = track.itsNClsInnerBarrel();
+  observables[femtoDreamTrackSelection::kDCAxyMax] = track.dcaXY();
+  observables[femtoDreamTrackSelection::kDCAzMax] = track.dcaZ();
+  observables[femtoDreamTrackSelection::kDCAMin] = std::sqrt(pow(track.dcaXY(), 2.) + pow(track.dcaZ(), 2.));
+  observables[femtoDreamTrackSelection::kPIDnSigmaMax] = 0.;
+
+  /// the n_sigma values of the species are computed once, in buffers kept from one track to the next
+  if constexpr (computePID) {
+    mPidTPC.resize(mPIDspecies.size());
+    mPidTOF.resize(mPIDspecies.size());
+    for (size_t i = 0; i < mPIDspecies.size(); ++i) {
+      mPidTPC[i] = getNsigmaTPC(track, mPIDspecies[i]);
+      mPidTOF[i] = getNsigmaTOF(track, mPIDspecies[i]);
+    }
   }
 
-  float observable = 0.;
   for (auto& sel : mSelections) {
     const auto selVariable = sel.getSelectionVariable();
     if (selVariable == femtoDreamTrackSelection::kPIDnSigmaMax) {
+      if constexpr (!computePID) {
+        continue;
+      }
       /// PID needs to be handled a bit differently since we may need more than one species
       for (size_t i = 0; i < mPIDspecies.size(); ++i) {
-        auto pidTPCVal = pidTPC.at(i) - nSigmaPIDOffsetTPC;
-        auto pidTOFVal = pidTOF.at(i) - nSigmaPIDOffsetTOF;
+        auto pidTPCVal = mPidTPC[i] - nSigmaPIDOffsetTPC;
+        auto pidTOFVal = mPidTOF[i] - nSigmaPIDOffsetTOF;
         auto pidComb = std::sqrt(pidTPCVal * pidTPCVal + pidTOFVal * pidTOFVal);
         sel.checkSelectionSetBitPID(pidTPCVal, outputPID);
         sel.checkSelectionSetBitPID(pidComb, outputPID);
       }
-
     } else {
-      /// for the rest it's all the same
-      switch (selVariable) {
-        case (femtoDreamTrackSelection::kSign):
-          observable = sign;
-          break;
-        case (femtoDreamTrackSelection::kpTMin):
-        case (femtoDreamTrackSelection::kpTMax):
-          observable = pT;
-          break;
-        case (femtoDreamTrackSelection::kEtaMax):
-          observable = eta;
-          break;
-        case (femtoDreamTrackSelection::kTPCnClsMin):
-          observable = tpcNClsF;
-          break;
-        case (femtoDreamTrackSelection::kTPCfClsMin):
-          observable = tpcRClsC;
-          break;
-        case (femtoDreamTrackSelection::kTPCcRowsMin):
-          observable = tpcNClsC;
-          break;
-        case (femtoDreamTrackSelection::kTPCsClsMax):
-          observable = tpcNClsS;
-          break;
-        case (femtoDreamTrackSelection::kITSnClsMin):
-          observable = itsNCls;
-          break;
-        case (femtoDreamTrackSelection::kITSnClsIbMin):
-          observable = itsNClsIB;
-          break;
-        case (femtoDreamTrackSelection::kDCAxyMax):
-          observable = dcaXY;
-          break;
-        case (femtoDreamTrackSelection::kDCAzMax):
-          observable = dcaZ;
-          break;
-        case (femtoDreamTrackSelection::kDCAMin):
-          observable = dca;
-          break;
-        case (femtoDreamTrackSelection::kPIDnSigmaMax):
-          break;
-      }
-      sel.checkSelectionSetBit(observable, output, counter);
+      sel.checkSelectionSetBit(observables[selVariable], output, counter);
     }
   }
   return {output, outputPID};
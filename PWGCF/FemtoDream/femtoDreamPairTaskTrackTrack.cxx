@@ -31,6 +31,7 @@
 #include "FemtoDreamPairCleaner.h"
 #include "FemtoDreamContainer.h"
 #include "FemtoDreamDetaDphiStar.h"
+#include "FemtoDreamEventMixer.h"
 #include "FemtoUtils.h"
 
 using namespace o2;
@@ -116,6 +117,7 @@ struct femtoDreamPairTaskTrackTrack {
   ConfigurableAxis ConfkTBins{"ConfkTBins", {150, 0., 9.}, "binning kT"};
   ConfigurableAxis ConfmTBins{"ConfmTBins", {225, 0., 7.5}, "binning mT"};
   Configurable<int> ConfNEventsMix{"ConfNEventsMix", 5, "Number of events for mixing"};
+  Configurable<bool> ConfMixAcrossDataFrames{"ConfMixAcrossDataFrames", false, "Keep the mixing pools from one data frame to the next"};
   Configurable<bool> ConfIsCPR{"ConfIsCPR", true, "Close Pair Rejection"};
   Configurable<bool> ConfCPRPlotPerRadii{"ConfCPRPlotPerRadii", false, "Plot CPR per radii"};
   Configurable<float> ConfCPRdeltaPhiMax{"ConfCPRdeltaPhiMax", 0.01, "Max. Delta Phi for Close Pair Rejection"};
@@ -125,6 +127,7 @@ struct femtoDreamPairTaskTrackTrack {
   FemtoDreamContainer<femtoDreamContainer::EventType::mixed, femtoDreamContainer::Observable::kstar> mixedEventCont;
   FemtoDreamPairCleaner<aod::femtodreamparticle::ParticleType::kTrack, aod::femtodreamparticle::ParticleType::kTrack> pairCleaner;
   FemtoDreamDetaDphiStar<aod::femtodreamparticle::ParticleType::kTrack, aod::femtodreamparticle::ParticleType::kTrack> pairCloseRejection;
+  FemtoDreamEventMixer eventMixer;
   /// Histogram output
   HistogramRegistry qaRegistry{"TrackQA", {}, OutputObjHandlingPolicy::AnalysisObject};
   HistogramRegistry resultRegistry{"Correlations", {}, OutputObjHandlingPolicy::AnalysisObject};
@@ -153,6 +156,7 @@ struct femtoDreamPairTaskTrackTrack {
     vPIDPartOne = ConfPIDPartOne.value;
     vPIDPartTwo = ConfPIDPartTwo.value;
     kNsigma = ConfTrkPIDnSigmaMax.value;
+    eventMixer.init(ConfNEventsMix);
   }
 
   template <typename CollisionType>
@@ -283,108 +287,111 @@ struct femtoDreamPairTaskTrackTrack {
   }
   PROCESS_SWITCH(femtoDreamPairTaskTrackTrack, processSameEventMC, "Enable processing same event for Monte Carlo", false);
 
-  /// This function processes the mixed event
-  /// \todo the trivial loops over the collisions and tracks should be factored out since they will be common to all combinations of T-T, T-V0, V0-V0, ...
-  /// \tparam PartitionType
-  /// \tparam PartType
-  /// \tparam isMC: enables Monte Carlo truth specific histograms
-  /// \param groupPartsOne partition for the first particle passed by the process function
-  /// \param groupPartsTwo partition for the second particle passed by the process function
-  /// \param parts femtoDreamParticles table (in case of Monte Carlo joined with FemtoDreamMCLabels)
-  /// \param magFieldTesla magnetic field of the collision
-  /// \param multCol multiplicity of the collision
-  template <bool isMC, typename PartitionType, typename PartType>
-  void doMixedEvent(PartitionType groupPartsOne, PartitionType groupPartsTwo, PartType parts, float magFieldTesla, int multCol)
+  /// Kinematic and PID selection of the particles, as applied in the pair loops
+  /// \param partName name of the particle in the cut table
+  /// \param vPID PID index of the particle from the cutCulator
+  template <typename PartType>
+  bool isSelectedParticle(PartType const& part, const char* partName, int vPID)
   {
-
-    for (auto& [p1, p2] : combinations(CombinationsFullIndexPolicy(groupPartsOne, groupPartsTwo))) {
-      if (p1.p() > ConfCutTable->get("PartOne", "MaxP") || p1.pt() > ConfCutTable->get("PartOne", "MaxPt") || p2.p() > ConfCutTable->get("PartTwo", "MaxP") || p2.pt() > ConfCutTable->get("PartTwo", "MaxPt")) {
-        continue;
-      }
-      if (!isFullPIDSelected(p1.pidcut(),
-                             p1.p(),
-                             ConfCutTable->get("PartOne", "PIDthr"),
-                             vPIDPartOne,
-                             ConfNspecies,
-                             kNsigma,
-                             ConfCutTable->get("PartOne", "nSigmaTPC"),
-                             ConfCutTable->get("PartOne", "nSigmaTPCTOF")) ||
-          !isFullPIDSelected(p2.pidcut(),
-                             p2.p(),
-                             ConfCutTable->get("PartTwo", "PIDthr"),
-                             vPIDPartTwo,
+    if (part.p() > ConfCutTable->get(partName, "MaxP") || part.pt() > ConfCutTable->get(partName, "MaxPt")) {
+      return false;
+    }
+    return isFullPIDSelected(part.pidcut(),
+                             part.p(),
+                             ConfCutTable->get(partName, "PIDthr"),
+                             vPID,
                              ConfNspecies,
                              kNsigma,
-                             ConfCutTable->get("PartTwo", "nSigmaTPC"),
-                             ConfCutTable->get("PartTwo", "nSigmaTPCTOF"))) {
-        continue;
+                             ConfCutTable->get(partName, "nSigmaTPC"),
+                             ConfCutTable->get(partName, "nSigmaTPCTOF"));
+  }
+
+  /// Stores the selected particles of a collision in its event of the mixing pools
+  /// \tparam isMC also stores the Monte Carlo truth of the particles
+  template <bool isMC, typename PartitionType>
+  void fillMixingEvent(FemtoDreamEventMixer::Event& event, PartitionType groupPartsOne, PartitionType groupPartsTwo)
+  {
+    for (auto& part : groupPartsOne) {
+      if (isSelectedParticle(part, "PartOne", vPIDPartOne)) {
+        event.partsOne.emplace_back().set<isMC>(part);
       }
+    }
+    for (auto& part : groupPartsTwo) {
+      if (isSelectedParticle(part, "PartTwo", vPIDPartTwo)) {
+        event.partsTwo.emplace_back().set<isMC>(part);
+      }
+    }
+  }
 
-      if (ConfIsCPR.value) {
-        if (pairCloseRejection.isClosePair(p1, p2, parts, magFieldTesla)) {
-          continue;
+  /// This function processes the mixed event of two pooled events
+  /// \tparam isMC: enables Monte Carlo truth specific histograms
+  /// \param event1 earlier event of the bin, providing the first particles, the magnetic field and the multiplicity
+  /// \param event2 later event of the bin, providing the second particles
+  /// \param bin mixing bin of the events
+  template <bool isMC>
+  void doMixedEvent(const FemtoDreamEventMixer::Event& event1, const FemtoDreamEventMixer::Event& event2, int bin)
+  {
+    MixQaRegistry.fill(HIST("MixingQA/hMECollisionBins"), bin);
+    if (event1.mMagField != event2.mMagField) {
+      return;
+    }
+    for (const auto& p1 : event1.partsOne) {
+      for (const auto& p2 : event2.partsTwo) {
+        if (ConfIsCPR.value) {
+          if (pairCloseRejection.isClosePair(p1, p2, event1.partsOne, event1.mMagField)) {
+            continue;
+          }
         }
+        mixedEventCont.setPair<isMC>(p1, p2, event1.mMult, ConfUse3D);
       }
+    }
+  }
 
-      mixedEventCont.setPair<isMC>(p1, p2, multCol, ConfUse3D);
+  /// Mixes each collision with the last ConfNEventsMix collisions of its bin
+  /// The particles of each collision are selected and stored in the mixing pools once, instead of for each pair of collisions
+  /// \tparam isMC: enables Monte Carlo truth specific histograms
+  /// \param cols collisions of the data frame
+  /// \param partitionOne partition for the first particle
+  /// \param partitionTwo partition for the second particle
+  template <bool isMC, typename PartitionType>
+  void doMixing(o2::aod::FDCollisions& cols, PartitionType& partitionOne, PartitionType& partitionTwo)
+  {
+    if (!ConfMixAcrossDataFrames) {
+      eventMixer.reset();
+    }
+    for (auto& col : cols) {
+      const int bin = colBinning.getBin({col.posZ(), col.multNtr()});
+      if (bin < 0) {
+        continue;
+      }
+      auto groupPartsOne = partitionOne->sliceByCached(aod::femtodreamparticle::fdCollisionId, col.globalIndex(), cache);
+      auto groupPartsTwo = partitionTwo->sliceByCached(aod::femtodreamparticle::fdCollisionId, col.globalIndex(), cache);
+      fillMixingEvent<isMC>(eventMixer.newEvent(bin, col.magField(), col.multNtr()), groupPartsOne, groupPartsTwo);
+      eventMixer.mixEvent(bin, [&](const FemtoDreamEventMixer::Event& pooled, const FemtoDreamEventMixer::Event& current) {
+        doMixedEvent<isMC>(pooled, current, bin);
+      });
     }
   }
 
-  /// process function for to call doMixedEvent with Data
+  /// process function for to call doMixing with Data
   /// @param cols subscribe to the collisions table (Data)
   /// @param parts subscribe to the femtoDreamParticleTable
   void processMixedEvent(o2::aod::FDCollisions& cols,
-                         o2::aod::FDParticles& parts)
+                         o2::aod::FDParticles&)
   {
-    for (auto& [collision1, collision2] : soa::selfCombinations(colBinning, 5, -1, cols, cols)) {
-
-      const int multiplicityCol = collision1.multNtr();
-      MixQaRegistry.fill(HIST("MixingQA/hMECollisionBins"), colBinning.getBin({collision1.posZ(), multiplicityCol}));
-
-      auto groupPartsOne = partsOne->sliceByCached(aod::femtodreamparticle::fdCollisionId, collision1.globalIndex(), cache);
-      auto groupPartsTwo = partsTwo->sliceByCached(aod::femtodreamparticle::fdCollisionId, collision2.globalIndex(), cache);
-
-      const auto& magFieldTesla1 = collision1.magField();
-      const auto& magFieldTesla2 = collision2.magField();
-
-      if (magFieldTesla1 != magFieldTesla2) {
-        continue;
-      }
-      /// \todo before mixing we should check whether both collisions contain a pair of particles!
-      // if (partsOne.size() == 0 || nPart2Evt1 == 0 || nPart1Evt2 == 0 || partsTwo.size() == 0 ) continue;
-
-      doMixedEvent<false>(groupPartsOne, groupPartsTwo, parts, magFieldTesla1, multiplicityCol);
-    }
+    doMixing<false>(cols, partsOne, partsTwo);
   }
   PROCESS_SWITCH(femtoDreamPairTaskTrackTrack, processMixedEvent, "Enable processing mixed events", true);
 
-  /// brief process function for to call doMixedEvent with Monte Carlo
+  /// brief process function for to call doMixing with Monte Carlo
   /// @param cols subscribe to the collisions table (Monte Carlo Reconstructed reconstructed)
   /// @param parts subscribe to joined table FemtoDreamParticles and FemtoDreamMCLables to access Monte Carlo truth
   /// @param FemtoDreamMCParticles subscribe to the Monte Carlo truth table
   void processMixedEventMC(o2::aod::FDCollisions& cols,
-                           soa::Join<o2::aod::FDParticles, o2::aod::FDMCLabels>& parts,
+                           soa::Join<o2::aod::FDParticles, o2::aod::FDMCLabels>&,
                            o2::aod::FDMCParticles&)
   {
-    for (auto& [collision1, collision2] : soa::selfCombinations(colBinning, 5, -1, cols, cols)) {
-
-      const int multiplicityCol = collision1.multNtr();
-      MixQaRegistry.fill(HIST("MixingQA/hMECollisionBins"), colBinning.getBin({collision1.posZ(), multiplicityCol}));
-
-      auto groupPartsOne = partsOneMC->sliceByCached(aod::femtodreamparticle::fdCollisionId, collision1.globalIndex(), cache);
-      auto groupPartsTwo = partsTwoMC->sliceByCached(aod::femtodreamparticle::fdCollisionId, collision2.globalIndex(), cache);
-
-      const auto& magFieldTesla1 = collision1.magField();
-      const auto& magFieldTesla2 = collision2.magField();
-
-      if (magFieldTesla1 != magFieldTesla2) {
-        continue;
-      }
-      /// \todo before mixing we should check whether both collisions contain a pair of particles!
-      // if (partsOne.size() == 0 || nPart2Evt1 == 0 || nPart1Evt2 == 0 || partsTwo.size() == 0 ) continue;
-
-      doMixedEvent<true>(groupPartsOne, groupPartsTwo, parts, magFieldTesla1, multiplicityCol);
-    }
+    doMixing<true>(cols, partsOneMC, partsTwoMC);
   }
   PROCESS_SWITCH(femtoDreamPairTaskTrackTrack, processMixedEventMC, "Enable processing mixed events MC", false);
 };
@@ -27,6 +27,7 @@
 #include "FemtoDreamPairCleaner.h"
 #include "FemtoDreamContainer.h"
 #include "FemtoDreamDetaDphiStar.h"
+#include "FemtoDreamEventMixer.h"
 #include "FemtoUtils.h"
 
 using namespace o2;
@@ -108,6 +109,7 @@ struct femtoDreamPairTaskTrackV0 {
   ConfigurableAxis ConfkTBins{"ConfkTBins", {150, 0., 9.}, "binning kT"};
   ConfigurableAxis ConfmTBins{"ConfmTBins", {225, 0., 7.5}, "binning mT"};
   Configurable<int> ConfNEventsMix{"ConfNEventsMix", 5, "Number of events for mixing"};
+  Configurable<bool> ConfMixAcrossDataFrames{"ConfMixAcrossDataFrames", false, "Keep the mixing pools from one data frame to the next"};
   Configurable<bool> ConfIsCPR{"ConfIsCPR", true, "Close Pair Rejection"};
   Configurable<bool> ConfCPRPlotPerRadii{"ConfCPRPlotPerRadii", false, "Plot CPR per radii"};
   Configurable<float> ConfCPRdeltaPhiMax{"ConfCPRdeltaPhiMax", 0.01, "Max. Delta Phi for Close Pair Rejection"};
@@ -120,6 +122,7 @@ struct femtoDreamPairTaskTrackV0 {
   FemtoDreamContainer<femtoDreamContainer::EventType::mixed, femtoDreamContainer::Observable::kstar> mixedEventCont;
   FemtoDreamPairCleaner<aod::femtodreamparticle::ParticleType::kTrack, aod::femtodreamparticle::ParticleType::kV0> pairCleaner;
   FemtoDreamDetaDphiStar<aod::femtodreamparticle::ParticleType::kTrack, aod::femtodreamparticle::ParticleType::kV0> pairCloseRejection;
+  FemtoDreamEventMixer eventMixer;
   /// Histogram output
   HistogramRegistry qaRegistry{"TrackQA", {}, OutputObjHandlingPolicy::AnalysisObject};
   HistogramRegistry resultRegistry{"Correlations", {}, OutputObjHandlingPolicy::AnalysisObject};
@@ -142,6 +145,7 @@ struct femtoDreamPairTaskTrackV0 {
     }
     vPIDPartOne = ConfTrkPIDPartOne.value;
     kNsigma = ConfTrkPIDnSigmaMax.value;
+    eventMixer.init(ConfNEventsMix);
   }
 
   /// This function processes the same event and takes care of all the histogramming
@@ -155,6 +159,7 @@ struct femtoDreamPairTaskTrackV0 {
     const int multCol = col.multNtr();
 
     eventHisto.fillQA(col);
+    pairCleaner.setCollision(parts.sliceBy(perCol, col.globalIndex()));
 
     /// Histogramming same event
     for (auto& part : groupPartsOne) {
@@ -208,50 +213,81 @@ struct femtoDreamPairTaskTrackV0 {
 
   PROCESS_SWITCH(femtoDreamPairTaskTrackV0, processSameEvent, "Enable processing same event", true);
 
-  /// This function processes the mixed event
-  /// \todo the trivial loops over the collisions and tracks should be factored out since they will be common to all combinations of T-T, T-V0, V0-V0, ...
-  void processMixedEvent(o2::aod::FDCollisions& cols, o2::aod::FDParticles& parts)
+  /// Kinematic and PID selection of the tracks, as applied in the pair loops
+  template <typename PartType>
+  bool isSelectedTrack(PartType const& part)
   {
-    ColumnBinningPolicy<aod::collision::PosZ, aod::femtodreamcollision::MultNtr> colBinning{{ConfVtxBins, ConfMultBins}, true};
-
-    for (auto& [collision1, collision2] : soa::selfCombinations(colBinning, 5, -1, cols, cols)) {
+    return part.p() <= ConfTrkCutTable->get("Track", "MaxP") && part.pt() <= ConfTrkCutTable->get("Track", "MaxPt") &&
+           isFullPIDSelected(part.pidcut(), part.p(), ConfTrkCutTable->get("Track", "PIDthr"), vPIDPartOne, ConfNspecies, kNsigma, ConfTrkCutTable->get("Track", "nSigmaTPC"), ConfTrkCutTable->get("Track", "nSigmaTPCTOF"));
+  }
 
-      const int multCol = collision1.multNtr();
+  /// Selection of the children of the V0s, as applied in the pair loops
+  template <typename PartType>
+  bool isSelectedV0Children(PartType const& posChild, PartType const& negChild)
+  {
+    return ((posChild.cut() & ConfCutChildPos) == ConfCutChildPos) && ((negChild.cut() & ConfCutChildNeg) == ConfCutChildNeg) &&
+           isFullPIDSelected(posChild.pidcut(), posChild.p(), ConfV0ChildrenCutTable->get("PosChild", "PIDthr"), ConfChildPosIndex.value, ConfChildnSpecies.value, ConfChildPIDnSigmaMax.value, ConfV0ChildrenCutTable->get("PosChild", "nSigmaTPC"), ConfV0ChildrenCutTable->get("PosChild", "nSigmaTPCTOF")) &&
+           isFullPIDSelected(negChild.pidcut(), negChild.p(), ConfV0ChildrenCutTable->get("PosChild", "PIDthr"), ConfChildNegIndex.value, ConfChildnSpecies.value, ConfChildPIDnSigmaMax.value, ConfV0ChildrenCutTable->get("NegChild", "nSigmaTPC"), ConfV0ChildrenCutTable->get("NegChild", "nSigmaTPCTOF"));
+  }
 
-      auto groupPartsOne = partsOne->sliceByCached(aod::femtodreamparticle::fdCollisionId, collision1.globalIndex(), cache);
-      auto groupPartsTwo = partsTwo->sliceByCached(aod::femtodreamparticle::fdCollisionId, collision2.globalIndex(), cache);
+  /// This function processes the mixed event of two pooled events
+  /// The pair cleaner is not needed, the particles of two events do not share tracks
+  /// \param event1 earlier event of the bin, providing the tracks, the magnetic field and the multiplicity
+  /// \param event2 later event of the bin, providing the V0s and their children
+  void doMixedEvent(const FemtoDreamEventMixer::Event& event1, const FemtoDreamEventMixer::Event& event2)
+  {
+    if (event1.mMagField != event2.mMagField) {
+      return;
+    }
+    for (const auto& p1 : event1.partsOne) {
+      for (std::size_t i2 = 0; i2 < event2.partsTwo.size(); i2++) {
+        if (ConfIsCPR.value) {
+          if (pairCloseRejection.isClosePairToChildren(p1, event2.children[2 * i2], event2.children[2 * i2 + 1], event1.mMagField)) {
+            continue;
+          }
+        }
+        mixedEventCont.setPair<false>(p1, event2.partsTwo[i2], event1.mMult, ConfUse3D);
+      }
+    }
+  }
 
-      const auto& magFieldTesla1 = collision1.magField();
-      const auto& magFieldTesla2 = collision2.magField();
+  /// This function processes the mixed event
+  /// Each collision is mixed with the last ConfNEventsMix collisions of its bin, and its selected tracks and V0s are
+  /// stored in the mixing pools once, instead of for each pair of collisions
+  void processMixedEvent(o2::aod::FDCollisions& cols, o2::aod::FDParticles& parts)
+  {
+    ColumnBinningPolicy<aod::collision::PosZ, aod::femtodreamcollision::MultNtr> colBinning{{ConfVtxBins, ConfMultBins}, true};
 
-      if (magFieldTesla1 != magFieldTesla2) {
+    if (!ConfMixAcrossDataFrames) {
+      eventMixer.reset();
+    }
+    for (auto& col : cols) {
+      const int bin = colBinning.getBin({col.posZ(), col.multNtr()});
+      if (bin < 0) {
         continue;
       }
+      auto groupPartsOne = partsOne->sliceByCached(aod::femtodreamparticle::fdCollisionId, col.globalIndex(), cache);
+      auto groupPartsTwo = partsTwo->sliceByCached(aod::femtodreamparticle::fdCollisionId, col.globalIndex(), cache);
 
-      for (auto& [p1, p2] : combinations(CombinationsFullIndexPolicy(groupPartsOne, groupPartsTwo))) {
-        if (p1.p() > ConfTrkCutTable->get("Track", "MaxP") || p1.pt() > ConfTrkCutTable->get("Track", "MaxPt") ||
-            !isFullPIDSelected(p1.pidcut(), p1.p(), ConfTrkCutTable->get("Track", "PIDthr"), vPIDPartOne, ConfNspecies, kNsigma, ConfTrkCutTable->get("Track", "nSigmaTPC"), ConfTrkCutTable->get("Track", "nSigmaTPCTOF"))) {
-          continue;
-        }
-        const auto& posChild = parts.iteratorAt(p2.index() - 2);
-        const auto& negChild = parts.iteratorAt(p2.index() - 1);
-        // check cuts on V0 children
-        if (!((posChild.cut() & ConfCutChildPos) == ConfCutChildPos) || !((negChild.cut() & ConfCutChildNeg) == ConfCutChildNeg) ||
-            !isFullPIDSelected(posChild.pidcut(), posChild.p(), ConfV0ChildrenCutTable->get("PosChild", "PIDthr"), ConfChildPosIndex.value, ConfChildnSpecies.value, ConfChildPIDnSigmaMax.value, ConfV0ChildrenCutTable->get("PosChild", "nSigmaTPC"), ConfV0ChildrenCutTable->get("PosChild", "nSigmaTPCTOF")) ||
-            !isFullPIDSelected(negChild.pidcut(), negChild.p(), ConfV0ChildrenCutTable->get("PosChild", "PIDthr"), ConfChildNegIndex.value, ConfChildnSpecies.value, ConfChildPIDnSigmaMax.value, ConfV0ChildrenCutTable->get("NegChild", "nSigmaTPC"), ConfV0ChildrenCutTable->get("NegChild", "nSigmaTPCTOF"))) {
-          continue;
+      auto& event = eventMixer.newEvent(bin, col.magField(), col.multNtr());
+      for (auto& part : groupPartsOne) {
+        if (isSelectedTrack(part)) {
+          event.partsOne.emplace_back().set<false>(part);
         }
-        if (ConfIsCPR.value) {
-          if (pairCloseRejection.isClosePair(p1, p2, parts, magFieldTesla1)) {
-            continue;
-          }
-        }
-        // track cleaning
-        if (!pairCleaner.isCleanPair(p1, p2, parts)) {
-          continue;
+      }
+      for (auto& part : groupPartsTwo) {
+        const auto& posChild = parts.iteratorAt(part.index() - 2);
+        const auto& negChild = parts.iteratorAt(part.index() - 1);
+        if (isSelectedV0Children(posChild, negChild)) {
+          event.partsTwo.emplace_back().set<false>(part);
+          event.children.emplace_back().set<false>(posChild);
+          event.children.emplace_back().set<false>(negChild);
         }
-        mixedEventCont.setPair<false>(p1, p2, multCol, ConfUse3D);
       }
+
+      eventMixer.mixEvent(bin, [&](const FemtoDreamEventMixer::Event& pooled, const FemtoDreamEventMixer::Event& current) {
+        doMixedEvent(pooled, current);
+      });
     }
   }
 
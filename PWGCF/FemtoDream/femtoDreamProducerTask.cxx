@@ -32,6 +32,7 @@
 #include "Framework/runDataProcessing.h"
 #include "Math/Vector4D.h"
 #include "PWGCF/DataModel/FemtoDerived.h"
+#include "PWGCF/Core/PIDBits.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
 #include "ReconstructionDataFormats/Track.h"
 #include "TMath.h"
@@ -171,6 +172,7 @@ struct femtoDreamProducerTask {
 
   int mRunNumber;
   float mMagField;
+  size_t nPIDThresholds = 0; ///< number of n_sigma thresholds of the track PID selection
   Service<o2::ccdb::BasicCCDBManager> ccdb; /// Accessing the CCDB
 
   void init(InitContext&)
@@ -202,6 +204,7 @@ struct femtoDreamProducerTask {
     trackCuts.setSelection(ConfTrkPIDnSigmaMax, femtoDreamTrackSelection::kPIDnSigmaMax, femtoDreamSelection::kAbsUpperLimit);
     trackCuts.setPIDSpecies(ConfTrkPIDspecies);
     trackCuts.setnSigmaPIDOffset(ConfTrkPIDnSigmaOffsetTPC, ConfTrkPIDnSigmaOffsetTOF);
+    nPIDThresholds = trackCuts.getNSelections(femtoDreamTrackSelection::kPIDnSigmaMax);
     trackCuts.init<aod::femtodreamparticle::ParticleType::kTrack, aod::femtodreamparticle::TrackType::kNoChild, aod::femtodreamparticle::cutContainerType>(&qaRegistry);
 
     /// \todo fix how to pass array to setSelection, getRow() passing a
@@ -353,7 +356,8 @@ struct femtoDreamProducerTask {
     }
   }
 
-  template <bool isMC, typename V0Type, typename TrackType,
+  /// \tparam sharedPID The PID container of the tracks is read from the FemtoPIDBits table joined with the tracks
+  template <bool isMC, bool sharedPID = false, typename V0Type, typename TrackType,
             typename CollisionType>
   void fillCollisionsAndTracksAndV0(CollisionType const& col, TrackType const& tracks, V0Type const& fullV0s)
   {
@@ -395,13 +399,21 @@ struct femtoDreamProducerTask {
     for (auto& track : tracks) {
       /// if the most open selection criteria are not fulfilled there is no
       /// point looking further at the track
-      if (!trackCuts.isSelectedMinimal(track)) {
+      if (!trackCuts.isSelectedMinimal<!sharedPID>(track)) {
         continue;
       }
+      if constexpr (sharedPID) {
+        if (nPIDThresholds > 0 && !o2::analysis::pidbits::passesLoosestTPC(track.pidBits(), trackCuts.getNPIDSpecies(), nPIDThresholds)) {
+          continue;
+        }
+      }
       trackCuts.fillQA<aod::femtodreamparticle::ParticleType::kTrack,
                        aod::femtodreamparticle::TrackType::kNoChild>(track);
       // the bit-wise container of the systematic variations is obtained
-      auto cutContainer = trackCuts.getCutContainer<aod::femtodreamparticle::cutContainerType>(track);
+      auto cutContainer = trackCuts.getCutContainer<aod::femtodreamparticle::cutContainerType, !sharedPID>(track);
+      if constexpr (sharedPID) {
+        cutContainer.at(femtoDreamTrackSelection::TrackContainerPosition::kPID) = track.pidBits();
+      }
 
       // now the table is filled
       outputParts(outputCollision.lastIndex(), track.pt(), track.eta(),
@@ -523,6 +535,20 @@ struct femtoDreamProducerTask {
   PROCESS_SWITCH(femtoDreamProducerTask, processData,
                  "Provide experimental data", true);
 
+  void
+    processDataSharedPID(aod::FemtoFullCollision const& col,
+                         aod::BCsWithTimestamps const&,
+                         soa::Join<aod::FemtoFullTracks, aod::FemtoPIDBits> const& tracks,
+                         o2::aod::V0Datas const& fullV0s)
+  {
+    // get magnetic field for run
+    getMagneticFieldTesla(col.bc_as<aod::BCsWithTimestamps>());
+    // fill the tables, with the PID bits of the femto-pid-bits task
+    fillCollisionsAndTracksAndV0<false, true>(col, tracks, fullV0s);
+  }
+  PROCESS_SWITCH(femtoDreamProducerTask, processDataSharedPID,
+                 "Provide experimental data, with the PID bits of the femto-pid-bits task (same PID configurables)", false);
+
   void
     processMC(aod::FemtoFullCollisionMC const& col,
               aod::BCsWithTimestamps const&,
@@ -18,11 +18,13 @@
 #define PWGCF_FEMTOUNIVERSE_CORE_FEMTOUNIVERSEDETADPHISTAR_H_
 
 #include <string>
+#include <array>
 #include <vector>
 #include <memory>
 
 #include "PWGCF/FemtoUniverse/DataModel/FemtoUniverseDerived.h"
 #include "Framework/HistogramRegistry.h"
+#include "PWGCF/Core/PhiStar.h"
 
 namespace o2::analysis
 {
@@ -144,7 +146,8 @@ class FemtoUniverseDetaDphiStar
   static constexpr o2::aod::femtouniverseparticle::ParticleType mPartOneType = partOne; ///< Type of particle 1
   static constexpr o2::aod::femtouniverseparticle::ParticleType mPartTwoType = partTwo; ///< Type of particle 2
 
-  static constexpr float tmpRadiiTPC[9] = {85., 105., 125., 145., 165., 185., 205., 225., 245.};
+  static constexpr int kNRadiiTPC = 9;
+  static constexpr float tmpRadiiTPC[kNRadiiTPC] = {85., 105., 125., 145., 165., 185., 205., 225., 245.};
 
   static constexpr uint32_t kSignMinusMask = 1;
   static constexpr uint32_t kSignPlusMask = 1 << 1;
@@ -158,10 +161,17 @@ class FemtoUniverseDetaDphiStar
   std::array<std::array<std::shared_ptr<TH2>, 2>, 2> histdetadpi{};
   std::array<std::array<std::shared_ptr<TH2>, 9>, 2> histdetadpiRadii{};
 
+  /// phi* of the last first particle, reused while the pair loop keeps the same first particle
+  std::array<float, kNRadiiTPC> phiStarPart1{};
+  int64_t phiStarPart1Index = -1;
+  float phiStarPart1Phi = 0.;
+  float phiStarPart1Pt = 0.;
+  float phiStarPart1Magfield = 0.;
+
   ///  Calculate phi at all required radii stored in tmpRadiiTPC
   /// Magnetic field to be provided in Tesla
   template <typename T>
-  void PhiAtRadiiTPC(const T& part, std::vector<float>& tmpVec)
+  void PhiAtRadiiTPC(const T& part, std::array<float, kNRadiiTPC>& phiStar)
   {
 
     float phi0 = part.phi();
@@ -177,31 +187,36 @@ class FemtoUniverseDetaDphiStar
       LOG(fatal) << "FemtoUniverseDetaDphiStar: Charge bits are set wrong!";
     }
     // End: Get the charge from cutcontainer using masks
-    float pt = part.pt();
-    for (size_t i = 0; i < 9; i++) {
-      tmpVec.push_back(phi0 - std::asin(0.3 * charge * 0.1 * magfield * tmpRadiiTPC[i] * 0.01 / (2. * pt)));
-    }
+    // phi* = phi0 - asin(0.3 * charge * 0.1 * magfield * R * 0.01 / (2 * pt)), with one asin per radius
+    double shifts[kNRadiiTPC];
+    o2::analysis::phistar::fillShifts(0.3 * 0.1 * magfield * 0.01 / 2., part.pt(), static_cast<int>(charge), tmpRadiiTPC, kNRadiiTPC, shifts);
+    o2::analysis::phistar::fillPhiStar(phi0, shifts, kNRadiiTPC, phiStar.data());
   }
 
   ///  Calculate average phi
   template <typename T1, typename T2>
   float AveragePhiStar(const T1& part1, const T2& part2, int iHist)
   {
-    std::vector<float> tmpVec1;
-    std::vector<float> tmpVec2;
-    PhiAtRadiiTPC(part1, tmpVec1);
-    PhiAtRadiiTPC(part2, tmpVec2);
-    const int num = tmpVec1.size();
+    // the kinematics are compared as well, the indices restart with each data frame
+    if (part1.globalIndex() != phiStarPart1Index || part1.phi() != phiStarPart1Phi || part1.pt() != phiStarPart1Pt || magfield != phiStarPart1Magfield) {
+      PhiAtRadiiTPC(part1, phiStarPart1);
+      phiStarPart1Index = part1.globalIndex();
+      phiStarPart1Phi = part1.phi();
+      phiStarPart1Pt = part1.pt();
+      phiStarPart1Magfield = magfield;
+    }
+    std::array<float, kNRadiiTPC> phiStarPart2;
+    PhiAtRadiiTPC(part2, phiStarPart2);
     float dPhiAvg = 0;
-    for (int i = 0; i < num; i++) {
-      float dphi = tmpVec1.at(i) - tmpVec2.at(i);
+    for (int i = 0; i < kNRadiiTPC; i++) {
+      float dphi = phiStarPart1[i] - phiStarPart2[i];
       dphi = TVector2::Phi_mpi_pi(dphi);
       dPhiAvg += dphi;
       if (plotForEveryRadii) {
         histdetadpiRadii[iHist][i]->Fill(part1.eta() - part2.eta(), dphi);
       }
     }
-    return (dPhiAvg / (static_cast<float>)num);
+    return dPhiAvg / static_cast<float>(kNRadiiTPC);
   }
 };
 
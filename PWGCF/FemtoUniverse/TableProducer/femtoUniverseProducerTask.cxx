@@ -14,6 +14,8 @@
 /// \author Andi Mathis, TU München, andreas.mathis@ph.tum.de
 /// \author Zuzanna Chochulska, WUT Warsaw, zchochul@cern.ch
 
+#include <algorithm>
+#include <vector>
 #include "CCDB/BasicCCDBManager.h"
 #include "PWGCF/FemtoUniverse/Core/FemtoUniverseCollisionSelection.h"
 #include "PWGCF/FemtoUniverse/Core/FemtoUniverseTrackSelection.h"
@@ -69,17 +71,15 @@ using FemtoPhiTracks = soa::Join<aod::FullTracks,
 // unsigned int rows = sizeof(arrayV0Sel) / sizeof(arrayV0Sel[0]);
 // unsigned int columns = sizeof(arrayV0Sel[0]) / sizeof(arrayV0Sel[0][0]);
 
+/// The IDs are stored in the order of the track table, so they are sorted and looked up by bisection
 template <typename T>
 int getRowDaughters(int daughID, T const& vecID)
 {
-  int rowInPrimaryTrackTableDaugh = -1;
-  for (size_t i = 0; i < vecID.size(); i++) {
-    if (vecID.at(i) == daughID) {
-      rowInPrimaryTrackTableDaugh = i;
-      break;
-    }
+  auto it = std::lower_bound(vecID.begin(), vecID.end(), daughID);
+  if (it == vecID.end() || *it != daughID) {
+    return -1;
   }
-  return rowInPrimaryTrackTableDaugh;
+  return it - vecID.begin();
 }
 
 struct femtoUniverseProducerTask {
@@ -225,6 +225,17 @@ struct femtoUniverseProducerTask {
   float mMagField;
   Service<o2::ccdb::BasicCCDBManager> ccdb; /// Accessing the CCDB
 
+  /// Kaon candidate of the phi reconstruction, selected once in the track loop
+  struct PhiDaughter {
+    int64_t index;
+    aod::FemtoFullTracks::iterator track;
+    TLorentzVector vec;
+  };
+  std::vector<PhiDaughter> phiDaughtersOne; // candidates for the first daughter, in the order of the tracks
+  std::vector<PhiDaughter> phiDaughtersTwo; // candidates for the second daughter, in the order of the tracks
+  float mMassOne = 0.f;
+  float mMassTwo = 0.f;
+
   void init(InitContext&)
   {
     colCuts.setCuts(ConfEvtZvtx, ConfEvtTriggerCheck, ConfEvtTriggerSel, ConfEvtOfflineCheck, ConfIsRun3);
@@ -299,6 +310,36 @@ struct femtoUniverseProducerTask {
     // changed long to float because of the MegaLinter
     int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
     ccdb->setCreatedNotAfter(now);
+
+    mMassOne = TDatabasePDG::Instance()->GetParticle(ConfPDGCodePartOne)->Mass();
+    mMassTwo = TDatabasePDG::Instance()->GetParticle(ConfPDGCodePartTwo)->Mass();
+  }
+
+  /// Adds the track to the candidates of the phi daughters it is selected for
+  template <typename TrackType>
+  void selectPhiDaughters(TrackType const& track)
+  {
+    if (track.trackType() == o2::aod::track::TrackTypeEnum::Run2Tracklet) {
+      return;
+    }
+    const bool isOne = (track.pt() >= cfgPtLowPart1) && (track.pt() <= cfgPtHighPart1) &&
+                       (track.p() >= cfgPLowPart1) && (track.p() <= cfgPHighPart1) &&
+                       (track.eta() >= cfgEtaLowPart1) && (track.eta() <= cfgEtaHighPart1);
+    const bool isTwo = (track.pt() >= cfgPtLowPart2) && (track.pt() <= cfgPtHighPart2) &&
+                       (track.p() >= cfgPLowPart2) && (track.p() <= cfgPHighPart2) &&
+                       (track.eta() >= cfgEtaLowPart2) && (track.eta() <= cfgEtaHighPart2);
+    if (!(isOne || isTwo) || !IsKaonNSigma(track.p(), track.tpcNSigmaKa(), track.tofNSigmaKa())) {
+      return;
+    }
+    TLorentzVector vec;
+    if (isOne) {
+      vec.SetPtEtaPhiM(track.pt(), track.eta(), track.phi(), mMassOne);
+      phiDaughtersOne.push_back({track.globalIndex(), track, vec});
+    }
+    if (isTwo) {
+      vec.SetPtEtaPhiM(track.pt(), track.eta(), track.phi(), mMassTwo);
+      phiDaughtersTwo.push_back({track.globalIndex(), track, vec});
+    }
   }
 
   // PID
@@ -432,8 +473,13 @@ struct femtoUniverseProducerTask {
 
     int childIDs[2] = {0, 0};    // these IDs are necessary to keep track of the children
     std::vector<int> tmpIDtrack; // this vector keeps track of the matching of the primary track table row <-> aod::track table global index
+    phiDaughtersOne.clear();
+    phiDaughtersTwo.clear();
 
     for (auto& track : tracks) {
+      if (ConfStorePhi) {
+        selectPhiDaughters(track);
+      }
       /// if the most open selection criteria are not fulfilled there is no point looking further at the track
       if (!trackCuts.isSelectedMinimal(track)) {
         continue;
@@ -662,207 +708,188 @@ struct femtoUniverseProducerTask {
       }
     }
     if (ConfStorePhi) {
-      for (auto& [p1, p2] : combinations(soa::CombinationsStrictlyUpperIndexPolicy(tracks, tracks))) {
-        if ((p1.trackType() == o2::aod::track::TrackTypeEnum::Run2Tracklet) || (p2.trackType() == o2::aod::track::TrackTypeEnum::Run2Tracklet)) {
-          continue;
-        } else if (p1.globalIndex() == p2.globalIndex()) { // checking not to correlate same particles
-          continue;
-        } else if ((p1.pt() < cfgPtLowPart1) || (p1.pt() > cfgPtHighPart1)) { // pT cuts for part1
-          continue;
-        } else if ((p1.p() < cfgPLowPart1) || (p1.p() > cfgPHighPart1)) { // p cuts for part1
-          continue;
-        } else if ((p1.eta() < cfgEtaLowPart1) || (p1.eta() > cfgEtaHighPart1)) { // eta cuts for part1
-          continue;
-        } else if ((p2.pt() < cfgPtLowPart2) || (p2.pt() > cfgPtHighPart2)) { // pT cuts for part2
-          continue;
-        } else if ((p2.p() < cfgPLowPart2) || (p2.p() > cfgPHighPart2)) { // p cuts for part2
-          continue;
-        } else if ((p2.eta() < cfgEtaLowPart2) || (p2.eta() > cfgEtaHighPart2)) { // eta for part2
-          continue;
-        } else if (!(IsKaonNSigma(p1.p(), p1.tpcNSigmaKa(), p1.tofNSigmaKa()))) { // PID for Kaons
-          continue;
-        } else if (!(IsKaonNSigma(p2.p(), p2.tpcNSigmaKa(), p2.tofNSigmaKa()))) {
-          continue;
+      // pairs of the pre-selected kaons, in the order of the strictly upper combinations of the tracks
+      size_t firstTwo = 0;
+      for (auto& daughOne : phiDaughtersOne) {
+        while (firstTwo < phiDaughtersTwo.size() && phiDaughtersTwo[firstTwo].index <= daughOne.index) {
+          firstTwo++;
         }
+        for (size_t iTwo = firstTwo; iTwo < phiDaughtersTwo.size(); iTwo++) {
+          auto& daughTwo = phiDaughtersTwo[iTwo];
+          const auto& p1 = daughOne.track;
+          const auto& p2 = daughTwo.track;
 
-        TLorentzVector part1Vec;
-        TLorentzVector part2Vec;
-        float mMassOne = TDatabasePDG::Instance()->GetParticle(ConfPDGCodePartOne)->Mass();
-        float mMassTwo = TDatabasePDG::Instance()->GetParticle(ConfPDGCodePartTwo)->Mass();
-
-        part1Vec.SetPtEtaPhiM(p1.pt(), p1.eta(), p1.phi(), mMassOne);
-        part2Vec.SetPtEtaPhiM(p2.pt(), p2.eta(), p2.phi(), mMassTwo);
+          TLorentzVector sumVec(daughOne.vec);
+          sumVec += daughTwo.vec;
 
-        TLorentzVector sumVec(part1Vec);
-        sumVec += part2Vec;
+          float phiEta = sumVec.Eta();
+          float phiPt = sumVec.Pt();
+          float phiP = sumVec.P();
+          float phiM = sumVec.M();
 
-        float phiEta = sumVec.Eta();
-        float phiPt = sumVec.Pt();
-        float phiP = sumVec.P();
-        float phiM = sumVec.M();
-
-        if (((phiM < ConfInvMassLowLimitPhi) || (phiM > ConfInvMassUpLimitPhi))) {
-          continue;
-        }
-
-        PhiCuts.fillQA<aod::femtouniverseparticle::ParticleType::kPhi, aod::femtouniverseparticle::ParticleType::kPhiChild>(col, p1, p1, p2); ///\todo fill QA also for daughters
-        auto cutContainerV0 = PhiCuts.getCutContainer<aod::femtouniverseparticle::cutContainerType>(col, p1, p2);
-        if (true) { // temporary true value, we are doing simpler version first
-          int postrackID = p1.globalIndex();
-          int rowInPrimaryTrackTablePos = -1;
-          rowInPrimaryTrackTablePos = getRowDaughters(postrackID, tmpIDtrack);
-          childIDs[0] = rowInPrimaryTrackTablePos;
-          childIDs[1] = 0;
-          outputParts(outputCollision.lastIndex(),
-                      p1.pt(),
-                      p1.eta(),
-                      p1.phi(),
-                      p1.p(),
-                      mMassOne,
-                      aod::femtouniverseparticle::ParticleType::kPhiChild,
-                      cutContainerV0.at(femtoUniverseV0Selection::V0ContainerPosition::kPosCuts),
-                      cutContainerV0.at(femtoUniverseV0Selection::V0ContainerPosition::kPosPID),
-                      0.,
-                      childIDs,
-                      0,
-                      0,
-                      p1.sign(),
-                      p1.beta(),
-                      p1.itsChi2NCl(),
-                      p1.tpcChi2NCl(),
-                      p1.tpcNSigmaKa(),
-                      p1.tofNSigmaKa(),
-                      (uint8_t)p1.tpcNClsFound(),
-                      p1.tpcNClsFindable(),
-                      (uint8_t)p1.tpcNClsCrossedRows(),
-                      p1.tpcNClsShared(),
-                      p1.tpcInnerParam(),
-                      p1.itsNCls(),
-                      p1.itsNClsInnerBarrel(),
-                      p1.dcaXY(),
-                      p1.dcaZ(),
-                      p1.tpcSignal(),
-                      p1.tpcNSigmaStoreEl(),
-                      p1.tpcNSigmaStorePi(),
-                      p1.tpcNSigmaStoreKa(),
-                      p1.tpcNSigmaStorePr(),
-                      p1.tpcNSigmaStoreDe(),
-                      p1.tofNSigmaStoreEl(),
-                      p1.tofNSigmaStorePi(),
-                      p1.tofNSigmaStoreKa(),
-                      p1.tofNSigmaStorePr(),
-                      p1.tofNSigmaStoreDe(),
-                      -999.,
-                      -999.,
-                      -999.,
-                      -999.,
-                      -999.,
-                      -999.);
-          const int rowOfPosTrack = outputParts.lastIndex();
-          int negtrackID = p2.globalIndex();
-          int rowInPrimaryTrackTableNeg = -1;
-          rowInPrimaryTrackTableNeg = getRowDaughters(negtrackID, tmpIDtrack);
-          childIDs[0] = 0;
-          childIDs[1] = rowInPrimaryTrackTableNeg;
-          outputParts(outputCollision.lastIndex(),
-                      p2.pt(),
-                      p2.eta(),
-                      p2.phi(),
-                      p2.p(),
-                      mMassTwo,
-                      aod::femtouniverseparticle::ParticleType::kPhiChild,
-                      cutContainerV0.at(femtoUniverseV0Selection::V0ContainerPosition::kNegCuts),
-                      cutContainerV0.at(femtoUniverseV0Selection::V0ContainerPosition::kNegPID),
-                      0.,
-                      childIDs,
-                      0,
-                      0,
-                      p2.sign(),
-                      p2.beta(),
-                      p2.itsChi2NCl(),
-                      p2.tpcChi2NCl(),
-                      p2.tpcNSigmaKa(),
-                      p2.tofNSigmaKa(),
-                      (uint8_t)p2.tpcNClsFound(),
-                      p2.tpcNClsFindable(),
-                      (uint8_t)p2.tpcNClsCrossedRows(),
-                      p2.tpcNClsShared(),
-                      p2.tpcInnerParam(),
-                      p2.itsNCls(),
-                      p2.itsNClsInnerBarrel(),
-                      p2.dcaXY(),
-                      p2.dcaZ(),
-                      p2.tpcSignal(),
-                      p2.tpcNSigmaStoreEl(),
-                      p2.tpcNSigmaStorePi(),
-                      p2.tpcNSigmaStoreKa(),
-                      p2.tpcNSigmaStorePr(),
-                      p2.tpcNSigmaStoreDe(),
-                      p2.tofNSigmaStoreEl(),
-                      p2.tofNSigmaStorePi(),
-                      p2.tofNSigmaStoreKa(),
-                      p2.tofNSigmaStorePr(),
-                      p2.tofNSigmaStoreDe(),
-                      -999.,
-                      -999.,
-                      -999.,
-                      -999.,
-                      -999.,
-                      -999.);
+          if (((phiM < ConfInvMassLowLimitPhi) || (phiM > ConfInvMassUpLimitPhi))) {
+            continue;
+          }
 
-          const int rowOfNegTrack = outputParts.lastIndex();
-          int indexChildID[2] = {rowOfPosTrack, rowOfNegTrack};
-          float phiPhi = sumVec.Phi();
-          if (sumVec.Phi() < 0) {
-            phiPhi = sumVec.Phi() + 2 * o2::constants::math::PI;
-          } else if (sumVec.Phi() >= 0) {
-            phiPhi = sumVec.Phi();
+          PhiCuts.fillQA<aod::femtouniverseparticle::ParticleType::kPhi, aod::femtouniverseparticle::ParticleType::kPhiChild>(col, p1, p1, p2); ///\todo fill QA also for daughters
+          auto cutContainerV0 = PhiCuts.getCutContainer<aod::femtouniverseparticle::cutContainerType>(col, p1, p2);
+          if (true) { // temporary true value, we are doing simpler version first
+            int postrackID = p1.globalIndex();
+            int rowInPrimaryTrackTablePos = -1;
+            rowInPrimaryTrackTablePos = getRowDaughters(postrackID, tmpIDtrack);
+            childIDs[0] = rowInPrimaryTrackTablePos;
+            childIDs[1] = 0;
+            outputParts(outputCollision.lastIndex(),
+                        p1.pt(),
+                        p1.eta(),
+                        p1.phi(),
+                        p1.p(),
+                        mMassOne,
+                        aod::femtouniverseparticle::ParticleType::kPhiChild,
+                        cutContainerV0.at(femtoUniverseV0Selection::V0ContainerPosition::kPosCuts),
+                        cutContainerV0.at(femtoUniverseV0Selection::V0ContainerPosition::kPosPID),
+                        0.,
+                        childIDs,
+                        0,
+                        0,
+                        p1.sign(),
+                        p1.beta(),
+                        p1.itsChi2NCl(),
+                        p1.tpcChi2NCl(),
+                        p1.tpcNSigmaKa(),
+                        p1.tofNSigmaKa(),
+                        (uint8_t)p1.tpcNClsFound(),
+                        p1.tpcNClsFindable(),
+                        (uint8_t)p1.tpcNClsCrossedRows(),
+                        p1.tpcNClsShared(),
+                        p1.tpcInnerParam(),
+                        p1.itsNCls(),
+                        p1.itsNClsInnerBarrel(),
+                        p1.dcaXY(),
+                        p1.dcaZ(),
+                        p1.tpcSignal(),
+                        p1.tpcNSigmaStoreEl(),
+                        p1.tpcNSigmaStorePi(),
+                        p1.tpcNSigmaStoreKa(),
+                        p1.tpcNSigmaStorePr(),
+                        p1.tpcNSigmaStoreDe(),
+                        p1.tofNSigmaStoreEl(),
+                        p1.tofNSigmaStorePi(),
+                        p1.tofNSigmaStoreKa(),
+                        p1.tofNSigmaStorePr(),
+                        p1.tofNSigmaStoreDe(),
+                        -999.,
+                        -999.,
+                        -999.,
+                        -999.,
+                        -999.,
+                        -999.);
+            const int rowOfPosTrack = outputParts.lastIndex();
+            int negtrackID = p2.globalIndex();
+            int rowInPrimaryTrackTableNeg = -1;
+            rowInPrimaryTrackTableNeg = getRowDaughters(negtrackID, tmpIDtrack);
+            childIDs[0] = 0;
+            childIDs[1] = rowInPrimaryTrackTableNeg;
+            outputParts(outputCollision.lastIndex(),
+                        p2.pt(),
+                        p2.eta(),
+                        p2.phi(),
+                        p2.p(),
+                        mMassTwo,
+                        aod::femtouniverseparticle::ParticleType::kPhiChild,
+                        cutContainerV0.at(femtoUniverseV0Selection::V0ContainerPosition::kNegCuts),
+                        cutContainerV0.at(femtoUniverseV0Selection::V0ContainerPosition::kNegPID),
+                        0.,
+                        childIDs,
+                        0,
+                        0,
+                        p2.sign(),
+                        p2.beta(),
+                        p2.itsChi2NCl(),
+                        p2.tpcChi2NCl(),
+                        p2.tpcNSigmaKa(),
+                        p2.tofNSigmaKa(),
+                        (uint8_t)p2.tpcNClsFound(),
+                        p2.tpcNClsFindable(),
+                        (uint8_t)p2.tpcNClsCrossedRows(),
+                        p2.tpcNClsShared(),
+                        p2.tpcInnerParam(),
+                        p2.itsNCls(),
+                        p2.itsNClsInnerBarrel(),
+                        p2.dcaXY(),
+                        p2.dcaZ(),
+                        p2.tpcSignal(),
+                        p2.tpcNSigmaStoreEl(),
+                        p2.tpcNSigmaStorePi(),
+                        p2.tpcNSigmaStoreKa(),
+                        p2.tpcNSigmaStorePr(),
+                        p2.tpcNSigmaStoreDe(),
+                        p2.tofNSigmaStoreEl(),
+                        p2.tofNSigmaStorePi(),
+                        p2.tofNSigmaStoreKa(),
+                        p2.tofNSigmaStorePr(),
+                        p2.tofNSigmaStoreDe(),
+                        -999.,
+                        -999.,
+                        -999.,
+                        -999.,
+                        -999.,
+                        -999.);
+
+            const int rowOfNegTrack = outputParts.lastIndex();
+            int indexChildID[2] = {rowOfPosTrack, rowOfNegTrack};
+            float phiPhi = sumVec.Phi();
+            if (sumVec.Phi() < 0) {
+              phiPhi = sumVec.Phi() + 2 * o2::constants::math::PI;
+            } else if (sumVec.Phi() >= 0) {
+              phiPhi = sumVec.Phi();
+            }
+            outputParts(outputCollision.lastIndex(),
+                        phiPt,
+                        phiEta,
+                        phiPhi,
+                        phiP,
+                        phiM,
+                        aod::femtouniverseparticle::ParticleType::kPhi,
+                        cutContainerV0.at(femtoUniverseV0Selection::V0ContainerPosition::kV0),
+                        0,
+                        0, // p1.v0cosPA(col.posX(), col.posY(), col.posZ()),
+                        indexChildID,
+                        0, // v0.mLambda(),
+                        0, // v0.mAntiLambda(),
+                        p1.sign(),
+                        p1.beta(),
+                        p1.itsChi2NCl(),
+                        p1.tpcChi2NCl(),
+                        p1.tpcNSigmaKa(),
+                        p1.tofNSigmaKa(),
+                        (uint8_t)p1.tpcNClsFound(),
+                        0, // p1.tpcNClsFindable(),
+                        0, //(uint8_t)p1.tpcNClsCrossedRows(),
+                        p1.tpcNClsShared(),
+                        p1.tpcInnerParam(),
+                        p1.itsNCls(),
+                        p1.itsNClsInnerBarrel(),
+                        0, // p1.dcaXY(),
+                        0, // p1.dcaZ(),
+                        p1.tpcSignal(),
+                        p1.tpcNSigmaStoreEl(),
+                        p1.tpcNSigmaStorePi(),
+                        p1.tpcNSigmaStoreKa(),
+                        p1.tpcNSigmaStorePr(),
+                        p1.tpcNSigmaStoreDe(),
+                        p1.tofNSigmaStoreEl(),
+                        p1.tofNSigmaStorePi(),
+                        p1.tofNSigmaStoreKa(),
+                        p1.tofNSigmaStorePr(),
+                        p1.tofNSigmaStoreDe(),
+                        -999.,
+                        -999.,
+                        -999.,
+                        -999.,
+                        -999.,
+                        -999.);
           }
-          outputParts(outputCollision.lastIndex(),
-                      phiPt,
-                      phiEta,
-                      phiPhi,
-                      phiP,
-                      phiM,
-                      aod::femtouniverseparticle::ParticleType::kPhi,
-                      cutContainerV0.at(femtoUniverseV0Selection::V0ContainerPosition::kV0),
-                      0,
-                      0, // p1.v0cosPA(col.posX(), col.posY(), col.posZ()),
-                      indexChildID,
-                      0, // v0.mLambda(),
-                      0, // v0.mAntiLambda(),
-                      p1.sign(),
-                      p1.beta(),
-                      p1.itsChi2NCl(),
-                      p1.tpcChi2NCl(),
-                      p1.tpcNSigmaKa(),
-                      p1.tofNSigmaKa(),
-                      (uint8_t)p1.tpcNClsFound(),
-                      0, // p1.tpcNClsFindable(),
-                      0, //(uint8_t)p1.tpcNClsCrossedRows(),
-                      p1.tpcNClsShared(),
-                      p1.tpcInnerParam(),
-                      p1.itsNCls(),
-                      p1.itsNClsInnerBarrel(),
-                      0, // p1.dcaXY(),
-                      0, // p1.dcaZ(),
-                      p1.tpcSignal(),
-                      p1.tpcNSigmaStoreEl(),
-                      p1.tpcNSigmaStorePi(),
-                      p1.tpcNSigmaStoreKa(),
-                      p1.tpcNSigmaStorePr(),
-                      p1.tpcNSigmaStoreDe(),
-                      p1.tofNSigmaStoreEl(),
-                      p1.tofNSigmaStorePi(),
-                      p1.tofNSigmaStoreKa(),
-                      p1.tofNSigmaStorePr(),
-                      p1.tofNSigmaStoreDe(),
-                      -999.,
-                      -999.,
-                      -999.,
-                      -999.,
-                      -999.,
-                      -999.);
         }
       }
     }
@@ -10,6 +10,7 @@
 // or submit itself to any jurisdiction.
 
 #include "FlowContainer.h"
+#include <cstring>
 
 ClassImp(FlowContainer);
 
@@ -134,14 +135,29 @@ void FlowContainer::SetXAxis()
   }
 }
 int FlowContainer::FillProfile(const char* hname, double multi, double corr, double w, double rn)
+{
+  if (!fProf)
+    return -1;
+  int yin = GetProfileBin(hname);
+  if (yin < 0)
+    return -1;
+  return FillProfile(yin, multi, corr, w, rn);
+};
+int FlowContainer::GetProfileBin(const char* hname)
 {
   if (!fProf)
     return -1;
   int yin = fProf->GetYaxis()->FindBin(hname);
-  if (!yin) {
+  if (yin < 1) {
     printf("Could not find bin %s\n", hname);
     return -1;
   };
+  return yin;
+};
+int FlowContainer::FillProfile(int yin, double multi, double corr, double w, double rn)
+{
+  if (!fProf)
+    return -1;
   fProf->Fill(multi, yin, corr, w);
   if (fNRandom) {
     double rnind = rn * fNRandom;
@@ -149,6 +165,71 @@ int FlowContainer::FillProfile(const char* hname, double multi, double corr, dou
   };
   return 0;
 };
+int FlowContainer::FillProfiles(double multi, const std::vector<int>& yins, const std::vector<double>& corrs, const std::vector<double>& ws, double rn)
+{
+  if (!fProf)
+    return -1;
+  if (yins.size() != corrs.size() || yins.size() != ws.size()) {
+    printf("Numbers of bins, correlations and weights do not match!\n");
+    return -1;
+  };
+  if (yins.empty())
+    return 0;
+  FillProfileBins(fProf, multi, yins, corrs, ws);
+  if (fNRandom) {
+    double rnind = rn * fNRandom;
+    FillProfileBins((TProfile2D*)fProfRand->At((int)rnind), multi, yins, corrs, ws);
+  };
+  return 0;
+};
+void FlowContainer::FillProfileBins(TProfile2D* prof, double multi, const std::vector<int>& yins, const std::vector<double>& corrs, const std::vector<double>& ws)
+{
+  // Same as TProfile2D::Fill for each correlator, but the x-bin is found once and the statistics are updated once.
+  // Buffered profiles, profiles with a z range and profiles without Sumw2 go through TProfile2D::Fill
+  int nFills = static_cast<int>(yins.size());
+  if (prof->GetBuffer() || prof->GetZmin() != prof->GetZmax() || !prof->GetBinSumw2()->fN) {
+    for (int i = 0; i < nFills; i++)
+      if (yins[i] > 0)
+        prof->Fill(multi, yins[i], corrs[i], ws[i]);
+    return;
+  };
+  int binx = prof->GetXaxis()->FindBin(multi);
+  if (binx < 0)
+    return;
+  bool fillStats = (binx > 0 && binx <= prof->GetNbinsX()) || prof->GetStatOverflowsBehaviour();
+  double* sumwz = prof->fArray;
+  double* sumwz2 = prof->GetSumw2()->fArray;
+  double* sumw2 = prof->GetBinSumw2()->fArray;
+  double stats[TH1::kNstat];
+  prof->GetStats(stats);
+  int nFilled = 0;
+  for (int i = 0; i < nFills; i++) {
+    int yin = yins[i];
+    if (yin < 1)
+      continue;
+    double w = ws[i];
+    double z = corrs[i];
+    int bin = prof->GetBin(binx, yin);
+    sumwz[bin] += w * z;
+    sumwz2[bin] += w * z * z;
+    sumw2[bin] += w * w;
+    prof->SetBinEntries(bin, prof->GetBinEntries(bin) + w);
+    nFilled++;
+    if (!fillStats)
+      continue;
+    stats[0] += w;
+    stats[1] += w * w;
+    stats[2] += w * multi;
+    stats[3] += w * multi * multi;
+    stats[4] += w * yin;
+    stats[5] += w * yin * yin;
+    stats[6] += w * multi * yin;
+    stats[7] += w * z;
+    stats[8] += w * z * z;
+  };
+  prof->PutStats(stats);
+  prof->SetEntries(prof->GetEntries() + nFilled);
+};
 void FlowContainer::OverrideProfileErrors(TProfile2D* inpf)
 {
   int nBinsX = fProf->GetNbinsX();
@@ -191,11 +272,15 @@ Long64_t FlowContainer::Merge(TCollection* collist)
   while ((l_FC = ((FlowContainer*)all_FC()))) {
     TProfile2D* tpro = GetProfile();
     TProfile2D* spro = l_FC->GetProfile();
+    // The subsamples are clones of the main profile, so the bins are compared once per container and the arrays added directly
+    bool sameBins = false;
     if (!tpro) {
       fProf = (TProfile2D*)spro->Clone(spro->GetName());
       fProf->SetDirectory(0);
-    } else
-      tpro->Add(spro);
+    } else {
+      sameBins = ProfileSubset::HaveSameBins(tpro, spro);
+      ProfileSubset::AddProfile(tpro, spro, sameBins);
+    }
     nmerged++;
     TObjArray* tarr = l_FC->GetSubProfiles();
     if (!tarr)
@@ -204,12 +289,23 @@ Long64_t FlowContainer::Merge(TCollection* collist)
       fProfRand = new TObjArray();
       fProfRand->SetOwner(kTRUE);
     };
-    for (int i = 0; i < tarr->GetEntries(); i++) {
-      if (!(fProfRand->FindObject(tarr->At(i)->GetName()))) {
-        fProfRand->Add((TProfile2D*)tarr->At(i)->Clone(tarr->At(i)->GetName()));
-        ((TProfile2D*)fProfRand->At(fProfRand->GetEntries() - 1))->SetDirectory(0);
+    // The subsamples of the merged containers are stored in the same order, so they are only looked up by name when the order differs
+    int nSub = tarr->GetEntriesFast();
+    for (int i = 0; i < nSub; i++) {
+      TProfile2D* sprof = (TProfile2D*)tarr->At(i);
+      if (!sprof)
+        continue;
+      TProfile2D* tprof = 0;
+      if (i < fProfRand->GetEntriesFast() && fProfRand->At(i) && !strcmp(fProfRand->At(i)->GetName(), sprof->GetName()))
+        tprof = (TProfile2D*)fProfRand->At(i);
+      else
+        tprof = (TProfile2D*)fProfRand->FindObject(sprof->GetName());
+      if (!tprof) {
+        tprof = (TProfile2D*)sprof->Clone(sprof->GetName());
+        tprof->SetDirectory(0);
+        fProfRand->Add(tprof);
       } else {
-        ((TProfile2D*)fProfRand->FindObject(tarr->At(i)->GetName()))->Add((TProfile2D*)tarr->At(i));
+        ProfileSubset::AddProfile(tprof, sprof, sameBins);
       };
     };
   };
@@ -249,11 +345,14 @@ void FlowContainer::PickAndMerge(TFile* tfi)
   };
   TProfile2D* spro = lfc->GetProfile();
   TProfile2D* tpro = GetProfile();
+  bool sameBins = false;
   if (!tpro) {
     fProf = (TProfile2D*)spro->Clone(spro->GetName());
     fProf->SetDirectory(0);
-  } else
-    tpro->Add(spro);
+  } else {
+    sameBins = ProfileSubset::HaveSameBins(tpro, spro);
+    ProfileSubset::AddProfile(tpro, spro, sameBins);
+  }
   TObjArray* tarr = lfc->GetSubProfiles();
   if (!tarr) {
     return;
@@ -262,12 +361,22 @@ void FlowContainer::PickAndMerge(TFile* tfi)
     fProfRand = new TObjArray();
     fProfRand->SetOwner(kTRUE);
   };
-  for (int i = 0; i < tarr->GetEntries(); i++) {
-    if (!(fProfRand->FindObject(tarr->At(i)->GetName()))) {
-      fProfRand->Add((TProfile2D*)tarr->At(i)->Clone(tarr->At(i)->GetName()));
-      ((TProfile2D*)fProfRand->At(fProfRand->GetEntries() - 1))->SetDirectory(0);
+  int nSub = tarr->GetEntriesFast();
+  for (int i = 0; i < nSub; i++) {
+    TProfile2D* sprof = (TProfile2D*)tarr->At(i);
+    if (!sprof)
+      continue;
+    TProfile2D* tprof = 0;
+    if (i < fProfRand->GetEntriesFast() && fProfRand->At(i) && !strcmp(fProfRand->At(i)->GetName(), sprof->GetName()))
+      tprof = (TProfile2D*)fProfRand->At(i);
+    else
+      tprof = (TProfile2D*)fProfRand->FindObject(sprof->GetName());
+    if (!tprof) {
+      tprof = (TProfile2D*)sprof->Clone(sprof->GetName());
+      tprof->SetDirectory(0);
+      fProfRand->Add(tprof);
     } else {
-      ((TProfile2D*)fProfRand->FindObject(tarr->At(i)->GetName()))->Add((TProfile2D*)tarr->At(i));
+      ProfileSubset::AddProfile(tprof, sprof, sameBins);
     };
   };
 };
@@ -309,7 +418,7 @@ bool FlowContainer::OverrideMainWithSub(int ind, bool ExcludeChosen)
       if (!fProf)
         fProf = (TProfile2D*)tarprof->Clone(ts.Data());
       else
-        fProf->Add(tarprof);
+        ProfileSubset::AddProfile(fProf, tarprof, ProfileSubset::HaveSameBins(fProf, tarprof));
     };
     return kTRUE;
   };
@@ -328,8 +437,10 @@ bool FlowContainer::RandomizeProfile(int nSubsets)
       TString ts(fProf->GetName());
       delete fProf;
       fProf = (TProfile2D*)fProfRand->At(rInd)->Clone(ts.Data());
-    } else
-      fProf->Add((TProfile2D*)fProfRand->At(rInd));
+    } else {
+      TProfile2D* tarprof = (TProfile2D*)fProfRand->At(rInd);
+      ProfileSubset::AddProfile(fProf, tarprof, ProfileSubset::HaveSameBins(fProf, tarprof));
+    }
   }
   return kTRUE;
 }
@@ -11,6 +11,7 @@
 
 #ifndef FLOWCONTAINER__H
 #define FLOWCONTAINER__H
+#include <vector>
 #include "TH3F.h"
 #include "TProfile2D.h"
 #include "TProfile.h"
@@ -50,6 +51,9 @@ class FlowContainer : public TNamed
   int GetNMultiBins() { return fProf->GetNbinsX(); };
   double GetMultiAtBin(int bin) { return fProf->GetXaxis()->GetBinCenter(bin); };
   int FillProfile(const char* hname, double multi, double y, double w, double rn);
+  int GetProfileBin(const char* hname);                                       // y-bin of a correlator, to be resolved once and passed to the fills below
+  int FillProfile(int yin, double multi, double y, double w, double rn);      // fill of a correlator given its y-bin
+  int FillProfiles(double multi, const std::vector<int>& yins, const std::vector<double>& ys, const std::vector<double>& ws, double rn); // all the correlators of an event
   TProfile2D* GetProfile() { return fProf; };
   void OverrideProfileErrors(TProfile2D* inpf);
   void ReadAndMerge(const char* infile);
@@ -162,6 +166,7 @@ class FlowContainer : public TNamed
   double* fbinsPt;       //! Do not store; stored in fXAxis
   bool fPropagateErrors; //! do not store
   TProfile* GetRefFlowProfile(const char* order, double m1 = -1, double m2 = -1);
+  void FillProfileBins(TProfile2D* prof, double multi, const std::vector<int>& yins, const std::vector<double>& ys, const std::vector<double>& ws);
   ClassDef(FlowContainer, 2);
 };
 
@@ -18,7 +18,7 @@ If used, modified, or distributed, please aknowledge the author of this code.
 */
 
 #include "GFW.h"
-GFW::GFW() : fInitialized(false) {}
+GFW::GFW() : fInitialized(false), fSinglePrecision(false) {}
 
 GFW::~GFW()
 {
@@ -83,9 +83,10 @@ int GFW::CreateRegions()
   }
   int nRegions = 0;
   for (auto pItr = fRegions.begin(); pItr != fRegions.end(); pItr++) {
-    GFWCumulant* lCumulant = new GFWCumulant();
-    lCumulant->CreateComplexVectorArrayVarPower(pItr->Nhar, pItr->NparVec, pItr->NpT);
-    fCumulants.push_back(*lCumulant);
+    GFWCumulant lCumulant;
+    lCumulant.SetSinglePrecision(fSinglePrecision);
+    lCumulant.CreateComplexVectorArrayVarPower(pItr->Nhar, pItr->NparVec, pItr->NpT);
+    fCumulants.push_back(lCumulant);
     ++nRegions;
   }
   if (nRegions)
@@ -156,6 +157,85 @@ complex<double> GFW::RecursiveCorr(GFWCumulant* qpoi, GFWCumulant* qref, GFWCumu
   pows.push_back(powlast);
   return formula;
 };
+GFW::QPolynomial GFW::ExpandRecursiveCorr(int poiRole, bool hasOvl, vector<int>& hars, vector<int>& pows)
+{
+  // Same recursion as RecursiveCorr, but on the symbols of the Q-vectors instead of their values
+  if ((pows.at(0) != 1) && hasOvl)
+    poiRole = kOvl;
+  if (hars.size() < 2)
+    return QPolynomial{{1., {{poiRole, hars.at(0), pows.at(0), true}}}};
+  if (hars.size() < 3) {
+    QPolynomial formula{{1., {{poiRole, hars.at(0), pows.at(0), true}, {kRef, hars.at(1), pows.at(1), true}}}};
+    if (hasOvl)
+      formula.push_back({-1., {{kOvl, hars.at(0) + hars.at(1), pows.at(0) + pows.at(1), true}}});
+    return formula;
+  }
+  int harlast = hars.at(hars.size() - 1);
+  int powlast = pows.at(pows.size() - 1);
+  hars.erase(hars.end() - 1);
+  pows.erase(pows.end() - 1);
+  QPolynomial formula = ExpandRecursiveCorr(poiRole, hasOvl, hars, pows);
+  for (auto& term : formula)
+    term.second.push_back({kRef, harlast, powlast, false}); // the last ref. Q-vector is always taken at pT bin 0
+  int lDegeneracy = 1;
+  int harSize = static_cast<int>(hars.size());
+  for (int i = harSize - 1; i >= 0; i--) {
+    if (i > 2) {
+      if (hars.at(i) == hars.at(i - 1) && pows.at(i) == pows.at(i - 1)) {
+        lDegeneracy++;
+        continue;
+      }
+    }
+    hars.at(i) += harlast;
+    pows.at(i) += powlast;
+    QPolynomial subtractVal = ExpandRecursiveCorr(poiRole, hasOvl, hars, pows);
+    for (auto& term : subtractVal)
+      formula.push_back({-term.first * lDegeneracy, std::move(term.second)});
+    lDegeneracy = 1;
+    hars.at(i) -= harlast;
+    pows.at(i) -= powlast;
+  }
+  hars.push_back(harlast);
+  pows.push_back(powlast);
+  return formula;
+};
+GFW::CorrPlan GFW::BuildCorrPlan(vector<int> hars, bool hasOvl)
+{
+  vector<int> pows(hars.size(), 1);
+  QPolynomial formula = ExpandRecursiveCorr(kPOI, hasOvl, hars, pows);
+  // The products commute, so sort the factors of each term and merge the identical terms
+  for (auto& term : formula)
+    std::sort(term.second.begin(), term.second.end());
+  std::sort(formula.begin(), formula.end(), [](const auto& a, const auto& b) { return a.second < b.second; });
+  CorrPlan plan;
+  for (int i = 0; i < static_cast<int>(formula.size()); i++) {
+    if (!plan.Coefs.empty() && formula[i].second == formula[i - 1].second) {
+      plan.Coefs.back() += formula[i].first;
+      continue;
+    }
+    plan.Coefs.push_back(formula[i].first);
+    plan.FirstFactor.push_back(static_cast<int>(plan.Factors.size()));
+    plan.Factors.insert(plan.Factors.end(), formula[i].second.begin(), formula[i].second.end());
+  }
+  plan.FirstFactor.push_back(static_cast<int>(plan.Factors.size()));
+  return plan;
+};
+complex<double> GFW::EvaluateCorrPlan(const CorrPlan& plan, GFWCumulant* qpoi, GFWCumulant* qref, GFWCumulant* qovl, int ptbin)
+{
+  GFWCumulant* cumulants[3] = {qpoi, qref, qovl};
+  complex<double> formula(0., 0.);
+  for (int i = 0; i < static_cast<int>(plan.Coefs.size()); i++) {
+    if (plan.Coefs[i] == 0)
+      continue;
+    complex<double> term(plan.Coefs[i], 0.);
+    for (int j = plan.FirstFactor[i]; j < plan.FirstFactor[i + 1]; j++) {
+      const QFactor& f = plan.Factors[j];
+      term *= cumulants[f.Role]->Vec(f.Har, f.Pow, f.AtPtBin ? ptbin : 0);
+    }
+    formula += term;
+  }
+  return formula;
+};
 void GFW::Clear()
 {
   if (!fInitialized)
@@ -243,6 +323,19 @@ GFW::CorrConfig GFW::GetCorrelatorConfig(string config, string head, bool ptdif)
   ReturnConfig.Head = head;
   ReturnConfig.pTDif = ptdif;
   // ReturnConfig.pTbin = ptbin;
+  // Precompile the formula of each subevent, so that Calculate does not go through the recursion for every event and pT bin
+  for (int i = 0; i < static_cast<int>(ReturnConfig.Regs.size()); i++) {
+    if (ReturnConfig.Regs.at(i).size() == 0 || ReturnConfig.Hars.at(i).size() == 0) {
+      ReturnConfig.Plans.clear();
+      ReturnConfig.PlansZeroHars.clear();
+      break;
+    }
+    int poi = ReturnConfig.Regs.at(i).at(0);
+    int ref = (ReturnConfig.Regs.at(i).size() > 1) ? ReturnConfig.Regs.at(i).at(1) : poi;
+    bool hasOvl = (ReturnConfig.Overlap.at(i) > -1) || (ref == poi);
+    ReturnConfig.Plans.push_back(BuildCorrPlan(ReturnConfig.Hars.at(i), hasOvl));
+    ReturnConfig.PlansZeroHars.push_back(BuildCorrPlan(vector<int>(ReturnConfig.Hars.at(i).size(), 0), hasOvl));
+  }
   fListOfCFGs.push_back(ReturnConfig);
   return ReturnConfig;
 };
@@ -254,7 +347,7 @@ complex<double> GFW::Calculate(int poi, int ref, vector<int> hars, int ptbin)
   GFWCumulant* qovl = qpoi;
   return RecursiveCorr(qpoi, qref, qovl, ptbin, hars);
 };
-complex<double> GFW::Calculate(CorrConfig corconf, int ptbin, bool SetHarmsToZero)
+complex<double> GFW::Calculate(const CorrConfig& corconf, int ptbin, bool SetHarmsToZero)
 {
   // if(!fInitialized) return complex<double>(0,0); //First check if initialised, if not -- initialize, and if it fails, return
   if (corconf.Regs.size() == 0)
@@ -290,12 +383,19 @@ complex<double> GFW::Calculate(CorrConfig corconf, int ptbin, bool SetHarmsToZer
       qovl = &fCumulants.at(ovl);
     else if (ref == poi)
       qovl = qref; // If ref and poi are the same, then the same is for overlap. Only, when OL not explicitly defined
+    const vector<CorrPlan>& plans = SetHarmsToZero ? corconf.PlansZeroHars : corconf.Plans;
+    if (i < static_cast<int>(plans.size())) {
+      retval *= EvaluateCorrPlan(plans[i], qpoi, qref, qovl, ptInd);
+      continue;
+    }
+    // Configurations without precompiled formulas go through the recursion
+    vector<int> hars = corconf.Hars.at(i);
     if (SetHarmsToZero) {
-      for (int j = 0; j < static_cast<int>(corconf.Hars.at(i).size()); j++) {
-        corconf.Hars.at(i).at(j) = 0;
+      for (int j = 0; j < static_cast<int>(hars.size()); j++) {
+        hars.at(j) = 0;
       }
     }
-    retval *= RecursiveCorr(qpoi, qref, qovl, ptInd, corconf.Hars.at(i));
+    retval *= RecursiveCorr(qpoi, qref, qovl, ptInd, hars);
   }
   return retval;
 };
@@ -25,6 +25,7 @@ If used, modified, or distributed, please aknowledge the author of this code.
 #include <utility>
 #include <algorithm>
 #include <complex>
+#include <tuple>
 using std::complex;
 using std::string;
 using std::vector;
@@ -45,6 +46,28 @@ class GFW
     };
     void PrintStructure() { printf("%s: eta [%f.. %f].", rName.c_str(), EtaMin, EtaMax); }
   };
+  enum QRole_t { kPOI = 0,
+                 kRef = 1,
+                 kOvl = 2 };
+  struct QFactor { // One Q-vector of a correlator term: region role, harmonic, power and whether it is taken at the requested pT bin or at bin 0
+    int Role;
+    int Har;
+    int Pow;
+    bool AtPtBin;
+    bool operator<(const QFactor& a) const
+    {
+      return std::tie(Role, Har, Pow, AtPtBin) < std::tie(a.Role, a.Har, a.Pow, a.AtPtBin);
+    };
+    bool operator==(const QFactor& a) const
+    {
+      return Role == a.Role && Har == a.Har && Pow == a.Pow && AtPtBin == a.AtPtBin;
+    };
+  };
+  struct CorrPlan { // Expansion of the recursive formula of one subevent into a sum of products of Q-vectors
+    vector<double> Coefs{};
+    vector<int> FirstFactor{}; // Factors of term i are [FirstFactor[i], FirstFactor[i+1])
+    vector<QFactor> Factors{};
+  };
   struct CorrConfig {
     vector<vector<int>> Regs{};
     vector<vector<int>> Hars{};
@@ -52,6 +75,8 @@ class GFW
     vector<int> ptInd;
     bool pTDif = false;
     string Head = "";
+    vector<CorrPlan> Plans{};         // Precompiled formula of each subevent
+    vector<CorrPlan> PlansZeroHars{}; // Same, with all harmonics set to zero
   };
   GFW();
   ~GFW();
@@ -66,11 +91,13 @@ class GFW
   void Clear();
   GFWCumulant GetCumulant(int index) { return fCumulants.at(index); }
   CorrConfig GetCorrelatorConfig(string config, string head = "", bool ptdif = false);
-  complex<double> Calculate(CorrConfig corconf, int ptbin, bool SetHarmsToZero);
+  complex<double> Calculate(const CorrConfig& corconf, int ptbin, bool SetHarmsToZero);
   void InitializePowerArrays();
+  void SetSinglePrecision(bool single) { fSinglePrecision = single; } // Q-vectors of the regions in single precision, to be set before CreateRegions()
 
  protected:
   bool fInitialized;
+  bool fSinglePrecision;
   vector<CorrConfig> fListOfCFGs;
   complex<double> TwoRec(int n1, int n2, int p1, int p2, int ptbin, GFWCumulant*, GFWCumulant*, GFWCumulant*);
   complex<double> RecursiveCorr(GFWCumulant* qpoi, GFWCumulant* qref, GFWCumulant* qol, int ptbin, vector<int>& hars, vector<int>& pows); // POI, Ref. flow, overlapping region
@@ -79,6 +106,11 @@ class GFW
   Region GetRegion(int index) { return fRegions.at(index); }
   int FindRegionByName(string refName);
   vector<pair<int, vector<int>>> GetHarmonicsSingleConfig(const CorrConfig&);
+  // Precompiled correlators:
+  using QPolynomial = vector<pair<double, vector<QFactor>>>;
+  QPolynomial ExpandRecursiveCorr(int poiRole, bool hasOvl, vector<int>& hars, vector<int>& pows);
+  CorrPlan BuildCorrPlan(vector<int> hars, bool hasOvl);
+  complex<double> EvaluateCorrPlan(const CorrPlan& plan, GFWCumulant* qpoi, GFWCumulant* qref, GFWCumulant* qovl, int ptbin);
   // Calculating functions:
   complex<double> Calculate(int poi, int ref, vector<int> hars, int ptbin = 0); // For differential, need POI and reference
   complex<double> Calculate(int poi, vector<int> hars);                         // For integrated case
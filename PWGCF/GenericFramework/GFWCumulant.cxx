@@ -17,13 +17,20 @@ A container to store Q vectors for one subevent with an extra layer to recursive
 If used, modified, or distributed, please aknowledge the author of this code.
 */
 #include "GFWCumulant.h"
-GFWCumulant::GFWCumulant() : fQvector(0),
+#include <algorithm>
+GFWCumulant::GFWCumulant() : fQvector(),
+                             fQvectorF(),
+                             fSinglePrecision(false),
+                             fHarOffsets(),
+                             fNQPerPt(0),
+                             fMaxPow(0),
+                             fWeightPows(),
                              fUsed(kBlank),
                              fNEntries(-1),
                              fN(1),
                              fPow(1),
                              fPt(1),
-                             fFilledPts(0),
+                             fFilledPts(),
                              fInitialized(false) {}
 
 GFWCumulant::~GFWCumulant() {}
@@ -36,53 +43,49 @@ void GFWCumulant::FillArray(int ptin, double phi, double weight, double SecondWe
   else if (ptin < 0 || ptin >= fPt)
     return;
   fFilledPts[ptin] = true;
+  // The powers of the weight are the same for all harmonics, so compute them once; multiplication is cheaper that power
+  // Also, if second weight is specified, then keep the first weight with power no more than 1, and us the other weight otherwise
+  // this is important when POIs are a subset of REFs and have different weights than REFs
+  fWeightPows[0] = 1;
+  for (int lPow = 1; lPow < fMaxPow; lPow++)
+    fWeightPows[lPow] = (SecondWeight > 0 && lPow > 1) ? fWeightPows[lPow - 1] * SecondWeight : fWeightPows[lPow - 1] * weight;
+  if (fSinglePrecision)
+    FillQs(fQvectorF.data() + ptin * fNQPerPt, phi);
+  else
+    FillQs(fQvector.data() + ptin * fNQPerPt, phi);
+  Inc();
+};
+template <typename T>
+void GFWCumulant::FillQs(complex<T>* lQ, double phi)
+{
+  // Higher harmonics from the angle addition, exp(i(n+1)phi) = exp(i*n*phi)*exp(i*phi), instead of sin and cos for each of them
+  // The harmonics are always computed in double precision, only the sums are stored in the precision of the Q-vectors
+  const complex<double> lStep(cos(phi), sin(phi));
+  complex<double> lHar(1., 0.);
   for (int lN = 0; lN < fN; lN++) {
-    double lSin = sin(lN * phi); // No need to recalculate for each power
-    double lCos = cos(lN * phi); // No need to recalculate for each power
-    for (int lPow = 0; lPow < PW(lN); lPow++) {
-      double lPrefactor = 0;
-      // Dont calculate it twice; multiplication is cheaper that power
-      // Also, if second weight is specified, then keep the first weight with power no more than 1, and us the other weight otherwise
-      // this is important when POIs are a subset of REFs and have different weights than REFs
-      if (SecondWeight > 0 && lPow > 1)
-        lPrefactor = pow(SecondWeight, lPow - 1) * weight;
-      else
-        lPrefactor = pow(weight, lPow);
-      double qsin = lPrefactor * lSin;
-      double qcos = lPrefactor * lCos;
-      fQvector[ptin][lN][lPow] += complex<double>(qcos, qsin);
-    }
+    complex<T>* lQHar = lQ + fHarOffsets[lN];
+    for (int lPow = 0; lPow < PW(lN); lPow++)
+      lQHar[lPow] += complex<T>(fWeightPows[lPow] * lHar);
+    lHar *= lStep;
   }
-  Inc();
 };
 void GFWCumulant::ResetQs()
 {
   if (!fNEntries)
     return; // If 0 entries, then no need to reset. Otherwise, if -1, then just initialized and need to set to 0.
-  for (int i = 0; i < fPt; i++) {
-    fFilledPts[i] = false;
-    for (int lN = 0; lN < fN; lN++) {
-      for (int lPow = 0; lPow < PW(lN); lPow++) {
-        fQvector[i][lN][lPow] = fNullQ;
-      }
-    }
-  }
+  std::fill(fFilledPts.begin(), fFilledPts.end(), false);
+  std::fill(fQvector.begin(), fQvector.end(), fNullQ);
+  std::fill(fQvectorF.begin(), fQvectorF.end(), complex<float>(0.f, 0.f));
   fNEntries = 0;
 };
 void GFWCumulant::DestroyComplexVectorArray()
 {
   if (!fInitialized)
     return;
-  for (int l_n = 0; l_n < fN; l_n++) {
-    for (int i = 0; i < fPt; i++) {
-      delete[] fQvector[i][l_n];
-    }
-  }
-  for (int i = 0; i < fPt; i++) {
-    delete[] fQvector[i];
-  }
-  delete[] fQvector;
-  delete[] fFilledPts;
+  fQvector.clear();
+  fQvectorF.clear();
+  fHarOffsets.clear();
+  fFilledPts.clear();
   fInitialized = false;
   fNEntries = -1;
 };
@@ -101,17 +104,21 @@ void GFWCumulant::CreateComplexVectorArrayVarPower(int N, vector<int> PowVec, in
   fN = N;
   fPow = 0;
   fPt = Pt;
-  fFilledPts = new bool[Pt];
+  fFilledPts.assign(Pt, false);
   fPowVec = PowVec;
-  fQvector = new complex<double>**[fPt];
-  for (int i = 0; i < fPt; i++) {
-    fQvector[i] = new complex<double>*[fN];
-  }
+  fHarOffsets.resize(fN);
+  fNQPerPt = 0;
+  fMaxPow = 1;
   for (int l_n = 0; l_n < fN; l_n++) {
-    for (int i = 0; i < fPt; i++) {
-      fQvector[i][l_n] = new complex<double>[PW(l_n)];
-    }
+    fHarOffsets[l_n] = fNQPerPt;
+    fNQPerPt += PW(l_n);
+    fMaxPow = std::max(fMaxPow, PW(l_n));
   }
+  fWeightPows.resize(fMaxPow);
+  if (fSinglePrecision)
+    fQvectorF.assign(fPt * fNQPerPt, complex<float>(0.f, 0.f));
+  else
+    fQvector.assign(fPt * fNQPerPt, fNullQ);
   ResetQs();
   fInitialized = true;
 };
@@ -121,13 +128,13 @@ complex<double> GFWCumulant::Vec(int n, int p, int ptbin)
     return 0;
   if (ptbin >= fPt || ptbin < 0)
     ptbin = 0;
-  if (n >= 0)
-    return fQvector[ptbin][n][p];
-  return conj(fQvector[ptbin][-n][p]);
+  const int lInd = ptbin * fNQPerPt + fHarOffsets[n >= 0 ? n : -n] + p;
+  const complex<double> lQ = fSinglePrecision ? complex<double>(fQvectorF[lInd]) : fQvector[lInd];
+  return n >= 0 ? lQ : conj(lQ);
 };
 bool GFWCumulant::IsPtBinFilled(int ptb)
 {
-  if (!fFilledPts)
+  if (fFilledPts.empty())
     return false;
   if (ptb > 0) {
     if (fPt == 1)
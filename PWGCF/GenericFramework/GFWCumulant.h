@@ -33,6 +33,12 @@ class GFWCumulant
   enum UsedFlags_t { kBlank = 0,
                      kFull = 1,
                      kPt = 2 };
+  void SetSinglePrecision(bool single) // Q-vectors stored as complex<float>, to be set before the arrays are created
+  {
+    DestroyComplexVectorArray();
+    fSinglePrecision = single;
+  };
+  bool IsSinglePrecision() { return fSinglePrecision; }
   void SetType(uint infl)
   {
     DestroyComplexVectorArray();
@@ -47,7 +53,15 @@ class GFWCumulant
   void DestroyComplexVectorArray();
   complex<double> Vec(int, int, int ptbin = 0); // envelope class to summarize pt-dif. Q-vec getter
  protected:
-  complex<double>*** fQvector;
+  template <typename T>
+  void FillQs(complex<T>* lQ, double phi);
+  vector<complex<double>> fQvector; //! Q-vectors of all pt bins, harmonics and powers in one contiguous array
+  vector<complex<float>> fQvectorF; //! Same, in single precision, used instead of fQvector if fSinglePrecision
+  bool fSinglePrecision;            //! Q-vectors stored in single precision
+  vector<int> fHarOffsets;          //! Offset of each harmonic in the Q-vectors of a pt bin
+  int fNQPerPt;                     //! Number of Q-vectors per pt bin
+  int fMaxPow;                      //! Largest power over all harmonics
+  vector<double> fWeightPows;       //! Powers of the weights of the track being filled
   uint fUsed;
   int fNEntries;
   // Q-vectors. Could be done recursively, but maybe defining each one of them explicitly is easier to read
@@ -55,7 +69,7 @@ class GFWCumulant
   int fPow;            //! Power
   vector<int> fPowVec; //! Powers array
   int fPt;             //! fPt bins
-  bool* fFilledPts;
+  vector<bool> fFilledPts;
   bool fInitialized; // Arrays are initialized
   complex<double> fNullQ = 0;
 };
@@ -10,6 +10,7 @@
 // or submit itself to any jurisdiction.
 
 #include "GFWWeights.h"
+#include <algorithm>
 #include "TMath.h"
 GFWWeights::GFWWeights() : fDataFilled(kFALSE),
                            fMCFilled(kFALSE),
@@ -129,29 +130,88 @@ double GFWWeights::GetWeight(double phi, double eta, double vz, double pt, doubl
     return 1. / weight;
   return 1;
 };
-double GFWWeights::GetNUA(double phi, double eta, double vz)
+void GFWWeights::WeightAxis::Set(const TAxis* inax)
+{
+  Nbins = inax->GetNbins();
+  Min = inax->GetXmin();
+  Max = inax->GetXmax();
+  Edges.clear();
+  if (inax->GetXbins()->fN)
+    Edges.assign(inax->GetXbins()->fArray, inax->GetXbins()->fArray + Nbins + 1);
+};
+int GFWWeights::WeightAxis::FindBin(double x) const
+{
+  if (x < Min)
+    return 0;
+  if (!(x < Max))
+    return Nbins + 1;
+  if (Edges.empty())
+    return 1 + static_cast<int>(Nbins * (x - Min) / (Max - Min));
+  return static_cast<int>(std::upper_bound(Edges.begin(), Edges.end(), x) - Edges.begin());
+};
+void GFWWeights::WeightTable::Set(TH3D* inh)
 {
+  Axes[0].Set(inh->GetXaxis());
+  Axes[1].Set(inh->GetYaxis());
+  Axes[2].Set(inh->GetZaxis());
+  int nCells = (Axes[0].Nbins + 2) * (Axes[1].Nbins + 2) * (Axes[2].Nbins + 2);
+  Weights.resize(nCells);
+  for (int i = 0; i < nCells; i++) {
+    double weight = inh->GetBinContent(i);
+    Weights[i] = (weight != 0) ? 1. / weight : 1;
+  };
+};
+bool GFWWeights::PrepareNUA()
+{
+  if (fAccTable.IsSet())
+    return kTRUE;
   if (!fAccInt)
     CreateNUA();
-  int xind = fAccInt->GetXaxis()->FindBin(phi);
-  int etaind = fAccInt->GetYaxis()->FindBin(eta);
-  int vzind = fAccInt->GetZaxis()->FindBin(vz);
-  double weight = fAccInt->GetBinContent(xind, etaind, vzind);
-  if (weight != 0)
-    return 1. / weight;
-  return 1;
-}
-double GFWWeights::GetNUE(double pt, double eta, double vz)
+  if (!fAccInt)
+    return kFALSE;
+  fAccTable.Set(fAccInt);
+  return kTRUE;
+};
+bool GFWWeights::PrepareNUE()
 {
+  if (fEffTable.IsSet())
+    return kTRUE;
   if (!fEffInt)
     CreateNUE();
-  int xind = fEffInt->GetXaxis()->FindBin(pt);
-  int etaind = fEffInt->GetYaxis()->FindBin(eta);
-  int vzind = fEffInt->GetZaxis()->FindBin(vz);
-  double weight = fEffInt->GetBinContent(xind, etaind, vzind);
-  if (weight != 0)
-    return 1. / weight;
-  return 1;
+  if (!fEffInt)
+    return kFALSE;
+  fEffTable.Set(fEffInt);
+  return kTRUE;
+};
+double GFWWeights::GetNUA(double phi, double eta, double vz)
+{
+  if (!PrepareNUA())
+    return 1;
+  return fAccTable.Get(fAccTable.Axes[0].FindBin(phi), fAccTable.Axes[1].FindBin(eta), fAccTable.Axes[2].FindBin(vz));
+}
+double GFWWeights::GetNUE(double pt, double eta, double vz)
+{
+  if (!PrepareNUE())
+    return 1;
+  return fEffTable.Get(fEffTable.Axes[0].FindBin(pt), fEffTable.Axes[1].FindBin(eta), fEffTable.Axes[2].FindBin(vz));
+}
+void GFWWeights::GetNUA(const std::vector<double>& phis, const std::vector<double>& etas, double vz, std::vector<double>& weights)
+{
+  weights.assign(phis.size(), 1.);
+  if (!PrepareNUA())
+    return;
+  int vzind = fAccTable.Axes[2].FindBin(vz);
+  for (size_t i = 0; i < phis.size(); i++)
+    weights[i] = fAccTable.Get(fAccTable.Axes[0].FindBin(phis[i]), fAccTable.Axes[1].FindBin(etas[i]), vzind);
+}
+void GFWWeights::GetNUE(const std::vector<double>& pts, const std::vector<double>& etas, double vz, std::vector<double>& weights)
+{
+  weights.assign(pts.size(), 1.);
+  if (!PrepareNUE())
+    return;
+  int vzind = fEffTable.Axes[2].FindBin(vz);
+  for (size_t i = 0; i < pts.size(); i++)
+    weights[i] = fEffTable.Get(fEffTable.Axes[0].FindBin(pts[i]), fEffTable.Axes[1].FindBin(etas[i]), vzind);
 }
 double GFWWeights::FindMax(TH3D* inh, int& ix, int& iy, int& iz)
 {
@@ -204,6 +264,7 @@ void GFWWeights::CreateNUA(bool IntegrateOverCentAndPt)
   if (IntegrateOverCentAndPt) {
     if (fAccInt)
       delete fAccInt;
+    fAccTable.Clear();
     fAccInt = (TH3D*)fW_data->At(0)->Clone("IntegratedAcceptance");
     fAccInt->Sumw2();
     for (int etai = 1; etai <= fAccInt->GetNbinsY(); etai++) {
@@ -264,6 +325,7 @@ void GFWWeights::CreateNUE(bool IntegrateOverCentrality)
     den->RebinY(2);
     num->RebinZ(5);
     den->RebinZ(5);
+    fEffTable.Clear();
     fEffInt = (TH3D*)num->Clone("Efficiency_Integrated");
     fEffInt->Divide(den);
     return;
@@ -349,6 +411,8 @@ void GFWWeights::OverwriteNUA()
   delete trash;
   fW_data->Add((TH3D*)fAccInt->Clone(ts.Data()));
   delete fAccInt;
+  fAccInt = 0;
+  fAccTable.Clear();
 }
 Long64_t GFWWeights::Merge(TCollection* collist)
 {
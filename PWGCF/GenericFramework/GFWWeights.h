@@ -11,6 +11,7 @@
 
 #ifndef GFWWeights__H
 #define GFWWeights__H
+#include <vector>
 #include "TObjArray.h"
 #include "TNamed.h"
 #include "TH3D.h"
@@ -30,6 +31,8 @@ class GFWWeights : public TNamed
   double GetWeight(double phi, double eta, double vz, double pt, double cent, int htype);             // htype: 0 for data, 1 for mc rec, 2 for mc gen
   double GetNUA(double phi, double eta, double vz);                                                   // This just fetches correction from integrated NUA, should speed up
   double GetNUE(double pt, double eta, double vz);                                                    // fetches weight from fEffInt
+  void GetNUA(const std::vector<double>& phis, const std::vector<double>& etas, double vz, std::vector<double>& weights); // NUA of all the tracks of an event
+  void GetNUE(const std::vector<double>& pts, const std::vector<double>& etas, double vz, std::vector<double>& weights);  // NUE of all the tracks of an event
   bool IsDataFilled() { return fDataFilled; };
   bool IsMCFilled() { return fMCFilled; };
   double FindMax(TH3D* inh, int& ix, int& iy, int& iz);
@@ -63,6 +66,26 @@ class GFWWeights : public TNamed
   TH3D* fAccInt;   //!
   int fNbinsPt;    //! do not store
   double* fbinsPt; //! do not store
+  struct WeightAxis { // Same bin finding as TAxis::FindBin, without the TAxis calls
+    int Nbins = 0;
+    double Min = 0;
+    double Max = 0;
+    std::vector<double> Edges{}; // only for variable bins
+    void Set(const TAxis* inax);
+    int FindBin(double x) const;
+  };
+  struct WeightTable { // Inverse weights of a TH3D, including the under- and overflows, indexed as TH3D::GetBin
+    WeightAxis Axes[3];
+    std::vector<double> Weights{};
+    void Set(TH3D* inh);
+    void Clear() { Weights.clear(); };
+    bool IsSet() const { return !Weights.empty(); };
+    double Get(int ix, int iy, int iz) const { return Weights[ix + (Axes[0].Nbins + 2) * (iy + (Axes[1].Nbins + 2) * iz)]; };
+  };
+  WeightTable fAccTable; //! tabulated fAccInt
+  WeightTable fEffTable; //! tabulated fEffInt
+  bool PrepareNUA();
+  bool PrepareNUE();
   void AddArray(TObjArray* targ, TObjArray* sour);
   const char* GetBinName(double ptv, double v0mv, const char* pf = "")
   {
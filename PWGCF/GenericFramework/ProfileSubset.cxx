@@ -10,7 +10,33 @@
 // or submit itself to any jurisdiction.
 
 #include "ProfileSubset.h"
+#include <cstring>
 #include "TProfile2D.h"
+#include "THashList.h"
+
+namespace
+{
+bool HaveSameAxis(const TAxis* a1, const TAxis* a2)
+{
+  if (a1->GetNbins() != a2->GetNbins() || a1->GetXmin() != a2->GetXmin() || a1->GetXmax() != a2->GetXmax())
+    return false;
+  const TArrayD* b1 = a1->GetXbins();
+  const TArrayD* b2 = a2->GetXbins();
+  if (b1->fN != b2->fN)
+    return false;
+  for (int i = 0; i < b1->fN; i++)
+    if (b1->fArray[i] != b2->fArray[i])
+      return false;
+  if (!a1->GetLabels() != !a2->GetLabels())
+    return false;
+  if (a1->GetLabels()) {
+    for (int i = 1; i <= a1->GetNbins(); i++)
+      if (strcmp(a1->GetBinLabel(i), a2->GetBinLabel(i)))
+        return false;
+  }
+  return true;
+}
+} // namespace
 
 TProfile* ProfileSubset::GetSubset(bool onX, const char* name, int firstbin, int lastbin, int l_nbins, double* l_binarray)
 {
@@ -65,15 +91,7 @@ void ProfileSubset::OverrideBinContent(double x, double y, double x2, double y2,
 {
   if (!fBinSumw2.fN)
     Sumw2();
-  TH2D* h2dW = ProjectionXY("h2temp-W", "W");
-  TH2D* h2dN = ProjectionXY("h2temp-N", "B");
-  int binIndex = FindBin(x, y);
-  int binIndex2 = FindBin(x2, y2);
-  fArray[binIndex] = h2dW->GetBinContent(binIndex2);
-  GetSumw2()->fArray[binIndex] = h2dW->GetSumw2()->fArray[binIndex2];
-  SetBinEntries(binIndex, h2dN->GetBinContent(binIndex2));
-  if (fBinSumw2.fN)
-    GetBinSumw2()->fArray[binIndex] = h2dN->GetSumw2()->fArray[binIndex2];
+  CopyBin(this, FindBin(x, y), this, FindBin(x2, y2));
 }
 void ProfileSubset::OverrideBinContent(double x, double y, double x2, double y2, TProfile2D* sourceProf)
 {
@@ -81,15 +99,72 @@ void ProfileSubset::OverrideBinContent(double x, double y, double x2, double y2,
     Sumw2();
   if (!sourceProf->fN)
     sourceProf->Sumw2();
-  TH2D* h2dW = sourceProf->ProjectionXY("h2temp-W", "W");
-  TH2D* h2dN = sourceProf->ProjectionXY("h2temp-N", "B");
-  int binIndex = FindBin(x, y);
-  int binIndex2 = sourceProf->FindBin(x2, y2);
-  fArray[binIndex] = h2dW->GetBinContent(binIndex2);
-  GetSumw2()->fArray[binIndex] = h2dW->GetSumw2()->fArray[binIndex2];
-  SetBinEntries(binIndex, h2dN->GetBinContent(binIndex2));
-  if (fBinSumw2.fN)
-    GetBinSumw2()->fArray[binIndex] = h2dN->GetSumw2()->fArray[binIndex2];
+  CopyBin(this, FindBin(x, y), sourceProf, sourceProf->FindBin(x2, y2));
+}
+// The arrays of the bin entries are protected members of TProfile2D, reached through the pointers to the members inherited by ProfileSubset
+void ProfileSubset::CopyBin(TProfile2D* target, int binIndex, const TProfile2D* source, int binIndex2)
+{
+  // Same contents as the "W" and "B" projections of the source bin, without projecting the whole profile
+  const TArrayD& sBinEntries = source->*(&ProfileSubset::fBinEntries);
+  const TArrayD& sBinSumw2 = source->*(&ProfileSubset::fBinSumw2);
+  target->fArray[binIndex] = source->fArray[binIndex2];
+  target->GetSumw2()->fArray[binIndex] = source->GetSumw2()->fArray[binIndex2];
+  target->SetBinEntries(binIndex, sBinEntries.fArray[binIndex2]);
+  TArrayD& tBinSumw2 = target->*(&ProfileSubset::fBinSumw2);
+  if (tBinSumw2.fN)
+    tBinSumw2.fArray[binIndex] = sBinSumw2.fN ? sBinSumw2.fArray[binIndex2] : sBinEntries.fArray[binIndex2];
+}
+bool ProfileSubset::HaveSameBins(const TProfile2D* p1, const TProfile2D* p2)
+{
+  if (p1->fN != p2->fN || p1->GetSumw2N() != p2->GetSumw2N())
+    return false;
+  if ((p1->*(&ProfileSubset::fBinSumw2)).fN != (p2->*(&ProfileSubset::fBinSumw2)).fN)
+    return false;
+  return HaveSameAxis(p1->GetXaxis(), p2->GetXaxis()) && HaveSameAxis(p1->GetYaxis(), p2->GetYaxis());
+}
+// Equivalent of TProfile2D::Add(source) for profiles with the same bins, see HaveSameBins(), without the consistency checks of the axes
+void ProfileSubset::AddBins(TProfile2D* target, const TProfile2D* source)
+{
+  double tStats[TH1::kNstat] = {0};
+  double sStats[TH1::kNstat] = {0};
+  target->GetStats(tStats);
+  source->GetStats(sStats);
+  const double entries = target->GetEntries() + source->GetEntries();
+
+  const int n = target->fN;
+  double* tSum = target->fArray;
+  const double* sSum = source->fArray;
+  for (int i = 0; i < n; i++)
+    tSum[i] += sSum[i];
+  if (target->GetSumw2N()) {
+    double* tSumw2 = target->GetSumw2()->fArray;
+    const double* sSumw2 = source->GetSumw2()->fArray;
+    for (int i = 0; i < n; i++)
+      tSumw2[i] += sSumw2[i];
+  }
+  double* tEntries = (target->*(&ProfileSubset::fBinEntries)).fArray;
+  const double* sEntries = (source->*(&ProfileSubset::fBinEntries)).fArray;
+  for (int i = 0; i < n; i++)
+    tEntries[i] += sEntries[i];
+  TArrayD& tBinSumw2 = target->*(&ProfileSubset::fBinSumw2);
+  if (tBinSumw2.fN) {
+    double* tBinSw2 = tBinSumw2.fArray;
+    const double* sBinSw2 = (source->*(&ProfileSubset::fBinSumw2)).fArray;
+    for (int i = 0; i < n; i++)
+      tBinSw2[i] += sBinSw2[i];
+  }
+
+  for (int i = 0; i < TH1::kNstat; i++)
+    tStats[i] += sStats[i];
+  target->PutStats(tStats);
+  target->SetEntries(entries);
+}
+void ProfileSubset::AddProfile(TProfile2D* target, const TProfile2D* source, bool sameBins)
+{
+  if (sameBins)
+    AddBins(target, source);
+  else
+    target->Add(source);
 }
 bool ProfileSubset::OverrideBinsWithZero(int xb1, int yb1, int xb2, int yb2)
 {
@@ -25,6 +25,11 @@ class ProfileSubset : public TProfile2D
   void OverrideBinContent(double x, double y, double x2, double y2, double val);
   void OverrideBinContent(double x, double y, double x2, double y2, TProfile2D* sourceProf);
   bool OverrideBinsWithZero(int xb1, int yb1, int xb2, int yb2);
+  // Bulk operations on the arrays of sums, sums of squares and entries of the bins
+  static bool HaveSameBins(const TProfile2D* p1, const TProfile2D* p2);
+  static void AddBins(TProfile2D* target, const TProfile2D* source);
+  static void AddProfile(TProfile2D* target, const TProfile2D* source, bool sameBins);
+  static void CopyBin(TProfile2D* target, int binIndex, const TProfile2D* source, int binIndex2);
 
   ClassDef(ProfileSubset, 2);
 };
@@ -438,12 +438,12 @@ void JFFlucAnalysis::UserExec(Option_t*)
     for (UInt_t ih = 2; ih < kNH; ih++) {
       for (UInt_t ik = 1; ik < nKL; ik++) { // 2k(0) =1, 2k(1) =2, 2k(2)=4....
         vn2[ih][ik] = corr[ih][ik].Re() / ref_2Np[ik - 1];
-        fh_vn[ih][ik][fCBin]->Fill(vn2[ih][ik], ebe_2Np_weight[ik - 1]);
-        fh_vna[ih][ik][fCBin]->Fill(ncorr[ih][ik].Re() / ref_2Np[ik - 1], ebe_2Np_weight[ik - 1]);
+        fh_vn.At(fh_vn.GlobalIndex(ih, ik, fCBin))->Fill(vn2[ih][ik], ebe_2Np_weight[ik - 1]);
+        fh_vna.At(fh_vna.GlobalIndex(ih, ik, fCBin))->Fill(ncorr[ih][ik].Re() / ref_2Np[ik - 1], ebe_2Np_weight[ik - 1]);
         for (UInt_t ihh = 2; ihh < kcNH; ihh++) {
           for (UInt_t ikk = 1; ikk < nKL; ikk++) {
             vn2_vn2[ih][ik][ihh][ikk] = ncorr2[ih][ik][ihh][ikk] / ref_2Np[ik + ikk - 1];
-            fh_vn_vn[ih][ik][ihh][ikk][fCBin]->Fill(vn2_vn2[ih][ik][ihh][ikk], ebe_2Np_weight[ik + ikk - 1]);
+            fh_vn_vn.At(fh_vn_vn.GlobalIndex(ih, ik, ihh, ikk, fCBin))->Fill(vn2_vn2[ih][ik][ihh][ikk], ebe_2Np_weight[ik + ikk - 1]);
           }
         }
       }
@@ -117,13 +117,10 @@ class JFFlucAnalysis
   inline void CalculateQvectorsQC(JInputClass& inputInst)
   {
     // calculate Q-vector for QC method ( no subgroup )
-    for (UInt_t ih = 0; ih < kNH; ih++) {
-      for (UInt_t ik = 0; ik < nKL; ++ik) {
-        QvectorQC[ih][ik] = TComplex(0, 0);
-        for (UInt_t isub = 0; isub < 2; isub++)
-          QvectorQCgap[isub][ih][ik] = TComplex(0, 0);
-      }
-    } // for max harmonics
+    // cos(ih*phi), sin(ih*phi) of a track are obtained from cos(phi), sin(phi) with the angle addition
+    // recurrence, and the sums are accumulated in plain arrays which are copied to the TComplex at the end
+    Double_t qRe[kNH][nKL] = {{0.0}}, qIm[kNH][nKL] = {{0.0}};
+    Double_t qGapRe[2][kNH][nKL] = {{{0.0}}}, qGapIm[2][kNH][nKL] = {{{0.0}}};
     for (auto& track : inputInst) {
       // pt cuts already applied in task.
       if (track.eta() < -fEta_max || track.eta() > fEta_max)
@@ -132,21 +129,43 @@ class JFFlucAnalysis
       Double_t effCorr = 1.0;    // itrack->GetTrackEff();//fEfficiency->GetCorrection( track.pt(), fEffFilterBit, fCent); //XXXXXX
       Double_t phiNUACorr = 1.0; // itrack->GetWeight(); //XXXXXX
 
-      UInt_t isub = (UInt_t)(track.eta() > 0.0);
-      for (UInt_t ih = 0; ih < kNH; ih++) {
-        Double_t tf = 1.0;
-        TComplex q[nKL];
-        for (UInt_t ik = 0; ik < nKL; ik++) {
-          q[ik] = TComplex(tf * TMath::Cos(ih * track.phi()), tf * TMath::Sin(ih * track.phi()));
-          QvectorQC[ih][ik] += q[ik];
+      Double_t tf[nKL];
+      tf[0] = 1.0;
+      for (UInt_t ik = 1; ik < nKL; ik++)
+        tf[ik] = tf[ik - 1] / (phiNUACorr * effCorr);
 
-          if (TMath::Abs(track.eta()) > fEta_min)
-            QvectorQCgap[isub][ih][ik] += q[ik];
+      Double_t c1 = TMath::Cos(track.phi());
+      Double_t s1 = TMath::Sin(track.phi());
+      Double_t cn[kNH], sn[kNH];
+      cn[0] = 1.0;
+      sn[0] = 0.0;
+      for (UInt_t ih = 1; ih < kNH; ih++) {
+        cn[ih] = cn[ih - 1] * c1 - sn[ih - 1] * s1;
+        sn[ih] = sn[ih - 1] * c1 + cn[ih - 1] * s1;
+      }
 
-          tf *= 1.0 / (phiNUACorr * effCorr);
+      for (UInt_t ih = 0; ih < kNH; ih++)
+        for (UInt_t ik = 0; ik < nKL; ik++) {
+          qRe[ih][ik] += tf[ik] * cn[ih];
+          qIm[ih][ik] += tf[ik] * sn[ih];
         }
+
+      if (TMath::Abs(track.eta()) > fEta_min) {
+        UInt_t isub = (UInt_t)(track.eta() > 0.0);
+        for (UInt_t ih = 0; ih < kNH; ih++)
+          for (UInt_t ik = 0; ik < nKL; ik++) {
+            qGapRe[isub][ih][ik] += tf[ik] * cn[ih];
+            qGapIm[isub][ih][ik] += tf[ik] * sn[ih];
+          }
       }
     }
+    for (UInt_t ih = 0; ih < kNH; ih++) {
+      for (UInt_t ik = 0; ik < nKL; ++ik) {
+        QvectorQC[ih][ik] = TComplex(qRe[ih][ik], qIm[ih][ik]);
+        for (UInt_t isub = 0; isub < 2; isub++)
+          QvectorQCgap[isub][ih][ik] = TComplex(qGapRe[isub][ih][ik], qGapIm[isub][ih][ik]);
+      }
+    } // for max harmonics
   };
 
   static Double_t pttJacek[74];
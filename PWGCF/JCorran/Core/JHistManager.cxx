@@ -272,7 +272,9 @@ JArrayBase::JArrayBase() : JNamed("JArayBase", "", "&Dir=default&Lazy", 0),
                            fNGenerated(0),
                            fIsBinFixed(false),
                            fIsBinLocked(false),
-                           fAlg(NULL)
+                           fAlg(NULL),
+                           fStrides(0),
+                           fItems(NULL)
 {
   // constrctor
 }
@@ -292,7 +294,9 @@ JArrayBase::JArrayBase(const JArrayBase& obj) : JNamed(obj.fName, obj.fTitle, ob
                                                 fNGenerated(obj.fNGenerated),
                                                 fIsBinFixed(obj.fIsBinFixed),
                                                 fIsBinLocked(obj.fIsBinLocked),
-                                                fAlg(obj.fAlg)
+                                                fAlg(obj.fAlg),
+                                                fStrides(obj.fStrides),
+                                                fItems(obj.fItems)
 {
   // copy constructor TODO: proper handling of pointer data members
 }
@@ -318,6 +322,18 @@ void* JArrayBase::GetItem()
   return item;
 }
 //_____________________________________________________
+void* JArrayBase::GetItemAt(int iG)
+{
+  void* item = fAlg->GetItemAt(iG);
+  if (!item) {
+    ClearIndex();
+    fAlg->SetGlobalIndex(iG); // BuildItem names the item after the current index
+    BuildItem();
+    item = fAlg->GetItemAt(iG);
+  }
+  return item;
+}
+//_____________________________________________________
 void* JArrayBase::GetSingleItem()
 {
   if (fMode == kSingle)
@@ -338,6 +354,10 @@ void JArrayBase::FixBin()
   ClearIndex();
   fAlg = new JArrayAlgorithmSimple(this);
   fArraySize = fAlg->BuildArray();
+  fItems = fAlg->GetArray();
+  fStrides.resize(Dimension());
+  for (int i = 0; i < Dimension(); i++)
+    fStrides[i] = fAlg->StrideOf(i);
 }
 //_____________________________________________________
 int JArrayBase::Index(int d)
@@ -569,15 +589,14 @@ int JTH1::AddDim(TString v)
 Int_t JTH1::Write()
 {
   TDirectory* owd = (TDirectory*)gDirectory;
-  InitIterator();
-  void* item;
   if (fSubDirectory)
     fSubDirectory->cd();
   // else fDirectory->cd();
-  while (Next(item)) {
-    if (!item)
+  // the items are read from the item array, without moving the index through every position
+  for (int iG = 0; iG < fArraySize; iG++) {
+    if (!fItems[iG])
       continue;
-    TH1* obj = static_cast<TH1*>(item);
+    TH1* obj = static_cast<TH1*>(fItems[iG]);
     obj->Write();
     // obj->Write( 0, TObject::kOverwrite );
   }
@@ -189,6 +189,8 @@ class JArrayBase : public JNamed
 
   void* GetItem();
   void* GetSingleItem();
+  void* GetItemAt(int iG);
+  int StrideOf(int d) { return fStrides[d]; }
 
   /// void LockBin(bool is=true){}//TODO
   // bool IsBinLocked(){ return fIsBinLocked; }
@@ -221,6 +223,8 @@ class JArrayBase : public JNamed
   bool fIsBinFixed;
   bool fIsBinLocked;
   JArrayAlgorithm* fAlg;
+  ArrayInt fStrides; // strides of the dimensions in the item array, fixed with the bins
+  void** fItems;     // contiguous item array of fAlg, indexed by the global index
   friend class JArrayAlgorithm;
 };
 
@@ -238,6 +242,10 @@ class JArrayAlgorithm
   int Index(int i) { return fCMD->Index(i); }
   virtual int BuildArray() = 0;
   virtual void* GetItem() = 0;
+  virtual void* GetItemAt(int iG) = 0;
+  virtual int StrideOf(int d) = 0;
+  virtual void** GetArray() = 0;
+  virtual void SetGlobalIndex(int iG) = 0;
   virtual void SetItem(void* item) = 0;
   virtual void InitIterator() = 0;
   virtual bool Next(void*& item) = 0;
@@ -263,6 +271,10 @@ class JArrayAlgorithmSimple : public JArrayAlgorithm
   int GlobalIndex();
   void ReverseIndex(int iG);
   virtual void* GetItem();
+  virtual void* GetItemAt(int iG) { return fArray[iG]; }
+  virtual int StrideOf(int d) { return fDimFactor[d]; }
+  virtual void** GetArray() { return fArray; }
+  virtual void SetGlobalIndex(int iG) { ReverseIndex(iG); }
   virtual void SetItem(void* item);
   virtual void InitIterator() { fPos = 0; }
   virtual void** GetRawItem() { return &fArray[GlobalIndex()]; }
@@ -363,6 +375,21 @@ class JTH1Derived : public JTH1
   }
   T* operator->() { return static_cast<T*>(GetSingleItem()); }
   operator T*() { return static_cast<T*>(GetSingleItem()); }
+
+  // Fast access for the hot loops: the global position of [i0][i1]... is computed from the strides
+  // and At() reads the item array directly, without the index checks of operator[]
+  template <typename... Is>
+  int GlobalIndex(Is... is)
+  {
+    int d = 0, iG = 0;
+    ((iG += is * fStrides[d++]), ...);
+    return iG;
+  }
+  T* At(int iG)
+  {
+    void* item = fItems[iG];
+    return static_cast<T*>(item ? item : GetItemAt(iG));
+  }
   // Virtual from JArrayBase
 
   // Virtual from JTH1
@@ -101,6 +101,7 @@ Bool_t fCalculateCustomNestedLoop = kFALSE; // validate e-b-e all correlations w
 struct NestedLoops_Arrays {
   TProfile* fNestedLoopsPro[4][6][5] = {{{NULL}}}; //! multiparticle correlations from nested loops [2p=0,4p=1,6p=2,8p=3][n=1,n=2,...,n=6][0=integrated,1=vs. multiplicity,2=vs. centrality,3=pT,4=eta]
   TArrayD* ftaNestedLoops[2] = {NULL};             //! e-b-e container for nested loops [0=angles;1=product of all weights]
+  TArrayD* ftaNestedLoopsCosSin[2] = {NULL};       //! e-b-e container for nested loops [0=cos(n*phi);1=sin(n*phi)], n=1,...,gMaxHarmonic of particle i at i*gMaxHarmonic+n-1
   // TArrayD *ftaNestedLoopsKine[gKineDependenceVariables][gMaxNoBinsKine][2]; //! e-b-e container for nested loops [0=pT,1=eta][kine.bin][0=angles;1=product of all weights]
 } nl_a;
 
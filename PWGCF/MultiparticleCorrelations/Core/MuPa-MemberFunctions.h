@@ -42,6 +42,7 @@
 // Bool_t ParticleCuts(aod::Track const& track)
 // void CalculateCorrelations();
 // void CalculateNestedLoops(); // calculate all standard isotropic correlations with nested loops
+// void FillProfileWithSums(TProfile* pro, Double_t x, Double_t sumW, Double_t sumW2, Double_t sumWY, Double_t sumWY2, Int_t nEntries);
 // Double_t CalculateCustomNestedLoop(TArrayI *harmonics); // calculate nested loop for the specified harmonics
 
 // *) Called after all events are processed (former "Terminate()"):
@@ -592,6 +593,9 @@ void BookNestedLoopsHistograms()
     return;
   }
 
+  nl_a.ftaNestedLoopsCosSin[0] = new TArrayD(iMaxSize * gMaxHarmonic); // ebe container for cos(n*phi)
+  nl_a.ftaNestedLoopsCosSin[1] = new TArrayD(iMaxSize * gMaxHarmonic); // ebe container for sin(n*phi)
+
   // b) Common local labels (keep 'em in sync with BookCorrelationsHistograms())
   TString oVariable[4] = {"#varphi_{1}-#varphi_{2}", "#varphi_{1}+#varphi_{2}-#varphi_{3}-#varphi_{4}",
                           "#varphi_{1}+#varphi_{2}+#varphi_{3}-#varphi_{4}-#varphi_{5}-#varphi_{6}",
@@ -967,32 +971,50 @@ void CalculateNestedLoops()
     return;
   }
   cout << "      CalculateNestedLoops(void), 2-p correlations .... " << endl;
+
+  // cos(n*phi) and sin(n*phi) of each particle are calculated once, and cos[n(phi1-phi2)] = cos(n*phi1)cos(n*phi2) + sin(n*phi1)sin(n*phi2):
+  Double_t* dCos = nl_a.ftaNestedLoopsCosSin[0]->GetArray();
+  Double_t* dSin = nl_a.ftaNestedLoopsCosSin[1]->GetArray();
+  for (int i = 0; i < nParticles; i++) {
+    Double_t dPhi = nl_a.ftaNestedLoops[0]->GetAt(i);
+    for (int h = 0; h < gMaxHarmonic; h++) {
+      dCos[i * gMaxHarmonic + h] = TMath::Cos((h + 1.) * dPhi);
+      dSin[i * gMaxHarmonic + h] = TMath::Sin((h + 1.) * dPhi);
+    }
+  }
+
+  // Sums over the pairs of the weights and of the weighted correlations. The pairs (i1,i2) and (i2,i1) have the same
+  // weight and correlation, so only i2 > i1 is looped over, and each pair is counted twice:
+  Double_t dSumW = 0.;                   // sum of w
+  Double_t dSumW2 = 0.;                  // sum of w^2
+  Double_t dSumWY[gMaxHarmonic] = {0.};  // sum of w*cos[n(phi1-phi2)]
+  Double_t dSumWY2[gMaxHarmonic] = {0.}; // sum of w*cos^2[n(phi1-phi2)]
   for (int i1 = 0; i1 < nParticles; i1++) {
-    Double_t dPhi1 = nl_a.ftaNestedLoops[0]->GetAt(i1);
     Double_t dW1 = nl_a.ftaNestedLoops[1]->GetAt(i1);
-    for (int i2 = 0; i2 < nParticles; i2++) {
-      if (i2 == i1) {
-        continue;
+    const Double_t* dCos1 = dCos + i1 * gMaxHarmonic;
+    const Double_t* dSin1 = dSin + i1 * gMaxHarmonic;
+    for (int i2 = i1 + 1; i2 < nParticles; i2++) {
+      Double_t dW = dW1 * nl_a.ftaNestedLoops[1]->GetAt(i2);
+      const Double_t* dCos2 = dCos + i2 * gMaxHarmonic;
+      const Double_t* dSin2 = dSin + i2 * gMaxHarmonic;
+      dSumW += dW;
+      dSumW2 += dW * dW;
+      for (int h = 0; h < gMaxHarmonic; h++) {
+        Double_t dCorrelation = dCos1[h] * dCos2[h] + dSin1[h] * dSin2[h];
+        dSumWY[h] += dW * dCorrelation;
+        dSumWY2[h] += dW * dCorrelation * dCorrelation;
       }
-      Double_t dPhi2 = nl_a.ftaNestedLoops[0]->GetAt(i2);
-      Double_t dW2 = nl_a.ftaNestedLoops[1]->GetAt(i2);
-      for (int h = 0; h < 6; h++) // TBI 20220823 hardcoded "h<6"
-      {
-        // fill cos, 2p, integreated:
-        if (nl_a.fNestedLoopsPro[0][h][0]) {
-          nl_a.fNestedLoopsPro[0][h][0]->Fill(0.5, TMath::Cos((h + 1.) * (dPhi1 - dPhi2)), dW1 * dW2);
-        }
-        // fill cos, 2p, vs. M:
-        if (nl_a.fNestedLoopsPro[0][h][1]) {
-          nl_a.fNestedLoopsPro[0][h][1]->Fill(fSelectedTracks + 0.5, TMath::Cos((h + 1.) * (dPhi1 - dPhi2)), dW1 * dW2);
-        }
-        // fill cos, 2p, vs. centrality:
-        if (nl_a.fNestedLoopsPro[0][h][2]) {
-          nl_a.fNestedLoopsPro[0][h][2]->Fill(fCentrality, TMath::Cos((h + 1.) * (dPhi1 - dPhi2)), dW1 * dW2);
-        }
-      } // for(int h=1; h<=6; h++)
-    }   // for(int i2=0; i2<nParticles; i2++)
-  }     // for(int i1=0; i1<nParticles; i1++)
+    } // for(int i2=i1+1; i2<nParticles; i2++)
+  }   // for(int i1=0; i1<nParticles; i1++)
+
+  // Fill the profiles once per event, with the same result as one Fill(...) for each ordered pair:
+  Int_t nPairs = nParticles * (nParticles - 1);
+  Double_t dX[3] = {0.5, fSelectedTracks + 0.5, fCentrality}; // [0=integrated,1=vs. M,2=vs. centrality]
+  for (int h = 0; h < gMaxHarmonic; h++) {
+    for (int v = 0; v < 3; v++) {
+      FillProfileWithSums(nl_a.fNestedLoopsPro[0][h][v], dX[v], 2. * dSumW, 2. * dSumW2, 2. * dSumWY[h], 2. * dSumWY2[h], nPairs);
+    }
+  }
 
   // TBI port the rest, i.e. 4p, 6p, 8p, etc.
 
@@ -1000,6 +1022,41 @@ void CalculateNestedLoops()
 
 //============================================================
 
+void FillProfileWithSums(TProfile* pro, Double_t x, Double_t sumW, Double_t sumW2, Double_t sumWY, Double_t sumWY2, Int_t nEntries)
+{
+  // Fill profile with nEntries values y with weights w at the same x, from the sums of w, w^2, w*y and w*y^2.
+  // The result is the same as for nEntries calls of pro->Fill(x,y,w), up to the rounding of the sums.
+
+  if (!pro || 0 == nEntries) {
+    return;
+  }
+
+  Int_t bin = pro->GetXaxis()->FindBin(x);
+  pro->fArray[bin] += sumWY;
+  pro->GetSumw2()->fArray[bin] += sumWY2;
+  if (pro->GetBinSumw2()->fN) {
+    pro->GetBinSumw2()->fArray[bin] += sumW2;
+  }
+  pro->SetBinEntries(bin, pro->GetBinEntries(bin) + sumW);
+  pro->SetEntries(pro->GetEntries() + nEntries);
+
+  // global statistics, only for the bins in range (default behaviour of TProfile::Fill):
+  if ((bin > 0 && bin <= pro->GetNbinsX()) || pro->GetStatOverflowsBehaviour()) {
+    Double_t stats[TH1::kNstat] = {0.};
+    pro->GetStats(stats);
+    stats[0] += sumW;
+    stats[1] += sumW2;
+    stats[2] += sumW * x;
+    stats[3] += sumW * x * x;
+    stats[4] += sumWY;
+    stats[5] += sumWY2;
+    pro->PutStats(stats);
+  }
+
+} // void FillProfileWithSums(TProfile* pro, Double_t x, Double_t sumW, Double_t sumW2, Double_t sumWY, Double_t sumWY2, Int_t nEntries)
+
+//============================================================
+
 void ComparisonNestedLoopsVsCorrelations()
 {
   // Make a ratio fNestedLoopsPro[....]/fCorrelationsPro[....]. If results are the same, these ratios must be 1.
@@ -10,6 +10,7 @@
 // or submit itself to any jurisdiction.
 
 #include <cmath>
+#include <vector>
 
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
@@ -746,6 +747,9 @@ struct DptDptFilterTracks {
                                         float charge,
                                         MatchRecoGenSpecies sp);
 
+  /* acceptance flags of the collisions of the data frame, indexed by collision index */
+  std::vector<bool> collisionsaccepted;
+
   /* TODO: as it is now when the derived data is stored (fullDerivedData = true) */
   /* the collision index stored with the track is wrong. This has to be fixed    */
   template <typename passedtracks>
@@ -757,19 +761,21 @@ struct DptDptFilterTracks {
     if (!fullDerivedData) {
       tracksinfo.reserve(tracks.size());
     }
+    collisionsaccepted.assign(collisions.size(), false);
     for (auto collision : collisions) {
       if (collision.collisionaccepted()) {
+        collisionsaccepted[collision.globalIndex()] = true;
         ncollaccepted++;
       }
     }
     for (auto track : tracks) {
       int8_t pid = -1;
-      if (track.has_collision() && (track.template collision_as<soa::Join<aod::Collisions, aod::DptDptCFCollisionsInfo>>()).collisionaccepted()) {
+      if (track.has_collision() && collisionsaccepted[track.collisionId()]) {
         pid = selectTrack(track);
         if (!(pid < 0)) {
           naccepted++;
           if (fullDerivedData) {
-            scannedtracks((track.template collision_as<soa::Join<aod::Collisions, aod::DptDptCFCollisionsInfo>>()).globalIndex(), pid, track.pt(), track.eta(), track.phi());
+            scannedtracks(track.collisionId(), pid, track.pt(), track.eta(), track.phi());
           } else {
             tracksinfo(pid);
           }
@@ -807,8 +813,10 @@ struct DptDptFilterTracks {
       gentracksinfo.reserve(particles.size());
     }
 
+    collisionsaccepted.assign(gencollisions.size(), false);
     for (auto gencoll : gencollisions) {
       if (gencoll.collisionaccepted()) {
+        collisionsaccepted[gencoll.globalIndex()] = true;
         acceptedcollisions++;
       }
     }
@@ -823,8 +831,8 @@ struct DptDptFilterTracks {
       int8_t pid = -1;
 
       if (charge != 0) {
-        if (particle.has_mcCollision() && (particle.template mcCollision_as<soa::Join<aod::McCollisions, aod::DptDptCFGenCollisionsInfo>>()).collisionaccepted()) {
-          auto mccollision = particle.template mcCollision_as<soa::Join<aod::McCollisions, aod::DptDptCFGenCollisionsInfo>>();
+        if (particle.has_mcCollision() && collisionsaccepted[particle.mcCollisionId()]) {
+          auto mccollision = gencollisions.iteratorAt(particle.mcCollisionId());
           /* before particle selection */
           fillParticleHistosBeforeSelection(particle, mccollision, charge);
 
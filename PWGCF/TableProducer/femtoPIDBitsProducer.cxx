@@ -0,0 +1,79 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file femtoPIDBitsProducer.cxx
+/// \brief Packs the n_sigma selections of all the tracks once, in the table FemtoPIDBits joinable with the tracks
+///
+/// The femto producers of the same workflow join the table instead of evaluating the n_sigma of each species
+/// again. The species, thresholds and offsets have to be the ones of the PID selection of the producers.
+
+#include <vector>
+
+#include "Framework/runDataProcessing.h"
+#include "Framework/AnalysisTask.h"
+#include "Framework/AnalysisDataModel.h"
+#include "Common/DataModel/PIDResponse.h"
+#include "ReconstructionDataFormats/PID.h"
+#include "PWGCF/DataModel/FemtoDerived.h"
+#include "PWGCF/Core/PIDBits.h"
+
+using namespace o2;
+using namespace o2::framework;
+using namespace o2::analysis;
+
+using PIDTracks = soa::Join<aod::Tracks, aod::TracksExtra, aod::TOFSignal,
+                            aod::pidTPCEl, aod::pidTPCMu, aod::pidTPCPi, aod::pidTPCKa, aod::pidTPCPr, aod::pidTPCDe,
+                            aod::pidTOFEl, aod::pidTOFMu, aod::pidTOFPi, aod::pidTOFKa, aod::pidTOFPr, aod::pidTOFDe>;
+
+struct FemtoPIDBitsProducer {
+  Produces<aod::FemtoPIDBits> pidBits;
+
+  Configurable<std::vector<int>> ConfTrkPIDspecies{"ConfTrkPIDspecies", std::vector<int>{o2::track::PID::Pion, o2::track::PID::Kaon, o2::track::PID::Proton, o2::track::PID::Deuteron}, "Trk sel: Particles species for PID"};
+  Configurable<std::vector<float>> ConfTrkPIDnSigmaMax{"ConfTrkPIDnSigmaMax", std::vector<float>{3.5f, 3.f, 2.5f}, "Track selection: Maximal PID (nSigma)"};
+  Configurable<float> ConfTrkPIDnSigmaOffsetTPC{"ConfTrkPIDnSigmaOffsetTPC", 0., "Offset for TPC nSigma because of bad calibration"};
+  Configurable<float> ConfTrkPIDnSigmaOffsetTOF{"ConfTrkPIDnSigmaOffsetTOF", 0., "Offset for TOF nSigma because of bad calibration"};
+
+  std::vector<o2::track::PID> species;
+  std::vector<float> thresholds;
+  std::vector<float> nSigmaTPC;
+  std::vector<float> nSigmaTOF;
+
+  void init(InitContext const&)
+  {
+    std::vector<int> tmpSpecies = ConfTrkPIDspecies;
+    for (auto pid : tmpSpecies) {
+      species.push_back(pid);
+    }
+    thresholds = pidbits::sortThresholds(ConfTrkPIDnSigmaMax);
+    if (2 * species.size() * thresholds.size() >= sizeof(aod::femtodreamparticle::cutContainerType) * 8) {
+      LOGF(fatal, "Too many PID selections (%d species, %d thresholds) for the PID bits", species.size(), thresholds.size());
+    }
+    nSigmaTPC.resize(species.size());
+    nSigmaTOF.resize(species.size());
+  }
+
+  void process(PIDTracks const& tracks)
+  {
+    pidBits.reserve(tracks.size());
+    for (auto const& track : tracks) {
+      for (size_t i = 0; i < species.size(); ++i) {
+        nSigmaTPC[i] = o2::aod::pidutils::tpcNSigma(species[i], track);
+        nSigmaTOF[i] = track.hasTOF() ? o2::aod::pidutils::tofNSigma(species[i], track) : 999.f;
+      }
+      pidBits(pidbits::pack<aod::femtodreamparticle::cutContainerType>(nSigmaTPC.data(), nSigmaTOF.data(), species.size(), thresholds, ConfTrkPIDnSigmaOffsetTPC, ConfTrkPIDnSigmaOffsetTOF));
+    }
+  }
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{adaptAnalysisTask<FemtoPIDBitsProducer>(cfgc, TaskName{"femto-pid-bits"})};
+}
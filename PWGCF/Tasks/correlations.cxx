@@ -28,7 +28,9 @@
 #include "DataFormatsParameters/GRPMagField.h"
 
 #include <TH1F.h>
+#include <algorithm>
 #include <cmath>
+#include <vector>
 #include <TDirectory.h>
 #include <THn.h>
 
@@ -64,6 +66,7 @@ struct CorrelationTask {
   O2_DEFINE_CONFIGURABLE(cfgTriggerCharge, int, 0, "Select on charge of trigger particle: 0 = all; 1 = positive; -1 = negative");
   O2_DEFINE_CONFIGURABLE(cfgAssociatedCharge, int, 0, "Select on charge of associated particle: 0 = all; 1 = positive; -1 = negative");
   O2_DEFINE_CONFIGURABLE(cfgPairCharge, int, 0, "Select on charge of particle pair: 0 = all; 1 = like sign; -1 = unlike sign");
+  O2_DEFINE_CONFIGURABLE(cfgPairDeltaEtaMax, float, -1, "Only consider pairs with |Delta eta| below this value, scanning the associated particles sorted in eta (-1 = all pairs)");
 
   O2_DEFINE_CONFIGURABLE(cfgTwoTrackCut, float, -1, "Two track cut: -1 = off; >0 otherwise distance value (suggested: 0.02)");
   O2_DEFINE_CONFIGURABLE(cfgTwoTrackCutMinRadius, float, 0.8f, "Two track cut: radius in m from which two track cuts are applied");
@@ -229,72 +232,137 @@ struct CorrelationTask {
     return true;
   }
 
+  // Kinematics of a particle, read once per event for all the pairs it enters.
+  // Provides the accessors used by the pair cuts.
+  struct CachedTrack {
+    float mEta;
+    float mPhi;
+    float mPt;
+    int mSign;
+    int64_t mGlobalIndex;
+    bool mSelected;
+    float mEfficiency;
+    float eta() const { return mEta; }
+    float phi() const { return mPhi; }
+    float pt() const { return mPt; }
+    int sign() const { return mSign; }
+  };
+  std::vector<CachedTrack> associatedCache;
+  std::vector<float> associatedEtas; // eta of the cached associated particles, sorted when the pairs are restricted in Delta eta
+  // bendings of the particles for the two-track cut, computed once per particle and event
+  std::vector<double> associatedShiftValues;
+  std::vector<PairCuts::TwoTrackShifts> associatedShifts;
+  std::vector<double> triggerShiftValues;
+
+  template <CorrelationContainer::CFStep step, typename TTrack>
+  CachedTrack cacheTrack(TTrack& track)
+  {
+    return CachedTrack{track.eta(), track.phi(), track.pt(), track.sign(), track.globalIndex(), checkObject<step>(track), 1.0f};
+  }
+
   template <CorrelationContainer::CFStep step, typename TTarget, typename TTracks>
   void fillCorrelations(TTarget target, TTracks& tracks1, TTracks& tracks2, float multiplicity, float posZ, int magField, float eventWeight)
   {
-    // Cache efficiency for particles (too many FindBin lookups)
-    float* efficiencyAssociated = nullptr;
-    if constexpr (step == CorrelationContainer::kCFStepCorrected) {
-      if (cfg.mEfficiencyAssociated) {
-        efficiencyAssociated = new float[tracks2.size()];
-        int i = 0;
-        for (auto& track : tracks2) {
-          efficiencyAssociated[i++] = getEfficiencyCorrection(cfg.mEfficiencyAssociated, track.eta(), track.pt(), multiplicity, posZ);
+    // The associated particles are read once for all the trigger particles, including their efficiency (too many FindBin lookups otherwise)
+    associatedCache.clear();
+    associatedCache.reserve(tracks2.size());
+    for (auto& track : tracks2) {
+      auto& cached = associatedCache.emplace_back(cacheTrack<step>(track));
+      if constexpr (step == CorrelationContainer::kCFStepCorrected) {
+        if (cfg.mEfficiencyAssociated) {
+          cached.mEfficiency = getEfficiencyCorrection(cfg.mEfficiencyAssociated, cached.mEta, cached.mPt, multiplicity, posZ);
         }
       }
     }
+    // With a Delta eta window, only the slice of associated particles in the window is scanned for each trigger
+    const float deltaEtaMax = cfgPairDeltaEtaMax;
+    const bool useDeltaEtaWindow = deltaEtaMax > 0;
+    if (useDeltaEtaWindow) {
+      std::sort(associatedCache.begin(), associatedCache.end(), [](const CachedTrack& a, const CachedTrack& b) { return a.mEta < b.mEta; });
+      associatedEtas.resize(associatedCache.size());
+      for (size_t i = 0; i < associatedCache.size(); i++) {
+        associatedEtas[i] = associatedCache[i].mEta;
+      }
+    }
+    if constexpr (step >= CorrelationContainer::kCFStepReconstructed) {
+      if (cfgTwoTrackCut > 0) {
+        const int nRadii = mPairCuts.getNTwoTrackRadii();
+        associatedShiftValues.resize(associatedCache.size() * nRadii);
+        associatedShifts.resize(associatedCache.size());
+        for (size_t i = 0; i < associatedCache.size(); i++) {
+          associatedShifts[i] = {associatedShiftValues.data() + i * nRadii, 0};
+        }
+        triggerShiftValues.resize(nRadii);
+      }
+    }
 
     for (auto& track1 : tracks1) {
       // LOGF(info, "Track %f | %f | %f  %d %d", track1.eta(), track1.phi(), track1.pt(), track1.isGlobalTrack(), track1.isGlobalTrackSDD());
 
+      const auto trigger = cacheTrack<step>(track1);
       if constexpr (step <= CorrelationContainer::kCFStepTracked) {
-        if (!checkObject<step>(track1)) {
+        if (!trigger.mSelected) {
           continue;
         }
       }
 
-      if (cfgTriggerCharge != 0 && cfgTriggerCharge * track1.sign() < 0) {
+      if (cfgTriggerCharge != 0 && cfgTriggerCharge * trigger.mSign < 0) {
         continue;
       }
 
       float triggerWeight = eventWeight;
       if constexpr (step == CorrelationContainer::kCFStepCorrected) {
         if (cfg.mEfficiencyTrigger) {
-          triggerWeight *= getEfficiencyCorrection(cfg.mEfficiencyTrigger, track1.eta(), track1.pt(), multiplicity, posZ);
+          triggerWeight *= getEfficiencyCorrection(cfg.mEfficiencyTrigger, trigger.mEta, trigger.mPt, multiplicity, posZ);
         }
       }
 
-      target->getTriggerHist()->Fill(step, track1.pt(), multiplicity, posZ, triggerWeight);
+      target->getTriggerHist()->Fill(step, trigger.mPt, multiplicity, posZ, triggerWeight);
+      PairCuts::TwoTrackShifts triggerShifts{triggerShiftValues.data(), 0};
+
+      size_t firstAssociated = 0;
+      size_t lastAssociated = associatedCache.size();
+      if (useDeltaEtaWindow) {
+        // the window is slightly enlarged for the rounding, the exact condition is checked on the pairs
+        const float margin = 1e-4f;
+        firstAssociated = std::lower_bound(associatedEtas.begin(), associatedEtas.end(), trigger.mEta - deltaEtaMax - margin) - associatedEtas.begin();
+        lastAssociated = std::upper_bound(associatedEtas.begin() + firstAssociated, associatedEtas.end(), trigger.mEta + deltaEtaMax + margin) - associatedEtas.begin();
+      }
 
-      for (auto& track2 : tracks2) {
-        if (track1.globalIndex() == track2.globalIndex()) {
-          // LOGF(info, "Track identical: %f | %f | %f || %f | %f | %f", track1.eta(), track1.phi(), track1.pt(),  track2.eta(), track2.phi(), track2.pt());
+      for (size_t iAssociated = firstAssociated; iAssociated < lastAssociated; iAssociated++) {
+        const auto& track2 = associatedCache[iAssociated];
+        if (trigger.mGlobalIndex == track2.mGlobalIndex) {
+          continue;
+        }
+
+        const float deltaEta = trigger.mEta - track2.mEta;
+        if (useDeltaEtaWindow && std::fabs(deltaEta) >= deltaEtaMax) {
           continue;
         }
 
         if constexpr (step <= CorrelationContainer::kCFStepTracked) {
-          if (!checkObject<step>(track2)) {
+          if (!track2.mSelected) {
             continue;
           }
         }
 
-        if (cfgPtOrder != 0 && track2.pt() >= track1.pt()) {
+        if (cfgPtOrder != 0 && track2.mPt >= trigger.mPt) {
           continue;
         }
 
-        if (cfgAssociatedCharge != 0 && cfgAssociatedCharge * track2.sign() < 0) {
+        if (cfgAssociatedCharge != 0 && cfgAssociatedCharge * track2.mSign < 0) {
           continue;
         }
-        if (cfgPairCharge != 0 && cfgPairCharge * track1.sign() * track2.sign() < 0) {
+        if (cfgPairCharge != 0 && cfgPairCharge * trigger.mSign * track2.mSign < 0) {
           continue;
         }
 
         if constexpr (step >= CorrelationContainer::kCFStepReconstructed) {
-          if (cfg.mPairCuts && mPairCuts.conversionCuts(track1, track2)) {
+          if (cfg.mPairCuts && mPairCuts.conversionCuts(trigger, track2)) {
             continue;
           }
 
-          if (cfgTwoTrackCut > 0 && mPairCuts.twoTrackCut(track1, track2, magField)) {
+          if (cfgTwoTrackCut > 0 && mPairCuts.twoTrackCut(trigger, track2, magField, triggerShifts, associatedShifts[iAssociated])) {
             continue;
           }
         }
@@ -302,11 +370,11 @@ struct CorrelationTask {
         float associatedWeight = triggerWeight;
         if constexpr (step == CorrelationContainer::kCFStepCorrected) {
           if (cfg.mEfficiencyAssociated) {
-            associatedWeight *= efficiencyAssociated[track2.filteredIndex()];
+            associatedWeight *= track2.mEfficiency;
           }
         }
 
-        float deltaPhi = track1.phi() - track2.phi();
+        float deltaPhi = trigger.mPhi - track2.mPhi;
         if (deltaPhi > 1.5f * PI) {
           deltaPhi -= TwoPI;
         }
@@ -315,11 +383,9 @@ struct CorrelationTask {
         }
 
         target->getPairHist()->Fill(step,
-                                    track1.eta() - track2.eta(), track2.pt(), track1.pt(), multiplicity, deltaPhi, posZ, associatedWeight);
+                                    deltaEta, track2.mPt, trigger.mPt, multiplicity, deltaPhi, posZ, associatedWeight);
       }
     }
-
-    delete[] efficiencyAssociated;
   }
 
   void loadEfficiency(uint64_t timestamp)
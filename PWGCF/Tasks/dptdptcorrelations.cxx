@@ -34,6 +34,7 @@
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
 #include "PWGCF/Core/AnalysisConfigurableCuts.h"
+#include "PWGCF/Core/EngineQueues.h"
 #include "PWGCF/Core/PairCuts.h"
 #include "PWGCF/DataModel/DptDptFiltered.h"
 #include "PWGCF/TableProducer/dptdptfilter.h"
@@ -63,6 +64,7 @@ float deltaphiup = constants::math::TwoPI - deltaphibinwidth / 2.0;
 bool processpairs = false;
 bool processmixedevents = false;
 bool ptorder = false;
+bool flatpairsums = false;
 
 PairCuts fPairCuts;              // pair suppression engine
 bool fUseConversionCuts = false; // suppress resonances and conversions
@@ -118,6 +120,16 @@ struct DptDptCorrelationsTask {
       nTrackPairs ///< the number of track pairs
     } trackpairs;
 
+    /* per collision accumulators of the differential pair sums, for each track pair combination the delta eta delta phi cells
+       with delta eta as the fastest running index */
+    std::vector<float> fN2Flat;         //!<! weighted number of pairs, flat vs \f$\Delta\eta,\;\Delta\phi\f$ for the different species combinations
+    std::vector<float> fSum2PtPtFlat;   //!<! weighted \f$\sum {p_T}_1 {p_T}_2\f$, flat vs \f$\Delta\eta,\;\Delta\phi\f$ for the different species combinations
+    std::vector<float> fSum2DptDptFlat; //!<! weighted \f$\sum ({p_T}_1- <{p_T}_1>) ({p_T}_2 - <{p_T}_2>) \f$, flat vs \f$\Delta\eta,\;\Delta\phi\f$ for the different species combinations
+    std::vector<float> fSupN1N1Flat;    //!<! weighted number of suppressed pairs, flat vs \f$\Delta\eta,\;\Delta\phi\f$ for the different species combinations
+    std::vector<float> fSupPt1Pt1Flat;  //!<! weighted suppressed \f${p_T}_1 {p_T}_2\f$, flat vs \f$\Delta\eta,\;\Delta\phi\f$ for the different species combinations
+    /* eta and phi zero based bin indexes of the tracks of the current collision */
+    std::vector<int> fEtaIx1, fPhiIx1, fEtaIx2, fPhiIx2;
+
     std::vector<std::string> tname = {"1", "2"}; ///< the external track names, one and two, for histogram creation
     std::vector<std::vector<std::string>> trackPairsNames = {{"OO", "OT"}, {"TO", "TT"}};
     bool ccdbstored = false;
@@ -191,13 +203,72 @@ struct DptDptCorrelationsTask {
       phi = GetShiftedPhi(t2.phi());
       int phiix_2 = static_cast<int>((phi - philow) / phibinwidth);
 
-      int deltaeta_ix = etaix_1 - etaix_2 + etabins - 1;
+      return fhN2_vsDEtaDPhi[0][0]->GetBin(GetDEtaIndex(etaix_1, etaix_2) + 1, GetDPhiIndex(phiix_1, phiix_2) + 1);
+    }
+
+    /// \brief Returns the zero based delta eta bin index of a pair from the zero based eta bin indexes of its tracks
+    int GetDEtaIndex(int etaix_1, int etaix_2)
+    {
+      using namespace o2::analysis::dptdptfilter;
+      return etaix_1 - etaix_2 + etabins - 1;
+    }
+
+    /// \brief Returns the zero based delta phi bin index of a pair from the zero based phi bin indexes of its tracks
+    int GetDPhiIndex(int phiix_1, int phiix_2)
+    {
+      using namespace o2::analysis::dptdptfilter;
       int deltaphi_ix = phiix_1 - phiix_2;
       if (deltaphi_ix < 0) {
         deltaphi_ix += phibins;
       }
+      return deltaphi_ix;
+    }
+
+    /// \brief stores the zero based eta and phi bin indexes of the passed tracks
+    /// The same assumptions as for GetEtaPhiIndex apply
+    template <typename TrackListObject>
+    void storeEtaPhiIndexes(TrackListObject const& tracks, std::vector<int>& etaixs, std::vector<int>& phiixs)
+    {
+      using namespace correlationstask;
+      using namespace o2::analysis::dptdptfilter;
 
-      return fhN2_vsDEtaDPhi[0][0]->GetBin(deltaeta_ix + 1, deltaphi_ix + 1);
+      etaixs.resize(tracks.size());
+      phiixs.resize(tracks.size());
+      int index = 0;
+      for (auto& track : tracks) {
+        etaixs[index] = static_cast<int>((track.eta() - etalow) / etabinwidth);
+        /* consider a potential phi origin shift */
+        phiixs[index] = static_cast<int>((GetShiftedPhi(track.phi()) - philow) / phibinwidth);
+        index++;
+      }
+    }
+
+    /// \brief adds the pair sums of the current collision, accumulated in the flat arrays, to the differential histograms
+    /// The flat arrays are left empty for the next collision
+    void flushPairSums()
+    {
+      using namespace correlationstask;
+
+      const int ncells = deltaetabins * deltaphibins;
+      auto flush = [&](std::vector<float>& sums, TH2F* h, uint offset) {
+        for (int cell = 0; cell < ncells; ++cell) {
+          float& sum = sums[offset + cell];
+          if (sum != 0) {
+            h->AddBinContent(h->GetBin(cell % deltaetabins + 1, cell / deltaetabins + 1), sum);
+            sum = 0;
+          }
+        }
+      };
+      for (uint pid1 = 0; pid1 < nch; ++pid1) {
+        for (uint pid2 = 0; pid2 < nch; ++pid2) {
+          uint offset = (pid1 * nch + pid2) * ncells;
+          flush(fN2Flat, fhN2_vsDEtaDPhi[pid1][pid2], offset);
+          flush(fSum2PtPtFlat, fhSum2PtPt_vsDEtaDPhi[pid1][pid2], offset);
+          flush(fSum2DptDptFlat, fhSum2DptDpt_vsDEtaDPhi[pid1][pid2], offset);
+          flush(fSupN1N1Flat, fhSupN1N1_vsDEtaDPhi[pid1][pid2], offset);
+          flush(fSupPt1Pt1Flat, fhSupPt1Pt1_vsDEtaDPhi[pid1][pid2], offset);
+        }
+      }
     }
 
     void storeTrackCorrections(std::vector<TH3*> corrs)
@@ -316,8 +387,13 @@ struct DptDptCorrelationsTask {
       std::vector<std::vector<double>> n2nw(nch, std::vector<double>(nch, 0.0));         ///< not weighted number of track1 track 2 pairs for current collision
       std::vector<std::vector<double>> sum2PtPtnw(nch, std::vector<double>(nch, 0.0));   ///< accumulated sum of not weighted track 1 track 2 \f${p_T}_1 {p_T}_2\f$ for current collision
       std::vector<std::vector<double>> sum2DptDptnw(nch, std::vector<double>(nch, 0.0)); ///< accumulated sum of not weighted number of track 1 tracks times not weighted track 2 \f$p_T\f$ for current collision
-      int index1 = 0;
 
+      /* the eta and phi bin indexes are obtained once per track */
+      storeEtaPhiIndexes(trks1, fEtaIx1, fPhiIx1);
+      storeEtaPhiIndexes(trks2, fEtaIx2, fPhiIx2);
+      const int ncells = deltaetabins * deltaphibins;
+
+      int index1 = 0;
       for (auto& track1 : trks1) {
         double ptavg_1 = (*ptavgs1)[index1];
         double corr1 = (*corrs1)[index1];
@@ -326,11 +402,13 @@ struct DptDptCorrelationsTask {
           /* checking the same track id condition */
           if (track1 == track2) {
             /* exclude autocorrelations */
+            index2++;
             continue;
           }
 
           if constexpr (doptorder) {
             if (track2.pt() >= track1.pt()) {
+              index2++;
               continue;
             }
           }
@@ -341,8 +419,16 @@ struct DptDptCorrelationsTask {
           double dptdptnw = (track1.pt() - ptavg_1) * (track2.pt() - ptavg_2);
           double dptdptw = (corr1 * track1.pt() - ptavg_1) * (corr2 * track2.pt() - ptavg_2);
 
-          /* get the global bin for filling the differential histograms */
-          int globalbin = GetDEtaDPhiGlobalIndex(track1, track2);
+          /* get the global bin for filling the differential histograms, or the cell of the flat arrays */
+          int deltaeta_ix = GetDEtaIndex(fEtaIx1[index1], fEtaIx2[index2]);
+          int deltaphi_ix = GetDPhiIndex(fPhiIx1[index1], fPhiIx2[index2]);
+          int globalbin = 0;
+          uint cell = 0;
+          if (flatpairsums) {
+            cell = (track1.trackacceptedid() * nch + track2.trackacceptedid()) * ncells + deltaphi_ix * deltaetabins + deltaeta_ix;
+          } else {
+            globalbin = fhN2_vsDEtaDPhi[0][0]->GetBin(deltaeta_ix + 1, deltaphi_ix + 1);
+          }
           float deltaeta = track1.eta() - track2.eta();
           float deltaphi = track1.phi() - track2.phi();
           while (deltaphi >= deltaphiup) {
@@ -353,8 +439,13 @@ struct DptDptCorrelationsTask {
           }
           if ((fUseConversionCuts && fPairCuts.conversionCuts(track1, track2)) || (fUseTwoTrackCut && fPairCuts.twoTrackCut(track1, track2, bfield))) {
             /* suppress the pair */
-            fhSupN1N1_vsDEtaDPhi[track1.trackacceptedid()][track2.trackacceptedid()]->AddBinContent(globalbin, corr);
-            fhSupPt1Pt1_vsDEtaDPhi[track1.trackacceptedid()][track2.trackacceptedid()]->AddBinContent(globalbin, track1.pt() * track2.pt() * corr);
+            if (flatpairsums) {
+              fSupN1N1Flat[cell] += corr;
+              fSupPt1Pt1Flat[cell] += track1.pt() * track2.pt() * corr;
+            } else {
+              fhSupN1N1_vsDEtaDPhi[track1.trackacceptedid()][track2.trackacceptedid()]->AddBinContent(globalbin, corr);
+              fhSupPt1Pt1_vsDEtaDPhi[track1.trackacceptedid()][track2.trackacceptedid()]->AddBinContent(globalbin, track1.pt() * track2.pt() * corr);
+            }
             n2sup[track1.trackacceptedid()][track2.trackacceptedid()] += corr;
           } else {
             /* count the pair */
@@ -365,13 +456,24 @@ struct DptDptCorrelationsTask {
             sum2PtPtnw[track1.trackacceptedid()][track2.trackacceptedid()] += track1.pt() * track2.pt();
             sum2DptDptnw[track1.trackacceptedid()][track2.trackacceptedid()] += dptdptnw;
 
-            fhN2_vsDEtaDPhi[track1.trackacceptedid()][track2.trackacceptedid()]->AddBinContent(globalbin, corr);
+            if (flatpairsums) {
+              fN2Flat[cell] += corr;
+              fSum2DptDptFlat[cell] += dptdptw;
+              fSum2PtPtFlat[cell] += track1.pt() * track2.pt() * corr;
+            } else {
+              fhN2_vsDEtaDPhi[track1.trackacceptedid()][track2.trackacceptedid()]->AddBinContent(globalbin, corr);
+              fhSum2DptDpt_vsDEtaDPhi[track1.trackacceptedid()][track2.trackacceptedid()]->AddBinContent(globalbin, dptdptw);
+              fhSum2PtPt_vsDEtaDPhi[track1.trackacceptedid()][track2.trackacceptedid()]->AddBinContent(globalbin, track1.pt() * track2.pt() * corr);
+            }
             fhN2cont_vsDEtaDPhi[track1.trackacceptedid()][track2.trackacceptedid()]->Fill(deltaeta, deltaphi, corr);
-            fhSum2DptDpt_vsDEtaDPhi[track1.trackacceptedid()][track2.trackacceptedid()]->AddBinContent(globalbin, dptdptw);
-            fhSum2PtPt_vsDEtaDPhi[track1.trackacceptedid()][track2.trackacceptedid()]->AddBinContent(globalbin, track1.pt() * track2.pt() * corr);
           }
           fhN2_vsPtPt[track1.trackacceptedid()][track2.trackacceptedid()]->Fill(track1.pt(), track2.pt(), corr);
+          index2++;
         }
+        index1++;
+      }
+      if (flatpairsums) {
+        flushPairSums();
       }
       for (uint pid1 = 0; pid1 < nch; ++pid1) {
         for (uint pid2 = 0; pid2 < nch; ++pid2) {
@@ -611,6 +713,14 @@ struct DptDptCorrelationsTask {
             fOutputList->Add(fhSum2DptDptnw_vsC[i][j]);
           }
         }
+        if (flatpairsums) {
+          size_t nflat = nch * nch * deltaetabins * deltaphibins;
+          fN2Flat.assign(nflat, 0.0f);
+          fSum2PtPtFlat.assign(nflat, 0.0f);
+          fSum2DptDptFlat.assign(nflat, 0.0f);
+          fSupN1N1Flat.assign(nflat, 0.0f);
+          fSupPt1Pt1Flat.assign(nflat, 0.0f);
+        }
       }
       TH1::AddDirectory(oldstatus);
     }
@@ -647,6 +757,8 @@ struct DptDptCorrelationsTask {
                                                            {28, -7.0, 7.0, 18, 0.2, 2.0, 16, -0.8, 0.8, 72, 0.5},
                                                            "triplets - nbins, min, max - for z_vtx, pT, eta and phi, binning plus bin fraction of phi origin shift"};
   Configurable<bool> cfgPtOrder{"ptorder", false, "enforce pT_1 < pT_2. Defalut: false"};
+  Configurable<int> cfgNThreads{"nthreads", 4, "Maximum number of threads, one per centrality/multiplicity range, for the parallel processing of the collisions"};
+  Configurable<bool> cfgFlatPairSums{"flatpairsums", false, "Accumulate the differential pair sums of each collision in flat arrays added to the histograms at the end of the collision. Default: false"};
   struct : ConfigurableGroup {
     Configurable<std::string> cfgCCDBUrl{"input_ccdburl", "http://ccdb-test.cern.ch:8080", "The CCDB url for the input file"};
     Configurable<std::string> cfgCCDBPathName{"input_ccdbpath", "", "The CCDB path for the input file. Default \"\", i.e. don't load from CCDB"};
@@ -677,6 +789,7 @@ struct DptDptCorrelationsTask {
     processpairs = cfgProcessPairs.value;
     processmixedevents = cfgProcessME.value;
     ptorder = cfgPtOrder.value;
+    flatpairsums = cfgFlatPairSums.value;
     loadfromccdb = cfginputfile.cfgCCDBPathName->length() > 0;
     /* update the potential binning change */
     etabinwidth = (etaup - etalow) / static_cast<float>(etabins);
@@ -827,8 +940,10 @@ struct DptDptCorrelationsTask {
     return grpo->getNominalL3Field();
   }
 
-  template <bool gen, typename FilterdCollision, typename FilteredTracks>
-  void processSame(FilterdCollision const& collision, FilteredTracks const& tracks, uint64_t timestamp = 0)
+  /// \brief Locates the same event data collecting engine of the passed collision and provides it with the CCDB input
+  /// \return the data collecting engine index, negative if the collision is not in any centrality/multiplicity range
+  template <bool gen, typename FilterdCollision>
+  int prepareSameDCE(FilterdCollision const& collision)
   {
     using namespace correlationstask;
 
@@ -879,7 +994,17 @@ struct DptDptCorrelationsTask {
                                   .Data()))});
         }
       }
+    }
+    return ixDCE;
+  }
 
+  template <bool gen, typename FilterdCollision, typename FilteredTracks>
+  void processSame(FilterdCollision const& collision, FilteredTracks const& tracks, uint64_t timestamp = 0)
+  {
+    using namespace correlationstask;
+
+    int ixDCE = prepareSameDCE<gen>(collision);
+    if (!(ixDCE < 0)) {
       std::string generated = "";
       if constexpr (gen) {
         generated = "generated ";
@@ -984,6 +1109,41 @@ struct DptDptCorrelationsTask {
   }
   PROCESS_SWITCH(DptDptCorrelationsTask, processRecLevel, "Process reco level correlations", false);
 
+  /// \brief a collision queued for its data collecting engine
+  template <typename TracksSlice>
+  struct QueuedCollision {
+    TracksSlice tracks;
+    float zvtx;
+    float centmult;
+    int bfield;
+  };
+
+  Preslice<aod::ScannedTracks> perScannedCollision = aod::dptdptfilter::dptDptCFAcceptedCollisionId;
+
+  /// \brief same as processRecLevel, with the collisions of the different centrality/multiplicity ranges processed on different threads
+  /// The collisions are queued, in order, to their data collecting engines on this thread, which also handles the CCDB access,
+  /// and each engine is then fed by a single thread, so that its histograms are not shared among threads
+  void processRecLevelParallel(soa::Filtered<aod::DptDptCFAcceptedCollisions> const& collisions, aod::BCsWithTimestamps const&, soa::Filtered<aod::ScannedTracks> const& tracks)
+  {
+    using namespace correlationstask;
+    using TracksSlice = decltype(tracks.sliceBy(perScannedCollision, 0));
+
+    o2::analysis::EngineQueues<QueuedCollision<TracksSlice>> queues;
+    queues.init(ncmranges);
+    for (auto const& collision : collisions) {
+      int ixDCE = prepareSameDCE<false>(collision);
+      if (ixDCE < 0) {
+        continue;
+      }
+      int bfield = (fUseConversionCuts || fUseTwoTrackCut) ? getMagneticField(collision.bc_as<aod::BCsWithTimestamps>().timestamp()) : 0;
+      queues.push(ixDCE, {tracks.sliceBy(perScannedCollision, collision.globalIndex()), collision.posZ(), collision.centmult(), bfield});
+    }
+    queues.drain(cfgNThreads, [this](int ixDCE, auto const& queued) {
+      dataCE[ixDCE]->processCollision<false>(queued.tracks, queued.tracks, queued.zvtx, queued.centmult, queued.bfield);
+    });
+  }
+  PROCESS_SWITCH(DptDptCorrelationsTask, processRecLevelParallel, "Process reco level correlations with one thread per centrality/multiplicity range", false);
+
   void processRecLevelCheck(aod::Collisions const& collisions, aod::Tracks& tracks)
   {
     int nAssignedTracks = 0;
@@ -44,6 +44,7 @@ struct GenericFramework {
   O2_DEFINE_CONFIGURABLE(cfgNbootstrap, int, 10, "Number of subsamples")
   O2_DEFINE_CONFIGURABLE(cfgEfficiency, std::string, "", "CCDB path to efficiency object")
   O2_DEFINE_CONFIGURABLE(cfgAcceptance, std::string, "", "CCDB path to acceptance object")
+  O2_DEFINE_CONFIGURABLE(cfgSinglePrecisionQ, bool, false, "Store the Q-vectors of the GFW in single precision")
 
   ConfigurableAxis axisVertex{"axisVertex", {20, -10, 10}, "vertex axis for histograms"};
   ConfigurableAxis axisPhi{"axisPhi", {60, 0.0, constants::math::TwoPI}, "phi axis for histograms"};
@@ -72,6 +73,13 @@ struct GenericFramework {
   // define global variables
   GFW* fGFW = new GFW();
   std::vector<GFW::CorrConfig> corrconfigs;
+  std::vector<std::vector<int>> corrBins; // y-bins of the correlators in the FlowContainer, per configuration and pT bin
+  std::vector<int> fcBins;                // correlators of the current event
+  std::vector<double> fcValues;
+  std::vector<double> fcWeights;
+  std::vector<double> trackPhis; // tracks of the current event, for the NUA lookup
+  std::vector<double> trackEtas;
+  std::vector<double> trackNUA;
   TRandom3* fRndm = new TRandom3(0);
   TAxis* fPtAxis;
 
@@ -118,7 +126,17 @@ struct GenericFramework {
     fGFW->AddRegion("refP", 0.4, 0.8, 1, 1);
     fGFW->AddRegion("full", -0.8, 0.8, 1, 2);
     CreateCorrConfigs();
+    fGFW->SetSinglePrecision(cfgSinglePrecisionQ);
     fGFW->CreateRegions();
+    for (const auto& corrconf : corrconfigs) {
+      corrBins.push_back({});
+      if (!corrconf.pTDif) {
+        corrBins.back().push_back(fFC->GetProfileBin(corrconf.Head.c_str()));
+        continue;
+      }
+      for (Int_t i = 1; i <= fPtAxis->GetNbins(); i++)
+        corrBins.back().push_back(fFC->GetProfileBin(Form("%s_pt_%i", corrconf.Head.c_str(), i)));
+    }
   }
 
   void CreateCorrConfigs()
@@ -133,7 +151,7 @@ struct GenericFramework {
     corrconfigs.push_back(fGFW->GetCorrelatorConfig("refP {2 3} refN {-2 -3}", "ChSC234", kFALSE));
   }
 
-  void FillFC(const GFW::CorrConfig& corrconf, const double& cent, const double& rndm)
+  void FillFC(const GFW::CorrConfig& corrconf, const std::vector<int>& bins)
   {
     double dnx, val;
     dnx = fGFW->Calculate(corrconf, 0, kTRUE).real();
@@ -142,7 +160,7 @@ struct GenericFramework {
     if (!corrconf.pTDif) {
       val = fGFW->Calculate(corrconf, 0, kFALSE).real() / dnx;
       if (TMath::Abs(val) < 1)
-        fFC->FillProfile(corrconf.Head.c_str(), cent, val, dnx, rndm);
+        addToFC(bins.at(0), val, dnx);
       return;
     }
     for (Int_t i = 1; i <= fPtAxis->GetNbins(); i++) {
@@ -151,11 +169,20 @@ struct GenericFramework {
         continue;
       val = fGFW->Calculate(corrconf, i - 1, kFALSE).real() / dnx;
       if (TMath::Abs(val) < 1)
-        fFC->FillProfile(Form("%s_pt_%i", corrconf.Head.c_str(), i), cent, val, dnx, rndm);
+        addToFC(bins.at(i - 1), val, dnx);
     }
     return;
   }
 
+  void addToFC(int bin, double val, double dnx)
+  {
+    if (bin < 0)
+      return;
+    fcBins.push_back(bin);
+    fcValues.push_back(val);
+    fcWeights.push_back(dnx);
+  }
+
   void process(soa::Filtered<soa::Join<aod::Collisions, aod::EvSels, aod::CentRun2V0Ms>>::iterator const& collision, aod::BCsWithTimestamps const&, myTracks const& tracks)
   {
 
@@ -183,7 +210,18 @@ struct GenericFramework {
     float l_Random = fRndm->Rndm();
     float weff = 1, wacc = 1;
 
+    if (cfg.mAcceptance) {
+      trackPhis.clear();
+      trackEtas.clear();
+      for (auto& track : tracks) {
+        trackPhis.push_back(track.phi());
+        trackEtas.push_back(track.eta());
+      }
+      cfg.mAcceptance->GetNUA(trackPhis, trackEtas, vtxz, trackNUA);
+    }
+    int iTrack = -1;
     for (auto& track : tracks) {
+      iTrack++;
       registry.fill(HIST("hPhi"), track.phi());
       registry.fill(HIST("hEta"), track.eta());
 
@@ -195,15 +233,19 @@ struct GenericFramework {
         continue;
       weff = 1. / weff;
       if (cfg.mAcceptance)
-        wacc = cfg.mAcceptance->GetNUA(track.phi(), track.eta(), vtxz);
+        wacc = trackNUA[iTrack];
       else
         wacc = 1;
 
       fGFW->Fill(track.eta(), 1, track.phi(), wacc * weff, 3);
     }
+    fcBins.clear();
+    fcValues.clear();
+    fcWeights.clear();
     for (uint l_ind = 0; l_ind < corrconfigs.size(); l_ind++) {
-      FillFC(corrconfigs.at(l_ind), centrality, l_Random);
+      FillFC(corrconfigs.at(l_ind), corrBins.at(l_ind));
     }
+    fFC->FillProfiles(centrality, fcBins, fcValues, fcWeights, l_Random);
   }
 };
 
@@ -83,6 +83,11 @@ class FilterAndAnalysisFramework : public TNamed
   {
     return fTrackFilter->Filter(track);
   }
+  template <typename TracksToFilter>
+  void FilterTracks(TracksToFilter const& tracks, std::vector<uint64_t>& masks)
+  {
+    fTrackFilter->Filter(tracks, masks);
+  }
   template <typename TrackToFilter>
   uint64_t FilterTrackPID(TrackToFilter const& track)
   {
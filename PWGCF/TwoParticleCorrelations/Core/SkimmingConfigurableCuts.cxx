@@ -1035,6 +1035,18 @@ int CutWithVariations<TValueToFilter>::getArmedIndex()
   return index;
 }
 
+/// Appends the default bricks and then the variation bricks to the flat evaluator
+template <typename TValueToFilter>
+void CutWithVariations<TValueToFilter>::Compile(CompiledCutBricks<TValueToFilter>& compiled) const
+{
+  for (int i = 0; i < mDefaultBricks.GetEntries(); ++i) {
+    ((CutBrick<TValueToFilter>*)mDefaultBricks.At(i))->Compile(compiled);
+  }
+  for (int i = 0; i < mVariationBricks.GetEntries(); ++i) {
+    ((CutBrick<TValueToFilter>*)mVariationBricks.At(i))->Compile(compiled);
+  }
+}
+
 templateClassImp(o2::analysis::CutWithVariations);
 template class o2::analysis::PWGCF::CutWithVariations<float>;
 template class o2::analysis::PWGCF::CutWithVariations<int>;
@@ -32,6 +32,9 @@ namespace analysis
 {
 namespace PWGCF
 {
+template <typename TValueToFilter>
+class CompiledCutBricks;
+
 /// \class CutBrick
 /// \brief Virtual class which implements the base component of the selection cuts
 ///
@@ -64,6 +67,9 @@ class CutBrick : public TNamed
   /// Virtual function. Return the index of the armed brick within this brick
   /// \returns The index of the armed brick within this brick. Default -1
   virtual int getArmedIndex() { return -1; }
+  /// Pure virtual function. Appends the brick, or its components, to the flat evaluator
+  /// The components are appended in the order of the results of Filter
+  virtual void Compile(CompiledCutBricks<TValueToFilter>&) const = 0;
 
   static CutBrick<TValueToFilter>* constructBrick(const char* name, const char* regex, const std::set<std::string>& allowed);
   static const char* mgImplementedbricks[];
@@ -97,6 +103,169 @@ class CutBrick : public TNamed
   ClassDef(CutBrick, 1);
 };
 
+/// \class CompiledCutBricks
+/// \brief Flat evaluator of a cut brick tree
+/// The bricks are compiled once, after parsing, into a plain list of conditions, which
+/// is then evaluated without virtual calls nor temporary vectors. Each condition codes
+/// one bit of the selection mask, except the multiple ranges which code one bit per range.
+/// The state of the bricks is not updated by the evaluator.
+template <typename TValueToFilter>
+class CompiledCutBricks
+{
+ public:
+  enum class Condition {
+    kLimit,         ///< value < up
+    kThreshold,     ///< low < value
+    kRange,         ///< low < value < up
+    kExtToRange,    ///< value < low or up < value
+    kMultipleRanges ///< one bit for the range, within edges, which contains the value
+  };
+
+  /// Compiles the passed brick, replacing the previous content
+  void Compile(const CutBrick<TValueToFilter>* brick)
+  {
+    mConditions.clear();
+    mEdges.clear();
+    mLength = 0;
+    Append(brick);
+  }
+
+  /// Compiles the passed brick after the current content
+  void Append(const CutBrick<TValueToFilter>* brick)
+  {
+    if (brick != nullptr) {
+      brick->Compile(*this);
+    }
+  }
+
+  /// Appends a condition. If given, the functions provide the condition limits for the independent variable
+  void Add(Condition condition, TValueToFilter low, TValueToFilter up, const TF1* lowFn = nullptr, const TF1* upFn = nullptr)
+  {
+    mConditions.push_back({condition, low, up, lowFn, upFn, 0, 0});
+    mLength++;
+  }
+
+  /// Appends a multiple ranges selector with the passed ranges edges
+  void Add(const std::vector<TValueToFilter>& edges)
+  {
+    mConditions.push_back({Condition::kMultipleRanges, edges.front(), edges.back(), nullptr, nullptr, static_cast<int>(mEdges.size()), static_cast<int>(edges.size())});
+    mEdges.insert(mEdges.end(), edges.begin(), edges.end());
+    mLength += edges.size() - 1;
+  }
+
+  /// The number of mask bits coded
+  int Length() const { return mLength; }
+  bool IsEmpty() const { return mConditions.empty(); }
+
+  /// Sets the limits of the function based conditions according to the passed variable value
+  void setIndependentFnVar(float x)
+  {
+    for (auto& c : mConditions) {
+      if (c.mLowFn != nullptr) {
+        c.mLow = TValueToFilter(c.mLowFn->Eval(x));
+      }
+      if (c.mUpFn != nullptr) {
+        c.mUp = TValueToFilter(c.mUpFn->Eval(x));
+      }
+    }
+  }
+
+  /// Sets the mask bits, from the passed bit on, of the conditions the value passes
+  /// \return true if the value passed any of the conditions
+  bool Filter(const TValueToFilter& value, uint64_t& mask, int& bit) const
+  {
+    uint64_t passed = 0UL;
+    int b = 0;
+    for (const auto& c : mConditions) {
+      if (c.mCondition == Condition::kMultipleRanges) {
+        filterRanges(c, mEdges, value, passed, b);
+      } else {
+        if (passes(c, value)) {
+          SETBIT(passed, b);
+        }
+        b++;
+      }
+    }
+    mask |= passed << bit;
+    bit += mLength;
+    return passed != 0UL;
+  }
+
+  /// \return true if the value passes any of the conditions
+  bool Passes(const TValueToFilter& value) const
+  {
+    uint64_t mask = 0UL;
+    int bit = 0;
+    return Filter(value, mask, bit);
+  }
+
+  /// Sets the mask bits of the whole span of values, from the passed bit on, one condition at a time
+  void Filter(const TValueToFilter* values, std::size_t nValues, uint64_t* masks, int bit) const
+  {
+    for (const auto& c : mConditions) {
+      if (c.mCondition == Condition::kMultipleRanges) {
+        for (std::size_t i = 0; i < nValues; ++i) {
+          int b = 0;
+          uint64_t ranges = 0UL;
+          filterRanges(c, mEdges, values[i], ranges, b);
+          masks[i] |= ranges << bit;
+        }
+        bit += c.mNEdges - 1;
+      } else {
+        const uint64_t setbit = 1UL << bit;
+        for (std::size_t i = 0; i < nValues; ++i) {
+          masks[i] |= passes(c, values[i]) ? setbit : 0UL;
+        }
+        bit++;
+      }
+    }
+  }
+
+ private:
+  struct CompiledCondition {
+    Condition mCondition;
+    TValueToFilter mLow;
+    TValueToFilter mUp;
+    const TF1* mLowFn;
+    const TF1* mUpFn;
+    int mFirstEdge;
+    int mNEdges;
+  };
+
+  static bool passes(const CompiledCondition& c, const TValueToFilter& value)
+  {
+    switch (c.mCondition) {
+      case Condition::kLimit:
+        return value < c.mUp;
+      case Condition::kThreshold:
+        return c.mLow < value;
+      case Condition::kRange:
+        return (c.mLow < value) and (value < c.mUp);
+      case Condition::kExtToRange:
+        return (value < c.mLow) or (c.mUp < value);
+      default:
+        return false;
+    }
+  }
+
+  static void filterRanges(const CompiledCondition& c, const std::vector<TValueToFilter>& edges, const TValueToFilter& value, uint64_t& mask, int& bit)
+  {
+    if ((c.mLow <= value) and (value < c.mUp)) {
+      for (int i = 0; i < c.mNEdges - 1; ++i) {
+        if (value < edges[c.mFirstEdge + i + 1]) {
+          SETBIT(mask, bit + i);
+          break;
+        }
+      }
+    }
+    bit += c.mNEdges - 1;
+  }
+
+  std::vector<CompiledCondition> mConditions; ///< the flat list of conditions
+  std::vector<TValueToFilter> mEdges;         ///< the edges of the multiple ranges conditions
+  int mLength = 0;                            ///< the number of mask bits coded
+};
+
 /// \class CutBrickLimit
 /// \brief Class which implements a limiting cut brick.
 /// The brick will be active if the filtered value is below the limit
@@ -114,6 +283,10 @@ class CutBrickLimit : public CutBrick<TValueToFilter>
   virtual std::vector<bool> IsArmed() override;
   virtual std::vector<bool> Filter(const TValueToFilter&) override;
   virtual int Length() override { return 1; }
+  virtual void Compile(CompiledCutBricks<TValueToFilter>& compiled) const override
+  {
+    compiled.Add(CompiledCutBricks<TValueToFilter>::Condition::kLimit, mLimit, mLimit);
+  }
 
  private:
   void ConstructCutFromString(const TString&);
@@ -160,6 +333,10 @@ class CutBrickFnLimit : public CutBrickLimit<TValueToFilter>
   {
     this->mLimit = TValueToFilter(mFunction.Eval(x));
   }
+  virtual void Compile(CompiledCutBricks<TValueToFilter>& compiled) const override
+  {
+    compiled.Add(CompiledCutBricks<TValueToFilter>::Condition::kLimit, this->mLimit, this->mLimit, nullptr, &mFunction);
+  }
 
  private:
   void ConstructCutFromString(const TString&);
@@ -185,6 +362,10 @@ class CutBrickThreshold : public CutBrick<TValueToFilter>
   virtual std::vector<bool> IsArmed() override;
   virtual std::vector<bool> Filter(const TValueToFilter&) override;
   virtual int Length() override { return 1; }
+  virtual void Compile(CompiledCutBricks<TValueToFilter>& compiled) const override
+  {
+    compiled.Add(CompiledCutBricks<TValueToFilter>::Condition::kThreshold, mThreshold, mThreshold);
+  }
 
  private:
   void ConstructCutFromString(const TString&);
@@ -231,6 +412,10 @@ class CutBrickFnThreshold : public CutBrickThreshold<TValueToFilter>
   {
     this->mThreshold = TValueToFilter(mFunction.Eval(x));
   }
+  virtual void Compile(CompiledCutBricks<TValueToFilter>& compiled) const override
+  {
+    compiled.Add(CompiledCutBricks<TValueToFilter>::Condition::kThreshold, this->mThreshold, this->mThreshold, &mFunction, nullptr);
+  }
 
  private:
   void ConstructCutFromString(const TString&);
@@ -256,6 +441,10 @@ class CutBrickRange : public CutBrick<TValueToFilter>
   virtual std::vector<bool> IsArmed() override;
   virtual std::vector<bool> Filter(const TValueToFilter&) override;
   virtual int Length() override { return 1; }
+  virtual void Compile(CompiledCutBricks<TValueToFilter>& compiled) const override
+  {
+    compiled.Add(CompiledCutBricks<TValueToFilter>::Condition::kRange, mLow, mUp);
+  }
 
  private:
   void ConstructCutFromString(const TString&);
@@ -304,6 +493,10 @@ class CutBrickFnRange : public CutBrickRange<TValueToFilter>
     this->mLow = TValueToFilter(mLowFunction.Eval(x));
     this->mUp = TValueToFilter(mUpFunction.Eval(x));
   }
+  virtual void Compile(CompiledCutBricks<TValueToFilter>& compiled) const override
+  {
+    compiled.Add(CompiledCutBricks<TValueToFilter>::Condition::kRange, this->mLow, this->mUp, &mLowFunction, &mUpFunction);
+  }
 
  private:
   void ConstructCutFromString(const TString&);
@@ -330,6 +523,10 @@ class CutBrickExtToRange : public CutBrick<TValueToFilter>
   virtual std::vector<bool> IsArmed() override;
   virtual std::vector<bool> Filter(const TValueToFilter&) override;
   virtual int Length() override { return 1; }
+  virtual void Compile(CompiledCutBricks<TValueToFilter>& compiled) const override
+  {
+    compiled.Add(CompiledCutBricks<TValueToFilter>::Condition::kExtToRange, mLow, mUp);
+  }
 
  private:
   void ConstructCutFromString(const TString&);
@@ -378,6 +575,10 @@ class CutBrickFnExtToRange : public CutBrickExtToRange<TValueToFilter>
     this->mLow = TValueToFilter(mLowFunction.Eval(x));
     this->mUp = TValueToFilter(mUpFunction.Eval(x));
   }
+  virtual void Compile(CompiledCutBricks<TValueToFilter>& compiled) const override
+  {
+    compiled.Add(CompiledCutBricks<TValueToFilter>::Condition::kExtToRange, this->mLow, this->mUp, &mLowFunction, &mUpFunction);
+  }
 
  private:
   void ConstructCutFromString(const TString&);
@@ -409,6 +610,7 @@ class CutBrickSelectorMultipleRanges : public CutBrick<TValueToFilter>
   /// The length is in brick units. The actual length is implementation dependent
   /// \returns Brick length in units of bricks
   virtual int Length() override { return mActive.size(); }
+  virtual void Compile(CompiledCutBricks<TValueToFilter>& compiled) const override { compiled.Add(mEdges); }
 
  private:
   void ConstructCutFromString(const TString&);
@@ -441,6 +643,7 @@ class CutWithVariations : public CutBrick<TValueToFilter>
   virtual std::vector<bool> Filter(const TValueToFilter&) override;
   virtual int Length() override;
   virtual int getArmedIndex() override;
+  virtual void Compile(CompiledCutBricks<TValueToFilter>& compiled) const override;
 
  private:
   void ConstructCutFromString(const TString&);
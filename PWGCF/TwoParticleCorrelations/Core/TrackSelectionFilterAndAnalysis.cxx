@@ -251,6 +251,27 @@ int TrackSelectionFilterAndAnalysis::CalculateMaskLength()
   return length;
 }
 
+/// \brief Compiles the cuts in the flat evaluators used for filtering
+/// The mask bits are coded in the same order as in the mask length calculation
+void TrackSelectionFilterAndAnalysis::CompileBricks()
+{
+  mCompiledTrackSign.Compile(nullptr);
+  for (int i = 0; i < mTrackSign.GetEntries(); ++i) {
+    mCompiledTrackSign.Append((CutBrick<float>*)mTrackSign.At(i));
+  }
+  mCompiledNClustersTPC.Compile(mNClustersTPC);
+  mCompiledNCrossedRowsTPC.Compile(mNCrossedRowsTPC);
+  mCompiledNClustersITS.Compile(mNClustersITS);
+  mCompiledMaxChi2PerClusterTPC.Compile(mMaxChi2PerClusterTPC);
+  mCompiledMaxChi2PerClusterITS.Compile(mMaxChi2PerClusterITS);
+  mCompiledMinNCrossedRowsOverFindableClustersTPC.Compile(mMinNCrossedRowsOverFindableClustersTPC);
+  mCompiledMaxDcaXY.Compile(mMaxDcaXY);
+  mCompiledMaxDcaZ.Compile(mMaxDcaZ);
+  mCompiledPtRange.Compile(mPtRange);
+  mCompiledEtaRange.Compile(mEtaRange);
+  mCompiled = true;
+}
+
 void TrackSelectionFilterAndAnalysis::SetPtRange(const TString& regex)
 {
   if (mPtRange != nullptr) {
@@ -258,6 +279,7 @@ void TrackSelectionFilterAndAnalysis::SetPtRange(const TString& regex)
   }
   mPtRange = CutBrick<float>::constructBrick("pT", regex.Data(), std::set<std::string>{"rg", "th", "lim", "xrg"});
   mMaskLength = CalculateMaskLength();
+  mCompiled = false;
 }
 
 void TrackSelectionFilterAndAnalysis::SetEtaRange(const TString& regex)
@@ -267,6 +289,7 @@ void TrackSelectionFilterAndAnalysis::SetEtaRange(const TString& regex)
   }
   mEtaRange = CutBrick<float>::constructBrick("eta", regex.Data(), std::set<std::string>{"rg", "th", "lim", "xrg"});
   mMaskLength = CalculateMaskLength();
+  mCompiled = false;
 }
 
 void TrackSelectionFilterAndAnalysis::ConstructCutFromString(const TString& cutstr)
@@ -102,11 +102,14 @@ class TrackSelectionFilterAndAnalysis : public SelectionFilterAndAnalysis
 
   template <typename TrackToFilter>
   uint64_t Filter(TrackToFilter const& track);
+  template <typename TracksToFilter>
+  void Filter(TracksToFilter const& tracks, std::vector<uint64_t>& masks);
 
  private:
   void ConstructCutFromString(const TString&);
   int CalculateMaskLength();
   void StoreArmedMask();
+  void CompileBricks();
 
   TList mTrackSign;                                         /// the track charge sign list
   TList mTrackTypes;                                        /// the track types to select list
@@ -121,6 +124,21 @@ class TrackSelectionFilterAndAnalysis : public SelectionFilterAndAnalysis
   CutBrick<float>* mPtRange;                                //! the pT range cuts
   CutBrick<float>* mEtaRange;                               //! the eta range cuts
 
+  bool mCompiled = false;                                                      //! the cuts are compiled in the flat evaluators
+  CompiledCutBricks<float> mCompiledTrackSign;                                 //! the track charge sign cuts evaluator
+  CompiledCutBricks<int> mCompiledNClustersTPC;                                //! the number of TPC clusters cuts evaluator
+  CompiledCutBricks<int> mCompiledNCrossedRowsTPC;                             //! the number of TPC crossed rows cuts evaluator
+  CompiledCutBricks<int> mCompiledNClustersITS;                                //! the number of ITS clusters cuts evaluator
+  CompiledCutBricks<float> mCompiledMaxChi2PerClusterTPC;                      //! the max Chi2 per TPC cluster cuts evaluator
+  CompiledCutBricks<float> mCompiledMaxChi2PerClusterITS;                      //! the max Chi2 per ITS cluster cuts evaluator
+  CompiledCutBricks<float> mCompiledMinNCrossedRowsOverFindableClustersTPC;    //! the min ratio crossed TPC rows over findable TPC clusters cuts evaluator
+  CompiledCutBricks<float> mCompiledMaxDcaXY;                                  //! the DCAxy cuts evaluator
+  CompiledCutBricks<float> mCompiledMaxDcaZ;                                   //! the DCAz cuts evaluator
+  CompiledCutBricks<float> mCompiledPtRange;                                   //! the pT range cuts evaluator
+  CompiledCutBricks<float> mCompiledEtaRange;                                  //! the eta range cuts evaluator
+  std::vector<float> mFloatColumn;                                             //! values of a float column of the tracks being filtered
+  std::vector<int> mIntColumn;                                                 //! values of an integer column of the tracks being filtered
+
   ClassDef(TrackSelectionFilterAndAnalysis, 1)
 };
 
@@ -128,77 +146,96 @@ class TrackSelectionFilterAndAnalysis : public SelectionFilterAndAnalysis
 template <typename TrackToFilter>
 uint64_t TrackSelectionFilterAndAnalysis::Filter(TrackToFilter const& track)
 {
+  if (not mCompiled) {
+    CompileBricks();
+  }
   uint64_t selectedMask = 0UL;
   int bit = 0;
 
-  auto filterTrackType = [&](TrackSelectionBrick* ttype, auto trk) {
-    if (ttype->Filter(trk)) {
+  mCompiledTrackSign.Filter(track.sign(), selectedMask, bit);
+  for (int i = 0; i < mTrackTypes.GetEntries(); ++i) {
+    if (((TrackSelectionBrick*)mTrackTypes.At(i))->Filter(track)) {
       SETBIT(selectedMask, bit);
     }
     bit++;
-  };
+  }
+  mCompiledNClustersTPC.Filter(track.tpcNClsFound(), selectedMask, bit);
+  mCompiledNCrossedRowsTPC.Filter(track.tpcNClsCrossedRows(), selectedMask, bit);
+  mCompiledNClustersITS.Filter(track.itsNCls(), selectedMask, bit);
+  mCompiledMaxChi2PerClusterTPC.Filter(track.tpcChi2NCl(), selectedMask, bit);
+  mCompiledMaxChi2PerClusterITS.Filter(track.itsChi2NCl(), selectedMask, bit);
+  mCompiledMinNCrossedRowsOverFindableClustersTPC.Filter(track.tpcCrossedRowsOverFindableCls(), selectedMask, bit);
+  mCompiledMaxDcaXY.Filter(track.dcaXY(), selectedMask, bit);
+  mCompiledMaxDcaZ.Filter(track.dcaZ(), selectedMask, bit);
+  if (not mCompiledPtRange.IsEmpty() and not mCompiledPtRange.Passes(track.pt())) {
+    selectedMask = 0UL;
+  }
+  if (not mCompiledEtaRange.IsEmpty() and not mCompiledEtaRange.Passes(track.pt())) {
+    selectedMask = 0UL;
+  }
+  return mSelectedMask = selectedMask;
+}
 
-  auto filterBrickValue = [&](auto brick, auto value) {
-    std::vector<bool> res = brick->Filter(value);
-    for (auto b : res) {
-      if (b) {
-        SETBIT(selectedMask, bit);
-      }
-      bit++;
+/// \brief Fills the filter cuts masks of a whole table of tracks
+/// The cuts are evaluated one column at a time, over the values of all the tracks.
+/// The masks are the same as the ones of the track by track filter
+template <typename TracksToFilter>
+void TrackSelectionFilterAndAnalysis::Filter(TracksToFilter const& tracks, std::vector<uint64_t>& masks)
+{
+  if (not mCompiled) {
+    CompileBricks();
+  }
+  const std::size_t nTracks = tracks.size();
+  masks.assign(nTracks, 0UL);
+  int bit = 0;
+
+  auto filterColumn = [&](auto const& compiled, auto& column, auto getter) {
+    if (compiled.IsEmpty()) {
+      return;
+    }
+    column.resize(nTracks);
+    std::size_t i = 0;
+    for (auto const& track : tracks) {
+      column[i++] = getter(track);
     }
+    compiled.Filter(column.data(), nTracks, masks.data(), bit);
+    bit += compiled.Length();
   };
-
-  auto filterBrickValueNoMask = [](auto brick, auto value) {
-    std::vector<bool> res = brick->Filter(value);
-    for (auto b : res) {
-      if (b) {
-        return true;
+  auto acceptColumn = [&](auto const& compiled, auto getter) {
+    if (compiled.IsEmpty()) {
+      return;
+    }
+    std::size_t i = 0;
+    for (auto const& track : tracks) {
+      if (not compiled.Passes(getter(track))) {
+        masks[i] = 0UL;
       }
+      i++;
     }
-    return false;
   };
 
-  for (int i = 0; i < mTrackSign.GetEntries(); ++i) {
-    filterBrickValue((CutBrick<float>*)mTrackSign.At(i), track.sign());
-  }
-  for (int i = 0; i < mTrackTypes.GetEntries(); ++i) {
-    filterTrackType((TrackSelectionBrick*)mTrackTypes.At(i), track);
-  }
-  if (mNClustersTPC != nullptr) {
-    filterBrickValue(mNClustersTPC, track.tpcNClsFound());
-  }
-  if (mNCrossedRowsTPC != nullptr) {
-    filterBrickValue(mNCrossedRowsTPC, track.tpcNClsCrossedRows());
-  }
-  if (mNClustersITS != nullptr) {
-    filterBrickValue(mNClustersITS, track.itsNCls());
-  }
-  if (mMaxChi2PerClusterTPC != nullptr) {
-    filterBrickValue(mMaxChi2PerClusterTPC, track.tpcChi2NCl());
-  }
-  if (mMaxChi2PerClusterITS != nullptr) {
-    filterBrickValue(mMaxChi2PerClusterITS, track.itsChi2NCl());
-  }
-  if (mMinNCrossedRowsOverFindableClustersTPC != nullptr) {
-    filterBrickValue(mMinNCrossedRowsOverFindableClustersTPC, track.tpcCrossedRowsOverFindableCls());
-  }
-  if (mMaxDcaXY != nullptr) {
-    filterBrickValue(mMaxDcaXY, track.dcaXY());
-  }
-  if (mMaxDcaZ != nullptr) {
-    filterBrickValue(mMaxDcaZ, track.dcaZ());
-  }
-  if (mPtRange != nullptr) {
-    if (not filterBrickValueNoMask(mPtRange, track.pt())) {
-      selectedMask = 0UL;
-    }
-  }
-  if (mEtaRange != nullptr) {
-    if (not filterBrickValueNoMask(mEtaRange, track.pt())) {
-      selectedMask = 0UL;
+  filterColumn(mCompiledTrackSign, mFloatColumn, [](auto const& track) { return track.sign(); });
+  for (int t = 0; t < mTrackTypes.GetEntries(); ++t) {
+    auto ttype = (TrackSelectionBrick*)mTrackTypes.At(t);
+    std::size_t i = 0;
+    for (auto const& track : tracks) {
+      if (ttype->Filter(track)) {
+        SETBIT(masks[i], bit);
+      }
+      i++;
     }
+    bit++;
   }
-  return mSelectedMask = selectedMask;
+  filterColumn(mCompiledNClustersTPC, mIntColumn, [](auto const& track) { return track.tpcNClsFound(); });
+  filterColumn(mCompiledNCrossedRowsTPC, mIntColumn, [](auto const& track) { return track.tpcNClsCrossedRows(); });
+  filterColumn(mCompiledNClustersITS, mIntColumn, [](auto const& track) { return track.itsNCls(); });
+  filterColumn(mCompiledMaxChi2PerClusterTPC, mFloatColumn, [](auto const& track) { return track.tpcChi2NCl(); });
+  filterColumn(mCompiledMaxChi2PerClusterITS, mFloatColumn, [](auto const& track) { return track.itsChi2NCl(); });
+  filterColumn(mCompiledMinNCrossedRowsOverFindableClustersTPC, mFloatColumn, [](auto const& track) { return track.tpcCrossedRowsOverFindableCls(); });
+  filterColumn(mCompiledMaxDcaXY, mFloatColumn, [](auto const& track) { return track.dcaXY(); });
+  filterColumn(mCompiledMaxDcaZ, mFloatColumn, [](auto const& track) { return track.dcaZ(); });
+  acceptColumn(mCompiledPtRange, [](auto const& track) { return track.pt(); });
+  acceptColumn(mCompiledEtaRange, [](auto const& track) { return track.pt(); });
 }
 
 } // namespace PWGCF
@@ -229,6 +229,8 @@ struct TwoParticleCorrelationsTrackSkimming {
   Produces<aod::CFTrackPIDs> skimmtrackpid;
   Produces<aod::CFMCPartMask> particlemask;
 
+  std::vector<uint64_t> trkmasks; ///< the track cuts masks of the tracks table being skimmed
+
 #include "PWGCF/TwoParticleCorrelations/TableProducer/Productions/skimmingconf_20221115.cxx" // NOLINT
 
   void init(InitContext const&)
@@ -266,14 +268,18 @@ struct TwoParticleCorrelationsTrackSkimming {
     trackmask.reserve(tracks.size());
     skimmtrackpid.reserve(tracks.size());
 
+    /* the track cuts are evaluated for the whole table at once */
+    fFilterFramework->FilterTracks(tracks, trkmasks);
+
     int nfilteredtracks = 0;
+    int itrack = 0;
     for (auto const& track : tracks) {
       if (!track.has_collision()) {
         /* track not assigned to any collision */
         trackmask(0UL);
         skimmtrackpid(0UL);
       } else {
-        auto trkmask = fFilterFramework->FilterTrack(track);
+        auto trkmask = trkmasks[itrack];
         auto pidmask = fFilterFramework->FilterTrackPID(track);
         trackmask(trkmask);
         skimmtrackpid(pidmask);
@@ -281,6 +287,7 @@ struct TwoParticleCorrelationsTrackSkimming {
           nfilteredtracks++;
         }
       }
+      itrack++;
     }
     LOGF(info, "Filtered %d tracks out of %d", nfilteredtracks, tracks.size());
   }
@@ -0,0 +1,142 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//
+// Contact: iarsene@cern.ch, i.c.arsene@fys.uio.no
+//
+// Flattened version of an AnalysisCut / AnalysisCompositeCut tree, for fast evaluation
+//
+
+#ifndef AnalysisCompiledCut_H
+#define AnalysisCompiledCut_H
+
+#include "PWGDQ/Core/AnalysisCut.h"
+#include "PWGDQ/Core/AnalysisCompositeCut.h"
+#include <vector>
+
+//_________________________________________________________________________
+// The cut tree is compiled into a linear program of range checks. Each instruction holds one cut
+//   (variable, limits, exclusion flag and the optional dependent-variable ranges) and the positions of the
+//   instructions to be executed next if the check passes or fails. The AND / OR logic of the composite cuts
+//   is encoded in these jumps, with the same short-circuit order as AnalysisCompositeCut::IsSelected(),
+//   so the evaluation is a loop over the program without virtual calls nor recursion.
+class AnalysisCompiledCut
+{
+ public:
+  AnalysisCompiledCut() = default;
+  explicit AnalysisCompiledCut(const AnalysisCut& cut) { Compile(cut); }
+
+  // Jump targets ending the evaluation
+  enum Constants {
+    kAccept = -1,
+    kReject = -2
+  };
+
+  struct Instruction {
+    AnalysisCut::CutContainer fCut; // range check
+    int fOnPass;                    // next instruction if the check passes (or if it does not apply), or kAccept / kReject
+    int fOnFail;                    // next instruction if the check fails, or kAccept / kReject
+  };
+
+  void Compile(const AnalysisCut& cut)
+  {
+    fProgram.clear();
+    int entry = 0;
+    if (cut.IsA() == AnalysisCompositeCut::Class()) {
+      entry = EmitComposite(static_cast<const AnalysisCompositeCut&>(cut), kAccept, kReject);
+    } else {
+      entry = EmitCut(cut, kAccept, kReject);
+    }
+    // the instructions were emitted starting from the last one, reverse them
+    const int n = fProgram.size();
+    auto position = [n](int target) { return target < 0 ? target : n - 1 - target; };
+    std::vector<Instruction> program(fProgram.rbegin(), fProgram.rend());
+    for (auto& instruction : program) {
+      instruction.fOnPass = position(instruction.fOnPass);
+      instruction.fOnFail = position(instruction.fOnFail);
+    }
+    fProgram = program;
+    fEntry = position(entry);
+  }
+
+  int GetNInstructions() const { return fProgram.size(); }
+
+  bool IsSelected(const float* values) const
+  {
+    int next = fEntry;
+    while (next >= 0) {
+      const Instruction& instruction = fProgram[next];
+      next = Check(instruction.fCut, values) ? instruction.fOnPass : instruction.fOnFail;
+    }
+    return next == kAccept;
+  }
+
+  // Evaluate the cut on nRows rows of values, stored contiguously with a distance of "stride" floats between rows
+  void IsSelected(int nRows, const float* values, int stride, bool* decisions) const
+  {
+    for (int i = 0; i < nRows; ++i) {
+      decisions[i] = IsSelected(values + static_cast<long>(i) * stride);
+    }
+  }
+
+ private:
+  std::vector<Instruction> fProgram; // instructions
+  int fEntry = kAccept;              // first instruction to be executed
+
+  // Same logic as in AnalysisCut::IsSelected() for a single cut container: returns true if the container does not apply
+  static bool Check(const AnalysisCut::CutContainer& cut, const float* values)
+  {
+    if (cut.fDepVar != -1) {
+      bool inRange = (values[cut.fDepVar] > cut.fDepLow && values[cut.fDepVar] <= cut.fDepHigh);
+      if (inRange == cut.fDepExclude) {
+        return true;
+      }
+    }
+    if (cut.fDepVar2 != -1) {
+      bool inRange = (values[cut.fDepVar2] > cut.fDep2Low && values[cut.fDepVar2] <= cut.fDep2High);
+      if (inRange == cut.fDep2Exclude) {
+        return true;
+      }
+    }
+    float cutLow = (cut.fFuncLow ? cut.fFuncLow->Eval(values[cut.fDepVar]) : cut.fLow);
+    float cutHigh = (cut.fFuncHigh ? cut.fFuncHigh->Eval(values[cut.fDepVar]) : cut.fHigh);
+    bool inRange = (values[cut.fVar] >= cutLow && values[cut.fVar] <= cutHigh);
+    return inRange != cut.fExclude;
+  }
+
+  // Emit the code of a simple cut (AND of its containers), jumping to onPass or onFail at the end; returns the entry point
+  int EmitCut(const AnalysisCut& cut, int onPass, int onFail)
+  {
+    int next = onPass;
+    const auto& containers = cut.GetCuts();
+    for (auto it = containers.rbegin(); it != containers.rend(); ++it) {
+      fProgram.push_back({*it, next, onFail});
+      next = fProgram.size() - 1;
+    }
+    return next;
+  }
+
+  // Emit the code of a composite cut: the simple cuts first and then the composite ones, as in AnalysisCompositeCut::IsSelected()
+  int EmitComposite(const AnalysisCompositeCut& cut, int onPass, int onFail)
+  {
+    const auto& cuts = cut.GetCutList();
+    const auto& compositeCuts = cut.GetCompositeCutList();
+    int next = (cut.GetUseAND() ? onPass : onFail);
+    for (auto it = compositeCuts.rbegin(); it != compositeCuts.rend(); ++it) {
+      next = (cut.GetUseAND() ? EmitComposite(*it, next, onFail) : EmitComposite(*it, onPass, next));
+    }
+    for (auto it = cuts.rbegin(); it != cuts.rend(); ++it) {
+      next = (cut.GetUseAND() ? EmitCut(*it, next, onFail) : EmitCut(*it, onPass, next));
+    }
+    return next;
+  }
+};
+
+#endif
@@ -12,8 +12,53 @@
 // Contact: iarsene@cern.ch, i.c.arsene@fys.uio.no
 //
 #include "PWGDQ/Core/CutsLibrary.h"
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
+namespace o2::aod::dqcuts
+{
+AnalysisCompositeCut* BuildCompositeCut(const char* cutName);
+AnalysisCut* BuildAnalysisCut(const char* cutName);
+
+//_______________________________________________________________________________________________
+template <typename T>
+T* GetCachedCut(const char* cutName, T* (*build)(const char*))
+{
+  //
+  // Registry of the cuts already built, indexed by name: each cut is defined only once (when first requested)
+  //   by running through the library and all the subsequent requests just copy it
+  //
+  static std::unordered_map<std::string, std::unique_ptr<T>> registry;
+  static std::recursive_mutex registryMutex; // composite cuts are built while holding the lock, requesting their ingredients
+  std::lock_guard<std::recursive_mutex> lock(registryMutex);
+
+  auto cached = registry.find(cutName);
+  if (cached == registry.end()) {
+    std::unique_ptr<T> cut(build(cutName));
+    if (cut == nullptr) {
+      return nullptr;
+    }
+    cached = registry.emplace(cutName, std::move(cut)).first;
+  }
+  return new T(*cached->second);
+}
+} // namespace o2::aod::dqcuts
+
+//_______________________________________________________________________________________________
 AnalysisCompositeCut* o2::aod::dqcuts::GetCompositeCut(const char* cutName)
+{
+  return GetCachedCut(cutName, &BuildCompositeCut);
+}
+
+//_______________________________________________________________________________________________
+AnalysisCut* o2::aod::dqcuts::GetAnalysisCut(const char* cutName)
+{
+  return GetCachedCut(cutName, &BuildAnalysisCut);
+}
+
+//_______________________________________________________________________________________________
+AnalysisCompositeCut* o2::aod::dqcuts::BuildCompositeCut(const char* cutName)
 {
   //
   // define composie cuts, typically combinations of all the ingredients needed for a full cut
@@ -1431,7 +1476,8 @@ AnalysisCompositeCut* o2::aod::dqcuts::GetCompositeCut(const char* cutName)
   return nullptr;
 }
 
-AnalysisCut* o2::aod::dqcuts::GetAnalysisCut(const char* cutName)
+//_______________________________________________________________________________________________
+AnalysisCut* o2::aod::dqcuts::BuildAnalysisCut(const char* cutName)
 {
   //
   // define here cuts which are likely to be used often
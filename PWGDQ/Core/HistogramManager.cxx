@@ -39,6 +39,10 @@ HistogramManager::HistogramManager() : TNamed("", ""),
                                        fNVars(0),
                                        fUsedVars(nullptr),
                                        fVariablesMap(),
+                                       fFillPlanCompiled(false),
+                                       fFillPlan(),
+                                       fFillVars(),
+                                       fClassHandles(),
                                        fUseDefaultVariableNames(false),
                                        fBinsAllocated(0),
                                        fVariableNames(nullptr),
@@ -55,6 +59,10 @@ HistogramManager::HistogramManager(const char* name, const char* title, const in
                                                                                               fNVars(maxNVars),
                                                                                               fUsedVars(),
                                                                                               fVariablesMap(),
+                                                                                              fFillPlanCompiled(false),
+                                                                                              fFillPlan(),
+                                                                                              fFillVars(),
+                                                                                              fClassHandles(),
                                                                                               fUseDefaultVariableNames(kFALSE),
                                                                                               fBinsAllocated(0),
                                                                                               fVariableNames(),
@@ -110,6 +118,7 @@ void HistogramManager::AddHistClass(const char* histClass)
   fMainList->Add(hList);
   std::list<std::vector<int>> varList;
   fVariablesMap[histClass] = varList;
+  fFillPlanCompiled = false;
   cout << "Adding histogram class " << histClass << endl;
   cout << "Variable map size :: " << fVariablesMap.size() << endl;
 }
@@ -184,6 +193,7 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   cout << "Adding histogram " << hname << endl;
   cout << "size of array :: " << varList.size() << endl;
   fVariablesMap[histClass] = varList;
+  fFillPlanCompiled = false;
 
   // create and configure histograms according to required options
   TH1* h = nullptr;
@@ -383,6 +393,7 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   cout << "Adding histogram " << hname << endl;
   cout << "size of array :: " << varList.size() << endl;
   fVariablesMap[histClass] = varList;
+  fFillPlanCompiled = false;
 
   TH1* h = nullptr;
   switch (dimension) {
@@ -551,6 +562,7 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   cout << "Adding histogram " << hname << endl;
   cout << "size of array :: " << varList.size() << endl;
   fVariablesMap[histClass] = varList;
+  fFillPlanCompiled = false;
 
   uint32_t nbins = 1;
   THnBase* h = nullptr;
@@ -630,6 +642,7 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   cout << "Adding histogram " << hname << endl;
   cout << "size of array :: " << varList.size() << endl;
   fVariablesMap[histClass] = varList;
+  fFillPlanCompiled = false;
 
   // get the min and max for each axis
   auto* xmin = new double[nDimensions];
@@ -679,130 +692,165 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   fBinsAllocated += bins;
 }
 
+//__________________________________________________________________
+void HistogramManager::CompileFillPlan()
+{
+  //
+  // resolve, for each histogram class, the histograms and the variables to be filled
+  //   so that the filling does not need any lookup by name
+  //
+  fFillPlan.clear();
+  fFillVars.clear();
+  fClassHandles.clear();
+  fFillPlan.resize(fMainList->GetEntries());
+
+  for (int iClass = 0; iClass < fMainList->GetEntries(); ++iClass) {
+    auto* hList = reinterpret_cast<TList*>(fMainList->At(iClass));
+    fClassHandles[hList->GetName()] = iClass;
+    const auto& varList = fVariablesMap[hList->GetName()];
+
+    // NOTE: the histogram list and the std::list of variables contain the same number of elements and are synchronized
+    TIter next(hList);
+    for (const auto& vars : varList) {
+      TObject* h = next();
+      if (!h) {
+        break;
+      }
+      FillEntry entry;
+      entry.fHist = h;
+      entry.fVarW = vars[2];
+      entry.fVarsOffset = static_cast<int>(fFillVars.size());
+      const bool isProfile = (vars[0] == 1);
+      if (vars[1] > 0) { // THn, the variables of all the axes are stored
+        entry.fType = kFillTHn;
+        entry.fNVars = vars[1];
+      } else {
+        const int dimension = (reinterpret_cast<TH1*>(h))->GetDimension();
+        // profiles need one more variable, the one being averaged
+        entry.fNVars = dimension + (isProfile ? 1 : 0);
+        entry.fType = (isProfile ? kFillProfile : kFillTH1) + dimension - 1;
+      }
+      for (int i = 0; i < entry.fNVars; ++i) {
+        fFillVars.push_back(vars[3 + i]);
+      }
+      fFillPlan[iClass].push_back(entry);
+    }
+  }
+  fFillPlanCompiled = true;
+}
+
+//__________________________________________________________________
+int HistogramManager::GetHistClassHandle(const char* className)
+{
+  //
+  // get the handle of a histogram class
+  //
+  if (!fFillPlanCompiled) {
+    CompileFillPlan();
+  }
+  auto it = fClassHandles.find(className);
+  if (it == fClassHandles.end()) {
+    LOG(warn) << "HistogramManager::GetHistClassHandle(): Histogram class " << className << " not found!";
+    return kNothing;
+  }
+  return it->second;
+}
+
 //__________________________________________________________________
 void HistogramManager::FillHistClass(const char* className, Float_t* values)
 {
   //
   //  fill a class of histograms
   //
-
-  // get the needed histogram list
-  auto* hList = reinterpret_cast<TList*>(fMainList->FindObject(className));
-  if (!hList) {
+  if (!fFillPlanCompiled) {
+    CompileFillPlan();
+  }
+  auto it = fClassHandles.find(className);
+  if (it == fClassHandles.end()) {
     // TODO: add some meaningfull error message
     /*LOG(warn) << "HistogramManager::FillHistClass(): Histogram list " << className << " not found!";
     LOG(warn) << "         Histogram list not filled" << endl; */
     return;
   }
+  FillHistClass(it->second, values);
+}
 
-  // get the corresponding std::list containng identifiers to the needed variables to be filled
-  list varList = fVariablesMap[className];
-
-  TIter next(hList);
+//__________________________________________________________________
+void HistogramManager::FillHistClass(int classHandle, Float_t* values)
+{
+  //
+  //  fill a class of histograms, identified by the handle from GetHistClassHandle()
+  //
+  if (classHandle < 0) {
+    return;
+  }
+  if (!fFillPlanCompiled) {
+    CompileFillPlan();
+  }
 
-  TObject* h = nullptr;
-  bool isProfile;
-  bool isTHn;
-  int dimension = 0;
-  bool isSparse = kFALSE;
   // TODO: At the moment, maximum 20 dimensions are foreseen for the THn histograms. We should make this more dynamic
   //       But maybe its better to have it like to avoid dynamically allocating this array in the histogram loop
   double fillValues[20] = {0.0};
-  int varX = -1, varY = -1, varZ = -1, varT = -1, varW = -1;
-
-  // loop over the histogram and std::list
-  // NOTE: these two should contain the same number of elements and be synchronized, otherwise its a mess
-  for (auto varIter = varList.begin(); varIter != varList.end(); varIter++) {
-    h = next(); // get the histogram
-    // decode information from the vector of indices
-    isProfile = (varIter->at(0) == 1 ? true : false);
-    isTHn = (varIter->at(1) > 0 ? true : false);
-    if (isTHn) {
-      dimension = varIter->at(1);
-    } else {
-      dimension = (reinterpret_cast<TH1*>(h))->GetDimension();
-    }
 
-    // get the various variable indices
-    varW = varIter->at(2);
-    if (isTHn) {
-      for (int i = 0; i < dimension; i++) {
-        fillValues[i] = values[varIter->at(3 + i)];
-      }
-    } else {
-      varX = varIter->at(3);
-      varY = varIter->at(4);
-      varZ = varIter->at(5);
-      varT = varIter->at(6);
-    }
-
-    if (!isTHn) {
-      switch (dimension) {
-        case 1:
-          if (isProfile) {
-            if (varW > kNothing) {
-              (reinterpret_cast<TProfile*>(h))->Fill(values[varX], values[varY], values[varW]);
-            } else {
-              (reinterpret_cast<TProfile*>(h))->Fill(values[varX], values[varY]);
-            }
-          } else {
-            if (varW > kNothing) {
-              (reinterpret_cast<TH1F*>(h))->Fill(values[varX], values[varW]);
-            } else {
-              (reinterpret_cast<TH1F*>(h))->Fill(values[varX]);
-            }
-          }
-          break;
-        case 2:
-          if (isProfile) {
-            if (varW > kNothing) {
-              (reinterpret_cast<TProfile2D*>(h))->Fill(values[varX], values[varY], values[varZ], values[varW]);
-            } else {
-              (reinterpret_cast<TProfile2D*>(h))->Fill(values[varX], values[varY], values[varZ]);
-            }
-          } else {
-            if (varW > kNothing) {
-              (reinterpret_cast<TH2F*>(h))->Fill(values[varX], values[varY], values[varW]);
-            } else {
-              (reinterpret_cast<TH2F*>(h))->Fill(values[varX], values[varY]);
-            }
-          }
-          break;
-        case 3:
-          if (isProfile) {
-            if (varW > kNothing) {
-              (reinterpret_cast<TProfile3D*>(h))->Fill(values[varX], values[varY], values[varZ], values[varT], values[varW]);
-            } else {
-              (reinterpret_cast<TProfile3D*>(h))->Fill(values[varX], values[varY], values[varZ], values[varT]);
-            }
-          } else {
-            if (varW > kNothing) {
-              (reinterpret_cast<TH3F*>(h))->Fill(values[varX], values[varY], values[varZ], values[varW]);
-            } else {
-              (reinterpret_cast<TH3F*>(h))->Fill(values[varX], values[varY], values[varZ]);
-            }
-          }
-          break;
-
-        default:
-          break;
-      } // end switch
-      // end if(!isTHn)
-    } else {
-      if (varW > kNothing) {
-        if (isSparse) {
-          (reinterpret_cast<THnSparseF*>(h))->Fill(fillValues, values[varW]);
+  for (const auto& entry : fFillPlan[classHandle]) {
+    const int* vars = fFillVars.data() + entry.fVarsOffset;
+    const bool useWeight = (entry.fVarW > kNothing);
+    switch (entry.fType) {
+      case kFillTH1:
+        if (useWeight) {
+          (reinterpret_cast<TH1F*>(entry.fHist))->Fill(values[vars[0]], values[entry.fVarW]);
         } else {
-          (reinterpret_cast<THnF*>(h))->Fill(fillValues, values[varW]);
+          (reinterpret_cast<TH1F*>(entry.fHist))->Fill(values[vars[0]]);
         }
-      } else {
-        if (isSparse) {
-          (reinterpret_cast<THnSparseF*>(h))->Fill(fillValues);
+        break;
+      case kFillTH2:
+        if (useWeight) {
+          (reinterpret_cast<TH2F*>(entry.fHist))->Fill(values[vars[0]], values[vars[1]], values[entry.fVarW]);
         } else {
-          (reinterpret_cast<THnF*>(h))->Fill(fillValues);
+          (reinterpret_cast<TH2F*>(entry.fHist))->Fill(values[vars[0]], values[vars[1]]);
         }
-      }
-    } // end else
+        break;
+      case kFillTH3:
+        if (useWeight) {
+          (reinterpret_cast<TH3F*>(entry.fHist))->Fill(values[vars[0]], values[vars[1]], values[vars[2]], values[entry.fVarW]);
+        } else {
+          (reinterpret_cast<TH3F*>(entry.fHist))->Fill(values[vars[0]], values[vars[1]], values[vars[2]]);
+        }
+        break;
+      case kFillProfile:
+        if (useWeight) {
+          (reinterpret_cast<TProfile*>(entry.fHist))->Fill(values[vars[0]], values[vars[1]], values[entry.fVarW]);
+        } else {
+          (reinterpret_cast<TProfile*>(entry.fHist))->Fill(values[vars[0]], values[vars[1]]);
+        }
+        break;
+      case kFillProfile2D:
+        if (useWeight) {
+          (reinterpret_cast<TProfile2D*>(entry.fHist))->Fill(values[vars[0]], values[vars[1]], values[vars[2]], values[entry.fVarW]);
+        } else {
+          (reinterpret_cast<TProfile2D*>(entry.fHist))->Fill(values[vars[0]], values[vars[1]], values[vars[2]]);
+        }
+        break;
+      case kFillProfile3D:
+        if (useWeight) {
+          (reinterpret_cast<TProfile3D*>(entry.fHist))->Fill(values[vars[0]], values[vars[1]], values[vars[2]], values[vars[3]], values[entry.fVarW]);
+        } else {
+          (reinterpret_cast<TProfile3D*>(entry.fHist))->Fill(values[vars[0]], values[vars[1]], values[vars[2]], values[vars[3]]);
+        }
+        break;
+      case kFillTHn:
+        for (int i = 0; i < entry.fNVars; i++) {
+          fillValues[i] = values[vars[i]];
+        }
+        if (useWeight) {
+          (reinterpret_cast<THnBase*>(entry.fHist))->Fill(fillValues, values[entry.fVarW]);
+        } else {
+          (reinterpret_cast<THnBase*>(entry.fHist))->Fill(fillValues);
+        }
+        break;
+      default:
+        break;
+    } // end switch
   }   // end loop over histograms
 }
 
@@ -47,6 +47,7 @@ class HistogramManager : public TNamed
       delete fMainList;
     }
     fMainList = list;
+    fFillPlanCompiled = false;
   }
 
   // Create a new histogram class
@@ -85,6 +86,10 @@ class HistogramManager : public TNamed
                     TString* axLabels = nullptr, int varW = -1, bool useSparse = kFALSE);
 
   void FillHistClass(const char* className, float* values);
+  // Get the integer handle of the histogram class <className>, to be used in FillHistClass(int, float*)
+  //   This avoids any string lookup when filling; kNothing is returned if the class does not exist
+  int GetHistClassHandle(const char* className);
+  void FillHistClass(int classHandle, float* values);
 
   void SetUseDefaultVariableNames(bool flag) { fUseDefaultVariableNames = flag; };
   void SetDefaultVarNames(TString* vars, TString* units);
@@ -102,6 +107,30 @@ class HistogramManager : public TNamed
   bool* fUsedVars;                                                  //! flags of used variables
   std::map<std::string, std::list<std::vector<int>>> fVariablesMap; //!  map holding identifiers for all variables needed by histograms
 
+  // compiled fill plan: for each histogram class (indexed by its handle, i.e. its position in fMainList)
+  //   the list of histograms with their type and the indices of the variables to be filled
+  enum FillType {
+    kFillTH1 = 0,
+    kFillTH2,
+    kFillTH3,
+    kFillProfile,
+    kFillProfile2D,
+    kFillProfile3D,
+    kFillTHn
+  };
+  struct FillEntry {
+    TObject* fHist;  // histogram to be filled
+    int fType;       // histogram type, see FillType
+    int fVarW;       // variable used for weighting, kNothing if not used
+    int fNVars;      // number of variables to be filled
+    int fVarsOffset; // position of the first variable in fFillVars
+  };
+  bool fFillPlanCompiled;                                //! whether the fill plan is up to date with the defined histograms
+  std::vector<std::vector<FillEntry>> fFillPlan;         //! fill entries for each histogram class
+  std::vector<int> fFillVars;                            //! variable indices of all the fill entries
+  std::map<std::string, int> fClassHandles;              //! handle of each histogram class
+  void CompileFillPlan();
+
   // various
   bool fUseDefaultVariableNames;    //! toggle the usage of default variable names and units
   unsigned long int fBinsAllocated; //! number of allocated bins
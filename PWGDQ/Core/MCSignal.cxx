@@ -18,7 +18,10 @@ MCSignal::MCSignal() : TNamed("", ""),
                        fProngs({}),
                        fNProngs(0),
                        fCommonAncestorIdxs({}),
-                       fTempAncestorLabel(-1)
+                       fTempAncestorLabel(-1),
+                       fCache(),
+                       fCacheEpoch(1),
+                       fCacheCheckSources(false)
 {
 }
 
@@ -27,7 +30,10 @@ MCSignal::MCSignal(int nProngs, const char* name /*= ""*/, const char* title /*=
                                                                                          fProngs({}),
                                                                                          fNProngs(nProngs),
                                                                                          fCommonAncestorIdxs({}),
-                                                                                         fTempAncestorLabel(-1)
+                                                                                         fTempAncestorLabel(-1),
+                                                                                         fCache(),
+                                                                                         fCacheEpoch(1),
+                                                                                         fCacheCheckSources(false)
 {
   fProngs.reserve(nProngs);
 }
@@ -37,7 +43,10 @@ MCSignal::MCSignal(const char* name, const char* title, std::vector<MCProng> pro
                                                                                                                            fProngs(prongs),
                                                                                                                            fNProngs(prongs.size()),
                                                                                                                            fCommonAncestorIdxs(commonAncestors),
-                                                                                                                           fTempAncestorLabel(-1)
+                                                                                                                           fTempAncestorLabel(-1),
+                                                                                                                           fCache(),
+                                                                                                                           fCacheEpoch(1),
+                                                                                                                           fCacheCheckSources(false)
 {
 }
 
@@ -47,6 +56,7 @@ void MCSignal::SetProngs(std::vector<MCProng> prongs, std::vector<short> commonA
   fProngs = prongs;
   fNProngs = fProngs.size();
   fCommonAncestorIdxs = commonAncestors;
+  ResetCache();
 }
 
 //________________________________________________________________________________________________
@@ -55,11 +65,25 @@ void MCSignal::AddProng(MCProng prong, short commonAncestor)
   if (fProngs.size() < fNProngs) {
     fProngs.push_back(prong);
     fCommonAncestorIdxs.push_back(commonAncestor);
+    ResetCache();
   } else { // TODO: there should be an error message here
     return;
   }
 }
 
+//________________________________________________________________________________________________
+void MCSignal::ResetCache()
+{
+  // invalidate all the cached prong decisions, keeping the allocated memory
+  fCacheEpoch++;
+  if (fCacheEpoch == 0) {
+    for (auto& cache : fCache) {
+      cache.clear();
+    }
+    fCacheEpoch = 1;
+  }
+}
+
 //________________________________________________________________________________________________
 void MCSignal::PrintConfig()
 {
@@ -59,6 +59,7 @@ process(aod::McParticles const& mcTracks) {
 #include "MCProng.h"
 #include "TNamed.h"
 
+#include <cstdint>
 #include <vector>
 #include <iostream>
 using std::cout;
@@ -96,6 +97,26 @@ class MCSignal : public TNamed
     return CheckMC(0, checkSources, args...);
   };
 
+  // Same as CheckSignal(), but the decision of each prong is evaluated only once per MC particle and then kept in a cache,
+  //   indexed by the globalIndex() of the particle. Multi-prong signals just combine the cached prong decisions with the common ancestor check.
+  //   ResetCache() must be called whenever the MC particle table changes (e.g. for every data frame or event).
+  template <typename... T>
+  bool CheckSignalCached(bool checkSources, const T&... args)
+  {
+    // Make sure number of tracks provided is equal to the number of prongs
+    if (sizeof...(args) != fNProngs) {
+      return false;
+    }
+    if (checkSources != fCacheCheckSources) {
+      ResetCache();
+      fCacheCheckSources = checkSources;
+    }
+
+    return CheckMCCached(0, checkSources, args...);
+  };
+
+  void ResetCache();
+
   void PrintConfig();
 
  private:
@@ -104,8 +125,32 @@ class MCSignal : public TNamed
   std::vector<short> fCommonAncestorIdxs;
   int fTempAncestorLabel;
 
+  struct ProngDecision {
+    uint32_t fEpoch;    // cache epoch in which the decision was evaluated
+    bool fPass;         // prong decision, without the common ancestor check
+    int fAncestorLabel; // globalIndex() of the common ancestor candidate, -1 if not checked for this prong
+  };
+  std::vector<std::vector<ProngDecision>> fCache; //! cached decisions, per prong and MC particle
+  uint32_t fCacheEpoch;                           //! decisions from older epochs are not valid anymore
+  bool fCacheCheckSources;                        //! checkSources option used for the cached decisions
+
+  template <typename T>
+  bool CheckProng(int i, bool checkSources, const T& track, int& ancestorLabel);
   template <typename T>
-  bool CheckProng(int i, bool checkSources, const T& track);
+  bool CheckProngCached(int i, bool checkSources, const T& track, int& ancestorLabel);
+
+  // common ancestor check: the ancestor of every prong has to be the one found for the first prong
+  bool CheckCommonAncestor(int i, int ancestorLabel)
+  {
+    if (ancestorLabel < 0) {
+      return true;
+    }
+    if (i == 0) {
+      fTempAncestorLabel = ancestorLabel;
+      return true;
+    }
+    return ancestorLabel == fTempAncestorLabel;
+  }
 
   bool CheckMC(int, bool)
   {
@@ -116,16 +161,53 @@ class MCSignal : public TNamed
   bool CheckMC(int i, bool checkSources, const T& track, const Ts&... args)
   {
     // recursive call of CheckMC for all args
-    if (!CheckProng(i, checkSources, track)) {
+    int ancestorLabel = -1;
+    if (!CheckProng(i, checkSources, track, ancestorLabel) || !CheckCommonAncestor(i, ancestorLabel)) {
       return false;
     } else {
       return CheckMC(i + 1, checkSources, args...);
     }
   };
+
+  bool CheckMCCached(int, bool)
+  {
+    return true;
+  };
+
+  template <typename T, typename... Ts>
+  bool CheckMCCached(int i, bool checkSources, const T& track, const Ts&... args)
+  {
+    int ancestorLabel = -1;
+    if (!CheckProngCached(i, checkSources, track, ancestorLabel) || !CheckCommonAncestor(i, ancestorLabel)) {
+      return false;
+    }
+    return CheckMCCached(i + 1, checkSources, args...);
+  };
 };
 
 template <typename T>
-bool MCSignal::CheckProng(int i, bool checkSources, const T& track)
+bool MCSignal::CheckProngCached(int i, bool checkSources, const T& track, int& ancestorLabel)
+{
+  if (fCache.size() < fNProngs) {
+    fCache.resize(fNProngs);
+  }
+  std::vector<ProngDecision>& cache = fCache[i];
+  const auto index = track.globalIndex();
+  if (index >= static_cast<int64_t>(cache.size())) {
+    cache.resize(index + 1, {0, false, -1});
+  }
+  ProngDecision& decision = cache[index];
+  if (decision.fEpoch != fCacheEpoch) {
+    decision.fAncestorLabel = -1;
+    decision.fPass = CheckProng(i, checkSources, track, decision.fAncestorLabel);
+    decision.fEpoch = fCacheEpoch;
+  }
+  ancestorLabel = decision.fAncestorLabel;
+  return decision.fPass;
+}
+
+template <typename T>
+bool MCSignal::CheckProng(int i, bool checkSources, const T& track, int& ancestorLabel)
 {
   using P = typename T::parent_t;
   auto currentMCParticle = track;
@@ -210,15 +292,9 @@ bool MCSignal::CheckProng(int i, bool checkSources, const T& track)
     if (!fProngs[i].TestPDG(j, currentMCParticle.pdgCode())) {
       return false;
     }
-    // check the common ancestor (if specified)
+    // keep the common ancestor (if specified), to be checked against the ones of the other prongs
     if (fNProngs > 1 && fCommonAncestorIdxs[i] == j) {
-      if (i == 0) {
-        fTempAncestorLabel = currentMCParticle.globalIndex();
-      } else {
-        if (currentMCParticle.globalIndex() != fTempAncestorLabel) {
-          return false;
-        }
-      }
+      ancestorLabel = currentMCParticle.globalIndex();
     }
 
     // Update the currentMCParticle by moving either back in time (towards mothers, grandmothers, etc)
@@ -26,7 +26,10 @@ ClassImp(MixingHandler);
 MixingHandler::MixingHandler() : TNamed(),
                                  fIsInitialized(kFALSE),
                                  fVariableLimits(),
-                                 fVariables()
+                                 fVariables(),
+                                 fPoolDepth(100),
+                                 fPoolMaxTracks(100),
+                                 fEventPools()
 {
   //
   // default constructor
@@ -37,7 +40,10 @@ MixingHandler::MixingHandler() : TNamed(),
 MixingHandler::MixingHandler(const char* name, const char* title) : TNamed(name, title),
                                                                     fIsInitialized(kFALSE),
                                                                     fVariableLimits(),
-                                                                    fVariables()
+                                                                    fVariables(),
+                                                                    fPoolDepth(100),
+                                                                    fPoolMaxTracks(100),
+                                                                    fEventPools()
 {
   //
   // Named constructor
@@ -188,3 +194,71 @@ int MixingHandler::GetBinFromCategory(VarManager::Variables var, int category) c
   truncatedCategory /= norm;
   return truncatedCategory % (fVariableLimits[tempVar].GetSize() - 1);
 }
+
+//_________________________________________________________________________
+void MixingHandler::SetPoolDepth(int depth, int maxTracks)
+{
+  //
+  // set the capacity of the event pools; the pools already created are dropped
+  //
+  fPoolDepth = (depth > 0 ? depth : 1);
+  fPoolMaxTracks = (maxTracks > 0 ? maxTracks : 1);
+  fEventPools.clear();
+}
+
+//_________________________________________________________________________
+MixingHandler::EventPool& MixingHandler::GetEventPool(int category, int leg)
+{
+  //
+  // get the pool of events for the given category and leg, allocate it if this is the first request
+  //
+  auto key = std::make_pair(category, leg);
+  auto pool = fEventPools.find(key);
+  if (pool == fEventPools.end()) {
+    pool = fEventPools.emplace(key, EventPool(fPoolDepth, fPoolMaxTracks)).first;
+  }
+  return pool->second;
+}
+
+//_________________________________________________________________________
+MixingHandler::EventPool::EventPool(int depth, int maxTracks) : fDepth(depth),
+                                                                fMaxTracks(maxTracks),
+                                                                fNEvents(0),
+                                                                fLast(-1),
+                                                                fNTracks(depth, 0),
+                                                                fPt(depth * maxTracks),
+                                                                fEta(depth * maxTracks),
+                                                                fPhi(depth * maxTracks),
+                                                                fSign(depth * maxTracks),
+                                                                fFilter(depth * maxTracks)
+{
+}
+
+//_________________________________________________________________________
+void MixingHandler::EventPool::AddEvent()
+{
+  //
+  // move to the next slot of the ring buffer
+  //
+  fLast = (fLast + 1) % fDepth;
+  fNTracks[fLast] = 0;
+  if (fNEvents < fDepth) {
+    fNEvents++;
+  }
+}
+
+//_________________________________________________________________________
+bool MixingHandler::EventPool::AddTrack(float pt, float eta, float phi, int sign, uint32_t filter)
+{
+  if (fLast < 0 || fNTracks[fLast] == fMaxTracks) {
+    return false;
+  }
+  int i = fLast * fMaxTracks + fNTracks[fLast];
+  fPt[i] = pt;
+  fEta[i] = eta;
+  fPhi[i] = phi;
+  fSign[i] = sign;
+  fFilter[i] = filter;
+  fNTracks[fLast]++;
+  return true;
+}
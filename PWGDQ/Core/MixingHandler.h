@@ -23,6 +23,10 @@
 #include <TClonesArray.h>
 #include <TList.h>
 #include <TString.h>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
 
 #include "PWGDQ/Core/HistogramManager.h"
 #include "PWGDQ/Core/VarManager.h"
@@ -48,6 +52,54 @@ class MixingHandler : public TNamed
   int FindEventCategory(float* values);
   int GetBinFromCategory(VarManager::Variables var, int category) const;
 
+  // Compact record of a track stored for mixing, with the accessors needed by VarManager::FillPairME() / FillPairVn()
+  struct PoolTrack {
+    float fPt;
+    float fEta;
+    float fPhi;
+    int fSign;
+    uint32_t fFilter; // selection bit map of the track
+    float pt() const { return fPt; }
+    float eta() const { return fEta; }
+    float phi() const { return fPhi; }
+    int sign() const { return fSign; }
+  };
+
+  // Events stored for mixing in one event category: a ring buffer holding the last "depth" events, with at most "maxTracks"
+  //   tracks per event. The tracks are stored as structure of arrays, allocated once for the full capacity of the pool.
+  class EventPool
+  {
+   public:
+    EventPool(int depth, int maxTracks);
+
+    int GetNEvents() const { return fNEvents; }
+    int GetNTracks(int event) const { return fNTracks[event]; }
+    PoolTrack GetTrack(int event, int track) const
+    {
+      int i = event * fMaxTracks + track;
+      return {fPt[i], fEta[i], fPhi[i], fSign[i], fFilter[i]};
+    }
+
+    void AddEvent();                                                          // start a new event, overwriting the oldest one if the pool is full
+    bool AddTrack(float pt, float eta, float phi, int sign, uint32_t filter); // add a track to the last event; false if the event is full
+
+   private:
+    int fDepth;     // maximum number of events
+    int fMaxTracks; // maximum number of tracks per event
+    int fNEvents;   // number of stored events
+    int fLast;      // slot of the last added event
+    std::vector<int> fNTracks;
+    std::vector<float> fPt;
+    std::vector<float> fEta;
+    std::vector<float> fPhi;
+    std::vector<int8_t> fSign;
+    std::vector<uint32_t> fFilter;
+  };
+
+  void SetPoolDepth(int depth, int maxTracks);
+  EventPool& GetEventPool(int category, int leg = 0); // leg: index of the kind of tracks stored (e.g. barrel tracks and muons)
+  void ClearEventPools() { fEventPools.clear(); }
+
  private:
   MixingHandler(const MixingHandler& handler);
   MixingHandler& operator=(const MixingHandler& handler);
@@ -58,6 +110,10 @@ class MixingHandler : public TNamed
   std::vector<TArrayF> fVariableLimits;
   std::vector<int> fVariables;
 
+  int fPoolDepth;                                        //! number of events stored per event category
+  int fPoolMaxTracks;                                    //! maximum number of tracks stored per event
+  std::map<std::pair<int, int>, EventPool> fEventPools; //! event pools, per category and leg, created when first requested
+
   ClassDef(MixingHandler, 1);
 };
 
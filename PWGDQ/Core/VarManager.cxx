@@ -28,6 +28,10 @@ o2::vertexing::DCAFitterN<2> VarManager::fgFitterTwoProngBarrel;
 o2::vertexing::DCAFitterN<3> VarManager::fgFitterThreeProngBarrel;
 o2::vertexing::FwdDCAFitterN<2> VarManager::fgFitterTwoProngFwd;
 o2::vertexing::FwdDCAFitterN<3> VarManager::fgFitterThreeProngFwd;
+std::vector<VarManager::FwdTrackCacheEntry> VarManager::fgFwdTrackCache;
+VarManager::KFPVCacheEntry VarManager::fgKFPVCache;
+float VarManager::fgFwdVertexingMaxDCA = -1.0f;
+thread_local VarManager::VarContext* VarManager::fgContext = nullptr;
 std::map<VarManager::CalibObjects, TObject*> VarManager::fgCalibs;
 bool VarManager::fgRunTPCPostCalibration[4] = {false, false, false, false};
 
@@ -43,6 +47,47 @@ VarManager::VarManager() : TObject()
 //__________________________________________________________________
 VarManager::~VarManager() = default;
 
+//__________________________________________________________________
+VarManager::VarContext::VarContext() : fValues{0.0f},
+                                       fFitterTwoProngBarrel(FitterTwoProngBarrel()),
+                                       fFitterThreeProngBarrel(FitterThreeProngBarrel()),
+                                       fFitterTwoProngFwd(FitterTwoProngFwd()),
+                                       fFitterThreeProngFwd(FitterThreeProngFwd())
+{
+  //
+  // constructor
+  //
+}
+
+//__________________________________________________________________
+float VarManager::GetFwdPairDCAProxy(const o2::track::TrackParCovFwd& t1, const o2::track::TrackParCovFwd& t2)
+{
+  //
+  // Distance of closest approach of two forward tracks, approximated with straight lines in the transverse plane
+  //   r_i(z) = r_i + s_i * (z - z_i), with the slopes s_i = (cos(phi_i), sin(phi_i)) / tgl_i.
+  // The distance between the lines is minimized w.r.t. z, starting from their separation at the z of the first track
+  //
+  if (t1.getTgl() == 0. || t2.getTgl() == 0.) {
+    return 0.;
+  }
+  double sx1 = std::cos(t1.getPhi()) / t1.getTgl();
+  double sy1 = std::sin(t1.getPhi()) / t1.getTgl();
+  double sx2 = std::cos(t2.getPhi()) / t2.getTgl();
+  double sy2 = std::sin(t2.getPhi()) / t2.getTgl();
+  double dz = t1.getZ() - t2.getZ();
+  double dx = t1.getX() - (t2.getX() + sx2 * dz);
+  double dy = t1.getY() - (t2.getY() + sy2 * dz);
+  double dsx = sx1 - sx2;
+  double dsy = sy1 - sy2;
+  double ds2 = dsx * dsx + dsy * dsy;
+  if (ds2 > 0.) {
+    double step = -(dx * dsx + dy * dsy) / ds2;
+    dx += step * dsx;
+    dy += step * dsy;
+  }
+  return std::sqrt(dx * dx + dy * dy);
+}
+
 //__________________________________________________________________
 void VarManager::SetVariableDependencies()
 {
@@ -83,7 +128,7 @@ void VarManager::ResetValues(int startValue, int endValue, float* values)
   // reset all variables to an "innocent" value
   // NOTE: here we use -9999.0 as a neutral value, but depending on situation, this may not be the case
   if (!values) {
-    values = fgValues;
+    values = GetValues();
   }
   for (Int_t i = startValue; i < endValue; ++i) {
     values[i] = -9999.;
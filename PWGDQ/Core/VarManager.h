@@ -60,6 +60,32 @@ using SMatrix5 = ROOT::Math::SVector<double, 5>;
 using Vec3D = ROOT::Math::SVector<double, 3>;
 using namespace o2::constants::physics;
 
+//_________________________________________________________________________
+// Compile-time set of variables, to be given to the Fill functions of the VarManager
+//   The computations of the variables which are not in the set are compiled out; for the variables in the set
+//   the run-time selection based on the used variables still applies.
+//   Example: using MyPairVars = VarSet<VarManager::kMass, VarManager::kPt, VarManager::kEta, VarManager::kPhi, VarManager::kVertexingTauz>;
+//            VarManager::FillPair<pairType, fillMap, MyPairVars>(t1, t2);
+template <int... vars>
+struct VarSet {
+  static constexpr bool contains(int var) { return ((var == vars) || ...); }
+  template <typename F>
+  static constexpr bool any(F predicate)
+  {
+    return (predicate(vars) || ...);
+  }
+};
+
+// Set of all the variables (default): the variables are selected at run-time only
+struct AllVars {
+  static constexpr bool contains(int) { return true; }
+  template <typename F>
+  static constexpr bool any(F)
+  {
+    return true;
+  }
+};
+
 //_________________________________________________________________________
 class VarManager : public TObject
 {
@@ -443,6 +469,18 @@ class VarManager : public TObject
     return false;
   }
 
+  // Whether the variable is requested both by the compile-time set and at run-time
+  template <typename TVars>
+  static bool IsUsed(int var)
+  {
+    return TVars::contains(var) && fgUsedVars[var];
+  }
+  // Whether the variable is computed by FillPairVertexing
+  static constexpr bool IsVertexingVariable(int var)
+  {
+    return (var == kKFMass) || (var == kUsedKF) || (var >= kVertexingLxy && var <= kVertexingChi2PCA) || (var >= kVertexingLxyOverErr && var <= kKFCosPA);
+  }
+
   static void SetRunNumbers(int n, int* runs);
   static void SetRunNumbers(std::vector<int> runs);
   static float GetRunIndex(double);
@@ -466,42 +504,49 @@ class VarManager : public TObject
   // Setup the 2 prong DCAFitterN
   static void SetupTwoProngDCAFitter(float magField, bool propagateToPCA, float maxR, float maxDZIni, float minParamChange, float minRelChi2Change, bool useAbsDCA)
   {
-    fgFitterTwoProngBarrel.setBz(magField);
-    fgFitterTwoProngBarrel.setPropagateToPCA(propagateToPCA);
-    fgFitterTwoProngBarrel.setMaxR(maxR);
-    fgFitterTwoProngBarrel.setMaxDZIni(maxDZIni);
-    fgFitterTwoProngBarrel.setMinParamChange(minParamChange);
-    fgFitterTwoProngBarrel.setMinRelChi2Change(minRelChi2Change);
-    fgFitterTwoProngBarrel.setUseAbsDCA(useAbsDCA);
+    FitterTwoProngBarrel().setBz(magField);
+    FitterTwoProngBarrel().setPropagateToPCA(propagateToPCA);
+    FitterTwoProngBarrel().setMaxR(maxR);
+    FitterTwoProngBarrel().setMaxDZIni(maxDZIni);
+    FitterTwoProngBarrel().setMinParamChange(minParamChange);
+    FitterTwoProngBarrel().setMinRelChi2Change(minRelChi2Change);
+    FitterTwoProngBarrel().setUseAbsDCA(useAbsDCA);
     fgUsedKF = false;
   }
 
   // Setup the 2 prong FwdDCAFitterN
   static void SetupTwoProngFwdDCAFitter(float magField, bool propagateToPCA, float maxR, float minParamChange, float minRelChi2Change, bool useAbsDCA)
   {
-    fgFitterTwoProngFwd.setBz(magField);
-    fgFitterTwoProngFwd.setPropagateToPCA(propagateToPCA);
-    fgFitterTwoProngFwd.setMaxR(maxR);
-    fgFitterTwoProngFwd.setMinParamChange(minParamChange);
-    fgFitterTwoProngFwd.setMinRelChi2Change(minRelChi2Change);
-    fgFitterTwoProngFwd.setUseAbsDCA(useAbsDCA);
+    FitterTwoProngFwd().setBz(magField);
+    FitterTwoProngFwd().setPropagateToPCA(propagateToPCA);
+    FitterTwoProngFwd().setMaxR(maxR);
+    FitterTwoProngFwd().setMinParamChange(minParamChange);
+    FitterTwoProngFwd().setMinRelChi2Change(minRelChi2Change);
+    FitterTwoProngFwd().setUseAbsDCA(useAbsDCA);
     fgUsedKF = false;
   }
   // Use MatLayerCylSet to correct MCS in fwdtrack propagation
   static void SetupMatLUTFwdDCAFitter(o2::base::MatLayerCylSet* m)
   {
-    fgFitterTwoProngFwd.setTGeoMat(false);
-    fgFitterTwoProngFwd.setMatLUT(m);
+    FitterTwoProngFwd().setTGeoMat(false);
+    FitterTwoProngFwd().setMatLUT(m);
   }
   // Use GeometryManager to correct MCS in fwdtrack propagation
   static void SetupTGeoFwdDCAFitter()
   {
-    fgFitterTwoProngFwd.setTGeoMat(true);
+    FitterTwoProngFwd().setTGeoMat(true);
   }
   // No material budget in fwdtrack propagation
   static void SetupFwdDCAFitterNoCorr()
   {
-    fgFitterTwoProngFwd.setTGeoMat(false);
+    FitterTwoProngFwd().setTGeoMat(false);
+  }
+  // Preselection of the muon pairs sent to the FwdDCAFitterN: the pairs with a distance of closest approach, estimated with
+  //   a straight line extrapolation of the muon tracks, larger than maxDCA (cm) are not fitted (kVertexingProcCode = 0).
+  //   The preselection is disabled for a negative maxDCA
+  static void SetupFwdDCAFitterPreselection(float maxDCA)
+  {
+    fgFwdVertexingMaxDCA = maxDCA;
   }
 
   static auto getEventPlane(int harm, float qnxa, float qnya)
@@ -512,17 +557,17 @@ class VarManager : public TObject
 
   template <uint32_t fillMap, typename T>
   static void FillEvent(T const& event, float* values = nullptr);
-  template <uint32_t fillMap, typename T>
+  template <uint32_t fillMap, typename TVars = AllVars, typename T>
   static void FillTrack(T const& track, float* values = nullptr);
   template <typename U, typename T>
   static void FillTrackMC(const U& mcStack, T const& track, float* values = nullptr);
-  template <int pairType, uint32_t fillMap, typename T1, typename T2>
+  template <int pairType, uint32_t fillMap, typename TVars = AllVars, typename T1, typename T2>
   static void FillPair(T1 const& t1, T2 const& t2, float* values = nullptr);
   template <int pairType, typename T1, typename T2>
   static void FillPairME(T1 const& t1, T2 const& t2, float* values = nullptr);
   template <typename T1, typename T2>
   static void FillPairMC(T1 const& t1, T2 const& t2, float* values = nullptr, PairCandidateType pairType = kDecayToEE);
-  template <int pairType, uint32_t collFillMap, uint32_t fillMap, typename C, typename T>
+  template <int pairType, uint32_t collFillMap, uint32_t fillMap, typename TVars = AllVars, typename C, typename T>
   static void FillPairVertexing(C const& collision, T const& t1, T const& t2, float* values = nullptr);
   template <int candidateType, uint32_t collFillMap, uint32_t fillMap, typename C, typename T1>
   static void FillDileptonTrackVertexing(C const& collision, T1 const& lepton1, T1 const& lepton2, T1 const& track, float* values);
@@ -569,6 +614,39 @@ class VarManager : public TObject
   static float fgValues[kNVars]; // array holding all variables computed during analysis
   static void ResetValues(int startValue = 0, int endValue = kNVars, float* values = nullptr);
 
+  // Instance-scoped state of the variable filling: the values array and the vertexers.
+  // A context can be created for each worker thread and made current in that thread with SetContext():
+  //   the static API then fills its values and runs its vertexers instead of the global fgValues and fitters.
+  //   The used variables, calibration objects and run lists are configured once and only read while filling, so they stay shared.
+  // Forward track parameters of a muon, built once and reused by all the pairs the muon is part of
+  struct FwdTrackCacheEntry {
+    int64_t fIndex = -1;                // global index of the muon, -1 for an empty entry
+    o2::track::TrackParCovFwd fTrack{}; // track parameters and covariance at the z of the muon
+  };
+  static constexpr int kFwdTrackCacheSize = 1024; // number of entries of the (direct-mapped) forward track cache
+  // Primary vertex of a collision as a KFParticle, built once and reused by all the pairs of the collision
+  struct KFPVCacheEntry {
+    int64_t fIndex = -1;    // global index of the collision, -1 for an empty entry
+    int fNContributors = 0; // number of contributors of the KFPVertex
+    KFParticle fPV{};       // primary vertex
+  };
+
+  struct VarContext {
+    VarContext(); // the vertexers are copied from the ones of the current thread, configured with the Setup*() functions
+    float fValues[kNVars];
+    o2::vertexing::DCAFitterN<2> fFitterTwoProngBarrel;
+    o2::vertexing::DCAFitterN<3> fFitterThreeProngBarrel;
+    o2::vertexing::FwdDCAFitterN<2> fFitterTwoProngFwd;
+    o2::vertexing::FwdDCAFitterN<3> fFitterThreeProngFwd;
+    std::vector<FwdTrackCacheEntry> fFwdTrackCache; // allocated at the first use
+    KFPVCacheEntry fKFPVCache;
+  };
+  // Set the context used by the static API in the current thread, nullptr to use the global one
+  static void SetContext(VarContext* context) { fgContext = context; }
+  static VarContext* GetContext() { return fgContext; }
+  // Values array of the current context, fgValues if no context is set
+  static float* GetValues() { return fgContext ? fgContext->fValues : fgValues; }
+
  private:
   static bool fgUsedVars[kNVars]; // holds flags for when the corresponding variable is needed (e.g., in the histogram manager, in cuts, mixing handler, etc.)
   static bool fgUsedKF;
@@ -587,11 +665,28 @@ class VarManager : public TObject
   template <typename T>
   static KFPVertex createKFPVertexFromCollision(const T& collision);
   static float calculateCosPA(KFParticle kfp, KFParticle PV);
+  template <typename C>
+  static const KFPVCacheEntry& GetCachedKFPV(C const& collision);
+  template <typename T>
+  static const o2::track::TrackParCovFwd& GetCachedFwdTrack(T const& muon);
+  static float GetFwdPairDCAProxy(const o2::track::TrackParCovFwd& t1, const o2::track::TrackParCovFwd& t2);
 
   static o2::vertexing::DCAFitterN<2> fgFitterTwoProngBarrel;
   static o2::vertexing::DCAFitterN<3> fgFitterThreeProngBarrel;
   static o2::vertexing::FwdDCAFitterN<2> fgFitterTwoProngFwd;
   static o2::vertexing::FwdDCAFitterN<3> fgFitterThreeProngFwd;
+  static std::vector<FwdTrackCacheEntry> fgFwdTrackCache; // forward track cache used when no context is set
+  static KFPVCacheEntry fgKFPVCache;                      // primary vertex cache used when no context is set
+  static float fgFwdVertexingMaxDCA;                      // straight line DCA preselection of the muon pairs to be fitted, disabled if negative
+
+  static thread_local VarContext* fgContext; // context of the current thread, nullptr for the global one
+
+  static o2::vertexing::DCAFitterN<2>& FitterTwoProngBarrel() { return fgContext ? fgContext->fFitterTwoProngBarrel : fgFitterTwoProngBarrel; }
+  static o2::vertexing::DCAFitterN<3>& FitterThreeProngBarrel() { return fgContext ? fgContext->fFitterThreeProngBarrel : fgFitterThreeProngBarrel; }
+  static o2::vertexing::FwdDCAFitterN<2>& FitterTwoProngFwd() { return fgContext ? fgContext->fFitterTwoProngFwd : fgFitterTwoProngFwd; }
+  static std::vector<FwdTrackCacheEntry>& FwdTrackCache() { return fgContext ? fgContext->fFwdTrackCache : fgFwdTrackCache; }
+  static KFPVCacheEntry& KFPVCache() { return fgContext ? fgContext->fKFPVCache : fgKFPVCache; }
+  static o2::vertexing::FwdDCAFitterN<3>& FitterThreeProngFwd() { return fgContext ? fgContext->fFitterThreeProngFwd : fgFitterThreeProngFwd; }
 
   static std::map<CalibObjects, TObject*> fgCalibs; // map of calibration histograms
   static bool fgRunTPCPostCalibration[4];           // 0-electron, 1-pion, 2-kaon, 3-proton
@@ -662,7 +757,7 @@ template <uint32_t fillMap, typename T>
 void VarManager::FillEvent(T const& event, float* values)
 {
   if (!values) {
-    values = fgValues;
+    values = GetValues();
   }
 
   if constexpr ((fillMap & CollisionTimestamp) > 0) {
@@ -849,26 +944,26 @@ void VarManager::FillEvent(T const& event, float* values)
   FillEventDerived(values);
 }
 
-template <uint32_t fillMap, typename T>
+template <uint32_t fillMap, typename TVars, typename T>
 void VarManager::FillTrack(T const& track, float* values)
 {
   if (!values) {
-    values = fgValues;
+    values = GetValues();
   }
 
   // Quantities based on the basic table (contains just kine information and filter bits)
   if constexpr ((fillMap & Track) > 0 || (fillMap & Muon) > 0 || (fillMap & ReducedTrack) > 0 || (fillMap & ReducedMuon) > 0) {
     values[kPt] = track.pt();
-    if (fgUsedVars[kPx]) {
+    if (IsUsed<TVars>(kPx)) {
       values[kPx] = track.px();
     }
-    if (fgUsedVars[kPy]) {
+    if (IsUsed<TVars>(kPy)) {
       values[kPy] = track.py();
     }
-    if (fgUsedVars[kPz]) {
+    if (IsUsed<TVars>(kPz)) {
       values[kPz] = track.pz();
     }
-    if (fgUsedVars[kInvPt]) {
+    if (IsUsed<TVars>(kInvPt)) {
       values[kInvPt] = 1. / track.pt();
     }
     values[kEta] = track.eta();
@@ -897,34 +992,34 @@ void VarManager::FillTrack(T const& track, float* values)
   // Quantities based on the barrel tables
   if constexpr ((fillMap & TrackExtra) > 0 || (fillMap & ReducedTrackBarrel) > 0) {
     values[kPin] = track.tpcInnerParam();
-    if (fgUsedVars[kIsITSrefit]) {
+    if (IsUsed<TVars>(kIsITSrefit)) {
       values[kIsITSrefit] = (track.flags() & o2::aod::track::ITSrefit) > 0; // NOTE: This is just for Run-2
     }
-    if (fgUsedVars[kTrackTimeResIsRange]) {
+    if (IsUsed<TVars>(kTrackTimeResIsRange)) {
       values[kTrackTimeResIsRange] = (track.flags() & o2::aod::track::TrackTimeResIsRange) > 0; // NOTE: This is NOT for Run-2
     }
-    if (fgUsedVars[kIsTPCrefit]) {
+    if (IsUsed<TVars>(kIsTPCrefit)) {
       values[kIsTPCrefit] = (track.flags() & o2::aod::track::TPCrefit) > 0; // NOTE: This is just for Run-2
     }
-    if (fgUsedVars[kPVContributor]) {
+    if (IsUsed<TVars>(kPVContributor)) {
       values[kPVContributor] = (track.flags() & o2::aod::track::PVContributor) > 0; // NOTE: This is NOT for Run-2
     }
-    if (fgUsedVars[kIsGoldenChi2]) {
+    if (IsUsed<TVars>(kIsGoldenChi2)) {
       values[kIsGoldenChi2] = (track.flags() & o2::aod::track::GoldenChi2) > 0; // NOTE: This is just for Run-2
     }
-    if (fgUsedVars[kOrphanTrack]) {
+    if (IsUsed<TVars>(kOrphanTrack)) {
       values[kOrphanTrack] = (track.flags() & o2::aod::track::OrphanTrack) > 0; // NOTE: This is NOT for Run-2
     }
-    if (fgUsedVars[kIsSPDfirst]) {
+    if (IsUsed<TVars>(kIsSPDfirst)) {
       values[kIsSPDfirst] = (track.itsClusterMap() & uint8_t(1)) > 0;
     }
-    if (fgUsedVars[kIsSPDboth]) {
+    if (IsUsed<TVars>(kIsSPDboth)) {
       values[kIsSPDboth] = (track.itsClusterMap() & uint8_t(3)) > 0;
     }
-    if (fgUsedVars[kIsSPDany]) {
+    if (IsUsed<TVars>(kIsSPDany)) {
       values[kIsSPDany] = (track.itsClusterMap() & uint8_t(1)) || (track.itsClusterMap() & uint8_t(2));
     }
-    if (fgUsedVars[kITSClusterMap]) {
+    if (IsUsed<TVars>(kITSClusterMap)) {
       values[kITSClusterMap] = track.itsClusterMap();
     }
     values[kTrackTime] = track.trackTime();
@@ -948,12 +1043,12 @@ void VarManager::FillTrack(T const& track, float* values)
     values[kHasTPC] = track.hasTPC();
 
     if constexpr ((fillMap & TrackExtra) > 0) {
-      if (fgUsedVars[kITSncls]) {
+      if (IsUsed<TVars>(kITSncls)) {
         values[kITSncls] = track.itsNCls(); // dynamic column
       }
     }
     if constexpr ((fillMap & ReducedTrackBarrel) > 0) {
-      if (fgUsedVars[kITSncls]) {
+      if (IsUsed<TVars>(kITSncls)) {
         values[kITSncls] = 0.0;
         for (int i = 0; i < 7; ++i) {
           values[kITSncls] += ((track.itsClusterMap() & (1 << i)) ? 1 : 0);
@@ -962,16 +1057,16 @@ void VarManager::FillTrack(T const& track, float* values)
       values[kTrackDCAxy] = track.dcaXY();
       values[kTrackDCAz] = track.dcaZ();
       if constexpr ((fillMap & ReducedTrackBarrelCov) > 0) {
-        if (fgUsedVars[kTrackDCAsigXY]) {
+        if (IsUsed<TVars>(kTrackDCAsigXY)) {
           values[kTrackDCAsigXY] = track.dcaXY() / std::sqrt(track.cYY());
         }
-        if (fgUsedVars[kTrackDCAsigZ]) {
+        if (IsUsed<TVars>(kTrackDCAsigZ)) {
           values[kTrackDCAsigZ] = track.dcaZ() / std::sqrt(track.cZZ());
         }
-        if (fgUsedVars[kTrackDCAresXY]) {
+        if (IsUsed<TVars>(kTrackDCAresXY)) {
           values[kTrackDCAresXY] = std::sqrt(track.cYY());
         }
-        if (fgUsedVars[kTrackDCAresZ]) {
+        if (IsUsed<TVars>(kTrackDCAresZ)) {
           values[kTrackDCAresZ] = std::sqrt(track.cZZ());
         }
       }
@@ -983,16 +1078,16 @@ void VarManager::FillTrack(T const& track, float* values)
     values[kTrackDCAxy] = track.dcaXY();
     values[kTrackDCAz] = track.dcaZ();
     if constexpr ((fillMap & TrackCov) > 0) {
-      if (fgUsedVars[kTrackDCAsigXY]) {
+      if (IsUsed<TVars>(kTrackDCAsigXY)) {
         values[kTrackDCAsigXY] = track.dcaXY() / std::sqrt(track.cYY());
       }
-      if (fgUsedVars[kTrackDCAsigZ]) {
+      if (IsUsed<TVars>(kTrackDCAsigZ)) {
         values[kTrackDCAsigZ] = track.dcaZ() / std::sqrt(track.cZZ());
       }
-      if (fgUsedVars[kTrackDCAresXY]) {
+      if (IsUsed<TVars>(kTrackDCAresXY)) {
         values[kTrackDCAresXY] = std::sqrt(track.cYY());
       }
-      if (fgUsedVars[kTrackDCAresZ]) {
+      if (IsUsed<TVars>(kTrackDCAresZ)) {
         values[kTrackDCAresZ] = std::sqrt(track.cZZ());
       }
     }
@@ -1028,7 +1123,7 @@ void VarManager::FillTrack(T const& track, float* values)
     values[kTPCnSigmaPr] = track.tpcNSigmaPr();
 
     // compute TPC postcalibrated electron nsigma based on calibration histograms from CCDB
-    if (fgUsedVars[kTPCnSigmaEl_Corr] && fgRunTPCPostCalibration[0]) {
+    if (IsUsed<TVars>(kTPCnSigmaEl_Corr) && fgRunTPCPostCalibration[0]) {
       TH3F* calibMean = reinterpret_cast<TH3F*>(fgCalibs[kTPCElectronMean]);
       TH3F* calibSigma = reinterpret_cast<TH3F*>(fgCalibs[kTPCElectronSigma]);
 
@@ -1047,7 +1142,7 @@ void VarManager::FillTrack(T const& track, float* values)
       values[kTPCnSigmaEl_Corr] = (values[kTPCnSigmaEl] - mean) / width;
     }
     // compute TPC postcalibrated pion nsigma if required
-    if (fgUsedVars[kTPCnSigmaPi_Corr] && fgRunTPCPostCalibration[1]) {
+    if (IsUsed<TVars>(kTPCnSigmaPi_Corr) && fgRunTPCPostCalibration[1]) {
       TH3F* calibMean = reinterpret_cast<TH3F*>(fgCalibs[kTPCPionMean]);
       TH3F* calibSigma = reinterpret_cast<TH3F*>(fgCalibs[kTPCPionSigma]);
 
@@ -1065,7 +1160,7 @@ void VarManager::FillTrack(T const& track, float* values)
       double width = calibSigma->GetBinContent(binTPCncls, binPin, binEta);
       values[kTPCnSigmaPi_Corr] = (values[kTPCnSigmaPi] - mean) / width;
     }
-    if (fgUsedVars[kTPCnSigmaKa_Corr] && fgRunTPCPostCalibration[2]) {
+    if (IsUsed<TVars>(kTPCnSigmaKa_Corr) && fgRunTPCPostCalibration[2]) {
       TH3F* calibMean = reinterpret_cast<TH3F*>(fgCalibs[kTPCKaonMean]);
       TH3F* calibSigma = reinterpret_cast<TH3F*>(fgCalibs[kTPCKaonSigma]);
 
@@ -1084,7 +1179,7 @@ void VarManager::FillTrack(T const& track, float* values)
       values[kTPCnSigmaKa_Corr] = (values[kTPCnSigmaKa] - mean) / width;
     }
     // compute TPC postcalibrated proton nsigma if required
-    if (fgUsedVars[kTPCnSigmaPr_Corr] && fgRunTPCPostCalibration[3]) {
+    if (IsUsed<TVars>(kTPCnSigmaPr_Corr) && fgRunTPCPostCalibration[3]) {
       TH3F* calibMean = reinterpret_cast<TH3F*>(fgCalibs[kTPCProtonMean]);
       TH3F* calibSigma = reinterpret_cast<TH3F*>(fgCalibs[kTPCProtonSigma]);
 
@@ -1107,7 +1202,7 @@ void VarManager::FillTrack(T const& track, float* values)
     values[kTOFnSigmaKa] = track.tofNSigmaKa();
     values[kTOFnSigmaPr] = track.tofNSigmaPr();
 
-    if (fgUsedVars[kTPCsignalRandomized] || fgUsedVars[kTPCnSigmaElRandomized] || fgUsedVars[kTPCnSigmaPiRandomized] || fgUsedVars[kTPCnSigmaPrRandomized]) {
+    if (IsUsed<TVars>(kTPCsignalRandomized) || IsUsed<TVars>(kTPCnSigmaElRandomized) || IsUsed<TVars>(kTPCnSigmaPiRandomized) || IsUsed<TVars>(kTPCnSigmaPrRandomized)) {
       // NOTE: this is needed temporarily for the study of the impact of TPC pid degradation on the quarkonium triggers in high lumi pp
       //     This study involves a degradation from a dE/dx resolution of 5% to one of 6% (20% worsening)
       //     For this we smear the dE/dx and n-sigmas using a gaus distribution with a width of 3.3%
@@ -1183,7 +1278,7 @@ template <typename U, typename T>
 void VarManager::FillTrackMC(const U& mcStack, T const& track, float* values)
 {
   if (!values) {
-    values = fgValues;
+    values = GetValues();
   }
 
   // Quantities based on the mc particle table
@@ -1209,11 +1304,11 @@ void VarManager::FillTrackMC(const U& mcStack, T const& track, float* values)
   FillTrackDerived(values);
 }
 
-template <int pairType, uint32_t fillMap, typename T1, typename T2>
+template <int pairType, uint32_t fillMap, typename TVars, typename T1, typename T2>
 void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
 {
   if (!values) {
-    values = fgValues;
+    values = GetValues();
   }
 
   float m1 = MassElectron;
@@ -1239,30 +1334,33 @@ void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
   values[kPt] = v12.Pt();
   values[kEta] = v12.Eta();
   values[kPhi] = v12.Phi();
-  values[kRap] = -v12.Rapidity();
-  double Ptot1 = TMath::Sqrt(v1.Px() * v1.Px() + v1.Py() * v1.Py() + v1.Pz() * v1.Pz());
-  double Ptot2 = TMath::Sqrt(v2.Px() * v2.Px() + v2.Py() * v2.Py() + v2.Pz() * v2.Pz());
-  values[kDeltaPtotTracks] = Ptot1 - Ptot2;
+  if constexpr (TVars::contains(kRap)) {
+    values[kRap] = -v12.Rapidity();
+  }
+  if constexpr (TVars::contains(kDeltaPtotTracks)) {
+    double Ptot1 = TMath::Sqrt(v1.Px() * v1.Px() + v1.Py() * v1.Py() + v1.Pz() * v1.Pz());
+    double Ptot2 = TMath::Sqrt(v2.Px() * v2.Px() + v2.Py() * v2.Py() + v2.Pz() * v2.Pz());
+    values[kDeltaPtotTracks] = Ptot1 - Ptot2;
+  }
 
-  if (fgUsedVars[kPsiPair]) {
+  if (IsUsed<TVars>(kPsiPair)) {
     values[kDeltaPhiPair] = (t1.sign() > 0) ? (v1.Phi() - v2.Phi()) : (v2.Phi() - v1.Phi());
     double xipair = TMath::ACos((v1.Px() * v2.Px() + v1.Py() * v2.Py() + v1.Pz() * v2.Pz()) / v1.P() / v2.P());
     values[kPsiPair] = (t1.sign() > 0) ? TMath::ASin((v1.Theta() - v2.Theta()) / xipair) : TMath::ASin((v2.Theta() - v1.Theta()) / xipair);
   }
 
   // CosTheta Helicity calculation
-  ROOT::Math::Boost boostv12{v12.BoostToCM()};
-  ROOT::Math::XYZVectorF v1_CM{(boostv12(v1).Vect()).Unit()};
-  ROOT::Math::XYZVectorF v2_CM{(boostv12(v2).Vect()).Unit()};
-  ROOT::Math::XYZVectorF zaxis{(v12.Vect()).Unit()};
-
-  if (fgUsedVars[kCosThetaHE]) {
+  if (IsUsed<TVars>(kCosThetaHE)) {
+    ROOT::Math::Boost boostv12{v12.BoostToCM()};
+    ROOT::Math::XYZVectorF v1_CM{(boostv12(v1).Vect()).Unit()};
+    ROOT::Math::XYZVectorF v2_CM{(boostv12(v2).Vect()).Unit()};
+    ROOT::Math::XYZVectorF zaxis{(v12.Vect()).Unit()};
     values[kCosThetaHE] = (t1.sign() > 0 ? zaxis.Dot(v1_CM) : zaxis.Dot(v2_CM));
   }
 
   if constexpr ((pairType == kDecayToEE) && ((fillMap & TrackCov) > 0 || (fillMap & ReducedTrackBarrelCov) > 0)) {
 
-    if (fgUsedVars[kQuadDCAabsXY] || fgUsedVars[kQuadDCAsigXY] || fgUsedVars[kQuadDCAabsZ] || fgUsedVars[kQuadDCAsigZ] || fgUsedVars[kQuadDCAsigXYZ]) {
+    if (IsUsed<TVars>(kQuadDCAabsXY) || IsUsed<TVars>(kQuadDCAsigXY) || IsUsed<TVars>(kQuadDCAabsZ) || IsUsed<TVars>(kQuadDCAsigZ) || IsUsed<TVars>(kQuadDCAsigXYZ)) {
       // Quantities based on the barrel tables
       double dca1XY = t1.dcaXY();
       double dca2XY = t2.dcaXY();
@@ -1293,14 +1391,14 @@ void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
       }
     }
   }
-  if (fgUsedVars[kPairPhiv]) {
+  if (IsUsed<TVars>(kPairPhiv)) {
     // cos(phiv) = w*a /|w||a|
     // with w = u x v
     // and  a = u x z / |u x z|   , unit vector perpendicular to v12 and z-direction (magnetic field)
     // u = v12 / |v12|            , the unit vector of v12
     // v = v1 x v2 / |v1 x v2|    , unit vector perpendicular to v1 and v2
 
-    float bz = fgFitterTwoProngBarrel.getBz();
+    float bz = FitterTwoProngBarrel().getBz();
 
     bool swapTracks = false;
     if (v1.Pt() < v2.Pt()) { // ordering of track, pt1 > pt2
@@ -1391,7 +1489,7 @@ void VarManager::FillPairME(T1 const& t1, T2 const& t2, float* values)
   // Lightweight fill function called from the innermost event mixing loop
   //
   if (!values) {
-    values = fgValues;
+    values = GetValues();
   }
 
   float m1 = MassElectron;
@@ -1424,7 +1522,7 @@ template <typename T1, typename T2>
 void VarManager::FillPairMC(T1 const& t1, T2 const& t2, float* values, PairCandidateType pairType)
 {
   if (!values) {
-    values = fgValues;
+    values = GetValues();
   }
 
   float m1 = MassElectron;
@@ -1454,7 +1552,47 @@ void VarManager::FillPairMC(T1 const& t1, T2 const& t2, float* values, PairCandi
   values[kRap] = -v12.Rapidity();
 }
 
-template <int pairType, uint32_t collFillMap, uint32_t fillMap, typename C, typename T>
+template <typename T>
+const o2::track::TrackParCovFwd& VarManager::GetCachedFwdTrack(T const& muon)
+{
+  // Return the forward track parameters of the muon, built from the table columns only if the muon is not in the cache.
+  // The entries are checked against the muon parameters, since the global indices are reused across the data frames
+  auto& cache = FwdTrackCache();
+  if (cache.empty()) {
+    cache.resize(kFwdTrackCacheSize);
+  }
+  FwdTrackCacheEntry& entry = cache[muon.globalIndex() % kFwdTrackCacheSize];
+  if (entry.fIndex == muon.globalIndex() && entry.fTrack.getZ() == muon.z() && entry.fTrack.getX() == muon.x() &&
+      entry.fTrack.getY() == muon.y() && entry.fTrack.getInvQPt() == muon.signed1Pt()) {
+    return entry.fTrack;
+  }
+  SMatrix5 pars(muon.x(), muon.y(), muon.phi(), muon.tgl(), muon.signed1Pt());
+  std::array<double, 15> covs{muon.cXX(), muon.cXY(), muon.cYY(), muon.cPhiX(), muon.cPhiY(),
+                              muon.cPhiPhi(), muon.cTglX(), muon.cTglY(), muon.cTglPhi(), muon.cTglTgl(),
+                              muon.c1PtX(), muon.c1PtY(), muon.c1PtPhi(), muon.c1PtTgl(), muon.c1Pt21Pt2()};
+  SMatrix55 covMatrix(covs.begin(), covs.end());
+  entry.fIndex = muon.globalIndex();
+  entry.fTrack = o2::track::TrackParCovFwd{muon.z(), pars, covMatrix, muon.chi2()};
+  return entry.fTrack;
+}
+
+template <typename C>
+const VarManager::KFPVCacheEntry& VarManager::GetCachedKFPV(C const& collision)
+{
+  // Return the primary vertex of the collision as a KFParticle, built only if the collision is not the one of the previous call.
+  // The entry is checked against the vertex position, since the global indices are reused across the data frames
+  KFPVCacheEntry& entry = KFPVCache();
+  if (entry.fIndex == collision.globalIndex() && entry.fPV.GetX() == collision.posX() && entry.fPV.GetY() == collision.posY() && entry.fPV.GetZ() == collision.posZ()) {
+    return entry;
+  }
+  KFPVertex kfpVertex = createKFPVertexFromCollision(collision);
+  entry.fIndex = collision.globalIndex();
+  entry.fNContributors = kfpVertex.GetNContributors();
+  entry.fPV = KFParticle(kfpVertex);
+  return entry;
+}
+
+template <int pairType, uint32_t collFillMap, uint32_t fillMap, typename TVars, typename C, typename T>
 void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2, float* values)
 {
   // check at compile time that the event and cov matrix have the cov matrix
@@ -1462,8 +1600,13 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
   constexpr bool trackHasCov = ((fillMap & TrackCov) > 0 || (fillMap & ReducedTrackBarrelCov) > 0);
   constexpr bool muonHasCov = ((fillMap & MuonCov) > 0 || (fillMap & ReducedMuonCov) > 0);
 
+  // the vertexing is compiled out if none of its variables is requested
+  if constexpr (!TVars::any(IsVertexingVariable)) {
+    return;
+  }
+
   if (!values) {
-    values = fgValues;
+    values = GetValues();
   }
 
   values[kUsedKF] = fgUsedKF;
@@ -1485,24 +1628,14 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
                                       t2.cSnpSnp(), t2.cTglY(), t2.cTglZ(), t2.cTglSnp(), t2.cTglTgl(),
                                       t2.c1PtY(), t2.c1PtZ(), t2.c1PtSnp(), t2.c1PtTgl(), t2.c1Pt21Pt2()};
       o2::track::TrackParCov pars2{t2.x(), t2.alpha(), t2pars, t2covs};
-      procCode = fgFitterTwoProngBarrel.process(pars1, pars2);
+      procCode = FitterTwoProngBarrel().process(pars1, pars2);
     } else if constexpr ((pairType == kDecayToMuMu) && muonHasCov) {
-      // Initialize track parameters for forward
-      double chi21 = t1.chi2();
-      double chi22 = t2.chi2();
-      SMatrix5 t1pars(t1.x(), t1.y(), t1.phi(), t1.tgl(), t1.signed1Pt());
-      std::vector<double> v1{t1.cXX(), t1.cXY(), t1.cYY(), t1.cPhiX(), t1.cPhiY(),
-                             t1.cPhiPhi(), t1.cTglX(), t1.cTglY(), t1.cTglPhi(), t1.cTglTgl(),
-                             t1.c1PtX(), t1.c1PtY(), t1.c1PtPhi(), t1.c1PtTgl(), t1.c1Pt21Pt2()};
-      SMatrix55 t1covs(v1.begin(), v1.end());
-      o2::track::TrackParCovFwd pars1{t1.z(), t1pars, t1covs, chi21};
-      SMatrix5 t2pars(t2.x(), t2.y(), t2.phi(), t2.tgl(), t2.signed1Pt());
-      std::vector<double> v2{t2.cXX(), t2.cXY(), t2.cYY(), t2.cPhiX(), t2.cPhiY(),
-                             t2.cPhiPhi(), t2.cTglX(), t2.cTglY(), t2.cTglPhi(), t2.cTglTgl(),
-                             t2.c1PtX(), t2.c1PtY(), t2.c1PtPhi(), t2.c1PtTgl(), t2.c1Pt21Pt2()};
-      SMatrix55 t2covs(v2.begin(), v2.end());
-      o2::track::TrackParCovFwd pars2{t2.z(), t2pars, t2covs, chi22};
-      procCode = fgFitterTwoProngFwd.process(pars1, pars2);
+      // Track parameters for forward, taken from the cache (the first one is copied since both muons may use the same cache entry)
+      o2::track::TrackParCovFwd pars1 = GetCachedFwdTrack(t1);
+      const o2::track::TrackParCovFwd& pars2 = GetCachedFwdTrack(t2);
+      if (fgFwdVertexingMaxDCA < 0 || GetFwdPairDCAProxy(pars1, pars2) < fgFwdVertexingMaxDCA) {
+        procCode = FitterTwoProngFwd().process(pars1, pars2);
+      }
     } else {
       return;
     }
@@ -1545,12 +1678,12 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
       auto covMatrixPV = primaryVertex.getCov();
 
       if constexpr (pairType == kDecayToEE && trackHasCov) {
-        secondaryVertex = fgFitterTwoProngBarrel.getPCACandidate();
-        bz = fgFitterTwoProngBarrel.getBz();
-        covMatrixPCA = fgFitterTwoProngBarrel.calcPCACovMatrixFlat();
-        auto chi2PCA = fgFitterTwoProngBarrel.getChi2AtPCACandidate();
-        auto trackParVar0 = fgFitterTwoProngBarrel.getTrack(0);
-        auto trackParVar1 = fgFitterTwoProngBarrel.getTrack(1);
+        secondaryVertex = FitterTwoProngBarrel().getPCACandidate();
+        bz = FitterTwoProngBarrel().getBz();
+        covMatrixPCA = FitterTwoProngBarrel().calcPCACovMatrixFlat();
+        auto chi2PCA = FitterTwoProngBarrel().getChi2AtPCACandidate();
+        auto trackParVar0 = FitterTwoProngBarrel().getTrack(0);
+        auto trackParVar1 = FitterTwoProngBarrel().getTrack(1);
         values[kVertexingChi2PCA] = chi2PCA;
         trackParVar0.getPxPyPzGlo(pvec0);
         trackParVar1.getPxPyPzGlo(pvec1);
@@ -1561,12 +1694,12 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
         m1 = MassMuon;
         m2 = MassMuon;
 
-        secondaryVertex = fgFitterTwoProngFwd.getPCACandidate();
-        bz = fgFitterTwoProngFwd.getBz();
-        covMatrixPCA = fgFitterTwoProngFwd.calcPCACovMatrixFlat();
-        auto chi2PCA = fgFitterTwoProngFwd.getChi2AtPCACandidate();
-        auto trackParVar0 = fgFitterTwoProngFwd.getTrack(0);
-        auto trackParVar1 = fgFitterTwoProngFwd.getTrack(1);
+        secondaryVertex = FitterTwoProngFwd().getPCACandidate();
+        bz = FitterTwoProngFwd().getBz();
+        covMatrixPCA = FitterTwoProngFwd().calcPCACovMatrixFlat();
+        auto chi2PCA = FitterTwoProngFwd().getChi2AtPCACandidate();
+        auto trackParVar0 = FitterTwoProngFwd().getTrack(0);
+        auto trackParVar1 = FitterTwoProngFwd().getTrack(1);
         values[kVertexingChi2PCA] = chi2PCA;
         pvec0[0] = trackParVar0.getPx();
         pvec0[1] = trackParVar0.getPy();
@@ -1621,14 +1754,14 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
       KFGeoTwoProngBarrel.AddDaughter(trk0KF);
       KFGeoTwoProngBarrel.AddDaughter(trk1KF);
 
-      if (fgUsedVars[kKFMass])
+      if (IsUsed<TVars>(kKFMass))
         values[kKFMass] = KFGeoTwoProngBarrel.GetMass();
     }
     if constexpr (eventHasVtxCov) {
-      KFPVertex kfpVertex = createKFPVertexFromCollision(collision);
-      values[kKFNContributorsPV] = kfpVertex.GetNContributors();
-      KFParticle KFPV(kfpVertex);
-      if (fgUsedVars[kVertexingLxy] || fgUsedVars[kVertexingLz] || fgUsedVars[kVertexingLxyz] || fgUsedVars[kVertexingLxyErr] || fgUsedVars[kVertexingLzErr] || fgUsedVars[kVertexingTauxy] || fgUsedVars[kVertexingLxyOverErr] || fgUsedVars[kVertexingLzOverErr] || fgUsedVars[kVertexingLxyzOverErr]) {
+      const KFPVCacheEntry& cachedPV = GetCachedKFPV(collision);
+      values[kKFNContributorsPV] = cachedPV.fNContributors;
+      const KFParticle& KFPV = cachedPV.fPV;
+      if (IsUsed<TVars>(kVertexingLxy) || IsUsed<TVars>(kVertexingLz) || IsUsed<TVars>(kVertexingLxyz) || IsUsed<TVars>(kVertexingLxyErr) || IsUsed<TVars>(kVertexingLzErr) || IsUsed<TVars>(kVertexingTauxy) || IsUsed<TVars>(kVertexingLxyOverErr) || IsUsed<TVars>(kVertexingLzOverErr) || IsUsed<TVars>(kVertexingLxyzOverErr)) {
         double dxPair2PV = KFGeoTwoProngBarrel.GetX() - KFPV.GetX();
         double dyPair2PV = KFGeoTwoProngBarrel.GetY() - KFPV.GetY();
         double dzPair2PV = KFGeoTwoProngBarrel.GetZ() - KFPV.GetZ();
@@ -1652,35 +1785,35 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
         values[kVertexingTauxyErr] = values[kVertexingLxyErr] * KFGeoTwoProngBarrel.GetMass() / (KFGeoTwoProngBarrel.GetPt() * o2::constants::physics::LightSpeedCm2NS);
         values[kVertexingTauzErr] = values[kVertexingLzErr] * KFGeoTwoProngBarrel.GetMass() / (TMath::Abs(KFGeoTwoProngBarrel.GetPz()) * o2::constants::physics::LightSpeedCm2NS);
       }
-      if (fgUsedVars[kVertexingLxyOverErr] || fgUsedVars[kVertexingLzOverErr] || fgUsedVars[kVertexingLxyzOverErr]) {
+      if (IsUsed<TVars>(kVertexingLxyOverErr) || IsUsed<TVars>(kVertexingLzOverErr) || IsUsed<TVars>(kVertexingLxyzOverErr)) {
         values[kVertexingLxyOverErr] = values[kVertexingLxy] / values[kVertexingLxyErr];
         values[kVertexingLzOverErr] = values[kVertexingLz] / values[kVertexingLzErr];
         values[kVertexingLxyzOverErr] = values[kVertexingLxyz] / values[kVertexingLxyzErr];
       }
 
-      if (fgUsedVars[kKFChi2OverNDFGeo])
+      if (IsUsed<TVars>(kKFChi2OverNDFGeo))
         values[kKFChi2OverNDFGeo] = KFGeoTwoProngBarrel.GetChi2() / KFGeoTwoProngBarrel.GetNDF();
-      if (fgUsedVars[kKFCosPA])
+      if (IsUsed<TVars>(kKFCosPA))
         values[kKFCosPA] = calculateCosPA(KFGeoTwoProngBarrel, KFPV);
 
       // in principle, they should be in FillTrack
-      if (fgUsedVars[kKFTrack0DCAxyz] || fgUsedVars[kKFTrack1DCAxyz]) {
+      if (IsUsed<TVars>(kKFTrack0DCAxyz) || IsUsed<TVars>(kKFTrack1DCAxyz)) {
         values[kKFTrack0DCAxyz] = trk0KF.GetDistanceFromVertex(KFPV);
         values[kKFTrack1DCAxyz] = trk1KF.GetDistanceFromVertex(KFPV);
       }
-      if (fgUsedVars[kKFTrack0DCAxy] || fgUsedVars[kKFTrack1DCAxy]) {
+      if (IsUsed<TVars>(kKFTrack0DCAxy) || IsUsed<TVars>(kKFTrack1DCAxy)) {
         values[kKFTrack0DCAxy] = trk0KF.GetDistanceFromVertexXY(KFPV);
         values[kKFTrack1DCAxy] = trk1KF.GetDistanceFromVertexXY(KFPV);
       }
-      if (fgUsedVars[kKFDCAxyzBetweenProngs])
+      if (IsUsed<TVars>(kKFDCAxyzBetweenProngs))
         values[kKFDCAxyzBetweenProngs] = trk0KF.GetDistanceFromParticle(trk1KF);
-      if (fgUsedVars[kKFDCAxyBetweenProngs])
+      if (IsUsed<TVars>(kKFDCAxyBetweenProngs))
         values[kKFDCAxyBetweenProngs] = trk0KF.GetDistanceFromParticle(trk1KF);
 
-      if (fgUsedVars[kKFTracksDCAxyzMax]) {
+      if (IsUsed<TVars>(kKFTracksDCAxyzMax)) {
         values[kKFTracksDCAxyzMax] = values[kKFTrack0DCAxyz] > values[kKFTrack1DCAxyz] ? values[kKFTrack0DCAxyz] : values[kKFTrack1DCAxyz];
       }
-      if (fgUsedVars[kKFTracksDCAxyMax]) {
+      if (IsUsed<TVars>(kKFTracksDCAxyMax)) {
         values[kKFTracksDCAxyMax] = TMath::Abs(values[kKFTrack0DCAxy]) > TMath::Abs(values[kKFTrack1DCAxy]) ? values[kKFTrack0DCAxy] : values[kKFTrack1DCAxy];
       }
     }
@@ -1695,7 +1828,7 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
   constexpr bool trackHasCov = ((fillMap & TrackCov) > 0 || (fillMap & ReducedTrackBarrelCov) > 0);
   constexpr bool muonHasCov = ((fillMap & MuonCov) > 0 || (fillMap & ReducedMuonCov) > 0);
   if (!values) {
-    values = fgValues;
+    values = GetValues();
   }
 
   float mtrack;
@@ -1731,8 +1864,8 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
                            track.c1PtX(), track.c1PtY(), track.c1PtPhi(), track.c1PtTgl(), track.c1Pt21Pt2()};
     SMatrix55 t3covs(v3.begin(), v3.end());
     o2::track::TrackParCovFwd pars3{track.z(), t3pars, t3covs, chi23};
-    procCode = VarManager::fgFitterThreeProngFwd.process(pars1, pars2, pars3);
-    procCodeJpsi = VarManager::fgFitterTwoProngFwd.process(pars1, pars2);
+    procCode = VarManager::FitterThreeProngFwd().process(pars1, pars2, pars3);
+    procCodeJpsi = VarManager::FitterTwoProngFwd().process(pars1, pars2);
   } else if constexpr ((candidateType == kBtoJpsiEEK) && trackHasCov) {
     mlepton = MassElectron;
     mtrack = MassKaonCharged;
@@ -1751,8 +1884,8 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
                                          track.cSnpSnp(), track.cTglY(), track.cTglZ(), track.cTglSnp(), track.cTglTgl(),
                                          track.c1PtY(), track.c1PtZ(), track.c1PtSnp(), track.c1PtTgl(), track.c1Pt21Pt2()};
     o2::track::TrackParCov pars3{track.x(), track.alpha(), lepton3pars, lepton3covs};
-    procCode = VarManager::fgFitterThreeProngBarrel.process(pars1, pars2, pars3);
-    procCodeJpsi = VarManager::fgFitterTwoProngBarrel.process(pars1, pars2);
+    procCode = VarManager::FitterThreeProngBarrel().process(pars1, pars2, pars3);
+    procCodeJpsi = VarManager::FitterTwoProngBarrel().process(pars1, pars2);
   } else {
     return;
   }
@@ -1802,11 +1935,11 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
     auto covMatrixPV = primaryVertex.getCov();
 
     if constexpr (candidateType == kBtoJpsiEEK && trackHasCov) {
-      secondaryVertex = fgFitterThreeProngBarrel.getPCACandidate();
-      covMatrixPCA = fgFitterThreeProngBarrel.calcPCACovMatrixFlat();
+      secondaryVertex = FitterThreeProngBarrel().getPCACandidate();
+      covMatrixPCA = FitterThreeProngBarrel().calcPCACovMatrixFlat();
     } else if constexpr (candidateType == kBcToThreeMuons && muonHasCov) {
-      secondaryVertex = fgFitterThreeProngFwd.getPCACandidate();
-      covMatrixPCA = fgFitterThreeProngFwd.calcPCACovMatrixFlat();
+      secondaryVertex = FitterThreeProngFwd().getPCACandidate();
+      covMatrixPCA = FitterThreeProngFwd().calcPCACovMatrixFlat();
     }
 
     double phi = std::atan2(secondaryVertex[1] - collision.posY(), secondaryVertex[0] - collision.posX());
@@ -1843,7 +1976,7 @@ template <typename C, typename A>
 void VarManager::FillQVectorFromGFW(C const& collision, A const& compA2, A const& compB2, A const& compC2, A const& compA3, A const& compB3, A const& compC3, float normA, float normB, float normC, float* values)
 {
   if (!values) {
-    values = fgValues;
+    values = GetValues();
   }
 
   // Fill Qn vectors from generic flow framework for different eta gap A, B, C (n=2,3)
@@ -1884,7 +2017,7 @@ void VarManager::FillPairVn(T1 const& t1, T2 const& t2, float* values)
 {
 
   if (!values) {
-    values = fgValues;
+    values = GetValues();
   }
 
   float m1 = MassElectron;
@@ -1915,7 +2048,7 @@ void VarManager::FillPairVn(T1 const& t1, T2 const& t2, float* values)
   values[kU3Q3] = values[kQ3X0A] * std::cos(3 * v12.Phi()) + values[kQ3Y0A] * std::sin(3 * v12.Phi());
   values[kCos2DeltaPhi] = std::cos(2 * (v12.Phi() - getEventPlane(2, values[kQ2X0A], values[kQ2Y0A])));
   values[kCos3DeltaPhi] = std::cos(3 * (v12.Phi() - getEventPlane(3, values[kQ3X0A], values[kQ3Y0A])));
-  if (isnan(VarManager::fgValues[VarManager::kU2Q2]) == true) {
+  if (isnan(values[kU2Q2]) == true) {
     values[kU2Q2] = -999.;
     values[kU3Q3] = -999.;
     values[kCos2DeltaPhi] = -999.;
@@ -1927,7 +2060,7 @@ template <typename T1, typename T2>
 void VarManager::FillDileptonHadron(T1 const& dilepton, T2 const& hadron, float* values, float hadronMass)
 {
   if (!values) {
-    values = fgValues;
+    values = GetValues();
   }
 
   if (fgUsedVars[kPairMass] || fgUsedVars[kPairPt] || fgUsedVars[kPairEta] || fgUsedVars[kPairPhi]) {
@@ -1966,7 +2099,7 @@ template <typename T>
 void VarManager::FillHadron(T const& hadron, float* values, float hadronMass)
 {
   if (!values) {
-    values = fgValues;
+    values = GetValues();
   }
 
   ROOT::Math::PtEtaPhiMVector vhadron(hadron.pt(), hadron.eta(), hadron.phi(), hadronMass);
@@ -17,7 +17,9 @@
 // The skimming can optionally produce just the barrel, muon, or both barrel and muon tracks
 // The event filtering (filterPP), centrality, and V0Bits (from v0-selector) can be switched on/off by selecting one
 //  of the process functions
+#include <algorithm>
 #include <iostream>
+#include <thread>
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/ASoAHelpers.h"
@@ -157,6 +159,7 @@ struct TableMaker {
   Configurable<bool> fConfigComputeTPCpostCalibKaon{"cfgTPCpostCalibKaon", false, "If true, compute TPC post-calibrated n-sigmas for kaons"};
   Configurable<std::string> fConfigRunPeriods{"cfgRunPeriods", "LHC22f", "run periods for used data"};
   Configurable<bool> fConfigIsOnlyforMaps{"cfgIsforMaps", false, "If true, run for postcalibration maps only"};
+  Configurable<bool> fConfigParallelSkimming{"cfgParallelSkimming", false, "If true, evaluate the barrel track and muon selections on separate threads (not used with QA histograms)"};
 
   Service<o2::ccdb::BasicCCDBManager> fCCDB;
 
@@ -300,6 +303,42 @@ struct TableMaker {
   }
 
   // Templated function instantianed for all of the process functions
+  // Evaluate the cuts for all the tracks, using a VarManager context of the calling thread. Returns the filter map of each track
+  template <uint32_t TFillMap, typename TTracks>
+  static std::vector<uint8_t> runSelectionStage(TTracks const& tracks, std::vector<AnalysisCompositeCut>& cuts)
+  {
+    VarManager::VarContext context;
+    std::copy(VarManager::fgValues, VarManager::fgValues + VarManager::kNVars, context.fValues); // start from the current values, with the event-wise variables
+    VarManager::SetContext(&context);
+
+    std::vector<uint8_t> filterMaps;
+    filterMaps.reserve(tracks.size());
+    for (auto& track : tracks) {
+      VarManager::FillTrack<TFillMap>(track, context.fValues);
+      uint8_t filterMap = 0;
+      int i = 0;
+      for (auto cut = cuts.begin(); cut != cuts.end(); cut++, i++) {
+        if ((*cut).IsSelected(context.fValues)) {
+          filterMap |= (uint8_t(1) << i);
+        }
+      }
+      filterMaps.push_back(filterMap);
+    }
+
+    VarManager::SetContext(nullptr);
+    return filterMaps;
+  }
+
+  // Fill the stats histogram at position iHist of fStatsList with the cuts fulfilled by a track
+  void fillCutStatistics(int iHist, uint8_t filterMap, int nCuts)
+  {
+    for (int i = 0; i < nCuts; i++) {
+      if (filterMap & (uint8_t(1) << i)) {
+        (reinterpret_cast<TH1I*>(fStatsList->At(iHist)))->Fill(static_cast<float>(i));
+      }
+    }
+  }
+
   template <uint32_t TEventFillMap, uint32_t TTrackFillMap, uint32_t TMuonFillMap, uint32_t TMFTFillMap = 0u, typename TEvent, typename TTracks, typename TMuons, typename TAmbiTracks, typename TAmbiMuons, typename TMFTTracks = std::nullptr_t>
   void fullSkimming(TEvent const& collision, aod::BCsWithTimestamps const&, TTracks const& tracksBarrel, TMuons const& tracksMuon, TAmbiTracks const& ambiTracksMid, TAmbiMuons const& ambiTracksFwd, TMFTTracks const& mftTracks = nullptr)
   {
@@ -383,6 +422,20 @@ struct TableMaker {
     }
     eventVtxCov(collision.covXX(), collision.covXY(), collision.covXZ(), collision.covYY(), collision.covYZ(), collision.covZZ(), collision.chi2());
 
+    // Selection stage: if requested, the barrel track and muon cut decisions are evaluated first and concurrently,
+    //   the muons on a separate thread. The tables are then written below, in the usual order, using these decisions.
+    std::vector<uint8_t> barrelFilterMaps;
+    std::vector<uint8_t> muonFilterMaps;
+    bool preselected = false;
+    if constexpr (static_cast<bool>(TTrackFillMap) && static_cast<bool>(TMuonFillMap)) {
+      if (fConfigParallelSkimming && !fConfigQA && !fDoDetailedQA && !fConfigIsOnlyforMaps) {
+        std::thread muonStage([&]() { muonFilterMaps = runSelectionStage<TMuonFillMap>(tracksMuon, fMuonCuts); });
+        barrelFilterMaps = runSelectionStage<TTrackFillMap>(tracksBarrel, fTrackCuts);
+        muonStage.join();
+        preselected = true;
+      }
+    }
+
     uint64_t trackFilteringTag = 0;
     uint8_t trackTempFilterMap = 0;
     int isAmbiguous = 0;
@@ -395,6 +448,7 @@ struct TableMaker {
       trackBarrelPID.reserve(tracksBarrel.size());
 
       // loop over tracks
+      size_t iTrack = 0;
       for (auto& track : tracksBarrel) {
         if constexpr ((TTrackFillMap & VarManager::ObjTypes::AmbiTrack) > 0) {
           if (fIsAmbiguous) {
@@ -410,30 +464,42 @@ struct TableMaker {
 
         trackFilteringTag = uint64_t(0);
         trackTempFilterMap = uint8_t(0);
-        VarManager::FillTrack<TTrackFillMap>(track);
-        if (fDoDetailedQA) {
-          fHistMan->FillHistClass("TrackBarrel_BeforeCuts", VarManager::fgValues);
-          if (fIsAmbiguous && isAmbiguous == 1) {
-            fHistMan->FillHistClass("Ambiguous_TrackBarrel_BeforeCuts", VarManager::fgValues);
+        if (preselected) {
+          // decisions from the selection stage; the variables are filled again only if the post-calibrated n-sigmas are stored
+          trackTempFilterMap = barrelFilterMaps[iTrack++];
+          if (!trackTempFilterMap) {
+            continue;
+          }
+          fillCutStatistics(1, trackTempFilterMap, fTrackCuts.size());
+          if (fConfigComputeTPCpostCalib) {
+            VarManager::FillTrack<TTrackFillMap>(track);
+          }
+        } else {
+          VarManager::FillTrack<TTrackFillMap>(track);
+          if (fDoDetailedQA) {
+            fHistMan->FillHistClass("TrackBarrel_BeforeCuts", VarManager::fgValues);
+            if (fIsAmbiguous && isAmbiguous == 1) {
+              fHistMan->FillHistClass("Ambiguous_TrackBarrel_BeforeCuts", VarManager::fgValues);
+            }
           }
-        }
 
-        // apply track cuts and fill stats histogram
-        int i = 0;
-        for (auto cut = fTrackCuts.begin(); cut != fTrackCuts.end(); cut++, i++) {
-          if ((*cut).IsSelected(VarManager::fgValues)) {
-            trackTempFilterMap |= (uint8_t(1) << i);
-            if (fConfigQA) {
-              fHistMan->FillHistClass(Form("TrackBarrel_%s", (*cut).GetName()), VarManager::fgValues);
-              if (fIsAmbiguous && isAmbiguous == 1) {
-                fHistMan->FillHistClass(Form("Ambiguous_TrackBarrel_%s", (*cut).GetName()), VarManager::fgValues);
+          // apply track cuts and fill stats histogram
+          int i = 0;
+          for (auto cut = fTrackCuts.begin(); cut != fTrackCuts.end(); cut++, i++) {
+            if ((*cut).IsSelected(VarManager::fgValues)) {
+              trackTempFilterMap |= (uint8_t(1) << i);
+              if (fConfigQA) {
+                fHistMan->FillHistClass(Form("TrackBarrel_%s", (*cut).GetName()), VarManager::fgValues);
+                if (fIsAmbiguous && isAmbiguous == 1) {
+                  fHistMan->FillHistClass(Form("Ambiguous_TrackBarrel_%s", (*cut).GetName()), VarManager::fgValues);
+                }
               }
+              (reinterpret_cast<TH1I*>(fStatsList->At(1)))->Fill(static_cast<float>(i));
             }
-            (reinterpret_cast<TH1I*>(fStatsList->At(1)))->Fill(static_cast<float>(i));
           }
-        }
-        if (!trackTempFilterMap) {
-          continue;
+          if (!trackTempFilterMap) {
+            continue;
+          }
         }
 
         // store filtering information
@@ -540,9 +606,10 @@ struct TableMaker {
       std::map<int, int> newMatchIndex;
       std::map<int, int> newMFTMatchIndex;
 
+      size_t iMuon = 0;
       for (auto& muon : tracksMuon) {
         trackFilteringTag = uint64_t(0);
-        VarManager::FillTrack<TMuonFillMap>(muon);
+        trackTempFilterMap = uint8_t(0);
 
         if (muon.index() > idxPrev + 1) { // checks if some muons are filtered even before the skimming function
           nDel += muon.index() - (idxPrev + 1);
@@ -550,10 +617,15 @@ struct TableMaker {
         idxPrev = muon.index();
 
         // check the cuts and filters
-        int i = 0;
-        for (auto cut = fMuonCuts.begin(); cut != fMuonCuts.end(); cut++, i++) {
-          if ((*cut).IsSelected(VarManager::fgValues))
-            trackTempFilterMap |= (uint8_t(1) << i);
+        if (preselected) {
+          trackTempFilterMap = muonFilterMaps[iMuon++];
+        } else {
+          VarManager::FillTrack<TMuonFillMap>(muon);
+          int i = 0;
+          for (auto cut = fMuonCuts.begin(); cut != fMuonCuts.end(); cut++, i++) {
+            if ((*cut).IsSelected(VarManager::fgValues))
+              trackTempFilterMap |= (uint8_t(1) << i);
+          }
         }
 
         if (!trackTempFilterMap) { // does not pass the cuts
@@ -564,6 +636,7 @@ struct TableMaker {
       }
 
       // now let's save the muons with the correct indices and matches
+      iMuon = 0;
       for (auto& muon : tracksMuon) {
         if constexpr ((TMuonFillMap & VarManager::ObjTypes::AmbiMuon) > 0) {
           if (fIsAmbiguous) {
@@ -579,25 +652,31 @@ struct TableMaker {
         trackFilteringTag = uint64_t(0);
         trackTempFilterMap = uint8_t(0);
 
-        VarManager::FillTrack<TMuonFillMap>(muon);
-        if (fDoDetailedQA) {
-          fHistMan->FillHistClass("Muons_BeforeCuts", VarManager::fgValues);
-          if (fIsAmbiguous && isAmbiguous == 1) {
-            fHistMan->FillHistClass("Ambiguous_Muons_BeforeCuts", VarManager::fgValues);
+        if (preselected) {
+          // decisions from the selection stage, the muon tables do not need the VarManager variables
+          trackTempFilterMap = muonFilterMaps[iMuon++];
+          fillCutStatistics(2, trackTempFilterMap, fMuonCuts.size());
+        } else {
+          VarManager::FillTrack<TMuonFillMap>(muon);
+          if (fDoDetailedQA) {
+            fHistMan->FillHistClass("Muons_BeforeCuts", VarManager::fgValues);
+            if (fIsAmbiguous && isAmbiguous == 1) {
+              fHistMan->FillHistClass("Ambiguous_Muons_BeforeCuts", VarManager::fgValues);
+            }
           }
-        }
-        // apply the muon selection cuts and fill the stats histogram
-        int i = 0;
-        for (auto cut = fMuonCuts.begin(); cut != fMuonCuts.end(); cut++, i++) {
-          if ((*cut).IsSelected(VarManager::fgValues)) {
-            trackTempFilterMap |= (uint8_t(1) << i);
-            if (fConfigQA) {
-              fHistMan->FillHistClass(Form("Muons_%s", (*cut).GetName()), VarManager::fgValues);
-              if (fIsAmbiguous && isAmbiguous == 1) {
-                fHistMan->FillHistClass(Form("Ambiguous_Muons_%s", (*cut).GetName()), VarManager::fgValues);
+          // apply the muon selection cuts and fill the stats histogram
+          int i = 0;
+          for (auto cut = fMuonCuts.begin(); cut != fMuonCuts.end(); cut++, i++) {
+            if ((*cut).IsSelected(VarManager::fgValues)) {
+              trackTempFilterMap |= (uint8_t(1) << i);
+              if (fConfigQA) {
+                fHistMan->FillHistClass(Form("Muons_%s", (*cut).GetName()), VarManager::fgValues);
+                if (fIsAmbiguous && isAmbiguous == 1) {
+                  fHistMan->FillHistClass(Form("Ambiguous_Muons_%s", (*cut).GetName()), VarManager::fgValues);
+                }
               }
+              (reinterpret_cast<TH1I*>(fStatsList->At(2)))->Fill(static_cast<float>(i));
             }
-            (reinterpret_cast<TH1I*>(fStatsList->At(2)))->Fill(static_cast<float>(i));
           }
         }
         if (!trackTempFilterMap) {
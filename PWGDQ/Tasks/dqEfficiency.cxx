@@ -87,6 +87,7 @@ constexpr static uint32_t gkMuonFillMapWithCov = VarManager::ObjTypes::ReducedMu
 constexpr static uint32_t gkParticleMCFillMap = VarManager::ObjTypes::ParticleMC;
 
 void DefineHistograms(HistogramManager* histMan, TString histClasses);
+std::vector<std::vector<int>> GetHistClassHandles(HistogramManager* histMan, std::vector<std::vector<TString>> const& histNames); // histogram class handles used in the pairing
 
 struct AnalysisEventSelection {
   Produces<aod::EventCuts> eventSel;
@@ -521,6 +522,13 @@ struct AnalysisSameEventPairing {
   std::vector<std::vector<TString>> fMuonHistNamesMCmatched;
   std::vector<std::vector<TString>> fBarrelMuonHistNames;
   std::vector<std::vector<TString>> fBarrelMuonHistNamesMCmatched;
+  // Handles of the histogram classes above, to fill them without any lookup by name
+  std::vector<std::vector<int>> fBarrelHistHandles;
+  std::vector<std::vector<int>> fBarrelHistHandlesMCmatched;
+  std::vector<std::vector<int>> fMuonHistHandles;
+  std::vector<std::vector<int>> fMuonHistHandlesMCmatched;
+  std::vector<std::vector<int>> fBarrelMuonHistHandles;
+  std::vector<std::vector<int>> fBarrelMuonHistHandlesMCmatched;
   std::vector<MCSignal> fRecMCSignals;
   std::vector<MCSignal> fGenMCSignals;
 
@@ -679,6 +687,12 @@ struct AnalysisSameEventPairing {
 
     DefineHistograms(fHistMan, histNames.Data());    // define all histograms
     VarManager::SetUseVars(fHistMan->GetUsedVars()); // provide the list of required variables so that VarManager knows what to fill
+    fBarrelHistHandles = GetHistClassHandles(fHistMan, fBarrelHistNames);
+    fBarrelHistHandlesMCmatched = GetHistClassHandles(fHistMan, fBarrelHistNamesMCmatched);
+    fMuonHistHandles = GetHistClassHandles(fHistMan, fMuonHistNames);
+    fMuonHistHandlesMCmatched = GetHistClassHandles(fHistMan, fMuonHistNamesMCmatched);
+    fBarrelMuonHistHandles = GetHistClassHandles(fHistMan, fBarrelMuonHistNames);
+    fBarrelMuonHistHandlesMCmatched = GetHistClassHandles(fHistMan, fBarrelMuonHistNamesMCmatched);
     fOutputList.setObject(fHistMan->GetMainHistogramList());
   }
 
@@ -712,17 +726,17 @@ struct AnalysisSameEventPairing {
 
     // establish the right histogram classes to be filled depending on TPairType (ee,mumu,emu)
     unsigned int ncuts = fBarrelHistNames.size();
-    std::vector<std::vector<TString>> histNames = fBarrelHistNames;
-    std::vector<std::vector<TString>> histNamesMCmatched = fBarrelHistNamesMCmatched;
+    const std::vector<std::vector<int>>* histHandles = &fBarrelHistHandles;
+    const std::vector<std::vector<int>>* histHandlesMCmatched = &fBarrelHistHandlesMCmatched;
     if constexpr (TPairType == VarManager::kDecayToMuMu) {
       ncuts = fMuonHistNames.size();
-      histNames = fMuonHistNames;
-      histNamesMCmatched = fMuonHistNamesMCmatched;
+      histHandles = &fMuonHistHandles;
+      histHandlesMCmatched = &fMuonHistHandlesMCmatched;
     }
     if constexpr (TPairType == VarManager::kElectronMuon) {
       ncuts = fBarrelMuonHistNames.size();
-      histNames = fBarrelMuonHistNames;
-      histNamesMCmatched = fBarrelMuonHistNamesMCmatched;
+      histHandles = &fBarrelMuonHistHandles;
+      histHandlesMCmatched = &fBarrelMuonHistHandlesMCmatched;
     }
 
     // Loop over two track combinations
@@ -734,6 +748,10 @@ struct AnalysisSameEventPairing {
     if (fConfigFlatTables.value) {
       dimuonAllList.reserve(1);
     }
+    // the MC signal decisions of each particle are evaluated once and reused for all its pairs
+    for (auto& sig : fRecMCSignals) {
+      sig.ResetCache();
+    }
 
     for (auto& [t1, t2] : combinations(tracks1, tracks2)) {
       if constexpr (TPairType == VarManager::kDecayToEE) {
@@ -759,12 +777,12 @@ struct AnalysisSameEventPairing {
       int isig = 0;
       for (auto sig = fRecMCSignals.begin(); sig != fRecMCSignals.end(); sig++, isig++) {
         if constexpr (TTrackFillMap & VarManager::ObjTypes::ReducedTrack || TTrackFillMap & VarManager::ObjTypes::ReducedMuon) { // for skimmed DQ model
-          if ((*sig).CheckSignal(false, t1.reducedMCTrack(), t2.reducedMCTrack())) {
+          if ((*sig).CheckSignalCached(false, t1.reducedMCTrack(), t2.reducedMCTrack())) {
             mcDecision |= (uint32_t(1) << isig);
           }
         }
         if constexpr (TTrackFillMap & VarManager::ObjTypes::Track || TTrackFillMap & VarManager::ObjTypes::Muon) { // for Framework data model
-          if ((*sig).CheckSignal(false, t1.template mcParticle_as<aod::McParticles_001>(), t2.template mcParticle_as<aod::McParticles_001>())) {
+          if ((*sig).CheckSignalCached(false, t1.template mcParticle_as<aod::McParticles_001>(), t2.template mcParticle_as<aod::McParticles_001>())) {
             mcDecision |= (uint32_t(1) << isig);
           }
         }
@@ -786,17 +804,17 @@ struct AnalysisSameEventPairing {
       for (unsigned int icut = 0; icut < ncuts; icut++) {
         if (twoTrackFilter & (uint8_t(1) << icut)) {
           if (t1.sign() * t2.sign() < 0) {
-            fHistMan->FillHistClass(histNames[icut][0].Data(), VarManager::fgValues);
+            fHistMan->FillHistClass((*histHandles)[icut][0], VarManager::fgValues);
             for (unsigned int isig = 0; isig < fRecMCSignals.size(); isig++) {
               if (mcDecision & (uint32_t(1) << isig)) {
-                fHistMan->FillHistClass(histNamesMCmatched[icut][isig].Data(), VarManager::fgValues);
+                fHistMan->FillHistClass((*histHandlesMCmatched)[icut][isig], VarManager::fgValues);
               }
             }
           } else {
             if (t1.sign() > 0) {
-              fHistMan->FillHistClass(histNames[icut][1].Data(), VarManager::fgValues);
+              fHistMan->FillHistClass((*histHandles)[icut][1], VarManager::fgValues);
             } else {
-              fHistMan->FillHistClass(histNames[icut][2].Data(), VarManager::fgValues);
+              fHistMan->FillHistClass((*histHandles)[icut][2], VarManager::fgValues);
             }
           }
         }
@@ -1058,6 +1076,10 @@ struct AnalysisDileptonTrack {
     VarManager::ResetValues(0, VarManager::kNVars, fValuesDilepton);
     VarManager::FillEvent<TEventFillMap>(event, fValuesTrack);
     VarManager::FillEvent<TEventFillMap>(event, fValuesDilepton);
+    // the MC signal decisions of each particle are evaluated once and reused for all the dilepton-track combinations
+    for (auto& sig : fRecMCSignals) {
+      sig.ResetCache();
+    }
 
     // Set the global index offset to find the proper lepton
     // TO DO: remove it once the issue with lepton index is solved
@@ -1095,7 +1117,7 @@ struct AnalysisDileptonTrack {
       int isig = 0;
       for (auto sig = fRecMCSignals.begin(); sig != fRecMCSignals.end(); sig++, isig++) {
         if constexpr (TTrackFillMap & VarManager::ObjTypes::ReducedTrack || TTrackFillMap & VarManager::ObjTypes::ReducedMuon) { // for skimmed DQ model
-          if ((*sig).CheckSignal(false, lepton1MC, lepton2MC)) {
+          if ((*sig).CheckSignalCached(false, lepton1MC, lepton2MC)) {
             mcDecision |= (uint32_t(1) << isig);
           }
         }
@@ -1127,7 +1149,7 @@ struct AnalysisDileptonTrack {
         isig = 0;
         for (auto sig = fRecMCSignals.begin(); sig != fRecMCSignals.end(); sig++, isig++) {
           if constexpr (TTrackFillMap & VarManager::ObjTypes::ReducedTrack || TTrackFillMap & VarManager::ObjTypes::ReducedMuon || TTrackFillMap & VarManager::ObjTypes::ReducedMuon) { // for skimmed DQ model
-            if ((*sig).CheckSignal(false, lepton1MC, lepton2MC, trackMC)) {
+            if ((*sig).CheckSignalCached(false, lepton1MC, lepton2MC, trackMC)) {
               mcDecision |= (uint32_t(1) << isig);
             }
           }
@@ -1271,3 +1293,19 @@ void DefineHistograms(HistogramManager* histMan, TString histClasses)
 
   } // end loop over histogram classes
 }
+
+std::vector<std::vector<int>> GetHistClassHandles(HistogramManager* histMan, std::vector<std::vector<TString>> const& histNames)
+{
+  //
+  // Convert the names of the histogram classes into the handles of the histogram manager
+  //
+  std::vector<std::vector<int>> handles;
+  for (auto const& names : histNames) {
+    std::vector<int> classHandles;
+    for (auto const& name : names) {
+      classHandles.push_back(histMan->GetHistClassHandle(name.Data()));
+    }
+    handles.push_back(classHandles);
+  }
+  return handles;
+}
@@ -11,9 +11,11 @@
 //
 // Contact: iarsene@cern.ch, i.c.arsene@fys.uio.no
 //
+#include <cmath>
 #include <iostream>
 #include <vector>
 #include <algorithm>
+#include <type_traits>
 #include <TH1F.h>
 #include <TH3F.h>
 #include <THashList.h>
@@ -31,6 +33,7 @@
 #include "PWGDQ/Core/MixingHandler.h"
 #include "PWGDQ/Core/AnalysisCut.h"
 #include "PWGDQ/Core/AnalysisCompositeCut.h"
+#include "PWGDQ/Core/AnalysisCompiledCut.h"
 #include "PWGDQ/Core/HistogramsLibrary.h"
 #include "PWGDQ/Core/CutsLibrary.h"
 #include "PWGDQ/Core/MixingLibrary.h"
@@ -111,6 +114,7 @@ constexpr static int pairTypeEMu = VarManager::kElectronMuon;
 
 // Global function used to define needed histogram classes
 void DefineHistograms(HistogramManager* histMan, TString histClasses, Configurable<std::string> configVar); // defines histograms for all tasks
+std::vector<std::vector<int>> GetHistClassHandles(HistogramManager* histMan, std::vector<std::vector<TString>> const& histNames); // histogram class handles used in the pairing
 
 struct AnalysisEventSelection {
   Produces<aod::EventCuts> eventSel;
@@ -497,6 +501,8 @@ struct AnalysisEventMixing {
   Configurable<string> fConfigMuonCuts{"cfgMuonCuts", "", "Comma separated list of muon cuts"};
   Configurable<int> fConfigMixingDepth{"cfgMixingDepth", 100, "Number of Events stored for event mixing"};
   Configurable<std::string> fConfigAddEventMixingHistogram{"cfgAddEventMixingHistogram", "", "Comma separated list of histograms"};
+  Configurable<bool> fConfigUseEventPools{"cfgUseEventPools", false, "Mix with events kept in per-category pools of compact track records, across data frames, instead of re-slicing the tables"};
+  Configurable<int> fConfigPoolMaxTracks{"cfgPoolMaxTracks", 100, "Maximum number of tracks stored per event in the mixing pools"};
 
   Filter filterEventSelected = aod::dqanalysisflags::isEventSelected == 1;
   Filter filterTrackSelected = aod::dqanalysisflags::isBarrelSelected > 0;
@@ -509,11 +515,22 @@ struct AnalysisEventMixing {
   std::vector<std::vector<TString>> fTrackHistNames;
   std::vector<std::vector<TString>> fMuonHistNames;
   std::vector<std::vector<TString>> fTrackMuonHistNames;
+  // Handles of the histogram classes above, to fill them without any lookup by name
+  std::vector<std::vector<int>> fTrackHistHandles;
+  std::vector<std::vector<int>> fMuonHistHandles;
+  std::vector<std::vector<int>> fTrackMuonHistHandles;
 
   NoBinningPolicy<aod::dqanalysisflags::MixingHash> hashBin;
+  // Event pools, used only if cfgUseEventPools is enabled
+  MixingHandler* fMixHandler = nullptr;
 
   void init(o2::framework::InitContext& context)
   {
+    if (fConfigUseEventPools) {
+      fMixHandler = new MixingHandler("mixingPools", "event mixing pools");
+      fMixHandler->SetPoolDepth(fConfigMixingDepth.value, fConfigPoolMaxTracks.value);
+    }
+
     VarManager::SetDefaultVarNames();
     fHistMan = new HistogramManager("analysisHistos", "aa", VarManager::kNVars);
     fHistMan->SetUseDefaultVariableNames(kTRUE);
@@ -573,63 +590,104 @@ struct AnalysisEventMixing {
     }
 
     DefineHistograms(fHistMan, histNames.Data(), fConfigAddEventMixingHistogram); // define all histograms
+    fTrackHistHandles = GetHistClassHandles(fHistMan, fTrackHistNames);
+    fMuonHistHandles = GetHistClassHandles(fHistMan, fMuonHistNames);
+    fTrackMuonHistHandles = GetHistClassHandles(fHistMan, fTrackMuonHistNames);
     VarManager::SetUseVars(fHistMan->GetUsedVars());                              // provide the list of required variables so that VarManager knows what to fill
     fOutputList.setObject(fHistMan->GetMainHistogramList());
   }
 
-  template <int TPairType, typename TTracks1, typename TTracks2>
-  void runMixedPairing(TTracks1 const& tracks1, TTracks2 const& tracks2)
+  template <int TPairType>
+  const std::vector<std::vector<int>>* getMixedHistHandles() const
   {
-
-    unsigned int ncuts = fTrackHistNames.size();
-    std::vector<std::vector<TString>> histNames = fTrackHistNames;
     if constexpr (TPairType == pairTypeMuMu) {
-      ncuts = fMuonHistNames.size();
-      histNames = fMuonHistNames;
+      return &fMuonHistHandles;
     }
     if constexpr (TPairType == pairTypeEMu) {
-      ncuts = fTrackMuonHistNames.size();
-      histNames = fTrackMuonHistNames;
+      return &fTrackMuonHistHandles;
     }
+    return &fTrackHistHandles;
+  }
 
-    uint32_t twoTrackFilter = 0;
-    for (auto& track1 : tracks1) {
-      for (auto& track2 : tracks2) {
-        if constexpr (TPairType == VarManager::kDecayToEE) {
-          twoTrackFilter = uint32_t(track1.isBarrelSelected()) & uint32_t(track2.isBarrelSelected()) & fTwoTrackFilterMask;
-        }
-        if constexpr (TPairType == VarManager::kDecayToMuMu) {
-          twoTrackFilter = uint32_t(track1.isMuonSelected()) & uint32_t(track2.isMuonSelected()) & fTwoMuonFilterMask;
-        }
-        if constexpr (TPairType == VarManager::kElectronMuon) {
-          twoTrackFilter = uint32_t(track1.isBarrelSelected()) & uint32_t(track2.isMuonSelected()) & fTwoTrackFilterMask;
-        }
+  // Filter bit map of a track used as leg of a mixed pair: the muon bits for muons, the barrel ones otherwise
+  template <bool TIsMuon, typename TTrack>
+  static uint32_t getTrackFilter(TTrack const& track)
+  {
+    if constexpr (std::is_same_v<TTrack, MixingHandler::PoolTrack>) {
+      return track.fFilter;
+    } else if constexpr (TIsMuon) {
+      return uint32_t(track.isMuonSelected());
+    } else {
+      return uint32_t(track.isBarrelSelected());
+    }
+  }
 
-        if (!twoTrackFilter) { // the tracks must have at least one filter bit in common to continue
-          continue;
+  template <int TPairType, typename TTrack1, typename TTrack2>
+  void fillMixedPair(TTrack1 const& track1, TTrack2 const& track2, const std::vector<std::vector<int>>& histHandles)
+  {
+    uint32_t twoTrackFilter = getTrackFilter<TPairType == VarManager::kDecayToMuMu>(track1) & getTrackFilter<TPairType != VarManager::kDecayToEE>(track2);
+    twoTrackFilter &= (TPairType == VarManager::kDecayToMuMu ? fTwoMuonFilterMask : fTwoTrackFilterMask);
+    if (!twoTrackFilter) { // the tracks must have at least one filter bit in common to continue
+      return;
+    }
+    VarManager::FillPairME<TPairType>(track1, track2);
+
+    constexpr bool eventHasQvector = (VarManager::ObjTypes::ReducedEventQvector > 0);
+    if constexpr (eventHasQvector) {
+      VarManager::FillPairVn<TPairType>(track1, track2);
+    }
+
+    for (unsigned int icut = 0; icut < histHandles.size(); icut++) {
+      if (twoTrackFilter & (uint32_t(1) << icut)) {
+        if (track1.sign() * track2.sign() < 0) {
+          fHistMan->FillHistClass(histHandles[icut][0], VarManager::fgValues);
+        } else {
+          if (track1.sign() > 0) {
+            fHistMan->FillHistClass(histHandles[icut][1], VarManager::fgValues);
+          } else {
+            fHistMan->FillHistClass(histHandles[icut][2], VarManager::fgValues);
+          }
         }
-        VarManager::FillPairME<TPairType>(track1, track2);
+      } // end if (filter bits)
+    }   // end for (cuts)
+  }
 
-        constexpr bool eventHasQvector = (VarManager::ObjTypes::ReducedEventQvector > 0);
-        if constexpr (eventHasQvector) {
-          VarManager::FillPairVn<TPairType>(track1, track2);
+  template <int TPairType, typename TTracks1, typename TTracks2>
+  void runMixedPairing(TTracks1 const& tracks1, TTracks2 const& tracks2)
+  {
+    const std::vector<std::vector<int>>& histHandles = *getMixedHistHandles<TPairType>();
+    for (auto& track1 : tracks1) {
+      for (auto& track2 : tracks2) {
+        fillMixedPair<TPairType>(track1, track2, histHandles);
+      } // end for (track2)
+    }   // end for (track1)
+  }
+
+  // Pair the tracks of the current event with the tracks of all the events in the pool
+  template <int TPairType, typename TTracks1>
+  void runPoolPairing(TTracks1 const& tracks1, const MixingHandler::EventPool& pool)
+  {
+    const std::vector<std::vector<int>>& histHandles = *getMixedHistHandles<TPairType>();
+    for (int iEvent = 0; iEvent < pool.GetNEvents(); iEvent++) {
+      const int nTracks2 = pool.GetNTracks(iEvent);
+      for (auto& track1 : tracks1) {
+        for (int iTrack2 = 0; iTrack2 < nTracks2; iTrack2++) {
+          fillMixedPair<TPairType>(track1, pool.GetTrack(iEvent, iTrack2), histHandles);
         }
+      }
+    }
+  }
 
-        for (unsigned int icut = 0; icut < ncuts; icut++) {
-          if (twoTrackFilter & (uint32_t(1) << icut)) {
-            if (track1.sign() * track2.sign() < 0) {
-              fHistMan->FillHistClass(histNames[icut][0].Data(), VarManager::fgValues);
-            } else {
-              if (track1.sign() > 0) {
-                fHistMan->FillHistClass(histNames[icut][1].Data(), VarManager::fgValues);
-              } else {
-                fHistMan->FillHistClass(histNames[icut][2].Data(), VarManager::fgValues);
-              }
-            }
-          } // end if (filter bits)
-        }   // end for (cuts)
-      }     // end for (track2)
-    }       // end for (track1)
+  // Store the tracks of the current event in the pool (the oldest event is dropped if the pool is full)
+  template <bool TIsMuon, typename TTracks>
+  static void addToPool(MixingHandler::EventPool& pool, TTracks const& tracks)
+  {
+    pool.AddEvent();
+    for (auto& track : tracks) {
+      if (!pool.AddTrack(track.pt(), track.eta(), track.phi(), track.sign(), getTrackFilter<TIsMuon>(track))) {
+        break; // the event is full, the remaining tracks are not used for mixing
+      }
+    }
   }
 
   // barrel-barrel and muon-muon event mixing
@@ -637,6 +695,23 @@ struct AnalysisEventMixing {
   void runSameSide(TEvents& events, TTracks const& tracks, Preslice<TTracks>& preSlice)
   {
     events.bindExternalIndices(&tracks);
+    if (fConfigUseEventPools) {
+      // separate pools for each process function, so that several of them can run in the same task
+      constexpr int poolLeg = (TPairType == pairTypeMuMu ? 1 : 0) + (TEventFillMap == gkEventFillMapWithQvector ? 2 : 0);
+      for (auto& event : events) {
+        if (event.mixingHash() < 0) {
+          continue;
+        }
+        VarManager::ResetValues(0, VarManager::kNVars);
+        VarManager::FillEvent<TEventFillMap>(event, VarManager::fgValues);
+
+        auto eventTracks = tracks.sliceBy(preSlice, event.globalIndex());
+        MixingHandler::EventPool& pool = fMixHandler->GetEventPool(event.mixingHash(), poolLeg);
+        runPoolPairing<TPairType>(eventTracks, pool);
+        addToPool<TPairType == pairTypeMuMu>(pool, eventTracks);
+      }
+      return;
+    }
     int mixingDepth = fConfigMixingDepth.value;
     for (auto& [event1, event2] : selfCombinations(hashBin, mixingDepth, -1, events, events)) {
       VarManager::ResetValues(0, VarManager::kNVars);
@@ -657,6 +732,23 @@ struct AnalysisEventMixing {
   void runBarrelMuon(TEvents& events, TTracks const& tracks, TMuons const& muons)
   {
     events.bindExternalIndices(&muons);
+    if (fConfigUseEventPools) {
+      // the barrel tracks of the current event are paired with the muons of the events in the pool
+      for (auto& event : events) {
+        if (event.mixingHash() < 0) {
+          continue;
+        }
+        VarManager::ResetValues(0, VarManager::kNVars);
+        VarManager::FillEvent<TEventFillMap>(event, VarManager::fgValues);
+
+        auto eventTracks = tracks.sliceBy(perEventsSelectedT, event.globalIndex());
+        auto eventMuons = muons.sliceBy(perEventsSelectedM, event.globalIndex());
+        MixingHandler::EventPool& pool = fMixHandler->GetEventPool(event.mixingHash(), 4);
+        runPoolPairing<pairTypeEMu>(eventTracks, pool);
+        addToPool<true>(pool, eventMuons);
+      }
+      return;
+    }
 
     for (auto& [event1, event2] : selfCombinations(hashBin, 100, -1, events, events)) {
       VarManager::ResetValues(0, VarManager::kNVars);
@@ -732,12 +824,16 @@ struct AnalysisSameEventPairing {
   Configurable<std::string> fConfigAddSEPHistogram{"cfgAddSEPHistogram", "", "Comma separated list of histograms"};
   Configurable<bool> fConfigFlatTables{"cfgFlatTables", false, "Produce a single flat tables with all relevant information of the pairs and single tracks"};
   Configurable<bool> fConfigUseKFVertexing{"cfgUseKFVertexing", false, "Use KF Particle for secondary vertex reconstruction (DCAFitter is used by default)"};
+  Configurable<float> fConfigPairMassMin{"cfgPairMassMin", 0.0f, "Pair preselection: minimum invariant mass, checked before filling the pair variables"};
+  Configurable<float> fConfigPairMassMax{"cfgPairMassMax", -1.0f, "Pair preselection: maximum invariant mass, checked before filling the pair variables (no mass preselection if negative)"};
+  Configurable<bool> fConfigSkipLikeSign{"cfgSkipLikeSign", false, "Pair preselection: skip the like-sign pairs"};
   Configurable<bool> fUseRemoteField{"cfgUseRemoteField", false, "Chose whether to fetch the magnetic field from ccdb or set it manually"};
   Configurable<float> fConfigMagField{"cfgMagField", 5.0f, "Manually set magnetic field"};
   Configurable<std::string> ccdburl{"ccdburl", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
   Configurable<std::string> grpmagPath{"grpmagPath", "GLO/Config/GRPMagField", "CCDB path of the GRPMagField object"};
   Configurable<bool> fUseAbsDCA{"cfgUseAbsDCA", false, "Use absolute DCA minimization instead of chi^2 minimization in secondary vertexing"};
   Configurable<bool> fPropToPCA{"cfgPropToPCA", false, "Propagate tracks to secondary vertex"};
+  Configurable<float> fFwdVertexingMaxDCA{"cfgFwdVertexingMaxDCA", -1.0f, "Fit only the muon pairs with a straight line DCA below this value, in cm (no preselection if negative)"};
   Configurable<bool> fCorrFullGeo{"cfgCorrFullGeo", false, "Use full geometry to correct for MCS effects in track propagation"};
   Configurable<bool> fNoCorr{"cfgNoCorrFwdProp", false, "Do not correct for MCS effects in track propagation"};
   Configurable<std::string> lutPath{"lutPath", "GLO/Param/MatLUT", "Path of the Lut parametrization"};
@@ -760,7 +856,51 @@ struct AnalysisSameEventPairing {
   std::vector<std::vector<TString>> fTrackHistNames;
   std::vector<std::vector<TString>> fMuonHistNames;
   std::vector<std::vector<TString>> fTrackMuonHistNames;
-  std::vector<AnalysisCompositeCut> fPairCuts;
+  // Handles of the histogram classes above, to fill them without any lookup by name
+  std::vector<std::vector<int>> fTrackHistHandles;
+  std::vector<std::vector<int>> fMuonHistHandles;
+  std::vector<std::vector<int>> fTrackMuonHistHandles;
+  std::vector<AnalysisCompiledCut> fPairCuts; // pair cuts, compiled since they are evaluated for every pair
+
+  // Pairing candidates of the current event, as structure of arrays: the four-momentum (with the mass hypothesis of the pair type),
+  //   charge and selection bits of each track, computed once and reused for all the pairs of the track
+  struct PairingCandidates {
+    std::vector<float> fPx;
+    std::vector<float> fPy;
+    std::vector<float> fPz;
+    std::vector<float> fE;
+    std::vector<int> fSign;
+    std::vector<uint32_t> fFilter;
+
+    void clear()
+    {
+      fPx.clear();
+      fPy.clear();
+      fPz.clear();
+      fE.clear();
+      fSign.clear();
+      fFilter.clear();
+    }
+    void add(float pt, float eta, float phi, int sign, float mass, uint32_t filter)
+    {
+      fPx.push_back(pt * std::cos(phi));
+      fPy.push_back(pt * std::sin(phi));
+      fPz.push_back(pt * std::sinh(eta));
+      fE.push_back(std::sqrt(pt * pt + fPz.back() * fPz.back() + mass * mass));
+      fSign.push_back(sign);
+      fFilter.push_back(filter);
+    }
+    // squared invariant mass of the pair of candidates i and j
+    double mass2(size_t i, size_t j) const
+    {
+      double e = fE[i] + fE[j];
+      double px = fPx[i] + fPx[j];
+      double py = fPy[i] + fPy[j];
+      double pz = fPz[i] + fPz[j];
+      return e * e - px * px - py * py - pz * pz;
+    }
+  };
+  PairingCandidates fCandidates;
 
   void init(o2::framework::InitContext& context)
   {
@@ -780,6 +920,7 @@ struct AnalysisSameEventPairing {
       lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(lutPath));
       VarManager::SetupMatLUTFwdDCAFitter(lut);
     }
+    VarManager::SetupFwdDCAFitterPreselection(fFwdVertexingMaxDCA.value);
 
     VarManager::SetDefaultVarNames();
     fHistMan = new HistogramManager("analysisHistos", "aa", VarManager::kNVars);
@@ -794,7 +935,7 @@ struct AnalysisSameEventPairing {
     if (!cutNamesStr.IsNull()) {
       std::unique_ptr<TObjArray> objArray(cutNamesStr.Tokenize(","));
       for (int icut = 0; icut < objArray->GetEntries(); ++icut) {
-        fPairCuts.push_back(*dqcuts::GetCompositeCut(objArray->At(icut)->GetName()));
+        fPairCuts.emplace_back(*dqcuts::GetCompositeCut(objArray->At(icut)->GetName()));
       }
     }
 
@@ -899,6 +1040,9 @@ struct AnalysisSameEventPairing {
     // ccdb->setCreatedNotAfter(nolaterthan.value);
 
     DefineHistograms(fHistMan, histNames.Data(), fConfigAddSEPHistogram); // define all histograms
+    fTrackHistHandles = GetHistClassHandles(fHistMan, fTrackHistNames);
+    fMuonHistHandles = GetHistClassHandles(fHistMan, fMuonHistNames);
+    fTrackMuonHistHandles = GetHistClassHandles(fHistMan, fTrackMuonHistNames);
     VarManager::SetUseVars(fHistMan->GetUsedVars());                      // provide the list of required variables so that VarManager knows what to fill
     fOutputList.setObject(fHistMan->GetMainHistogramList());
   }
@@ -933,106 +1077,155 @@ struct AnalysisSameEventPairing {
     }
 
     TString cutNames = fConfigTrackCuts.value;
-    std::vector<std::vector<TString>> histNames = fTrackHistNames;
+    const std::vector<std::vector<int>>* histHandles = &fTrackHistHandles;
     if constexpr (TPairType == pairTypeMuMu) {
       cutNames = fConfigMuonCuts.value;
-      histNames = fMuonHistNames;
+      histHandles = &fMuonHistHandles;
     }
     if constexpr (TPairType == pairTypeEMu) {
       cutNames = fConfigMuonCuts.value;
-      histNames = fTrackMuonHistNames;
+      histHandles = &fTrackMuonHistHandles;
     }
     std::unique_ptr<TObjArray> objArray(cutNames.Tokenize(","));
     int ncuts = objArray->GetEntries();
 
-    uint32_t twoTrackFilter = 0;
-    uint32_t dileptonFilterMap = 0;
-    uint32_t dileptonMcDecision = 0; // placeholder, copy of the dqEfficiency.cxx one
     dileptonList.reserve(1);
     dileptonExtraList.reserve(1);
     dileptonInfoList.reserve(1);
     if (fConfigFlatTables.value) {
       dimuonAllList.reserve(1);
     }
-    for (auto& [t1, t2] : combinations(tracks1, tracks2)) {
-      if constexpr (TPairType == VarManager::kDecayToEE || TPairType == VarManager::kDecayToPiPi) {
-        twoTrackFilter = uint32_t(t1.isBarrelSelected()) & uint32_t(t2.isBarrelSelected()) & fTwoTrackFilterMask;
+    if constexpr (TPairType == VarManager::kElectronMuon) {
+      for (auto& [t1, t2] : combinations(tracks1, tracks2)) {
+        uint32_t twoTrackFilter = uint32_t(t1.isBarrelSelected()) & uint32_t(t2.isMuonSelected()) & fTwoTrackFilterMask;
+        if (!twoTrackFilter) { // the tracks must have at least one filter bit in common to continue
+          continue;
+        }
+        fillSameEventPair<TPairType, TEventFillMap, TTrackFillMap>(event, t1, t2, twoTrackFilter, ncuts, *histHandles);
       }
+      return;
+    }
+
+    // Candidate lists: only the tracks having at least one of the selection bits used for pairing, with their four-momenta
+    float legMass = o2::constants::physics::MassElectron;
+    uint32_t filterMask = fTwoTrackFilterMask;
+    if constexpr (TPairType == VarManager::kDecayToMuMu) {
+      legMass = o2::constants::physics::MassMuon;
+      filterMask = fTwoMuonFilterMask;
+    }
+    if constexpr (TPairType == VarManager::kDecayToPiPi) {
+      legMass = o2::constants::physics::MassPionCharged;
+    }
+    std::vector<typename TTracks1::iterator> candidates;
+    candidates.reserve(tracks1.size());
+    fCandidates.clear();
+    for (auto& track : tracks1) {
+      uint32_t filter = 0;
       if constexpr (TPairType == VarManager::kDecayToMuMu) {
-        twoTrackFilter = uint32_t(t1.isMuonSelected()) & uint32_t(t2.isMuonSelected()) & fTwoMuonFilterMask;
-      }
-      if constexpr (TPairType == VarManager::kElectronMuon) {
-        twoTrackFilter = uint32_t(t1.isBarrelSelected()) & uint32_t(t2.isMuonSelected()) & fTwoTrackFilterMask;
+        filter = uint32_t(track.isMuonSelected()) & filterMask;
+      } else {
+        filter = uint32_t(track.isBarrelSelected()) & filterMask;
       }
-      if (!twoTrackFilter) { // the tracks must have at least one filter bit in common to continue
+      if (!filter) {
         continue;
       }
-      constexpr bool eventHasQvector = ((TEventFillMap & VarManager::ObjTypes::ReducedEventQvector) > 0);
-
-      // TODO: FillPair functions need to provide a template argument to discriminate between cases when cov matrix is available or not
-      VarManager::FillPair<TPairType, TTrackFillMap>(t1, t2);
-      if constexpr ((TPairType == pairTypeEE) || (TPairType == pairTypeMuMu)) { // call this just for ee or mumu pairs
-        VarManager::FillPairVertexing<TPairType, TEventFillMap, TTrackFillMap>(event, t1, t2);
-        if constexpr (eventHasQvector) {
-          VarManager::FillPairVn<TPairType>(t1, t2);
+      candidates.push_back(track);
+      fCandidates.add(track.pt(), track.eta(), track.phi(), track.sign(), legMass, filter);
+    }
+
+    // Pairs in the same order as combinations(), with the cheap preselections applied before filling the pair variables
+    const bool massPreselection = (fConfigPairMassMax.value >= 0.0f);
+    const double mass2Min = (fConfigPairMassMin.value > 0.0f ? fConfigPairMassMin.value * fConfigPairMassMin.value : -1.0);
+    const double mass2Max = fConfigPairMassMax.value * fConfigPairMassMax.value;
+    for (size_t i = 0; i < candidates.size(); i++) {
+      for (size_t j = i + 1; j < candidates.size(); j++) {
+        uint32_t twoTrackFilter = fCandidates.fFilter[i] & fCandidates.fFilter[j];
+        if (!twoTrackFilter) { // the tracks must have at least one filter bit in common to continue
+          continue;
+        }
+        if (fConfigSkipLikeSign && fCandidates.fSign[i] * fCandidates.fSign[j] > 0) {
+          continue;
         }
+        if (massPreselection) {
+          double mass2 = fCandidates.mass2(i, j);
+          if (mass2 < mass2Min || mass2 > mass2Max) {
+            continue;
+          }
+        }
+        fillSameEventPair<TPairType, TEventFillMap, TTrackFillMap>(event, candidates[i], candidates[j], twoTrackFilter, ncuts, *histHandles);
       }
+    }
+  }
 
-      // TODO: provide the type of pair to the dilepton table (e.g. ee, mumu, emu...)
-      dileptonFilterMap = twoTrackFilter;
-
-      dileptonList(event, VarManager::fgValues[VarManager::kMass], VarManager::fgValues[VarManager::kPt], VarManager::fgValues[VarManager::kEta], VarManager::fgValues[VarManager::kPhi], t1.sign() + t2.sign(), dileptonFilterMap, dileptonMcDecision);
+  template <int TPairType, uint32_t TEventFillMap, uint32_t TTrackFillMap, typename TEvent, typename TTrack1, typename TTrack2>
+  void fillSameEventPair(TEvent const& event, TTrack1 const& t1, TTrack2 const& t2, uint32_t twoTrackFilter, int ncuts, const std::vector<std::vector<int>>& histHandles)
+  {
+    uint32_t dileptonFilterMap = 0;
+    uint32_t dileptonMcDecision = 0; // placeholder, copy of the dqEfficiency.cxx one
+    constexpr bool eventHasQvector = ((TEventFillMap & VarManager::ObjTypes::ReducedEventQvector) > 0);
 
-      constexpr bool trackHasCov = ((TTrackFillMap & VarManager::ObjTypes::TrackCov) > 0 || (TTrackFillMap & VarManager::ObjTypes::ReducedTrackBarrelCov) > 0);
-      if constexpr ((TPairType == pairTypeEE) && trackHasCov) {
-        dileptonExtraList(t1.globalIndex(), t2.globalIndex(), VarManager::fgValues[VarManager::kVertexingTauz], VarManager::fgValues[VarManager::kVertexingLz], VarManager::fgValues[VarManager::kVertexingLxy]);
-      }
-      constexpr bool muonHasCov = ((TTrackFillMap & VarManager::ObjTypes::MuonCov) > 0 || (TTrackFillMap & VarManager::ObjTypes::ReducedMuonCov) > 0);
-      if constexpr ((TPairType == pairTypeMuMu) && muonHasCov) {
-        // LOGP(info, "mu1 collId = {}, mu2 collId = {}", t1.collisionId(), t2.collisionId());
-        dileptonExtraList(t1.globalIndex(), t2.globalIndex(), VarManager::fgValues[VarManager::kVertexingTauz], VarManager::fgValues[VarManager::kVertexingLz], VarManager::fgValues[VarManager::kVertexingLxy]);
-        dileptonInfoList(t1.collisionId(), event.posX(), event.posY(), event.posZ());
-        if (fConfigFlatTables.value) {
-          dimuonAllList(event.posX(), event.posY(), event.posZ(), event.numContrib(), t1.fwdDcaX(), t1.fwdDcaY(), t2.fwdDcaX(), t2.fwdDcaY(), -999., -999., -999., VarManager::fgValues[VarManager::kMass], false, VarManager::fgValues[VarManager::kPt], VarManager::fgValues[VarManager::kEta], VarManager::fgValues[VarManager::kPhi], t1.sign() + t2.sign(), VarManager::fgValues[VarManager::kVertexingChi2PCA], VarManager::fgValues[VarManager::kVertexingTauz], VarManager::fgValues[VarManager::kVertexingTauzErr], VarManager::fgValues[VarManager::kVertexingTauxy], VarManager::fgValues[VarManager::kVertexingTauxyErr], t1.pt(), t1.eta(), t1.phi(), t1.sign(), t2.pt(), t2.eta(), t2.phi(), t2.sign(), 0., 0., t1.chi2MatchMCHMID(), t2.chi2MatchMCHMID(), t1.chi2MatchMCHMFT(), t2.chi2MatchMCHMFT(), t1.chi2(), t2.chi2(), -999., -999., -999., -999., -999., -999., -999., -999., -999., -999., -999., -999., -999., -999., -999., -999., t1.isAmbiguous(), t2.isAmbiguous());
-        }
+    // TODO: FillPair functions need to provide a template argument to discriminate between cases when cov matrix is available or not
+    VarManager::FillPair<TPairType, TTrackFillMap>(t1, t2);
+    if constexpr ((TPairType == pairTypeEE) || (TPairType == pairTypeMuMu)) { // call this just for ee or mumu pairs
+      VarManager::FillPairVertexing<TPairType, TEventFillMap, TTrackFillMap>(event, t1, t2);
+      if constexpr (eventHasQvector) {
+        VarManager::FillPairVn<TPairType>(t1, t2);
       }
+    }
 
-      if constexpr (eventHasQvector) {
-        dileptonFlowList(VarManager::fgValues[VarManager::kU2Q2], VarManager::fgValues[VarManager::kU3Q3], VarManager::fgValues[VarManager::kCos2DeltaPhi], VarManager::fgValues[VarManager::kCos3DeltaPhi]);
+    // TODO: provide the type of pair to the dilepton table (e.g. ee, mumu, emu...)
+    dileptonFilterMap = twoTrackFilter;
+
+    dileptonList(event, VarManager::fgValues[VarManager::kMass], VarManager::fgValues[VarManager::kPt], VarManager::fgValues[VarManager::kEta], VarManager::fgValues[VarManager::kPhi], t1.sign() + t2.sign(), dileptonFilterMap, dileptonMcDecision);
+
+    constexpr bool trackHasCov = ((TTrackFillMap & VarManager::ObjTypes::TrackCov) > 0 || (TTrackFillMap & VarManager::ObjTypes::ReducedTrackBarrelCov) > 0);
+    if constexpr ((TPairType == pairTypeEE) && trackHasCov) {
+      dileptonExtraList(t1.globalIndex(), t2.globalIndex(), VarManager::fgValues[VarManager::kVertexingTauz], VarManager::fgValues[VarManager::kVertexingLz], VarManager::fgValues[VarManager::kVertexingLxy]);
+    }
+    constexpr bool muonHasCov = ((TTrackFillMap & VarManager::ObjTypes::MuonCov) > 0 || (TTrackFillMap & VarManager::ObjTypes::ReducedMuonCov) > 0);
+    if constexpr ((TPairType == pairTypeMuMu) && muonHasCov) {
+      // LOGP(info, "mu1 collId = {}, mu2 collId = {}", t1.collisionId(), t2.collisionId());
+      dileptonExtraList(t1.globalIndex(), t2.globalIndex(), VarManager::fgValues[VarManager::kVertexingTauz], VarManager::fgValues[VarManager::kVertexingLz], VarManager::fgValues[VarManager::kVertexingLxy]);
+      dileptonInfoList(t1.collisionId(), event.posX(), event.posY(), event.posZ());
+      if (fConfigFlatTables.value) {
+        dimuonAllList(event.posX(), event.posY(), event.posZ(), event.numContrib(), t1.fwdDcaX(), t1.fwdDcaY(), t2.fwdDcaX(), t2.fwdDcaY(), -999., -999., -999., VarManager::fgValues[VarManager::kMass], false, VarManager::fgValues[VarManager::kPt], VarManager::fgValues[VarManager::kEta], VarManager::fgValues[VarManager::kPhi], t1.sign() + t2.sign(), VarManager::fgValues[VarManager::kVertexingChi2PCA], VarManager::fgValues[VarManager::kVertexingTauz], VarManager::fgValues[VarManager::kVertexingTauzErr], VarManager::fgValues[VarManager::kVertexingTauxy], VarManager::fgValues[VarManager::kVertexingTauxyErr], t1.pt(), t1.eta(), t1.phi(), t1.sign(), t2.pt(), t2.eta(), t2.phi(), t2.sign(), 0., 0., t1.chi2MatchMCHMID(), t2.chi2MatchMCHMID(), t1.chi2MatchMCHMFT(), t2.chi2MatchMCHMFT(), t1.chi2(), t2.chi2(), -999., -999., -999., -999., -999., -999., -999., -999., -999., -999., -999., -999., -999., -999., -999., -999., t1.isAmbiguous(), t2.isAmbiguous());
       }
+    }
 
-      int iCut = 0;
-      for (int icut = 0; icut < ncuts; icut++) {
-        if (twoTrackFilter & (uint32_t(1) << icut)) {
+    if constexpr (eventHasQvector) {
+      dileptonFlowList(VarManager::fgValues[VarManager::kU2Q2], VarManager::fgValues[VarManager::kU3Q3], VarManager::fgValues[VarManager::kCos2DeltaPhi], VarManager::fgValues[VarManager::kCos3DeltaPhi]);
+    }
+
+    int iCut = 0;
+    for (int icut = 0; icut < ncuts; icut++) {
+      if (twoTrackFilter & (uint32_t(1) << icut)) {
+        if (t1.sign() * t2.sign() < 0) {
+          fHistMan->FillHistClass(histHandles[iCut][0], VarManager::fgValues);
+        } else {
+          if (t1.sign() > 0) {
+            fHistMan->FillHistClass(histHandles[iCut][1], VarManager::fgValues);
+          } else {
+            fHistMan->FillHistClass(histHandles[iCut][2], VarManager::fgValues);
+          }
+        }
+        iCut++;
+        for (unsigned int iPairCut = 0; iPairCut < fPairCuts.size(); iPairCut++, iCut++) {
+          if (!(fPairCuts[iPairCut].IsSelected(VarManager::fgValues))) // apply pair cuts
+            continue;
           if (t1.sign() * t2.sign() < 0) {
-            fHistMan->FillHistClass(histNames[iCut][0].Data(), VarManager::fgValues);
+            fHistMan->FillHistClass(histHandles[iCut][0], VarManager::fgValues);
           } else {
             if (t1.sign() > 0) {
-              fHistMan->FillHistClass(histNames[iCut][1].Data(), VarManager::fgValues);
+              fHistMan->FillHistClass(histHandles[iCut][1], VarManager::fgValues);
             } else {
-              fHistMan->FillHistClass(histNames[iCut][2].Data(), VarManager::fgValues);
+              fHistMan->FillHistClass(histHandles[iCut][2], VarManager::fgValues);
             }
           }
-          iCut++;
-          for (unsigned int iPairCut = 0; iPairCut < fPairCuts.size(); iPairCut++, iCut++) {
-            AnalysisCompositeCut cut = fPairCuts.at(iPairCut);
-            if (!(cut.IsSelected(VarManager::fgValues))) // apply pair cuts
-              continue;
-            if (t1.sign() * t2.sign() < 0) {
-              fHistMan->FillHistClass(histNames[iCut][0].Data(), VarManager::fgValues);
-            } else {
-              if (t1.sign() > 0) {
-                fHistMan->FillHistClass(histNames[iCut][1].Data(), VarManager::fgValues);
-              } else {
-                fHistMan->FillHistClass(histNames[iCut][2].Data(), VarManager::fgValues);
-              }
-            }
-          }      // end loop (pair cuts)
-        } else { // end if (filter bits)
-          iCut++;
-        }
-      } // end loop (cuts)
-    }   // end loop over pairs
+        }      // end loop (pair cuts)
+      } else { // end if (filter bits)
+        iCut++;
+      }
+    } // end loop (cuts)
   }
 
   void processDecayToEESkimmed(soa::Filtered<MyEventsSelected>::iterator const& event, soa::Filtered<MyBarrelTracksSelected> const& tracks)
@@ -1151,6 +1344,8 @@ struct AnalysisDileptonHadron {
   Configurable<string> fConfigTrackCuts{"cfgLeptonCuts", "jpsiO2MCdebugCuts2", "Comma separated list of barrel track cuts"};
   // comment: add list of subgroups (must define subgroups under )
   Configurable<std::string> fConfigAddDileptonHadHistogram{"cfgAddDileptonHadHistogram", "", "Comma separated list of histograms"};
+  Configurable<float> fConfigHadronDeltaEtaMax{"cfgHadronDeltaEtaMax", -1.0f, "Combine only the hadrons with |eta_hadron - eta_dilepton| below this value (no preselection if negative)"};
+  Configurable<float> fConfigHadronDeltaPhiMax{"cfgHadronDeltaPhiMax", -1.0f, "Combine only the hadrons with |phi_hadron - phi_dilepton| below this value (no preselection if negative)"};
 
   Filter eventFilter = aod::dqanalysisflags::isEventSelected == 1;
   Filter dileptonFilter = aod::reducedpair::mass > 2.92f && aod::reducedpair::mass < 3.16f && aod::reducedpair::sign == 0;
@@ -1167,6 +1362,56 @@ struct AnalysisDileptonHadron {
   //      The current condition should be replaced when bitwise operators will become available in Filter expressions
   int fNHadronCutBit;
 
+  // Selected hadrons of the event, bucketed in eta and phi with buckets as large as the proximity window,
+  //  so that the hadrons close to a dilepton are found in the 3x3 buckets around it
+  struct HadronBuckets {
+    static constexpr float fEtaMin = -2.0f;
+    static constexpr float fEtaMax = 2.0f;
+    int fNEta = 1;
+    int fNPhi = 1;
+    std::vector<std::vector<int>> fBuckets; // positions of the hadrons in the track table
+
+    void configure(float deltaEta, float deltaPhi)
+    {
+      fNEta = std::max(1, static_cast<int>((fEtaMax - fEtaMin) / deltaEta));
+      fNPhi = std::max(1, static_cast<int>(2.0 * M_PI / deltaPhi));
+      fBuckets.assign(fNEta * fNPhi, {});
+    }
+    void clear()
+    {
+      for (auto& bucket : fBuckets) {
+        bucket.clear();
+      }
+    }
+    int etaBin(float eta) const { return std::clamp(static_cast<int>((eta - fEtaMin) / (fEtaMax - fEtaMin) * fNEta), 0, fNEta - 1); }
+    int phiBin(float phi) const
+    {
+      float phiWrapped = std::fmod(phi, static_cast<float>(2.0 * M_PI));
+      if (phiWrapped < 0) {
+        phiWrapped += 2.0 * M_PI;
+      }
+      return std::min(static_cast<int>(phiWrapped / (2.0 * M_PI) * fNPhi), fNPhi - 1);
+    }
+    void add(float eta, float phi, int position) { fBuckets[etaBin(eta) * fNPhi + phiBin(phi)].push_back(position); }
+    // fill the positions of the hadrons in the buckets around (eta, phi)
+    void getNeighbours(float eta, float phi, std::vector<int>& positions) const
+    {
+      positions.clear();
+      int iEta = etaBin(eta);
+      int iPhi = phiBin(phi);
+      for (int jEta = std::max(0, iEta - 1); jEta <= std::min(fNEta - 1, iEta + 1); jEta++) {
+        // with less than 3 phi buckets, each of them is visited only once
+        for (int dPhi = -1; dPhi <= 1 && dPhi < fNPhi - 1; dPhi++) {
+          const auto& bucket = fBuckets[jEta * fNPhi + (iPhi + dPhi + fNPhi) % fNPhi];
+          positions.insert(positions.end(), bucket.begin(), bucket.end());
+        }
+      }
+    }
+  };
+  bool fUseHadronPreselection = false;
+  HadronBuckets fHadronBuckets;
+  std::vector<int> fHadronPositions; // selected hadrons to be combined with the current dilepton
+
   void init(o2::framework::InitContext& context)
   {
     fValuesDilepton = new float[VarManager::kNVars];
@@ -1191,6 +1436,11 @@ struct AnalysisDileptonHadron {
     } else {
       fNHadronCutBit = 0;
     }
+
+    fUseHadronPreselection = (fConfigHadronDeltaEtaMax.value > 0 && fConfigHadronDeltaPhiMax.value > 0);
+    if (fUseHadronPreselection) {
+      fHadronBuckets.configure(fConfigHadronDeltaEtaMax.value, fConfigHadronDeltaPhiMax.value);
+    }
   }
 
   // Template function to run pair - hadron combinations
@@ -1202,6 +1452,23 @@ struct AnalysisDileptonHadron {
     VarManager::FillEvent<TEventFillMap>(event, fValuesHadron);
     VarManager::FillEvent<TEventFillMap>(event, fValuesDilepton);
 
+    // list the selected hadrons once per event
+    std::vector<int> selectedHadrons;
+    if (fUseHadronPreselection) {
+      fHadronBuckets.clear();
+    }
+    int position = 0;
+    for (auto& hadron : tracks) {
+      if (uint32_t(hadron.isBarrelSelected()) & (uint32_t(1) << fNHadronCutBit)) {
+        if (fUseHadronPreselection) {
+          fHadronBuckets.add(hadron.eta(), hadron.phi(), position);
+        } else {
+          selectedHadrons.push_back(position);
+        }
+      }
+      position++;
+    }
+
     // Set the global index offset to find the proper lepton
     // TO DO: remove it once the issue with lepton index is solved
     int indexOffset = -999;
@@ -1232,10 +1499,24 @@ struct AnalysisDileptonHadron {
         continue;
       }
 
+      // hadrons to be combined with this dilepton: all the selected ones, or only the ones close in eta and phi
+      const std::vector<int>* hadronPositions = &selectedHadrons;
+      if (fUseHadronPreselection) {
+        fHadronBuckets.getNeighbours(dilepton.eta(), dilepton.phi(), fHadronPositions);
+        hadronPositions = &fHadronPositions;
+      }
+
       // loop over hadrons
-      for (auto& hadron : tracks) {
-        if (!(uint32_t(hadron.isBarrelSelected()) & (uint32_t(1) << fNHadronCutBit))) {
-          continue;
+      for (int hadronPosition : *hadronPositions) {
+        auto hadron = tracks.iteratorAt(hadronPosition);
+        if (fUseHadronPreselection) {
+          float deltaPhi = std::fabs(hadron.phi() - dilepton.phi());
+          if (deltaPhi > M_PI) {
+            deltaPhi = 2.0 * M_PI - deltaPhi;
+          }
+          if (std::fabs(hadron.eta() - dilepton.eta()) > fConfigHadronDeltaEtaMax.value || deltaPhi > fConfigHadronDeltaPhiMax.value) {
+            continue;
+          }
         }
 
         // if the hadron is either of the electron legs, continue
@@ -1334,3 +1615,19 @@ void DefineHistograms(HistogramManager* histMan, TString histClasses, Configurab
     }
   } // end loop over histogram classes
 }
+
+std::vector<std::vector<int>> GetHistClassHandles(HistogramManager* histMan, std::vector<std::vector<TString>> const& histNames)
+{
+  //
+  // Convert the names of the histogram classes into the handles of the histogram manager
+  //
+  std::vector<std::vector<int>> handles;
+  for (auto const& names : histNames) {
+    std::vector<int> classHandles;
+    for (auto const& name : names) {
+      classHandles.push_back(histMan->GetHistClassHandle(name.Data()));
+    }
+    handles.push_back(classHandles);
+  }
+  return handles;
+}
@@ -18,7 +18,7 @@
 //    Please write to: daiki.sekihata@cern.ch
 //
 #include <array>
-#include <map>
+#include <vector>
 #include "Math/Vector4D.h"
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
@@ -155,9 +155,16 @@ struct v0selector {
     }
   }
 
+  std::vector<uint8_t> pidmap;       // V0 bits per track, indexed by the track global index
+  std::vector<uint8_t> goodDaughter; // daughter selection per track, evaluated once for all its V0s
+
   void process(aod::V0Datas const& V0s, FullTracksExt const& tracks, aod::Collisions const&)
   {
-    std::map<int, uint8_t> pidmap;
+    pidmap.assign(tracks.size(), 0);
+    goodDaughter.resize(tracks.size());
+    for (auto& track : tracks) {
+      goodDaughter[track.globalIndex()] = fabs(track.eta()) <= 0.9 && track.tpcNClsCrossedRows() >= mincrossedrows && track.tpcChi2NCl() <= maxchi2tpc && fabs(track.dcaXY()) >= dcamin && fabs(track.dcaXY()) <= dcamax;
+    }
 
     for (auto& V0 : V0s) {
       // if (!(V0.posTrack_as<FullTracksExt>().trackType() & o2::aod::track::TPCrefit)) {
@@ -171,50 +178,21 @@ struct v0selector {
       if (fillhisto) {
         registry.fill(HIST("hV0Candidate"), 1);
       }
-      if (fabs(V0.posTrack_as<FullTracksExt>().eta()) > 0.9) {
-        continue;
-      }
-      if (fabs(V0.negTrack_as<FullTracksExt>().eta()) > 0.9) {
-        continue;
-      }
-
-      if (V0.posTrack_as<FullTracksExt>().tpcNClsCrossedRows() < mincrossedrows) {
-        continue;
-      }
-      if (V0.negTrack_as<FullTracksExt>().tpcNClsCrossedRows() < mincrossedrows) {
-        continue;
-      }
-
-      if (V0.posTrack_as<FullTracksExt>().tpcChi2NCl() > maxchi2tpc) {
-        continue;
-      }
-      if (V0.negTrack_as<FullTracksExt>().tpcChi2NCl() > maxchi2tpc) {
-        continue;
-      }
-
-      if (fabs(V0.posTrack_as<FullTracksExt>().dcaXY()) < dcamin) {
-        continue;
-      }
-      if (fabs(V0.negTrack_as<FullTracksExt>().dcaXY()) < dcamin) {
-        continue;
-      }
-
-      if (fabs(V0.posTrack_as<FullTracksExt>().dcaXY()) > dcamax) {
-        continue;
-      }
-      if (fabs(V0.negTrack_as<FullTracksExt>().dcaXY()) > dcamax) {
+      if (!goodDaughter[V0.posTrackId()] || !goodDaughter[V0.negTrackId()]) {
         continue;
       }
 
-      if (V0.posTrack_as<FullTracksExt>().sign() * V0.negTrack_as<FullTracksExt>().sign() > 0) { // reject same sign pair
+      auto const& posTrack = V0.posTrack_as<FullTracksExt>();
+      auto const& negTrack = V0.negTrack_as<FullTracksExt>();
+      if (posTrack.sign() * negTrack.sign() > 0) { // reject same sign pair
         continue;
       }
 
-      // if (V0.posTrack_as<FullTracksExt>().collisionId() != V0.negTrack_as<FullTracksExt>().collisionId()) {
+      // if (posTrack.collisionId() != negTrack.collisionId()) {
       //   continue;
       // }
 
-      // if (!V0.posTrack_as<FullTracksExt>().has_collision() || !V0.negTrack_as<FullTracksExt>().has_collision()) {
+      // if (!posTrack.has_collision() || !negTrack.has_collision()) {
       //   continue;
       // }
 
@@ -251,10 +229,10 @@ struct v0selector {
       if (fillhisto) {
         registry.fill(HIST("hV0Pt"), V0.pt());
         registry.fill(HIST("hV0EtaPhi"), V0.phi(), V0.eta());
-        registry.fill(HIST("hDCAxyPosToPV"), V0.posTrack_as<FullTracksExt>().dcaXY());
-        registry.fill(HIST("hDCAxyNegToPV"), V0.negTrack_as<FullTracksExt>().dcaXY());
-        registry.fill(HIST("hDCAzPosToPV"), V0.posTrack_as<FullTracksExt>().dcaZ());
-        registry.fill(HIST("hDCAzNegToPV"), V0.negTrack_as<FullTracksExt>().dcaZ());
+        registry.fill(HIST("hDCAxyPosToPV"), posTrack.dcaXY());
+        registry.fill(HIST("hDCAxyNegToPV"), negTrack.dcaXY());
+        registry.fill(HIST("hDCAzPosToPV"), posTrack.dcaZ());
+        registry.fill(HIST("hDCAzNegToPV"), negTrack.dcaZ());
         registry.fill(HIST("hV0APplot"), V0.alpha(), V0.qtarm());
         registry.fill(HIST("hV0Radius"), V0radius);
         registry.fill(HIST("hV0CosPA"), V0CosinePA);
@@ -272,7 +250,7 @@ struct v0selector {
           registry.fill(HIST("hMassGamma"), V0radius, mGamma);
           registry.fill(HIST("hV0Psi"), psipair, mGamma);
         }
-        if (mGamma < v0max_mee && TMath::Abs(V0.posTrack_as<FullTracksExt>().tpcNSigmaEl()) < 5 && TMath::Abs(V0.negTrack_as<FullTracksExt>().tpcNSigmaEl()) < 5 && psipair < maxpsipair) {
+        if (mGamma < v0max_mee && TMath::Abs(posTrack.tpcNSigmaEl()) < 5 && TMath::Abs(negTrack.tpcNSigmaEl()) < 5 && psipair < maxpsipair) {
           pidmap[V0.posTrackId()] |= (uint8_t(1) << kGamma);
           pidmap[V0.negTrackId()] |= (uint8_t(1) << kGamma);
           if (fillhisto) {
@@ -283,7 +261,7 @@ struct v0selector {
         if (fillhisto) {
           registry.fill(HIST("hMassK0S"), V0radius, mK0S);
         }
-        if ((0.48 < mK0S && mK0S < 0.51) && TMath::Abs(V0.posTrack_as<FullTracksExt>().tpcNSigmaPi()) < 5 && TMath::Abs(V0.negTrack_as<FullTracksExt>().tpcNSigmaPi()) < 5) {
+        if ((0.48 < mK0S && mK0S < 0.51) && TMath::Abs(posTrack.tpcNSigmaPi()) < 5 && TMath::Abs(negTrack.tpcNSigmaPi()) < 5) {
           pidmap[V0.posTrackId()] |= (uint8_t(1) << kK0S);
           pidmap[V0.negTrackId()] |= (uint8_t(1) << kK0S);
         }
@@ -291,7 +269,7 @@ struct v0selector {
         if (fillhisto) {
           registry.fill(HIST("hMassLambda"), V0radius, mLambda);
         }
-        if (v0id == kLambda && (1.110 < mLambda && mLambda < 1.120) && TMath::Abs(V0.posTrack_as<FullTracksExt>().tpcNSigmaPr()) < 5 && TMath::Abs(V0.negTrack_as<FullTracksExt>().tpcNSigmaPi()) < 5) {
+        if (v0id == kLambda && (1.110 < mLambda && mLambda < 1.120) && TMath::Abs(posTrack.tpcNSigmaPr()) < 5 && TMath::Abs(negTrack.tpcNSigmaPi()) < 5) {
           pidmap[V0.posTrackId()] |= (uint8_t(1) << kLambda);
           pidmap[V0.negTrackId()] |= (uint8_t(1) << kLambda);
         }
@@ -299,7 +277,7 @@ struct v0selector {
         if (fillhisto) {
           registry.fill(HIST("hMassAntiLambda"), V0radius, mAntiLambda);
         }
-        if ((1.110 < mAntiLambda && mAntiLambda < 1.120) && TMath::Abs(V0.posTrack_as<FullTracksExt>().tpcNSigmaPi()) < 5 && TMath::Abs(V0.negTrack_as<FullTracksExt>().tpcNSigmaPr()) < 5) {
+        if ((1.110 < mAntiLambda && mAntiLambda < 1.120) && TMath::Abs(posTrack.tpcNSigmaPi()) < 5 && TMath::Abs(negTrack.tpcNSigmaPr()) < 5) {
           pidmap[V0.posTrackId()] |= (uint8_t(1) << kAntiLambda);
           pidmap[V0.negTrackId()] |= (uint8_t(1) << kAntiLambda);
         }
@@ -310,6 +288,7 @@ struct v0selector {
 
     } // end of V0 loop
 
+    v0bits.reserve(tracks.size());
     for (auto& track : tracks) {
       // printf("setting pidmap[%lld] = %d\n",track.globalIndex(),pidmap[track.globalIndex()]);
       v0bits(pidmap[track.globalIndex()]);
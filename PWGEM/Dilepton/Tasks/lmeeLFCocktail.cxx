@@ -116,6 +116,11 @@ struct lmeelfcocktail {
   TH1F** fh_DCAtemplates;
 
   MomentumSmearer smearer;
+  // electrons of the event, smeared in one batch before the loop over the tracks
+  std::vector<int> fSmearedIndex; // index of each track in the smeared electrons, -1 if not an electron
+  std::vector<int> fSmearCharge;
+  std::vector<float> fPtGen, fEtaGen, fPhiGen;
+  std::vector<float> fPtSmeared, fEtaSmeared, fPhiSmeared;
 
   Double_t eMass;
 
@@ -209,6 +214,11 @@ struct lmeelfcocktail {
     std::vector<PxPyPzEVector> eBuff;
     std::vector<Char_t> echBuff;
     std::vector<Double_t> eweightBuff;
+    std::vector<XYZVector> eunitBuff; // direction of the electrons
+    std::vector<bool> eaccBuff;       // electron in the pT and eta acceptance
+    const double cosMinOpAng = TMath::Cos(fConfigMinOpAng);
+
+    smearElectrons(mctracks);
 
     bool skipNext = false;
 
@@ -239,6 +249,8 @@ struct lmeelfcocktail {
           eBuff.push_back(e);
           echBuff.push_back(ech);
           eweightBuff.push_back(eweight);
+          eunitBuff.push_back(e.Vect().Unit());
+          eaccBuff.push_back(e.Pt() > fConfigMinPt && e.Pt() < fConfigMaxPt && TMath::Abs(e.Eta()) < fConfigMaxEta);
           // loop the buffer and pair
           //------------------------
           for (Int_t jj = eBuff.size() - 2; jj >= 0; jj--) {
@@ -252,7 +264,7 @@ struct lmeelfcocktail {
               registry.fill(HIST("LSpp_orig"), dielectron.M(), dielectron.Pt(), dielectron_weight);
             if (dielectron_ch < 0)
               registry.fill(HIST("LSmm_orig"), dielectron.M(), dielectron.Pt(), dielectron_weight);
-            if (e.Pt() > fConfigMinPt && eBuff.at(jj).Pt() > fConfigMinPt && e.Pt() < fConfigMaxPt && eBuff.at(jj).Pt() < fConfigMaxPt && TMath::Abs(e.Eta()) < fConfigMaxEta && TMath::Abs(eBuff.at(jj).Eta()) < fConfigMaxEta && e.Vect().Unit().Dot(eBuff.at(jj).Vect().Unit()) < TMath::Cos(fConfigMinOpAng)) {
+            if (eaccBuff.back() && eaccBuff[jj] && eunitBuff.back().Dot(eunitBuff[jj]) < cosMinOpAng) {
               if (dielectron_ch == 0)
                 registry.fill(HIST("ULS"), dielectron.M(), dielectron.Pt(), dielectron_weight);
               if (dielectron_ch > 0)
@@ -433,16 +445,8 @@ struct lmeelfcocktail {
 
         // Resolution and acceptance
         //-------------------------
-        int ch1 = 1;
-        int ch2 = 1;
-        if (mctrack.GetPdgCode() > 0) {
-          ch1 = -1;
-        }
-        if (mctrack2.GetPdgCode() > 0) {
-          ch2 = -1;
-        }
-        dau1 = applySmearingPxPyPzE(ch1, dau1);
-        dau2 = applySmearingPxPyPzE(ch2, dau2);
+        dau1 = getSmearedElectron(trackID);
+        dau2 = getSmearedElectron(trackID + 1);
 
         treeWords.fpass = true;
         if (dau1.Pt() < fConfigMinPt || dau2.Pt() < fConfigMinPt)
@@ -696,6 +700,42 @@ struct lmeelfcocktail {
     eBuff.clear();
     echBuff.clear();
     eweightBuff.clear();
+    eunitBuff.clear();
+    eaccBuff.clear();
+  }
+
+  /// Smears all the electrons of the event in one call to the smearer
+  template <typename TMCTracks>
+  void smearElectrons(TMCTracks const& mctracks)
+  {
+    fSmearedIndex.assign(mctracks.size(), -1);
+    fSmearCharge.clear();
+    fPtGen.clear();
+    fEtaGen.clear();
+    fPhiGen.clear();
+    for (size_t i = 0; i < mctracks.size(); i++) {
+      auto const& mctrack = mctracks[i];
+      if (abs(mctrack.GetPdgCode()) != 11) {
+        continue;
+      }
+      PxPyPzEVector vec(mctrack.Px(), mctrack.Py(), mctrack.Pz(), mctrack.GetEnergy());
+      fSmearedIndex[i] = fSmearCharge.size();
+      fSmearCharge.push_back(mctrack.GetPdgCode() > 0 ? -1 : 1);
+      fPtGen.push_back(vec.Pt());
+      fEtaGen.push_back(vec.Eta());
+      fPhiGen.push_back(vec.Phi());
+    }
+    fPtSmeared.resize(fPtGen.size());
+    fEtaSmeared.resize(fPtGen.size());
+    fPhiSmeared.resize(fPtGen.size());
+    smearer.applySmearing(fSmearCharge, fPtGen, fEtaGen, fPhiGen, fPtSmeared, fEtaSmeared, fPhiSmeared);
+  }
+
+  /// \param trackID index of an electron in the MC tracks of the event
+  PxPyPzEVector getSmearedElectron(int trackID)
+  {
+    const int i = fSmearedIndex[trackID];
+    return getPxPyPzE(fPtSmeared[i], fEtaSmeared[i], fPhiSmeared[i]);
   }
 
   Double_t PhiV(PxPyPzEVector e1, PxPyPzEVector e2)
@@ -717,9 +757,14 @@ struct lmeelfcocktail {
 
   PxPyPzEVector applySmearingPxPyPzE(int ch, PxPyPzEVector vec)
   {
-    PxPyPzEVector vecsmeared;
     float ptsmeared, etasmeared, phismeared;
     smearer.applySmearing(ch, vec.Pt(), vec.Eta(), vec.Phi(), ptsmeared, etasmeared, phismeared);
+    return getPxPyPzE(ptsmeared, etasmeared, phismeared);
+  }
+
+  PxPyPzEVector getPxPyPzE(float ptsmeared, float etasmeared, float phismeared)
+  {
+    PxPyPzEVector vecsmeared;
     float sPx = ptsmeared * cos(phismeared);
     float sPy = ptsmeared * sin(phismeared);
     float sPz = ptsmeared * sinh(etasmeared);
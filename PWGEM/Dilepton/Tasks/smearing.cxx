@@ -13,6 +13,7 @@
 // Analysis task to produce smeared pt,eta,phi for electrons/muons in dilepton analysis
 //    Please write to: daiki.sekihata@cern.ch
 
+#include <vector>
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
@@ -41,6 +42,10 @@ struct ApplySmearing {
   Configurable<std::string> fConfigResPhiNegHistName{"cfgResPhiNegHistName", "PhiEleResArr", "hisogram for phi neg in resolution file"};
 
   MomentumSmearer smearer;
+  // leptons of the current table, smeared in one batch
+  std::vector<int> vCharge;
+  std::vector<float> vPtGen, vEtaGen, vPhiGen;
+  std::vector<float> vPtSmeared, vEtaSmeared, vPhiSmeared;
 
   void init(InitContext& context)
   {
@@ -55,24 +60,33 @@ struct ApplySmearing {
   template <typename TTracksMC>
   void applySmearing(TTracksMC const& tracksMC)
   {
+    vCharge.clear();
+    vPtGen.clear();
+    vEtaGen.clear();
+    vPhiGen.clear();
     for (auto& mctrack : tracksMC) {
-      float ptgen = mctrack.pt();
-      float etagen = mctrack.eta();
-      float phigen = mctrack.phi();
-
       int pdgCode = mctrack.pdgCode();
       if (abs(pdgCode) == fPdgCode) {
-        int ch = -1;
-        if (pdgCode < 0) {
-          ch = 1;
-        }
-        // apply smearing for electrons or muons.
-        float ptsmeared, etasmeared, phismeared;
-        smearer.applySmearing(ch, ptgen, etagen, phigen, ptsmeared, etasmeared, phismeared);
-        smearedtrack(ptsmeared, etasmeared, phismeared);
+        vCharge.push_back(pdgCode < 0 ? 1 : -1);
+        vPtGen.push_back(mctrack.pt());
+        vEtaGen.push_back(mctrack.eta());
+        vPhiGen.push_back(mctrack.phi());
+      }
+    }
+    // apply smearing for electrons or muons.
+    vPtSmeared.resize(vPtGen.size());
+    vEtaSmeared.resize(vPtGen.size());
+    vPhiSmeared.resize(vPtGen.size());
+    smearer.applySmearing(vCharge, vPtGen, vEtaGen, vPhiGen, vPtSmeared, vEtaSmeared, vPhiSmeared);
+
+    size_t iLepton = 0;
+    for (auto& mctrack : tracksMC) {
+      if (abs(mctrack.pdgCode()) == fPdgCode) {
+        smearedtrack(vPtSmeared[iLepton], vEtaSmeared[iLepton], vPhiSmeared[iLepton]);
+        iLepton++;
       } else {
         // don't apply smearing
-        smearedtrack(ptgen, etagen, phigen);
+        smearedtrack(mctrack.pt(), mctrack.eta(), mctrack.phi());
       }
     }
   }
@@ -11,11 +11,19 @@
 //
 //
 // Class to produce smeared pt,eta,phi
+//
+// The resolution histograms are converted at init() into cumulative distributions, which are sampled
+// as TH1::GetRandom() does, with a random generator owned by the smearer.
 
 #ifndef PWGEM_DILEPTON_UTILS_MOMENTUMSMEARER_H_
 #define PWGEM_DILEPTON_UTILS_MOMENTUMSMEARER_H_
 
+#include <algorithm>
+#include <span>
+#include <vector>
 #include <TH1D.h>
+#include <TH2D.h>
+#include <TRandom3.h>
 #include <TString.h>
 #include <TGrid.h>
 #include <TObjArray.h>
@@ -25,6 +33,90 @@
 class MomentumSmearer
 {
  public:
+  /// Cumulative distribution of a resolution histogram
+  struct ResolutionCDF {
+    std::vector<double> edges; ///< bin edges of the histogram
+    std::vector<double> cdf;   ///< normalised integral below each edge, empty if the histogram gives no smearing
+
+    void set(const TH1* hist)
+    {
+      edges.clear();
+      cdf.clear();
+      if (!hist || hist->GetEntries() <= 0) {
+        return;
+      }
+      const int nBins = hist->GetNbinsX();
+      double integral = 0.;
+      for (int i = 1; i <= nBins; ++i) {
+        integral += hist->GetBinContent(i);
+      }
+      if (integral <= 0.) {
+        return;
+      }
+      edges.resize(nBins + 1);
+      cdf.resize(nBins + 1);
+      double sum = 0.;
+      for (int i = 0; i <= nBins; ++i) {
+        edges[i] = hist->GetXaxis()->GetBinLowEdge(i + 1);
+        cdf[i] = sum / integral;
+        if (i < nBins) {
+          sum += hist->GetBinContent(i + 1);
+        }
+      }
+      cdf[nBins] = 1.;
+    }
+
+    /// \param r uniform random number in [0, 1)
+    /// \return the value of the inverse cumulative distribution, linearly interpolated in the bin
+    double sample(double r) const
+    {
+      if (cdf.empty()) {
+        return 0.;
+      }
+      const int nBins = edges.size() - 1;
+      const int bin = std::clamp(static_cast<int>(std::upper_bound(cdf.begin(), cdf.end(), r) - cdf.begin()) - 1, 0, nBins - 1);
+      const double width = cdf[bin + 1] - cdf[bin];
+      double x = edges[bin];
+      if (width > 0. && r > cdf[bin]) {
+        x += (edges[bin + 1] - edges[bin]) * (r - cdf[bin]) / width;
+      }
+      return x;
+    }
+  };
+
+  /// Resolution of a quantity: the pT axis of the map and one cumulative distribution per pT bin
+  struct ResolutionMap {
+    std::vector<double> ptEdges;
+    std::vector<ResolutionCDF> cdfs; ///< indexed as the resolution array, the pT bins start at 1
+
+    void set(TObjArray* arr, TObjArray* arrAxis)
+    {
+      ptEdges.clear();
+      cdfs.clear();
+      if (!arr || !arrAxis) {
+        return;
+      }
+      const TAxis* axis = reinterpret_cast<TH2D*>(arrAxis->At(0))->GetXaxis();
+      for (int i = 1; i <= axis->GetNbins() + 1; ++i) {
+        ptEdges.push_back(axis->GetBinLowEdge(i));
+      }
+      cdfs.resize(arr->GetLast() + 1);
+      for (int i = 1; i <= arr->GetLast(); ++i) {
+        cdfs[i].set(reinterpret_cast<TH1D*>(arr->At(i)));
+      }
+    }
+
+    /// \return the distribution of the pT bin, the pT outside of the map taking the first or last bin
+    const ResolutionCDF* get(float pt) const
+    {
+      if (cdfs.size() < 2) {
+        return nullptr;
+      }
+      const int bin = std::upper_bound(ptEdges.begin(), ptEdges.end(), pt) - ptEdges.begin();
+      return &cdfs[std::clamp(bin, 1, static_cast<int>(cdfs.size()) - 1)];
+    }
+  };
+
   /// Default constructor
   MomentumSmearer() = default;
 
@@ -93,59 +185,33 @@ class MomentumSmearer
     fArrResoPhi_Neg = ArrResoPhi_Neg;
     fFile->Close();
 
+    // the phi maps of both charges are binned with the pT axis of the positive one
+    fResoPt.set(fArrResoPt, fArrResoPt);
+    fResoEta.set(fArrResoEta, fArrResoEta);
+    fResoPhiPos.set(fArrResoPhi_Pos, fArrResoPhi_Pos);
+    fResoPhiNeg.set(fArrResoPhi_Neg, fArrResoPhi_Pos);
+
     fInitialized = true;
   }
 
   void applySmearing(const int ch, const float ptgen, const float etagen, const float phigen, float& ptsmeared, float& etasmeared, float& phismeared)
   {
     // smear pt
-    int ptbin = reinterpret_cast<TH2D*>(fArrResoPt->At(0))->GetXaxis()->FindBin(ptgen);
-    if (ptbin < 1) {
-      ptbin = 1;
-    }
-    if (ptbin > fArrResoPt->GetLast()) {
-      ptbin = fArrResoPt->GetLast();
-    }
-    float smearing = 0.;
-    TH1D* thisHist = reinterpret_cast<TH1D*>(fArrResoPt->At(ptbin));
-    if (thisHist->GetEntries() > 0) {
-      smearing = thisHist->GetRandom() * ptgen;
-    }
-    ptsmeared = ptgen - smearing;
-
+    ptsmeared = ptgen - sample(fResoPt, ptgen) * ptgen;
     // smear eta
-    ptbin = reinterpret_cast<TH2D*>(fArrResoEta->At(0))->GetXaxis()->FindBin(ptgen);
-    if (ptbin < 1) {
-      ptbin = 1;
-    }
-    if (ptbin > fArrResoEta->GetLast()) {
-      ptbin = fArrResoEta->GetLast();
-    }
-    smearing = 0.;
-    thisHist = reinterpret_cast<TH1D*>(fArrResoEta->At(ptbin));
-    if (thisHist->GetEntries() > 0) {
-      smearing = thisHist->GetRandom();
-    }
-    etasmeared = etagen - smearing;
-
+    etasmeared = etagen - sample(fResoEta, ptgen);
     // smear phi
-    ptbin = reinterpret_cast<TH2D*>(fArrResoPhi_Pos->At(0))->GetXaxis()->FindBin(ptgen);
-    if (ptbin < 1) {
-      ptbin = 1;
-    }
-    if (ptbin > fArrResoPhi_Pos->GetLast()) {
-      ptbin = fArrResoPhi_Pos->GetLast();
-    }
-    smearing = 0.;
-    if (ch < 0) {
-      thisHist = reinterpret_cast<TH1D*>(fArrResoPhi_Neg->At(ptbin));
-    } else {
-      thisHist = reinterpret_cast<TH1D*>(fArrResoPhi_Pos->At(ptbin));
-    }
-    if (thisHist->GetEntries() > 0) {
-      smearing = thisHist->GetRandom();
+    phismeared = phigen - sample(ch < 0 ? fResoPhiNeg : fResoPhiPos, ptgen);
+  }
+
+  /// Smears a batch of leptons, with one span per quantity
+  /// All input spans must have at least the size of the output spans
+  void applySmearing(std::span<const int> ch, std::span<const float> ptgen, std::span<const float> etagen, std::span<const float> phigen,
+                     std::span<float> ptsmeared, std::span<float> etasmeared, std::span<float> phismeared)
+  {
+    for (size_t i = 0; i < ptsmeared.size(); ++i) {
+      applySmearing(ch[i], ptgen[i], etagen[i], phigen[i], ptsmeared[i], etasmeared[i], phismeared[i]);
     }
-    phismeared = phigen - smearing;
   }
 
   // setters
@@ -154,6 +220,7 @@ class MomentumSmearer
   void setResEtaHistName(TString resEtaHistName) { fResEtaHistName = resEtaHistName; }
   void setResPhiPosHistName(TString resPhiPosHistName) { fResPhiPosHistName = resPhiPosHistName; }
   void setResPhiNegHistName(TString resPhiNegHistName) { fResPhiNegHistName = resPhiNegHistName; }
+  void setSeed(UInt_t seed) { fRandom.SetSeed(seed); }
 
   // getters
   TString getResFileName() { return fResFileName; }
@@ -177,6 +244,17 @@ class MomentumSmearer
   TObjArray* fArrResoEta;
   TObjArray* fArrResoPhi_Pos;
   TObjArray* fArrResoPhi_Neg;
+  ResolutionMap fResoPt;
+  ResolutionMap fResoEta;
+  ResolutionMap fResoPhiPos;
+  ResolutionMap fResoPhiNeg;
+  TRandom3 fRandom; // same default seed as gRandom
+
+  float sample(const ResolutionMap& map, float ptgen)
+  {
+    const ResolutionCDF* cdf = map.get(ptgen);
+    return cdf ? cdf->sample(fRandom.Rndm()) : 0.f;
+  }
 };
 
 #endif // PWGEM_DILEPTON_UTILS_MOMENTUMSMEARER_H_
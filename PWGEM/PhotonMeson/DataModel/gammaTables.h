@@ -9,6 +9,9 @@
 // granted to it by virtue of its status as an Intergovernmental Organization
 // or submit itself to any jurisdiction.
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <vector>
 
 #include "Framework/AnalysisDataModel.h"
@@ -273,6 +276,69 @@ DECLARE_SOA_TABLE(V0PhotonsKF, "AOD", "V0PHOTONKF", //!
 // iterators
 using V0PhotonKF = V0PhotonsKF::iterator;
 
+namespace v0photoncompact
+{
+// Bits of the packed legs: the TPC n sigma of the electron hypothesis in steps of legNSigmaStep,
+// the detectors of the track and its number of ITS clusters
+enum LegBits : uint16_t {
+  kNSigmaElMask = 0xff,
+  kHasITS = 1 << 8,
+  kHasTPC = 1 << 9,
+  kHasTRD = 1 << 10,
+  kHasTOF = 1 << 11,
+  kITSNClsShift = 12,
+  kITSNClsMask = 0x7 << kITSNClsShift
+};
+constexpr float legNSigmaStep = 0.1f; // |n sigma| up to 12.7
+
+template <typename TTrack>
+uint16_t packLeg(TTrack const& track)
+{
+  const auto nSigma = static_cast<int8_t>(std::clamp(std::lround(track.tpcNSigmaEl() / legNSigmaStep), -127l, 127l));
+  uint16_t bits = static_cast<uint8_t>(nSigma);
+  bits |= track.hasITS() ? kHasITS : 0;
+  bits |= track.hasTPC() ? kHasTPC : 0;
+  bits |= track.hasTRD() ? kHasTRD : 0;
+  bits |= track.hasTOF() ? kHasTOF : 0;
+  bits |= std::min<int>(track.itsNCls(), 7) << kITSNClsShift;
+  return bits;
+}
+
+DECLARE_SOA_COLUMN(PosLeg, posLeg, uint16_t); //! packed information of the positive leg, see LegBits
+DECLARE_SOA_COLUMN(NegLeg, negLeg, uint16_t); //! packed information of the negative leg, see LegBits
+
+DECLARE_SOA_DYNAMIC_COLUMN(TPCNSigmaElPos, tpcNSigmaElPos, [](uint16_t leg) -> float { return static_cast<int8_t>(leg & kNSigmaElMask) * legNSigmaStep; });
+DECLARE_SOA_DYNAMIC_COLUMN(TPCNSigmaElNeg, tpcNSigmaElNeg, [](uint16_t leg) -> float { return static_cast<int8_t>(leg & kNSigmaElMask) * legNSigmaStep; });
+DECLARE_SOA_DYNAMIC_COLUMN(ITSNClsPos, itsNClsPos, [](uint16_t leg) -> int { return (leg & kITSNClsMask) >> kITSNClsShift; });
+DECLARE_SOA_DYNAMIC_COLUMN(ITSNClsNeg, itsNClsNeg, [](uint16_t leg) -> int { return (leg & kITSNClsMask) >> kITSNClsShift; });
+DECLARE_SOA_DYNAMIC_COLUMN(HasLegBitsPos, hasLegBitsPos, [](uint16_t leg, uint16_t mask) -> bool { return (leg & mask) == mask; }); //! e.g. hasLegBitsPos(kHasITS | kHasTPC)
+DECLARE_SOA_DYNAMIC_COLUMN(HasLegBitsNeg, hasLegBitsNeg, [](uint16_t leg, uint16_t mask) -> bool { return (leg & mask) == mask; });
+} // namespace v0photoncompact
+// KF photons with packed legs, for the analyses which do not need the V0Legs table
+DECLARE_SOA_TABLE(V0PhotonsCompact, "AOD", "V0PHOTONCMP", //!
+                  o2::soa::Index<>, v0photonkf::CollisionId,
+                  v0photonkf::Vx, v0photonkf::Vy, v0photonkf::Vz,
+                  v0photonkf::Px, v0photonkf::Py, v0photonkf::Pz,
+                  v0photonkf::MGamma, v0photonkf::CosPA, v0photonkf::PCA,
+                  v0photonkf::Alpha, v0photonkf::QtArm, v0photonkf::PsiPair,
+                  v0photonkf::ChiSquareNDF,
+                  v0photoncompact::PosLeg, v0photoncompact::NegLeg,
+                  // dynamic column
+                  v0photonkf::E<v0photonkf::Px, v0photonkf::Py, v0photonkf::Pz>,
+                  v0photonkf::Pt<v0photonkf::Px, v0photonkf::Py>,
+                  v0photonkf::Eta<v0photonkf::Px, v0photonkf::Py, v0photonkf::Pz>,
+                  v0photonkf::Phi<v0photonkf::Px, v0photonkf::Py>,
+                  v0photonkf::P<v0photonkf::Px, v0photonkf::Py, v0photonkf::Pz>,
+                  v0photonkf::V0Radius<v0photonkf::Vx, v0photonkf::Vy>,
+                  v0photoncompact::TPCNSigmaElPos<v0photoncompact::PosLeg>,
+                  v0photoncompact::TPCNSigmaElNeg<v0photoncompact::NegLeg>,
+                  v0photoncompact::ITSNClsPos<v0photoncompact::PosLeg>,
+                  v0photoncompact::ITSNClsNeg<v0photoncompact::NegLeg>,
+                  v0photoncompact::HasLegBitsPos<v0photoncompact::PosLeg>,
+                  v0photoncompact::HasLegBitsNeg<v0photoncompact::NegLeg>);
+// iterators
+using V0PhotonCompact = V0PhotonsCompact::iterator;
+
 namespace MCTracksTrue
 {
 DECLARE_SOA_COLUMN(SameMother, sameMother, bool); // Do the tracks have the same mother particle?
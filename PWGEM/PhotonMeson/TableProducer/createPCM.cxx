@@ -14,7 +14,9 @@
 // This code produces photon data tables.
 //    Please write to: daiki.sekihata@cern.ch
 
+#include <algorithm>
 #include <array>
+#include <vector>
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
@@ -80,6 +82,8 @@ struct createPCM {
   Configurable<float> maxchi2tpc{"maxchi2tpc", 4.0, "max chi2/NclsTPC"};
   Configurable<float> min_tpcdEdx{"min_tpcdEdx", 30.0, "min TPC dE/dx"};
   Configurable<float> max_tpcdEdx{"max_tpcdEdx", 110.0, "max TPC dE/dx"};
+  Configurable<float> maxDeltaTgl{"maxDeltaTgl", -1.f, "max. difference of tan(lambda) between the legs before the fit, negative to fit all pairs"};
+  Configurable<bool> doFinderQA{"doFinderQA", false, "also fit the pairs rejected by maxDeltaTgl, and count the V0s they would give"};
 
   int mRunNumber;
   float d_bz;
@@ -87,11 +91,25 @@ struct createPCM {
   o2::base::MatLayerCylSet* lut = nullptr;
   o2::vertexing::DCAFitterN<2> fitter;
 
+  // Selected legs of the current collision
+  struct Leg {
+    float tgl;
+    int64_t globalIndex;
+  };
+  std::vector<Leg> negLegs;
+  std::vector<Leg> posLegs;
+
   void init(InitContext& context)
   {
     mRunNumber = 0;
     d_bz = 0;
 
+    if (doFinderQA) {
+      registry.add("hFinderQA", "V0s found;;Number of V0s", HistType::kTH1F, {{2, 0.5f, 2.5f}});
+      registry.get<TH1>(HIST("hFinderQA"))->GetXaxis()->SetBinLabel(1, "found");
+      registry.get<TH1>(HIST("hFinderQA"))->GetXaxis()->SetBinLabel(2, "lost by #Deltatan#lambda");
+    }
+
     ccdb->setURL(ccdburl);
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
@@ -184,8 +202,10 @@ struct createPCM {
     }
   }
 
-  template <typename TCollision, typename TTrack>
-  void fillV0Table(TCollision const& collision, TTrack const& ele, TTrack const& pos)
+  /// \return true if the pair gives a V0 passing the selections
+  /// \tparam store fills the V0 in the table, false to only count it in the finder QA
+  template <bool store = true, typename TCollision, typename TTrack>
+  bool fillV0Table(TCollision const& collision, TTrack const& ele, TTrack const& pos)
   {
     array<float, 3> pVtx = {collision.posX(), collision.posY(), collision.posZ()};
     array<float, 3> svpos = {0.}; // secondary vertex position
@@ -205,7 +225,7 @@ struct createPCM {
       fitter.getTrack(0).getPxPyPzGlo(pvec0); // positive
       fitter.getTrack(1).getPxPyPzGlo(pvec1); // negative
     } else {
-      return;
+      return false;
     }
 
     float px = pvec0[0] + pvec1[0];
@@ -217,21 +237,24 @@ struct createPCM {
     float v0radius = RecoDecay::sqrtSumOfSquares(svpos[0], svpos[1]);
 
     if (v0dca > maxdcav0dau) {
-      return;
+      return false;
     }
     if (v0radius < v0Rmin || v0Rmax < v0radius) {
-      return;
+      return false;
     }
     if (v0CosinePA < minv0cospa) {
-      return;
+      return false;
     }
 
-    v0data(pos.globalIndex(), ele.globalIndex(), collision.globalIndex(), -1,
-           fitter.getTrack(0).getX(), fitter.getTrack(1).getX(),
-           svpos[0], svpos[1], svpos[2],
-           pvec0[0], pvec0[1], pvec0[2],
-           pvec1[0], pvec1[1], pvec1[2],
-           v0dca, pos.dcaXY(), ele.dcaXY());
+    if constexpr (store) {
+      v0data(pos.globalIndex(), ele.globalIndex(), collision.globalIndex(), -1,
+             fitter.getTrack(0).getX(), fitter.getTrack(1).getX(),
+             svpos[0], svpos[1], svpos[2],
+             pvec0[0], pvec0[1], pvec0[2],
+             pvec1[0], pvec1[1], pvec1[2],
+             v0dca, pos.dcaXY(), ele.dcaXY());
+    }
+    return true;
   }
 
   template <typename TTrack>
@@ -258,6 +281,50 @@ struct createPCM {
     return true;
   }
 
+  template <typename TTrack>
+  void addLeg(TTrack const& track)
+  {
+    if (!isSelected(track)) {
+      return;
+    }
+    (track.sign() < 0 ? negLegs : posLegs).push_back({track.tgl(), track.globalIndex()});
+  }
+
+  /// \brief Fits the pairs of the selected legs of a collision, filled by addLeg()
+  /// The legs of a conversion have almost the same direction, so with maxDeltaTgl >= 0 the positive legs are
+  /// sorted in tan(lambda), and each negative leg is only fitted with the positive legs of its window
+  template <typename TCollision, typename TTracks>
+  void findV0s(TCollision const& collision, TTracks const& tracks)
+  {
+    const bool preselect = maxDeltaTgl >= 0.f;
+    if (preselect) {
+      std::sort(posLegs.begin(), posLegs.end(), [](const Leg& a, const Leg& b) { return a.tgl < b.tgl; });
+    }
+    for (auto& negLeg : negLegs) {
+      auto ele = tracks.rawIteratorAt(negLeg.globalIndex);
+      auto first = posLegs.begin();
+      auto last = posLegs.end();
+      if (preselect) {
+        first = std::lower_bound(posLegs.begin(), posLegs.end(), negLeg.tgl - maxDeltaTgl, [](const Leg& leg, float tgl) { return leg.tgl < tgl; });
+        last = std::upper_bound(first, posLegs.end(), negLeg.tgl + maxDeltaTgl, [](float tgl, const Leg& leg) { return tgl < leg.tgl; });
+      }
+      for (auto posLeg = first; posLeg != last; ++posLeg) {
+        if (fillV0Table(collision, ele, tracks.rawIteratorAt(posLeg->globalIndex)) && doFinderQA) {
+          registry.fill(HIST("hFinderQA"), 1);
+        }
+      }
+      if (preselect && doFinderQA) { // the pairs outside of the window, as they would be found without the preselection
+        for (auto posLeg = posLegs.begin(); posLeg != posLegs.end(); ++posLeg) {
+          if ((posLeg < first || posLeg >= last) && fillV0Table<false>(collision, ele, tracks.rawIteratorAt(posLeg->globalIndex))) {
+            registry.fill(HIST("hFinderQA"), 2);
+          }
+        }
+      }
+    }
+    negLegs.clear();
+    posLegs.clear();
+  }
+
   Filter trackFilter = o2::aod::track::x < maxX && o2::aod::track::pt > minpt&& nabs(o2::aod::track::eta) < maxeta&& dcamin < nabs(o2::aod::track::dcaXY) && nabs(o2::aod::track::dcaXY) < dcamax;
   using MyFilteredTracks = soa::Filtered<FullTracksExtIU>;
   Partition<MyFilteredTracks> posTracks = o2::aod::track::signed1Pt > 0.f;
@@ -276,18 +343,14 @@ struct createPCM {
 
       // LOGF(info, "collision.globalIndex() = %d , negTracks_coll.size() = %d , posTracks_coll.size() = %d", collision.globalIndex(), negTracks_coll.size(), posTracks_coll.size());
 
-      for (auto& [ele, pos] : combinations(CombinationsFullIndexPolicy(negTracks_coll, posTracks_coll))) {
-        if (!isSelected(ele) || !isSelected(pos)) {
-          continue;
-        }
-        // if(ele.hasITS() && (!ele.hasTPC() && !ele.hasTOF() && !ele.hasTRD())){
-        //   LOGF(info, "ele : ITSonly track %d", ele.globalIndex());
-        // }
-        // if(pos.hasITS() && (!pos.hasTPC() && !pos.hasTOF() && !pos.hasTRD())){
-        //   LOGF(info, "pos : ITSonly track %d", pos.globalIndex());
-        // }
-        fillV0Table(collision, ele, pos);
+      // the tracks are selected once, and not for each pair
+      for (auto& ele : negTracks_coll) {
+        addLeg(ele);
+      }
+      for (auto& pos : posTracks_coll) {
+        addLeg(pos);
       }
+      findV0s(collision, tracks);
     } // end of collision loop
   }   // end of process
   PROCESS_SWITCH(createPCM, processSA, "create V0s with stand-alone way", true);
@@ -303,25 +366,11 @@ struct createPCM {
       auto trackIdsThisCollision = trackIndices.sliceBy(trackIndicesPerCollision, collision.globalIndex());
 
       // LOGF(info,"%d tracks in collision %d", trackIdsThisCollision.size(), collision.globalIndex());
-      for (auto& [eleId, posId] : combinations(CombinationsStrictlyUpperIndexPolicy(trackIdsThisCollision, trackIdsThisCollision))) {
-        auto ele = eleId.track_as<FullTracksExtIU>();
-        auto pos = posId.track_as<FullTracksExtIU>();
-        // LOGF(info,"eleId = %d , posId = %d", ele.globalIndex(), pos.globalIndex());
-
-        if (ele.sign() * pos.sign() > 0) { // reject same sign combination
-          continue;
-        }
-
-        if (!isSelected(ele) || !isSelected(pos)) {
-          continue;
-        }
-
-        if (ele.sign() < 0) {
-          fillV0Table(collision, ele, pos);
-        } else {
-          fillV0Table(collision, pos, ele);
-        }
+      // the legs are split by sign, so that only the opposite sign combinations are fitted
+      for (auto& trackId : trackIdsThisCollision) {
+        addLeg(trackId.track_as<FullTracksExtIU>());
       }
+      findV0s(collision, tracks);
     } // end of collision loop
   }   // end of process
   PROCESS_SWITCH(createPCM, processTrkCollAsso, "create V0s with track-to-collision associator", false);
@@ -73,6 +73,11 @@ struct skimmerGammaConversions {
   Configurable<float> dcamin{"dcamin", 0.1, "dcamin"};
   Configurable<float> dcamax{"dcamax", 1e+10, "dcamax"};
 
+  Configurable<bool> fillCompactPhotons{"fillCompactPhotons", false, "also write the KF photons with their packed legs in V0PhotonsCompact"};
+  Configurable<float> compactMinPt{"compactMinPt", 0.f, "min. pT of the compact photons"};
+  Configurable<float> compactMaxChi2KF{"compactMaxChi2KF", 1e+10, "max. KF chi2/ndf of the compact photons"};
+  Configurable<float> compactMaxPsiPair{"compactMaxPsiPair", 1e+10, "max. |psi pair| of the compact photons"};
+
   HistogramRegistry fRegistry{
     "fRegistry",
     {
@@ -114,6 +119,7 @@ struct skimmerGammaConversions {
 
   Produces<aod::V0Photons> v0photons;
   Produces<aod::V0PhotonsKF> v0photonskf;
+  Produces<aod::V0PhotonsCompact> v0photonscompact;
   Produces<aod::V0Legs> v0legs;
   Produces<aod::McGammasTrue> fFuncTableMcGammasFromConfirmedV0s;
   Produces<aod::V0Recalculation> fFuncTableV0Recalculated;
@@ -311,6 +317,15 @@ struct skimmerGammaConversions {
                 gammaKF_PV.GetPx(), gammaKF_PV.GetPy(), gammaKF_PV.GetPz(),
                 v0.mGamma(), cpaFromKF(gammaKF_DecayVtx, KFPV), v0.dcaV0daughters(),
                 v0.alpha(), v0.qtarm(), v0.psipair(), chi2kf);
+
+    if (fillCompactPhotons && gammaKF_PV.GetPt() > compactMinPt && chi2kf < compactMaxChi2KF && std::abs(v0.psipair()) < compactMaxPsiPair) {
+      v0photonscompact(collision.globalIndex(),
+                       gammaKF_DecayVtx.GetX(), gammaKF_DecayVtx.GetY(), gammaKF_DecayVtx.GetZ(),
+                       gammaKF_PV.GetPx(), gammaKF_PV.GetPy(), gammaKF_PV.GetPz(),
+                       v0.mGamma(), cpaFromKF(gammaKF_DecayVtx, KFPV), v0.dcaV0daughters(),
+                       v0.alpha(), v0.qtarm(), v0.psipair(), chi2kf,
+                       aod::v0photoncompact::packLeg(pos), aod::v0photoncompact::packLeg(ele));
+    }
   }
 
   // ============================ FUNCTION DEFINITIONS ====================================================
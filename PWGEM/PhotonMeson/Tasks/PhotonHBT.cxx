@@ -14,8 +14,15 @@
 // This code loops over v0 photons and makes pairs for photon HBT analysis.
 //    Please write to: daiki.sekihata@cern.ch
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
 #include <cstring>
 #include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "TString.h"
 #include "Math/Vector4D.h"
@@ -42,6 +49,7 @@
 #include "PWGEM/PhotonMeson/Core/PairCut.h"
 #include "PWGEM/PhotonMeson/Core/CutsLibrary.h"
 #include "PWGEM/PhotonMeson/Core/HistogramsLibrary.h"
+#include "PWGCF/Core/EngineQueues.h"
 
 using namespace o2;
 using namespace o2::aod;
@@ -57,6 +65,8 @@ struct PhotonHBT {
   Configurable<std::string> fConfigPCMCuts{"cfgPCMCuts", "analysis,qc,nocut", "Comma separated list of V0 photon cuts"};
   Configurable<std::string> fConfigPHOSCuts{"cfgPHOSCuts", "test02,test03", "Comma separated list of PHOS photon cuts"};
   Configurable<std::string> fConfigPairCuts{"cfgPairCuts", "nocut", "Comma separated list of pair cuts"};
+  Configurable<bool> fConfigPruneQinv{"cfgPruneQinv", true, "skip the pairs which cannot have q_inv inside of the histogram range"};
+  Configurable<int> fConfigNThreadsMixing{"cfgNThreadsMixing", 1, "number of threads for the event mixing, the collision bins are shared among them"};
 
   OutputObj<THashList> fOutputEvent{"Event"};
   OutputObj<THashList> fOutputPair{"Pair"}; // 2-photon pair
@@ -82,6 +92,9 @@ struct PhotonHBT {
     DefinePCMCuts();
     DefinePHOSCuts();
     DefinePairCuts();
+    if (fPCMCuts.size() > 64 || fPHOSCuts.size() > 64 || fPairCuts.size() > 64) {
+      LOGF(fatal, "At most 64 photon cuts per subsystem and 64 pair cuts are supported.");
+    }
     addhistograms();
 
     fOutputEvent.setObject(reinterpret_cast<THashList*>(fMainList->FindObject("Event")));
@@ -190,20 +203,224 @@ struct PhotonHBT {
     LOGF(info, "Number of Pair cuts = %d", fPairCuts.size());
   }
 
-  template <PairType pairtype, typename TG1, typename TG2, typename TCut1, typename TCut2>
-  bool IsSelectedPair(TG1 const& g1, TG2 const& g2, TCut1 const& cut1, TCut2 const& cut2)
+  // Types of the matched tracks given to the photon cuts, for the first and the second photons of a pair
+  template <PairType pairtype>
+  using FirstLeg = std::conditional_t<pairtype == PairType::kPCMPCM || pairtype == PairType::kPCMPHOS, aod::V0Legs, int>; // int is a dummy, because track matching is not ready for PHOS.
+  template <PairType pairtype>
+  using SecondLeg = std::conditional_t<pairtype == PairType::kPCMPCM, aod::V0Legs, int>;
+
+  template <PairType pairtype>
+  static constexpr bool isSameSubsystem()
+  {
+    return pairtype == PairType::kPCMPCM || pairtype == PairType::kPHOSPHOS || pairtype == PairType::kEMCEMC;
+  }
+
+  // Photon of the data frame, with the accessors used by the pair cuts, and the photon cuts it passes, bit i for the cut i
+  struct PhotonRecord {
+    int64_t mGlobalIndex = -1;
+    float mPt = 0.f;
+    float mEta = 0.f;
+    float mPhi = 0.f;
+    float mE = 0.f;
+    uint64_t mCutMask = 0;
+
+    int64_t globalIndex() const { return mGlobalIndex; }
+    float pt() const { return mPt; }
+    float eta() const { return mEta; }
+    float phi() const { return mPhi; }
+    float e() const { return mE; }
+  };
+
+  // Photons passing at least one photon cut, for each collision id, sorted in eta
+  std::vector<std::vector<PhotonRecord>> fRecords1;
+  std::vector<std::vector<PhotonRecord>> fRecords2;
+
+  /// \brief Evaluates all the photon cuts once for each photon of the data frame, and stores the selected photons
+  template <typename TLeg, typename TPhotons, typename TCuts>
+  void fillRecords(TPhotons const& photons, TCuts const& cuts, std::vector<std::vector<PhotonRecord>>& records)
+  {
+    for (auto& collisionRecords : records) {
+      collisionRecords.clear();
+    }
+    for (auto& photon : photons) {
+      if (photon.collisionId() < 0) {
+        continue;
+      }
+      uint64_t mask = 0;
+      for (size_t icut = 0; icut < cuts.size(); icut++) {
+        if (cuts[icut].template IsSelected<TLeg>(photon)) {
+          mask |= uint64_t(1) << icut;
+        }
+      }
+      if (!mask) {
+        continue;
+      }
+      if (photon.collisionId() >= static_cast<int>(records.size())) {
+        records.resize(photon.collisionId() + 1);
+      }
+      records[photon.collisionId()].push_back({photon.globalIndex(), photon.pt(), photon.eta(), photon.phi(), photon.e(), mask});
+    }
+    for (auto& collisionRecords : records) {
+      std::sort(collisionRecords.begin(), collisionRecords.end(), [](const PhotonRecord& g1, const PhotonRecord& g2) { return g1.eta() < g2.eta(); });
+    }
+  }
+
+  static const std::vector<PhotonRecord>& getRecords(const std::vector<std::vector<PhotonRecord>>& records, int collisionId)
+  {
+    static const std::vector<PhotonRecord> empty;
+    return collisionId >= 0 && collisionId < static_cast<int>(records.size()) ? records[collisionId] : empty;
+  }
+
+  /// \brief Evaluates the photon cuts of both photon tables, before the same and mixed event pairings
+  template <PairType pairtype, typename TPhotons1, typename TPhotons2, typename TCuts1, typename TCuts2>
+  void PrepareRecords(TPhotons1 const& photons1, TPhotons2 const& photons2, TCuts1 const& cuts1, TCuts2 const& cuts2)
+  {
+    fillRecords<FirstLeg<pairtype>>(photons1, cuts1, fRecords1);
+    if constexpr (!isSameSubsystem<pairtype>()) {
+      fillRecords<SecondLeg<pairtype>>(photons2, cuts2, fRecords2);
+    }
+  }
+
+  template <PairType pairtype>
+  const std::vector<std::vector<PhotonRecord>>& getSecondRecords() const
+  {
+    return isSameSubsystem<pairtype>() ? fRecords1 : fRecords2;
+  }
+
+  /// \brief Calls process(g1, g2) for the pairs of photons of two eta-sorted lists which can have a q_inv below qmax
+  /// For massless photons, q_inv^2 = 2 pT1 pT2 (cosh(deta) - cos(dphi)) >= 2 pT1 pT2 (cosh(deta) - 1), so that a photon
+  /// can only get below qmax with the photons of the other list in an eta window. With qmax <= 0, all the pairs are given.
+  /// \tparam same both lists are the same, each pair is given once with the photon of lower global index first
+  template <bool same, typename TProcess>
+  static void forEachPair(const std::vector<PhotonRecord>& photons1, const std::vector<PhotonRecord>& photons2, float qmax, TProcess process)
+  {
+    if (photons1.empty() || photons2.empty()) {
+      return;
+    }
+    float minPt2 = photons2.front().pt();
+    for (auto& g2 : photons2) {
+      minPt2 = std::min(minPt2, g2.pt());
+    }
+    auto lessEta = [](const PhotonRecord& g, float eta) { return g.eta() < eta; };
+    auto greaterEta = [](float eta, const PhotonRecord& g) { return eta < g.eta(); };
+    for (size_t i = 0; i < photons1.size(); i++) {
+      const auto& g1 = photons1[i];
+      auto first = same ? photons2.begin() + i + 1 : photons2.begin();
+      auto last = photons2.end();
+      if (qmax > 0.f) {
+        const float detamax = std::acosh(1.f + qmax * qmax / (2.f * g1.pt() * minPt2));
+        if constexpr (!same) {
+          first = std::lower_bound(first, last, g1.eta() - detamax, lessEta);
+        }
+        last = std::upper_bound(first, last, g1.eta() + detamax, greaterEta);
+      }
+      for (auto g2 = first; g2 != last; ++g2) {
+        if (same && g2->globalIndex() < g1.globalIndex()) {
+          process(*g2, g1);
+        } else {
+          process(g1, *g2);
+        }
+      }
+    }
+  }
+
+  /// \brief q_inv, q_long, q_out, q_side and k_T of a photon pair, in the longitudinally co-moving system (LCMS)
+  static void getQValues(const PhotonRecord& g1, const PhotonRecord& g2, double values[5])
+  {
+    ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
+    ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
+    ROOT::Math::PtEtaPhiMVector q12 = v1 - v2;
+    ROOT::Math::PtEtaPhiMVector k12 = 0.5 * (v1 + v2);
+    float qinv = -q12.M();
+    float kt = k12.Pt();
+    ROOT::Math::XYZVector q_3d = q12.Vect();               // 3D q vector
+    ROOT::Math::XYZVector uv_out = k12.Vect() / k12.P();   // unit vector for out
+    ROOT::Math::XYZVector uv_long(0, 0, 1);                // unit vector for long, beam axis
+    ROOT::Math::XYZVector uv_side = uv_out.Cross(uv_long); // unit vector for side
+    values[0] = qinv;
+    values[1] = static_cast<float>(q_3d.Dot(uv_long));
+    values[2] = static_cast<float>(q_3d.Dot(uv_out));
+    values[3] = static_cast<float>(q_3d.Dot(uv_side));
+    values[4] = kt;
+  }
+
+  /// \brief Pair cuts passed by a photon pair, bit i for the cut i
+  template <typename TPairCuts>
+  static uint64_t getPairCutMask(const PhotonRecord& g1, const PhotonRecord& g2, TPairCuts const& paircuts)
+  {
+    uint64_t mask = 0;
+    for (size_t ipaircut = 0; ipaircut < paircuts.size(); ipaircut++) {
+      if (paircuts[ipaircut].IsSelected(g1, g2)) {
+        mask |= uint64_t(1) << ipaircut;
+      }
+    }
+    return mask;
+  }
+
+  static size_t pairIndex(size_t icut1, size_t icut2, size_t ipaircut, size_t ncuts2, size_t npaircuts)
+  {
+    return (icut1 * ncuts2 + icut2) * npaircuts + ipaircut;
+  }
+
+  /// \brief Looks up the histograms of all the (cut1, cut2, pair cut) combinations once, at the index given by pairIndex()
+  /// Only the combinations with the same photon cut exist for the pairs of a single subsystem.
+  template <PairType pairtype, typename TCuts1, typename TCuts2, typename TPairCuts>
+  std::vector<THnSparseF*> getPairHistograms(THashList* list_pair_ss, TCuts1 const& cuts1, TCuts2 const& cuts2, TPairCuts const& paircuts, const char* histname)
+  {
+    std::vector<THnSparseF*> hists(cuts1.size() * cuts2.size() * paircuts.size(), nullptr);
+    for (size_t icut1 = 0; icut1 < cuts1.size(); icut1++) {
+      for (size_t icut2 = 0; icut2 < cuts2.size(); icut2++) {
+        if (isSameSubsystem<pairtype>() && icut1 != icut2) {
+          continue;
+        }
+        auto list_photoncut = list_pair_ss->FindObject(Form("%s_%s", cuts1[icut1].GetName(), cuts2[icut2].GetName()));
+        for (size_t ipaircut = 0; ipaircut < paircuts.size(); ipaircut++) {
+          hists[pairIndex(icut1, icut2, ipaircut, cuts2.size(), paircuts.size())] = reinterpret_cast<THnSparseF*>(list_photoncut->FindObject(paircuts[ipaircut].GetName())->FindObject(histname));
+        }
+      }
+    }
+    return hists;
+  }
+
+  /// \brief Upper edge of q_inv in the pair histograms, or 0 if the pairs are not pruned
+  float getMaxQinv(std::vector<THnSparseF*> const& hists)
+  {
+    if (!fConfigPruneQinv) {
+      return 0.f;
+    }
+    for (auto& hist : hists) {
+      if (hist) {
+        return 1.01f * hist->GetAxis(0)->GetXmax(); // margin for the rounding of q_inv
+      }
+    }
+    return 0.f;
+  }
+
+  /// \brief Calls fill(index) for each combination of cuts passed by a photon pair
+  template <PairType pairtype, typename TFill>
+  static void forEachCutCombination(uint64_t cutmask1, size_t ncuts1, uint64_t cutmask2, size_t ncuts2, uint64_t paircutmask, size_t npaircuts, TFill fill)
   {
-    bool is_selected_pair = false;
-    if constexpr (pairtype == PairType::kPCMPCM) {
-      is_selected_pair = o2::aod::photonpair::IsSelectedPair<aod::V0Legs, aod::V0Legs>(g1, g2, cut1, cut2);
-    } else if constexpr (pairtype == PairType::kPHOSPHOS) {
-      is_selected_pair = o2::aod::photonpair::IsSelectedPair<int, int>(g1, g2, cut1, cut2); // dummy, because track matching is not ready.
-    } else if constexpr (pairtype == PairType::kPCMPHOS) {
-      is_selected_pair = o2::aod::photonpair::IsSelectedPair<aod::V0Legs, int>(g1, g2, cut1, cut2);
-    } else {
-      is_selected_pair = true;
+    for (size_t ipaircut = 0; ipaircut < npaircuts; ipaircut++) {
+      if (!(paircutmask & (uint64_t(1) << ipaircut))) {
+        continue;
+      }
+      for (size_t icut1 = 0; icut1 < ncuts1; icut1++) {
+        if (!(cutmask1 & (uint64_t(1) << icut1))) {
+          continue;
+        }
+        if constexpr (isSameSubsystem<pairtype>()) {
+          if (cutmask2 & (uint64_t(1) << icut1)) {
+            fill(pairIndex(icut1, icut1, ipaircut, ncuts2, npaircuts));
+          }
+        } else {
+          for (size_t icut2 = 0; icut2 < ncuts2; icut2++) {
+            if (cutmask2 & (uint64_t(1) << icut2)) {
+              fill(pairIndex(icut1, icut2, ipaircut, ncuts2, npaircuts));
+            }
+          }
+        }
+      }
     }
-    return is_selected_pair;
   }
 
   template <PairType pairtype, typename TEvents, typename TPhotons1, typename TPhotons2, typename TPreslice1, typename TPreslice2, typename TCuts1, typename TCuts2, typename TPairCuts, typename TLegs>
@@ -211,6 +428,9 @@ struct PhotonHBT {
   {
     THashList* list_ev_pair = static_cast<THashList*>(fMainList->FindObject("Event")->FindObject(pairnames[pairtype].data()));
     THashList* list_pair_ss = static_cast<THashList*>(fMainList->FindObject("Pair")->FindObject(pairnames[pairtype].data()));
+    const auto hSame = getPairHistograms<pairtype>(list_pair_ss, cuts1, cuts2, paircuts, "hs_q_same");
+    const float qmax = getMaxQinv(hSame);
+    const uint64_t allPairCuts = paircuts.size() < 64 ? (uint64_t(1) << paircuts.size()) - 1 : ~uint64_t(0);
 
     for (auto& collision : collisions) {
 
@@ -237,74 +457,36 @@ struct PhotonHBT {
       reinterpret_cast<TH1F*>(fMainList->FindObject("Event")->FindObject(pairnames[pairtype].data())->FindObject("hCollisionCounter"))->Fill(4.0); // |Zvtx| < 10 cm
       o2::aod::emphotonhistograms::FillHistClass<EMHistType::kEvent>(list_ev_pair, "", collision);
 
-      auto photons1_coll = photons1.sliceBy(perCollision1, collision.collisionId());
-      auto photons2_coll = photons2.sliceBy(perCollision2, collision.collisionId());
-
-      if constexpr (pairtype == PairType::kPCMPCM || pairtype == PairType::kPHOSPHOS || pairtype == PairType::kEMCEMC) {
-        for (auto& cut : cuts1) {
-          for (auto& paircut : paircuts) {
-            for (auto& [g1, g2] : combinations(CombinationsStrictlyUpperIndexPolicy(photons1_coll, photons2_coll))) {
-              if (!IsSelectedPair<pairtype>(g1, g2, cut, cut)) {
-                continue;
-              }
-
-              // longitudinally co-moving system (LCMS)
-              ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
-              ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
-              ROOT::Math::PtEtaPhiMVector q12 = v1 - v2;
-              ROOT::Math::PtEtaPhiMVector k12 = 0.5 * (v1 + v2);
-              float qinv = -q12.M();
-              float kt = k12.Pt();
-              ROOT::Math::XYZVector q_3d = q12.Vect();               // 3D q vector
-              ROOT::Math::XYZVector uv_out = k12.Vect() / k12.P();   // unit vector for out
-              ROOT::Math::XYZVector uv_long(0, 0, 1);                // unit vector for long, beam axis
-              ROOT::Math::XYZVector uv_side = uv_out.Cross(uv_long); // unit vector for side
-              float qout = q_3d.Dot(uv_out);
-              float qlong = q_3d.Dot(uv_long);
-              float qside = q_3d.Dot(uv_side);
-              double values[5] = {qinv, qlong, qout, qside, kt};
-              reinterpret_cast<THnSparseF*>(list_pair_ss->FindObject(Form("%s_%s", cut.GetName(), cut.GetName()))->FindObject(paircut.GetName())->FindObject("hs_q_same"))->Fill(values);
-            }  // end of combination
-          }    // end of pair cut loop
-        }      // end of cut loop
-      } else { // different subsystem pairs
-        for (auto& cut1 : cuts1) {
-          for (auto& cut2 : cuts2) {
-            for (auto& paircut : paircuts) {
-              for (auto& [g1, g2] : combinations(CombinationsFullIndexPolicy(photons1_coll, photons2_coll))) {
-                if (!IsSelectedPair<pairtype>(g1, g2, cut1, cut2)) {
-                  continue;
-                }
-                if (!paircut.IsSelected(g1, g2)) {
-                  continue;
-                }
-                if constexpr (pairtype == PairType::kPCMPHOS) {
-                  auto pos = g1.template posTrack_as<aod::V0Legs>();
-                  auto ele = g1.template negTrack_as<aod::V0Legs>();
-                  if (o2::aod::photonpair::DoesV0LegMatchWithCluster(pos, g2, 0.02, 0.4, 0.2) || o2::aod::photonpair::DoesV0LegMatchWithCluster(ele, g2, 0.02, 0.4, 0.2)) {
-                    continue;
-                  }
-                }
-                ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
-                ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
-                ROOT::Math::PtEtaPhiMVector q12 = v1 - v2;
-                ROOT::Math::PtEtaPhiMVector k12 = 0.5 * (v1 + v2);
-                float qinv = -q12.M();
-                float kt = k12.Pt();
-                ROOT::Math::XYZVector q_3d = q12.Vect();               // 3D q vector
-                ROOT::Math::XYZVector uv_out = k12.Vect() / k12.P();   // unit vector for out
-                ROOT::Math::XYZVector uv_long(0, 0, 1);                // unit vector for long, beam axis
-                ROOT::Math::XYZVector uv_side = uv_out.Cross(uv_long); // unit vector for side
-                float qout = q_3d.Dot(uv_out);
-                float qlong = q_3d.Dot(uv_long);
-                float qside = q_3d.Dot(uv_side);
-                double values[5] = {qinv, qlong, qout, qside, kt};
-                reinterpret_cast<THnSparseF*>(list_pair_ss->FindObject(Form("%s_%s", cut1.GetName(), cut2.GetName()))->FindObject(paircut.GetName())->FindObject("hs_q_same"))->Fill(values);
-              } // end of combination
-            }   // end of pair cut loop
-          }     // end of cut2 loop
-        }       // end of cut1 loop
-      }
+      const auto& records1 = getRecords(fRecords1, collision.collisionId());
+      const auto& records2 = getRecords(getSecondRecords<pairtype>(), collision.collisionId());
+
+      forEachPair<isSameSubsystem<pairtype>()>(records1, records2, qmax, [&](const PhotonRecord& g1, const PhotonRecord& g2) {
+        uint64_t paircutmask = allPairCuts; // the pair cuts are not applied to the same event pairs of a single subsystem
+        if constexpr (isSameSubsystem<pairtype>()) {
+          if (!(g1.mCutMask & g2.mCutMask)) {
+            return;
+          }
+        } else { // different subsystem pairs
+          paircutmask = getPairCutMask(g1, g2, paircuts);
+          if (!paircutmask) {
+            return;
+          }
+          if constexpr (pairtype == PairType::kPCMPHOS) {
+            auto v0photon = photons1.rawIteratorAt(g1.globalIndex());
+            auto cluster = photons2.rawIteratorAt(g2.globalIndex());
+            auto pos = v0photon.template posTrack_as<aod::V0Legs>();
+            auto ele = v0photon.template negTrack_as<aod::V0Legs>();
+            if (o2::aod::photonpair::DoesV0LegMatchWithCluster(pos, cluster, 0.02, 0.4, 0.2) || o2::aod::photonpair::DoesV0LegMatchWithCluster(ele, cluster, 0.02, 0.4, 0.2)) {
+              return;
+            }
+          }
+        }
+        double values[5];
+        getQValues(g1, g2, values);
+        forEachCutCombination<pairtype>(g1.mCutMask, cuts1.size(), g2.mCutMask, cuts2.size(), paircutmask, paircuts.size(), [&](size_t index) {
+          hSame[index]->Fill(values);
+        });
+      });
     } // end of collision loop
   }
 
@@ -314,56 +496,75 @@ struct PhotonHBT {
   using BinningType = ColumnBinningPolicy<aod::collision::PosZ, aod::mult::MultNTracksPV>;
   BinningType colBinning{{ConfVtxBins, ConfMultBins}, true};
 
+  // Copies of the mixed event histograms filled by the additional mixing threads, for each pair type
+  std::array<std::vector<std::vector<THnSparseF*>>, 6> fMixingCopies;
+
   template <PairType pairtype, typename TEvents, typename TPhotons1, typename TPhotons2, typename TPreslice1, typename TPreslice2, typename TCuts1, typename TCuts2, typename TPairCuts, typename TLegs>
   void MixedEventPairing(TEvents const& collisions, TPhotons1 const& photons1, TPhotons2 const& photons2, TPreslice1 const& perCollision1, TPreslice2 const& perCollision2, TCuts1 const& cuts1, TCuts2 const& cuts2, TPairCuts const& paircuts, TLegs const& legs)
   {
     THashList* list_pair_ss = static_cast<THashList*>(fMainList->FindObject("Pair")->FindObject(pairnames[pairtype].data()));
-    // LOGF(info, "Number of collisions after filtering: %d", collisions.size());
-    for (auto& [collision1, collision2] : soa::selfCombinations(colBinning, ndepth, -1, collisions, collisions)) { // internally, CombinationsStrictlyUpperIndexPolicy(collisions, collisions) is called.
-      // LOGF(info, "Mixed event collisionId: (%d, %d) , counter = %d, ngpcm: (%d, %d), ngphos: (%d, %d), ngemc: (%d, %d)",
-      //     collision1.collisionId(), collision2.collisionId(), nev, collision1.ngpcm(), collision2.ngpcm(), collision1.ngphos(), collision2.ngphos(), collision1.ngemc(), collision2.ngemc());
-
-      auto photons_coll1 = photons1.sliceBy(perCollision1, collision1.collisionId());
-      auto photons_coll2 = photons2.sliceBy(perCollision2, collision2.collisionId());
-      // LOGF(info, "collision1: posZ = %f, numContrib = %d , sel8 = %d | collision2: posZ = %f, numContrib = %d , sel8 = %d",
-      //     collision1.posZ(), collision1.numContrib(), collision1.sel8(), collision2.posZ(), collision2.numContrib(), collision2.sel8());
-
-      for (auto& cut1 : cuts1) {
-        for (auto& cut2 : cuts2) {
-          for (auto& paircut : paircuts) {
-            for (auto& [g1, g2] : combinations(soa::CombinationsFullIndexPolicy(photons_coll1, photons_coll2))) {
-              // LOGF(info, "Mixed event photon pair: (%d, %d) from events (%d, %d), photon event: (%d, %d)", g1.index(), g2.index(), collision1.index(), collision2.index(), g1.collisionId(), g2.collisionId());
-
-              if ((pairtype == PairType::kPCMPCM || pairtype == PairType::kPHOSPHOS || pairtype == PairType::kEMCEMC) && (TString(cut1.GetName()) != TString(cut2.GetName()))) {
-                continue;
-              }
-              if (!IsSelectedPair<pairtype>(g1, g2, cut1, cut2)) {
-                continue;
-              }
-              if (!paircut.IsSelected(g1, g2)) {
-                continue;
-              }
-              ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
-              ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
-              ROOT::Math::PtEtaPhiMVector q12 = v1 - v2;
-              ROOT::Math::PtEtaPhiMVector k12 = 0.5 * (v1 + v2);
-              float qinv = -q12.M();
-              float kt = k12.Pt();
-              ROOT::Math::XYZVector q_3d = q12.Vect();               // 3D q vector
-              ROOT::Math::XYZVector uv_out = k12.Vect() / k12.P();   // unit vector for out
-              ROOT::Math::XYZVector uv_long(0, 0, 1);                // unit vector for long, beam axis
-              ROOT::Math::XYZVector uv_side = uv_out.Cross(uv_long); // unit vector for side
-              float qout = q_3d.Dot(uv_out);
-              float qlong = q_3d.Dot(uv_long);
-              float qside = q_3d.Dot(uv_side);
-              double values[5] = {qinv, qlong, qout, qside, kt};
-              reinterpret_cast<THnSparseF*>(list_pair_ss->FindObject(Form("%s_%s", cut1.GetName(), cut2.GetName()))->FindObject(paircut.GetName())->FindObject("hs_q_mix"))->Fill(values);
-
-            } // end of different photon combinations
-          }   // end of pair cut loop
-        }     // end of cut2 loop
-      }       // end of cut1 loop
-    }         // end of different collision combinations
+    const auto hMix = getPairHistograms<pairtype>(list_pair_ss, cuts1, cuts2, paircuts, "hs_q_mix");
+    const float qmax = getMaxQinv(hMix);
+
+    // the photons are only read from the records, so that the pairs of collisions can be mixed on several threads
+    auto mixCollisions = [&](std::vector<THnSparseF*> const& hists, int collisionId1, int collisionId2) {
+      const auto& records1 = getRecords(fRecords1, collisionId1);
+      const auto& records2 = getRecords(getSecondRecords<pairtype>(), collisionId2);
+      forEachPair<false>(records1, records2, qmax, [&](const PhotonRecord& g1, const PhotonRecord& g2) {
+        if (isSameSubsystem<pairtype>() && !(g1.mCutMask & g2.mCutMask)) {
+          return;
+        }
+        const uint64_t paircutmask = getPairCutMask(g1, g2, paircuts);
+        if (!paircutmask) {
+          return;
+        }
+        double values[5];
+        getQValues(g1, g2, values);
+        forEachCutCombination<pairtype>(g1.mCutMask, cuts1.size(), g2.mCutMask, cuts2.size(), paircutmask, paircuts.size(), [&](size_t index) {
+          hists[index]->Fill(values);
+        });
+      });
+    };
+
+    const int nThreads = fConfigNThreadsMixing;
+    if (nThreads <= 1) {
+      for (auto& [collision1, collision2] : soa::selfCombinations(colBinning, ndepth, -1, collisions, collisions)) { // internally, CombinationsStrictlyUpperIndexPolicy(collisions, collisions) is called.
+        mixCollisions(hMix, collision1.collisionId(), collision2.collisionId());
+      }
+      return;
+    }
+
+    // the pairs of collisions of a bin are all mixed by the same thread, which fills its own copy of the histograms
+    auto& copies = fMixingCopies[pairtype];
+    if (static_cast<int>(copies.size()) != nThreads - 1) {
+      copies.resize(nThreads - 1);
+      for (auto& copy : copies) {
+        copy.resize(hMix.size(), nullptr);
+        for (size_t i = 0; i < hMix.size(); i++) {
+          if (hMix[i]) {
+            copy[i] = reinterpret_cast<THnSparseF*>(hMix[i]->Clone());
+            copy[i]->Reset();
+          }
+        }
+      }
+    }
+    o2::analysis::EngineQueues<std::pair<int, int>> queues;
+    queues.init(nThreads);
+    for (auto& [collision1, collision2] : soa::selfCombinations(colBinning, ndepth, -1, collisions, collisions)) {
+      const int bin = colBinning.getBin({collision1.posZ(), collision1.multNTracksPV()});
+      queues.push(std::max(bin, 0) % nThreads, {collision1.collisionId(), collision2.collisionId()});
+    }
+    queues.drain(nThreads, [&](int engine, std::pair<int, int> const& collisionIds) {
+      mixCollisions(engine == 0 ? hMix : copies[engine - 1], collisionIds.first, collisionIds.second);
+    });
+    for (auto& copy : copies) {
+      for (size_t i = 0; i < hMix.size(); i++) {
+        if (hMix[i]) {
+          hMix[i]->Add(copy[i]);
+          copy[i]->Reset();
+        }
+      }
+    }
   }
 
   Preslice<MyV0Photons> perCollision_pcm = aod::v0photon::collisionId;
@@ -375,18 +576,21 @@ struct PhotonHBT {
 
   void processPCMPCM(aod::EMReducedEvents const& collisions, MyFilteredCollisions const& filtered_collisions, MyV0Photons const& v0photons, aod::V0Legs const& legs)
   {
+    PrepareRecords<PairType::kPCMPCM>(v0photons, v0photons, fPCMCuts, fPCMCuts);
     SameEventPairing<PairType::kPCMPCM>(collisions, v0photons, v0photons, perCollision_pcm, perCollision_pcm, fPCMCuts, fPCMCuts, fPairCuts, legs);
     MixedEventPairing<PairType::kPCMPCM>(filtered_collisions, v0photons, v0photons, perCollision_pcm, perCollision_pcm, fPCMCuts, fPCMCuts, fPairCuts, legs);
   }
 
   void processPHOSPHOS(aod::EMReducedEvents const& collisions, MyFilteredCollisions const& filtered_collisions, aod::PHOSClusters const& phosclusters)
   {
+    PrepareRecords<PairType::kPHOSPHOS>(phosclusters, phosclusters, fPHOSCuts, fPHOSCuts);
     SameEventPairing<PairType::kPHOSPHOS>(collisions, phosclusters, phosclusters, perCollision_phos, perCollision_phos, fPHOSCuts, fPHOSCuts, fPairCuts, nullptr);
     MixedEventPairing<PairType::kPHOSPHOS>(filtered_collisions, phosclusters, phosclusters, perCollision_phos, perCollision_phos, fPHOSCuts, fPHOSCuts, fPairCuts, nullptr);
   }
 
   void processPCMPHOS(aod::EMReducedEvents const& collisions, MyFilteredCollisions const& filtered_collisions, MyV0Photons const& v0photons, aod::PHOSClusters const& phosclusters, aod::V0Legs const& legs)
   {
+    PrepareRecords<PairType::kPCMPHOS>(v0photons, phosclusters, fPCMCuts, fPHOSCuts);
     SameEventPairing<PairType::kPCMPHOS>(collisions, v0photons, phosclusters, perCollision_pcm, perCollision_phos, fPCMCuts, fPHOSCuts, fPairCuts, legs);
     MixedEventPairing<PairType::kPCMPHOS>(filtered_collisions, v0photons, phosclusters, perCollision_pcm, perCollision_phos, fPCMCuts, fPHOSCuts, fPairCuts, legs);
   }
@@ -14,8 +14,11 @@
 // This code loops over v0 photons and makes pairs for neutral mesons analyses.
 //    Please write to: daiki.sekihata@cern.ch
 
+#include <cstdint>
 #include <cstring>
 #include <iterator>
+#include <type_traits>
+#include <vector>
 
 #include "TString.h"
 #include "Math/Vector4D.h"
@@ -116,6 +119,9 @@ struct Pi0EtaToGammaGamma {
     DefinePHOSCuts();
     DefineEMCCuts();
     DefinePairCuts();
+    if (fPCMCuts.size() > 64 || fPHOSCuts.size() > 64 || fEMCCuts.size() > 64 || fPairCuts.size() > 64) {
+      LOGF(fatal, "At most 64 photon cuts per subsystem and 64 pair cuts are supported.");
+    }
     addhistograms();
 
     fOutputEvent.setObject(reinterpret_cast<THashList*>(fMainList->FindObject("Event")));
@@ -279,26 +285,116 @@ struct Pi0EtaToGammaGamma {
   Preslice<aod::PHOSClusters> perCollision_phos = aod::skimmedcluster::collisionId;
   Preslice<aod::SkimEMCClusters> perCollision_emc = aod::skimmedcluster::collisionId;
 
-  template <PairType pairtype, typename TG1, typename TG2, typename TCut1, typename TCut2>
-  bool IsSelectedPair(TG1 const& g1, TG2 const& g2, TCut1 const& cut1, TCut2 const& cut2)
+  // Types of the matched tracks given to the photon cuts, for the first and the second photons of a pair
+  template <PairType pairtype>
+  using FirstLeg = std::conditional_t<pairtype == PairType::kPCMPCM || pairtype == PairType::kPCMPHOS || pairtype == PairType::kPCMEMC, aod::V0Legs, std::conditional_t<pairtype == PairType::kEMCEMC, aod::SkimEMCMTs, int>>; // int is a dummy, because track matching is not ready for PHOS.
+  template <PairType pairtype>
+  using SecondLeg = std::conditional_t<pairtype == PairType::kPCMPCM, aod::V0Legs, std::conditional_t<pairtype == PairType::kEMCEMC || pairtype == PairType::kPCMEMC || pairtype == PairType::kPHOSEMC, aod::SkimEMCMTs, int>>;
+
+  template <PairType pairtype>
+  static constexpr bool isSameSubsystem()
+  {
+    return pairtype == PairType::kPCMPCM || pairtype == PairType::kPHOSPHOS || pairtype == PairType::kEMCEMC;
+  }
+
+  // Photon cuts passed by each photon, bit i for the cut i, indexed by the global index of the photon
+  std::vector<uint64_t> fCutMasks1;
+  std::vector<uint64_t> fCutMasks2;
+
+  /// \brief Evaluates all the photon cuts once for each photon of the data frame
+  template <typename TLeg, typename TPhotons, typename TCuts>
+  void fillCutMasks(TPhotons const& photons, TCuts const& cuts, std::vector<uint64_t>& masks)
   {
-    bool is_selected_pair = false;
-    if constexpr (pairtype == PairType::kPCMPCM) {
-      is_selected_pair = o2::aod::photonpair::IsSelectedPair<aod::V0Legs, aod::V0Legs>(g1, g2, cut1, cut2);
-    } else if constexpr (pairtype == PairType::kPHOSPHOS) {
-      is_selected_pair = o2::aod::photonpair::IsSelectedPair<int, int>(g1, g2, cut1, cut2); // dummy, because track matching is not ready.
-    } else if constexpr (pairtype == PairType::kEMCEMC) {
-      is_selected_pair = o2::aod::photonpair::IsSelectedPair<aod::SkimEMCMTs, aod::SkimEMCMTs>(g1, g2, cut1, cut2);
-    } else if constexpr (pairtype == PairType::kPCMPHOS) {
-      is_selected_pair = o2::aod::photonpair::IsSelectedPair<aod::V0Legs, int>(g1, g2, cut1, cut2);
-    } else if constexpr (pairtype == PairType::kPCMEMC) {
-      is_selected_pair = o2::aod::photonpair::IsSelectedPair<aod::V0Legs, aod::SkimEMCMTs>(g1, g2, cut1, cut2);
-    } else if constexpr (pairtype == PairType::kPHOSEMC) {
-      is_selected_pair = o2::aod::photonpair::IsSelectedPair<int, aod::SkimEMCMTs>(g1, g2, cut1, cut2);
+    masks.assign(photons.size(), 0);
+    for (auto& photon : photons) {
+      uint64_t mask = 0;
+      for (size_t icut = 0; icut < cuts.size(); icut++) {
+        if (cuts[icut].template IsSelected<TLeg>(photon)) {
+          mask |= uint64_t(1) << icut;
+        }
+      }
+      masks[photon.globalIndex()] = mask;
+    }
+  }
+
+  /// \brief Pair cuts passed by a photon pair, bit i for the cut i
+  template <typename TG1, typename TG2, typename TPairCuts>
+  uint64_t getPairCutMask(TG1 const& g1, TG2 const& g2, TPairCuts const& paircuts)
+  {
+    uint64_t mask = 0;
+    for (size_t ipaircut = 0; ipaircut < paircuts.size(); ipaircut++) {
+      if (paircuts[ipaircut].IsSelected(g1, g2)) {
+        mask |= uint64_t(1) << ipaircut;
+      }
+    }
+    return mask;
+  }
+
+  /// \brief Looks up the histograms of all the (cut1, cut2, pair cut) combinations once, at the index given by pairIndex()
+  /// Only the combinations with the same photon cut exist for the pairs of a single subsystem.
+  template <PairType pairtype, typename TCuts1, typename TCuts2, typename TPairCuts>
+  std::vector<TH2F*> getPairHistograms(THashList* list_pair_ss, TCuts1 const& cuts1, TCuts2 const& cuts2, TPairCuts const& paircuts, const char* histname)
+  {
+    std::vector<TH2F*> hists(cuts1.size() * cuts2.size() * paircuts.size(), nullptr);
+    for (size_t icut1 = 0; icut1 < cuts1.size(); icut1++) {
+      for (size_t icut2 = 0; icut2 < cuts2.size(); icut2++) {
+        if (isSameSubsystem<pairtype>() && icut1 != icut2) {
+          continue;
+        }
+        auto list_photoncut = list_pair_ss->FindObject(Form("%s_%s", cuts1[icut1].GetName(), cuts2[icut2].GetName()));
+        for (size_t ipaircut = 0; ipaircut < paircuts.size(); ipaircut++) {
+          hists[pairIndex(icut1, icut2, ipaircut, cuts2.size(), paircuts.size())] = reinterpret_cast<TH2F*>(list_photoncut->FindObject(paircuts[ipaircut].GetName())->FindObject(histname));
+        }
+      }
+    }
+    return hists;
+  }
+
+  static size_t pairIndex(size_t icut1, size_t icut2, size_t ipaircut, size_t ncuts2, size_t npaircuts)
+  {
+    return (icut1 * ncuts2 + icut2) * npaircuts + ipaircut;
+  }
+
+  /// \brief Calls fill(index, icut1, icut2, ipaircut) for each combination of cuts passed by a photon pair
+  /// \param cutmask1 photon cuts passed by the first photon
+  /// \param cutmask2 photon cuts passed by the second photon
+  /// \param paircutmask pair cuts passed by the pair
+  template <PairType pairtype, typename TFill>
+  void forEachCutCombination(uint64_t cutmask1, size_t ncuts1, uint64_t cutmask2, size_t ncuts2, uint64_t paircutmask, size_t npaircuts, TFill fill)
+  {
+    for (size_t ipaircut = 0; ipaircut < npaircuts; ipaircut++) {
+      if (!(paircutmask & (uint64_t(1) << ipaircut))) {
+        continue;
+      }
+      for (size_t icut1 = 0; icut1 < ncuts1; icut1++) {
+        if (!(cutmask1 & (uint64_t(1) << icut1))) {
+          continue;
+        }
+        if constexpr (isSameSubsystem<pairtype>()) {
+          if (cutmask2 & (uint64_t(1) << icut1)) {
+            fill(pairIndex(icut1, icut1, ipaircut, ncuts2, npaircuts), icut1, icut1, ipaircut);
+          }
+        } else {
+          for (size_t icut2 = 0; icut2 < ncuts2; icut2++) {
+            if (cutmask2 & (uint64_t(1) << icut2)) {
+              fill(pairIndex(icut1, icut2, ipaircut, ncuts2, npaircuts), icut1, icut2, ipaircut);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  /// \brief Evaluates the photon cuts of both photon tables, before the same and mixed event pairings
+  template <PairType pairtype, typename TPhotons1, typename TPhotons2, typename TCuts1, typename TCuts2>
+  void PrepareCutMasks(TPhotons1 const& photons1, TPhotons2 const& photons2, TCuts1 const& cuts1, TCuts2 const& cuts2)
+  {
+    fillCutMasks<FirstLeg<pairtype>>(photons1, cuts1, fCutMasks1);
+    if constexpr (isSameSubsystem<pairtype>()) {
+      fCutMasks2 = fCutMasks1;
     } else {
-      is_selected_pair = true;
+      fillCutMasks<SecondLeg<pairtype>>(photons2, cuts2, fCutMasks2);
     }
-    return is_selected_pair;
   }
 
   template <PairType pairtype, typename TEvents, typename TPhotons1, typename TPhotons2, typename TPreslice1, typename TPreslice2, typename TCuts1, typename TCuts2, typename TPairCuts, typename TLegs, typename TEMCMTs>
@@ -306,6 +402,14 @@ struct Pi0EtaToGammaGamma {
   {
     THashList* list_ev_pair = static_cast<THashList*>(fMainList->FindObject("Event")->FindObject(pairnames[pairtype].data()));
     THashList* list_pair_ss = static_cast<THashList*>(fMainList->FindObject("Pair")->FindObject(pairnames[pairtype].data()));
+    const auto hMggPtSame = getPairHistograms<pairtype>(list_pair_ss, cuts1, cuts2, paircuts, "hMggPt_Same");
+    std::vector<TH2F*> hdEtadPhi, hdEtaPt, hdPhiPt, hEpE;
+    if constexpr (pairtype == PairType::kPCMPHOS || pairtype == PairType::kPCMEMC) {
+      hdEtadPhi = getPairHistograms<pairtype>(list_pair_ss, cuts1, cuts2, paircuts, "hdEtadPhi");
+      hdEtaPt = getPairHistograms<pairtype>(list_pair_ss, cuts1, cuts2, paircuts, "hdEtaPt");
+      hdPhiPt = getPairHistograms<pairtype>(list_pair_ss, cuts1, cuts2, paircuts, "hdPhiPt");
+      hEpE = getPairHistograms<pairtype>(list_pair_ss, cuts1, cuts2, paircuts, "hEp_E");
+    }
 
     for (auto& collision : collisions) {
       if ((pairtype == PairType::kPHOSPHOS || pairtype == PairType::kPCMPHOS) && !collision.isPHOSCPVreadout()) {
@@ -338,84 +442,84 @@ struct Pi0EtaToGammaGamma {
       auto photons1_coll = photons1.sliceBy(perCollision1, collision.collisionId());
       auto photons2_coll = photons2.sliceBy(perCollision2, collision.collisionId());
 
-      if constexpr (pairtype == PairType::kPCMPCM || pairtype == PairType::kPHOSPHOS || pairtype == PairType::kEMCEMC) {
-        for (auto& cut : cuts1) {
-          for (auto& paircut : paircuts) {
+      if constexpr (isSameSubsystem<pairtype>()) {
+        for (auto& [g1, g2] : combinations(CombinationsStrictlyUpperIndexPolicy(photons1_coll, photons2_coll))) {
+          const uint64_t cutmask1 = fCutMasks1[g1.globalIndex()];
+          const uint64_t cutmask2 = fCutMasks2[g2.globalIndex()];
+          if (!(cutmask1 & cutmask2)) {
+            continue;
+          }
+          const uint64_t paircutmask = getPairCutMask(g1, g2, paircuts);
+          if (!paircutmask) {
+            continue;
+          }
+
+          ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
+          ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
+          ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
+          if (abs(v12.Rapidity()) > maxY) {
+            continue;
+          }
+          forEachCutCombination<pairtype>(cutmask1, cuts1.size(), cutmask2, cuts2.size(), paircutmask, paircuts.size(), [&](size_t index, size_t icut1, size_t, size_t ipaircut) {
+            hMggPtSame[index]->Fill(v12.M(), v12.Pt());
+            if constexpr (pairtype == PairType::kEMCEMC) {
+              RotationBackground<aod::SkimEMCClusters>(v12, v1, v2, photons2_coll, g1.globalIndex(), g2.globalIndex(), cuts1[icut1], paircuts[ipaircut], emcmatchedtracks);
+            }
+          });
+        } // end of combination
 
-            for (auto& [g1, g2] : combinations(CombinationsStrictlyUpperIndexPolicy(photons1_coll, photons2_coll))) {
-              if (!IsSelectedPair<pairtype>(g1, g2, cut, cut)) {
-                continue;
-              }
-              if (!paircut.IsSelected(g1, g2)) {
-                continue;
-              }
+      } else { // different subsystem pairs
+        for (auto& [g1, g2] : combinations(CombinationsFullIndexPolicy(photons1_coll, photons2_coll))) {
+          const uint64_t cutmask1 = fCutMasks1[g1.globalIndex()];
+          const uint64_t cutmask2 = fCutMasks2[g2.globalIndex()];
+          if (!cutmask1 || !cutmask2) {
+            continue;
+          }
+          const uint64_t paircutmask = getPairCutMask(g1, g2, paircuts);
+          if (!paircutmask) {
+            continue;
+          }
+
+          if constexpr (pairtype == PairType::kPCMPHOS || pairtype == PairType::kPCMEMC) {
+            auto pos = g1.template posTrack_as<aod::V0Legs>();
+            auto ele = g1.template negTrack_as<aod::V0Legs>();
+
+            for (auto& v0leg : {pos, ele}) {
+              float deta = v0leg.eta() - g2.eta();
+              float dphi = TVector2::Phi_mpi_pi(TVector2::Phi_0_2pi(v0leg.phi()) - TVector2::Phi_0_2pi(g2.phi()));
+              float Ep = g2.e() / v0leg.p();
+              bool is_in_matching_window = pow(deta / 0.02, 2) + pow(dphi / 0.4, 2) < 1;
+              forEachCutCombination<pairtype>(cutmask1, cuts1.size(), cutmask2, cuts2.size(), paircutmask, paircuts.size(), [&](size_t index, size_t, size_t, size_t) {
+                hdEtadPhi[index]->Fill(dphi, deta);
+                hdEtaPt[index]->Fill(v0leg.pt(), deta);
+                hdPhiPt[index]->Fill(v0leg.pt(), dphi);
+                if (is_in_matching_window) {
+                  hEpE[index]->Fill(g2.e(), Ep);
+                }
+              });
+            }
 
-              ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
-              ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
-              ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
-              if (abs(v12.Rapidity()) > maxY) {
+            if constexpr (pairtype == PairType::kPCMPHOS) {
+              if (o2::aod::photonpair::DoesV0LegMatchWithCluster(pos, g2, 0.02, 0.4, 0.2) || o2::aod::photonpair::DoesV0LegMatchWithCluster(ele, g2, 0.02, 0.4, 0.2)) {
                 continue;
               }
-              reinterpret_cast<TH2F*>(list_pair_ss->FindObject(Form("%s_%s", cut.GetName(), cut.GetName()))->FindObject(paircut.GetName())->FindObject("hMggPt_Same"))->Fill(v12.M(), v12.Pt());
-
-              if constexpr (pairtype == PairType::kEMCEMC) {
-                RotationBackground<aod::SkimEMCClusters>(v12, v1, v2, photons2_coll, g1.globalIndex(), g2.globalIndex(), cut, paircut, emcmatchedtracks);
+            } else if constexpr (pairtype == PairType::kPCMEMC) {
+              if (o2::aod::photonpair::DoesV0LegMatchWithCluster(pos, g2, 0.02, 0.4, 0.5) || o2::aod::photonpair::DoesV0LegMatchWithCluster(ele, g2, 0.02, 0.4, 0.5)) {
+                continue;
               }
-            } // end of combination
-          }   // end of pair cut loop
-        }     // end of cut loop
-
-      } else { // different subsystem pairs
-        for (auto& cut1 : cuts1) {
-          for (auto& cut2 : cuts2) {
-            for (auto& paircut : paircuts) {
-              for (auto& [g1, g2] : combinations(CombinationsFullIndexPolicy(photons1_coll, photons2_coll))) {
-                if (!IsSelectedPair<pairtype>(g1, g2, cut1, cut2)) {
-                  continue;
-                }
-                if (!paircut.IsSelected(g1, g2)) {
-                  continue;
-                }
-
-                if constexpr (pairtype == PairType::kPCMPHOS || pairtype == PairType::kPCMEMC) {
-                  auto pos = g1.template posTrack_as<aod::V0Legs>();
-                  auto ele = g1.template negTrack_as<aod::V0Legs>();
-
-                  for (auto& v0leg : {pos, ele}) {
-                    float deta = v0leg.eta() - g2.eta();
-                    float dphi = TVector2::Phi_mpi_pi(TVector2::Phi_0_2pi(v0leg.phi()) - TVector2::Phi_0_2pi(g2.phi()));
-                    float Ep = g2.e() / v0leg.p();
-                    reinterpret_cast<TH2F*>(list_pair_ss->FindObject(Form("%s_%s", cut1.GetName(), cut2.GetName()))->FindObject(paircut.GetName())->FindObject("hdEtadPhi"))->Fill(dphi, deta);
-                    reinterpret_cast<TH2F*>(list_pair_ss->FindObject(Form("%s_%s", cut1.GetName(), cut2.GetName()))->FindObject(paircut.GetName())->FindObject("hdEtaPt"))->Fill(v0leg.pt(), deta);
-                    reinterpret_cast<TH2F*>(list_pair_ss->FindObject(Form("%s_%s", cut1.GetName(), cut2.GetName()))->FindObject(paircut.GetName())->FindObject("hdPhiPt"))->Fill(v0leg.pt(), dphi);
-                    if (pow(deta / 0.02, 2) + pow(dphi / 0.4, 2) < 1) {
-                      reinterpret_cast<TH2F*>(list_pair_ss->FindObject(Form("%s_%s", cut1.GetName(), cut2.GetName()))->FindObject(paircut.GetName())->FindObject("hEp_E"))->Fill(g2.e(), Ep);
-                    }
-                  }
-
-                  if constexpr (pairtype == PairType::kPCMPHOS) {
-                    if (o2::aod::photonpair::DoesV0LegMatchWithCluster(pos, g2, 0.02, 0.4, 0.2) || o2::aod::photonpair::DoesV0LegMatchWithCluster(ele, g2, 0.02, 0.4, 0.2)) {
-                      continue;
-                    }
-                  } else if constexpr (pairtype == PairType::kPCMEMC) {
-                    if (o2::aod::photonpair::DoesV0LegMatchWithCluster(pos, g2, 0.02, 0.4, 0.5) || o2::aod::photonpair::DoesV0LegMatchWithCluster(ele, g2, 0.02, 0.4, 0.5)) {
-                      continue;
-                    }
-                  }
-                }
-
-                ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
-                ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
-                ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
-                if (abs(v12.Rapidity()) > maxY) {
-                  continue;
-                }
-                // reinterpret_cast<TH2F*>(fMainList->FindObject("Pair")->FindObject(pairnames[pairtype].data())->FindObject(Form("%s_%s", cut1.GetName(), cut2.GetName()))->FindObject("hMggPt_Same"))->Fill(v12.M(), v12.Pt());
-                reinterpret_cast<TH2F*>(list_pair_ss->FindObject(Form("%s_%s", cut1.GetName(), cut2.GetName()))->FindObject(paircut.GetName())->FindObject("hMggPt_Same"))->Fill(v12.M(), v12.Pt());
-              } // end of combination
-            }   // end of pair cut loop
-          }     // end of cut2 loop
-        }       // end of cut1 loop
+            }
+          }
+
+          ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
+          ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
+          ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
+          if (abs(v12.Rapidity()) > maxY) {
+            continue;
+          }
+          forEachCutCombination<pairtype>(cutmask1, cuts1.size(), cutmask2, cuts2.size(), paircutmask, paircuts.size(), [&](size_t index, size_t, size_t, size_t) {
+            hMggPtSame[index]->Fill(v12.M(), v12.Pt());
+          });
+        } // end of combination
       }
     } // end of collision loop
   }
@@ -430,6 +534,7 @@ struct Pi0EtaToGammaGamma {
   void MixedEventPairing(TEvents const& collisions, TPhotons1 const& photons1, TPhotons2 const& photons2, TPreslice1 const& perCollision1, TPreslice2 const& perCollision2, TCuts1 const& cuts1, TCuts2 const& cuts2, TPairCuts const& paircuts, TLegs const& legs, TEMCMTs const& emcmatchedtracks)
   {
     THashList* list_pair_ss = static_cast<THashList*>(fMainList->FindObject("Pair")->FindObject(pairnames[pairtype].data()));
+    const auto hMggPtMixed = getPairHistograms<pairtype>(list_pair_ss, cuts1, cuts2, paircuts, "hMggPt_Mixed");
     // LOGF(info, "Number of collisions after filtering: %d", collisions.size());
     for (auto& [collision1, collision2] : soa::selfCombinations(colBinning, ndepth, -1, collisions, collisions)) { // internally, CombinationsStrictlyUpperIndexPolicy(collisions, collisions) is called.
 
@@ -441,36 +546,29 @@ struct Pi0EtaToGammaGamma {
       // LOGF(info, "collision1: posZ = %f, numContrib = %d , sel8 = %d | collision2: posZ = %f, numContrib = %d , sel8 = %d",
       //     collision1.posZ(), collision1.numContrib(), collision1.sel8(), collision2.posZ(), collision2.numContrib(), collision2.sel8());
 
-      for (auto& cut1 : cuts1) {
-        for (auto& cut2 : cuts2) {
-          for (auto& paircut : paircuts) {
-            for (auto& [g1, g2] : combinations(soa::CombinationsFullIndexPolicy(photons_coll1, photons_coll2))) {
-              // LOGF(info, "Mixed event photon pair: (%d, %d) from events (%d, %d), photon event: (%d, %d)", g1.index(), g2.index(), collision1.index(), collision2.index(), g1.collisionId(), g2.collisionId());
-
-              if ((pairtype == PairType::kPCMPCM || pairtype == PairType::kPHOSPHOS || pairtype == PairType::kEMCEMC) && (TString(cut1.GetName()) != TString(cut2.GetName()))) {
-                continue;
-              }
-              if (!IsSelectedPair<pairtype>(g1, g2, cut1, cut2)) {
-                continue;
-              }
-              if (!paircut.IsSelected(g1, g2)) {
-                continue;
-              }
+      for (auto& [g1, g2] : combinations(soa::CombinationsFullIndexPolicy(photons_coll1, photons_coll2))) {
+        // LOGF(info, "Mixed event photon pair: (%d, %d) from events (%d, %d), photon event: (%d, %d)", g1.index(), g2.index(), collision1.index(), collision2.index(), g1.collisionId(), g2.collisionId());
+        const uint64_t cutmask1 = fCutMasks1[g1.globalIndex()];
+        const uint64_t cutmask2 = fCutMasks2[g2.globalIndex()];
+        if (!cutmask1 || !cutmask2) {
+          continue;
+        }
+        const uint64_t paircutmask = getPairCutMask(g1, g2, paircuts);
+        if (!paircutmask) {
+          continue;
+        }
 
-              ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
-              ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
-              ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
-              if (abs(v12.Rapidity()) > maxY) {
-                continue;
-              }
-              // reinterpret_cast<TH2F*>(fMainList->FindObject("Pair")->FindObject(pairnames[pairtype].data())->FindObject(Form("%s_%s", cut1.GetName(), cut2.GetName()))->FindObject("hMggPt_Mixed"))->Fill(v12.M(), v12.Pt());
-              reinterpret_cast<TH2F*>(list_pair_ss->FindObject(Form("%s_%s", cut1.GetName(), cut2.GetName()))->FindObject(paircut.GetName())->FindObject("hMggPt_Mixed"))->Fill(v12.M(), v12.Pt());
-
-            } // end of different photon combinations
-          }   // end of pair cut loop
-        }     // end of cut2 loop
-      }       // end of cut1 loop
-    }         // end of different collision combinations
+        ROOT::Math::PtEtaPhiMVector v1(g1.pt(), g1.eta(), g1.phi(), 0.);
+        ROOT::Math::PtEtaPhiMVector v2(g2.pt(), g2.eta(), g2.phi(), 0.);
+        ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
+        if (abs(v12.Rapidity()) > maxY) {
+          continue;
+        }
+        forEachCutCombination<pairtype>(cutmask1, cuts1.size(), cutmask2, cuts2.size(), paircutmask, paircuts.size(), [&](size_t index, size_t, size_t, size_t) {
+          hMggPtMixed[index]->Fill(v12.M(), v12.Pt());
+        });
+      } // end of different photon combinations
+    } // end of different collision combinations
   }
 
   /// \brief Calculate background (using rotation background method only for EMCal!)
@@ -542,36 +640,42 @@ struct Pi0EtaToGammaGamma {
 
   void processPCMPCM(aod::EMReducedEvents const& collisions, MyFilteredCollisions const& filtered_collisions, MyV0Photons const& v0photons, aod::V0Legs const& legs)
   {
+    PrepareCutMasks<PairType::kPCMPCM>(v0photons, v0photons, fPCMCuts, fPCMCuts);
     SameEventPairing<PairType::kPCMPCM>(grouped_collisions, v0photons, v0photons, perCollision, perCollision, fPCMCuts, fPCMCuts, fPairCuts, legs, nullptr);
     MixedEventPairing<PairType::kPCMPCM>(filtered_collisions, v0photons, v0photons, perCollision, perCollision, fPCMCuts, fPCMCuts, fPairCuts, legs, nullptr);
   }
 
   void processPHOSPHOS(aod::EMReducedEvents const& collisions, MyFilteredCollisions const& filtered_collisions, aod::PHOSClusters const& phosclusters)
   {
+    PrepareCutMasks<PairType::kPHOSPHOS>(phosclusters, phosclusters, fPHOSCuts, fPHOSCuts);
     SameEventPairing<PairType::kPHOSPHOS>(grouped_collisions, phosclusters, phosclusters, perCollision_phos, perCollision_phos, fPHOSCuts, fPHOSCuts, fPairCuts, nullptr, nullptr);
     MixedEventPairing<PairType::kPHOSPHOS>(filtered_collisions, phosclusters, phosclusters, perCollision_phos, perCollision_phos, fPHOSCuts, fPHOSCuts, fPairCuts, nullptr, nullptr);
   }
 
   void processEMCEMC(aod::EMReducedEvents const& collisions, MyFilteredCollisions const& filtered_collisions, aod::SkimEMCClusters const& emcclusters, aod::SkimEMCMTs const& emcmatchedtracks)
   {
+    PrepareCutMasks<PairType::kEMCEMC>(emcclusters, emcclusters, fEMCCuts, fEMCCuts);
     SameEventPairing<PairType::kEMCEMC>(grouped_collisions, emcclusters, emcclusters, perCollision_emc, perCollision_emc, fEMCCuts, fEMCCuts, fPairCuts, nullptr, emcmatchedtracks);
     MixedEventPairing<PairType::kEMCEMC>(filtered_collisions, emcclusters, emcclusters, perCollision_emc, perCollision_emc, fEMCCuts, fEMCCuts, fPairCuts, nullptr, emcmatchedtracks);
   }
 
   void processPCMPHOS(aod::EMReducedEvents const& collisions, MyFilteredCollisions const& filtered_collisions, MyV0Photons const& v0photons, aod::PHOSClusters const& phosclusters, aod::V0Legs const& legs)
   {
+    PrepareCutMasks<PairType::kPCMPHOS>(v0photons, phosclusters, fPCMCuts, fPHOSCuts);
     SameEventPairing<PairType::kPCMPHOS>(grouped_collisions, v0photons, phosclusters, perCollision, perCollision_phos, fPCMCuts, fPHOSCuts, fPairCuts, legs, nullptr);
     MixedEventPairing<PairType::kPCMPHOS>(filtered_collisions, v0photons, phosclusters, perCollision, perCollision_phos, fPCMCuts, fPHOSCuts, fPairCuts, legs, nullptr);
   }
 
   void processPCMEMC(aod::EMReducedEvents const& collisions, MyFilteredCollisions const& filtered_collisions, MyV0Photons const& v0photons, aod::SkimEMCClusters const& emcclusters, aod::V0Legs const& legs, aod::SkimEMCMTs const& emcmatchedtracks)
   {
+    PrepareCutMasks<PairType::kPCMEMC>(v0photons, emcclusters, fPCMCuts, fEMCCuts);
     SameEventPairing<PairType::kPCMEMC>(grouped_collisions, v0photons, emcclusters, perCollision, perCollision_emc, fPCMCuts, fEMCCuts, fPairCuts, legs, emcmatchedtracks);
     MixedEventPairing<PairType::kPCMEMC>(filtered_collisions, v0photons, emcclusters, perCollision, perCollision_emc, fPCMCuts, fEMCCuts, fPairCuts, legs, emcmatchedtracks);
   }
 
   void processPHOSEMC(aod::EMReducedEvents const& collisions, MyFilteredCollisions const& filtered_collisions, aod::PHOSClusters const& phosclusters, aod::SkimEMCClusters const& emcclusters, aod::SkimEMCMTs const& emcmatchedtracks)
   {
+    PrepareCutMasks<PairType::kPHOSEMC>(phosclusters, emcclusters, fPHOSCuts, fEMCCuts);
     SameEventPairing<PairType::kPHOSEMC>(grouped_collisions, phosclusters, emcclusters, perCollision_phos, perCollision_emc, fPHOSCuts, fEMCCuts, fPairCuts, nullptr, emcmatchedtracks);
     MixedEventPairing<PairType::kPHOSEMC>(filtered_collisions, phosclusters, emcclusters, perCollision_phos, perCollision_emc, fPHOSCuts, fEMCCuts, fPairCuts, nullptr, emcmatchedtracks);
   }
@@ -15,7 +15,8 @@
 #ifndef PWGHF_CORE_SELECTORCUTS_H_
 #define PWGHF_CORE_SELECTORCUTS_H_
 
-#include <algorithm> // std::upper_bound
+#include <algorithm> // std::upper_bound, std::min
+#include <cmath>     // std::abs
 #include <iterator>  // std::distance
 #include <string>    // std::string
 #include <vector>    // std::vector
@@ -70,6 +71,65 @@ int findBin(T1 const& binsPt, T2 value)
   return std::distance(binsPt->begin(), std::upper_bound(binsPt->begin(), binsPt->end(), value)) - 1;
 }
 
+/// pT bins prepared for repeated lookups.
+/// \note find() returns the same bin as findBin(), without a binary search if the bins have a uniform width.
+class PtBins
+{
+ public:
+  PtBins() = default;
+  explicit PtBins(std::vector<double> const& binsPt) { set(binsPt); }
+
+  /// Copies the bin edges and checks whether the bins have a uniform width
+  /// \param binsPt  array of pT bin edges
+  void set(std::vector<double> const& binsPt)
+  {
+    mEdges = binsPt;
+    mNBins = static_cast<int>(mEdges.size()) - 1;
+    mIsUniform = mNBins > 0;
+    if (!mIsUniform) {
+      return;
+    }
+    const double width = (mEdges.back() - mEdges.front()) / mNBins;
+    for (int iBin = 0; iBin < mNBins; iBin++) {
+      if (std::abs(mEdges[iBin + 1] - mEdges[iBin] - width) > 1.e-9 * width) {
+        mIsUniform = false;
+        break;
+      }
+    }
+    mInvWidth = 1. / width;
+  }
+
+  /// Finds the pT bin
+  /// \param value  pT
+  /// \return index of the pT bin, -1 if outside the bins
+  int find(double value) const
+  {
+    if (mNBins <= 0 || value < mEdges.front() || value >= mEdges.back()) {
+      return -1;
+    }
+    if (!mIsUniform) {
+      return std::distance(mEdges.begin(), std::upper_bound(mEdges.begin(), mEdges.end(), value)) - 1;
+    }
+    int bin = std::min(static_cast<int>((value - mEdges.front()) * mInvWidth), mNBins - 1);
+    // protect against the rounding of the edges
+    if (value < mEdges[bin]) {
+      bin--;
+    } else if (value >= mEdges[bin + 1]) {
+      bin++;
+    }
+    return bin;
+  }
+
+  /// \return number of pT bins
+  int size() const { return mNBins; }
+
+ private:
+  std::vector<double> mEdges{}; // bin edges
+  int mNBins = 0;               // number of bins
+  bool mIsUniform = false;      // true if all the bins have the same width
+  double mInvWidth = 0.;        // inverse of the bin width, for uniform bins
+};
+
 // namespace per channel
 
 namespace hf_cuts_single_track
@@ -12,13 +12,21 @@
 /// \file ReducedDataModel.h
 /// \brief Header file with definition of methods and tables
 //  used to fold (unfold) track and primary vertex information by writing (reading) AO2Ds
-/// \note
+/// \note The compact tables store the covariance matrices as the square roots of the diagonal elements
+///       and the correlation coefficients packed on 8 bits, as the AO2D track tables, and the PID of the pions
+///       binned on 8 bits. Their collision table gives the offset and the number of the rows of each collision,
+///       so that the D mesons and the pions of a collision are read as contiguous ranges.
 ///
 /// \author Alexandre Bigot <alexandre.bigot@cern.ch>, IPHC Strasbourg
 
 #ifndef PWGHF_D2H_DATAMODEL_REDUCEDDATAMODEL_H_
 #define PWGHF_D2H_DATAMODEL_REDUCEDDATAMODEL_H_
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/ASoA.h"
 #include "ReconstructionDataFormats/Track.h"
@@ -59,6 +67,33 @@ DECLARE_SOA_TABLE(HfReducedCollisions, "AOD", "HFREDCOLLISION", //! Table with c
 
 using HfReducedCollision = HfReducedCollisions::iterator;
 
+namespace hf_reduced_collision_compact
+{
+DECLARE_SOA_COLUMN(TrackOffset, trackOffset, int);           //! Index of the first pion of the collision in HfTracksReducedCompact
+DECLARE_SOA_COLUMN(NTracks, nTracks, int);                   //! Number of pions of the collision
+DECLARE_SOA_COLUMN(Cand3ProngOffset, cand3ProngOffset, int); //! Index of the first D candidate of the collision in HfCand3ProngReducedCompact
+DECLARE_SOA_COLUMN(NCands3Prong, nCands3Prong, int);         //! Number of D candidates of the collision
+} // namespace hf_reduced_collision_compact
+
+DECLARE_SOA_TABLE(HfReducedCollisionsCompact, "AOD", "HFREDCOLLCMP", //! Table with collision for compact reduced workflow
+                  soa::Index<>,
+                  collision::PosX,
+                  collision::PosY,
+                  collision::PosZ,
+                  collision::CovXX,
+                  collision::CovXY,
+                  collision::CovYY,
+                  collision::CovXZ,
+                  collision::CovYZ,
+                  collision::CovZZ,
+                  hf_reduced_collision::Bz,
+                  hf_reduced_collision_compact::TrackOffset,
+                  hf_reduced_collision_compact::NTracks,
+                  hf_reduced_collision_compact::Cand3ProngOffset,
+                  hf_reduced_collision_compact::NCands3Prong);
+
+using HfReducedCollisionCompact = HfReducedCollisionsCompact::iterator;
+
 DECLARE_SOA_TABLE(HfOriginalCollisionsCounter, "AOD", "HFCOLCOUNTER", //! Table with original number of collisions
                   hf_reduced_collision::OriginalCollisionCount);
 
@@ -114,6 +149,133 @@ DECLARE_SOA_COLUMN(Pz, pz, float); //! Momentum in z-direction in GeV/c
     hf_track_par_cov::Py,        \
     hf_track_par_cov::Pz
 
+namespace hf_track_par_cov_compact
+{
+constexpr float RhoScale = 128.f; // as in the AO2D track tables
+
+/// Covariance matrix packed as the square roots of the diagonal elements and the correlation coefficients
+struct PackedCovariance {
+  std::array<float, 5> sigma;
+  std::array<int8_t, 10> rho;
+};
+
+inline int8_t packRho(float cov, float sigma1, float sigma2)
+{
+  if (sigma1 <= 0.f || sigma2 <= 0.f) {
+    return 0;
+  }
+  return static_cast<int8_t>(std::clamp(std::round(RhoScale * cov / (sigma1 * sigma2)), -RhoScale, RhoScale - 1.f));
+}
+inline float unpackRho(int8_t rho) { return rho / RhoScale; }
+
+/// \param cov is the covariance matrix of a track parametrisation, in the order of o2::track::TrackParCov
+inline PackedCovariance packCovariance(std::array<float, 15> const& cov)
+{
+  PackedCovariance packed;
+  constexpr int IndexDiagonal[5] = {0, 2, 5, 9, 14};
+  for (int i = 0; i < 5; ++i) {
+    packed.sigma[i] = std::sqrt(std::max(cov[IndexDiagonal[i]], 0.f));
+  }
+  int iRho = 0;
+  for (int i = 1; i < 5; ++i) {
+    for (int j = 0; j < i; ++j) {
+      packed.rho[iRho++] = packRho(cov[IndexDiagonal[i] - i + j], packed.sigma[i], packed.sigma[j]);
+    }
+  }
+  return packed;
+}
+
+// CAREFUL: the getters names shall be the same as the ones of the getTrackParCov method in Common/Core/trackUtilities.h
+DECLARE_SOA_DYNAMIC_COLUMN(CYY, cYY, //! Covariance matrix
+                           [](float sigmaY) -> float { return sigmaY * sigmaY; });
+DECLARE_SOA_DYNAMIC_COLUMN(CZY, cZY, //! Covariance matrix
+                           [](float sigmaZ, float sigmaY, int8_t rhoZY) -> float { return unpackRho(rhoZY) * sigmaZ * sigmaY; });
+DECLARE_SOA_DYNAMIC_COLUMN(CZZ, cZZ, //! Covariance matrix
+                           [](float sigmaZ) -> float { return sigmaZ * sigmaZ; });
+DECLARE_SOA_DYNAMIC_COLUMN(CSnpY, cSnpY, //! Covariance matrix
+                           [](float sigmaSnp, float sigmaY, int8_t rhoSnpY) -> float { return unpackRho(rhoSnpY) * sigmaSnp * sigmaY; });
+DECLARE_SOA_DYNAMIC_COLUMN(CSnpZ, cSnpZ, //! Covariance matrix
+                           [](float sigmaSnp, float sigmaZ, int8_t rhoSnpZ) -> float { return unpackRho(rhoSnpZ) * sigmaSnp * sigmaZ; });
+DECLARE_SOA_DYNAMIC_COLUMN(CSnpSnp, cSnpSnp, //! Covariance matrix
+                           [](float sigmaSnp) -> float { return sigmaSnp * sigmaSnp; });
+DECLARE_SOA_DYNAMIC_COLUMN(CTglY, cTglY, //! Covariance matrix
+                           [](float sigmaTgl, float sigmaY, int8_t rhoTglY) -> float { return unpackRho(rhoTglY) * sigmaTgl * sigmaY; });
+DECLARE_SOA_DYNAMIC_COLUMN(CTglZ, cTglZ, //! Covariance matrix
+                           [](float sigmaTgl, float sigmaZ, int8_t rhoTglZ) -> float { return unpackRho(rhoTglZ) * sigmaTgl * sigmaZ; });
+DECLARE_SOA_DYNAMIC_COLUMN(CTglSnp, cTglSnp, //! Covariance matrix
+                           [](float sigmaTgl, float sigmaSnp, int8_t rhoTglSnp) -> float { return unpackRho(rhoTglSnp) * sigmaTgl * sigmaSnp; });
+DECLARE_SOA_DYNAMIC_COLUMN(CTglTgl, cTglTgl, //! Covariance matrix
+                           [](float sigmaTgl) -> float { return sigmaTgl * sigmaTgl; });
+DECLARE_SOA_DYNAMIC_COLUMN(C1PtY, c1PtY, //! Covariance matrix
+                           [](float sigma1Pt, float sigmaY, int8_t rho1PtY) -> float { return unpackRho(rho1PtY) * sigma1Pt * sigmaY; });
+DECLARE_SOA_DYNAMIC_COLUMN(C1PtZ, c1PtZ, //! Covariance matrix
+                           [](float sigma1Pt, float sigmaZ, int8_t rho1PtZ) -> float { return unpackRho(rho1PtZ) * sigma1Pt * sigmaZ; });
+DECLARE_SOA_DYNAMIC_COLUMN(C1PtSnp, c1PtSnp, //! Covariance matrix
+                           [](float sigma1Pt, float sigmaSnp, int8_t rho1PtSnp) -> float { return unpackRho(rho1PtSnp) * sigma1Pt * sigmaSnp; });
+DECLARE_SOA_DYNAMIC_COLUMN(C1PtTgl, c1PtTgl, //! Covariance matrix
+                           [](float sigma1Pt, float sigmaTgl, int8_t rho1PtTgl) -> float { return unpackRho(rho1PtTgl) * sigma1Pt * sigmaTgl; });
+DECLARE_SOA_DYNAMIC_COLUMN(C1Pt21Pt2, c1Pt21Pt2, //! Covariance matrix
+                           [](float sigma1Pt) -> float { return sigma1Pt * sigma1Pt; });
+
+DECLARE_SOA_DYNAMIC_COLUMN(Px, px, //! Momentum in x-direction in GeV/c
+                           [](float signed1Pt, float snp, float alpha) -> float {
+                             auto pt = 1.f / std::abs(signed1Pt);
+                             auto r = std::sqrt((1.f - snp) * (1.f + snp));
+                             return pt * (r * std::cos(alpha) - snp * std::sin(alpha));
+                           });
+DECLARE_SOA_DYNAMIC_COLUMN(Py, py, //! Momentum in y-direction in GeV/c
+                           [](float signed1Pt, float snp, float alpha) -> float {
+                             auto pt = 1.f / std::abs(signed1Pt);
+                             auto r = std::sqrt((1.f - snp) * (1.f + snp));
+                             return pt * (snp * std::cos(alpha) + r * std::sin(alpha));
+                           });
+DECLARE_SOA_DYNAMIC_COLUMN(Pz, pz, //! Momentum in z-direction in GeV/c
+                           [](float signed1Pt, float tgl) -> float { return tgl / std::abs(signed1Pt); });
+} // namespace hf_track_par_cov_compact
+
+// general columns of the compact tables, with covariance matrix and momentum computed on the fly
+#define HFTRACKPARCOV_COMPACT_COLUMNS                                                                     \
+  aod::track::X,                                                                                          \
+    aod::track::Alpha,                                                                                    \
+    aod::track::Y,                                                                                        \
+    aod::track::Z,                                                                                        \
+    aod::track::Snp,                                                                                      \
+    aod::track::Tgl,                                                                                      \
+    aod::track::Signed1Pt,                                                                                \
+    aod::track::SigmaY,                                                                                   \
+    aod::track::SigmaZ,                                                                                   \
+    aod::track::SigmaSnp,                                                                                 \
+    aod::track::SigmaTgl,                                                                                 \
+    aod::track::Sigma1Pt,                                                                                 \
+    aod::track::RhoZY,                                                                                    \
+    aod::track::RhoSnpY,                                                                                  \
+    aod::track::RhoSnpZ,                                                                                  \
+    aod::track::RhoTglY,                                                                                  \
+    aod::track::RhoTglZ,                                                                                  \
+    aod::track::RhoTglSnp,                                                                                \
+    aod::track::Rho1PtY,                                                                                  \
+    aod::track::Rho1PtZ,                                                                                  \
+    aod::track::Rho1PtSnp,                                                                                \
+    aod::track::Rho1PtTgl,                                                                                \
+    hf_track_par_cov_compact::CYY<aod::track::SigmaY>,                                                    \
+    hf_track_par_cov_compact::CZY<aod::track::SigmaZ, aod::track::SigmaY, aod::track::RhoZY>,             \
+    hf_track_par_cov_compact::CZZ<aod::track::SigmaZ>,                                                    \
+    hf_track_par_cov_compact::CSnpY<aod::track::SigmaSnp, aod::track::SigmaY, aod::track::RhoSnpY>,       \
+    hf_track_par_cov_compact::CSnpZ<aod::track::SigmaSnp, aod::track::SigmaZ, aod::track::RhoSnpZ>,       \
+    hf_track_par_cov_compact::CSnpSnp<aod::track::SigmaSnp>,                                              \
+    hf_track_par_cov_compact::CTglY<aod::track::SigmaTgl, aod::track::SigmaY, aod::track::RhoTglY>,       \
+    hf_track_par_cov_compact::CTglZ<aod::track::SigmaTgl, aod::track::SigmaZ, aod::track::RhoTglZ>,       \
+    hf_track_par_cov_compact::CTglSnp<aod::track::SigmaTgl, aod::track::SigmaSnp, aod::track::RhoTglSnp>, \
+    hf_track_par_cov_compact::CTglTgl<aod::track::SigmaTgl>,                                              \
+    hf_track_par_cov_compact::C1PtY<aod::track::Sigma1Pt, aod::track::SigmaY, aod::track::Rho1PtY>,       \
+    hf_track_par_cov_compact::C1PtZ<aod::track::Sigma1Pt, aod::track::SigmaZ, aod::track::Rho1PtZ>,       \
+    hf_track_par_cov_compact::C1PtSnp<aod::track::Sigma1Pt, aod::track::SigmaSnp, aod::track::Rho1PtSnp>, \
+    hf_track_par_cov_compact::C1PtTgl<aod::track::Sigma1Pt, aod::track::SigmaTgl, aod::track::Rho1PtTgl>, \
+    hf_track_par_cov_compact::C1Pt21Pt2<aod::track::Sigma1Pt>,                                            \
+    hf_track_par_cov_compact::Px<aod::track::Signed1Pt, aod::track::Snp, aod::track::Alpha>,              \
+    hf_track_par_cov_compact::Py<aod::track::Signed1Pt, aod::track::Snp, aod::track::Alpha>,              \
+    hf_track_par_cov_compact::Pz<aod::track::Signed1Pt, aod::track::Tgl>
+
 namespace hf_track_index_reduced
 {
 DECLARE_SOA_INDEX_COLUMN(HfReducedCollision, hfReducedCollision); //! ReducedCollision index
@@ -128,11 +290,44 @@ DECLARE_SOA_TABLE(HfTracksReduced, "AOD", "HFTRACKRED", //! Table with track inf
                   hf_track_index_reduced::HfReducedCollisionId,
                   HFTRACKPARCOV_COLUMNS);
 
+DECLARE_SOA_TABLE(HfTracksReducedCompact, "AOD", "HFTRACKREDCMP", //! Table with track information for compact reduced workflow
+                  soa::Index<>,
+                  hf_track_index_reduced::TrackId,
+                  HFTRACKPARCOV_COMPACT_COLUMNS);
+
 namespace hf_track_pid_reduced
 {
 DECLARE_SOA_COLUMN(Pt, pt, float); //! Transverse momentum of the track in GeV/c
 } // namespace hf_track_pid_reduced
 
+namespace hf_track_pid_reduced_compact
+{
+enum PidFlags : uint8_t {
+  TpcMatch = BIT(0),
+  TofMatch = BIT(1)
+};
+
+/// \return nsigma binned as in the tiny PID tables
+template <typename TBinning>
+typename TBinning::binned_t packNSigma(float nSigma)
+{
+  if (nSigma <= TBinning::binned_min) {
+    return TBinning::underflowBin;
+  } else if (nSigma >= TBinning::binned_max) {
+    return TBinning::overflowBin;
+  } else if (nSigma >= 0) {
+    return static_cast<typename TBinning::binned_t>((nSigma / TBinning::bin_width) + 0.5f);
+  }
+  return static_cast<typename TBinning::binned_t>((nSigma / TBinning::bin_width) - 0.5f);
+}
+
+DECLARE_SOA_COLUMN(Flags, flags, uint8_t); //! Detector matching flags, see PidFlags
+DECLARE_SOA_DYNAMIC_COLUMN(HasTPC, hasTPC, //! Flag to check if track has a TPC match
+                           [](uint8_t flags) -> bool { return flags & PidFlags::TpcMatch; });
+DECLARE_SOA_DYNAMIC_COLUMN(HasTOF, hasTOF, //! Flag to check if track has a TOF match
+                           [](uint8_t flags) -> bool { return flags & PidFlags::TofMatch; });
+} // namespace hf_track_pid_reduced_compact
+
 // table with all attributes needed to call getStatusTrackPIDTpcAndTof() in the selector task
 DECLARE_SOA_TABLE(HfTracksPidReduced, "AOD", "HFTRACKPIDRED", //! Table with PID track information for reduced workflow
                   o2::soa::Index<>,
@@ -151,6 +346,33 @@ DECLARE_SOA_TABLE(HfTracksPidReduced, "AOD", "HFTRACKPIDRED", //! Table with PID
                   pidtof::TOFNSigmaKa,
                   pidtof::TOFNSigmaPr);
 
+DECLARE_SOA_TABLE(HfTracksPidReducedCompact, "AOD", "HFTRKPIDREDCMP", //! Table with binned PID track information for compact reduced workflow
+                  o2::soa::Index<>,
+                  hf_track_pid_reduced::Pt,
+                  hf_track_pid_reduced_compact::Flags,
+                  pidtpc_tiny::TPCNSigmaStoreEl,
+                  pidtpc_tiny::TPCNSigmaStoreMu,
+                  pidtpc_tiny::TPCNSigmaStorePi,
+                  pidtpc_tiny::TPCNSigmaStoreKa,
+                  pidtpc_tiny::TPCNSigmaStorePr,
+                  pidtof_tiny::TOFNSigmaStoreEl,
+                  pidtof_tiny::TOFNSigmaStoreMu,
+                  pidtof_tiny::TOFNSigmaStorePi,
+                  pidtof_tiny::TOFNSigmaStoreKa,
+                  pidtof_tiny::TOFNSigmaStorePr,
+                  hf_track_pid_reduced_compact::HasTPC<hf_track_pid_reduced_compact::Flags>,
+                  hf_track_pid_reduced_compact::HasTOF<hf_track_pid_reduced_compact::Flags>,
+                  pidtpc_tiny::TPCNSigmaEl<pidtpc_tiny::TPCNSigmaStoreEl>,
+                  pidtpc_tiny::TPCNSigmaMu<pidtpc_tiny::TPCNSigmaStoreMu>,
+                  pidtpc_tiny::TPCNSigmaPi<pidtpc_tiny::TPCNSigmaStorePi>,
+                  pidtpc_tiny::TPCNSigmaKa<pidtpc_tiny::TPCNSigmaStoreKa>,
+                  pidtpc_tiny::TPCNSigmaPr<pidtpc_tiny::TPCNSigmaStorePr>,
+                  pidtof_tiny::TOFNSigmaEl<pidtof_tiny::TOFNSigmaStoreEl>,
+                  pidtof_tiny::TOFNSigmaMu<pidtof_tiny::TOFNSigmaStoreMu>,
+                  pidtof_tiny::TOFNSigmaPi<pidtof_tiny::TOFNSigmaStorePi>,
+                  pidtof_tiny::TOFNSigmaKa<pidtof_tiny::TOFNSigmaStoreKa>,
+                  pidtof_tiny::TOFNSigmaPr<pidtof_tiny::TOFNSigmaStorePr>);
+
 namespace hf_cand_3prong_reduced
 {
 DECLARE_SOA_COLUMN(CPA, cpa, float);                 //! Cosinus pointing angle
@@ -176,6 +398,14 @@ DECLARE_SOA_TABLE(HfCand3ProngReduced, "AOD", "HFCAND3PRONGRED", //! Table with
                   hf_cand_3prong_reduced::DecayLength,
                   hf_cand_3prong_reduced::InvMass);
 
+DECLARE_SOA_TABLE(HfCand3ProngReducedCompact, "AOD", "HFCAND3PRCMP", //! Table with 3prong candidate information for compact reduced workflow
+                  o2::soa::Index<>,
+                  hf_track_index::Prong0Id, hf_track_index::Prong1Id, hf_track_index::Prong2Id,
+                  HFTRACKPARCOV_COMPACT_COLUMNS,
+                  hf_cand_3prong_reduced::CPA,
+                  hf_cand_3prong_reduced::DecayLength,
+                  hf_cand_3prong_reduced::InvMass);
+
 namespace hf_b0_mc
 {
 // MC Rec
@@ -238,6 +468,9 @@ namespace soa
 DECLARE_EQUIVALENT_FOR_INDEX(aod::HfCand3ProngBase, aod::HfCand3ProngReduced);
 DECLARE_EQUIVALENT_FOR_INDEX(aod::StoredTracks, aod::HfTracksReduced);
 DECLARE_EQUIVALENT_FOR_INDEX(aod::StoredTracks, aod::HfTracksPidReduced);
+DECLARE_EQUIVALENT_FOR_INDEX(aod::HfCand3ProngBase, aod::HfCand3ProngReducedCompact);
+DECLARE_EQUIVALENT_FOR_INDEX(aod::StoredTracks, aod::HfTracksReducedCompact);
+DECLARE_EQUIVALENT_FOR_INDEX(aod::StoredTracks, aod::HfTracksPidReducedCompact);
 } // namespace soa
 } // namespace o2
 #endif // PWGHF_D2H_DATAMODEL_REDUCEDDATAMODEL_H_
@@ -36,6 +36,7 @@ ClassImp(HFInvMassFitter);
 HFInvMassFitter::HFInvMassFitter() : TNamed(),
                                      mHistoInvMass(0x0),
                                      mFitOption("L,E"),
+                                     mNumberOfCpus(1),
                                      mMinMass(0),
                                      mMaxMass(5),
                                      mTypeOfBkgPdf(Expo),
@@ -102,6 +103,7 @@ HFInvMassFitter::HFInvMassFitter() : TNamed(),
 HFInvMassFitter::HFInvMassFitter(const TH1F* histoToFit, Double_t minValue, Double_t maxValue, Int_t fitTypeBkg, Int_t fitTypeSgn) : TNamed(),
                                                                                                                                      mHistoInvMass(0x0),
                                                                                                                                      mFitOption("L,E"),
+                                                                                                                                     mNumberOfCpus(1),
                                                                                                                                      mMinMass(minValue),
                                                                                                                                      mMaxMass(maxValue),
                                                                                                                                      mTypeOfBkgPdf(fitTypeBkg),
@@ -225,11 +227,7 @@ void HFInvMassFitter::doFit(Bool_t draw)
   if (mTypeOfBkgPdf == 6) {                                                                                    // MC
     mRooNSgn = new RooRealVar("mRooNSig", "number of signal", 0.3 * mIntegralHisto, 0., 1.2 * mIntegralHisto); // signal yield
     mTotalPdf = new RooAddPdf("mMCFunc", "MC fit function", RooArgList(*sgnPdf), RooArgList(*mRooNSgn));       // create total pdf
-    if (!strcmp(mFitOption.Data(), "Chi2")) {
-      mTotalPdf->chi2FitTo(dataHistogram, Range("signal"));
-    } else {
-      mTotalPdf->fitTo(dataHistogram, Range("signal"));
-    }
+    fitToData(mTotalPdf, dataHistogram, "signal");
     RooAbsReal* signalIntergralMc = mTotalPdf->createIntegral(*mass, NormSet(*mass), Range("signal")); // sig yield from fit
     mIntegralSgn = signalIntergralMc->getValV();
     calculateSignal(mRawYield, mRawYieldErr);        // calculate signal and signal error
@@ -237,17 +235,9 @@ void HFInvMassFitter::doFit(Bool_t draw)
   } else {                                           // data
     mBkgPdf = new RooAddPdf("mBkgPdf", "background fit function", RooArgList(*bkgPdf), RooArgList(*mRooNBkg));
     if (mTypeOfSgnPdf == 3) { // two peak fit
-      if (!strcmp(mFitOption.Data(), "Chi2")) {
-        mBkgPdf->chi2FitTo(dataHistogram, Range("SBL,SBR,SEC"), Save());
-      } else {
-        mBkgPdf->fitTo(dataHistogram, Range("SBL,SBR,SEC"), Save());
-      }
+      fitToData(mBkgPdf, dataHistogram, "SBL,SBR,SEC");
     } else { // single peak fit
-      if (!strcmp(mFitOption.Data(), "Chi2")) {
-        mBkgPdf->chi2FitTo(dataHistogram, Range("SBL,SBR"), Save());
-      } else {
-        mBkgPdf->fitTo(dataHistogram, Range("SBL,SBR"), Save());
-      }
+      fitToData(mBkgPdf, dataHistogram, "SBL,SBR");
     }
 
     // estimate signal yield
@@ -272,22 +262,14 @@ void HFInvMassFitter::doFit(Bool_t draw)
       reflHistogram.plotOn(mReflOnlyFrame);
       mRooNRefl = new RooRealVar("mNRefl", "number of reflection", 0.5 * mHistoTemplateRefl->Integral(), 0, mHistoTemplateRefl->Integral());
       RooAddPdf reflFuncTemp("reflFuncTemp", "template reflection fit function", RooArgList(*reflPdf), RooArgList(*mRooNRefl));
-      if (!strcmp(mFitOption.Data(), "Chi2")) {
-        reflFuncTemp.chi2FitTo(reflHistogram);
-      } else {
-        reflFuncTemp.fitTo(reflHistogram);
-      }
+      fitToData(&reflFuncTemp, reflHistogram);
       reflFuncTemp.plotOn(mReflOnlyFrame);
 
       mRooNRefl->setVal(mReflOverSgn * estimatedSignal);
       mRooNRefl->setConstant(kTRUE);
       setReflFuncFixed(); // fix reflection pdf parameter
       mTotalPdf = new RooAddPdf("mTotalPdf", "background + signal + reflection fit function", RooArgList(*bkgPdf, *sgnPdf, *reflPdf), RooArgList(*mRooNBkg, *mRooNSgn, *mRooNRefl));
-      if (!strcmp(mFitOption.Data(), "Chi2")) {
-        mTotalPdf->chi2FitTo(dataHistogram);
-      } else {
-        mTotalPdf->fitTo(dataHistogram);
-      }
+      fitToData(mTotalPdf, dataHistogram);
       mTotalPdf->plotOn(mInvMassFrame, Name("Tot_c"));
       mReflPdf = new RooAddPdf("mReflPdf", "reflection fit function", RooArgList(*reflPdf), RooArgList(*mRooNRefl));
       RooAddPdf reflBkgPdf("reflBkgPdf", "reflBkgPdf", RooArgList(*bkgPdf, *reflPdf), RooArgList(*mRooNBkg, *mRooNRefl));
@@ -303,11 +285,7 @@ void HFInvMassFitter::doFit(Bool_t draw)
       mSgnPdf->plotOn(mResidualFrame, Normalization(1.0, RooAbsReal::RelativeExpected), LineColor(kBlue));
     } else {
       mTotalPdf = new RooAddPdf("mTotalPdf", "background + signal pdf", RooArgList(*bkgPdf, *sgnPdf), RooArgList(*mRooNBkg, *mRooNSgn));
-      if (!strcmp(mFitOption.Data(), "Chi2")) {
-        mTotalPdf->chi2FitTo(dataHistogram);
-      } else {
-        mTotalPdf->fitTo(dataHistogram);
-      }
+      fitToData(mTotalPdf, dataHistogram);
       plotBkg(mTotalPdf);
       mTotalPdf->plotOn(mInvMassFrame, Components("mReflFuncDoubleGaus"), Name("refl_c"), LineColor(kGreen));
       mTotalPdf->plotOn(mInvMassFrame, Name("Tot_c"), LineColor(kBlue));
@@ -331,6 +309,18 @@ void HFInvMassFitter::doFit(Bool_t draw)
   }
 }
 
+// fit a pdf to the data, in the given ranges if any, with the likelihood or the chi2
+void HFInvMassFitter::fitToData(RooAbsPdf* pdf, RooDataHist& data, const char* range)
+{
+  RooCmdArg rangeArg = range ? Range(range) : RooCmdArg::none();
+  if (!strcmp(mFitOption.Data(), "Chi2")) {
+    pdf->chi2FitTo(data, rangeArg, NumCPU(mNumberOfCpus));
+  } else {
+    pdf->fitTo(data, rangeArg, NumCPU(mNumberOfCpus));
+  }
+}
+
+// only the pdfs of the selected functions are imported, with their parameters
 void HFInvMassFitter::fillWorkspace(RooWorkspace& workspace)
 {
   // Declare observable variable
@@ -338,25 +328,40 @@ void HFInvMassFitter::fillWorkspace(RooWorkspace& workspace)
   // bkg expo
   RooRealVar tau("tau", "tau", -1, -5., 5.);
   RooAbsPdf* bkgFuncExpo = new RooExponential("bkgFuncExpo", "background fit function", mass, tau);
-  workspace.import(*bkgFuncExpo);
+  if (mTypeOfBkgPdf == Expo) {
+    workspace.import(*bkgFuncExpo);
+  }
+  delete bkgFuncExpo;
   // bkg poly1
   RooRealVar PolyParam0("PolyParam0", "Parameter of Poly function", 0.5, -5., 5.);
   RooRealVar PolyParam1("PolyParam1", "Parameter of Poly function", 0.2, -5., 5.);
   RooAbsPdf* bkgFuncPoly1 = new RooPolynomial("bkgFuncPoly1", "background fit function", mass, RooArgSet(PolyParam0, PolyParam1));
-  workspace.import(*bkgFuncPoly1);
+  if (mTypeOfBkgPdf == Poly1) {
+    workspace.import(*bkgFuncPoly1);
+  }
+  delete bkgFuncPoly1;
   // bkg poly2
   RooRealVar PolyParam2("PolyParam2", "Parameter of Poly function", 0.2, -5., 5.);
   RooAbsPdf* bkgFuncPoly2 = new RooPolynomial("bkgFuncPoly2", "background fit function", mass, RooArgSet(PolyParam0, PolyParam1, PolyParam2));
-  workspace.import(*bkgFuncPoly2);
+  if (mTypeOfBkgPdf == Poly2) {
+    workspace.import(*bkgFuncPoly2);
+  }
+  delete bkgFuncPoly2;
   // bkg poly3
   RooRealVar PolyParam3("PolyParam3", "Parameter of Poly function", 0.2, -1., 1.);
   RooAbsPdf* bkgFuncPoly3 = new RooPolynomial("bkgFuncPoly3", "background pdf", mass, RooArgSet(PolyParam0, PolyParam1, PolyParam2, PolyParam3));
-  workspace.import(*bkgFuncPoly3);
+  if (mTypeOfBkgPdf == Poly3) {
+    workspace.import(*bkgFuncPoly3);
+  }
+  delete bkgFuncPoly3;
   // bkg power law
   RooRealVar PowParam1("PowParam1", "Parameter of Pow function", 0.13957);
   RooRealVar PowParam2("PowParam2", "Parameter of Pow function", 1., -10, 10);
   RooAbsPdf* bkgFuncPow = new RooGenericPdf("bkgFuncPow", "bkgFuncPow", "(mass-PowParam1)^PowParam2", RooArgSet(mass, PowParam1, PowParam2));
-  workspace.import(*bkgFuncPow);
+  if (mTypeOfBkgPdf == Pow) {
+    workspace.import(*bkgFuncPow);
+  }
+  delete bkgFuncPow;
   // pow * exp
   RooRealVar PowExpoParam1("PowExpoParam1", "Parameter of PowExpo function", 1 / 2);
   RooRealVar PowExpoParam2("PowExpoParam2", "Parameter of PowExpo function", 1, -10, 10);
@@ -364,7 +369,10 @@ void HFInvMassFitter::fillWorkspace(RooWorkspace& workspace)
   RooFormulaVar PowExpoParam3("PowExpoParam3", "PowExpoParam1 + 1", RooArgList(PowExpoParam1));
   RooFormulaVar PowExpoParam4("PowExpoParam4", "1./PowExpoParam2", RooArgList(PowExpoParam2));
   RooAbsPdf* bkgFuncPowExpo = new RooGamma("bkgFuncPowExpo", "background pdf", mass, PowExpoParam3, PowExpoParam4, massPi);
-  workspace.import(*bkgFuncPowExpo);
+  if (mTypeOfBkgPdf == PowExpo) {
+    workspace.import(*bkgFuncPowExpo);
+  }
+  delete bkgFuncPowExpo;
   // signal pdf
   RooRealVar mean("mean", "mean for signal fit", mMass, 1.86, 1.87);
   if (mBoundMean) {
@@ -386,7 +394,10 @@ void HFInvMassFitter::fillWorkspace(RooWorkspace& workspace)
     sigma.setMin(mSigmaSgn * (1 - mParamSgn));
   }
   RooAbsPdf* sgnFuncGaus = new RooGaussian("sgnFuncGaus", "signal pdf", mass, mean, sigma);
-  workspace.import(*sgnFuncGaus);
+  if (mTypeOfSgnPdf == SingleGaus) {
+    workspace.import(*sgnFuncGaus);
+  }
+  delete sgnFuncGaus;
   // signal double Gaussianaa
   RooRealVar sigmaDoubleGaus("sigmaDoubleGaus", "sigma2Gaus", mSigmaSgn, mSigmaSgn - 0.01, mSigmaSgn + 0.01);
   if (mBoundSigma) {
@@ -409,7 +420,10 @@ void HFInvMassFitter::fillWorkspace(RooWorkspace& workspace)
     fracDoubleGaus.setConstant(kTRUE);
   }
   RooAbsPdf* sgnFuncDoubleGaus = new RooAddPdf("sgnFuncDoubleGaus", "signal pdf", RooArgList(gaus1, gaus2), fracDoubleGaus);
-  workspace.import(*sgnFuncDoubleGaus);
+  if (mTypeOfSgnPdf == DoubleGaus) {
+    workspace.import(*sgnFuncDoubleGaus);
+  }
+  delete sgnFuncDoubleGaus;
   // double Gaussian ratio
   RooRealVar ratio("ratio", "ratio of sigma12", mRatioDoubleGausSigma, 0, 10);
   if (mFixedSigma) {
@@ -433,7 +447,10 @@ void HFInvMassFitter::fillWorkspace(RooWorkspace& workspace)
     fracDoubleGausRatio.setConstant(kTRUE);
   }
   RooAbsPdf* sgnFuncGausRatio = new RooAddPdf("sgnFuncGausRatio", "signal pdf", RooArgList(gausRatio1, gausRatio2), fracDoubleGausRatio);
-  workspace.import(*sgnFuncGausRatio);
+  if (mTypeOfSgnPdf == DoubleGausSigmaRatioPar) {
+    workspace.import(*sgnFuncGausRatio);
+  }
+  delete sgnFuncGausRatio;
   // double peak for Ds
   RooRealVar meanSec("meanSec", "mean for second peak fit", mSecMass, mMinMass, mMaxMass);
   RooRealVar sigmaSec("sigmaSec", "sigmaSec", mSecSigma, mSecSigma - 0.005, mSecSigma + 0.01);
@@ -457,7 +474,10 @@ void HFInvMassFitter::fillWorkspace(RooWorkspace& workspace)
   RooGaussian gausSec2("gausSec2", "gausSec2", mass, meanSec, sigmaSec);
   RooRealVar fracSec("fracSec", "frac of two peak", 0.5, 0, 1.);
   RooAbsPdf* sgnFuncDoublePeak = new RooAddPdf("sgnFuncDoublePeak", "signal pdf", RooArgList(gausSec1, gausSec2), fracSec);
-  workspace.import(*sgnFuncDoublePeak);
+  if (mTypeOfSgnPdf == GausSec) {
+    workspace.import(*sgnFuncDoublePeak);
+  }
+  delete sgnFuncDoublePeak;
   // reflection Gaussian
   RooRealVar meanRefl("meanRefl", "mean for reflection", mMass, 0.0, mMass + 0.05);
   if (mBoundReflMean) {
@@ -466,7 +486,10 @@ void HFInvMassFitter::fillWorkspace(RooWorkspace& workspace)
   }
   RooRealVar sigmaRefl("sigmaRefl", "sigma for reflection", 0.012, 0, 0.25);
   RooAbsPdf* reflFuncGaus = new RooGaussian("reflFuncGaus", "reflection pdf", mass, meanRefl, sigmaRefl);
-  workspace.import(*reflFuncGaus);
+  if (mHistoTemplateRefl && mTypeOfReflPdf == SingleGausRefl) {
+    workspace.import(*reflFuncGaus);
+  }
+  delete reflFuncGaus;
   // reflection double Gaussian
   RooRealVar meanReflDoubleGaus("meanReflDoubleGaus", "mean for reflection double gaussian", mMass, 0.0, mMass + 0.05);
   if (mBoundReflMean) {
@@ -478,20 +501,29 @@ void HFInvMassFitter::fillWorkspace(RooWorkspace& workspace)
   RooGaussian gausRefl2("gausRefl2", "gausRefl2", mass, meanReflDoubleGaus, sigmaReflDoubleGaus);
   RooRealVar fracRefl("fracRefl", "frac of two gauss", 0.5, 0, 1.);
   RooAbsPdf* reflFuncDoubleGaus = new RooAddPdf("reflFuncDoubleGaus", "reflection pdf", RooArgList(gausRefl1, gausRefl2), fracRefl);
-  workspace.import(*reflFuncDoubleGaus);
+  if (mHistoTemplateRefl && mTypeOfReflPdf == DoubleGausRefl) {
+    workspace.import(*reflFuncDoubleGaus);
+  }
+  delete reflFuncDoubleGaus;
   // reflection poly3
   RooRealVar PolyReflParam0("PolyReflParam0", "PolyReflParam0", 0.5, -1., 1.);
   RooRealVar PolyReflParam1("PolyReflParam1", "PolyReflParam1", 0.2, -1., 1.);
   RooRealVar PolyReflParam2("PolyReflParam2", "PolyReflParam2", 0.2, -1., 1.);
   RooRealVar PolyReflParam3("PolyReflParam3", "PolyReflParam3", 0.2, -1., 1.);
   RooAbsPdf* reflFuncPoly3 = new RooPolynomial("reflFuncPoly3", "reflection PDF", mass, RooArgSet(PolyReflParam0, PolyReflParam1, PolyReflParam2, PolyReflParam3));
-  workspace.import(*reflFuncPoly3);
+  if (mHistoTemplateRefl && mTypeOfReflPdf == Poly3Refl) {
+    workspace.import(*reflFuncPoly3);
+  }
+  delete reflFuncPoly3;
   // reflection poly6
   RooRealVar PolyReflParam4("PolyReflParam4", "PolyReflParam4", 0.2, -1., 1.);
   RooRealVar PolyReflParam5("PolyReflParam5", "PolyReflParam5", 0.2, -1., 1.);
   RooRealVar PolyReflParam6("PolyReflParam6", "PolyReflParam6", 0.2, -1., 1.);
   RooAbsPdf* reflFuncPoly6 = new RooPolynomial("reflFuncPoly6", "reflection pdf", mass, RooArgSet(PolyReflParam0, PolyReflParam1, PolyReflParam2, PolyReflParam3, PolyReflParam4, PolyReflParam5, PolyReflParam6));
-  workspace.import(*reflFuncPoly6);
+  if (mHistoTemplateRefl && mTypeOfReflPdf == Poly6Refl) {
+    workspace.import(*reflFuncPoly6);
+  }
+  delete reflFuncPoly6;
 }
 // draw fit output
 void HFInvMassFitter::drawFit(TVirtualPad* pad, Int_t writeFitInfo)
@@ -22,6 +22,7 @@
 
 #include <string> // std::string
 
+#include <RooDataHist.h>
 #include <RooWorkspace.h>
 #include <TCanvas.h>
 #include <TCanvas.h>
@@ -80,6 +81,7 @@ class HFInvMassFitter : public TNamed
   void setUseLikelihoodFit() { mFitOption = "L,E"; }
   void setUseChi2Fit() { mFitOption = "Chi2"; }
   void setFitOption(TString opt) { mFitOption = opt.Data(); }
+  void setNumberOfCpus(Int_t nCpus) { mNumberOfCpus = nCpus; }
   RooAbsPdf* createBackgroundFitFunction(RooWorkspace* w1);
   RooAbsPdf* createSignalFitFunction(RooWorkspace* w1);
   RooAbsPdf* createReflectionFitFunction(RooWorkspace* w1);
@@ -227,9 +229,11 @@ class HFInvMassFitter : public TNamed
   HFInvMassFitter(const HFInvMassFitter& source);
   HFInvMassFitter& operator=(const HFInvMassFitter& source);
   void fillWorkspace(RooWorkspace& w);
+  void fitToData(RooAbsPdf* pdf, RooDataHist& data, const char* range = nullptr);
 
   TH1F* mHistoInvMass; // histogram to fit
   TString mFitOption;
+  Int_t mNumberOfCpus;               // number of processes used to compute the likelihood or the chi2 of the fits
   Double_t mMinMass;                 // lower mass limit
   Double_t mMaxMass;                 // upper mass limit
   Int_t mTypeOfBkgPdf;               // background fit function
@@ -12,8 +12,13 @@
 /// \file candidateCreatorB0Reduced.cxx
 /// \brief Reconstruction of B0 candidates
 ///
+/// The B0 candidates are reconstructed from the full reduced tables or from the compact ones (processCompact),
+/// in which the pions of a collision are read as one contiguous range.
+///
 /// \author Alexandre Bigot <alexandre.bigot@cern.ch>, IPHC Strasbourg
 
+#include <vector>
+
 #include "DCAFitter/DCAFitterN.h"
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
@@ -58,6 +63,14 @@ struct HfCandidateCreatorB0Reduced {
   Preslice<aod::HfCand3ProngReduced> candsDPerCollision = hf_track_index_reduced::hfReducedCollisionId;
   Preslice<aod::HfTracksReduced> tracksPionPerCollision = hf_track_index_reduced::hfReducedCollisionId;
 
+  /// Bachelor pion of a collision, with its parametrisation built once for all the D candidates
+  struct PionCandidate {
+    int64_t globalIndex;
+    o2::track::TrackParCov trackParCov;
+    std::array<float, 3> pVec;
+  };
+  std::vector<PionCandidate> pionsThisCollision;
+
   HistogramRegistry registry{"registry"};
 
   void init(InitContext const&)
@@ -76,12 +89,95 @@ struct HfCandidateCreatorB0Reduced {
     df2.setMinRelChi2Change(minRelChi2Change);
     df2.setUseAbsDCA(useAbsDCA);
     df2.setWeightedFinalPCA(useWeightedFinalPCA);
+
+    if (doprocessData && doprocessCompact) {
+      LOGP(fatal, "Only one process function between processData and processCompact can be enabled at a time.");
+    }
+  }
+
+  template <typename TPion>
+  void addPion(TPion const& trackPion)
+  {
+    pionsThisCollision.push_back({trackPion.globalIndex(), getTrackParCov(trackPion), {trackPion.px(), trackPion.py(), trackPion.pz()}});
+  }
+
+  /// Pairs a D candidate with the pions of its collision and fills the B0 candidates
+  template <typename TCollision, typename TCandD>
+  void reconstructB0(TCollision const& collision, TCandD const& candD)
+  {
+    auto thisCollId = collision.globalIndex();
+    auto primaryVertex = getPrimaryVertex(collision);
+    auto covMatrixPV = primaryVertex.getCov();
+
+    auto trackParCovD = getTrackParCov(candD);
+    std::array<float, 3> pVecD = {candD.px(), candD.py(), candD.pz()};
+
+    for (const auto& pion : pionsThisCollision) {
+      auto trackParCovPi = pion.trackParCov;
+      std::array<float, 3> pVecPion = pion.pVec;
+
+      // ---------------------------------
+      // reconstruct the 2-prong B0 vertex
+      if (df2.process(trackParCovD, trackParCovPi) == 0) {
+        continue;
+      }
+      // DPi passed B0 reconstruction
+
+      // calculate relevant properties
+      const auto& secondaryVertexB0 = df2.getPCACandidate();
+      auto chi2PCA = df2.getChi2AtPCACandidate();
+      auto covMatrixPCA = df2.calcPCACovMatrixFlat();
+      registry.fill(HIST("hCovSVXX"), covMatrixPCA[0]);
+      registry.fill(HIST("hCovPVXX"), covMatrixPV[0]);
+
+      // propagate D and Pi to the B0 vertex
+      df2.propagateTracksToVertex();
+      // track.getPxPyPzGlo(pVec) modifies pVec of track
+      df2.getTrack(0).getPxPyPzGlo(pVecD);    // momentum of D at the B0 vertex
+      df2.getTrack(1).getPxPyPzGlo(pVecPion); // momentum of Pi at the B0 vertex
+
+      // compute invariant
+      massDPi = RecoDecay::m(array{pVecD, pVecPion}, array{massD, massPi});
+
+      if (std::abs(massDPi - massB0) > invMassWindowB0) {
+        continue;
+      }
+      registry.fill(HIST("hMassB0ToDPi"), massDPi);
+
+      // compute impact parameters of D and Pi
+      o2::dataformats::DCA dcaD;
+      o2::dataformats::DCA dcaPion;
+      trackParCovD.propagateToDCA(primaryVertex, bz, &dcaD);
+      trackParCovPi.propagateToDCA(primaryVertex, bz, &dcaPion);
+
+      // get uncertainty of the decay length
+      double phi, theta;
+      // getPointDirection modifies phi and theta
+      getPointDirection(array{collision.posX(), collision.posY(), collision.posZ()}, secondaryVertexB0, phi, theta);
+      auto errorDecayLength = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, theta) + getRotatedCovMatrixXX(covMatrixPCA, phi, theta));
+      auto errorDecayLengthXY = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, 0.) + getRotatedCovMatrixXX(covMatrixPCA, phi, 0.));
+
+      int hfFlag = BIT(hf_cand_b0::DecayType::B0ToDPi);
+
+      // fill the candidate table for the B0 here:
+      rowCandidateBase(thisCollId,
+                       collision.posX(), collision.posY(), collision.posZ(),
+                       secondaryVertexB0[0], secondaryVertexB0[1], secondaryVertexB0[2],
+                       errorDecayLength, errorDecayLengthXY,
+                       chi2PCA,
+                       pVecD[0], pVecD[1], pVecD[2],
+                       pVecPion[0], pVecPion[1], pVecPion[2],
+                       dcaD.getY(), dcaPion.getY(),
+                       std::sqrt(dcaD.getSigmaY2()), std::sqrt(dcaPion.getSigmaY2()),
+                       candD.globalIndex(), pion.globalIndex,
+                       hfFlag);
+    } // pi loop
   }
 
-  void process(aod::HfReducedCollisions const& collisions,
-               aod::HfCand3ProngReduced const& candsD,
-               aod::HfTracksReduced const& tracksPion,
-               aod::HfOriginalCollisionsCounter const& collisionsCounter)
+  void processData(aod::HfReducedCollisions const& collisions,
+                   aod::HfCand3ProngReduced const& candsD,
+                   aod::HfTracksReduced const& tracksPion,
+                   aod::HfOriginalCollisionsCounter const& collisionsCounter)
   {
     for (const auto& collisionCounter : collisionsCounter) {
       registry.fill(HIST("hEvents"), 1, collisionCounter.originalCollisionCount());
@@ -91,8 +187,6 @@ struct HfCandidateCreatorB0Reduced {
 
     for (const auto& collision : collisions) {
       auto thisCollId = collision.globalIndex();
-      auto primaryVertex = getPrimaryVertex(collision);
-      auto covMatrixPV = primaryVertex.getCov();
 
       if (ncol % 10000 == 0) {
         LOG(debug) << ncol << " collisions parsed";
@@ -103,76 +197,46 @@ struct HfCandidateCreatorB0Reduced {
       bz = collision.bz();
       df2.setBz(bz);
 
+      pionsThisCollision.clear();
+      auto tracksPionThisCollision = tracksPion.sliceBy(tracksPionPerCollision, thisCollId);
+      for (const auto& trackPion : tracksPionThisCollision) {
+        addPion(trackPion);
+      }
+
       auto candsDThisColl = candsD.sliceBy(candsDPerCollision, thisCollId);
       for (const auto& candD : candsDThisColl) {
-        auto trackParCovD = getTrackParCov(candD);
-        std::array<float, 3> pVecD = {candD.px(), candD.py(), candD.pz()};
-
-        auto tracksPionThisCollision = tracksPion.sliceBy(tracksPionPerCollision, thisCollId);
-        for (const auto& trackPion : tracksPionThisCollision) {
-          auto trackParCovPi = getTrackParCov(trackPion);
-          std::array<float, 3> pVecPion = {trackPion.px(), trackPion.py(), trackPion.pz()};
-
-          // ---------------------------------
-          // reconstruct the 2-prong B0 vertex
-          if (df2.process(trackParCovD, trackParCovPi) == 0) {
-            continue;
-          }
-          // DPi passed B0 reconstruction
-
-          // calculate relevant properties
-          const auto& secondaryVertexB0 = df2.getPCACandidate();
-          auto chi2PCA = df2.getChi2AtPCACandidate();
-          auto covMatrixPCA = df2.calcPCACovMatrixFlat();
-          registry.fill(HIST("hCovSVXX"), covMatrixPCA[0]);
-          registry.fill(HIST("hCovPVXX"), covMatrixPV[0]);
-
-          // propagate D and Pi to the B0 vertex
-          df2.propagateTracksToVertex();
-          // track.getPxPyPzGlo(pVec) modifies pVec of track
-          df2.getTrack(0).getPxPyPzGlo(pVecD);    // momentum of D at the B0 vertex
-          df2.getTrack(1).getPxPyPzGlo(pVecPion); // momentum of Pi at the B0 vertex
-
-          // compute invariant
-          massDPi = RecoDecay::m(array{pVecD, pVecPion}, array{massD, massPi});
-
-          if (std::abs(massDPi - massB0) > invMassWindowB0) {
-            continue;
-          }
-          registry.fill(HIST("hMassB0ToDPi"), massDPi);
-
-          // compute impact parameters of D and Pi
-          o2::dataformats::DCA dcaD;
-          o2::dataformats::DCA dcaPion;
-          trackParCovD.propagateToDCA(primaryVertex, bz, &dcaD);
-          trackParCovPi.propagateToDCA(primaryVertex, bz, &dcaPion);
-
-          // get uncertainty of the decay length
-          double phi, theta;
-          // getPointDirection modifies phi and theta
-          getPointDirection(array{collision.posX(), collision.posY(), collision.posZ()}, secondaryVertexB0, phi, theta);
-          auto errorDecayLength = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, theta) + getRotatedCovMatrixXX(covMatrixPCA, phi, theta));
-          auto errorDecayLengthXY = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, 0.) + getRotatedCovMatrixXX(covMatrixPCA, phi, 0.));
-
-          int hfFlag = BIT(hf_cand_b0::DecayType::B0ToDPi);
-
-          // fill the candidate table for the B0 here:
-          rowCandidateBase(thisCollId,
-                           collision.posX(), collision.posY(), collision.posZ(),
-                           secondaryVertexB0[0], secondaryVertexB0[1], secondaryVertexB0[2],
-                           errorDecayLength, errorDecayLengthXY,
-                           chi2PCA,
-                           pVecD[0], pVecD[1], pVecD[2],
-                           pVecPion[0], pVecPion[1], pVecPion[2],
-                           dcaD.getY(), dcaPion.getY(),
-                           std::sqrt(dcaD.getSigmaY2()), std::sqrt(dcaPion.getSigmaY2()),
-                           candD.globalIndex(), trackPion.globalIndex(),
-                           hfFlag);
-        } // pi loop
-      }   // D loop
-    }     // collision loop
-  }       // process
-};        // struct
+        reconstructB0(collision, candD);
+      } // D loop
+    }   // collision loop
+  }     // processData
+  PROCESS_SWITCH(HfCandidateCreatorB0Reduced, processData, "Process the full reduced tables", true);
+
+  void processCompact(aod::HfReducedCollisionsCompact const& collisions,
+                      aod::HfCand3ProngReducedCompact const& candsD,
+                      aod::HfTracksReducedCompact const& tracksPion,
+                      aod::HfOriginalCollisionsCounter const& collisionsCounter)
+  {
+    for (const auto& collisionCounter : collisionsCounter) {
+      registry.fill(HIST("hEvents"), 1, collisionCounter.originalCollisionCount());
+    }
+
+    for (const auto& collision : collisions) {
+      // Set the magnetic field from ccdb
+      bz = collision.bz();
+      df2.setBz(bz);
+
+      // the pions and the D candidates of the collision are contiguous rows
+      pionsThisCollision.clear();
+      for (int iPion = collision.trackOffset(); iPion < collision.trackOffset() + collision.nTracks(); ++iPion) {
+        addPion(tracksPion.rawIteratorAt(iPion));
+      }
+      for (int iCandD = collision.cand3ProngOffset(); iCandD < collision.cand3ProngOffset() + collision.nCands3Prong(); ++iCandD) {
+        reconstructB0(collision, candsD.rawIteratorAt(iCandD));
+      }
+    }
+  }
+  PROCESS_SWITCH(HfCandidateCreatorB0Reduced, processCompact, "Process the compact reduced tables", false);
+}; // struct
 
 /// Extends the table base with expression columns and performs MC matching.
 struct HfCandidateCreatorB0ReducedExpressions {
@@ -90,9 +90,10 @@ struct HfCandidateSelectorB0ToDPiReduced {
     }
   }
 
-  void process(HfCandB0 const& hfCandsB0,
-               HfTracksPidReduced const&,
-               HfCandB0Config const& configs)
+  /// \tparam TTracksPid is the table of the PID information of the pions, full or compact
+  template <typename TTracksPid>
+  void runSelection(HfCandB0 const& hfCandsB0,
+                    HfCandB0Config const& configs)
   {
     // get DplusPi creator configurable
     for (const auto& config : configs) {
@@ -144,7 +145,7 @@ struct HfCandidateSelectorB0ToDPiReduced {
       }
       // track-level PID selection
       if (usePid) {
-        auto trackPi = hfCandB0.prong1_as<HfTracksPidReduced>();
+        auto trackPi = hfCandB0.template prong1_as<TTracksPid>();
         int pidTrackPi = selectorPion.getStatusTrackPIDTpcAndTof(trackPi);
         if (!hf_sel_candidate_b0::selectionPID(pidTrackPi, acceptPIDNotApplicable.value)) {
           // LOGF(info, "B0 candidate selection failed at PID selection");
@@ -160,6 +161,22 @@ struct HfCandidateSelectorB0ToDPiReduced {
       // LOGF(info, "B0 candidate selection passed all selections");
     }
   }
+
+  void processData(HfCandB0 const& hfCandsB0,
+                   HfTracksPidReduced const&,
+                   HfCandB0Config const& configs)
+  {
+    runSelection<HfTracksPidReduced>(hfCandsB0, configs);
+  }
+  PROCESS_SWITCH(HfCandidateSelectorB0ToDPiReduced, processData, "Select the B0 candidates with the full reduced tables", true);
+
+  void processCompact(HfCandB0 const& hfCandsB0,
+                      HfTracksPidReducedCompact const&,
+                      HfCandB0Config const& configs)
+  {
+    runSelection<HfTracksPidReducedCompact>(hfCandsB0, configs);
+  }
+  PROCESS_SWITCH(HfCandidateSelectorB0ToDPiReduced, processCompact, "Select the B0 candidates with the compact reduced tables", false);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
@@ -20,6 +20,7 @@
 #include "ReconstructionDataFormats/DCA.h"
 #include "ReconstructionDataFormats/V0.h"
 
+#include "Common/Core/PropagatorServices.h"
 #include "Common/Core/trackUtilities.h"
 #include "Common/DataModel/CollisionAssociationTables.h"
 
@@ -50,6 +51,11 @@ struct HfDataCreatorDplusPiReduced {
   Produces<aod::HfTracksPidReduced> hfTrackPidPion;
   Produces<aod::HfCand3ProngReduced> hfCand3Prong;
   Produces<aod::HfCandB0Config> rowCandidateConfig;
+  // compact variants of the tables
+  Produces<aod::HfReducedCollisionsCompact> hfReducedCollisionCompact;
+  Produces<aod::HfTracksReducedCompact> hfTrackPionCompact;
+  Produces<aod::HfTracksPidReducedCompact> hfTrackPidPionCompact;
+  Produces<aod::HfCand3ProngReducedCompact> hfCand3ProngCompact;
 
   // vertexing
   // Configurable<double> bz{"bz", 5., "magnetic field"};
@@ -67,6 +73,8 @@ struct HfDataCreatorDplusPiReduced {
   Configurable<LabeledArray<double>> cutsTrackPionDCA{"cutsTrackPionDCA", {hf_cuts_single_track::cutsTrack[0], hf_cuts_single_track::nBinsPtTrack, hf_cuts_single_track::nCutVarsTrack, hf_cuts_single_track::labelsPtTrack, hf_cuts_single_track::labelsCutVarTrack}, "Single-track selections per pT bin for pions"};
   Configurable<double> invMassWindowB0{"invMassWindowB0", 0.3, "invariant-mass window for B0 candidates"};
   Configurable<int> selectionFlagD{"selectionFlagD", 1, "Selection Flag for D"};
+  // output
+  Configurable<bool> storeCompactTables{"storeCompactTables", false, "Store the compact reduced tables instead of the full ones (no MC matching)"};
 
   // magnetic field setting from CCDB
   Configurable<bool> isRun2{"isRun2", false, "enable Run 2 or Run 3 GRP objects for magnetic field"};
@@ -94,16 +102,30 @@ struct HfDataCreatorDplusPiReduced {
 
   using TracksPIDWithSel = soa::Join<aod::BigTracksPIDExtended, aod::TrackSelection>;
   using CandsDFiltered = soa::Filtered<soa::Join<aod::HfCand3Prong, aod::HfSelDplusToPiKPi>>;
+  using CandsDWithParCovFiltered = soa::Filtered<soa::Join<aod::HfCand3Prong, aod::HfCand3ProngParCov, aod::HfSelDplusToPiKPi>>;
 
   Filter filterSelectCandidates = (aod::hf_sel_candidate_dplus::isSelDplusToPiKPi >= selectionFlagD);
 
   Preslice<CandsDFiltered> candsDPerCollision = aod::track_association::collisionId;
+  Preslice<CandsDWithParCovFiltered> candsDWithParCovPerCollision = aod::track_association::collisionId;
   Preslice<aod::TrackAssoc> trackIndicesPerCollision = aod::track_association::collisionId;
 
+  /// Bachelor pion of a collision, passing the selections that do not depend on the D candidate
+  struct PionCandidate {
+    TracksPIDWithSel::iterator track;
+    std::array<float, 3> pVec;
+    bool isStored; // already filled in the pion tables of the reduced collision
+  };
+  std::array<std::vector<PionCandidate>, 2> pionsThisCollision; // negative and positive pions of the current collision
+
   HistogramRegistry registry{"registry"};
 
   void init(InitContext const&)
   {
+    if (doprocessRefitD && doprocessStoredD) {
+      LOGP(fatal, "Only one process function between processRefitD and processStoredD can be enabled at a time.");
+    }
+
     // histograms
     constexpr int kNBinsEvents = kNEvent;
     std::string labels[kNBinsEvents];
@@ -134,18 +156,15 @@ struct HfDataCreatorDplusPiReduced {
     ccdb->setURL(ccdbUrl);
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
-    lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(ccdbPathLut));
+    lut = o2::common::propagator::getMatLut(ccdb, ccdbPathLut);
     runNumber = 0;
   }
 
-  /// Pion selection (D Pi <-- B0)
+  /// Pion selection (D Pi <-- B0), for the cuts that do not depend on the D candidate
   /// \param trackPion is a track with the pion hypothesis
-  /// \param track0 is prong0 of selected D candidate
-  /// \param track1 is prong1 of selected D candidate
-  /// \param track2 is prong2 of selected D candidate
   /// \return true if trackPion passes all cuts
-  template <typename T1, typename T2>
-  bool isPionSelected(const T1& trackPion, const T2& track0, const T2& track1, const T2& track2)
+  template <typename T1>
+  bool isPionPreselected(const T1& trackPion)
   {
     // check isGlobalTrackWoDCA status for pions if wanted
     if (usePionIsGlobalTrackWoDCA && !trackPion.isGlobalTrackWoDCA()) {
@@ -155,14 +174,6 @@ struct HfDataCreatorDplusPiReduced {
     if (trackPion.pt() < ptPionMin || !isSelectedTrackDCA(trackPion)) {
       return false;
     }
-    // reject pions that are D daughters
-    if (trackPion.globalIndex() == track0.globalIndex() || trackPion.globalIndex() == track1.globalIndex() || trackPion.globalIndex() == track2.globalIndex()) {
-      return false;
-    }
-    // reject pi D with same sign as D
-    if (trackPion.sign() * track0.sign() > 0) {
-      return false;
-    }
     return true;
   }
 
@@ -186,11 +197,13 @@ struct HfDataCreatorDplusPiReduced {
     return true;
   }
 
-  void process(aod::Collisions const& collisions,
-               CandsDFiltered const& candsD,
-               aod::TrackAssoc const& trackIndices,
-               TracksPIDWithSel const&,
-               aod::BCsWithTimestamps const&)
+  /// Pairs the selected D candidates of each collision with the bachelor pions of opposite sign
+  /// \tparam useStoredParCov use the D parametrisation at the secondary vertex stored by the candidate creator instead of refitting the D vertex
+  template <bool useStoredParCov, typename TCands, typename TPreslice>
+  void runDataCreation(aod::Collisions const& collisions,
+                       TCands const& candsD,
+                       TPreslice const& candsDPerColl,
+                       aod::TrackAssoc const& trackIndices)
   {
     // store configurables needed for B0 workflow
     if (!isHfCandB0ConfigFilled) {
@@ -210,8 +223,9 @@ struct HfDataCreatorDplusPiReduced {
 
       // helpers for ReducedTables filling
       int hfReducedCollisionIndex = hfReducedCollision.lastIndex() + 1;
-      std::vector<int64_t> selectedTracksPion;
-      selectedTracksPion.reserve(trackIndices.size());
+      // the pions and the D candidates of a collision are contiguous in the compact tables
+      int trackOffset = hfTrackPionCompact.lastIndex() + 1;
+      int cand3ProngOffset = hfCand3ProngCompact.lastIndex() + 1;
       bool fillHfReducedCollision = false;
 
       auto primaryVertex = getPrimaryVertex(collision);
@@ -232,90 +246,143 @@ struct HfDataCreatorDplusPiReduced {
       df3.setBz(bz);
 
       auto thisCollId = collision.globalIndex();
-      auto candsDThisColl = candsD.sliceBy(candsDPerCollision, thisCollId);
+      auto candsDThisColl = candsD.sliceBy(candsDPerColl, thisCollId);
+      if (candsDThisColl.size() == 0) {
+        registry.fill(HIST("hEvents"), 1 + Event::Processed);
+        registry.fill(HIST("hEvents"), 1 + Event::NoDPiSelected);
+        continue;
+      }
+
+      // bachelor pions of the collision, split by charge, once for all the D candidates
+      for (auto& pions : pionsThisCollision) {
+        pions.clear();
+      }
+      auto trackIdsThisCollision = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
+      for (const auto& trackId : trackIdsThisCollision) {
+        auto trackPion = trackId.track_as<TracksPIDWithSel>();
+        if (!isPionPreselected(trackPion)) {
+          continue;
+        }
+        pionsThisCollision[trackPion.sign() > 0 ? 1 : 0].push_back({trackPion, {trackPion.px(), trackPion.py(), trackPion.pz()}, false});
+      }
+
       for (const auto& candD : candsDThisColl) {
         bool fillHfCand3Prong = false;
-        float invMassD;
 
         registry.fill(HIST("hMassDToPiKPi"), invMassDplusToPiKPi(candD));
         registry.fill(HIST("hPtD"), candD.pt());
         registry.fill(HIST("hCPAD"), candD.cpa());
 
         // track0 <-> pi, track1 <-> K, track2 <-> pi
-        auto track0 = candD.prong0_as<TracksPIDWithSel>();
-        auto track1 = candD.prong1_as<TracksPIDWithSel>();
-        auto track2 = candD.prong2_as<TracksPIDWithSel>();
-        auto trackParCov0 = getTrackParCov(track0);
-        auto trackParCov1 = getTrackParCov(track1);
-        auto trackParCov2 = getTrackParCov(track2);
-
-        std::array<float, 3> pVec0 = {track0.px(), track0.py(), track0.pz()};
-        std::array<float, 3> pVec1 = {track1.px(), track1.py(), track1.pz()};
-        std::array<float, 3> pVec2 = {track2.px(), track2.py(), track2.pz()};
-
-        auto dca0 = o2::dataformats::DCA(track0.dcaXY(), track0.dcaZ(), track0.cYY(), track0.cZY(), track0.cZZ());
-        auto dca1 = o2::dataformats::DCA(track1.dcaXY(), track1.dcaZ(), track1.cYY(), track1.cZY(), track1.cZZ());
-        auto dca2 = o2::dataformats::DCA(track2.dcaXY(), track2.dcaZ(), track2.cYY(), track2.cZY(), track2.cZZ());
-
-        // repropagate tracks to this collision if needed
-        if (track0.collisionId() != thisCollId) {
-          trackParCov0.propagateToDCA(primaryVertex, bz, &dca0);
-        }
-
-        if (track1.collisionId() != thisCollId) {
-          trackParCov1.propagateToDCA(primaryVertex, bz, &dca1);
-        }
-
-        if (track2.collisionId() != thisCollId) {
-          trackParCov2.propagateToDCA(primaryVertex, bz, &dca2);
-        }
+        auto track0 = candD.template prong0_as<TracksPIDWithSel>();
+        std::array<float, 3> pVec0;
+        std::array<float, 3> pVec1;
+        std::array<float, 3> pVec2;
+        o2::track::TrackParCov trackParCovD;
+
+        if constexpr (useStoredParCov) {
+          pVec0 = {candD.pxProng0(), candD.pyProng0(), candD.pzProng0()};
+          pVec1 = {candD.pxProng1(), candD.pyProng1(), candD.pzProng1()};
+          pVec2 = {candD.pxProng2(), candD.pyProng2(), candD.pzProng2()};
+          trackParCovD = o2::track::TrackParCov(candD.parX(), candD.parAlpha(),
+                                                {candD.parY(), candD.parZ(), candD.parSnp(), candD.parTgl(), candD.parQ2Pt()},
+                                                {candD.covY2(), candD.covZY(), candD.covZ2(),
+                                                 candD.covSnpY(), candD.covSnpZ(), candD.covSnp2(),
+                                                 candD.covTglY(), candD.covTglZ(), candD.covTglSnp(), candD.covTgl2(),
+                                                 candD.cov1PtY(), candD.cov1PtZ(), candD.cov1PtSnp(), candD.cov1PtTgl(), candD.cov1Pt2()});
+        } else {
+          auto track1 = candD.template prong1_as<TracksPIDWithSel>();
+          auto track2 = candD.template prong2_as<TracksPIDWithSel>();
+          auto trackParCov0 = getTrackParCov(track0);
+          auto trackParCov1 = getTrackParCov(track1);
+          auto trackParCov2 = getTrackParCov(track2);
+
+          auto dca0 = o2::dataformats::DCA(track0.dcaXY(), track0.dcaZ(), track0.cYY(), track0.cZY(), track0.cZZ());
+          auto dca1 = o2::dataformats::DCA(track1.dcaXY(), track1.dcaZ(), track1.cYY(), track1.cZY(), track1.cZZ());
+          auto dca2 = o2::dataformats::DCA(track2.dcaXY(), track2.dcaZ(), track2.cYY(), track2.cZY(), track2.cZZ());
+
+          // repropagate tracks to this collision if needed
+          if (track0.collisionId() != thisCollId) {
+            trackParCov0.propagateToDCA(primaryVertex, bz, &dca0);
+          }
 
-        // ---------------------------------
-        // reconstruct 3-prong secondary vertex (D±)
-        if (df3.process(trackParCov0, trackParCov1, trackParCov2) == 0) {
-          continue;
-        }
+          if (track1.collisionId() != thisCollId) {
+            trackParCov1.propagateToDCA(primaryVertex, bz, &dca1);
+          }
 
-        const auto& secondaryVertexD = df3.getPCACandidate();
-        // propagate the 3 prongs to the secondary vertex
-        trackParCov0.propagateTo(secondaryVertexD[0], bz);
-        trackParCov1.propagateTo(secondaryVertexD[0], bz);
-        trackParCov2.propagateTo(secondaryVertexD[0], bz);
+          if (track2.collisionId() != thisCollId) {
+            trackParCov2.propagateToDCA(primaryVertex, bz, &dca2);
+          }
 
-        // update pVec of tracks
-        df3.getTrack(0).getPxPyPzGlo(pVec0);
-        df3.getTrack(1).getPxPyPzGlo(pVec1);
-        df3.getTrack(2).getPxPyPzGlo(pVec2);
+          // ---------------------------------
+          // reconstruct 3-prong secondary vertex (D±)
+          if (df3.process(trackParCov0, trackParCov1, trackParCov2) == 0) {
+            continue;
+          }
 
-        // D∓ → π∓ K± π∓
-        std::array<float, 3> pVecPiK = RecoDecay::pVec(pVec0, pVec1);
+          const auto& secondaryVertexD = df3.getPCACandidate();
+          // propagate the 3 prongs to the secondary vertex
+          trackParCov0.propagateTo(secondaryVertexD[0], bz);
+          trackParCov1.propagateTo(secondaryVertexD[0], bz);
+          trackParCov2.propagateTo(secondaryVertexD[0], bz);
+
+          // update pVec of tracks
+          df3.getTrack(0).getPxPyPzGlo(pVec0);
+          df3.getTrack(1).getPxPyPzGlo(pVec1);
+          df3.getTrack(2).getPxPyPzGlo(pVec2);
+
+          // D∓ → π∓ K± π∓
+          std::array<float, 3> pVecPiK = RecoDecay::pVec(pVec0, pVec1);
+          auto trackParCovPiK = o2::dataformats::V0(df3.getPCACandidatePos(), pVecPiK, df3.calcPCACovMatrixFlat(),
+                                                    trackParCov0, trackParCov1, {0, 0}, {0, 0});
+          trackParCovD = o2::dataformats::V0(df3.getPCACandidatePos(), RecoDecay::pVec(pVec0, pVec1, pVec2), df3.calcPCACovMatrixFlat(),
+                                             trackParCovPiK, trackParCov2, {0, 0}, {0, 0});
+        }
         std::array<float, 3> pVecD = RecoDecay::pVec(pVec0, pVec1, pVec2);
-        auto trackParCovPiK = o2::dataformats::V0(df3.getPCACandidatePos(), pVecPiK, df3.calcPCACovMatrixFlat(),
-                                                  trackParCov0, trackParCov1, {0, 0}, {0, 0});
-        auto trackParCovD = o2::dataformats::V0(df3.getPCACandidatePos(), pVecD, df3.calcPCACovMatrixFlat(),
-                                                trackParCovPiK, trackParCov2, {0, 0}, {0, 0});
-
-        auto trackIdsThisCollision = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
-        for (const auto& trackId : trackIdsThisCollision) {
-          auto trackPion = trackId.track_as<TracksPIDWithSel>();
+        invMassD = hf_cand_3prong_reduced::invMassDplusToPiKPi(pVec0, pVec1, pVec2);
 
-          // apply selections on pion tracks
-          if (!isPionSelected(trackPion, track0, track1, track2) || !isSelectedTrackDCA(trackPion)) {
+        // pions of opposite sign to the D, which are not D daughters
+        for (auto& pion : pionsThisCollision[track0.sign() > 0 ? 0 : 1]) {
+          const auto& trackPion = pion.track;
+          if (trackPion.globalIndex() == candD.prong0Id() || trackPion.globalIndex() == candD.prong1Id() || trackPion.globalIndex() == candD.prong2Id()) {
             continue;
           }
           registry.fill(HIST("hPtPion"), trackPion.pt());
-          std::array<float, 3> pVecPion = {trackPion.px(), trackPion.py(), trackPion.pz()};
           // compute invariant mass and apply selection
-          massDPi = RecoDecay::m(std::array{pVecD, pVecPion}, std::array{massD, massPi});
+          massDPi = RecoDecay::m(std::array{pVecD, pion.pVec}, std::array{massD, massPi});
           if (std::abs(massDPi - massB0) > invMassWindowB0) {
             continue;
           }
 
-          invMassD = hf_cand_3prong_reduced::invMassDplusToPiKPi(pVec0, pVec1, pVec2);
-
           // fill Pion tracks table
           // if information on track already stored, go to next track
-          if (!std::count(selectedTracksPion.begin(), selectedTracksPion.end(), trackPion.globalIndex())) {
+          if (!pion.isStored && storeCompactTables) {
+            uint8_t pidFlags = 0;
+            if (trackPion.hasTPC()) {
+              pidFlags |= hf_track_pid_reduced_compact::PidFlags::TpcMatch;
+            }
+            if (trackPion.hasTOF()) {
+              pidFlags |= hf_track_pid_reduced_compact::PidFlags::TofMatch;
+            }
+            using hf_track_pid_reduced_compact::packNSigma;
+            // the covariance matrix of the track is already stored packed in the AO2D
+            hfTrackPionCompact(trackPion.globalIndex(),
+                               trackPion.x(), trackPion.alpha(),
+                               trackPion.y(), trackPion.z(), trackPion.snp(),
+                               trackPion.tgl(), trackPion.signed1Pt(),
+                               trackPion.sigmaY(), trackPion.sigmaZ(), trackPion.sigmaSnp(), trackPion.sigmaTgl(), trackPion.sigma1Pt(),
+                               trackPion.rhoZY(), trackPion.rhoSnpY(), trackPion.rhoSnpZ(),
+                               trackPion.rhoTglY(), trackPion.rhoTglZ(), trackPion.rhoTglSnp(),
+                               trackPion.rho1PtY(), trackPion.rho1PtZ(), trackPion.rho1PtSnp(), trackPion.rho1PtTgl());
+            hfTrackPidPionCompact(trackPion.pt(), pidFlags,
+                                  packNSigma<pidtpc_tiny::binning>(trackPion.tpcNSigmaEl()), packNSigma<pidtpc_tiny::binning>(trackPion.tpcNSigmaMu()),
+                                  packNSigma<pidtpc_tiny::binning>(trackPion.tpcNSigmaPi()), packNSigma<pidtpc_tiny::binning>(trackPion.tpcNSigmaKa()),
+                                  packNSigma<pidtpc_tiny::binning>(trackPion.tpcNSigmaPr()),
+                                  packNSigma<pidtof_tiny::binning>(trackPion.tofNSigmaEl()), packNSigma<pidtof_tiny::binning>(trackPion.tofNSigmaMu()),
+                                  packNSigma<pidtof_tiny::binning>(trackPion.tofNSigmaPi()), packNSigma<pidtof_tiny::binning>(trackPion.tofNSigmaKa()),
+                                  packNSigma<pidtof_tiny::binning>(trackPion.tofNSigmaPr()));
+            pion.isStored = true;
+          } else if (!pion.isStored) {
             hfTrackPion(trackPion.globalIndex(), hfReducedCollisionIndex,
                         trackPion.x(), trackPion.alpha(),
                         trackPion.y(), trackPion.z(), trackPion.snp(),
@@ -332,14 +399,26 @@ struct HfDataCreatorDplusPiReduced {
                            trackPion.hasTPC(), trackPion.hasTOF(),
                            trackPion.tpcNSigmaEl(), trackPion.tpcNSigmaMu(), trackPion.tpcNSigmaPi(), trackPion.tpcNSigmaKa(), trackPion.tpcNSigmaPr(),
                            trackPion.tofNSigmaEl(), trackPion.tofNSigmaMu(), trackPion.tofNSigmaPi(), trackPion.tofNSigmaKa(), trackPion.tofNSigmaPr());
-            // add trackPion.globalIndex() to a list
-            // to keep memory of the pions filled in the table and avoid refilling them if they are paired to another D candidate
-            selectedTracksPion.emplace_back(trackPion.globalIndex());
+            // keep memory of the pions filled in the table, to avoid refilling them if they are paired to another D candidate
+            pion.isStored = true;
           }
           fillHfCand3Prong = true;
-        }                       // pion loop
-        if (fillHfCand3Prong) { // fill candDplus table only once per D candidate
-          hfCand3Prong(track0.globalIndex(), track1.globalIndex(), track2.globalIndex(),
+        } // pion loop
+        if (fillHfCand3Prong && storeCompactTables) { // fill candDplus table only once per D candidate
+          auto covD = hf_track_par_cov_compact::packCovariance(trackParCovD.getCov());
+          hfCand3ProngCompact(candD.prong0Id(), candD.prong1Id(), candD.prong2Id(),
+                              trackParCovD.getX(), trackParCovD.getAlpha(),
+                              trackParCovD.getY(), trackParCovD.getZ(), trackParCovD.getSnp(),
+                              trackParCovD.getTgl(), trackParCovD.getQ2Pt(),
+                              covD.sigma[0], covD.sigma[1], covD.sigma[2], covD.sigma[3], covD.sigma[4],
+                              covD.rho[0], covD.rho[1], covD.rho[2], covD.rho[3], covD.rho[4],
+                              covD.rho[5], covD.rho[6], covD.rho[7], covD.rho[8], covD.rho[9],
+                              candD.cpa(),
+                              candD.decayLength(),
+                              invMassD);
+          fillHfReducedCollision = true;
+        } else if (fillHfCand3Prong) {
+          hfCand3Prong(candD.prong0Id(), candD.prong1Id(), candD.prong2Id(),
                        hfReducedCollisionIndex,
                        trackParCovD.getX(), trackParCovD.getAlpha(),
                        trackParCovD.getY(), trackParCovD.getZ(), trackParCovD.getSnp(),
@@ -364,13 +443,42 @@ struct HfDataCreatorDplusPiReduced {
       }
       registry.fill(HIST("hEvents"), 1 + Event::DPiSelected);
       // fill collision table if it contains a DPi pair a minima
+      if (storeCompactTables) {
+        hfReducedCollisionCompact(collision.posX(), collision.posY(), collision.posZ(),
+                                  collision.covXX(), collision.covXY(), collision.covYY(),
+                                  collision.covXZ(), collision.covYZ(), collision.covZZ(),
+                                  bz,
+                                  trackOffset, hfTrackPionCompact.lastIndex() + 1 - trackOffset,
+                                  cand3ProngOffset, hfCand3ProngCompact.lastIndex() + 1 - cand3ProngOffset);
+        continue;
+      }
       hfReducedCollision(collision.posX(), collision.posY(), collision.posZ(),
                          collision.covXX(), collision.covXY(), collision.covYY(),
                          collision.covXZ(), collision.covYZ(), collision.covZZ(),
                          bz);
     } // collision
-  }   // process
-};    // struct
+  }
+
+  void processRefitD(aod::Collisions const& collisions,
+                     CandsDFiltered const& candsD,
+                     aod::TrackAssoc const& trackIndices,
+                     TracksPIDWithSel const&,
+                     aod::BCsWithTimestamps const&)
+  {
+    runDataCreation<false>(collisions, candsD, candsDPerCollision, trackIndices);
+  }
+  PROCESS_SWITCH(HfDataCreatorDplusPiReduced, processRefitD, "Refit the D vertices", true);
+
+  void processStoredD(aod::Collisions const& collisions,
+                      CandsDWithParCovFiltered const& candsD,
+                      aod::TrackAssoc const& trackIndices,
+                      TracksPIDWithSel const&,
+                      aod::BCsWithTimestamps const&)
+  {
+    runDataCreation<true>(collisions, candsD, candsDWithParCovPerCollision, trackIndices);
+  }
+  PROCESS_SWITCH(HfDataCreatorDplusPiReduced, processStoredD, "Use the D parametrisations stored by the candidate creator (fillParCov)", false);
+};
 
 /// Performs MC matching.
 struct HfDataCreatorDplusPiReducedMc {
@@ -126,8 +126,9 @@ struct HfTaskB0Reduced {
     return std::abs(etaProng) <= etaTrackMax && ptProng >= ptTrackMin;
   }
 
-  void process(soa::Filtered<soa::Join<aod::HfCandB0, aod::HfSelB0ToDPi>> const& candidates,
-               aod::HfCand3ProngReduced const&)
+  /// \tparam TCands3Prong is the table of the D candidates, full or compact
+  template <typename TCands3Prong>
+  void analyse(soa::Filtered<soa::Join<aod::HfCandB0, aod::HfSelB0ToDPi>> const& candidates)
   {
     for (auto const& candidate : candidates) {
       if (!TESTBIT(candidate.hfflag(), hf_cand_b0::DecayType::B0ToDPi)) {
@@ -138,7 +139,7 @@ struct HfTaskB0Reduced {
       }
 
       auto ptCandB0 = candidate.pt();
-      auto candD = candidate.prong0_as<aod::HfCand3ProngReduced>();
+      auto candD = candidate.template prong0_as<TCands3Prong>();
 
       registry.fill(HIST("hMass"), invMassB0ToDPi(candidate), ptCandB0);
       registry.fill(HIST("hPtCand"), ptCandB0);
@@ -158,7 +159,21 @@ struct HfTaskB0Reduced {
       registry.fill(HIST("hDecLenXYErr"), candidate.errorDecayLengthXY(), ptCandB0);
       registry.fill(HIST("hInvMassD"), candD.invMass(), ptCandB0);
     } // candidate loop
-  }   // process
+  }   // analyse
+
+  void processData(soa::Filtered<soa::Join<aod::HfCandB0, aod::HfSelB0ToDPi>> const& candidates,
+                   aod::HfCand3ProngReduced const&)
+  {
+    analyse<aod::HfCand3ProngReduced>(candidates);
+  }
+  PROCESS_SWITCH(HfTaskB0Reduced, processData, "Process the full reduced tables", true);
+
+  void processCompact(soa::Filtered<soa::Join<aod::HfCandB0, aod::HfSelB0ToDPi>> const& candidates,
+                      aod::HfCand3ProngReducedCompact const&)
+  {
+    analyse<aod::HfCand3ProngReducedCompact>(candidates);
+  }
+  PROCESS_SWITCH(HfTaskB0Reduced, processCompact, "Process the compact reduced tables", false);
 
   /// B0 MC analysis and fill histograms
   void processMc(soa::Join<aod::HfCandB0, aod::HfB0McRecReduced> const& candidates,
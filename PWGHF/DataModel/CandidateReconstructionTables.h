@@ -52,6 +52,14 @@ DECLARE_SOA_COLUMN(IsSelProng, isSelProng, int); //!
 DECLARE_SOA_TABLE(HfSelTrack, "AOD", "HFSELTRACK", //!
                   hf_sel_track::IsSelProng);
 
+namespace hf_pid_status_track
+{
+DECLARE_SOA_COLUMN(PidStatus, pidStatus, uint64_t); //! packed PID statuses of all species and detectors (see TrackSelectorPID::getPackedStatus)
+} // namespace hf_pid_status_track
+
+DECLARE_SOA_TABLE(HfPidStatusTrack, "AOD", "HFPIDSTATUSTRK", //!
+                  hf_pid_status_track::PidStatus);
+
 namespace hf_pv_refit_track
 {
 DECLARE_SOA_COLUMN(PvRefitX, pvRefitX, float);             //!
@@ -1009,6 +1017,42 @@ DECLARE_SOA_EXTENDED_TABLE_USER(HfCand3ProngExt, HfCand3ProngBase, "HFCAND3PEXT"
 
 using HfCand3Prong = HfCand3ProngExt;
 
+namespace hf_cand_par_cov
+{
+DECLARE_SOA_COLUMN(ParX, parX, float);           //! X of the track parametrisation
+DECLARE_SOA_COLUMN(ParAlpha, parAlpha, float);   //! alpha of the track parametrisation
+DECLARE_SOA_COLUMN(ParY, parY, float);           //! local Y
+DECLARE_SOA_COLUMN(ParZ, parZ, float);           //! local Z
+DECLARE_SOA_COLUMN(ParSnp, parSnp, float);       //! sine of the local phi
+DECLARE_SOA_COLUMN(ParTgl, parTgl, float);       //! tangent of the dip angle
+DECLARE_SOA_COLUMN(ParQ2Pt, parQ2Pt, float);     //! charge over pT
+DECLARE_SOA_COLUMN(CovY2, covY2, float);         //! element of the covariance matrix
+DECLARE_SOA_COLUMN(CovZY, covZY, float);         //! element of the covariance matrix
+DECLARE_SOA_COLUMN(CovZ2, covZ2, float);         //! element of the covariance matrix
+DECLARE_SOA_COLUMN(CovSnpY, covSnpY, float);     //! element of the covariance matrix
+DECLARE_SOA_COLUMN(CovSnpZ, covSnpZ, float);     //! element of the covariance matrix
+DECLARE_SOA_COLUMN(CovSnp2, covSnp2, float);     //! element of the covariance matrix
+DECLARE_SOA_COLUMN(CovTglY, covTglY, float);     //! element of the covariance matrix
+DECLARE_SOA_COLUMN(CovTglZ, covTglZ, float);     //! element of the covariance matrix
+DECLARE_SOA_COLUMN(CovTglSnp, covTglSnp, float); //! element of the covariance matrix
+DECLARE_SOA_COLUMN(CovTgl2, covTgl2, float);     //! element of the covariance matrix
+DECLARE_SOA_COLUMN(Cov1PtY, cov1PtY, float);     //! element of the covariance matrix
+DECLARE_SOA_COLUMN(Cov1PtZ, cov1PtZ, float);     //! element of the covariance matrix
+DECLARE_SOA_COLUMN(Cov1PtSnp, cov1PtSnp, float); //! element of the covariance matrix
+DECLARE_SOA_COLUMN(Cov1PtTgl, cov1PtTgl, float); //! element of the covariance matrix
+DECLARE_SOA_COLUMN(Cov1Pt2, cov1Pt2, float);     //! element of the covariance matrix
+} // namespace hf_cand_par_cov
+
+// track parametrisation and covariance of the 3-prong candidates at their secondary vertex,
+// optionally filled by the candidate creator and joinable with HfCand3ProngBase
+DECLARE_SOA_TABLE(HfCand3ProngParCov, "AOD", "HFCAND3PPARCOV", //!
+                  hf_cand_par_cov::ParX, hf_cand_par_cov::ParAlpha,
+                  hf_cand_par_cov::ParY, hf_cand_par_cov::ParZ, hf_cand_par_cov::ParSnp, hf_cand_par_cov::ParTgl, hf_cand_par_cov::ParQ2Pt,
+                  hf_cand_par_cov::CovY2, hf_cand_par_cov::CovZY, hf_cand_par_cov::CovZ2,
+                  hf_cand_par_cov::CovSnpY, hf_cand_par_cov::CovSnpZ, hf_cand_par_cov::CovSnp2,
+                  hf_cand_par_cov::CovTglY, hf_cand_par_cov::CovTglZ, hf_cand_par_cov::CovTglSnp, hf_cand_par_cov::CovTgl2,
+                  hf_cand_par_cov::Cov1PtY, hf_cand_par_cov::Cov1PtZ, hf_cand_par_cov::Cov1PtSnp, hf_cand_par_cov::Cov1PtTgl, hf_cand_par_cov::Cov1Pt2);
+
 // table with results of reconstruction level MC matching
 DECLARE_SOA_TABLE(HfCand3ProngMcRec, "AOD", "HFCAND3PMCREC", //!
                   hf_cand_3prong::FlagMcMatchRec,
@@ -1022,6 +1066,64 @@ DECLARE_SOA_TABLE(HfCand3ProngMcGen, "AOD", "HFCAND3PMCGEN", //!
                   hf_cand_3prong::OriginMcGen,
                   hf_cand_3prong::FlagMcDecayChanGen);
 
+// stored values of the most used dynamic columns of the 2-prong and 3-prong candidates,
+// computed once per data frame by candidate-stored-columns-creator and joinable with the candidate tables
+namespace hf_cand_stored
+{
+DECLARE_SOA_COLUMN(PtStored, ptStored, float);                                           //! transverse momentum of candidate
+DECLARE_SOA_COLUMN(DecayLengthStored, decayLengthStored, float);                         //! decay length
+DECLARE_SOA_COLUMN(DecayLengthXYStored, decayLengthXYStored, float);                     //! decay length in the transverse plane
+DECLARE_SOA_COLUMN(DecayLengthNormalisedStored, decayLengthNormalisedStored, float);     //! normalised decay length
+DECLARE_SOA_COLUMN(DecayLengthXYNormalisedStored, decayLengthXYNormalisedStored, float); //! normalised decay length in the transverse plane
+DECLARE_SOA_COLUMN(CpaStored, cpaStored, float);                                         //! cosine of pointing angle
+DECLARE_SOA_COLUMN(CpaXYStored, cpaXYStored, float);                                     //! cosine of pointing angle in the transverse plane
+DECLARE_SOA_COLUMN(ImpactParameterXYStored, impactParameterXYStored, float);             //! impact parameter of candidate in the transverse plane
+DECLARE_SOA_COLUMN(MaxNormalisedDeltaIPStored, maxNormalisedDeltaIPStored, float);       //! maximum normalised difference between measured and expected impact parameters of the prongs
+DECLARE_SOA_COLUMN(ImpactParameterProductStored, impactParameterProductStored, float);   //! product of the impact parameters of the prongs (2-prong)
+DECLARE_SOA_COLUMN(InvMassD0ToPiKStored, invMassD0ToPiKStored, float);                   //! invariant mass in the D0 → π+ K− hypothesis
+DECLARE_SOA_COLUMN(InvMassD0barToKPiStored, invMassD0barToKPiStored, float);             //! invariant mass in the D0bar → K+ π− hypothesis
+DECLARE_SOA_COLUMN(CosThetaStarD0Stored, cosThetaStarD0Stored, float);                   //! cos θ* in the D0 → π+ K− hypothesis
+DECLARE_SOA_COLUMN(CosThetaStarD0barStored, cosThetaStarD0barStored, float);             //! cos θ* in the D0bar → K+ π− hypothesis
+DECLARE_SOA_COLUMN(InvMassDplusToPiKPiStored, invMassDplusToPiKPiStored, float);         //! invariant mass in the D+ → π+ K− π+ hypothesis
+DECLARE_SOA_COLUMN(InvMassDsToKKPiStored, invMassDsToKKPiStored, float);                 //! invariant mass in the Ds+ → K+ K− π+ hypothesis
+DECLARE_SOA_COLUMN(InvMassDsToPiKKStored, invMassDsToPiKKStored, float);                 //! invariant mass in the Ds+ → π+ K− K+ hypothesis
+DECLARE_SOA_COLUMN(InvMassLcToPKPiStored, invMassLcToPKPiStored, float);                 //! invariant mass in the Λc+ → p K− π+ hypothesis
+DECLARE_SOA_COLUMN(InvMassLcToPiKPStored, invMassLcToPiKPStored, float);                 //! invariant mass in the Λc+ → π+ K− p hypothesis
+DECLARE_SOA_COLUMN(InvMassXicToPKPiStored, invMassXicToPKPiStored, float);               //! invariant mass in the Ξc+ → p K− π+ hypothesis
+DECLARE_SOA_COLUMN(InvMassXicToPiKPStored, invMassXicToPiKPStored, float);               //! invariant mass in the Ξc+ → π+ K− p hypothesis
+} // namespace hf_cand_stored
+
+// topological quantities of the 2-prong candidates
+DECLARE_SOA_TABLE(HfCand2ProngStored, "AOD", "HFCAND2PSTORED", //!
+                  hf_cand_stored::PtStored,
+                  hf_cand_stored::DecayLengthStored, hf_cand_stored::DecayLengthXYStored,
+                  hf_cand_stored::DecayLengthNormalisedStored, hf_cand_stored::DecayLengthXYNormalisedStored,
+                  hf_cand_stored::CpaStored, hf_cand_stored::CpaXYStored,
+                  hf_cand_stored::ImpactParameterXYStored,
+                  hf_cand_stored::MaxNormalisedDeltaIPStored,
+                  hf_cand_stored::ImpactParameterProductStored);
+
+// mass hypotheses of the 2-prong candidates
+DECLARE_SOA_TABLE(HfCand2ProngMStored, "AOD", "HFCAND2PMSTORED", //!
+                  hf_cand_stored::InvMassD0ToPiKStored, hf_cand_stored::InvMassD0barToKPiStored,
+                  hf_cand_stored::CosThetaStarD0Stored, hf_cand_stored::CosThetaStarD0barStored);
+
+// topological quantities of the 3-prong candidates
+DECLARE_SOA_TABLE(HfCand3ProngStored, "AOD", "HFCAND3PSTORED", //!
+                  hf_cand_stored::PtStored,
+                  hf_cand_stored::DecayLengthStored, hf_cand_stored::DecayLengthXYStored,
+                  hf_cand_stored::DecayLengthNormalisedStored, hf_cand_stored::DecayLengthXYNormalisedStored,
+                  hf_cand_stored::CpaStored, hf_cand_stored::CpaXYStored,
+                  hf_cand_stored::ImpactParameterXYStored,
+                  hf_cand_stored::MaxNormalisedDeltaIPStored);
+
+// mass hypotheses of the 3-prong candidates
+DECLARE_SOA_TABLE(HfCand3ProngMStored, "AOD", "HFCAND3PMSTORED", //!
+                  hf_cand_stored::InvMassDplusToPiKPiStored,
+                  hf_cand_stored::InvMassDsToKKPiStored, hf_cand_stored::InvMassDsToPiKKStored,
+                  hf_cand_stored::InvMassLcToPKPiStored, hf_cand_stored::InvMassLcToPiKPStored,
+                  hf_cand_stored::InvMassXicToPKPiStored, hf_cand_stored::InvMassXicToPiKPStored);
+
 namespace hf_cand_casc_lf_2prong
 {
 DECLARE_SOA_EXPRESSION_COLUMN(Px, px, //!
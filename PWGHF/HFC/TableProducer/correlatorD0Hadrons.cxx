@@ -24,6 +24,7 @@
 
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
+#include "PWGHF/Utils/utilsCorrelations.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -31,17 +32,10 @@ using namespace o2::framework::expressions;
 using namespace o2::aod::hf_cand;
 using namespace o2::aod::hf_cand_2prong;
 using namespace o2::aod::hf_correlation_d0_hadron;
+using namespace o2::analysis::hf_correlations;
 using namespace o2::analysis::hf_cuts_d0_to_pi_k;
 using namespace o2::constants::math;
 
-///
-/// Returns deltaPhi value in range [-pi/2., 3.*pi/2], typically used for correlation studies
-///
-double getDeltaPhi(double phiD, double phiDbar)
-{
-  return RecoDecay::constrainAngle(phiDbar - phiD, -o2::constants::math::PIHalf);
-}
-
 const int nPtBinsMassAndEfficiency = o2::analysis::hf_cuts_d0_to_pi_k::nBinsPt;
 const double efficiencyDmesonDefault[nPtBinsMassAndEfficiency] = {};
 auto vecEfficiencyDmeson = std::vector<double>{efficiencyDmesonDefault, efficiencyDmesonDefault + nPtBinsMassAndEfficiency};
@@ -86,6 +80,8 @@ struct HfCorrelatorD0Hadrons {
   Configurable<double> multMax{"multMax", 10000., "maximum multiplicity accepted"};
   Configurable<double> ptSoftPionMax{"ptSoftPionMax", 3 * 800. * pow(10., -6.), "max. pT cut for soft pion identification"};
 
+  AssociatedHadrons associatedHadrons;
+
   Partition<soa::Join<aod::HfCand2Prong, aod::HfSelD0>> selectedD0Candidates = aod::hf_sel_candidate_d0::isSelD0 >= selectionFlagD0 || aod::hf_sel_candidate_d0::isSelD0bar >= selectionFlagD0bar;
   Partition<soa::Join<aod::HfCand2Prong, aod::HfSelD0, aod::HfCand2ProngMcRec>> selectedD0candidatesMC = aod::hf_sel_candidate_d0::isSelD0 >= selectionFlagD0 || aod::hf_sel_candidate_d0::isSelD0bar >= selectionFlagD0bar;
 
@@ -168,6 +164,14 @@ struct HfCorrelatorD0Hadrons {
     }
     registry.fill(HIST("hMultiplicity"), nTracks);
 
+    associatedHadrons.clear();
+    for (const auto& track : tracks) {
+      if (std::abs(track.dcaXY()) >= 1. || std::abs(track.dcaZ()) >= 1.) {
+        continue; // Remove secondary tracks
+      }
+      associatedHadrons.add(track);
+    }
+
     auto selectedD0CandidatesGrouped = selectedD0Candidates->sliceByCached(aod::hf_cand::collisionId, collision.globalIndex(), cache);
 
     for (auto const& candidate1 : selectedD0CandidatesGrouped) {
@@ -214,39 +218,42 @@ struct HfCorrelatorD0Hadrons {
       // ================================================================================= D-h correlation dedicated section =====================================================
 
       // ========================== track loop starts here ================================
-      for (const auto& track : tracks) {
-        registry.fill(HIST("hTrackCounter"), 1); // fill total no. of tracks
+      registry.fill(HIST("hTrackCounter"), 1, tracks.size()); // fill total no. of tracks
+      auto invMassD0 = invMassD0ToPiK(candidate1);
+      auto invMassD0bar = invMassD0barToKPi(candidate1);
+      int nTracksBeforeSoftPi = 0, nTracksAfterSoftPi = 0;
+      associatedHadrons.computeDeltas(candidate1.eta(), candidate1.phi());
+      for (std::size_t iHadron = 0; iHadron < associatedHadrons.size(); iHadron++) {
         // Remove D0 daughters by checking track indices
-        if ((candidate1.prong0Id() == track.globalIndex()) || (candidate1.prong1Id() == track.globalIndex())) {
+        auto indexHadron = associatedHadrons.index(iHadron);
+        if ((candidate1.prong0Id() == indexHadron) || (candidate1.prong1Id() == indexHadron)) {
           continue;
         }
-        if (std::abs(track.dcaXY()) >= 1. || std::abs(track.dcaZ()) >= 1.)
-          continue; // Remove secondary tracks
-
-        registry.fill(HIST("hTrackCounter"), 2); // fill no. of tracks before soft pion removal
+        nTracksBeforeSoftPi++; // no. of tracks before soft pion removal
 
         // ===== soft pion removal ===================================================
         double invMassDstar1 = 0., invMassDstar2 = 0.;
         bool isSoftpiD0 = false, isSoftpiD0bar = false;
-        auto pSum2 = RecoDecay::p2(candidate1.px() + track.px(), candidate1.py() + track.py(), candidate1.pz() + track.pz());
-        auto ePion = track.energy(massPi);
+        auto pxHadron = associatedHadrons.px(iHadron), pyHadron = associatedHadrons.py(iHadron), pzHadron = associatedHadrons.pz(iHadron);
+        auto pSum2 = RecoDecay::p2(candidate1.px() + pxHadron, candidate1.py() + pyHadron, candidate1.pz() + pzHadron);
+        auto ePion = RecoDecay::e(pxHadron, pyHadron, pzHadron, massPi);
         invMassDstar1 = std::sqrt((ePiK + ePion) * (ePiK + ePion) - pSum2);
         invMassDstar2 = std::sqrt((eKPi + ePion) * (eKPi + ePion) - pSum2);
 
         if (candidate1.isSelD0() >= selectionFlagD0) {
-          if ((std::abs(invMassDstar1 - invMassD0ToPiK(candidate1)) - softPiMass) < ptSoftPionMax) {
+          if ((std::abs(invMassDstar1 - invMassD0) - softPiMass) < ptSoftPionMax) {
             isSoftpiD0 = true;
             continue;
           }
         }
 
         if (candidate1.isSelD0bar() >= selectionFlagD0bar) {
-          if ((std::abs(invMassDstar2 - invMassD0barToKPi(candidate1)) - softPiMass) < ptSoftPionMax) {
+          if ((std::abs(invMassDstar2 - invMassD0bar) - softPiMass) < ptSoftPionMax) {
             isSoftpiD0bar = true;
             continue;
           }
         }
-        registry.fill(HIST("hTrackCounter"), 3); // fill no. of tracks after soft pion removal
+        nTracksAfterSoftPi++; // no. of tracks after soft pion removal
 
         int signalStatus = 0;
         if ((candidate1.isSelD0() >= selectionFlagD0) && (isSoftpiD0 == false)) {
@@ -256,13 +263,15 @@ struct HfCorrelatorD0Hadrons {
           signalStatus += 2;
         }
 
-        entryD0HadronPair(getDeltaPhi(track.phi(), candidate1.phi()),
-                          track.eta() - candidate1.eta(),
+        entryD0HadronPair(associatedHadrons.deltaPhi(iHadron),
+                          associatedHadrons.deltaEta(iHadron),
                           candidate1.pt(),
-                          track.pt());
-        entryD0HadronRecoInfo(invMassD0ToPiK(candidate1), invMassD0barToKPi(candidate1), signalStatus);
+                          associatedHadrons.pt(iHadron));
+        entryD0HadronRecoInfo(invMassD0, invMassD0bar, signalStatus);
 
       } // end inner loop (tracks)
+      registry.fill(HIST("hTrackCounter"), 2, nTracksBeforeSoftPi);
+      registry.fill(HIST("hTrackCounter"), 3, nTracksAfterSoftPi);
 
     } // end outer loop
   }
@@ -296,6 +305,20 @@ struct HfCorrelatorD0Hadrons {
     }
     registry.fill(HIST("hMultiplicity"), nTracks);
 
+    associatedHadrons.clear();
+    for (const auto& track : tracks) {
+      if (std::abs(track.eta()) > etaTrackMax) {
+        continue;
+      }
+      if (track.pt() < ptTrackMin) {
+        continue;
+      }
+      if (std::abs(track.dcaXY()) >= 1. || std::abs(track.dcaZ()) >= 1.) {
+        continue; // Remove secondary tracks
+      }
+      associatedHadrons.add(track);
+    }
+
     auto selectedD0CandidatesGroupedMC = selectedD0candidatesMC->sliceByCached(aod::hf_cand::collisionId, collision.globalIndex(), cache);
     // MC reco level
     bool flagD0 = false;
@@ -359,46 +382,43 @@ struct HfCorrelatorD0Hadrons {
 
       // ========== track loop starts here ========================
 
-      for (const auto& track : tracks) {
-        registry.fill(HIST("hTrackCounterRec"), 1); // fill total no. of tracks
-        if (std::abs(track.eta()) > etaTrackMax) {
-          continue;
-        }
-        if (track.pt() < ptTrackMin) {
-          continue;
-        }
+      registry.fill(HIST("hTrackCounterRec"), 1, tracks.size()); // fill total no. of tracks
+      auto invMassD0 = invMassD0ToPiK(candidate1);
+      auto invMassD0bar = invMassD0barToKPi(candidate1);
+      int nTracksBeforeSoftPi = 0, nTracksAfterSoftPi = 0;
+      associatedHadrons.computeDeltas(candidate1.eta(), candidate1.phi());
+      for (std::size_t iHadron = 0; iHadron < associatedHadrons.size(); iHadron++) {
         // Removing D0 daughters by checking track indices
-        if ((candidate1.prong0Id() == track.globalIndex()) || (candidate1.prong1Id() == track.globalIndex())) {
+        auto indexHadron = associatedHadrons.index(iHadron);
+        if ((candidate1.prong0Id() == indexHadron) || (candidate1.prong1Id() == indexHadron)) {
           continue;
         }
-        if (std::abs(track.dcaXY()) >= 1. || std::abs(track.dcaZ()) >= 1.) {
-          continue; // Remove secondary tracks
-        }
-        registry.fill(HIST("hTrackCounterRec"), 2); // fill no. of tracks before soft pion removal
+        nTracksBeforeSoftPi++; // no. of tracks before soft pion removal
 
         // ===== soft pion removal ===================================================
         double invMassDstar1 = 0, invMassDstar2 = 0;
         bool isSoftpiD0 = false, isSoftpiD0bar = false;
-        auto pSum2 = RecoDecay::p2(candidate1.px() + track.px(), candidate1.py() + track.py(), candidate1.pz() + track.pz());
-        auto ePion = track.energy(massPi);
+        auto pxHadron = associatedHadrons.px(iHadron), pyHadron = associatedHadrons.py(iHadron), pzHadron = associatedHadrons.pz(iHadron);
+        auto pSum2 = RecoDecay::p2(candidate1.px() + pxHadron, candidate1.py() + pyHadron, candidate1.pz() + pzHadron);
+        auto ePion = RecoDecay::e(pxHadron, pyHadron, pzHadron, massPi);
         invMassDstar1 = std::sqrt((ePiK + ePion) * (ePiK + ePion) - pSum2);
         invMassDstar2 = std::sqrt((eKPi + ePion) * (eKPi + ePion) - pSum2);
 
         if (candidate1.isSelD0() >= selectionFlagD0) {
-          if ((std::abs(invMassDstar1 - invMassD0ToPiK(candidate1)) - softPiMass) < ptSoftPionMax) {
+          if ((std::abs(invMassDstar1 - invMassD0) - softPiMass) < ptSoftPionMax) {
             isSoftpiD0 = true;
             continue;
           }
         }
 
         if (candidate1.isSelD0bar() >= selectionFlagD0bar) {
-          if ((std::abs(invMassDstar2 - invMassD0barToKPi(candidate1)) - softPiMass) < ptSoftPionMax) {
+          if ((std::abs(invMassDstar2 - invMassD0bar) - softPiMass) < ptSoftPionMax) {
             isSoftpiD0bar = true;
             continue;
           }
         }
 
-        registry.fill(HIST("hTrackCounterRec"), 3); // fill no. of tracks after soft pion removal
+        nTracksAfterSoftPi++; // no. of tracks after soft pion removal
 
         int signalStatus = 0;
         if ((flagD0 == true) && (candidate1.isSelD0() >= selectionFlagD0) && (isSoftpiD0 == false)) {
@@ -421,12 +441,14 @@ struct HfCorrelatorD0Hadrons {
           signalStatus += 32;
         } // background case D0bar
 
-        entryD0HadronPair(getDeltaPhi(track.phi(), candidate1.phi()),
-                          track.eta() - candidate1.eta(),
+        entryD0HadronPair(associatedHadrons.deltaPhi(iHadron),
+                          associatedHadrons.deltaEta(iHadron),
                           candidate1.pt(),
-                          track.pt());
-        entryD0HadronRecoInfo(invMassD0ToPiK(candidate1), invMassD0barToKPi(candidate1), signalStatus);
+                          associatedHadrons.pt(iHadron));
+        entryD0HadronRecoInfo(invMassD0, invMassD0bar, signalStatus);
       } // end inner loop (Tracks)
+      registry.fill(HIST("hTrackCounterRec"), 2, nTracksBeforeSoftPi);
+      registry.fill(HIST("hTrackCounterRec"), 3, nTracksAfterSoftPi);
 
     } // end of outer loop (D0)
   }
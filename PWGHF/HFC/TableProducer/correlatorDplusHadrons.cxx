@@ -24,22 +24,17 @@
 
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
+#include "PWGHF/Utils/utilsCorrelations.h"
 
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::framework::expressions;
 using namespace o2::aod::hf_cand_3prong;
 using namespace o2::aod::hf_correlation_dplus_hadron;
+using namespace o2::analysis::hf_correlations;
 using namespace o2::analysis::hf_cuts_dplus_to_pi_k_pi;
 using namespace o2::constants::math;
 
-/// Returns deltaPhi value in range [-pi/2., 3.*pi/2], typically used for correlation studies
-
-double getDeltaPhi(double phiD, double phiHadron)
-{
-  return RecoDecay::constrainAngle(phiHadron - phiD, -o2::constants::math::PIHalf);
-}
-
 /// definition of variables for Dplus hadron pairs (in data-like, MC-reco and MC-kine tasks)
 const int npTBinsMassAndEfficiency = o2::analysis::hf_cuts_dplus_to_pi_k_pi::nBinsPt;
 const double efficiencyDmesonDefault[npTBinsMassAndEfficiency] = {};
@@ -164,6 +159,10 @@ struct HfCorrelatorDplusHadrons {
   Configurable<float> multMax{"multMax", 10000., "maximum multiplicity accepted"};
   Configurable<std::vector<double>> binsPt{"binsPt", std::vector<double>{o2::analysis::hf_cuts_dplus_to_pi_k_pi::vecBinsPt}, "pT bin limits for candidate mass plots and efficiency"};
   Configurable<std::vector<double>> efficiencyD{"efficiencyD", std::vector<double>{efficiencyDmeson_v}, "Efficiency values for Dplus meson"};
+  Configurable<int> numberEventsMixed{"numberEventsMixed", 5, "number of events of the same pool bin mixed with each event"};
+
+  AssociatedHadrons associatedHadrons;
+  MixingPools mixingPools;
 
   Partition<soa::Join<aod::HfCand3Prong, aod::HfSelDplusToPiKPi>> selectedDplusCandidates = aod::hf_sel_candidate_dplus::isSelDplusToPiKPi >= selectionFlagDplus;
   Partition<soa::Join<aod::HfCand3Prong, aod::HfSelDplusToPiKPi, aod::HfCand3ProngMcRec>> recoFlagDplusCandidates = aod::hf_sel_candidate_dplus::isSelDplusToPiKPi >= selectionFlagDplus;
@@ -208,6 +207,26 @@ struct HfCorrelatorDplusHadrons {
     registry.add("hMassDplusMCRecSig", "Dplus signal candidates - MC reco;inv. mass (#pi K) (GeV/#it{c}^{2});entries", {HistType::kTH2F, {{massAxisBins, massAxisMin, massAxisMax}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
     registry.add("hMassDplusMCRecBkg", "Dplus background candidates - MC reco;inv. mass (#pi K) (GeV/#it{c}^{2});entries", {HistType::kTH2F, {{massAxisBins, massAxisMin, massAxisMax}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
     registry.add("hcountDplustriggersMCGen", "Dplus trigger particles - MC gen;;N of trigger Dplus", {HistType::kTH2F, {{1, -0.5, 0.5}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
+    mixingPools.init(numberEventsMixed);
+  }
+
+  /// Fills the associated hadrons of the event with the tracks passing the selections of the pairs
+  template <typename TTracks>
+  void selectAssociatedHadrons(TTracks const& tracks)
+  {
+    associatedHadrons.clear();
+    for (const auto& track : tracks) {
+      if (std::abs(track.eta()) > etaTrackMax) {
+        continue;
+      }
+      if (track.pt() < ptTrackMin) {
+        continue;
+      }
+      if (std::abs(track.dcaXY()) >= dcaXYTrackMax || std::abs(track.dcaZ()) >= dcaZTrackMax) {
+        continue; // Remove secondary tracks
+      }
+      associatedHadrons.add(track);
+    }
   }
 
   /// Dplus-hadron correlation pair builder - for real data and data-like analysis (i.e. reco-level w/o matching request via MC truth)
@@ -225,15 +244,16 @@ struct HfCorrelatorDplusHadrons {
             continue;
           }
           nTracks++;
-          registry.fill(HIST("hTracksBin"), poolBin);
         }
       }
+      registry.fill(HIST("hTracksBin"), poolBin, nTracks);
 
       registry.fill(HIST("hMultiplicityPreSelection"), nTracks);
       if (nTracks < multMin || nTracks > multMax) {
         return;
       }
       registry.fill(HIST("hMultiplicity"), nTracks);
+      selectAssociatedHadrons(tracks);
 
       auto selectedDplusCandidatesGrouped = selectedDplusCandidates->sliceByCached(aod::hf_cand::collisionId, collision.globalIndex(), cache);
 
@@ -269,24 +289,17 @@ struct HfCorrelatorDplusHadrons {
         registry.fill(HIST("hDplusBin"), poolBin);
         // Dplus-Hadron correlation dedicated section
         // if the candidate is a Dplus, search for Hadrons and evaluate correlations
-        for (const auto& track : tracks) {
-          if (std::abs(track.eta()) > etaTrackMax) {
-            continue;
-          }
-          if (track.pt() < ptTrackMin) {
-            continue;
-          }
-          if (std::abs(track.dcaXY()) >= dcaXYTrackMax || std::abs(track.dcaZ()) >= dcaZTrackMax) {
-            continue; // Remove secondary tracks
-          }
+        associatedHadrons.computeDeltas(candidate1.eta(), candidate1.phi());
+        for (std::size_t iHadron = 0; iHadron < associatedHadrons.size(); iHadron++) {
           // Removing Dplus daughters by checking track indices
-          if ((candidate1.prong0Id() == track.globalIndex()) || (candidate1.prong1Id() == track.globalIndex()) || (candidate1.prong2Id() == track.globalIndex())) {
+          auto indexHadron = associatedHadrons.index(iHadron);
+          if ((candidate1.prong0Id() == indexHadron) || (candidate1.prong1Id() == indexHadron) || (candidate1.prong2Id() == indexHadron)) {
             continue;
           }
-          entryDplusHadronPair(getDeltaPhi(track.phi(), candidate1.phi()),
-                               track.eta() - candidate1.eta(),
+          entryDplusHadronPair(associatedHadrons.deltaPhi(iHadron),
+                               associatedHadrons.deltaEta(iHadron),
                                candidate1.pt(),
-                               track.pt(), poolBin);
+                               associatedHadrons.pt(iHadron), poolBin);
           entryDplusHadronRecoInfo(invMassDplusToPiKPi(candidate1), 0);
         } // Hadron Tracks loop
       }   // end outer Dplus loop
@@ -312,14 +325,15 @@ struct HfCorrelatorDplusHadrons {
             continue;
           }
           nTracks++;
-          registry.fill(HIST("hTracksBin"), poolBin);
         }
       }
+      registry.fill(HIST("hTracksBin"), poolBin, nTracks);
       registry.fill(HIST("hMultiplicityPreSelection"), nTracks);
       if (nTracks < multMin || nTracks > multMax) {
         return;
       }
       registry.fill(HIST("hMultiplicity"), nTracks);
+      selectAssociatedHadrons(tracks);
 
       auto selectedDplusCandidatesGroupedMc = recoFlagDplusCandidates->sliceByCached(aod::hf_cand::collisionId, collision.globalIndex(), cache);
       // MC reco level
@@ -365,24 +379,17 @@ struct HfCorrelatorDplusHadrons {
         // Dplus-Hadron correlation dedicated section
         // if the candidate is selected as Dplus, search for Hadron and evaluate correlations
         flagDplusSignal = candidate1.flagMcMatchRec() == 1 << DecayType::DplusToPiKPi;
-        for (const auto& track : tracks) {
-          if (std::abs(track.eta()) > etaTrackMax) {
-            continue;
-          }
-          if (track.pt() < ptTrackMin) {
-            continue;
-          }
+        associatedHadrons.computeDeltas(candidate1.eta(), candidate1.phi());
+        for (std::size_t iHadron = 0; iHadron < associatedHadrons.size(); iHadron++) {
           // Removing Dplus daughters by checking track indices
-          if ((candidate1.prong0Id() == track.globalIndex()) || (candidate1.prong1Id() == track.globalIndex()) || (candidate1.prong2Id() == track.globalIndex())) {
+          auto indexHadron = associatedHadrons.index(iHadron);
+          if ((candidate1.prong0Id() == indexHadron) || (candidate1.prong1Id() == indexHadron) || (candidate1.prong2Id() == indexHadron)) {
             continue;
           }
-          if (std::abs(track.dcaXY()) >= dcaXYTrackMax || std::abs(track.dcaZ()) >= dcaZTrackMax) {
-            continue; // Remove secondary tracks
-          }
-          entryDplusHadronPair(getDeltaPhi(track.phi(), candidate1.phi()),
-                               track.eta() - candidate1.eta(),
+          entryDplusHadronPair(associatedHadrons.deltaPhi(iHadron),
+                               associatedHadrons.deltaEta(iHadron),
                                candidate1.pt(),
-                               track.pt(), poolBin);
+                               associatedHadrons.pt(iHadron), poolBin);
           entryDplusHadronRecoInfo(invMassDplusToPiKPi(candidate1), flagDplusSignal);
         } // end inner loop (Tracks)
 
@@ -483,45 +490,45 @@ struct HfCorrelatorDplusHadrons {
   Filter trackFilter = (nabs(aod::track::eta) < etaTrackMax) && (nabs(aod::track::pt) > ptTrackMin) && (nabs(aod::track::dcaXY) < dcaXYTrackMax) && (nabs(aod::track::dcaZ) < dcaZTrackMax);
   Filter dplusfilter = aod::hf_sel_candidate_dplus::isSelDplusToPiKPi >= 1;
 
-  void processDataMixedEvent(mySelCollisions& collisions, myCandidatesData& candidates, myTracks& tracks)
+  /// Pairs the Dplus candidates of the event with the hadrons of the previous events of its pool bin, then adds its hadrons to the pool
+  template <typename TCollision, typename TCandidates, typename TTracks>
+  void mixEvent(TCollision const& collision, TCandidates const& candidates, TTracks const& tracks)
   {
-    auto tracksTuple = std::make_tuple(candidates, tracks);
-    Pair<mySelCollisions, myCandidatesData, myTracks, BinningType> pairData{corrBinning, 5, -1, collisions, tracksTuple, &cache};
-
-    for (auto& [c1, tracks1, c2, tracks2] : pairData) {
-      // LOGF(info, "Mixed event collisions: Index = (%d, %d), tracks Size: (%d, %d), Z Vertex: (%f, %f), Pool Bin: (%d, %d)", c1.globalIndex(), c2.globalIndex(), tracks1.size(), tracks2.size(), c1.posZ(), c2.posZ(), corrBinning.getBin(std::make_tuple(c1.posZ(), c1.multFV0M())),corrBinning.getBin(std::make_tuple(c2.posZ(), c2.multFV0M()))); // For debug
-      int poolBin = corrBinning.getBin(std::make_tuple(c2.posZ(), c2.multFV0M()));
-      for (auto& [t1, t2] : o2::soa::combinations(o2::soa::CombinationsFullIndexPolicy(tracks1, tracks2))) {
-
-        if (yCandMax >= 0. && std::abs(yDplus(t1)) > yCandMax) {
+    int poolBin = corrBinning.getBin(std::make_tuple(collision.posZ(), collision.multFV0M()));
+    if (poolBin < 0) {
+      return;
+    }
+    mixingPools.forEachEvent(poolBin, [&](AssociatedHadrons& hadronsMixed) {
+      for (const auto& candidate : candidates) {
+        if (yCandMax >= 0. && std::abs(yDplus(candidate)) > yCandMax) {
           continue;
         }
-        entryDplusHadronPair(getDeltaPhi(t1.phi(), t2.phi()), t1.eta() - t2.eta(), t1.pt(), t2.pt(), poolBin);
-        entryDplusHadronRecoInfo(invMassDplusToPiKPi(t1), 0);
+        hadronsMixed.computeDeltas(candidate.eta(), candidate.phi());
+        for (std::size_t iHadron = 0; iHadron < hadronsMixed.size(); iHadron++) {
+          entryDplusHadronPair(hadronsMixed.deltaPhi(iHadron), hadronsMixed.deltaEta(iHadron), candidate.pt(), hadronsMixed.pt(iHadron), poolBin);
+          entryDplusHadronRecoInfo(invMassDplusToPiKPi(candidate), 0);
+        }
       }
+    });
+    associatedHadrons.clear();
+    for (const auto& track : tracks) {
+      associatedHadrons.add(track);
     }
+    mixingPools.add(poolBin, associatedHadrons);
+  }
+
+  void processDataMixedEvent(mySelCollisions::iterator const& collision, myCandidatesData const& candidates, myTracks const& tracks)
+  {
+    mixEvent(collision, candidates, tracks);
   }
   PROCESS_SWITCH(HfCorrelatorDplusHadrons, processDataMixedEvent, "Process Mixed Event Data", false);
 
   // Event Mixing for the MCRec Mode
   using myCandidatesMcRec = soa::Filtered<soa::Join<aod::HfCand3Prong, aod::HfSelDplusToPiKPi, aod::HfCand3ProngMcRec>>;
 
-  void processMcRecMixedEvent(mySelCollisions& collisions, myCandidatesMcRec& candidates, myTracks& tracks)
+  void processMcRecMixedEvent(mySelCollisions::iterator const& collision, myCandidatesMcRec const& candidates, myTracks const& tracks)
   {
-    auto tracksTuple = std::make_tuple(candidates, tracks);
-    Pair<mySelCollisions, myCandidatesMcRec, myTracks, BinningType> pairMcRec{corrBinning, 5, -1, collisions, tracksTuple, &cache};
-
-    for (auto& [c1, tracks1, c2, tracks2] : pairMcRec) {
-      int poolBin = corrBinning.getBin(std::make_tuple(c2.posZ(), c2.multFV0M()));
-      for (auto& [t1, t2] : o2::soa::combinations(o2::soa::CombinationsFullIndexPolicy(tracks1, tracks2))) {
-
-        if (yCandMax >= 0. && std::abs(yDplus(t1)) > yCandMax) {
-          continue;
-        }
-        entryDplusHadronPair(getDeltaPhi(t1.phi(), t2.phi()), t1.eta() - t2.eta(), t1.pt(), t2.pt(), poolBin);
-        entryDplusHadronRecoInfo(invMassDplusToPiKPi(t1), 0);
-      }
-    }
+    mixEvent(collision, candidates, tracks);
   }
   PROCESS_SWITCH(HfCorrelatorDplusHadrons, processMcRecMixedEvent, "Process Mixed Event MCRec", false);
 
@@ -26,6 +26,7 @@
 
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
+#include "PWGHF/Utils/utilsCorrelations.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -33,15 +34,10 @@ using namespace o2::framework::expressions;
 using namespace o2::aod::hf_cand_3prong;
 using namespace o2::aod::hf_correlation_ds_hadron;
 using namespace o2::aod::hf_selection_dmeson_collision;
+using namespace o2::analysis::hf_correlations;
 using namespace o2::analysis::hf_cuts_ds_to_k_k_pi;
 using namespace o2::constants::math;
 
-/// Returns deltaPhi value in range [-pi/2., 3.*pi/2], typically used for correlation studies
-double getDeltaPhi(double phiD, double phiHadron)
-{
-  return RecoDecay::constrainAngle(phiHadron - phiD, -o2::constants::math::PIHalf);
-}
-
 /// definition of variables for Ds hadron pairs (in data-like, MC-reco and MC-kine tasks)
 const int nBinsPtMassAndEfficiency = o2::analysis::hf_cuts_ds_to_k_k_pi::nBinsPt;
 const double efficiencyDmesonDefault[nBinsPtMassAndEfficiency] = {};
@@ -173,6 +169,10 @@ struct HfCorrelatorDsHadrons {
   Configurable<float> multMax{"multMax", 10000., "maximum multiplicity accepted"};
   Configurable<std::vector<double>> binsPt{"binsPt", std::vector<double>{o2::analysis::hf_cuts_ds_to_k_k_pi::vecBinsPt}, "pT bin limits for candidate mass plots and efficiency"};
   Configurable<std::vector<double>> efficiencyD{"efficiencyD", std::vector<double>{vecEfficiencyDmeson}, "Efficiency values for Ds meson"};
+  Configurable<int> numberEventsMixed{"numberEventsMixed", 5, "number of events of the same pool bin mixed with each event"};
+
+  AssociatedHadrons associatedHadrons;
+  MixingPools mixingPools;
 
   Filter collisionFilter = aod::hf_selection_dmeson_collision::dmesonSel == true;
   Filter flagDsFilter = ((o2::aod::hf_track_index::hfflag & static_cast<uint8_t>(1 << DecayType::DsToKKPi)) != static_cast<uint8_t>(0)) && (aod::hf_sel_candidate_ds::isSelDsToKKPi >= selectionFlagDs || aod::hf_sel_candidate_ds::isSelDsToPiKK >= selectionFlagDs);
@@ -245,6 +245,76 @@ struct HfCorrelatorDsHadrons {
     registry.add("hMassDsMCRecSig", "Ds signal candidates - MC Reco", {HistType::kTH2F, {{axisMassD}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
     registry.add("hMassDsMCRecBkg", "Ds background candidates - MC Reco", {HistType::kTH2F, {{axisMassD}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
     registry.add("hCountDstriggersMCGen", "Ds trigger particles - MC Gen", {HistType::kTH2F, {{1, -0.5, 0.5, "number of Ds triggers"}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
+    mixingPools.init(numberEventsMixed);
+  }
+
+  /// Fills the pairs of a Ds candidate with the associated hadrons
+  /// \param candidate is the Ds candidate
+  /// \param hadrons are the associated hadrons, of the same event or of a mixed one
+  /// \param poolBin is the pool bin of the event
+  /// \param removeDaughters rejects the hadrons which are daughters of the candidate, for the pairs of the same event
+  template <typename T1>
+  void fillPairs(const T1& candidate, AssociatedHadrons& hadrons, int poolBin, bool removeDaughters, bool isDsSignal, bool isDsPrompt)
+  {
+    // DsToKKPi and DsToPiKK division
+    float massDs;
+    if (candidate.isSelDsToKKPi() >= selectionFlagDs) {
+      massDs = invMassDsToKKPi(candidate);
+    } else if (candidate.isSelDsToPiKK() >= selectionFlagDs) {
+      massDs = invMassDsToPiKK(candidate);
+    } else {
+      return;
+    }
+    hadrons.computeDeltas(candidate.eta(), candidate.phi());
+    for (std::size_t iHadron = 0; iHadron < hadrons.size(); iHadron++) {
+      // Removing Ds daughters by checking track indices
+      if (removeDaughters) {
+        auto indexHadron = hadrons.index(iHadron);
+        if ((candidate.prong0Id() == indexHadron) || (candidate.prong1Id() == indexHadron) || (candidate.prong2Id() == indexHadron)) {
+          continue;
+        }
+      }
+      entryDsHadronPair(hadrons.deltaPhi(iHadron),
+                        hadrons.deltaEta(iHadron),
+                        candidate.pt(),
+                        hadrons.pt(iHadron),
+                        poolBin);
+      entryDsHadronRecoInfo(massDs, isDsSignal);
+      entryDsHadronGenInfo(isDsPrompt);
+    }
+  }
+
+  /// Pairs the Ds candidates of the event with the hadrons of the previous events of its pool bin, then adds its hadrons to the pool
+  template <bool doMc, typename TCollision, typename TCandidates>
+  void mixEvent(TCollision const& collision, TCandidates const& candidates, MyTracksData const& tracks)
+  {
+    int poolBin = corrBinning.getBin(std::make_tuple(collision.posZ(), collision.multFV0M()));
+    if (poolBin < 0) {
+      return;
+    }
+    mixingPools.forEachEvent(poolBin, [&](AssociatedHadrons& hadronsMixed) {
+      registry.fill(HIST("hTracksPoolBin"), poolBin);
+      registry.fill(HIST("hDsPoolBin"), poolBin);
+      for (const auto& candidate : candidates) {
+        if (yCandMax >= 0. && std::abs(yDs(candidate)) > yCandMax) {
+          continue;
+        }
+        bool isDsSignal = false;
+        bool isDsPrompt = false;
+        if constexpr (doMc) {
+          // prompt and non-prompt division
+          isDsPrompt = candidate.originMcRec() == RecoDecay::OriginType::Prompt;
+          // Ds Signal
+          isDsSignal = std::abs(candidate.flagMcMatchRec()) == 1 << DecayType::DsToKKPi;
+        }
+        fillPairs(candidate, hadronsMixed, poolBin, false, isDsSignal, isDsPrompt);
+      }
+    });
+    associatedHadrons.clear();
+    for (const auto& track : tracks) {
+      associatedHadrons.add(track);
+    }
+    mixingPools.add(poolBin, associatedHadrons);
   }
 
   /// Fill histograms of quantities independent from the daugther-mass hypothesis for data
@@ -357,13 +427,17 @@ struct HfCorrelatorDsHadrons {
             continue;
           }
           nTracks++;
-          registry.fill(HIST("hTracksPoolBin"), poolBin);
         }
       }
+      registry.fill(HIST("hTracksPoolBin"), poolBin, nTracks);
       if (nTracks < multMin || nTracks > multMax) {
         return;
       }
       registry.fill(HIST("hMultiplicity"), nTracks);
+      associatedHadrons.clear();
+      for (const auto& track : tracks) {
+        associatedHadrons.add(track);
+      }
 
       // Ds fill histograms and Ds-Hadron correlation for DsToKKPi
       for (const auto& candidate : candidates) {
@@ -388,29 +462,7 @@ struct HfCorrelatorDsHadrons {
         }
 
         // Ds-Hadron correlation dedicated section
-        for (const auto& track : tracks) {
-          // Removing Ds daughters by checking track indices
-          if ((candidate.prong0Id() == track.globalIndex()) || (candidate.prong1Id() == track.globalIndex()) || (candidate.prong2Id() == track.globalIndex())) {
-            continue;
-          }
-          if (candidate.isSelDsToKKPi() >= selectionFlagDs) {
-            entryDsHadronPair(getDeltaPhi(track.phi(), candidate.phi()),
-                              track.eta() - candidate.eta(),
-                              candidate.pt(),
-                              track.pt(),
-                              poolBin);
-            entryDsHadronRecoInfo(invMassDsToKKPi(candidate), false);
-            entryDsHadronGenInfo(false);
-          } else if (candidate.isSelDsToPiKK() >= selectionFlagDs) {
-            entryDsHadronPair(getDeltaPhi(track.phi(), candidate.phi()),
-                              track.eta() - candidate.eta(),
-                              candidate.pt(),
-                              track.pt(),
-                              poolBin);
-            entryDsHadronRecoInfo(invMassDsToPiKK(candidate), false);
-            entryDsHadronGenInfo(false);
-          }
-        }
+        fillPairs(candidate, associatedHadrons, poolBin, true, false, false);
       }
     }
   }
@@ -430,15 +482,19 @@ struct HfCorrelatorDsHadrons {
           if (std::abs(track.eta()) > etaTrackMax) {
             continue;
           }
-          registry.fill(HIST("hTracksPoolBin"), poolBin);
           nTracks++;
         }
       }
+      registry.fill(HIST("hTracksPoolBin"), poolBin, nTracks);
       registry.fill(HIST("hMultiplicityPreSelection"), nTracks);
       if (nTracks < multMin || nTracks > multMax) {
         return;
       }
       registry.fill(HIST("hMultiplicity"), nTracks);
+      associatedHadrons.clear();
+      for (const auto& track : tracks) {
+        associatedHadrons.add(track);
+      }
 
       // auto selectedDsMcRecoCandGrouped = selectedDsMcRecoCand->sliceByCached(aod::hf_cand::collisionId, collision.globalIndex(), cache);
 
@@ -497,31 +553,15 @@ struct HfCorrelatorDsHadrons {
 
         // Ds-Hadron correlation dedicated section
         // if the candidate is selected as Ds, search for Hadron and evaluate correlations
-        for (const auto& track : tracks) {
+        for (std::size_t iHadron = 0; iHadron < associatedHadrons.size(); iHadron++) {
           // Removing Ds daughters by checking track indices
-          if ((candidate.prong0Id() == track.globalIndex()) || (candidate.prong1Id() == track.globalIndex()) || (candidate.prong2Id() == track.globalIndex())) {
+          auto indexHadron = associatedHadrons.index(iHadron);
+          if ((candidate.prong0Id() == indexHadron) || (candidate.prong1Id() == indexHadron) || (candidate.prong2Id() == indexHadron)) {
             continue;
           }
-          registry.fill(HIST("hPtParticleAssocMcRec"), track.pt()); // va tolto
-          // DsToKKPi and DsToPiKK division
-          if (candidate.isSelDsToKKPi() >= selectionFlagDs) {
-            entryDsHadronPair(getDeltaPhi(track.phi(), candidate.phi()),
-                              track.eta() - candidate.eta(),
-                              candidate.pt(),
-                              track.pt(),
-                              poolBin);
-            entryDsHadronRecoInfo(invMassDsToKKPi(candidate), isDsSignal);
-            entryDsHadronGenInfo(isDsPrompt);
-          } else if (candidate.isSelDsToPiKK() >= selectionFlagDs) {
-            entryDsHadronPair(getDeltaPhi(track.phi(), candidate.phi()),
-                              track.eta() - candidate.eta(),
-                              candidate.pt(),
-                              track.pt(),
-                              poolBin);
-            entryDsHadronRecoInfo(invMassDsToPiKK(candidate), isDsSignal);
-            entryDsHadronGenInfo(isDsPrompt);
-          }
+          registry.fill(HIST("hPtParticleAssocMcRec"), associatedHadrons.pt(iHadron)); // va tolto
         }
+        fillPairs(candidate, associatedHadrons, poolBin, true, isDsSignal, isDsPrompt);
       }
     }
   }
@@ -673,63 +713,18 @@ struct HfCorrelatorDsHadrons {
   PROCESS_SWITCH(HfCorrelatorDsHadrons, processMcGen, "Process MC Gen mode", false);
 
   // Event Mixing
-  void processDataME(soa::Join<aod::Collisions, aod::Mults>& collisions, CandDsData& candidates, MyTracksData& tracks)
+  void processDataME(SelCollisionsWithDs::iterator const& collision, CandDsData const& candidates, MyTracksData const& tracks)
   {
-    if (candidates.size() == 0) {
-      return;
-    }
     for (const auto& candidate : candidates) {
       fillHisto(candidate);
     }
-
-    auto tracksTuple = std::make_tuple(candidates, tracks);
-    Pair<soa::Join<aod::Collisions, aod::Mults>, CandDsData, MyTracksData, BinningType> pairData{corrBinning, 5, -1, collisions, tracksTuple, &cache};
-
-    for (auto& [c1, tracks1, c2, tracks2] : pairData) {
-      if (tracks1.size() == 0) {
-        continue;
-      }
-      LOGF(info, "Mixed event collisions: Index = (%d, %d), tracks Size: (%d, %d), Z Vertex: (%f, %f), Pool Bin: (%d, %d)", c1.globalIndex(), c2.globalIndex(), tracks1.size(), tracks2.size(), c1.posZ(), c2.posZ(), corrBinning.getBin(std::make_tuple(c1.posZ(), c1.multFV0M())), corrBinning.getBin(std::make_tuple(c2.posZ(), c2.multFV0M())));
-      int poolBin = corrBinning.getBin(std::make_tuple(c2.posZ(), c2.multFV0M()));
-      int poolBinDs = corrBinning.getBin(std::make_tuple(c1.posZ(), c1.multFV0M()));
-      registry.fill(HIST("hTracksPoolBin"), poolBin);
-      registry.fill(HIST("hDsPoolBin"), poolBinDs);
-      for (auto& [cand, pAssoc] : o2::soa::combinations(o2::soa::CombinationsFullIndexPolicy(tracks1, tracks2))) {
-        if (!(cand.hfflag() & 1 << DecayType::DsToKKPi)) {
-          continue;
-        }
-        if (yCandMax >= 0. && std::abs(yDs(cand)) > yCandMax) {
-          continue;
-        }
-
-        // DsToKKPi and DsToPiKK division
-        if (cand.isSelDsToKKPi() >= selectionFlagDs) {
-          LOGF(info, "Mixed event tracks pair: (%d, %d) from events (%d, %d), track event: (%d, %d), KKPi", cand.index(), pAssoc.index(), c1.index(), c2.index(), cand.collision().index(), pAssoc.collision().index());
-          entryDsHadronPair(getDeltaPhi(cand.phi(), pAssoc.phi()),
-                            cand.eta() - pAssoc.eta(),
-                            cand.pt(),
-                            pAssoc.pt(),
-                            poolBin);
-          entryDsHadronRecoInfo(invMassDsToKKPi(cand), false);
-          entryDsHadronGenInfo(false);
-        } else if (cand.isSelDsToPiKK() >= selectionFlagDs) {
-          LOGF(info, "Mixed event tracks pair: (%d, %d) from events (%d, %d), track event: (%d, %d), PiKK", cand.index(), pAssoc.index(), c1.index(), c2.index(), cand.collision().index(), pAssoc.collision().index());
-          entryDsHadronPair(getDeltaPhi(cand.phi(), pAssoc.phi()),
-                            cand.eta() - pAssoc.eta(),
-                            cand.pt(),
-                            pAssoc.pt(),
-                            poolBin);
-          entryDsHadronRecoInfo(invMassDsToPiKK(cand), false);
-          entryDsHadronGenInfo(false);
-        }
-      }
-    }
+    mixEvent<false>(collision, candidates, tracks);
   }
   PROCESS_SWITCH(HfCorrelatorDsHadrons, processDataME, "Process Mixed Event Data", false);
 
-  void processMcRecME(SelCollisionsWithDs& collisions, CandDsMcReco& candidates, MyTracksData& tracks)
+  void processMcRecME(SelCollisionsWithDs::iterator const& collision, CandDsMcReco const& candidates, MyTracksData const& tracks)
   {
-    for (auto& candidate : candidates) {
+    for (const auto& candidate : candidates) {
       if (yCandMax >= 0. && std::abs(yDs(candidate)) > yCandMax) {
         continue;
       }
@@ -752,45 +747,7 @@ struct HfCorrelatorDsHadrons {
         fillHistoMcRecBkg(candidate);
       }
     }
-    auto tracksTuple = std::make_tuple(candidates, tracks);
-    Pair<SelCollisionsWithDs, CandDsMcReco, MyTracksData, BinningType> pairMcRec{corrBinning, 5, -1, collisions, tracksTuple, &cache};
-
-    bool isDsPrompt = false;
-    bool isDsSignal = false;
-    for (auto& [c1, tracks1, c2, tracks2] : pairMcRec) {
-      int poolBin = corrBinning.getBin(std::make_tuple(c2.posZ(), c2.multFV0M()));
-      int poolBinDs = corrBinning.getBin(std::make_tuple(c1.posZ(), c1.multFV0M()));
-      registry.fill(HIST("hTracksPoolBin"), poolBin);
-      registry.fill(HIST("hDsPoolBin"), poolBinDs);
-      for (auto& [candidate, pAssoc] : o2::soa::combinations(o2::soa::CombinationsFullIndexPolicy(tracks1, tracks2))) {
-
-        if (yCandMax >= 0. && std::abs(yDs(candidate)) > yCandMax) {
-          continue;
-        }
-        // prompt and non-prompt division
-        isDsPrompt = candidate.originMcRec() == RecoDecay::OriginType::Prompt;
-        // Ds Signal
-        isDsSignal = std::abs(candidate.flagMcMatchRec()) == 1 << DecayType::DsToKKPi;
-        // DsToKKPi and DsToPiKK division
-        if (candidate.isSelDsToKKPi() >= selectionFlagDs) {
-          entryDsHadronPair(getDeltaPhi(candidate.phi(), pAssoc.phi()),
-                            candidate.eta() - pAssoc.eta(),
-                            candidate.pt(),
-                            pAssoc.pt(),
-                            poolBin);
-          entryDsHadronRecoInfo(invMassDsToKKPi(candidate), isDsSignal);
-          entryDsHadronGenInfo(isDsPrompt);
-        } else if (candidate.isSelDsToPiKK() >= selectionFlagDs) {
-          entryDsHadronPair(getDeltaPhi(candidate.phi(), pAssoc.phi()),
-                            candidate.eta() - pAssoc.eta(),
-                            candidate.pt(),
-                            pAssoc.pt(),
-                            poolBin);
-          entryDsHadronRecoInfo(invMassDsToPiKK(candidate), isDsSignal);
-          entryDsHadronGenInfo(isDsPrompt);
-        }
-      }
-    }
+    mixEvent<true>(collision, candidates, tracks);
   }
   PROCESS_SWITCH(HfCorrelatorDsHadrons, processMcRecME, "Process Mixed Event MCRec", false);
 
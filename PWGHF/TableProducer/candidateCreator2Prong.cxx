@@ -20,10 +20,13 @@
 #include "Framework/runDataProcessing.h"
 #include "ReconstructionDataFormats/DCA.h"
 
+#include "Common/Core/McDecayGraph.h"
+#include "Common/Core/PropagatorServices.h"
 #include "Common/Core/trackUtilities.h"
 
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/Utils/utilsBfieldCCDB.h"
+#include "PWGHF/Utils/utilsTrackParCovCache.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -62,6 +65,7 @@ struct HfCandidateCreator2Prong {
   double massPiK{0.};
   double massKPi{0.};
   double bz = 0.;
+  TrackParCovCache trackParCovCache; // prong parametrisations, shared by the candidates of a dataframe
 
   OutputObj<TH1F> hMass2{TH1F("hMass2", "2-prong candidates;inv. mass (#pi K) (GeV/#it{c}^{2});entries", 500, 0., 5.)};
   OutputObj<TH1F> hCovPVXX{TH1F("hCovPVXX", "2-prong candidates;XX element of cov. matrix of prim. vtx. position (cm^{2});entries", 100, 0., 1.e-4)};
@@ -83,7 +87,7 @@ struct HfCandidateCreator2Prong {
     ccdb->setURL(ccdbUrl);
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
-    lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(ccdbPathLut));
+    lut = o2::common::propagator::getMatLut(ccdb, ccdbPathLut);
     runNumber = 0;
   }
 
@@ -104,27 +108,37 @@ struct HfCandidateCreator2Prong {
     df.setUseAbsDCA(useAbsDCA);
     df.setWeightedFinalPCA(useWeightedFinalPCA);
 
+    // the candidates are grouped by collision: the collision quantities are updated only when the collision changes
+    rowCandidateBase.reserve(rowsTrackIndexProng2.size());
+    trackParCovCache.reset(tracks.size());
+    int64_t lastCollisionId = -1;
+    o2::dataformats::VertexBase primaryVertexCollision;
+
     // loop over pairs of track indices
     for (const auto& rowTrackIndexProng2 : rowsTrackIndexProng2) {
       auto track0 = rowTrackIndexProng2.template prong0_as<aod::BigTracks>();
       auto track1 = rowTrackIndexProng2.template prong1_as<aod::BigTracks>();
-      auto trackParVarPos1 = getTrackParCov(track0);
-      auto trackParVarNeg1 = getTrackParCov(track1);
+      const auto& trackParVarPos1 = trackParCovCache.get(track0);
+      const auto& trackParVarNeg1 = trackParCovCache.get(track1);
       auto collision = rowTrackIndexProng2.collision();
-
-      /// Set the magnetic field from ccdb.
-      /// The static instance of the propagator was already modified in the HFTrackIndexSkimCreator,
-      /// but this is not true when running on Run2 data/MC already converted into AO2Ds.
-      auto bc = collision.template bc_as<aod::BCsWithTimestamps>();
-      if (runNumber != bc.runNumber()) {
-        LOG(info) << ">>>>>>>>>>>> Current run number: " << runNumber;
-        initCCDB(bc, runNumber, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2);
-        bz = o2::base::Propagator::Instance()->getNominalBz();
-        LOG(info) << ">>>>>>>>>>>> Magnetic field: " << bz;
-        // df.setBz(bz); /// put it outside the 'if'! Otherwise we have a difference wrt bz Configurable (< 1 permille) in Run2 conv. data
-        // df.print();
+      if (collision.globalIndex() != lastCollisionId) {
+        lastCollisionId = collision.globalIndex();
+        primaryVertexCollision = getPrimaryVertex(collision);
+
+        /// Set the magnetic field from ccdb.
+        /// The static instance of the propagator was already modified in the HFTrackIndexSkimCreator,
+        /// but this is not true when running on Run2 data/MC already converted into AO2Ds.
+        auto bc = collision.template bc_as<aod::BCsWithTimestamps>();
+        if (runNumber != bc.runNumber()) {
+          LOG(info) << ">>>>>>>>>>>> Current run number: " << runNumber;
+          initCCDB(bc, runNumber, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2);
+          bz = o2::base::Propagator::Instance()->getNominalBz();
+          LOG(info) << ">>>>>>>>>>>> Magnetic field: " << bz;
+          // df.setBz(bz); /// put it outside the 'if'! Otherwise we have a difference wrt bz Configurable (< 1 permille) in Run2 conv. data
+          // df.print();
+        }
+        df.setBz(bz);
       }
-      df.setBz(bz);
 
       // reconstruct the 2-prong secondary vertex
       if (df.process(trackParVarPos1, trackParVarNeg1) == 0) {
@@ -148,7 +162,7 @@ struct HfCandidateCreator2Prong {
 
       // get track impact parameters
       // This modifies track momenta!
-      auto primaryVertex = getPrimaryVertex(collision);
+      auto primaryVertex = primaryVertexCollision;
       auto covMatrixPV = primaryVertex.getCov();
       if constexpr (doPvRefit) {
         /// use PV refit
@@ -237,6 +251,8 @@ struct HfCandidateCreator2ProngExpressions {
   Produces<aod::HfCand2ProngMcRec> rowMcMatchRec;
   Produces<aod::HfCand2ProngMcGen> rowMcMatchGen;
 
+  McDecayGraph decayGraph; // index of the MC decay tree
+
   void init(InitContext const&) {}
 
   /// Performs MC matching.
@@ -244,6 +260,7 @@ struct HfCandidateCreator2ProngExpressions {
                  aod::McParticles const& particlesMC)
   {
     rowCandidateProng2->bindExternalIndices(&tracks);
+    decayGraph.build(particlesMC);
 
     int indexRec = -1;
     int8_t sign = 0;
@@ -260,7 +277,7 @@ struct HfCandidateCreator2ProngExpressions {
 
       // D0(bar) → π± K∓
       // Printf("Checking D0(bar) → π± K∓");
-      indexRec = RecoDecay::getMatchedMCRec(particlesMC, arrayDaughters, pdg::Code::kD0, array{+kPiPlus, -kKPlus}, true, &sign);
+      indexRec = decayGraph.getMatchedMCRec(arrayDaughters, pdg::Code::kD0, array{+kPiPlus, -kKPlus}, true, &sign);
       if (indexRec > -1) {
         flag = sign * (1 << DecayType::D0ToPiK);
       }
@@ -268,7 +285,7 @@ struct HfCandidateCreator2ProngExpressions {
       // J/ψ → e+ e−
       if (flag == 0) {
         // Printf("Checking J/ψ → e+ e−");
-        indexRec = RecoDecay::getMatchedMCRec(particlesMC, arrayDaughters, pdg::Code::kJPsi, array{+kElectron, -kElectron}, true);
+        indexRec = decayGraph.getMatchedMCRec(arrayDaughters, pdg::Code::kJPsi, array{+kElectron, -kElectron}, true);
         if (indexRec > -1) {
           flag = 1 << DecayType::JpsiToEE;
         }
@@ -277,7 +294,7 @@ struct HfCandidateCreator2ProngExpressions {
       // J/ψ → μ+ μ−
       if (flag == 0) {
         // Printf("Checking J/ψ → μ+ μ−");
-        indexRec = RecoDecay::getMatchedMCRec(particlesMC, arrayDaughters, pdg::Code::kJPsi, array{+kMuonPlus, -kMuonPlus}, true);
+        indexRec = decayGraph.getMatchedMCRec(arrayDaughters, pdg::Code::kJPsi, array{+kMuonPlus, -kMuonPlus}, true);
         if (indexRec > -1) {
           flag = 1 << DecayType::JpsiToMuMu;
         }
@@ -300,14 +317,14 @@ struct HfCandidateCreator2ProngExpressions {
 
       // D0(bar) → π± K∓
       // Printf("Checking D0(bar) → π± K∓");
-      if (RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kD0, array{+kPiPlus, -kKPlus}, true, &sign)) {
+      if (decayGraph.isMatchedMCGen(particle.globalIndex(), pdg::Code::kD0, array{+kPiPlus, -kKPlus}, true, &sign)) {
         flag = sign * (1 << DecayType::D0ToPiK);
       }
 
       // J/ψ → e+ e−
       if (flag == 0) {
         // Printf("Checking J/ψ → e+ e−");
-        if (RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kJPsi, array{+kElectron, -kElectron}, true)) {
+        if (decayGraph.isMatchedMCGen(particle.globalIndex(), pdg::Code::kJPsi, array{+kElectron, -kElectron}, true)) {
           flag = 1 << DecayType::JpsiToEE;
         }
       }
@@ -315,7 +332,7 @@ struct HfCandidateCreator2ProngExpressions {
       // J/ψ → μ+ μ−
       if (flag == 0) {
         // Printf("Checking J/ψ → μ+ μ−");
-        if (RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kJPsi, array{+kMuonPlus, -kMuonPlus}, true)) {
+        if (decayGraph.isMatchedMCGen(particle.globalIndex(), pdg::Code::kJPsi, array{+kMuonPlus, -kMuonPlus}, true)) {
           flag = 1 << DecayType::JpsiToMuMu;
         }
       }
@@ -19,11 +19,15 @@
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
 #include "ReconstructionDataFormats/DCA.h"
+#include "ReconstructionDataFormats/V0.h"
 
+#include "Common/Core/McDecayGraph.h"
+#include "Common/Core/PropagatorServices.h"
 #include "Common/Core/trackUtilities.h"
 
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/Utils/utilsBfieldCCDB.h"
+#include "PWGHF/Utils/utilsTrackParCovCache.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -33,6 +37,7 @@ using namespace o2::aod::hf_cand_3prong;
 /// Reconstruction of heavy-flavour 3-prong decay candidates
 struct HfCandidateCreator3Prong {
   Produces<aod::HfCand3ProngBase> rowCandidateBase;
+  Produces<aod::HfCand3ProngParCov> rowCandidateParCov;
 
   // vertexing
   Configurable<bool> propagateToPCA{"propagateToPCA", true, "create tracks version propagated to PCA"};
@@ -43,6 +48,7 @@ struct HfCandidateCreator3Prong {
   Configurable<double> minParamChange{"minParamChange", 1.e-3, "stop iterations if largest change of any X is smaller than this"};
   Configurable<double> minRelChi2Change{"minRelChi2Change", 0.9, "stop iterations is chi2/chi2old > this"};
   Configurable<bool> fillHistograms{"fillHistograms", true, "do validation plots"};
+  Configurable<bool> fillParCov{"fillParCov", false, "fill the track parametrisation and covariance of the candidates at the secondary vertex (HfCand3ProngParCov)"};
   // magnetic field setting from CCDB
   Configurable<bool> isRun2{"isRun2", false, "enable Run 2 or Run 3 GRP objects for magnetic field"};
   Configurable<std::string> ccdbUrl{"ccdbUrl", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
@@ -61,6 +67,7 @@ struct HfCandidateCreator3Prong {
   double massK = RecoDecay::getMassPDG(kKPlus);
   double massPiKPi{0.};
   double bz = 0.;
+  TrackParCovCache trackParCovCache; // prong parametrisations, shared by the candidates of a dataframe
 
   OutputObj<TH1F> hMass3{TH1F("hMass3", "3-prong candidates;inv. mass (#pi K #pi) (GeV/#it{c}^{2});entries", 500, 1.6, 2.1)};
   OutputObj<TH1F> hCovPVXX{TH1F("hCovPVXX", "3-prong candidates;XX element of cov. matrix of prim. vtx. position (cm^{2});entries", 100, 0., 1.e-4)};
@@ -83,7 +90,7 @@ struct HfCandidateCreator3Prong {
     ccdb->setURL(ccdbUrl);
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
-    lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(ccdbPathLut));
+    lut = o2::common::propagator::getMatLut(ccdb, ccdbPathLut);
     runNumber = 0;
   }
 
@@ -104,29 +111,42 @@ struct HfCandidateCreator3Prong {
     df.setUseAbsDCA(useAbsDCA);
     df.setWeightedFinalPCA(useWeightedFinalPCA);
 
+    // the candidates are grouped by collision: the collision quantities are updated only when the collision changes
+    rowCandidateBase.reserve(rowsTrackIndexProng3.size());
+    if (fillParCov) {
+      rowCandidateParCov.reserve(rowsTrackIndexProng3.size());
+    }
+    trackParCovCache.reset(tracks.size());
+    int64_t lastCollisionId = -1;
+    o2::dataformats::VertexBase primaryVertexCollision;
+
     // loop over triplets of track indices
     for (const auto& rowTrackIndexProng3 : rowsTrackIndexProng3) {
       auto track0 = rowTrackIndexProng3.template prong0_as<aod::BigTracks>();
       auto track1 = rowTrackIndexProng3.template prong1_as<aod::BigTracks>();
       auto track2 = rowTrackIndexProng3.template prong2_as<aod::BigTracks>();
-      auto trackParVar0 = getTrackParCov(track0);
-      auto trackParVar1 = getTrackParCov(track1);
-      auto trackParVar2 = getTrackParCov(track2);
+      auto trackParVar0 = trackParCovCache.get(track0);
+      auto trackParVar1 = trackParCovCache.get(track1);
+      auto trackParVar2 = trackParCovCache.get(track2);
       auto collision = rowTrackIndexProng3.collision();
-
-      /// Set the magnetic field from ccdb.
-      /// The static instance of the propagator was already modified in the HFTrackIndexSkimCreator,
-      /// but this is not true when running on Run2 data/MC already converted into AO2Ds.
-      auto bc = collision.template bc_as<aod::BCsWithTimestamps>();
-      if (runNumber != bc.runNumber()) {
-        LOG(info) << ">>>>>>>>>>>> Current run number: " << runNumber;
-        initCCDB(bc, runNumber, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2);
-        bz = o2::base::Propagator::Instance()->getNominalBz();
-        LOG(info) << ">>>>>>>>>>>> Magnetic field: " << bz;
-        // df.setBz(bz); /// put it outside the 'if'! Otherwise we have a difference wrt bz Configurable (< 1 permille) in Run2 conv. data
-        // df.print();
+      if (collision.globalIndex() != lastCollisionId) {
+        lastCollisionId = collision.globalIndex();
+        primaryVertexCollision = getPrimaryVertex(collision);
+
+        /// Set the magnetic field from ccdb.
+        /// The static instance of the propagator was already modified in the HFTrackIndexSkimCreator,
+        /// but this is not true when running on Run2 data/MC already converted into AO2Ds.
+        auto bc = collision.template bc_as<aod::BCsWithTimestamps>();
+        if (runNumber != bc.runNumber()) {
+          LOG(info) << ">>>>>>>>>>>> Current run number: " << runNumber;
+          initCCDB(bc, runNumber, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2);
+          bz = o2::base::Propagator::Instance()->getNominalBz();
+          LOG(info) << ">>>>>>>>>>>> Magnetic field: " << bz;
+          // df.setBz(bz); /// put it outside the 'if'! Otherwise we have a difference wrt bz Configurable (< 1 permille) in Run2 conv. data
+          // df.print();
+        }
+        df.setBz(bz);
       }
-      df.setBz(bz);
 
       // reconstruct the 3-prong secondary vertex
       if (df.process(trackParVar0, trackParVar1, trackParVar2) == 0) {
@@ -151,9 +171,23 @@ struct HfCandidateCreator3Prong {
       trackParVar1.getPxPyPzGlo(pvec1);
       trackParVar2.getPxPyPzGlo(pvec2);
 
+      // candidate parametrisation at the secondary vertex, combining the prongs 0 and 1 first
+      if (fillParCov) {
+        auto trackParCov01 = o2::dataformats::V0(df.getPCACandidatePos(), RecoDecay::pVec(pvec0, pvec1), covMatrixPCA,
+                                                 trackParVar0, trackParVar1, {0, 0}, {0, 0});
+        auto trackParCovCand = o2::dataformats::V0(df.getPCACandidatePos(), RecoDecay::pVec(pvec0, pvec1, pvec2), covMatrixPCA,
+                                                   trackParCov01, trackParVar2, {0, 0}, {0, 0});
+        rowCandidateParCov(trackParCovCand.getX(), trackParCovCand.getAlpha(),
+                           trackParCovCand.getY(), trackParCovCand.getZ(), trackParCovCand.getSnp(), trackParCovCand.getTgl(), trackParCovCand.getQ2Pt(),
+                           trackParCovCand.getSigmaY2(), trackParCovCand.getSigmaZY(), trackParCovCand.getSigmaZ2(),
+                           trackParCovCand.getSigmaSnpY(), trackParCovCand.getSigmaSnpZ(), trackParCovCand.getSigmaSnp2(),
+                           trackParCovCand.getSigmaTglY(), trackParCovCand.getSigmaTglZ(), trackParCovCand.getSigmaTglSnp(), trackParCovCand.getSigmaTgl2(),
+                           trackParCovCand.getSigma1PtY(), trackParCovCand.getSigma1PtZ(), trackParCovCand.getSigma1PtSnp(), trackParCovCand.getSigma1PtTgl(), trackParCovCand.getSigma1Pt2());
+      }
+
       // get track impact parameters
       // This modifies track momenta!
-      auto primaryVertex = getPrimaryVertex(collision);
+      auto primaryVertex = primaryVertexCollision;
       auto covMatrixPV = primaryVertex.getCov();
       if constexpr (doPvRefit) {
         /// use PV refit
@@ -245,6 +279,8 @@ struct HfCandidateCreator3ProngExpressions {
   Produces<aod::HfCand3ProngMcRec> rowMcMatchRec;
   Produces<aod::HfCand3ProngMcGen> rowMcMatchGen;
 
+  McDecayGraph decayGraph; // index of the MC decay tree
+
   void init(InitContext const&) {}
 
   /// Performs MC matching.
@@ -252,6 +288,7 @@ struct HfCandidateCreator3ProngExpressions {
                  aod::McParticles const& particlesMC)
   {
     rowCandidateProng3->bindExternalIndices(&tracks);
+    decayGraph.build(particlesMC);
 
     int indexRec = -1;
     int8_t sign = 0;
@@ -280,7 +317,7 @@ struct HfCandidateCreator3ProngExpressions {
 
       // D± → π± K∓ π±
       // Printf("Checking D± → π± K∓ π±");
-      indexRec = RecoDecay::getMatchedMCRec(particlesMC, arrayDaughters, pdg::Code::kDPlus, array{+kPiPlus, -kKPlus, +kPiPlus}, true, &sign, 2);
+      indexRec = decayGraph.getMatchedMCRec(arrayDaughters, pdg::Code::kDPlus, array{+kPiPlus, -kKPlus, +kPiPlus}, true, &sign, 2);
       if (indexRec > -1) {
         flag = sign * (1 << DecayType::DplusToPiKPi);
       }
@@ -288,13 +325,13 @@ struct HfCandidateCreator3ProngExpressions {
       // Ds± → K± K∓ π±
       if (flag == 0) {
         // Printf("Checking Ds± → K± K∓ π±");
-        indexRec = RecoDecay::getMatchedMCRec(particlesMC, arrayDaughters, pdg::Code::kDS, array{+kKPlus, -kKPlus, +kPiPlus}, true, &sign, 2);
+        indexRec = decayGraph.getMatchedMCRec(arrayDaughters, pdg::Code::kDS, array{+kKPlus, -kKPlus, +kPiPlus}, true, &sign, 2);
         if (indexRec > -1) {
           flag = sign * (1 << DecayType::DsToKKPi);
           if (arrayDaughters[0].has_mcParticle()) {
             swapping = int8_t(std::abs(arrayDaughters[0].mcParticle().pdgCode()) == kPiPlus);
           }
-          RecoDecay::getDaughters(particlesMC.rawIteratorAt(indexRec), &arrDaughIndex, array{0}, 1);
+          decayGraph.getDaughters(indexRec, &arrDaughIndex, array{0}, 1);
           if (arrDaughIndex.size() == 2) {
             for (auto iProng = 0u; iProng < arrDaughIndex.size(); ++iProng) {
               auto daughI = particlesMC.rawIteratorAt(arrDaughIndex[iProng]);
@@ -312,7 +349,7 @@ struct HfCandidateCreator3ProngExpressions {
       // Λc± → p± K∓ π±
       if (flag == 0) {
         // Printf("Checking Λc± → p± K∓ π±");
-        indexRec = RecoDecay::getMatchedMCRec(particlesMC, arrayDaughters, pdg::Code::kLambdaCPlus, array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2);
+        indexRec = decayGraph.getMatchedMCRec(arrayDaughters, pdg::Code::kLambdaCPlus, array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2);
         if (indexRec > -1) {
           flag = sign * (1 << DecayType::LcToPKPi);
 
@@ -320,7 +357,7 @@ struct HfCandidateCreator3ProngExpressions {
           if (arrayDaughters[0].has_mcParticle()) {
             swapping = int8_t(std::abs(arrayDaughters[0].mcParticle().pdgCode()) == kPiPlus);
           }
-          RecoDecay::getDaughters(particlesMC.rawIteratorAt(indexRec), &arrDaughIndex, array{0}, 1);
+          decayGraph.getDaughters(indexRec, &arrDaughIndex, array{0}, 1);
           if (arrDaughIndex.size() == 2) {
             for (auto iProng = 0u; iProng < arrDaughIndex.size(); ++iProng) {
               auto daughI = particlesMC.rawIteratorAt(arrDaughIndex[iProng]);
@@ -340,7 +377,7 @@ struct HfCandidateCreator3ProngExpressions {
       // Ξc± → p± K∓ π±
       if (flag == 0) {
         // Printf("Checking Ξc± → p± K∓ π±");
-        indexRec = RecoDecay::getMatchedMCRec(particlesMC, arrayDaughters, pdg::Code::kXiCPlus, array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2);
+        indexRec = decayGraph.getMatchedMCRec(arrayDaughters, pdg::Code::kXiCPlus, array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2);
         if (indexRec > -1) {
           flag = sign * (1 << DecayType::XicToPKPi);
         }
@@ -365,16 +402,16 @@ struct HfCandidateCreator3ProngExpressions {
 
       // D± → π± K∓ π±
       // Printf("Checking D± → π± K∓ π±");
-      if (RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kDPlus, array{+kPiPlus, -kKPlus, +kPiPlus}, true, &sign, 2)) {
+      if (decayGraph.isMatchedMCGen(particle.globalIndex(), pdg::Code::kDPlus, array{+kPiPlus, -kKPlus, +kPiPlus}, true, &sign, 2)) {
         flag = sign * (1 << DecayType::DplusToPiKPi);
       }
 
       // Ds± → K± K∓ π±
       if (flag == 0) {
         // Printf("Checking Ds± → K± K∓ π±");
-        if (RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kDS, array{+kKPlus, -kKPlus, +kPiPlus}, true, &sign, 2)) {
+        if (decayGraph.isMatchedMCGen(particle.globalIndex(), pdg::Code::kDS, array{+kKPlus, -kKPlus, +kPiPlus}, true, &sign, 2)) {
           flag = sign * (1 << DecayType::DsToKKPi);
-          RecoDecay::getDaughters(particle, &arrDaughIndex, array{0}, 1);
+          decayGraph.getDaughters(particle.globalIndex(), &arrDaughIndex, array{0}, 1);
           if (arrDaughIndex.size() == 2) {
             for (auto jProng = 0u; jProng < arrDaughIndex.size(); ++jProng) {
               auto daughJ = particlesMC.rawIteratorAt(arrDaughIndex[jProng]);
@@ -392,11 +429,11 @@ struct HfCandidateCreator3ProngExpressions {
       // Λc± → p± K∓ π±
       if (flag == 0) {
         // Printf("Checking Λc± → p± K∓ π±");
-        if (RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kLambdaCPlus, array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2)) {
+        if (decayGraph.isMatchedMCGen(particle.globalIndex(), pdg::Code::kLambdaCPlus, array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2)) {
           flag = sign * (1 << DecayType::LcToPKPi);
 
           // Printf("Flagging the different Λc± → p± K∓ π± decay channels");
-          RecoDecay::getDaughters(particle, &arrDaughIndex, array{0}, 1);
+          decayGraph.getDaughters(particle.globalIndex(), &arrDaughIndex, array{0}, 1);
           if (arrDaughIndex.size() == 2) {
             for (auto jProng = 0u; jProng < arrDaughIndex.size(); ++jProng) {
               auto daughJ = particlesMC.rawIteratorAt(arrDaughIndex[jProng]);
@@ -416,7 +453,7 @@ struct HfCandidateCreator3ProngExpressions {
       // Ξc± → p± K∓ π±
       if (flag == 0) {
         // Printf("Checking Ξc± → p± K∓ π±");
-        if (RecoDecay::isMatchedMCGen(particlesMC, particle, pdg::Code::kXiCPlus, array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2)) {
+        if (decayGraph.isMatchedMCGen(particle.globalIndex(), pdg::Code::kXiCPlus, array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2)) {
           flag = sign * (1 << DecayType::XicToPKPi);
         }
       }
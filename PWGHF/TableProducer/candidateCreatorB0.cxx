@@ -21,6 +21,7 @@
 #include "ReconstructionDataFormats/DCA.h"
 #include "ReconstructionDataFormats/V0.h"
 
+#include "Common/Core/PropagatorServices.h"
 #include "Common/Core/trackUtilities.h"
 #include "Common/DataModel/CollisionAssociationTables.h"
 
@@ -56,6 +57,8 @@ struct HfCandidateCreatorB0 {
   Configurable<std::vector<double>> binsPtPion{"binsPtPion", std::vector<double>{hf_cuts_single_track::vecBinsPtTrack}, "track pT bin limits for pion DCA XY pT-dependent cut"};
   Configurable<LabeledArray<double>> cutsTrackPionDCA{"cutsTrackPionDCA", {hf_cuts_single_track::cutsTrack[0], hf_cuts_single_track::nBinsPtTrack, hf_cuts_single_track::nCutVarsTrack, hf_cuts_single_track::labelsPtTrack, hf_cuts_single_track::labelsCutVarTrack}, "Single-track selections per pT bin for pions"};
   Configurable<double> invMassWindowB0{"invMassWindowB0", 0.3, "invariant-mass window for B0 candidates"};
+  Configurable<double> invMassWindowB0PreFit{"invMassWindowB0PreFit", 0.5, "invariant-mass window for D-pi pairs before the B0 vertex fit, from the momenta at the D vertex and at the pion DCA (negative: no cut)"};
+  Configurable<double> cpaPreFitMin{"cpaPreFitMin", -2., "min. cosine of the angle between the D-pi momentum and the primary-to-D vertex direction, before the B0 vertex fit"};
   Configurable<int> selectionFlagD{"selectionFlagD", 1, "Selection Flag for D"};
   // magnetic field setting from CCDB
   Configurable<bool> isRun2{"isRun2", false, "enable Run 2 or Run 3 GRP objects for magnetic field"};
@@ -83,6 +86,14 @@ struct HfCandidateCreatorB0 {
 
   Preslice<aod::TrackAssoc> trackIndicesPerCollision = aod::track_association::collisionId;
 
+  struct PionCandidate {
+    int64_t globalIndex;
+    float pt;
+    std::array<float, 3> pVec;
+    o2::track::TrackParCov trackParCov;
+  };
+  std::array<std::vector<PionCandidate>, 2> pionsThisCollision; // negative and positive pions of the current collision
+
   OutputObj<TH1F> hMassDToPiKPi{TH1F("hMassDToPiKPi", "D^{#minus} candidates;inv. mass (p^{#minus} K^{#plus} #pi^{#minus}) (GeV/#it{c}^{2});entries", 500, 0., 5.)};
   OutputObj<TH1F> hPtD{TH1F("hPtD", "D^{#minus} candidates;D^{#minus} candidate #it{p}_{T} (GeV/#it{c});entries", 100, 0., 10.)};
   OutputObj<TH1F> hPtPion{TH1F("hPtPion", "#pi^{#plus} candidates;#pi^{#plus} candidate #it{p}_{T} (GeV/#it{c});entries", 100, 0., 10.)};
@@ -96,7 +107,7 @@ struct HfCandidateCreatorB0 {
     ccdb->setURL(ccdbUrl);
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
-    lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(ccdbPathLut));
+    lut = o2::common::propagator::getMatLut(ccdb, ccdbPathLut);
     runNumber = 0;
   }
 
@@ -174,6 +185,28 @@ struct HfCandidateCreatorB0 {
 
       auto thisCollId = collision.globalIndex();
       auto candsDThisColl = candsD.sliceBy(candsDPerCollision, thisCollId);
+      if (candsDThisColl.size() == 0) {
+        continue;
+      }
+
+      // select the pions of this collision once, for all its D candidates
+      pionsThisCollision[0].clear();
+      pionsThisCollision[1].clear();
+      auto trackIdsThisCollision = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
+      for (const auto& trackId : trackIdsThisCollision) { // start loop over track indices associated to this collision
+        auto trackPion = trackId.track_as<TracksWithSel>();
+
+        // check isGlobalTrackWoDCA status for pions if wanted
+        if (usePionIsGlobalTrackWoDCA && !trackPion.isGlobalTrackWoDCA()) {
+          continue;
+        }
+
+        // minimum pT selection
+        if (trackPion.pt() < ptPionMin || !isSelectedTrackDCA(trackPion)) {
+          continue;
+        }
+        pionsThisCollision[trackPion.sign() > 0].push_back({trackPion.globalIndex(), trackPion.pt(), {trackPion.px(), trackPion.py(), trackPion.pz()}, getTrackParCov(trackPion)});
+      }
 
       for (const auto& candD : candsDThisColl) { // start loop over filtered D candidates indices as associated to this collision in candidateCreator3Prong.cxx
         hMassDToPiKPi->Fill(invMassDplusToPiKPi(candD), candD.pt());
@@ -238,36 +271,27 @@ struct HfCandidateCreatorB0 {
         int indexTrack1 = track1.globalIndex();
         int indexTrack2 = track2.globalIndex();
 
-        auto trackIdsThisCollision = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
-
-        for (const auto& trackId : trackIdsThisCollision) { // start loop over track indices associated to this collision
-          auto trackPion = trackId.track_as<TracksWithSel>();
-
-          // check isGlobalTrackWoDCA status for pions if wanted
-          if (usePionIsGlobalTrackWoDCA && !trackPion.isGlobalTrackWoDCA()) {
+        // pi and D with opposite sign only
+        for (const auto& pion : pionsThisCollision[track0.sign() < 0]) {
+          // reject pions that are D daughters
+          if (pion.globalIndex == indexTrack0 || pion.globalIndex == indexTrack1 || pion.globalIndex == indexTrack2) {
             continue;
           }
 
-          // minimum pT selection
-          if (trackPion.pt() < ptPionMin || !isSelectedTrackDCA(trackPion)) {
-            continue;
-          }
-          // reject pions that are D daughters
-          if (trackPion.globalIndex() == indexTrack0 || trackPion.globalIndex() == indexTrack1 || trackPion.globalIndex() == indexTrack2) {
+          hPtPion->Fill(pion.pt);
+          array<float, 3> pVecPion = pion.pVec;
+
+          // kinematic preselection of the pair, before the vertex fit
+          if (invMassWindowB0PreFit >= 0. && std::abs(RecoDecay::m(array{pVecD, pVecPion}, array{massD, massPi}) - massB0) > invMassWindowB0PreFit) {
             continue;
           }
-          // reject pi and D with same sign
-          if (trackPion.sign() * track0.sign() > 0) {
+          if (cpaPreFitMin > -1. && RecoDecay::cpa(array{collision.posX(), collision.posY(), collision.posZ()}, secondaryVertexD, RecoDecay::pVec(pVecD, pVecPion)) < cpaPreFitMin) {
             continue;
           }
 
-          hPtPion->Fill(trackPion.pt());
-          array<float, 3> pVecPion = {trackPion.px(), trackPion.py(), trackPion.pz()};
-          auto trackParCovPi = getTrackParCov(trackPion);
-
           // ---------------------------------
           // reconstruct the 2-prong B0 vertex
-          if (df2.process(trackParCovD, trackParCovPi) == 0) {
+          if (df2.process(trackParCovD, pion.trackParCov) == 0) {
             continue;
           }
 
@@ -281,20 +305,23 @@ struct HfCandidateCreatorB0 {
           // propagate D and Pi to the B0 vertex
           df2.propagateTracksToVertex();
           // track.getPxPyPzGlo(pVec) modifies pVec of track
-          df2.getTrack(0).getPxPyPzGlo(pVecD);    // momentum of D at the B0 vertex
-          df2.getTrack(1).getPxPyPzGlo(pVecPion); // momentum of Pi at the B0 vertex
+          array<float, 3> pVecDAtB0;
+          df2.getTrack(0).getPxPyPzGlo(pVecDAtB0); // momentum of D at the B0 vertex
+          df2.getTrack(1).getPxPyPzGlo(pVecPion);  // momentum of Pi at the B0 vertex
 
           // calculate invariant mass and apply selection
-          massDPi = RecoDecay::m(array{pVecD, pVecPion}, array{massD, massPi});
+          massDPi = RecoDecay::m(array{pVecDAtB0, pVecPion}, array{massD, massPi});
           if (std::abs(massDPi - massB0) > invMassWindowB0) {
             continue;
           }
           hMassB0ToDPi->Fill(massDPi);
 
-          // compute impact parameters of D and Pi
+          // compute impact parameters of D and Pi, on copies so that the D and the pion are not moved for the next pairs
           o2::dataformats::DCA dcaD;
           o2::dataformats::DCA dcaPion;
-          trackParCovD.propagateToDCA(primaryVertex, bz, &dcaD);
+          auto trackParCovDAtPV = trackParCovD;
+          auto trackParCovPi = pion.trackParCov;
+          trackParCovDAtPV.propagateToDCA(primaryVertex, bz, &dcaD);
           trackParCovPi.propagateToDCA(primaryVertex, bz, &dcaPion);
 
           // get uncertainty of the decay length
@@ -312,11 +339,11 @@ struct HfCandidateCreatorB0 {
                            secondaryVertexB0[0], secondaryVertexB0[1], secondaryVertexB0[2],
                            errorDecayLength, errorDecayLengthXY,
                            chi2PCA,
-                           pVecD[0], pVecD[1], pVecD[2],
+                           pVecDAtB0[0], pVecDAtB0[1], pVecDAtB0[2],
                            pVecPion[0], pVecPion[1], pVecPion[2],
                            dcaD.getY(), dcaPion.getY(),
                            std::sqrt(dcaD.getSigmaY2()), std::sqrt(dcaPion.getSigmaY2()),
-                           candD.globalIndex(), trackPion.globalIndex(),
+                           candD.globalIndex(), pion.globalIndex,
                            hfFlag);
         } // pi loop
       }   // D loop
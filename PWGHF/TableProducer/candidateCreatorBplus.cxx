@@ -24,6 +24,7 @@
 #include "ReconstructionDataFormats/DCA.h"
 #include "ReconstructionDataFormats/V0.h"
 
+#include "Common/Core/PropagatorServices.h"
 #include "Common/Core/trackUtilities.h"
 #include "Common/DataModel/CollisionAssociationTables.h"
 
@@ -59,6 +60,8 @@ struct HfCandidateCreatorBplus {
   Configurable<std::vector<double>> binsPtPion{"binsPtPion", std::vector<double>{hf_cuts_single_track::vecBinsPtTrack}, "track pT bin limits for pion DCA XY pT-dependent cut"};
   Configurable<LabeledArray<double>> cutsTrackPionDCA{"cutsTrackPionDCA", {hf_cuts_single_track::cutsTrack[0], hf_cuts_single_track::nBinsPtTrack, hf_cuts_single_track::nCutVarsTrack, hf_cuts_single_track::labelsPtTrack, hf_cuts_single_track::labelsCutVarTrack}, "Single-track selections per pT bin for pions"};
   Configurable<double> invMassWindowBplus{"invMassWindowBplus", 0.3, "invariant-mass window for B^{+} candidates"};
+  Configurable<double> invMassWindowBplusPreFit{"invMassWindowBplusPreFit", 0.5, "invariant-mass window for D0-pi pairs before the B^{+} vertex fit, from the momenta at the D0 vertex and at the pion DCA (negative: no cut)"};
+  Configurable<double> cpaPreFitMin{"cpaPreFitMin", -2., "min. cosine of the angle between the D0-pi momentum and the primary-to-D0 vertex direction, before the B^{+} vertex fit"};
   Configurable<int> selectionFlagD0{"selectionFlagD0", 1, "Selection Flag for D0"};
   Configurable<int> selectionFlagD0bar{"selectionFlagD0bar", 1, "Selection Flag for D0bar"};
   Configurable<double> yCandMax{"yCandMax", -1., "max. cand. rapidity"};
@@ -87,6 +90,14 @@ struct HfCandidateCreatorBplus {
   Preslice<CandsDFiltered> candsDPerCollision = aod::track_association::collisionId;
   Preslice<aod::TrackAssoc> trackIndicesPerCollision = aod::track_association::collisionId;
 
+  struct PionCandidate {
+    int64_t globalIndex;
+    float eta;
+    std::array<float, 3> pVec;
+    o2::track::TrackParCov trackParCov;
+  };
+  std::array<std::vector<PionCandidate>, 2> pionsThisCollision; // negative and positive pions of the current collision
+
   OutputObj<TH1F> hCovPVXX{TH1F("hCovPVXX", "2-prong candidates;XX element of cov. matrix of prim. vtx. position (cm^{2});entries", 100, 0., 1.e-4)};
   OutputObj<TH1F> hCovSVXX{TH1F("hCovSVXX", "2-prong candidates;XX element of cov. matrix of sec. vtx. position (cm^{2});entries", 100, 0., 0.2)};
   OutputObj<TH1F> hRapidityD0{TH1F("hRapidityD0", "D0 candidates;#it{y};entries", 100, -2, 2)};
@@ -98,7 +109,7 @@ struct HfCandidateCreatorBplus {
     ccdb->setURL(ccdbUrl);
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
-    lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(ccdbPathLut));
+    lut = o2::common::propagator::getMatLut(ccdb, ccdbPathLut);
     runNumber = 0;
   }
 
@@ -172,6 +183,32 @@ struct HfCandidateCreatorBplus {
 
       auto thisCollId = collision.globalIndex();
       auto candsDThisColl = candsD.sliceBy(candsDPerCollision, thisCollId);
+      if (candsDThisColl.size() == 0) {
+        continue;
+      }
+
+      // select the pions of this collision once, for all its D0 candidates
+      pionsThisCollision[0].clear();
+      pionsThisCollision[1].clear();
+      auto trackIdsThisCollision = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
+      for (const auto& trackId : trackIdsThisCollision) { // start loop over track indices associated to this collision
+        auto trackPion = trackId.track_as<TracksWithSel>();
+
+        // check isGlobalTrackWoDCA status for pions if wanted
+        if (usePionIsGlobalTrackWoDCA && !trackPion.isGlobalTrackWoDCA()) {
+          continue;
+        }
+
+        // minimum pT selection
+        if (trackPion.pt() < ptPionMin || !isSelectedTrack(trackPion)) {
+          continue;
+        }
+
+        if (etaTrackMax >= 0. && std::abs(trackPion.eta()) > etaTrackMax) {
+          continue;
+        }
+        pionsThisCollision[trackPion.sign() > 0].push_back({trackPion.globalIndex(), trackPion.eta(), {trackPion.px(), trackPion.py(), trackPion.pz()}, getTrackParCov(trackPion)});
+      }
 
       // loop over pairs of track indices
       for (const auto& candD0 : candsDThisColl) {
@@ -225,96 +262,87 @@ struct HfCandidateCreatorBplus {
         int indexTrack0 = prong0.globalIndex();
         int indexTrack1 = prong1.globalIndex();
 
-        auto trackIdsThisCollision = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
-
-        // loop over tracks pi
-        for (const auto& trackId : trackIdsThisCollision) { // start loop over track indices associated to this collision
-          auto trackPion = trackId.track_as<TracksWithSel>();
-
-          // check isGlobalTrackWoDCA status for pions if wanted
-          if (usePionIsGlobalTrackWoDCA && !trackPion.isGlobalTrackWoDCA()) {
-            continue;
-          }
-
-          // Select D0pi- and D0(bar)pi+ pairs only
-          if (!((candD0.isSelD0() >= selectionFlagD0 && trackPion.sign() < 0) || (candD0.isSelD0bar() >= selectionFlagD0bar && trackPion.sign() > 0))) {
-            // Printf("D0: %d, D0bar%d, sign: %d", candD0.isSelD0(), candD0.isSelD0bar(), track.sign());
-            continue;
-          }
-
-          // minimum pT selection
-          if (trackPion.pt() < ptPionMin || !isSelectedTrack(trackPion)) {
-            continue;
-          }
-
-          if (indexTrack0 == trackPion.globalIndex() || indexTrack1 == trackPion.globalIndex()) {
-            continue; // different id between D0 daughters and bachelor track
-          }
-
-          if (etaTrackMax >= 0. && std::abs(trackPion.eta()) > etaTrackMax) {
-            continue;
-          }
-
-          hEtaPi->Fill(trackPion.eta());
-
-          auto trackParCovPi = getTrackParCov(trackPion);
-          std::array<float, 3> pVecD0 = {0., 0., 0.};
-          std::array<float, 3> pVecBach = {0., 0., 0.};
-          std::array<float, 3> pVecBCand = {0., 0., 0.};
-
-          // find the DCA between the D0 and the bachelor track, for B+
-          if (dfB.process(trackD0, trackParCovPi) == 0) {
-            continue;
-          }
-
-          dfB.propagateTracksToVertex();        // propagate the bachelor and D0 to the B+ vertex
-          trackD0.getPxPyPzGlo(pVecD0);         // momentum of D0 at the B+ vertex
-          trackParCovPi.getPxPyPzGlo(pVecBach); // momentum of pi+ at the B+ vertex
-
-          const auto& secVertexBplus = dfB.getPCACandidate();
-          auto chi2PCA = dfB.getChi2AtPCACandidate();
-          auto covMatrixPCA = dfB.calcPCACovMatrixFlat();
-          hCovSVXX->Fill(covMatrixPCA[0]); // FIXME: Calculation of errorDecayLength(XY) gives wrong values without this line.
-
-          pVecBCand = RecoDecay::pVec(pVecD0, pVecBach);
-
-          // get track impact parameters
-          // This modifies track momenta!
-          auto covMatrixPV = primaryVertex.getCov();
-          hCovPVXX->Fill(covMatrixPV[0]);
-          o2::dataformats::DCA impactParameter0;
-          o2::dataformats::DCA impactParameter1;
-          trackD0.propagateToDCA(primaryVertex, bz, &impactParameter0);
-          trackParCovPi.propagateToDCA(primaryVertex, bz, &impactParameter1);
-
-          // get uncertainty of the decay length
-          double phi, theta;
-          getPointDirection(array{collision.posX(), collision.posY(), collision.posZ()}, secVertexBplus, phi, theta);
-          auto errorDecayLength = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, theta) + getRotatedCovMatrixXX(covMatrixPCA, phi, theta));
-          auto errorDecayLengthXY = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, 0.) + getRotatedCovMatrixXX(covMatrixPCA, phi, 0.));
-
-          int hfFlag = 1 << hf_cand_bplus::DecayType::BplusToD0Pi;
-
-          // calculate invariant mass and fill the Invariant Mass control plot
-          massD0Pi = RecoDecay::m(array{pVecD0, pVecBach}, array{massD0, massPi});
-          if (std::abs(massD0Pi - massBplus) > invMassWindowBplus) {
+        // loop over tracks pi, D0pi- and D0(bar)pi+ pairs only
+        for (int sign = 0; sign < 2; ++sign) {
+          if (sign == 0 ? candD0.isSelD0() < selectionFlagD0 : candD0.isSelD0bar() < selectionFlagD0bar) {
             continue;
           }
-          hMassBplusToD0Pi->Fill(massD0Pi);
-
-          // fill candidate table rows
-          rowCandidateBase(collision.globalIndex(),
-                           collision.posX(), collision.posY(), collision.posZ(),
-                           secVertexBplus[0], secVertexBplus[1], secVertexBplus[2],
-                           errorDecayLength, errorDecayLengthXY,
-                           chi2PCA,
-                           pVecD0[0], pVecD0[1], pVecD0[2],
-                           pVecBach[0], pVecBach[1], pVecBach[2],
-                           impactParameter0.getY(), impactParameter1.getY(),
-                           std::sqrt(impactParameter0.getSigmaY2()), std::sqrt(impactParameter1.getSigmaY2()),
-                           candD0.globalIndex(), trackPion.globalIndex(), // index D0 and bachelor
-                           hfFlag);
-        } // track loop
+          for (const auto& pion : pionsThisCollision[sign]) {
+            if (indexTrack0 == pion.globalIndex || indexTrack1 == pion.globalIndex) {
+              continue; // different id between D0 daughters and bachelor track
+            }
+
+            hEtaPi->Fill(pion.eta);
+
+            // kinematic preselection of the pair, before the vertex fit
+            if (invMassWindowBplusPreFit >= 0. && std::abs(RecoDecay::m(array{pVecD, pion.pVec}, array{massD0, massPi}) - massBplus) > invMassWindowBplusPreFit) {
+              continue;
+            }
+            if (cpaPreFitMin > -1. && RecoDecay::cpa(array{collision.posX(), collision.posY(), collision.posZ()}, vertexD0, RecoDecay::pVec(pVecD, pion.pVec)) < cpaPreFitMin) {
+              continue;
+            }
+
+            // copies, so that the D0 and the pion are not moved for the next pairs
+            auto trackD0AtPV = trackD0;
+            auto trackParCovPi = pion.trackParCov;
+            std::array<float, 3> pVecD0 = {0., 0., 0.};
+            std::array<float, 3> pVecBach = {0., 0., 0.};
+            std::array<float, 3> pVecBCand = {0., 0., 0.};
+
+            // find the DCA between the D0 and the bachelor track, for B+
+            if (dfB.process(trackD0, trackParCovPi) == 0) {
+              continue;
+            }
+
+            dfB.propagateTracksToVertex();        // propagate the bachelor and D0 to the B+ vertex
+            trackD0.getPxPyPzGlo(pVecD0);         // momentum of D0 at the B+ vertex
+            trackParCovPi.getPxPyPzGlo(pVecBach); // momentum of pi+ at the B+ vertex
+
+            const auto& secVertexBplus = dfB.getPCACandidate();
+            auto chi2PCA = dfB.getChi2AtPCACandidate();
+            auto covMatrixPCA = dfB.calcPCACovMatrixFlat();
+            hCovSVXX->Fill(covMatrixPCA[0]); // FIXME: Calculation of errorDecayLength(XY) gives wrong values without this line.
+
+            pVecBCand = RecoDecay::pVec(pVecD0, pVecBach);
+
+            // get track impact parameters
+            // This modifies track momenta!
+            auto covMatrixPV = primaryVertex.getCov();
+            hCovPVXX->Fill(covMatrixPV[0]);
+            o2::dataformats::DCA impactParameter0;
+            o2::dataformats::DCA impactParameter1;
+            trackD0AtPV.propagateToDCA(primaryVertex, bz, &impactParameter0);
+            trackParCovPi.propagateToDCA(primaryVertex, bz, &impactParameter1);
+
+            // get uncertainty of the decay length
+            double phi, theta;
+            getPointDirection(array{collision.posX(), collision.posY(), collision.posZ()}, secVertexBplus, phi, theta);
+            auto errorDecayLength = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, theta) + getRotatedCovMatrixXX(covMatrixPCA, phi, theta));
+            auto errorDecayLengthXY = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, 0.) + getRotatedCovMatrixXX(covMatrixPCA, phi, 0.));
+
+            int hfFlag = 1 << hf_cand_bplus::DecayType::BplusToD0Pi;
+
+            // calculate invariant mass and fill the Invariant Mass control plot
+            massD0Pi = RecoDecay::m(array{pVecD0, pVecBach}, array{massD0, massPi});
+            if (std::abs(massD0Pi - massBplus) > invMassWindowBplus) {
+              continue;
+            }
+            hMassBplusToD0Pi->Fill(massD0Pi);
+
+            // fill candidate table rows
+            rowCandidateBase(collision.globalIndex(),
+                             collision.posX(), collision.posY(), collision.posZ(),
+                             secVertexBplus[0], secVertexBplus[1], secVertexBplus[2],
+                             errorDecayLength, errorDecayLengthXY,
+                             chi2PCA,
+                             pVecD0[0], pVecD0[1], pVecD0[2],
+                             pVecBach[0], pVecBach[1], pVecBach[2],
+                             impactParameter0.getY(), impactParameter1.getY(),
+                             std::sqrt(impactParameter0.getSigmaY2()), std::sqrt(impactParameter1.getSigmaY2()),
+                             candD0.globalIndex(), pion.globalIndex, // index D0 and bachelor
+                             hfFlag);
+          } // track loop
+        }   // pion sign loop
       }   // D0 cand loop
     }     // collision
   }       // process
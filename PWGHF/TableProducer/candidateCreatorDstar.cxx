@@ -40,21 +40,28 @@ struct HfCandidateCreatorDstar {
                aod::BigTracks const&,
                aod::Hf2Prongs const&)
   {
+    // D0 of the previous pair, reused by the consecutive pairs with the same D0
+    int64_t indexD0Previous = -1;
+    std::array<float, 3> pVecD0Prong0{}, pVecD0Prong1{}, pVecD0{};
+
     // loop over pairs of prong indices
     for (const auto& rowTrackIndexDstar : rowsTrackIndexDstar) {
       auto trackPi = rowTrackIndexDstar.prong0_as<aod::BigTracks>();
-      auto prongD0 = rowTrackIndexDstar.prongD0_as<aod::Hf2Prongs>();
-      auto trackD0Prong0 = prongD0.prong0_as<aod::BigTracks>();
-      auto trackD0Prong1 = prongD0.prong1_as<aod::BigTracks>();
       // auto collisionPiId = trackPi.collisionId();
       // auto collisionD0Id = trackD0Prong0.collisionId();
 
       // LOGF(info, "Pi collision %ld, D0 collision %ld", collisionPiId, collisionD0Id);
 
       std::array<float, 3> pVecPi = {trackPi.px(), trackPi.py(), trackPi.pz()};
-      std::array<float, 3> pVecD0Prong0 = {trackD0Prong0.px(), trackD0Prong0.py(), trackD0Prong0.pz()};
-      std::array<float, 3> pVecD0Prong1 = {trackD0Prong1.px(), trackD0Prong1.py(), trackD0Prong1.pz()};
-      auto pVecD0 = RecoDecay::pVec(pVecD0Prong0, pVecD0Prong1);
+      if (rowTrackIndexDstar.prongD0Id() != indexD0Previous) {
+        auto prongD0 = rowTrackIndexDstar.prongD0_as<aod::Hf2Prongs>();
+        auto trackD0Prong0 = prongD0.prong0_as<aod::BigTracks>();
+        auto trackD0Prong1 = prongD0.prong1_as<aod::BigTracks>();
+        pVecD0Prong0 = {trackD0Prong0.px(), trackD0Prong0.py(), trackD0Prong0.pz()};
+        pVecD0Prong1 = {trackD0Prong1.px(), trackD0Prong1.py(), trackD0Prong1.pz()};
+        pVecD0 = RecoDecay::pVec(pVecD0Prong0, pVecD0Prong1);
+        indexD0Previous = rowTrackIndexDstar.prongD0Id();
+      }
 
       // fill histograms
       if (fillHistograms) {
@@ -59,11 +59,22 @@ struct HfCandidateCreatorLb {
   Configurable<double> ptPionMin{"ptPionMin", 0.5, "minimum pion pT threshold (GeV/c)"};
   Configurable<int> selectionFlagLc{"selectionFlagLc", 1, "Selection Flag for Lc"};
   Configurable<double> yCandMax{"yCandMax", -1., "max. cand. rapidity"};
+  Configurable<double> invMassWindowLbPreFit{"invMassWindowLbPreFit", -1., "invariant-mass window for Lc-pi pairs before the Lb vertex fit, from the momenta of the tracks at their DCA (negative: no cut)"};
+  Configurable<double> cpaPreFitMin{"cpaPreFitMin", -2., "min. cosine of the angle between the Lc-pi momentum and the primary-to-Lc vertex direction, before the Lb vertex fit"};
 
   double massPi = RecoDecay::getMassPDG(kPiMinus);
   double massLc = RecoDecay::getMassPDG(pdg::Code::kLambdaCPlus);
+  double massLb = RecoDecay::getMassPDG(pdg::Code::kLambdaB0);
   double massLcPi = 0.;
 
+  struct PionCandidate {
+    int64_t globalIndex;
+    float pt;
+    std::array<float, 3> pVec;
+    o2::track::TrackParCov trackParCov;
+  };
+  std::vector<PionCandidate> pionsThisCollision; // negative pions of the current collision
+
   Filter filterSelectCandidates = (aod::hf_sel_candidate_lc::isSelLcToPKPi >= selectionFlagLc || aod::hf_sel_candidate_lc::isSelLcToPiKP >= selectionFlagLc);
 
   OutputObj<TH1F> hMassLcToPKPi{TH1F("hMassLcToPKPi", "#Lambda_{c}^{#plus} candidates;inv. mass (pK^{#minus} #pi^{#plus}) (GeV/#it{c}^{2});entries", 500, 0., 5.)};
@@ -102,6 +113,18 @@ struct HfCandidateCreatorLb {
     df3.setUseAbsDCA(useAbsDCA);
     df3.setWeightedFinalPCA(useWeightedFinalPCA);
 
+    // select the pions once, for all the Lc candidates
+    pionsThisCollision.clear();
+    for (auto& trackPion : tracks) {
+      if (trackPion.pt() < ptPionMin) {
+        continue;
+      }
+      if (trackPion.sign() > 0) {
+        continue;
+      }
+      pionsThisCollision.push_back({trackPion.globalIndex(), trackPion.pt(), {trackPion.px(), trackPion.py(), trackPion.pz()}, getTrackParCov(trackPion)});
+    }
+
     // loop over Lc candidates
     for (auto& lcCand : lcCands) {
       if (!(lcCand.hfflag() & 1 << o2::aod::hf_cand_3prong::DecayType::LcToPKPi)) {
@@ -145,22 +168,23 @@ struct HfCandidateCreatorLb {
       int index2Lc = track2.globalIndex();
       // int charge = track0.sign() + track1.sign() + track2.sign();
 
-      for (auto& trackPion : tracks) {
-        if (trackPion.pt() < ptPionMin) {
+      for (const auto& pion : pionsThisCollision) {
+        if (pion.globalIndex == index0Lc || pion.globalIndex == index1Lc || pion.globalIndex == index2Lc) {
           continue;
         }
-        if (trackPion.sign() > 0) {
+        hPtPion->Fill(pion.pt);
+        array<float, 3> pvecPion;
+
+        // kinematic preselection of the pair, before the vertex fit
+        if (invMassWindowLbPreFit >= 0. && std::abs(RecoDecay::m(array{pvecLc, pion.pVec}, array{massLc, massPi}) - massLb) > invMassWindowLbPreFit) {
           continue;
         }
-        if (trackPion.globalIndex() == index0Lc || trackPion.globalIndex() == index1Lc || trackPion.globalIndex() == index2Lc) {
+        if (cpaPreFitMin > -1. && RecoDecay::cpa(array{collision.posX(), collision.posY(), collision.posZ()}, secondaryVertex, RecoDecay::pVec(pvecLc, pion.pVec)) < cpaPreFitMin) {
           continue;
         }
-        hPtPion->Fill(trackPion.pt());
-        array<float, 3> pvecPion;
-        auto trackParVarPi = getTrackParCov(trackPion);
 
         // reconstruct the 3-prong Lc vertex
-        if (df2.process(trackLc, trackParVarPi) == 0) {
+        if (df2.process(trackLc, pion.trackParCov) == 0) {
           continue;
         }
 
@@ -169,15 +193,19 @@ struct HfCandidateCreatorLb {
         auto chi2PCA = df2.getChi2AtPCACandidate();
         auto covMatrixPCA = df2.calcPCACovMatrixFlat();
 
+        array<float, 3> pvecLcAtLb;
         df2.propagateTracksToVertex();
-        df2.getTrack(0).getPxPyPzGlo(pvecLc);
+        df2.getTrack(0).getPxPyPzGlo(pvecLcAtLb);
         df2.getTrack(1).getPxPyPzGlo(pvecPion);
 
         auto primaryVertex = getPrimaryVertex(collision);
         auto covMatrixPV = primaryVertex.getCov();
         o2::dataformats::DCA impactParameter0;
         o2::dataformats::DCA impactParameter1;
-        trackLc.propagateToDCA(primaryVertex, bz, &impactParameter0);
+        // copies, so that the Lc and the pion are not moved for the next pairs
+        auto trackLcAtPV = trackLc;
+        auto trackParVarPi = pion.trackParCov;
+        trackLcAtPV.propagateToDCA(primaryVertex, bz, &impactParameter0);
         trackParVarPi.propagateToDCA(primaryVertex, bz, &impactParameter1);
 
         hCovSVXX->Fill(covMatrixPCA[0]);
@@ -197,15 +225,15 @@ struct HfCandidateCreatorLb {
                          secondaryVertexLb[0], secondaryVertexLb[1], secondaryVertexLb[2],
                          errorDecayLength, errorDecayLengthXY,
                          chi2PCA,
-                         pvecLc[0], pvecLc[1], pvecLc[2],
+                         pvecLcAtLb[0], pvecLcAtLb[1], pvecLcAtLb[2],
                          pvecPion[0], pvecPion[1], pvecPion[2],
                          impactParameter0.getY(), impactParameter1.getY(),
                          std::sqrt(impactParameter0.getSigmaY2()), std::sqrt(impactParameter1.getSigmaY2()),
-                         lcCand.globalIndex(), trackPion.globalIndex(),
+                         lcCand.globalIndex(), pion.globalIndex,
                          hfFlag);
 
         // calculate invariant mass
-        auto arrayMomenta = array{pvecLc, pvecPion};
+        auto arrayMomenta = array{pvecLcAtLb, pvecPion};
         massLcPi = RecoDecay::m(std::move(arrayMomenta), array{massLc, massPi});
         if (lcCand.isSelLcToPKPi() > 0) {
           hMassLbToLcPi->Fill(massLcPi);
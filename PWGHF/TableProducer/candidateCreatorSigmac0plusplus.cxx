@@ -15,6 +15,9 @@
 ///
 /// \author Mattia Faggin <mfaggin@cern.ch>, University and INFN PADOVA
 
+#include <algorithm>
+#include <vector>
+
 #include "CCDB/BasicCCDBManager.h"             // for dca recalculation
 #include "DataFormatsParameters/GRPMagField.h" // for dca recalculation
 #include "DataFormatsParameters/GRPObject.h"   // for dca recalculation
@@ -24,6 +27,7 @@
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
 
+#include "Common/Core/PropagatorServices.h"
 #include "Common/Core/TrackSelection.h"
 #include "Common/Core/trackUtilities.h"
 #include "Common/DataModel/CollisionAssociationTables.h"
@@ -55,6 +59,9 @@ struct HfCandidateCreatorSigmac0plusplus {
   Configurable<float> softPiDcaXYMax{"softPiDcaXYMax", 0.065, "Soft pion max dcaXY (cm)"};
   Configurable<float> softPiDcaZMax{"softPiDcaZMax", 0.065, "Soft pion max dcaZ (cm)"};
 
+  /// Selection on the Σc0,++ candidate
+  Configurable<float> deltaMassMax{"deltaMassMax", -1.f, "max. M(pKpipi) - M(pKpi) for at least one of the selected Lc mass hypotheses (GeV/c^2), negative for no cut"};
+
   // CCDB
   Configurable<bool> isRun2Ccdb{"isRun2Ccdb", false, "enable Run 2 or Run 3 GRP objects for magnetic field"};
   Configurable<std::string> ccdbUrl{"ccdbUrl", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
@@ -84,6 +91,17 @@ struct HfCandidateCreatorSigmac0plusplus {
   o2::base::Propagator::MatCorrType noMatCorr = o2::base::Propagator::MatCorrType::USEMatCorrNONE;
   int runNumber;
 
+  /// Soft-pion candidates of the current collision, sorted by momentum
+  struct SoftPion {
+    int64_t globalIndex;
+    int sign;
+    float p;
+    float energy;
+    std::array<float, 3> pVec;
+  };
+  std::vector<SoftPion> softPionsThisCollision;
+  const double massPi = RecoDecay::getMassPDG(kPiPlus);
+
   /// @brief init function, to define the soft pion selections and histograms
   /// @param
   void init(InitContext&)
@@ -124,10 +142,54 @@ struct HfCandidateCreatorSigmac0plusplus {
     ccdb->setURL(ccdbUrl);
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
-    lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(ccdbPathLut));
+    lut = o2::common::propagator::getMatLut(ccdb, ccdbPathLut);
     runNumber = 0;
   }
 
+  /// @brief selection of the soft-pion candidates of a collision, sorted by increasing momentum
+  /// @param collision is the collision the tracks are associated to
+  /// @param trackIdsThisCollision are the indices of the tracks associated to the collision
+  template <typename TCollision, typename TTrackIds>
+  void selectSoftPions(TCollision const& collision, TTrackIds const& trackIdsThisCollision)
+  {
+    softPionsThisCollision.clear();
+    for (auto const& trackId : trackIdsThisCollision) {
+
+      auto trackSoftPi = trackId.template track_as<TracksSigmac>();
+      histos.fill(HIST("hCounter"), 4);
+
+      /// keep only soft-pion candidate tracks
+      /// if not selected, skip it and go to the next one
+      if (!softPiCuts.IsSelected(trackSoftPi)) {
+        continue;
+      }
+      /// dcaXY, dcaZ selections
+      /// To be done separately from the others, because for reassigned tracks the dca must be recalculated
+      /// TODO: to be properly adapted in case of PV refit usage
+      if (trackSoftPi.collisionId() == collision.globalIndex()) {
+        /// this is a track originally assigned to the current collision
+        /// therefore, the dcaXY, dcaZ are those already calculated in the track-propagation workflow
+        if (std::abs(trackSoftPi.dcaXY()) > softPiDcaXYMax || std::abs(trackSoftPi.dcaZ()) > softPiDcaZMax) {
+          continue;
+        }
+      } else {
+        /// this is a reassigned track
+        /// therefore we need to calculate the dcaXY, dcaZ with respect to this new primary vertex
+        auto bc = collision.template bc_as<o2::aod::BCsWithTimestamps>();
+        initCCDB(bc, runNumber, ccdb, isRun2Ccdb ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2Ccdb);
+        auto trackParSoftPi = getTrackPar(trackSoftPi);
+        o2::gpu::gpustd::array<float, 2> dcaInfo{-999., -999.};
+        o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParSoftPi, 2.f, noMatCorr, &dcaInfo);
+        if (std::abs(dcaInfo[0]) > softPiDcaXYMax || std::abs(dcaInfo[1]) > softPiDcaZMax) {
+          continue;
+        }
+      }
+      float p = trackSoftPi.p();
+      softPionsThisCollision.push_back({trackSoftPi.globalIndex(), trackSoftPi.sign(), p, static_cast<float>(std::sqrt(p * p + massPi * massPi)), {trackSoftPi.px(), trackSoftPi.py(), trackSoftPi.pz()}});
+    }
+    std::sort(softPionsThisCollision.begin(), softPionsThisCollision.end(), [](SoftPion const& a, SoftPion const& b) { return a.p < b.p; });
+  }
+
   /// @brief process function for Σc0,++ → Λc+(→pK-π+) π- candidate reconstruction considering also reassigned tracks for soft pions
   /// @param collision is a o2::aod::Collision
   /// @param tracks are the tracks (with dcaXY, dcaZ information) in the collision → soft-pion candidate tracks
@@ -138,6 +200,7 @@ struct HfCandidateCreatorSigmac0plusplus {
     for (auto const& collision : collisions) {
       histos.fill(HIST("hCounter"), 1);
       auto thisCollId = collision.globalIndex();
+      bool softPionsSelected = false;
 
       /// loop over Λc+ → pK-π+ (and charge conj.) candidates
       auto candidatesThisColl = candidates.sliceBy(hf3ProngPerCollision, thisCollId);
@@ -158,10 +221,11 @@ struct HfCandidateCreatorSigmac0plusplus {
         /// selection on the Λc+ inv. mass window we want to consider for Σc0,++ candidate creation
         auto statusSpreadMinvPKPiFromPDG = 0;
         auto statusSpreadMinvPiKPFromPDG = 0;
-        if (candLc.isSelLcToPKPi() >= 1 && std::abs(invMassLcToPKPi(candLc) - RecoDecay::getMassPDG(pdg::Code::kLambdaCPlus)) <= mPKPiCandLcMax) {
+        double massLcHyp[2] = {invMassLcToPKPi(candLc), invMassLcToPiKP(candLc)};
+        if (candLc.isSelLcToPKPi() >= 1 && std::abs(massLcHyp[0] - RecoDecay::getMassPDG(pdg::Code::kLambdaCPlus)) <= mPKPiCandLcMax) {
           statusSpreadMinvPKPiFromPDG = 1;
         }
-        if (candLc.isSelLcToPiKP() >= 1 && std::abs(invMassLcToPiKP(candLc) - RecoDecay::getMassPDG(pdg::Code::kLambdaCPlus)) <= mPiKPCandLcMax) {
+        if (candLc.isSelLcToPiKP() >= 1 && std::abs(massLcHyp[1] - RecoDecay::getMassPDG(pdg::Code::kLambdaCPlus)) <= mPiKPCandLcMax) {
           statusSpreadMinvPiKPFromPDG = 1;
         }
         if (statusSpreadMinvPKPiFromPDG == 0 && statusSpreadMinvPiKPFromPDG == 0) {
@@ -170,60 +234,67 @@ struct HfCandidateCreatorSigmac0plusplus {
         }
         histos.fill(HIST("hCounter"), 3);
 
-        /// loop over tracks
-        auto trackIdsThisCollision = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
-        for (auto const& trackId : trackIdsThisCollision) {
-
-          auto trackSoftPi = trackId.track_as<TracksSigmac>();
-          // auto trackSoftPi = tracks.rawIteratorAt(trackId.trackId());
-          histos.fill(HIST("hCounter"), 4);
+        /// select the soft pions of the collision once, at its first Λc+ candidate
+        if (!softPionsSelected) {
+          selectSoftPions(collision, trackIndices.sliceBy(trackIndicesPerCollision, thisCollId));
+          softPionsSelected = true;
+        }
 
-          /////////////////////////////////////////////////////////////////////////////////
-          ///                       Σc0,++ candidate creation                           ///
-          ///                                                                           ///
-          /// For each candidate Λc, let's loop over all the candidate soft-pion tracks ///
-          /////////////////////////////////////////////////////////////////////////////////
+        /// quantities of the Λc+ candidate shared by all its soft pions
+        int indexProng0 = candLc.prong0Id();
+        int indexProng1 = candLc.prong1Id();
+        int indexProng2 = candLc.prong2Id();
+        int chargeLc = candLc.prong0_as<TracksSigmac>().sign() + candLc.prong1_as<TracksSigmac>().sign() + candLc.prong2_as<TracksSigmac>().sign();
+        std::array<float, 3> pVecLc = {candLc.px(), candLc.py(), candLc.pz()};
+        double pLc = RecoDecay::p(pVecLc);
+        /// energy and velocity of the Λc+ for the mass hypotheses in the window, with the (positive) reconstructed mass
+        bool isHypInWindow[2] = {statusSpreadMinvPKPiFromPDG == 1, statusSpreadMinvPiKPFromPDG == 1};
+        double energyLcHyp[2], betaLcHyp[2];
+        for (int iHyp = 0; iHyp < 2; ++iHyp) {
+          energyLcHyp[iHyp] = std::sqrt(pLc * pLc + massLcHyp[iHyp] * massLcHyp[iHyp]);
+          betaLcHyp[iHyp] = pLc / energyLcHyp[iHyp];
+        }
 
-          /// keep only soft-pion candidate tracks
-          /// if not selected, skip it and go to the next one
-          if (!softPiCuts.IsSelected(trackSoftPi)) {
-            continue;
-          }
-          /// dcaXY, dcaZ selections
-          /// To be done separately from the others, because for reassigned tracks the dca must be recalculated
-          /// TODO: to be properly adapted in case of PV refit usage
-          if (trackSoftPi.collisionId() == thisCollId) {
-            /// this is a track originally assigned to the current collision
-            /// therefore, the dcaXY, dcaZ are those already calculated in the track-propagation workflow
-            if (std::abs(trackSoftPi.dcaXY()) > softPiDcaXYMax || std::abs(trackSoftPi.dcaZ()) > softPiDcaZMax) {
-              continue;
+        /////////////////////////////////////////////////////////////////////////////////
+        ///                       Σc0,++ candidate creation                           ///
+        ///                                                                           ///
+        /// For each candidate Λc, let's loop over all the candidate soft-pion tracks ///
+        /////////////////////////////////////////////////////////////////////////////////
+        for (auto const& softPi : softPionsThisCollision) {
+
+          /// Δm = M(pKππ) - M(pKπ) from the four-momenta, for the hypotheses in the mass window
+          if (deltaMassMax >= 0.f) {
+            bool isInDeltaMassWindow = false;
+            bool isAboveForAllMomenta = true;
+            double pLcPi = RecoDecay::dotProd(pVecLc, softPi.pVec);
+            for (int iHyp = 0; iHyp < 2; ++iHyp) {
+              if (!isHypInWindow[iHyp]) {
+                continue;
+              }
+              double constMass2 = massLcHyp[iHyp] * massLcHyp[iHyp] + massPi * massPi;
+              double deltaMass = std::sqrt(constMass2 + 2. * (energyLcHyp[iHyp] * softPi.energy - pLcPi)) - massLcHyp[iHyp];
+              isInDeltaMassWindow = isInDeltaMassWindow || deltaMass <= deltaMassMax;
+              /// the smallest Δm over the directions of the pion grows with its momentum once the pion is faster than the Λc+
+              double deltaMassMin = std::sqrt(constMass2 + 2. * (energyLcHyp[iHyp] * softPi.energy - pLc * softPi.p)) - massLcHyp[iHyp];
+              isAboveForAllMomenta = isAboveForAllMomenta && softPi.p > betaLcHyp[iHyp] * softPi.energy && deltaMassMin > deltaMassMax;
+            }
+            if (isAboveForAllMomenta) {
+              /// the soft pions are sorted by momentum, none of the next ones can be in the Δm window
+              break;
             }
-          } else {
-            /// this is a reassigned track
-            /// therefore we need to calculate the dcaXY, dcaZ with respect to this new primary vertex
-            auto bc = collision.bc_as<o2::aod::BCsWithTimestamps>();
-            initCCDB(bc, runNumber, ccdb, isRun2Ccdb ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2Ccdb);
-            auto trackParSoftPi = getTrackPar(trackSoftPi);
-            o2::gpu::gpustd::array<float, 2> dcaInfo{-999., -999.};
-            o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParSoftPi, 2.f, noMatCorr, &dcaInfo);
-            if (std::abs(dcaInfo[0]) > softPiDcaXYMax || std::abs(dcaInfo[1]) > softPiDcaZMax) {
+            if (!isInDeltaMassWindow) {
               continue;
             }
           }
 
           /// Exclude the current candidate soft pion if it corresponds already to a candidate Lc prong
-          int indexProng0 = candLc.prong0_as<aod::Tracks>().globalIndex();
-          int indexProng1 = candLc.prong1_as<aod::Tracks>().globalIndex();
-          int indexProng2 = candLc.prong2_as<aod::Tracks>().globalIndex();
-          int indexSoftPi = trackSoftPi.globalIndex();
-          if (indexSoftPi == indexProng0 || indexSoftPi == indexProng1 || indexSoftPi == indexProng2) {
+          if (softPi.globalIndex == indexProng0 || softPi.globalIndex == indexProng1 || softPi.globalIndex == indexProng2) {
             continue;
           }
           histos.fill(HIST("hCounter"), 5);
 
           /// determine the Σc candidate charge
-          int chargeLc = candLc.prong0_as<TracksSigmac>().sign() + candLc.prong1_as<TracksSigmac>().sign() + candLc.prong2_as<TracksSigmac>().sign();
-          int chargeSoftPi = trackSoftPi.sign();
+          int chargeSoftPi = softPi.sign;
           int8_t chargeSigmac = chargeLc + chargeSoftPi;
           if (std::abs(chargeSigmac) != 0 && std::abs(chargeSigmac) != 2) {
             /// this shall never happen
@@ -237,8 +308,8 @@ struct HfCandidateCreatorSigmac0plusplus {
                           candLc.collisionId(),
                           /* 2-prong specific columns */
                           candLc.px(), candLc.py(), candLc.pz(),
-                          trackSoftPi.px(), trackSoftPi.py(), trackSoftPi.pz(),
-                          candLc.globalIndex(), trackSoftPi.globalIndex(),
+                          softPi.pVec[0], softPi.pVec[1], softPi.pVec[2],
+                          candLc.globalIndex(), softPi.globalIndex,
                           candLc.hfflag(),
                           /* Σc0,++ specific columns */
                           chargeSigmac,
@@ -13,6 +13,8 @@
 /// \brief Reconstruction of Omegac0 and Xic0 -> xi pi candidates
 /// \author Federica Zanone <federica.zanone@cern.ch>, HEIDELBERG UNIVERSITY & GSI
 
+#include <vector>
+
 #include "CCDB/BasicCCDBManager.h"
 #include "DataFormatsParameters/GRPMagField.h"
 #include "DataFormatsParameters/GRPObject.h"
@@ -26,6 +28,7 @@
 #include "ReconstructionDataFormats/Track.h"
 #include "ReconstructionDataFormats/V0.h"
 
+#include "Common/Core/PropagatorServices.h"
 #include "Common/Core/RecoDecay.h"
 #include "Common/Core/trackUtilities.h"
 #include "Common/DataModel/CollisionAssociationTables.h"
@@ -84,6 +87,21 @@ struct HfCandidateCreatorToXiPi {
   o2::base::Propagator::MatCorrType matCorr = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
   int runNumber;
 
+  o2::vertexing::DCAFitterN<2> df; // 2-prong vertex fitter to build the omegac vertex
+
+  // pion candidates of a collision, prepared once and combined with all its cascades
+  struct PionCandidate {
+    int64_t globalIndex;
+    int collisionId;
+    int sign;
+    float eta;
+    bool hasPvRefit;                           // PV refitted without the track in trackIndexSkimCreator.cxx
+    o2::dataformats::VertexBase primaryVertex; // PV of the collision, or refitted one
+    o2::track::TrackParCov trackParCov;        // track parametrisation at the inner point
+    o2::dataformats::DCA impactParameter;      // impact parameter with respect to primaryVertex
+  };
+  std::vector<PionCandidate> pionCandidates;
+
   using SelectedCollisions = soa::Filtered<soa::Join<aod::Collisions, aod::HfSelCollision>>;
   using MyTracks = soa::Join<aod::BigTracks, aod::TracksDCA, aod::HfPvRefitTrack>;
   using FilteredHfTrackAssocSel = soa::Filtered<soa::Join<aod::TrackAssoc, aod::HfSelTrack>>;
@@ -104,8 +122,19 @@ struct HfCandidateCreatorToXiPi {
     ccdb->setURL(ccdbUrl);
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
-    lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(ccdbPathLut));
+    lut = o2::common::propagator::getMatLut(ccdb, ccdbPathLut);
     runNumber = 0;
+
+    df.setPropagateToPCA(propagateToPCA);
+    df.setMaxR(maxR);
+    df.setMaxDZIni(maxDZIni);
+    df.setMaxDXYIni(maxDXYIni);
+    df.setMinParamChange(minParamChange);
+    df.setMinRelChi2Change(minRelChi2Change);
+    df.setMaxChi2(maxChi2);
+    df.setUseAbsDCA(useAbsDCA);
+    df.setWeightedFinalPCA(useWeightedFinalPCA);
+    df.setRefitWithMatCorr(refitWithMatCorr);
   }
 
   void process(SelectedCollisions const& collisions,
@@ -116,6 +145,11 @@ struct HfCandidateCreatorToXiPi {
                MyV0Table const&,
                aod::V0sLinked const&)
   {
+    const double massPionFromPDG = RecoDecay::getMassPDG(kPiPlus);    // pdg code 211
+    const double massLambdaFromPDG = RecoDecay::getMassPDG(kLambda0); // pdg code 3122
+    const double massXiFromPDG = RecoDecay::getMassPDG(kXiMinus);     // pdg code 3312
+    const double massOmegacFromPDG = RecoDecay::getMassPDG(kOmegaC0); // pdg code 4332
+    const double massXicFromPDG = RecoDecay::getMassPDG(kXiCZero);    // pdg code 4132
 
     for (const auto& collision : collisions) {
 
@@ -123,29 +157,33 @@ struct HfCandidateCreatorToXiPi {
       auto bc = collision.bc_as<o2::aod::BCsWithTimestamps>();
       initCCDB(bc, runNumber, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2);
       auto magneticField = o2::base::Propagator::Instance()->getNominalBz(); // z component
-
-      // 2-prong vertex fitter to build the omegac vertex
-      o2::vertexing::DCAFitterN<2> df;
       df.setBz(magneticField);
-      df.setPropagateToPCA(propagateToPCA);
-      df.setMaxR(maxR);
-      df.setMaxDZIni(maxDZIni);
-      df.setMaxDXYIni(maxDXYIni);
-      df.setMinParamChange(minParamChange);
-      df.setMinRelChi2Change(minRelChi2Change);
-      df.setMaxChi2(maxChi2);
-      df.setUseAbsDCA(useAbsDCA);
-      df.setWeightedFinalPCA(useWeightedFinalPCA);
-      df.setRefitWithMatCorr(refitWithMatCorr);
-
-      double massPionFromPDG = RecoDecay::getMassPDG(kPiPlus);    // pdg code 211
-      double massLambdaFromPDG = RecoDecay::getMassPDG(kLambda0); // pdg code 3122
-      double massXiFromPDG = RecoDecay::getMassPDG(kXiMinus);     // pdg code 3312
-      double massOmegacFromPDG = RecoDecay::getMassPDG(kOmegaC0); // pdg code 4332
-      double massXicFromPDG = RecoDecay::getMassPDG(kXiCZero);    // pdg code 4132
 
-      // loop over cascades reconstructed by cascadebuilder.cxx
+      // primary vertex of the collision
+      auto primaryVertexColl = getPrimaryVertex(collision); // get the associated covariance matrix with auto covMatrixPV = primaryVertex.getCov();
       auto thisCollId = collision.globalIndex();
+
+      // prepare the pion candidates once, their parametrisation and impact parameter do not depend on the cascade
+      pionCandidates.clear();
+      auto groupedTrackIndices = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
+      for (auto const& trackIndexPion : groupedTrackIndices) {
+        auto trackPion = trackIndexPion.track_as<MyTracks>();
+        if (trackPion.sign() == 0) {
+          continue;
+        }
+        auto& pion = pionCandidates.emplace_back(PionCandidate{trackPion.globalIndex(), trackPion.collisionId(), trackPion.sign(), trackPion.eta(), false, primaryVertexColl, getTrackParCov(trackPion), {}});
+        if (doPvRefit && ((trackPion.pvRefitSigmaX2() != 1e10f) || (trackPion.pvRefitSigmaY2() != 1e10f) || (trackPion.pvRefitSigmaZ2() != 1e10f))) { // if I asked for PV refit in trackIndexSkimCreator.cxx
+          pion.hasPvRefit = true;
+          pion.primaryVertex.setX(trackPion.pvRefitX());
+          pion.primaryVertex.setY(trackPion.pvRefitY());
+          pion.primaryVertex.setZ(trackPion.pvRefitZ());
+          pion.primaryVertex.setCov(trackPion.pvRefitSigmaX2(), trackPion.pvRefitSigmaXY(), trackPion.pvRefitSigmaY2(), trackPion.pvRefitSigmaXZ(), trackPion.pvRefitSigmaYZ(), trackPion.pvRefitSigmaZ2());
+        }
+        auto trackParVarPiCopy = pion.trackParCov;
+        o2::base::Propagator::Instance()->propagateToDCABxByBz(pion.primaryVertex, trackParVarPiCopy, 2.f, matCorr, &pion.impactParameter);
+      }
+
+      // loop over cascades reconstructed by cascadebuilder.cxx
       auto groupedCascades = cascades.sliceBy(cascadesPerCollision, thisCollId);
 
       for (auto const& casc : groupedCascades) {
@@ -208,8 +246,6 @@ struct HfCandidateCreatorToXiPi {
         std::array<float, 3> pVecV0Dau0 = {casc.pxpos(), casc.pypos(), casc.pzpos()};
         std::array<float, 3> pVecV0Dau1 = {casc.pxneg(), casc.pyneg(), casc.pzneg()};
 
-        auto trackV0Copy = trackV0;
-
         //-----------------------------reconstruct cascade track-----------------------------
         // pseudorapidity
         double pseudorapPiFromCas = trackXiDauCharged.eta();
@@ -239,37 +275,39 @@ struct HfCandidateCreatorToXiPi {
 
         std::array<float, 3> pVecPionFromCasc = {casc.pxbach(), casc.pybach(), casc.pzbach()};
 
-        auto trackCascCopy = trackCasc;
+        // impact parameters of the cascade and of the V0 with respect to the PV of the collision, computed at the first pion without PV refit
+        o2::dataformats::DCA impactParameterCascColl;
+        o2::dataformats::DCA impactParameterV0Coll;
+        bool hasImpactParametersColl = false;
 
-        //-------------------combining cascade and pion tracks--------------------------
-        auto groupedTrackIndices = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
-        for (auto const& trackIndexPion : groupedTrackIndices) {
+        const int signXiDauCharged = trackXiDauCharged.sign();
+        const int64_t indexXiDauCharged = trackXiDauCharged.globalIndex();
+        const int64_t indexV0Dau0 = trackV0Dau0.globalIndex();
+        const int64_t indexV0Dau1 = trackV0Dau1.globalIndex();
+        const int collIdXiDauCharged = trackXiDauCharged.collisionId();
 
-          auto trackPion = trackIndexPion.track_as<MyTracks>();
+        //-------------------combining cascade and pion tracks--------------------------
+        for (auto const& pion : pionCandidates) {
 
-          if ((rejDiffCollTrack) && (trackXiDauCharged.collisionId() != trackPion.collisionId())) {
+          if ((rejDiffCollTrack) && (collIdXiDauCharged != pion.collisionId)) {
             continue;
           }
 
           // ask for opposite sign daughters (omegac daughters)
-          if (trackPion.sign() * trackXiDauCharged.sign() >= 0) {
+          if (pion.sign * signXiDauCharged >= 0) {
             continue;
           }
 
           // check not to take the same particle twice in the decay chain
-          if (trackPion.globalIndex() == trackXiDauCharged.globalIndex() || trackPion.globalIndex() == trackV0Dau0.globalIndex() || trackPion.globalIndex() == trackV0Dau1.globalIndex()) {
+          if (pion.globalIndex == indexXiDauCharged || pion.globalIndex == indexV0Dau0 || pion.globalIndex == indexV0Dau1) {
             continue;
           }
 
           // pseudorapidity
-          double pseudorapPiFromOme = trackPion.eta();
-
-          // primary pion track to be processed with DCAFitter
-          auto trackParVarPi = getTrackParCov(trackPion);
-          auto trackParVarPiCopy = trackParVarPi;
+          double pseudorapPiFromOme = pion.eta;
 
           // reconstruct omegac with DCAFitter
-          int nVtxFromFitterOmegac = df.process(trackCasc, trackParVarPi);
+          int nVtxFromFitterOmegac = df.process(trackCasc, pion.trackParCov);
           if (nVtxFromFitterOmegac == 0) {
             continue;
           }
@@ -302,20 +340,21 @@ struct HfCandidateCreatorToXiPi {
           float dcazV0Dau1 = trackV0Dau1.dcaZ();
           float dcazPiFromCasc = trackXiDauCharged.dcaZ();
 
-          // primary vertex of the collision
-          auto primaryVertex = getPrimaryVertex(collision); // get the associated covariance matrix with auto covMatrixPV = primaryVertex.getCov();
-          std::array<float, 3> pvCoord = {collision.posX(), collision.posY(), collision.posZ()};
+          // primary vertex of the collision, or refitted without the pion
+          auto const& primaryVertex = pion.primaryVertex;
+          std::array<float, 3> pvCoord = {primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ()};
 
-          if (doPvRefit && ((trackPion.pvRefitSigmaX2() != 1e10f) || (trackPion.pvRefitSigmaY2() != 1e10f) || (trackPion.pvRefitSigmaZ2() != 1e10f))) { // if I asked for PV refit in trackIndexSkimCreator.cxx
-            pvCoord[0] = trackPion.pvRefitX();
-            pvCoord[1] = trackPion.pvRefitY();
-            pvCoord[2] = trackPion.pvRefitZ();
+          // impact parameters
+          o2::dataformats::DCA impactParameterCasc;
+          o2::dataformats::DCA impactParameterV0;
+          o2::dataformats::DCA impactParameterOmegac;
+          auto const& impactParameterPrimaryPi = pion.impactParameter;
 
-            // o2::dataformats::VertexBase Pvtx;
-            primaryVertex.setX(trackPion.pvRefitX());
-            primaryVertex.setY(trackPion.pvRefitY());
-            primaryVertex.setZ(trackPion.pvRefitZ());
-            primaryVertex.setCov(trackPion.pvRefitSigmaX2(), trackPion.pvRefitSigmaXY(), trackPion.pvRefitSigmaY2(), trackPion.pvRefitSigmaXZ(), trackPion.pvRefitSigmaYZ(), trackPion.pvRefitSigmaZ2());
+          if (pion.hasPvRefit) {
+            auto trackCascCopy = trackCasc;
+            auto trackV0Copy = trackV0;
+            o2::base::Propagator::Instance()->propagateToDCABxByBz(primaryVertex, trackCascCopy, 2.f, matCorr, &impactParameterCasc);
+            o2::base::Propagator::Instance()->propagateToDCABxByBz(primaryVertex, trackV0Copy, 2.f, matCorr, &impactParameterV0);
 
             o2::dataformats::DCA impactParameterV0Dau0;
             o2::dataformats::DCA impactParameterV0Dau1;
@@ -329,16 +368,17 @@ struct HfCandidateCreatorToXiPi {
             dcazV0Dau0 = impactParameterV0Dau0.getZ();
             dcazV0Dau1 = impactParameterV0Dau1.getZ();
             dcazPiFromCasc = impactParameterPiFromCasc.getZ();
+          } else {
+            if (!hasImpactParametersColl) {
+              auto trackCascCopy = trackCasc;
+              auto trackV0Copy = trackV0;
+              o2::base::Propagator::Instance()->propagateToDCABxByBz(primaryVertexColl, trackCascCopy, 2.f, matCorr, &impactParameterCascColl);
+              o2::base::Propagator::Instance()->propagateToDCABxByBz(primaryVertexColl, trackV0Copy, 2.f, matCorr, &impactParameterV0Coll);
+              hasImpactParametersColl = true;
+            }
+            impactParameterCasc = impactParameterCascColl;
+            impactParameterV0 = impactParameterV0Coll;
           }
-
-          // impact parameters
-          o2::dataformats::DCA impactParameterCasc;
-          o2::dataformats::DCA impactParameterPrimaryPi;
-          o2::dataformats::DCA impactParameterV0;
-          o2::dataformats::DCA impactParameterOmegac;
-          o2::base::Propagator::Instance()->propagateToDCABxByBz(primaryVertex, trackCascCopy, 2.f, matCorr, &impactParameterCasc);
-          o2::base::Propagator::Instance()->propagateToDCABxByBz(primaryVertex, trackParVarPiCopy, 2.f, matCorr, &impactParameterPrimaryPi);
-          o2::base::Propagator::Instance()->propagateToDCABxByBz(primaryVertex, trackV0Copy, 2.f, matCorr, &impactParameterV0);
           o2::base::Propagator::Instance()->propagateToDCABxByBz(primaryVertex, trackOmegac, 2.f, matCorr, &impactParameterOmegac);
 
           // invariant mass under the hypothesis of particles ID corresponding to the decay chain
@@ -386,7 +426,7 @@ struct HfCandidateCreatorToXiPi {
                        vertexOmegacFromFitter[0], vertexOmegacFromFitter[1], vertexOmegacFromFitter[2],
                        vertexCasc[0], vertexCasc[1], vertexCasc[2],
                        vertexV0[0], vertexV0[1], vertexV0[2],
-                       trackXiDauCharged.sign(),
+                       signXiDauCharged,
                        chi2PCAOmegac, covVtxOmegac[0], covVtxOmegac[1], covVtxOmegac[2], covVtxOmegac[3], covVtxOmegac[4], covVtxOmegac[5],
                        covV0[0], covV0[1], covV0[2], covV0[3], covV0[4], covV0[5],
                        covCasc[0], covCasc[1], covCasc[2], covCasc[3], covCasc[4], covCasc[5],
@@ -402,7 +442,7 @@ struct HfCandidateCreatorToXiPi {
                        impactParameterV0.getY(), impactParameterV0.getZ(),
                        std::sqrt(impactParameterCasc.getSigmaY2()), std::sqrt(impactParameterPrimaryPi.getSigmaY2()), std::sqrt(impactParameterV0.getSigmaY2()),
                        v0Element.globalIndex(), v0Element.posTrackId(), v0Element.negTrackId(),
-                       casc.globalIndex(), trackPion.globalIndex(), trackXiDauCharged.globalIndex(),
+                       casc.globalIndex(), pion.globalIndex, indexXiDauCharged,
                        impactParameterOmegac.getY(), impactParameterOmegac.getZ(),
                        mLambda, mCasc, mOmegac,
                        cpaV0, cpaOmegac, cpaCasc, cpaxyV0, cpaxyOmegac, cpaxyCasc,
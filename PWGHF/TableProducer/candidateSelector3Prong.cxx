@@ -0,0 +1,440 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file candidateSelector3Prong.cxx
+/// \brief D± → π± K∓ π±, Ds± → K± K∓ π±, Λc± → p± K∓ π± and Ξc± → p± K∓ π± selections in one pass over the 3-prong candidates
+///
+/// The selections are the ones of candidateSelectorDplusToPiKPi, candidateSelectorDsToKKPi, candidateSelectorLc
+/// and candidateSelectorXicToPKPi, and the same selection tables are produced. Each candidate and its prongs are read
+/// once for all the hypotheses, and the PID statuses of the prongs are taken from the packed status word filled by
+/// track-pid-status-creator, shared by all the hypotheses.
+
+#include "Framework/AnalysisTask.h"
+#include "Framework/runDataProcessing.h"
+
+#include "Common/Core/TrackSelectorPID.h"
+
+#include "PWGHF/DataModel/CandidateReconstructionTables.h"
+#include "PWGHF/DataModel/CandidateSelectionTables.h"
+
+using namespace o2;
+using namespace o2::framework;
+using namespace o2::aod::hf_cand_3prong;
+
+/// Struct for applying the D+, Ds, Lc and Xic selection cuts
+struct HfCandidateSelector3Prong {
+  Produces<aod::HfSelDplusToPiKPi> hfSelDplusToPiKPiCandidate;
+  Produces<aod::HfSelDsToKKPi> hfSelDsToKKPiCandidate;
+  Produces<aod::HfSelLc> hfSelLcCandidate;
+  Produces<aod::HfSelXicToPKPi> hfSelXicToPKPiCandidate;
+
+  // D+ selections
+  struct : ConfigurableGroup {
+    Configurable<double> ptCandMin{"ptCandMinDplus", 1., "Lower bound of D+ candidate pT"};
+    Configurable<double> ptCandMax{"ptCandMaxDplus", 36., "Upper bound of D+ candidate pT"};
+    Configurable<bool> acceptPIDNotApplicable{"acceptPIDNotApplicableDplus", true, "Switch to accept Status::PIDNotApplicable [(NotApplicable for one detector) and (NotApplicable or Conditional for the other)] in D+ PID selection"};
+    Configurable<std::vector<double>> binsPt{"binsPtDplus", std::vector<double>{hf_cuts_dplus_to_pi_k_pi::vecBinsPt}, "D+ pT bin limits"};
+    Configurable<LabeledArray<double>> cuts{"cutsDplus", {hf_cuts_dplus_to_pi_k_pi::cuts[0], hf_cuts_dplus_to_pi_k_pi::nBinsPt, hf_cuts_dplus_to_pi_k_pi::nCutVars, hf_cuts_dplus_to_pi_k_pi::labelsPt, hf_cuts_dplus_to_pi_k_pi::labelsCutVar}, "D+ candidate selection per pT bin"};
+  } cfgDplus;
+  // Ds selections
+  struct : ConfigurableGroup {
+    Configurable<double> ptCandMin{"ptCandMinDs", 1., "Lower bound of Ds candidate pT"};
+    Configurable<double> ptCandMax{"ptCandMaxDs", 36., "Upper bound of Ds candidate pT"};
+    Configurable<std::vector<double>> binsPt{"binsPtDs", std::vector<double>{hf_cuts_ds_to_k_k_pi::vecBinsPt}, "Ds pT bin limits"};
+    Configurable<LabeledArray<double>> cuts{"cutsDs", {hf_cuts_ds_to_k_k_pi::cuts[0], hf_cuts_ds_to_k_k_pi::nBinsPt, hf_cuts_ds_to_k_k_pi::nCutVars, hf_cuts_ds_to_k_k_pi::labelsPt, hf_cuts_ds_to_k_k_pi::labelsCutVar}, "Ds candidate selection per pT bin"};
+  } cfgDs;
+  // Lc selections
+  struct : ConfigurableGroup {
+    Configurable<double> ptCandMin{"ptCandMinLc", 0., "Lower bound of Lc candidate pT"};
+    Configurable<double> ptCandMax{"ptCandMaxLc", 36., "Upper bound of Lc candidate pT"};
+    Configurable<bool> usePid{"usePidLc", true, "Bool to use or not the PID based on nSigma cut for Lc"};
+    Configurable<bool> usePidBayes{"usePidBayesLc", false, "Bool to use or not the Bayesian PID for Lc (needs the Bayesian statuses in track-pid-status-creator)"};
+    Configurable<bool> usePidTpcAndTof{"usePidTpcAndTofLc", false, "Bool to decide how to combine TPC and TOF PID for Lc: true = both (if present, only one otherwise); false = one is enough"};
+    Configurable<std::vector<double>> binsPt{"binsPtLc", std::vector<double>{hf_cuts_lc_to_p_k_pi::vecBinsPt}, "Lc pT bin limits"};
+    Configurable<LabeledArray<double>> cuts{"cutsLc", {hf_cuts_lc_to_p_k_pi::cuts[0], hf_cuts_lc_to_p_k_pi::nBinsPt, hf_cuts_lc_to_p_k_pi::nCutVars, hf_cuts_lc_to_p_k_pi::labelsPt, hf_cuts_lc_to_p_k_pi::labelsCutVar}, "Lc candidate selection per pT bin"};
+  } cfgLc;
+  // Xic selections
+  struct : ConfigurableGroup {
+    Configurable<double> ptCandMin{"ptCandMinXic", 0., "Lower bound of Xic candidate pT"};
+    Configurable<double> ptCandMax{"ptCandMaxXic", 36., "Upper bound of Xic candidate pT"};
+    Configurable<bool> usePid{"usePidXic", true, "Bool to use or not the PID for Xic"};
+    Configurable<double> decayLengthXYNormalisedMin{"decayLengthXYNormalisedMinXic", 3., "Min. normalised decay length XY of Xic candidates"};
+    Configurable<std::vector<double>> binsPt{"binsPtXic", std::vector<double>{hf_cuts_xic_to_p_k_pi::vecBinsPt}, "Xic pT bin limits"};
+    Configurable<LabeledArray<double>> cuts{"cutsXic", {hf_cuts_xic_to_p_k_pi::cuts[0], hf_cuts_xic_to_p_k_pi::nBinsPt, hf_cuts_xic_to_p_k_pi::nCutVars, hf_cuts_xic_to_p_k_pi::labelsPt, hf_cuts_xic_to_p_k_pi::labelsCutVar}, "Xic candidate selection per pT bin"};
+  } cfgXic;
+
+  using TracksWithPidStatus = soa::Join<aod::BigTracksPID, aod::HfPidStatusTrack>;
+
+  /// Candidate and prong quantities shared by the selections of all the hypotheses
+  struct CandidateInfo {
+    float pt;                      // candidate pT
+    float cpa;                     // cosine of pointing angle
+    float cpaXY;                   // cosine of pointing angle XY
+    float decayLength;             // decay length
+    float decayLengthXY;           // decay length XY
+    float decayLengthXYNormalised; // normalised decay length XY
+    float chi2PCA;                 // chi2 of the secondary vertex
+    float impactParameterXY;       // impact parameter XY of the candidate
+    std::array<float, 3> ptProngs; // pT of the prongs
+    std::array<uint64_t, 3> pid;   // packed PID statuses of the prongs
+  };
+
+  /// \return PID status of a prong for the given species and detector combination
+  static int getPid(const CandidateInfo& info, int prong, uint species, int detector)
+  {
+    return TrackSelectorPID::getPackedStatus(info.pid[prong], species, detector);
+  }
+
+  /// Combines the PID statuses of the three prongs of a hypothesis
+  /// \return 1 if all the prongs are accepted, 0 if at least one of them is rejected, -1 otherwise
+  static int combinePid(int pid0, int pid1, int pid2)
+  {
+    if (pid0 == TrackSelectorPID::Status::PIDAccepted && pid1 == TrackSelectorPID::Status::PIDAccepted && pid2 == TrackSelectorPID::Status::PIDAccepted) {
+      return 1;
+    }
+    if (pid0 == TrackSelectorPID::Status::PIDRejected || pid1 == TrackSelectorPID::Status::PIDRejected || pid2 == TrackSelectorPID::Status::PIDRejected) {
+      return 0;
+    }
+    return -1;
+  }
+
+  /// D+ → π+ K− π+ selection, as in candidateSelectorDplusToPiKPi
+  /// \return selection status
+  template <typename T>
+  int selectDplus(const T& candidate, const CandidateInfo& info)
+  {
+    int statusDplusToPiKPi = 0;
+    if (!TESTBIT(candidate.hfflag(), DecayType::DplusToPiKPi)) {
+      return statusDplusToPiKPi;
+    }
+    SETBIT(statusDplusToPiKPi, aod::SelectionStep::RecoSkims);
+
+    // topological selection
+    int pTBin = findBin(cfgDplus.binsPt, info.pt);
+    if (pTBin == -1) {
+      return statusDplusToPiKPi;
+    }
+    if (info.pt < cfgDplus.ptCandMin || info.pt > cfgDplus.ptCandMax) {
+      return statusDplusToPiKPi;
+    }
+    const auto& cuts = cfgDplus.cuts;
+    if (info.ptProngs[0] < cuts->get(pTBin, "pT Pi") || info.ptProngs[1] < cuts->get(pTBin, "pT K") || info.ptProngs[2] < cuts->get(pTBin, "pT Pi")) {
+      return statusDplusToPiKPi;
+    }
+    if (std::abs(invMassDplusToPiKPi(candidate) - RecoDecay::getMassPDG(pdg::Code::kDPlus)) > cuts->get(pTBin, "deltaM")) {
+      return statusDplusToPiKPi;
+    }
+    if (info.decayLength < cuts->get(pTBin, "decay length")) {
+      return statusDplusToPiKPi;
+    }
+    if (info.decayLengthXYNormalised < cuts->get(pTBin, "normalized decay length XY")) {
+      return statusDplusToPiKPi;
+    }
+    if (info.cpa < cuts->get(pTBin, "cos pointing angle")) {
+      return statusDplusToPiKPi;
+    }
+    if (info.cpaXY < cuts->get(pTBin, "cos pointing angle XY")) {
+      return statusDplusToPiKPi;
+    }
+    if (std::abs(candidate.maxNormalisedDeltaIP()) > cuts->get(pTBin, "max normalized deltaIP")) {
+      return statusDplusToPiKPi;
+    }
+    SETBIT(statusDplusToPiKPi, aod::SelectionStep::RecoTopol);
+
+    // track-level PID selection
+    const int pidDplusToPiKPi = combinePid(getPid(info, 0, o2::track::PID::Pion, TrackSelectorPID::PackedTpcAndTof),
+                                           getPid(info, 1, o2::track::PID::Kaon, TrackSelectorPID::PackedTpcAndTof),
+                                           getPid(info, 2, o2::track::PID::Pion, TrackSelectorPID::PackedTpcAndTof));
+    if ((!cfgDplus.acceptPIDNotApplicable && pidDplusToPiKPi != 1) || pidDplusToPiKPi == 0) {
+      return statusDplusToPiKPi;
+    }
+    SETBIT(statusDplusToPiKPi, aod::SelectionStep::RecoPID);
+    return statusDplusToPiKPi;
+  }
+
+  /// Ds → K K π selection of both mass hypotheses, as in candidateSelectorDsToKKPi
+  /// \param statusDsToKKPi is the selection status of the KKπ hypothesis
+  /// \param statusDsToPiKK is the selection status of the πKK hypothesis
+  template <typename T>
+  void selectDs(const T& candidate, const CandidateInfo& info, int& statusDsToKKPi, int& statusDsToPiKK)
+  {
+    statusDsToKKPi = 0;
+    statusDsToPiKK = 0;
+    if (!TESTBIT(candidate.hfflag(), DecayType::DsToKKPi)) {
+      return;
+    }
+    SETBIT(statusDsToKKPi, aod::SelectionStep::RecoSkims);
+    SETBIT(statusDsToPiKK, aod::SelectionStep::RecoSkims);
+
+    // topological selections independent from the daugther-mass hypothesis
+    int pTBin = findBin(cfgDs.binsPt, info.pt);
+    if (pTBin == -1) {
+      return;
+    }
+    if (info.pt < cfgDs.ptCandMin || info.pt > cfgDs.ptCandMax) {
+      return;
+    }
+    const auto& cuts = cfgDs.cuts;
+    if (info.decayLength < cuts->get(pTBin, "decay length")) {
+      return;
+    }
+    if (info.decayLengthXYNormalised < cuts->get(pTBin, "normalized decay length XY")) {
+      return;
+    }
+    if (info.cpa < cuts->get(pTBin, "cos pointing angle")) {
+      return;
+    }
+    if (info.cpaXY < cuts->get(pTBin, "cos pointing angle XY")) {
+      return;
+    }
+    if (std::abs(info.impactParameterXY) > cuts->get(pTBin, "impact parameter XY")) {
+      return;
+    }
+
+    // topological selections of the KKπ and πKK hypotheses
+    bool topolDsToKKPi = !(info.ptProngs[0] < cuts->get(pTBin, "pT K") || info.ptProngs[1] < cuts->get(pTBin, "pT K") || info.ptProngs[2] < cuts->get(pTBin, "pT Pi")) &&
+                         std::abs(invMassDsToKKPi(candidate) - RecoDecay::getMassPDG(pdg::Code::kDS)) <= cuts->get(pTBin, "deltaM") &&
+                         deltaMassPhiDsToKKPi(candidate) <= cuts->get(pTBin, "deltaM Phi") &&
+                         std::abs(cos3PiKDsToKKPi(candidate)) >= cuts->get(pTBin, "cos^3 theta_PiK");
+    bool topolDsToPiKK = !(info.ptProngs[1] < cuts->get(pTBin, "pT K") || info.ptProngs[2] < cuts->get(pTBin, "pT K") || info.ptProngs[0] < cuts->get(pTBin, "pT Pi")) &&
+                         std::abs(invMassDsToPiKK(candidate) - RecoDecay::getMassPDG(pdg::Code::kDS)) <= cuts->get(pTBin, "deltaM") &&
+                         deltaMassPhiDsToPiKK(candidate) <= cuts->get(pTBin, "deltaM Phi") &&
+                         std::abs(cos3PiKDsToPiKK(candidate)) >= cuts->get(pTBin, "cos^3 theta_PiK");
+    if (!topolDsToKKPi && !topolDsToPiKK) {
+      return;
+    }
+    if (topolDsToKKPi) {
+      SETBIT(statusDsToKKPi, aod::SelectionStep::RecoTopol);
+    }
+    if (topolDsToPiKK) {
+      SETBIT(statusDsToPiKK, aod::SelectionStep::RecoTopol);
+    }
+
+    // track-level PID selection
+    bool pidDsToKKPi = combinePid(getPid(info, 0, o2::track::PID::Kaon, TrackSelectorPID::PackedTpcOrTof),
+                                  getPid(info, 1, o2::track::PID::Kaon, TrackSelectorPID::PackedTpcOrTof),
+                                  getPid(info, 2, o2::track::PID::Pion, TrackSelectorPID::PackedTpcOrTof)) != 0;
+    bool pidDsToPiKK = combinePid(getPid(info, 0, o2::track::PID::Pion, TrackSelectorPID::PackedTpcOrTof),
+                                  getPid(info, 1, o2::track::PID::Kaon, TrackSelectorPID::PackedTpcOrTof),
+                                  getPid(info, 2, o2::track::PID::Kaon, TrackSelectorPID::PackedTpcOrTof)) != 0;
+    if (!pidDsToKKPi && !pidDsToPiKK) {
+      return;
+    }
+    if (pidDsToKKPi) {
+      SETBIT(statusDsToKKPi, aod::SelectionStep::RecoPID);
+    }
+    if (pidDsToPiKK) {
+      SETBIT(statusDsToPiKK, aod::SelectionStep::RecoPID);
+    }
+  }
+
+  /// Λc → p K π selection of both mass hypotheses, as in candidateSelectorLc
+  /// \param statusLcToPKPi is the selection status of the pKπ hypothesis: 0 - rejected, 1 - accepted
+  /// \param statusLcToPiKP is the selection status of the πKp hypothesis: 0 - rejected, 1 - accepted
+  template <typename T>
+  void selectLc(const T& candidate, const CandidateInfo& info, int& statusLcToPKPi, int& statusLcToPiKP)
+  {
+    statusLcToPKPi = 0;
+    statusLcToPiKP = 0;
+    if (!TESTBIT(candidate.hfflag(), DecayType::LcToPKPi)) {
+      return;
+    }
+
+    // conjugate-independent topological selection
+    int pTBin = findBin(cfgLc.binsPt, info.pt);
+    if (pTBin == -1) {
+      return;
+    }
+    if (info.pt < cfgLc.ptCandMin || info.pt >= cfgLc.ptCandMax) {
+      return;
+    }
+    const auto& cuts = cfgLc.cuts;
+    if (info.cpa <= cuts->get(pTBin, "cos pointing angle")) {
+      return;
+    }
+    if (info.chi2PCA > cuts->get(pTBin, "Chi2PCA")) {
+      return;
+    }
+    if (info.decayLength <= cuts->get(pTBin, "decay length")) {
+      return;
+    }
+
+    // conjugate-dependent topological selection
+    bool topolLcToPKPi = !(info.ptProngs[0] < cuts->get(pTBin, "pT p") || info.ptProngs[1] < cuts->get(pTBin, "pT K") || info.ptProngs[2] < cuts->get(pTBin, "pT Pi")) &&
+                         std::abs(invMassLcToPKPi(candidate) - RecoDecay::getMassPDG(pdg::Code::kLambdaCPlus)) <= cuts->get(pTBin, "m");
+    bool topolLcToPiKP = !(info.ptProngs[2] < cuts->get(pTBin, "pT p") || info.ptProngs[1] < cuts->get(pTBin, "pT K") || info.ptProngs[0] < cuts->get(pTBin, "pT Pi")) &&
+                         std::abs(invMassLcToPiKP(candidate) - RecoDecay::getMassPDG(pdg::Code::kLambdaCPlus)) <= cuts->get(pTBin, "m");
+    if (!topolLcToPKPi && !topolLcToPiKP) {
+      return;
+    }
+
+    // track-level PID selection
+    int pidLcToPKPi = 1;
+    int pidLcToPiKP = 1;
+    if (cfgLc.usePid) {
+      const int detector = cfgLc.usePidTpcAndTof ? TrackSelectorPID::PackedTpcAndTof : TrackSelectorPID::PackedTpcOrTof;
+      pidLcToPKPi = combinePid(getPid(info, 0, o2::track::PID::Proton, detector), getPid(info, 1, o2::track::PID::Kaon, detector), getPid(info, 2, o2::track::PID::Pion, detector));
+      pidLcToPiKP = combinePid(getPid(info, 0, o2::track::PID::Pion, detector), getPid(info, 1, o2::track::PID::Kaon, detector), getPid(info, 2, o2::track::PID::Proton, detector));
+    }
+    int pidBayesLcToPKPi = 1;
+    int pidBayesLcToPiKP = 1;
+    if (cfgLc.usePidBayes) {
+      const int detector = TrackSelectorPID::PackedBayes;
+      pidBayesLcToPKPi = combinePid(getPid(info, 0, o2::track::PID::Proton, detector), getPid(info, 1, o2::track::PID::Kaon, detector), getPid(info, 2, o2::track::PID::Pion, detector));
+      pidBayesLcToPiKP = combinePid(getPid(info, 0, o2::track::PID::Pion, detector), getPid(info, 1, o2::track::PID::Kaon, detector), getPid(info, 2, o2::track::PID::Proton, detector));
+    }
+    if (pidLcToPKPi == 0 && pidLcToPiKP == 0) {
+      return;
+    }
+    if (pidBayesLcToPKPi == 0 && pidBayesLcToPiKP == 0) {
+      return;
+    }
+
+    if (pidLcToPKPi != 0 && pidBayesLcToPKPi != 0 && topolLcToPKPi) {
+      statusLcToPKPi = 1; // identified as LcToPKPi
+    }
+    if (pidLcToPiKP != 0 && pidBayesLcToPiKP != 0 && topolLcToPiKP) {
+      statusLcToPiKP = 1; // identified as LcToPiKP
+    }
+  }
+
+  /// Ξc → p K π selection of both mass hypotheses, as in candidateSelectorXicToPKPi
+  /// \param statusXicToPKPi is the selection status of the pKπ hypothesis: 0 - rejected, 1 - accepted
+  /// \param statusXicToPiKP is the selection status of the πKp hypothesis: 0 - rejected, 1 - accepted
+  template <typename T>
+  void selectXic(const T& candidate, const CandidateInfo& info, int& statusXicToPKPi, int& statusXicToPiKP)
+  {
+    statusXicToPKPi = 0;
+    statusXicToPiKP = 0;
+    if (!TESTBIT(candidate.hfflag(), DecayType::XicToPKPi)) {
+      return;
+    }
+
+    // conjugate-independent topological selection
+    int pTBin = findBin(cfgXic.binsPt, info.pt);
+    if (pTBin == -1) {
+      return;
+    }
+    if (info.pt < cfgXic.ptCandMin || info.pt >= cfgXic.ptCandMax) {
+      return;
+    }
+    const auto& cuts = cfgXic.cuts;
+    if (info.cpa <= cuts->get(pTBin, "cos pointing angle")) {
+      return;
+    }
+    if (info.chi2PCA > cuts->get(pTBin, "chi2PCA")) {
+      return;
+    }
+    if (info.decayLength <= cuts->get(pTBin, "decay length")) {
+      return;
+    }
+    if (info.decayLengthXY <= cuts->get(pTBin, "decLengthXY")) {
+      return;
+    }
+    if (info.decayLengthXYNormalised < cuts->get(pTBin, "normDecLXY")) {
+      return;
+    }
+    if (info.decayLengthXYNormalised < cfgXic.decayLengthXYNormalisedMin) {
+      return;
+    }
+    if (ctXic(candidate) > cuts->get(pTBin, "ct")) {
+      return;
+    }
+    if (std::abs(info.impactParameterXY) > cuts->get(pTBin, "impParXY")) {
+      return;
+    }
+
+    // conjugate-dependent topological selection
+    bool topolXicToPKPi = !(info.ptProngs[0] < cuts->get(pTBin, "pT p") || info.ptProngs[1] < cuts->get(pTBin, "pT K") || info.ptProngs[2] < cuts->get(pTBin, "pT Pi")) &&
+                          std::abs(invMassXicToPKPi(candidate) - RecoDecay::getMassPDG(pdg::Code::kXiCPlus)) <= cuts->get(pTBin, "m");
+    bool topolXicToPiKP = !(info.ptProngs[2] < cuts->get(pTBin, "pT p") || info.ptProngs[1] < cuts->get(pTBin, "pT K") || info.ptProngs[0] < cuts->get(pTBin, "pT Pi")) &&
+                          std::abs(invMassXicToPiKP(candidate) - RecoDecay::getMassPDG(pdg::Code::kXiCPlus)) <= cuts->get(pTBin, "m");
+    if (!topolXicToPKPi && !topolXicToPiKP) {
+      return;
+    }
+
+    // track-level PID selection
+    int pidXicToPKPi = 1;
+    int pidXicToPiKP = 1;
+    if (cfgXic.usePid) {
+      const int detector = TrackSelectorPID::PackedTpcOrTof;
+      pidXicToPKPi = combinePid(getPid(info, 0, o2::track::PID::Proton, detector), getPid(info, 1, o2::track::PID::Kaon, detector), getPid(info, 2, o2::track::PID::Pion, detector));
+      pidXicToPiKP = combinePid(getPid(info, 0, o2::track::PID::Pion, detector), getPid(info, 1, o2::track::PID::Kaon, detector), getPid(info, 2, o2::track::PID::Proton, detector));
+    }
+    if (pidXicToPKPi == 0 && pidXicToPiKP == 0) {
+      return;
+    }
+
+    if (pidXicToPKPi != 0 && topolXicToPKPi) {
+      statusXicToPKPi = 1; // identified as Xic->pKpi
+    }
+    if (pidXicToPiKP != 0 && topolXicToPiKP) {
+      statusXicToPiKP = 1; // identified as Xic->piKp
+    }
+  }
+
+  void process(aod::HfCand3Prong const& candidates, TracksWithPidStatus const&)
+  {
+    constexpr int kMaskSelected = BIT(DecayType::DplusToPiKPi) | BIT(DecayType::DsToKKPi) | BIT(DecayType::LcToPKPi) | BIT(DecayType::XicToPKPi);
+
+    hfSelDplusToPiKPiCandidate.reserve(candidates.size());
+    hfSelDsToKKPiCandidate.reserve(candidates.size());
+    hfSelLcCandidate.reserve(candidates.size());
+    hfSelXicToPKPiCandidate.reserve(candidates.size());
+
+    // looping over 3-prong candidates
+    for (const auto& candidate : candidates) {
+
+      // final selection flags
+      int statusDplusToPiKPi = 0;
+      int statusDsToKKPi = 0;
+      int statusDsToPiKK = 0;
+      int statusLcToPKPi = 0;
+      int statusLcToPiKP = 0;
+      int statusXicToPKPi = 0;
+      int statusXicToPiKP = 0;
+
+      if (candidate.hfflag() & kMaskSelected) {
+        auto trackPos1 = candidate.prong0_as<TracksWithPidStatus>(); // positive daughter (negative for the antiparticles)
+        auto trackNeg = candidate.prong1_as<TracksWithPidStatus>();  // negative daughter (positive for the antiparticles)
+        auto trackPos2 = candidate.prong2_as<TracksWithPidStatus>(); // positive daughter (negative for the antiparticles)
+
+        CandidateInfo info{};
+        info.pt = candidate.pt();
+        info.cpa = candidate.cpa();
+        info.cpaXY = candidate.cpaXY();
+        info.decayLength = candidate.decayLength();
+        info.decayLengthXY = candidate.decayLengthXY();
+        info.decayLengthXYNormalised = candidate.decayLengthXYNormalised();
+        info.chi2PCA = candidate.chi2PCA();
+        info.impactParameterXY = candidate.impactParameterXY();
+        info.ptProngs = {trackPos1.pt(), trackNeg.pt(), trackPos2.pt()};
+        info.pid = {trackPos1.pidStatus(), trackNeg.pidStatus(), trackPos2.pidStatus()};
+
+        statusDplusToPiKPi = selectDplus(candidate, info);
+        selectDs(candidate, info, statusDsToKKPi, statusDsToPiKK);
+        selectLc(candidate, info, statusLcToPKPi, statusLcToPiKP);
+        selectXic(candidate, info, statusXicToPKPi, statusXicToPiKP);
+      }
+
+      hfSelDplusToPiKPiCandidate(statusDplusToPiKPi);
+      hfSelDsToKKPiCandidate(statusDsToKKPi, statusDsToPiKK);
+      hfSelLcCandidate(statusLcToPKPi, statusLcToPiKP);
+      hfSelXicToPKPiCandidate(statusXicToPKPi, statusXicToPiKP);
+    }
+  }
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{
+    adaptAnalysisTask<HfCandidateSelector3Prong>(cfgc)};
+}
@@ -57,6 +57,10 @@ struct HfCandidateSelectorDplusToPiKPi {
 
   void init(InitContext const&)
   {
+    if (doprocessNoPidStatus && doprocessWithPidStatus) {
+      LOGP(fatal, "Only one process function between processNoPidStatus and processWithPidStatus can be enabled at a time.");
+    }
+
     selectorPion.setPDG(kPiPlus);
     selectorPion.setRangePtTPC(ptPidTpcMin, ptPidTpcMax);
     selectorPion.setRangeNSigmaTPC(-nSigmaTpcMax, nSigmaTpcMax);
@@ -164,7 +168,11 @@ struct HfCandidateSelectorDplusToPiKPi {
     return true;
   }
 
-  void process(aod::HfCand3Prong const& candidates, aod::BigTracksPID const&)
+  /// Candidate selection loop
+  /// \tparam usePidStatus  take the PID statuses of the prongs from the HfPidStatusTrack table instead of evaluating them here
+  /// \param candidates  3-prong candidates
+  template <bool usePidStatus, typename TTracks>
+  void runSelection(aod::HfCand3Prong const& candidates)
   {
     // looping over 3-prong candidates
     for (auto& candidate : candidates) {
@@ -186,9 +194,9 @@ struct HfCandidateSelectorDplusToPiKPi {
         registry.fill(HIST("hSelections"), 2 + aod::SelectionStep::RecoSkims, ptCand);
       }
 
-      auto trackPos1 = candidate.prong0_as<aod::BigTracksPID>(); // positive daughter (negative for the antiparticles)
-      auto trackNeg = candidate.prong1_as<aod::BigTracksPID>();  // negative daughter (positive for the antiparticles)
-      auto trackPos2 = candidate.prong2_as<aod::BigTracksPID>(); // positive daughter (negative for the antiparticles)
+      auto trackPos1 = candidate.template prong0_as<TTracks>(); // positive daughter (negative for the antiparticles)
+      auto trackNeg = candidate.template prong1_as<TTracks>();  // negative daughter (positive for the antiparticles)
+      auto trackPos2 = candidate.template prong2_as<TTracks>(); // positive daughter (negative for the antiparticles)
 
       /*
       // daughter track validity selection
@@ -211,9 +219,16 @@ struct HfCandidateSelectorDplusToPiKPi {
       }
 
       // track-level PID selection
-      int pidTrackPos1Pion = selectorPion.getStatusTrackPIDTpcAndTof(trackPos1);
-      int pidTrackNegKaon = selectorKaon.getStatusTrackPIDTpcAndTof(trackNeg);
-      int pidTrackPos2Pion = selectorPion.getStatusTrackPIDTpcAndTof(trackPos2);
+      int pidTrackPos1Pion, pidTrackNegKaon, pidTrackPos2Pion;
+      if constexpr (usePidStatus) {
+        pidTrackPos1Pion = TrackSelectorPID::getPackedStatus(trackPos1.pidStatus(), o2::track::PID::Pion, TrackSelectorPID::PackedTpcAndTof);
+        pidTrackNegKaon = TrackSelectorPID::getPackedStatus(trackNeg.pidStatus(), o2::track::PID::Kaon, TrackSelectorPID::PackedTpcAndTof);
+        pidTrackPos2Pion = TrackSelectorPID::getPackedStatus(trackPos2.pidStatus(), o2::track::PID::Pion, TrackSelectorPID::PackedTpcAndTof);
+      } else {
+        pidTrackPos1Pion = selectorPion.getStatusTrackPIDTpcAndTof(trackPos1);
+        pidTrackNegKaon = selectorKaon.getStatusTrackPIDTpcAndTof(trackNeg);
+        pidTrackPos2Pion = selectorPion.getStatusTrackPIDTpcAndTof(trackPos2);
+      }
 
       if (!selectionPID(pidTrackPos1Pion, pidTrackNegKaon, pidTrackPos2Pion)) { // exclude D±
         hfSelDplusToPiKPiCandidate(statusDplusToPiKPi);
@@ -227,6 +242,19 @@ struct HfCandidateSelectorDplusToPiKPi {
       hfSelDplusToPiKPiCandidate(statusDplusToPiKPi);
     }
   }
+
+  void processNoPidStatus(aod::HfCand3Prong const& candidates, aod::BigTracksPID const&)
+  {
+    runSelection<false, aod::BigTracksPID>(candidates);
+  }
+  PROCESS_SWITCH(HfCandidateSelectorDplusToPiKPi, processNoPidStatus, "Evaluate the PID of the prongs in the selector", true);
+
+  /// PID statuses from the table filled by track-pid-status-creator, the PID configurables of this task are not used
+  void processWithPidStatus(aod::HfCand3Prong const& candidates, soa::Join<aod::BigTracksPID, aod::HfPidStatusTrack> const&)
+  {
+    runSelection<true, soa::Join<aod::BigTracksPID, aod::HfPidStatusTrack>>(candidates);
+  }
+  PROCESS_SWITCH(HfCandidateSelectorDplusToPiKPi, processWithPidStatus, "Use the shared per-track PID status table", false);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
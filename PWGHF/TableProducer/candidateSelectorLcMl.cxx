@@ -69,11 +69,29 @@ struct HfCandidateSelectorLcMl {
   Configurable<std::string> mlModelPathCCDB{"mlModelPathCCDB", "Analysis/PWGHF/ML/HFTrigger/Lc", "Path on CCDB"};
   Configurable<int64_t> timestampCCDB{"timestampCCDB", -1, "timestamp of the ONNX file for ML model used to query in CCDB. Exceptions: > 0 for the specific timestamp, 0 gets the run dependent timestamp"};
   Configurable<bool> loadModelsFromCCDB{"loadModelsFromCCDB", false, "Flag to enable or disable the loading of models from CCDB"};
+  Configurable<int> nIntraOpThreadsML{"nIntraOpThreadsML", 1, "Number of threads used inside each operator of the ML model"};
+  Configurable<int> nInterOpThreadsML{"nInterOpThreadsML", 0, "Number of threads used to run independent operators of the ML model in parallel (0: sequential)"};
+  Configurable<bool> shareSessionML{"shareSessionML", false, "Share the ONNX runtime environment and session with the other tasks of the workflow using the same model"};
+  Configurable<bool> applyMLBatch{"applyMLBatch", true, "Score all the preselected candidates of the data frame in batched inference calls instead of one call per candidate"};
+  Configurable<int64_t> maxBatchSizeML{"maxBatchSizeML", 0, "Maximum number of candidates scored in one inference call in batch mode (0: all the candidates of the data frame at once)"};
 
   Configurable<int> activateQA{"activateQA", 0, "flag to enable QA histos (0 no QA, 1 basic QA, 2 extended QA)"};
   HistogramRegistry registry{"registry", {}, OutputObjHandlingPolicy::AnalysisObject, true, true};
   int dataTypeML;
   OnnxModel model;
+  // Buffers bound to the model, reused for every candidate
+  std::vector<float> inputFeaturesF;
+  std::vector<float> scoresF;
+  std::vector<double> inputFeaturesD;
+  std::vector<double> scoresD;
+  // Buffers for the batched evaluation, reused across data frames
+  std::vector<float> batchFeaturesF;
+  std::vector<float> batchScoresF;
+  std::vector<double> batchFeaturesD;
+  std::vector<double> batchScoresD;
+  std::vector<int> statusesLcToPKPi; // selection flags of the data frame candidates, filled in candidate order
+  std::vector<int> statusesLcToPiKP; // selection flags of the data frame candidates, filled in candidate order
+  std::vector<int64_t> candidatesML; // positions of the candidates scored in batch mode
 
   using TrksPID = soa::Join<aod::BigTracksPIDExtended, aod::pidBayesPi, aod::pidBayesKa, aod::pidBayesPr, aod::pidBayes>;
 
@@ -93,15 +111,17 @@ struct HfCandidateSelectorLcMl {
     std::map<std::string, std::string> headers;
     bool retrieveSuccess = true;
     if (applyML) {
+      model.setInterOpThreads(nInterOpThreadsML);
+      model.setShareSession(shareSessionML);
       if (onnxFileLcToPiKPConf.value == "") {
         LOG(error) << "Apply ML specified, but no name given to the local model file";
       }
       if (loadModelsFromCCDB && timestampCCDB > 0) {
         retrieveSuccess = ccdbApi.retrieveBlob(mlModelPathCCDB.value, ".", metadata, timestampCCDB.value, false, onnxFileLcToPiKPConf.value);
         headers = ccdbApi.retrieveHeaders(mlModelPathCCDB.value, metadata, timestampCCDB.value);
-        model.initModel(onnxFileLcToPiKPConf.value, false, 1, strtoul(headers["Valid-From"].c_str(), NULL, 0), strtoul(headers["Valid-Until"].c_str(), NULL, 0));
+        model.initModel(onnxFileLcToPiKPConf.value, false, nIntraOpThreadsML, strtoul(headers["Valid-From"].c_str(), NULL, 0), strtoul(headers["Valid-Until"].c_str(), NULL, 0));
       } else if (!loadModelsFromCCDB) {
-        model.initModel(onnxFileLcToPiKPConf.value, false, 1);
+        model.initModel(onnxFileLcToPiKPConf.value, false, nIntraOpThreadsML);
       } else {
         LOG(error) << "Retrieving model based on current run number not implemented yet... But anyways it is just a single model!";
       }
@@ -115,12 +135,72 @@ struct HfCandidateSelectorLcMl {
         std::vector<float> dummyInput(model.getNumInputNodes(), 1.);
         model.evalModel(dummyInput); // Init the model evaluations
         dataTypeML = session->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetElementType();
+        if (dataTypeML == 1) {
+          model.bindBuffers(inputFeaturesF, scoresF);
+        } else if (dataTypeML == 11) {
+          model.bindBuffers(inputFeaturesD, scoresD);
+        }
       } else {
         LOG(fatal) << "Error encountered while fetching/loading the ML model from CCDB! Maybe the ML model doesn't exist yet for this runnumber/timestamp?";
       }
     }
   }
 
+  /// Applies the BDT score thresholds and fills the QA histograms
+  /// \param scores BDT scores (background, prompt, non-prompt)
+  /// \param statusLcToPKPi selection flag of the pKpi hypothesis
+  /// \param statusLcToPiKP selection flag of the piKp hypothesis
+  template <typename T>
+  void applyScores(const T* scores, int& statusLcToPKPi, int& statusLcToPiKP)
+  {
+    if (scores[0] > thresholdBDTScoreLcToPiKP.value.get(0u, "BDTbkg")) {
+      // background
+      statusLcToPKPi = 0;
+      statusLcToPiKP = 0;
+    }
+    // This is an equivalent to the cut above but it depends on the thresholds set
+    if (scores[1] <= thresholdBDTScoreLcToPiKP.value.get(0u, "BDTprompt") &&
+        scores[2] <= thresholdBDTScoreLcToPiKP.value.get(0u, "BDTnonprompt")) {
+      statusLcToPKPi = 0;
+      statusLcToPiKP = 0;
+    }
+    if (scores[1] > thresholdBDTScoreLcToPiKP.value.get(0u, "BDTprompt")) {
+      // prompt
+    }
+    if (scores[2] > thresholdBDTScoreLcToPiKP.value.get(0u, "BDTnonprompt")) {
+      // non-prompt
+      // NOTE: Can be both prompt and non-prompt!
+    }
+    if (activateQA != 0) {
+      registry.fill(HIST("hLcBDTScoreBkg"), scores[0]);
+      registry.fill(HIST("hLcBDTScorePrompt"), scores[1]);
+      registry.fill(HIST("hLcBDTScoreNonPrompt"), scores[2]);
+    }
+  }
+
+  /// Scores the candidates collected in batch mode and applies the thresholds
+  /// \param features features of the collected candidates, one row per candidate
+  /// \param scores buffer for the scores
+  template <typename T>
+  void scoreBatch(std::vector<T>& features, std::vector<T>& scores)
+  {
+    if (candidatesML.empty()) {
+      return;
+    }
+    if (!model.evalModelBatched(features, scores, maxBatchSizeML.value)) {
+      LOG(error) << "Error running batched model inference for Lc.";
+      const T defaultScores[3] = {-1, -1, -1};
+      for (const auto& iCand : candidatesML) {
+        applyScores(defaultScores, statusesLcToPKPi[iCand], statusesLcToPiKP[iCand]);
+      }
+      return;
+    }
+    const std::size_t nScores = scores.size() / candidatesML.size();
+    for (std::size_t i = 0; i < candidatesML.size(); i++) {
+      applyScores(scores.data() + i * nScores, statusesLcToPKPi[candidatesML[i]], statusesLcToPiKP[candidatesML[i]]);
+    }
+  }
+
   /*
   /// Selection on goodness of daughter tracks
   /// \note should be applied at candidate selection
@@ -154,6 +234,21 @@ struct HfCandidateSelectorLcMl {
     TrackSelectorPID selectorProton(selectorPion);
     selectorProton.setPDG(kProton);
 
+    const bool batchML = applyML && applyMLBatch && (dataTypeML == 1 || dataTypeML == 11);
+    statusesLcToPKPi.clear();
+    statusesLcToPiKP.clear();
+    statusesLcToPKPi.reserve(candidates.size());
+    statusesLcToPiKP.reserve(candidates.size());
+    candidatesML.clear();
+    batchFeaturesF.clear();
+    batchFeaturesD.clear();
+
+    // the selection flags are stored and the table is filled at the end, once the batched scores are available
+    auto fillCandidate = [this](int statusLcToPKPi, int statusLcToPiKP) {
+      statusesLcToPKPi.push_back(statusLcToPKPi);
+      statusesLcToPiKP.push_back(statusLcToPiKP);
+    };
+
     // looping over 3-prong candidates
     for (auto& candidate : candidates) {
 
@@ -162,7 +257,7 @@ struct HfCandidateSelectorLcMl {
       auto statusLcToPiKP = 0;
 
       if (!(candidate.hfflag() & 1 << DecayType::LcToPKPi)) {
-        hfSelLcCandidate(statusLcToPKPi, statusLcToPiKP);
+        fillCandidate(statusLcToPKPi, statusLcToPiKP);
         continue;
       }
 
@@ -173,7 +268,7 @@ struct HfCandidateSelectorLcMl {
       /*
       // daughter track validity selection
       if (!daughterSelection(trackPos1) || !daughterSelection(trackNeg) || !daughterSelection(trackPos2)) {
-        hfSelLcCandidate(statusLcToPKPi, statusLcToPiKP);
+        fillCandidate(statusLcToPKPi, statusLcToPiKP);
         continue;
       }
       */
@@ -249,12 +344,12 @@ struct HfCandidateSelectorLcMl {
       }
 
       if (pidLcToPKPi == 0 && pidLcToPiKP == 0) {
-        hfSelLcCandidate(statusLcToPKPi, statusLcToPiKP);
+        fillCandidate(statusLcToPKPi, statusLcToPiKP);
         continue;
       }
 
       if (pidBayesLcToPKPi == 0 && pidBayesLcToPiKP == 0) {
-        hfSelLcCandidate(statusLcToPKPi, statusLcToPiKP);
+        fillCandidate(statusLcToPKPi, statusLcToPiKP);
         continue;
       }
 
@@ -268,7 +363,7 @@ struct HfCandidateSelectorLcMl {
       if (candidate.cpa() <= cpaMin) {
         statusLcToPKPi = 0;
         statusLcToPiKP = 0;
-        hfSelLcCandidate(statusLcToPKPi, statusLcToPiKP);
+        fillCandidate(statusLcToPKPi, statusLcToPiKP);
         continue;
       }
 
@@ -296,48 +391,50 @@ struct HfCandidateSelectorLcMl {
         auto trackParPos1 = getTrackPar(trackPos1);
         auto trackParNeg = getTrackPar(trackNeg);
         auto trackParPos2 = getTrackPar(trackPos2);
-        std::vector<float> inputFeaturesF{trackParPos1.getPt(), trackPos1.dcaXY(), trackPos1.dcaZ(), trackParNeg.getPt(), trackNeg.dcaXY(), trackNeg.dcaZ(), trackParPos2.getPt(), trackPos2.dcaXY(), trackPos2.dcaZ()};
-        std::vector<double> inputFeaturesD{trackParPos1.getPt(), trackPos1.dcaXY(), trackPos1.dcaZ(), trackParNeg.getPt(), trackNeg.dcaXY(), trackNeg.dcaZ(), trackParPos2.getPt(), trackPos2.dcaXY(), trackPos2.dcaZ()};
+        const std::array<float, 9> features{trackParPos1.getPt(), trackPos1.dcaXY(), trackPos1.dcaZ(), trackParNeg.getPt(), trackNeg.dcaXY(), trackNeg.dcaZ(), trackParPos2.getPt(), trackPos2.dcaXY(), trackPos2.dcaZ()};
+        if (batchML) { // scored after the loop over the candidates
+          candidatesML.push_back(statusesLcToPKPi.size());
+          if (dataTypeML == 1) {
+            batchFeaturesF.insert(batchFeaturesF.end(), features.begin(), features.end());
+          } else {
+            batchFeaturesD.insert(batchFeaturesD.end(), features.begin(), features.end());
+          }
+          fillCandidate(statusLcToPKPi, statusLcToPiKP);
+          continue;
+        }
         float scores[3] = {-1.f, -1.f, -1.f};
         if (dataTypeML == 1) {
-          auto scoresRaw = model.evalModel(inputFeaturesF);
-          for (int iScore = 0; iScore < 3; ++iScore) {
-            scores[iScore] = scoresRaw[iScore];
+          std::copy(features.begin(), features.end(), inputFeaturesF.begin());
+          if (model.evalBound()) {
+            for (int iScore = 0; iScore < 3; ++iScore) {
+              scores[iScore] = scoresF[iScore];
+            }
           }
         } else if (dataTypeML == 11) {
-          auto scoresRaw = model.evalModel(inputFeaturesD);
-          for (int iScore = 0; iScore < 3; ++iScore) {
-            scores[iScore] = scoresRaw[iScore];
+          std::copy(features.begin(), features.end(), inputFeaturesD.begin());
+          if (model.evalBound()) {
+            for (int iScore = 0; iScore < 3; ++iScore) {
+              scores[iScore] = scoresD[iScore];
+            }
           }
         } else {
           LOG(error) << "Error running model inference for Lc: Unexpected input data type.";
         }
-        if (scores[0] > thresholdBDTScoreLcToPiKP.value.get(0u, "BDTbkg")) {
-          // background
-          statusLcToPKPi = 0;
-          statusLcToPiKP = 0;
-        }
-        // This is an equivalent to the cut above but it depends on the thresholds set
-        if (scores[1] <= thresholdBDTScoreLcToPiKP.value.get(0u, "BDTprompt") &&
-            scores[2] <= thresholdBDTScoreLcToPiKP.value.get(0u, "BDTnonprompt")) {
-          statusLcToPKPi = 0;
-          statusLcToPiKP = 0;
-        }
-        if (scores[1] > thresholdBDTScoreLcToPiKP.value.get(0u, "BDTprompt")) {
-          // prompt
-        }
-        if (scores[2] > thresholdBDTScoreLcToPiKP.value.get(0u, "BDTnonprompt")) {
-          // non-prompt
-          // NOTE: Can be both prompt and non-prompt!
-        }
-        if (activateQA != 0) {
-          registry.fill(HIST("hLcBDTScoreBkg"), scores[0]);
-          registry.fill(HIST("hLcBDTScorePrompt"), scores[1]);
-          registry.fill(HIST("hLcBDTScoreNonPrompt"), scores[2]);
-        }
+        applyScores(scores, statusLcToPKPi, statusLcToPiKP);
       }
 
-      hfSelLcCandidate(statusLcToPKPi, statusLcToPiKP);
+      fillCandidate(statusLcToPKPi, statusLcToPiKP);
+    }
+
+    if (batchML) {
+      if (dataTypeML == 1) {
+        scoreBatch(batchFeaturesF, batchScoresF);
+      } else {
+        scoreBatch(batchFeaturesD, batchScoresD);
+      }
+    }
+    for (std::size_t iCand = 0; iCand < statusesLcToPKPi.size(); iCand++) {
+      hfSelLcCandidate(statusesLcToPKPi[iCand], statusesLcToPiKP[iCand]);
     }
   }
 };
@@ -0,0 +1,120 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file candidateStoredColumnsCreator.cxx
+/// \brief Stores the values of the most used dynamic columns of the 2-prong and 3-prong candidates
+///
+/// The dynamic columns of the candidate tables are computed at every access. This task computes them once per
+/// data frame and stores them in tables joinable with the candidate tables, so that the downstream tasks read
+/// stored values instead. Each table is filled only if the corresponding process function is enabled.
+
+#include "Framework/AnalysisTask.h"
+#include "Framework/runDataProcessing.h"
+
+#include "PWGHF/DataModel/CandidateReconstructionTables.h"
+
+using namespace o2;
+using namespace o2::framework;
+
+/// Stores the dynamic columns of the candidates
+struct HfCandidateStoredColumnsCreator {
+  Produces<aod::HfCand2ProngStored> rowCandidate2ProngStored;
+  Produces<aod::HfCand2ProngMStored> rowCandidate2ProngMStored;
+  Produces<aod::HfCand3ProngStored> rowCandidate3ProngStored;
+  Produces<aod::HfCand3ProngMStored> rowCandidate3ProngMStored;
+
+  void processDummy(aod::Collisions const&)
+  {
+    // dummy process function, all the stored tables are optional
+  }
+
+  PROCESS_SWITCH(HfCandidateStoredColumnsCreator, processDummy, "Do not store any column", true);
+
+  /// Topological quantities of the 2-prong candidates
+  void process2Prong(aod::HfCand2Prong const& candidates)
+  {
+    rowCandidate2ProngStored.reserve(candidates.size());
+    for (const auto& candidate : candidates) {
+      rowCandidate2ProngStored(
+        candidate.pt(),
+        candidate.decayLength(),
+        candidate.decayLengthXY(),
+        candidate.decayLengthNormalised(),
+        candidate.decayLengthXYNormalised(),
+        candidate.cpa(),
+        candidate.cpaXY(),
+        candidate.impactParameterXY(),
+        candidate.maxNormalisedDeltaIP(),
+        candidate.impactParameterProduct());
+    }
+  }
+
+  PROCESS_SWITCH(HfCandidateStoredColumnsCreator, process2Prong, "Store the topological quantities of the 2-prong candidates", false);
+
+  /// Mass hypotheses of the 2-prong candidates
+  void process2ProngMasses(aod::HfCand2Prong const& candidates)
+  {
+    rowCandidate2ProngMStored.reserve(candidates.size());
+    for (const auto& candidate : candidates) {
+      rowCandidate2ProngMStored(
+        aod::hf_cand_2prong::invMassD0ToPiK(candidate),
+        aod::hf_cand_2prong::invMassD0barToKPi(candidate),
+        aod::hf_cand_2prong::cosThetaStarD0(candidate),
+        aod::hf_cand_2prong::cosThetaStarD0bar(candidate));
+    }
+  }
+
+  PROCESS_SWITCH(HfCandidateStoredColumnsCreator, process2ProngMasses, "Store the mass hypotheses of the 2-prong candidates", false);
+
+  /// Topological quantities of the 3-prong candidates
+  void process3Prong(aod::HfCand3Prong const& candidates)
+  {
+    rowCandidate3ProngStored.reserve(candidates.size());
+    for (const auto& candidate : candidates) {
+      rowCandidate3ProngStored(
+        candidate.pt(),
+        candidate.decayLength(),
+        candidate.decayLengthXY(),
+        candidate.decayLengthNormalised(),
+        candidate.decayLengthXYNormalised(),
+        candidate.cpa(),
+        candidate.cpaXY(),
+        candidate.impactParameterXY(),
+        candidate.maxNormalisedDeltaIP());
+    }
+  }
+
+  PROCESS_SWITCH(HfCandidateStoredColumnsCreator, process3Prong, "Store the topological quantities of the 3-prong candidates", false);
+
+  /// Mass hypotheses of the 3-prong candidates
+  void process3ProngMasses(aod::HfCand3Prong const& candidates)
+  {
+    rowCandidate3ProngMStored.reserve(candidates.size());
+    for (const auto& candidate : candidates) {
+      rowCandidate3ProngMStored(
+        aod::hf_cand_3prong::invMassDplusToPiKPi(candidate),
+        aod::hf_cand_3prong::invMassDsToKKPi(candidate),
+        aod::hf_cand_3prong::invMassDsToPiKK(candidate),
+        aod::hf_cand_3prong::invMassLcToPKPi(candidate),
+        aod::hf_cand_3prong::invMassLcToPiKP(candidate),
+        aod::hf_cand_3prong::invMassXicToPKPi(candidate),
+        aod::hf_cand_3prong::invMassXicToPiKP(candidate));
+    }
+  }
+
+  PROCESS_SWITCH(HfCandidateStoredColumnsCreator, process3ProngMasses, "Store the mass hypotheses of the 3-prong candidates", false);
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{
+    adaptAnalysisTask<HfCandidateStoredColumnsCreator>(cfgc)};
+}
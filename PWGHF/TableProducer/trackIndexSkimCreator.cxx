@@ -19,10 +19,16 @@
 /// \author Jinjoo Seo <jseo@cern.ch>, Inha University
 /// \author Fabrizio Grosa <fgrosa@cern.ch>, CERN
 
-#include <algorithm> // std::find
-#include <iterator>  // std::distance
-#include <string>    // std::string
-#include <vector>    // std::vector
+#include <algorithm>     // std::find
+#include <atomic>        // std::atomic
+#include <iterator>      // std::distance
+#include <limits>        // std::numeric_limits
+#include <memory>        // std::unique_ptr
+#include <mutex>         // std::mutex
+#include <string>        // std::string
+#include <thread>        // std::thread
+#include <unordered_map> // std::unordered_map
+#include <vector>        // std::vector
 
 #include "CCDB/BasicCCDBManager.h"             // for PV refit
 #include "DataFormatsParameters/GRPMagField.h" // for PV refit
@@ -36,6 +42,8 @@
 #include "ReconstructionDataFormats/V0.h"
 #include "ReconstructionDataFormats/Vertex.h" // for PV refit
 
+#include "Common/Core/ProcessTimer.h"
+#include "Common/Core/PropagatorServices.h"
 #include "Common/Core/trackUtilities.h"
 #include "Common/DataModel/CollisionAssociationTables.h"
 #include "Common/DataModel/EventSelection.h"
@@ -91,6 +99,95 @@ using TracksWithSelAndDCA = soa::Join<aod::BigTracks, aod::TracksDCA, aod::Track
 #define MY_DEBUG_MSG(condition, cmd)
 #endif
 
+/// PV refit excluding a few of its contributors.
+/// The contributors of a collision are registered once, with a map from their global index to their position
+/// in the vertexer input, and the vertexer is prepared at the first refit; each refit then only changes the flags
+/// of the excluded contributors.
+struct HfPvRefitter {
+  o2::dataformats::VertexBase primVtx;                          // original PV, seed of the refits
+  std::vector<o2::track::TrackParCov> contributorTrackParCov{}; // TrackParCov of the PV contributors
+  std::vector<bool> contributorUsed{};                          // flags of the contributors used in the refit
+  std::unordered_map<int64_t, int> contributorSlot{};           // global index of a contributor -> position in the vertexer input
+  std::unique_ptr<o2::vertexing::PVertexer> vertexer{};         // vertexer prepared with the contributors of the collision
+  bool isPrepared = false;                                      // true if the vertexer has been prepared for the collision
+  bool isDoable = false;                                        // true if the vertexer accepted enough contributors
+
+  /// Starts a new collision
+  /// \param collision is the collision whose PV is refitted
+  template <typename TCollision>
+  void reset(TCollision const& collision)
+  {
+    primVtx.setX(collision.posX());
+    primVtx.setY(collision.posY());
+    primVtx.setZ(collision.posZ());
+    primVtx.setCov(collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ());
+    contributorTrackParCov.clear();
+    contributorSlot.clear();
+    isPrepared = false;
+    isDoable = false;
+  }
+
+  /// Registers a PV contributor of the current collision
+  void addContributor(int64_t globalIndex, o2::track::TrackParCov const& trackParCov)
+  {
+    contributorSlot[globalIndex] = contributorTrackParCov.size();
+    contributorTrackParCov.push_back(trackParCov);
+  }
+
+  int getNContributors() const { return contributorTrackParCov.size(); }
+
+  /// \return position of the track in the vertexer input, -1 if the track is not a PV contributor
+  int getSlot(int64_t globalIndex) const
+  {
+    auto it = contributorSlot.find(globalIndex);
+    return it == contributorSlot.end() ? -1 : it->second;
+  }
+
+  bool isContributor(int64_t globalIndex) const { return getSlot(globalIndex) >= 0; }
+
+  /// Prepares the vertexer with all the contributors, only once per collision (the magnetic field must be set)
+  /// \return true if the refit is doable
+  bool prepare()
+  {
+    if (!isPrepared) {
+      vertexer = std::make_unique<o2::vertexing::PVertexer>();
+      o2::conf::ConfigurableParam::updateFromString("pvertexer.useMeanVertexConstraint=false"); /// remove diamond constraint (let's keep it at the moment...)
+      vertexer->init();
+      isDoable = vertexer->prepareVertexRefit(contributorTrackParCov, primVtx);
+      contributorUsed.assign(contributorTrackParCov.size(), true);
+      isPrepared = true;
+    }
+    return isDoable;
+  }
+
+  /// Refits the PV excluding the given tracks, if contributors
+  /// \param excludedGlobIds are the global indices of the tracks to be excluded
+  /// \param nExcluded is filled with the number of excluded contributors, if not null
+  o2::vertexing::PVertex refit(std::vector<int64_t> const& excludedGlobIds, int* nExcluded = nullptr)
+  {
+    prepare();
+    int nRemoved = 0;
+    for (const auto globalIndex : excludedGlobIds) {
+      const int slot = getSlot(globalIndex);
+      if (slot >= 0) {
+        contributorUsed[slot] = false; /// remove the track from the PV refitting
+        nRemoved++;
+      }
+    }
+    auto primVtxRefitted = vertexer->refitVertex(contributorUsed, primVtx); // vertex refit
+    for (const auto globalIndex : excludedGlobIds) {
+      const int slot = getSlot(globalIndex);
+      if (slot >= 0) {
+        contributorUsed[slot] = true; /// restore the track for the next PV refitting
+      }
+    }
+    if (nExcluded != nullptr) {
+      *nExcluded = nRemoved;
+    }
+    return primVtxRefitted;
+  }
+};
+
 /// Event selection
 struct HfTrackIndexSkimCreatorTagSelCollisions {
   Produces<aod::HfSelCollision> rowSelectedCollision;
@@ -315,9 +412,11 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
   ConfigurableAxis axisPvRefitDeltaZ{"axisPvRefitDeltaZ", {1000, -0.5f, 0.5f}, "DeltaZ binning PV refit"};
 
   HistogramRegistry registry{"registry"};
+  o2::common::ProcessTimer timerProcess;
 
   void init(InitContext const&)
   {
+    timerProcess.init(registry, "process");
     cutsSingleTrack = {cutsTrack2Prong, cutsTrack3Prong, cutsTrackBach};
 
     if (etaMinTrack2Prong == -99999.) {
@@ -390,7 +489,7 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
       ccdb->setCaching(true);
       ccdb->setLocalObjectValidityChecking();
 
-      lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(ccdbPathLut));
+      lut = o2::common::propagator::getMatLut(ccdb, ccdbPathLut);
       runNumber = 0;
     }
   }
@@ -596,63 +695,27 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
   /// Method for the PV refit and DCA recalculation for tracks with a collision assigned
   /// \param collision is a collision
   /// \param bcWithTimeStamps is a table of bunch crossing joined with timestamps used to query the CCDB for B and material budget
-  /// \param vecPvContributorGlobId is a vector containing the global ID of PV contributors for the current collision
-  /// \param vecPvContributorTrackParCov is a vector containing the TrackParCov of PV contributors for the current collision
+  /// \param pvRefitter holds the PV contributors of the current collision and the prepared vertexer
   /// \param myTrack is the track to be removed, if contributor, from the PV refit
   /// \param pvCoord is an array containing the coordinates of the refitted PV
   /// \param pvCovMatrix is an array containing the covariance matrix values of the refitted PV
   /// \param dcaXYdcaZ is an array containing the dcaXY and dcaZ of myTrack with respect to the refitted PV
   void performPvRefitTrack(aod::Collision const& collision,
                            aod::BCsWithTimestamps const& bcWithTimeStamps,
-                           std::vector<int64_t> vecPvContributorGlobId,
-                           std::vector<o2::track::TrackParCov> vecPvContributorTrackParCov,
+                           HfPvRefitter& pvRefitter,
                            TracksWithSelAndDCA::iterator const& myTrack,
                            std::array<float, 3>& pvCoord,
                            std::array<float, 6>& pvCovMatrix,
                            std::array<float, 2>& dcaXYdcaZ)
   {
-    std::vector<bool> vecPvRefitContributorUsed(vecPvContributorGlobId.size(), true);
-
     /// Prepare the vertex refitting
     // set the magnetic field from CCDB
     auto bc = collision.bc_as<o2::aod::BCsWithTimestamps>();
     initCCDB(bc, runNumber, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2);
-    /*if (runNumber != bc.runNumber()) {
-
-      if (isRun2) { // Run 2 GRP object
-        o2::parameters::GRPObject* grpo = ccdb->getForTimeStamp<o2::parameters::GRPObject>(ccdbPathGrp, bc.timestamp());
-        if (grpo != nullptr) {
-          o2::base::Propagator::initFieldFromGRP(grpo);
-          o2::base::Propagator::Instance()->setMatLUT(lut);
-          LOGF(info, "Setting magnetic field to %d kG for run %d from its GRP CCDB object (type o2::parameters::GRPObject)", grpo->getNominalL3Field(), bc.runNumber());
-        } else {
-          LOGF(fatal, "Run 2 GRP object (type o2::parameters::GRPObject) is not available in CCDB for run=%d at timestamp=%llu", bc.runNumber(), bc.timestamp());
-        }
-      } else { // Run 3 GRP object
-        o2::parameters::GRPMagField* grpo = ccdb->getForTimeStamp<o2::parameters::GRPMagField>(ccdbPathGrpMag, bc.timestamp());
-        if (grpo != nullptr) {
-          o2::base::Propagator::initFieldFromGRP(grpo);
-          o2::base::Propagator::Instance()->setMatLUT(lut);
-          LOG(info) << "Setting magnetic field to current" << grpo->getL3Current() << " A for run" << bc.runNumber() << " from its GRP CCDB object (type o2::parameters::GRPMagField)";
-        } else {
-          LOGF(fatal, "Run 3 GRP object (type o2::parameters::GRPMagField) is not available in CCDB for run=%d at timestamp=%llu", bc.runNumber(), bc.timestamp());
-        }
-      }
 
-      runNumber = bc.runNumber();
-    }*/
-
-    // build the VertexBase to initialize the vertexer
-    o2::dataformats::VertexBase primVtx;
-    primVtx.setX(collision.posX());
-    primVtx.setY(collision.posY());
-    primVtx.setZ(collision.posZ());
-    primVtx.setCov(collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ());
-    // configure PVertexer
-    o2::vertexing::PVertexer vertexer;
-    o2::conf::ConfigurableParam::updateFromString("pvertexer.useMeanVertexConstraint=false"); /// remove diamond constraint (let's keep it at the moment...)
-    vertexer.init();
-    bool pvRefitDoable = vertexer.prepareVertexRefit(vecPvContributorTrackParCov, primVtx);
+    // the vertexer is prepared only for the first track of the collision
+    const auto& primVtx = pvRefitter.primVtx;
+    bool pvRefitDoable = pvRefitter.prepare();
     if (!pvRefitDoable) {
       LOG(info) << "Not enough tracks accepted for the refit";
       if (doPvRefit && fillHistograms) {
@@ -660,7 +723,7 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
       }
     }
     if (debug) {
-      LOG(info) << "prepareVertexRefit = " << pvRefitDoable << " Ncontrib= " << vecPvContributorTrackParCov.size() << " Ntracks= " << collision.numContrib() << " Vtx= " << primVtx.asString();
+      LOG(info) << "prepareVertexRefit = " << pvRefitDoable << " Ncontrib= " << pvRefitter.getNContributors() << " Ntracks= " << collision.numContrib() << " Vtx= " << primVtx.asString();
     }
 
     if (fillHistograms) {
@@ -674,15 +737,10 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
     bool recalcImpPar = false;
     if (doPvRefit && pvRefitDoable) {
       recalcImpPar = true;
-      auto trackIterator = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), myTrack.globalIndex()); /// track global index
-      if (trackIterator != vecPvContributorGlobId.end()) {
+      if (pvRefitter.isContributor(myTrack.globalIndex())) {
 
         /// this track contributed to the PV fit: let's do the refit without it
-        const int entry = std::distance(vecPvContributorGlobId.begin(), trackIterator);
-
-        vecPvRefitContributorUsed[entry] = false; /// remove the track from the PV refitting
-
-        auto primVtxRefitted = vertexer.refitVertex(vecPvRefitContributorUsed, primVtx); // vertex refit
+        auto primVtxRefitted = pvRefitter.refit({myTrack.globalIndex()}); // vertex refit
         // LOG(info) << "refit " << cnt << "/" << ntr << " result = " << primVtxRefitted.asString();
         if (debug) {
           LOG(info) << "refit for track with global index " << static_cast<int>(myTrack.globalIndex()) << " " << primVtxRefitted.asString();
@@ -705,8 +763,6 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
           registry.fill(HIST("PvRefit/hChi2vsNContrib"), primVtxRefitted.getNContributors(), primVtxRefitted.getChi2());
         }
 
-        vecPvRefitContributorUsed[entry] = true; /// restore the track for the next PV refitting (probably not necessary here)
-
         if (recalcImpPar) {
           // fill the histograms for refitted PV with good Chi2
           const double deltaX = primVtx.getX() - primVtxRefitted.getX();
@@ -791,6 +847,7 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
 #endif
   )
   {
+    o2::common::ScopedTimer timer(timerProcess, tracks.size());
     rowSelectedTrack.reserve(tracks.size());
 
     // prepare vectors to cache quantities needed for PV refit
@@ -807,10 +864,12 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
       }
       tabPvRefitTrack.reserve(tracks.size());
     }
+    HfPvRefitter pvRefitter;
 
     for (const auto& collision : collisions) {
       auto thisCollId = collision.globalIndex();
       auto groupedTrackIndices = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
+      bool arePvContributorsSet = false;
 
       for (const auto& trackId : groupedTrackIndices) {
         int statusProng = BIT(CandidateType::NCandidateTypes) - 1; // all bits on
@@ -833,25 +892,24 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
           pvRefitPvCoord = {collision.posX(), collision.posY(), collision.posZ()};
           pvRefitPvCovMatrix = {collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ()};
 
-          /// retrieve PV contributors for the current collision
-          std::vector<int64_t> vecPvContributorGlobId = {};
-          std::vector<o2::track::TrackParCov> vecPvContributorTrackParCov = {};
-
-          /// contributors for the current collision
-          auto pvContrCollision = pvContributors->sliceByCached(aod::track::collisionId, thisCollId, cache);
-          for (auto contributor : pvContrCollision) {
-            vecPvContributorGlobId.push_back(contributor.globalIndex());
-            vecPvContributorTrackParCov.push_back(getTrackParCov(contributor));
-          }
-          if (debug) {
-            LOG(info) << "### vecPvContributorGlobId.size()=" << vecPvContributorGlobId.size() << ", vecPvContributorTrackParCov.size()=" << vecPvContributorTrackParCov.size() << ", N. original contributors=" << collision.numContrib();
+          /// retrieve PV contributors for the current collision, only once
+          if (!arePvContributorsSet) {
+            pvRefitter.reset(collision);
+            auto pvContrCollision = pvContributors->sliceByCached(aod::track::collisionId, thisCollId, cache);
+            for (auto contributor : pvContrCollision) {
+              pvRefitter.addContributor(contributor.globalIndex(), getTrackParCov(contributor));
+            }
+            arePvContributorsSet = true;
+            if (debug) {
+              LOG(info) << "### pvRefitter.getNContributors()=" << pvRefitter.getNContributors() << ", N. original contributors=" << collision.numContrib();
+            }
           }
 
           /// Perform the PV refit only for tracks with an assigned collision
           if (debug) {
             LOG(info) << "[BEFORE performPvRefitTrack] track.collision().globalIndex(): " << collision.globalIndex();
           }
-          performPvRefitTrack(collision, bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, track, pvRefitPvCoord, pvRefitPvCovMatrix, pvRefitDcaXYDcaZ);
+          performPvRefitTrack(collision, bcWithTimeStamps, pvRefitter, track, pvRefitPvCoord, pvRefitPvCovMatrix, pvRefitDcaXYDcaZ);
           pvRefitDcaPerTrack[trackIdx] = pvRefitDcaXYDcaZ;
           pvRefitPvCoordPerTrack[trackIdx] = pvRefitPvCoord;
           pvRefitPvCovMatrixPerTrack[trackIdx] = pvRefitPvCovMatrix;
@@ -908,6 +966,7 @@ struct HfTrackIndexSkimCreator {
   Configurable<int> do3Prong{"do3Prong", 0, "do 3 prong"};
   Configurable<bool> debug{"debug", false, "debug mode"};
   Configurable<bool> fillHistograms{"fillHistograms", true, "fill histograms"};
+  Configurable<int> nThreadsProngs{"nThreadsProngs", 1, "Number of threads sharing the collisions in the 2- and 3-prong combinatorics (not used with the PV refit)"};
   ConfigurableAxis axisNumTracks{"axisNumTracks", {250, -0.5f, 249.5f}, "Number of tracks"};
   ConfigurableAxis axisNumCands{"axisNumCands", {200, -0.5f, 199.f}, "Number of candidates"};
   // Configurable<int> nCollsMax{"nCollsMax", -1, "Max collisions per file"}; //can be added to run over limited collisions per file - for tesing purposes
@@ -956,6 +1015,8 @@ struct HfTrackIndexSkimCreator {
   o2::base::Propagator::MatCorrType noMatCorr = o2::base::Propagator::MatCorrType::USEMatCorrNONE;
   int runNumber;
 
+  std::unique_ptr<std::mutex> mutexRegistry = std::make_unique<std::mutex>(); // protects the histogram registry when the collisions are processed by several threads
+
   // int nColls{0}; //can be added to run over limited collisions per file - for tesing purposes
 
   static constexpr int kN2ProngDecays = hf_cand_2prong::DecayType::N2ProngDecays; // number of 2-prong hadron types
@@ -964,11 +1025,29 @@ struct HfTrackIndexSkimCreator {
   static constexpr int kNCuts3Prong = 4;                                          // how many different selections are made on 3-prongs
   std::array<std::array<std::array<double, 2>, 2>, kN2ProngDecays> arrMass2Prong;
   std::array<std::array<std::array<double, 3>, 2>, kN3ProngDecays> arrMass3Prong;
+  // 2-prong selections of one pT bin, copied from the cut configurables with the mass limits already squared
+  struct Cuts2ProngPtBin {
+    bool applyMassCut; // mass window applied only for massMin >= 0 and massMax > 0
+    double massMin2;   // squared lower limit of the mass window
+    double massMax2;   // squared upper limit of the mass window
+    double cosp;       // min. cosine of pointing angle
+    double d0d0;       // max. product of the impact parameters
+  };
+  // 3-prong selections of one pT bin, copied from the cut configurables with the mass limits already squared
+  struct Cuts3ProngPtBin {
+    bool applyMassCut; // mass window applied only for massMin >= 0 and massMax > 0
+    double massMin2;   // squared lower limit of the mass window
+    double massMax2;   // squared upper limit of the mass window
+    double cosp;       // min. cosine of pointing angle
+    double decL;       // min. decay length
+  };
   // arrays of 2-prong and 3-prong cuts
-  std::array<LabeledArray<double>, kN2ProngDecays> cut2Prong;
+  std::array<std::vector<Cuts2ProngPtBin>, kN2ProngDecays> cut2Prong;
   std::array<std::vector<double>, kN2ProngDecays> pTBins2Prong;
-  std::array<LabeledArray<double>, kN3ProngDecays> cut3Prong;
+  std::array<PtBins, kN2ProngDecays> ptBinning2Prong;
+  std::array<std::vector<Cuts3ProngPtBin>, kN3ProngDecays> cut3Prong;
   std::array<std::vector<double>, kN3ProngDecays> pTBins3Prong;
+  std::array<PtBins, kN3ProngDecays> ptBinning3Prong;
 
   using SelectedCollisions = soa::Filtered<soa::Join<aod::Collisions, aod::HfSelCollision>>;
   using TracksWithDCA = soa::Join<aod::BigTracks, aod::TracksDCA>;
@@ -995,12 +1074,14 @@ struct HfTrackIndexSkimCreator {
   ConfigurableAxis axisPvRefitDeltaZ{"axisPvRefitDeltaZ", {1000, -0.5f, 0.5f}, "DeltaZ binning PV refit"};
 
   HistogramRegistry registry{"registry"};
+  o2::common::ProcessTimer timer2And3Prongs;
 
   void init(InitContext const& context)
   {
     if (!doprocess2And3ProngsWithPvRefit && !doprocess2And3ProngsNoPvRefit) {
       return;
     }
+    timer2And3Prongs.init(registry, doprocess2And3ProngsWithPvRefit ? "process2And3ProngsWithPvRefit" : "process2And3ProngsNoPvRefit");
 
     arrMass2Prong[hf_cand_2prong::DecayType::D0ToPiK] = array{array{massPi, massK},
                                                               array{massK, massPi}};
@@ -1024,12 +1105,42 @@ struct HfTrackIndexSkimCreator {
                                                                 array{massPi, massK, massProton}};
 
     // cuts for 2-prong decays retrieved by json. the order must be then one in hf_cand_2prong::DecayType
-    cut2Prong = {cutsD0ToPiK, cutsJpsiToEE, cutsJpsiToMuMu};
+    const std::array<LabeledArray<double>, kN2ProngDecays> cutsConfig2Prong = {cutsD0ToPiK, cutsJpsiToEE, cutsJpsiToMuMu};
     pTBins2Prong = {binsPtD0ToPiK, binsPtJpsiToEE, binsPtJpsiToMuMu};
     // cuts for 3-prong decays retrieved by json. the order must be then one in hf_cand_3prong::DecayType
-    cut3Prong = {cutsDplusToPiKPi, cutsLcToPKPi, cutsDsToKKPi, cutsXicToPKPi};
+    const std::array<LabeledArray<double>, kN3ProngDecays> cutsConfig3Prong = {cutsDplusToPiKPi, cutsLcToPKPi, cutsDsToKKPi, cutsXicToPKPi};
     pTBins3Prong = {binsPtDplusToPiKPi, binsPtLcToPKPi, binsPtDsToKKPi, binsPtXicToPKPi};
 
+    // copy the cuts per pT bin, to avoid the lookups of the labelled arrays in the candidate loops
+    for (int iDecay2P = 0; iDecay2P < kN2ProngDecays; iDecay2P++) {
+      const auto& cuts = cutsConfig2Prong[iDecay2P];
+      const int massMinIndex = cuts.colmap.find("massMin")->second;
+      const int massMaxIndex = cuts.colmap.find("massMax")->second;
+      const int cospIndex = cuts.colmap.find("cosp")->second;
+      const int d0d0Index = cuts.colmap.find("d0d0")->second;
+      ptBinning2Prong[iDecay2P].set(pTBins2Prong[iDecay2P]);
+      cut2Prong[iDecay2P].clear();
+      for (int iBin = 0; iBin < ptBinning2Prong[iDecay2P].size(); iBin++) {
+        const double massMin = cuts.get(iBin, massMinIndex);
+        const double massMax = cuts.get(iBin, massMaxIndex);
+        cut2Prong[iDecay2P].push_back({massMin >= 0. && massMax > 0., massMin * massMin, massMax * massMax, cuts.get(iBin, cospIndex), cuts.get(iBin, d0d0Index)});
+      }
+    }
+    for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
+      const auto& cuts = cutsConfig3Prong[iDecay3P];
+      const int massMinIndex = cuts.colmap.find("massMin")->second;
+      const int massMaxIndex = cuts.colmap.find("massMax")->second;
+      const int cospIndex = cuts.colmap.find("cosp")->second;
+      const int decLenIndex = cuts.colmap.find("decL")->second;
+      ptBinning3Prong[iDecay3P].set(pTBins3Prong[iDecay3P]);
+      cut3Prong[iDecay3P].clear();
+      for (int iBin = 0; iBin < ptBinning3Prong[iDecay3P].size(); iBin++) {
+        const double massMin = cuts.get(iBin, massMinIndex);
+        const double massMax = cuts.get(iBin, massMaxIndex);
+        cut3Prong[iDecay3P].push_back({massMin >= 0. && massMax > 0., massMin * massMin, massMax * massMax, cuts.get(iBin, cospIndex), cuts.get(iBin, decLenIndex)});
+      }
+    }
+
     if (fillHistograms) {
       registry.add("hNTracks", "Number of selected tracks;# of selected tracks;entries", {HistType::kTH1F, {axisNumTracks}});
       // 2-prong histograms
@@ -1086,7 +1197,7 @@ struct HfTrackIndexSkimCreator {
     ccdb->setURL(ccdbUrl);
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
-    lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(ccdbPathLut));
+    lut = o2::common::propagator::getMatLut(ccdb, ccdbPathLut);
     runNumber = 0;
   }
 
@@ -1101,30 +1212,13 @@ struct HfTrackIndexSkimCreator {
   template <typename T1, typename T2, typename T3, typename T4>
   void is2ProngPreselected(T1 const& pVecTrack0, T1 const& pVecTrack1, T2 const& dcaTrack0, T2 const& dcaTrack1, T3& cutStatus, T4& whichHypo, int& isSelected)
   {
-    /// FIXME: this would be better fixed by having a convention on the position of min and max in the 2D Array
-    static std::vector<int> massMinIndex;
-    static std::vector<int> massMaxIndex;
-    static std::vector<int> d0d0Index;
-    static auto cacheIndices = [](std::array<LabeledArray<double>, kN2ProngDecays>& cut2Prong, std::vector<int>& mins, std::vector<int>& maxs, std::vector<int>& d0d0) {
-      mins.resize(cut2Prong.size());
-      maxs.resize(cut2Prong.size());
-      d0d0.resize(cut2Prong.size());
-      for (size_t i = 0; i < cut2Prong.size(); ++i) {
-        mins[i] = cut2Prong[i].colmap.find("massMin")->second;
-        maxs[i] = cut2Prong[i].colmap.find("massMax")->second;
-        d0d0[i] = cut2Prong[i].colmap.find("d0d0")->second;
-      }
-      return true;
-    };
-    cacheIndices(cut2Prong, massMinIndex, massMaxIndex, d0d0Index);
-
     auto arrMom = array{pVecTrack0, pVecTrack1};
     auto pT = RecoDecay::pt(pVecTrack0, pVecTrack1) + ptTolerance; // add tolerance because of no reco decay vertex
 
     for (int iDecay2P = 0; iDecay2P < kN2ProngDecays; iDecay2P++) {
 
       // pT
-      auto pTBin = findBin(&pTBins2Prong[iDecay2P], pT);
+      auto pTBin = ptBinning2Prong[iDecay2P].find(pT);
       // return immediately if it is outside the defined pT bins
       if (pTBin == -1) {
         CLRBIT(isSelected, iDecay2P);
@@ -1134,13 +1228,15 @@ struct HfTrackIndexSkimCreator {
         continue;
       }
 
+      const auto& cuts = cut2Prong[iDecay2P][pTBin];
+
       // invariant mass
       double massHypos[2];
       whichHypo[iDecay2P] = 3;
-      double min2 = pow(cut2Prong[iDecay2P].get(pTBin, massMinIndex[iDecay2P]), 2);
-      double max2 = pow(cut2Prong[iDecay2P].get(pTBin, massMaxIndex[iDecay2P]), 2);
+      const double min2 = cuts.massMin2;
+      const double max2 = cuts.massMax2;
 
-      if ((debug || TESTBIT(isSelected, iDecay2P)) && cut2Prong[iDecay2P].get(pTBin, massMinIndex[iDecay2P]) >= 0. && cut2Prong[iDecay2P].get(pTBin, massMaxIndex[iDecay2P]) > 0.) {
+      if ((debug || TESTBIT(isSelected, iDecay2P)) && cuts.applyMassCut) {
         massHypos[0] = RecoDecay::m2(arrMom, arrMass2Prong[iDecay2P][0]);
         massHypos[1] = RecoDecay::m2(arrMom, arrMass2Prong[iDecay2P][1]);
         if (massHypos[0] < min2 || massHypos[0] >= max2) {
@@ -1160,7 +1256,7 @@ struct HfTrackIndexSkimCreator {
       // imp. par. product cut
       if (debug || TESTBIT(isSelected, iDecay2P)) {
         auto impParProduct = dcaTrack0 * dcaTrack1;
-        if (impParProduct > cut2Prong[iDecay2P].get(pTBin, d0d0Index[iDecay2P])) {
+        if (impParProduct > cuts.d0d0) {
           CLRBIT(isSelected, iDecay2P);
           if (debug) {
             cutStatus[iDecay2P][2] = false;
@@ -1180,27 +1276,13 @@ struct HfTrackIndexSkimCreator {
   template <typename T1, typename T2, typename T3>
   void is3ProngPreselected(T1 const& pVecTrack0, T1 const& pVecTrack1, T1 const& pVecTrack2, T2& cutStatus, T3& whichHypo, int& isSelected)
   {
-    /// FIXME: this would be better fixed by having a convention on the position of min and max in the 2D Array
-    static std::vector<int> massMinIndex;
-    static std::vector<int> massMaxIndex;
-    static auto cacheIndices = [](std::array<LabeledArray<double>, kN3ProngDecays>& cut3Prong, std::vector<int>& mins, std::vector<int>& maxs) {
-      mins.resize(cut3Prong.size());
-      maxs.resize(cut3Prong.size());
-      for (size_t iDecay3P = 0; iDecay3P < cut3Prong.size(); ++iDecay3P) {
-        mins[iDecay3P] = cut3Prong[iDecay3P].colmap.find("massMin")->second;
-        maxs[iDecay3P] = cut3Prong[iDecay3P].colmap.find("massMax")->second;
-      }
-      return true;
-    };
-    cacheIndices(cut3Prong, massMinIndex, massMaxIndex);
-
     auto arrMom = array{pVecTrack0, pVecTrack1, pVecTrack2};
     auto pT = RecoDecay::pt(pVecTrack0, pVecTrack1, pVecTrack2) + ptTolerance; // add tolerance because of no reco decay vertex
 
     for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
 
       // pT
-      auto pTBin = findBin(&pTBins3Prong[iDecay3P], pT);
+      auto pTBin = ptBinning3Prong[iDecay3P].find(pT);
       // return immediately if it is outside the defined pT bins
       if (pTBin == -1) {
         CLRBIT(isSelected, iDecay3P);
@@ -1210,13 +1292,15 @@ struct HfTrackIndexSkimCreator {
         continue;
       }
 
+      const auto& cuts = cut3Prong[iDecay3P][pTBin];
+
       // invariant mass
       double massHypos[2];
       whichHypo[iDecay3P] = 3;
-      double min2 = pow(cut3Prong[iDecay3P].get(pTBin, massMinIndex[iDecay3P]), 2);
-      double max2 = pow(cut3Prong[iDecay3P].get(pTBin, massMaxIndex[iDecay3P]), 2);
+      const double min2 = cuts.massMin2;
+      const double max2 = cuts.massMax2;
 
-      if ((debug || TESTBIT(isSelected, iDecay3P)) && cut3Prong[iDecay3P].get(pTBin, massMinIndex[iDecay3P]) >= 0. && cut3Prong[iDecay3P].get(pTBin, massMaxIndex[iDecay3P]) > 0.) { // no need to check isSelected but to avoid mistakes
+      if ((debug || TESTBIT(isSelected, iDecay3P)) && cuts.applyMassCut) { // no need to check isSelected but to avoid mistakes
         massHypos[0] = RecoDecay::m2(arrMom, arrMass3Prong[iDecay3P][0]);
         massHypos[1] = RecoDecay::m2(arrMom, arrMass3Prong[iDecay3P][1]);
         if (massHypos[0] < min2 || massHypos[0] >= max2) {
@@ -1245,22 +1329,12 @@ struct HfTrackIndexSkimCreator {
   void is2ProngSelected(const T1& pVecCand, const T2& secVtx, const T3& primVtx, T4& cutStatus, int& isSelected)
   {
     if (debug || isSelected > 0) {
-
-      /// FIXME: this would be better fixed by having a convention on the position of min and max in the 2D Array
-      static std::vector<int> cospIndex;
-      static auto cacheIndices = [](std::array<LabeledArray<double>, kN2ProngDecays>& cut2Prong, std::vector<int>& cosp) {
-        cosp.resize(cut2Prong.size());
-        for (size_t iDecay2P = 0; iDecay2P < cut2Prong.size(); ++iDecay2P) {
-          cosp[iDecay2P] = cut2Prong[iDecay2P].colmap.find("cosp")->second;
-        }
-        return true;
-      };
-      cacheIndices(cut2Prong, cospIndex);
+      const auto pT = RecoDecay::pt(pVecCand);
 
       for (int iDecay2P = 0; iDecay2P < kN2ProngDecays; iDecay2P++) {
 
         // pT
-        auto pTBin = findBin(&pTBins2Prong[iDecay2P], RecoDecay::pt(pVecCand));
+        auto pTBin = ptBinning2Prong[iDecay2P].find(pT);
         if (pTBin == -1) { // cut if it is outside the defined pT bins
           CLRBIT(isSelected, iDecay2P);
           if (debug) {
@@ -1272,7 +1346,7 @@ struct HfTrackIndexSkimCreator {
         // cosp
         if (debug || TESTBIT(isSelected, iDecay2P)) {
           auto cpa = RecoDecay::cpa(primVtx, secVtx, pVecCand);
-          if (cpa < cut2Prong[iDecay2P].get(pTBin, cospIndex[iDecay2P])) {
+          if (cpa < cut2Prong[iDecay2P][pTBin].cosp) {
             CLRBIT(isSelected, iDecay2P);
             if (debug) {
               cutStatus[iDecay2P][3] = false;
@@ -1293,25 +1367,12 @@ struct HfTrackIndexSkimCreator {
   void is3ProngSelected(const T1& pVecCand, const T2& secVtx, const T3& primVtx, T4& cutStatus, int& isSelected)
   {
     if (debug || isSelected > 0) {
-
-      /// FIXME: this would be better fixed by having a convention on the position of min and max in the 2D Array
-      static std::vector<int> cospIndex;
-      static std::vector<int> decLenIndex;
-      static auto cacheIndices = [](std::array<LabeledArray<double>, kN3ProngDecays>& cut3Prong, std::vector<int>& cosp, std::vector<int>& decL) {
-        cosp.resize(cut3Prong.size());
-        decL.resize(cut3Prong.size());
-        for (size_t iDecay3P = 0; iDecay3P < cut3Prong.size(); ++iDecay3P) {
-          cosp[iDecay3P] = cut3Prong[iDecay3P].colmap.find("cosp")->second;
-          decL[iDecay3P] = cut3Prong[iDecay3P].colmap.find("decL")->second;
-        }
-        return true;
-      };
-      cacheIndices(cut3Prong, cospIndex, decLenIndex);
+      const auto pT = RecoDecay::pt(pVecCand);
 
       for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
 
         // pT
-        auto pTBin = findBin(&pTBins3Prong[iDecay3P], RecoDecay::pt(pVecCand));
+        auto pTBin = ptBinning3Prong[iDecay3P].find(pT);
         if (pTBin == -1) { // cut if it is outside the defined pT bins
           CLRBIT(isSelected, iDecay3P);
           if (debug) {
@@ -1323,7 +1384,7 @@ struct HfTrackIndexSkimCreator {
         // cosp
         if ((debug || TESTBIT(isSelected, iDecay3P))) {
           auto cpa = RecoDecay::cpa(primVtx, secVtx, pVecCand);
-          if (cpa < cut3Prong[iDecay3P].get(pTBin, cospIndex[iDecay3P])) {
+          if (cpa < cut3Prong[iDecay3P][pTBin].cosp) {
             CLRBIT(isSelected, iDecay3P);
             if (debug) {
               cutStatus[iDecay3P][2] = false;
@@ -1334,7 +1395,7 @@ struct HfTrackIndexSkimCreator {
         // decay length
         if ((debug || TESTBIT(isSelected, iDecay3P))) {
           auto decayLength = RecoDecay::distance(primVtx, secVtx);
-          if (decayLength < cut3Prong[iDecay3P].get(pTBin, decLenIndex[iDecay3P])) {
+          if (decayLength < cut3Prong[iDecay3P][pTBin].decL) {
             CLRBIT(isSelected, iDecay3P);
             if (debug) {
               cutStatus[iDecay3P][3] = false;
@@ -1348,37 +1409,25 @@ struct HfTrackIndexSkimCreator {
   /// Method for the PV refit excluding the candidate daughters
   /// \param collision is a collision
   /// \param bcWithTimeStamps is a table of bunch crossing joined with timestamps used to query the CCDB for B and material budget
-  /// \param vecPvContributorGlobId is a vector containing the global ID of PV contributors for the current collision
-  /// \param vecPvContributorTrackParCov is a vector containing the TrackParCov of PV contributors for the current collision
+  /// \param pvRefitter holds the PV contributors of the current collision and the prepared vertexer
   /// \param vecCandPvContributorGlobId is a vector containing the global indices of daughter tracks that contributed to the original PV refit
   /// \param pvCoord is a vector where to store X, Y and Z values of refitted PV
   /// \param pvCovMatrix is a vector where to store the covariance matrix values of refitted PV
   void performPvRefitCandProngs(SelectedCollisions::iterator const& collision,
                                 aod::BCsWithTimestamps const& bcWithTimeStamps,
-                                std::vector<int64_t> vecPvContributorGlobId,
-                                std::vector<o2::track::TrackParCov> vecPvContributorTrackParCov,
-                                std::vector<int64_t> vecCandPvContributorGlobId,
+                                HfPvRefitter& pvRefitter,
+                                std::vector<int64_t> const& vecCandPvContributorGlobId,
                                 std::array<float, 3>& pvCoord,
                                 std::array<float, 6>& pvCovMatrix)
   {
-    std::vector<bool> vecPvRefitContributorUsed(vecPvContributorGlobId.size(), true);
-
     /// Prepare the vertex refitting
     // set the magnetic field from CCDB
     auto bc = collision.bc_as<o2::aod::BCsWithTimestamps>();
     initCCDB(bc, runNumber, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2);
 
-    // build the VertexBase to initialize the vertexer
-    o2::dataformats::VertexBase primVtx;
-    primVtx.setX(collision.posX());
-    primVtx.setY(collision.posY());
-    primVtx.setZ(collision.posZ());
-    primVtx.setCov(collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ());
-    // configure PVertexer
-    o2::vertexing::PVertexer vertexer;
-    o2::conf::ConfigurableParam::updateFromString("pvertexer.useMeanVertexConstraint=false"); /// remove diamond constraint (let's keep it at the moment...)
-    vertexer.init();
-    bool pvRefitDoable = vertexer.prepareVertexRefit(vecPvContributorTrackParCov, primVtx);
+    // the vertexer is prepared only for the first candidate of the collision
+    const auto& primVtx = pvRefitter.primVtx;
+    bool pvRefitDoable = pvRefitter.prepare();
     if (!pvRefitDoable) {
       LOG(info) << "Not enough tracks accepted for the refit";
       if (doprocess2And3ProngsWithPvRefit && fillHistograms) {
@@ -1386,7 +1435,7 @@ struct HfTrackIndexSkimCreator {
       }
     }
     if (debug) {
-      LOG(info) << "prepareVertexRefit = " << pvRefitDoable << " Ncontrib= " << vecPvContributorTrackParCov.size() << " Ntracks= " << collision.numContrib() << " Vtx= " << primVtx.asString();
+      LOG(info) << "prepareVertexRefit = " << pvRefitDoable << " Ncontrib= " << pvRefitter.getNContributors() << " Ntracks= " << collision.numContrib() << " Vtx= " << primVtx.asString();
     }
 
     /// PV refitting, if the tracks contributed to this at the beginning
@@ -1397,22 +1446,12 @@ struct HfTrackIndexSkimCreator {
         registry.fill(HIST("PvRefit/verticesPerCandidate"), 2);
       }
       recalcPvRefit = true;
-      int nCandContr = 0;
-      for (uint64_t myGlobalID : vecCandPvContributorGlobId) {
-        auto trackIterator = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), myGlobalID); /// track global index
-        if (trackIterator != vecPvContributorGlobId.end()) {
-          /// this is a contributor, let's remove it for the PV refit
-          const int entry = std::distance(vecPvContributorGlobId.begin(), trackIterator);
-          vecPvRefitContributorUsed[entry] = false; /// remove the track from the PV refitting
-          nCandContr++;
-        }
-      }
-
       /// do the PV refit excluding the candidate daughters that originally contributed to fit it
+      int nCandContr = 0;
+      auto primVtxRefitted = pvRefitter.refit(vecCandPvContributorGlobId, &nCandContr); // vertex refit
       if (debug) {
         LOG(info) << "### PV refit after removing " << nCandContr << " tracks";
       }
-      auto primVtxRefitted = vertexer.refitVertex(vecPvRefitContributorUsed, primVtx); // vertex refit
       // LOG(info) << "refit " << cnt << "/" << ntr << " result = " << primVtxRefitted.asString();
       // LOG(info) << "refit for track with global index " << static_cast<int>(myTrack.globalIndex()) << " " << primVtxRefitted.asString();
       if (primVtxRefitted.getChi2() < 0) {
@@ -1434,10 +1473,6 @@ struct HfTrackIndexSkimCreator {
         registry.fill(HIST("PvRefit/hChi2vsNContrib"), primVtxRefitted.getNContributors(), primVtxRefitted.getChi2());
       }
 
-      for (size_t i = 0; i < vecPvContributorGlobId.size(); i++) {
-        vecPvRefitContributorUsed[i] = true; /// restore the tracks for the next PV refitting (probably not necessary here)
-      }
-
       if (recalcPvRefit) {
         // fill the histograms for refitted PV with good Chi2
         const double deltaX = primVtx.getX() - primVtxRefitted.getX();
@@ -1481,309 +1516,397 @@ struct HfTrackIndexSkimCreator {
     return;
   } /// end of performPvRefitCandProngs function
 
-  template <bool doPvRefit = false, typename TTracks>
-  void run2And3Prongs(SelectedCollisions const& collisions,
-                      aod::BCsWithTimestamps const& bcWithTimeStamps,
-                      FilteredTrackAssocSel const& trackIndices,
-                      TTracks const& tracks)
+  /// candidates found in one collision, buffered to be written to the output tables in collision order
+  struct CollisionCandidates {
+    std::vector<std::array<int64_t, 4>> prong2;                   /// collision, prong indices and selection bitmap of the 2-prong candidates
+    std::vector<std::array<int, kN2ProngDecays>> cutStatus2Prong; /// selection status of the 2-prong candidates (debug mode)
+    std::vector<std::array<float, 9>> pvRefit2Prong;              /// refitted PV coordinates and covariance matrix of the 2-prong candidates
+    std::vector<std::array<int64_t, 5>> prong3;                   /// collision, prong indices and selection bitmap of the 3-prong candidates
+    std::vector<std::array<int, kN3ProngDecays>> cutStatus3Prong; /// selection status of the 3-prong candidates (debug mode)
+    std::vector<std::array<float, 9>> pvRefit3Prong;              /// refitted PV coordinates and covariance matrix of the 3-prong candidates
+
+    void clear()
+    {
+      prong2.clear();
+      cutStatus2Prong.clear();
+      pvRefit2Prong.clear();
+      prong3.clear();
+      cutStatus3Prong.clear();
+      pvRefit3Prong.clear();
+    }
+  };
+
+  /// state of one worker of the 2- and 3-prong combinatorics
+  template <typename TTracks>
+  struct ProngWorker {
+    /// selected prong of the current collision, with the track parameters and the DCA computed once for all its combinations
+    struct ProngCandidate {
+      typename TTracks::iterator track;
+      float pt;
+      bool sel2Prong;
+      bool sel3Prong;
+      o2::track::TrackParCov trackParVar;
+      std::array<float, 3> pVec;
+      o2::gpu::gpustd::array<float, 2> dcaInfo;
+    };
+
+    o2::vertexing::DCAFitterN<2> df2; /// 2-prong vertex fitter
+    o2::vertexing::DCAFitterN<3> df3; /// 3-prong vertex fitter
+    std::vector<ProngCandidate> prongsPos;
+    std::vector<ProngCandidate> prongsNeg;
+    double ptMin2Prong = 0.; /// lowest candidate pT accepted by the preselections, used to stop the loops over the pT-sorted prongs
+    double ptMin3Prong = 0.;
+  };
+
+  /// Configures the vertex fitters of a worker with the current magnetic field
+  /// \param worker is the worker to be configured
+  template <typename TWorker>
+  void setupProngWorker(TWorker& worker)
   {
+    // 2-prong vertex fitter
+    worker.df2.setBz(o2::base::Propagator::Instance()->getNominalBz());
+    worker.df2.setPropagateToPCA(propagateToPCA);
+    worker.df2.setMaxR(maxR);
+    worker.df2.setMaxDZIni(maxDZIni);
+    worker.df2.setMinParamChange(minParamChange);
+    worker.df2.setMinRelChi2Change(minRelChi2Change);
+    worker.df2.setUseAbsDCA(useAbsDCA);
+    worker.df2.setWeightedFinalPCA(useWeightedFinalPCA);
+
+    // 3-prong vertex fitter
+    worker.df3.setBz(o2::base::Propagator::Instance()->getNominalBz());
+    worker.df3.setPropagateToPCA(propagateToPCA);
+    worker.df3.setMaxR(maxR);
+    worker.df3.setMaxDZIni(maxDZIni);
+    worker.df3.setMinParamChange(minParamChange);
+    worker.df3.setMinRelChi2Change(minRelChi2Change);
+    worker.df3.setUseAbsDCA(useAbsDCA);
+    worker.df3.setWeightedFinalPCA(useWeightedFinalPCA);
+
+    worker.ptMin2Prong = std::numeric_limits<double>::max();
+    for (const auto& bins : pTBins2Prong) {
+      worker.ptMin2Prong = std::min(worker.ptMin2Prong, bins.front());
+    }
+    worker.ptMin3Prong = std::numeric_limits<double>::max();
+    for (const auto& bins : pTBins3Prong) {
+      worker.ptMin3Prong = std::min(worker.ptMin3Prong, bins.front());
+    }
+  }
 
-    // can be added to run over limited collisions per file - for tesing purposes
-    /*
-    if (nCollsMax > -1){
-      if (nColls == nCollMax){
-        return;
-        //can be added to run over limited collisions per file - for tesing purposes
-      }
-      nColls++;
+  /// Writes the buffered candidates of a collision in the output tables
+  /// \param candidates are the candidates of the collision
+  void fillCandidateTables(const CollisionCandidates& candidates)
+  {
+    for (const auto& row : candidates.prong2) {
+      rowTrackIndexProng2(row[0], row[1], row[2], row[3]);
     }
-    */
+    for (const auto& row : candidates.cutStatus2Prong) {
+      rowProng2CutStatus(row[0], row[1], row[2]);
+    }
+    for (const auto& row : candidates.pvRefit2Prong) {
+      rowProng2PVrefit(row[0], row[1], row[2], row[3], row[4], row[5], row[6], row[7], row[8]);
+    }
+    for (const auto& row : candidates.prong3) {
+      rowTrackIndexProng3(row[0], row[1], row[2], row[3], row[4]);
+    }
+    for (const auto& row : candidates.cutStatus3Prong) {
+      rowProng3CutStatus(row[0], row[1], row[2], row[3]);
+    }
+    for (const auto& row : candidates.pvRefit3Prong) {
+      rowProng3PVrefit(row[0], row[1], row[2], row[3], row[4], row[5], row[6], row[7], row[8]);
+    }
+  }
 
-    for (const auto& collision : collisions) {
+  /// 2- and 3-prong combinatorics of one collision
+  /// \param collision is the collision
+  /// \param worker holds the vertex fitters and the prong lists, used by one thread at a time
+  /// \param candidates is the buffer filled with the candidates of the collision
+  template <bool doPvRefit, typename TTracks, typename TWorker>
+  void run2And3ProngsCollision(SelectedCollisions::iterator const& collision,
+                               aod::BCsWithTimestamps const& bcWithTimeStamps,
+                               FilteredTrackAssocSel const& trackIndices,
+                               TTracks const& tracks,
+                               TWorker& worker,
+                               CollisionCandidates& candidates)
+  {
 
-      /// retrieve PV contributors for the current collision
-      std::vector<int64_t> vecPvContributorGlobId{};
-      std::vector<o2::track::TrackParCov> vecPvContributorTrackParCov{};
-      std::vector<bool> vecPvRefitContributorUsed{};
-      if constexpr (doPvRefit) {
-        auto groupedTracksUnfiltered = tracks.sliceBy(tracksPerCollision, collision.globalIndex());
-        const int nTrk = groupedTracksUnfiltered.size();
-        int nContrib = 0;
-        int nNonContrib = 0;
-        for (const auto& trackUnfiltered : groupedTracksUnfiltered) {
-          if (!trackUnfiltered.isPVContributor()) {
-            /// the track did not contribute to fit the primary vertex
-            nNonContrib++;
-            continue;
-          } else {
-            vecPvContributorGlobId.push_back(trackUnfiltered.globalIndex());
-            vecPvContributorTrackParCov.push_back(getTrackParCov(trackUnfiltered));
-            nContrib++;
-            if (debug) {
-              LOG(info) << "---> a contributor! stuff saved";
-              LOG(info) << "vec_contrib size: " << vecPvContributorTrackParCov.size() << ", nContrib: " << nContrib;
-            }
+    /// retrieve PV contributors for the current collision
+    HfPvRefitter pvRefitter;
+    if constexpr (doPvRefit) {
+      pvRefitter.reset(collision);
+      auto groupedTracksUnfiltered = tracks.sliceBy(tracksPerCollision, collision.globalIndex());
+      const int nTrk = groupedTracksUnfiltered.size();
+      int nContrib = 0;
+      int nNonContrib = 0;
+      for (const auto& trackUnfiltered : groupedTracksUnfiltered) {
+        if (!trackUnfiltered.isPVContributor()) {
+          /// the track did not contribute to fit the primary vertex
+          nNonContrib++;
+          continue;
+        } else {
+          pvRefitter.addContributor(trackUnfiltered.globalIndex(), getTrackParCov(trackUnfiltered));
+          nContrib++;
+          if (debug) {
+            LOG(info) << "---> a contributor! stuff saved";
+            LOG(info) << "vec_contrib size: " << pvRefitter.getNContributors() << ", nContrib: " << nContrib;
           }
         }
-        if (debug) {
-          LOG(info) << "===> nTrk: " << nTrk << ",   nContrib: " << nContrib << ",   nNonContrib: " << nNonContrib;
-          if ((uint16_t)vecPvContributorTrackParCov.size() != collision.numContrib() || (uint16_t)nContrib != collision.numContrib()) {
-            LOG(info) << "!!! Some problem here !!! vecPvContributorTrackParCov.size()= " << vecPvContributorTrackParCov.size() << ", nContrib=" << nContrib << ", collision.numContrib()" << collision.numContrib();
-          }
+      }
+      if (debug) {
+        LOG(info) << "===> nTrk: " << nTrk << ",   nContrib: " << nContrib << ",   nNonContrib: " << nNonContrib;
+        if ((uint16_t)pvRefitter.getNContributors() != collision.numContrib() || (uint16_t)nContrib != collision.numContrib()) {
+          LOG(info) << "!!! Some problem here !!! pvRefitter.getNContributors()= " << pvRefitter.getNContributors() << ", nContrib=" << nContrib << ", collision.numContrib()" << collision.numContrib();
         }
-        vecPvRefitContributorUsed = std::vector<bool>(vecPvContributorGlobId.size(), true);
       }
+    }
 
-      // auto centrality = collision.centV0M(); //FIXME add centrality when option for variations to the process function appears
-
-      int n2ProngBit = BIT(kN2ProngDecays) - 1; // bit value for 2-prong candidates where each candidate is one bit and they are all set to 1
-      int n3ProngBit = BIT(kN3ProngDecays) - 1; // bit value for 3-prong candidates where each candidate is one bit and they are all set to 1
-
-      bool cutStatus2Prong[kN2ProngDecays][kNCuts2Prong];
-      bool cutStatus3Prong[kN3ProngDecays][kNCuts3Prong];
-      int nCutStatus2ProngBit = BIT(kNCuts2Prong) - 1; // bit value for selection status for each 2-prong candidate where each selection is one bit and they are all set to 1
-      int nCutStatus3ProngBit = BIT(kNCuts3Prong) - 1; // bit value for selection status for each 3-prong candidate where each selection is one bit and they are all set to 1
-
-      int whichHypo2Prong[kN2ProngDecays];
-      int whichHypo3Prong[kN3ProngDecays];
-
-      // set the magnetic field from CCDB
-      auto bc = collision.bc_as<o2::aod::BCsWithTimestamps>();
-      initCCDB(bc, runNumber, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2);
-
-      // 2-prong vertex fitter
-      o2::vertexing::DCAFitterN<2> df2;
-      df2.setBz(o2::base::Propagator::Instance()->getNominalBz());
-      df2.setPropagateToPCA(propagateToPCA);
-      df2.setMaxR(maxR);
-      df2.setMaxDZIni(maxDZIni);
-      df2.setMinParamChange(minParamChange);
-      df2.setMinRelChi2Change(minRelChi2Change);
-      df2.setUseAbsDCA(useAbsDCA);
-      df2.setWeightedFinalPCA(useWeightedFinalPCA);
-
-      // 3-prong vertex fitter
-      o2::vertexing::DCAFitterN<3> df3;
-      df3.setBz(o2::base::Propagator::Instance()->getNominalBz());
-      df3.setPropagateToPCA(propagateToPCA);
-      df3.setMaxR(maxR);
-      df3.setMaxDZIni(maxDZIni);
-      df3.setMinParamChange(minParamChange);
-      df3.setMinRelChi2Change(minRelChi2Change);
-      df3.setUseAbsDCA(useAbsDCA);
-      df3.setWeightedFinalPCA(useWeightedFinalPCA);
-
-      // used to calculate number of candidiates per event
-      auto nCand2 = rowTrackIndexProng2.lastIndex();
-      auto nCand3 = rowTrackIndexProng3.lastIndex();
-
-      // if there isn't at least a positive and a negative track, continue immediately
-      // if (tracksPos.size() < 1 || tracksNeg.size() < 1) {
-      //  return;
-      //}
-
-      // first loop over positive tracks
-      // for (auto trackPos1 = tracksPos.begin(); trackPos1 != tracksPos.end(); ++trackPos1) {
-
-      auto thisCollId = collision.globalIndex();
-      auto groupedTrackIndices = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
-
-      for (auto trackIndexPos1 = groupedTrackIndices.begin(); trackIndexPos1 != groupedTrackIndices.end(); ++trackIndexPos1) {
-        auto trackPos1 = trackIndexPos1.template track_as<TTracks>();
-
-        if (trackPos1.signed1Pt() < 0) {
-          continue;
-        }
+    // auto centrality = collision.centV0M(); //FIXME add centrality when option for variations to the process function appears
+
+    int n2ProngBit = BIT(kN2ProngDecays) - 1; // bit value for 2-prong candidates where each candidate is one bit and they are all set to 1
+    int n3ProngBit = BIT(kN3ProngDecays) - 1; // bit value for 3-prong candidates where each candidate is one bit and they are all set to 1
+
+    bool cutStatus2Prong[kN2ProngDecays][kNCuts2Prong];
+    bool cutStatus3Prong[kN3ProngDecays][kNCuts3Prong];
+    int nCutStatus2ProngBit = BIT(kNCuts2Prong) - 1; // bit value for selection status for each 2-prong candidate where each selection is one bit and they are all set to 1
+    int nCutStatus3ProngBit = BIT(kNCuts3Prong) - 1; // bit value for selection status for each 3-prong candidate where each selection is one bit and they are all set to 1
+
+    int whichHypo2Prong[kN2ProngDecays];
+    int whichHypo3Prong[kN3ProngDecays];
+
+    // vertex fitters and prong lists of this worker
+    auto& df2 = worker.df2;
+    auto& df3 = worker.df3;
+    auto& prongsPos = worker.prongsPos;
+    auto& prongsNeg = worker.prongsNeg;
+    const double ptMin2Prong = worker.ptMin2Prong;
+    const double ptMin3Prong = worker.ptMin3Prong;
+
+    // if there isn't at least a positive and a negative track, continue immediately
+    // if (tracksPos.size() < 1 || tracksNeg.size() < 1) {
+    //  return;
+    //}
+
+    // first loop over positive tracks
+    // for (auto trackPos1 = tracksPos.begin(); trackPos1 != tracksPos.end(); ++trackPos1) {
+
+    auto thisCollId = collision.globalIndex();
+    auto groupedTrackIndices = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
+
+    // build the lists of positive and negative prongs once, sorted by decreasing pT
+    prongsPos.clear();
+    prongsNeg.clear();
+    for (const auto& trackIndex : groupedTrackIndices) {
+      // retrieve the selection flag that corresponds to this collision
+      auto isSelProng = trackIndex.isSelProng();
+      bool sel2ProngStatus = TESTBIT(isSelProng, CandidateType::Cand2Prong);
+      bool sel3ProngStatus = TESTBIT(isSelProng, CandidateType::Cand3Prong);
+      if (!sel2ProngStatus && !sel3ProngStatus) {
+        continue;
+      }
 
-        // retrieve the selection flag that corresponds to this collision
-        auto isSelProngPos1 = trackIndexPos1.isSelProng();
-        bool sel2ProngStatusPos = TESTBIT(isSelProngPos1, CandidateType::Cand2Prong);
-        bool sel3ProngStatusPos1 = TESTBIT(isSelProngPos1, CandidateType::Cand3Prong);
-        if (!sel2ProngStatusPos && !sel3ProngStatusPos1) {
+      auto track = trackIndex.template track_as<TTracks>();
+      auto trackParVar = getTrackParCov(track);
+      std::array<float, 3> pVecTrack{track.px(), track.py(), track.pz()};
+      o2::gpu::gpustd::array<float, 2> dcaInfo{track.dcaXY(), track.dcaZ()};
+      if (thisCollId != track.collisionId()) { // this is not the "default" collision for this track, we have to re-propagate it
+        o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVar, 2.f, noMatCorr, &dcaInfo);
+        getPxPyPz(trackParVar, pVecTrack);
+      }
+      typename TWorker::ProngCandidate prong{track, static_cast<float>(RecoDecay::pt(pVecTrack)), sel2ProngStatus, sel3ProngStatus, trackParVar, pVecTrack, dcaInfo};
+      if (track.signed1Pt() >= 0) {
+        prongsPos.push_back(prong);
+      }
+      if (track.signed1Pt() <= 0) {
+        prongsNeg.push_back(prong);
+      }
+    }
+    auto comparePt = [](const auto& prong1, const auto& prong2) { return prong1.pt > prong2.pt; };
+    std::stable_sort(prongsPos.begin(), prongsPos.end(), comparePt);
+    std::stable_sort(prongsNeg.begin(), prongsNeg.end(), comparePt);
+
+    for (size_t iPos1 = 0; iPos1 < prongsPos.size(); ++iPos1) {
+      const auto& prongPos1 = prongsPos[iPos1];
+      const auto& trackPos1 = prongPos1.track;
+      bool sel2ProngStatusPos = prongPos1.sel2Prong;
+      bool sel3ProngStatusPos1 = prongPos1.sel3Prong;
+      const auto& trackParVarPos1 = prongPos1.trackParVar;
+      const auto& pVecTrackPos1 = prongPos1.pVec;
+      const auto& dcaInfoPos1 = prongPos1.dcaInfo;
+
+      // first loop over negative tracks
+      for (size_t iNeg1 = 0; iNeg1 < prongsNeg.size(); ++iNeg1) {
+        const auto& prongNeg1 = prongsNeg[iNeg1];
+        const auto& trackNeg1 = prongNeg1.track;
+        if (trackNeg1.globalIndex() == trackPos1.globalIndex()) { // track with signed1Pt = 0, present in both lists
           continue;
         }
 
-        auto trackParVarPos1 = getTrackParCov(trackPos1);
-        std::array<float, 3> pVecTrackPos1{trackPos1.px(), trackPos1.py(), trackPos1.pz()};
-        o2::gpu::gpustd::array<float, 2> dcaInfoPos1{trackPos1.dcaXY(), trackPos1.dcaZ()};
-        if (thisCollId != trackPos1.collisionId()) { // this is not the "default" collision for this track, we have to re-propagate it
-          o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarPos1, 2.f, noMatCorr, &dcaInfoPos1);
-          getPxPyPz(trackParVarPos1, pVecTrackPos1);
-        }
-
-        // first loop over negative tracks
-        // for (auto trackNeg1 = tracksNeg.begin(); trackNeg1 != tracksNeg.end(); ++trackNeg1) {
-        for (auto trackIndexNeg1 = groupedTrackIndices.begin(); trackIndexNeg1 != groupedTrackIndices.end(); ++trackIndexNeg1) {
-          auto trackNeg1 = trackIndexNeg1.template track_as<TTracks>();
-          if (trackNeg1.signed1Pt() > 0) {
-            continue;
-          }
-
-          // retrieve the selection flag that corresponds to this collision
-          auto isSelProngNeg1 = trackIndexNeg1.isSelProng();
-          bool sel2ProngStatusNeg = TESTBIT(isSelProngNeg1, CandidateType::Cand2Prong);
-          bool sel3ProngStatusNeg1 = TESTBIT(isSelProngNeg1, CandidateType::Cand3Prong);
-          if (!sel2ProngStatusNeg && !sel3ProngStatusNeg1) {
-            continue;
+        // the candidate pT is at most the sum of the prong pT: once neither a 2-prong nor a 3-prong candidate
+        // can reach the lowest pT bin, the remaining (softer) negative prongs can be skipped
+        if (!debug) {
+          float ptThirdMax = std::max(iPos1 + 1 < prongsPos.size() ? prongsPos[iPos1 + 1].pt : 0.f, iNeg1 + 1 < prongsNeg.size() ? prongsNeg[iNeg1 + 1].pt : 0.f);
+          float ptSum = prongPos1.pt + prongNeg1.pt + ptTolerance;
+          if (ptSum < ptMin2Prong && (do3Prong != 1 || ptSum + ptThirdMax < ptMin3Prong)) {
+            break;
           }
+        }
 
-          auto trackParVarNeg1 = getTrackParCov(trackNeg1);
-          std::array<float, 3> pVecTrackNeg1{trackNeg1.px(), trackNeg1.py(), trackNeg1.pz()};
-          o2::gpu::gpustd::array<float, 2> dcaInfoNeg1{trackNeg1.dcaXY(), trackNeg1.dcaZ()};
-          if (thisCollId != trackNeg1.collisionId()) { // this is not the "default" collision for this track, we have to re-propagate it
-            o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarNeg1, 2.f, noMatCorr, &dcaInfoNeg1);
-            getPxPyPz(trackParVarNeg1, pVecTrackNeg1);
-          }
+        bool sel2ProngStatusNeg = prongNeg1.sel2Prong;
+        bool sel3ProngStatusNeg1 = prongNeg1.sel3Prong;
+        const auto& trackParVarNeg1 = prongNeg1.trackParVar;
+        const auto& pVecTrackNeg1 = prongNeg1.pVec;
+        const auto& dcaInfoNeg1 = prongNeg1.dcaInfo;
 
-          int isSelected2ProngCand = n2ProngBit; // bitmap for checking status of two-prong candidates (1 is true, 0 is rejected)
+        int isSelected2ProngCand = n2ProngBit; // bitmap for checking status of two-prong candidates (1 is true, 0 is rejected)
 
-          if (debug) {
-            for (int iDecay2P = 0; iDecay2P < kN2ProngDecays; iDecay2P++) {
-              for (int iCut = 0; iCut < kNCuts2Prong; iCut++) {
-                cutStatus2Prong[iDecay2P][iCut] = true;
-              }
+        if (debug) {
+          for (int iDecay2P = 0; iDecay2P < kN2ProngDecays; iDecay2P++) {
+            for (int iCut = 0; iCut < kNCuts2Prong; iCut++) {
+              cutStatus2Prong[iDecay2P][iCut] = true;
             }
           }
+        }
 
-          // 2-prong vertex reconstruction
-          if (sel2ProngStatusPos && sel2ProngStatusNeg) {
-
-            // 2-prong preselections
-            // TODO: in case of PV refit, the single-track DCA is calculated wrt two different PV vertices (only 1 track excluded)
-            is2ProngPreselected(pVecTrackPos1, pVecTrackNeg1, dcaInfoPos1[0], dcaInfoNeg1[0], cutStatus2Prong, whichHypo2Prong, isSelected2ProngCand);
-
-            // secondary vertex reconstruction and further 2-prong selections
-            if (isSelected2ProngCand > 0 && df2.process(trackParVarPos1, trackParVarNeg1) > 0) { // should it be this or > 0 or are they equivalent
-              // get secondary vertex
-              const auto& secondaryVertex2 = df2.getPCACandidate();
-              // get track momenta
-              array<float, 3> pvec0;
-              array<float, 3> pvec1;
-              df2.getTrack(0).getPxPyPzGlo(pvec0);
-              df2.getTrack(1).getPxPyPzGlo(pvec1);
-
-              /// PV refit excluding the candidate daughters, if contributors
-              array<float, 3> pvRefitCoord2Prong = {collision.posX(), collision.posY(), collision.posZ()}; /// initialize to the original PV
-              array<float, 6> pvRefitCovMatrix2Prong = getPrimaryVertex(collision).getCov();               /// initialize to the original PV
-              if constexpr (doPvRefit) {
+        // 2-prong vertex reconstruction
+        if (sel2ProngStatusPos && sel2ProngStatusNeg) {
+
+          // 2-prong preselections
+          // TODO: in case of PV refit, the single-track DCA is calculated wrt two different PV vertices (only 1 track excluded)
+          is2ProngPreselected(pVecTrackPos1, pVecTrackNeg1, dcaInfoPos1[0], dcaInfoNeg1[0], cutStatus2Prong, whichHypo2Prong, isSelected2ProngCand);
+
+          // secondary vertex reconstruction and further 2-prong selections
+          if (isSelected2ProngCand > 0 && df2.process(trackParVarPos1, trackParVarNeg1) > 0) { // should it be this or > 0 or are they equivalent
+            // get secondary vertex
+            const auto& secondaryVertex2 = df2.getPCACandidate();
+            // get track momenta
+            array<float, 3> pvec0;
+            array<float, 3> pvec1;
+            df2.getTrack(0).getPxPyPzGlo(pvec0);
+            df2.getTrack(1).getPxPyPzGlo(pvec1);
+
+            /// PV refit excluding the candidate daughters, if contributors
+            array<float, 3> pvRefitCoord2Prong = {collision.posX(), collision.posY(), collision.posZ()}; /// initialize to the original PV
+            array<float, 6> pvRefitCovMatrix2Prong = getPrimaryVertex(collision).getCov();               /// initialize to the original PV
+            if constexpr (doPvRefit) {
+              if (fillHistograms) {
+                std::lock_guard<std::mutex> lockRegistry(*mutexRegistry);
+                registry.fill(HIST("PvRefit/verticesPerCandidate"), 1);
+              }
+              int nCandContr = 2;
+              bool isTrackFirstContr = true;
+              bool isTrackSecondContr = true;
+              if (!pvRefitter.isContributor(trackPos1.globalIndex())) {
+                /// This track did not contribute to the original PV refit
+                if (debug) {
+                  LOG(info) << "--- [2 Prong] trackPos1 with globalIndex " << trackPos1.globalIndex() << " was not a PV contributor";
+                }
+                nCandContr--;
+                isTrackFirstContr = false;
+              }
+              if (!pvRefitter.isContributor(trackNeg1.globalIndex())) {
+                /// This track did not contribute to the original PV refit
+                if (debug) {
+                  LOG(info) << "--- [2 Prong] trackNeg1 with globalIndex " << trackNeg1.globalIndex() << " was not a PV contributor";
+                }
+                nCandContr--;
+                isTrackSecondContr = false;
+              }
+              if (nCandContr == 2) {
+                /// Both the daughter tracks were used for the original PV refit, let's refit it after excluding them
+                if (debug) {
+                  LOG(info) << "### [2 Prong] Calling performPvRefitCandProngs for HF 2 prong candidate";
+                }
+                performPvRefitCandProngs(collision, bcWithTimeStamps, pvRefitter, {trackPos1.globalIndex(), trackNeg1.globalIndex()}, pvRefitCoord2Prong, pvRefitCovMatrix2Prong);
+              } else if (nCandContr == 1) {
+                /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
+                if (debug) {
+                  LOG(info) << "####### [2 Prong] nCandContr==" << nCandContr << " ---> just 1 contributor!";
+                }
                 if (fillHistograms) {
-                  registry.fill(HIST("PvRefit/verticesPerCandidate"), 1);
+                  std::lock_guard<std::mutex> lockRegistry(*mutexRegistry);
+                  registry.fill(HIST("PvRefit/verticesPerCandidate"), 5);
                 }
-                int nCandContr = 2;
-                auto trackFirstIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackPos1.globalIndex());
-                auto trackSecondIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackNeg1.globalIndex());
-                bool isTrackFirstContr = true;
-                bool isTrackSecondContr = true;
-                if (trackFirstIt == vecPvContributorGlobId.end()) {
-                  /// This track did not contribute to the original PV refit
-                  if (debug) {
-                    LOG(info) << "--- [2 Prong] trackPos1 with globalIndex " << trackPos1.globalIndex() << " was not a PV contributor";
-                  }
-                  nCandContr--;
-                  isTrackFirstContr = false;
+                if (isTrackFirstContr && !isTrackSecondContr) {
+                  /// the first daughter is contributor, the second is not
+                  pvRefitCoord2Prong = {trackPos1.pvRefitX(), trackPos1.pvRefitY(), trackPos1.pvRefitZ()};
+                  pvRefitCovMatrix2Prong = {trackPos1.pvRefitSigmaX2(), trackPos1.pvRefitSigmaXY(), trackPos1.pvRefitSigmaY2(), trackPos1.pvRefitSigmaXZ(), trackPos1.pvRefitSigmaYZ(), trackPos1.pvRefitSigmaZ2()};
+                } else if (!isTrackFirstContr && isTrackSecondContr) {
+                  ///  the second daughter is contributor, the first is not
+                  pvRefitCoord2Prong = {trackNeg1.pvRefitX(), trackNeg1.pvRefitY(), trackNeg1.pvRefitZ()};
+                  pvRefitCovMatrix2Prong = {trackNeg1.pvRefitSigmaX2(), trackNeg1.pvRefitSigmaXY(), trackNeg1.pvRefitSigmaY2(), trackNeg1.pvRefitSigmaXZ(), trackNeg1.pvRefitSigmaYZ(), trackNeg1.pvRefitSigmaZ2()};
                 }
-                if (trackSecondIt == vecPvContributorGlobId.end()) {
-                  /// This track did not contribute to the original PV refit
-                  if (debug) {
-                    LOG(info) << "--- [2 Prong] trackNeg1 with globalIndex " << trackNeg1.globalIndex() << " was not a PV contributor";
-                  }
-                  nCandContr--;
-                  isTrackSecondContr = false;
+              } else {
+                /// 0 contributors among the HF candidate daughters
+                if (fillHistograms) {
+                  std::lock_guard<std::mutex> lockRegistry(*mutexRegistry);
+                  registry.fill(HIST("PvRefit/verticesPerCandidate"), 6);
                 }
-                if (nCandContr == 2) {
-                  /// Both the daughter tracks were used for the original PV refit, let's refit it after excluding them
-                  if (debug) {
-                    LOG(info) << "### [2 Prong] Calling performPvRefitCandProngs for HF 2 prong candidate";
-                  }
-                  performPvRefitCandProngs(collision, bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, {trackPos1.globalIndex(), trackNeg1.globalIndex()}, pvRefitCoord2Prong, pvRefitCovMatrix2Prong);
-                } else if (nCandContr == 1) {
-                  /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
-                  if (debug) {
-                    LOG(info) << "####### [2 Prong] nCandContr==" << nCandContr << " ---> just 1 contributor!";
-                  }
-                  if (fillHistograms) {
-                    registry.fill(HIST("PvRefit/verticesPerCandidate"), 5);
-                  }
-                  if (isTrackFirstContr && !isTrackSecondContr) {
-                    /// the first daughter is contributor, the second is not
-                    pvRefitCoord2Prong = {trackPos1.pvRefitX(), trackPos1.pvRefitY(), trackPos1.pvRefitZ()};
-                    pvRefitCovMatrix2Prong = {trackPos1.pvRefitSigmaX2(), trackPos1.pvRefitSigmaXY(), trackPos1.pvRefitSigmaY2(), trackPos1.pvRefitSigmaXZ(), trackPos1.pvRefitSigmaYZ(), trackPos1.pvRefitSigmaZ2()};
-                  } else if (!isTrackFirstContr && isTrackSecondContr) {
-                    ///  the second daughter is contributor, the first is not
-                    pvRefitCoord2Prong = {trackNeg1.pvRefitX(), trackNeg1.pvRefitY(), trackNeg1.pvRefitZ()};
-                    pvRefitCovMatrix2Prong = {trackNeg1.pvRefitSigmaX2(), trackNeg1.pvRefitSigmaXY(), trackNeg1.pvRefitSigmaY2(), trackNeg1.pvRefitSigmaXZ(), trackNeg1.pvRefitSigmaYZ(), trackNeg1.pvRefitSigmaZ2()};
-                  }
-                } else {
-                  /// 0 contributors among the HF candidate daughters
-                  if (fillHistograms) {
-                    registry.fill(HIST("PvRefit/verticesPerCandidate"), 6);
-                  }
-                  if (debug) {
-                    LOG(info) << "####### [2 Prong] nCandContr==" << nCandContr << " ---> some of the candidate daughters did not contribute to the original PV fit, PV refit not redone";
-                  }
+                if (debug) {
+                  LOG(info) << "####### [2 Prong] nCandContr==" << nCandContr << " ---> some of the candidate daughters did not contribute to the original PV fit, PV refit not redone";
                 }
               }
+            }
 
-              auto pVecCandProng2 = RecoDecay::pVec(pvec0, pvec1);
-              // 2-prong selections after secondary vertex
-              array<float, 3> pvCoord2Prong = {collision.posX(), collision.posY(), collision.posZ()};
-              if constexpr (doPvRefit) {
-                pvCoord2Prong[0] = pvRefitCoord2Prong[0];
-                pvCoord2Prong[1] = pvRefitCoord2Prong[1];
-                pvCoord2Prong[2] = pvRefitCoord2Prong[2];
-              }
-              is2ProngSelected(pVecCandProng2, secondaryVertex2, pvCoord2Prong, cutStatus2Prong, isSelected2ProngCand);
+            auto pVecCandProng2 = RecoDecay::pVec(pvec0, pvec1);
+            // 2-prong selections after secondary vertex
+            array<float, 3> pvCoord2Prong = {collision.posX(), collision.posY(), collision.posZ()};
+            if constexpr (doPvRefit) {
+              pvCoord2Prong[0] = pvRefitCoord2Prong[0];
+              pvCoord2Prong[1] = pvRefitCoord2Prong[1];
+              pvCoord2Prong[2] = pvRefitCoord2Prong[2];
+            }
+            is2ProngSelected(pVecCandProng2, secondaryVertex2, pvCoord2Prong, cutStatus2Prong, isSelected2ProngCand);
 
-              if (isSelected2ProngCand > 0) {
-                // fill table row
-                rowTrackIndexProng2(thisCollId, trackPos1.globalIndex(), trackNeg1.globalIndex(), isSelected2ProngCand);
+            if (isSelected2ProngCand > 0) {
+              // fill table row
+              candidates.prong2.push_back({thisCollId, trackPos1.globalIndex(), trackNeg1.globalIndex(), isSelected2ProngCand});
 
-                if constexpr (doPvRefit) {
-                  // fill table row with coordinates of PV refit
-                  rowProng2PVrefit(pvRefitCoord2Prong[0], pvRefitCoord2Prong[1], pvRefitCoord2Prong[2],
-                                   pvRefitCovMatrix2Prong[0], pvRefitCovMatrix2Prong[1], pvRefitCovMatrix2Prong[2], pvRefitCovMatrix2Prong[3], pvRefitCovMatrix2Prong[4], pvRefitCovMatrix2Prong[5]);
-                }
+              if constexpr (doPvRefit) {
+                // fill table row with coordinates of PV refit
+                candidates.pvRefit2Prong.push_back({pvRefitCoord2Prong[0], pvRefitCoord2Prong[1], pvRefitCoord2Prong[2],
+                                                    pvRefitCovMatrix2Prong[0], pvRefitCovMatrix2Prong[1], pvRefitCovMatrix2Prong[2], pvRefitCovMatrix2Prong[3], pvRefitCovMatrix2Prong[4], pvRefitCovMatrix2Prong[5]});
+              }
 
-                if (debug) {
-                  int Prong2CutStatus[kN2ProngDecays];
-                  for (int iDecay2P = 0; iDecay2P < kN2ProngDecays; iDecay2P++) {
-                    Prong2CutStatus[iDecay2P] = nCutStatus2ProngBit;
-                    for (int iCut = 0; iCut < kNCuts2Prong; iCut++) {
-                      if (!cutStatus2Prong[iDecay2P][iCut]) {
-                        CLRBIT(Prong2CutStatus[iDecay2P], iCut);
-                      }
+              if (debug) {
+                int Prong2CutStatus[kN2ProngDecays];
+                for (int iDecay2P = 0; iDecay2P < kN2ProngDecays; iDecay2P++) {
+                  Prong2CutStatus[iDecay2P] = nCutStatus2ProngBit;
+                  for (int iCut = 0; iCut < kNCuts2Prong; iCut++) {
+                    if (!cutStatus2Prong[iDecay2P][iCut]) {
+                      CLRBIT(Prong2CutStatus[iDecay2P], iCut);
                     }
                   }
-                  rowProng2CutStatus(Prong2CutStatus[0], Prong2CutStatus[1], Prong2CutStatus[2]); // FIXME when we can do this by looping over kN2ProngDecays
                 }
+                candidates.cutStatus2Prong.push_back({Prong2CutStatus[0], Prong2CutStatus[1], Prong2CutStatus[2]}); // FIXME when we can do this by looping over kN2ProngDecays
+              }
 
-                // fill histograms
-                if (fillHistograms) {
-                  registry.fill(HIST("hVtx2ProngX"), secondaryVertex2[0]);
-                  registry.fill(HIST("hVtx2ProngY"), secondaryVertex2[1]);
-                  registry.fill(HIST("hVtx2ProngZ"), secondaryVertex2[2]);
-                  array<array<float, 3>, 2> arrMom = {pvec0, pvec1};
-                  for (int iDecay2P = 0; iDecay2P < kN2ProngDecays; iDecay2P++) {
-                    if (TESTBIT(isSelected2ProngCand, iDecay2P)) {
-                      if (whichHypo2Prong[iDecay2P] == 1 || whichHypo2Prong[iDecay2P] == 3) {
-                        auto mass2Prong = RecoDecay::m(arrMom, arrMass2Prong[iDecay2P][0]);
-                        switch (iDecay2P) {
-                          case hf_cand_2prong::DecayType::D0ToPiK:
-                            registry.fill(HIST("hMassD0ToPiK"), mass2Prong);
-                            break;
-                          case hf_cand_2prong::DecayType::JpsiToEE:
-                            registry.fill(HIST("hMassJpsiToEE"), mass2Prong);
-                            break;
-                          case hf_cand_2prong::DecayType::JpsiToMuMu:
-                            registry.fill(HIST("hMassJpsiToMuMu"), mass2Prong);
-                            break;
-                        }
-                      }
-                      if (whichHypo2Prong[iDecay2P] >= 2) {
-                        auto mass2Prong = RecoDecay::m(arrMom, arrMass2Prong[iDecay2P][1]);
-                        if (iDecay2P == hf_cand_2prong::DecayType::D0ToPiK) {
+              // fill histograms
+              if (fillHistograms) {
+                std::lock_guard<std::mutex> lockRegistry(*mutexRegistry);
+                registry.fill(HIST("hVtx2ProngX"), secondaryVertex2[0]);
+                registry.fill(HIST("hVtx2ProngY"), secondaryVertex2[1]);
+                registry.fill(HIST("hVtx2ProngZ"), secondaryVertex2[2]);
+                array<array<float, 3>, 2> arrMom = {pvec0, pvec1};
+                for (int iDecay2P = 0; iDecay2P < kN2ProngDecays; iDecay2P++) {
+                  if (TESTBIT(isSelected2ProngCand, iDecay2P)) {
+                    if (whichHypo2Prong[iDecay2P] == 1 || whichHypo2Prong[iDecay2P] == 3) {
+                      auto mass2Prong = RecoDecay::m(arrMom, arrMass2Prong[iDecay2P][0]);
+                      switch (iDecay2P) {
+                        case hf_cand_2prong::DecayType::D0ToPiK:
                           registry.fill(HIST("hMassD0ToPiK"), mass2Prong);
-                        }
+                          break;
+                        case hf_cand_2prong::DecayType::JpsiToEE:
+                          registry.fill(HIST("hMassJpsiToEE"), mass2Prong);
+                          break;
+                        case hf_cand_2prong::DecayType::JpsiToMuMu:
+                          registry.fill(HIST("hMassJpsiToMuMu"), mass2Prong);
+                          break;
+                      }
+                    }
+                    if (whichHypo2Prong[iDecay2P] >= 2) {
+                      auto mass2Prong = RecoDecay::m(arrMom, arrMass2Prong[iDecay2P][1]);
+                      if (iDecay2P == hf_cand_2prong::DecayType::D0ToPiK) {
+                        registry.fill(HIST("hMassD0ToPiK"), mass2Prong);
                       }
                     }
                   }
@@ -1791,447 +1914,437 @@ struct HfTrackIndexSkimCreator {
               }
             }
           }
+        }
+
+        // 3-prong vertex reconstruction
+        if (do3Prong == 1) {
+          if (!sel3ProngStatusPos1 || !sel3ProngStatusNeg1) {
+            continue;
+          }
 
-          // 3-prong vertex reconstruction
-          if (do3Prong == 1) {
-            if (!sel3ProngStatusPos1 || !sel3ProngStatusNeg1) {
+          if (tracks.size() < 2) {
+            continue;
+          }
+          // second loop over positive tracks
+          for (size_t iPos2 = iPos1 + 1; iPos2 < prongsPos.size(); ++iPos2) {
+            const auto& prongPos2 = prongsPos[iPos2];
+            if (!debug && prongPos1.pt + prongNeg1.pt + prongPos2.pt + ptTolerance < ptMin3Prong) {
+              break;
+            }
+            if (!prongPos2.sel3Prong) {
               continue;
             }
-
-            if (tracks.size() < 2) {
+            const auto& trackPos2 = prongPos2.track;
+            if (trackPos2.globalIndex() == trackNeg1.globalIndex()) {
               continue;
             }
-            // second loop over positive tracks
-            // for (auto trackPos2 = trackPos1 + 1; trackPos2 != tracksPos.end(); ++trackPos2) {
-            for (auto trackIndexPos2 = trackIndexPos1 + 1; trackIndexPos2 != groupedTrackIndices.end(); ++trackIndexPos2) {
-              auto trackPos2 = trackIndexPos2.template track_as<TTracks>();
-              if (trackPos2.signed1Pt() < 0) {
-                continue;
-              }
+            const auto& trackParVarPos2 = prongPos2.trackParVar;
+            const auto& pVecTrackPos2 = prongPos2.pVec;
 
-              // retrieve the selection flag that corresponds to this collision
-              auto isSelProngPos2 = trackIndexPos2.isSelProng();
-              if (!TESTBIT(isSelProngPos2, CandidateType::Cand3Prong)) {
-                continue;
-              }
+            int isSelected3ProngCand = n3ProngBit;
 
-              auto trackParVarPos2 = getTrackParCov(trackPos2);
-              std::array<float, 3> pVecTrackPos2{trackPos2.px(), trackPos2.py(), trackPos2.pz()};
-              o2::gpu::gpustd::array<float, 2> dcaInfoPos2{trackPos2.dcaXY(), trackPos2.dcaZ()};
-              if (thisCollId != trackPos2.collisionId()) { // this is not the "default" collision for this track, we have to re-propagate it
-                o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarPos2, 2.f, noMatCorr, &dcaInfoPos2);
-                getPxPyPz(trackParVarPos2, pVecTrackPos2);
+            if (debug) {
+              for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
+                for (int iCut = 0; iCut < kNCuts3Prong; iCut++) {
+                  cutStatus3Prong[iDecay3P][iCut] = true;
+                }
               }
+            }
 
-              int isSelected3ProngCand = n3ProngBit;
+            // 3-prong preselections
+            is3ProngPreselected(pVecTrackPos1, pVecTrackNeg1, pVecTrackPos2, cutStatus3Prong, whichHypo3Prong, isSelected3ProngCand);
+            if (!debug && isSelected3ProngCand == 0) {
+              continue;
+            }
 
-              if (debug) {
-                for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
-                  for (int iCut = 0; iCut < kNCuts3Prong; iCut++) {
-                    cutStatus3Prong[iDecay3P][iCut] = true;
-                  }
+            // reconstruct the 3-prong secondary vertex
+            if (df3.process(trackParVarPos1, trackParVarNeg1, trackParVarPos2) == 0) {
+              continue;
+            }
+            // get secondary vertex
+            const auto& secondaryVertex3 = df3.getPCACandidate();
+            // get track momenta
+            array<float, 3> pvec0;
+            array<float, 3> pvec1;
+            array<float, 3> pvec2;
+            df3.getTrack(0).getPxPyPzGlo(pvec0);
+            df3.getTrack(1).getPxPyPzGlo(pvec1);
+            df3.getTrack(2).getPxPyPzGlo(pvec2);
+
+            /// PV refit excluding the candidate daughters, if contributors
+            array<float, 3> pvRefitCoord3Prong2Pos1Neg = {collision.posX(), collision.posY(), collision.posZ()}; /// initialize to the original PV
+            array<float, 6> pvRefitCovMatrix3Prong2Pos1Neg = getPrimaryVertex(collision).getCov();               /// initialize to the original PV
+            if constexpr (doPvRefit) {
+              if (fillHistograms) {
+                std::lock_guard<std::mutex> lockRegistry(*mutexRegistry);
+                registry.fill(HIST("PvRefit/verticesPerCandidate"), 1);
+              }
+              int nCandContr = 3;
+              bool isTrackFirstContr = true;
+              bool isTrackSecondContr = true;
+              bool isTrackThirdContr = true;
+              if (!pvRefitter.isContributor(trackPos1.globalIndex())) {
+                /// This track did not contribute to the original PV refit
+                if (debug) {
+                  LOG(info) << "--- [3 prong] trackPos1 with globalIndex " << trackPos1.globalIndex() << " was not a PV contributor";
                 }
+                nCandContr--;
+                isTrackFirstContr = false;
               }
-
-              // 3-prong preselections
-              is3ProngPreselected(pVecTrackPos1, pVecTrackNeg1, pVecTrackPos2, cutStatus3Prong, whichHypo3Prong, isSelected3ProngCand);
-              if (!debug && isSelected3ProngCand == 0) {
-                continue;
+              if (!pvRefitter.isContributor(trackNeg1.globalIndex())) {
+                /// This track did not contribute to the original PV refit
+                if (debug) {
+                  LOG(info) << "--- [3 prong] trackNeg1 with globalIndex " << trackNeg1.globalIndex() << " was not a PV contributor";
+                }
+                nCandContr--;
+                isTrackSecondContr = false;
+              }
+              if (!pvRefitter.isContributor(trackPos2.globalIndex())) {
+                /// This track did not contribute to the original PV refit
+                if (debug) {
+                  LOG(info) << "--- [3 prong] trackPos2 with globalIndex " << trackPos2.globalIndex() << " was not a PV contributor";
+                }
+                nCandContr--;
+                isTrackThirdContr = false;
               }
 
-              // reconstruct the 3-prong secondary vertex
-              if (df3.process(trackParVarPos1, trackParVarNeg1, trackParVarPos2) == 0) {
-                continue;
+              // Fill a vector with global ID of candidate daughters that are contributors
+              std::vector<int64_t> vecCandPvContributorGlobId = {};
+              if (isTrackFirstContr) {
+                vecCandPvContributorGlobId.push_back(trackPos1.globalIndex());
               }
-              // get secondary vertex
-              const auto& secondaryVertex3 = df3.getPCACandidate();
-              // get track momenta
-              array<float, 3> pvec0;
-              array<float, 3> pvec1;
-              array<float, 3> pvec2;
-              df3.getTrack(0).getPxPyPzGlo(pvec0);
-              df3.getTrack(1).getPxPyPzGlo(pvec1);
-              df3.getTrack(2).getPxPyPzGlo(pvec2);
-
-              /// PV refit excluding the candidate daughters, if contributors
-              array<float, 3> pvRefitCoord3Prong2Pos1Neg = {collision.posX(), collision.posY(), collision.posZ()}; /// initialize to the original PV
-              array<float, 6> pvRefitCovMatrix3Prong2Pos1Neg = getPrimaryVertex(collision).getCov();               /// initialize to the original PV
-              if constexpr (doPvRefit) {
-                if (fillHistograms) {
-                  registry.fill(HIST("PvRefit/verticesPerCandidate"), 1);
-                }
-                int nCandContr = 3;
-                auto trackFirstIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackPos1.globalIndex());
-                auto trackSecondIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackNeg1.globalIndex());
-                auto trackThirdIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackPos2.globalIndex());
-                bool isTrackFirstContr = true;
-                bool isTrackSecondContr = true;
-                bool isTrackThirdContr = true;
-                if (trackFirstIt == vecPvContributorGlobId.end()) {
-                  /// This track did not contribute to the original PV refit
-                  if (debug) {
-                    LOG(info) << "--- [3 prong] trackPos1 with globalIndex " << trackPos1.globalIndex() << " was not a PV contributor";
-                  }
-                  nCandContr--;
-                  isTrackFirstContr = false;
-                }
-                if (trackSecondIt == vecPvContributorGlobId.end()) {
-                  /// This track did not contribute to the original PV refit
-                  if (debug) {
-                    LOG(info) << "--- [3 prong] trackNeg1 with globalIndex " << trackNeg1.globalIndex() << " was not a PV contributor";
-                  }
-                  nCandContr--;
-                  isTrackSecondContr = false;
+              if (isTrackSecondContr) {
+                vecCandPvContributorGlobId.push_back(trackNeg1.globalIndex());
+              }
+              if (isTrackThirdContr) {
+                vecCandPvContributorGlobId.push_back(trackPos2.globalIndex());
+              }
+
+              if (nCandContr == 3 || nCandContr == 2) {
+                /// At least two of the daughter tracks were used for the original PV refit, let's refit it after excluding them
+                if (debug) {
+                  LOG(info) << "### [3 prong] Calling performPvRefitCandProngs for HF 3 prong candidate, removing " << nCandContr << " daughters";
                 }
-                if (trackThirdIt == vecPvContributorGlobId.end()) {
-                  /// This track did not contribute to the original PV refit
-                  if (debug) {
-                    LOG(info) << "--- [3 prong] trackPos2 with globalIndex " << trackPos2.globalIndex() << " was not a PV contributor";
-                  }
-                  nCandContr--;
-                  isTrackThirdContr = false;
+                performPvRefitCandProngs(collision, bcWithTimeStamps, pvRefitter, vecCandPvContributorGlobId, pvRefitCoord3Prong2Pos1Neg, pvRefitCovMatrix3Prong2Pos1Neg);
+              } else if (nCandContr == 1) {
+                /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
+                if (debug) {
+                  LOG(info) << "####### [3 Prong] nCandContr==" << nCandContr << " ---> just 1 contributor!";
                 }
-
-                // Fill a vector with global ID of candidate daughters that are contributors
-                std::vector<int64_t> vecCandPvContributorGlobId = {};
-                if (isTrackFirstContr) {
-                  vecCandPvContributorGlobId.push_back(trackPos1.globalIndex());
+                if (fillHistograms) {
+                  std::lock_guard<std::mutex> lockRegistry(*mutexRegistry);
+                  registry.fill(HIST("PvRefit/verticesPerCandidate"), 5);
                 }
-                if (isTrackSecondContr) {
-                  vecCandPvContributorGlobId.push_back(trackNeg1.globalIndex());
+                if (isTrackFirstContr && !isTrackSecondContr && !isTrackThirdContr) {
+                  /// the first daughter is contributor, the second and the third are not
+                  pvRefitCoord3Prong2Pos1Neg = {trackPos1.pvRefitX(), trackPos1.pvRefitY(), trackPos1.pvRefitZ()};
+                  pvRefitCovMatrix3Prong2Pos1Neg = {trackPos1.pvRefitSigmaX2(), trackPos1.pvRefitSigmaXY(), trackPos1.pvRefitSigmaY2(), trackPos1.pvRefitSigmaXZ(), trackPos1.pvRefitSigmaYZ(), trackPos1.pvRefitSigmaZ2()};
+                } else if (!isTrackFirstContr && isTrackSecondContr && !isTrackThirdContr) {
+                  /// the second daughter is contributor, the first and the third are not
+                  pvRefitCoord3Prong2Pos1Neg = {trackNeg1.pvRefitX(), trackNeg1.pvRefitY(), trackNeg1.pvRefitZ()};
+                  pvRefitCovMatrix3Prong2Pos1Neg = {trackNeg1.pvRefitSigmaX2(), trackNeg1.pvRefitSigmaXY(), trackNeg1.pvRefitSigmaY2(), trackNeg1.pvRefitSigmaXZ(), trackNeg1.pvRefitSigmaYZ(), trackNeg1.pvRefitSigmaZ2()};
+                } else if (!isTrackFirstContr && !isTrackSecondContr && isTrackThirdContr) {
+                  /// the third daughter is contributor, the first and the second are not
+                  pvRefitCoord3Prong2Pos1Neg = {trackPos2.pvRefitX(), trackPos2.pvRefitY(), trackPos2.pvRefitZ()};
+                  pvRefitCovMatrix3Prong2Pos1Neg = {trackPos2.pvRefitSigmaX2(), trackPos2.pvRefitSigmaXY(), trackPos2.pvRefitSigmaY2(), trackPos2.pvRefitSigmaXZ(), trackPos2.pvRefitSigmaYZ(), trackPos2.pvRefitSigmaZ2()};
                 }
-                if (isTrackThirdContr) {
-                  vecCandPvContributorGlobId.push_back(trackPos2.globalIndex());
+              } else {
+                /// 0 contributors among the HF candidate daughters
+                if (fillHistograms) {
+                  std::lock_guard<std::mutex> lockRegistry(*mutexRegistry);
+                  registry.fill(HIST("PvRefit/verticesPerCandidate"), 6);
                 }
-
-                if (nCandContr == 3 || nCandContr == 2) {
-                  /// At least two of the daughter tracks were used for the original PV refit, let's refit it after excluding them
-                  if (debug) {
-                    LOG(info) << "### [3 prong] Calling performPvRefitCandProngs for HF 3 prong candidate, removing " << nCandContr << " daughters";
-                  }
-                  performPvRefitCandProngs(collision, bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, vecCandPvContributorGlobId, pvRefitCoord3Prong2Pos1Neg, pvRefitCovMatrix3Prong2Pos1Neg);
-                } else if (nCandContr == 1) {
-                  /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
-                  if (debug) {
-                    LOG(info) << "####### [3 Prong] nCandContr==" << nCandContr << " ---> just 1 contributor!";
-                  }
-                  if (fillHistograms) {
-                    registry.fill(HIST("PvRefit/verticesPerCandidate"), 5);
-                  }
-                  if (isTrackFirstContr && !isTrackSecondContr && !isTrackThirdContr) {
-                    /// the first daughter is contributor, the second and the third are not
-                    pvRefitCoord3Prong2Pos1Neg = {trackPos1.pvRefitX(), trackPos1.pvRefitY(), trackPos1.pvRefitZ()};
-                    pvRefitCovMatrix3Prong2Pos1Neg = {trackPos1.pvRefitSigmaX2(), trackPos1.pvRefitSigmaXY(), trackPos1.pvRefitSigmaY2(), trackPos1.pvRefitSigmaXZ(), trackPos1.pvRefitSigmaYZ(), trackPos1.pvRefitSigmaZ2()};
-                  } else if (!isTrackFirstContr && isTrackSecondContr && !isTrackThirdContr) {
-                    /// the second daughter is contributor, the first and the third are not
-                    pvRefitCoord3Prong2Pos1Neg = {trackNeg1.pvRefitX(), trackNeg1.pvRefitY(), trackNeg1.pvRefitZ()};
-                    pvRefitCovMatrix3Prong2Pos1Neg = {trackNeg1.pvRefitSigmaX2(), trackNeg1.pvRefitSigmaXY(), trackNeg1.pvRefitSigmaY2(), trackNeg1.pvRefitSigmaXZ(), trackNeg1.pvRefitSigmaYZ(), trackNeg1.pvRefitSigmaZ2()};
-                  } else if (!isTrackFirstContr && !isTrackSecondContr && isTrackThirdContr) {
-                    /// the third daughter is contributor, the first and the second are not
-                    pvRefitCoord3Prong2Pos1Neg = {trackPos2.pvRefitX(), trackPos2.pvRefitY(), trackPos2.pvRefitZ()};
-                    pvRefitCovMatrix3Prong2Pos1Neg = {trackPos2.pvRefitSigmaX2(), trackPos2.pvRefitSigmaXY(), trackPos2.pvRefitSigmaY2(), trackPos2.pvRefitSigmaXZ(), trackPos2.pvRefitSigmaYZ(), trackPos2.pvRefitSigmaZ2()};
-                  }
-                } else {
-                  /// 0 contributors among the HF candidate daughters
-                  if (fillHistograms) {
-                    registry.fill(HIST("PvRefit/verticesPerCandidate"), 6);
-                  }
-                  if (debug) {
-                    LOG(info) << "####### [3 prong] nCandContr==" << nCandContr << " ---> some of the candidate daughters did not contribute to the original PV fit, PV refit not redone";
-                  }
+                if (debug) {
+                  LOG(info) << "####### [3 prong] nCandContr==" << nCandContr << " ---> some of the candidate daughters did not contribute to the original PV fit, PV refit not redone";
                 }
               }
+            }
 
-              auto pVecCandProng3Pos = RecoDecay::pVec(pvec0, pvec1, pvec2);
-              // 3-prong selections after secondary vertex
-              array<float, 3> pvCoord3Prong2Pos1Neg = {collision.posX(), collision.posY(), collision.posZ()};
-              if constexpr (doPvRefit) {
-                pvCoord3Prong2Pos1Neg[0] = pvRefitCoord3Prong2Pos1Neg[0];
-                pvCoord3Prong2Pos1Neg[1] = pvRefitCoord3Prong2Pos1Neg[1];
-                pvCoord3Prong2Pos1Neg[2] = pvRefitCoord3Prong2Pos1Neg[2];
-              }
-              is3ProngSelected(pVecCandProng3Pos, secondaryVertex3, pvCoord3Prong2Pos1Neg, cutStatus3Prong, isSelected3ProngCand);
-              if (!debug && isSelected3ProngCand == 0) {
-                continue;
-              }
+            auto pVecCandProng3Pos = RecoDecay::pVec(pvec0, pvec1, pvec2);
+            // 3-prong selections after secondary vertex
+            array<float, 3> pvCoord3Prong2Pos1Neg = {collision.posX(), collision.posY(), collision.posZ()};
+            if constexpr (doPvRefit) {
+              pvCoord3Prong2Pos1Neg[0] = pvRefitCoord3Prong2Pos1Neg[0];
+              pvCoord3Prong2Pos1Neg[1] = pvRefitCoord3Prong2Pos1Neg[1];
+              pvCoord3Prong2Pos1Neg[2] = pvRefitCoord3Prong2Pos1Neg[2];
+            }
+            is3ProngSelected(pVecCandProng3Pos, secondaryVertex3, pvCoord3Prong2Pos1Neg, cutStatus3Prong, isSelected3ProngCand);
+            if (!debug && isSelected3ProngCand == 0) {
+              continue;
+            }
 
-              // fill table row
-              rowTrackIndexProng3(thisCollId, trackPos1.globalIndex(), trackNeg1.globalIndex(), trackPos2.globalIndex(), isSelected3ProngCand);
-              if constexpr (doPvRefit) {
-                // fill table row of coordinates of PV refit
-                rowProng3PVrefit(pvRefitCoord3Prong2Pos1Neg[0], pvRefitCoord3Prong2Pos1Neg[1], pvRefitCoord3Prong2Pos1Neg[2],
-                                 pvRefitCovMatrix3Prong2Pos1Neg[0], pvRefitCovMatrix3Prong2Pos1Neg[1], pvRefitCovMatrix3Prong2Pos1Neg[2], pvRefitCovMatrix3Prong2Pos1Neg[3], pvRefitCovMatrix3Prong2Pos1Neg[4], pvRefitCovMatrix3Prong2Pos1Neg[5]);
-              }
+            // fill table row
+            candidates.prong3.push_back({thisCollId, trackPos1.globalIndex(), trackNeg1.globalIndex(), trackPos2.globalIndex(), isSelected3ProngCand});
+            if constexpr (doPvRefit) {
+              // fill table row of coordinates of PV refit
+              candidates.pvRefit3Prong.push_back({pvRefitCoord3Prong2Pos1Neg[0], pvRefitCoord3Prong2Pos1Neg[1], pvRefitCoord3Prong2Pos1Neg[2],
+                                                  pvRefitCovMatrix3Prong2Pos1Neg[0], pvRefitCovMatrix3Prong2Pos1Neg[1], pvRefitCovMatrix3Prong2Pos1Neg[2], pvRefitCovMatrix3Prong2Pos1Neg[3], pvRefitCovMatrix3Prong2Pos1Neg[4], pvRefitCovMatrix3Prong2Pos1Neg[5]});
+            }
 
-              if (debug) {
-                int Prong3CutStatus[kN3ProngDecays];
-                for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
-                  Prong3CutStatus[iDecay3P] = nCutStatus3ProngBit;
-                  for (int iCut = 0; iCut < kNCuts3Prong; iCut++) {
-                    if (!cutStatus3Prong[iDecay3P][iCut]) {
-                      CLRBIT(Prong3CutStatus[iDecay3P], iCut);
-                    }
+            if (debug) {
+              int Prong3CutStatus[kN3ProngDecays];
+              for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
+                Prong3CutStatus[iDecay3P] = nCutStatus3ProngBit;
+                for (int iCut = 0; iCut < kNCuts3Prong; iCut++) {
+                  if (!cutStatus3Prong[iDecay3P][iCut]) {
+                    CLRBIT(Prong3CutStatus[iDecay3P], iCut);
                   }
                 }
-                rowProng3CutStatus(Prong3CutStatus[0], Prong3CutStatus[1], Prong3CutStatus[2], Prong3CutStatus[3]); // FIXME when we can do this by looping over kN3ProngDecays
               }
+              candidates.cutStatus3Prong.push_back({Prong3CutStatus[0], Prong3CutStatus[1], Prong3CutStatus[2], Prong3CutStatus[3]}); // FIXME when we can do this by looping over kN3ProngDecays
+            }
 
-              // fill histograms
-              if (fillHistograms) {
-                registry.fill(HIST("hVtx3ProngX"), secondaryVertex3[0]);
-                registry.fill(HIST("hVtx3ProngY"), secondaryVertex3[1]);
-                registry.fill(HIST("hVtx3ProngZ"), secondaryVertex3[2]);
-                array<array<float, 3>, 3> arr3Mom = {pvec0, pvec1, pvec2};
-                for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
-                  if (TESTBIT(isSelected3ProngCand, iDecay3P)) {
-                    if (whichHypo3Prong[iDecay3P] == 1 || whichHypo3Prong[iDecay3P] == 3) {
-                      auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][0]);
-                      switch (iDecay3P) {
-                        case hf_cand_3prong::DecayType::DplusToPiKPi:
-                          registry.fill(HIST("hMassDPlusToPiKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::DsToKKPi:
-                          registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::LcToPKPi:
-                          registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::XicToPKPi:
-                          registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
-                          break;
-                      }
+            // fill histograms
+            if (fillHistograms) {
+              std::lock_guard<std::mutex> lockRegistry(*mutexRegistry);
+              registry.fill(HIST("hVtx3ProngX"), secondaryVertex3[0]);
+              registry.fill(HIST("hVtx3ProngY"), secondaryVertex3[1]);
+              registry.fill(HIST("hVtx3ProngZ"), secondaryVertex3[2]);
+              array<array<float, 3>, 3> arr3Mom = {pvec0, pvec1, pvec2};
+              for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
+                if (TESTBIT(isSelected3ProngCand, iDecay3P)) {
+                  if (whichHypo3Prong[iDecay3P] == 1 || whichHypo3Prong[iDecay3P] == 3) {
+                    auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][0]);
+                    switch (iDecay3P) {
+                      case hf_cand_3prong::DecayType::DplusToPiKPi:
+                        registry.fill(HIST("hMassDPlusToPiKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::DsToKKPi:
+                        registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::LcToPKPi:
+                        registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::XicToPKPi:
+                        registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
+                        break;
                     }
-                    if (whichHypo3Prong[iDecay3P] >= 2) {
-                      auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][1]);
-                      switch (iDecay3P) {
-                        case hf_cand_3prong::DecayType::DsToKKPi:
-                          registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::LcToPKPi:
-                          registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::XicToPKPi:
-                          registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
-                          break;
-                      }
+                  }
+                  if (whichHypo3Prong[iDecay3P] >= 2) {
+                    auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][1]);
+                    switch (iDecay3P) {
+                      case hf_cand_3prong::DecayType::DsToKKPi:
+                        registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::LcToPKPi:
+                        registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::XicToPKPi:
+                        registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
+                        break;
                     }
                   }
                 }
               }
             }
+          }
 
-            // second loop over negative tracks
-            // for (auto trackNeg2 = trackNeg1 + 1; trackNeg2 != tracksNeg.end(); ++trackNeg2) {
-            for (auto trackIndexNeg2 = trackIndexNeg1 + 1; trackIndexNeg2 != groupedTrackIndices.end(); ++trackIndexNeg2) {
-              auto trackNeg2 = trackIndexNeg2.template track_as<TTracks>();
-              if (trackNeg2.signed1Pt() > 0) {
-                continue;
-              }
+          // second loop over negative tracks
+          for (size_t iNeg2 = iNeg1 + 1; iNeg2 < prongsNeg.size(); ++iNeg2) {
+            const auto& prongNeg2 = prongsNeg[iNeg2];
+            if (!debug && prongPos1.pt + prongNeg1.pt + prongNeg2.pt + ptTolerance < ptMin3Prong) {
+              break;
+            }
+            if (!prongNeg2.sel3Prong) {
+              continue;
+            }
+            const auto& trackNeg2 = prongNeg2.track;
+            if (trackNeg2.globalIndex() == trackPos1.globalIndex()) {
+              continue;
+            }
+            const auto& trackParVarNeg2 = prongNeg2.trackParVar;
+            const auto& pVecTrackNeg2 = prongNeg2.pVec;
 
-              // retrieve the selection flag that corresponds to this collision
-              auto isSelProngNeg2 = trackIndexNeg2.isSelProng();
-              if (!TESTBIT(isSelProngNeg2, CandidateType::Cand3Prong)) {
-                continue;
-              }
+            int isSelected3ProngCand = n3ProngBit;
 
-              auto trackParVarNeg2 = getTrackParCov(trackNeg2);
-              std::array<float, 3> pVecTrackNeg2{trackNeg2.px(), trackNeg2.py(), trackNeg2.pz()};
-              o2::gpu::gpustd::array<float, 2> dcaInfoNeg2{trackNeg2.dcaXY(), trackNeg2.dcaZ()};
-              if (thisCollId != trackNeg2.collisionId()) { // this is not the "default" collision for this track, we have to re-propagate it
-                o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarNeg2, 2.f, noMatCorr, &dcaInfoNeg2);
-                getPxPyPz(trackParVarNeg2, pVecTrackNeg2);
+            if (debug) {
+              for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
+                for (int iCut = 0; iCut < kNCuts3Prong; iCut++) {
+                  cutStatus3Prong[iDecay3P][iCut] = true;
+                }
               }
+            }
 
-              int isSelected3ProngCand = n3ProngBit;
+            // 3-prong preselections
+            is3ProngPreselected(pVecTrackNeg1, pVecTrackPos1, pVecTrackNeg2, cutStatus3Prong, whichHypo3Prong, isSelected3ProngCand);
+            if (!debug && isSelected3ProngCand == 0) {
+              continue;
+            }
 
-              if (debug) {
-                for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
-                  for (int iCut = 0; iCut < kNCuts3Prong; iCut++) {
-                    cutStatus3Prong[iDecay3P][iCut] = true;
-                  }
+            // reconstruct the 3-prong secondary vertex
+            if (df3.process(trackParVarNeg1, trackParVarPos1, trackParVarNeg2) == 0) {
+              continue;
+            }
+
+            // get secondary vertex
+            const auto& secondaryVertex3 = df3.getPCACandidate();
+            // get track momenta
+            array<float, 3> pvec0;
+            array<float, 3> pvec1;
+            array<float, 3> pvec2;
+            df3.getTrack(0).getPxPyPzGlo(pvec0);
+            df3.getTrack(1).getPxPyPzGlo(pvec1);
+            df3.getTrack(2).getPxPyPzGlo(pvec2);
+
+            /// PV refit excluding the candidate daughters, if contributors
+            array<float, 3> pvRefitCoord3Prong1Pos2Neg = {collision.posX(), collision.posY(), collision.posZ()}; /// initialize to the original PV
+            array<float, 6> pvRefitCovMatrix3Prong1Pos2Neg = getPrimaryVertex(collision).getCov();               /// initialize to the original PV
+            if constexpr (doPvRefit) {
+              if (fillHistograms) {
+                std::lock_guard<std::mutex> lockRegistry(*mutexRegistry);
+                registry.fill(HIST("PvRefit/verticesPerCandidate"), 1);
+              }
+              int nCandContr = 3;
+              bool isTrackFirstContr = true;
+              bool isTrackSecondContr = true;
+              bool isTrackThirdContr = true;
+              if (!pvRefitter.isContributor(trackPos1.globalIndex())) {
+                /// This track did not contribute to the original PV refit
+                if (debug) {
+                  LOG(info) << "--- [3 prong] trackPos1 with globalIndex " << trackPos1.globalIndex() << " was not a PV contributor";
                 }
+                nCandContr--;
+                isTrackFirstContr = false;
               }
-
-              // 3-prong preselections
-              is3ProngPreselected(pVecTrackNeg1, pVecTrackPos1, pVecTrackNeg2, cutStatus3Prong, whichHypo3Prong, isSelected3ProngCand);
-              if (!debug && isSelected3ProngCand == 0) {
-                continue;
+              if (!pvRefitter.isContributor(trackNeg1.globalIndex())) {
+                /// This track did not contribute to the original PV refit
+                if (debug) {
+                  LOG(info) << "--- [3 prong] trackNeg1 with globalIndex " << trackNeg1.globalIndex() << " was not a PV contributor";
+                }
+                nCandContr--;
+                isTrackSecondContr = false;
+              }
+              if (!pvRefitter.isContributor(trackNeg2.globalIndex())) {
+                /// This track did not contribute to the original PV refit
+                if (debug) {
+                  LOG(info) << "--- [3 prong] trackNeg2 with globalIndex " << trackNeg2.globalIndex() << " was not a PV contributor";
+                }
+                nCandContr--;
+                isTrackThirdContr = false;
               }
 
-              // reconstruct the 3-prong secondary vertex
-              if (df3.process(trackParVarNeg1, trackParVarPos1, trackParVarNeg2) == 0) {
-                continue;
+              // Fill a vector with global ID of candidate daughters that are contributors
+              std::vector<int64_t> vecCandPvContributorGlobId = {};
+              if (isTrackFirstContr) {
+                vecCandPvContributorGlobId.push_back(trackPos1.globalIndex());
+              }
+              if (isTrackSecondContr) {
+                vecCandPvContributorGlobId.push_back(trackNeg1.globalIndex());
+              }
+              if (isTrackThirdContr) {
+                vecCandPvContributorGlobId.push_back(trackNeg2.globalIndex());
               }
 
-              // get secondary vertex
-              const auto& secondaryVertex3 = df3.getPCACandidate();
-              // get track momenta
-              array<float, 3> pvec0;
-              array<float, 3> pvec1;
-              array<float, 3> pvec2;
-              df3.getTrack(0).getPxPyPzGlo(pvec0);
-              df3.getTrack(1).getPxPyPzGlo(pvec1);
-              df3.getTrack(2).getPxPyPzGlo(pvec2);
-
-              /// PV refit excluding the candidate daughters, if contributors
-              array<float, 3> pvRefitCoord3Prong1Pos2Neg = {collision.posX(), collision.posY(), collision.posZ()}; /// initialize to the original PV
-              array<float, 6> pvRefitCovMatrix3Prong1Pos2Neg = getPrimaryVertex(collision).getCov();               /// initialize to the original PV
-              if constexpr (doPvRefit) {
-                if (fillHistograms) {
-                  registry.fill(HIST("PvRefit/verticesPerCandidate"), 1);
-                }
-                int nCandContr = 3;
-                auto trackFirstIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackPos1.globalIndex());
-                auto trackSecondIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackNeg1.globalIndex());
-                auto trackThirdIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackNeg2.globalIndex());
-                bool isTrackFirstContr = true;
-                bool isTrackSecondContr = true;
-                bool isTrackThirdContr = true;
-                if (trackFirstIt == vecPvContributorGlobId.end()) {
-                  /// This track did not contribute to the original PV refit
-                  if (debug) {
-                    LOG(info) << "--- [3 prong] trackPos1 with globalIndex " << trackPos1.globalIndex() << " was not a PV contributor";
-                  }
-                  nCandContr--;
-                  isTrackFirstContr = false;
-                }
-                if (trackSecondIt == vecPvContributorGlobId.end()) {
-                  /// This track did not contribute to the original PV refit
-                  if (debug) {
-                    LOG(info) << "--- [3 prong] trackNeg1 with globalIndex " << trackNeg1.globalIndex() << " was not a PV contributor";
-                  }
-                  nCandContr--;
-                  isTrackSecondContr = false;
+              if (nCandContr == 3 || nCandContr == 2) {
+                /// At least two of the daughter tracks were used for the original PV refit, let's refit it after excluding them
+                if (debug) {
+                  LOG(info) << "### [3 prong] Calling performPvRefitCandProngs for HF 3 prong candidate, removing " << nCandContr << " daughters";
                 }
-                if (trackThirdIt == vecPvContributorGlobId.end()) {
-                  /// This track did not contribute to the original PV refit
-                  if (debug) {
-                    LOG(info) << "--- [3 prong] trackNeg2 with globalIndex " << trackNeg2.globalIndex() << " was not a PV contributor";
-                  }
-                  nCandContr--;
-                  isTrackThirdContr = false;
+                performPvRefitCandProngs(collision, bcWithTimeStamps, pvRefitter, vecCandPvContributorGlobId, pvRefitCoord3Prong1Pos2Neg, pvRefitCovMatrix3Prong1Pos2Neg);
+              } else if (nCandContr == 1) {
+                /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
+                if (debug) {
+                  LOG(info) << "####### [3 Prong] nCandContr==" << nCandContr << " ---> just 1 contributor!";
                 }
-
-                // Fill a vector with global ID of candidate daughters that are contributors
-                std::vector<int64_t> vecCandPvContributorGlobId = {};
-                if (isTrackFirstContr) {
-                  vecCandPvContributorGlobId.push_back(trackPos1.globalIndex());
+                if (fillHistograms) {
+                  std::lock_guard<std::mutex> lockRegistry(*mutexRegistry);
+                  registry.fill(HIST("PvRefit/verticesPerCandidate"), 5);
                 }
-                if (isTrackSecondContr) {
-                  vecCandPvContributorGlobId.push_back(trackNeg1.globalIndex());
+                if (isTrackFirstContr && !isTrackSecondContr && !isTrackThirdContr) {
+                  /// the first daughter is contributor, the second and the third are not
+                  pvRefitCoord3Prong1Pos2Neg = {trackPos1.pvRefitX(), trackPos1.pvRefitY(), trackPos1.pvRefitZ()};
+                  pvRefitCovMatrix3Prong1Pos2Neg = {trackPos1.pvRefitSigmaX2(), trackPos1.pvRefitSigmaXY(), trackPos1.pvRefitSigmaY2(), trackPos1.pvRefitSigmaXZ(), trackPos1.pvRefitSigmaYZ(), trackPos1.pvRefitSigmaZ2()};
+                } else if (!isTrackFirstContr && isTrackSecondContr && !isTrackThirdContr) {
+                  /// the second daughter is contributor, the first and the third are not
+                  pvRefitCoord3Prong1Pos2Neg = {trackNeg1.pvRefitX(), trackNeg1.pvRefitY(), trackNeg1.pvRefitZ()};
+                  pvRefitCovMatrix3Prong1Pos2Neg = {trackNeg1.pvRefitSigmaX2(), trackNeg1.pvRefitSigmaXY(), trackNeg1.pvRefitSigmaY2(), trackNeg1.pvRefitSigmaXZ(), trackNeg1.pvRefitSigmaYZ(), trackNeg1.pvRefitSigmaZ2()};
+                } else if (!isTrackFirstContr && !isTrackSecondContr && isTrackThirdContr) {
+                  /// the third daughter is contributor, the first and the second are not
+                  pvRefitCoord3Prong1Pos2Neg = {trackNeg2.pvRefitX(), trackNeg2.pvRefitY(), trackNeg2.pvRefitZ()};
+                  pvRefitCovMatrix3Prong1Pos2Neg = {trackNeg2.pvRefitSigmaX2(), trackNeg2.pvRefitSigmaXY(), trackNeg2.pvRefitSigmaY2(), trackNeg2.pvRefitSigmaXZ(), trackNeg2.pvRefitSigmaYZ(), trackNeg2.pvRefitSigmaZ2()};
                 }
-                if (isTrackThirdContr) {
-                  vecCandPvContributorGlobId.push_back(trackNeg2.globalIndex());
+              } else {
+                /// 0 contributors among the HF candidate daughters
+                if (fillHistograms) {
+                  std::lock_guard<std::mutex> lockRegistry(*mutexRegistry);
+                  registry.fill(HIST("PvRefit/verticesPerCandidate"), 6);
                 }
-
-                if (nCandContr == 3 || nCandContr == 2) {
-                  /// At least two of the daughter tracks were used for the original PV refit, let's refit it after excluding them
-                  if (debug) {
-                    LOG(info) << "### [3 prong] Calling performPvRefitCandProngs for HF 3 prong candidate, removing " << nCandContr << " daughters";
-                  }
-                  performPvRefitCandProngs(collision, bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, vecCandPvContributorGlobId, pvRefitCoord3Prong1Pos2Neg, pvRefitCovMatrix3Prong1Pos2Neg);
-                } else if (nCandContr == 1) {
-                  /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
-                  if (debug) {
-                    LOG(info) << "####### [3 Prong] nCandContr==" << nCandContr << " ---> just 1 contributor!";
-                  }
-                  if (fillHistograms) {
-                    registry.fill(HIST("PvRefit/verticesPerCandidate"), 5);
-                  }
-                  if (isTrackFirstContr && !isTrackSecondContr && !isTrackThirdContr) {
-                    /// the first daughter is contributor, the second and the third are not
-                    pvRefitCoord3Prong1Pos2Neg = {trackPos1.pvRefitX(), trackPos1.pvRefitY(), trackPos1.pvRefitZ()};
-                    pvRefitCovMatrix3Prong1Pos2Neg = {trackPos1.pvRefitSigmaX2(), trackPos1.pvRefitSigmaXY(), trackPos1.pvRefitSigmaY2(), trackPos1.pvRefitSigmaXZ(), trackPos1.pvRefitSigmaYZ(), trackPos1.pvRefitSigmaZ2()};
-                  } else if (!isTrackFirstContr && isTrackSecondContr && !isTrackThirdContr) {
-                    /// the second daughter is contributor, the first and the third are not
-                    pvRefitCoord3Prong1Pos2Neg = {trackNeg1.pvRefitX(), trackNeg1.pvRefitY(), trackNeg1.pvRefitZ()};
-                    pvRefitCovMatrix3Prong1Pos2Neg = {trackNeg1.pvRefitSigmaX2(), trackNeg1.pvRefitSigmaXY(), trackNeg1.pvRefitSigmaY2(), trackNeg1.pvRefitSigmaXZ(), trackNeg1.pvRefitSigmaYZ(), trackNeg1.pvRefitSigmaZ2()};
-                  } else if (!isTrackFirstContr && !isTrackSecondContr && isTrackThirdContr) {
-                    /// the third daughter is contributor, the first and the second are not
-                    pvRefitCoord3Prong1Pos2Neg = {trackNeg2.pvRefitX(), trackNeg2.pvRefitY(), trackNeg2.pvRefitZ()};
-                    pvRefitCovMatrix3Prong1Pos2Neg = {trackNeg2.pvRefitSigmaX2(), trackNeg2.pvRefitSigmaXY(), trackNeg2.pvRefitSigmaY2(), trackNeg2.pvRefitSigmaXZ(), trackNeg2.pvRefitSigmaYZ(), trackNeg2.pvRefitSigmaZ2()};
-                  }
-                } else {
-                  /// 0 contributors among the HF candidate daughters
-                  if (fillHistograms) {
-                    registry.fill(HIST("PvRefit/verticesPerCandidate"), 6);
-                  }
-                  if (debug) {
-                    LOG(info) << "####### [3 prong] nCandContr==" << nCandContr << " ---> some of the candidate daughters did not contribute to the original PV fit, PV refit not redone";
-                  }
+                if (debug) {
+                  LOG(info) << "####### [3 prong] nCandContr==" << nCandContr << " ---> some of the candidate daughters did not contribute to the original PV fit, PV refit not redone";
                 }
               }
+            }
 
-              auto pVecCandProng3Neg = RecoDecay::pVec(pvec0, pvec1, pvec2);
-              // 3-prong selections after secondary vertex
-              array<float, 3> pvCoord3Prong1Pos2Neg = {collision.posX(), collision.posY(), collision.posZ()};
-              if constexpr (doPvRefit) {
-                pvCoord3Prong1Pos2Neg[0] = pvRefitCoord3Prong1Pos2Neg[0];
-                pvCoord3Prong1Pos2Neg[1] = pvRefitCoord3Prong1Pos2Neg[1];
-                pvCoord3Prong1Pos2Neg[2] = pvRefitCoord3Prong1Pos2Neg[2];
-              }
-              is3ProngSelected(pVecCandProng3Neg, secondaryVertex3, pvCoord3Prong1Pos2Neg, cutStatus3Prong, isSelected3ProngCand);
-              if (!debug && isSelected3ProngCand == 0) {
-                continue;
-              }
+            auto pVecCandProng3Neg = RecoDecay::pVec(pvec0, pvec1, pvec2);
+            // 3-prong selections after secondary vertex
+            array<float, 3> pvCoord3Prong1Pos2Neg = {collision.posX(), collision.posY(), collision.posZ()};
+            if constexpr (doPvRefit) {
+              pvCoord3Prong1Pos2Neg[0] = pvRefitCoord3Prong1Pos2Neg[0];
+              pvCoord3Prong1Pos2Neg[1] = pvRefitCoord3Prong1Pos2Neg[1];
+              pvCoord3Prong1Pos2Neg[2] = pvRefitCoord3Prong1Pos2Neg[2];
+            }
+            is3ProngSelected(pVecCandProng3Neg, secondaryVertex3, pvCoord3Prong1Pos2Neg, cutStatus3Prong, isSelected3ProngCand);
+            if (!debug && isSelected3ProngCand == 0) {
+              continue;
+            }
 
-              // fill table row
-              rowTrackIndexProng3(thisCollId, trackNeg1.globalIndex(), trackPos1.globalIndex(), trackNeg2.globalIndex(), isSelected3ProngCand);
-              // fill table row of coordinates of PV refit
-              rowProng3PVrefit(pvRefitCoord3Prong1Pos2Neg[0], pvRefitCoord3Prong1Pos2Neg[1], pvRefitCoord3Prong1Pos2Neg[2],
-                               pvRefitCovMatrix3Prong1Pos2Neg[0], pvRefitCovMatrix3Prong1Pos2Neg[1], pvRefitCovMatrix3Prong1Pos2Neg[2], pvRefitCovMatrix3Prong1Pos2Neg[3], pvRefitCovMatrix3Prong1Pos2Neg[4], pvRefitCovMatrix3Prong1Pos2Neg[5]);
+            // fill table row
+            candidates.prong3.push_back({thisCollId, trackNeg1.globalIndex(), trackPos1.globalIndex(), trackNeg2.globalIndex(), isSelected3ProngCand});
+            // fill table row of coordinates of PV refit
+            candidates.pvRefit3Prong.push_back({pvRefitCoord3Prong1Pos2Neg[0], pvRefitCoord3Prong1Pos2Neg[1], pvRefitCoord3Prong1Pos2Neg[2],
+                                                pvRefitCovMatrix3Prong1Pos2Neg[0], pvRefitCovMatrix3Prong1Pos2Neg[1], pvRefitCovMatrix3Prong1Pos2Neg[2], pvRefitCovMatrix3Prong1Pos2Neg[3], pvRefitCovMatrix3Prong1Pos2Neg[4], pvRefitCovMatrix3Prong1Pos2Neg[5]});
 
-              if (debug) {
-                int Prong3CutStatus[kN3ProngDecays];
-                for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
-                  Prong3CutStatus[iDecay3P] = nCutStatus3ProngBit;
-                  for (int iCut = 0; iCut < kNCuts3Prong; iCut++) {
-                    if (!cutStatus3Prong[iDecay3P][iCut]) {
-                      CLRBIT(Prong3CutStatus[iDecay3P], iCut);
-                    }
+            if (debug) {
+              int Prong3CutStatus[kN3ProngDecays];
+              for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
+                Prong3CutStatus[iDecay3P] = nCutStatus3ProngBit;
+                for (int iCut = 0; iCut < kNCuts3Prong; iCut++) {
+                  if (!cutStatus3Prong[iDecay3P][iCut]) {
+                    CLRBIT(Prong3CutStatus[iDecay3P], iCut);
                   }
                 }
-                rowProng3CutStatus(Prong3CutStatus[0], Prong3CutStatus[1], Prong3CutStatus[2], Prong3CutStatus[3]); // FIXME when we can do this by looping over kN3ProngDecays
               }
+              candidates.cutStatus3Prong.push_back({Prong3CutStatus[0], Prong3CutStatus[1], Prong3CutStatus[2], Prong3CutStatus[3]}); // FIXME when we can do this by looping over kN3ProngDecays
+            }
 
-              // fill histograms
-              if (fillHistograms) {
-                registry.fill(HIST("hVtx3ProngX"), secondaryVertex3[0]);
-                registry.fill(HIST("hVtx3ProngY"), secondaryVertex3[1]);
-                registry.fill(HIST("hVtx3ProngZ"), secondaryVertex3[2]);
-                array<array<float, 3>, 3> arr3Mom = {pvec0, pvec1, pvec2};
-                for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
-                  if (TESTBIT(isSelected3ProngCand, iDecay3P)) {
-                    if (whichHypo3Prong[iDecay3P] == 1 || whichHypo3Prong[iDecay3P] == 3) {
-                      auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][0]);
-                      switch (iDecay3P) {
-                        case hf_cand_3prong::DecayType::DplusToPiKPi:
-                          registry.fill(HIST("hMassDPlusToPiKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::DsToKKPi:
-                          registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::LcToPKPi:
-                          registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::XicToPKPi:
-                          registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
-                          break;
-                      }
+            // fill histograms
+            if (fillHistograms) {
+              std::lock_guard<std::mutex> lockRegistry(*mutexRegistry);
+              registry.fill(HIST("hVtx3ProngX"), secondaryVertex3[0]);
+              registry.fill(HIST("hVtx3ProngY"), secondaryVertex3[1]);
+              registry.fill(HIST("hVtx3ProngZ"), secondaryVertex3[2]);
+              array<array<float, 3>, 3> arr3Mom = {pvec0, pvec1, pvec2};
+              for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
+                if (TESTBIT(isSelected3ProngCand, iDecay3P)) {
+                  if (whichHypo3Prong[iDecay3P] == 1 || whichHypo3Prong[iDecay3P] == 3) {
+                    auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][0]);
+                    switch (iDecay3P) {
+                      case hf_cand_3prong::DecayType::DplusToPiKPi:
+                        registry.fill(HIST("hMassDPlusToPiKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::DsToKKPi:
+                        registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::LcToPKPi:
+                        registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::XicToPKPi:
+                        registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
+                        break;
                     }
-                    if (whichHypo3Prong[iDecay3P] >= 2) {
-                      auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][1]);
-                      switch (iDecay3P) {
-                        case hf_cand_3prong::DecayType::DsToKKPi:
-                          registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::LcToPKPi:
-                          registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::XicToPKPi:
-                          registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
-                          break;
-                      }
+                  }
+                  if (whichHypo3Prong[iDecay3P] >= 2) {
+                    auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][1]);
+                    switch (iDecay3P) {
+                      case hf_cand_3prong::DecayType::DsToKKPi:
+                        registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::LcToPKPi:
+                        registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::XicToPKPi:
+                        registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
+                        break;
                     }
                   }
                 }
@@ -2240,20 +2353,94 @@ struct HfTrackIndexSkimCreator {
           }
         }
       }
+    }
 
-      int nTracks = 0;
-      // auto nTracks = trackIndicesPerCollision.lastIndex() - trackIndicesPerCollision.firstIndex(); // number of tracks passing 2 and 3 prong selection in this collision
-      nCand2 = rowTrackIndexProng2.lastIndex() - nCand2; // number of 2-prong candidates in this collision
-      nCand3 = rowTrackIndexProng3.lastIndex() - nCand3; // number of 3-prong candidates in this collision
+    int nTracks = 0;
+    // auto nTracks = trackIndicesPerCollision.lastIndex() - trackIndicesPerCollision.firstIndex(); // number of tracks passing 2 and 3 prong selection in this collision
+    int nCand2 = candidates.prong2.size(); // number of 2-prong candidates in this collision
+    int nCand3 = candidates.prong3.size(); // number of 3-prong candidates in this collision
 
-      if (fillHistograms) {
-        registry.fill(HIST("hNTracks"), nTracks);
-        registry.fill(HIST("hNCand2Prong"), nCand2);
-        registry.fill(HIST("hNCand3Prong"), nCand3);
-        registry.fill(HIST("hNCand2ProngVsNTracks"), nTracks, nCand2);
-        registry.fill(HIST("hNCand3ProngVsNTracks"), nTracks, nCand3);
+    if (fillHistograms) {
+      std::lock_guard<std::mutex> lockRegistry(*mutexRegistry);
+      registry.fill(HIST("hNTracks"), nTracks);
+      registry.fill(HIST("hNCand2Prong"), nCand2);
+      registry.fill(HIST("hNCand3Prong"), nCand3);
+      registry.fill(HIST("hNCand2ProngVsNTracks"), nTracks, nCand2);
+      registry.fill(HIST("hNCand3ProngVsNTracks"), nTracks, nCand3);
+    }
+  } /// end of run2And3ProngsCollision function
+
+  template <bool doPvRefit = false, typename TTracks>
+  void run2And3Prongs(SelectedCollisions const& collisions,
+                      aod::BCsWithTimestamps const& bcWithTimeStamps,
+                      FilteredTrackAssocSel const& trackIndices,
+                      TTracks const& tracks)
+  {
+
+    // can be added to run over limited collisions per file - for tesing purposes
+    /*
+    if (nCollsMax > -1){
+      if (nColls == nCollMax){
+        return;
+        //can be added to run over limited collisions per file - for tesing purposes
       }
+      nColls++;
     }
+    */
+
+    // the PV refit is not thread safe, in that case the collisions are processed sequentially
+    const int nWorkers = doPvRefit ? 1 : std::max(1, nThreadsProngs.value);
+    std::vector<ProngWorker<TTracks>> workers(nWorkers);
+    std::vector<CollisionCandidates> candidates;
+    std::vector<SelectedCollisions::iterator> batch;
+
+    // combinatorics of a batch of collisions of the same run, the candidates are written in collision order
+    auto processBatch = [&]() {
+      if (batch.empty()) {
+        return;
+      }
+      for (auto& worker : workers) {
+        setupProngWorker(worker);
+      }
+      if (nWorkers == 1) {
+        candidates.resize(1);
+        for (const auto& collision : batch) {
+          candidates[0].clear();
+          run2And3ProngsCollision<doPvRefit>(collision, bcWithTimeStamps, trackIndices, tracks, workers[0], candidates[0]);
+          fillCandidateTables(candidates[0]);
+        }
+      } else {
+        candidates.resize(batch.size());
+        std::atomic<size_t> nextCollision{0};
+        std::vector<std::thread> threads;
+        for (auto& worker : workers) {
+          threads.emplace_back([&, workerPtr = &worker]() {
+            for (size_t iColl = nextCollision++; iColl < batch.size(); iColl = nextCollision++) {
+              candidates[iColl].clear();
+              run2And3ProngsCollision<doPvRefit>(batch[iColl], bcWithTimeStamps, trackIndices, tracks, *workerPtr, candidates[iColl]);
+            }
+          });
+        }
+        for (auto& thread : threads) {
+          thread.join();
+        }
+        for (size_t iColl = 0; iColl < batch.size(); iColl++) {
+          fillCandidateTables(candidates[iColl]);
+        }
+      }
+      batch.clear();
+    };
+
+    for (const auto& collision : collisions) {
+      // set the magnetic field from CCDB, after processing the collisions of the previous run
+      auto bc = collision.bc_as<o2::aod::BCsWithTimestamps>();
+      if (bc.runNumber() != runNumber) {
+        processBatch();
+        initCCDB(bc, runNumber, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2);
+      }
+      batch.push_back(collision);
+    }
+    processBatch();
   } /// end of run2And3Prongs function
 
   void processNo2And3Prongs(SelectedCollisions const&)
@@ -2268,6 +2455,7 @@ struct HfTrackIndexSkimCreator {
     FilteredTrackAssocSel const& trackIndices,
     TracksWithPVRefitAndDCA const& tracks)
   {
+    o2::common::ScopedTimer timer(timer2And3Prongs, trackIndices.size());
     run2And3Prongs<true>(collisions, bcWithTimeStamps, trackIndices, tracks);
   }
 
@@ -2279,6 +2467,7 @@ struct HfTrackIndexSkimCreator {
     FilteredTrackAssocSel const& trackIndices,
     TracksWithDCA const& tracks)
   {
+    o2::common::ScopedTimer timer(timer2And3Prongs, trackIndices.size());
     run2And3Prongs(collisions, bcWithTimeStamps, trackIndices, tracks);
   }
 
@@ -2368,6 +2557,21 @@ struct HfTrackIndexSkimCreatorCascades {
   Preslice<FilteredTrackAssocSel> trackIndicesPerCollision = aod::track_association::collisionId;
   Preslice<aod::V0Datas> v0sPerCollision = aod::v0data::collisionId;
 
+  /// V0 of the current collision passing the selections, with its neutral track built once for all the bachelors
+  struct V0Candidate {
+    int v0Id;
+    int64_t posTrackId;
+    int64_t negTrackId;
+    std::array<float, 3> momentum;
+    o2::dataformats::V0 track;
+#ifdef MY_DEBUG
+    int indexV0DaughPos;
+    int indexV0DaughNeg;
+    bool isK0SfromLc;
+#endif
+  };
+  std::vector<V0Candidate> selectedV0s;
+
   // histograms
   HistogramRegistry registry{"registry"};
 
@@ -2384,7 +2588,7 @@ struct HfTrackIndexSkimCreatorCascades {
     ccdb->setURL(ccdbUrl);
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
-    lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(ccdbPathLut));
+    lut = o2::common::propagator::getMatLut(ccdb, ccdbPathLut);
     runNumber = 0;
 
     if (fillHistograms) {
@@ -2427,9 +2631,88 @@ struct HfTrackIndexSkimCreatorCascades {
       fitter.setUseAbsDCA(useAbsDCA);
       fitter.setWeightedFinalPCA(useWeightedFinalPCA);
 
-      // fist we loop over the bachelor candidate
-
       const auto thisCollId = collision.globalIndex();
+
+      // select the V0s of the collision once, with the daughter tracks propagated to the V0 vertex,
+      // instead of repeating the selections and the propagation for each bachelor
+      selectedV0s.clear();
+      auto groupedV0s = v0s.sliceBy(v0sPerCollision, thisCollId);
+      for (const auto& v0 : groupedV0s) {
+        MY_DEBUG_MSG(1, LOG(info) << "*** Checking next K0S");
+        // selections on the V0 daughters
+        const auto& trackV0DaughPos = v0.posTrack_as<TracksWithDCA>();
+        const auto& trackV0DaughNeg = v0.negTrack_as<TracksWithDCA>();
+
+#ifdef MY_DEBUG
+        auto indexV0DaughPos = trackV0DaughPos.mcParticleId();
+        auto indexV0DaughNeg = trackV0DaughNeg.mcParticleId();
+        bool isK0SfromLc = isK0SfromLcFunc(indexV0DaughPos, indexV0DaughNeg, indexK0Spos, indexK0Sneg);
+#endif
+        MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "K0S from Lc found, trackV0DaughPos --> " << indexV0DaughPos << ", trackV0DaughNeg --> " << indexV0DaughNeg);
+
+        if (tpcRefitV0Daugh) {
+          if (!(trackV0DaughPos.trackType() & o2::aod::track::TPCrefit) ||
+              !(trackV0DaughNeg.trackType() & o2::aod::track::TPCrefit)) {
+            MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "K0S with daughters " << indexV0DaughPos << " and " << indexV0DaughNeg << ": rejected due to TPCrefit");
+            continue;
+          }
+        }
+        if (trackV0DaughPos.tpcNClsCrossedRows() < nCrossedRowsMinV0Daugh ||
+            trackV0DaughNeg.tpcNClsCrossedRows() < nCrossedRowsMinV0Daugh) {
+          MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "K0S with daughters " << indexV0DaughPos << " and " << indexV0DaughNeg << ": rejected due to minCrossedRows");
+          continue;
+        }
+        //
+        // if (trackV0DaughPos.dcaXY() < dcaXYPosToPvMin ||   // to the filters?
+        //     trackV0DaughNeg.dcaXY() < dcaXYNegToPvMin) {
+        //   continue;
+        // }
+        //
+        if (trackV0DaughPos.pt() < ptMinV0Daugh || // to the filters? I can't for now, it is not in the tables
+            trackV0DaughNeg.pt() < ptMinV0Daugh) {
+          MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "K0S with daughters " << indexV0DaughPos << " and " << indexV0DaughNeg << ": rejected due to minPt --> pos " << trackV0DaughPos.pt() << ", neg " << trackV0DaughNeg.pt() << " (cut " << ptMinV0Daugh << ")");
+          continue;
+        }
+        if ((trackV0DaughPos.eta() > etaMaxV0Daugh || trackV0DaughPos.eta() < etaMinV0Daugh) || // to the filters? I can't for now, it is not in the tables
+            (trackV0DaughNeg.eta() > etaMaxV0Daugh || trackV0DaughNeg.eta() < etaMinV0Daugh)) {
+          MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "K0S with daughters " << indexV0DaughPos << " and " << indexV0DaughNeg << ": rejected due to eta --> pos " << trackV0DaughPos.eta() << ", neg " << trackV0DaughNeg.eta() << " (cut " << etaMinV0Daugh << " to " << etaMaxV0Daugh << ")");
+          continue;
+        }
+
+        // V0 invariant mass selection
+        if (std::abs(v0.mK0Short() - massK0s) > cutInvMassV0) {
+          MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "K0S with daughters " << indexV0DaughPos << " and " << indexV0DaughNeg << ": rejected due to invMass --> " << v0.mK0Short() - massK0s << " (cut " << cutInvMassV0 << ")");
+          continue; // should go to the filter, but since it is a dynamic column, I cannot use it there
+        }
+
+        // V0 cosPointingAngle selection
+        if (v0.v0cosPA(collision.posX(), collision.posY(), collision.posZ()) < cpaV0Min) {
+          MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "K0S with daughters " << indexV0DaughPos << " and " << indexV0DaughNeg << ": rejected due to cosPA --> " << v0.v0cosPA(collision.posX(), collision.posY(), collision.posZ()) << " (cut " << cpaV0Min << ")");
+          continue;
+        }
+
+        MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "KEPT! K0S from Lc with daughters " << indexV0DaughPos << " and " << indexV0DaughNeg);
+
+        const std::array<float, 3> momentumV0 = {v0.px(), v0.py(), v0.pz()};
+        auto trackParCovV0DaughPos = getTrackParCov(trackV0DaughPos);
+        trackParCovV0DaughPos.propagateTo(v0.posX(), o2::base::Propagator::Instance()->getNominalBz()); // propagate the track to the X closest to the V0 vertex
+        auto trackParCovV0DaughNeg = getTrackParCov(trackV0DaughNeg);
+        trackParCovV0DaughNeg.propagateTo(v0.negX(), o2::base::Propagator::Instance()->getNominalBz()); // propagate the track to the X closest to the V0 vertex
+
+        const std::array<float, 3> vertexV0 = {v0.x(), v0.y(), v0.z()};
+        // we build the neutral track to then build the cascade
+        auto trackV0 = o2::dataformats::V0(vertexV0, momentumV0, {0, 0, 0, 0, 0, 0}, trackParCovV0DaughPos, trackParCovV0DaughNeg, {0, 0}, {0, 0}); // build the V0 track
+
+        V0Candidate candidate{v0.v0Id(), trackV0DaughPos.globalIndex(), trackV0DaughNeg.globalIndex(), momentumV0, trackV0};
+#ifdef MY_DEBUG
+        candidate.indexV0DaughPos = indexV0DaughPos;
+        candidate.indexV0DaughNeg = indexV0DaughNeg;
+        candidate.isK0SfromLc = isK0SfromLc;
+#endif
+        selectedV0s.push_back(candidate);
+      }
+
+      // fist we loop over the bachelor candidate
       auto groupedBachTrackIndices = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
 
       // for (const auto& bach : selectedTracks) {
@@ -2464,29 +2747,21 @@ struct HfTrackIndexSkimCreatorCascades {
         MY_DEBUG_MSG(isProtonFromLc, LOG(info) << "KEPT! proton from Lc with daughters " << indexBach);
 
         auto trackBach = getTrackParCov(bach);
+        const std::array<float, 3> momentumBach = {bach.px(), bach.py(), bach.pz()};
 
-        auto groupedV0s = v0s.sliceBy(v0sPerCollision, thisCollId);
-        // now we loop over the V0s
-        for (const auto& v0 : groupedV0s) {
-          MY_DEBUG_MSG(1, LOG(info) << "*** Checking next K0S");
-          // selections on the V0 daughters
-          const auto& trackV0DaughPos = v0.posTrack_as<TracksWithDCA>();
-          const auto& trackV0DaughNeg = v0.negTrack_as<TracksWithDCA>();
-
+        // now we loop over the selected V0s
+        for (const auto& candidateV0 : selectedV0s) {
           // check not to take the same track twice (as bachelor and V0 daughter)
-          if (trackV0DaughPos.globalIndex() == bach.globalIndex() || trackV0DaughNeg.globalIndex() == bach.globalIndex()) {
+          if (candidateV0.posTrackId == bach.globalIndex() || candidateV0.negTrackId == bach.globalIndex()) {
             continue;
           }
 
 #ifdef MY_DEBUG
-          auto indexV0DaughPos = trackV0DaughPos.mcParticleId();
-          auto indexV0DaughNeg = trackV0DaughNeg.mcParticleId();
-          bool isK0SfromLc = isK0SfromLcFunc(indexV0DaughPos, indexV0DaughNeg, indexK0Spos, indexK0Sneg);
-
+          auto indexV0DaughPos = candidateV0.indexV0DaughPos;
+          auto indexV0DaughNeg = candidateV0.indexV0DaughNeg;
+          bool isK0SfromLc = candidateV0.isK0SfromLc;
           bool isLc = isLcK0SpFunc(indexBach, indexV0DaughPos, indexV0DaughNeg, indexProton, indexK0Spos, indexK0Sneg);
 #endif
-          MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "K0S from Lc found, trackV0DaughPos --> " << indexV0DaughPos << ", trackV0DaughNeg --> " << indexV0DaughNeg);
-
           MY_DEBUG_MSG(isK0SfromLc && isProtonFromLc,
                        LOG(info) << "ACCEPTED!!!";
                        LOG(info) << "proton belonging to a Lc found: label --> " << indexBach;
@@ -2494,69 +2769,17 @@ struct HfTrackIndexSkimCreatorCascades {
 
           MY_DEBUG_MSG(isLc, LOG(info) << "Combination of K0S and p which correspond to a Lc found!");
 
-          if (tpcRefitV0Daugh) {
-            if (!(trackV0DaughPos.trackType() & o2::aod::track::TPCrefit) ||
-                !(trackV0DaughNeg.trackType() & o2::aod::track::TPCrefit)) {
-              MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "K0S with daughters " << indexV0DaughPos << " and " << indexV0DaughNeg << ": rejected due to TPCrefit");
-              continue;
-            }
-          }
-          if (trackV0DaughPos.tpcNClsCrossedRows() < nCrossedRowsMinV0Daugh ||
-              trackV0DaughNeg.tpcNClsCrossedRows() < nCrossedRowsMinV0Daugh) {
-            MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "K0S with daughters " << indexV0DaughPos << " and " << indexV0DaughNeg << ": rejected due to minCrossedRows");
-            continue;
-          }
-          //
-          // if (trackV0DaughPos.dcaXY() < dcaXYPosToPvMin ||   // to the filters?
-          //     trackV0DaughNeg.dcaXY() < dcaXYNegToPvMin) {
-          //   continue;
-          // }
-          //
-          if (trackV0DaughPos.pt() < ptMinV0Daugh || // to the filters? I can't for now, it is not in the tables
-              trackV0DaughNeg.pt() < ptMinV0Daugh) {
-            MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "K0S with daughters " << indexV0DaughPos << " and " << indexV0DaughNeg << ": rejected due to minPt --> pos " << trackV0DaughPos.pt() << ", neg " << trackV0DaughNeg.pt() << " (cut " << ptMinV0Daugh << ")");
-            continue;
-          }
-          if ((trackV0DaughPos.eta() > etaMaxV0Daugh || trackV0DaughPos.eta() < etaMinV0Daugh) || // to the filters? I can't for now, it is not in the tables
-              (trackV0DaughNeg.eta() > etaMaxV0Daugh || trackV0DaughNeg.eta() < etaMinV0Daugh)) {
-            MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "K0S with daughters " << indexV0DaughPos << " and " << indexV0DaughNeg << ": rejected due to eta --> pos " << trackV0DaughPos.eta() << ", neg " << trackV0DaughNeg.eta() << " (cut " << etaMinV0Daugh << " to " << etaMaxV0Daugh << ")");
-            continue;
-          }
-
-          // V0 invariant mass selection
-          if (std::abs(v0.mK0Short() - massK0s) > cutInvMassV0) {
-            MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "K0S with daughters " << indexV0DaughPos << " and " << indexV0DaughNeg << ": rejected due to invMass --> " << v0.mK0Short() - massK0s << " (cut " << cutInvMassV0 << ")");
-            continue; // should go to the filter, but since it is a dynamic column, I cannot use it there
-          }
-
-          // V0 cosPointingAngle selection
-          if (v0.v0cosPA(collision.posX(), collision.posY(), collision.posZ()) < cpaV0Min) {
-            MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "K0S with daughters " << indexV0DaughPos << " and " << indexV0DaughNeg << ": rejected due to cosPA --> " << v0.v0cosPA(collision.posX(), collision.posY(), collision.posZ()) << " (cut " << cpaV0Min << ")");
-            continue;
-          }
-
-          const std::array<float, 3> momentumV0 = {v0.px(), v0.py(), v0.pz()};
-
           // invariant-mass cut: we do it here, before updating the momenta of bach and V0 during the fitting to save CPU
           // TODO: but one should better check that the value here and after the fitter do not change significantly!!!
-          mass2K0sP = RecoDecay::m(array{array{bach.px(), bach.py(), bach.pz()}, momentumV0}, array{massP, massK0s});
+          mass2K0sP = RecoDecay::m(array{momentumBach, candidateV0.momentum}, array{massP, massK0s});
           if ((cutInvMassCascLc >= 0.) && (std::abs(mass2K0sP - massLc) > cutInvMassCascLc)) {
             MY_DEBUG_MSG(isK0SfromLc && isProtonFromLc, LOG(info) << "True Lc from proton " << indexBach << " and K0S pos " << indexV0DaughPos << " and neg " << indexV0DaughNeg << " rejected due to invMass cut: " << mass2K0sP << ", mass Lc " << massLc << " (cut " << cutInvMassCascLc << ")");
             continue;
           }
 
-          MY_DEBUG_MSG(isK0SfromLc, LOG(info) << "KEPT! K0S from Lc with daughters " << indexV0DaughPos << " and " << indexV0DaughNeg);
-
-          auto trackParCovV0DaughPos = getTrackParCov(trackV0DaughPos);
-          trackParCovV0DaughPos.propagateTo(v0.posX(), o2::base::Propagator::Instance()->getNominalBz()); // propagate the track to the X closest to the V0 vertex
-          auto trackParCovV0DaughNeg = getTrackParCov(trackV0DaughNeg);
-          trackParCovV0DaughNeg.propagateTo(v0.negX(), o2::base::Propagator::Instance()->getNominalBz()); // propagate the track to the X closest to the V0 vertex
           std::array<float, 3> pVecV0 = {0., 0., 0.};
           std::array<float, 3> pVecBach = {0., 0., 0.};
-
-          const std::array<float, 3> vertexV0 = {v0.x(), v0.y(), v0.z()};
-          // we build the neutral track to then build the cascade
-          auto trackV0 = o2::dataformats::V0(vertexV0, momentumV0, {0, 0, 0, 0, 0, 0}, trackParCovV0DaughPos, trackParCovV0DaughNeg, {0, 0}, {0, 0}); // build the V0 track
+          const auto& trackV0 = candidateV0.track;
 
           // now we find the DCA between the V0 and the bachelor, for the cascade
           int nCand2 = fitter.process(trackV0, trackBach);
@@ -2587,7 +2810,7 @@ struct HfTrackIndexSkimCreatorCascades {
           }
 
           // fill table row
-          rowTrackIndexCasc(thisCollId, bach.globalIndex(), v0.v0Id());
+          rowTrackIndexCasc(thisCollId, bach.globalIndex(), candidateV0.v0Id);
           // fill histograms
           if (fillHistograms) {
             MY_DEBUG_MSG(isK0SfromLc && isProtonFromLc && isLc, LOG(info) << "KEPT! True Lc from proton " << indexBach << " and K0S pos " << indexV0DaughPos << " and neg " << indexV0DaughNeg);
@@ -2688,7 +2911,7 @@ struct HfTrackIndexSkimCreatorLfCascades {
     ccdb->setURL(ccdbUrl);
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
-    lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(ccdbPathLut));
+    lut = o2::common::propagator::getMatLut(ccdb, ccdbPathLut);
     runNumber = 0;
 
     if (fillHistograms) {
@@ -0,0 +1,108 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file trackPidStatusCreator.cxx
+/// \brief Producer of the per-track packed PID status word shared by the HF candidate selectors
+///
+/// The statuses of all species (electron to proton) and detectors are evaluated once per track
+/// with TrackSelectorPIDMulti and stored in a column joinable with the track table, so that the
+/// selectors of the workflow do not re-evaluate the same hypotheses for each prong.
+
+#include "Framework/AnalysisTask.h"
+#include "Framework/runDataProcessing.h"
+
+#include "Common/Core/TrackSelectorPID.h"
+
+#include "PWGHF/DataModel/CandidateReconstructionTables.h"
+
+using namespace o2;
+using namespace o2::framework;
+
+/// Struct to produce the packed PID status of all tracks
+struct HfTrackPidStatusCreator {
+  Produces<aod::HfPidStatusTrack> rowPidStatus;
+
+  // TPC PID
+  Configurable<double> ptPidTpcMin{"ptPidTpcMin", 0.15, "Lower bound of track pT for TPC PID"};
+  Configurable<double> ptPidTpcMax{"ptPidTpcMax", 20., "Upper bound of track pT for TPC PID"};
+  Configurable<double> nSigmaTpcMax{"nSigmaTpcMax", 3., "Nsigma cut on TPC only"};
+  Configurable<double> nSigmaTpcCombinedMax{"nSigmaTpcCombinedMax", 5., "Nsigma cut on TPC combined with TOF"};
+  // TOF PID
+  Configurable<double> ptPidTofMin{"ptPidTofMin", 0.15, "Lower bound of track pT for TOF PID"};
+  Configurable<double> ptPidTofMax{"ptPidTofMax", 20., "Upper bound of track pT for TOF PID"};
+  Configurable<double> nSigmaTofMax{"nSigmaTofMax", 3., "Nsigma cut on TOF only"};
+  Configurable<double> nSigmaTofCombinedMax{"nSigmaTofCombinedMax", 5., "Nsigma cut on TOF combined with TPC"};
+  // Bayesian PID
+  Configurable<double> ptPidBayesMin{"ptPidBayesMin", 0., "Lower bound of track pT for Bayesian PID"};
+  Configurable<double> ptPidBayesMax{"ptPidBayesMax", 100, "Upper bound of track pT for Bayesian PID"};
+  Configurable<double> probBayesMin{"probBayesMin", -1., "Minimum Bayesian probability of the expected species (negative: disabled)"};
+
+  TrackSelectorPIDMulti selector;
+
+  using TracksPidBayes = soa::Join<aod::BigTracksPID, aod::pidBayesEl, aod::pidBayesMu, aod::pidBayesPi, aod::pidBayesKa, aod::pidBayesPr, aod::pidBayes>;
+
+  void init(InitContext const&)
+  {
+    if (doprocessNoBayes && doprocessWithBayes) {
+      LOGP(fatal, "Only one process function between processNoBayes and processWithBayes can be enabled at a time.");
+    }
+
+    TrackSelectorPID selectorElectron(kElectron);
+    selectorElectron.setRangePtTPC(ptPidTpcMin, ptPidTpcMax);
+    selectorElectron.setRangeNSigmaTPC(-nSigmaTpcMax, nSigmaTpcMax);
+    selectorElectron.setRangeNSigmaTPCCondTOF(-nSigmaTpcCombinedMax, nSigmaTpcCombinedMax);
+    selectorElectron.setRangePtTOF(ptPidTofMin, ptPidTofMax);
+    selectorElectron.setRangeNSigmaTOF(-nSigmaTofMax, nSigmaTofMax);
+    selectorElectron.setRangeNSigmaTOFCondTPC(-nSigmaTofCombinedMax, nSigmaTofCombinedMax);
+    selectorElectron.setRangePtBayes(ptPidBayesMin, ptPidBayesMax);
+    selectorElectron.setProbBayesMin(probBayesMin);
+    selector.setSelector(selectorElectron);
+
+    for (const auto pdg : {kMuonMinus, kPiPlus, kKPlus, kProton}) {
+      TrackSelectorPID selectorSpecies(selectorElectron);
+      selectorSpecies.setPDG(pdg);
+      selector.setSelector(selectorSpecies);
+    }
+
+    uint32_t detectors = BIT(TrackSelectorPID::PackedTPC) | BIT(TrackSelectorPID::PackedTOF) | BIT(TrackSelectorPID::PackedTpcOrTof) | BIT(TrackSelectorPID::PackedTpcAndTof);
+    if (doprocessWithBayes) {
+      detectors |= BIT(TrackSelectorPID::PackedBayes) | BIT(TrackSelectorPID::PackedBayesProb);
+    }
+    selector.setDetectors(detectors);
+  }
+
+  template <typename T>
+  void fillPidStatus(T const& tracks)
+  {
+    rowPidStatus.reserve(tracks.size());
+    for (const auto& track : tracks) {
+      rowPidStatus(selector.getStatusWord(track));
+    }
+  }
+
+  void processNoBayes(aod::BigTracksPID const& tracks)
+  {
+    fillPidStatus(tracks);
+  }
+  PROCESS_SWITCH(HfTrackPidStatusCreator, processNoBayes, "Fill TPC and TOF statuses", true);
+
+  void processWithBayes(TracksPidBayes const& tracks)
+  {
+    fillPidStatus(tracks);
+  }
+  PROCESS_SWITCH(HfTrackPidStatusCreator, processWithBayes, "Fill TPC, TOF and Bayesian statuses", false);
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{
+    adaptAnalysisTask<HfTrackPidStatusCreator>(cfgc)};
+}
@@ -22,6 +22,7 @@
 
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
+#include "PWGHF/Utils/utilsTreeCreator.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -157,8 +158,15 @@ struct HfTreeCreatorD0ToKPi {
   Produces<o2::aod::HfCand2ProngFullEvents> rowCandidateFullEvents;
   Produces<o2::aod::HfCand2ProngFullParticles> rowCandidateFullParticles;
 
+  // parameters for production of training samples
+  Configurable<std::vector<double>> binsPtDownSample{"binsPtDownSample", std::vector<double>{0., 1000.}, "pT bin limits for the downsampling of the candidates"};
+  Configurable<std::vector<double>> downSampleFactors{"downSampleFactors", std::vector<double>{1.}, "Fraction of candidates to keep in each pT bin"};
+
+  HfTreeDownsampler downsampler;
+
   void init(InitContext const&)
   {
+    downsampler.set(binsPtDownSample, downSampleFactors);
   }
 
   template <typename T>
@@ -252,6 +260,13 @@ struct HfTreeCreatorD0ToKPi {
     // Filling candidate properties
     rowCandidateFull.reserve(candidates.size());
     for (auto const& candidate : candidates) {
+      // skip the candidates before computing any of the stored quantities
+      if (candidate.isSelD0() < 1 && candidate.isSelD0bar() < 1) {
+        continue;
+      }
+      if (!downsampler.isKept(candidate.pt(), candidate.ptProng0())) {
+        continue;
+      }
       auto prong0 = candidate.prong0_as<aod::BigTracksPID>();
       auto prong1 = candidate.prong1_as<aod::BigTracksPID>();
       double yD = yD0(candidate);
@@ -279,6 +294,13 @@ struct HfTreeCreatorD0ToKPi {
     // Filling candidate properties
     rowCandidateFull.reserve(candidates.size());
     for (auto const& candidate : candidates) {
+      // skip the candidates before computing any of the stored quantities
+      if (candidate.isSelD0() < 1 && candidate.isSelD0bar() < 1) {
+        continue;
+      }
+      if (!downsampler.isKept(candidate.pt(), candidate.ptProng0())) {
+        continue;
+      }
       auto prong0 = candidate.prong0_as<aod::BigTracksPID>();
       auto prong1 = candidate.prong0_as<aod::BigTracksPID>();
       double yD = yD0(candidate);
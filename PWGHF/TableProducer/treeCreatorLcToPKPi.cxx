@@ -21,6 +21,7 @@
 
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
+#include "PWGHF/Utils/utilsTreeCreator.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -190,9 +191,14 @@ struct HfTreeCreatorLcToPKPi {
   Produces<o2::aod::HfCand3ProngFullParticles> rowCandidateFullParticles;
 
   Configurable<double> downSampleBkgFactor{"downSampleBkgFactor", 1., "Fraction of candidates to store in the tree"};
+  Configurable<std::vector<double>> binsPtDownSample{"binsPtDownSample", std::vector<double>{0., 1000.}, "pT bin limits for the downsampling of the candidates"};
+  Configurable<std::vector<double>> downSampleFactors{"downSampleFactors", std::vector<double>{1.}, "Fraction of candidates to keep in each pT bin, on top of downSampleBkgFactor"};
+
+  HfTreeDownsampler downsampler;
 
   void init(InitContext const&)
   {
+    downsampler.set(binsPtDownSample, downSampleFactors, downSampleBkgFactor);
   }
 
   void processMc(aod::Collisions const& collisions,
@@ -222,14 +228,20 @@ struct HfTreeCreatorLcToPKPi {
       auto trackPos1 = candidate.prong0_as<aod::BigTracksPID>(); // positive daughter (negative for the antiparticles)
       auto trackNeg = candidate.prong1_as<aod::BigTracksPID>();  // negative daughter (positive for the antiparticles)
       auto trackPos2 = candidate.prong2_as<aod::BigTracksPID>(); // positive daughter (negative for the antiparticles)
+      // skip the candidates before computing any of the stored quantities
+      if (candidate.isSelLcToPKPi() < 1 && candidate.isSelLcToPiKP() < 1) {
+        continue;
+      }
+      if (!downsampler.isKept(candidate.pt(), trackPos1.pt())) {
+        continue;
+      }
       auto fillTable = [&](int CandFlag,
                            int FunctionSelection,
                            float FunctionInvMass,
                            float FunctionCt,
                            float FunctionY,
                            float FunctionE) {
-        double pseudoRndm = trackPos1.pt() * 1000. - (int64_t)(trackPos1.pt() * 1000);
-        if (FunctionSelection >= 1 && pseudoRndm < downSampleBkgFactor) {
+        if (FunctionSelection >= 1) {
           rowCandidateFull(
             candidate.collisionId(),
             trackPos1.collision().bcId(),
@@ -308,8 +320,11 @@ struct HfTreeCreatorLcToPKPi {
         }
       };
 
-      fillTable(0, candidate.isSelLcToPKPi(), invMassLcToPKPi(candidate), ctLc(candidate), yLc(candidate), eLc(candidate));
-      fillTable(1, candidate.isSelLcToPiKP(), invMassLcToPiKP(candidate), ctLc(candidate), yLc(candidate), eLc(candidate));
+      const float ctCand = ctLc(candidate);
+      const float yCand = yLc(candidate);
+      const float eCand = eLc(candidate);
+      fillTable(0, candidate.isSelLcToPKPi(), invMassLcToPKPi(candidate), ctCand, yCand, eCand);
+      fillTable(1, candidate.isSelLcToPiKP(), invMassLcToPiKP(candidate), ctCand, yCand, eCand);
     }
 
     // Filling particle properties
@@ -356,14 +371,20 @@ struct HfTreeCreatorLcToPKPi {
       auto trackPos1 = candidate.prong0_as<aod::BigTracksPID>(); // positive daughter (negative for the antiparticles)
       auto trackNeg = candidate.prong1_as<aod::BigTracksPID>();  // negative daughter (positive for the antiparticles)
       auto trackPos2 = candidate.prong2_as<aod::BigTracksPID>(); // positive daughter (negative for the antiparticles)
+      // skip the candidates before computing any of the stored quantities
+      if (candidate.isSelLcToPKPi() < 1 && candidate.isSelLcToPiKP() < 1) {
+        continue;
+      }
+      if (!downsampler.isKept(candidate.pt(), trackPos1.pt())) {
+        continue;
+      }
       auto fillTable = [&](int CandFlag,
                            int FunctionSelection,
                            float FunctionInvMass,
                            float FunctionCt,
                            float FunctionY,
                            float FunctionE) {
-        double pseudoRndm = trackPos1.pt() * 1000. - (int64_t)(trackPos1.pt() * 1000);
-        if (FunctionSelection >= 1 && pseudoRndm < downSampleBkgFactor) {
+        if (FunctionSelection >= 1) {
           rowCandidateFull(
             candidate.collisionId(),
             trackPos1.collision().bcId(),
@@ -442,8 +463,11 @@ struct HfTreeCreatorLcToPKPi {
         }
       };
 
-      fillTable(0, candidate.isSelLcToPKPi(), invMassLcToPKPi(candidate), ctLc(candidate), yLc(candidate), eLc(candidate));
-      fillTable(1, candidate.isSelLcToPiKP(), invMassLcToPiKP(candidate), ctLc(candidate), yLc(candidate), eLc(candidate));
+      const float ctCand = ctLc(candidate);
+      const float yCand = yLc(candidate);
+      const float eCand = eLc(candidate);
+      fillTable(0, candidate.isSelLcToPKPi(), invMassLcToPKPi(candidate), ctCand, yCand, eCand);
+      fillTable(1, candidate.isSelLcToPiKP(), invMassLcToPiKP(candidate), ctCand, yCand, eCand);
     }
   }
   PROCESS_SWITCH(HfTreeCreatorLcToPKPi, processData, "Process data tree writer", false);
@@ -22,7 +22,10 @@
 #include "DataFormatsParameters/GRPMagField.h"
 #include "DataFormatsParameters/GRPObject.h"
 
+#include "Common/Core/PropagatorServices.h"
+
 /// \brief Sets up the grp object for magnetic field (w/o matCorr for propagation)
+/// The GRP is fetched and the propagator set up only once per run for all the tasks of the process, see PropagatorServices.h
 /// \param bc is the bunch crossing
 /// \param mRunNumber is an int with the run umber of the previous iteration. If at the current iteration it changes, then the grp object is updated
 /// \param ccdb is the o2::ccdb::BasicCCDBManager object
@@ -35,23 +38,7 @@ void initCCDB(o2::aod::BCsWithTimestamps::iterator const& bc, int& mRunNumber,
 {
   if (mRunNumber != bc.runNumber()) {
     LOGF(info, "====== initCCDB function called (isRun2==%d)", isRun2);
-    if (isRun2) { // Run 2 GRP object
-      o2::parameters::GRPObject* grpo = ccdb->getForTimeStamp<o2::parameters::GRPObject>(ccdbPathGrp, bc.timestamp());
-      if (grpo == nullptr) {
-        LOGF(fatal, "Run 2 GRP object (type o2::parameters::GRPObject) is not available in CCDB for run=%d at timestamp=%llu", bc.runNumber(), bc.timestamp());
-      }
-      o2::base::Propagator::initFieldFromGRP(grpo);
-      o2::base::Propagator::Instance()->setMatLUT(lut);
-      LOGF(info, "Setting magnetic field to %d kG for run %d from its GRP CCDB object (type o2::parameters::GRPObject)", grpo->getNominalL3Field(), bc.runNumber());
-    } else { // Run 3 GRP object
-      o2::parameters::GRPMagField* grpo = ccdb->getForTimeStamp<o2::parameters::GRPMagField>(ccdbPathGrp, bc.timestamp());
-      if (grpo == nullptr) {
-        LOGF(fatal, "Run 3 GRP object (type o2::parameters::GRPMagField) is not available in CCDB for run=%d at timestamp=%llu", bc.runNumber(), bc.timestamp());
-      }
-      o2::base::Propagator::initFieldFromGRP(grpo);
-      o2::base::Propagator::Instance()->setMatLUT(lut);
-      LOGF(info, "Setting magnetic field to current %f A for run %d from its GRP CCDB object (type o2::parameters::GRPMagField)", grpo->getL3Current(), bc.runNumber());
-    }
+    o2::common::propagator::setMagField(ccdb, ccdbPathGrp, bc.runNumber(), bc.timestamp(), lut, isRun2);
     mRunNumber = bc.runNumber();
   }
 } /// end initCCDB
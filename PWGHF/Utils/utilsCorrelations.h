@@ -0,0 +1,165 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file utilsCorrelations.h
+/// \brief Associated hadrons of the events and mixing pools shared by the D-meson-hadron correlators
+///
+/// The associated hadrons of an event are selected once and stored as columns, from which the Δφ and Δη with
+/// respect to each trigger candidate are computed in a single loop without branches. For the mixed event, the
+/// hadrons of the last events of each pool bin are kept in ring buffers, so that the trigger candidates of an
+/// event are paired with them directly instead of slicing again the tables of the other events.
+
+#ifndef PWGHF_UTILS_UTILSCORRELATIONS_H_
+#define PWGHF_UTILS_UTILSCORRELATIONS_H_
+
+#include <cstddef> // std::size_t
+#include <cstdint> // int64_t
+#include <vector>  // std::vector
+
+#include "CommonConstants/MathConstants.h"
+
+#include "Common/Core/RecoDecay.h"
+
+namespace o2::analysis::hf_correlations
+{
+
+/// Returns deltaPhi value in range [-pi/2., 3.*pi/2], typically used for correlation studies
+inline double getDeltaPhi(double phiD, double phiHadron)
+{
+  return RecoDecay::constrainAngle(phiHadron - phiD, -o2::constants::math::PIHalf);
+}
+
+/// \brief Associated hadrons of an event, as columns
+class AssociatedHadrons
+{
+ public:
+  void clear()
+  {
+    mIndex.clear();
+    mPt.clear();
+    mEta.clear();
+    mPhi.clear();
+    mPx.clear();
+    mPy.clear();
+    mPz.clear();
+  }
+
+  /// Adds a track or a particle, with its global index used to reject the daughters of the trigger candidates
+  template <typename T>
+  void add(T const& track)
+  {
+    mIndex.push_back(track.globalIndex());
+    mPt.push_back(track.pt());
+    mEta.push_back(track.eta());
+    mPhi.push_back(track.phi());
+    mPx.push_back(track.px());
+    mPy.push_back(track.py());
+    mPz.push_back(track.pz());
+  }
+
+  std::size_t size() const { return mIndex.size(); }
+  int64_t index(std::size_t i) const { return mIndex[i]; }
+  float pt(std::size_t i) const { return mPt[i]; }
+  float eta(std::size_t i) const { return mEta[i]; }
+  float phi(std::size_t i) const { return mPhi[i]; }
+  float px(std::size_t i) const { return mPx[i]; }
+  float py(std::size_t i) const { return mPy[i]; }
+  float pz(std::size_t i) const { return mPz[i]; }
+
+  /// Computes Δφ = getDeltaPhi(φ(hadron), φ(trigger)), in [-π/2, 3π/2), and Δη = η(hadron) - η(trigger) of all the hadrons,
+  /// with the conventions of the same-event pairs of the correlators
+  /// The azimuthal angles are in [0, 2π], as those of the tables, so that one shift by 2π is enough.
+  void computeDeltas(float etaTrigger, float phiTrigger)
+  {
+    constexpr float PIHalf = o2::constants::math::PIHalf;
+    constexpr float TwoPI = o2::constants::math::TwoPI;
+    const std::size_t n = size();
+    mDeltaPhi.resize(n);
+    mDeltaEta.resize(n);
+    for (std::size_t i = 0; i < n; i++) {
+      float deltaPhi = phiTrigger - mPhi[i];
+      deltaPhi += (deltaPhi < -PIHalf) ? TwoPI : 0.f;
+      deltaPhi -= (deltaPhi >= 3.f * PIHalf) ? TwoPI : 0.f;
+      mDeltaPhi[i] = deltaPhi;
+      mDeltaEta[i] = mEta[i] - etaTrigger;
+    }
+  }
+
+  /// \return Δφ and Δη of the hadron i from the last call of computeDeltas()
+  float deltaPhi(std::size_t i) const { return mDeltaPhi[i]; }
+  float deltaEta(std::size_t i) const { return mDeltaEta[i]; }
+
+ private:
+  std::vector<int64_t> mIndex{};
+  std::vector<float> mPt{};
+  std::vector<float> mEta{};
+  std::vector<float> mPhi{};
+  std::vector<float> mPx{};
+  std::vector<float> mPy{};
+  std::vector<float> mPz{};
+  std::vector<float> mDeltaPhi{};
+  std::vector<float> mDeltaEta{};
+};
+
+/// \brief Associated hadrons of the last events of each pool bin, for the event mixing
+class MixingPools
+{
+ public:
+  /// \param depth is the number of events kept per bin, with which each new event is mixed
+  void init(int depth)
+  {
+    mDepth = depth;
+    mPools.clear();
+  }
+
+  /// Calls f(hadrons) for the hadrons of each event stored in the pool, the current event is not included before add()
+  template <typename F>
+  void forEachEvent(int bin, F&& f)
+  {
+    if (bin < 0 || bin >= static_cast<int>(mPools.size())) {
+      return;
+    }
+    for (auto& hadrons : mPools[bin].events) {
+      f(hadrons);
+    }
+  }
+
+  /// Stores the hadrons of an event in the pool of its bin, replacing the oldest event once the pool is full
+  /// The buffers of the replaced event are reused.
+  void add(int bin, AssociatedHadrons const& hadrons)
+  {
+    if (bin < 0 || mDepth <= 0) {
+      return;
+    }
+    if (bin >= static_cast<int>(mPools.size())) {
+      mPools.resize(bin + 1);
+    }
+    auto& pool = mPools[bin];
+    if (static_cast<int>(pool.events.size()) < mDepth) {
+      pool.events.push_back(hadrons);
+      return;
+    }
+    pool.events[pool.next] = hadrons;
+    pool.next = (pool.next + 1) % mDepth;
+  }
+
+ private:
+  struct Pool {
+    std::vector<AssociatedHadrons> events{};
+    int next{0}; // slot of the oldest event, replaced by the next one
+  };
+  std::vector<Pool> mPools{};
+  int mDepth{0};
+};
+
+} // namespace o2::analysis::hf_correlations
+
+#endif // PWGHF_UTILS_UTILSCORRELATIONS_H_
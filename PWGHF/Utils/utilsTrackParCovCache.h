@@ -0,0 +1,57 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file utilsTrackParCovCache.h
+/// \brief Cache of the track parametrisations shared by several candidates
+
+#ifndef PWGHF_UTILS_UTILSTRACKPARCOVCACHE_H_
+#define PWGHF_UTILS_UTILSTRACKPARCOVCACHE_H_
+
+#include <cstdint> // int64_t
+#include <vector>  // std::vector
+
+#include "ReconstructionDataFormats/Track.h"
+
+#include "Common/Core/trackUtilities.h"
+
+/// \brief Track parametrisations with covariance of the tracks of a dataframe, built at the first use of each track.
+/// A track is typically a prong of many candidates of its collision, so the conversion from the table columns
+/// is done only once per track instead of once per candidate.
+class TrackParCovCache
+{
+ public:
+  /// Empties the cache
+  /// \param nTracks is the number of tracks in the table, the global indices of the tracks must be smaller
+  void reset(int64_t nTracks)
+  {
+    mTrackParCov.resize(nTracks);
+    mIsCached.assign(nTracks, false);
+  }
+
+  /// \param track is the track, from the table used in reset()
+  /// \return the track parametrisation with covariance at the point of the track table
+  template <typename T>
+  o2::track::TrackParCov const& get(T const& track)
+  {
+    const auto index = track.globalIndex();
+    if (!mIsCached[index]) {
+      mTrackParCov[index] = getTrackParCov(track);
+      mIsCached[index] = true;
+    }
+    return mTrackParCov[index];
+  }
+
+ private:
+  std::vector<o2::track::TrackParCov> mTrackParCov{}; // track parametrisations, indexed by the global index of the track
+  std::vector<bool> mIsCached{};                      // flags of the tracks already converted
+};
+
+#endif // PWGHF_UTILS_UTILSTRACKPARCOVCACHE_H_
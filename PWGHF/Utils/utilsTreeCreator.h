@@ -0,0 +1,70 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file utilsTreeCreator.h
+/// \brief Utilities shared by the tree creators of the HF candidates
+
+#ifndef PWGHF_UTILS_UTILSTREECREATOR_H_
+#define PWGHF_UTILS_UTILSTREECREATOR_H_
+
+#include <cstdint> // int64_t
+#include <vector>  // std::vector
+
+#include "Framework/Logger.h"
+
+#include "PWGHF/Core/SelectorCuts.h"
+
+/// \brief Downsampling of the candidates written in the trees, with a fraction of kept candidates per pT bin.
+/// The decision only needs the candidate pT and the pT of its first prong, so it is taken before any other
+/// (dynamic) column of the candidate is computed.
+class HfTreeDownsampler
+{
+ public:
+  /// \param binsPt are the pT bin limits
+  /// \param fractions are the fractions of candidates to keep in each pT bin
+  /// \param fraction is a global fraction of candidates to keep, multiplying the ones of the pT bins and applied alone outside the bins
+  void set(const std::vector<double>& binsPt, const std::vector<double>& fractions, double fraction = 1.)
+  {
+    if (fractions.size() + 1 != binsPt.size()) {
+      LOGF(fatal, "Downsampling: %d fractions given for %d pT bins", static_cast<int>(fractions.size()), static_cast<int>(binsPt.size()) - 1);
+    }
+    mPtBins.set(binsPt);
+    mFractions.clear();
+    mIsActive = fraction < 1.;
+    for (const auto& fractionBin : fractions) {
+      mFractions.push_back(fractionBin * fraction);
+      mIsActive = mIsActive || fractionBin < 1.;
+    }
+    mFraction = fraction;
+  }
+
+  /// \param pt is the candidate pT
+  /// \param ptProng0 is the pT of the first prong, from which the pseudo-random number is derived
+  /// \return true if the candidate is kept
+  bool isKept(double pt, double ptProng0) const
+  {
+    if (!mIsActive) {
+      return true;
+    }
+    const int bin = mPtBins.find(pt);
+    const double fraction = bin < 0 ? mFraction : mFractions[bin];
+    double pseudoRndm = ptProng0 * 1000. - (int64_t)(ptProng0 * 1000);
+    return pseudoRndm < fraction;
+  }
+
+ private:
+  o2::analysis::PtBins mPtBins{};   // pT bins of the fractions
+  std::vector<double> mFractions{}; // fractions of kept candidates per pT bin
+  double mFraction = 1.;            // fraction of kept candidates outside the pT bins
+  bool mIsActive = false;           // true if some candidates are rejected
+};
+
+#endif // PWGHF_UTILS_UTILSTREECREATOR_H_
@@ -23,14 +23,12 @@ void JetFinder::setParams()
     jetEtaMin = etaMin + jetR; //in aliphysics this was (-etaMax + 0.95*jetR)
     jetEtaMax = etaMax - jetR;
   }
-  if (isReclustering) {
-    jetR = 5.0 * jetR;
-  }
+  float jetRParam = isReclustering ? 5.0 * jetR : jetR;
 
   //selGhosts =fastjet::SelectorRapRange(ghostEtaMin,ghostEtaMax) && fastjet::SelectorPhiRange(phiMin,phiMax);
   //ghostAreaSpec=fastjet::GhostedAreaSpec(selGhosts,ghostRepeatN,ghostArea,gridScatter,ktScatter,ghostktMean);
   ghostAreaSpec = fastjet::GhostedAreaSpec(ghostEtaMax, ghostRepeatN, ghostArea, gridScatter, ktScatter, ghostktMean); //the first argument is rapidity not pseudorapidity, to be checked
-  jetDef = fastjet::JetDefinition(algorithm, jetR, recombScheme, strategy);
+  jetDef = fastjet::JetDefinition(algorithm, jetRParam, recombScheme, strategy);
   areaDef = fastjet::AreaDefinition(areaType, ghostAreaSpec);
   selJets = fastjet::SelectorPtRange(jetPtMin, jetPtMax) && fastjet::SelectorEtaRange(jetEtaMin, jetEtaMax) && fastjet::SelectorPhiRange(jetPhiMin, jetPhiMax);
   jetDefBkg = fastjet::JetDefinition(algorithmBkg, jetBkgR, recombSchemeBkg, strategyBkg);
@@ -78,23 +76,67 @@ void JetFinder::setSub()
 /// \return ClusterSequenceArea object needed to access constituents
 fastjet::ClusterSequenceArea JetFinder::findJets(std::vector<fastjet::PseudoJet>& inputParticles, std::vector<fastjet::PseudoJet>& jets) //ideally find a way of passing the cluster sequence as a reeference
 {
-  setParams();
-  setBkgE();
-  jets.clear();
+  subtractBackground(inputParticles);
+  return clusterJets(inputParticles, jets);
+}
 
-  if (bkgE) {
-    bkgE->set_particles(inputParticles);
+void JetFinder::updateParams()
+{
+  // the definitions only depend on the configuration, they are set again only when jetR changes
+  if (!mParamsAreSet) {
+    setParams();
+    setBkgE();
     setSub();
+    mParamsAreSet = true;
+    mParamsJetR = jetR;
+  } else if (jetR != mParamsJetR) {
+    setParams();
+    mParamsJetR = jetR;
+  }
+}
+
+void JetFinder::estimateRho(std::vector<fastjet::PseudoJet>& inputParticles, double& rho, double& rhoM)
+{
+  updateParams();
+  if (!bkgE) {
+    bkgE = decltype(bkgE)(new fastjet::JetMedianBackgroundEstimator(selRho, jetDefBkg, areaDefBkg));
+  }
+  bkgE->set_particles(inputParticles);
+  rho = bkgE->rho();
+  rhoM = bkgE->rho_m();
+}
+
+void JetFinder::setBkgRho(double rho, double rhoM)
+{
+  mHasExternalRho = true;
+  mExternalRho = rho;
+  mExternalRhoM = rhoM;
+}
+
+void JetFinder::subtractBackground(std::vector<fastjet::PseudoJet>& inputParticles)
+{
+  updateParams();
+  if (mHasExternalRho) {
+    // the background densities are given, the estimator is not run
+    if (bkgSubMode == BkgSubMode::rhoAreaSub) {
+      sub = decltype(sub){new fastjet::Subtractor{mExternalRho}};
+    }
+    if (constituentSub) {
+      constituentSub->set_scalar_background_density(mExternalRho, mExternalRhoM);
+    }
+  } else if (bkgE) {
+    bkgE->set_particles(inputParticles);
   }
   if (constituentSub) {
     inputParticles = constituentSub->subtract_event(inputParticles);
   }
+}
+
+fastjet::ClusterSequenceArea JetFinder::clusterJets(std::vector<fastjet::PseudoJet> const& inputParticles, std::vector<fastjet::PseudoJet>& jets)
+{
+  updateParams();
+  jets.clear();
   fastjet::ClusterSequenceArea clusterSeq(inputParticles, jetDef, areaDef);
-  jets = sub ? (*sub)(clusterSeq.inclusive_jets()) : clusterSeq.inclusive_jets();
-  jets = selJets(jets);
-  jets = sorted_by_pt(jets);
-  if (isReclustering) {
-    jetR = jetR / 5.0;
-  }
+  jets = sorted_by_pt(selJets(sub ? (*sub)(clusterSeq.inclusive_jets()) : clusterSeq.inclusive_jets()));
   return clusterSeq;
 }
@@ -154,8 +154,14 @@ class JetFinder
   ~JetFinder() = default;
 
   /// Sets the jet finding parameters
+  /// \note called by findJets whenever jetR differs from the one of the last call, the other parameters
+  /// are expected to be set before the first call of findJets, a later change requires a call of resetParams
+  /// \note the background estimator and the subtractors do not depend on jetR, they are only set at the first call
   void setParams();
 
+  /// Forces the jet finding parameters to be set again at the next call of findJets
+  void resetParams() { mParamsAreSet = false; }
+
   /// Sets the background subtraction estimater pointer
   void setBkgE();
 
@@ -169,6 +175,34 @@ class JetFinder
   /// \return ClusterSequenceArea object needed to access constituents
   fastjet::ClusterSequenceArea findJets(std::vector<fastjet::PseudoJet>& inputParticles, std::vector<fastjet::PseudoJet>& jets); // ideally find a way of passing the cluster sequence as a reeference
 
+  /// Estimates the background densities of the event, with the background settings of the jet finder
+  /// \param inputParticles vector of input particles/tracks
+  /// \param rho background transverse momentum density
+  /// \param rhoM background mass density
+  void estimateRho(std::vector<fastjet::PseudoJet>& inputParticles, double& rho, double& rhoM);
+
+  /// Uses the given background densities of the event, e.g. from the BkgRhos table, instead of estimating them
+  /// \note to be called for each event before findJets or subtractBackground, until clearBkgRho is called
+  void setBkgRho(double rho, double rhoM);
+
+  /// Estimates the background densities in findJets again
+  void clearBkgRho()
+  {
+    mHasExternalRho = false;
+    resetParams();
+  }
+
+  /// Estimates the background of the event and, for constituent subtraction, subtracts it from the input particles
+  /// \note first step of findJets, to be called once per event before clusterJets when clustering with several jetR
+  /// \param inputParticles vector of input particles/tracks
+  void subtractBackground(std::vector<fastjet::PseudoJet>& inputParticles);
+
+  /// Performs jet finding on the particles returned by subtractBackground, with the current jetR
+  /// \param inputParticles vector of input particles/tracks, after subtractBackground
+  /// \param jets veector of jets to be filled
+  /// \return ClusterSequenceArea object needed to access constituents
+  fastjet::ClusterSequenceArea clusterJets(std::vector<fastjet::PseudoJet> const& inputParticles, std::vector<fastjet::PseudoJet>& jets);
+
  private:
   // void setParams();
   // void setBkgSub();
@@ -176,7 +210,17 @@ class JetFinder
   std::unique_ptr<fastjet::Subtractor> sub;
   std::unique_ptr<fastjet::contrib::ConstituentSubtractor> constituentSub;
 
-  ClassDefNV(JetFinder, 1);
+  bool mParamsAreSet = false; // jet and area definitions, background estimator and subtractors are set
+  float mParamsJetR = -1.;    // jetR for which the definitions are set
+
+  bool mHasExternalRho = false; // background densities given by setBkgRho
+  double mExternalRho = 0.;      // background transverse momentum density given by setBkgRho
+  double mExternalRhoM = 0.;     // background mass density given by setBkgRho
+
+  /// Sets the definitions at the first call and when jetR changes
+  void updateParams();
+
+  ClassDefNV(JetFinder, 2);
 };
 
 #endif // PWGJE_CORE_JETFINDER_H_
@@ -17,10 +17,12 @@
 #ifndef PWGJE_CORE_JETUTILITIES_H_
 #define PWGJE_CORE_JETUTILITIES_H_
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <numeric>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include <TKDTree.h>
@@ -223,6 +225,141 @@ std::tuple<std::vector<int>, std::vector<int>> MatchJetsGeometricallyImpl(
   return std::make_tuple(baseToTagMap, tagToBaseMap);
 }
 
+/**
+ * Eta-phi grid of a jet collection, for the search of the closest jet within a maximum distance.
+ *
+ * The cells are at least as large as the maximum distance and the grid is periodic in phi, so that the jets
+ * within the maximum distance of a point are in the 3x3 cells around it, without duplicating the jets around
+ * the phi boundary. The grid only stores the jet indices, the eta and phi vectors are used in place.
+ */
+template <typename T>
+class EtaPhiGrid
+{
+ public:
+  /**
+   * @param jetsPhi Jets phi
+   * @param jetsEta Jets eta
+   * @param maxDistance Maximum distance of the searches
+   */
+  EtaPhiGrid(const std::vector<T>& jetsPhi, const std::vector<T>& jetsEta, double maxDistance) : mJetsPhi(jetsPhi), mJetsEta(jetsEta)
+  {
+    const std::size_t nJets = jetsEta.size();
+    mCellSize = std::max(maxDistance, 1.e-3);
+    mEtaMin = nJets ? *std::min_element(jetsEta.begin(), jetsEta.end()) : 0.;
+    const double etaMax = nJets ? *std::max_element(jetsEta.begin(), jetsEta.end()) : 0.;
+    mNCellsEta = static_cast<int>((etaMax - mEtaMin) / mCellSize) + 1;
+    mNCellsPhi = std::max(static_cast<int>(2 * M_PI / mCellSize), 1);
+    mCellSizePhi = 2 * M_PI / mNCellsPhi;
+
+    // counting sort of the jets by cell
+    std::vector<int> jetCells(nJets);
+    mCellStarts.assign(mNCellsEta * mNCellsPhi + 1, 0);
+    for (std::size_t i = 0; i < nJets; i++) {
+      jetCells[i] = getCellEta(jetsEta[i]) * mNCellsPhi + getCellPhi(jetsPhi[i]);
+      mCellStarts[jetCells[i] + 1]++;
+    }
+    std::partial_sum(mCellStarts.begin(), mCellStarts.end(), mCellStarts.begin());
+    mJetIndices.resize(nJets);
+    std::vector<std::size_t> cellFill(mCellStarts.begin(), mCellStarts.end() - 1);
+    for (std::size_t i = 0; i < nJets; i++) {
+      mJetIndices[cellFill[jetCells[i]]++] = i;
+    }
+  }
+
+  /**
+   * @param phi Point phi
+   * @param eta Point eta
+   * @param maxDistance Maximum distance, not larger than the one of the grid
+   *
+   * @returns Index of the closest jet with a distance smaller than maxDistance, -1 if none.
+   */
+  int FindClosest(T phi, T eta, double maxDistance) const
+  {
+    int closest = -1;
+    double closestDistance = maxDistance;
+    forEachNeighbour(phi, eta, [&](std::size_t iJet, double distance) {
+      if (distance < closestDistance) {
+        closestDistance = distance;
+        closest = static_cast<int>(iJet);
+      }
+    });
+    return closest;
+  }
+
+  /**
+   * @param phi Point phi
+   * @param eta Point eta
+   * @param maxDistance Maximum distance, not larger than the one of the grid
+   * @param maxNumber Maximum number of jets
+   * @param indices Indices of the maxNumber closest jets with a distance smaller than maxDistance, by increasing distance, padded with -1
+   */
+  void FindClosest(T phi, T eta, double maxDistance, int maxNumber, std::vector<int>& indices) const
+  {
+    mCandidates.clear();
+    forEachNeighbour(phi, eta, [&](std::size_t iJet, double distance) {
+      if (distance < maxDistance) {
+        mCandidates.emplace_back(distance, static_cast<int>(iJet));
+      }
+    });
+    const std::size_t nFound = std::min(mCandidates.size(), static_cast<std::size_t>(std::max(maxNumber, 0)));
+    std::partial_sort(mCandidates.begin(), mCandidates.begin() + nFound, mCandidates.end());
+    indices.assign(maxNumber, -1);
+    for (std::size_t i = 0; i < nFound; i++) {
+      indices[i] = mCandidates[i].second;
+    }
+  }
+
+ private:
+  template <typename F>
+  void forEachNeighbour(T phi, T eta, F&& f) const
+  {
+    const int cellEta = static_cast<int>(std::floor((eta - mEtaMin) / mCellSize));
+    const int cellPhi = getCellPhi(phi);
+    // with less than 3 cells in phi, all the cells are neighbours
+    const int nNeighboursPhi = std::min(mNCellsPhi, 3);
+    for (int iEta = std::max(cellEta - 1, 0); iEta <= std::min(cellEta + 1, mNCellsEta - 1); iEta++) {
+      for (int dPhi = 0; dPhi < nNeighboursPhi; dPhi++) {
+        const int iPhi = nNeighboursPhi < 3 ? dPhi : (cellPhi + dPhi - 1 + mNCellsPhi) % mNCellsPhi;
+        const int cell = iEta * mNCellsPhi + iPhi;
+        for (std::size_t j = mCellStarts[cell]; j < mCellStarts[cell + 1]; j++) {
+          const std::size_t iJet = mJetIndices[j];
+          const double deltaEta = eta - mJetsEta[iJet];
+          double deltaPhi = std::abs(phi - mJetsPhi[iJet]);
+          if (deltaPhi > M_PI) {
+            deltaPhi = 2 * M_PI - deltaPhi;
+          }
+          f(iJet, std::sqrt(deltaEta * deltaEta + deltaPhi * deltaPhi));
+        }
+      }
+    }
+  }
+
+  int getCellEta(T eta) const
+  {
+    return std::clamp(static_cast<int>((eta - mEtaMin) / mCellSize), 0, mNCellsEta - 1);
+  }
+
+  int getCellPhi(T phi) const
+  {
+    double phiWrapped = std::fmod(static_cast<double>(phi), 2 * M_PI);
+    if (phiWrapped < 0) {
+      phiWrapped += 2 * M_PI;
+    }
+    return std::min(static_cast<int>(phiWrapped / mCellSizePhi), mNCellsPhi - 1);
+  }
+
+  const std::vector<T>& mJetsPhi;                          // jets phi
+  const std::vector<T>& mJetsEta;                          // jets eta
+  double mCellSize = 0.;                                   // cell size in eta
+  double mCellSizePhi = 0.;                                // cell size in phi, not smaller than the one in eta
+  double mEtaMin = 0.;                                     // lower edge of the grid in eta
+  int mNCellsEta = 1;                                      // number of cells in eta
+  int mNCellsPhi = 1;                                      // number of cells in phi
+  std::vector<std::size_t> mCellStarts;                    // index of the first jet of each cell in mJetIndices
+  std::vector<std::size_t> mJetIndices;                    // jet indices sorted by cell
+  mutable std::vector<std::pair<double, int>> mCandidates; // (distance, index) of the jets found around a point
+};
+
 /**
  * Geometrical jet matching.
  *
@@ -232,6 +369,9 @@ std::tuple<std::vector<int>, std::vector<int>> MatchJetsGeometricallyImpl(
  *
  * If no unique match was found for a jet, an index of -1 is stored.
  *
+ * The closest jets are searched in eta-phi grids of the collections, periodic in phi, so the jets
+ * are neither copied nor duplicated around the phi boundary.
+ *
  * @param jetsBasePhi Base jet collection phi.
  * @param jetsBaseEta Base jet collection eta.
  * @param jetsTagPhi Tag jet collection phi.
@@ -242,10 +382,10 @@ std::tuple<std::vector<int>, std::vector<int>> MatchJetsGeometricallyImpl(
  */
 template <typename T>
 std::tuple<std::vector<int>, std::vector<int>> MatchJetsGeometrically(
-  std::vector<T> jetsBasePhi,
-  std::vector<T> jetsBaseEta,
-  std::vector<T> jetsTagPhi,
-  std::vector<T> jetsTagEta,
+  const std::vector<T>& jetsBasePhi,
+  const std::vector<T>& jetsBaseEta,
+  const std::vector<T>& jetsTagPhi,
+  const std::vector<T>& jetsTagEta,
   double maxMatchingDistance)
 {
   // Validation
@@ -263,17 +403,29 @@ std::tuple<std::vector<int>, std::vector<int>> MatchJetsGeometrically(
     throw std::invalid_argument("Tag collection eta and phi sizes don't match. Check the inputs.");
   }
 
-  // To perform matching with periodic boundary conditions (ie. phi) with a KDTree, we need
-  // to duplicate data up to maxMatchingDistance in phi because phi is periodic.
-  // NOTE: vectors are modified in place to avoid copies.
-  auto&& [jetMapBaseToJetIndex, jetsBasePhiComparison, jetsBaseEtaComparison] = DuplicateJetsAroundPhiBoundary(jetsBasePhi, jetsBaseEta, maxMatchingDistance);
-  auto&& [jetMapTagToJetIndex, jetsTagPhiComparison, jetsTagEtaComparison] = DuplicateJetsAroundPhiBoundary(jetsTagPhi, jetsTagEta, maxMatchingDistance);
+  const EtaPhiGrid<T> gridBase(jetsBasePhi, jetsBaseEta, maxMatchingDistance);
+  const EtaPhiGrid<T> gridTag(jetsTagPhi, jetsTagEta, maxMatchingDistance);
 
-  // Finally, perform the actual matching.
-  auto&& [baseToTagMap, tagToBaseMap] = MatchJetsGeometricallyImpl(
-    jetsBasePhi, jetsBaseEta, jetsBasePhiComparison, jetsBaseEtaComparison, jetMapBaseToJetIndex,
-    jetsTagPhi, jetsTagEta, jetsTagPhiComparison, jetsTagEtaComparison, jetMapTagToJetIndex,
-    maxMatchingDistance);
+  // Find the tag jet closest to each base jet, and the base jet closest to each tag jet.
+  std::vector<int> matchIndexTag(nJetsBase, -1), matchIndexBase(nJetsTag, -1);
+  for (std::size_t iBase = 0; iBase < nJetsBase; iBase++) {
+    matchIndexTag[iBase] = gridTag.FindClosest(jetsBasePhi[iBase], jetsBaseEta[iBase], maxMatchingDistance);
+  }
+  for (std::size_t iTag = 0; iTag < nJetsTag; iTag++) {
+    matchIndexBase[iTag] = gridBase.FindClosest(jetsTagPhi[iTag], jetsTagEta[iTag], maxMatchingDistance);
+  }
+
+  // Finally, we'll check for true matches, which are pairs where the base jet is the
+  // closest to the tag jet and vice versa
+  std::vector<int> baseToTagMap(nJetsBase, -1);
+  std::vector<int> tagToBaseMap(nJetsTag, -1);
+  for (std::size_t iBase = 0; iBase < nJetsBase; iBase++) {
+    if (matchIndexTag[iBase] > -1 && matchIndexBase[matchIndexTag[iBase]] == static_cast<int>(iBase)) {
+      LOG(debug) << "True match! base index: " << iBase << ", tag index: " << matchIndexTag[iBase] << "\n";
+      baseToTagMap[iBase] = matchIndexTag[iBase];
+      tagToBaseMap[matchIndexTag[iBase]] = iBase;
+    }
+  }
 
   return std::make_tuple(baseToTagMap, tagToBaseMap);
 }
@@ -285,6 +437,9 @@ std::tuple<std::vector<int>, std::vector<int>> MatchJetsGeometrically(
  * If no unique match was found for a jet, an index of -1 is stored.
  * The same map is created for clusters matched to tracks e.g. for electron analyses.
  *
+ * The candidates are searched in eta-phi grids of the clusters and of the tracks, so each
+ * cluster (track) is only compared with the tracks (clusters) in the neighbouring cells.
+ *
  * @param clusterPhi cluster collection phi.
  * @param clusterEta cluster collection eta.
  * @param trackPhi track collection phi.
@@ -296,10 +451,10 @@ std::tuple<std::vector<int>, std::vector<int>> MatchJetsGeometrically(
  */
 template <typename T>
 std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>> MatchClustersAndTracks(
-  std::vector<T>& clusterPhi,
-  std::vector<T>& clusterEta,
-  std::vector<T>& trackPhi,
-  std::vector<T>& trackEta,
+  const std::vector<T>& clusterPhi,
+  const std::vector<T>& clusterEta,
+  const std::vector<T>& trackPhi,
+  const std::vector<T>& trackEta,
   double maxMatchingDistance,
   int maxNumberMatches)
 {
@@ -319,67 +474,21 @@ std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>> MatchCl
     throw std::invalid_argument("track collection eta and phi sizes don't match. Check the inputs.");
   }
 
-  // for (std::size_t iTrack = 0; iTrack < nTracks; iTrack++) {
-  //   if (trackEta[iTrack] == 0)
-  //     LOG(warning) << "Track eta is 0!";
-  // }
-
-  // Build the KD-trees using vectors
-  // We build two trees:
-  // treeBase, which contains the base collection.
-  // treeTag, which contains the tag collection.
-  // The trees are built to match in two dimensions (eta, phi)
-  TKDTree<int, T> treeCluster(clusterEta.size(), 2, 1), treeTrack(trackEta.size(), 2, 1);
-  // By utilizing SetData, we can avoid having to copy the data again.
-  treeCluster.SetData(0, clusterEta.data());
-  treeCluster.SetData(1, clusterPhi.data());
-  treeCluster.Build();
-  treeTrack.SetData(0, trackEta.data());
-  treeTrack.SetData(1, trackPhi.data());
-  treeTrack.Build();
+  const EtaPhiGrid<T> gridCluster(clusterPhi, clusterEta, maxMatchingDistance);
+  const EtaPhiGrid<T> gridTrack(trackPhi, trackEta, maxMatchingDistance);
 
   // Storage for the cluster matching indices.
-  std::vector<std::vector<int>> matchIndexTrack(nClusters, std::vector<int>(maxNumberMatches, -1));
-  std::vector<std::vector<int>> matchIndexCluster(nTracks, std::vector<int>(maxNumberMatches, -1));
+  std::vector<std::vector<int>> matchIndexTrack(nClusters);
+  std::vector<std::vector<int>> matchIndexCluster(nTracks);
 
-  // Find the track closest to each cluster.
+  // Find the tracks closest to each cluster.
   for (std::size_t iCluster = 0; iCluster < nClusters; iCluster++) {
-    T point[2] = {clusterEta[iCluster], clusterPhi[iCluster]};
-    int index[50];  // size 50 for safety
-    T distance[50]; // size 50 for safery
-    std::fill_n(index, 50, -1);
-    std::fill_n(distance, 50, std::numeric_limits<T>::max());
-    treeTrack.FindNearestNeighbors(point, maxNumberMatches, index, distance);
-    // test whether indices are matching:
-    matchIndexTrack[iCluster] = std::vector<int>(maxNumberMatches);
-    for (int m = 0; m < maxNumberMatches; m++) {
-      if (index[m] >= 0 && distance[m] < maxMatchingDistance) {
-        matchIndexTrack[iCluster][m] = index[m];
-      } else {
-        // no match or no more matches found, fill -1
-        matchIndexTrack[iCluster][m] = -1;
-      }
-    }
+    gridTrack.FindClosest(clusterPhi[iCluster], clusterEta[iCluster], maxMatchingDistance, maxNumberMatches, matchIndexTrack[iCluster]);
   }
 
-  // Find the base jet closest to each tag jet
+  // Find the clusters closest to each track
   for (std::size_t iTrack = 0; iTrack < nTracks; iTrack++) {
-    T point[2] = {trackEta[iTrack], trackPhi[iTrack]};
-    int index[50];  // size 50 for safety
-    T distance[50]; // size 50 for safery
-    std::fill_n(index, 50, -1);
-    std::fill_n(distance, 50, std::numeric_limits<T>::max());
-    treeCluster.FindNearestNeighbors(point, maxNumberMatches, index, distance);
-    matchIndexCluster[iTrack] = std::vector<int>(maxNumberMatches);
-    // loop over maxNumberMatches closest matches
-    for (int m = 0; m < maxNumberMatches; m++) {
-      if (index[m] >= 0 && distance[m] < maxMatchingDistance) {
-        matchIndexCluster[iTrack][m] = index[m];
-      } else {
-        // no match jet or no more matches found, fill -1
-        matchIndexCluster[iTrack][m] = -1;
-      }
-    }
+    gridCluster.FindClosest(trackPhi[iTrack], trackEta[iTrack], maxMatchingDistance, maxNumberMatches, matchIndexCluster[iTrack]);
   }
   return std::make_tuple(matchIndexTrack, matchIndexCluster);
 }
@@ -70,6 +70,17 @@ DECLARE_SOA_DYNAMIC_COLUMN(Pz, pz,
 DECLARE_SOA_DYNAMIC_COLUMN(P, p,
                            [](float pt, float eta) -> float { return pt * std::cosh(eta); });
 } // namespace constituentssub
+
+// Background densities of the collisions
+namespace bkgrho
+{
+DECLARE_SOA_COLUMN(Rho, rho, float);   //! transverse momentum density
+DECLARE_SOA_COLUMN(RhoM, rhoM, float); //! mass density
+} // namespace bkgrho
+DECLARE_SOA_TABLE(BkgRhos, "AOD", "BKGRHO", //! background densities, joinable with the collisions
+                  bkgrho::Rho,
+                  bkgrho::RhoM);
+using BkgRho = BkgRhos::iterator;
 } // namespace o2::aod
 
 // Defines the jet table definition
@@ -138,6 +149,23 @@ DECLARE_SOA_DYNAMIC_COLUMN(P, p,
                     constituentssub::Pz<constituentssub::Pt, constituentssub::Eta>, \
                     constituentssub::P<constituentssub::Pt, constituentssub::Eta>);
 
+// Defines the table of the kinematics of the constituents, contiguous per jet, so that the
+// constituent momenta are read without dereferencing the track or particle tables
+// NOTE: This relies on the jet index column being defined in the constituents namespace.
+#define DECLARE_CONSTITUENTS_PACKED_TABLE(_jet_type_, _name_, _Description_)        \
+  DECLARE_SOA_TABLE(_jet_type_##ConstituentsPacked, "AOD", _Description_ "CONSTPK", \
+                    _name_##constituents::_jet_type_##Id,                           \
+                    constituentssub::Pt,                                            \
+                    constituentssub::Eta,                                           \
+                    constituentssub::Phi,                                           \
+                    constituentssub::Energy,                                        \
+                    constituentssub::Mass,                                          \
+                    constituentssub::Source,                                        \
+                    constituentssub::Px<constituentssub::Pt, constituentssub::Phi>, \
+                    constituentssub::Py<constituentssub::Pt, constituentssub::Phi>, \
+                    constituentssub::Pz<constituentssub::Pt, constituentssub::Eta>, \
+                    constituentssub::P<constituentssub::Pt, constituentssub::Eta>);
+
 // combine definition of tables for jets, constituents, and substructure
 #define DECLARE_JET_TABLES(_collision_name_, _jet_type_, _const_type_, _hfcand_type_, _description_)        \
   DECLARE_JET_TABLE(_collision_name_, _jet_type_##Jet, _jet_type_##jet, _description_);                     \
@@ -145,7 +173,9 @@ DECLARE_SOA_DYNAMIC_COLUMN(P, p,
   DECLARE_CONSTITUENTS_TABLE(_jet_type_##Jet, _jet_type_##jet, _description_, _const_type_, _hfcand_type_); \
   using _jet_type_##Jet##Constituent = _jet_type_##Jet##Constituents::iterator;                             \
   DECLARE_CONSTITUENTS_SUB_TABLE(_jet_type_##Jet, _jet_type_##jet, _description_);                          \
-  using _jet_type_##Jet##ConstituentSub = _jet_type_##Jet##ConstituentsSub::iterator;
+  using _jet_type_##Jet##ConstituentSub = _jet_type_##Jet##ConstituentsSub::iterator;                       \
+  DECLARE_CONSTITUENTS_PACKED_TABLE(_jet_type_##Jet, _jet_type_##jet, _description_);                       \
+  using _jet_type_##Jet##ConstituentPacked = _jet_type_##Jet##ConstituentsPacked::iterator;
 
 #define DECLARE_JETMATCHING_TABLE(_jet_type_base_, _jet_type_tag_, _description_)               \
   DECLARE_SOA_TABLE(_jet_type_base_##JetsMatchedTo##_jet_type_tag_##Jets, "AOD", _description_, \
@@ -0,0 +1,111 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+// Table definitions for the jet skims
+//
+// The compact skim stores the constituent kinematics quantised on 16 bits: pt on a
+// logarithmic scale, eta and phi in fixed point. The decoded values are given by the
+// dynamic columns, so that the compact skim is read as the full one.
+//
+// Author: Nima Zardoshti
+
+#ifndef PWGJE_DATAMODEL_JETSKIM_H_
+#define PWGJE_DATAMODEL_JETSKIM_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#include "CommonConstants/MathConstants.h"
+#include "Framework/AnalysisDataModel.h"
+
+namespace o2::aod
+{
+namespace jetskim
+{
+DECLARE_SOA_INDEX_COLUMN(Collision, collision);
+DECLARE_SOA_COLUMN(Pt, pt, float);
+DECLARE_SOA_COLUMN(Eta, eta, float);
+DECLARE_SOA_COLUMN(Phi, phi, float);
+DECLARE_SOA_COLUMN(Energy, energy, float);
+} // namespace jetskim
+DECLARE_SOA_TABLE(JetSkim, "AOD", "JETSKIM1",
+                  jetskim::CollisionId,
+                  jetskim::Pt, jetskim::Eta, jetskim::Phi, jetskim::Energy);
+
+namespace jetskimcompact
+{
+// quantisation of the kinematics
+constexpr float PtMin = 0.01f;                                                     // GeV/c, lowest pt stored
+constexpr float PtMax = 1000.f;                                                    // GeV/c, highest pt stored
+constexpr float PtLogStep = 1.7567e-4f;                                            // log(PtMax / PtMin) / 65535, relative pt resolution
+constexpr float EtaStep = 1.e-4f;                                                  // eta in [-3.2768, 3.2767]
+constexpr float PhiStep = static_cast<float>(o2::constants::math::TwoPI / 65536.); // phi in [0, 2pi)
+
+// bits of the type of the constituent
+enum TypeBits : uint8_t {
+  kCluster = 1 << 0,  // EMCal cluster, track otherwise
+  kNegative = 1 << 1, // negative charge
+};
+
+inline uint16_t encodePt(float pt)
+{
+  float code = std::round(std::log(std::clamp(pt, PtMin, PtMax) / PtMin) / PtLogStep);
+  return static_cast<uint16_t>(std::min(code, 65535.f));
+}
+inline float decodePt(uint16_t code) { return PtMin * std::exp(code * PtLogStep); }
+
+inline int16_t encodeEta(float eta) { return static_cast<int16_t>(std::clamp(std::round(eta / EtaStep), -32768.f, 32767.f)); }
+inline float decodeEta(int16_t code) { return code * EtaStep; }
+
+inline uint16_t encodePhi(float phi)
+{
+  auto code = static_cast<int>(std::round(phi / PhiStep)) % 65536;
+  return static_cast<uint16_t>(code < 0 ? code + 65536 : code);
+}
+inline float decodePhi(uint16_t code) { return code * PhiStep; }
+
+DECLARE_SOA_INDEX_COLUMN(Track, track);                   //!
+DECLARE_SOA_COLUMN(PtCode, ptCode, uint16_t);             //! log-quantised pt
+DECLARE_SOA_COLUMN(EtaCode, etaCode, int16_t);            //! fixed-point eta
+DECLARE_SOA_COLUMN(PhiCode, phiCode, uint16_t);           //! fixed-point phi
+DECLARE_SOA_COLUMN(Type, type, uint8_t);                  //! type bits, see TypeBits
+DECLARE_SOA_DYNAMIC_COLUMN(Pt, pt,                        //!
+                           [](uint16_t ptCode) -> float { return decodePt(ptCode); });
+DECLARE_SOA_DYNAMIC_COLUMN(Eta, eta, //!
+                           [](int16_t etaCode) -> float { return decodeEta(etaCode); });
+DECLARE_SOA_DYNAMIC_COLUMN(Phi, phi, //!
+                           [](uint16_t phiCode) -> float { return decodePhi(phiCode); });
+DECLARE_SOA_DYNAMIC_COLUMN(Px, px, //!
+                           [](uint16_t ptCode, uint16_t phiCode) -> float { return decodePt(ptCode) * std::cos(decodePhi(phiCode)); });
+DECLARE_SOA_DYNAMIC_COLUMN(Py, py, //!
+                           [](uint16_t ptCode, uint16_t phiCode) -> float { return decodePt(ptCode) * std::sin(decodePhi(phiCode)); });
+DECLARE_SOA_DYNAMIC_COLUMN(Pz, pz, //!
+                           [](uint16_t ptCode, int16_t etaCode) -> float { return decodePt(ptCode) * std::sinh(decodeEta(etaCode)); });
+DECLARE_SOA_DYNAMIC_COLUMN(IsCluster, isCluster, //!
+                           [](uint8_t type) -> bool { return type & kCluster; });
+DECLARE_SOA_DYNAMIC_COLUMN(Sign, sign, //! charge sign, 0 for clusters
+                           [](uint8_t type) -> int { return (type & kCluster) ? 0 : ((type & kNegative) ? -1 : 1); });
+} // namespace jetskimcompact
+DECLARE_SOA_TABLE(JetSkimCompact, "AOD", "JETSKIMC",
+                  jetskim::CollisionId, jetskimcompact::TrackId,
+                  jetskimcompact::PtCode, jetskimcompact::EtaCode, jetskimcompact::PhiCode, jetskimcompact::Type,
+                  jetskimcompact::Pt<jetskimcompact::PtCode>,
+                  jetskimcompact::Eta<jetskimcompact::EtaCode>,
+                  jetskimcompact::Phi<jetskimcompact::PhiCode>,
+                  jetskimcompact::Px<jetskimcompact::PtCode, jetskimcompact::PhiCode>,
+                  jetskimcompact::Py<jetskimcompact::PtCode, jetskimcompact::PhiCode>,
+                  jetskimcompact::Pz<jetskimcompact::PtCode, jetskimcompact::EtaCode>,
+                  jetskimcompact::IsCluster<jetskimcompact::Type>,
+                  jetskimcompact::Sign<jetskimcompact::Type>);
+} // namespace o2::aod
+
+#endif // PWGJE_DATAMODEL_JETSKIM_H_
@@ -96,6 +96,18 @@ struct EmcalCorrectionTask {
   o2::emcal::NonlinearityHandler mNonlinearityHandler;
   // Cells and clusters
   std::vector<o2::emcal::AnalysisCluster> mAnalysisClusters;
+  std::vector<o2::emcal::Cell> mCellsBC;
+  std::vector<int64_t> mCellIndicesBC;
+  // Position of each cell, indexed by the cell ID, filled once from the geometry
+  std::vector<float> mCellEta;
+  std::vector<float> mCellPhi;
+  std::vector<int> mCellRow;
+  std::vector<int> mCellCol;
+  // Tracks of the collision of the current BC, shared by the clusterizers
+  int64_t mTrackInfoCollisionId = -1;
+  std::vector<double> mTrackPhi;
+  std::vector<double> mTrackEta;
+  std::vector<int64_t> mTrackGlobalIndex;
 
   std::vector<o2::aod::EMCALClusterDefinition> mClusterDefinitions;
   // QA
@@ -152,6 +164,7 @@ struct EmcalCorrectionTask {
     for (auto& clusterizer : mClusterizers) {
       clusterizer->setGeometry(geometry);
     }
+    fillCellPositions(geometry);
 
     if (mClusterizers.size() == 0) {
       LOG(error) << "No cluster definitions specified!";
@@ -215,6 +228,7 @@ struct EmcalCorrectionTask {
   {
     LOG(debug) << "Starting process full.";
 
+    mTrackInfoCollisionId = -1;
     int nBCsProcessed = 0;
     int nCellsProcessed = 0;
     for (auto bc : bcs) {
@@ -233,8 +247,12 @@ struct EmcalCorrectionTask {
       }
       // Counters for BCs with matched collisions
       countBC(collisionsInFoundBC.size(), true);
-      std::vector<o2::emcal::Cell> cellsBC;
-      std::vector<int64_t> cellIndicesBC;
+      auto& cellsBC = mCellsBC;
+      auto& cellIndicesBC = mCellIndicesBC;
+      cellsBC.clear();
+      cellIndicesBC.clear();
+      cellsBC.reserve(cellsInBC.size());
+      cellIndicesBC.reserve(cellsInBC.size());
       for (auto& cell : cellsInBC) {
         auto amplitude = cell.amplitude();
         if (static_cast<bool>(hasShaperCorrection)) {
@@ -309,6 +327,7 @@ struct EmcalCorrectionTask {
   {
     LOG(debug) << "Starting process full.";
 
+    mTrackInfoCollisionId = -1;
     int nBCsProcessed = 0;
     int nCellsProcessed = 0;
     for (auto bc : bcs) {
@@ -327,8 +346,12 @@ struct EmcalCorrectionTask {
       }
       // Counters for BCs with matched collisions
       countBC(collisionsInFoundBC.size(), true);
-      std::vector<o2::emcal::Cell> cellsBC;
-      std::vector<int64_t> cellIndicesBC;
+      auto& cellsBC = mCellsBC;
+      auto& cellIndicesBC = mCellIndicesBC;
+      cellsBC.clear();
+      cellIndicesBC.clear();
+      cellsBC.reserve(cellsInBC.size());
+      cellIndicesBC.reserve(cellsInBC.size());
       for (auto& cell : cellsInBC) {
         mHistManager.fill(HIST("hContributors"), cell.mcParticle().size());
         auto cellParticles = cell.mcParticle_as<aod::StoredMcParticles_001>();
@@ -425,8 +448,12 @@ struct EmcalCorrectionTask {
       }
       // Counters for BCs with matched collisions
       countBC(collisionsInBC.size(), true);
-      std::vector<o2::emcal::Cell> cellsBC;
-      std::vector<int64_t> cellIndicesBC;
+      auto& cellsBC = mCellsBC;
+      auto& cellIndicesBC = mCellIndicesBC;
+      cellsBC.clear();
+      cellIndicesBC.clear();
+      cellsBC.reserve(cellsInBC.size());
+      cellIndicesBC.reserve(cellsInBC.size());
       for (auto& cell : cellsInBC) {
         cellsBC.emplace_back(cell.cellNumber(),
                              cell.amplitude(),
@@ -617,15 +644,21 @@ struct EmcalCorrectionTask {
   template <typename Collision>
   void doTrackMatching(Collision const& col, myGlobTracks const& tracks, std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>>& IndexMapPair, math_utils::Point3D<float>& vertex_pos, std::vector<int64_t>& trackGlobalIndex)
   {
-    auto groupedTracks = tracks.sliceBy(perCollision, col.globalIndex());
-    int NTracksInCol = groupedTracks.size();
-    std::vector<double> trackPhi;
-    std::vector<double> trackEta;
-    // reserve memory to reduce on the fly memory allocation
-    trackPhi.reserve(NTracksInCol);
-    trackEta.reserve(NTracksInCol);
-    trackGlobalIndex.reserve(NTracksInCol);
-    FillTrackInfo<decltype(groupedTracks)>(groupedTracks, trackPhi, trackEta, trackGlobalIndex);
+    // the tracks of a collision are the same for all the clusterizers, so they are only read once per BC
+    if (col.globalIndex() != mTrackInfoCollisionId) {
+      auto groupedTracks = tracks.sliceBy(perCollision, col.globalIndex());
+      int NTracksInCol = groupedTracks.size();
+      mTrackPhi.clear();
+      mTrackEta.clear();
+      mTrackGlobalIndex.clear();
+      // reserve memory to reduce on the fly memory allocation
+      mTrackPhi.reserve(NTracksInCol);
+      mTrackEta.reserve(NTracksInCol);
+      mTrackGlobalIndex.reserve(NTracksInCol);
+      FillTrackInfo<decltype(groupedTracks)>(groupedTracks, mTrackPhi, mTrackEta, mTrackGlobalIndex);
+      mTrackInfoCollisionId = col.globalIndex();
+    }
+    trackGlobalIndex = mTrackGlobalIndex;
 
     int NClusterInCol = mAnalysisClusters.size();
     std::vector<double> clusterPhi;
@@ -647,7 +680,7 @@ struct EmcalCorrectionTask {
     }
     IndexMapPair =
       JetUtilities::MatchClustersAndTracks(clusterPhi, clusterEta,
-                                           trackPhi, trackEta,
+                                           mTrackPhi, mTrackEta,
                                            maxMatchingDistance, 20);
   }
 
@@ -700,18 +733,38 @@ struct EmcalCorrectionTask {
     mHistManager.fill(HIST("hBC"), 1 + emcDataOffset + collisionOffset);
   }
 
+  void fillCellPositions(o2::emcal::Geometry* geometry)
+  {
+    // The positions only depend on the geometry, so they are computed once
+    // instead of for every cell of every BC
+    int nCells = geometry ? geometry->GetNCells() : 0;
+    mCellEta.resize(nCells);
+    mCellPhi.resize(nCells);
+    mCellRow.resize(nCells);
+    mCellCol.resize(nCells);
+    for (int cellID = 0; cellID < nCells; cellID++) {
+      auto [eta, phi] = geometry->EtaPhiFromIndex(cellID);
+      mCellEta[cellID] = eta;
+      mCellPhi[cellID] = TVector2::Phi_0_2pi(phi);
+      auto [row, col] = geometry->GlobalRowColFromIndex(cellID);
+      mCellRow[cellID] = row;
+      mCellCol[cellID] = col;
+    }
+  }
+
   void fillQAHistogram(const gsl::span<o2::emcal::Cell> cellsBC)
   {
     // Cell QA
-    // For convenience, use the clusterizer stored geometry to get the eta-phi
     for (auto& cell : cellsBC) {
+      auto cellID = cell.getTower();
       mHistManager.fill(HIST("hCellE"), cell.getEnergy());
-      mHistManager.fill(HIST("hCellTowerID"), cell.getTower());
-      auto res = mClusterizers.at(0)->getGeometry()->EtaPhiFromIndex(cell.getTower());
-      mHistManager.fill(HIST("hCellEtaPhi"), std::get<0>(res), TVector2::Phi_0_2pi(std::get<1>(res)));
-      res = mClusterizers.at(0)->getGeometry()->GlobalRowColFromIndex(cell.getTower());
+      mHistManager.fill(HIST("hCellTowerID"), cellID);
+      if (cellID < 0 || cellID >= static_cast<int>(mCellEta.size())) {
+        continue;
+      }
+      mHistManager.fill(HIST("hCellEtaPhi"), mCellEta[cellID], mCellPhi[cellID]);
       // NOTE: Reversed column and row because it's more natural for presentation.
-      mHistManager.fill(HIST("hCellRowCol"), std::get<1>(res), std::get<0>(res));
+      mHistManager.fill(HIST("hCellRowCol"), mCellCol[cellID], mCellRow[cellID]);
     }
   }
 };
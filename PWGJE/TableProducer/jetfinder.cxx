@@ -21,11 +21,12 @@ using namespace o2::framework::expressions;
 
 #include "Framework/runDataProcessing.h"
 
-template <typename JetTable, typename ConstituentTable, typename ConstituentSubTable>
+template <typename JetTable, typename ConstituentTable, typename ConstituentSubTable, typename ConstituentPackedTable>
 struct JetFinderTask {
   Produces<JetTable> jetsTable;
   Produces<ConstituentTable> constituentsTable;
   Produces<ConstituentSubTable> constituentsSubTable;
+  Produces<ConstituentPackedTable> constituentsPackedTable;
 
   // event level configurables
   Configurable<float> vertexZCut{"vertexZCut", 10.0f, "Accepted z-vertex range"};
@@ -63,6 +64,7 @@ struct JetFinderTask {
   Configurable<bool> DoTriggering{"DoTriggering", false, "used for the charged jet trigger to remove the eta constraint on the jet axis"};
   Configurable<bool> DoRhoAreaSub{"DoRhoAreaSub", false, "do rho area subtraction"};
   Configurable<bool> DoConstSub{"DoConstSub", false, "do constituent subtraction"};
+  Configurable<bool> doPackedConstituents{"doPackedConstituents", false, "write the kinematics of the jet constituents in the packed constituent table"};
 
   Service<O2DatabasePDG> pdg;
   std::string trackSelection;
@@ -114,11 +116,37 @@ struct JetFinderTask {
     }
     inputParticles.clear();
     analyseTracks<JetTracks, JetTracks::iterator>(inputParticles, tracks, trackSelection);
-    findJets(jetFinder, inputParticles, jetRadius, collision, jetsTable, constituentsTable, constituentsSubTable, DoConstSub);
+    findJets(jetFinder, inputParticles, jetRadius, collision, jetsTable, constituentsTable, constituentsSubTable, constituentsPackedTable, DoConstSub, doPackedConstituents);
   }
 
   PROCESS_SWITCH(JetFinderTask, processChargedJets, "Data jet finding for charged jets", false);
 
+  void processChargedJetsWithRho(soa::Filtered<soa::Join<aod::Collisions, aod::EvSels, aod::BkgRhos>>::iterator const& collision,
+                                 JetTracks const& tracks)
+  {
+    if (!selectCollision(collision, evSel)) {
+      return;
+    }
+    // background densities from the rho estimator instead of estimating them again
+    jetFinder.setBkgRho(collision.rho(), collision.rhoM());
+    inputParticles.clear();
+    analyseTracks<JetTracks, JetTracks::iterator>(inputParticles, tracks, trackSelection);
+    findJets(jetFinder, inputParticles, jetRadius, collision, jetsTable, constituentsTable, constituentsSubTable, constituentsPackedTable, DoConstSub, doPackedConstituents);
+  }
+
+  PROCESS_SWITCH(JetFinderTask, processChargedJetsWithRho, "Data jet finding for charged jets, with the background densities of the rho estimator", false);
+
+  void processChargedJetsFromSkim(soa::Filtered<aod::Collisions>::iterator const& collision,
+                                  aod::JetSkimCompact const& skimmedTracks)
+  {
+    // the skim has no event selection and track selection bits, only the kinematic selections are applied
+    inputParticles.clear();
+    analyseSkimmedTracks(inputParticles, skimmedTracks, trackPtMin, trackPtMax, trackEtaMin, trackEtaMax, trackPhiMin, trackPhiMax);
+    findJets(jetFinder, inputParticles, jetRadius, collision, jetsTable, constituentsTable, constituentsSubTable, constituentsPackedTable, DoConstSub, doPackedConstituents);
+  }
+
+  PROCESS_SWITCH(JetFinderTask, processChargedJetsFromSkim, "Data jet finding for charged jets, from the compact jet skim", false);
+
   void processNeutralJets(soa::Filtered<soa::Join<aod::Collisions, aod::EvSels>>::iterator const& collision,
                           JetClusters const& clusters)
   {
@@ -127,7 +155,7 @@ struct JetFinderTask {
     }
     inputParticles.clear();
     analyseClusters(inputParticles, &clusters);
-    findJets(jetFinder, inputParticles, jetRadius, collision, jetsTable, constituentsTable, constituentsSubTable, DoConstSub);
+    findJets(jetFinder, inputParticles, jetRadius, collision, jetsTable, constituentsTable, constituentsSubTable, constituentsPackedTable, DoConstSub, doPackedConstituents);
   }
   PROCESS_SWITCH(JetFinderTask, processNeutralJets, "Data jet finding for neutral jets", false);
 
@@ -141,7 +169,7 @@ struct JetFinderTask {
     inputParticles.clear();
     analyseTracks<JetTracks, JetTracks::iterator>(inputParticles, tracks, trackSelection);
     analyseClusters(inputParticles, &clusters);
-    findJets(jetFinder, inputParticles, jetRadius, collision, jetsTable, constituentsTable, constituentsSubTable, DoConstSub);
+    findJets(jetFinder, inputParticles, jetRadius, collision, jetsTable, constituentsTable, constituentsSubTable, constituentsPackedTable, DoConstSub, doPackedConstituents);
   }
 
   PROCESS_SWITCH(JetFinderTask, processFullJets, "Data jet finding for full and neutral jets", false);
@@ -150,22 +178,22 @@ struct JetFinderTask {
   {
     // TODO: MC event selection?
     analyseParticles<aod::McParticles, aod::McParticles::iterator>(inputParticles, trackEtaMin, trackEtaMax, jetTypeParticleLevel, particles, pdg->Instance());
-    findJets(jetFinder, inputParticles, jetRadius, collision, jetsTable, constituentsTable, constituentsSubTable, DoConstSub);
+    findJets(jetFinder, inputParticles, jetRadius, collision, jetsTable, constituentsTable, constituentsSubTable, constituentsPackedTable, DoConstSub, doPackedConstituents);
   }
 
   PROCESS_SWITCH(JetFinderTask, processParticleLevelJets, "Particle level jet finding", false);
 };
 
-using JetFinderDataCharged = JetFinderTask<o2::aod::ChargedJets, o2::aod::ChargedJetConstituents, o2::aod::ChargedJetConstituentsSub>;
-using JetFinderDataFull = JetFinderTask<o2::aod::FullJets, o2::aod::FullJetConstituents, o2::aod::FullJetConstituentsSub>;
-using JetFinderDataNeutral = JetFinderTask<o2::aod::NeutralJets, o2::aod::NeutralJetConstituents, o2::aod::NeutralJetConstituentsSub>;
-using JetFinderMCDetectorLevelCharged = JetFinderTask<o2::aod::ChargedMCDetectorLevelJets, o2::aod::ChargedMCDetectorLevelJetConstituents, o2::aod::ChargedMCDetectorLevelJetConstituentsSub>;
-using JetFinderMCDetectorLevelFull = JetFinderTask<o2::aod::FullMCDetectorLevelJets, o2::aod::FullMCDetectorLevelJetConstituents, o2::aod::FullMCDetectorLevelJetConstituentsSub>;
-using JetFinderMCDetectorLevelNeutral = JetFinderTask<o2::aod::NeutralMCDetectorLevelJets, o2::aod::NeutralMCDetectorLevelJetConstituents, o2::aod::NeutralMCDetectorLevelJetConstituentsSub>;
-using JetFinderMCParticleLevelCharged = JetFinderTask<o2::aod::ChargedMCParticleLevelJets, o2::aod::ChargedMCParticleLevelJetConstituents, o2::aod::ChargedMCParticleLevelJetConstituentsSub>;
-using JetFinderMCParticleLevelFull = JetFinderTask<o2::aod::FullMCParticleLevelJets, o2::aod::FullMCParticleLevelJetConstituents, o2::aod::FullMCParticleLevelJetConstituentsSub>;
-using JetFinderMCParticleLevelNeutral = JetFinderTask<o2::aod::NeutralMCParticleLevelJets, o2::aod::NeutralMCParticleLevelJetConstituents, o2::aod::NeutralMCParticleLevelJetConstituentsSub>;
-// using JetFinderHybridIntermediate = JetFinderTask<o2::aod::HybridIntermediateJets, o2::aod::HybridIntermediateJetConstituents, o2::aod::HybridIntermediateJetConstituentsSub>;
+using JetFinderDataCharged = JetFinderTask<o2::aod::ChargedJets, o2::aod::ChargedJetConstituents, o2::aod::ChargedJetConstituentsSub, o2::aod::ChargedJetConstituentsPacked>;
+using JetFinderDataFull = JetFinderTask<o2::aod::FullJets, o2::aod::FullJetConstituents, o2::aod::FullJetConstituentsSub, o2::aod::FullJetConstituentsPacked>;
+using JetFinderDataNeutral = JetFinderTask<o2::aod::NeutralJets, o2::aod::NeutralJetConstituents, o2::aod::NeutralJetConstituentsSub, o2::aod::NeutralJetConstituentsPacked>;
+using JetFinderMCDetectorLevelCharged = JetFinderTask<o2::aod::ChargedMCDetectorLevelJets, o2::aod::ChargedMCDetectorLevelJetConstituents, o2::aod::ChargedMCDetectorLevelJetConstituentsSub, o2::aod::ChargedMCDetectorLevelJetConstituentsPacked>;
+using JetFinderMCDetectorLevelFull = JetFinderTask<o2::aod::FullMCDetectorLevelJets, o2::aod::FullMCDetectorLevelJetConstituents, o2::aod::FullMCDetectorLevelJetConstituentsSub, o2::aod::FullMCDetectorLevelJetConstituentsPacked>;
+using JetFinderMCDetectorLevelNeutral = JetFinderTask<o2::aod::NeutralMCDetectorLevelJets, o2::aod::NeutralMCDetectorLevelJetConstituents, o2::aod::NeutralMCDetectorLevelJetConstituentsSub, o2::aod::NeutralMCDetectorLevelJetConstituentsPacked>;
+using JetFinderMCParticleLevelCharged = JetFinderTask<o2::aod::ChargedMCParticleLevelJets, o2::aod::ChargedMCParticleLevelJetConstituents, o2::aod::ChargedMCParticleLevelJetConstituentsSub, o2::aod::ChargedMCParticleLevelJetConstituentsPacked>;
+using JetFinderMCParticleLevelFull = JetFinderTask<o2::aod::FullMCParticleLevelJets, o2::aod::FullMCParticleLevelJetConstituents, o2::aod::FullMCParticleLevelJetConstituentsSub, o2::aod::FullMCParticleLevelJetConstituentsPacked>;
+using JetFinderMCParticleLevelNeutral = JetFinderTask<o2::aod::NeutralMCParticleLevelJets, o2::aod::NeutralMCParticleLevelJetConstituents, o2::aod::NeutralMCParticleLevelJetConstituentsSub, o2::aod::NeutralMCParticleLevelJetConstituentsPacked>;
+// using JetFinderHybridIntermediate = JetFinderTask<o2::aod::HybridIntermediateJets, o2::aod::HybridIntermediateJetConstituents, o2::aod::HybridIntermediateJetConstituentsSub, o2::aod::HybridIntermediateJetConstituentsPacked>;
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
 {
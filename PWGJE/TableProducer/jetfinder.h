@@ -16,6 +16,8 @@
 #ifndef PWGJE_TABLEPRODUCER_JETFINDER_H_
 #define PWGJE_TABLEPRODUCER_JETFINDER_H_
 
+#include <algorithm>
+#include <array>
 #include <vector>
 #include <string>
 
@@ -39,6 +41,7 @@
 #include "PWGJE/Core/FastJetUtilities.h"
 #include "PWGJE/Core/JetFinder.h"
 #include "PWGJE/DataModel/Jet.h"
+#include "PWGJE/DataModel/JetSkim.h"
 
 using JetTracks = soa::Filtered<soa::Join<aod::Tracks, aod::TrackSelection>>;
 using JetClusters = o2::soa::Filtered<o2::aod::EMCALClusters>;
@@ -73,35 +76,77 @@ bool selectTrack(T const& track, std::string trackSelection)
   }
 }
 
+// function that returns the global indices of the tracks of a HF candidate, -1 for the unused entries
+template <typename U>
+std::array<int64_t, 3> getCandidateDaughterIndices(U const& cand)
+{
+  std::array<int64_t, 3> daughterIndices{-1, -1, -1};
+  if constexpr (std::is_same_v<std::decay_t<U>, CandidateD0Data::iterator> || std::is_same_v<std::decay_t<U>, CandidateD0Data::filtered_iterator> || std::is_same_v<std::decay_t<U>, CandidateD0MC::iterator> || std::is_same_v<std::decay_t<U>, CandidateD0MC::filtered_iterator>) {
+    daughterIndices = {cand.template prong0_as<JetTracks>().globalIndex(), cand.template prong1_as<JetTracks>().globalIndex(), -1};
+  }
+
+  if constexpr (std::is_same_v<std::decay_t<U>, CandidateLcData::iterator> || std::is_same_v<std::decay_t<U>, CandidateLcData::filtered_iterator> || std::is_same_v<std::decay_t<U>, CandidateLcMC::iterator> || std::is_same_v<std::decay_t<U>, CandidateLcMC::filtered_iterator>) {
+    daughterIndices = {cand.template prong0_as<JetTracks>().globalIndex(), cand.template prong1_as<JetTracks>().globalIndex(), cand.template prong2_as<JetTracks>().globalIndex()};
+  }
+
+  if constexpr (std::is_same_v<std::decay_t<U>, CandidateBplusData::iterator> || std::is_same_v<std::decay_t<U>, CandidateBplusData::filtered_iterator> || std::is_same_v<std::decay_t<U>, CandidateBplusMC::iterator> || std::is_same_v<std::decay_t<U>, CandidateBplusMC::filtered_iterator>) {
+    auto candD0 = cand.template prong0_as<aod::HfCand2Prong>();
+    daughterIndices = {candD0.template prong0_as<JetTracks>().globalIndex(), candD0.template prong1_as<JetTracks>().globalIndex(), cand.template prong1_as<JetTracks>().globalIndex()};
+  }
+  return daughterIndices;
+}
+
 // function that adds tracks to the fastjet list, removing daughters of 2Prong candidates
 template <typename T, typename U>
 void analyseTracks(std::vector<fastjet::PseudoJet>& inputParticles, T const& tracks, std::string trackSelection, std::optional<U> const& candidate = std::nullopt)
 {
+  std::array<int64_t, 3> daughterIndices{-1, -1, -1};
+  if (candidate != std::nullopt) {
+    daughterIndices = getCandidateDaughterIndices(candidate.value());
+  }
   for (auto& track : tracks) {
     if (!selectTrack(track, trackSelection)) {
       continue;
     }
-    if (candidate != std::nullopt) {
-      auto cand = candidate.value();
-      if constexpr (std::is_same_v<std::decay_t<U>, CandidateD0Data::iterator> || std::is_same_v<std::decay_t<U>, CandidateD0Data::filtered_iterator> || std::is_same_v<std::decay_t<U>, CandidateD0MC::iterator> || std::is_same_v<std::decay_t<U>, CandidateD0MC::filtered_iterator>) {
-        if (cand.template prong0_as<JetTracks>().globalIndex() == track.globalIndex() || cand.template prong1_as<JetTracks>().globalIndex() == track.globalIndex()) {
-          continue;
-        }
-      }
+    if (std::find(daughterIndices.begin(), daughterIndices.end(), track.globalIndex()) != daughterIndices.end()) {
+      continue;
+    }
+    FastJetUtilities::fillTracks(track, inputParticles, track.globalIndex());
+  }
+}
 
-      if constexpr (std::is_same_v<std::decay_t<U>, CandidateLcData::iterator> || std::is_same_v<std::decay_t<U>, CandidateLcData::filtered_iterator> || std::is_same_v<std::decay_t<U>, CandidateLcMC::iterator> || std::is_same_v<std::decay_t<U>, CandidateLcMC::filtered_iterator>) {
-        if (cand.template prong0_as<JetTracks>().globalIndex() == track.globalIndex() || cand.template prong1_as<JetTracks>().globalIndex() == track.globalIndex() || cand.template prong2_as<JetTracks>().globalIndex() == track.globalIndex()) {
-          continue;
-        }
-      }
+// function that adds the tracks of a list filled by analyseTracks to the fastjet list, removing the daughters of a HF candidate
+// the track selection is then done once per collision instead of once per candidate
+inline void addTracksWithoutDaughters(std::vector<fastjet::PseudoJet>& inputParticles, std::vector<fastjet::PseudoJet> const& trackParticles, std::array<int64_t, 3> const& daughterIndices)
+{
+  inputParticles.reserve(inputParticles.size() + trackParticles.size());
+  for (auto const& trackParticle : trackParticles) {
+    if (std::find(daughterIndices.begin(), daughterIndices.end(), trackParticle.user_info<FastJetUtilities::fastjet_user_info>().getIndex()) != daughterIndices.end()) {
+      continue;
+    }
+    inputParticles.push_back(trackParticle);
+  }
+}
 
-      if constexpr (std::is_same_v<std::decay_t<U>, CandidateBplusData::iterator> || std::is_same_v<std::decay_t<U>, CandidateBplusData::filtered_iterator> || std::is_same_v<std::decay_t<U>, CandidateBplusMC::iterator> || std::is_same_v<std::decay_t<U>, CandidateBplusMC::filtered_iterator>) {
-        if (cand.template prong0_as<aod::HfCand2Prong>().template prong0_as<JetTracks>().globalIndex() == track.globalIndex() || cand.template prong0_as<aod::HfCand2Prong>().template prong1_as<JetTracks>().globalIndex() == track.globalIndex() || cand.template prong1_as<JetTracks>().globalIndex() == track.globalIndex()) {
-          continue;
-        }
-      }
+// function that adds the tracks of a compact jet skim to the fastjet list
+// the kinematics are decoded once per track, the energy is given by the pion mass hypothesis
+template <typename T>
+void analyseSkimmedTracks(std::vector<fastjet::PseudoJet>& inputParticles, T const& skimmedTracks, float ptMin, float ptMax, float etaMin, float etaMax, float phiMin, float phiMax)
+{
+  for (auto& skimmedTrack : skimmedTracks) {
+    if (skimmedTrack.isCluster()) {
+      continue;
     }
-    FastJetUtilities::fillTracks(track, inputParticles, track.globalIndex());
+    const float pt = skimmedTrack.pt();
+    const float eta = skimmedTrack.eta();
+    const float phi = skimmedTrack.phi();
+    if (pt < ptMin || pt >= ptMax || eta <= etaMin || eta >= etaMax || phi < phiMin || phi > phiMax) {
+      continue;
+    }
+    const double pz = pt * std::sinh(eta);
+    const double energy = std::sqrt(pt * pt + pz * pz + JetFinder::mPion * JetFinder::mPion);
+    inputParticles.emplace_back(pt * std::cos(phi), pt * std::sin(phi), pz, energy);
+    FastJetUtilities::setFastJetUserInfo(inputParticles, skimmedTrack.trackId(), static_cast<int>(JetConstituentStatus::track));
   }
 }
 
@@ -140,15 +185,17 @@ bool analyseCandidateMC(std::vector<fastjet::PseudoJet>& inputParticles, int can
 }
 
 // function that calls the jet finding and fills the relevant tables
-template <typename T, typename U, typename V, typename W>
-void findJets(JetFinder& jetFinder, std::vector<fastjet::PseudoJet>& inputParticles, std::vector<double> jetRadius, T const& collision, U& jetsTable, V& constituentsTable, W& constituentsSubTable, bool DoConstSub, bool doHFJetFinding = false)
+template <typename T, typename U, typename V, typename W, typename X>
+void findJets(JetFinder& jetFinder, std::vector<fastjet::PseudoJet>& inputParticles, std::vector<double> jetRadius, T const& collision, U& jetsTable, V& constituentsTable, W& constituentsSubTable, X& constituentsPackedTable, bool DoConstSub, bool doPackedConstituents, bool doHFJetFinding = false)
 {
   // auto candidatepT = 0.0;
   auto jetRValues = static_cast<std::vector<double>>(jetRadius);
+  std::vector<fastjet::PseudoJet> jets;
+  // the background does not depend on R, it is estimated and subtracted once for all the radii
+  jetFinder.subtractBackground(inputParticles);
   for (auto R : jetRValues) {
     jetFinder.jetR = R;
-    std::vector<fastjet::PseudoJet> jets;
-    fastjet::ClusterSequenceArea clusterSeq(jetFinder.findJets(inputParticles, jets));
+    fastjet::ClusterSequenceArea clusterSeq(jetFinder.clusterJets(inputParticles, jets));
     for (const auto& jet : jets) {
       bool isHFJet = false;
       if (doHFJetFinding) {
@@ -174,6 +221,10 @@ void findJets(JetFinder& jetFinder, std::vector<fastjet::PseudoJet>& inputPartic
           constituentsSubTable(jetsTable.lastIndex(), constituent.pt(), constituent.eta(), constituent.phi(),
                                constituent.E(), constituent.m(), constituent.user_index());
         }
+        if (doPackedConstituents) {
+          constituentsPackedTable(jetsTable.lastIndex(), constituent.pt(), constituent.eta(), constituent.phi(),
+                                  constituent.E(), constituent.m(), constituent.user_index());
+        }
 
         if (constituent.template user_info<FastJetUtilities::fastjet_user_info>().getStatus() == static_cast<int>(JetConstituentStatus::track)) {
           trackconst.push_back(constituent.template user_info<FastJetUtilities::fastjet_user_info>().getIndex());
@@ -29,39 +29,40 @@
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/ASoA.h"
 
+#include "PWGJE/DataModel/JetSkim.h"
+
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::framework::expressions;
 
-namespace o2::aod
-{
-namespace jetskim
-{
-DECLARE_SOA_INDEX_COLUMN(Collision, collision);
-DECLARE_SOA_COLUMN(Pt, pt, float);
-DECLARE_SOA_COLUMN(Eta, eta, float);
-DECLARE_SOA_COLUMN(Phi, phi, float);
-DECLARE_SOA_COLUMN(Energy, energy, float);
-} // namespace jetskim
-DECLARE_SOA_TABLE(JetSkim, "AOD", "JETSKIM1",
-                  jetskim::CollisionId,
-                  jetskim::Pt, jetskim::Eta, jetskim::Phi, jetskim::Energy);
-} // namespace o2::aod
-
 struct JetSkimmingTask1 {
   Produces<o2::aod::JetSkim> skim;
+  Produces<o2::aod::JetSkimCompact> skimCompact;
 
   Filter trackCuts = aod::track::pt > 0.15f;
   float mPionSquared = 0.139 * 0.139;
 
-  void process(aod::Collision const& collision,
-               soa::Filtered<aod::Tracks> const& tracks)
+  void processFull(aod::Collision const& collision,
+                   soa::Filtered<aod::Tracks> const& tracks)
   {
     for (auto& track : tracks) {
       float energy = std::sqrt(track.p() * track.p() + mPionSquared);
       skim(collision, track.pt(), track.eta(), track.phi(), energy);
     }
   }
+  PROCESS_SWITCH(JetSkimmingTask1, processFull, "Skim the tracks at full precision", true);
+
+  // the energy is not stored, it is given by the pion mass hypothesis of the jet finder
+  void processCompact(aod::Collision const& collision,
+                      soa::Filtered<aod::Tracks> const& tracks)
+  {
+    using namespace o2::aod::jetskimcompact;
+    for (auto& track : tracks) {
+      uint8_t type = track.sign() < 0 ? kNegative : 0;
+      skimCompact(collision.globalIndex(), track.globalIndex(), encodePt(track.pt()), encodeEta(track.eta()), encodePhi(track.phi()), type);
+    }
+  }
+  PROCESS_SWITCH(JetSkimmingTask1, processCompact, "Skim the tracks with quantised pt, eta and phi", false);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
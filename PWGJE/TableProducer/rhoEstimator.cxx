@@ -0,0 +1,88 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+// task estimating the background densities of each collision once, for all the jet tasks of a workflow
+//
+// The table BkgRhos is joinable with the collisions. The collisions which do not pass the
+// event selection get zero densities.
+
+#include "PWGJE/TableProducer/jetfinder.h"
+
+using namespace o2;
+using namespace o2::framework;
+using namespace o2::framework::expressions;
+
+#include "Framework/runDataProcessing.h"
+
+struct RhoEstimatorTask {
+  Produces<aod::BkgRhos> rhoTable;
+
+  // event level configurables
+  Configurable<float> vertexZCut{"vertexZCut", 10.0f, "Accepted z-vertex range"};
+  Configurable<std::string> evSel{"evSel", "evSel8", "choose event selection"};
+
+  // track level configurables
+  Configurable<float> trackPtMin{"trackPtMin", 0.15, "minimum track pT"};
+  Configurable<float> trackPtMax{"trackPtMax", 1000.0, "maximum track pT"};
+  Configurable<float> trackEtaMin{"trackEtaMin", -0.9, "minimum track eta"};
+  Configurable<float> trackEtaMax{"trackEtaMax", 0.9, "maximum track eta"};
+  Configurable<float> trackPhiMin{"trackPhiMin", -999, "minimum track phi"};
+  Configurable<float> trackPhiMax{"trackPhiMax", 999, "maximum track phi"};
+  Configurable<std::string> trackSelections{"trackSelections", "globalTracks", "set track selections"};
+
+  // background configurables
+  Configurable<float> bkgJetR{"bkgJetR", 0.2, "jet resolution parameter of the background estimation"};
+  Configurable<float> bkgEtaMin{"bkgEtaMin", -0.9, "minimum rapidity of the background jets"};
+  Configurable<float> bkgEtaMax{"bkgEtaMax", 0.9, "maximum rapidity of the background jets"};
+  Configurable<float> jetGhostArea{"jetGhostArea", 0.005, "jet ghost area"};
+
+  std::string trackSelection;
+
+  JetFinder jetFinder;
+  std::vector<fastjet::PseudoJet> inputParticles;
+
+  void init(InitContext const&)
+  {
+    trackSelection = static_cast<std::string>(trackSelections);
+
+    jetFinder.etaMin = trackEtaMin;
+    jetFinder.etaMax = trackEtaMax;
+    jetFinder.ghostArea = jetGhostArea;
+    jetFinder.jetBkgR = bkgJetR;
+    jetFinder.bkgEtaMin = bkgEtaMin;
+    jetFinder.bkgEtaMax = bkgEtaMax;
+  }
+
+  Filter trackCuts = (aod::track::pt >= trackPtMin && aod::track::pt < trackPtMax && aod::track::eta > trackEtaMin && aod::track::eta < trackEtaMax && aod::track::phi >= trackPhiMin && aod::track::phi <= trackPhiMax);
+
+  void processChargedRho(soa::Join<aod::Collisions, aod::EvSels>::iterator const& collision,
+                         JetTracks const& tracks)
+  {
+    if (std::abs(collision.posZ()) >= vertexZCut || !selectCollision(collision, evSel)) {
+      rhoTable(0., 0.);
+      return;
+    }
+    inputParticles.clear();
+    analyseTracks<JetTracks, JetTracks::iterator>(inputParticles, tracks, trackSelection);
+    double rho = 0.;
+    double rhoM = 0.;
+    jetFinder.estimateRho(inputParticles, rho, rhoM);
+    rhoTable(rho, rhoM);
+  }
+
+  PROCESS_SWITCH(RhoEstimatorTask, processChargedRho, "Background densities from the charged tracks", true);
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{
+    adaptAnalysisTask<RhoEstimatorTask>(cfgc, TaskName{"estimator-rho"})};
+}
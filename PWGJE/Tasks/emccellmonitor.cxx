@@ -9,7 +9,11 @@
 // granted to it by virtue of its status as an Intergovernmental Organization
 // or submit itself to any jurisdiction.
 
+#include <algorithm>
+#include <array>
 #include <climits>
+#include <cmath>
+#include <cstdint>
 #include <cstdlib>
 #include <map>
 #include <memory>
@@ -27,6 +31,9 @@
 #include "EMCALCalib/BadChannelMap.h"
 #include "CommonDataFormat/InteractionRecord.h"
 
+#include <TH1.h>
+#include <TH2.h>
+
 /// \struct CellMonitor
 /// \brief Simple monitoring task for cell related quantities
 /// \author Markus Fasel <markus.fasel@cern.ch>, Oak Ridge National Laoratory
@@ -37,11 +44,17 @@
 /// - Time distribution
 /// - Count rate in col-row space
 /// - Integrated amplitude in col-row space
+/// - Mean and RMS of the time per cell
 /// In addition, in case the task has access to reconstructed clusters,
 /// it plots
 /// - Frequency of a cell contributing to clusters
 /// - Summed cell amplitude fraction in a cluster
 ///
+/// The counts, amplitudes and time moments per cell are accumulated in dense
+/// arrays indexed by the cell abs. ID, and converted into the histograms at the
+/// end of each TF for the cells which fired in it. The amplitude and time
+/// distributions can be disabled for the full-rate monitoring.
+///
 /// The task is a direct port of PWG::EMCAL::AliEmcalCellMonitorTask from
 /// AliPhysics
 struct CellMonitor {
@@ -52,17 +65,46 @@ struct CellMonitor {
   o2::framework::Configurable<double> mMinCellAmplitudeTimeHists{"minCellAmplitudeTimeHists", 0, "Min. cell amplitude used for time distribution"};
   o2::framework::Configurable<std::string> mVetoBCID{"vetoBCID", "", "BC ID to be excluded"};
   o2::framework::Configurable<std::string> mSelectBCID{"selectBCID", "all", "BC ID to be included"};
+  o2::framework::Configurable<bool> mFillCellDistributions{"fillCellDistributions", true, "Fill the amplitude and time distributions of the cells, in addition to their counts, amplitudes and time moments"};
 
   o2::framework::HistogramRegistry mHistManager{"CellMonitorHistograms"};
 
   // Require EMCAL cells (CALO type 1)
   o2::framework::expressions::Filter emccellfilter = o2::aod::calo::caloType == 1;
 
+  using FilteredCells = o2::soa::Filtered<o2::aod::Calos>;
+  o2::framework::Preslice<FilteredCells> cellsPerBC = o2::aod::calo::bcId;
+
+  static constexpr int NSupermodules = 20;
+
   o2::emcal::Geometry* mGeometry = nullptr;
   std::shared_ptr<o2::emcal::BadChannelMap> mBadChannels;
   std::vector<int> mVetoBCIDs;
   std::vector<int> mSelectBCIDs;
 
+  // Accumulators per cell, indexed by the cell abs. ID
+  std::vector<uint64_t> mCellCounts;     ///< Number of cells above the min. amplitude
+  std::vector<double> mCellAmplitudeSum; ///< Summed amplitude of the cells above the min. amplitude
+  std::vector<uint64_t> mCellTimeCounts; ///< Number of cells used for the time moments
+  std::vector<double> mCellTimeSum;      ///< Summed time of the cells used for the time moments
+  std::vector<double> mCellTimeSum2;     ///< Summed squared time of the cells used for the time moments
+  std::vector<bool> mCellUpdated;        ///< Cell updated since the last conversion into histograms
+  std::vector<int> mUpdatedCells;        ///< Cells updated since the last conversion into histograms
+  std::array<uint64_t, NSupermodules> mSupermoduleCounts{};
+  uint64_t mTimeCounts = 0;
+
+  // Position of the cells in their supermodule, indexed by the cell abs. ID
+  std::vector<int> mCellSupermodule;
+  std::vector<int> mCellCol;
+  std::vector<int> mCellRow;
+
+  std::shared_ptr<TH1> mHistCellFrequency;
+  std::shared_ptr<TH1> mHistCellTimeMean;
+  std::shared_ptr<TH1> mHistCellTimeRMS;
+  std::array<std::shared_ptr<TH2>, NSupermodules> mHistCellAmplitudeSM;
+  std::array<std::shared_ptr<TH2>, NSupermodules> mHistCellCountSM;
+  std::array<std::shared_ptr<TH2>, NSupermodules> mHistCellAmplitudeTimeSM;
+
   /// \brief Create output histograms and initialize geometry
   void init(o2::framework::InitContext const&)
   {
@@ -92,7 +134,9 @@ struct CellMonitor {
     mHistManager.add("cellBCAll", "Bunch crossing ID of cell (all cells)", o2HistType::kTH1F, {bcAxis});
     mHistManager.add("cellBCSelected", "Bunch crossing ID of cell (selected cells)", o2HistType::kTH1F, {{bcAxis}});
     mHistManager.add("cellMasking", "Monitoring for masked cells", o2HistType::kTH1F, {cellAxis});
-    mHistManager.add("cellFrequency", "Frequency of cell firing", o2HistType::kTH1F, {cellAxis});
+    mHistCellFrequency = std::get<std::shared_ptr<TH1>>(mHistManager.add("cellFrequency", "Frequency of cell firing", o2HistType::kTH1F, {cellAxis}));
+    mHistCellTimeMean = std::get<std::shared_ptr<TH1>>(mHistManager.add("cellTimeMean", "Mean time per cell; cell abs. ID; mean time (ns)", o2HistType::kTH1F, {cellAxis}));
+    mHistCellTimeRMS = std::get<std::shared_ptr<TH1>>(mHistManager.add("cellTimeRMS", "RMS of the time per cell; cell abs. ID; time RMS (ns)", o2HistType::kTH1F, {cellAxis}));
     mHistManager.add("cellAmplitude", "Energy distribution per cell", o2HistType::kTH2F, {amplitudeAxis, cellAxis});
     mHistManager.add("cellAmplitudeCut", "Energy distribution per cell", o2HistType::kTH2F, {amplitudeAxis, cellAxis});
     mHistManager.add("cellTime", "Time distribution per cell", o2HistType::kTH2F, {timeAxisLarge, cellAxis});
@@ -102,10 +146,10 @@ struct CellMonitor {
     // mCellClusterOccurrency.setObject(new TH1F("cellClusterOccurrency", "Occurrency of a cell in clusters", nCells, -0.5, nCells - 0.5));
     // mCellAmplitudeFractionCluster.setObject(new TH2F("cellAmplitudeFractionCluster", "Summed cell amplitude fraction in a cluster", nCells, -0.5, nCells - 0.5, 200, 0., 200.));
 
-    for (int ism = 0; ism < 20; ++ism) {
-      mHistManager.add(Form("cellAmplitudeSM/cellAmpSM%d", ism), Form("Integrated cell amplitudes for SM %d", ism), o2HistType::kTH2F, {colAxis, rowAxis});
-      mHistManager.add(Form("cellCountSM/cellCountSM%d", ism), Form("Count rate per cell for SM %d; col; row", ism), o2HistType::kTH2F, {colAxis, rowAxis});
-      mHistManager.add(Form("cellAmplitudeTime/cellAmpTimeCorrSM%d", ism), Form("Correlation between cell amplitude and time in Supermodule %d", ism), o2HistType::kTH2F, {timeAxisLarge, amplitudeAxisLarge});
+    for (int ism = 0; ism < NSupermodules; ++ism) {
+      mHistCellAmplitudeSM[ism] = std::get<std::shared_ptr<TH2>>(mHistManager.add(Form("cellAmplitudeSM/cellAmpSM%d", ism), Form("Integrated cell amplitudes for SM %d", ism), o2HistType::kTH2F, {colAxis, rowAxis}));
+      mHistCellCountSM[ism] = std::get<std::shared_ptr<TH2>>(mHistManager.add(Form("cellCountSM/cellCountSM%d", ism), Form("Count rate per cell for SM %d; col; row", ism), o2HistType::kTH2F, {colAxis, rowAxis}));
+      mHistCellAmplitudeTimeSM[ism] = std::get<std::shared_ptr<TH2>>(mHistManager.add(Form("cellAmplitudeTime/cellAmpTimeCorrSM%d", ism), Form("Correlation between cell amplitude and time in Supermodule %d", ism), o2HistType::kTH2F, {timeAxisLarge, amplitudeAxisLarge}));
     }
     for (int ibc = 0; ibc < 4; ++ibc) {
       mHistManager.add(Form("cellTimeBC/cellTimeBC%d", ibc), Form("Time distribution for BC mod %d", ibc), o2HistType::kTH2F, {timeAxisLarge, cellAxis});
@@ -130,12 +174,39 @@ struct CellMonitor {
         mSelectBCIDs.push_back(bcid);
       }
     }
+
+    mCellCounts.assign(nCells, 0);
+    mCellAmplitudeSum.assign(nCells, 0.);
+    mCellTimeCounts.assign(nCells, 0);
+    mCellTimeSum.assign(nCells, 0.);
+    mCellTimeSum2.assign(nCells, 0.);
+    mCellUpdated.assign(nCells, false);
+    mUpdatedCells.reserve(nCells);
+    mCellSupermodule.resize(nCells);
+    mCellCol.resize(nCells);
+    mCellRow.resize(nCells);
+    for (int cellID = 0; cellID < nCells; ++cellID) {
+      auto [supermodule, module, phiInModule, etaInModule] = mGeometry->GetCellIndex(cellID);
+      auto [row, col] = mGeometry->GetCellPhiEtaIndexInSModule(supermodule, module, phiInModule, etaInModule);
+      mCellSupermodule[cellID] = supermodule;
+      mCellCol[cellID] = col;
+      mCellRow[cellID] = row;
+    }
     LOG(info) << "Cell monitor task configured ...";
   }
 
-  /// \brief Process EMCAL cells
-  void process(o2::aod::BC const& bc, o2::soa::Filtered<o2::aod::Calos> const& cells)
-  // void process(o2::aod::BC const& bc, o2::aod::Calos const& cells)
+  /// \brief Process the EMCAL cells of a TF, BC by BC
+  void process(o2::aod::BCs const& bcs, FilteredCells const& cells)
+  {
+    for (const auto& bc : bcs) {
+      processBC(bc, cells.sliceBy(cellsPerBC, bc.globalIndex()));
+    }
+    fillCellHistograms();
+  }
+
+  /// \brief Process the EMCAL cells of a BC
+  template <typename TCells>
+  void processBC(o2::aod::BC const& bc, TCells const& cells)
   {
     LOG(debug) << "Processing next event";
     o2::InteractionRecord eventIR;
@@ -156,111 +227,94 @@ struct CellMonitor {
       mHistManager.fill(HIST("eventsTriggered"), 1);
       mHistManager.fill(HIST("eventBCTriggered"), eventIR.bc);
     }
+    const bool fillDistributions = mFillCellDistributions;
+    const double minCellAmplitude = mMinCellAmplitude;
+    const double minCellAmplitudeTimeHists = mMinCellAmplitudeTimeHists;
+    const int nCells = mCellCounts.size();
+    int nCellsBC = 0;
     for (const auto& cell : cells) {
       // cells expected to be filtered -> only EMCAL cells
-      // cell.cellNumber(),
-      // cell.amplitude(),
-      // cell.time(),
-      if (isCellMasked(cell.cellNumber())) {
+      const int cellID = cell.cellNumber();
+      if (cellID < 0 || cellID >= nCells || isCellMasked(cellID)) {
         continue;
       }
-      o2::InteractionRecord cellIR;
-      cellIR.setFromLong(cell.bc().globalBC());
-      mHistManager.fill(HIST("cellBCAll"), cellIR.bc);
-      mHistManager.fill(HIST("cellBCSelected"), cellIR.bc);
-      mHistManager.fill(HIST("cellAmplitude"), cell.amplitude(), cell.cellNumber());
-      if (cell.amplitude() < mMinCellAmplitude)
+      nCellsBC++;
+      const double amplitude = cell.amplitude();
+      const double celltime = cell.time();
+      if (fillDistributions) {
+        mHistManager.fill(HIST("cellAmplitude"), amplitude, cellID);
+      }
+      if (amplitude < minCellAmplitude) {
         continue;
-      mHistManager.fill(HIST("cellAmplitudeCut"), cell.amplitude(), cell.cellNumber());
-      mHistManager.fill(HIST("cellFrequency"), cell.cellNumber());
-      if (cell.amplitude() >= mMinCellAmplitudeTimeHists) {
-        mHistManager.fill(HIST("cellTime"), cell.time(), cell.cellNumber());
-        if (cell.time() > mMinCellTimeMain && cell.time() < mMaxCellTimeMain) {
-          mHistManager.fill(HIST("cellTimeMain"), cell.time(), cell.cellNumber());
+      }
+      if (!mCellUpdated[cellID]) {
+        mCellUpdated[cellID] = true;
+        mUpdatedCells.push_back(cellID);
+      }
+      mCellCounts[cellID]++;
+      mCellAmplitudeSum[cellID] += amplitude;
+      mSupermoduleCounts[mCellSupermodule[cellID]]++;
+      const bool useTime = amplitude >= minCellAmplitudeTimeHists;
+      if (useTime) {
+        mCellTimeCounts[cellID]++;
+        mCellTimeSum[cellID] += celltime;
+        mCellTimeSum2[cellID] += celltime * celltime;
+        mTimeCounts++;
+      }
+      if (!fillDistributions) {
+        continue;
+      }
+      mHistManager.fill(HIST("cellAmplitudeCut"), amplitude, cellID);
+      if (useTime) {
+        mHistManager.fill(HIST("cellTime"), celltime, cellID);
+        if (celltime > mMinCellTimeMain && celltime < mMaxCellTimeMain) {
+          mHistManager.fill(HIST("cellTimeMain"), celltime, cellID);
         }
-        mHistManager.fill(HIST("celTimeBC"), cellIR.bc, cell.time());
-        fillHistTimeBCMod(bcMod4, cell.cellNumber(), cell.time());
+        mHistManager.fill(HIST("celTimeBC"), eventIR.bc, celltime);
+        fillHistTimeBCMod(bcMod4, cellID, celltime);
       }
-
-      mHistManager.fill(HIST("cellAmplitudeBC"), cellIR.bc, cell.amplitude());
-
-      // Get Cell index in eta-phi of sm
-      auto [supermodule, module, phiInModule, etaInModule] = mGeometry->GetCellIndex(cell.cellNumber());
-      auto [row, col] = mGeometry->GetCellPhiEtaIndexInSModule(supermodule, module, phiInModule, etaInModule);
-
-      fillSupermoduleHistograms(supermodule, col, row, cell.amplitude(), cell.time());
+      mHistManager.fill(HIST("cellAmplitudeBC"), eventIR.bc, amplitude);
+      mHistCellAmplitudeTimeSM[mCellSupermodule[cellID]]->Fill(celltime, amplitude);
+    }
+    if (nCellsBC) {
+      mHistManager.fill(HIST("cellBCAll"), eventIR.bc, nCellsBC);
+      mHistManager.fill(HIST("cellBCSelected"), eventIR.bc, nCellsBC);
     }
     LOG(debug) << "Processing event done";
   }
 
-  void fillSupermoduleHistograms(int supermoduleID, int col, int row, double amplitude, double celltime)
+  /// \brief Convert the accumulators of the cells updated since the last call into the histograms
+  void fillCellHistograms()
   {
-    // workaround to have the histogram names per supermodule
-    // handled as constexpr
-    switch (supermoduleID) {
-      case 0:
-        supermoduleHistHelper<0>(col, row, amplitude, celltime);
-        break;
-      case 1:
-        supermoduleHistHelper<1>(col, row, amplitude, celltime);
-        break;
-      case 2:
-        supermoduleHistHelper<2>(col, row, amplitude, celltime);
-        break;
-      case 3:
-        supermoduleHistHelper<3>(col, row, amplitude, celltime);
-        break;
-      case 4:
-        supermoduleHistHelper<4>(col, row, amplitude, celltime);
-        break;
-      case 5:
-        supermoduleHistHelper<5>(col, row, amplitude, celltime);
-        break;
-      case 6:
-        supermoduleHistHelper<6>(col, row, amplitude, celltime);
-        break;
-      case 7:
-        supermoduleHistHelper<7>(col, row, amplitude, celltime);
-        break;
-      case 8:
-        supermoduleHistHelper<8>(col, row, amplitude, celltime);
-        break;
-      case 9:
-        supermoduleHistHelper<9>(col, row, amplitude, celltime);
-        break;
-      case 10:
-        supermoduleHistHelper<10>(col, row, amplitude, celltime);
-        break;
-      case 11:
-        supermoduleHistHelper<11>(col, row, amplitude, celltime);
-        break;
-      case 12:
-        supermoduleHistHelper<12>(col, row, amplitude, celltime);
-        break;
-      case 13:
-        supermoduleHistHelper<13>(col, row, amplitude, celltime);
-        break;
-      case 14:
-        supermoduleHistHelper<14>(col, row, amplitude, celltime);
-        break;
-      case 15:
-        supermoduleHistHelper<15>(col, row, amplitude, celltime);
-        break;
-      case 16:
-        supermoduleHistHelper<16>(col, row, amplitude, celltime);
-        break;
-      case 17:
-        supermoduleHistHelper<17>(col, row, amplitude, celltime);
-        break;
-      case 18:
-        supermoduleHistHelper<18>(col, row, amplitude, celltime);
-        break;
-      case 19:
-        supermoduleHistHelper<19>(col, row, amplitude, celltime);
-        break;
-      default:
-        break;
+    if (mUpdatedCells.empty()) {
+      return;
+    }
+    for (auto cellID : mUpdatedCells) {
+      mCellUpdated[cellID] = false;
+      auto supermodule = mCellSupermodule[cellID];
+      auto col = mCellCol[cellID];
+      auto row = mCellRow[cellID];
+      mHistCellFrequency->SetBinContent(cellID + 1, mCellCounts[cellID]);
+      mHistCellCountSM[supermodule]->SetBinContent(col + 1, row + 1, mCellCounts[cellID]);
+      mHistCellAmplitudeSM[supermodule]->SetBinContent(col + 1, row + 1, mCellAmplitudeSum[cellID]);
+      if (mCellTimeCounts[cellID]) {
+        double mean = mCellTimeSum[cellID] / mCellTimeCounts[cellID];
+        double variance = mCellTimeSum2[cellID] / mCellTimeCounts[cellID] - mean * mean;
+        mHistCellTimeMean->SetBinContent(cellID + 1, mean);
+        mHistCellTimeRMS->SetBinContent(cellID + 1, std::sqrt(std::max(variance, 0.)));
+      }
+    }
+    mUpdatedCells.clear();
+    // SetBinContent increments the number of entries
+    uint64_t totalCounts = 0;
+    for (int ism = 0; ism < NSupermodules; ++ism) {
+      mHistCellCountSM[ism]->SetEntries(mSupermoduleCounts[ism]);
+      mHistCellAmplitudeSM[ism]->SetEntries(mSupermoduleCounts[ism]);
+      totalCounts += mSupermoduleCounts[ism];
     }
+    mHistCellFrequency->SetEntries(totalCounts);
+    mHistCellTimeMean->SetEntries(mTimeCounts);
+    mHistCellTimeRMS->SetEntries(mTimeCounts);
   }
 
   void fillHistTimeBCMod(int bcMod4, int cellAbsID, double cellTime)
@@ -281,17 +335,6 @@ struct CellMonitor {
     }
   }
 
-  template <int supermoduleID>
-  void supermoduleHistHelper(int col, int row, double amplitude, double celltime)
-  {
-    static constexpr std::string_view cellAmpHistSM[20] = {"cellAmplitudeSM/cellAmpSM0", "cellAmplitudeSM/cellAmpSM1", "cellAmplitudeSM/cellAmpSM2", "cellAmplitudeSM/cellAmpSM3", "cellAmplitudeSM/cellAmpSM4", "cellAmplitudeSM/cellAmpSM5", "cellAmplitudeSM/cellAmpSM6", "cellAmplitudeSM/cellAmpSM7", "cellAmplitudeSM/cellAmpSM8", "cellAmplitudeSM/cellAmpSM9", "cellAmplitudeSM/cellAmpSM10", "cellAmplitudeSM/cellAmpSM11", "cellAmplitudeSM/cellAmpSM12", "cellAmplitudeSM/cellAmpSM13", "cellAmplitudeSM/cellAmpSM14", "cellAmplitudeSM/cellAmpSM15", "cellAmplitudeSM/cellAmpSM16", "cellAmplitudeSM/cellAmpSM17", "cellAmplitudeSM/cellAmpSM18", "cellAmplitudeSM/cellAmpSM19"};
-    static constexpr std::string_view cellCountHistSM[20] = {"cellCountSM/cellCountSM0", "cellCountSM/cellCountSM1", "cellCountSM/cellCountSM2", "cellCountSM/cellCountSM3", "cellCountSM/cellCountSM4", "cellCountSM/cellCountSM5", "cellCountSM/cellCountSM6", "cellCountSM/cellCountSM7", "cellCountSM/cellCountSM8", "cellCountSM/cellCountSM9", "cellCountSM/cellCountSM10", "cellCountSM/cellCountSM11", "cellCountSM/cellCountSM12", "cellCountSM/cellCountSM13", "cellCountSM/cellCountSM14", "cellCountSM/cellCountSM15", "cellCountSM/cellCountSM16", "cellCountSM/cellCountSM17", "cellCountSM/cellCountSM18", "cellCountSM/cellCountSM19"};
-    static constexpr std::string_view cellAmpTimeHist[20] = {"cellAmplitudeTime/cellAmpTimeCorrSM0", "cellAmplitudeTime/cellAmpTimeCorrSM1", "cellAmplitudeTime/cellAmpTimeCorrSM2", "cellAmplitudeTime/cellAmpTimeCorrSM3", "cellAmplitudeTime/cellAmpTimeCorrSM4", "cellAmplitudeTime/cellAmpTimeCorrSM5", "cellAmplitudeTime/cellAmpTimeCorrSM6", "cellAmplitudeTime/cellAmpTimeCorrSM7", "cellAmplitudeTime/cellAmpTimeCorrSM8", "cellAmplitudeTime/cellAmpTimeCorrSM9", "cellAmplitudeTime/cellAmpTimeCorrSM10", "cellAmplitudeTime/cellAmpTimeCorrSM11", "cellAmplitudeTime/cellAmpTimeCorrSM12", "cellAmplitudeTime/cellAmpTimeCorrSM13", "cellAmplitudeTime/cellAmpTimeCorrSM14", "cellAmplitudeTime/cellAmpTimeCorrSM15", "cellAmplitudeTime/cellAmpTimeCorrSM16", "cellAmplitudeTime/cellAmpTimeCorrSM17", "cellAmplitudeTime/cellAmpTimeCorrSM18", "cellAmplitudeTime/cellAmpTimeCorrSM19"};
-    mHistManager.fill(HIST(cellAmpHistSM[supermoduleID]), col, row);
-    mHistManager.fill(HIST(cellCountHistSM[supermoduleID]), col, row, amplitude);
-    mHistManager.fill(HIST(cellAmpTimeHist[supermoduleID]), celltime, amplitude);
-  }
-
   template <int bcMod>
   void bcmodHistHelper(int cellAbsID, double celltime)
   {
@@ -162,66 +162,82 @@ struct JetFinderQATask {
   template <typename T>
   void fillHistograms(T const& jet, float weight = 1.0)
   {
-
-    registry.fill(HIST("h_jet_pt"), jet.pt(), weight);
-    registry.fill(HIST("h_jet_eta"), jet.eta(), weight);
-    registry.fill(HIST("h_jet_phi"), jet.phi(), weight);
-    registry.fill(HIST("h_jet_ntracks"), jet.tracks().size(), weight);
-
-    registry.fill(HIST("h2_jet_pt_jet_eta"), jet.pt(), jet.eta(), weight);
-    registry.fill(HIST("h2_jet_pt_jet_phi"), jet.pt(), jet.phi(), weight);
-    registry.fill(HIST("h2_jet_pt_jet_ntracks"), jet.pt(), jet.tracks().size(), weight);
-
-    registry.fill(HIST("h2_jet_r_jet_pt"), jet.r() / 100.0, jet.pt(), weight);
-    registry.fill(HIST("h2_jet_r_jet_eta"), jet.r() / 100.0, jet.eta(), weight);
-    registry.fill(HIST("h2_jet_r_jet_phi"), jet.r() / 100.0, jet.phi(), weight);
-    registry.fill(HIST("h2_jet_r_jet_ntracks"), jet.r() / 100.0, jet.tracks().size(), weight);
-
-    registry.fill(HIST("h3_jet_radius_jet_pt_jet_eta"), jet.r() / 100.0, jet.pt(), jet.eta(), weight);
-    registry.fill(HIST("h3_jet_radius_jet_pt_jet_phi"), jet.r() / 100.0, jet.pt(), jet.phi(), weight);
-    registry.fill(HIST("h3_jet_radius_jet_eta_jet_phi"), jet.r() / 100.0, jet.eta(), jet.phi(), weight);
+    // the columns are read once per jet instead of once per histogram
+    const float jetPt = jet.pt();
+    const float jetEta = jet.eta();
+    const float jetPhi = jet.phi();
+    const float jetR = jet.r() / 100.0;
+    const int jetNTracks = jet.tracks().size();
+
+    registry.fill(HIST("h_jet_pt"), jetPt, weight);
+    registry.fill(HIST("h_jet_eta"), jetEta, weight);
+    registry.fill(HIST("h_jet_phi"), jetPhi, weight);
+    registry.fill(HIST("h_jet_ntracks"), jetNTracks, weight);
+
+    registry.fill(HIST("h2_jet_pt_jet_eta"), jetPt, jetEta, weight);
+    registry.fill(HIST("h2_jet_pt_jet_phi"), jetPt, jetPhi, weight);
+    registry.fill(HIST("h2_jet_pt_jet_ntracks"), jetPt, jetNTracks, weight);
+
+    registry.fill(HIST("h2_jet_r_jet_pt"), jetR, jetPt, weight);
+    registry.fill(HIST("h2_jet_r_jet_eta"), jetR, jetEta, weight);
+    registry.fill(HIST("h2_jet_r_jet_phi"), jetR, jetPhi, weight);
+    registry.fill(HIST("h2_jet_r_jet_ntracks"), jetR, jetNTracks, weight);
+
+    registry.fill(HIST("h3_jet_radius_jet_pt_jet_eta"), jetR, jetPt, jetEta, weight);
+    registry.fill(HIST("h3_jet_radius_jet_pt_jet_phi"), jetR, jetPt, jetPhi, weight);
+    registry.fill(HIST("h3_jet_radius_jet_eta_jet_phi"), jetR, jetEta, jetPhi, weight);
 
     for (auto& constituent : jet.template tracks_as<JetTracks>()) {
-
-      registry.fill(HIST("h2_jet_pt_track_pt"), jet.pt(), constituent.pt(), weight);
-      registry.fill(HIST("h2_jet_pt_track_eta"), jet.pt(), constituent.eta(), weight);
-      registry.fill(HIST("h2_jet_pt_track_phi"), jet.pt(), constituent.phi(), weight);
-      registry.fill(HIST("h_track_pt"), constituent.pt(), weight);
-      registry.fill(HIST("h_track_eta"), constituent.eta(), weight);
-      registry.fill(HIST("h_track_phi"), constituent.phi(), weight);
+      const float trackPt = constituent.pt();
+      const float trackEta = constituent.eta();
+      const float trackPhi = constituent.phi();
+      registry.fill(HIST("h2_jet_pt_track_pt"), jetPt, trackPt, weight);
+      registry.fill(HIST("h2_jet_pt_track_eta"), jetPt, trackEta, weight);
+      registry.fill(HIST("h2_jet_pt_track_phi"), jetPt, trackPhi, weight);
+      registry.fill(HIST("h_track_pt"), trackPt, weight);
+      registry.fill(HIST("h_track_eta"), trackEta, weight);
+      registry.fill(HIST("h_track_phi"), trackPhi, weight);
     }
   }
 
   template <typename T>
   void fillMCPHistograms(T const& jet, float weight = 1.0)
   {
-
-    registry.fill(HIST("h_jet_pt_part"), jet.pt(), weight);
-    registry.fill(HIST("h_jet_eta_part"), jet.eta(), weight);
-    registry.fill(HIST("h_jet_phi_part"), jet.phi(), weight);
-    registry.fill(HIST("h_jet_ntracks_part"), jet.tracks().size(), weight);
-
-    registry.fill(HIST("h2_jet_pt_part_jet_eta_part"), jet.pt(), jet.eta(), weight);
-    registry.fill(HIST("h2_jet_pt_part_jet_phi_part"), jet.pt(), jet.phi(), weight);
-    registry.fill(HIST("h2_jet_pt_part_jet_ntracks_part"), jet.pt(), jet.tracks().size(), weight);
-
-    registry.fill(HIST("h2_jet_r_part_jet_pt_part"), jet.r() / 100.0, jet.pt(), weight);
-    registry.fill(HIST("h2_jet_r_part_jet_eta_part"), jet.r() / 100.0, jet.eta(), weight);
-    registry.fill(HIST("h2_jet_r_part_jet_phi_part"), jet.r() / 100.0, jet.phi(), weight);
-    registry.fill(HIST("h2_jet_r_part_jet_ntracks_part"), jet.r() / 100.0, jet.tracks().size(), weight);
-
-    registry.fill(HIST("h3_jet_radius_part_jet_pt_part_jet_eta_part"), jet.r() / 100.0, jet.pt(), jet.eta(), weight);
-    registry.fill(HIST("h3_jet_radius_part_jet_pt_part_jet_phi_part"), jet.r() / 100.0, jet.pt(), jet.phi(), weight);
-    registry.fill(HIST("h3_jet_radius_part_jet_eta_part_jet_phi_part"), jet.r() / 100.0, jet.eta(), jet.phi(), weight);
+    // the columns are read once per jet instead of once per histogram
+    const float jetPt = jet.pt();
+    const float jetEta = jet.eta();
+    const float jetPhi = jet.phi();
+    const float jetR = jet.r() / 100.0;
+    const int jetNTracks = jet.tracks().size();
+
+    registry.fill(HIST("h_jet_pt_part"), jetPt, weight);
+    registry.fill(HIST("h_jet_eta_part"), jetEta, weight);
+    registry.fill(HIST("h_jet_phi_part"), jetPhi, weight);
+    registry.fill(HIST("h_jet_ntracks_part"), jetNTracks, weight);
+
+    registry.fill(HIST("h2_jet_pt_part_jet_eta_part"), jetPt, jetEta, weight);
+    registry.fill(HIST("h2_jet_pt_part_jet_phi_part"), jetPt, jetPhi, weight);
+    registry.fill(HIST("h2_jet_pt_part_jet_ntracks_part"), jetPt, jetNTracks, weight);
+
+    registry.fill(HIST("h2_jet_r_part_jet_pt_part"), jetR, jetPt, weight);
+    registry.fill(HIST("h2_jet_r_part_jet_eta_part"), jetR, jetEta, weight);
+    registry.fill(HIST("h2_jet_r_part_jet_phi_part"), jetR, jetPhi, weight);
+    registry.fill(HIST("h2_jet_r_part_jet_ntracks_part"), jetR, jetNTracks, weight);
+
+    registry.fill(HIST("h3_jet_radius_part_jet_pt_part_jet_eta_part"), jetR, jetPt, jetEta, weight);
+    registry.fill(HIST("h3_jet_radius_part_jet_pt_part_jet_phi_part"), jetR, jetPt, jetPhi, weight);
+    registry.fill(HIST("h3_jet_radius_part_jet_eta_part_jet_phi_part"), jetR, jetEta, jetPhi, weight);
 
     for (auto& constituent : jet.template tracks_as<aod::McParticles>()) {
-
-      registry.fill(HIST("h2_jet_pt_part_track_pt_part"), jet.pt(), constituent.pt(), weight);
-      registry.fill(HIST("h2_jet_pt_part_track_eta_part"), jet.pt(), constituent.eta(), weight);
-      registry.fill(HIST("h2_jet_pt_part_track_phi_part"), jet.pt(), constituent.phi(), weight);
-      registry.fill(HIST("h_track_pt_part"), constituent.pt(), weight);
-      registry.fill(HIST("h_track_eta_part"), constituent.eta(), weight);
-      registry.fill(HIST("h_track_phi_part"), constituent.phi(), weight);
+      const float trackPt = constituent.pt();
+      const float trackEta = constituent.eta();
+      const float trackPhi = constituent.phi();
+      registry.fill(HIST("h2_jet_pt_part_track_pt_part"), jetPt, trackPt, weight);
+      registry.fill(HIST("h2_jet_pt_part_track_eta_part"), jetPt, trackEta, weight);
+      registry.fill(HIST("h2_jet_pt_part_track_phi_part"), jetPt, trackPhi, weight);
+      registry.fill(HIST("h_track_pt_part"), trackPt, weight);
+      registry.fill(HIST("h_track_eta_part"), trackEta, weight);
+      registry.fill(HIST("h_track_phi_part"), trackPhi, weight);
     }
   }
 
@@ -246,9 +262,9 @@ struct JetFinderQATask {
   void processDummy(aod::Tracks const& track) {}
   PROCESS_SWITCH(JetFinderQATask, processDummy, "Dummy process function turned on by default", true);
 
-  void processJetsData(soa::Join<aod::ChargedJets, aod::ChargedJetConstituents>::iterator const& jet, JetTracks const& tracks)
+  void processJetsData(soa::Join<aod::ChargedJets, aod::ChargedJetConstituents> const& jets, JetTracks const& tracks)
   {
-    fillHistograms(jet);
+    // the leading track is searched once for all the jets, not once per jet
     auto leadingTrackpT = -1.0;
     for (auto const& track : tracks) {
       if (!selectTrack(track)) {
@@ -257,7 +273,10 @@ struct JetFinderQATask {
       if (track.pt() > leadingTrackpT)
         leadingTrackpT = track.pt();
     }
-    registry.fill(HIST("h2_jet_pt_leadingtrack_pt"), jet.pt(), leadingTrackpT);
+    for (auto const& jet : jets) {
+      fillHistograms(jet);
+      registry.fill(HIST("h2_jet_pt_leadingtrack_pt"), jet.pt(), leadingTrackpT);
+    }
   }
   PROCESS_SWITCH(JetFinderQATask, processJetsData, "jet finder QA data", false);
 
@@ -126,16 +126,19 @@ struct JetFragmentation {
     }
     for (const auto& jet : jets) {
       registry.fill(HIST("jets/detJetPtEtaPhi"), jet.pt(), jet.eta(), jet.phi());
+      // the jet momentum is read once per jet instead of once per constituent
+      const double jetPx = jet.px(), jetPy = jet.py(), jetPz = jet.pz(), jetPt = jet.pt();
+      const double jetP2 = jetPx * jetPx + jetPy * jetPy + jetPz * jetPz;
       for (const auto& track : jet.tracks_as<aod::Tracks>()) {
         double chargeFrag = -1., trackProj = -1.;
-        trackProj = track.px() * jet.px() + track.py() * jet.py() + track.pz() * jet.pz();
-        trackProj /= (jet.p() * jet.p());
-        chargeFrag = track.pt() / jet.pt();
+        trackProj = track.px() * jetPx + track.py() * jetPy + track.pz() * jetPz;
+        trackProj /= jetP2;
+        chargeFrag = track.pt() / jetPt;
 
-        registry.fill(HIST("jets/detJetPtTrackPt"), jet.pt(), track.pt());
+        registry.fill(HIST("jets/detJetPtTrackPt"), jetPt, track.pt());
         registry.fill(HIST("jets/detJetTrackPtEtaPhi"), track.pt(), track.eta(), track.phi());
-        registry.fill(HIST("jets/detJetPtFrag"), jet.pt(), chargeFrag);
-        registry.fill(HIST("jets/detJetPtTrackProj"), jet.pt(), trackProj);
+        registry.fill(HIST("jets/detJetPtFrag"), jetPt, chargeFrag);
+        registry.fill(HIST("jets/detJetPtTrackProj"), jetPt, trackProj);
       }
     }
   }
@@ -153,16 +156,19 @@ struct JetFragmentation {
     }
     for (const auto& jet : jets) {
       registry.fill(HIST("jets/partJetPtEtaPhi"), jet.pt(), jet.eta(), jet.phi());
+      // the jet momentum is read once per jet instead of once per constituent
+      const double jetPx = jet.px(), jetPy = jet.py(), jetPz = jet.pz(), jetPt = jet.pt();
+      const double jetP2 = jetPx * jetPx + jetPy * jetPy + jetPz * jetPz;
       for (const auto& track : jet.tracks_as<aod::McParticles>()) {
         double chargeFrag = -1., trackProj = -1.;
-        trackProj = track.px() * jet.px() + track.py() * jet.py() + track.pz() * jet.pz();
-        trackProj /= (jet.p() * jet.p());
-        chargeFrag = track.pt() / jet.pt();
+        trackProj = track.px() * jetPx + track.py() * jetPy + track.pz() * jetPz;
+        trackProj /= jetP2;
+        chargeFrag = track.pt() / jetPt;
 
-        registry.fill(HIST("jets/partJetPtTrackPt"), jet.pt(), track.pt());
+        registry.fill(HIST("jets/partJetPtTrackPt"), jetPt, track.pt());
         registry.fill(HIST("jets/partJetTrackPtEtaPhi"), track.pt(), track.eta(), track.phi());
-        registry.fill(HIST("jets/partJetPtFrag"), jet.pt(), chargeFrag);
-        registry.fill(HIST("jets/partJetPtTrackProj"), jet.pt(), trackProj);
+        registry.fill(HIST("jets/partJetPtFrag"), jetPt, chargeFrag);
+        registry.fill(HIST("jets/partJetPtTrackProj"), jetPt, trackProj);
       }
     }
   }
@@ -183,16 +189,19 @@ struct JetFragmentation {
     }
     for (const auto& jet : jets) {
       registry.fill(HIST("jets/jetPtEtaPhi"), jet.pt(), jet.eta(), jet.phi());
+      // the jet momentum is read once per jet instead of once per constituent
+      const double jetPx = jet.px(), jetPy = jet.py(), jetPz = jet.pz(), jetPt = jet.pt();
+      const double jetP2 = jetPx * jetPx + jetPy * jetPy + jetPz * jetPz;
       for (const auto& track : jet.tracks_as<aod::Tracks>()) {
         double chargeFrag = -1., trackProj = -1.;
-        trackProj = track.px() * jet.px() + track.py() * jet.py() + track.pz() * jet.pz();
-        trackProj /= (jet.p() * jet.p());
-        chargeFrag = track.pt() / jet.pt();
+        trackProj = track.px() * jetPx + track.py() * jetPy + track.pz() * jetPz;
+        trackProj /= jetP2;
+        chargeFrag = track.pt() / jetPt;
 
-        registry.fill(HIST("jets/jetPtTrackPt"), jet.pt(), track.pt());
+        registry.fill(HIST("jets/jetPtTrackPt"), jetPt, track.pt());
         registry.fill(HIST("jets/jetTrackPtEtaPhi"), track.pt(), track.eta(), track.phi());
-        registry.fill(HIST("jets/jetPtFrag"), jet.pt(), chargeFrag);
-        registry.fill(HIST("jets/jetPtTrackProj"), jet.pt(), trackProj);
+        registry.fill(HIST("jets/jetPtFrag"), jetPt, chargeFrag);
+        registry.fill(HIST("jets/jetPtTrackProj"), jetPt, trackProj);
       }
     }
   }
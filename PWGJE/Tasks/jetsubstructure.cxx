@@ -15,7 +15,8 @@
 //
 
 #include "fastjet/PseudoJet.hh"
-#include "fastjet/ClusterSequenceArea.hh"
+#include "fastjet/ClusterSequence.hh"
+#include "fastjet/JetDefinition.hh"
 
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
@@ -51,11 +52,13 @@ struct JetSubstructureTask {
   Configurable<float> zCut{"zCut", 0.1, "soft drop z cut"};
   Configurable<float> beta{"beta", 0.0, "soft drop beta"};
   Configurable<float> jetR{"jetR", 0.4, "jet resolution parameter"};
+  Configurable<float> jetReclusteringR{"jetReclusteringR", 2.0, "resolution parameter of the C/A reclustering, large enough to merge all the jet constituents"};
   Configurable<bool> doConstSub{"doConstSub", false, "do constituent subtraction"};
 
   std::vector<fastjet::PseudoJet> jetConstituents;
   std::vector<fastjet::PseudoJet> jetReclustered;
-  JetFinder jetReclusterer;
+  // the declustering only needs the C/A clustering history, the definition is set once and no area is computed
+  fastjet::JetDefinition jetDefReclustering;
 
   void init(InitContext const&)
   {
@@ -65,8 +68,7 @@ struct JetSubstructureTask {
                            10, 0.0, 0.5));
     hNsd.setObject(new TH1F("h_jet_nsd", "nsd ;nsd",
                             7, -0.5, 6.5));
-    jetReclusterer.isReclustering = true;
-    jetReclusterer.algorithm = fastjet::JetAlgorithm::cambridge_algorithm;
+    jetDefReclustering = fastjet::JetDefinition(fastjet::JetAlgorithm::cambridge_algorithm, jetReclusteringR, fastjet::E_scheme, fastjet::Best);
   }
 
   //Filter jetCuts = aod::jet::pt > f_jetPtMin; //how does this work?
@@ -74,9 +76,8 @@ struct JetSubstructureTask {
   template <typename T>
   void jetReclustering(T const& jet)
   {
-    jetReclustered.clear();
-    fastjet::ClusterSequenceArea clusterSeq(jetReclusterer.findJets(jetConstituents, jetReclustered));
-    jetReclustered = sorted_by_pt(jetReclustered);
+    fastjet::ClusterSequence clusterSeq(jetConstituents, jetDefReclustering);
+    jetReclustered = sorted_by_pt(clusterSeq.inclusive_jets());
     fastjet::PseudoJet daughterSubJet = jetReclustered[0];
     fastjet::PseudoJet parentSubJet1;
     fastjet::PseudoJet parentSubJet2;
@@ -19,7 +19,9 @@
 #ifndef PWGLF_DATAMODEL_LFRESONANCETABLES_H_
 #define PWGLF_DATAMODEL_LFRESONANCETABLES_H_
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 #include "Common/DataModel/PIDResponse.h"
 #include "Common/Core/RecoDecay.h"
@@ -106,6 +108,45 @@ DECLARE_SOA_COLUMN(DaughterID1, daughterId1, int);   //! Id of the first Daughte
 DECLARE_SOA_COLUMN(DaughterID2, daughterId2, int);   //! Id of the second Daughter particle
 DECLARE_SOA_COLUMN(BachTrkID, bachtrkID, int);       //! Id of the bach track from cascade
 DECLARE_SOA_COLUMN(V0ID, v0ID, int);                 //! Id of the V0 from cascade
+
+// Quantised columns of the compact tracks
+// The n sigma are stored in steps of 0.1 on an int8 (|n sigma| < 12.7), the DCAs in steps of 1 um on an int16 (|DCA| < 3.2 cm)
+// Values outside of the range are stored at its edge, which is enough to keep them out of the selections
+constexpr float binnedNSigmaStep = 0.1f;
+constexpr float binnedDCAStep = 0.0001f; // cm
+
+template <typename T>
+T binValue(float value, float step)
+{
+  constexpr float maxBin = std::numeric_limits<T>::max();
+  float bin = std::round(value / step);
+  return static_cast<T>(std::clamp(bin, -maxBin, maxBin));
+}
+
+DECLARE_SOA_COLUMN(BinnedDcaXY, binnedDcaXY, int16_t);             //! DCA_xy, in steps of binnedDCAStep
+DECLARE_SOA_COLUMN(BinnedDcaZ, binnedDcaZ, int16_t);               //! DCA_z, in steps of binnedDCAStep
+DECLARE_SOA_COLUMN(BinnedTPCNSigmaPi, binnedTpcNSigmaPi, int8_t); //! TPC n sigma of the pion hypothesis, in steps of binnedNSigmaStep
+DECLARE_SOA_COLUMN(BinnedTPCNSigmaKa, binnedTpcNSigmaKa, int8_t); //! TPC n sigma of the kaon hypothesis, in steps of binnedNSigmaStep
+DECLARE_SOA_COLUMN(BinnedTPCNSigmaPr, binnedTpcNSigmaPr, int8_t); //! TPC n sigma of the proton hypothesis, in steps of binnedNSigmaStep
+DECLARE_SOA_COLUMN(BinnedTOFNSigmaPi, binnedTofNSigmaPi, int8_t); //! TOF n sigma of the pion hypothesis, in steps of binnedNSigmaStep
+DECLARE_SOA_COLUMN(BinnedTOFNSigmaKa, binnedTofNSigmaKa, int8_t); //! TOF n sigma of the kaon hypothesis, in steps of binnedNSigmaStep
+DECLARE_SOA_COLUMN(BinnedTOFNSigmaPr, binnedTofNSigmaPr, int8_t); //! TOF n sigma of the proton hypothesis, in steps of binnedNSigmaStep
+DECLARE_SOA_DYNAMIC_COLUMN(DcaXY, dcaXY, //! DCA_xy (cm)
+                           [](int16_t binned) -> float { return binned * binnedDCAStep; });
+DECLARE_SOA_DYNAMIC_COLUMN(DcaZ, dcaZ, //! DCA_z (cm)
+                           [](int16_t binned) -> float { return binned * binnedDCAStep; });
+DECLARE_SOA_DYNAMIC_COLUMN(TPCNSigmaPi, tpcNSigmaPi, //! TPC n sigma of the pion hypothesis
+                           [](int8_t binned) -> float { return binned * binnedNSigmaStep; });
+DECLARE_SOA_DYNAMIC_COLUMN(TPCNSigmaKa, tpcNSigmaKa, //! TPC n sigma of the kaon hypothesis
+                           [](int8_t binned) -> float { return binned * binnedNSigmaStep; });
+DECLARE_SOA_DYNAMIC_COLUMN(TPCNSigmaPr, tpcNSigmaPr, //! TPC n sigma of the proton hypothesis
+                           [](int8_t binned) -> float { return binned * binnedNSigmaStep; });
+DECLARE_SOA_DYNAMIC_COLUMN(TOFNSigmaPi, tofNSigmaPi, //! TOF n sigma of the pion hypothesis
+                           [](int8_t binned) -> float { return binned * binnedNSigmaStep; });
+DECLARE_SOA_DYNAMIC_COLUMN(TOFNSigmaKa, tofNSigmaKa, //! TOF n sigma of the kaon hypothesis
+                           [](int8_t binned) -> float { return binned * binnedNSigmaStep; });
+DECLARE_SOA_DYNAMIC_COLUMN(TOFNSigmaPr, tofNSigmaPr, //! TOF n sigma of the proton hypothesis
+                           [](int8_t binned) -> float { return binned * binnedNSigmaStep; });
 } // namespace resodaughter
 DECLARE_SOA_TABLE(ResoTracks, "AOD", "RESOTRACKS",
                   o2::soa::Index<>,
@@ -132,6 +173,41 @@ DECLARE_SOA_TABLE(ResoTracks, "AOD", "RESOTRACKS",
                   o2::aod::pidtof::TOFNSigmaPr);
 using ResoTrack = ResoTracks::iterator;
 
+// Same content as ResoTracks with the DCAs and the n sigma quantised, about half of the size
+// The dynamic columns give back the values with the accessors of ResoTracks
+DECLARE_SOA_TABLE(ResoTracksCompact, "AOD", "RESOTRACKSCMP",
+                  o2::soa::Index<>,
+                  resodaughter::ResoCollisionId,
+                  resodaughter::Pt,
+                  resodaughter::Px,
+                  resodaughter::Py,
+                  resodaughter::Pz,
+                  resodaughter::Eta,
+                  resodaughter::Phi,
+                  resodaughter::Sign,
+                  resodaughter::TPCNClsCrossedRows,
+                  resodaughter::BinnedDcaXY,
+                  resodaughter::BinnedDcaZ,
+                  o2::aod::track::X,
+                  o2::aod::track::Alpha,
+                  resodaughter::TPCPIDselectionFlag,
+                  resodaughter::TOFPIDselectionFlag,
+                  resodaughter::BinnedTPCNSigmaPi,
+                  resodaughter::BinnedTPCNSigmaKa,
+                  resodaughter::BinnedTPCNSigmaPr,
+                  resodaughter::BinnedTOFNSigmaPi,
+                  resodaughter::BinnedTOFNSigmaKa,
+                  resodaughter::BinnedTOFNSigmaPr,
+                  resodaughter::DcaXY<resodaughter::BinnedDcaXY>,
+                  resodaughter::DcaZ<resodaughter::BinnedDcaZ>,
+                  resodaughter::TPCNSigmaPi<resodaughter::BinnedTPCNSigmaPi>,
+                  resodaughter::TPCNSigmaKa<resodaughter::BinnedTPCNSigmaKa>,
+                  resodaughter::TPCNSigmaPr<resodaughter::BinnedTPCNSigmaPr>,
+                  resodaughter::TOFNSigmaPi<resodaughter::BinnedTOFNSigmaPi>,
+                  resodaughter::TOFNSigmaKa<resodaughter::BinnedTOFNSigmaKa>,
+                  resodaughter::TOFNSigmaPr<resodaughter::BinnedTOFNSigmaPr>);
+using ResoTrackCompact = ResoTracksCompact::iterator;
+
 DECLARE_SOA_TABLE(ResoV0s, "AOD", "RESOV0S",
                   o2::soa::Index<>,
                   resodaughter::ResoCollisionId,
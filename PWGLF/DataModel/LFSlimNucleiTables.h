@@ -71,6 +71,28 @@ DECLARE_SOA_TABLE(NucleiTableMC, "AOD", "NUCLEITABLEMC",
                   NucleiTableNS::gPhi,
                   NucleiTableNS::PDGcode)
 
+namespace NucleiCandidateNS
+{
+DECLARE_SOA_INDEX_COLUMN(Collision, collision);      //! Collision of the candidate
+DECLARE_SOA_INDEX_COLUMN(Track, track);              //! Track of the candidate
+DECLARE_SOA_COLUMN(TPCnSigmaDe, tpcNsigmaDe, float); //! TPC n-sigma of the deuteron hypothesis
+DECLARE_SOA_COLUMN(TPCnSigmaTr, tpcNsigmaTr, float); //! TPC n-sigma of the triton hypothesis
+DECLARE_SOA_COLUMN(TPCnSigmaHe, tpcNsigmaHe, float); //! TPC n-sigma of the He3 hypothesis
+DECLARE_SOA_COLUMN(TPCnSigmaAl, tpcNsigmaAl, float); //! TPC n-sigma of the alpha hypothesis
+} // namespace NucleiCandidateNS
+
+/// Tracks preselected as light nuclei candidates by the nuclei-preselection task, with their TPC n-sigma,
+/// shared by the nuclei trigger and the nuclei spectra tasks so that all the tracks are scanned only once
+DECLARE_SOA_TABLE(NucleiCandidates, "AOD", "NUCLEICAND", //!
+                  o2::soa::Index<>,
+                  NucleiCandidateNS::CollisionId,
+                  NucleiCandidateNS::TrackId,
+                  NucleiCandidateNS::TPCnSigmaDe,
+                  NucleiCandidateNS::TPCnSigmaTr,
+                  NucleiCandidateNS::TPCnSigmaHe,
+                  NucleiCandidateNS::TPCnSigmaAl)
+using NucleiCandidate = NucleiCandidates::iterator;
+
 } // namespace o2::aod
 
 #endif // PWGLF_DATAMODEL_LFSLIMNUCLEITABLES_H_
@@ -15,6 +15,8 @@
 ///
 /// \author Bong-Hwi Lim <bong-hwi.lim@cern.ch>
 
+#include <array>
+
 #include "Common/DataModel/PIDResponse.h"
 #include "Common/Core/TrackSelection.h"
 #include "Common/DataModel/Centrality.h"
@@ -31,6 +33,7 @@
 #include "PWGLF/DataModel/LFStrangenessTables.h"
 #include "PWGLF/DataModel/LFResonanceTables.h"
 #include "PWGLF/Utils/collisionCuts.h"
+#include "PWGLF/Utils/mcParticleRelations.h"
 #include "ReconstructionDataFormats/Track.h"
 #include "DataFormatsParameters/GRPObject.h"
 #include "DataFormatsParameters/GRPMagField.h"
@@ -50,6 +53,7 @@ struct reso2initializer {
 
   Produces<aod::ResoCollisions> resoCollisions;
   Produces<aod::ResoTracks> reso2trks;
+  Produces<aod::ResoTracksCompact> reso2trkscompact;
   Produces<aod::ResoV0s> reso2v0s;
   Produces<aod::ResoCascades> reso2cascades;
   Produces<aod::ResoMCTracks> reso2mctracks;
@@ -81,6 +85,7 @@ struct reso2initializer {
 
   // Pre-selection cuts
   Configurable<float> cfgCutEta{"cfgCutEta", 0.8f, "Eta range for tracks"};
+  Configurable<bool> cfgCompactTracks{"cfgCompactTracks", false, "Store the tracks in ResoTracksCompact, with quantised DCAs and n sigma, instead of ResoTracks"};
   Configurable<float> pidnSigmaPreSelectionCut{"pidnSigmaPreSelectionCut", 5.0f, "TPC and TOF PID cut (loose, improve performance)"};
   Configurable<int> mincrossedrows{"mincrossedrows", 70, "min crossed rows"};
 
@@ -309,6 +314,36 @@ struct reso2initializer {
         if (std::abs(track.tofNSigmaPr()) < pidnSigmaPreSelectionCut)
           tofPIDselections |= aod::resodaughter::PDGtype::kProton;
       }
+      if (cfgCompactTracks) {
+        using aod::resodaughter::binValue;
+        using aod::resodaughter::binnedDCAStep;
+        using aod::resodaughter::binnedNSigmaStep;
+        reso2trkscompact(resoCollisions.lastIndex(),
+                         track.pt(),
+                         track.px(),
+                         track.py(),
+                         track.pz(),
+                         track.eta(),
+                         track.phi(),
+                         track.sign(),
+                         (uint8_t)track.tpcNClsCrossedRows(),
+                         binValue<int16_t>(track.dcaXY(), binnedDCAStep),
+                         binValue<int16_t>(track.dcaZ(), binnedDCAStep),
+                         track.x(),
+                         track.alpha(),
+                         tpcPIDselections,
+                         tofPIDselections,
+                         binValue<int8_t>(track.tpcNSigmaPi(), binnedNSigmaStep),
+                         binValue<int8_t>(track.tpcNSigmaKa(), binnedNSigmaStep),
+                         binValue<int8_t>(track.tpcNSigmaPr(), binnedNSigmaStep),
+                         binValue<int8_t>(track.tofNSigmaPi(), binnedNSigmaStep),
+                         binValue<int8_t>(track.tofNSigmaKa(), binnedNSigmaStep),
+                         binValue<int8_t>(track.tofNSigmaPr(), binnedNSigmaStep));
+        if constexpr (isMC) {
+          fillMCTrack(track);
+        }
+        continue;
+      }
       reso2trks(resoCollisions.lastIndex(),
                 track.pt(),
                 track.px(),
@@ -394,38 +429,13 @@ struct reso2initializer {
   template <typename TrackType>
   void fillMCTrack(TrackType const& track)
   {
-    // ------ Temporal lambda function to prevent error in build
-    auto getMothersIndeces = [&](auto const& theMcParticle) {
-      std::vector<int> lMothersIndeces{};
-      for (auto& lMother : theMcParticle.template mothers_as<aod::McParticles>()) {
-        LOGF(debug, "   mother index lMother: %d", lMother.globalIndex());
-        lMothersIndeces.push_back(lMother.globalIndex());
-      }
-      return lMothersIndeces;
-    };
-    auto getMothersPDGCodes = [&](auto const& theMcParticle) {
-      std::vector<int> lMothersPDGs{};
-      for (auto& lMother : theMcParticle.template mothers_as<aod::McParticles>()) {
-        LOGF(debug, "   mother pdgcode lMother: %d", lMother.pdgCode());
-        lMothersPDGs.push_back(lMother.pdgCode());
-      }
-      return lMothersPDGs;
-    };
-    // ------
-    std::vector<int> mothers = {-1, -1};
-    std::vector<int> motherPDGs = {-1, -1};
+    std::array<int, 2> mothers = {-1, -1};
+    std::array<int, 2> motherPDGs = {-1, -1};
     if (track.has_mcParticle()) {
       //
       // Get the MC particle
       const auto& particle = track.mcParticle();
-      if (particle.has_mothers()) {
-        mothers = getMothersIndeces(particle);
-        motherPDGs = getMothersPDGCodes(particle);
-      }
-      while (mothers.size() > 2) {
-        mothers.pop_back();
-        motherPDGs.pop_back();
-      }
+      o2::pwglf::getMothers(particle, mothers, motherPDGs);
       reso2mctracks(particle.pdgCode(),
                     mothers[0],
                     motherPDGs[0],
@@ -444,67 +454,14 @@ struct reso2initializer {
   template <typename V0Type>
   void fillMCV0(V0Type const& v0)
   {
-    // ------ Temporal lambda function to prevent error in build
-    auto getMothersIndeces = [&](auto const& theMcParticle) {
-      std::vector<int> lMothersIndeces{};
-      for (auto& lMother : theMcParticle.template mothers_as<aod::McParticles>()) {
-        LOGF(debug, "   mother index lMother: %d", lMother.globalIndex());
-        lMothersIndeces.push_back(lMother.globalIndex());
-      }
-      return lMothersIndeces;
-    };
-    auto getMothersPDGCodes = [&](auto const& theMcParticle) {
-      std::vector<int> lMothersPDGs{};
-      for (auto& lMother : theMcParticle.template mothers_as<aod::McParticles>()) {
-        LOGF(debug, "   mother pdgcode lMother: %d", lMother.pdgCode());
-        lMothersPDGs.push_back(lMother.pdgCode());
-      }
-      return lMothersPDGs;
-    };
-    auto getDaughtersIndeces = [&](auto const& theMcParticle) {
-      std::vector<int> lDaughtersIndeces{};
-      for (auto& lDaughter : theMcParticle.template daughters_as<aod::McParticles>()) {
-        LOGF(debug, "   daughter index lDaughter: %d", lDaughter.globalIndex());
-        if (lDaughter.globalIndex() != 0) {
-          lDaughtersIndeces.push_back(lDaughter.globalIndex());
-        }
-      }
-      return lDaughtersIndeces;
-    };
-    auto getDaughtersPDGCodes = [&](auto const& theMcParticle) {
-      std::vector<int> lDaughtersPDGs{};
-      for (auto& lDaughter : theMcParticle.template daughters_as<aod::McParticles>()) {
-        LOGF(debug, "   daughter pdgcode lDaughter: %d", lDaughter.pdgCode());
-        if (lDaughter.globalIndex() != 0) {
-          lDaughtersPDGs.push_back(lDaughter.pdgCode());
-        }
-      }
-      return lDaughtersPDGs;
-    };
-    // ------
-    std::vector<int> mothers = {-1, -1};
-    std::vector<int> motherPDGs = {-1, -1};
-    std::vector<int> daughters = {-1, -1};
-    std::vector<int> daughterPDGs = {-1, -1};
+    std::array<int, 2> mothers = {-1, -1};
+    std::array<int, 2> motherPDGs = {-1, -1};
+    std::array<int, 2> daughters = {-1, -1};
+    std::array<int, 2> daughterPDGs = {-1, -1};
     if (v0.has_mcParticle()) {
       auto v0mc = v0.mcParticle();
-      if (v0mc.has_mothers()) {
-        mothers = getMothersIndeces(v0mc);
-        motherPDGs = getMothersPDGCodes(v0mc);
-      }
-      while (mothers.size() > 2) {
-        mothers.pop_back();
-        motherPDGs.pop_back();
-      }
-      if (v0mc.has_daughters()) {
-        daughters = getDaughtersIndeces(v0mc);
-        daughterPDGs = getDaughtersPDGCodes(v0mc);
-      }
-      while (daughters.size() > 2) {
-        LOGF(info, "daughters.size() is larger than 2");
-        daughters.pop_back();
-        daughterPDGs.pop_back();
-      }
+      o2::pwglf::getMothers(v0mc, mothers, motherPDGs);
+      o2::pwglf::getDaughters(v0mc, daughters, daughterPDGs);
       reso2mcv0s(v0mc.pdgCode(),
                  mothers[0],
                  motherPDGs[0],
@@ -530,67 +487,14 @@ struct reso2initializer {
   template <typename CascType>
   void fillMCCascade(CascType const& casc)
   {
-    // ------ Temporal lambda function to prevent error in build
-    auto getMothersIndeces = [&](auto const& theMcParticle) {
-      std::vector<int> lMothersIndeces{};
-      for (auto& lMother : theMcParticle.template mothers_as<aod::McParticles>()) {
-        LOGF(debug, "   mother index lMother: %d", lMother.globalIndex());
-        lMothersIndeces.push_back(lMother.globalIndex());
-      }
-      return lMothersIndeces;
-    };
-    auto getMothersPDGCodes = [&](auto const& theMcParticle) {
-      std::vector<int> lMothersPDGs{};
-      for (auto& lMother : theMcParticle.template mothers_as<aod::McParticles>()) {
-        LOGF(debug, "   mother pdgcode lMother: %d", lMother.pdgCode());
-        lMothersPDGs.push_back(lMother.pdgCode());
-      }
-      return lMothersPDGs;
-    };
-    auto getDaughtersIndeces = [&](auto const& theMcParticle) {
-      std::vector<int> lDaughtersIndeces{};
-      for (auto& lDaughter : theMcParticle.template daughters_as<aod::McParticles>()) {
-        LOGF(debug, "   daughter index lDaughter: %d", lDaughter.globalIndex());
-        if (lDaughter.globalIndex() != 0) {
-          lDaughtersIndeces.push_back(lDaughter.globalIndex());
-        }
-      }
-      return lDaughtersIndeces;
-    };
-    auto getDaughtersPDGCodes = [&](auto const& theMcParticle) {
-      std::vector<int> lDaughtersPDGs{};
-      for (auto& lDaughter : theMcParticle.template daughters_as<aod::McParticles>()) {
-        LOGF(debug, "   daughter pdgcode lDaughter: %d", lDaughter.pdgCode());
-        if (lDaughter.globalIndex() != 0) {
-          lDaughtersPDGs.push_back(lDaughter.pdgCode());
-        }
-      }
-      return lDaughtersPDGs;
-    };
-    // ------
-    std::vector<int> mothers = {-1, -1};
-    std::vector<int> motherPDGs = {-1, -1};
-    std::vector<int> daughters = {-1, -1};
-    std::vector<int> daughterPDGs = {-1, -1};
+    std::array<int, 2> mothers = {-1, -1};
+    std::array<int, 2> motherPDGs = {-1, -1};
+    std::array<int, 2> daughters = {-1, -1};
+    std::array<int, 2> daughterPDGs = {-1, -1};
     if (casc.has_mcParticle()) {
       auto cascmc = casc.mcParticle();
-      if (cascmc.has_mothers()) {
-        mothers = getMothersIndeces(cascmc);
-        motherPDGs = getMothersPDGCodes(cascmc);
-      }
-      while (mothers.size() > 2) {
-        mothers.pop_back();
-        motherPDGs.pop_back();
-      }
-      if (cascmc.has_daughters()) {
-        daughters = getDaughtersIndeces(cascmc);
-        daughterPDGs = getDaughtersPDGCodes(cascmc);
-      }
-      while (daughters.size() > 2) {
-        LOGF(info, "daughters.size() is larger than 2");
-        daughters.pop_back();
-        daughterPDGs.pop_back();
-      }
+      o2::pwglf::getMothers(cascmc, mothers, motherPDGs);
+      o2::pwglf::getDaughters(cascmc, daughters, daughterPDGs);
       reso2mccascades(cascmc.pdgCode(),
                       mothers[0],
                       motherPDGs[0],
@@ -617,7 +521,7 @@ struct reso2initializer {
   void fillMCParticles(SelectedMCPartType const& mcParts, TotalMCParts const& mcParticles)
   {
     for (auto& mcPart : mcParts) {
-      std::vector<int> daughterPDGs;
+      std::array<int, 2> daughterPDGs;
       if (mcPart.has_daughters()) {
         auto daughter01 = mcParticles.rawIteratorAt(mcPart.daughtersIds()[0] - mcParticles.offset());
         auto daughter02 = mcParticles.rawIteratorAt(mcPart.daughtersIds()[1] - mcParticles.offset());
@@ -638,7 +542,6 @@ struct reso2initializer {
                      mcPart.eta(),
                      mcPart.phi(),
                      mcPart.y());
-      daughterPDGs.clear();
     }
   }
 
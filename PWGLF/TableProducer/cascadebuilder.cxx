@@ -41,6 +41,7 @@
 #include <cstdlib>
 #include <map>
 #include <iterator>
+#include <type_traits>
 #include <utility>
 
 #include "Framework/runDataProcessing.h"
@@ -50,10 +51,12 @@
 #include "Framework/ASoAHelpers.h"
 #include "DCAFitter/DCAFitterN.h"
 #include "ReconstructionDataFormats/Track.h"
+#include "Common/Core/PropagatorServices.h"
 #include "Common/Core/RecoDecay.h"
 #include "Common/Core/trackUtilities.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
 #include "PWGLF/DataModel/LFParticleIdentification.h"
+#include "PWGLF/Utils/trackDCAtoPV.h"
 #include "Common/Core/TrackSelection.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "DetectorsBase/Propagator.h"
@@ -74,6 +77,7 @@ using std::array;
 // use parameters + cov mat non-propagated, aux info + (extension propagated)
 using FullTracksExt = soa::Join<aod::Tracks, aod::TracksExtra, aod::TracksCov>;
 using FullTracksExtIU = soa::Join<aod::TracksIU, aod::TracksExtra, aod::TracksCovIU>;
+using FullTracksExtIUWithDCA = soa::Join<aod::TracksIU, aod::TracksExtra, aod::TracksCovIU, aod::TracksDCA>;
 using TracksWithExtra = soa::Join<aod::Tracks, aod::TracksExtra>; // generally always need DCA, will have Tracks too
 
 // For dE/dx association in pre-selection
@@ -109,6 +113,8 @@ struct cascadeBuilder {
   Configurable<float> casccospa{"casccospa", 0.95, "casccospa"};
   Configurable<float> dcacascdau{"dcacascdau", 1.0, "DCA cascade Daughters"};
   Configurable<float> lambdaMassWindow{"lambdaMassWindow", .01, "Distance from Lambda mass"};
+  Configurable<float> preselV0Radius{"preselV0Radius", 0.0, "min radius of the V0, checked before the cascade fit"};
+  Configurable<float> preselV0CosPA{"preselV0CosPA", -2.0, "min cosPA of the V0 to the PV, checked before the cascade fit (-2: no check)"};
   Configurable<float> dcaXYCascToPV{"dcaXYCascToPV", 1e+6, "dcaXYCascToPV"};
   Configurable<float> dcaZCascToPV{"dcaZCascToPV", 1e+6, "dcaZCascToPV"};
 
@@ -166,6 +172,8 @@ struct cascadeBuilder {
   o2::vertexing::DCAFitterN<2> fitter;
   enum cascstep { kCascAll = 0,
                   kCascLambdaMass,
+                  kCascV0Radius,
+                  kCascV0CosPA,
                   kBachTPCrefit,
                   kBachDCAxy,
                   kCascDCADau,
@@ -375,11 +383,14 @@ struct cascadeBuilder {
     }
     if (useMatCorrType == 2) {
       LOGF(info, "LUT correction requested, loading LUT");
-      lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(lutPath));
+      lut = o2::common::propagator::getMatLut(ccdb, lutPath);
     }
 
-    if (doprocessRun2 == false && doprocessRun3 == false && doprocessRun3withStrangenessTracking == false) {
-      LOGF(fatal, "Neither processRun2 nor processRun3 nor processRun3withstrangenesstracking enabled. Please choose one!");
+    if (doprocessRun2 == false && doprocessRun3 == false && doprocessRun3withStrangenessTracking == false && doprocessRun3WithTracksDCA == false) {
+      LOGF(fatal, "Neither processRun2 nor processRun3 nor processRun3withstrangenesstracking nor processRun3WithTracksDCA enabled. Please choose one!");
+    }
+    if (doprocessRun3WithTracksDCA == true && (doprocessRun2 == true || doprocessRun3 == true || doprocessRun3withStrangenessTracking == true)) {
+      LOGF(fatal, "Cannot enable processRun3WithTracksDCA with another processRun. Please choose one.");
     }
     if (doprocessRun2 == true && doprocessRun3 == true) {
       LOGF(fatal, "Cannot enable processRun2 and processRun3 at the same time. Please choose one.");
@@ -493,6 +504,9 @@ struct cascadeBuilder {
     if (doprocessRun3 == true) {
       LOGF(info, "Run 3 processing enabled. Will subscribe to TracksIU table.");
     };
+    if (doprocessRun3WithTracksDCA == true) {
+      LOGF(info, "Run 3 processing enabled. Will subscribe to TracksIU and TracksDCA tables.");
+    };
     if (createCascCovMats > 0) {
       LOGF(info, "-> Will produce cascade cov mat table");
     };
@@ -643,16 +657,6 @@ struct cascadeBuilder {
     auto negTrack = v0.template negTrack_as<TTrackTo>();
     auto const& collision = cascade.collision();
 
-    if (calculateBachBaryonVars) {
-      // Calculates properties of the V0 comprised of bachelor and baryon in the cascade
-      // baryon: distinguished via bachelor charge
-      if (bachTrack.sign() < 0) {
-        processBachBaryonVariables(collision, bachTrack, posTrack);
-      } else {
-        processBachBaryonVariables(collision, bachTrack, negTrack);
-      }
-    }
-
     // value 0.5: any considered cascade
     statisticsRegistry.cascstats[kCascAll]++;
 
@@ -666,6 +670,14 @@ struct cascadeBuilder {
       return false;
     statisticsRegistry.cascstats[kCascLambdaMass]++;
 
+    // Preselection on the stored V0 topology, to reject the cascades before propagating and fitting
+    if (v0.v0radius() < preselV0Radius)
+      return false;
+    statisticsRegistry.cascstats[kCascV0Radius]++;
+    if (preselV0CosPA > -1.f && v0.v0cosPA(collision.posX(), collision.posY(), collision.posZ()) < preselV0CosPA)
+      return false;
+    statisticsRegistry.cascstats[kCascV0CosPA]++;
+
     if (tpcrefit) {
       if (!(bachTrack.trackType() & o2::aod::track::TPCrefit)) {
         return false;
@@ -675,16 +687,22 @@ struct cascadeBuilder {
 
     // bachelor DCA track to PV
     // Calculate DCA with respect to the collision associated to the V0, not individual tracks
-    gpu::gpustd::array<float, 2> dcaInfo;
-
-    auto bachTrackPar = getTrackPar(bachTrack);
-    o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, bachTrackPar, 2.f, fitter.getMatCorrType(), &dcaInfo);
-    cascadecandidate.bachDCAxy = dcaInfo[0];
+    cascadecandidate.bachDCAxy = o2::pwglf::getDCAxyToPV<std::is_same_v<TTrackTo, FullTracksExtIUWithDCA>>(bachTrack, cascade.collisionId(), {collision.posX(), collision.posY(), collision.posZ()}, fitter.getMatCorrType());
 
     if (TMath::Abs(cascadecandidate.bachDCAxy) < dcabachtopv)
       return false;
     statisticsRegistry.cascstats[kBachDCAxy]++;
 
+    if (calculateBachBaryonVars) {
+      // Calculates properties of the V0 comprised of bachelor and baryon in the cascade
+      // baryon: distinguished via bachelor charge
+      if (bachTrack.sign() < 0) {
+        processBachBaryonVariables(collision, bachTrack, posTrack);
+      } else {
+        processBachBaryonVariables(collision, bachTrack, negTrack);
+      }
+    }
+
     // Do actual minimization
     lBachelorTrack = getTrackParCov(bachTrack);
 
@@ -750,6 +768,7 @@ struct cascadeBuilder {
     lCascadeTrack = fitter.createParentTrackPar();
     lCascadeTrack.setAbsCharge(cascadecandidate.charge); // to be sure
     lCascadeTrack.setPID(o2::track::PID::XiMinus);       // FIXME: not OK for omegas
+    gpu::gpustd::array<float, 2> dcaInfo;
     dcaInfo[0] = 999;
     dcaInfo[1] = 999;
 
@@ -1113,6 +1132,20 @@ struct cascadeBuilder {
   }
   PROCESS_SWITCH(cascadeBuilder, processRun3, "Produce Run 3 cascade tables", false);
 
+  void processRun3WithTracksDCA(aod::Collisions const& collisions, aod::V0sLinked const&, V0full const&, soa::Filtered<TaggedCascades> const& cascades, FullTracksExtIUWithDCA const&, aod::BCsWithTimestamps const&)
+  {
+    for (const auto& collision : collisions) {
+      // Fire up CCDB
+      auto bc = collision.bc_as<aod::BCsWithTimestamps>();
+      initCCDB(bc);
+      // Do analysis with collision-grouped V0s, retain full collision information
+      const uint64_t collIdx = collision.globalIndex();
+      auto CascadeTable_thisCollision = cascades.sliceBy(perCollision, collIdx);
+      buildStrangenessTables<FullTracksExtIUWithDCA>(CascadeTable_thisCollision);
+    }
+  }
+  PROCESS_SWITCH(cascadeBuilder, processRun3WithTracksDCA, "Produce Run 3 cascade tables, with the bachelor DCA of the track propagation", false);
+
   void processRun3withStrangenessTracking(aod::Collisions const& collisions, aod::V0sLinked const&, V0full const&, soa::Filtered<TaggedCascades> const& cascades, FullTracksExtIU const&, aod::BCsWithTimestamps const&, aod::TrackedCascades const& trackedCascades)
   {
     for (const auto& collision : collisions) {
@@ -13,6 +13,8 @@
 // ==============================================================================
 
 #include <array>
+#include <type_traits>
+#include <vector>
 
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
@@ -33,12 +35,14 @@
 #include "DCAFitter/DCAFitterN.h"
 
 #include "PWGLF/DataModel/LFHypernucleiTables.h"
+#include "PWGLF/Utils/trackDCAtoPV.h"
 
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::framework::expressions;
 using std::array;
 using TracksFull = soa::Join<aod::TracksIU, aod::TracksExtra, aod::TracksCovIU>;
+using TracksFullWithDCA = soa::Join<aod::TracksIU, aod::TracksExtra, aod::TracksCovIU, aod::TracksDCA>;
 
 namespace
 {
@@ -360,13 +364,14 @@ struct hyperRecoTask {
       }
 
       // if survived all selections, propagate decay daughters to PV
-      gpu::gpustd::array<float, 2> dcaInfo;
+      constexpr bool useTracksDCA = std::is_same_v<T, TracksFullWithDCA>;
+      std::array<float, 3> primaryVertex{collision.posX(), collision.posY(), collision.posZ()};
 
-      o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, posTrackCov, 2.f, fitter.getMatCorrType(), &dcaInfo);
-      hypCand.isMatter ? hypCand.he3DCAXY = dcaInfo[0] : hypCand.piDCAXY = dcaInfo[0];
+      float posDCAXY = o2::pwglf::getDCAxyToPV<useTracksDCA>(posTrack, collision.globalIndex(), primaryVertex, fitter.getMatCorrType());
+      hypCand.isMatter ? hypCand.he3DCAXY = posDCAXY : hypCand.piDCAXY = posDCAXY;
 
-      o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, negTrackCov, 2.f, fitter.getMatCorrType(), &dcaInfo);
-      hypCand.isMatter ? hypCand.piDCAXY = dcaInfo[0] : hypCand.he3DCAXY = dcaInfo[0];
+      float negDCAXY = o2::pwglf::getDCAxyToPV<useTracksDCA>(negTrack, collision.globalIndex(), primaryVertex, fitter.getMatCorrType());
+      hypCand.isMatter ? hypCand.piDCAXY = negDCAXY : hypCand.he3DCAXY = negDCAXY;
 
       // finally, push back the candidate
       hypCand.isReco = true;
@@ -384,7 +389,8 @@ struct hyperRecoTask {
 
   void fillMCinfo(aod::McTrackLabels const& trackLabels, aod::McParticles const& particlesMC)
   {
-    std::vector<unsigned int> filledMothers;
+    // flags of the generated hypertritons already matched to a candidate, by MC particle index
+    std::vector<bool> filledMothers(particlesMC.size(), false);
     for (auto& hypCand : hyperCandidates) {
       auto mcLabPos = trackLabels.rawIteratorAt(hypCand.posTrackID);
       auto mcLabNeg = trackLabels.rawIteratorAt(hypCand.negTrackID);
@@ -410,7 +416,7 @@ struct hyperRecoTask {
               }
               hypCand.isSignal = true;
               hypCand.pdgCode = posMother.pdgCode();
-              filledMothers.push_back(posMother.globalIndex());
+              filledMothers[posMother.globalIndex()] = true;
             }
           }
         }
@@ -447,7 +453,7 @@ struct hyperRecoTask {
       } else {
         hIsMatterGenTwoBody->Fill(1.);
       }
-      if (std::find(filledMothers.begin(), filledMothers.end(), mcPart.globalIndex()) != std::end(filledMothers)) {
+      if (filledMothers[mcPart.globalIndex()]) {
         continue;
       }
       hyperCandidate hypCand;
@@ -463,7 +469,8 @@ struct hyperRecoTask {
     }
   }
 
-  void processData(soa::Join<aod::Collisions, aod::EvSels> const& collisions, aod::V0s const& V0s, TracksFull const& tracks, aod::BCsWithTimestamps const&)
+  template <class TTracks>
+  void analyseData(soa::Join<aod::Collisions, aod::EvSels> const& collisions, aod::V0s const& V0s, TTracks const& tracks)
   {
     hyperCandidates.clear();
 
@@ -488,7 +495,7 @@ struct hyperRecoTask {
       auto V0Table_thisCollision = V0s.sliceBy(perCollision, collIdx);
       V0Table_thisCollision.bindExternalIndices(&tracks);
 
-      fillCandidateData<TracksFull>(collision, V0Table_thisCollision);
+      fillCandidateData<TTracks>(collision, V0Table_thisCollision);
     }
 
     for (auto& hypCand : hyperCandidates) {
@@ -500,8 +507,19 @@ struct hyperRecoTask {
                       hypCand.he3DCAXY, hypCand.piDCAXY);
     }
   }
+
+  void processData(soa::Join<aod::Collisions, aod::EvSels> const& collisions, aod::V0s const& V0s, TracksFull const& tracks, aod::BCsWithTimestamps const&)
+  {
+    analyseData(collisions, V0s, tracks);
+  }
   PROCESS_SWITCH(hyperRecoTask, processData, "Data analysis", true);
 
+  void processDataWithTracksDCA(soa::Join<aod::Collisions, aod::EvSels> const& collisions, aod::V0s const& V0s, TracksFullWithDCA const& tracks, aod::BCsWithTimestamps const&)
+  {
+    analyseData(collisions, V0s, tracks);
+  }
+  PROCESS_SWITCH(hyperRecoTask, processDataWithTracksDCA, "Data analysis, with the daughter DCAs of the track propagation", false);
+
   void processMC(soa::Join<aod::Collisions, aod::EvSels> const& collisions, aod::V0s const& V0s, TracksFull const& tracks, aod::BCsWithTimestamps const&, aod::McTrackLabels const& trackLabelsMC, aod::McParticles const& particlesMC)
   {
     hyperCandidates.clear();
@@ -42,6 +42,11 @@
 #include <map>
 #include <iterator>
 #include <utility>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 #include "Framework/runDataProcessing.h"
 #include "Framework/RunningWorkflowInfo.h"
@@ -50,10 +55,13 @@
 #include "Framework/ASoAHelpers.h"
 #include "DCAFitter/DCAFitterN.h"
 #include "ReconstructionDataFormats/Track.h"
+#include "Common/Core/ProcessTimer.h"
+#include "Common/Core/PropagatorServices.h"
 #include "Common/Core/RecoDecay.h"
 #include "Common/Core/trackUtilities.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
 #include "PWGLF/DataModel/LFParticleIdentification.h"
+#include "PWGLF/Utils/trackDCAtoPV.h"
 #include "Common/Core/TrackSelection.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "DetectorsBase/Propagator.h"
@@ -75,6 +83,7 @@ using std::array;
 // use parameters + cov mat non-propagated, aux info + (extension propagated)
 using FullTracksExt = soa::Join<aod::Tracks, aod::TracksExtra, aod::TracksCov>;
 using FullTracksExtIU = soa::Join<aod::TracksIU, aod::TracksExtra, aod::TracksCovIU>;
+using FullTracksExtIUWithDCA = soa::Join<aod::TracksIU, aod::TracksExtra, aod::TracksCovIU, aod::TracksDCA>;
 using TracksWithExtra = soa::Join<aod::Tracks, aod::TracksExtra>;
 
 // For dE/dx association in pre-selection
@@ -121,6 +130,7 @@ struct lambdakzeroBuilder {
   Configurable<bool> d_doTrackQA{"d_doTrackQA", false, "do track QA"};
   Configurable<bool> d_QA_checkMC{"d_QA_checkMC", true, "check MC truth in QA"};
   Configurable<bool> d_QA_checkdEdx{"d_QA_checkdEdx", false, "check dEdx in QA"};
+  Configurable<int> nBuilderThreads{"nBuilderThreads", 1, "number of threads building the V0s, sequential if 1, with the basic QA or with the TGeo material correction"};
 
   // CCDB options
   Configurable<std::string> ccdburl{"ccdb-url", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
@@ -159,9 +169,6 @@ struct lambdakzeroBuilder {
   o2::base::MatLayerCylSet* lut = nullptr;
   o2::dataformats::MeanVertexObject* mVtx = nullptr;
 
-  // Define o2 fitter, 2-prong, active memory (no need to redefine per event)
-  o2::vertexing::DCAFitterN<2> fitter;
-
   Filter taggedFilter = aod::v0tag::isInteresting == true;
 
   // For manual sliceBy
@@ -176,7 +183,7 @@ struct lambdakzeroBuilder {
                 kNV0Steps };
 
   // Helper struct to pass V0 information
-  struct {
+  struct V0Candidate {
     float posTrackX;
     float negTrackX;
     std::array<float, 3> pos;
@@ -189,16 +196,41 @@ struct lambdakzeroBuilder {
     float V0radius;
     float lambdaMass;
     float antilambdaMass;
-  } v0candidate;
+  };
 
   // Helper struct to do bookkeeping of building parameters
-  struct {
+  struct StatisticsRegistry {
     std::array<int32_t, kNV0Steps> v0stats;
     std::array<int32_t, 10> posITSclu;
     std::array<int32_t, 10> negITSclu;
     int32_t exceptions;
     int32_t eventCounter;
-  } statisticsRegistry;
+  };
+
+  // Fitter and working objects of a building thread, the sequential building uses the first one
+  struct V0Builder {
+    // Define o2 fitter, 2-prong, active memory (no need to redefine per event)
+    o2::vertexing::DCAFitterN<2> fitter;
+    V0Candidate v0candidate;
+    StatisticsRegistry statisticsRegistry;
+    o2::track::TrackParCov lPositiveTrack;
+    o2::track::TrackParCov lNegativeTrack;
+  };
+  std::vector<V0Builder> builders;
+
+  // Result of the threaded building of a V0, stored in the order of the V0 table
+  struct V0Result {
+    bool valid;
+    V0Candidate v0candidate;
+    float positionCovariance[6];
+    float momentumCovariance[6];
+  };
+  std::vector<V0Result> v0results;
+
+  // DCA to the PV of the daughters, propagated once per track and data frame
+  std::vector<float> trackDCAxy;
+  std::vector<int> trackDCACollision; // collision of the cached DCA, -2 if not computed
+  std::vector<std::pair<int, bool>> dcaRequests; // V0 and daughter (positive or not) of the DCAs to compute
 
   HistogramRegistry registry{
     "registry",
@@ -207,21 +239,37 @@ struct lambdakzeroBuilder {
      {"hPositiveITSClusters", "hPositiveITSClusters", {HistType::kTH1F, {{10, -0.5f, 9.5f}}}},
      {"hNegativeITSClusters", "hNegativeITSClusters", {HistType::kTH1F, {{10, -0.5f, 9.5f}}}},
      {"hV0Criteria", "hV0Criteria", {HistType::kTH1F, {{10, -0.5f, 9.5f}}}}}};
+  o2::common::ProcessTimer timerBuild;
 
   void resetHistos()
   {
-    statisticsRegistry.exceptions = 0;
-    statisticsRegistry.eventCounter = 0;
-    for (Int_t ii = 0; ii < kNV0Steps; ii++)
-      statisticsRegistry.v0stats[ii] = 0;
-    for (Int_t ii = 0; ii < 10; ii++) {
-      statisticsRegistry.posITSclu[ii] = 0;
-      statisticsRegistry.negITSclu[ii] = 0;
+    for (auto& builder : builders) {
+      auto& statisticsRegistry = builder.statisticsRegistry;
+      statisticsRegistry.exceptions = 0;
+      statisticsRegistry.eventCounter = 0;
+      for (Int_t ii = 0; ii < kNV0Steps; ii++)
+        statisticsRegistry.v0stats[ii] = 0;
+      for (Int_t ii = 0; ii < 10; ii++) {
+        statisticsRegistry.posITSclu[ii] = 0;
+        statisticsRegistry.negITSclu[ii] = 0;
+      }
     }
   }
 
   void fillHistos()
   {
+    // sum of the bookkeeping of all the building threads
+    auto statisticsRegistry = builders[0].statisticsRegistry;
+    for (size_t ib = 1; ib < builders.size(); ib++) {
+      auto const& threadRegistry = builders[ib].statisticsRegistry;
+      statisticsRegistry.exceptions += threadRegistry.exceptions;
+      for (Int_t ii = 0; ii < kNV0Steps; ii++)
+        statisticsRegistry.v0stats[ii] += threadRegistry.v0stats[ii];
+      for (Int_t ii = 0; ii < 10; ii++) {
+        statisticsRegistry.posITSclu[ii] += threadRegistry.posITSclu[ii];
+        statisticsRegistry.negITSclu[ii] += threadRegistry.negITSclu[ii];
+      }
+    }
     registry.fill(HIST("hEventCounter"), 0.0, statisticsRegistry.eventCounter);
     registry.fill(HIST("hCaughtExceptions"), 0.0, statisticsRegistry.exceptions);
     for (Int_t ii = 0; ii < kNV0Steps; ii++)
@@ -234,11 +282,10 @@ struct lambdakzeroBuilder {
     }
   }
 
-  o2::track::TrackParCov lPositiveTrack;
-  o2::track::TrackParCov lNegativeTrack;
-
   void init(InitContext& context)
   {
+    timerBuild.init(registry, doprocessRun2 ? "processRun2" : (doprocessRun3WithTracksDCA ? "processRun3WithTracksDCA" : "processRun3"));
+    builders.resize(std::max(1, static_cast<int>(nBuilderThreads)));
     resetHistos();
 
     randomSeed = static_cast<unsigned int>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
@@ -301,15 +348,18 @@ struct lambdakzeroBuilder {
     }
     if (useMatCorrType == 2) {
       LOGF(info, "LUT correction requested, loading LUT");
-      lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(lutPath));
+      lut = o2::common::propagator::getMatLut(ccdb, lutPath);
     }
 
-    if (doprocessRun2 == false && doprocessRun3 == false) {
-      LOGF(fatal, "Neither processRun2 nor processRun3 enabled. Please choose one.");
+    if (doprocessRun2 == false && doprocessRun3 == false && doprocessRun3WithTracksDCA == false) {
+      LOGF(fatal, "Neither processRun2 nor processRun3 nor processRun3WithTracksDCA enabled. Please choose one.");
     }
     if (doprocessRun2 == true && doprocessRun3 == true) {
       LOGF(fatal, "Cannot enable processRun2 and processRun3 at the same time. Please choose one.");
     }
+    if (doprocessRun3WithTracksDCA == true && (doprocessRun2 == true || doprocessRun3 == true)) {
+      LOGF(fatal, "Cannot enable processRun3WithTracksDCA with processRun2 or processRun3. Please choose one.");
+    }
 
     if (d_UseAutodetectMode) {
       double loosest_v0cospa = 100;
@@ -399,28 +449,44 @@ struct lambdakzeroBuilder {
     if (doprocessRun3 == true) {
       LOGF(info, " ---+*> Run 3 processing enabled. Will subscribe to TracksIU table.");
     }
+    if (doprocessRun3WithTracksDCA == true) {
+      LOGF(info, " ---+*> Run 3 processing enabled. Will subscribe to TracksIU and TracksDCA tables.");
+    }
     if (createV0CovMats > 0) {
       LOGF(info, " ---+*> Will produce V0 cov mat table");
     }
     //*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*
 
-    // initialize O2 2-prong fitter (only once)
-    fitter.setPropagateToPCA(true);
-    fitter.setMaxR(200.);
-    fitter.setMinParamChange(1e-3);
-    fitter.setMinRelChi2Change(0.9);
-    fitter.setMaxDZIni(1e9);
-    fitter.setMaxChi2(1e9);
-    fitter.setUseAbsDCA(d_UseAbsDCA);
-    fitter.setWeightedFinalPCA(d_UseWeightedPCA);
-
     // Material correction in the DCA fitter
     o2::base::Propagator::MatCorrType matCorr = o2::base::Propagator::MatCorrType::USEMatCorrNONE;
     if (useMatCorrType == 1)
       matCorr = o2::base::Propagator::MatCorrType::USEMatCorrTGeo;
     if (useMatCorrType == 2)
       matCorr = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
-    fitter.setMatCorrType(matCorr);
+
+    // initialize O2 2-prong fitters (only once), all the threads use the same parameters
+    for (auto& builder : builders) {
+      auto& fitter = builder.fitter;
+      fitter.setPropagateToPCA(true);
+      fitter.setMaxR(200.);
+      fitter.setMinParamChange(1e-3);
+      fitter.setMinRelChi2Change(0.9);
+      fitter.setMaxDZIni(1e9);
+      fitter.setMaxChi2(1e9);
+      fitter.setUseAbsDCA(d_UseAbsDCA);
+      fitter.setWeightedFinalPCA(d_UseWeightedPCA);
+      fitter.setMatCorrType(matCorr);
+    }
+    if (builders.size() > 1) {
+      LOGF(info, " ---+*> Will build the V0s with %d threads", static_cast<int>(builders.size()));
+    }
+  }
+
+  void setBz(float bz)
+  {
+    for (auto& builder : builders) {
+      builder.fitter.setBz(bz);
+    }
   }
 
   void initCCDB(aod::BCsWithTimestamps::iterator const& bc)
@@ -432,7 +498,7 @@ struct lambdakzeroBuilder {
     // In case override, don't proceed, please - no CCDB access required
     if (d_bz_input > -990) {
       d_bz = d_bz_input;
-      fitter.setBz(d_bz);
+      setBz(d_bz);
       o2::parameters::GRPMagField grpmag;
       if (fabs(d_bz) > 1e-5) {
         grpmag.setL3Current(30000.f / (d_bz / 5.0f));
@@ -464,7 +530,7 @@ struct lambdakzeroBuilder {
     mVtx = ccdb->getForTimeStamp<o2::dataformats::MeanVertexObject>(mVtxPath, bc.timestamp());
     mRunNumber = bc.runNumber();
     // Set magnetic field value once known
-    fitter.setBz(d_bz);
+    setBz(d_bz);
 
     if (useMatCorrType == 2) {
       // setMatLUT only after magfield has been initalized
@@ -473,13 +539,9 @@ struct lambdakzeroBuilder {
     }
   }
 
-  template <class TTrackTo, typename TV0Object>
-  bool buildV0Candidate(TV0Object const& V0)
+  template <typename TV0Object>
+  o2::dataformats::VertexBase getPrimaryVertex(TV0Object const& V0)
   {
-    // Get tracks
-    auto const& posTrack = V0.template posTrack_as<TTrackTo>();
-    auto const& negTrack = V0.template negTrack_as<TTrackTo>();
-
     // for storing whatever is the relevant quantity for the PV
     o2::dataformats::VertexBase primaryVertex;
     if (V0.has_collision()) {
@@ -489,6 +551,46 @@ struct lambdakzeroBuilder {
     } else {
       primaryVertex.setPos({mVtx->getX(), mVtx->getY(), mVtx->getZ()});
     }
+    return primaryVertex;
+  }
+
+  template <class TTrackTo, class TTrack>
+  float propagateDCAxy(TTrack const& track, int collisionId, o2::dataformats::VertexBase const& primaryVertex)
+  {
+    return o2::pwglf::getDCAxyToPV<std::is_same_v<TTrackTo, FullTracksExtIUWithDCA>>(track, collisionId, {primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ()}, builders[0].fitter.getMatCorrType());
+  }
+
+  // DCA of a daughter to the PV of the V0, taken from the cache if already computed for the same collision
+  // \param store whether a newly computed DCA is cached, only from the sequential building
+  template <class TTrackTo, class TTrack>
+  float getDCAxy(TTrack const& track, int collisionId, o2::dataformats::VertexBase const& primaryVertex, bool store)
+  {
+    auto trackId = track.globalIndex();
+    if (trackDCACollision[trackId] == collisionId) {
+      return trackDCAxy[trackId];
+    }
+    float dcaXY = propagateDCAxy<TTrackTo>(track, collisionId, primaryVertex);
+    if (store) {
+      trackDCAxy[trackId] = dcaXY;
+      trackDCACollision[trackId] = collisionId;
+    }
+    return dcaXY;
+  }
+
+  template <class TTrackTo, typename TV0Object>
+  bool buildV0Candidate(TV0Object const& V0, V0Builder& builder, bool storeDCA)
+  {
+    auto& fitter = builder.fitter;
+    auto& v0candidate = builder.v0candidate;
+    auto& statisticsRegistry = builder.statisticsRegistry;
+    auto& lPositiveTrack = builder.lPositiveTrack;
+    auto& lNegativeTrack = builder.lNegativeTrack;
+
+    // Get tracks
+    auto const& posTrack = V0.template posTrack_as<TTrackTo>();
+    auto const& negTrack = V0.template negTrack_as<TTrackTo>();
+
+    auto primaryVertex = getPrimaryVertex(V0);
 
     // value 0.5: any considered V0
     statisticsRegistry.v0stats[kV0All]++;
@@ -505,15 +607,8 @@ struct lambdakzeroBuilder {
     statisticsRegistry.v0stats[kV0TPCrefit]++;
 
     // Calculate DCA with respect to the collision associated to the V0, not individual tracks
-    gpu::gpustd::array<float, 2> dcaInfo;
-
-    auto posTrackPar = getTrackPar(posTrack);
-    o2::base::Propagator::Instance()->propagateToDCABxByBz({primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ()}, posTrackPar, 2.f, fitter.getMatCorrType(), &dcaInfo);
-    auto posTrackdcaXY = dcaInfo[0];
-
-    auto negTrackPar = getTrackPar(negTrack);
-    o2::base::Propagator::Instance()->propagateToDCABxByBz({primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ()}, negTrackPar, 2.f, fitter.getMatCorrType(), &dcaInfo);
-    auto negTrackdcaXY = dcaInfo[0];
+    auto posTrackdcaXY = getDCAxy<TTrackTo>(posTrack, V0.collisionId(), primaryVertex, storeDCA);
+    auto negTrackdcaXY = getDCAxy<TTrackTo>(negTrack, V0.collisionId(), primaryVertex, storeDCA);
 
     if (fabs(posTrackdcaXY) < dcapostopv || fabs(negTrackdcaXY) < dcanegtopv) {
       return false;
@@ -656,10 +751,158 @@ struct lambdakzeroBuilder {
     return true;
   }
 
+  // Covariances of the last V0 built by the builder
+  void getV0Covariances(V0Builder& builder, float* positionCovariance, float* momentumCovariance)
+  {
+    // Calculate position covariance matrix
+    auto covVtxV = builder.fitter.calcPCACovMatrix(0);
+    positionCovariance[0] = covVtxV(0, 0);
+    positionCovariance[1] = covVtxV(1, 0);
+    positionCovariance[2] = covVtxV(1, 1);
+    positionCovariance[3] = covVtxV(2, 0);
+    positionCovariance[4] = covVtxV(2, 1);
+    positionCovariance[5] = covVtxV(2, 2);
+    // store momentum covariance matrix
+    std::array<float, 21> covTpositive = {0.};
+    std::array<float, 21> covTnegative = {0.};
+    builder.lPositiveTrack.getCovXYZPxPyPzGlo(covTpositive);
+    builder.lNegativeTrack.getCovXYZPxPyPzGlo(covTnegative);
+    constexpr int MomInd[6] = {9, 13, 14, 18, 19, 20}; // cov matrix elements for momentum component
+    for (int i = 0; i < 6; i++) {
+      momentumCovariance[i] = covTpositive[MomInd[i]] + covTnegative[MomInd[i]];
+    }
+  }
+
+  template <typename TV0Object>
+  void storeV0(TV0Object const& V0, V0Candidate const& v0candidate, const float* positionCovariance, const float* momentumCovariance)
+  {
+    // populates table for V0 analysis
+    v0data(V0.posTrackId(),
+           V0.negTrackId(),
+           V0.collisionId(),
+           V0.globalIndex(),
+           v0candidate.posTrackX, v0candidate.negTrackX,
+           v0candidate.pos[0], v0candidate.pos[1], v0candidate.pos[2],
+           v0candidate.posP[0], v0candidate.posP[1], v0candidate.posP[2],
+           v0candidate.negP[0], v0candidate.negP[1], v0candidate.negP[2],
+           v0candidate.dcaV0dau,
+           v0candidate.posDCAxy,
+           v0candidate.negDCAxy);
+
+    // populate V0 covariance matrices if required by any other task
+    if (createV0CovMats) {
+      v0covs(positionCovariance, momentumCovariance);
+    }
+  }
+
+  // Calls work(builder, i) for i in [0, n), in chunks taken in order by the first free building thread
+  template <typename TWork>
+  void runOnBuilders(int n, TWork work)
+  {
+    constexpr int chunkSize = 64;
+    std::atomic<int> nextChunk{0};
+    std::vector<std::thread> threads;
+    for (auto& builder : builders) {
+      threads.emplace_back([&, threadBuilder = &builder]() {
+        for (int first = chunkSize * nextChunk++; first < n; first = chunkSize * nextChunk++) {
+          for (int i = first; i < std::min(n, first + chunkSize); i++) {
+            work(*threadBuilder, i);
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  // Builds the first nV0s V0s of the table with all the building threads and stores them in the table order
+  // The DCAs of the daughters are propagated first, once per track, so that the threads only read the cache
   template <class TTrackTo, typename TV0Table>
-  void buildStrangenessTables(TV0Table const& V0s)
+  void buildV0sInThreads(TV0Table const& V0s, int nV0s)
   {
-    statisticsRegistry.eventCounter++;
+    dcaRequests.clear();
+    for (int i = 0; i < nV0s; i++) {
+      auto V0 = V0s.iteratorAt(i);
+      auto const& posTrack = V0.template posTrack_as<TTrackTo>();
+      auto const& negTrack = V0.template negTrack_as<TTrackTo>();
+      if (tpcrefit && (!(posTrack.trackType() & o2::aod::track::TPCrefit) || !(negTrack.trackType() & o2::aod::track::TPCrefit))) {
+        continue;
+      }
+      // the first collision requesting the DCA of a track gets it cached
+      if (trackDCACollision[posTrack.globalIndex()] == -2) {
+        trackDCACollision[posTrack.globalIndex()] = V0.collisionId();
+        dcaRequests.emplace_back(i, true);
+      }
+      if (trackDCACollision[negTrack.globalIndex()] == -2) {
+        trackDCACollision[negTrack.globalIndex()] = V0.collisionId();
+        dcaRequests.emplace_back(i, false);
+      }
+    }
+    runOnBuilders(static_cast<int>(dcaRequests.size()), [&](V0Builder&, int i) {
+      auto V0 = V0s.iteratorAt(dcaRequests[i].first);
+      auto const& track = dcaRequests[i].second ? V0.template posTrack_as<TTrackTo>() : V0.template negTrack_as<TTrackTo>();
+      trackDCAxy[track.globalIndex()] = propagateDCAxy<TTrackTo>(track, V0.collisionId(), getPrimaryVertex(V0));
+    });
+
+    v0results.resize(nV0s);
+    runOnBuilders(nV0s, [&](V0Builder& builder, int i) {
+      auto& result = v0results[i];
+      result.valid = buildV0Candidate<TTrackTo>(V0s.iteratorAt(i), builder, false);
+      if (result.valid) {
+        result.v0candidate = builder.v0candidate;
+        if (createV0CovMats) {
+          getV0Covariances(builder, result.positionCovariance, result.momentumCovariance);
+        }
+      }
+    });
+
+    int i = 0;
+    for (auto& V0 : V0s) {
+      if (i == nV0s) {
+        break;
+      }
+      auto const& result = v0results[i++];
+      if (result.valid) {
+        storeV0(V0, result.v0candidate, result.positionCovariance, result.momentumCovariance);
+      }
+    }
+  }
+
+  template <class TTrackTo, typename TV0Table>
+  void buildStrangenessTables(TV0Table const& V0s, int nTracks)
+  {
+    auto& builder = builders[0];
+    builder.statisticsRegistry.eventCounter++;
+
+    trackDCAxy.resize(nTracks);
+    trackDCACollision.assign(nTracks, -2);
+
+    // the QA histograms are filled while building and the TGeo navigation has a state per thread,
+    // both only work with the sequential building
+    if (builders.size() > 1 && !d_doQA && useMatCorrType != 1) {
+      // downscale some V0s if requested to do so, the building stops at the first rejected V0
+      int nV0s = 0;
+      bool downscaled = false;
+      for (int iV0 = 0; iV0 < static_cast<int>(V0s.size()); iV0++) {
+        if (downscaleFactor < 1.f && (static_cast<float>(rand_r(&randomSeed)) / static_cast<float>(RAND_MAX)) > downscaleFactor) {
+          downscaled = true;
+          break;
+        }
+        nV0s++;
+      }
+      buildV0sInThreads<TTrackTo>(V0s, nV0s);
+      if (downscaled) {
+        return;
+      }
+      // En masse histo filling at end of process call
+      fillHistos();
+      resetHistos();
+      return;
+    }
+
+    float positionCovariance[6];
+    float momentumCovariance[6];
 
     // Loops over all V0s in the time frame
     for (auto& V0 : V0s) {
@@ -669,75 +912,54 @@ struct lambdakzeroBuilder {
       }
 
       // populates v0candidate struct declared inside strangenessbuilder
-      bool validCandidate = buildV0Candidate<TTrackTo>(V0);
+      bool validCandidate = buildV0Candidate<TTrackTo>(V0, builder, true);
 
       if (!validCandidate) {
         continue; // doesn't pass selections
       }
 
-      // populates table for V0 analysis
-      v0data(V0.posTrackId(),
-             V0.negTrackId(),
-             V0.collisionId(),
-             V0.globalIndex(),
-             v0candidate.posTrackX, v0candidate.negTrackX,
-             v0candidate.pos[0], v0candidate.pos[1], v0candidate.pos[2],
-             v0candidate.posP[0], v0candidate.posP[1], v0candidate.posP[2],
-             v0candidate.negP[0], v0candidate.negP[1], v0candidate.negP[2],
-             v0candidate.dcaV0dau,
-             v0candidate.posDCAxy,
-             v0candidate.negDCAxy);
-
-      // populate V0 covariance matrices if required by any other task
       if (createV0CovMats) {
-        // Calculate position covariance matrix
-        auto covVtxV = fitter.calcPCACovMatrix(0);
-        // std::array<float, 6> positionCovariance;
-        float positionCovariance[6];
-        positionCovariance[0] = covVtxV(0, 0);
-        positionCovariance[1] = covVtxV(1, 0);
-        positionCovariance[2] = covVtxV(1, 1);
-        positionCovariance[3] = covVtxV(2, 0);
-        positionCovariance[4] = covVtxV(2, 1);
-        positionCovariance[5] = covVtxV(2, 2);
-        // store momentum covariance matrix
-        std::array<float, 21> covTpositive = {0.};
-        std::array<float, 21> covTnegative = {0.};
-        // std::array<float, 6> momentumCovariance;
-        float momentumCovariance[6];
-        lPositiveTrack.getCovXYZPxPyPzGlo(covTpositive);
-        lNegativeTrack.getCovXYZPxPyPzGlo(covTnegative);
-        constexpr int MomInd[6] = {9, 13, 14, 18, 19, 20}; // cov matrix elements for momentum component
-        for (int i = 0; i < 6; i++) {
-          momentumCovariance[i] = covTpositive[MomInd[i]] + covTnegative[MomInd[i]];
-        }
-        v0covs(positionCovariance, momentumCovariance);
+        getV0Covariances(builder, positionCovariance, momentumCovariance);
       }
+      storeV0(V0, builder.v0candidate, positionCovariance, momentumCovariance);
     }
     // En masse histo filling at end of process call
     fillHistos();
     resetHistos();
   }
 
-  void processRun2(aod::Collisions const& collisions, soa::Filtered<TaggedV0s> const& V0s, FullTracksExt const&, aod::BCsWithTimestamps const&)
+  void processRun2(aod::Collisions const& collisions, soa::Filtered<TaggedV0s> const& V0s, FullTracksExt const& tracks, aod::BCsWithTimestamps const&)
   {
+    o2::common::ScopedTimer timer(timerBuild, V0s.size());
     // Fire up CCDB
     auto collision = collisions.begin();
     auto bc = collision.bc_as<aod::BCsWithTimestamps>();
     initCCDB(bc);
-    buildStrangenessTables<FullTracksExt>(V0s);
+    buildStrangenessTables<FullTracksExt>(V0s, tracks.size());
   }
   PROCESS_SWITCH(lambdakzeroBuilder, processRun2, "Produce Run 2 V0 tables", false);
 
-  void processRun3(aod::Collisions const& collisions, soa::Filtered<TaggedV0s> const& V0s, FullTracksExtIU const&, aod::BCsWithTimestamps const&)
+  void processRun3(aod::Collisions const& collisions, soa::Filtered<TaggedV0s> const& V0s, FullTracksExtIU const& tracks, aod::BCsWithTimestamps const&)
   {
+    o2::common::ScopedTimer timer(timerBuild, V0s.size());
     // Fire up CCDB
     auto collision = collisions.begin();
     auto bc = collision.bc_as<aod::BCsWithTimestamps>();
     initCCDB(bc);
-    buildStrangenessTables<FullTracksExtIU>(V0s);
+    buildStrangenessTables<FullTracksExtIU>(V0s, tracks.size());
   }
   PROCESS_SWITCH(lambdakzeroBuilder, processRun3, "Produce Run 3 V0 tables", true);
+
+  void processRun3WithTracksDCA(aod::Collisions const& collisions, soa::Filtered<TaggedV0s> const& V0s, FullTracksExtIUWithDCA const& tracks, aod::BCsWithTimestamps const&)
+  {
+    o2::common::ScopedTimer timer(timerBuild, V0s.size());
+    // Fire up CCDB
+    auto collision = collisions.begin();
+    auto bc = collision.bc_as<aod::BCsWithTimestamps>();
+    initCCDB(bc);
+    buildStrangenessTables<FullTracksExtIUWithDCA>(V0s, tracks.size());
+  }
+  PROCESS_SWITCH(lambdakzeroBuilder, processRun3WithTracksDCA, "Produce Run 3 V0 tables, with the daughter DCAs of the track propagation", false);
 };
 
 //*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*
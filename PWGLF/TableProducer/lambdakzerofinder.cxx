@@ -59,6 +59,7 @@
 #include <cmath>
 #include <array>
 #include <cstdlib>
+#include <vector>
 
 using namespace o2;
 using namespace o2::framework;
@@ -143,6 +144,7 @@ struct lambdakzerofinder {
   Configurable<float> dcav0dau{"dcav0dau", 1.0, "DCA V0 Daughters"};
   Configurable<float> v0radius{"v0radius", 5.0, "v0radius"};
   Configurable<float> maxV0DCAtoPV{"maxV0DCAtoPV", 0.5, "maximum V0 DCA to PV"};
+  Configurable<float> maxDCAcircles{"maxDCAcircles", 2.0, "maximum distance in xy between the circles of the daughters before the fit (cm), negative to fit all pairs"};
 
   // Configurables for selecting which particles to generate
   Configurable<bool> findK0Short{"findK0Short", true, "findK0Short"};
@@ -164,6 +166,18 @@ struct lambdakzerofinder {
   int mRunNumber;
   float d_bz;
 
+  // daughter candidate, with the track parametrisation and the circle in xy computed once per data frame
+  struct FinderTrack {
+    o2::track::TrackParCov trackParCov;
+    o2::math_utils::CircleXYf_t circle;
+    int64_t globalIndex;
+    float dcaXY;
+    bool compatiblePi;
+    bool compatiblePr;
+  };
+  std::vector<FinderTrack> posFinderTracks;
+  std::vector<FinderTrack> negFinderTracks;
+
   void init(InitContext& context)
   {
     mRunNumber = 0;
@@ -227,14 +241,40 @@ struct lambdakzerofinder {
     return std::sqrt((std::pow((pvY - Y) * Pz - (pvZ - Z) * Py, 2) + std::pow((pvX - X) * Pz - (pvZ - Z) * Px, 2) + std::pow((pvX - X) * Py - (pvY - Y) * Px, 2)) / (Px * Px + Py * Py + Pz * Pz));
   }
 
-  template <class TTrack, class TCollisions>
-  int buildV0Candidate(TTrack const& t1, TTrack const& t2, TCollisions const& collisions)
+  template <class TFinderTracks>
+  void fillFinderTracks(TFinderTracks const& finderTracks, std::vector<FinderTrack>& candidates)
   {
-    auto Track1 = getTrackParCov(t1);
-    auto Track2 = getTrackParCov(t2);
+    candidates.clear();
+    candidates.reserve(finderTracks.size());
+    for (auto& finderTrack : finderTracks) {
+      auto track = finderTrack.template track_as<FullTracksExtIU>();
+      FinderTrack& candidate = candidates.emplace_back();
+      candidate.trackParCov = getTrackParCov(track);
+      float sna, csa;
+      candidate.trackParCov.getCircleParams(d_bz, candidate.circle, sna, csa);
+      candidate.globalIndex = track.globalIndex();
+      candidate.dcaXY = track.dcaXY();
+      candidate.compatiblePi = finderTrack.compatiblePi();
+      candidate.compatiblePr = finderTrack.compatiblePr();
+    }
+  }
 
+  // distance in xy between the circles of two tracks, a lower bound of the distance of the helices
+  static float getCirclesDistance(o2::math_utils::CircleXYf_t const& c1, o2::math_utils::CircleXYf_t const& c2)
+  {
+    float centerDistance = std::hypot(c1.xC - c2.xC, c1.yC - c2.yC);
+    if (centerDistance > c1.rC + c2.rC) {
+      return centerDistance - c1.rC - c2.rC;
+    }
+    float nestedDistance = std::abs(c1.rC - c2.rC) - centerDistance;
+    return nestedDistance > 0.f ? nestedDistance : 0.f;
+  }
+
+  template <class TCollisions>
+  int buildV0Candidate(FinderTrack const& t1, FinderTrack const& t2, TCollisions const& collisions)
+  {
     // Try to progate to dca
-    int nCand = fitter.process(Track1, Track2);
+    int nCand = fitter.process(t1.trackParCov, t2.trackParCov);
     if (nCand == 0) {
       return 0;
     }
@@ -275,14 +315,14 @@ struct lambdakzerofinder {
     }
     if (smallestDCA > maxV0DCAtoPV)
       return 0; // unassociated
-    v0(collisionIndex, t1.globalIndex(), t2.globalIndex());
-    v0data(t1.globalIndex(), t2.globalIndex(), collisionIndex, 0,
+    v0(collisionIndex, t1.globalIndex, t2.globalIndex);
+    v0data(t1.globalIndex, t2.globalIndex, collisionIndex, 0,
            fitter.getTrack(0).getX(), fitter.getTrack(1).getX(),
            pos[0], pos[1], pos[2],
            pvec0[0], pvec0[1], pvec0[2],
            pvec1[0], pvec1[1], pvec1[2],
            TMath::Sqrt(fitter.getChi2AtPCACandidate()),
-           t1.dcaXY(), t2.dcaXY());
+           t1.dcaXY, t2.dcaXY);
     v0datalink(v0data.lastIndex());
     return 1;
   }
@@ -296,23 +336,29 @@ struct lambdakzerofinder {
 
     Long_t lNCand = 0;
 
-    for (auto& pTrack : pTracks) { // FIXME: turn into combination(...)
-      for (auto& nTrack : nTracks) {
+    fillFinderTracks(pTracks, posFinderTracks);
+    fillFinderTracks(nTracks, negFinderTracks);
+    // the circles only bound the helices fitted with a non-zero field
+    const bool checkCircles = maxDCAcircles >= 0.f && std::abs(d_bz) > 1e-5;
+
+    for (auto& pTrack : posFinderTracks) {
+      for (auto& nTrack : negFinderTracks) {
         // Check compatibility with certain hypotheses and desired building
         bool keepCandidate = false;
-        if (pTrack.compatiblePi() && nTrack.compatiblePi() && findK0Short)
+        if (pTrack.compatiblePi && nTrack.compatiblePi && findK0Short)
           keepCandidate = true;
-        if (pTrack.compatiblePr() && nTrack.compatiblePi() && findLambda)
+        if (pTrack.compatiblePr && nTrack.compatiblePi && findLambda)
           keepCandidate = true;
-        if (pTrack.compatiblePi() && nTrack.compatiblePr() && findAntiLambda)
+        if (pTrack.compatiblePi && nTrack.compatiblePr && findAntiLambda)
           keepCandidate = true;
         if (!keepCandidate)
           continue;
 
-        auto t1 = pTrack.track_as<FullTracksExtIU>();
-        auto t2 = nTrack.track_as<FullTracksExtIU>();
+        // Daughters which cannot get closer than maxDCAcircles are not fitted
+        if (checkCircles && getCirclesDistance(pTrack.circle, nTrack.circle) > maxDCAcircles)
+          continue;
 
-        lNCand += buildV0Candidate(t1, t2, collisions);
+        lNCand += buildV0Candidate(pTrack, nTrack, collisions);
       }
     }
     registry.fill(HIST("hCandPerEvent"), lNCand);
@@ -0,0 +1,153 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//
+// Light nuclei preselection task
+// ========================
+//
+// Scans all the tracks of each collision once, and stores the light nuclei candidates,
+// i.e. the tracks compatible with any of the deuteron, triton, He3 and alpha hypotheses in the TPC,
+// with their TPC n-sigma in the NucleiCandidates table. The table is read by the nuclei trigger
+// (o2-analysis-nuclei-filter) and by o2-analysis-lf-nuclei-spectra with their processCandidates
+// process functions, instead of both looping over all the tracks.
+//
+// Executable + dependencies:
+//
+// Data (run3):
+// o2-analysis-lf-nuclei-preselection
+// o2-analysis-pid-tpc-full (only for processPIDTables)
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "Common/DataModel/PIDResponse.h"
+#include "DataFormatsTPC/BetheBlochAleph.h"
+#include "Framework/AnalysisDataModel.h"
+#include "Framework/AnalysisTask.h"
+#include "Framework/runDataProcessing.h"
+
+#include "PWGLF/DataModel/LFSlimNucleiTables.h"
+
+using namespace o2;
+using namespace o2::framework;
+using namespace o2::framework::expressions;
+using namespace o2::constants::physics;
+
+namespace
+{
+constexpr int species{4};
+constexpr float charges[species]{1.f, 1.f, 2.f, 2.f};
+constexpr float masses[species]{MassDeuteron, MassTriton, MassHelium3, MassAlpha};
+constexpr double bbMomScalingDefault[species][2]{
+  {1., 1.},
+  {1., 1.},
+  {1., 1.},
+  {1., 1.}};
+constexpr double betheBlochDefault[species][6]{
+  {-1.e32, -1.e32, -1.e32, -1.e32, -1.e32, -1.e32},
+  {-1.e32, -1.e32, -1.e32, -1.e32, -1.e32, -1.e32},
+  {-1.e32, -1.e32, -1.e32, -1.e32, -1.e32, -1.e32},
+  {-1.e32, -1.e32, -1.e32, -1.e32, -1.e32, -1.e32}};
+constexpr double nSigmaTPCdefault[species][2]{
+  {-6., 6.},
+  {-6., 6.},
+  {-6., 6.},
+  {-6., 6.}};
+static const std::vector<std::string> names{"deuteron", "triton", "He3", "alpha"};
+static const std::vector<std::string> chargeLabelNames{"Positive", "Negative"};
+static const std::vector<std::string> nSigmaConfigName{"nsigma_min", "nsigma_max"};
+static const std::vector<std::string> betheBlochParNames{"p0", "p1", "p2", "p3", "p4", "resolution"};
+} // namespace
+
+struct nucleiPreselection {
+  Produces<o2::aod::NucleiCandidates> candidatesTable;
+
+  // The selections must be looser than those of all the tasks reading the candidates
+  Configurable<float> cfgCutEta{"cfgCutEta", 1.f, "Eta range for tracks"};
+  Configurable<float> cfgCutNclusITS{"cfgCutNclusITS", 2, "Minimum number of ITS clusters"};
+  Configurable<float> cfgCutNclusTPC{"cfgCutNclusTPC", 70, "Minimum number of TPC clusters"};
+
+  Configurable<LabeledArray<double>> cfgMomentumScalingBetheBloch{"cfgMomentumScalingBetheBloch", {bbMomScalingDefault[0], species, 2, names, chargeLabelNames}, "TPC Bethe-Bloch momentum scaling for light nuclei"};
+  Configurable<LabeledArray<double>> cfgBetheBlochParams{"cfgBetheBlochParams", {betheBlochDefault[0], species, 6, names, betheBlochParNames}, "TPC Bethe-Bloch parameterisation for light nuclei, used by processBetheBloch"};
+  Configurable<LabeledArray<double>> cfgNsigmaTPC{"cfgNsigmaTPC", {nSigmaTPCdefault[0], species, 2, names, nSigmaConfigName}, "TPC nsigma preselection for light nuclei"};
+
+  Filter trackFilter = nabs(aod::track::eta) < cfgCutEta;
+
+  using TrackCandidates = soa::Filtered<soa::Join<aod::Tracks, aod::TracksExtra>>;
+  using TrackCandidatesWithPID = soa::Filtered<soa::Join<aod::Tracks, aod::TracksExtra, aod::pidTPCFullDe, aod::pidTPCFullTr, aod::pidTPCFullHe, aod::pidTPCFullAl>>;
+
+  double bgScalings[species][2];
+  double bbParams[species][6];
+  float nSigmaCuts[species][2];
+
+  void init(o2::framework::InitContext&)
+  {
+    for (int iS{0}; iS < species; ++iS) {
+      for (int iC{0}; iC < 2; ++iC) {
+        bgScalings[iS][iC] = charges[iS] * cfgMomentumScalingBetheBloch->get(iS, iC) / masses[iS];
+        nSigmaCuts[iS][iC] = cfgNsigmaTPC->get(iS, iC);
+      }
+      for (int iP{0}; iP < 6; ++iP) {
+        bbParams[iS][iP] = cfgBetheBlochParams->get(iS, iP);
+      }
+    }
+  }
+
+  template <bool usePIDTables, typename TC>
+  void fillCandidates(aod::Collision const& collision, TC const& tracks)
+  {
+    for (auto const& track : tracks) {
+      if (track.itsNCls() < cfgCutNclusITS || track.tpcNClsFound() < cfgCutNclusTPC) {
+        continue;
+      }
+      float nSigma[species];
+      if constexpr (usePIDTables) {
+        nSigma[0] = track.tpcNSigmaDe();
+        nSigma[1] = track.tpcNSigmaTr();
+        nSigma[2] = track.tpcNSigmaHe();
+        nSigma[3] = track.tpcNSigmaAl();
+      } else {
+        const int iC{track.sign() < 0};
+        const float tpcInnerParam{track.tpcInnerParam()};
+        for (int iS{0}; iS < species; ++iS) {
+          double expBethe{tpc::BetheBlochAleph(static_cast<double>(tpcInnerParam * bgScalings[iS][iC]), bbParams[iS][0], bbParams[iS][1], bbParams[iS][2], bbParams[iS][3], bbParams[iS][4])};
+          double expSigma{expBethe * bbParams[iS][5]};
+          nSigma[iS] = static_cast<float>((track.tpcSignal() - expBethe) / expSigma);
+        }
+      }
+      bool selected{false};
+      for (int iS{0}; iS < species; ++iS) {
+        selected = selected || (nSigma[iS] > nSigmaCuts[iS][0] && nSigma[iS] < nSigmaCuts[iS][1]);
+      }
+      if (selected) {
+        candidatesTable(collision.globalIndex(), track.globalIndex(), nSigma[0], nSigma[1], nSigma[2], nSigma[3]);
+      }
+    }
+  }
+
+  void processBetheBloch(aod::Collision const& collision, TrackCandidates const& tracks)
+  {
+    fillCandidates<false>(collision, tracks);
+  }
+  PROCESS_SWITCH(nucleiPreselection, processBetheBloch, "TPC n-sigma from the Bethe-Bloch parameterisation of the task", true);
+
+  void processPIDTables(aod::Collision const& collision, TrackCandidatesWithPID const& tracks)
+  {
+    fillCandidates<true>(collision, tracks);
+  }
+  PROCESS_SWITCH(nucleiPreselection, processPIDTables, "TPC n-sigma from the PID tables", false);
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{
+    adaptAnalysisTask<nucleiPreselection>(cfgc, TaskName{"nuclei-preselection"})};
+}
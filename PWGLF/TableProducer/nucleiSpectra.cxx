@@ -228,10 +228,10 @@ struct nucleiSpectra {
   Filter collisionFilter = nabs(aod::collision::posZ) < cfgCutVertex;
   Filter trackFilter = nabs(aod::track::eta) < cfgCutEta;
 
-  using TrackCandidates = soa::Filtered<soa::Join<aod::TracksIU, aod::TracksCovIU, aod::TracksExtra, aod::TOFSignal, aod::TOFEvTime>>;
+  using TracksFull = soa::Join<aod::TracksIU, aod::TracksCovIU, aod::TracksExtra, aod::TOFSignal, aod::TOFEvTime>;
+  using TrackCandidates = soa::Filtered<TracksFull>;
 
   HistogramRegistry spectra{"spectra", {}, OutputObjHandlingPolicy::AnalysisObject, true, true};
-  o2::pid::tof::Beta<TrackCandidates::iterator> responseBeta;
 
   void initCCDB(aod::BCsWithTimestamps::iterator const& bc)
   {
@@ -320,8 +320,8 @@ struct nucleiSpectra {
     o2::base::Propagator::Instance(true)->setMatLUT(nuclei::lut);
   }
 
-  template <typename TC>
-  void fillDataInfo(soa::Filtered<soa::Join<aod::Collisions, aod::EvSels>>::iterator const& collision, TC const& tracks)
+  /// \return whether the collision is selected, after having set up the magnetic field and cleared the candidates
+  bool selectCollision(soa::Filtered<soa::Join<aod::Collisions, aod::EvSels>>::iterator const& collision)
   {
     auto bc = collision.bc_as<aod::BCsWithTimestamps>();
     initCCDB(bc);
@@ -329,33 +329,49 @@ struct nucleiSpectra {
     nuclei::candidates.clear();
     // collision process loop
     if (!collision.sel8()) {
-      return;
+      return false;
     }
     spectra.fill(HIST("hRecVtxZData"), collision.posZ());
+    return true;
+  }
 
-    const o2::math_utils::Point3D<float> collVtx{collision.posX(), collision.posY(), collision.posZ()};
-    uint8_t zVert{getBinnedValue(collision.posZ(), 10.16)};
+  template <typename TT>
+  bool passesTrackSelections(TT const& track)
+  {
+    return !(track.itsNCls() < cfgCutNclusITS ||
+             track.tpcNClsFound() < cfgCutNclusTPC ||
+             track.tpcNClsCrossedRows() < 70 ||
+             track.tpcNClsCrossedRows() < 0.8 * track.tpcNClsFindable() ||
+             track.tpcChi2NCl() > 4.f ||
+             track.itsChi2NCl() > 36.f);
+  }
+
+  template <typename TC>
+  void fillDataInfo(soa::Filtered<soa::Join<aod::Collisions, aod::EvSels>>::iterator const& collision, TC const& tracks)
+  {
+    if (!selectCollision(collision)) {
+      return;
+    }
 
     const double bgScalings[4][2]{
       {nuclei::charges[0] * cfgMomentumScalingBetheBloch->get(0u, 0u) / nuclei::masses[0], nuclei::charges[0] * cfgMomentumScalingBetheBloch->get(0u, 1u) / nuclei::masses[0]},
       {nuclei::charges[1] * cfgMomentumScalingBetheBloch->get(1u, 0u) / nuclei::masses[1], nuclei::charges[1] * cfgMomentumScalingBetheBloch->get(1u, 1u) / nuclei::masses[1]},
       {nuclei::charges[2] * cfgMomentumScalingBetheBloch->get(2u, 0u) / nuclei::masses[2], nuclei::charges[2] * cfgMomentumScalingBetheBloch->get(2u, 1u) / nuclei::masses[2]},
       {nuclei::charges[3] * cfgMomentumScalingBetheBloch->get(3u, 0u) / nuclei::masses[3], nuclei::charges[3] * cfgMomentumScalingBetheBloch->get(3u, 1u) / nuclei::masses[3]}};
+    /// Bethe-Bloch parameters and resolution of all the species, read once for all the tracks
+    double bbParams[nuclei::species][6];
+    for (int iS{0}; iS < nuclei::species; ++iS) {
+      for (int iP{0}; iP < 6; ++iP) {
+        bbParams[iS][iP] = cfgBetheBlochParams->get(iS, iP);
+      }
+    }
 
     int nGloTracks[2]{0, 0}, nTOFTracks[2]{0, 0};
     for (auto& track : tracks) { // start loop over tracks
-      if (track.itsNCls() < cfgCutNclusITS ||
-          track.tpcNClsFound() < cfgCutNclusTPC ||
-          track.tpcNClsCrossedRows() < 70 ||
-          track.tpcNClsCrossedRows() < 0.8 * track.tpcNClsFindable() ||
-          track.tpcChi2NCl() > 4.f ||
-          track.itsChi2NCl() > 36.f) {
+      if (!passesTrackSelections(track)) {
         continue;
       }
       spectra.fill(HIST("hTpcSignalData"), track.tpcInnerParam() * track.sign(), track.tpcSignal());
-      float nSigma[2][4]{
-        {-10., -10., -10., -10.},
-        {0.f, 0.f, 0.f, 0.f}}; /// then we will calibrate the TOF mass for the He3 and Alpha
       const int iC{track.sign() < 0};
 
       /// Checking if we have outliers in the TPC-TOF correlation
@@ -364,82 +380,122 @@ struct nucleiSpectra {
         nTOFTracks[iC]++;
       }
 
-      bool selectedTPC[4]{false}, goodToAnalyse{false};
+      /// The expected dE/dx of all the species select the nucleus-like tracks, the others are rejected before the propagation
+      const float tpcInnerParam{track.tpcInnerParam()};
+      const float tpcSignal{track.tpcSignal()};
+      float nSigmaTPC[4];
       for (int iS{0}; iS < nuclei::species; ++iS) {
-        double expBethe{tpc::BetheBlochAleph(static_cast<double>(track.tpcInnerParam() * bgScalings[iS][iC]), cfgBetheBlochParams->get(iS, 0u), cfgBetheBlochParams->get(iS, 1u), cfgBetheBlochParams->get(iS, 2u), cfgBetheBlochParams->get(iS, 3u), cfgBetheBlochParams->get(iS, 4u))};
-        double expSigma{expBethe * cfgBetheBlochParams->get(iS, 5u)};
-        nSigma[0][iS] = static_cast<float>((track.tpcSignal() - expBethe) / expSigma);
-        selectedTPC[iS] = (nSigma[0][iS] > nuclei::pidCuts[0][iS][0] && nSigma[0][iS] < nuclei::pidCuts[0][iS][1]);
-        goodToAnalyse = goodToAnalyse || selectedTPC[iS];
+        double expBethe{tpc::BetheBlochAleph(static_cast<double>(tpcInnerParam * bgScalings[iS][iC]), bbParams[iS][0], bbParams[iS][1], bbParams[iS][2], bbParams[iS][3], bbParams[iS][4])};
+        double expSigma{expBethe * bbParams[iS][5]};
+        nSigmaTPC[iS] = static_cast<float>((tpcSignal - expBethe) / expSigma);
       }
-      if (!goodToAnalyse) {
+      analyseTrack(collision, track, nSigmaTPC);
+    } // end loop over tracks
+
+    nuclei::hGloTOFtracks[0]->Fill(nGloTracks[0], nTOFTracks[0]);
+    nuclei::hGloTOFtracks[1]->Fill(nGloTracks[1], nTOFTracks[1]);
+  }
+
+  /// Same as fillDataInfo, for the light nuclei candidates of the nuclei-preselection task and with their TPC n-sigma
+  /// The tracks which are not candidates are not looked at, so the histograms of all the tracks are not filled.
+  template <typename TCands>
+  void fillDataInfoFromCandidates(soa::Filtered<soa::Join<aod::Collisions, aod::EvSels>>::iterator const& collision, TCands const& candidates)
+  {
+    if (!selectCollision(collision)) {
+      return;
+    }
+    for (auto& candidate : candidates) {
+      auto track = candidate.template track_as<TracksFull>();
+      if (std::abs(track.eta()) >= cfgCutEta || !passesTrackSelections(track)) {
         continue;
       }
+      const float nSigmaTPC[4]{candidate.tpcNsigmaDe(), candidate.tpcNsigmaTr(), candidate.tpcNsigmaHe(), candidate.tpcNsigmaAl()};
+      analyseTrack(collision, track, nSigmaTPC);
+    }
+  }
 
-      auto trackParCov = getTrackParCov(track); // should we set the charge according to the nucleus?
-      gpu::gpustd::array<float, 2> dcaInfo;
-      o2::base::Propagator::Instance()->propagateToDCA(collVtx, trackParCov, mBz, 2.f, static_cast<o2::base::Propagator::MatCorrType>(cfgMaterialCorrection.value), &dcaInfo);
+  /// Analyses the track as a nucleus of the species selected by their TPC n-sigma, and stores the candidates
+  template <typename TT>
+  void analyseTrack(soa::Filtered<soa::Join<aod::Collisions, aod::EvSels>>::iterator const& collision, TT const& track, const float nSigmaTPC[4])
+  {
+    float nSigma[2][4]{
+      {nSigmaTPC[0], nSigmaTPC[1], nSigmaTPC[2], nSigmaTPC[3]},
+      {0.f, 0.f, 0.f, 0.f}}; /// then we will calibrate the TOF mass for the He3 and Alpha
+    const int iC{track.sign() < 0};
+    bool selectedTPC[4]{false}, goodToAnalyse{false};
+    for (int iS{0}; iS < nuclei::species; ++iS) {
+      selectedTPC[iS] = (nSigma[0][iS] > nuclei::pidCuts[0][iS][0] && nSigma[0][iS] < nuclei::pidCuts[0][iS][1]);
+      goodToAnalyse = goodToAnalyse || selectedTPC[iS];
+    }
+    if (!goodToAnalyse) {
+      return;
+    }
 
-      float beta{responseBeta.GetBeta(track)};
-      spectra.fill(HIST("hTpcSignalDataSelected"), track.tpcInnerParam() * track.sign(), track.tpcSignal());
-      spectra.fill(HIST("hTofSignalData"), track.tpcInnerParam(), beta);
-      beta = std::min(1.f - 1.e-6f, std::max(1.e-4f, beta)); /// sometimes beta > 1 or < 0, to be chec
-      for (int iS{0}; iS < nuclei::species; ++iS) {
-        bool selectedTOF{false};
-        if (std::abs(dcaInfo[1]) > cfgDCAcut->get(iS, 1)) {
-          continue;
-        }
-        ROOT::Math::LorentzVector<ROOT::Math::PtEtaPhiM4D<float>> fvector{trackParCov.getPt() * nuclei::charges[iS], trackParCov.getEta(), trackParCov.getPhi(), nuclei::masses[iS]};
-        float y{fvector.Rapidity() + cfgCMrapidity};
-        if (cfgCutOnReconstructedRapidity && (y < cfgCutRapidityMin || y > cfgCutRapidityMax)) {
-          continue;
-        }
+    const o2::math_utils::Point3D<float> collVtx{collision.posX(), collision.posY(), collision.posZ()};
+    uint8_t zVert{getBinnedValue(collision.posZ(), 10.16)};
+    const float tpcInnerParam{track.tpcInnerParam()};
+    auto trackParCov = getTrackParCov(track); // should we set the charge according to the nucleus?
+    gpu::gpustd::array<float, 2> dcaInfo;
+    o2::base::Propagator::Instance()->propagateToDCA(collVtx, trackParCov, mBz, 2.f, static_cast<o2::base::Propagator::MatCorrType>(cfgMaterialCorrection.value), &dcaInfo);
+
+    float beta{o2::pid::tof::Beta<TT>::GetBeta(track)};
+    spectra.fill(HIST("hTpcSignalDataSelected"), track.tpcInnerParam() * track.sign(), track.tpcSignal());
+    spectra.fill(HIST("hTofSignalData"), track.tpcInnerParam(), beta);
+    beta = std::min(1.f - 1.e-6f, std::max(1.e-4f, beta)); /// sometimes beta > 1 or < 0, to be chec
+    /// p / (beta gamma), the TOF mass of each species is its charge times this minus its mass
+    const float tofMassPerCharge{tpcInnerParam * std::sqrt(1.f / (beta * beta) - 1.f)};
+    for (int iS{0}; iS < nuclei::species; ++iS) {
+      bool selectedTOF{false};
+      if (std::abs(dcaInfo[1]) > cfgDCAcut->get(iS, 1)) {
+        continue;
+      }
+      ROOT::Math::LorentzVector<ROOT::Math::PtEtaPhiM4D<float>> fvector{trackParCov.getPt() * nuclei::charges[iS], trackParCov.getEta(), trackParCov.getPhi(), nuclei::masses[iS]};
+      float y{fvector.Rapidity() + cfgCMrapidity};
+      if (cfgCutOnReconstructedRapidity && (y < cfgCutRapidityMin || y > cfgCutRapidityMax)) {
+        continue;
+      }
 
-        for (int iPID{0}; iPID < 2; ++iPID) {
-          if (selectedTPC[iS]) {
-            if (iPID && !track.hasTOF()) {
-              continue;
-            } else if (iPID) {
-              selectedTOF = true;
-            }
-            nuclei::hDCAxy[iPID][iS][iC]->Fill(1., fvector.pt(), dcaInfo[0]);
-            nuclei::hDCAz[iPID][iS][iC]->Fill(1., fvector.pt(), dcaInfo[1]);
-            if (std::abs(dcaInfo[0]) < cfgDCAcut->get(iS, 0u)) {
-              if (!iPID) { /// temporary exclusion of the TOF nsigma PID for the He3 and Alpha
-                nuclei::hNsigma[iPID][iS][iC]->Fill(1., fvector.pt(), nSigma[iPID][iS]);
-                nuclei::hNsigmaEta[iPID][iS][iC]->Fill(fvector.eta(), fvector.pt(), nSigma[iPID][iS]);
-              }
-              if (iPID) {
-                float mass{track.tpcInnerParam() * nuclei::charges[iS] * std::sqrt(1.f / (beta * beta) - 1.f) - nuclei::masses[iS]};
-                nuclei::hTOFmass[iS][iC]->Fill(1., fvector.pt(), mass);
-                nuclei::hTOFmassEta[iS][iC]->Fill(fvector.eta(), fvector.pt(), mass);
-              }
-            }
-          }
-        }
-        uint16_t flag{kIsReconstructed};
-        if (cfgTreeConfig->get(iS, 0u) && selectedTPC[iS]) {
-          uint8_t massTOF{0u};
-          if (cfgTreeConfig->get(iS, 1u) && !selectedTOF) {
+      for (int iPID{0}; iPID < 2; ++iPID) {
+        if (selectedTPC[iS]) {
+          if (iPID && !track.hasTOF()) {
             continue;
+          } else if (iPID) {
+            selectedTOF = true;
           }
-          if (track.hasTOF()) {
-            flag |= kHasTOF;
-            float mass{track.tpcInnerParam() * nuclei::charges[iS] * std::sqrt(1.f / (beta * beta) - 1.f) - nuclei::masses[iS]};
-            massTOF = getBinnedValue(mass, cfgBinnedVariables->get(3u, 1u));
+          nuclei::hDCAxy[iPID][iS][iC]->Fill(1., fvector.pt(), dcaInfo[0]);
+          nuclei::hDCAz[iPID][iS][iC]->Fill(1., fvector.pt(), dcaInfo[1]);
+          if (std::abs(dcaInfo[0]) < cfgDCAcut->get(iS, 0u)) {
+            if (!iPID) { /// temporary exclusion of the TOF nsigma PID for the He3 and Alpha
+              nuclei::hNsigma[iPID][iS][iC]->Fill(1., fvector.pt(), nSigma[iPID][iS]);
+              nuclei::hNsigmaEta[iPID][iS][iC]->Fill(fvector.eta(), fvector.pt(), nSigma[iPID][iS]);
+            }
+            if (iPID) {
+              float mass{tofMassPerCharge * nuclei::charges[iS] - nuclei::masses[iS]};
+              nuclei::hTOFmass[iS][iC]->Fill(1., fvector.pt(), mass);
+              nuclei::hTOFmassEta[iS][iC]->Fill(fvector.eta(), fvector.pt(), mass);
+            }
           }
-          flag |= BIT(iS);
-          uint8_t dcaxy = getBinnedValue(dcaInfo[0], cfgBinnedVariables->get(0u, 1u));
-          uint8_t dcaz = getBinnedValue(dcaInfo[1], cfgBinnedVariables->get(1u, 1u));
-          uint8_t nsigmaTPC = getBinnedValue(nSigma[0][iS], cfgBinnedVariables->get(2u, 1u));
-
-          nuclei::candidates.emplace_back(track.globalIndex(), track.sign() * fvector.pt(), fvector.eta(), fvector.phi(), zVert, track.itsClusterMap(), track.tpcNClsFound(), dcaxy, dcaz, flag, nsigmaTPC, massTOF);
         }
       }
-    } // end loop over tracks
+      uint16_t flag{kIsReconstructed};
+      if (cfgTreeConfig->get(iS, 0u) && selectedTPC[iS]) {
+        uint8_t massTOF{0u};
+        if (cfgTreeConfig->get(iS, 1u) && !selectedTOF) {
+          continue;
+        }
+        if (track.hasTOF()) {
+          flag |= kHasTOF;
+          float mass{tofMassPerCharge * nuclei::charges[iS] - nuclei::masses[iS]};
+          massTOF = getBinnedValue(mass, cfgBinnedVariables->get(3u, 1u));
+        }
+        flag |= BIT(iS);
+        uint8_t dcaxy = getBinnedValue(dcaInfo[0], cfgBinnedVariables->get(0u, 1u));
+        uint8_t dcaz = getBinnedValue(dcaInfo[1], cfgBinnedVariables->get(1u, 1u));
+        uint8_t nsigmaTPC = getBinnedValue(nSigma[0][iS], cfgBinnedVariables->get(2u, 1u));
 
-    nuclei::hGloTOFtracks[0]->Fill(nGloTracks[0], nTOFTracks[0]);
-    nuclei::hGloTOFtracks[1]->Fill(nGloTracks[1], nTOFTracks[1]);
+        nuclei::candidates.emplace_back(track.globalIndex(), track.sign() * fvector.pt(), fvector.eta(), fvector.phi(), zVert, track.itsClusterMap(), track.tpcNClsFound(), dcaxy, dcaz, flag, nsigmaTPC, massTOF);
+      }
+    }
   }
 
   void processData(soa::Filtered<soa::Join<aod::Collisions, aod::EvSels>>::iterator const& collision, TrackCandidates const& tracks, aod::BCsWithTimestamps const&)
@@ -451,6 +507,15 @@ struct nucleiSpectra {
   }
   PROCESS_SWITCH(nucleiSpectra, processData, "Data analysis", true);
 
+  void processDataCandidates(soa::Filtered<soa::Join<aod::Collisions, aod::EvSels>>::iterator const& collision, aod::NucleiCandidates const& candidates, TracksFull const&, aod::BCsWithTimestamps const&)
+  {
+    fillDataInfoFromCandidates(collision, candidates);
+    for (auto& c : nuclei::candidates) {
+      nucleiTable(c.pt, c.eta, c.phi, c.zVertex, c.ITSclsMap, c.TPCnCls, c.DCAxy, c.DCAz, c.flags, c.TPCnsigma, c.TOFmass);
+    }
+  }
+  PROCESS_SWITCH(nucleiSpectra, processDataCandidates, "Data analysis of the light nuclei candidates of the preselection", false);
+
   Preslice<TrackCandidates> tracksPerCollisions = aod::track::collisionId;
   void processMC(soa::Filtered<soa::Join<aod::Collisions, aod::EvSels>> const& collisions, TrackCandidates const& tracks, aod::McTrackLabels const& trackLabelsMC, aod::McParticles const& particlesMC, aod::BCsWithTimestamps const&)
   {
@@ -1116,8 +1116,11 @@ struct LFNucleiBATask {
 
     float gamma = 0., massTOF = 0., hePt = 0.f;
     bool isTriton = kFALSE;
+    bool prRapCut = kFALSE;
     bool deRapCut = kFALSE;
+    bool trRapCut = kFALSE;
     bool heRapCut = kFALSE;
+    bool alRapCut = kFALSE;
 
     // Event histos fill
     histos.fill(HIST("event/h1VtxZ"), event.posZ());
@@ -1159,9 +1162,12 @@ struct LFNucleiBATask {
           break;
       }
 
-      // debug on helium rapidity cut
+      // Rapidity cuts of all the species, evaluated once per track
+      prRapCut = TMath::Abs(track.rapidity(o2::track::PID::getMass2Z(o2::track::PID::Proton))) < yCut;
       deRapCut = TMath::Abs(track.rapidity(o2::track::PID::getMass2Z(o2::track::PID::Deuteron))) < yCut;
+      trRapCut = TMath::Abs(track.rapidity(o2::track::PID::getMass2Z(o2::track::PID::Triton))) < yCut;
       heRapCut = TMath::Abs(track.rapidity(o2::track::PID::getMass2Z(o2::track::PID::Helium3))) < yCut;
+      alRapCut = TMath::Abs(track.rapidity(o2::track::PID::getMass2Z(o2::track::PID::Alpha))) < yCut;
 
       // Tracks DCA histos fill
       if (makeDCABeforeCutPlots) {
@@ -1381,7 +1387,7 @@ struct LFNucleiBATask {
 
       if (track.sign() > 0) {
         if (enablePr) {
-          if (TMath::Abs(track.rapidity(o2::track::PID::getMass2Z(o2::track::PID::Proton))) < yCut) {
+          if (prRapCut) {
             if (enableExpSignalTPC)
               histos.fill(HIST("tracks/proton/h2ProtonTPCExpSignalDiffVsPt"), track.pt(), track.tpcExpSignalDiffPr());
 
@@ -1423,7 +1429,7 @@ struct LFNucleiBATask {
           }
         }
         if (enableTr) {
-          if (TMath::Abs(track.rapidity(o2::track::PID::getMass2Z(o2::track::PID::Triton))) < yCut) {
+          if (trRapCut) {
             histos.fill(HIST("tracks/triton/h2TritonVspTNSigmaTPC"), track.pt(), track.tpcNSigmaTr());
           }
         }
@@ -1434,13 +1440,13 @@ struct LFNucleiBATask {
           histos.fill(HIST("tracks/helium/h2HeliumVspTNSigmaTPC"), hePt, track.tpcNSigmaHe());
         }
         if (enableAl) {
-          if (TMath::Abs(track.rapidity(o2::track::PID::getMass2Z(o2::track::PID::Alpha))) < yCut) {
+          if (alRapCut) {
             histos.fill(HIST("tracks/alpha/h2AlphaVspTNSigmaTPC"), track.pt(), track.tpcNSigmaAl());
           }
         }
       } else {
         if (enablePr) {
-          if (TMath::Abs(track.rapidity(o2::track::PID::getMass2Z(o2::track::PID::Proton))) < yCut) {
+          if (prRapCut) {
             if (enableExpSignalTPC)
               histos.fill(HIST("tracks/proton/h2antiProtonTPCExpSignalDiffVsPt"), track.pt(), track.tpcExpSignalDiffPr());
 
@@ -1482,7 +1488,7 @@ struct LFNucleiBATask {
           }
         }
         if (enableTr) {
-          if (TMath::Abs(track.rapidity(o2::track::PID::getMass2Z(o2::track::PID::Triton))) < yCut) {
+          if (trRapCut) {
             histos.fill(HIST("tracks/triton/h2antiTritonVspTNSigmaTPC"), track.pt(), track.tpcNSigmaTr());
           }
         }
@@ -1493,7 +1499,7 @@ struct LFNucleiBATask {
           histos.fill(HIST("tracks/helium/h2antiHeliumVspTNSigmaTPC"), hePt, track.tpcNSigmaHe());
         }
         if (enableAl) {
-          if (TMath::Abs(track.rapidity(o2::track::PID::getMass2Z(o2::track::PID::Alpha))) < yCut) {
+          if (alRapCut) {
             histos.fill(HIST("tracks/alpha/h2antiAlphaVspTNSigmaTPC"), track.pt(), track.tpcNSigmaAl());
           }
         }
@@ -1505,7 +1511,7 @@ struct LFNucleiBATask {
         histos.fill(HIST("tracks/kaon/h2KaonVspTNSigmaTOF"), track.pt(), track.tofNSigmaKa());
         if (track.sign() > 0) {
           if (enablePr) {
-            if (TMath::Abs(track.rapidity(o2::track::PID::getMass2Z(o2::track::PID::Proton))) < yCut) {
+            if (prRapCut) {
               switch (useHasTRDConfig) {
                 case 0:
                   histos.fill(HIST("tracks/proton/h2ProtonVspTNSigmaTOF"), track.pt(), track.tofNSigmaPr());
@@ -1687,7 +1693,7 @@ struct LFNucleiBATask {
 
         } else {
           if (enablePr) {
-            if (TMath::Abs(track.rapidity(o2::track::PID::getMass2Z(o2::track::PID::Proton))) < yCut) {
+            if (prRapCut) {
               switch (useHasTRDConfig) {
                 case 0:
                   histos.fill(HIST("tracks/proton/h2antiProtonVspTNSigmaTOF"), track.pt(), track.tofNSigmaPr());
@@ -1860,7 +1866,7 @@ struct LFNucleiBATask {
 
       // PID
       if (enablePr) {
-        if ((std::abs(track.tpcNSigmaPr()) < nsigmaTPCPr) && (TMath::Abs(track.rapidity(o2::track::PID::getMass2Z(o2::track::PID::Proton))) < yCut)) {
+        if ((std::abs(track.tpcNSigmaPr()) < nsigmaTPCPr) && prRapCut) {
           if (track.sign() > 0) {
             if (enablePtSpectra) {
               histos.fill(HIST("tracks/eff/proton/hPtPr"), track.pt());
@@ -1918,7 +1924,7 @@ struct LFNucleiBATask {
 
       if (enableTr) {
         // if ((((!enableStrongCut) && (std::abs(track.tpcNSigmaTr()) < nsigmaTPCTr)) || ((enableStrongCut) && (std::abs(track.tpcNSigmaPr()) >= nsigmaTPCStrongCut))) && (TMath::Abs(track.rapidity(o2::track::PID::getMass2Z(o2::track::PID::Triton))) < yCut)) {
-        if ((isTriton) && (TMath::Abs(track.rapidity(o2::track::PID::getMass2Z(o2::track::PID::Triton))) < yCut)) {
+        if ((isTriton) && trRapCut) {
           if (track.sign() > 0) {
             if (enablePtSpectra) {
               histos.fill(HIST("tracks/eff/triton/hPtTr"), track.pt());
@@ -1974,7 +1980,7 @@ struct LFNucleiBATask {
       }
       if (enableAl) {
         // if ((((!enableStrongCut) && (std::abs(track.tpcNSigmaAl()) < nsigmaTPCAl)) || ((enableStrongCut) && (std::abs(track.tpcNSigmaPr()) >= nsigmaTPCStrongCut))) && TMath::Abs(track.rapidity(o2::track::PID::getMass2Z(o2::track::PID::Alpha))) < yCut) {
-        if ((std::abs(track.tpcNSigmaAl()) < nsigmaTPCAl) && TMath::Abs(track.rapidity(o2::track::PID::getMass2Z(o2::track::PID::Alpha))) < yCut) {
+        if ((std::abs(track.tpcNSigmaAl()) < nsigmaTPCAl) && alRapCut) {
           if (track.sign() > 0) {
             histos.fill(HIST("tracks/alpha/h1AlphaSpectra"), track.pt());
             if (enablePIDplot)
@@ -2141,7 +2147,7 @@ struct LFNucleiBATask {
           }
 
           if (enablePr) {
-            if ((std::abs(track.tpcNSigmaPr()) < nsigmaTPCPr) && (TMath::Abs(track.rapidity(o2::track::PID::getMass2Z(o2::track::PID::Proton))) < yCut)) {
+            if ((std::abs(track.tpcNSigmaPr()) < nsigmaTPCPr) && prRapCut) {
               if (enablePtSpectra)
                 histos.fill(HIST("tracks/eff/proton/hPtPrTOF"), track.pt());
               if (track.sign() > 0) {
@@ -2271,7 +2277,7 @@ struct LFNucleiBATask {
 
           if (enableTr) {
             // if ((((!enableStrongCut) && (std::abs(track.tpcNSigmaTr()) < nsigmaTPCTr)) || ((enableStrongCut) && (std::abs(track.tpcNSigmaPr()) >= nsigmaTPCStrongCut))) && (TMath::Abs(track.rapidity(o2::track::PID::getMass2Z(o2::track::PID::Triton))) < yCut)) {
-            if ((isTriton) && (TMath::Abs(track.rapidity(o2::track::PID::getMass2Z(o2::track::PID::Triton))) < yCut)) {
+            if ((isTriton) && trRapCut) {
               if (track.sign() > 0) {
                 if (enablePtSpectra)
                   histos.fill(HIST("tracks/eff/triton/hPtTrTOF"), track.pt());
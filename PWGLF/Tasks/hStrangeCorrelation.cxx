@@ -32,6 +32,10 @@
 #include "Common/DataModel/Centrality.h"
 #include "Framework/StaticFor.h"
 
+#include <array>
+#include <cstdint>
+#include <vector>
+
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::framework::expressions;
@@ -98,148 +102,197 @@ struct correlateStrangeness {
     return deltaPhi;
   }
 
-  void fillCorrelationsV0(aod::TriggerTracks const& triggers, aod::AssocV0s const& assocs, bool mixing, float pvz, float mult)
+  // kinematics of the trigger and associated particles of an event, gathered once before the pair loop
+  struct CorrelationParticles {
+    std::vector<std::array<int64_t, 3>> indices; // global index of the trigger track, or of the daughter tracks of the associated particle (-1 if unused)
+    std::vector<float> pt;
+    std::vector<float> eta;
+    std::vector<float> phi;
+    std::vector<uint32_t> regions; // mass region (1, 2, 3) of each enabled and compatible species of the associated particle, on 2 bits per species
+
+    void clear()
+    {
+      indices.clear();
+      pt.clear();
+      eta.clear();
+      phi.clear();
+      regions.clear();
+    }
+    void add(std::array<int64_t, 3> const& index, float ptValue, float etaValue, float phiValue, uint32_t regionsValue = 0)
+    {
+      indices.push_back(index);
+      pt.push_back(ptValue);
+      eta.push_back(etaValue);
+      phi.push_back(phiValue);
+      regions.push_back(regionsValue);
+    }
+    std::size_t size() const { return pt.size(); }
+  };
+  CorrelationParticles triggerParticles;
+  CorrelationParticles assocParticles;
+
+  void gatherTriggers(aod::TriggerTracks const& triggers)
   {
+    triggerParticles.clear();
     for (auto& triggerTrack : triggers) {
       auto trigg = triggerTrack.track_as<TracksComplete>();
-      if (!mixing)
-        histos.fill(HIST("sameEvent/TriggerParticlesV0"), trigg.pt(), mult);
-      for (auto& assocCandidate : assocs) {
-        auto assoc = assocCandidate.v0Data();
+      triggerParticles.add({trigg.globalIndex(), -1, -1}, trigg.pt(), trigg.eta(), trigg.phi());
+    }
+  }
 
+  /// Calls fillPair(deltaphi, deltaeta, ptassoc, regions) for all the trigger-associated pairs within the axis ranges,
+  /// without the pairs in which the trigger is a daughter of the associated particle
+  template <typename TFillTrigger, typename TFillPair>
+  void loopOverPairs(TFillTrigger&& fillTrigger, TFillPair&& fillPair)
+  {
+    for (std::size_t iTrigger = 0; iTrigger < triggerParticles.size(); iTrigger++) {
+      const int64_t indexTrigger = triggerParticles.indices[iTrigger][0];
+      const float etaTrigger = triggerParticles.eta[iTrigger];
+      const float phiTrigger = triggerParticles.phi[iTrigger];
+      fillTrigger(triggerParticles.pt[iTrigger]);
+      for (std::size_t iAssoc = 0; iAssoc < assocParticles.size(); iAssoc++) {
         //---] removing autocorrelations [---
-        auto postrack = assoc.posTrack_as<TracksComplete>();
-        auto negtrack = assoc.negTrack_as<TracksComplete>();
-        if (trigg.globalIndex() == postrack.globalIndex())
-          continue;
-        if (trigg.globalIndex() == negtrack.globalIndex())
+        auto const& daughters = assocParticles.indices[iAssoc];
+        if (indexTrigger == daughters[0] || indexTrigger == daughters[1] || indexTrigger == daughters[2])
           continue;
         // TODO: add histogram checking how many pairs are rejected (should be small!)
 
-        float deltaphi = ComputeDeltaPhi(trigg.phi(), assoc.phi());
-        float deltaeta = trigg.eta() - assoc.eta();
-        float ptassoc = assoc.pt();
+        float deltaphi = ComputeDeltaPhi(phiTrigger, assocParticles.phi[iAssoc]);
+        float deltaeta = etaTrigger - assocParticles.eta[iAssoc];
 
         // skip if basic ranges not met
         if (deltaphi < axisRanges[0][0] || deltaphi > axisRanges[0][1])
           continue;
         if (deltaeta < axisRanges[1][0] || deltaeta > axisRanges[1][1])
           continue;
-        if (ptassoc < axisRanges[2][0] || ptassoc > axisRanges[2][1])
-          continue;
 
-        static_for<0, 2>([&](auto i) {
-          constexpr int index = i.value;
-          if (bitcheck(doCorrelation, index)) {
-            if (assocCandidate.compatible(index) && !mixing && assocCandidate.invMassRegionCheck(index, 1))
-              histos.fill(HIST("sameEvent/LeftBg/") + HIST(v0names[index]), deltaphi, deltaeta, ptassoc, pvz, mult);
-            if (assocCandidate.compatible(index) && !mixing && assocCandidate.invMassRegionCheck(index, 2))
-              histos.fill(HIST("sameEvent/Signal/") + HIST(v0names[index]), deltaphi, deltaeta, ptassoc, pvz, mult);
-            if (assocCandidate.compatible(index) && !mixing && assocCandidate.invMassRegionCheck(index, 3))
-              histos.fill(HIST("sameEvent/RightBg/") + HIST(v0names[index]), deltaphi, deltaeta, ptassoc, pvz, mult);
-            if (assocCandidate.compatible(index) && mixing && assocCandidate.invMassRegionCheck(index, 1))
-              histos.fill(HIST("mixedEvent/LeftBg/") + HIST(v0names[index]), deltaphi, deltaeta, ptassoc, pvz, mult);
-            if (assocCandidate.compatible(index) && mixing && assocCandidate.invMassRegionCheck(index, 2))
-              histos.fill(HIST("mixedEvent/Signal/") + HIST(v0names[index]), deltaphi, deltaeta, ptassoc, pvz, mult);
-            if (assocCandidate.compatible(index) && mixing && assocCandidate.invMassRegionCheck(index, 3))
-              histos.fill(HIST("mixedEvent/RightBg/") + HIST(v0names[index]), deltaphi, deltaeta, ptassoc, pvz, mult);
-          }
-        });
+        fillPair(deltaphi, deltaeta, assocParticles.pt[iAssoc], assocParticles.regions[iAssoc]);
       }
     }
   }
 
-  void fillCorrelationsCascade(aod::TriggerTracks const& triggers, aod::AssocCascades const& assocs, bool mixing, float pvz, float mult)
+  /// \return whether the pt of an associated particle is within the pt assoc. axis range
+  bool isInPtAssocRange(float ptassoc)
   {
-    for (auto& triggerTrack : triggers) {
-      auto trigg = triggerTrack.track_as<TracksComplete>();
-      if (!mixing)
-        histos.fill(HIST("sameEvent/TriggerParticlesCascade"), trigg.pt(), mult);
-      for (auto& assocCandidate : assocs) {
-        auto assoc = assocCandidate.cascData();
+    return ptassoc >= axisRanges[2][0] && ptassoc <= axisRanges[2][1];
+  }
 
-        //---] removing autocorrelations [---
-        auto v0index = assoc.v0_as<o2::aod::V0sLinked>();
-        if (!(v0index.has_v0Data()))
-          continue;                      // this should not happen - included for safety
-        auto assocV0 = v0index.v0Data(); // de-reference index to correct v0data in case it exists
-        auto postrack = assocV0.posTrack_as<TracksComplete>();
-        auto negtrack = assocV0.negTrack_as<TracksComplete>();
-        auto bachtrack = assoc.bachelor_as<TracksComplete>();
-        if (trigg.globalIndex() == postrack.globalIndex())
-          continue;
-        if (trigg.globalIndex() == negtrack.globalIndex())
-          continue;
-        if (trigg.globalIndex() == bachtrack.globalIndex())
-          continue;
-        // TODO: add histogram checking how many pairs are rejected (should be small!)
+  void fillCorrelationsV0(aod::TriggerTracks const& triggers, aod::AssocV0s const& assocs, bool mixing, float pvz, float mult)
+  {
+    gatherTriggers(triggers);
+    // the species and mass regions of the V0s are stored once, instead of being checked again for each trigger
+    assocParticles.clear();
+    for (auto& assocCandidate : assocs) {
+      auto assoc = assocCandidate.v0Data();
+      if (!isInPtAssocRange(assoc.pt()))
+        continue;
+      uint32_t regions = 0;
+      for (int index = 0; index < 3; index++) {
+        int region = assocCandidate.invMassRegion(index);
+        if (bitcheck(doCorrelation, index) && assocCandidate.compatible(index) && region >= 1 && region <= 3)
+          regions |= region << (2 * index);
+      }
+      if (regions == 0)
+        continue;
+      assocParticles.add({assoc.posTrackId(), assoc.negTrackId(), -1}, assoc.pt(), assoc.eta(), assoc.phi(), regions);
+    }
 
-        float deltaphi = ComputeDeltaPhi(trigg.phi(), assoc.phi());
-        float deltaeta = trigg.eta() - assoc.eta();
-        float ptassoc = assoc.pt();
+    loopOverPairs(
+      [&](float ptTrigger) {
+        if (!mixing)
+          histos.fill(HIST("sameEvent/TriggerParticlesV0"), ptTrigger, mult);
+      },
+      [&](float deltaphi, float deltaeta, float ptassoc, uint32_t regions) {
+        static_for<0, 2>([&](auto i) {
+          constexpr int index = i.value;
+          const uint32_t region = (regions >> (2 * index)) & 0x3;
+          if (region == 1 && !mixing)
+            histos.fill(HIST("sameEvent/LeftBg/") + HIST(v0names[index]), deltaphi, deltaeta, ptassoc, pvz, mult);
+          if (region == 2 && !mixing)
+            histos.fill(HIST("sameEvent/Signal/") + HIST(v0names[index]), deltaphi, deltaeta, ptassoc, pvz, mult);
+          if (region == 3 && !mixing)
+            histos.fill(HIST("sameEvent/RightBg/") + HIST(v0names[index]), deltaphi, deltaeta, ptassoc, pvz, mult);
+          if (region == 1 && mixing)
+            histos.fill(HIST("mixedEvent/LeftBg/") + HIST(v0names[index]), deltaphi, deltaeta, ptassoc, pvz, mult);
+          if (region == 2 && mixing)
+            histos.fill(HIST("mixedEvent/Signal/") + HIST(v0names[index]), deltaphi, deltaeta, ptassoc, pvz, mult);
+          if (region == 3 && mixing)
+            histos.fill(HIST("mixedEvent/RightBg/") + HIST(v0names[index]), deltaphi, deltaeta, ptassoc, pvz, mult);
+        });
+      });
+  }
 
-        // skip if basic ranges not met
-        if (deltaphi < axisRanges[0][0] || deltaphi > axisRanges[0][1])
-          continue;
-        if (deltaeta < axisRanges[1][0] || deltaeta > axisRanges[1][1])
-          continue;
-        if (ptassoc < axisRanges[2][0] || ptassoc > axisRanges[2][1])
-          continue;
+  void fillCorrelationsCascade(aod::TriggerTracks const& triggers, aod::AssocCascades const& assocs, bool mixing, float pvz, float mult)
+  {
+    gatherTriggers(triggers);
+    // the daughters, species and mass regions of the cascades are stored once, instead of being checked again for each trigger
+    assocParticles.clear();
+    for (auto& assocCandidate : assocs) {
+      auto assoc = assocCandidate.cascData();
+      if (!isInPtAssocRange(assoc.pt()))
+        continue;
+      auto v0index = assoc.v0_as<o2::aod::V0sLinked>();
+      if (!(v0index.has_v0Data()))
+        continue;                      // this should not happen - included for safety
+      auto assocV0 = v0index.v0Data(); // de-reference index to correct v0data in case it exists
+      uint32_t regions = 0;
+      for (int index = 0; index < 4; index++) {
+        int region = assocCandidate.invMassRegion(index);
+        if (bitcheck(doCorrelation, index + 3) && assocCandidate.compatible(index) && region >= 1 && region <= 3)
+          regions |= region << (2 * index);
+      }
+      if (regions == 0)
+        continue;
+      assocParticles.add({assocV0.posTrackId(), assocV0.negTrackId(), assoc.bachelorId()}, assoc.pt(), assoc.eta(), assoc.phi(), regions);
+    }
 
+    loopOverPairs(
+      [&](float ptTrigger) {
+        if (!mixing)
+          histos.fill(HIST("sameEvent/TriggerParticlesCascade"), ptTrigger, mult);
+      },
+      [&](float deltaphi, float deltaeta, float ptassoc, uint32_t regions) {
         static_for<0, 3>([&](auto i) {
           constexpr int index = i.value;
-          if (bitcheck(doCorrelation, index + 3)) {
-            if (assocCandidate.compatible(index) && !mixing && assocCandidate.invMassRegionCheck(index, 1))
-              histos.fill(HIST("sameEvent/LeftBg/") + HIST(cascadenames[index]), deltaphi, deltaeta, ptassoc, pvz, mult);
-            if (assocCandidate.compatible(index) && !mixing && assocCandidate.invMassRegionCheck(index, 2))
-              histos.fill(HIST("sameEvent/Signal/") + HIST(cascadenames[index]), deltaphi, deltaeta, ptassoc, pvz, mult);
-            if (assocCandidate.compatible(index) && !mixing && assocCandidate.invMassRegionCheck(index, 3))
-              histos.fill(HIST("sameEvent/RightBg/") + HIST(cascadenames[index]), deltaphi, deltaeta, ptassoc, pvz, mult);
-            if (assocCandidate.compatible(index) && mixing && assocCandidate.invMassRegionCheck(index, 1))
-              histos.fill(HIST("mixedEvent/LeftBg/") + HIST(cascadenames[index]), deltaphi, deltaeta, ptassoc, pvz, mult);
-            if (assocCandidate.compatible(index) && mixing && assocCandidate.invMassRegionCheck(index, 2))
-              histos.fill(HIST("mixedEvent/Signal/") + HIST(cascadenames[index]), deltaphi, deltaeta, ptassoc, pvz, mult);
-            if (assocCandidate.compatible(index) && mixing && assocCandidate.invMassRegionCheck(index, 3))
-              histos.fill(HIST("mixedEvent/RightBg/") + HIST(cascadenames[index]), deltaphi, deltaeta, ptassoc, pvz, mult);
-          }
+          const uint32_t region = (regions >> (2 * index)) & 0x3;
+          if (region == 1 && !mixing)
+            histos.fill(HIST("sameEvent/LeftBg/") + HIST(cascadenames[index]), deltaphi, deltaeta, ptassoc, pvz, mult);
+          if (region == 2 && !mixing)
+            histos.fill(HIST("sameEvent/Signal/") + HIST(cascadenames[index]), deltaphi, deltaeta, ptassoc, pvz, mult);
+          if (region == 3 && !mixing)
+            histos.fill(HIST("sameEvent/RightBg/") + HIST(cascadenames[index]), deltaphi, deltaeta, ptassoc, pvz, mult);
+          if (region == 1 && mixing)
+            histos.fill(HIST("mixedEvent/LeftBg/") + HIST(cascadenames[index]), deltaphi, deltaeta, ptassoc, pvz, mult);
+          if (region == 2 && mixing)
+            histos.fill(HIST("mixedEvent/Signal/") + HIST(cascadenames[index]), deltaphi, deltaeta, ptassoc, pvz, mult);
+          if (region == 3 && mixing)
+            histos.fill(HIST("mixedEvent/RightBg/") + HIST(cascadenames[index]), deltaphi, deltaeta, ptassoc, pvz, mult);
         });
-      }
-    }
+      });
   }
 
   void fillCorrelationsPion(aod::TriggerTracks const& triggers, aod::AssocPions const& assocs, bool mixing, float pvz, float mult)
   {
+    gatherTriggers(triggers);
+    assocParticles.clear();
+    for (auto& assocTrack : assocs) {
+      auto assoc = assocTrack.track_as<TracksComplete>();
+      if (!isInPtAssocRange(assoc.pt()))
+        continue;
+      assocParticles.add({assoc.globalIndex(), -1, -1}, assoc.pt(), assoc.eta(), assoc.phi());
+    }
 
-    for (auto& triggerTrack : triggers) {
-      auto trigg = triggerTrack.track_as<TracksComplete>();
-      if (!mixing)
-        histos.fill(HIST("sameEvent/TriggerParticlesPion"), trigg.pt(), mult);
-      for (auto& assocTrack : assocs) {
-        auto assoc = assocTrack.track_as<TracksComplete>();
-
-        //---] removing autocorrelations [---
-        if (trigg.globalIndex() == assoc.globalIndex())
-          continue;
-        // TODO: add histogram checking how many pairs are rejected (should be small!)
-
-        float deltaphi = ComputeDeltaPhi(trigg.phi(), assoc.phi());
-        float deltaeta = trigg.eta() - assoc.eta();
-        float ptassoc = assoc.pt();
-
-        // skip if basic ranges not met
-        if (deltaphi < axisRanges[0][0] || deltaphi > axisRanges[0][1])
-          continue;
-        if (deltaeta < axisRanges[1][0] || deltaeta > axisRanges[1][1])
-          continue;
-        if (ptassoc < axisRanges[2][0] || ptassoc > axisRanges[2][1])
-          continue;
-
+    loopOverPairs(
+      [&](float ptTrigger) {
+        if (!mixing)
+          histos.fill(HIST("sameEvent/TriggerParticlesPion"), ptTrigger, mult);
+      },
+      [&](float deltaphi, float deltaeta, float ptassoc, uint32_t) {
         if (!mixing)
           histos.fill(HIST("sameEvent/Pion"), deltaphi, deltaeta, ptassoc, pvz, mult);
         else
           histos.fill(HIST("mixedEvent/Pion"), deltaphi, deltaeta, ptassoc, pvz, mult);
-      }
-    }
+      });
   }
 
   void init(InitContext const&)
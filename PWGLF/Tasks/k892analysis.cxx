@@ -24,6 +24,7 @@
 #include "Framework/ASoAHelpers.h"
 #include "Framework/runDataProcessing.h"
 #include "PWGLF/DataModel/LFResonanceTables.h"
+#include "PWGLF/Utils/resonanceEventMixer.h"
 #include "DataFormatsParameters/GRPObject.h"
 
 using namespace o2;
@@ -44,6 +45,7 @@ struct k892analysis {
   ConfigurableAxis binsCent{"binsCent", {VARIABLE_WIDTH, 0., 1., 5., 10., 15., 20., 25., 30., 35., 40., 45., 50., 55., 60., 65., 70., 80., 90., 100.}, "Binning of the centrality axis"};
   /// Event Mixing
   Configurable<int> nEvtMixing{"nEvtMixing", 5, "Number of events to mix"};
+  o2::pwglf::ResonanceEventMixer eventMixer;
   ConfigurableAxis CfgVtxBins{"CfgVtxBins", {VARIABLE_WIDTH, -10.0f, -8.f, -6.f, -4.f, -2.f, 0.f, 2.f, 4.f, 6.f, 8.f, 10.f}, "Mixing bins - z-vertex"};
   ConfigurableAxis CfgMultBins{"CfgMultBins", {VARIABLE_WIDTH, 0.0f, 20.0f, 40.0f, 60.0f, 80.0f, 100.0f, 200.0f, 99999.f}, "Mixing bins - multiplicity"};
   /// Pre-selection cuts
@@ -65,6 +67,7 @@ struct k892analysis {
 
   void init(o2::framework::InitContext&)
   {
+    eventMixer.init(nEvtMixing);
     AxisSpec centAxis = {binsCent, "V0M (%)"};
     AxisSpec multAxis = {0, 0, 100, "V0M (%)"}; // for future
     AxisSpec ptAxis = {binsPt, "#it{p}_{T} (GeV/#it{c})"};
@@ -126,132 +129,134 @@ struct k892analysis {
     auto vKaonTOFPIDpTintv = static_cast<std::vector<double>>(kaonTOFPIDpTintv);
     auto vKaonTOFPIDcuts = static_cast<std::vector<double>>(kaonTOFPIDcuts);
     auto lengthOfkaonTPCPIDpTintv = static_cast<int>(vKaonTPCPIDpTintv.size());
-    for (auto& [trk1, trk2] : combinations(CombinationsFullIndexPolicy(dTracks1, dTracks2))) {
-      // Full index policy is needed to consider all possible combinations
-      if (trk1.index() == trk2.index())
-        continue; // We need to run (0,1), (1,0) pairs as well. but same id pairs are not needed.
+    for (auto& trk1 : dTracks1) {
+      for (auto& trk2 : dTracks2) {
+        // All the ordered pairs are needed, the two tracks take different mass hypotheses
+        if (trk1.index() == trk2.index())
+          continue; // We need to run (0,1), (1,0) pairs as well. but same id pairs are not needed.
 
-      //// Initialize variables
-      // Trk1: Pion, Trk2: Kaon
-      isTrk1Selected = true;
-      isTrk2Selected = true;
-      isTrk1hasTOF = false;
-      isTrk2hasTOF = false;
-      auto trk1ptPi = trk1.pt();
-      auto trk1NSigmaPiTPC = trk1.tpcNSigmaPi();
-      auto trk1NSigmaPiTOF = -999.;
-      auto trk2ptKa = trk2.pt();
-      auto trk2NSigmaKaTPC = trk2.tpcNSigmaKa();
-      auto trk2NSigmaKaTOF = -999.;
+        //// Initialize variables
+        // Trk1: Pion, Trk2: Kaon
+        isTrk1Selected = true;
+        isTrk2Selected = true;
+        isTrk1hasTOF = false;
+        isTrk2hasTOF = false;
+        auto trk1ptPi = trk1.pt();
+        auto trk1NSigmaPiTPC = trk1.tpcNSigmaPi();
+        auto trk1NSigmaPiTOF = -999.;
+        auto trk2ptKa = trk2.pt();
+        auto trk2NSigmaKaTPC = trk2.tpcNSigmaKa();
+        auto trk2NSigmaKaTOF = -999.;
 
-      // hasTOF?
-      if ((trk1.tofPIDselectionFlag() & aod::resodaughter::kHasTOF) == aod::resodaughter::kHasTOF) {
-        isTrk1hasTOF = true;
-      }
-      if ((trk2.tofPIDselectionFlag() & aod::resodaughter::kHasTOF) == aod::resodaughter::kHasTOF) {
-        isTrk2hasTOF = true;
-      }
-      //// PID selections
-      // For Pion candidate, we don't need to apply pT-dependent PID cuts
-      if (std::abs(trk1NSigmaPiTPC) > cMaxTPCnSigmaPion)
-        isTrk1Selected = false;
-      if (isTrk1hasTOF) {
-        trk1NSigmaPiTOF = trk1.tofNSigmaPi();
-        if (std::abs(trk1NSigmaPiTOF) > cMaxTOFnSigmaPion)
+        // hasTOF?
+        if ((trk1.tofPIDselectionFlag() & aod::resodaughter::kHasTOF) == aod::resodaughter::kHasTOF) {
+          isTrk1hasTOF = true;
+        }
+        if ((trk2.tofPIDselectionFlag() & aod::resodaughter::kHasTOF) == aod::resodaughter::kHasTOF) {
+          isTrk2hasTOF = true;
+        }
+        //// PID selections
+        // For Pion candidate, we don't need to apply pT-dependent PID cuts
+        if (std::abs(trk1NSigmaPiTPC) > cMaxTPCnSigmaPion)
           isTrk1Selected = false;
-      }
-      // For Kaon candidate, we need to apply pT-dependent PID cuts
-      if (lengthOfkaonTPCPIDpTintv > 0) {
-        for (int i = 0; i < lengthOfkaonTPCPIDpTintv; i++) {
-          if (trk2ptKa < vKaonTPCPIDpTintv[i]) {
-            if (std::abs(trk2NSigmaKaTPC) > vKaonTPCPIDcuts[i])
-              isTrk2Selected = false;
-          }
+        if (isTrk1hasTOF) {
+          trk1NSigmaPiTOF = trk1.tofNSigmaPi();
+          if (std::abs(trk1NSigmaPiTOF) > cMaxTOFnSigmaPion)
+            isTrk1Selected = false;
         }
-      }
-      if (isTrk2hasTOF) {
-        trk2NSigmaKaTOF = trk2.tofNSigmaKa();
+        // For Kaon candidate, we need to apply pT-dependent PID cuts
         if (lengthOfkaonTPCPIDpTintv > 0) {
           for (int i = 0; i < lengthOfkaonTPCPIDpTintv; i++) {
-            if (trk2ptKa < vKaonTOFPIDpTintv[i]) {
-              if (std::abs(trk2NSigmaKaTOF) > vKaonTOFPIDcuts[i])
+            if (trk2ptKa < vKaonTPCPIDpTintv[i]) {
+              if (std::abs(trk2NSigmaKaTPC) > vKaonTPCPIDcuts[i])
                 isTrk2Selected = false;
             }
           }
         }
-      }
-
-      //// QA plots before the selection
-      //  --- PID QA Pion
-      histos.fill(HIST("QAbefore/TPC_Nsigma_pi_all"), trk1ptPi, trk1NSigmaPiTPC);
-      if (isTrk1hasTOF) {
-        histos.fill(HIST("QAbefore/TOF_Nsigma_pi_all"), trk1ptPi, trk1NSigmaPiTOF);
-        histos.fill(HIST("QAbefore/TOF_TPC_Map_pi_all"), trk1NSigmaPiTOF, trk1NSigmaPiTPC);
-      }
-      //  --- PID QA Kaon
-      histos.fill(HIST("QAbefore/TPC_Nsigmaka_all"), trk2ptKa, trk2NSigmaKaTPC);
-      if (isTrk1hasTOF) {
-        histos.fill(HIST("QAbefore/TOF_Nsigma_ka_all"), trk2ptKa, trk2NSigmaKaTOF);
-        histos.fill(HIST("QAbefore/TOF_TPC_Mapka_all"), trk2NSigmaKaTOF, trk2NSigmaKaTPC);
-      }
-      histos.fill(HIST("QAbefore/trkpT_pi"), trk1ptPi);
-      histos.fill(HIST("QAbefore/trkpT_ka"), trk2ptKa);
+        if (isTrk2hasTOF) {
+          trk2NSigmaKaTOF = trk2.tofNSigmaKa();
+          if (lengthOfkaonTPCPIDpTintv > 0) {
+            for (int i = 0; i < lengthOfkaonTPCPIDpTintv; i++) {
+              if (trk2ptKa < vKaonTOFPIDpTintv[i]) {
+                if (std::abs(trk2NSigmaKaTOF) > vKaonTOFPIDcuts[i])
+                  isTrk2Selected = false;
+              }
+            }
+          }
+        }
 
-      //// Apply the selection
-      if (!isTrk1Selected || !isTrk2Selected)
-        continue;
+        //// QA plots before the selection
+        //  --- PID QA Pion
+        histos.fill(HIST("QAbefore/TPC_Nsigma_pi_all"), trk1ptPi, trk1NSigmaPiTPC);
+        if (isTrk1hasTOF) {
+          histos.fill(HIST("QAbefore/TOF_Nsigma_pi_all"), trk1ptPi, trk1NSigmaPiTOF);
+          histos.fill(HIST("QAbefore/TOF_TPC_Map_pi_all"), trk1NSigmaPiTOF, trk1NSigmaPiTPC);
+        }
+        //  --- PID QA Kaon
+        histos.fill(HIST("QAbefore/TPC_Nsigmaka_all"), trk2ptKa, trk2NSigmaKaTPC);
+        if (isTrk1hasTOF) {
+          histos.fill(HIST("QAbefore/TOF_Nsigma_ka_all"), trk2ptKa, trk2NSigmaKaTOF);
+          histos.fill(HIST("QAbefore/TOF_TPC_Mapka_all"), trk2NSigmaKaTOF, trk2NSigmaKaTPC);
+        }
+        histos.fill(HIST("QAbefore/trkpT_pi"), trk1ptPi);
+        histos.fill(HIST("QAbefore/trkpT_ka"), trk2ptKa);
 
-      //// QA plots after the selection
-      //  --- PID QA Pion
-      histos.fill(HIST("QAafter/TPC_Nsigma_pi_all"), trk1ptPi, trk1NSigmaPiTPC);
-      if (isTrk1hasTOF) {
-        histos.fill(HIST("QAafter/TOF_Nsigma_pi_all"), trk1ptPi, trk1NSigmaPiTOF);
-        histos.fill(HIST("QAafter/TOF_TPC_Map_pi_all"), trk1NSigmaPiTOF, trk1NSigmaPiTPC);
-      }
-      //  --- PID QA Kaon
-      histos.fill(HIST("QAafter/TPC_Nsigmaka_all"), trk2ptKa, trk2NSigmaKaTPC);
-      if (isTrk1hasTOF) {
-        histos.fill(HIST("QAafter/TOF_Nsigma_ka_all"), trk2ptKa, trk2NSigmaKaTOF);
-        histos.fill(HIST("QAafter/TOF_TPC_Mapka_all"), trk2NSigmaKaTOF, trk2NSigmaKaTPC);
-      }
-      histos.fill(HIST("QAafter/trkpT_pi"), trk1ptPi);
-      histos.fill(HIST("QAafter/trkpT_ka"), trk2ptKa);
+        //// Apply the selection
+        if (!isTrk1Selected || !isTrk2Selected)
+          continue;
 
-      //// Resonance reconstruction
-      lDecayDaughter1.SetXYZM(trk1.px(), trk1.py(), trk1.pz(), massPi);
-      lDecayDaughter2.SetXYZM(trk2.px(), trk2.py(), trk2.pz(), massKa);
-      lResonance = lDecayDaughter1 + lDecayDaughter2;
-      // Rapidity cut
-      if (lResonance.Rapidity() > 0.5 || lResonance.Rapidity() < -0.5)
-        continue;
-      //// Un-like sign pair only
-      if (trk1.sign() * trk2.sign() < 0) {
-        if constexpr (!IsMix) {
-          histos.fill(HIST("k892invmassDS"), lResonance.M());
-          histos.fill(HIST("h3k892invmassDS"), collision.multV0M(), lResonance.Pt(), lResonance.M()); // TODO: multV0M has to be updatde.
-        } else {
-          histos.fill(HIST("k892invmassME"), lResonance.M());
-          histos.fill(HIST("h3k892invmassME"), collision.multV0M(), lResonance.Pt(), lResonance.M()); // TODO: multV0M has to be updatde.
+        //// QA plots after the selection
+        //  --- PID QA Pion
+        histos.fill(HIST("QAafter/TPC_Nsigma_pi_all"), trk1ptPi, trk1NSigmaPiTPC);
+        if (isTrk1hasTOF) {
+          histos.fill(HIST("QAafter/TOF_Nsigma_pi_all"), trk1ptPi, trk1NSigmaPiTOF);
+          histos.fill(HIST("QAafter/TOF_TPC_Map_pi_all"), trk1NSigmaPiTOF, trk1NSigmaPiTPC);
+        }
+        //  --- PID QA Kaon
+        histos.fill(HIST("QAafter/TPC_Nsigmaka_all"), trk2ptKa, trk2NSigmaKaTPC);
+        if (isTrk1hasTOF) {
+          histos.fill(HIST("QAafter/TOF_Nsigma_ka_all"), trk2ptKa, trk2NSigmaKaTOF);
+          histos.fill(HIST("QAafter/TOF_TPC_Mapka_all"), trk2NSigmaKaTOF, trk2NSigmaKaTPC);
         }
+        histos.fill(HIST("QAafter/trkpT_pi"), trk1ptPi);
+        histos.fill(HIST("QAafter/trkpT_ka"), trk2ptKa);
 
-        // MC
-        if constexpr (IsMC) {
-          if (abs(trk1.pdgCode()) != kPiPlus || abs(trk2.pdgCode()) != kKPlus)
-            continue;
-          auto mother1 = trk1.motherId();
-          auto mother2 = trk2.motherId();
-          if (mother1 == mother2) {             // Same mother
-            if (abs(trk1.motherPDG()) == 313) { // k892(0)
-              histos.fill(HIST("reconk892pt"), lResonance.Pt());
-              histos.fill(HIST("reconk892invmass"), lResonance.M());
-              histos.fill(HIST("h3recok892invmass"), collision.multV0M(), lResonance.Pt(), lResonance.M()); // TODO: multV0M has to be updatde.
+        //// Resonance reconstruction
+        lDecayDaughter1.SetXYZM(trk1.px(), trk1.py(), trk1.pz(), massPi);
+        lDecayDaughter2.SetXYZM(trk2.px(), trk2.py(), trk2.pz(), massKa);
+        lResonance = lDecayDaughter1 + lDecayDaughter2;
+        // Rapidity cut
+        if (lResonance.Rapidity() > 0.5 || lResonance.Rapidity() < -0.5)
+          continue;
+        //// Un-like sign pair only
+        if (trk1.sign() * trk2.sign() < 0) {
+          if constexpr (!IsMix) {
+            histos.fill(HIST("k892invmassDS"), lResonance.M());
+            histos.fill(HIST("h3k892invmassDS"), collision.multV0M(), lResonance.Pt(), lResonance.M()); // TODO: multV0M has to be updatde.
+          } else {
+            histos.fill(HIST("k892invmassME"), lResonance.M());
+            histos.fill(HIST("h3k892invmassME"), collision.multV0M(), lResonance.Pt(), lResonance.M()); // TODO: multV0M has to be updatde.
+          }
+
+          // MC
+          if constexpr (IsMC) {
+            if (abs(trk1.pdgCode()) != kPiPlus || abs(trk2.pdgCode()) != kKPlus)
+              continue;
+            auto mother1 = trk1.motherId();
+            auto mother2 = trk2.motherId();
+            if (mother1 == mother2) {             // Same mother
+              if (abs(trk1.motherPDG()) == 313) { // k892(0)
+                histos.fill(HIST("reconk892pt"), lResonance.Pt());
+                histos.fill(HIST("reconk892invmass"), lResonance.M());
+                histos.fill(HIST("h3recok892invmass"), collision.multV0M(), lResonance.Pt(), lResonance.M()); // TODO: multV0M has to be updatde.
+              }
             }
           }
-        }
-      } else {
-        if constexpr (!IsMix) {
-          histos.fill(HIST("k892invmassLS"), lResonance.M());
-          histos.fill(HIST("h3k892invmassLS"), collision.multV0M(), lResonance.Pt(), lResonance.M()); // TODO: multV0M has to be updatde.
+        } else {
+          if constexpr (!IsMix) {
+            histos.fill(HIST("k892invmassLS"), lResonance.M());
+            histos.fill(HIST("h3k892invmassLS"), collision.multV0M(), lResonance.Pt(), lResonance.M()); // TODO: multV0M has to be updatde.
+          }
         }
       }
     }
@@ -348,20 +353,27 @@ struct k892analysis {
   // Processing Event Mixing
   using BinningTypeVetZTPCtemp = ColumnBinningPolicy<aod::collision::PosZ, aod::resocollision::MultTPCtemp>; // TODO: MultTPCtemp has to be updatde.
   BinningTypeVetZTPCtemp colBinning{{CfgVtxBins, CfgMultBins}, true};
+  /// Mixes each collision with the last nEvtMixing collisions of its bin
+  /// The tracks of each collision are selected and stored in the mixing pools once, instead of for each pair of collisions
   void processME(o2::aod::ResoCollisions& collisions, aod::ResoTracks const& resotracks)
   {
     LOGF(debug, "Event Mixing Started");
-    auto tracksTuple = std::make_tuple(resotracks);
-    SameKindPair<aod::ResoCollisions, aod::ResoTracks, BinningTypeVetZTPCtemp> pairs{colBinning, nEvtMixing, -1, collisions, tracksTuple, &cache}; // -1 is the number of the bin to skip
-
-    TLorentzVector lDecayDaughter1, lDecayDaughter2, lResonance;
-    for (auto& [collision1, tracks1, collision2, tracks2] : pairs) {
-      Partition<aod::ResoTracks> selectedTracks1 = (o2::aod::track::pt > static_cast<float_t>(cMinPtcut)) && (nabs(o2::aod::track::dcaZ) > static_cast<float_t>(cMinDCAzToPVcut)) && (nabs(o2::aod::track::dcaZ) < static_cast<float_t>(cMaxDCAzToPVcut)) && (nabs(o2::aod::track::dcaXY) < static_cast<float_t>(cMaxDCArToPVcut)); // Basic DCA cuts
-      selectedTracks1.bindTable(tracks1);
-      Partition<aod::ResoTracks> selectedTracks2 = (o2::aod::track::pt > static_cast<float_t>(cMinPtcut)) && (nabs(o2::aod::track::dcaZ) > static_cast<float_t>(cMinDCAzToPVcut)) && (nabs(o2::aod::track::dcaZ) < static_cast<float_t>(cMaxDCAzToPVcut)) && (nabs(o2::aod::track::dcaXY) < static_cast<float_t>(cMaxDCArToPVcut)); // Basic DCA cuts
-      selectedTracks2.bindTable(tracks2);
+    Partition<aod::ResoTracks> selectedTracks = (o2::aod::track::pt > static_cast<float_t>(cMinPtcut)) && (nabs(o2::aod::track::dcaZ) > static_cast<float_t>(cMinDCAzToPVcut)) && (nabs(o2::aod::track::dcaZ) < static_cast<float_t>(cMaxDCAzToPVcut)) && (nabs(o2::aod::track::dcaXY) < static_cast<float_t>(cMaxDCArToPVcut)); // Basic DCA cuts
+    selectedTracks.bindTable(resotracks);
 
-      fillHistograms<false, true>(collision1, selectedTracks1, selectedTracks2);
+    eventMixer.reset();
+    for (auto& collision : collisions) {
+      const int bin = colBinning.getBin({collision.posZ(), collision.multTPCtemp()});
+      if (bin < 0) {
+        continue;
+      }
+      auto& event = eventMixer.newEvent(bin, collision.multV0M());
+      for (auto& track : selectedTracks->sliceByCached(aod::resodaughter::resoCollisionId, collision.globalIndex(), cache)) {
+        event.addTrack(track);
+      }
+      eventMixer.mixEvent(bin, [&](const o2::pwglf::ResonanceEventMixer::Event& pooled, const o2::pwglf::ResonanceEventMixer::Event& current) {
+        fillHistograms<false, true>(pooled, pooled.tracks, current.tracks);
+      });
     }
   };
   PROCESS_SWITCH(k892analysis, processME, "Process EventMixing", false);
@@ -17,6 +17,7 @@
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
 #include "PWGLF/DataModel/LFResonanceTables.h"
+#include "PWGLF/Utils/resonanceEventMixer.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -68,6 +69,7 @@ struct lambda1520analysis {
 
   /// Event Mixing
   Configurable<int> nEvtMixing{"nEvtMixing", 5, "Number of events to mix"};
+  o2::pwglf::ResonanceEventMixer eventMixer;
   ConfigurableAxis CfgVtxBins{"CfgVtxBins", {VARIABLE_WIDTH, -10.0f, -8.f, -6.f, -4.f, -2.f, 0.f, 2.f, 4.f, 6.f, 8.f, 10.f}, "Mixing bins - z-vertex"};
   ConfigurableAxis CfgMultBins{"CfgMultBins", {VARIABLE_WIDTH, 0.0f, 10.0f, 20.0f, 30.0f, 40.0f, 50.0f, 60.0f, 70.0f, 80.0f, 90.0f, 100.0f}, "Mixing bins - multiplicity"};
 
@@ -82,6 +84,7 @@ struct lambda1520analysis {
 
   void init(o2::framework::InitContext&)
   {
+    eventMixer.init(nEvtMixing);
     // axes
     AxisSpec axisPt{binsPt, "#it{p}_{T} (GeV/#it{c})"};
     AxisSpec axisEta{binsEta, ""};
@@ -207,230 +210,232 @@ struct lambda1520analysis {
     auto vProtonTOFPIDcuts = static_cast<std::vector<double>>(protonTOFPIDcuts);
     auto lengthOfprotonTPCPIDpTintv = static_cast<int>(vProtonTPCPIDpTintv.size());
 
-    for (auto& [trk1, trk2] : combinations(CombinationsFullIndexPolicy(dTracks1, dTracks2))) {
-      // Full index policy is needed to consider all possible combinations
-      if (trk1.index() == trk2.index())
-        continue; // We need to run (0,1), (1,0) pairs as well. but same id pairs are not needed.
-
-      //// Initialize variables
-      // Trk1: Proton, Trk2: Kaon
-      bool isTrk1Selected{true}, isTrk2Selected{true}, isTrk1hasTOF{false}, isTrk2hasTOF{false};
-      auto trk1ptPr = trk1.pt();
-      auto trk1NSigmaPrTPC = trk1.tpcNSigmaPr();
-      auto trk1NSigmaPrTOF = -999.;
-      auto trk2ptKa = trk2.pt();
-      auto trk2NSigmaKaTPC = trk2.tpcNSigmaKa();
-      auto trk2NSigmaKaTOF = -999.;
-
-      // hasTOF?
-      if ((trk1.tofPIDselectionFlag() & aod::resodaughter::kHasTOF) == aod::resodaughter::kHasTOF) {
-        isTrk1hasTOF = true;
-      }
-      if ((trk2.tofPIDselectionFlag() & aod::resodaughter::kHasTOF) == aod::resodaughter::kHasTOF) {
-        isTrk2hasTOF = true;
-      }
+    for (auto& trk1 : dTracks1) {
+      for (auto& trk2 : dTracks2) {
+        // All the ordered pairs are needed, the two tracks take different mass hypotheses
+        if (trk1.index() == trk2.index())
+          continue; // We need to run (0,1), (1,0) pairs as well. but same id pairs are not needed.
+
+        //// Initialize variables
+        // Trk1: Proton, Trk2: Kaon
+        bool isTrk1Selected{true}, isTrk2Selected{true}, isTrk1hasTOF{false}, isTrk2hasTOF{false};
+        auto trk1ptPr = trk1.pt();
+        auto trk1NSigmaPrTPC = trk1.tpcNSigmaPr();
+        auto trk1NSigmaPrTOF = -999.;
+        auto trk2ptKa = trk2.pt();
+        auto trk2NSigmaKaTPC = trk2.tpcNSigmaKa();
+        auto trk2NSigmaKaTOF = -999.;
+
+        // hasTOF?
+        if ((trk1.tofPIDselectionFlag() & aod::resodaughter::kHasTOF) == aod::resodaughter::kHasTOF) {
+          isTrk1hasTOF = true;
+        }
+        if ((trk2.tofPIDselectionFlag() & aod::resodaughter::kHasTOF) == aod::resodaughter::kHasTOF) {
+          isTrk2hasTOF = true;
+        }
 
-      //// PID selections
-      // For Proton candidate:
-      if (IsptIndependentProtonCut) {
-        // to apply pT-independent PID cuts
-        if (isTrk1hasTOF) {
-          trk1NSigmaPrTOF = trk1.tofNSigmaPr();
-          if (std::abs(trk1NSigmaPrTOF) > cMaxTOFnSigmaProton)
-            isTrk1Selected = false;
-          if (std::abs(trk1NSigmaPrTPC) > cMaxTPCnSigmaProtonVETO)
-            isTrk1Selected = false;
+        //// PID selections
+        // For Proton candidate:
+        if (IsptIndependentProtonCut) {
+          // to apply pT-independent PID cuts
+          if (isTrk1hasTOF) {
+            trk1NSigmaPrTOF = trk1.tofNSigmaPr();
+            if (std::abs(trk1NSigmaPrTOF) > cMaxTOFnSigmaProton)
+              isTrk1Selected = false;
+            if (std::abs(trk1NSigmaPrTPC) > cMaxTPCnSigmaProtonVETO)
+              isTrk1Selected = false;
+          } else {
+            if (std::abs(trk1NSigmaPrTPC) > cMaxTPCnSigmaProton)
+              isTrk1Selected = false;
+          }
         } else {
-          if (std::abs(trk1NSigmaPrTPC) > cMaxTPCnSigmaProton)
-            isTrk1Selected = false;
-        }
-      } else {
-        // to apply pT-dependent PID cuts
-        if (isTrk1hasTOF) {
-          trk1NSigmaPrTOF = trk1.tofNSigmaPr();
-          if (lengthOfprotonTPCPIDpTintv > 0) {
-            for (int i = 0; i < lengthOfprotonTPCPIDpTintv; i++) {
-              if (trk1ptPr < vProtonTOFPIDpTintv[i]) {
-                if (std::abs(trk1NSigmaPrTOF) > vProtonTOFPIDcuts[i])
-                  isTrk1Selected = false;
-                if (std::abs(trk1NSigmaPrTPC) > cMaxTPCnSigmaProtonVETO)
-                  isTrk1Selected = false;
+          // to apply pT-dependent PID cuts
+          if (isTrk1hasTOF) {
+            trk1NSigmaPrTOF = trk1.tofNSigmaPr();
+            if (lengthOfprotonTPCPIDpTintv > 0) {
+              for (int i = 0; i < lengthOfprotonTPCPIDpTintv; i++) {
+                if (trk1ptPr < vProtonTOFPIDpTintv[i]) {
+                  if (std::abs(trk1NSigmaPrTOF) > vProtonTOFPIDcuts[i])
+                    isTrk1Selected = false;
+                  if (std::abs(trk1NSigmaPrTPC) > cMaxTPCnSigmaProtonVETO)
+                    isTrk1Selected = false;
+                }
               }
             }
-          }
-        } else {
-          if (lengthOfprotonTPCPIDpTintv > 0) {
-            for (int i = 0; i < lengthOfprotonTPCPIDpTintv; i++) {
-              if (trk1ptPr > vProtonTPCPIDpTintv[i]) {
-                if (std::abs(trk1NSigmaPrTPC) > vProtonTPCPIDcuts[i])
-                  isTrk1Selected = false;
+          } else {
+            if (lengthOfprotonTPCPIDpTintv > 0) {
+              for (int i = 0; i < lengthOfprotonTPCPIDpTintv; i++) {
+                if (trk1ptPr > vProtonTPCPIDpTintv[i]) {
+                  if (std::abs(trk1NSigmaPrTPC) > vProtonTPCPIDcuts[i])
+                    isTrk1Selected = false;
+                }
               }
             }
           }
         }
-      }
 
-      // For Kaon candidate:
-      // to apply pT-independent PID cuts
-      if (IsptIndependentKaonCut) {
-        if (isTrk2hasTOF) {
-          trk2NSigmaKaTOF = trk2.tofNSigmaKa();
-          if (std::abs(trk2NSigmaKaTOF) > cMaxTOFnSigmaKaon)
-            isTrk2Selected = false;
-          if (std::abs(trk2NSigmaKaTPC) > cMaxTPCnSigmaKaonVETO)
-            isTrk2Selected = false;
+        // For Kaon candidate:
+        // to apply pT-independent PID cuts
+        if (IsptIndependentKaonCut) {
+          if (isTrk2hasTOF) {
+            trk2NSigmaKaTOF = trk2.tofNSigmaKa();
+            if (std::abs(trk2NSigmaKaTOF) > cMaxTOFnSigmaKaon)
+              isTrk2Selected = false;
+            if (std::abs(trk2NSigmaKaTPC) > cMaxTPCnSigmaKaonVETO)
+              isTrk2Selected = false;
+          } else {
+            if (std::abs(trk2NSigmaKaTPC) > cMaxTPCnSigmaKaon)
+              isTrk2Selected = false;
+          }
         } else {
-          if (std::abs(trk2NSigmaKaTPC) > cMaxTPCnSigmaKaon)
-            isTrk2Selected = false;
-        }
-      } else {
-        // to apply pT-dependent PID cuts
-        if (isTrk2hasTOF) {
-          trk2NSigmaKaTOF = trk2.tofNSigmaKa();
-          if (lengthOfkaonTPCPIDpTintv > 0) {
-            for (int i = 0; i < lengthOfkaonTPCPIDpTintv; i++) {
-              if (trk2ptKa < vKaonTOFPIDpTintv[i]) {
-                if (std::abs(trk2NSigmaKaTOF) > vKaonTOFPIDcuts[i])
-                  isTrk2Selected = false;
-                if (std::abs(trk2NSigmaKaTPC) > cMaxTPCnSigmaKaonVETO)
-                  isTrk2Selected = false;
+          // to apply pT-dependent PID cuts
+          if (isTrk2hasTOF) {
+            trk2NSigmaKaTOF = trk2.tofNSigmaKa();
+            if (lengthOfkaonTPCPIDpTintv > 0) {
+              for (int i = 0; i < lengthOfkaonTPCPIDpTintv; i++) {
+                if (trk2ptKa < vKaonTOFPIDpTintv[i]) {
+                  if (std::abs(trk2NSigmaKaTOF) > vKaonTOFPIDcuts[i])
+                    isTrk2Selected = false;
+                  if (std::abs(trk2NSigmaKaTPC) > cMaxTPCnSigmaKaonVETO)
+                    isTrk2Selected = false;
+                }
               }
             }
-          }
-        } else {
-          if (lengthOfkaonTPCPIDpTintv > 0) {
-            for (int i = 0; i < lengthOfkaonTPCPIDpTintv; i++) {
-              if (trk2ptKa > vKaonTPCPIDpTintv[i]) {
-                if (std::abs(trk2NSigmaKaTPC) > vKaonTPCPIDcuts[i])
-                  isTrk2Selected = false;
+          } else {
+            if (lengthOfkaonTPCPIDpTintv > 0) {
+              for (int i = 0; i < lengthOfkaonTPCPIDpTintv; i++) {
+                if (trk2ptKa > vKaonTPCPIDpTintv[i]) {
+                  if (std::abs(trk2NSigmaKaTPC) > vKaonTPCPIDcuts[i])
+                    isTrk2Selected = false;
+                }
               }
             }
           }
         }
-      }
 
-      //// QA plots before the selection
-      //  --- Track QA all
-      histos.fill(HIST("QA/QAbefore/Track/TPC_Nsigma_pr_all"), trk1ptPr, trk1NSigmaPrTPC);
-      if (isTrk1hasTOF) {
-        histos.fill(HIST("QA/QAbefore/Track/TOF_Nsigma_pr_all"), trk1ptPr, trk1NSigmaPrTOF);
-        histos.fill(HIST("QA/QAbefore/Track/TOF_TPC_Map_pr_all"), trk1NSigmaPrTOF, trk1NSigmaPrTPC);
-      }
-      histos.fill(HIST("QA/QAbefore/Track/TPC_Nsigma_ka_all"), trk2ptKa, trk2NSigmaKaTPC);
-      if (isTrk2hasTOF) {
-        histos.fill(HIST("QA/QAbefore/Track/TOF_Nsigma_ka_all"), trk2ptKa, trk2NSigmaKaTOF);
-        histos.fill(HIST("QA/QAbefore/Track/TOF_TPC_Map_ka_all"), trk2NSigmaKaTOF, trk2NSigmaKaTPC);
-      }
+        //// QA plots before the selection
+        //  --- Track QA all
+        histos.fill(HIST("QA/QAbefore/Track/TPC_Nsigma_pr_all"), trk1ptPr, trk1NSigmaPrTPC);
+        if (isTrk1hasTOF) {
+          histos.fill(HIST("QA/QAbefore/Track/TOF_Nsigma_pr_all"), trk1ptPr, trk1NSigmaPrTOF);
+          histos.fill(HIST("QA/QAbefore/Track/TOF_TPC_Map_pr_all"), trk1NSigmaPrTOF, trk1NSigmaPrTPC);
+        }
+        histos.fill(HIST("QA/QAbefore/Track/TPC_Nsigma_ka_all"), trk2ptKa, trk2NSigmaKaTPC);
+        if (isTrk2hasTOF) {
+          histos.fill(HIST("QA/QAbefore/Track/TOF_Nsigma_ka_all"), trk2ptKa, trk2NSigmaKaTOF);
+          histos.fill(HIST("QA/QAbefore/Track/TOF_TPC_Map_ka_all"), trk2NSigmaKaTOF, trk2NSigmaKaTPC);
+        }
 
-      histos.fill(HIST("QA/QAbefore/Track/dcaZ"), trk1ptPr, trk1.dcaZ());
-      histos.fill(HIST("QA/QAbefore/Track/dcaXY"), trk1ptPr, trk1.dcaXY());
-      histos.fill(HIST("QA/QAbefore/Track/TPC_CR"), trk1ptPr, trk1.tpcNClsCrossedRows());
-      histos.fill(HIST("QA/QAbefore/Track/pT"), trk1ptPr);
-      histos.fill(HIST("QA/QAbefore/Track/eta"), trk1.eta());
+        histos.fill(HIST("QA/QAbefore/Track/dcaZ"), trk1ptPr, trk1.dcaZ());
+        histos.fill(HIST("QA/QAbefore/Track/dcaXY"), trk1ptPr, trk1.dcaXY());
+        histos.fill(HIST("QA/QAbefore/Track/TPC_CR"), trk1ptPr, trk1.tpcNClsCrossedRows());
+        histos.fill(HIST("QA/QAbefore/Track/pT"), trk1ptPr);
+        histos.fill(HIST("QA/QAbefore/Track/eta"), trk1.eta());
 
-      // apply the track cut
-      if (!trackCut(trk1) || !trackCut(trk2))
-        continue;
+        // apply the track cut
+        if (!trackCut(trk1) || !trackCut(trk2))
+          continue;
 
-      //// Apply the pid selection
-      if (!isTrk1Selected || !isTrk2Selected)
-        continue;
+        //// Apply the pid selection
+        if (!isTrk1Selected || !isTrk2Selected)
+          continue;
 
-      //// QA plots after the selection
-      //  --- PID QA Proton
-      histos.fill(HIST("QA/QAafter/Proton/TPC_Nsigma_pr_all"), trk1ptPr, trk1NSigmaPrTPC);
-      if (isTrk1hasTOF) {
-        histos.fill(HIST("QA/QAafter/Proton/TOF_Nsigma_pr_all"), trk1ptPr, trk1NSigmaPrTOF);
-        histos.fill(HIST("QA/QAafter/Proton/TOF_TPC_Map_pr_all"), trk1NSigmaPrTOF, trk1NSigmaPrTPC);
-      }
-      if (!isTrk1hasTOF) {
-        histos.fill(HIST("QA/QAafter/Proton/TPC_Nsigma_pr_TPConly"), trk1ptPr, trk1NSigmaPrTPC);
-      }
-      histos.fill(HIST("QA/QAafter/Proton/dcaZ"), trk1ptPr, trk1.dcaZ());
-      histos.fill(HIST("QA/QAafter/Proton/dcaXY"), trk1ptPr, trk1.dcaXY());
-      histos.fill(HIST("QA/QAafter/Proton/TPC_CR"), trk1ptPr, trk1.tpcNClsCrossedRows());
-      histos.fill(HIST("QA/QAafter/Proton/pT"), trk1ptPr);
-      histos.fill(HIST("QA/QAafter/Proton/eta"), trk1.eta());
-
-      //  --- PID QA Kaon
-      histos.fill(HIST("QA/QAafter/Kaon/TPC_Nsigma_ka_all"), trk2ptKa, trk2NSigmaKaTPC);
-      if (isTrk2hasTOF) {
-        histos.fill(HIST("QA/QAafter/Kaon/TOF_Nsigma_ka_all"), trk2ptKa, trk2NSigmaKaTOF);
-        histos.fill(HIST("QA/QAafter/Kaon/TOF_TPC_Map_ka_all"), trk2NSigmaKaTOF, trk2NSigmaKaTPC);
-      }
-      if (!isTrk2hasTOF) {
-        histos.fill(HIST("QA/QAafter/Kaon/TPC_Nsigma_ka_TPConly"), trk2ptKa, trk2NSigmaKaTPC);
-      }
-      histos.fill(HIST("QA/QAafter/Kaon/dcaZ"), trk2ptKa, trk2.dcaZ());
-      histos.fill(HIST("QA/QAafter/Kaon/dcaXY"), trk2ptKa, trk2.dcaXY());
-      histos.fill(HIST("QA/QAafter/Kaon/TPC_CR"), trk2ptKa, trk2.tpcNClsCrossedRows());
-      histos.fill(HIST("QA/QAafter/Kaon/pT"), trk2ptKa);
-      histos.fill(HIST("QA/QAafter/Kaon/eta"), trk2.eta());
-
-      //// Resonance reconstruction
-      lDecayDaughter1.SetXYZM(trk1.px(), trk1.py(), trk1.pz(), massPr);
-      lDecayDaughter2.SetXYZM(trk2.px(), trk2.py(), trk2.pz(), massKa);
-      lResonance = lDecayDaughter1 + lDecayDaughter2;
-      // Rapidity cut
-      if (lResonance.Rapidity() > 0.5 || lResonance.Rapidity() < -0.5)
-        continue;
-      //// Un-like sign pair only
-      if (trk1.sign() * trk2.sign() < 0) {
-        if constexpr (!IsMix) {
-          histos.fill(HIST("Result/Data/lambda1520invmass"), lResonance.M());
-          histos.fill(HIST("Result/Data/h3lambda1520invmass"), collision.multV0M(), lResonance.Pt(), lResonance.M());
-          if (isEtaAssym && trk1.eta() > 0.2 && trk1.eta() < 0.8 && trk2.eta() > 0.2 && trk2.eta() < 0.8) { // Eta-range will be updated
-            histos.fill(HIST("Result/Data/hlambda1520invmassUnlikeSignAside"), lResonance.M());
-            histos.fill(HIST("Result/Data/h3lambda1520invmassUnlikeSignAside"), collision.multV0M(), lResonance.Pt(), lResonance.M());
-          } else if (isEtaAssym && trk1.eta() > -0.6 && trk1.eta() < 0.0 && trk2.eta() > -0.6 && trk2.eta() < 0.0) { // Eta-range will be updated
-            histos.fill(HIST("Result/Data/hlambda1520invmassUnlikeSignCside"), lResonance.M());
-            histos.fill(HIST("Result/Data/h3lambda1520invmassUnlikeSignCside"), collision.multV0M(), lResonance.Pt(), lResonance.M());
-          }
-        } else {
-          histos.fill(HIST("Result/Data/lambda1520invmassME"), lResonance.M());
-          histos.fill(HIST("Result/Data/h3lambda1520invmassME"), collision.multV0M(), lResonance.Pt(), lResonance.M());
-          if (isEtaAssym && trk1.eta() > 0.2 && trk1.eta() < 0.8 && trk2.eta() > 0.2 && trk2.eta() < 0.8) { // Eta-range will be updated
-            histos.fill(HIST("Result/Data/hlambda1520invmassMixedAside"), lResonance.M());
-            histos.fill(HIST("Result/Data/h3lambda1520invmassMixedAside"), collision.multV0M(), lResonance.Pt(), lResonance.M());
-          } else if (isEtaAssym && trk1.eta() > -0.6 && trk1.eta() < 0.0 && trk2.eta() > -0.6 && trk2.eta() < 0.0) { // Eta-range will be updated
-            histos.fill(HIST("Result/Data/hlambda1520invmassMixedCside"), lResonance.M());
-            histos.fill(HIST("Result/Data/h3lambda1520invmassMixedCside"), collision.multV0M(), lResonance.Pt(), lResonance.M());
-          }
+        //// QA plots after the selection
+        //  --- PID QA Proton
+        histos.fill(HIST("QA/QAafter/Proton/TPC_Nsigma_pr_all"), trk1ptPr, trk1NSigmaPrTPC);
+        if (isTrk1hasTOF) {
+          histos.fill(HIST("QA/QAafter/Proton/TOF_Nsigma_pr_all"), trk1ptPr, trk1NSigmaPrTOF);
+          histos.fill(HIST("QA/QAafter/Proton/TOF_TPC_Map_pr_all"), trk1NSigmaPrTOF, trk1NSigmaPrTPC);
         }
-
-        // MC
-        if constexpr (IsMC) {
-          if (abs(trk1.pdgCode()) != kProton || abs(trk2.pdgCode()) != kKPlus)
-            continue;
-          auto mother1 = trk1.motherId();
-          auto mother2 = trk2.motherId();
-          if (mother1 == mother2) {              // Same mother
-            if (abs(trk1.motherPDG()) == 3124) { // lambda1520(0)
-              histos.fill(HIST("Result/MC/reconlambda1520pt"), lResonance.Pt());
-              histos.fill(HIST("Result/MC/reconlambda1520invmass"), lResonance.M());
-              histos.fill(HIST("Result/MC/h3recolambda1520invmass"), collision.multV0M(), lResonance.Pt(), lResonance.M());
-            }
-          }
+        if (!isTrk1hasTOF) {
+          histos.fill(HIST("QA/QAafter/Proton/TPC_Nsigma_pr_TPConly"), trk1ptPr, trk1NSigmaPrTPC);
         }
-      } else {
-        if constexpr (!IsMix) {
-          if (isEtaAssym && trk1.eta() > 0.2 && trk1.eta() < 0.8 && trk2.eta() > 0.2 && trk2.eta() < 0.8) { // Eta-range will be updated
-            histos.fill(HIST("Result/Data/hlambda1520invmassLikeSignAside"), lResonance.M());
-            histos.fill(HIST("Result/Data/h3lambda1520invmassLikeSignAside"), collision.multV0M(), lResonance.Pt(), lResonance.M());
-          } else if (isEtaAssym && trk1.eta() > -0.6 && trk1.eta() < 0.0 && trk2.eta() > -0.6 && trk2.eta() < 0.0) { // Eta-range will be updated
-            histos.fill(HIST("Result/Data/hlambda1520invmassLikeSignCside"), lResonance.M());
-            histos.fill(HIST("Result/Data/h3lambda1520invmassLikeSignCside"), collision.multV0M(), lResonance.Pt(), lResonance.M());
+        histos.fill(HIST("QA/QAafter/Proton/dcaZ"), trk1ptPr, trk1.dcaZ());
+        histos.fill(HIST("QA/QAafter/Proton/dcaXY"), trk1ptPr, trk1.dcaXY());
+        histos.fill(HIST("QA/QAafter/Proton/TPC_CR"), trk1ptPr, trk1.tpcNClsCrossedRows());
+        histos.fill(HIST("QA/QAafter/Proton/pT"), trk1ptPr);
+        histos.fill(HIST("QA/QAafter/Proton/eta"), trk1.eta());
+
+        //  --- PID QA Kaon
+        histos.fill(HIST("QA/QAafter/Kaon/TPC_Nsigma_ka_all"), trk2ptKa, trk2NSigmaKaTPC);
+        if (isTrk2hasTOF) {
+          histos.fill(HIST("QA/QAafter/Kaon/TOF_Nsigma_ka_all"), trk2ptKa, trk2NSigmaKaTOF);
+          histos.fill(HIST("QA/QAafter/Kaon/TOF_TPC_Map_ka_all"), trk2NSigmaKaTOF, trk2NSigmaKaTPC);
+        }
+        if (!isTrk2hasTOF) {
+          histos.fill(HIST("QA/QAafter/Kaon/TPC_Nsigma_ka_TPConly"), trk2ptKa, trk2NSigmaKaTPC);
+        }
+        histos.fill(HIST("QA/QAafter/Kaon/dcaZ"), trk2ptKa, trk2.dcaZ());
+        histos.fill(HIST("QA/QAafter/Kaon/dcaXY"), trk2ptKa, trk2.dcaXY());
+        histos.fill(HIST("QA/QAafter/Kaon/TPC_CR"), trk2ptKa, trk2.tpcNClsCrossedRows());
+        histos.fill(HIST("QA/QAafter/Kaon/pT"), trk2ptKa);
+        histos.fill(HIST("QA/QAafter/Kaon/eta"), trk2.eta());
+
+        //// Resonance reconstruction
+        lDecayDaughter1.SetXYZM(trk1.px(), trk1.py(), trk1.pz(), massPr);
+        lDecayDaughter2.SetXYZM(trk2.px(), trk2.py(), trk2.pz(), massKa);
+        lResonance = lDecayDaughter1 + lDecayDaughter2;
+        // Rapidity cut
+        if (lResonance.Rapidity() > 0.5 || lResonance.Rapidity() < -0.5)
+          continue;
+        //// Un-like sign pair only
+        if (trk1.sign() * trk2.sign() < 0) {
+          if constexpr (!IsMix) {
+            histos.fill(HIST("Result/Data/lambda1520invmass"), lResonance.M());
+            histos.fill(HIST("Result/Data/h3lambda1520invmass"), collision.multV0M(), lResonance.Pt(), lResonance.M());
+            if (isEtaAssym && trk1.eta() > 0.2 && trk1.eta() < 0.8 && trk2.eta() > 0.2 && trk2.eta() < 0.8) { // Eta-range will be updated
+              histos.fill(HIST("Result/Data/hlambda1520invmassUnlikeSignAside"), lResonance.M());
+              histos.fill(HIST("Result/Data/h3lambda1520invmassUnlikeSignAside"), collision.multV0M(), lResonance.Pt(), lResonance.M());
+            } else if (isEtaAssym && trk1.eta() > -0.6 && trk1.eta() < 0.0 && trk2.eta() > -0.6 && trk2.eta() < 0.0) { // Eta-range will be updated
+              histos.fill(HIST("Result/Data/hlambda1520invmassUnlikeSignCside"), lResonance.M());
+              histos.fill(HIST("Result/Data/h3lambda1520invmassUnlikeSignCside"), collision.multV0M(), lResonance.Pt(), lResonance.M());
+            }
+          } else {
+            histos.fill(HIST("Result/Data/lambda1520invmassME"), lResonance.M());
+            histos.fill(HIST("Result/Data/h3lambda1520invmassME"), collision.multV0M(), lResonance.Pt(), lResonance.M());
+            if (isEtaAssym && trk1.eta() > 0.2 && trk1.eta() < 0.8 && trk2.eta() > 0.2 && trk2.eta() < 0.8) { // Eta-range will be updated
+              histos.fill(HIST("Result/Data/hlambda1520invmassMixedAside"), lResonance.M());
+              histos.fill(HIST("Result/Data/h3lambda1520invmassMixedAside"), collision.multV0M(), lResonance.Pt(), lResonance.M());
+            } else if (isEtaAssym && trk1.eta() > -0.6 && trk1.eta() < 0.0 && trk2.eta() > -0.6 && trk2.eta() < 0.0) { // Eta-range will be updated
+              histos.fill(HIST("Result/Data/hlambda1520invmassMixedCside"), lResonance.M());
+              histos.fill(HIST("Result/Data/h3lambda1520invmassMixedCside"), collision.multV0M(), lResonance.Pt(), lResonance.M());
+            }
           }
-          // Like sign pair ++
-          if (trk1.sign() > 0 && trk2.sign() > 0) {
-            histos.fill(HIST("Result/Data/lambda1520invmassLSPP"), lResonance.M());
-            histos.fill(HIST("Result/Data/h3lambda1520invmassLSPP"), collision.multV0M(), lResonance.Pt(), lResonance.M());
+
+          // MC
+          if constexpr (IsMC) {
+            if (abs(trk1.pdgCode()) != kProton || abs(trk2.pdgCode()) != kKPlus)
+              continue;
+            auto mother1 = trk1.motherId();
+            auto mother2 = trk2.motherId();
+            if (mother1 == mother2) {              // Same mother
+              if (abs(trk1.motherPDG()) == 3124) { // lambda1520(0)
+                histos.fill(HIST("Result/MC/reconlambda1520pt"), lResonance.Pt());
+                histos.fill(HIST("Result/MC/reconlambda1520invmass"), lResonance.M());
+                histos.fill(HIST("Result/MC/h3recolambda1520invmass"), collision.multV0M(), lResonance.Pt(), lResonance.M());
+              }
+            }
           }
+        } else {
+          if constexpr (!IsMix) {
+            if (isEtaAssym && trk1.eta() > 0.2 && trk1.eta() < 0.8 && trk2.eta() > 0.2 && trk2.eta() < 0.8) { // Eta-range will be updated
+              histos.fill(HIST("Result/Data/hlambda1520invmassLikeSignAside"), lResonance.M());
+              histos.fill(HIST("Result/Data/h3lambda1520invmassLikeSignAside"), collision.multV0M(), lResonance.Pt(), lResonance.M());
+            } else if (isEtaAssym && trk1.eta() > -0.6 && trk1.eta() < 0.0 && trk2.eta() > -0.6 && trk2.eta() < 0.0) { // Eta-range will be updated
+              histos.fill(HIST("Result/Data/hlambda1520invmassLikeSignCside"), lResonance.M());
+              histos.fill(HIST("Result/Data/h3lambda1520invmassLikeSignCside"), collision.multV0M(), lResonance.Pt(), lResonance.M());
+            }
+            // Like sign pair ++
+            if (trk1.sign() > 0 && trk2.sign() > 0) {
+              histos.fill(HIST("Result/Data/lambda1520invmassLSPP"), lResonance.M());
+              histos.fill(HIST("Result/Data/h3lambda1520invmassLSPP"), collision.multV0M(), lResonance.Pt(), lResonance.M());
+            }
 
-          // Like sign pair --
-          if (trk1.sign() < 0 && trk2.sign() < 0) {
-            histos.fill(HIST("Result/Data/lambda1520invmassLSMM"), lResonance.M());
-            histos.fill(HIST("Result/Data/h3lambda1520invmassLSMM"), collision.multV0M(), lResonance.Pt(), lResonance.M());
+            // Like sign pair --
+            if (trk1.sign() < 0 && trk2.sign() < 0) {
+              histos.fill(HIST("Result/Data/lambda1520invmassLSMM"), lResonance.M());
+              histos.fill(HIST("Result/Data/h3lambda1520invmassLSMM"), collision.multV0M(), lResonance.Pt(), lResonance.M());
+            }
           }
         }
       }
@@ -530,33 +535,41 @@ struct lambda1520analysis {
   // Processing Event Mixing
   using BinningTypeVetZTPCtemp = ColumnBinningPolicy<aod::collision::PosZ, aod::resocollision::MultV0M>;
   BinningTypeVetZTPCtemp colBinning{{CfgVtxBins, CfgMultBins}, true};
+  /// Mixes each collision with the last nEvtMixing collisions of its bin
+  /// The tracks of each collision are selected and stored in the mixing pools once, instead of for each pair of collisions
+  /// \param getTracks returns the tracks of a collision to be mixed
+  template <typename TGetTracks>
+  void doMixing(o2::aod::ResoCollisions& collisions, TGetTracks getTracks)
+  {
+    eventMixer.reset();
+    for (auto& collision : collisions) {
+      const int bin = colBinning.getBin({collision.posZ(), collision.multV0M()});
+      if (bin < 0) {
+        continue;
+      }
+      auto& event = eventMixer.newEvent(bin, collision.multV0M());
+      for (auto& track : getTracks(collision)) {
+        event.addTrack(track);
+      }
+      eventMixer.mixEvent(bin, [&](const o2::pwglf::ResonanceEventMixer::Event& pooled, const o2::pwglf::ResonanceEventMixer::Event& current) {
+        fillHistograms<false, true>(pooled, pooled.tracks, current.tracks);
+      });
+    }
+  }
+
   void processME(o2::aod::ResoCollisions& collisions, aod::ResoTracks const& resotracks)
   {
     LOGF(debug, "Event Mixing Started");
-    auto tracksTuple = std::make_tuple(resotracks);
-    SameKindPair<aod::ResoCollisions, aod::ResoTracks, BinningTypeVetZTPCtemp> pairs{colBinning, nEvtMixing, -1, collisions, tracksTuple, &cache}; // -1 is the number of the bin to skip
-
-    for (auto& [collision1, tracks1, collision2, tracks2] : pairs) {
-      // Kaons
-      Partition<aod::ResoTracks> selectedTracks1 = (o2::aod::track::pt > static_cast<float_t>(cMinPtcut)) && (nabs(o2::aod::track::eta) < static_cast<float_t>(cfgCutEta)) && (nabs(o2::aod::track::dcaZ) > static_cast<float_t>(cMinDCAzToPVcut)) && (nabs(o2::aod::track::dcaZ) < static_cast<float_t>(cMaxDCAzToPVcut)) && (nabs(o2::aod::track::dcaXY) < static_cast<float_t>(cMaxDCArToPVcut)) && (aod::resodaughter::tpcNClsCrossedRows > static_cast<uint8_t>(cMinTPCncr)); // && aod::tracktag::isKaon == true; // Basic DCA cuts
-      selectedTracks1.bindTable(tracks1);
-      // Protons
-      Partition<aod::ResoTracks> selectedTracks2 = (o2::aod::track::pt > static_cast<float_t>(cMinPtcut)) && (nabs(o2::aod::track::eta) < static_cast<float_t>(cfgCutEta)) && (nabs(o2::aod::track::dcaZ) > static_cast<float_t>(cMinDCAzToPVcut)) && (nabs(o2::aod::track::dcaZ) < static_cast<float_t>(cMaxDCAzToPVcut)) && (nabs(o2::aod::track::dcaXY) < static_cast<float_t>(cMaxDCArToPVcut)) && (aod::resodaughter::tpcNClsCrossedRows > static_cast<uint8_t>(cMinTPCncr)); // && aod::tracktag::isProton == true; // Basic DCA cuts
-      selectedTracks2.bindTable(tracks2);
-
-      fillHistograms<false, true>(collision1, selectedTracks1, selectedTracks2);
-    }
+    // Kaons and protons
+    Partition<aod::ResoTracks> selectedTracks = (o2::aod::track::pt > static_cast<float_t>(cMinPtcut)) && (nabs(o2::aod::track::eta) < static_cast<float_t>(cfgCutEta)) && (nabs(o2::aod::track::dcaZ) > static_cast<float_t>(cMinDCAzToPVcut)) && (nabs(o2::aod::track::dcaZ) < static_cast<float_t>(cMaxDCAzToPVcut)) && (nabs(o2::aod::track::dcaXY) < static_cast<float_t>(cMaxDCArToPVcut)) && (aod::resodaughter::tpcNClsCrossedRows > static_cast<uint8_t>(cMinTPCncr)); // Basic DCA cuts
+    selectedTracks.bindTable(resotracks);
+    doMixing(collisions, [&](const auto& collision) { return selectedTracks->sliceByCached(aod::resodaughter::resoCollisionId, collision.globalIndex(), cache); });
   };
   PROCESS_SWITCH(lambda1520analysis, processME, "Process EventMixing with partition", true);
 
   void processMELight(o2::aod::ResoCollisions& collisions, aod::ResoTracks const& resotracks)
   {
-    auto tracksTuple = std::make_tuple(resotracks);
-    SameKindPair<aod::ResoCollisions, aod::ResoTracks, BinningTypeVetZTPCtemp> pairs{colBinning, nEvtMixing, -1, collisions, tracksTuple, &cache}; // -1 is the number of the bin to skip
-
-    for (auto& [collision1, tracks1, collision2, tracks2] : pairs) {
-      fillHistograms<false, true>(collision1, tracks1, tracks2);
-    }
+    doMixing(collisions, [&](const auto& collision) { return resotracks.sliceBy(perResoCollision, collision.globalIndex()); });
   };
   PROCESS_SWITCH(lambda1520analysis, processMELight, "Process EventMixing light without partition", false);
 };
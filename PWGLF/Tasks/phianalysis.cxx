@@ -25,6 +25,7 @@
 #include "Framework/ASoAHelpers.h"
 #include "Framework/runDataProcessing.h"
 #include "PWGLF/DataModel/LFResonanceTables.h"
+#include "PWGLF/Utils/resonanceEventMixer.h"
 #include "DataFormatsParameters/GRPObject.h"
 
 using namespace o2;
@@ -40,6 +41,7 @@ struct phianalysis {
   ConfigurableAxis CfgMultBins{"CfgMultBins", {VARIABLE_WIDTH, 0.0f, 20.0f, 40.0f, 60.0f, 80.0f, 100.0f, 200.0f, 99999.f}, "Mixing bins - multiplicity"};
   ConfigurableAxis CfgVtxBins{"CfgVtxBins", {VARIABLE_WIDTH, -10.0f, -8.f, -6.f, -4.f, -2.f, 0.f, 2.f, 4.f, 6.f, 8.f, 10.f}, "Mixing bins - z-vertex"};
   Configurable<int> nEvtMixing{"nEvtMixing", 5, "Number of events to mix"};
+  o2::pwglf::ResonanceEventMixer eventMixer;
 
   HistogramRegistry histos{"histos", {}, OutputObjHandlingPolicy::AnalysisObject};
   HistogramRegistry qaRegistry{"QAHistos", {}, OutputObjHandlingPolicy::QAObject};
@@ -61,6 +63,7 @@ struct phianalysis {
 
   void init(o2::framework::InitContext&)
   {
+    eventMixer.init(nEvtMixing);
     ccdb->setURL("http://alice-ccdb.cern.ch");
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
@@ -221,48 +224,57 @@ struct phianalysis {
   // Processing Event Mixing
   using BinningTypeVetZTPCtemp = ColumnBinningPolicy<aod::collision::PosZ, aod::resocollision::MultTPCtemp>;
   BinningTypeVetZTPCtemp colBinning{{CfgVtxBins, CfgMultBins}, true};
+  /// Mixes each collision with the last nEvtMixing collisions of its bin
+  /// The tracks of each collision are selected and stored in the mixing pools once, instead of for each pair of collisions
   void processME(o2::aod::ResoCollisions& collisions, aod::ResoTracks const& resotracks)
   {
     LOGF(debug, "Event Mixing Started");
-    auto tracksTuple = std::make_tuple(resotracks);
-    SameKindPair<aod::ResoCollisions, aod::ResoTracks, BinningTypeVetZTPCtemp> pairs{colBinning, nEvtMixing, -1, collisions, tracksTuple, &cache}; // -1 is the number of the bin to skip
+    Partition<aod::ResoTracks> selectedTracks = requireTOFPIDKaonCutInFilter() && (o2::aod::track::pt > static_cast<float_t>(cMinPtcut)) && (nabs(o2::aod::track::dcaZ) > static_cast<float_t>(cMinDCAzToPVcut)) && (nabs(o2::aod::track::dcaZ) < static_cast<float_t>(cMaxDCAzToPVcut)) && (nabs(o2::aod::track::dcaXY) < static_cast<float_t>(cMaxDCArToPVcut)); // Basic DCA cuts
+    selectedTracks.bindTable(resotracks);
 
     TLorentzVector lDecayDaughter1, lDecayDaughter2, lResonance;
-    for (auto& [collision1, tracks1, collision2, tracks2] : pairs) {
-      Partition<aod::ResoTracks> selectedTracks1 = requireTOFPIDKaonCutInFilter() && (o2::aod::track::pt > static_cast<float_t>(cMinPtcut)) && (nabs(o2::aod::track::dcaZ) > static_cast<float_t>(cMinDCAzToPVcut)) && (nabs(o2::aod::track::dcaZ) < static_cast<float_t>(cMaxDCAzToPVcut)) && (nabs(o2::aod::track::dcaXY) < static_cast<float_t>(cMaxDCArToPVcut)); // Basic DCA cuts
-      selectedTracks1.bindTable(tracks1);
-
-      Partition<aod::ResoTracks> selectedTracks2 = requireTOFPIDKaonCutInFilter() && (o2::aod::track::pt > static_cast<float_t>(cMinPtcut)) && (nabs(o2::aod::track::dcaZ) > static_cast<float_t>(cMinDCAzToPVcut)) && (nabs(o2::aod::track::dcaZ) < static_cast<float_t>(cMaxDCAzToPVcut)) && (nabs(o2::aod::track::dcaXY) < static_cast<float_t>(cMaxDCArToPVcut)); // Basic DCA cuts
-      selectedTracks2.bindTable(tracks2);
-
-      for (auto& [trk1, trk2] : combinations(CombinationsFullIndexPolicy(selectedTracks1, selectedTracks2))) {
-        // Un-like sign pair only
-        if (trk1.sign() * trk2.sign() > 0)
-          continue;
-        if ((trk1.pt() < 0.3) && (std::abs(trk1.tpcNSigmaKa()) > 6.0))
-          continue;
-        if ((trk1.pt() >= 0.3) && (trk1.pt() < 0.4) && (std::abs(trk1.tpcNSigmaKa()) > 4.0))
-          continue;
-        if ((trk1.pt() >= 0.4) && (std::abs(trk1.tpcNSigmaKa()) > 2.0))
-          continue;
-
-        if ((trk2.pt() < 0.3) && (std::abs(trk2.tpcNSigmaKa()) > 6.0))
-          continue;
-        if ((trk2.pt() >= 0.3) && (trk2.pt() < 0.4) && (std::abs(trk2.tpcNSigmaKa()) > 4.0))
-          continue;
-        if ((trk2.pt() >= 0.4) && (std::abs(trk2.tpcNSigmaKa()) > 2.0))
-          continue;
-
-        lDecayDaughter1.SetXYZM(trk1.px(), trk1.py(), trk1.pz(), massKa);
-        lDecayDaughter2.SetXYZM(trk2.px(), trk2.py(), trk2.pz(), massKa);
-        lResonance = lDecayDaughter1 + lDecayDaughter2;
-
-        if (lResonance.Rapidity() > 0.5 || lResonance.Rapidity() < -0.5)
-          continue;
-
-        histos.fill(HIST("phiinvmassME"), lResonance.M());
-        histos.fill(HIST("h3phiinvmassME"), collision1.multV0M(), lResonance.Pt(), lResonance.M());
+    eventMixer.reset();
+    for (auto& collision : collisions) {
+      const int bin = colBinning.getBin({collision.posZ(), collision.multTPCtemp()});
+      if (bin < 0) {
+        continue;
+      }
+      auto& event = eventMixer.newEvent(bin, collision.multV0M());
+      for (auto& track : selectedTracks->sliceByCached(aod::resodaughter::resoCollisionId, collision.globalIndex(), cache)) {
+        event.addTrack(track);
       }
+      eventMixer.mixEvent(bin, [&](const o2::pwglf::ResonanceEventMixer::Event& pooled, const o2::pwglf::ResonanceEventMixer::Event& current) {
+        for (auto& trk1 : pooled.tracks) {
+          for (auto& trk2 : current.tracks) {
+            // Un-like sign pair only
+            if (trk1.sign() * trk2.sign() > 0)
+              continue;
+            if ((trk1.pt() < 0.3) && (std::abs(trk1.tpcNSigmaKa()) > 6.0))
+              continue;
+            if ((trk1.pt() >= 0.3) && (trk1.pt() < 0.4) && (std::abs(trk1.tpcNSigmaKa()) > 4.0))
+              continue;
+            if ((trk1.pt() >= 0.4) && (std::abs(trk1.tpcNSigmaKa()) > 2.0))
+              continue;
+
+            if ((trk2.pt() < 0.3) && (std::abs(trk2.tpcNSigmaKa()) > 6.0))
+              continue;
+            if ((trk2.pt() >= 0.3) && (trk2.pt() < 0.4) && (std::abs(trk2.tpcNSigmaKa()) > 4.0))
+              continue;
+            if ((trk2.pt() >= 0.4) && (std::abs(trk2.tpcNSigmaKa()) > 2.0))
+              continue;
+
+            lDecayDaughter1.SetXYZM(trk1.px(), trk1.py(), trk1.pz(), massKa);
+            lDecayDaughter2.SetXYZM(trk2.px(), trk2.py(), trk2.pz(), massKa);
+            lResonance = lDecayDaughter1 + lDecayDaughter2;
+
+            if (lResonance.Rapidity() > 0.5 || lResonance.Rapidity() < -0.5)
+              continue;
+
+            histos.fill(HIST("phiinvmassME"), lResonance.M());
+            histos.fill(HIST("h3phiinvmassME"), pooled.multV0M(), lResonance.Pt(), lResonance.M());
+          }
+        }
+      });
     }
   };
   PROCESS_SWITCH(phianalysis, processME, "Process EventMixing", false);
@@ -487,15 +487,10 @@ struct tofSpectra {
     histos.print();
   }
 
-  template <bool fillFullInfo, PID::ID id, typename T, typename C>
-  void fillParticleHistos(const T& track, const C& collision)
+  /// Multiplicity of the collision with the selected estimator, evaluated once per collision for all its tracks
+  template <typename C>
+  float getMultiplicity(const C& collision)
   {
-    if (abs(track.rapidity(PID::getMass(id))) > cfgCutY) {
-      return;
-    }
-    const auto& nsigmaTOF = o2::aod::pidutils::tofNSigma<id>(track);
-    const auto& nsigmaTPC = o2::aod::pidutils::tpcNSigma<id>(track);
-    // const auto id = track.sign() > 0 ? id : id + Np;
     float multiplicity = 0.f;
 
     switch (multiplicityEstimator) {
@@ -539,6 +534,18 @@ struct tofSpectra {
       default:
         LOG(fatal) << "Unknown multiplicity estimator: " << multiplicityEstimator;
     }
+    return multiplicity;
+  }
+
+  template <bool fillFullInfo, PID::ID id, typename T>
+  void fillParticleHistos(const T& track, const float multiplicity)
+  {
+    if (abs(track.rapidity(PID::getMass(id))) > cfgCutY) {
+      return;
+    }
+    const auto& nsigmaTOF = o2::aod::pidutils::tofNSigma<id>(track);
+    const auto& nsigmaTPC = o2::aod::pidutils::tpcNSigma<id>(track);
+    // const auto id = track.sign() > 0 ? id : id + Np;
 
     if (multiplicityEstimator == kNoMultiplicity) {
       if (track.sign() > 0) {
@@ -977,11 +984,12 @@ struct tofSpectra {
     if (!isEventSelected<false, false>(collision)) {                                           \
       return;                                                                                  \
     }                                                                                          \
+    const float multiplicity = getMultiplicity(collision);                                     \
     for (const auto& track : tracks) {                                                         \
       if (!isTrackSelected<false>(track)) {                                                    \
         continue;                                                                              \
       }                                                                                        \
-      fillParticleHistos<isFull, PID::particleId>(track, collision);                           \
+      fillParticleHistos<isFull, PID::particleId>(track, multiplicity);                        \
     }                                                                                          \
   }                                                                                            \
   PROCESS_SWITCH(tofSpectra, process##processorName##inputPid, Form("Process for the %s hypothesis from %s tables", #particleId, #processorName), false);
@@ -1076,6 +1084,10 @@ struct tofSpectra {
         break;
     }
 
+    if (mcParticle.pdgCode() != PDGs[i]) {
+      return;
+    }
+
     //************************************RD**************************************************
     float multiplicity = 0.f;
 
@@ -1119,9 +1131,6 @@ struct tofSpectra {
 
     //************************************RD**************************************************
 
-    if (mcParticle.pdgCode() != PDGs[i]) {
-      return;
-    }
     if (std::abs(mcParticle.eta()) > cfgCutEta) {
       return;
     }
@@ -1265,6 +1274,10 @@ struct tofSpectra {
         break;
     }
 
+    if (mcParticle.pdgCode() != PDGs[i]) {
+      return;
+    }
+
     //************************************RD**************************************************
     float multiplicity = 0.f;
 
@@ -1308,10 +1321,6 @@ struct tofSpectra {
 
     //************************************RD**************************************************
 
-    if (mcParticle.pdgCode() != PDGs[i]) {
-      return;
-    }
-
     if (!mcParticle.isPhysicalPrimary()) {
       if (mcParticle.getProcess() == 4) {
         if (makeTHnSparseChoice) {
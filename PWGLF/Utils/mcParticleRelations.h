@@ -0,0 +1,76 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file mcParticleRelations.h
+/// \brief Mothers and daughters of the MC particles, read in one pass for the LF MC tables
+///
+/// The McParticles table already stores the relations as indices, the mothers as an array and the
+/// daughters as a contiguous slice. These helpers read the first mothers or daughters of a particle
+/// with their PDG codes in a single loop, into fixed size arrays.
+
+#ifndef PWGLF_UTILS_MCPARTICLERELATIONS_H_
+#define PWGLF_UTILS_MCPARTICLERELATIONS_H_
+
+#include <array>
+#include <cstddef>
+
+#include "Framework/AnalysisDataModel.h"
+
+namespace o2::pwglf
+{
+
+/// \brief Indices and PDG codes of the first N mothers of an MC particle, -1 for the missing ones
+template <std::size_t N, typename TMCParticle>
+void getMothers(TMCParticle const& particle, std::array<int, N>& indices, std::array<int, N>& pdgCodes)
+{
+  indices.fill(-1);
+  pdgCodes.fill(-1);
+  if (!particle.has_mothers()) {
+    return;
+  }
+  std::size_t nFound{0};
+  for (auto const& mother : particle.template mothers_as<aod::McParticles>()) {
+    if (nFound == N) {
+      break;
+    }
+    indices[nFound] = mother.globalIndex();
+    pdgCodes[nFound] = mother.pdgCode();
+    nFound++;
+  }
+}
+
+/// \brief Indices and PDG codes of the first N daughters of an MC particle, -1 for the missing ones
+/// The daughter of index 0 is skipped, as it flags an invalid daughter slice
+template <std::size_t N, typename TMCParticle>
+void getDaughters(TMCParticle const& particle, std::array<int, N>& indices, std::array<int, N>& pdgCodes)
+{
+  indices.fill(-1);
+  pdgCodes.fill(-1);
+  if (!particle.has_daughters()) {
+    return;
+  }
+  std::size_t nFound{0};
+  for (auto const& daughter : particle.template daughters_as<aod::McParticles>()) {
+    if (nFound == N) {
+      break;
+    }
+    if (daughter.globalIndex() == 0) {
+      continue;
+    }
+    indices[nFound] = daughter.globalIndex();
+    pdgCodes[nFound] = daughter.pdgCode();
+    nFound++;
+  }
+}
+
+} // namespace o2::pwglf
+
+#endif // PWGLF_UTILS_MCPARTICLERELATIONS_H_
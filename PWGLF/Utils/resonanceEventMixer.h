@@ -0,0 +1,195 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file resonanceEventMixer.h
+/// \brief Pools of the last events of each mixing bin for the resonance analyses, stored as compact track records
+///
+/// The tracks of a collision are selected and copied in its event once, and each new event is mixed with the
+/// pooled events of its bin. Compared with the pairs of collisions of SameKindPair, the resonance tables are
+/// read only once per collision instead of once per mixed pair, so that the mixing depth can be increased.
+
+#ifndef PWGLF_UTILS_RESONANCEEVENTMIXER_H_
+#define PWGLF_UTILS_RESONANCEEVENTMIXER_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace o2::pwglf
+{
+
+namespace resonanceEventMixer
+{
+
+/// Track of a pooled event, with the accessors of the ResoTracks table used by the resonance analyses
+struct TrackRecord {
+  int64_t mGlobalIndex = -1;
+  float mPt = 0.f;
+  float mPx = 0.f;
+  float mPy = 0.f;
+  float mPz = 0.f;
+  float mEta = 0.f;
+  float mPhi = 0.f;
+  int8_t mSign = 0;
+  uint8_t mTPCNClsCrossedRows = 0;
+  float mDcaXY = 0.f;
+  float mDcaZ = 0.f;
+  uint8_t mTPCPIDselectionFlag = 0;
+  uint8_t mTOFPIDselectionFlag = 0;
+  float mTPCNSigmaPi = 0.f;
+  float mTPCNSigmaKa = 0.f;
+  float mTPCNSigmaPr = 0.f;
+  float mTOFNSigmaPi = 0.f;
+  float mTOFNSigmaKa = 0.f;
+  float mTOFNSigmaPr = 0.f;
+
+  int64_t index() const { return mGlobalIndex; }
+  int64_t globalIndex() const { return mGlobalIndex; }
+  float pt() const { return mPt; }
+  float px() const { return mPx; }
+  float py() const { return mPy; }
+  float pz() const { return mPz; }
+  float eta() const { return mEta; }
+  float phi() const { return mPhi; }
+  int8_t sign() const { return mSign; }
+  uint8_t tpcNClsCrossedRows() const { return mTPCNClsCrossedRows; }
+  float dcaXY() const { return mDcaXY; }
+  float dcaZ() const { return mDcaZ; }
+  uint8_t tpcPIDselectionFlag() const { return mTPCPIDselectionFlag; }
+  uint8_t tofPIDselectionFlag() const { return mTOFPIDselectionFlag; }
+  float tpcNSigmaPi() const { return mTPCNSigmaPi; }
+  float tpcNSigmaKa() const { return mTPCNSigmaKa; }
+  float tpcNSigmaPr() const { return mTPCNSigmaPr; }
+  float tofNSigmaPi() const { return mTOFNSigmaPi; }
+  float tofNSigmaKa() const { return mTOFNSigmaKa; }
+  float tofNSigmaPr() const { return mTOFNSigmaPr; }
+
+  /// Fills the record from a row of the ResoTracks table
+  /// The global index is kept, so that the tracks of different events never compare as the same track
+  template <typename T>
+  void set(T const& track)
+  {
+    mGlobalIndex = track.globalIndex();
+    mPt = track.pt();
+    mPx = track.px();
+    mPy = track.py();
+    mPz = track.pz();
+    mEta = track.eta();
+    mPhi = track.phi();
+    mSign = track.sign();
+    mTPCNClsCrossedRows = track.tpcNClsCrossedRows();
+    mDcaXY = track.dcaXY();
+    mDcaZ = track.dcaZ();
+    mTPCPIDselectionFlag = track.tpcPIDselectionFlag();
+    mTOFPIDselectionFlag = track.tofPIDselectionFlag();
+    mTPCNSigmaPi = track.tpcNSigmaPi();
+    mTPCNSigmaKa = track.tpcNSigmaKa();
+    mTPCNSigmaPr = track.tpcNSigmaPr();
+    mTOFNSigmaPi = track.tofNSigmaPi();
+    mTOFNSigmaKa = track.tofNSigmaKa();
+    mTOFNSigmaPr = track.tofNSigmaPr();
+  }
+};
+
+/// Event of a pool: the multiplicity of the collision, with the accessor of the ResoCollisions table, and its selected tracks
+struct Event {
+  float mMultV0M = 0.f;
+  std::vector<TrackRecord> tracks;
+
+  float multV0M() const { return mMultV0M; }
+
+  void clear(float multV0M)
+  {
+    mMultV0M = multV0M;
+    tracks.clear();
+  }
+
+  template <typename T>
+  void addTrack(T const& track)
+  {
+    tracks.emplace_back().set(track);
+  }
+};
+
+} // namespace resonanceEventMixer
+
+/// \class ResonanceEventMixer
+/// \brief Keeps, for each mixing bin, a ring buffer with the last events of the bin
+/// Each new event is mixed with the pooled events of its bin, and then takes the place of the oldest one.
+/// The record vectors of the pools are reused from one event to the next.
+class ResonanceEventMixer
+{
+ public:
+  using Event = resonanceEventMixer::Event;
+  using TrackRecord = resonanceEventMixer::TrackRecord;
+
+  /// \param depth number of events of a bin each event is mixed with
+  void init(int depth)
+  {
+    mDepth = depth > 0 ? depth : 1;
+    mPools.clear();
+  }
+
+  /// Empties the pools, without releasing the memory of the records
+  void reset()
+  {
+    for (auto& pool : mPools) {
+      pool.next = 0;
+      pool.nFilled = 0;
+    }
+  }
+
+  /// \param bin mixing bin of the collision, the pools are created when the bins are first used
+  /// \return the event to be filled with the tracks of the current collision of the bin
+  Event& newEvent(int bin, float multV0M)
+  {
+    if (bin >= static_cast<int>(mPools.size())) {
+      mPools.resize(bin + 1);
+    }
+    auto& pool = mPools[bin];
+    if (pool.events.empty()) {
+      pool.events.resize(mDepth + 1);
+    }
+    auto& event = pool.events[pool.next];
+    event.clear(multV0M);
+    return event;
+  }
+
+  /// Calls process(pooled, current) for each pooled event of the bin, from the oldest, with the event filled
+  /// last by newEvent(), and adds the current event to the pool
+  template <typename TProcess>
+  void mixEvent(int bin, TProcess process)
+  {
+    auto& pool = mPools[bin];
+    const int nSlots = mDepth + 1;
+    const auto& current = pool.events[pool.next];
+    for (int i = pool.nFilled; i > 0; --i) {
+      process(pool.events[(pool.next + nSlots - i) % nSlots], current);
+    }
+    pool.next = (pool.next + 1) % nSlots;
+    if (pool.nFilled < mDepth) {
+      pool.nFilled++;
+    }
+  }
+
+ private:
+  struct Pool {
+    std::vector<Event> events; ///< ring buffer, with one slot for the current event
+    int next = 0;              ///< slot of the next event
+    int nFilled = 0;           ///< number of pooled events
+  };
+
+  int mDepth = 1;
+  std::vector<Pool> mPools;
+};
+
+} // namespace o2::pwglf
+
+#endif // PWGLF_UTILS_RESONANCEEVENTMIXER_H_
@@ -0,0 +1,51 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file trackDCAtoPV.h
+/// \brief DCA of the daughter tracks to the primary vertex, shared by the V0, cascade and hypernuclei builders
+///
+/// The track-propagation task already stores, in the TracksDCA table, the DCA of each track to the
+/// collision it is assigned to. The builders reuse it for the daughters of the candidates of that same
+/// collision, and only propagate the daughters of candidates associated to another collision.
+
+#ifndef PWGLF_UTILS_TRACKDCATOPV_H_
+#define PWGLF_UTILS_TRACKDCATOPV_H_
+
+#include <array>
+
+#include "DetectorsBase/Propagator.h"
+#include "Common/Core/trackUtilities.h"
+
+namespace o2::pwglf
+{
+
+/// \brief DCA in xy of a daughter track to the primary vertex of its candidate
+/// \tparam useTracksDCA the track is joined with the TracksDCA table
+/// \param collisionId collision of the candidate, negative if none
+/// \param vertex position of the primary vertex of the candidate
+/// \param matCorr material correction of the propagation
+template <bool useTracksDCA, typename TTrack>
+float getDCAxyToPV(TTrack const& track, int collisionId, std::array<float, 3> const& vertex, o2::base::Propagator::MatCorrType matCorr)
+{
+  if constexpr (useTracksDCA) {
+    if (collisionId >= 0 && track.collisionId() == collisionId) {
+      return track.dcaXY();
+    }
+  }
+  gpu::gpustd::array<float, 2> dcaInfo;
+  auto trackPar = getTrackPar(track);
+  o2::base::Propagator::Instance()->propagateToDCABxByBz({vertex[0], vertex[1], vertex[2]}, trackPar, 2.f, matCorr, &dcaInfo);
+  return dcaInfo[0];
+}
+
+} // namespace o2::pwglf
+
+#endif // PWGLF_UTILS_TRACKDCATOPV_H_
@@ -0,0 +1,97 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file bcMoments.h
+/// \brief Sums of the vertex positions of the collisions of each bunch crossing of the orbit, for the luminous region
+///
+/// The vertices are accumulated in fixed size arrays indexed by the BC in the orbit, and the sums are flushed
+/// into a histogram with one fill per filled BC and moment. As sums, they are merged by simply adding the
+/// histograms of the jobs, and the mean position and the covariance of the luminous region of each BC follow
+/// from them without keeping the vertices of the individual events.
+
+#ifndef PWGMM_CORE_BCMOMENTS_H_
+#define PWGMM_CORE_BCMOMENTS_H_
+
+#include <array>
+#include <vector>
+
+#include "CommonConstants/LHCConstants.h"
+
+namespace o2::pwgmm
+{
+
+class BCMoments
+{
+ public:
+  enum Moment {
+    kCount = 0,
+    kX,
+    kY,
+    kZ,
+    kXX,
+    kYY,
+    kZZ,
+    kXY,
+    kXZ,
+    kYZ,
+    kCovXX, ///< sum of the vertex resolutions, for the unfolding of the width of the luminous region
+    kCovYY,
+    kCovXY,
+    kNMoments
+  };
+
+  static constexpr const char* MomentLabels[kNMoments] = {"N", "x", "y", "z", "xx", "yy", "zz", "xy", "xz", "yz", "#sigma_{xx}^{vtx}", "#sigma_{yy}^{vtx}", "#sigma_{xy}^{vtx}"};
+
+  void add(int bcInOrbit, double x, double y, double z, double covXX, double covYY, double covXY)
+  {
+    auto& sums = mSums[bcInOrbit];
+    if (sums[kCount] == 0.) {
+      mFilled.push_back(bcInOrbit);
+    }
+    sums[kCount] += 1.;
+    sums[kX] += x;
+    sums[kY] += y;
+    sums[kZ] += z;
+    sums[kXX] += x * x;
+    sums[kYY] += y * y;
+    sums[kZZ] += z * z;
+    sums[kXY] += x * y;
+    sums[kXZ] += x * z;
+    sums[kYZ] += y * z;
+    sums[kCovXX] += covXX;
+    sums[kCovYY] += covYY;
+    sums[kCovXY] += covXY;
+  }
+
+  bool empty() const { return mFilled.empty(); }
+
+  /// Calls fill(bcInOrbit, moment, sum) for the sums of each filled BC, and resets them
+  template <typename TFill>
+  void flush(TFill fill)
+  {
+    for (auto bc : mFilled) {
+      auto& sums = mSums[bc];
+      for (auto moment = 0; moment < kNMoments; ++moment) {
+        fill(bc, moment, sums[moment]);
+      }
+      sums.fill(0.);
+    }
+    mFilled.clear();
+  }
+
+ private:
+  std::array<std::array<double, kNMoments>, o2::constants::lhc::LHCMaxBunches> mSums{};
+  std::vector<int> mFilled; ///< BCs with at least one vertex since the last flush
+};
+
+} // namespace o2::pwgmm
+
+#endif // PWGMM_CORE_BCMOMENTS_H_
@@ -0,0 +1,156 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file fwdTrackDCA.h
+/// \brief Transverse DCAs of forward tracks to all of their compatible collisions, computed in one pass
+///
+/// The ambiguous tracks of a time frame are added with their compatible collisions, and the DCAs of all
+/// the track-collision candidates are computed together. Only the track positions are propagated, with
+/// the terms of the helix that do not depend on the collision computed once per track, while the
+/// propagation of the covariance matrix is left to the caller for the best collision only.
+
+#ifndef PWGMM_CORE_FWDTRACKDCA_H_
+#define PWGMM_CORE_FWDTRACKDCA_H_
+
+#include <cmath>
+#include <vector>
+
+#include "CommonConstants/MathConstants.h"
+
+namespace o2::pwgmm
+{
+
+class FwdTrackDCA
+{
+ public:
+  /// Smallest DCA_xy for which a candidate is taken as the best collision of its track
+  static constexpr float MaxDCAXY = 999.f;
+
+  void clear()
+  {
+    mTracks.clear();
+    mOffsets.assign(1, 0);
+    mCollisionIds.clear();
+    mVertices.clear();
+    mDCAX.clear();
+    mDCAY.clear();
+    mDCAXY.clear();
+  }
+
+  /// Adds a track, to which the next candidates are added, with the parameters of the MFTTracks table
+  template <typename TTrack>
+  void addTrack(TTrack const& track)
+  {
+    mTracks.push_back({track.x(), track.y(), track.z(), track.phi(), track.tgl(), track.signed1Pt()});
+    mOffsets.push_back(mOffsets.back());
+  }
+
+  /// Adds a compatible collision to the last added track
+  template <typename TCollision>
+  void addCollision(TCollision const& collision)
+  {
+    mCollisionIds.push_back(collision.globalIndex());
+    mVertices.push_back({collision.posX(), collision.posY(), collision.posZ()});
+    ++mOffsets.back();
+  }
+
+  /// Computes the DCAs of all the candidates
+  /// \param bZ field for the helix propagation, in kG, or 0 for a linear propagation
+  void compute(float bZ)
+  {
+    const auto nCandidates = mVertices.size();
+    mDCAX.resize(nCandidates);
+    mDCAY.resize(nCandidates);
+    mDCAXY.resize(nCandidates);
+    const double k = std::abs(o2::constants::math::B2C * bZ);
+    const double hz = std::copysign(1., bZ);
+    for (auto iTrack = 0U; iTrack < mTracks.size(); ++iTrack) {
+      auto const& track = mTracks[iTrack];
+      const double invTgl = 1. / track.tgl;
+      const double cosPhi = std::cos(track.phi);
+      const double sinPhi = std::sin(track.phi);
+      // radius of the helix projected on xy, and angle per unit of z
+      const double xr = cosPhi / (track.signed1Pt * k);
+      const double yr = sinPhi / (track.signed1Pt * k);
+      const double dThetaDz = -track.signed1Pt * k * invTgl;
+      for (auto i = mOffsets[iTrack]; i < mOffsets[iTrack + 1]; ++i) {
+        const double dz = mVertices[i].z - track.z;
+        double x = track.x;
+        double y = track.y;
+        if (k == 0. || track.signed1Pt == 0.f) {
+          x += cosPhi * dz * invTgl;
+          y += sinPhi * dz * invTgl;
+        } else {
+          const double theta = dThetaDz * dz;
+          const double cosTheta = std::cos(theta);
+          const double sinTheta = std::sin(theta);
+          x += hz * yr * (1. - cosTheta) - xr * sinTheta;
+          y += hz * xr * (cosTheta - 1.) - yr * sinTheta;
+        }
+        mDCAX[i] = x - mVertices[i].x;
+        mDCAY[i] = y - mVertices[i].y;
+        mDCAXY[i] = std::sqrt(mDCAX[i] * mDCAX[i] + mDCAY[i] * mDCAY[i]);
+      }
+    }
+  }
+
+  int nTracks() const { return mTracks.size(); }
+  /// Candidates of the track iTrack are in [first(iTrack), last(iTrack))
+  int first(int iTrack) const { return mOffsets[iTrack]; }
+  int last(int iTrack) const { return mOffsets[iTrack + 1]; }
+
+  /// \return candidate of the track with the smallest DCA_xy, the first one for equal DCAs, or -1 if none is below MaxDCAXY
+  int best(int iTrack) const
+  {
+    int best = -1;
+    float bestDCA = MaxDCAXY;
+    for (auto i = first(iTrack); i < last(iTrack); ++i) {
+      if (mDCAXY[i] < bestDCA) {
+        best = i;
+        bestDCA = mDCAXY[i];
+      }
+    }
+    return best;
+  }
+
+  int collisionId(int i) const { return mCollisionIds[i]; }
+  float vertexZ(int i) const { return mVertices[i].z; }
+  float dcaX(int i) const { return mDCAX[i]; }
+  float dcaY(int i) const { return mDCAY[i]; }
+  float dcaXY(int i) const { return mDCAXY[i]; }
+
+ private:
+  struct Track {
+    float x;
+    float y;
+    float z;
+    float phi;
+    float tgl;
+    float signed1Pt;
+  };
+  struct Vertex {
+    float x;
+    float y;
+    float z;
+  };
+
+  std::vector<Track> mTracks;
+  std::vector<int> mOffsets{0}; ///< candidates of each track, as offsets into the candidate arrays
+  std::vector<int> mCollisionIds;
+  std::vector<Vertex> mVertices;
+  std::vector<float> mDCAX;
+  std::vector<float> mDCAY;
+  std::vector<float> mDCAXY;
+};
+
+} // namespace o2::pwgmm
+
+#endif // PWGMM_CORE_FWDTRACKDCA_H_
@@ -46,6 +46,8 @@
 #include "CCDB/CcdbApi.h"
 #include "DataFormatsCalibration/MeanVertexObject.h"
 
+#include "PWGMM/Core/bcMoments.h"
+
 using namespace o2::framework;
 using namespace o2::framework::expressions;
 using BCsWithTimestamps = soa::Join<aod::BCs, aod::Timestamps>;
@@ -147,6 +149,13 @@ struct LumiFDDFT0 {
 
   bool doPVrefit = true;
 
+  Configurable<bool> fillEventInfo{"fillEventInfo", true, "Fill the EventInfo table with the refitted vertex of each collision"};
+  ConfigurableAxis momentsTimeBinning{"momentsTimeBinning", {2000, 0, 2e7}, "time slices of the per-BC vertex moments (ms since the first time stamp)"};
+
+  o2::pwgmm::BCMoments bcMoments; // vertex sums of the current time slice
+  int mMomentsSlice = -1;
+  double mMomentsTime = 0.;
+
   void init(InitContext&)
   {
     if (doprocessLite == true && doprocessFull == true) {
@@ -159,6 +168,34 @@ struct LumiFDDFT0 {
     uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
     ccdb->setCreatedNotAfter(now);
     mRunNumber = 0;
+
+    if (doprocessBCMoments) {
+      AxisSpec timeAxis = {momentsTimeBinning, "t (ms)"};
+      histos.add("BCMoments", "; t (ms); BC in orbit; moment", {HistType::kTHnSparseD, {timeAxis, {o2::constants::lhc::LHCMaxBunches, -0.5, o2::constants::lhc::LHCMaxBunches - 0.5, "BC"}, {o2::pwgmm::BCMoments::kNMoments, -0.5, o2::pwgmm::BCMoments::kNMoments - 0.5, "moment"}}});
+      auto* axis = histos.get<THnSparse>(HIST("BCMoments"))->GetAxis(2);
+      for (auto moment = 0; moment < o2::pwgmm::BCMoments::kNMoments; ++moment) {
+        axis->SetBinLabel(moment + 1, o2::pwgmm::BCMoments::MomentLabels[moment]);
+      }
+    }
+  }
+
+  /// Adds the refitted vertex to the sums of its BC, after flushing the sums of the previous time slice
+  void addBCMoments(uint64_t globalBC, double relTS, double x, double y, double z, double covXX, double covYY, double covXY)
+  {
+    const auto slice = histos.get<THnSparse>(HIST("BCMoments"))->GetAxis(0)->FindBin(relTS);
+    if (slice != mMomentsSlice) {
+      flushBCMoments();
+      mMomentsSlice = slice;
+      mMomentsTime = histos.get<THnSparse>(HIST("BCMoments"))->GetAxis(0)->GetBinCenter(slice);
+    }
+    bcMoments.add(globalBC % o2::constants::lhc::LHCMaxBunches, x, y, z, covXX, covYY, covXY);
+  }
+
+  void flushBCMoments()
+  {
+    bcMoments.flush([&](int bc, int moment, double sum) {
+      histos.fill(HIST("BCMoments"), mMomentsTime, bc, moment, sum);
+    });
   }
 
   void processFull(soa::Join<aod::Collisions, aod::EvSels>::iterator const& collision, aod::FDDs const& fdds, aod::FT0s const& ft0s, aod::BCsWithTimestamps const&,
@@ -274,9 +311,11 @@ struct LumiFDDFT0 {
       } // ft0
 
     } // pv refit
-    rowEventInfo(relTS, refitX, refitY, refitZ, globalBC, chi2, nContrib, collision.has_foundFDD(),
-                 mTriggerFDD, timeaFDD, timecFDD, chargeaFDD, chargecFDD, collision.has_foundFT0(), mTriggerFT0, timeaFT0,
-                 timecFT0, chargeaFT0, chargecFT0);
+    if (fillEventInfo) {
+      rowEventInfo(relTS, refitX, refitY, refitZ, globalBC, chi2, nContrib, collision.has_foundFDD(),
+                   mTriggerFDD, timeaFDD, timecFDD, chargeaFDD, chargecFDD, collision.has_foundFT0(), mTriggerFT0, timeaFT0,
+                   timecFT0, chargeaFT0, chargecFT0);
+    }
 
     histos.fill(HIST("chisquare_Refitted"), chi2);
     if (nContrib > nContribMin && nContrib < nContribMax &&
@@ -286,6 +325,10 @@ struct LumiFDDFT0 {
 
       histos.fill(HIST("vertexx_Refitted_timestamp"), relTS, refitX);
       histos.fill(HIST("vertexy_Refitted_timestamp"), relTS, refitY);
+
+      if (doprocessBCMoments) {
+        addBCMoments(globalBC, relTS, refitX, refitY, refitZ, refitXX, refitYY, refitXY);
+      }
     }
     histos.fill(HIST("chisquare"), collision.chi2());
     if (collision.chi2() / collision.numContrib() > 4)
@@ -309,6 +352,13 @@ struct LumiFDDFT0 {
   };
   PROCESS_SWITCH(LumiFDDFT0, processFull, "Process FDD", true);
 
+  // declared after the collision process, so that the sums of the last time slice of each data frame are flushed after it
+  void processBCMoments(aod::Collisions const&)
+  {
+    flushBCMoments();
+  }
+  PROCESS_SWITCH(LumiFDDFT0, processBCMoments, "Accumulate the per-BC moments of the refitted vertices (with processFull)", false);
+
   void processLite(aod::FDDs const& fdds, aod::FT0s const& ft0s, aod::BCsWithTimestamps const&)
   {
 
@@ -53,6 +53,8 @@
 
 #include "DataFormatsCalibration/MeanVertexObject.h"
 
+#include "PWGMM/Core/bcMoments.h"
+
 namespace o2::aod
 {
 namespace full
@@ -129,6 +131,13 @@ struct lumiTask {
     }};
   bool doPVrefit = true;
 
+  Configurable<bool> fillEventInfo{"fillEventInfo", true, "Fill the EventInfo table with the refitted vertex of each collision"};
+  ConfigurableAxis momentsTimeBinning{"momentsTimeBinning", {2000, 0, 2e7}, "time slices of the per-BC vertex moments (ms since the first time stamp)"};
+
+  o2::pwgmm::BCMoments bcMoments; // vertex sums of the current time slice
+  int mMomentsSlice = -1;
+  double mMomentsTime = 0.;
+
   void init(InitContext&)
   {
     ccdb->setURL(ccdburl);
@@ -137,6 +146,34 @@ struct lumiTask {
     uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
     ccdb->setCreatedNotAfter(now);
     mRunNumber = 0;
+
+    if (doprocessBCMoments) {
+      AxisSpec timeAxis = {momentsTimeBinning, "t (ms)"};
+      histos.add("BCMoments", "; t (ms); BC in orbit; moment", {HistType::kTHnSparseD, {timeAxis, {o2::constants::lhc::LHCMaxBunches, -0.5, o2::constants::lhc::LHCMaxBunches - 0.5, "BC"}, {o2::pwgmm::BCMoments::kNMoments, -0.5, o2::pwgmm::BCMoments::kNMoments - 0.5, "moment"}}});
+      auto* axis = histos.get<THnSparse>(HIST("BCMoments"))->GetAxis(2);
+      for (auto moment = 0; moment < o2::pwgmm::BCMoments::kNMoments; ++moment) {
+        axis->SetBinLabel(moment + 1, o2::pwgmm::BCMoments::MomentLabels[moment]);
+      }
+    }
+  }
+
+  /// Adds the refitted vertex to the sums of its BC, after flushing the sums of the previous time slice
+  void addBCMoments(uint64_t globalBC, double relTS, double x, double y, double z, double covXX, double covYY, double covXY)
+  {
+    const auto slice = histos.get<THnSparse>(HIST("BCMoments"))->GetAxis(0)->FindBin(relTS);
+    if (slice != mMomentsSlice) {
+      flushBCMoments();
+      mMomentsSlice = slice;
+      mMomentsTime = histos.get<THnSparse>(HIST("BCMoments"))->GetAxis(0)->GetBinCenter(slice);
+    }
+    bcMoments.add(globalBC % o2::constants::lhc::LHCMaxBunches, x, y, z, covXX, covYY, covXY);
+  }
+
+  void flushBCMoments()
+  {
+    bcMoments.flush([&](int bc, int moment, double sum) {
+      histos.fill(HIST("BCMoments"), mMomentsTime, bc, moment, sum);
+    });
   }
 
   void process(aod::Collision const& collision, aod::BCsWithTimestamps const&,
@@ -218,8 +255,10 @@ struct lumiTask {
       refitXY = Pvtx_refitted.getSigmaXY();
     }
 
-    rowEventInfo(relTS, refitX, refitY, refitZ, refitXX, refitYY, refitXY, chi2,
-                 nContrib);
+    if (fillEventInfo) {
+      rowEventInfo(relTS, refitX, refitY, refitZ, refitXX, refitYY, refitXY, chi2,
+                   nContrib);
+    }
 
     //    LOGP(info,"chi2: {}, Ncont: {}, nonctr:
     //    {}",chi2,nContrib,nNonContrib);
@@ -232,6 +271,10 @@ struct lumiTask {
 
       histos.fill(HIST("vertexx_Refitted_timestamp"), relTS, refitX);
       histos.fill(HIST("vertexy_Refitted_timestamp"), relTS, refitY);
+
+      if (doprocessBCMoments) {
+        addBCMoments(bc.globalBC(), relTS, refitX, refitY, refitZ, refitXX, refitYY, refitXY);
+      }
     }
     histos.fill(HIST("chisquare"), collision.chi2());
     if (collision.chi2() / collision.numContrib() > 4)
@@ -254,6 +297,13 @@ struct lumiTask {
     }
 
   } // need selections
+
+  // declared after the collision process, so that the sums of the last time slice of each data frame are flushed after it
+  void processBCMoments(aod::Collisions const&)
+  {
+    flushBCMoments();
+  }
+  PROCESS_SWITCH(lumiTask, processBCMoments, "Accumulate the per-BC moments of the refitted vertices", false);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
@@ -0,0 +1,45 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef PWGMM_MULT_DATAMODEL_FLATENICITYTABLE_H_
+#define PWGMM_MULT_DATAMODEL_FLATENICITYTABLE_H_
+
+#include "Framework/AnalysisDataModel.h"
+
+namespace o2::aod
+{
+namespace flatenicity
+{
+DECLARE_SOA_COLUMN(FlatenicityFV0, flatenicityFV0, float);   //! flatenicity of the FV0 cells, 9999 without signal
+DECLARE_SOA_COLUMN(FlatenicityFT0A, flatenicityFT0A, float); //! flatenicity of the FT0A sectors, 9999 without signal
+DECLARE_SOA_COLUMN(FlatenicityFT0C, flatenicityFT0C, float); //! flatenicity of the FT0C sectors, 9999 without signal
+DECLARE_SOA_COLUMN(AmpFV0, ampFV0, float);                   //! FV0 amplitude, with the calibrations of the producer
+DECLARE_SOA_COLUMN(AmpFT0A, ampFT0A, float);                 //! FT0A amplitude, with the calibrations of the producer
+DECLARE_SOA_COLUMN(AmpFT0C, ampFT0C, float);                 //! FT0C amplitude, with the calibrations of the producer
+DECLARE_SOA_COLUMN(MultGlobal, multGlobal, int);             //! number of global tracks in the acceptance of the producer
+DECLARE_SOA_COLUMN(PtTrig, ptTrig, float);                   //! leading pT of the global tracks
+DECLARE_SOA_DYNAMIC_COLUMN(FlatenicityFT0, flatenicityFT0, //! average of the FT0A and FT0C flatenicities
+                           [](float flatFT0A, float flatFT0C) -> float { return (flatFT0A + flatFT0C) / 2.f; });
+DECLARE_SOA_DYNAMIC_COLUMN(FlatenicityFV0FT0C, flatenicityFV0FT0C, //! average of the FV0 and FT0C flatenicities
+                           [](float flatFV0, float flatFT0C) -> float { return 0.5f * flatFV0 + 0.5f * flatFT0C; });
+} // namespace flatenicity
+
+// one row per collision, to be joined with the Collisions table
+DECLARE_SOA_TABLE(Flatenicities, "AOD", "FLATENICITY",
+                  flatenicity::FlatenicityFV0, flatenicity::FlatenicityFT0A, flatenicity::FlatenicityFT0C,
+                  flatenicity::AmpFV0, flatenicity::AmpFT0A, flatenicity::AmpFT0C,
+                  flatenicity::MultGlobal, flatenicity::PtTrig,
+                  flatenicity::FlatenicityFT0<flatenicity::FlatenicityFT0A, flatenicity::FlatenicityFT0C>,
+                  flatenicity::FlatenicityFV0FT0C<flatenicity::FlatenicityFV0, flatenicity::FlatenicityFT0C>);
+using Flatenicity = Flatenicities::iterator;
+} // namespace o2::aod
+
+#endif // PWGMM_MULT_DATAMODEL_FLATENICITYTABLE_H_
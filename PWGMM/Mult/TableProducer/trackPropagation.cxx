@@ -34,6 +34,7 @@
 #include "TGeoGlobalMagField.h"
 
 #include "Common/DataModel/CollisionAssociationTables.h"
+#include "PWGMM/Core/fwdTrackDCA.h"
 #include "bestCollisionTable.h"
 
 using SMatrix55 = ROOT::Math::SMatrix<double, 5, 5, ROOT::Math::MatRepSym<double, 5>>;
@@ -73,6 +74,8 @@ struct AmbiguousTrackPropagation {
   Configurable<bool> produceExtra{"produceExtra", false, "Produce table with refitted track parameters"};
   Configurable<bool> produceHistos{"produceHistos", false, "Produce control histograms"};
 
+  o2::pwgmm::FwdTrackDCA fwdDCA; // DCAs of the MFT tracks to their compatible collisions
+
   HistogramRegistry registry{
     "registry",
     {
@@ -183,6 +186,55 @@ struct AmbiguousTrackPropagation {
   }
   PROCESS_SWITCH(AmbiguousTrackPropagation, processCentral, "Fill ReassignedTracks for central ambiguous tracks", true);
 
+  /// Fills the best collision of the MFT track iTrack of fwdDCA, propagating the full track parameters
+  /// only to the best collision
+  template <typename T>
+  void fillBestCollision(T const& track, int iTrack, int64_t mftTrackId, int degree)
+  {
+    const auto best = fwdDCA.best(iTrack);
+    auto bestCol = track.has_collision() ? track.collisionId() : -1;
+    float bestDCA = o2::pwgmm::FwdTrackDCA::MaxDCAXY;
+    float bestDCAx = o2::pwgmm::FwdTrackDCA::MaxDCAXY;
+    float bestDCAy = o2::pwgmm::FwdTrackDCA::MaxDCAXY;
+    if (best >= 0) {
+      bestCol = fwdDCA.collisionId(best);
+      bestDCA = fwdDCA.dcaXY(best);
+      bestDCAx = fwdDCA.dcaX(best);
+      bestDCAy = fwdDCA.dcaY(best);
+    }
+
+    if (produceHistos) {
+      for (auto i = fwdDCA.first(iTrack); i < fwdDCA.last(iTrack); ++i) {
+        registry.fill(HIST("TracksDCAXY"), fwdDCA.dcaXY(i));
+        if (track.collisionId() != fwdDCA.collisionId(i)) {
+          registry.fill(HIST("DeltaZ"), track.collision().posZ() - fwdDCA.vertexZ(i)); // deltaZ between the 1st coll zvtx and the other compatible ones
+        } else {
+          registry.fill(HIST("TracksOrigDCAXY"), fwdDCA.dcaXY(i));
+        }
+      }
+      if (bestCol != track.collisionId()) {
+        // reassigned
+        registry.fill(HIST("ReassignedDCAXY"), bestDCA);
+      }
+      registry.fill(HIST("TracksAmbDegree"), degree);
+    }
+
+    fwdtracksBestCollisions(mftTrackId, degree, bestCol, bestDCA, bestDCAx, bestDCAy);
+    if (produceExtra) {
+      std::vector<double> v1; // Temporary null vector for the computation of the covariance matrix
+      SMatrix55 tcovs(v1.begin(), v1.end());
+      SMatrix5 tpars(track.x(), track.y(), track.phi(), track.tgl(), track.signed1Pt());
+      o2::track::TrackParCovFwd bestTrackPar{track.z(), tpars, tcovs, track.chi2()};
+      if (best >= 0) {
+        bestTrackPar.propagateToZhelix(fwdDCA.vertexZ(best), Bz); // track parameters propagation to the position of the z vertex
+      }
+      fwdtracksBestCollExtra(bestTrackPar.getX(),
+                             bestTrackPar.getY(), bestTrackPar.getZ(),
+                             bestTrackPar.getTgl(), bestTrackPar.getInvQPt(), bestTrackPar.getPt(),
+                             bestTrackPar.getP(), bestTrackPar.getEta(), bestTrackPar.getPhi());
+    }
+  }
+
   void processMFT(aod::MFTTracks const&,
                   aod::Collisions const&, ExtBCs const& bcs,
                   aod::AmbiguousMFTTracks const& atracks)
@@ -196,75 +248,26 @@ struct AmbiguousTrackPropagation {
     }
     initCCDB(bcs.begin());
 
-    // Minimum only on DCAxy
-    float dcaInfo;
-    float bestDCA, bestDCAx, bestDCAy;
-    o2::track::TrackParCovFwd bestTrackPar;
-
+    // the DCAs of all the ambiguous tracks to their compatible collisions are computed in one pass
+    fwdDCA.clear();
     for (auto& atrack : atracks) {
-      dcaInfo = 999; // DCAxy
-      bestDCA = 999;
-
-      auto track = atrack.mfttrack();
-      auto bestCol = track.has_collision() ? track.collisionId() : -1;
-
-      std::vector<double> v1; // Temporary null vector for the computation of the covariance matrix
-      SMatrix55 tcovs(v1.begin(), v1.end());
-      SMatrix5 tpars(track.x(), track.y(), track.phi(), track.tgl(), track.signed1Pt());
-      o2::track::TrackParCovFwd trackPar{track.z(), tpars, tcovs, track.chi2()};
-
-      int degree = 0; // degree of ambiguity of the track
-
-      auto compatibleBCs = atrack.bc_as<ExtBCs>();
-      for (auto& bc : compatibleBCs) {
+      fwdDCA.addTrack(atrack.mfttrack());
+      for (auto& bc : atrack.bc_as<ExtBCs>()) {
         if (!bc.has_collisions()) {
           continue;
         }
-        auto collisions = bc.collisions();
-        for (auto const& collision : collisions) {
-          degree++;
-          trackPar.propagateToZhelix(collision.posZ(), Bz); // track parameters propagation to the position of the z vertex
-
-          const auto dcaX(trackPar.getX() - collision.posX());
-          const auto dcaY(trackPar.getY() - collision.posY());
-          dcaInfo = std::sqrt(dcaX * dcaX + dcaY * dcaY);
-
-          if ((dcaInfo < bestDCA)) {
-            bestCol = collision.globalIndex();
-            bestDCA = dcaInfo;
-            bestDCAx = dcaX;
-            bestDCAy = dcaY;
-            bestTrackPar = trackPar;
-          }
-
-          if (produceHistos) {
-            registry.fill(HIST("TracksDCAXY"), dcaInfo);
-          }
-          if ((track.collisionId() != collision.globalIndex()) && produceHistos) {
-            registry.fill(HIST("DeltaZ"), track.collision().posZ() - collision.posZ()); // deltaZ between the 1st coll zvtx and the other compatible ones
-          }
-
-          if ((collision.globalIndex() == track.collisionId()) && produceHistos) {
-            registry.fill(HIST("TracksOrigDCAXY"), dcaInfo);
-          }
+        for (auto const& collision : bc.collisions()) {
+          fwdDCA.addCollision(collision);
         }
       }
+    }
+    fwdDCA.compute(Bz);
 
-      if ((bestCol != track.collisionId()) && produceHistos) {
-        // reassigned
-        registry.fill(HIST("ReassignedDCAXY"), bestDCA);
-      }
-      if (produceHistos) {
-        registry.fill(HIST("TracksAmbDegree"), degree);
-      }
-
-      fwdtracksBestCollisions(-1, degree, bestCol, bestDCA, bestDCAx, bestDCAy);
-      if (produceExtra) {
-        fwdtracksBestCollExtra(bestTrackPar.getX(),
-                               bestTrackPar.getY(), bestTrackPar.getZ(),
-                               bestTrackPar.getTgl(), bestTrackPar.getInvQPt(), bestTrackPar.getPt(),
-                               bestTrackPar.getP(), bestTrackPar.getEta(), bestTrackPar.getPhi());
-      }
+    auto iTrack = 0;
+    for (auto& atrack : atracks) {
+      auto track = atrack.mfttrack();
+      fillBestCollision(track, iTrack, -1, fwdDCA.last(iTrack) - fwdDCA.first(iTrack));
+      ++iTrack;
     }
   }
   PROCESS_SWITCH(AmbiguousTrackPropagation, processMFT, "Fill BestCollisionsFwd for MFT ambiguous tracks", false);
@@ -283,76 +286,23 @@ struct AmbiguousTrackPropagation {
     }
     initCCDB(bcs.begin());
 
-    float dcaInfo;
-    float bestDCA, bestDCAx, bestDCAy;
-    o2::track::TrackParCovFwd bestTrackPar;
-
+    fwdDCA.clear();
     for (auto& track : tracks) {
-      dcaInfo = 999; // DCAxy
-      bestDCA = 999;
-
-      auto bestCol = track.has_collision() ? track.collisionId() : -1;
-
-      // auto ids = track.compatibleCollIds();
-
-      // if (ids.empty() || (ids.size() == 1 && bestCol == ids[0]))
-      // {
-      //   continue;
-      // }
-
-      auto compatibleColls = track.compatibleColl();
-
-      std::vector<double> v1; // Temporary null vector for the computation of the covariance matrix
-      SMatrix55 tcovs(v1.begin(), v1.end());
-      SMatrix5 tpars(track.x(), track.y(), track.phi(), track.tgl(), track.signed1Pt());
-      o2::track::TrackParCovFwd trackPar{track.z(), tpars, tcovs, track.chi2()};
-
-      for (auto& collision : compatibleColls) {
-
-        trackPar.propagateToZhelix(collision.posZ(), Bz); // track parameters propagation to the position of the z vertex
-
-        const auto dcaX(trackPar.getX() - collision.posX());
-        const auto dcaY(trackPar.getY() - collision.posY());
-        dcaInfo = std::sqrt(dcaX * dcaX + dcaY * dcaY);
-
-        if ((dcaInfo < bestDCA)) {
-          bestCol = collision.globalIndex();
-          bestDCA = dcaInfo;
-          bestDCAx = dcaX;
-          bestDCAy = dcaY;
-          bestTrackPar = trackPar;
-        }
-        if ((track.collisionId() != collision.globalIndex()) && produceHistos) {
-          registry.fill(HIST("DeltaZ"), track.collision().posZ() - collision.posZ()); // deltaZ between the 1st coll zvtx and the other compatible ones
-        }
-        if (produceHistos) {
-          registry.fill(HIST("TracksDCAXY"), dcaInfo);
-        }
-
-        if ((collision.globalIndex() == track.collisionId()) && produceHistos) {
-          registry.fill(HIST("TracksOrigDCAXY"), dcaInfo);
-        }
-      }
-      if ((bestCol != track.collisionId()) && produceHistos) {
-        // reassigned
-        registry.fill(HIST("ReassignedDCAXY"), bestDCA);
-      }
-      if (produceHistos) {
-        int isAmbiguous = 0;
-        registry.fill(HIST("TracksAmbDegree"), compatibleColls.size());
-        if (compatibleColls.size() > 1) {
-          isAmbiguous = 1;
-        }
-        registry.fill(HIST("TrackIsAmb"), isAmbiguous);
+      fwdDCA.addTrack(track);
+      for (auto& collision : track.compatibleColl()) {
+        fwdDCA.addCollision(collision);
       }
+    }
+    fwdDCA.compute(Bz);
 
-      fwdtracksBestCollisions(track.globalIndex(), compatibleColls.size(), bestCol, bestDCA, bestDCAx, bestDCAy);
-      if (produceExtra) {
-        fwdtracksBestCollExtra(bestTrackPar.getX(),
-                               bestTrackPar.getY(), bestTrackPar.getZ(),
-                               bestTrackPar.getTgl(), bestTrackPar.getInvQPt(), bestTrackPar.getPt(),
-                               bestTrackPar.getP(), bestTrackPar.getEta(), bestTrackPar.getPhi());
+    auto iTrack = 0;
+    for (auto& track : tracks) {
+      const int degree = fwdDCA.last(iTrack) - fwdDCA.first(iTrack);
+      fillBestCollision(track, iTrack, track.globalIndex(), degree);
+      if (produceHistos) {
+        registry.fill(HIST("TrackIsAmb"), degree > 1 ? 1 : 0);
       }
+      ++iTrack;
     }
   }
   PROCESS_SWITCH(AmbiguousTrackPropagation, processMFTReassoc, "Fill BestCollisionsFwd for MFT ambiguous tracks with the new data model", false);
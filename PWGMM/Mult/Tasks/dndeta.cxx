@@ -9,7 +9,10 @@
 // granted to it by virtue of its status as an Intergovernmental Organization
 // or submit itself to any jurisdiction.
 
+#include <array>
 #include <cmath>
+#include <cstdint>
+#include <vector>
 
 #include "Common/CCDB/EventSelectionParams.h"
 #include "Common/DataModel/EventSelection.h"
@@ -22,6 +25,7 @@
 #include "Framework/runDataProcessing.h"
 #include "Index.h"
 #include "TDatabasePDG.h"
+#include "THnSparse.h"
 
 #include "bestCollisionTable.h"
 
@@ -67,6 +71,76 @@ static constexpr bool hasCent()
     return false;
   }
 }
+
+/// Unit weight fills of a THnSparse within one event, in which only the first NVar axes vary
+/// The cells of these axes are counted in a dense array and added to the histogram at the end of the
+/// event, with one bin lookup per filled cell instead of one per fill. The bin contents, errors and
+/// entries are the same as with THnSparse::Fill, the per-axis moments of the statistics are not filled.
+template <int NVar>
+class EventSparseFill
+{
+ public:
+  void init(THnSparse* hist)
+  {
+    mHist = hist;
+    auto size = 1;
+    for (auto i = 0; i < NVar; ++i) {
+      mAxes[i] = hist->GetAxis(i);
+      mNCells[i] = mAxes[i]->GetNbins() + 2;
+      size *= mNCells[i];
+    }
+    mCounts.assign(size, 0);
+    mFilled.clear();
+  }
+
+  void fill(std::array<double, NVar> const& x)
+  {
+    auto cell = 0;
+    for (auto i = NVar - 1; i >= 0; --i) {
+      cell = cell * mNCells[i] + mAxes[i]->FindBin(x[i]);
+    }
+    if (mCounts[cell]++ == 0) {
+      mFilled.push_back(cell);
+    }
+  }
+
+  /// Adds the counts of the event to the histogram, with the values of its remaining axes
+  template <typename... Ts>
+  void flush(Ts... fixed)
+  {
+    static_assert(sizeof...(Ts) > 0, "the fixed axes of the event must be given");
+    const std::array<double, sizeof...(Ts)> xFixed{static_cast<double>(fixed)...};
+    std::array<int, NVar + sizeof...(Ts)> coords;
+    for (auto i = 0U; i < xFixed.size(); ++i) {
+      coords[NVar + i] = mHist->GetAxis(NVar + i)->FindBin(xFixed[i]);
+    }
+    int64_t nEntries = 0;
+    for (auto cell : mFilled) {
+      auto rest = cell;
+      for (auto i = 0; i < NVar; ++i) {
+        coords[i] = rest % mNCells[i];
+        rest /= mNCells[i];
+      }
+      const auto n = mCounts[cell];
+      const auto bin = mHist->GetBin(coords.data(), kTRUE);
+      mHist->SetBinContent(bin, mHist->GetBinContent(bin) + n);
+      if (mHist->GetCalculateErrors()) {
+        mHist->SetBinError2(bin, mHist->GetBinError2(bin) + n);
+      }
+      nEntries += n;
+      mCounts[cell] = 0;
+    }
+    mFilled.clear();
+    mHist->SetEntries(mHist->GetEntries() + nEntries);
+  }
+
+ private:
+  THnSparse* mHist = nullptr;
+  std::array<TAxis*, NVar> mAxes{};
+  std::array<int, NVar> mNCells{};
+  std::vector<uint32_t> mCounts; ///< counts of the event per cell of the varying axes
+  std::vector<int> mFilled;      ///< cells with non-zero counts
+};
 } // namespace
 
 struct MultiplicityCounter {
@@ -80,6 +154,7 @@ struct MultiplicityCounter {
   Configurable<float> estimatorEta{"estimatorEta", 1.0, "eta range for INEL>0 sample definition"};
   Configurable<bool> useEvSel{"useEvSel", true, "use event selection"};
   Configurable<bool> fillResponse{"fillResponse", false, "Fill response matrix"};
+  Configurable<bool> denseSparseFill{"denseSparseFill", false, "Accumulate the per-track centrality THnSparse fills per event"};
   ConfigurableAxis multBinning{"multBinning", {301, -0.5, 300.5}, ""};
   ConfigurableAxis centBinning{"centBinning", {VARIABLE_WIDTH, 0, 10, 20, 30, 40, 50, 60, 70, 80, 100}, ""};
 
@@ -95,6 +170,32 @@ struct MultiplicityCounter {
   std::vector<int> usedTracksIdsDFMC;
   std::vector<int> usedTracksIdsDFMCEff;
 
+  // collisions of each BC, as offsets into the collision indices
+  std::vector<int> bcCollisionOffsets;
+  std::vector<int> bcCollisionIndices;
+
+  // selected tracks of each charged particle of the sample, as offsets into the track records
+  struct RelatedTrack {
+    float eta;
+    float phi;
+    uint8_t itsClusterMap;
+    uint16_t mcMask;
+  };
+  struct ChargedParticle {
+    float pt;
+    float eta;
+    float phi;
+  };
+  std::vector<ChargedParticle> chargedParticles;
+  std::vector<int> relatedTrackOffsets;
+  std::vector<RelatedTrack> relatedTracksFlat;
+
+  EventSparseFill<1> denseEtaZvtx;
+  EventSparseFill<2> densePhiEta;
+  EventSparseFill<2> densePtEta;
+  EventSparseFill<2> denseDCAXYPt;
+  EventSparseFill<2> denseDCAZPt;
+
   void init(InitContext&)
   {
     AxisSpec MultAxis = {multBinning, "N_{trk}"};
@@ -165,6 +266,14 @@ struct MultiplicityCounter {
       registry.add({"Tracks/Centrality/Control/ReassignedTracksEtaZvtx", "; #eta; Z_{vtx} (cm); centrality", {HistType::kTHnSparseF, {EtaAxis, ZAxis, CentAxis}}});
       registry.add({"Tracks/Centrality/Control/ReassignedTracksPhiEta", "; #varphi; #eta; centrality", {HistType::kTHnSparseF, {PhiAxis, EtaAxis, CentAxis}}});
       registry.add({"Tracks/Centrality/Control/ReassignedVertexCorr", "; Z_{vtx}^{orig} (cm); Z_{vtx}^{re} (cm); centrality", {HistType::kTHnSparseF, {ZAxis, ZAxis, CentAxis}}});
+
+      if (denseSparseFill) {
+        denseEtaZvtx.init(registry.get<THnSparse>(HIST("Tracks/Centrality/EtaZvtx")).get());
+        densePhiEta.init(registry.get<THnSparse>(HIST("Tracks/Centrality/PhiEta")).get());
+        densePtEta.init(registry.get<THnSparse>(HIST("Tracks/Centrality/Control/PtEta")).get());
+        denseDCAXYPt.init(registry.get<THnSparse>(HIST("Tracks/Centrality/Control/DCAXYPt")).get());
+        denseDCAZPt.init(registry.get<THnSparse>(HIST("Tracks/Centrality/Control/DCAZPt")).get());
+      }
     }
 
     if (doprocessGen) {
@@ -251,29 +360,46 @@ struct MultiplicityCounter {
   void processEventStatGeneral(FullBCs const& bcs, C const& collisions)
   {
     constexpr bool hasCentrality = C::template contains<aod::CentFT0Cs>() || C::template contains<aod::CentFT0Ms>();
-    std::vector<typename std::decay_t<decltype(collisions)>::iterator> cols;
+
+    // collisions of each BC, in the order of the collision table, counted in one pass over the collisions
+    const int nBCs = bcs.size();
+    auto bcOf = [](auto const& collision) { return collision.has_foundBC() ? collision.foundBCId() : collision.bcId(); };
+    bcCollisionOffsets.assign(nBCs + 1, 0);
+    for (auto& collision : collisions) {
+      const auto bcId = bcOf(collision);
+      if (bcId >= 0 && bcId < nBCs) {
+        ++bcCollisionOffsets[bcId + 1];
+      }
+    }
+    for (auto i = 0; i < nBCs; ++i) {
+      bcCollisionOffsets[i + 1] += bcCollisionOffsets[i];
+    }
+    bcCollisionIndices.resize(bcCollisionOffsets[nBCs]);
+    std::vector<int> next(bcCollisionOffsets.begin(), bcCollisionOffsets.end() - 1);
+    auto row = 0;
+    for (auto& collision : collisions) {
+      const auto bcId = bcOf(collision);
+      if (bcId >= 0 && bcId < nBCs) {
+        bcCollisionIndices[next[bcId]++] = row;
+      }
+      ++row;
+    }
+
     for (auto& bc : bcs) {
       if (!useEvSel || (bc.selection_bit(evsel::kIsBBT0A) &&
                         bc.selection_bit(evsel::kIsBBT0C)) != 0) {
         registry.fill(HIST("Events/BCSelection"), 1.);
-        cols.clear();
-        for (auto& collision : collisions) {
-          if (collision.has_foundBC()) {
-            if (collision.foundBCId() == bc.globalIndex()) {
-              cols.emplace_back(collision);
-            }
-          } else if (collision.bcId() == bc.globalIndex()) {
-            cols.emplace_back(collision);
-          }
-        }
-        LOGP(debug, "BC {} has {} collisions", bc.globalBC(), cols.size());
-        if (!cols.empty()) {
+        const auto first = bcCollisionOffsets[bc.globalIndex()];
+        const auto nCols = bcCollisionOffsets[bc.globalIndex() + 1] - first;
+        LOGP(debug, "BC {} has {} collisions", bc.globalBC(), nCols);
+        if (nCols > 0) {
           registry.fill(HIST("Events/BCSelection"), 2.);
-          if (cols.size() > 1) {
+          if (nCols > 1) {
             registry.fill(HIST("Events/BCSelection"), 3.);
           }
         }
-        for (auto& col : cols) {
+        for (auto i = first; i < first + nCols; ++i) {
+          auto col = collisions.rawIteratorAt(bcCollisionIndices[i]);
           float c = -1;
           if constexpr (hasCentrality) {
             if constexpr (C::template contains<aod::CentFT0Cs>()) {
@@ -371,6 +497,22 @@ struct MultiplicityCounter {
       auto z = collision.posZ();
       usedTracksIds.clear();
 
+      auto fillCentralityTrack = [&](auto const& track, float dcaXY, float dcaZ) {
+        if (denseSparseFill) {
+          denseEtaZvtx.fill({track.eta()});
+          densePhiEta.fill({track.phi(), track.eta()});
+          densePtEta.fill({track.pt(), track.eta()});
+          denseDCAXYPt.fill({track.pt(), dcaXY});
+          denseDCAZPt.fill({track.pt(), dcaZ});
+          return;
+        }
+        registry.fill(HIST("Tracks/Centrality/EtaZvtx"), track.eta(), z, c);
+        registry.fill(HIST("Tracks/Centrality/PhiEta"), track.phi(), track.eta(), c);
+        registry.fill(HIST("Tracks/Centrality/Control/PtEta"), track.pt(), track.eta(), c);
+        registry.fill(HIST("Tracks/Centrality/Control/DCAXYPt"), track.pt(), dcaXY, c);
+        registry.fill(HIST("Tracks/Centrality/Control/DCAZPt"), track.pt(), dcaZ, c);
+      };
+
       auto Ntrks = 0;
       for (auto& track : atracks) {
         auto otrack = track.track_as<FiTracks>();
@@ -379,11 +521,7 @@ struct MultiplicityCounter {
           ++Ntrks;
         }
         if constexpr (hasCentrality) {
-          registry.fill(HIST("Tracks/Centrality/EtaZvtx"), otrack.eta(), z, c);
-          registry.fill(HIST("Tracks/Centrality/PhiEta"), otrack.phi(), otrack.eta(), c);
-          registry.fill(HIST("Tracks/Centrality/Control/PtEta"), otrack.pt(), otrack.eta(), c);
-          registry.fill(HIST("Tracks/Centrality/Control/DCAXYPt"), otrack.pt(), track.bestDCAXY(), c);
-          registry.fill(HIST("Tracks/Centrality/Control/DCAZPt"), otrack.pt(), track.bestDCAZ(), c);
+          fillCentralityTrack(otrack, track.bestDCAXY(), track.bestDCAZ());
         } else {
           registry.fill(HIST("Tracks/EtaZvtx"), otrack.eta(), z);
           registry.fill(HIST("Tracks/PhiEta"), otrack.phi(), otrack.eta());
@@ -431,11 +569,7 @@ struct MultiplicityCounter {
           ++Ntrks;
         }
         if constexpr (hasCentrality) {
-          registry.fill(HIST("Tracks/Centrality/EtaZvtx"), track.eta(), z, c);
-          registry.fill(HIST("Tracks/Centrality/PhiEta"), track.phi(), track.eta(), c);
-          registry.fill(HIST("Tracks/Centrality/Control/PtEta"), track.pt(), track.eta(), c);
-          registry.fill(HIST("Tracks/Centrality/Control/DCAXYPt"), track.pt(), track.dcaXY(), c);
-          registry.fill(HIST("Tracks/Centrality/Control/DCAZPt"), track.pt(), track.dcaZ(), c);
+          fillCentralityTrack(track, track.dcaXY(), track.dcaZ());
         } else {
           registry.fill(HIST("Tracks/EtaZvtx"), track.eta(), z);
           registry.fill(HIST("Tracks/PhiEta"), track.phi(), track.eta());
@@ -445,6 +579,13 @@ struct MultiplicityCounter {
         }
       }
       if constexpr (hasCentrality) {
+        if (denseSparseFill) {
+          denseEtaZvtx.flush(z, c);
+          densePhiEta.flush(c);
+          densePtEta.flush(c);
+          denseDCAXYPt.flush(c);
+          denseDCAZPt.flush(c);
+        }
         registry.fill(HIST("Events/Centrality/NtrkZvtx"), Ntrks, z, c);
       } else {
         if (Ntrks > 0) {
@@ -526,6 +667,10 @@ struct MultiplicityCounter {
     auto mcCollision = collision.mcCollision();
     auto sample = particles.sliceByCached(aod::mcparticle::mcCollisionId, mcCollision.globalIndex(), cache);
 
+    // the selected tracks of the charged particles are read once from the particles2tracks index
+    chargedParticles.clear();
+    relatedTrackOffsets.assign(1, 0);
+    relatedTracksFlat.clear();
     for (auto& particle : sample) {
       auto charge = 0.;
       auto p = pdg->GetParticle(particle.pdgCode());
@@ -535,58 +680,56 @@ struct MultiplicityCounter {
       if (std::abs(charge) < 3.) {
         continue;
       }
-      registry.fill(HIST("Tracks/Control/PtGenINoEtaCut"), particle.pt());
-      if (std::abs(particle.eta()) < estimatorEta) {
-        registry.fill(HIST("Tracks/Control/PtGenI"), particle.pt());
-      }
+      chargedParticles.push_back({particle.pt(), particle.eta(), particle.phi()});
       if (particle.has_tracks()) {
-        auto counted = false;
-        auto countedNoEtaCut = false;
-        auto counter = 0;
-        auto relatedTracks = particle.template filtered_tracks_as<FiLTracks>();
-        for (auto const& track : relatedTracks) {
-          ++counter;
-          if (!countedNoEtaCut) {
-            registry.fill(HIST("Tracks/Control/PtEfficiencyINoEtaCut"), particle.pt());
-            countedNoEtaCut = true;
-          }
-          if (std::abs(track.eta()) < estimatorEta) {
-            if (!counted) {
-              registry.fill(HIST("Tracks/Control/PtEfficiencyI"), particle.pt());
-              counted = true;
-            }
+        for (auto const& track : particle.template filtered_tracks_as<FiLTracks>()) {
+          relatedTracksFlat.push_back({track.eta(), track.phi(), track.itsClusterMap(), track.mcMask()});
+        }
+      }
+      relatedTrackOffsets.push_back(relatedTracksFlat.size());
+    }
+
+    for (auto ip = 0U; ip < chargedParticles.size(); ++ip) {
+      auto const& particle = chargedParticles[ip];
+      registry.fill(HIST("Tracks/Control/PtGenINoEtaCut"), particle.pt);
+      if (std::abs(particle.eta) < estimatorEta) {
+        registry.fill(HIST("Tracks/Control/PtGenI"), particle.pt);
+      }
+      const auto first = relatedTracksFlat.begin() + relatedTrackOffsets[ip];
+      const auto last = relatedTracksFlat.begin() + relatedTrackOffsets[ip + 1];
+      if (first == last) {
+        continue;
+      }
+      registry.fill(HIST("Tracks/Control/PtEfficiencyINoEtaCut"), particle.pt);
+      auto counted = false;
+      for (auto track = first; track != last; ++track) {
+        if (std::abs(track->eta) < estimatorEta) {
+          if (!counted) {
+            registry.fill(HIST("Tracks/Control/PtEfficiencyI"), particle.pt);
+            counted = true;
           }
-          if (counter > 1) {
-            registry.fill(HIST("Tracks/Control/PtEfficiencyISecondariesNoEtaCut"), particle.pt());
-            if (std::abs(track.eta()) < estimatorEta) {
-              registry.fill(HIST("Tracks/Control/PtEfficiencyISecondaries"), particle.pt());
-            }
+          if (track != first) {
+            registry.fill(HIST("Tracks/Control/PtEfficiencyISecondaries"), particle.pt);
           }
         }
-        if (counter > 1) {
-          for (auto const& track : relatedTracks) {
-            for (auto layer = 0; layer < 7; ++layer) {
-              if (track.itsClusterMap() & (uint8_t(1) << layer)) {
-                registry.fill(HIST("Tracks/Control/ITSClusters"), layer + 1);
-              }
-            }
-            auto hasbit = false;
-            for (auto bit = 0; bit < 16; ++bit) {
-              if (track.mcMask() & (uint8_t(1) << bit)) {
-                registry.fill(HIST("Tracks/Control/Mask"), bit);
-                hasbit = true;
-              }
-            }
-            if (!hasbit) {
-              registry.fill(HIST("Tracks/Control/Mask"), 16);
-            }
-          }
+        if (track != first) {
+          registry.fill(HIST("Tracks/Control/PtEfficiencyISecondariesNoEtaCut"), particle.pt);
         }
-        if (relatedTracks.size() > 1) {
-          registry.fill(HIST("Tracks/Control/PhiEtaGenDuplicates"), particle.phi(), particle.eta());
-          for (auto const& track : relatedTracks) {
-            registry.fill(HIST("Tracks/Control/PhiEtaDuplicates"), track.phi(), track.eta());
+      }
+      if (last - first > 1) {
+        registry.fill(HIST("Tracks/Control/PhiEtaGenDuplicates"), particle.phi, particle.eta);
+        for (auto track = first; track != last; ++track) {
+          // only the set bits are visited
+          for (uint8_t layers = track->itsClusterMap & 0x7f; layers != 0; layers &= layers - 1) {
+            registry.fill(HIST("Tracks/Control/ITSClusters"), __builtin_ctz(layers) + 1);
+          }
+          if (track->mcMask == 0) {
+            registry.fill(HIST("Tracks/Control/Mask"), 16);
+          }
+          for (uint16_t bits = track->mcMask; bits != 0; bits &= bits - 1) {
+            registry.fill(HIST("Tracks/Control/Mask"), __builtin_ctz(bits));
           }
+          registry.fill(HIST("Tracks/Control/PhiEtaDuplicates"), track->phi, track->eta);
         }
       }
     }
@@ -8,6 +8,8 @@
 // In applying this license CERN does not waive the privileges and immunities
 // granted to it by virtue of its status as an Intergovernmental Organization
 // or submit itself to any jurisdiction.
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <vector>
 
@@ -25,7 +27,7 @@
 #include "Common/DataModel/Multiplicity.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 
-#include <TGraph.h>
+#include "flatenicityTable.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -57,6 +59,40 @@ struct flatenictyFV0 {
   static constexpr std::string_view nhPtEst[8] = {
     "ptVsGlobaltrack", "ptVsFV0", "ptVs1flatencityFV0", "ptVsFT0", "ptVs1flatencityFT0", "ptVsFV0FT0C", "ptVs1flatencityFV0FT0C", "pTVsPtTrig"};
 
+  Produces<aod::Flatenicities> flatenicityTable;
+
+  static constexpr int nCells = 48; // 48 sectors in FV0
+  static constexpr int nCellsT0A = 24;
+  static constexpr int nCellsT0C = 28;
+  static constexpr int nBinsVtx = 30;
+  static constexpr int innerFV0 = 32;
+  static constexpr float maxEtaFV0 = 5.1;
+  static constexpr float minEtaFV0 = 2.2;
+
+  // V0A calibration
+  static constexpr float calib[nCells] = {1.01697, 1.122, 1.03854, 1.108, 1.11634, 1.14971, 1.19321, 1.06866, 0.954675, 0.952695, 0.969853, 0.957557, 0.989784, 1.01549, 1.02182, 0.976005, 1.01865, 1.06871, 1.06264, 1.02969, 1.07378, 1.06622, 1.15057, 1.0433, 0.83654, 0.847178, 0.890027, 0.920814, 0.888271, 1.04662, 0.8869, 0.856348, 0.863181, 0.906312, 0.902166, 1.00122, 1.03303, 0.887866, 0.892437, 0.906278, 0.884976, 0.864251, 0.917221, 1.10618, 1.04028, 0.893184, 0.915734, 0.892676};
+  // calibration T0C
+  static constexpr float calibT0C[nCellsT0C] = {0.949829, 1.05408, 1.00681, 1.00724, 0.990663, 0.973571, 0.9855, 1.03726, 1.02526, 1.00467, 0.983008, 0.979349, 0.952352, 0.985775, 1.013, 1.01721, 0.993948, 0.996421, 0.971871, 1.02921, 0.989641, 1.01885, 1.01259, 0.929502, 1.03969, 1.02496, 1.01385, 1.01711};
+  // calibration T0A
+  static constexpr float calibT0A[nCellsT0A] = {0.86041, 1.10607, 1.17724, 0.756397, 1.14954, 1.0879, 0.829438, 1.09014, 1.16515, 0.730077, 1.06722, 0.906344, 0.824167, 1.14716, 1.20692, 0.755034, 1.11734, 1.00556, 0.790522, 1.09138, 1.16225, 0.692458, 1.12428, 1.01127};
+  // vtx bins of the calibrations vs vtx, 1 cm wide
+  static constexpr float biningVtxt[nBinsVtx] = {-14.5, -13.5, -12.5, -11.5, -10.5, -9.5, -8.5, -7.5, -6.5, -5.5, -4.5, -3.5, -2.5, -1.5, -0.5, 0.5, 1.5, 2.5, 3.5, 4.5, 5.5, 6.5, 7.5, 8.5, 9.5, 10.5, 11.5, 12.5, 13.5, 14.5};
+  // calibration factor FV0 vs vtx
+  static constexpr float calibFV0vtx[nBinsVtx] = {0.907962, 0.934607, 0.938929, 0.950987, 0.950817, 0.966362, 0.968509, 0.972741, 0.982412, 0.984872, 0.994543, 0.996003, 0.99435, 1.00266, 0.998245, 1.00584, 1.01078, 1.01003, 1.00726, 1.00872, 1.01726, 1.02015, 1.0193, 1.01106, 1.02229, 1.02104, 1.03435, 1.00822, 1.01921, 1.01736};
+  // calibration FT0A vs vtx
+  static constexpr float calibFT0Avtx[nBinsVtx] = {0.924334, 0.950988, 0.959604, 0.965607, 0.970016, 0.979057, 0.978384, 0.982005, 0.992825, 0.990048, 0.998588, 0.997338, 1.00102, 1.00385, 0.99492, 1.01083, 1.00703, 1.00494, 1.00063, 1.0013, 1.00777, 1.01238, 1.01179, 1.00577, 1.01028, 1.017, 1.02975, 1.0085, 1.00856, 1.01662};
+  // calibration FT0C vs vtx
+  static constexpr float calibFT0Cvtx[nBinsVtx] = {1.02096, 1.01245, 1.02148, 1.03605, 1.03561, 1.03667, 1.04229, 1.0327, 1.03674, 1.02764, 1.01828, 1.02331, 1.01864, 1.015, 1.01197, 1.00615, 0.996845, 0.993051, 0.985635, 0.982883, 0.981914, 0.964635, 0.967812, 0.95475, 0.956687, 0.932816, 0.92773, 0.914892, 0.891724, 0.872382};
+
+  // per channel of the digits, filled once in init from the geometry and the calibrations
+  std::array<int, nCells> fv0CellIndex{};       // cell of the channel, ordered in phi
+  std::array<float, nCells> fv0Eta{};
+  std::array<float, nCells> fv0Phi{};
+  std::array<float, nCells> fv0Gain{};          // 1 without the channel calibration
+  std::array<float, nCells> fv0LatticeWeight{}; // 1/2 for the outer channels, two channels per cell
+  std::array<float, nCellsT0A> gainT0A{};
+  std::array<float, nCellsT0C> gainT0C{};
+
   void init(o2::framework::InitContext&)
   {
     int nBinsEst[8] = {100, 500, 102, 500, 102, 500, 102, 150};
@@ -146,30 +182,29 @@ struct flatenictyFV0 {
     flatenicity.add("hAmpT0CvsVtx", "", HistType::kTH2F,
                     {{30, -15.0, +15.0, "Vtx_z"},
                      {600, -0.5, +5999.5, "FT0C amplitude"}});
-  }
-  int getT0ASector(int i_ch)
-  {
-    int i_sec_t0a = -1;
-    for (int i_sec = 0; i_sec < 24; ++i_sec) {
-      if (i_ch >= 4 * i_sec && i_ch <= 3 + 4 * i_sec) {
-        i_sec_t0a = i_sec;
-        break;
+
+    const float detaFV0 = (maxEtaFV0 - minEtaFV0) / 5.0;
+    for (int ch = 0; ch < nCells; ++ch) {
+      int ringindex = getFV0Ring(ch);
+      int channelv0phi = getFV0IndexPhi(ch);
+      fv0CellIndex[ch] = channelv0phi;
+      fv0Eta[ch] = maxEtaFV0 - (detaFV0 / 2.0) * (2.0 * ringindex + 1);
+      if (ch < innerFV0) {
+        fv0Phi[ch] = (2.0 * (channelv0phi - 8 * ringindex) + 1) * M_PI / (8.0);
+        fv0LatticeWeight[ch] = 1.f;
+      } else {
+        fv0Phi[ch] = ((2.0 * channelv0phi) + 1 - 64.0) * 2.0 * M_PI / (32.0);
+        fv0LatticeWeight[ch] = 0.5f;
       }
+      fv0Gain[ch] = applyCalibCh ? calib[channelv0phi] : 1.f;
     }
-    return i_sec_t0a;
-  }
-  int getT0CSector(int i_ch)
-  {
-    int i_sec_t0c = -1;
-    for (int i_sec = 0; i_sec < 28; ++i_sec) {
-      if (i_ch >= 4 * i_sec && i_ch <= 3 + 4 * i_sec) {
-        i_sec_t0c = i_sec;
-        break;
-      }
+    for (int sec = 0; sec < nCellsT0A; ++sec) {
+      gainT0A[sec] = applyCalibCh ? calibT0A[sec] : 1.f;
+    }
+    for (int sec = 0; sec < nCellsT0C; ++sec) {
+      gainT0C[sec] = applyCalibCh ? calibT0C[sec] : 1.f;
     }
-    return i_sec_t0c;
   }
-
   int getFV0Ring(int i_ch)
   {
     int i_ring = -1;
@@ -281,26 +316,31 @@ struct flatenictyFV0 {
     }
     return i_ring;
   }
-  float GetFlatenicity(float signals[], int entries)
+  /// Calibration vs vtx, linearly interpolated between the bin centres and extrapolated beyond them
+  float getVtxCalib(const float (&calibVtx)[nBinsVtx], float vtxZ)
   {
-    float flat = 9999;
-    float mRho = 0;
-    for (int iCell = 0; iCell < entries; ++iCell) {
-      mRho += 1.0 * signals[iCell];
-    }
-    // average activity per cell
-    mRho /= (1.0 * entries);
-    // get sigma
-    float sRho_tmp = 0;
-    for (int iCell = 0; iCell < entries; ++iCell) {
-      sRho_tmp += TMath::Power(1.0 * signals[iCell] - mRho, 2);
+    int bin = static_cast<int>(std::floor(vtxZ - biningVtxt[0]));
+    bin = std::clamp(bin, 0, nBinsVtx - 2);
+    return calibVtx[bin] + (calibVtx[bin + 1] - calibVtx[bin]) * (vtxZ - biningVtxt[bin]);
+  }
+
+  /// Relative spread of the signals of the cells, sigma/rho, from their sum and sum of squares in a single pass
+  template <std::size_t N>
+  float getFlatenicity(std::array<float, N> const& signals)
+  {
+    double sumRho = 0.;
+    double sumRho2 = 0.;
+    for (auto signal : signals) {
+      sumRho += signal;
+      sumRho2 += signal * signal;
     }
-    sRho_tmp /= (1.0 * entries * entries);
-    float sRho = TMath::Sqrt(sRho_tmp);
-    if (mRho > 0) {
-      flat = sRho / mRho;
+    if (sumRho <= 0.) {
+      return 9999;
     }
-    return flat;
+    // average activity per cell, and sigma of the average
+    double mRho = sumRho / N;
+    double sRho = std::sqrt(std::max(sumRho2 / N - mRho * mRho, 0.) / N);
+    return sRho / mRho;
   }
 
   Filter trackFilter = (nabs(aod::track::eta) < cfgTrkEtaCut) &&
@@ -316,32 +356,22 @@ struct flatenictyFV0 {
                aod::MFTTracks const& mfttracks, aod::FT0s const& ft0s,
                aod::FV0As const& fv0s)
   {
-    bool isAcceptedEvent = false;
-    if (isRun3 ? collision.sel8() : collision.sel7()) {
-      isAcceptedEvent = true;
-    }
-    // only PS
-    if (!isAcceptedEvent) {
-      return;
-    }
-
+    // the flatenicities are computed for all the collisions, for the table,
+    // and only the good events fill the histograms
     auto vtxZ = collision.posZ();
-    flatenicity.fill(HIST("hEv"), 0);
-    flatenicity.fill(HIST("hvtxZ"), vtxZ);
-
-    flatenicity.fill(HIST("hEv"), 1);
     bool isGoodEvent = false;
-    if (vtxZ > -15.f && vtxZ < 15.0f) {
-      flatenicity.fill(HIST("hEv"), 2);
-      isGoodEvent = true;
-    }
-
-    if (!isGoodEvent) {
-      return;
+    // only PS
+    if (isRun3 ? collision.sel8() : collision.sel7()) {
+      flatenicity.fill(HIST("hEv"), 0);
+      flatenicity.fill(HIST("hvtxZ"), vtxZ);
+      flatenicity.fill(HIST("hEv"), 1);
+      if (vtxZ > -15.f && vtxZ < 15.0f) {
+        flatenicity.fill(HIST("hEv"), 2);
+        isGoodEvent = true;
+        flatenicity.fill(HIST("hEv"), 3);
+      }
     }
 
-    flatenicity.fill(HIST("hEv"), 3);
-
     const int nEta5 = 2; // FT0C + FT0A
     float weigthsEta5[nEta5] = {0.0490638, 0.010958415};
     float deltaEeta5[nEta5] = {1.1, 1.2};
@@ -353,107 +383,50 @@ struct flatenictyFV0 {
     float ampl6[nEta6] = {0, 0};
 
     // V0A signal and flatenicity calculation
-    float calib[48] = {1.01697, 1.122, 1.03854, 1.108, 1.11634, 1.14971, 1.19321, 1.06866, 0.954675, 0.952695, 0.969853, 0.957557, 0.989784, 1.01549, 1.02182, 0.976005, 1.01865, 1.06871, 1.06264, 1.02969, 1.07378, 1.06622, 1.15057, 1.0433, 0.83654, 0.847178, 0.890027, 0.920814, 0.888271, 1.04662, 0.8869, 0.856348, 0.863181, 0.906312, 0.902166, 1.00122, 1.03303, 0.887866, 0.892437, 0.906278, 0.884976, 0.864251, 0.917221, 1.10618, 1.04028, 0.893184, 0.915734, 0.892676};
-    // calibration T0C
-    float calibT0C[28] = {0.949829, 1.05408, 1.00681, 1.00724, 0.990663, 0.973571, 0.9855, 1.03726, 1.02526, 1.00467, 0.983008, 0.979349, 0.952352, 0.985775, 1.013, 1.01721, 0.993948, 0.996421, 0.971871, 1.02921, 0.989641, 1.01885, 1.01259, 0.929502, 1.03969, 1.02496, 1.01385, 1.01711};
-    // calibration T0A
-    float calibT0A[24] = {0.86041, 1.10607, 1.17724, 0.756397, 1.14954, 1.0879, 0.829438, 1.09014, 1.16515, 0.730077, 1.06722, 0.906344, 0.824167, 1.14716, 1.20692, 0.755034, 1.11734, 1.00556, 0.790522, 1.09138, 1.16225, 0.692458, 1.12428, 1.01127};
-    // calibration factor MFT vs vtx
-    float biningVtxt[30] = {-14.5, -13.5, -12.5, -11.5, -10.5, -9.5, -8.5, -7.5, -6.5, -5.5, -4.5, -3.5, -2.5, -1.5, -0.5, 0.5, 1.5, 2.5, 3.5, 4.5, 5.5, 6.5, 7.5, 8.5, 9.5, 10.5, 11.5, 12.5, 13.5, 14.5};
-
-    // calibration factor FV0 vs vtx
-    float calibFV0vtx[30] = {0.907962, 0.934607, 0.938929, 0.950987, 0.950817, 0.966362, 0.968509, 0.972741, 0.982412, 0.984872, 0.994543, 0.996003, 0.99435, 1.00266, 0.998245, 1.00584, 1.01078, 1.01003, 1.00726, 1.00872, 1.01726, 1.02015, 1.0193, 1.01106, 1.02229, 1.02104, 1.03435, 1.00822, 1.01921, 1.01736};
-    // calibration FT0A vs vtx
-    float calibFT0Avtx[30] = {0.924334, 0.950988, 0.959604, 0.965607, 0.970016, 0.979057, 0.978384, 0.982005, 0.992825, 0.990048, 0.998588, 0.997338, 1.00102, 1.00385, 0.99492, 1.01083, 1.00703, 1.00494, 1.00063, 1.0013, 1.00777, 1.01238, 1.01179, 1.00577, 1.01028, 1.017, 1.02975, 1.0085, 1.00856, 1.01662};
-    // calibration FT0C vs vtx
-    float calibFT0Cvtx[30] = {1.02096, 1.01245, 1.02148, 1.03605, 1.03561, 1.03667, 1.04229, 1.0327, 1.03674, 1.02764, 1.01828, 1.02331, 1.01864, 1.015, 1.01197, 1.00615, 0.996845, 0.993051, 0.985635, 0.982883, 0.981914, 0.964635, 0.967812, 0.95475, 0.956687, 0.932816, 0.92773, 0.914892, 0.891724, 0.872382};
-
-    const int nDetVtx = 3;
-    TGraph* gVtx[nDetVtx];
-    const char* nameDet[nDetVtx] = {"AmpV0", "AmpT0A", "AmpT0C"};
-    for (int i_d = 0; i_d < nDetVtx; ++i_d) {
-      gVtx[i_d] = 0;
-      gVtx[i_d] = new TGraph();
-    }
-    for (int i_v = 0; i_v < 30; ++i_v) {
-      gVtx[0]->SetPoint(i_v, biningVtxt[i_v], calibFV0vtx[i_v]);
-    }
-    for (int i_v = 0; i_v < 30; ++i_v) {
-      gVtx[1]->SetPoint(i_v, biningVtxt[i_v], calibFT0Avtx[i_v]);
-    }
-    for (int i_v = 0; i_v < 30; ++i_v) {
-      gVtx[2]->SetPoint(i_v, biningVtxt[i_v], calibFT0Cvtx[i_v]);
-    }
-
-    for (int i_d = 0; i_d < nDetVtx; ++i_d) {
-      gVtx[i_d]->SetName(Form("g%s", nameDet[i_d]));
-    }
-
     float sumAmpFV0 = 0;
     float sumAmpFV01to4Ch = 0;
-    int innerFV0 = 32;
-    float maxEtaFV0 = 5.1;
-    float minEtaFV0 = 2.2;
-    float detaFV0 = (maxEtaFV0 - minEtaFV0) / 5.0;
-
-    const int nCells = 48; // 48 sectors in FV0
-    float ampchannel[48];
-    for (int iCell = 0; iCell < nCells; ++iCell) {
-      ampchannel[iCell] = 0.0;
-    }
-    float ampchannelBefore[48];
-    for (int iCell = 0; iCell < nCells; ++iCell) {
-      ampchannelBefore[iCell] = 0.0;
-    }
-
-    float RhoLattice[nCells];
-    for (Int_t iCh = 0; iCh < nCells; iCh++) {
-      RhoLattice[iCh] = 0;
-    }
+    std::array<float, nCells> ampchannel{};
+    std::array<float, nCells> ampchannelBefore{};
+    std::array<float, nCells> RhoLattice{};
 
     if (collision.has_foundFV0()) {
-
       auto fv0 = collision.foundFV0();
-      for (std::size_t ich = 0; ich < fv0.amplitude().size(); ich++) {
-        float phiv0 = -999.0;
-        float etav0 = -999.0;
-        int channelv0 = fv0.channel()[ich];
-        float ampl_ch = fv0.amplitude()[ich];
-        int ringindex = getFV0Ring(channelv0);
-        int channelv0phi = getFV0IndexPhi(channelv0);
-        etav0 = maxEtaFV0 - (detaFV0 / 2.0) * (2.0 * ringindex + 1);
-        if (channelv0 < innerFV0) {
-          phiv0 = (2.0 * (channelv0phi - 8 * ringindex) + 1) * M_PI / (8.0);
-        } else {
-          phiv0 = ((2.0 * channelv0phi) + 1 - 64.0) * 2.0 * M_PI / (32.0);
+      auto amplitudes = fv0.amplitude();
+      auto channels = fv0.channel();
+      for (std::size_t ich = 0; ich < amplitudes.size(); ich++) {
+        int channelv0 = channels[ich];
+        if (channelv0 >= nCells) {
+          continue;
         }
+        float ampl_ch = amplitudes[ich];
+        int channelv0phi = fv0CellIndex[channelv0];
         ampchannelBefore[channelv0phi] = ampl_ch;
-        if (applyCalibCh) {
-          ampl_ch *= calib[channelv0phi];
-        }
+        ampl_ch *= fv0Gain[channelv0];
         sumAmpFV0 += ampl_ch;
 
         if (channelv0 >= 8) { // exclude the 1st ch, eta 2.2,4.52
           sumAmpFV01to4Ch += ampl_ch;
         }
-        flatenicity.fill(HIST("fEtaPhiFv0"), phiv0, etav0, ampl_ch);
-        ampchannel[channelv0phi] = ampl_ch;
-        if (channelv0 < innerFV0) {
-          RhoLattice[channelv0phi] = ampl_ch;
-        } else {
-          RhoLattice[channelv0phi] = ampl_ch / 2.0; // two channels per bin
+        if (isGoodEvent) {
+          flatenicity.fill(HIST("fEtaPhiFv0"), fv0Phi[channelv0], fv0Eta[channelv0], ampl_ch);
         }
+        ampchannel[channelv0phi] = ampl_ch;
+        RhoLattice[channelv0phi] = ampl_ch * fv0LatticeWeight[channelv0];
+      }
+      if (isGoodEvent) {
+        flatenicity.fill(HIST("hAmpV0vsVtxBeforeCalibration"), vtxZ, sumAmpFV0);
       }
-      flatenicity.fill(HIST("hAmpV0vsVtxBeforeCalibration"), vtxZ, sumAmpFV0);
       if (applyCalibVtx) {
-        sumAmpFV0 *= gVtx[0]->Eval(vtxZ);
-        sumAmpFV01to4Ch *= gVtx[0]->Eval(vtxZ);
+        float calibVtx = getVtxCalib(calibFV0vtx, vtxZ);
+        sumAmpFV0 *= calibVtx;
+        sumAmpFV01to4Ch *= calibVtx;
+      }
+      if (isGoodEvent) {
+        flatenicity.fill(HIST("hAmpV0vsVtx"), vtxZ, sumAmpFV0);
       }
-      flatenicity.fill(HIST("hAmpV0vsVtx"), vtxZ, sumAmpFV0);
     }
 
-    float flattenicityfv0 = 9999;
-    flattenicityfv0 = GetFlatenicity(RhoLattice, nCells);
+    float flattenicityfv0 = getFlatenicity(RhoLattice);
 
     // global tracks
     float ptT = 0.;
@@ -468,66 +441,77 @@ struct flatenictyFV0 {
       multGlob++;
     }
 
-    // FT0
+    // FT0, four channels per sector
     float sumAmpFT0A = 0.f;
     float sumAmpFT0C = 0.f;
-    const int nCellsT0A = 24;
-    float RhoLatticeT0A[nCellsT0A];
-    for (int iCh = 0; iCh < nCellsT0A; iCh++) {
-      RhoLatticeT0A[iCh] = 0.0;
-    }
-    const int nCellsT0C = 28;
-    float RhoLatticeT0C[nCellsT0C];
-    for (int iCh = 0; iCh < nCellsT0C; iCh++) {
-      RhoLatticeT0C[iCh] = 0.0;
-    }
+    std::array<float, nCellsT0A> RhoLatticeT0A{};
+    std::array<float, nCellsT0C> RhoLatticeT0C{};
 
     if (collision.has_foundFT0()) {
       auto ft0 = collision.foundFT0();
-      for (std::size_t i_a = 0; i_a < ft0.amplitudeA().size(); i_a++) {
-        float amplitude = ft0.amplitudeA()[i_a];
-        uint8_t channel = ft0.channelA()[i_a];
-        int sector = getT0ASector(channel);
-        if (sector >= 0 && sector < 24) {
+      auto amplitudesA = ft0.amplitudeA();
+      auto channelsA = ft0.channelA();
+      for (std::size_t i_a = 0; i_a < amplitudesA.size(); i_a++) {
+        float amplitude = amplitudesA[i_a];
+        int sector = channelsA[i_a] / 4;
+        if (sector < nCellsT0A) {
           RhoLatticeT0A[sector] += amplitude;
-          flatenicity.fill(HIST("hAmpT0AVsChBeforeCalibration"), sector, amplitude);
-          if (applyCalibCh) {
-            amplitude *= calibT0A[sector];
+          if (isGoodEvent) {
+            flatenicity.fill(HIST("hAmpT0AVsChBeforeCalibration"), sector, amplitude);
+          }
+          amplitude *= gainT0A[sector];
+          if (isGoodEvent) {
+            flatenicity.fill(HIST("hAmpT0AVsCh"), sector, amplitude);
           }
-          flatenicity.fill(HIST("hAmpT0AVsCh"), sector, amplitude);
         }
         sumAmpFT0A += amplitude;
-        flatenicity.fill(HIST("hFT0A"), amplitude);
+        if (isGoodEvent) {
+          flatenicity.fill(HIST("hFT0A"), amplitude);
+        }
       }
 
-      for (std::size_t i_c = 0; i_c < ft0.amplitudeC().size(); i_c++) {
-        float amplitude = ft0.amplitudeC()[i_c];
+      auto amplitudesC = ft0.amplitudeC();
+      auto channelsC = ft0.channelC();
+      for (std::size_t i_c = 0; i_c < amplitudesC.size(); i_c++) {
+        float amplitude = amplitudesC[i_c];
         sumAmpFT0C += amplitude;
-        uint8_t channel = ft0.channelC()[i_c];
-        int sector = getT0CSector(channel);
-        if (sector >= 0 && sector < 28) {
+        int sector = channelsC[i_c] / 4;
+        if (sector < nCellsT0C) {
           RhoLatticeT0C[sector] += amplitude;
-          flatenicity.fill(HIST("hAmpT0CVsChBeforeCalibration"), sector, amplitude);
-          if (applyCalibCh) {
-            amplitude *= calibT0C[sector];
+          if (isGoodEvent) {
+            flatenicity.fill(HIST("hAmpT0CVsChBeforeCalibration"), sector, amplitude);
           }
-          flatenicity.fill(HIST("hAmpT0CVsCh"), sector, amplitude);
+          amplitude *= gainT0C[sector];
+          if (isGoodEvent) {
+            flatenicity.fill(HIST("hAmpT0CVsCh"), sector, amplitude);
+          }
+        }
+        if (isGoodEvent) {
+          flatenicity.fill(HIST("hFT0C"), amplitude);
         }
-        flatenicity.fill(HIST("hFT0C"), amplitude);
       }
-      flatenicity.fill(HIST("hAmpT0AvsVtxBeforeCalibration"), vtxZ, sumAmpFT0A);
-      flatenicity.fill(HIST("hAmpT0CvsVtxBeforeCalibration"), vtxZ, sumAmpFT0C);
+      if (isGoodEvent) {
+        flatenicity.fill(HIST("hAmpT0AvsVtxBeforeCalibration"), vtxZ, sumAmpFT0A);
+        flatenicity.fill(HIST("hAmpT0CvsVtxBeforeCalibration"), vtxZ, sumAmpFT0C);
+      }
       if (applyCalibVtx) {
-        sumAmpFT0A *= gVtx[1]->Eval(vtxZ);
-        sumAmpFT0C *= gVtx[2]->Eval(vtxZ);
+        sumAmpFT0A *= getVtxCalib(calibFT0Avtx, vtxZ);
+        sumAmpFT0C *= getVtxCalib(calibFT0Cvtx, vtxZ);
+      }
+      if (isGoodEvent) {
+        flatenicity.fill(HIST("hAmpT0AvsVtx"), vtxZ, sumAmpFT0A);
+        flatenicity.fill(HIST("hAmpT0CvsVtx"), vtxZ, sumAmpFT0C);
       }
-      flatenicity.fill(HIST("hAmpT0AvsVtx"), vtxZ, sumAmpFT0A);
-      flatenicity.fill(HIST("hAmpT0CvsVtx"), vtxZ, sumAmpFT0C);
     }
-    float flatenicity_t0a = 9999;
-    flatenicity_t0a = GetFlatenicity(RhoLatticeT0A, nCellsT0A);
-    float flatenicity_t0c = 9999;
-    flatenicity_t0c = GetFlatenicity(RhoLatticeT0C, nCellsT0C);
+    float flatenicity_t0a = getFlatenicity(RhoLatticeT0A);
+    float flatenicity_t0c = getFlatenicity(RhoLatticeT0C);
+
+    flatenicityTable(flattenicityfv0, flatenicity_t0a, flatenicity_t0c,
+                     sumAmpFV0, sumAmpFT0A, sumAmpFT0C, multGlob, ptT);
+
+    if (!isGoodEvent) {
+      return;
+    }
 
     bool isOK_estimator5 = false;
     bool isOK_estimator6 = false;
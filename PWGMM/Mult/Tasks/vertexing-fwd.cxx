@@ -29,6 +29,8 @@
 #include "CommonConstants/MathConstants.h"
 #include "CommonConstants/LHCConstants.h"
 
+#include "PWGMM/Core/fwdTrackDCA.h"
+
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::track;
@@ -46,6 +48,7 @@ struct vertexingfwd {
 
   Configurable<float> maxDCAXY{"maxDCAXY", 6.0, "max allowed transverse DCA"}; // To be used when associating ambitrack to collision using best DCA
   std::vector<uint64_t> ambTrackIds;
+  o2::pwgmm::FwdTrackDCA fwdDCA; // DCAs of the ambiguous tracks to their compatible collisions
 
   HistogramRegistry registry{
     "registry",
@@ -118,7 +121,7 @@ struct vertexingfwd {
   }
 
   void processDCAamb(MFTTracksLabeled const&,
-                     CollisionsLabeled const&, ExtBCs const& bcs,
+                     CollisionsLabeled const& collisions, ExtBCs const& bcs,
                      aod::AmbiguousMFTTracks const& atracks,
                      aod::McParticles const&,
                      aod::McCollisions const&)
@@ -133,14 +136,24 @@ struct vertexingfwd {
     // initCCDB(bcs.begin()); if Bz is needed
     ambTrackIds.clear();
 
-    float dcaXY;
-    float bestDCA, bestDCAX, bestDCAY;
-    o2::track::TrackParCovFwd bestTrackPar;
-
+    // linear propagation of all the ambiguous tracks to their compatible collisions, in one pass
+    fwdDCA.clear();
     for (auto& atrack : atracks) {
+      fwdDCA.addTrack(atrack.mfttrack_as<MFTTracksLabeled>());
+      for (auto& bc : atrack.bc_as<ExtBCs>()) {
+        if (!bc.has_collisions()) {
+          continue;
+        }
+        for (auto const& collision : bc.collisions_as<CollisionsLabeled>()) { // compatible collisions
+          fwdDCA.addCollision(collision);
+        }
+      }
+    }
+    fwdDCA.compute(0.f);
 
-      dcaXY = 999; // DCAxy
-      bestDCA = 999;
+    auto iTrack = -1;
+    for (auto& atrack : atracks) {
+      ++iTrack;
 
       auto track = atrack.mfttrack_as<MFTTracksLabeled>();
       if (track.has_collision()) {
@@ -152,43 +165,24 @@ struct vertexingfwd {
       }
       auto particle = track.mcParticle();
 
+      for (auto i = fwdDCA.first(iTrack); i < fwdDCA.last(iTrack); ++i) {
+        registry.fill(HIST("Ambiguous/TracksDCAXY"), fwdDCA.dcaXY(i));
+        registry.fill(HIST("Ambiguous/TracksDCAX"), fwdDCA.dcaX(i));
+        registry.fill(HIST("Ambiguous/TracksDCAY"), fwdDCA.dcaY(i));
+      }
+
       auto bestCol = track.has_collision() ? track.collisionId() : -1;
       int bestMCCol = -1;
-      std::vector<double> v1; // Temporary null vector for the computation of the covariance matrix
-      SMatrix55 tcovs(v1.begin(), v1.end());
-      SMatrix5 tpars(track.x(), track.y(), track.phi(), track.tgl(), track.signed1Pt());
-      o2::track::TrackParCovFwd trackPar{track.z(), tpars, tcovs, track.chi2()};
-
-      auto compatibleBCs = atrack.bc_as<ExtBCs>();
-
-      for (auto& bc : compatibleBCs) {
-        if (!bc.has_collisions()) {
-          continue;
-        }
-        auto collisions = bc.collisions_as<CollisionsLabeled>(); // compatible collisions
-        for (auto const& collision : collisions) {
-
-          // trackPar.propagateToZhelix(collision.posZ(), Bz); // track parameters propagation to the position of the z vertex
-          trackPar.propagateToZlinear(collision.posZ());
-
-          const auto dcaX(trackPar.getX() - collision.posX());
-          const auto dcaY(trackPar.getY() - collision.posY());
-          dcaXY = std::sqrt(dcaX * dcaX + dcaY * dcaY);
-
-          registry.fill(HIST("Ambiguous/TracksDCAXY"), dcaXY);
-          registry.fill(HIST("Ambiguous/TracksDCAX"), dcaX);
-          registry.fill(HIST("Ambiguous/TracksDCAY"), dcaY);
-          // registry.fill(HIST("NumberOfContributors"), collision.numContrib());
-
-          if ((dcaXY < bestDCA)) {
-            bestCol = collision.globalIndex();
-            bestMCCol = collision.mcCollisionId();
-            bestDCA = dcaXY;
-            bestDCAX = dcaX;
-            bestDCAY = dcaY;
-            bestTrackPar = trackPar;
-          }
-        }
+      float bestDCA = o2::pwgmm::FwdTrackDCA::MaxDCAXY;
+      float bestDCAX = o2::pwgmm::FwdTrackDCA::MaxDCAXY;
+      float bestDCAY = o2::pwgmm::FwdTrackDCA::MaxDCAXY;
+      const auto best = fwdDCA.best(iTrack);
+      if (best >= 0) {
+        bestCol = fwdDCA.collisionId(best);
+        bestMCCol = collisions.rawIteratorAt(bestCol).mcCollisionId();
+        bestDCA = fwdDCA.dcaXY(best);
+        bestDCAX = fwdDCA.dcaX(best);
+        bestDCAY = fwdDCA.dcaY(best);
       }
 
       // other option for the truth : collision.mcCollision().posZ();
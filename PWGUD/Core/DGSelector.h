@@ -12,6 +12,10 @@
 #ifndef PWGUD_CORE_DGSELECTOR_H_
 #define PWGUD_CORE_DGSELECTOR_H_
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
 #include "TDatabasePDG.h"
 #include "TLorentzVector.h"
 #include "Framework/Logger.h"
@@ -37,30 +41,18 @@ class DGSelector
   }
 
   // Function to check if collisions passes DG filter
+  // The criteria are evaluated from the cheapest to the most expensive one: the number of vertex tracks, the
+  // tracks of the collision, the forward tracks and at last the FIT signals in the range of compatible BCs.
+  // The return value gives the first criterion which is not fulfilled, 0 if the collision is selected.
   template <typename CC, typename BCs, typename TCs, typename FWs>
   int IsSelected(DGCutparHolder diffCuts, CC& collision, BCs& bcRange, TCs& tracks, FWs& fwdtracks)
   {
     LOGF(debug, "Collision %f", collision.collisionTime());
     LOGF(debug, "Number of close BCs: %i", bcRange.size());
 
-    // check that there are no FIT signals in any of the compatible BCs
-    // Double Gap (DG) condition
-    for (auto const& bc : bcRange) {
-      if (!udhelpers::cleanFIT(bc, diffCuts.maxFITtime(), diffCuts.FITAmpLimits())) {
-        return 1;
-      }
-    }
-
-    // forward tracks
-    LOGF(debug, "FwdTracks %i", fwdtracks.size());
-    if (!diffCuts.withFwdTracks()) {
-      // only consider tracks with MID (good timing)
-      for (auto& fwdtrack : fwdtracks) {
-        LOGF(info, "  %i / %f / %f / %f / %f", fwdtrack.trackType(), fwdtrack.eta(), fwdtrack.pt(), fwdtrack.p(), fwdtrack.trackTimeRes());
-        if (fwdtrack.trackType() == 0 || fwdtrack.trackType() == 3) {
-          return 2;
-        }
-      }
+    // number of vertex tracks
+    if (collision.numContrib() < diffCuts.minNTracks() || collision.numContrib() > diffCuts.maxNTracks()) {
+      return count(6);
     }
 
     // no global tracks which are not vtx tracks
@@ -68,10 +60,10 @@ class DGSelector
     auto rgtrwTOF = 0.; // fraction of PV tracks with TOF hit
     for (auto& track : tracks) {
       if (track.isGlobalTrack() && !track.isPVContributor()) {
-        return 3;
+        return count(3);
       }
       if (diffCuts.globalTracksOnly() && !track.isGlobalTrack() && track.isPVContributor()) {
-        return 4;
+        return count(4);
       }
 
       // update fraction of PV tracks with TOF hit
@@ -83,23 +75,14 @@ class DGSelector
       rgtrwTOF /= collision.numContrib();
     }
     if (rgtrwTOF < diffCuts.minRgtrwTOF()) {
-      return 5;
-    }
-
-    // number of vertex tracks
-    if (collision.numContrib() < diffCuts.minNTracks() || collision.numContrib() > diffCuts.maxNTracks()) {
-      return 6;
+      return count(5);
     }
 
     // PID, pt, and eta of tracks, invariant mass, and net charge
     // consider only vertex tracks
 
     // which particle hypothesis?
-    auto mass2Use = 0.;
-    TParticlePDG* pdgparticle = fPDG->GetParticle(diffCuts.pidHypothesis());
-    if (pdgparticle != nullptr) {
-      mass2Use = pdgparticle->Mass();
-    }
+    auto mass2Use = getMass(diffCuts.pidHypothesis());
 
     auto netCharge = 0;
     auto lvtmp = TLorentzVector();
@@ -109,18 +92,18 @@ class DGSelector
 
         // PID
         // if (!udhelpers::hasGoodPID(diffCuts, track)) {
-        //   return 7;
+        //   return count(7);
         // }
 
         // pt
         lvtmp.SetXYZM(track.px(), track.py(), track.pz(), mass2Use);
         if (lvtmp.Perp() < diffCuts.minPt() || lvtmp.Perp() > diffCuts.maxPt()) {
-          return 8;
+          return count(8);
         }
 
         // eta
         if (lvtmp.Eta() < diffCuts.minEta() || lvtmp.Eta() > diffCuts.maxEta()) {
-          return 9;
+          return count(9);
         }
         netCharge += track.sign();
         ivm += lvtmp;
@@ -130,35 +113,123 @@ class DGSelector
     // net charge
     auto netChargeValues = diffCuts.netCharges();
     if (std::find(netChargeValues.begin(), netChargeValues.end(), netCharge) == netChargeValues.end()) {
-      return 10;
+      return count(10);
     }
     // invariant mass
     if (ivm.M() < diffCuts.minIVM() || ivm.M() > diffCuts.maxIVM()) {
-      return 11;
+      return count(11);
+    }
+
+    // forward tracks
+    LOGF(debug, "FwdTracks %i", fwdtracks.size());
+    if (!diffCuts.withFwdTracks()) {
+      // only consider tracks with MID (good timing)
+      for (auto& fwdtrack : fwdtracks) {
+        LOGF(debug, "  %i / %f / %f / %f / %f", fwdtrack.trackType(), fwdtrack.eta(), fwdtrack.pt(), fwdtrack.p(), fwdtrack.trackTimeRes());
+        if (fwdtrack.trackType() == 0 || fwdtrack.trackType() == 3) {
+          return count(2);
+        }
+      }
+    }
+
+    // check that there are no FIT signals in any of the compatible BCs
+    // Double Gap (DG) condition
+    if (!isCleanFITRange(diffCuts, bcRange)) {
+      return count(1);
     }
 
     // if we arrive here then the event is good!
-    return 0;
+    return count(0);
   };
 
   // Function to check if BC passes DG filter (without associated collision)
+  // The FIT signals in bcRange are checked last, only for the BCs which pass the other criteria
   template <typename BCs, typename TCs, typename FWs>
   int IsSelected(DGCutparHolder diffCuts, BCs& bcRange, TCs& tracks, FWs& fwdtracks)
   {
+    auto isDG = selectTracks(diffCuts, tracks, fwdtracks);
+    if (isDG != 0) {
+      return count(isDG);
+    }
     // check that there are no FIT signals in bcRange
     // Double Gap (DG) condition
+    if (!isCleanFITRange(diffCuts, bcRange)) {
+      return count(1);
+    }
+    return count(0);
+  };
+
+  // Same as above, with the FIT condition in the range of compatible BCs already evaluated
+  template <typename TCs, typename FWs>
+  int IsSelected(DGCutparHolder diffCuts, bool isCleanFIT, TCs& tracks, FWs& fwdtracks)
+  {
+    // Double Gap (DG) condition
+    if (!isCleanFIT) {
+      return count(1);
+    }
+    return count(selectTracks(diffCuts, tracks, fwdtracks));
+  };
+
+  // Number of calls of IsSelected which returned the given value, to check the rejection power of each criterion
+  static constexpr int NStages = 12;
+  uint64_t getNCalls(int stage) const { return (stage >= 0 && stage < NStages) ? fNCalls[stage] : 0; }
+  void resetNCalls() { fNCalls.fill(0); }
+  void printNCalls() const
+  {
+    for (auto stage = 0; stage < NStages; stage++) {
+      LOGF(info, "DGSelector: %llu events with return value %i", fNCalls[stage], stage);
+    }
+  }
+
+ private:
+  TDatabasePDG* fPDG;
+  std::array<uint64_t, NStages> fNCalls{}; // number of calls per return value
+  int fMassPdgCode = 0;                    // particle hypothesis of fMass
+  double fMass = 0.;                       // mass of the particle hypothesis
+
+  int count(int stage)
+  {
+    if (stage >= 0 && stage < NStages) {
+      ++fNCalls[stage];
+    }
+    return stage;
+  }
+
+  // mass of the particle hypothesis, the PDG database is queried only when the hypothesis changes
+  double getMass(int pdgCode)
+  {
+    if (pdgCode != fMassPdgCode) {
+      fMassPdgCode = pdgCode;
+      fMass = 0.;
+      TParticlePDG* pdgparticle = fPDG->GetParticle(pdgCode);
+      if (pdgparticle != nullptr) {
+        fMass = pdgparticle->Mass();
+      }
+    }
+    return fMass;
+  }
+
+  template <typename BCs>
+  bool isCleanFITRange(DGCutparHolder& diffCuts, BCs& bcRange)
+  {
     for (auto const& bc : bcRange) {
       if (!udhelpers::cleanFIT(bc, diffCuts.maxFITtime(), diffCuts.FITAmpLimits())) {
-        return 1;
+        return false;
       }
     }
+    return true;
+  }
 
+  // criteria for the tracks and the forward tracks of a BC, from the cheapest to the most expensive one
+  template <typename TCs, typename FWs>
+  int selectTracks(DGCutparHolder& diffCuts, TCs& tracks, FWs& fwdtracks)
+  {
     // no activity in muon arm
     LOGF(debug, "FwdTracks %i", fwdtracks.size());
-    for (auto& fwdtrack : fwdtracks) {
-      LOGF(debug, "  %i / %f / %f / %f", fwdtrack.trackType(), fwdtrack.eta(), fwdtrack.pt(), fwdtrack.p());
-    }
     if (fwdtracks.size() > 0) {
+      for (auto& fwdtrack : fwdtracks) {
+        LOGF(debug, "  %i / %f / %f / %f", fwdtrack.trackType(), fwdtrack.eta(), fwdtrack.pt(), fwdtrack.p());
+      }
       return 2;
     }
 
@@ -169,21 +240,12 @@ class DGSelector
 
     // PID, pt, and eta of tracks, invariant mass, and net charge
     // which particle hypothesis?
-    auto mass2Use = 0.;
-    TParticlePDG* pdgparticle = fPDG->GetParticle(diffCuts.pidHypothesis());
-    if (pdgparticle != nullptr) {
-      mass2Use = pdgparticle->Mass();
-    }
+    auto mass2Use = getMass(diffCuts.pidHypothesis());
 
     auto netCharge = 0;
     auto lvtmp = TLorentzVector();
     auto ivm = TLorentzVector();
     for (auto& track : tracks) {
-      // PID
-      if (!udhelpers::hasGoodPID(diffCuts, track)) {
-        return 7;
-      }
-
       // pt
       lvtmp.SetXYZM(track.px(), track.py(), track.pz(), mass2Use);
       if (lvtmp.Perp() < diffCuts.minPt() || lvtmp.Perp() > diffCuts.maxPt()) {
@@ -209,13 +271,17 @@ class DGSelector
       return 11;
     }
 
+    // PID, the most expensive check of the tracks
+    for (auto& track : tracks) {
+      if (!udhelpers::hasGoodPID(diffCuts, track)) {
+        return 7;
+      }
+    }
+
     // if we arrive here then the event is good!
     return 0;
   };
 
- private:
-  TDatabasePDG* fPDG;
-
   ClassDefNV(DGSelector, 1);
 };
 
@@ -71,12 +71,24 @@ bool UDFSParser::readFS(const char* filename)
     }
   }
 
-  // fill fP2BCsE
+  // fill the type masks of the P2BCs, and fP2BCsE
+  fP2BCMasks.assign(o2::constants::lhc::LHCMaxBunches, 0);
+  for (auto bcnum : fP2BCsA) {
+    fP2BCMasks[bcnum] |= 1 << 1;
+  }
+  for (auto bcnum : fP2BCsC) {
+    fP2BCMasks[bcnum] |= 1 << 2;
+  }
+  for (auto bcnum : fP2BCsBB) {
+    fP2BCMasks[bcnum] |= 1 << 3;
+  }
   for (int bcnum = 0; bcnum < o2::constants::lhc::LHCMaxBunches; bcnum++) {
-    if (!isP2BCA(bcnum) && !isP2BCC(bcnum) && !isP2BCBB(bcnum)) {
+    if (fP2BCMasks[bcnum] == 0) {
+      fP2BCMasks[bcnum] = 1 << 0;
       fP2BCsE.push_back(bcnum);
     }
   }
+  fisActive = true;
   return true;
 }
 
@@ -159,33 +171,37 @@ std::vector<std::string> UDFSParser::tokenize(std::string& str,
 }
 
 // -----------------------------------------------------------------------------
-bool UDFSParser::isInVector(int num, std::vector<int> vec)
+// lookup in the type masks, without searching the vectors of BCs
+bool UDFSParser::hasP2BCMask(int bcnum, uint8_t mask)
 {
-  return !fisActive || find(vec.begin(), vec.end(), num) != vec.end();
+  if (!fisActive) {
+    return true;
+  }
+  return bcnum >= 0 && bcnum < static_cast<int>(fP2BCMasks.size()) && (fP2BCMasks[bcnum] & mask) != 0;
 }
 
 // -----------------------------------------------------------------------------
 bool UDFSParser::isP2BCE(int bcnum)
 {
-  return isInVector(bcnum, fP2BCsE);
+  return hasP2BCMask(bcnum, 1 << 0);
 }
 
 // -----------------------------------------------------------------------------
 bool UDFSParser::isP2BCA(int bcnum)
 {
-  return isInVector(bcnum, fP2BCsA);
+  return hasP2BCMask(bcnum, 1 << 1);
 }
 
 // -----------------------------------------------------------------------------
 bool UDFSParser::isP2BCC(int bcnum)
 {
-  return isInVector(bcnum, fP2BCsC);
+  return hasP2BCMask(bcnum, 1 << 2);
 }
 
 // -----------------------------------------------------------------------------
 bool UDFSParser::isP2BCBB(int bcnum)
 {
-  return isInVector(bcnum, fP2BCsBB);
+  return hasP2BCMask(bcnum, 1 << 3);
 }
 
 // -----------------------------------------------------------------------------
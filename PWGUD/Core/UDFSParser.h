@@ -13,6 +13,7 @@
 #define PWGUD_CORE_UDFSPARSER_H_
 
 //#include <gandiva/projector.h>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -59,11 +60,15 @@ class UDFSParser
   std::vector<int> fP2BCsC;  // C-side
   std::vector<int> fP2BCsBB; // BB
 
+  // bit mask of the types of each P2BC, filled by readFS
+  // bit 0: empty, bit 1: A-side, bit 2: C-side, bit 3: BB
+  std::vector<uint8_t> fP2BCMasks;
+  bool hasP2BCMask(int bcnum, uint8_t mask);
+
   // helper functions for string parsing
   bool isNumber(std::string s);
   std::string trim(std::string str, std::string whitespace);
   std::vector<std::string> tokenize(std::string& str, std::string separator = ",");
-  bool isInVector(int num, std::vector<int> vec);
 
   // ClassDefNV(UDFSParser, 1);
 };
@@ -36,6 +36,8 @@ void UDGoodRunSelector::clear()
   mrnMin = -1;
   mrnMax = -1;
   misActive = false;
+  mlastRun = -1;
+  mlastIsGood = false;
 }
 
 void UDGoodRunSelector::Print()
@@ -58,9 +60,12 @@ bool UDGoodRunSelector::isGoodRun(int runNumber)
   // search for runNumber in mgoodRuns
   if (!misActive) {
     return true;
-  } else {
-    return std::find(mgoodRuns.begin(), mgoodRuns.end(), runNumber) != mgoodRuns.end();
   }
+  if (runNumber != mlastRun) {
+    mlastRun = runNumber;
+    mlastIsGood = std::binary_search(mgoodRuns.begin(), mgoodRuns.end(), runNumber);
+  }
+  return mlastIsGood;
 }
 
 std::vector<int> UDGoodRunSelector::goodRuns(std::string runPeriod)
@@ -90,6 +95,7 @@ bool UDGoodRunSelector::init(std::string const& goodRunsFile)
   //    ]
   //  }
   misActive = false;
+  mlastRun = -1;
   if (goodRunsFile.empty()) {
     LOGF(info, "goodRuns was not specified!");
     return true;
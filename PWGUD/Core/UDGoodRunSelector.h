@@ -41,8 +41,12 @@ struct UDGoodRunSelector {
   bool misActive;
   std::string mgoodRunsFile;
   int mrnMin = -1, mrnMax = -1;
-  std::vector<int> mgoodRuns;
+  std::vector<int> mgoodRuns; // sorted and unique
   std::map<std::string, std::vector<int>> mrunMap;
+
+  // result of the last call of isGoodRun, consecutive events mostly belong to the same run
+  int mlastRun = -1;
+  bool mlastIsGood = false;
 };
 
 #endif // PWGUD_CORE_UDGOODRUNSELECTOR_H_
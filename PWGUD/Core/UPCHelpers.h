@@ -88,6 +88,73 @@ struct FITInfo {
   int32_t BGFDDCpf = 0;
 };
 
+// fill FITInfo of the BC bcnum from the BC activity summary, bcs has to be joined with UDBcActivities
+// the BB and BG flags are filled for the adjacent BCs [-16, 15]
+template <typename TBCs>
+void fillFITInfo(FITInfo& info, uint64_t bcnum, TBCs const& bcs)
+{
+  // BCs are sorted by globalBC, find the first BC of the range
+  uint64_t minbc = bcnum > 16 ? bcnum - 16 : 0;
+  int64_t first = 0;
+  int64_t last = bcs.size();
+  while (first < last) {
+    auto mid = first + (last - first) / 2;
+    if (bcs.iteratorAt(mid).globalBC() < minbc) {
+      first = mid + 1;
+    } else {
+      last = mid;
+    }
+  }
+
+  for (auto ind = first; ind < bcs.size(); ind++) {
+    const auto& bc = bcs.iteratorAt(ind);
+    if (bc.globalBC() > bcnum + 15) {
+      break;
+    }
+
+    // amplitudes, times and trigger masks of this BC
+    if (bc.globalBC() == bcnum) {
+      info.ampFT0A = bc.totalFT0AmplitudeA();
+      info.ampFT0C = bc.totalFT0AmplitudeC();
+      info.timeFT0A = bc.timeFT0A();
+      info.timeFT0C = bc.timeFT0C();
+      info.triggerMaskFT0 = bc.triggerMaskFT0();
+      info.ampFDDA = bc.totalFDDAmplitudeA();
+      info.ampFDDC = bc.totalFDDAmplitudeC();
+      info.timeFDDA = bc.timeFDDA();
+      info.timeFDDC = bc.timeFDDC();
+      info.triggerMaskFDD = bc.triggerMaskFDD();
+      info.ampFV0A = bc.totalFV0AmplitudeA();
+      info.timeFV0A = bc.timeFV0A();
+      info.triggerMaskFV0A = bc.triggerMaskFV0A();
+    }
+
+    // 0 <= bit <= 31
+    auto bit = bc.globalBC() + 16 - bcnum;
+    auto flags = bc.activityFlags();
+    if (TESTBIT(flags, o2::aod::udbcactivity::kBBFT0A))
+      SETBIT(info.BBFT0Apf, bit);
+    if (TESTBIT(flags, o2::aod::udbcactivity::kBBFT0C))
+      SETBIT(info.BBFT0Cpf, bit);
+    if (TESTBIT(flags, o2::aod::udbcactivity::kBGFT0A))
+      SETBIT(info.BGFT0Apf, bit);
+    if (TESTBIT(flags, o2::aod::udbcactivity::kBGFT0C))
+      SETBIT(info.BGFT0Cpf, bit);
+    if (TESTBIT(flags, o2::aod::udbcactivity::kBBFV0A))
+      SETBIT(info.BBFV0Apf, bit);
+    if (TESTBIT(flags, o2::aod::udbcactivity::kBGFV0A))
+      SETBIT(info.BGFV0Apf, bit);
+    if (TESTBIT(flags, o2::aod::udbcactivity::kBBFDDA))
+      SETBIT(info.BBFDDApf, bit);
+    if (TESTBIT(flags, o2::aod::udbcactivity::kBBFDDC))
+      SETBIT(info.BBFDDCpf, bit);
+    if (TESTBIT(flags, o2::aod::udbcactivity::kBGFDDA))
+      SETBIT(info.BGFDDApf, bit);
+    if (TESTBIT(flags, o2::aod::udbcactivity::kBGFDDC))
+      SETBIT(info.BGFDDCpf, bit);
+  }
+}
+
 template <typename TSelectorsArray>
 void applyFwdCuts(UPCCutparHolder& upcCuts, const ForwardTracks::iterator& track, TSelectorsArray& fwdSelectors)
 {
@@ -169,6 +169,46 @@ DECLARE_SOA_TABLE(UDCollisionsSels, "AOD", "UDCOLLISIONSEL",
 using UDCollision = UDCollisions::iterator;
 using UDCollisionsSel = UDCollisionsSels::iterator;
 
+namespace udbcactivity
+{
+// bits of the activity flags of a BC
+enum ActivityBits {
+  kBBFT0A = 0, // beam-beam time in FT0A
+  kBBFT0C,     // beam-beam time in FT0C
+  kBGFT0A,     // beam-gas time in FT0A
+  kBGFT0C,     // beam-gas time in FT0C
+  kBBFV0A,     // beam-beam time in V0A
+  kBGFV0A,     // beam-gas time in V0A
+  kBBFDDA,     // beam-beam time in FDA
+  kBBFDDC,     // beam-beam time in FDC
+  kBGFDDA,     // beam-gas time in FDA
+  kBGFDDC,     // beam-gas time in FDC
+  kHasZDC,     // ZDC record in the BC
+  kHasCalo,    // calorimeter cells in the BC
+  kNActivityBits
+};
+DECLARE_SOA_COLUMN(ActivityFlags, activityFlags, uint16_t); //! ActivityBits of the BC
+} // namespace udbcactivity
+
+// summary of the FIT, ZDC and calorimeter activity in each BC, joinable with BCs
+DECLARE_SOA_TABLE(UDBcActivities, "AOD", "UDBCACTIVITY", //! BC activity summary
+                  udcollision::TotalFT0AmplitudeA,
+                  udcollision::TotalFT0AmplitudeC,
+                  udcollision::TimeFT0A,
+                  udcollision::TimeFT0C,
+                  udcollision::TriggerMaskFT0,
+                  udcollision::TotalFDDAmplitudeA,
+                  udcollision::TotalFDDAmplitudeC,
+                  udcollision::TimeFDDA,
+                  udcollision::TimeFDDC,
+                  udcollision::TriggerMaskFDD,
+                  udcollision::TotalFV0AmplitudeA,
+                  udcollision::TimeFV0A,
+                  udcollision::TriggerMaskFV0A,
+                  udbcactivity::ActivityFlags);
+
+using UDBcActivity = UDBcActivities::iterator;
+
 namespace udtrack
 {
 DECLARE_SOA_INDEX_COLUMN(UDCollision, udCollision);    //!
@@ -68,7 +68,7 @@ struct DGCandProducer {
   // data inputs
   using CCs = soa::Join<aod::Collisions, aod::EvSels>;
   using CC = CCs::iterator;
-  using BCs = soa::Join<aod::BCsWithTimestamps, aod::BcSels, aod::Run3MatchedToBCSparse>;
+  using BCs = soa::Join<aod::BCsWithTimestamps, aod::BcSels, aod::Run3MatchedToBCSparse, aod::UDBcActivities>;
   using BC = BCs::iterator;
   using TCs = soa::Join<aod::Tracks, /*aod::TracksCov,*/ aod::TracksExtra, aod::TracksDCA, aod::TrackSelection,
                         aod::pidTPCFullEl, aod::pidTPCFullMu, aod::pidTPCFullPi, aod::pidTPCFullKa, aod::pidTPCFullPr,
@@ -84,101 +84,6 @@ struct DGCandProducer {
                           aod::TOFSignal, aod::pidTOFFullEl, aod::pidTOFFullMu, aod::pidTOFFullPi, aod::pidTOFFullKa, aod::pidTOFFullPr>;
   using MCTC = MCTCs::iterator;
 
-  // extract FIT information
-  void getFITinfo(upchelpers::FITInfo& info, uint64_t const& bcnum, BCs const& bcs, aod::FT0s const& ft0s, aod::FV0As const& fv0as, aod::FDDs const& fdds)
-  {
-    // find bc with globalBC = bcnum
-    Partition<BCs> selbc = aod::bc::globalBC == bcnum;
-    selbc.bindTable(bcs);
-
-    // if BC exists then update FIT information for this BC
-    if (selbc.size() > 0) {
-      auto bc = selbc.begin();
-
-      // FT0
-      if (bc.has_foundFT0()) {
-        auto ft0 = ft0s.iteratorAt(bc.foundFT0Id());
-        info.timeFT0A = ft0.timeA();
-        info.timeFT0C = ft0.timeC();
-        const auto& ampsA = ft0.amplitudeA();
-        const auto& ampsC = ft0.amplitudeC();
-        info.ampFT0A = 0.;
-        for (auto amp : ampsA) {
-          info.ampFT0A += amp;
-        }
-        info.ampFT0C = 0.;
-        for (auto amp : ampsC) {
-          info.ampFT0C += amp;
-        }
-        info.triggerMaskFT0 = ft0.triggerMask();
-      }
-
-      // FV0A
-      if (bc.has_foundFV0()) {
-        auto fv0a = fv0as.iteratorAt(bc.foundFV0Id());
-        info.timeFV0A = fv0a.time();
-        const auto& amps = fv0a.amplitude();
-        info.ampFV0A = 0.;
-        for (auto amp : amps) {
-          info.ampFV0A += amp;
-        }
-        info.triggerMaskFV0A = fv0a.triggerMask();
-      }
-
-      // FDD
-      if (bc.has_foundFDD()) {
-        auto fdd = fdds.iteratorAt(bc.foundFDDId());
-        info.timeFDDA = fdd.timeA();
-        info.timeFDDC = fdd.timeC();
-        const auto& ampsA = fdd.chargeA();
-        const auto& ampsC = fdd.chargeC();
-        info.ampFDDA = 0.;
-        for (auto amp : ampsA) {
-          info.ampFDDA += amp;
-        }
-        info.ampFDDC = 0.;
-        for (auto amp : ampsC) {
-          info.ampFDDC += amp;
-        }
-        info.triggerMaskFDD = fdd.triggerMask();
-      }
-    }
-
-    // fill BG and BB flags in adjacent BCs [-16, 15]
-    // compute range to check
-    auto minbc = bcnum - 16;
-    auto maxbc = bcnum + 15;
-    Partition<BCs> bcrange = aod::bc::globalBC >= minbc && aod::bc::globalBC <= maxbc;
-    bcrange.bindTable(bcs);
-
-    // loop over bcrange and check
-    for (auto const& bc2u : bcrange) {
-
-      // 0 <= bit <= 31
-      auto bit = bc2u.globalBC() - minbc;
-      if (!bc2u.selection_bit(evsel::kNoBGT0A))
-        SETBIT(info.BGFT0Apf, bit);
-      if (!bc2u.selection_bit(evsel::kNoBGT0C))
-        SETBIT(info.BGFT0Cpf, bit);
-      if (bc2u.selection_bit(evsel::kIsBBT0A))
-        SETBIT(info.BBFT0Apf, bit);
-      if (bc2u.selection_bit(evsel::kIsBBT0C))
-        SETBIT(info.BBFT0Cpf, bit);
-      if (!bc2u.selection_bit(evsel::kNoBGV0A))
-        SETBIT(info.BGFV0Apf, bit);
-      if (bc2u.selection_bit(evsel::kIsBBV0A))
-        SETBIT(info.BBFV0Apf, bit);
-      if (!bc2u.selection_bit(evsel::kNoBGFDA))
-        SETBIT(info.BGFDDApf, bit);
-      if (!bc2u.selection_bit(evsel::kNoBGFDC))
-        SETBIT(info.BGFDDCpf, bit);
-      if (bc2u.selection_bit(evsel::kIsBBFDA))
-        SETBIT(info.BBFDDApf, bit);
-      if (bc2u.selection_bit(evsel::kIsBBFDC))
-        SETBIT(info.BBFDDCpf, bit);
-    }
-  }
-
   // function to update UDTracks, UDTracksCov, UDTracksDCA, UDTracksPID, UDTracksExtra, UDTracksFlag,
   // and UDTrackCollisionIDs
   template <typename TTrack>
@@ -309,7 +214,7 @@ struct DGCandProducer {
 
   // process function for real data
   void processData(CC const& collision, BCs const& bcs, TCs& tracks, FWs& fwdtracks,
-                   aod::Zdcs& zdcs, aod::FT0s& ft0s, aod::FV0As& fv0as, aod::FDDs& fdds)
+                   aod::Zdcs& zdcs)
   {
     LOGF(debug, "<DGCandProducer>  collision %d", collision.globalIndex());
     // nominal BC
@@ -330,9 +235,9 @@ struct DGCandProducer {
     if (isDGEvent == 0) {
       LOGF(debug, "<DGCandProducer>  Data: good collision!");
 
-      // fill FITInfo
+      // fill FITInfo from the BC activity summary
       upchelpers::FITInfo fitInfo{};
-      getFITinfo(fitInfo, bc.globalBC(), bcs, ft0s, fv0as, fdds);
+      upchelpers::fillFITInfo(fitInfo, bc.globalBC(), bcs);
 
       // update DG candidates tables
       auto rtrwTOF = udhelpers::rPVtrwTOF<true>(tracks, collision.numContrib());
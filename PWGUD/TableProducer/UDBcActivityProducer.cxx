@@ -0,0 +1,132 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//
+// \brief Summarises the FIT, ZDC and calorimeter activity of each BC
+//        The table UDBcActivities is joinable with the BCs, so that the UD producers
+//        read the amplitudes, times and flags of a BC and of its neighbours
+//        instead of looking them up in the detector tables for every candidate.
+// \since  14.10.2026
+
+#include <vector>
+
+#include "Framework/runDataProcessing.h"
+#include "Framework/AnalysisTask.h"
+#include "Common/DataModel/EventSelection.h"
+#include "PWGUD/DataModel/UDTables.h"
+#include "PWGUD/Core/UPCHelpers.h"
+
+using namespace o2;
+using namespace o2::framework;
+
+struct UDBcActivityProducer {
+
+  Produces<aod::UDBcActivities> outputBcActivities;
+
+  using BCs = soa::Join<aod::BCs, aod::BcSels, aod::Run3MatchedToBCSparse>;
+
+  // flags of the BCs with calorimeter cells
+  std::vector<bool> hasCalo;
+
+  void process(BCs const& bcs, aod::FT0s const& ft0s, aod::FV0As const& fv0as, aod::FDDs const& fdds, aod::Calos const& calos)
+  {
+    hasCalo.assign(bcs.size(), false);
+    for (auto const& calo : calos) {
+      hasCalo[calo.bcId()] = true;
+    }
+
+    outputBcActivities.reserve(bcs.size());
+    for (auto const& bc : bcs) {
+      upchelpers::FITInfo info{};
+
+      // FT0
+      if (bc.has_foundFT0()) {
+        auto ft0 = ft0s.iteratorAt(bc.foundFT0Id());
+        info.timeFT0A = ft0.timeA();
+        info.timeFT0C = ft0.timeC();
+        info.ampFT0A = 0.;
+        for (auto amp : ft0.amplitudeA()) {
+          info.ampFT0A += amp;
+        }
+        info.ampFT0C = 0.;
+        for (auto amp : ft0.amplitudeC()) {
+          info.ampFT0C += amp;
+        }
+        info.triggerMaskFT0 = ft0.triggerMask();
+      }
+
+      // FV0A
+      if (bc.has_foundFV0()) {
+        auto fv0a = fv0as.iteratorAt(bc.foundFV0Id());
+        info.timeFV0A = fv0a.time();
+        info.ampFV0A = 0.;
+        for (auto amp : fv0a.amplitude()) {
+          info.ampFV0A += amp;
+        }
+        info.triggerMaskFV0A = fv0a.triggerMask();
+      }
+
+      // FDD
+      if (bc.has_foundFDD()) {
+        auto fdd = fdds.iteratorAt(bc.foundFDDId());
+        info.timeFDDA = fdd.timeA();
+        info.timeFDDC = fdd.timeC();
+        info.ampFDDA = 0.;
+        for (auto amp : fdd.chargeA()) {
+          info.ampFDDA += amp;
+        }
+        info.ampFDDC = 0.;
+        for (auto amp : fdd.chargeC()) {
+          info.ampFDDC += amp;
+        }
+        info.triggerMaskFDD = fdd.triggerMask();
+      }
+
+      // BB and BG flags, ZDC and calorimeter activity
+      uint16_t flags = 0;
+      if (bc.selection_bit(evsel::kIsBBT0A))
+        SETBIT(flags, aod::udbcactivity::kBBFT0A);
+      if (bc.selection_bit(evsel::kIsBBT0C))
+        SETBIT(flags, aod::udbcactivity::kBBFT0C);
+      if (!bc.selection_bit(evsel::kNoBGT0A))
+        SETBIT(flags, aod::udbcactivity::kBGFT0A);
+      if (!bc.selection_bit(evsel::kNoBGT0C))
+        SETBIT(flags, aod::udbcactivity::kBGFT0C);
+      if (bc.selection_bit(evsel::kIsBBV0A))
+        SETBIT(flags, aod::udbcactivity::kBBFV0A);
+      if (!bc.selection_bit(evsel::kNoBGV0A))
+        SETBIT(flags, aod::udbcactivity::kBGFV0A);
+      if (bc.selection_bit(evsel::kIsBBFDA))
+        SETBIT(flags, aod::udbcactivity::kBBFDDA);
+      if (bc.selection_bit(evsel::kIsBBFDC))
+        SETBIT(flags, aod::udbcactivity::kBBFDDC);
+      if (!bc.selection_bit(evsel::kNoBGFDA))
+        SETBIT(flags, aod::udbcactivity::kBGFDDA);
+      if (!bc.selection_bit(evsel::kNoBGFDC))
+        SETBIT(flags, aod::udbcactivity::kBGFDDC);
+      if (bc.has_zdc())
+        SETBIT(flags, aod::udbcactivity::kHasZDC);
+      if (hasCalo[bc.globalIndex()])
+        SETBIT(flags, aod::udbcactivity::kHasCalo);
+
+      outputBcActivities(info.ampFT0A, info.ampFT0C, info.timeFT0A, info.timeFT0C, info.triggerMaskFT0,
+                         info.ampFDDA, info.ampFDDC, info.timeFDDA, info.timeFDDC, info.triggerMaskFDD,
+                         info.ampFV0A, info.timeFV0A, info.triggerMaskFV0A,
+                         flags);
+    }
+  }
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{
+    adaptAnalysisTask<UDBcActivityProducer>(cfgc, TaskName{"udbcactivityproducer"}),
+  };
+}
@@ -76,6 +76,7 @@ struct UpcCandProducer {
                                      o2::aod::TOFSignal, o2::aod::pidTOFFullEl, o2::aod::pidTOFFullMu, o2::aod::pidTOFFullPi, o2::aod::pidTOFFullKa, o2::aod::pidTOFFullPr>;
 
   typedef std::pair<uint64_t, std::vector<int64_t>> BCTracksPair;
+  typedef std::pair<uint64_t, int64_t> BCTrackPair;
 
   void init(InitContext&)
   {
@@ -462,14 +463,18 @@ struct UpcCandProducer {
     }
   }
 
-  void addTrack(std::vector<BCTracksPair>& v, uint64_t bc, int64_t trkId)
+  // group the (BC, track ID) pairs by BC
+  // the groups are sorted by BC, the tracks of a group keep the order in which they were collected
+  void groupTracks(std::vector<BCTrackPair>& bcTracks, std::vector<BCTracksPair>& v)
   {
-    auto it = std::find_if(v.begin(), v.end(),
-                           [bc](const BCTracksPair& element) { return element.first == bc; });
-    if (it != v.end())
-      it->second.push_back(trkId);
-    else
-      v.emplace_back(std::make_pair(bc, std::vector<int64_t>({trkId})));
+    std::stable_sort(bcTracks.begin(), bcTracks.end(),
+                     [](const BCTrackPair& left, const BCTrackPair& right) { return left.first < right.first; });
+    for (const auto& [bc, trkId] : bcTracks) {
+      if (v.empty() || v.back().first != bc)
+        v.emplace_back(std::make_pair(bc, std::vector<int64_t>()));
+      v.back().second.push_back(trkId);
+    }
+    bcTracks.clear();
   }
 
   void collectBarrelTracks(std::vector<BCTracksPair>& bcsMatchedTrIdsA,
@@ -480,6 +485,9 @@ struct UpcCandProducer {
                            o2::aod::AmbiguousTracks const& ambBarrelTracks,
                            std::unordered_map<int64_t, uint64_t>& ambBarrelTrBCs)
   {
+    std::vector<BCTrackPair> bcTracksA;
+    std::vector<BCTrackPair> bcTracksB;
+    bcTracksA.reserve(barrelTracks.size());
     for (const auto& trk : barrelTracks) {
       if (!applyBarCuts(trk))
         continue;
@@ -506,10 +514,12 @@ struct UpcCandProducer {
       bool needTOFWithITS = !upcCuts.getProduceITSITS() && upcCuts.getRequireITSTPC() && trk.hasTOF() && trk.hasITS() && trk.hasTPC();
       bool addToA = needITSITS || needAllTOF || needTOFWithITS;
       if (addToA)
-        addTrack(bcsMatchedTrIdsA, bc, trkId);
+        bcTracksA.emplace_back(bc, trkId);
       if (fSearchITSTPC == 1 && !trk.hasTOF() && trk.hasITS() && trk.hasTPC())
-        addTrack(bcsMatchedTrIdsB, bc, trkId);
+        bcTracksB.emplace_back(bc, trkId);
     }
+    groupTracks(bcTracksA, bcsMatchedTrIdsA);
+    groupTracks(bcTracksB, bcsMatchedTrIdsB);
   }
 
   void collectForwardTracks(std::vector<BCTracksPair>& bcsMatchedTrIdsMID,
@@ -519,6 +529,8 @@ struct UpcCandProducer {
                             o2::aod::AmbiguousFwdTracks const& ambFwdTracks,
                             std::unordered_map<int64_t, uint64_t>& ambFwdTrBCs)
   {
+    std::vector<BCTrackPair> bcTracksMID;
+    bcTracksMID.reserve(fwdTracks.size());
     for (const auto& trk : fwdTracks) {
       if (trk.trackType() != o2::aod::fwdtrack::ForwardTrackTypeEnum::MuonStandaloneTrack)
         continue;
@@ -540,8 +552,9 @@ struct UpcCandProducer {
       if (bc > fMaxBC)
         continue;
       if (nContrib <= upcCuts.getMaxNContrib())
-        addTrack(bcsMatchedTrIdsMID, bc, trkId);
+        bcTracksMID.emplace_back(bc, trkId);
     }
+    groupTracks(bcTracksMID, bcsMatchedTrIdsMID);
   }
 
   int32_t searchTracks(uint64_t midbc, uint64_t range, uint32_t tracksToFind,
@@ -609,13 +622,9 @@ struct UpcCandProducer {
                         bcs, collisions,
                         barrelTracks, ambBarrelTracks, ambBarrelTrBCs);
 
+    // the groups of tracks are sorted by BC
     uint32_t nBCsWithITSTPC = bcsMatchedTrIdsITSTPC.size();
 
-    std::sort(bcsMatchedTrIdsTOF.begin(), bcsMatchedTrIdsTOF.end(),
-              [](const auto& left, const auto& right) { return left.first < right.first; });
-    std::sort(bcsMatchedTrIdsITSTPC.begin(), bcsMatchedTrIdsITSTPC.end(),
-              [](const auto& left, const auto& right) { return left.first < right.first; });
-
     if (nBCsWithITSTPC > 0 && fSearchITSTPC == 1) {
       std::unordered_set<int64_t> matchedTracks;
       for (auto& pair : bcsMatchedTrIdsTOF) {
@@ -750,25 +759,23 @@ struct UpcCandProducer {
     uint32_t nBCsWithITSTPC = bcsMatchedTrIdsITSTPC.size();
     uint32_t nBCsWithMID = bcsMatchedTrIdsMID.size();
 
-    std::sort(bcsMatchedTrIdsMID.begin(), bcsMatchedTrIdsMID.end(),
-              [](const auto& left, const auto& right) { return left.first < right.first; });
-
+    // the groups of tracks are sorted by BC: tag the TOF tracks in a single merge pass
     std::vector<BCTracksPair> bcsMatchedTrIdsTOFTagged(nBCsWithMID);
-    for (const auto& pair : bcsMatchedTrIdsTOF) {
+    auto itMID = bcsMatchedTrIdsMID.begin();
+    for (auto& pair : bcsMatchedTrIdsTOF) {
       uint64_t bc = pair.first;
-      auto it = std::find_if(bcsMatchedTrIdsMID.begin(), bcsMatchedTrIdsMID.end(),
-                             [bc](const auto& item) { return item.first == bc; });
-      if (it != bcsMatchedTrIdsMID.end()) {
-        uint32_t ibc = it - bcsMatchedTrIdsMID.begin();
-        bcsMatchedTrIdsTOFTagged[ibc].second = pair.second;
+      while (itMID != bcsMatchedTrIdsMID.end() && itMID->first < bc)
+        ++itMID;
+      if (itMID == bcsMatchedTrIdsMID.end())
+        break;
+      if (itMID->first == bc) {
+        uint32_t ibc = itMID - bcsMatchedTrIdsMID.begin();
+        bcsMatchedTrIdsTOFTagged[ibc].second = std::move(pair.second);
       }
     }
 
     bcsMatchedTrIdsTOF.clear();
 
-    std::sort(bcsMatchedTrIdsITSTPC.begin(), bcsMatchedTrIdsITSTPC.end(),
-              [](const auto& left, const auto& right) { return left.first < right.first; });
-
     if (nBCsWithITSTPC > 0 && fSearchITSTPC == 1) {
       std::unordered_set<int64_t> matchedTracks;
       for (uint32_t ibc = 0; ibc < nBCsWithMID; ++ibc) {
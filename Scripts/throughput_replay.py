@@ -0,0 +1,339 @@
+#!/usr/bin/env python3
+
+# Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+# See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+# All rights not expressly granted are reserved.
+#
+# This software is distributed under the terms of the GNU General Public
+# License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+#
+# In applying this license CERN does not waive the privileges and immunities
+# granted to it by virtue of its status as an Intergovernmental Organization
+# or submit itself to any jurisdiction.
+
+"""!
+@brief  Replay an AO2D sample through standard workflow chains and report their throughput.
+
+Each chain is run on the same input file with its own process session.
+While it runs, the processes of the session are sampled in /proc to get the CPU time
+and the peak resident memory of each DPL device (identified by its --id argument).
+The results are written in a JSON report:
+- wall time, number of events and events/s of the chain,
+- total CPU time and peak RSS of the chain,
+- CPU time and peak RSS of each device.
+The report can be compared with a reference report (e.g. from the previous nightly build).
+The script exits with a non-zero code if the throughput of a chain dropped
+or its peak memory grew by more than the given tolerance, or if a chain failed.
+
+The input sample is meant to be pinned: its SHA-256 checksum can be given to make sure
+that the reference and the new report were obtained on the same data.
+The configuration of the workflows of a chain is read from <config-dir>/<chain>.json if present,
+otherwise the defaults of the workflows are used.
+
+Example:
+  throughput_replay.py --aod-file AO2D.root --sha256 <checksum> -o report.json --reference report_ref.json
+"""
+
+import argparse
+import hashlib
+import json
+import os
+import platform
+import resource
+import shlex
+import subprocess as sp  # nosec B404
+import sys
+import time
+from datetime import datetime, timezone
+
+# workflows producing the common tables needed by all the chains
+WORKFLOWS_COMMON = [
+    "o2-analysis-timestamp",
+    "o2-analysis-event-selection",
+    "o2-analysis-track-propagation",
+    "o2-analysis-trackselection",
+    "o2-analysis-multiplicity-table",
+]
+WORKFLOWS_PID = [
+    "o2-analysis-pid-tpc-base",
+    "o2-analysis-pid-tpc-full",
+    "o2-analysis-pid-tof-base",
+    "o2-analysis-pid-tof-full",
+]
+
+CHAINS = {
+    "common-pid": WORKFLOWS_COMMON + WORKFLOWS_PID,
+    "hf": WORKFLOWS_COMMON
+    + WORKFLOWS_PID
+    + [
+        "o2-analysis-hf-track-index-skim-creator",
+        "o2-analysis-hf-candidate-creator-2prong",
+        "o2-analysis-hf-candidate-creator-3prong",
+        "o2-analysis-hf-candidate-selector-d0",
+        "o2-analysis-hf-candidate-selector-dplus-to-pi-k-pi",
+    ],
+    "lf-strangeness": WORKFLOWS_COMMON
+    + WORKFLOWS_PID
+    + [
+        "o2-analysis-weak-decay-indices",
+        "o2-analysis-lf-lambdakzerobuilder",
+        "o2-analysis-lf-cascadebuilder",
+    ],
+    "dq": WORKFLOWS_COMMON
+    + WORKFLOWS_PID
+    + [
+        "o2-analysis-dq-table-maker",
+        "o2-analysis-dq-table-reader",
+    ],
+    "jet": WORKFLOWS_COMMON + ["o2-analysis-je-jet-finder"],
+}
+
+CLOCK_TICKS = os.sysconf("SC_CLK_TCK")
+
+
+def eprint(*args, **kwargs):
+    """Print to stderr."""
+    print(*args, file=sys.stderr, **kwargs)
+
+
+def msg_err(message: str):
+    """Print an error message."""
+    eprint("\x1b[1;31mError: %s\x1b[0m" % message)
+
+
+def msg_fatal(message: str):
+    """Print an error message and exit."""
+    msg_err(message)
+    sys.exit(1)
+
+
+def msg_warn(message: str):
+    """Print a warning message."""
+    eprint("\x1b[1;36mWarning:\x1b[0m %s" % message)
+
+
+def sha256sum(path: str):
+    """Return the SHA-256 checksum of a file."""
+    digest = hashlib.sha256()
+    with open(path, "rb") as file:
+        for block in iter(lambda: file.read(1 << 20), b""):
+            digest.update(block)
+    return digest.hexdigest()
+
+
+def count_events(path: str):
+    """Return the number of collisions in an AO2D file, None if it cannot be determined."""
+    try:
+        import ROOT  # pylint: disable=import-outside-toplevel
+    except ImportError:
+        msg_warn("PyROOT not available, cannot count the events. Use --events.")
+        return None
+    file = ROOT.TFile.Open(path)
+    if not file or file.IsZombie():
+        msg_warn(f"Cannot open {path} to count the events.")
+        return None
+    n_events = 0
+    for key in file.GetListOfKeys():
+        if not key.GetName().startswith("DF_"):
+            continue
+        folder = key.ReadObj()
+        for name in ("O2collision_001", "O2collision"):
+            tree = folder.Get(name)
+            if tree:
+                n_events += tree.GetEntries()
+                break
+    file.Close()
+    return n_events
+
+
+def make_command(workflows: list, aod_file: str, config: str, extra_args: str):
+    """Return the shell command of a chain of workflows."""
+    steps = []
+    for i, workflow in enumerate(workflows):
+        step = [workflow, "-b"]
+        if config:
+            step += ["--configuration", f"json://{config}"]
+        if i == 0:
+            step += ["--aod-file", aod_file]
+        if i == len(workflows) - 1 and extra_args:
+            step += shlex.split(extra_args)
+        steps.append(" ".join(shlex.quote(arg) for arg in step))
+    return " | ".join(steps)
+
+
+def device_name(pid: int):
+    """Return the DPL device name of a process, or the name of its executable."""
+    try:
+        with open(f"/proc/{pid}/cmdline", "rb") as file:
+            args = file.read().decode(errors="replace").split("\0")
+    except OSError:
+        return None
+    if "--id" in args:
+        i = args.index("--id")
+        if i + 1 < len(args):
+            return args[i + 1]
+    return os.path.basename(args[0]) if args and args[0] else None
+
+
+def sample_session(session: int, devices: dict):
+    """Update the CPU time and the peak RSS of the processes of a session."""
+    for entry in os.listdir("/proc"):
+        if not entry.isdigit():
+            continue
+        pid = int(entry)
+        try:
+            with open(f"/proc/{pid}/stat") as file:
+                # the executable name is in parentheses and can contain spaces
+                fields = file.read().rsplit(")", 1)[1].split()
+            if int(fields[3]) != session:
+                continue
+            cpu = (int(fields[11]) + int(fields[12])) / CLOCK_TICKS
+            hwm = 0
+            with open(f"/proc/{pid}/status") as file:
+                for line in file:
+                    if line.startswith("VmHWM:"):
+                        hwm = int(line.split()[1]) / 1024
+                        break
+        except (OSError, IndexError, ValueError):
+            continue
+        if not (name := device_name(pid)):
+            continue
+        # several processes can have the same name (e.g. the shell), sum them by pid
+        device = devices.setdefault(name, {})
+        device[pid] = {"cpu": cpu, "rss": max(hwm, device.get(pid, {}).get("rss", 0))}
+
+
+def run_chain(name: str, workflows: list, args, n_events):
+    """Run a chain and return its measurements."""
+    config = os.path.join(args.config_dir, f"{name}.json") if args.config_dir else ""
+    if config and not os.path.isfile(config):
+        config = ""
+    command = make_command(workflows, args.aod_input, config, args.extra_args)
+    print(f"Running chain {name}")
+    if args.verbose:
+        print(command)
+    log_path = os.path.join(args.log_dir, f"{name}.log")
+    devices = {}
+    usage_before = resource.getrusage(resource.RUSAGE_CHILDREN)
+    start = time.monotonic()
+    with open(log_path, "w") as log:
+        # own session to find all the processes of the chain in /proc
+        process = sp.Popen(command, shell=True, executable="/bin/bash", stdout=log, stderr=sp.STDOUT, start_new_session=True)  # nosec B602
+        while process.poll() is None:
+            sample_session(process.pid, devices)
+            time.sleep(args.sampling)
+    wall_time = time.monotonic() - start
+    usage_after = resource.getrusage(resource.RUSAGE_CHILDREN)
+    cpu_time = (usage_after.ru_utime - usage_before.ru_utime) + (usage_after.ru_stime - usage_before.ru_stime)
+    if process.returncode != 0:
+        msg_err(f"Chain {name} failed with exit code {process.returncode}, see {log_path}")
+    result = {
+        "workflows": workflows,
+        "command": command,
+        "exit-code": process.returncode,
+        "wall-time-s": round(wall_time, 3),
+        "events": n_events,
+        "events-per-s": round(n_events / wall_time, 3) if n_events else None,
+        "cpu-time-s": round(cpu_time, 3),
+        # ru_maxrss of the children is the peak of the largest terminated descendant
+        "peak-rss-mb": round(usage_after.ru_maxrss / 1024, 1),
+        "devices": {},
+    }
+    for device, processes in sorted(devices.items()):
+        result["devices"][device] = {
+            "cpu-time-s": round(sum(p["cpu"] for p in processes.values()), 3),
+            "peak-rss-mb": round(max(p["rss"] for p in processes.values()), 1),
+        }
+    return result
+
+
+def compare(report: dict, reference: dict, tolerance: float):
+    """Compare a report with a reference report. Return the list of regressions."""
+    regressions = []
+    if report["sha256"] and reference.get("sha256") and report["sha256"] != reference["sha256"]:
+        msg_warn("The reference report was obtained on a different input file.")
+    for name, chain in report["chains"].items():
+        if chain["exit-code"] != 0:
+            regressions.append(f"{name}: failed with exit code {chain['exit-code']}")
+            continue
+        if not (chain_ref := reference.get("chains", {}).get(name)):
+            continue
+        rate, rate_ref = chain["events-per-s"], chain_ref.get("events-per-s")
+        if rate and rate_ref and rate < (1 - tolerance) * rate_ref:
+            regressions.append(f"{name}: {rate} events/s, reference {rate_ref} events/s")
+        rss, rss_ref = chain["peak-rss-mb"], chain_ref.get("peak-rss-mb")
+        if rss and rss_ref and rss > (1 + tolerance) * rss_ref:
+            regressions.append(f"{name}: peak RSS {rss} MB, reference {rss_ref} MB")
+    return regressions
+
+
+def main():
+    """Main function"""
+    parser = argparse.ArgumentParser(
+        description="Replay an AO2D sample through standard workflow chains and report their throughput."
+    )
+    parser.add_argument("--aod-file", required=True, help="input AO2D file, or text file with a list of AO2D files")
+    parser.add_argument("--sha256", help="expected SHA-256 checksum of the input file")
+    parser.add_argument("-c", "--chains", nargs="+", choices=list(CHAINS), default=list(CHAINS), help="chains to run")
+    parser.add_argument("--config-dir", help="directory with the configuration <chain>.json of the chains")
+    parser.add_argument("--extra-args", default="", help="arguments added to the last workflow (e.g. --shm-segment-size)")
+    parser.add_argument("--events", type=int, help="number of events in the input, counted with PyROOT if not given")
+    parser.add_argument("--sampling", type=float, default=0.2, help="sampling period of the processes in seconds")
+    parser.add_argument("--log-dir", default=".", help="directory of the logs of the chains")
+    parser.add_argument("-o", "--output", default="throughput_report.json", help="output report")
+    parser.add_argument("--reference", help="reference report to compare with")
+    parser.add_argument("--tolerance", type=float, default=0.1, help="relative tolerance of the comparison")
+    parser.add_argument("-v", "--verbose", action="store_true", help="print the commands")
+    args = parser.parse_args()
+
+    if not os.path.isfile(args.aod_file):
+        msg_fatal(f"{args.aod_file} does not exist.")
+    if not os.path.isdir(args.log_dir):
+        os.makedirs(args.log_dir)
+    # DPL reads a list of files with the @ prefix
+    is_list = not args.aod_file.endswith(".root")
+    args.aod_input = f"@{args.aod_file}" if is_list else args.aod_file
+
+    checksum = sha256sum(args.aod_file)
+    if args.sha256 and checksum != args.sha256:
+        msg_fatal(f"Checksum of {args.aod_file} is {checksum}, expected {args.sha256}.")
+
+    n_events = args.events
+    if n_events is None:
+        if is_list:
+            with open(args.aod_file) as file:
+                counts = [count_events(line.strip()) for line in file if line.strip()]
+            n_events = None if None in counts else sum(counts)
+        else:
+            n_events = count_events(args.aod_file)
+
+    report = {
+        "date": datetime.now(timezone.utc).isoformat(timespec="seconds"),
+        "host": platform.node(),
+        "cpu": platform.processor(),
+        "aod-file": args.aod_file,
+        "sha256": checksum,
+        "chains": {},
+    }
+    for name in args.chains:
+        report["chains"][name] = run_chain(name, CHAINS[name], args, n_events)
+        chain = report["chains"][name]
+        print(f"  {chain['wall-time-s']} s, {chain['events-per-s']} events/s, peak RSS {chain['peak-rss-mb']} MB")
+
+    with open(args.output, "w") as file:
+        json.dump(report, file, indent=2)
+    print(f"Report written in {args.output}")
+
+    regressions = []
+    if args.reference:
+        with open(args.reference) as file:
+            regressions = compare(report, json.load(file), args.tolerance)
+    else:
+        regressions = [f"{name}: failed" for name, chain in report["chains"].items() if chain["exit-code"] != 0]
+    for regression in regressions:
+        msg_err(regression)
+    sys.exit(1 if regressions else 0)
+
+
+if __name__ == "__main__":
+    main()
@@ -21,6 +21,11 @@
 #define HomogeneousField
 #endif
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
 #include "KFParticle.h"
 #include "KFPTrack.h"
 #include "KFPVertex.h"
@@ -103,6 +108,90 @@ KFPTrack createKFPTrackFromTrackParCov(const o2::track::TrackParametrizationWith
   return kfpTrack;
 }
 
+/// @brief KFPTracks and KFParticles of the tracks of a collision for a set of mass hypotheses.
+/// Each track is converted once, on first use, instead of once for every pair or triplet it enters.
+/// The tracks are looked up by their global index. The returned references are valid until the next lookup.
+/// @tparam NHypotheses number of mass hypotheses
+template <std::size_t NHypotheses>
+class KFParticleCache
+{
+ public:
+  /// @param pdgCodes PDG codes of the mass hypotheses, in the order of their indices
+  explicit KFParticleCache(std::array<int, NHypotheses> const& pdgCodes) : mPdgCodes(pdgCodes) {}
+
+  /// @brief Clears the cache, to be called for each new collision
+  void reset() { mEntries.clear(); }
+
+  /// @brief KFPTrack of the track
+  template <typename T>
+  KFPTrack const& kfpTrack(const T& track)
+  {
+    auto& entry = getEntry(track);
+    if (!entry.hasTrack) {
+      entry.kfpTrack = createKFPTrackFromTrack(track);
+      entry.hasTrack = true;
+    }
+    return entry.kfpTrack;
+  }
+
+  /// @brief KFParticle of the track for the mass hypothesis of index iHypothesis
+  template <typename T>
+  KFParticle const& particle(const T& track, std::size_t iHypothesis)
+  {
+    auto& entry = getEntry(track);
+    if (!entry.hasParticle[iHypothesis]) {
+      if (!entry.hasTrack) {
+        entry.kfpTrack = createKFPTrackFromTrack(track);
+        entry.hasTrack = true;
+      }
+      entry.particles[iHypothesis] = KFParticle(entry.kfpTrack, mPdgCodes[iHypothesis]);
+      entry.hasParticle[iHypothesis] = true;
+    }
+    return entry.particles[iHypothesis];
+  }
+
+ private:
+  struct Entry {
+    bool hasTrack = false;
+    std::array<bool, NHypotheses> hasParticle{};
+    KFPTrack kfpTrack;
+    std::array<KFParticle, NHypotheses> particles;
+  };
+
+  template <typename T>
+  Entry& getEntry(const T& track)
+  {
+    const int64_t index = track.globalIndex();
+    if (mEntries.empty()) {
+      mFirst = index;
+    } else if (index < mFirst) {
+      mEntries.insert(mEntries.begin(), mFirst - index, Entry{});
+      mFirst = index;
+    }
+    if (index - mFirst >= static_cast<int64_t>(mEntries.size())) {
+      mEntries.resize(index - mFirst + 1);
+    }
+    return mEntries[index - mFirst];
+  }
+
+  std::array<int, NHypotheses> mPdgCodes;
+  int64_t mFirst = 0;          ///< global index of the first entry
+  std::vector<Entry> mEntries; ///< entries of the tracks from mFirst on
+};
+
+/// @brief Mother particle constructed from its daughters
+/// @param daughters pointers to the daughter KFParticles
+/// @param constructMethod KFParticle construction method
+/// @return mother KFParticle
+template <std::size_t N>
+KFParticle constructMother(std::array<const KFParticle*, N> daughters, int constructMethod = 2)
+{
+  KFParticle mother;
+  mother.SetConstructMethod(constructMethod);
+  mother.Construct(daughters.data(), N);
+  return mother;
+}
+
 /// @brief Cosine of pointing angle from KFParticles
 /// @param kfp KFParticle
 /// @param PV KFParticle primary vertex
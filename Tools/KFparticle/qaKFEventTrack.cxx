@@ -393,8 +393,7 @@ struct qaKFEventTrack {
     KFPVertex kfpVertex = createKFPVertexFromCollision(collision);
     KFParticle KFPV(kfpVertex);
 
-    KFPVertex kfpVertexDefault = createKFPVertexFromCollision(collision);
-    KFParticle KFPVDefault(kfpVertexDefault);
+    KFParticle KFPVDefault = KFPV;
     if (writeHistograms) {
       /// fill collision parameters
       histos.fill(HIST("EventsKF/posX"), kfpVertex.GetX());
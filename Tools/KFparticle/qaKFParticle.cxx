@@ -76,6 +76,10 @@ struct qaKFParticle {
   int runNumber;
   double magneticField = 0.;
   int PVContributor = 0;
+  /// KFParticles of the tracks of the current collision, for the pion and kaon hypotheses
+  enum Hypothesis { kHypPion = 0,
+                    kHypKaon };
+  KFParticleCache<2> kfParticles{{211, 321}};
 
   /// Histogram Configurables
   ConfigurableAxis binsPt{"binsPt", {VARIABLE_WIDTH, 0.0, 1., 2., 3., 4., 5., 6., 7., 8., 9., 10., 11., 12., 13., 14., 15., 16., 17., 24., 36., 50.0}, ""};
@@ -665,6 +669,7 @@ struct qaKFParticle {
     /// set KF primary vertex
     KFPVertex kfpVertex = createKFPVertexFromCollision(collision);
     KFParticle KFPV(kfpVertex);
+    kfParticles.reset();
     for (auto& [track1, track2] : combinations(soa::CombinationsStrictlyUpperIndexPolicy(tracks, tracks))) {
 
       histos.fill(HIST("DZeroCandTopo/Selections"), 3.f);
@@ -679,6 +684,10 @@ struct qaKFParticle {
       KFPTrack kfpTrackNegPi;
       KFPTrack kfpTrackPosKa;
       KFPTrack kfpTrackNegKa;
+      KFParticle KFPosPion;
+      KFParticle KFNegPion;
+      KFParticle KFPosKaon;
+      KFParticle KFNegKaon;
 
       bool CandD0 = false;
       bool CandD0bar = false;
@@ -715,8 +724,10 @@ struct qaKFParticle {
         if (track1.sign() == 1 && track2.sign() == -1) {
           CandD0 = true;
           source = 1;
-          kfpTrackPosPi = createKFPTrackFromTrack(track1);
-          kfpTrackNegKa = createKFPTrackFromTrack(track2);
+          kfpTrackPosPi = kfParticles.kfpTrack(track1);
+          KFPosPion = kfParticles.particle(track1, kHypPion);
+          kfpTrackNegKa = kfParticles.kfpTrack(track2);
+          KFNegKaon = kfParticles.particle(track2, kHypKaon);
           TPCnSigmaPosPi = track1.tpcNSigmaPi();
           TPCnSigmaNegKa = track2.tpcNSigmaKa();
           TOFnSigmaPosPi = track1.tofNSigmaPi();
@@ -726,8 +737,10 @@ struct qaKFParticle {
         } else if (track1.sign() == -1 && track2.sign() == 1) {
           CandD0bar = true;
           source = 2;
-          kfpTrackNegPi = createKFPTrackFromTrack(track1);
-          kfpTrackPosKa = createKFPTrackFromTrack(track2);
+          kfpTrackNegPi = kfParticles.kfpTrack(track1);
+          KFNegPion = kfParticles.particle(track1, kHypPion);
+          kfpTrackPosKa = kfParticles.kfpTrack(track2);
+          KFPosKaon = kfParticles.particle(track2, kHypKaon);
           TPCnSigmaNegPi = track1.tpcNSigmaPi();
           TPCnSigmaPosKa = track2.tpcNSigmaKa();
           TOFnSigmaNegPi = track1.tofNSigmaPi();
@@ -745,8 +758,10 @@ struct qaKFParticle {
           if (CandD0 == true) {
             source = 3;
           }
-          kfpTrackNegPi = createKFPTrackFromTrack(track2);
-          kfpTrackPosKa = createKFPTrackFromTrack(track1);
+          kfpTrackNegPi = kfParticles.kfpTrack(track2);
+          KFNegPion = kfParticles.particle(track2, kHypPion);
+          kfpTrackPosKa = kfParticles.kfpTrack(track1);
+          KFPosKaon = kfParticles.particle(track1, kHypKaon);
           TPCnSigmaNegPi = track2.tpcNSigmaPi();
           TPCnSigmaPosKa = track1.tpcNSigmaKa();
           TOFnSigmaNegPi = track2.tofNSigmaPi();
@@ -759,8 +774,10 @@ struct qaKFParticle {
           if (CandD0bar == true) {
             source = 3;
           }
-          kfpTrackPosPi = createKFPTrackFromTrack(track2);
-          kfpTrackNegKa = createKFPTrackFromTrack(track1);
+          kfpTrackPosPi = kfParticles.kfpTrack(track2);
+          KFPosPion = kfParticles.particle(track2, kHypPion);
+          kfpTrackNegKa = kfParticles.kfpTrack(track1);
+          KFNegKaon = kfParticles.particle(track1, kHypKaon);
           TPCnSigmaPosPi = track2.tpcNSigmaPi();
           TPCnSigmaNegKa = track1.tpcNSigmaKa();
           TOFnSigmaPosPi = track2.tofNSigmaPi();
@@ -776,19 +793,10 @@ struct qaKFParticle {
         continue;
       }
 
-      KFParticle KFPosPion(kfpTrackPosPi, 211);
-      KFParticle KFNegPion(kfpTrackNegPi, 211);
-      KFParticle KFPosKaon(kfpTrackPosKa, 321);
-      KFParticle KFNegKaon(kfpTrackNegKa, 321);
-
-      int NDaughters = 2;
       float cosThetaStar = 0;
 
       if (CandD0) {
-        KFParticle KFDZero;
-        const KFParticle* D0Daughters[2] = {&KFPosPion, &KFNegKaon};
-        KFDZero.SetConstructMethod(2);
-        KFDZero.Construct(D0Daughters, NDaughters);
+        KFParticle KFDZero = constructMother<2>({&KFPosPion, &KFNegKaon});
         histos.fill(HIST("DZeroCandTopo/Selections"), 10.f);
         /// Apply daughter selection
         if (!isSelectedDaughters(KFPosPion, KFNegKaon, KFDZero, KFPV)) {
@@ -820,10 +828,7 @@ struct qaKFParticle {
         writeVarTree(kfpTrackPosPi, kfpTrackNegKa, KFPosPion, KFNegKaon, KFDZero_PV, KFDZero, KFPV, KFDZero_DecayVtx, TPCnSigmaPosPi, TOFnSigmaPosPi, TPCnSigmaNegKa, TOFnSigmaNegKa, TPCNclsPosPi, TPCNclsNegKa, cosThetaStar, track1, source);
       }
       if (CandD0bar) {
-        KFParticle KFDZeroBar;
-        const KFParticle* D0BarDaughters[2] = {&KFNegPion, &KFPosKaon};
-        KFDZeroBar.SetConstructMethod(2);
-        KFDZeroBar.Construct(D0BarDaughters, NDaughters);
+        KFParticle KFDZeroBar = constructMother<2>({&KFNegPion, &KFPosKaon});
         histos.fill(HIST("DZeroCandTopo/Selections"), 10.f);
         /// Apply daughter selection
         if (!isSelectedDaughters(KFNegPion, KFPosKaon, KFDZeroBar, KFPV)) {
@@ -883,8 +888,8 @@ struct qaKFParticle {
     KFPVertex kfpVertex = createKFPVertexFromCollision(collision);
     KFParticle KFPV(kfpVertex);
 
-    KFPVertex kfpVertexDefault = createKFPVertexFromCollision(collision);
-    KFParticle KFPVDefault(kfpVertexDefault);
+    KFParticle KFPVDefault = KFPV;
+    kfParticles.reset();
 
     for (auto& [track1, track2] : combinations(soa::CombinationsStrictlyUpperIndexPolicy(tracks, tracks))) {
 
@@ -983,6 +988,10 @@ struct qaKFParticle {
       KFPTrack kfpTrackNegPi;
       KFPTrack kfpTrackPosKa;
       KFPTrack kfpTrackNegKa;
+      KFParticle KFPosPion;
+      KFParticle KFNegPion;
+      KFParticle KFPosKaon;
+      KFParticle KFNegKaon;
 
       bool CandD0 = false;
       bool CandD0bar = false;
@@ -1022,8 +1031,10 @@ struct qaKFParticle {
           if (pdgMother == -421) {
             sourceD0 |= kReflection;
           }
-          kfpTrackPosPi = createKFPTrackFromTrack(track1);
-          kfpTrackNegKa = createKFPTrackFromTrack(track2);
+          kfpTrackPosPi = kfParticles.kfpTrack(track1);
+          KFPosPion = kfParticles.particle(track1, kHypPion);
+          kfpTrackNegKa = kfParticles.kfpTrack(track2);
+          KFNegKaon = kfParticles.particle(track2, kHypKaon);
           TPCnSigmaPosPi = track1.tpcNSigmaPi();
           TPCnSigmaNegKa = track2.tpcNSigmaKa();
           TOFnSigmaPosPi = track1.tofNSigmaPi();
@@ -1035,8 +1046,10 @@ struct qaKFParticle {
           if (pdgMother == 421) {
             sourceD0Bar |= kReflection;
           }
-          kfpTrackNegPi = createKFPTrackFromTrack(track1);
-          kfpTrackPosKa = createKFPTrackFromTrack(track2);
+          kfpTrackNegPi = kfParticles.kfpTrack(track1);
+          KFNegPion = kfParticles.particle(track1, kHypPion);
+          kfpTrackPosKa = kfParticles.kfpTrack(track2);
+          KFPosKaon = kfParticles.particle(track2, kHypKaon);
           TPCnSigmaNegPi = track1.tpcNSigmaPi();
           TPCnSigmaPosKa = track2.tpcNSigmaKa();
           TOFnSigmaNegPi = track1.tofNSigmaPi();
@@ -1053,8 +1066,10 @@ struct qaKFParticle {
           if (pdgMother == 421) {
             sourceD0Bar |= kReflection;
           }
-          kfpTrackNegPi = createKFPTrackFromTrack(track2);
-          kfpTrackPosKa = createKFPTrackFromTrack(track1);
+          kfpTrackNegPi = kfParticles.kfpTrack(track2);
+          KFNegPion = kfParticles.particle(track2, kHypPion);
+          kfpTrackPosKa = kfParticles.kfpTrack(track1);
+          KFPosKaon = kfParticles.particle(track1, kHypKaon);
           TPCnSigmaNegPi = track2.tpcNSigmaPi();
           TPCnSigmaPosKa = track1.tpcNSigmaKa();
           TOFnSigmaNegPi = track2.tofNSigmaPi();
@@ -1066,8 +1081,10 @@ struct qaKFParticle {
           if (pdgMother == -421) {
             sourceD0 |= kReflection;
           }
-          kfpTrackPosPi = createKFPTrackFromTrack(track2);
-          kfpTrackNegKa = createKFPTrackFromTrack(track1);
+          kfpTrackPosPi = kfParticles.kfpTrack(track2);
+          KFPosPion = kfParticles.particle(track2, kHypPion);
+          kfpTrackNegKa = kfParticles.kfpTrack(track1);
+          KFNegKaon = kfParticles.particle(track1, kHypKaon);
           TPCnSigmaPosPi = track2.tpcNSigmaPi();
           TPCnSigmaNegKa = track1.tpcNSigmaKa();
           TOFnSigmaPosPi = track2.tofNSigmaPi();
@@ -1083,19 +1100,10 @@ struct qaKFParticle {
         continue;
       }
 
-      KFParticle KFPosPion(kfpTrackPosPi, 211);
-      KFParticle KFNegPion(kfpTrackNegPi, 211);
-      KFParticle KFPosKaon(kfpTrackPosKa, 321);
-      KFParticle KFNegKaon(kfpTrackNegKa, 321);
-
-      int NDaughters = 2;
       float cosThetaStar = 0;
 
       if (CandD0) {
-        KFParticle KFDZero;
-        const KFParticle* D0Daughters[2] = {&KFPosPion, &KFNegKaon};
-        KFDZero.SetConstructMethod(2);
-        KFDZero.Construct(D0Daughters, NDaughters);
+        KFParticle KFDZero = constructMother<2>({&KFPosPion, &KFNegKaon});
         histos.fill(HIST("DZeroCandTopo/Selections"), 10.f);
         /// Apply daughter selection
         if (!isSelectedDaughters(KFPosPion, KFNegKaon, KFDZero, KFPV)) {
@@ -1132,10 +1140,7 @@ struct qaKFParticle {
         writeVarTree(kfpTrackPosPi, kfpTrackNegKa, KFPosPion, KFNegKaon, KFDZero_PV, KFDZero, KFPV, KFDZero_DecayVtx, TPCnSigmaPosPi, TOFnSigmaPosPi, TPCnSigmaNegKa, TOFnSigmaNegKa, TPCNclsPosPi, TPCNclsNegKa, cosThetaStar, track1, sourceD0);
       }
       if (CandD0bar) {
-        KFParticle KFDZeroBar;
-        const KFParticle* D0BarDaughters[2] = {&KFNegPion, &KFPosKaon};
-        KFDZeroBar.SetConstructMethod(2);
-        KFDZeroBar.Construct(D0BarDaughters, NDaughters);
+        KFParticle KFDZeroBar = constructMother<2>({&KFNegPion, &KFPosKaon});
         histos.fill(HIST("DZeroCandTopo/Selections"), 10.f);
         /// Apply daughter selection
         if (!isSelectedDaughters(KFNegPion, KFPosKaon, KFDZeroBar, KFPV)) {
@@ -76,6 +76,11 @@ struct qaKFParticleLc {
   int runNumber;
   double magneticField = 0.;
   KFParticle KFPion, KFKaon, KFProton, KFLc, KFLc_PV;
+  /// KFParticles of the tracks of the current collision, for the pion, kaon and proton hypotheses
+  enum Hypothesis { kHypPion = 0,
+                    kHypKaon,
+                    kHypProton };
+  KFParticleCache<3> kfParticles{{211, 321, 2212}};
 
   /// option to select good events
   Configurable<bool> eventSelection{"eventSelection", true, "select good events"}; // currently only sel8 is defined for run3
@@ -247,18 +252,10 @@ struct qaKFParticleLc {
   template <typename T, typename T2>
   bool ReconstructLc(const T& trackKaon, const T& trackPion, const T& trackProton, const T2& KFPV)
   {
-    KFPTrack kfpTrackKa = createKFPTrackFromTrack(trackKaon);
-    KFPTrack kfpTrackPi = createKFPTrackFromTrack(trackPion);
-    KFPTrack kfpTrackPr = createKFPTrackFromTrack(trackProton);
-    KFParticle KFKa(kfpTrackKa, 321);
-    KFKaon = KFKa;
-    KFParticle KFPi(kfpTrackPi, 211);
-    KFPion = KFPi;
-    KFParticle KFPr(kfpTrackPr, 2212);
-    KFProton = KFPr;
-    const KFParticle* LcDaughters[3] = {&KFKaon, &KFPion, &KFProton};
-    KFLc.SetConstructMethod(2);
-    KFLc.Construct(LcDaughters, 3);
+    KFKaon = kfParticles.particle(trackKaon, kHypKaon);
+    KFPion = kfParticles.particle(trackPion, kHypPion);
+    KFProton = kfParticles.particle(trackProton, kHypProton);
+    KFLc = constructMother<3>({&KFKaon, &KFPion, &KFProton});
     if (!isSelectedDaughters(KFPion, KFKaon, KFProton)) {
       return false;
     }
@@ -480,6 +477,7 @@ struct qaKFParticleLc {
     /// set KF primary vertex
     KFPVertex kfpVertex = createKFPVertexFromCollision(collision);
     KFParticle KFPV(kfpVertex);
+    kfParticles.reset();
 
     for (auto& [track1, track2, track3] : combinations(soa::CombinationsStrictlyUpperIndexPolicy(tracks, tracks, tracks))) {
 
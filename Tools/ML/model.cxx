@@ -20,12 +20,22 @@
 // ONNX includes
 #include "Tools/ML/model.h"
 
+#include <mutex>
+
 namespace o2
 {
 
 namespace ml
 {
 
+namespace
+{
+/// Environment and sessions shared among the models of the process
+std::mutex gSharedMutex;
+std::shared_ptr<Ort::Env> gSharedEnv = nullptr;
+std::map<std::string, std::weak_ptr<Ort::Experimental::Session>> gSharedSessions;
+} // namespace
+
 std::string OnnxModel::printShape(const std::vector<int64_t>& v)
 {
   std::stringstream ss("");
@@ -69,13 +79,39 @@ void OnnxModel::initModel(std::string localPath, bool enableOptimizations, int t
     sessionOptions.SetIntraOpNumThreads(activeThreads);
   }
 
+  /// Inter-op parallelism
+  if (interOpThreads > 0) {
+    sessionOptions.SetInterOpNumThreads(interOpThreads);
+    sessionOptions.SetExecutionMode(ExecutionMode::ORT_PARALLEL);
+  }
+
   /// Enableing optimizations
   if (enableOptimizations) {
     sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
   }
 
-  mEnv = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "onnx-model");
-  mSession = std::make_shared<Ort::Experimental::Session>(*mEnv, modelPath, sessionOptions);
+  /// Buffers bound to a previous session are not valid anymore
+  mIoBinding.reset();
+  mBoundTensors.clear();
+
+  if (shareSession) {
+    const std::string key = modelPath + ":" + std::to_string(enableOptimizations) + ":" + std::to_string(activeThreads) + ":" + std::to_string(interOpThreads) + ":" + std::to_string(from) + ":" + std::to_string(until);
+    std::lock_guard<std::mutex> lock(gSharedMutex);
+    if (!gSharedEnv) {
+      gSharedEnv = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "onnx-model-shared");
+    }
+    mEnv = gSharedEnv;
+    mSession = gSharedSessions[key].lock();
+    if (mSession) {
+      LOG(info) << "Reusing shared session for " << modelPath;
+    } else {
+      mSession = std::make_shared<Ort::Experimental::Session>(*mEnv, modelPath, sessionOptions);
+      gSharedSessions[key] = mSession;
+    }
+  } else {
+    mEnv = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "onnx-model");
+    mSession = std::make_shared<Ort::Experimental::Session>(*mEnv, modelPath, sessionOptions);
+  }
 
   mInputNames = mSession->GetInputNames();
   mInputShapes = mSession->GetInputShapes();
@@ -100,6 +136,26 @@ void OnnxModel::initModel(std::string localPath, bool enableOptimizations, int t
   LOG(info) << "--- Model initialized! ---";
 }
 
+bool OnnxModel::evalBound()
+{
+  if (!mIoBinding) {
+    LOG(error) << "No buffers bound to the model, call bindBuffers first";
+    return false;
+  }
+  try {
+    mSession->Run(Ort::RunOptions{nullptr}, *mIoBinding);
+  } catch (const Ort::Exception& exception) {
+    LOG(error) << "Error running model inference on bound buffers: " << exception.what();
+    return false;
+  }
+  return true;
+}
+
+void OnnxModel::setInterOpThreads(int threads)
+{
+  interOpThreads = threads;
+}
+
 void OnnxModel::setActiveThreads(int threads)
 {
   activeThreads = threads;
@@ -22,6 +22,7 @@
 
 // C++ and system includes
 #include <onnxruntime/core/session/experimental_onnxruntime_cxx_api.h>
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <memory>
@@ -88,6 +89,68 @@ class OnnxModel
     return evalModel<T>(inputTensors);
   }
 
+  /// Evaluates the model on a contiguous input holding nRows = input.size() / getNumInputNodes() rows.
+  /// The rows are sent to the session in batches of at most maxBatchSize rows (all at once if maxBatchSize <= 0)
+  /// and the last output tensor of each batch is copied into output, which is resized to nRows * getNumOutputNodes().
+  template <typename T>
+  bool evalModelBatched(std::vector<T>& input, std::vector<T>& output, int64_t maxBatchSize = 0)
+  {
+    const int64_t nInputs = mInputShapes[0][1];
+    const int64_t nOutputs = mOutputShapes.back()[1];
+    assert(input.size() % nInputs == 0);
+    const int64_t nRows = input.size() / nInputs;
+    if (maxBatchSize <= 0 || maxBatchSize > nRows) {
+      maxBatchSize = nRows;
+    }
+    output.resize(nRows * nOutputs);
+    try {
+      for (int64_t first = 0; first < nRows; first += maxBatchSize) {
+        const int64_t batchSize = std::min(maxBatchSize, nRows - first);
+        std::vector<int64_t> inputShape{batchSize, nInputs};
+        std::vector<Ort::Value> inputTensors;
+        inputTensors.emplace_back(Ort::Experimental::Value::CreateTensor<T>(input.data() + first * nInputs, batchSize * nInputs, inputShape));
+        auto outputTensors = mSession->Run(mInputNames, inputTensors, mOutputNames);
+        if (outputTensors.size() != mOutputNames.size()) {
+          LOG(fatal) << "Number of output tensors: " << outputTensors.size() << " does not agree with the model specified size: " << mOutputNames.size();
+        }
+        const T* outputValues = outputTensors.back().GetTensorData<T>();
+        std::copy(outputValues, outputValues + batchSize * nOutputs, output.begin() + first * nOutputs);
+      }
+    } catch (const Ort::Exception& exception) {
+      LOG(error) << "Error running batched model inference: " << exception.what();
+      return false;
+    }
+    return true;
+  }
+
+  /// Binds reusable input and output buffers of nRows rows to the session. The buffers are resized here and must not be
+  /// resized or reallocated afterwards: evalBound() then reads the input and writes the last output of the model in place,
+  /// without allocating, and the results stay valid until the next evaluation.
+  template <typename T>
+  void bindBuffers(std::vector<T>& input, std::vector<T>& output, int64_t nRows = 1)
+  {
+    const int64_t nInputs = mInputShapes[0][1];
+    const int64_t nOutputs = mOutputShapes.back()[1];
+    input.resize(nRows * nInputs);
+    output.resize(nRows * nOutputs);
+    std::vector<int64_t> inputShape{nRows, nInputs};
+    std::vector<int64_t> outputShape{nRows, nOutputs};
+    mBoundTensors.clear();
+    mBoundTensors.emplace_back(Ort::Experimental::Value::CreateTensor<T>(input.data(), input.size(), inputShape));
+    mBoundTensors.emplace_back(Ort::Experimental::Value::CreateTensor<T>(output.data(), output.size(), outputShape));
+    mIoBinding = std::make_unique<Ort::IoBinding>(*mSession);
+    mIoBinding->BindInput(mInputNames[0].c_str(), mBoundTensors[0]);
+    Ort::MemoryInfo memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+    for (std::size_t i = 0; i + 1 < mOutputNames.size(); i++) { // Outputs other than the last one are allocated by the runtime
+      mIoBinding->BindOutput(mOutputNames[i].c_str(), memoryInfo);
+    }
+    mIoBinding->BindOutput(mOutputNames.back().c_str(), mBoundTensors[1]);
+    LOG(debug) << "Bound input " << printShape(inputShape) << " and output " << printShape(outputShape) << " buffers";
+  }
+
+  /// Evaluates the model on the buffers bound with bindBuffers
+  bool evalBound();
+
   // Reset session
   void resetSession() { mSession.reset(new Ort::Experimental::Session{*mEnv, modelPath, sessionOptions}); }
 
@@ -99,6 +162,8 @@ class OnnxModel
   uint64_t getValidityFrom() const { return validFrom; }
   uint64_t getValidityUntil() const { return validUntil; }
   void setActiveThreads(int);
+  void setInterOpThreads(int);                               // To be called before initModel, the intra-op threads are set in initModel
+  void setShareSession(bool share) { shareSession = share; } // To be called before initModel
 
  private:
   // Environment variables for the ONNX runtime
@@ -106,6 +171,10 @@ class OnnxModel
   std::shared_ptr<Ort::Experimental::Session> mSession = nullptr;
   Ort::SessionOptions sessionOptions;
 
+  // Buffers bound to the session
+  std::unique_ptr<Ort::IoBinding> mIoBinding = nullptr;
+  std::vector<Ort::Value> mBoundTensors;
+
   // Input & Output specifications of the loaded network
   std::vector<std::string> mInputNames;
   std::vector<std::vector<int64_t>> mInputShapes;
@@ -115,6 +184,8 @@ class OnnxModel
   // Environment settings
   std::string modelPath;
   int activeThreads = 0;
+  int interOpThreads = 0;    // 0: operators are executed sequentially
+  bool shareSession = false; // Share one environment and one session per model among all instances in the process
   uint64_t validFrom = 0;
   uint64_t validUntil = 0;
 
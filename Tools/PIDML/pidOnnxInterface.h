@@ -115,6 +115,47 @@ struct PidONNXInterface {
     return false;
   }
 
+  /// Evaluates all the models for all the tracks of a table, with one inference call per model
+  /// \param tracks table of tracks
+  /// \param certainties output certainties, indexed by the position of the pid in the constructor list and by the position of the track in the table. Tracks without a suitable model get -1
+  template <typename T>
+  void applyModelsBatch(const T& tracks, std::vector<std::vector<float>>& certainties)
+  {
+    certainties.assign(mNPids, std::vector<float>(tracks.size(), -1.0f));
+    std::array<std::vector<typename T::iterator>, kNDetectors> tracksPerModel;
+    std::array<std::vector<int64_t>, kNDetectors> positionsPerModel;
+    std::vector<float> modelCertainties;
+    for (std::size_t i = 0; i < mNPids; i++) {
+      for (uint32_t j = 0; j < kNDetectors; j++) {
+        tracksPerModel[j].clear();
+        positionsPerModel[j].clear();
+      }
+      int64_t position = 0;
+      for (auto const& track : tracks) {
+        for (uint32_t j = 0; j < kNDetectors; j++) {
+          if (track.pt() >= mPTLimits[i][j] && (j == kNDetectors - 1 || track.pt() < mPTLimits[i][j + 1])) {
+            tracksPerModel[j].push_back(track);
+            positionsPerModel[j].push_back(position);
+            break;
+          }
+        }
+        position++;
+      }
+      for (uint32_t j = 0; j < kNDetectors; j++) {
+        if (tracksPerModel[j].empty()) {
+          continue;
+        }
+        mModels[i * kNDetectors + j].applyModelBatch(tracksPerModel[j], modelCertainties);
+        for (std::size_t k = 0; k < modelCertainties.size(); k++) {
+          certainties[i][positionsPerModel[j][k]] = modelCertainties[k];
+        }
+      }
+    }
+  }
+
+  /// Gets the minimum certainty to accept a track for the pid at the given position in the constructor list
+  double getMinCertainty(std::size_t i) const { return mModels[i * kNDetectors].mMinCertainty; }
+
  private:
   void fillDefaultConfiguration(std::vector<double>& minCertainties)
   {
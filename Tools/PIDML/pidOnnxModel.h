@@ -22,6 +22,7 @@
 #include <map>
 #include <utility>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include "onnxruntime/core/session/experimental_onnxruntime_cxx_api.h"
@@ -57,36 +58,62 @@ bool readJsonFile(const std::string& config, rapidjson::Document& d)
 }
 } // namespace
 
-struct PidONNXModel {
+/// ONNX session and input configuration of one model, shared by all the PidONNXModel instances using it
+struct PidONNXSharedModel {
+  std::vector<std::string> mTrainColumns;
+  std::map<std::string, std::pair<float, float>> mScalingParams;
+
+  // No empty constructors for Session, we need a pointer
+  std::shared_ptr<Ort::Experimental::Session> mSession = nullptr;
+
+  std::vector<std::string> mInputNames;
+  std::vector<std::vector<int64_t>> mInputShapes;
+  std::vector<std::string> mOutputNames;
+  std::vector<std::vector<int64_t>> mOutputShapes;
+};
+
+/// Process-wide registry of the PID ML models, keyed by model path and timestamp.
+/// Models requested by several instances (e.g. several tasks of the same workflow) are loaded and downloaded only once
+/// and released when the last instance using them is destroyed.
+class PidONNXModelRegistry
+{
  public:
-  PidONNXModel(std::string& localPath, std::string& ccdbPath, bool useCCDB, o2::ccdb::CcdbApi& ccdbApi, uint64_t timestamp, int pid, PidMLDetector detector, double minCertainty) : mDetector(detector), mPid(pid), mMinCertainty(minCertainty)
+  static PidONNXModelRegistry& instance()
   {
-    std::string modelFile;
-    loadInputFiles(localPath, ccdbPath, useCCDB, ccdbApi, timestamp, pid, modelFile);
-
-    Ort::SessionOptions sessionOptions;
-    mEnv = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "pid-onnx-inferer");
-    LOG(info) << "Loading ONNX model from file: " << modelFile;
-    mSession.reset(new Ort::Experimental::Session{*mEnv, modelFile, sessionOptions});
-    LOG(info) << "ONNX model loaded";
-
-    mInputNames = mSession->GetInputNames();
-    mInputShapes = mSession->GetInputShapes();
-    mOutputNames = mSession->GetOutputNames();
-    mOutputShapes = mSession->GetOutputShapes();
-
-    LOG(debug) << "Input Node Name/Shape (" << mInputNames.size() << "):";
-    for (size_t i = 0; i < mInputNames.size(); i++) {
-      LOG(debug) << "\t" << mInputNames[i] << " : " << printShape(mInputShapes[i]);
-    }
+    static PidONNXModelRegistry registry;
+    return registry;
+  }
 
-    LOG(debug) << "Output Node Name/Shape (" << mOutputNames.size() << "):";
-    for (size_t i = 0; i < mOutputNames.size(); i++) {
-      LOG(debug) << "\t" << mOutputNames[i] << " : " << printShape(mOutputShapes[i]);
+  /// Returns the model with the given key, calling loader to create it if it is not loaded yet
+  template <typename Loader>
+  std::shared_ptr<PidONNXSharedModel> get(std::string const& key, Loader&& loader)
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::shared_ptr<PidONNXSharedModel> model = mModels[key].lock();
+    if (!model) {
+      model = std::make_shared<PidONNXSharedModel>();
+      loader(*model, *mEnv);
+      mModels[key] = model;
+    } else {
+      LOG(debug) << "Reusing PID ML model " << key;
     }
+    return model;
+  }
 
-    // Assume model has 1 input node and 1 output node.
-    assert(mInputNames.size() == 1 && mOutputNames.size() == 1);
+ private:
+  PidONNXModelRegistry() : mEnv{std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "pid-onnx-inferer")} {}
+
+  std::mutex mMutex;
+  std::shared_ptr<Ort::Env> mEnv = nullptr;
+  std::map<std::string, std::weak_ptr<PidONNXSharedModel>> mModels;
+};
+
+/// Wrapper of one PID ML model. The model is taken from the PidONNXModelRegistry when it is first used,
+/// thus the CCDB api passed to the constructor must stay valid until then.
+struct PidONNXModel {
+ public:
+  PidONNXModel(std::string& localPath, std::string& ccdbPath, bool useCCDB, o2::ccdb::CcdbApi& ccdbApi, uint64_t timestamp, int pid, PidMLDetector detector, double minCertainty) : mDetector(detector), mPid(pid), mMinCertainty(minCertainty), mLocalPath(localPath), mCCDBPath(ccdbPath), mUseCCDB(useCCDB), mCCDBApi(&ccdbApi), mTimestamp(timestamp)
+  {
   }
   PidONNXModel() = default;
   PidONNXModel(PidONNXModel&&) = default;
@@ -107,6 +134,45 @@ struct PidONNXModel {
     return getModelOutput(track) >= mMinCertainty;
   }
 
+  /// Evaluates the model for all the tracks of a range in one inference call (one call per track if the model has a fixed batch size)
+  /// \param tracks range of tracks
+  /// \param certainties output certainties, in the order of the tracks
+  template <typename T>
+  void applyModelBatch(const T& tracks, std::vector<float>& certainties)
+  {
+    loadModel();
+    certainties.clear();
+    if (mModel->mInputShapes[0][0] != -1) { // Fixed batch size, evaluating track by track
+      for (auto const& track : tracks) {
+        certainties.push_back(getModelOutput(track));
+      }
+      return;
+    }
+    std::vector<float> inputTensorValues;
+    int64_t nTracks = 0;
+    for (auto const& track : tracks) {
+      createInputsSingle(track, inputTensorValues);
+      nTracks++;
+    }
+    if (nTracks == 0) {
+      return;
+    }
+    std::vector<int64_t> inputShape{nTracks, static_cast<int64_t>(inputTensorValues.size()) / nTracks};
+    std::vector<Ort::Value> inputTensors;
+    inputTensors.emplace_back(Ort::Experimental::Value::CreateTensor<float>(inputTensorValues.data(), inputTensorValues.size(), inputShape));
+    try {
+      auto outputTensors = mModel->mSession->Run(mModel->mInputNames, inputTensors, mModel->mOutputNames);
+      assert(outputTensors.size() == mModel->mOutputNames.size() && outputTensors[0].IsTensor());
+      const float* outputValues = outputTensors[0].GetTensorData<float>();
+      for (int64_t i = 0; i < nTracks; i++) {
+        certainties.push_back(sigmoid(outputValues[i])); // FIXME: Temporary, sigmoid will be added as network layer
+      }
+    } catch (const Ort::Exception& exception) {
+      LOG(error) << "Error running batched model inference: " << exception.what();
+      certainties.assign(nTracks, -1.f);
+    }
+  }
+
   PidMLDetector mDetector;
   int mPid;
   double mMinCertainty;
@@ -144,7 +210,7 @@ struct PidONNXModel {
     }
   }
 
-  void loadInputFiles(std::string const& localPath, std::string const& ccdbPath, bool useCCDB, o2::ccdb::CcdbApi& ccdbApi, uint64_t timestamp, int pid, std::string& modelPath)
+  void loadInputFiles(PidONNXSharedModel& model, std::string const& localPath, std::string const& ccdbPath, bool useCCDB, o2::ccdb::CcdbApi& ccdbApi, uint64_t timestamp, int pid, std::string& modelPath)
   {
     rapidjson::Document trainColumnsDoc;
     rapidjson::Document scalingParamsDoc;
@@ -169,48 +235,86 @@ struct PidONNXModel {
     LOG(info) << "Using configuration files: " << localTrainColumnsPath << ", " << localScalingParamsPath;
     if (readJsonFile(localTrainColumnsPath, trainColumnsDoc)) {
       for (auto& param : trainColumnsDoc["columns_for_training"].GetArray()) {
-        mTrainColumns.emplace_back(param.GetString());
+        model.mTrainColumns.emplace_back(param.GetString());
       }
     }
     if (readJsonFile(localScalingParamsPath, scalingParamsDoc)) {
       for (auto& param : scalingParamsDoc["data"].GetArray()) {
-        mScalingParams[param[0].GetString()] = std::make_pair(param[1].GetFloat(), param[2].GetFloat());
+        model.mScalingParams[param[0].GetString()] = std::make_pair(param[1].GetFloat(), param[2].GetFloat());
       }
     }
   }
 
+  // Takes the model from the registry, loading it on first use
+  void loadModel()
+  {
+    if (mModel) {
+      return;
+    }
+    std::string localDir, localModelFile, modelPath;
+    getModelPaths(mUseCCDB ? mCCDBPath : mLocalPath, localDir, localModelFile, modelPath, mPid, "");
+    const std::string key = mUseCCDB ? "ccdb:" + modelPath + "@" + std::to_string(mTimestamp) : "local:" + modelPath;
+    mModel = PidONNXModelRegistry::instance().get(key, [this](PidONNXSharedModel& model, Ort::Env& env) {
+      std::string modelFile;
+      loadInputFiles(model, mLocalPath, mCCDBPath, mUseCCDB, *mCCDBApi, mTimestamp, mPid, modelFile);
+
+      Ort::SessionOptions sessionOptions;
+      LOG(info) << "Loading ONNX model from file: " << modelFile;
+      model.mSession.reset(new Ort::Experimental::Session{env, modelFile, sessionOptions});
+      LOG(info) << "ONNX model loaded";
+
+      model.mInputNames = model.mSession->GetInputNames();
+      model.mInputShapes = model.mSession->GetInputShapes();
+      model.mOutputNames = model.mSession->GetOutputNames();
+      model.mOutputShapes = model.mSession->GetOutputShapes();
+
+      LOG(debug) << "Input Node Name/Shape (" << model.mInputNames.size() << "):";
+      for (size_t i = 0; i < model.mInputNames.size(); i++) {
+        LOG(debug) << "\t" << model.mInputNames[i] << " : " << printShape(model.mInputShapes[i]);
+      }
+
+      LOG(debug) << "Output Node Name/Shape (" << model.mOutputNames.size() << "):";
+      for (size_t i = 0; i < model.mOutputNames.size(); i++) {
+        LOG(debug) << "\t" << model.mOutputNames[i] << " : " << printShape(model.mOutputShapes[i]);
+      }
+
+      // Assume model has 1 input node and 1 output node.
+      assert(model.mInputNames.size() == 1 && model.mOutputNames.size() == 1);
+    });
+  }
+
+  // Appends the scaled inputs of one track to inputValues
   template <typename T>
-  std::vector<float> createInputsSingle(const T& track)
+  void createInputsSingle(const T& track, std::vector<float>& inputValues)
   {
     // TODO: Hardcoded for now. Planning to implement RowView extension to get runtime access to selected columns
     // sign is short, trackType and tpcNClsShared uint8_t
-    float scaledX = (track.x() - mScalingParams.at("fX").first) / mScalingParams.at("fX").second;
-    float scaledY = (track.y() - mScalingParams.at("fY").first) / mScalingParams.at("fY").second;
-    float scaledZ = (track.z() - mScalingParams.at("fZ").first) / mScalingParams.at("fZ").second;
-    float scaledAlpha = (track.alpha() - mScalingParams.at("fAlpha").first) / mScalingParams.at("fAlpha").second;
-    float scaledTPCNClsShared = (static_cast<float>(track.tpcNClsShared()) - mScalingParams.at("fTPCNClsShared").first) / mScalingParams.at("fTPCNClsShared").second;
-    float scaledDcaXY = (track.dcaXY() - mScalingParams.at("fDcaXY").first) / mScalingParams.at("fDcaXY").second;
-    float scaledDcaZ = (track.dcaZ() - mScalingParams.at("fDcaZ").first) / mScalingParams.at("fDcaZ").second;
+    const auto& scalingParams = mModel->mScalingParams;
+    float scaledX = (track.x() - scalingParams.at("fX").first) / scalingParams.at("fX").second;
+    float scaledY = (track.y() - scalingParams.at("fY").first) / scalingParams.at("fY").second;
+    float scaledZ = (track.z() - scalingParams.at("fZ").first) / scalingParams.at("fZ").second;
+    float scaledAlpha = (track.alpha() - scalingParams.at("fAlpha").first) / scalingParams.at("fAlpha").second;
+    float scaledTPCNClsShared = (static_cast<float>(track.tpcNClsShared()) - scalingParams.at("fTPCNClsShared").first) / scalingParams.at("fTPCNClsShared").second;
+    float scaledDcaXY = (track.dcaXY() - scalingParams.at("fDcaXY").first) / scalingParams.at("fDcaXY").second;
+    float scaledDcaZ = (track.dcaZ() - scalingParams.at("fDcaZ").first) / scalingParams.at("fDcaZ").second;
 
-    float scaledTPCSignal = (track.tpcSignal() - mScalingParams.at("fTPCSignal").first) / mScalingParams.at("fTPCSignal").second;
+    float scaledTPCSignal = (track.tpcSignal() - scalingParams.at("fTPCSignal").first) / scalingParams.at("fTPCSignal").second;
 
-    std::vector<float> inputValues{track.px(), track.py(), track.pz(), static_cast<float>(track.sign()), scaledX, scaledY, scaledZ, scaledAlpha, static_cast<float>(track.trackType()), scaledTPCNClsShared, scaledDcaXY, scaledDcaZ, track.p(), scaledTPCSignal};
+    inputValues.insert(inputValues.end(), {track.px(), track.py(), track.pz(), static_cast<float>(track.sign()), scaledX, scaledY, scaledZ, scaledAlpha, static_cast<float>(track.trackType()), scaledTPCNClsShared, scaledDcaXY, scaledDcaZ, track.p(), scaledTPCSignal});
 
     if (mDetector >= kTPCTOF) {
-      float scaledTOFSignal = (track.tofSignal() - mScalingParams.at("fTOFSignal").first) / mScalingParams.at("fTOFSignal").second;
-      float scaledBeta = (track.beta() - mScalingParams.at("fBeta").first) / mScalingParams.at("fBeta").second;
+      float scaledTOFSignal = (track.tofSignal() - scalingParams.at("fTOFSignal").first) / scalingParams.at("fTOFSignal").second;
+      float scaledBeta = (track.beta() - scalingParams.at("fBeta").first) / scalingParams.at("fBeta").second;
       inputValues.push_back(scaledTOFSignal);
       inputValues.push_back(scaledBeta);
     }
 
     if (mDetector >= kTPCTOFTRD) {
-      float scaledTRDSignal = (track.trdSignal() - mScalingParams.at("fTRDSignal").first) / mScalingParams.at("fTRDSignal").second;
-      float scaledTRDPattern = (track.trdPattern() - mScalingParams.at("fTRDPattern").first) / mScalingParams.at("fTRDPattern").second;
+      float scaledTRDSignal = (track.trdSignal() - scalingParams.at("fTRDSignal").first) / scalingParams.at("fTRDSignal").second;
+      float scaledTRDPattern = (track.trdPattern() - scalingParams.at("fTRDPattern").first) / scalingParams.at("fTRDPattern").second;
       inputValues.push_back(scaledTRDSignal);
       inputValues.push_back(scaledTRDPattern);
     }
-
-    return inputValues;
   }
 
   // FIXME: Temporary solution, new networks will have sigmoid layer added
@@ -223,8 +327,13 @@ struct PidONNXModel {
   template <typename T>
   float getModelOutput(const T& track)
   {
-    auto input_shape = mInputShapes[0];
-    std::vector<float> inputTensorValues = createInputsSingle(track);
+    loadModel();
+    auto input_shape = mModel->mInputShapes[0];
+    if (input_shape[0] == -1) { // Dynamic batch size, evaluating a single track
+      input_shape[0] = 1;
+    }
+    std::vector<float> inputTensorValues;
+    createInputsSingle(track, inputTensorValues);
     std::vector<Ort::Value> inputTensors;
     inputTensors.emplace_back(Ort::Experimental::Value::CreateTensor<float>(inputTensorValues.data(), inputTensorValues.size(), input_shape));
 
@@ -234,11 +343,11 @@ struct PidONNXModel {
     LOG(debug) << "input tensor shape: " << printShape(inputTensors[0].GetTensorTypeAndShapeInfo().GetShape());
 
     try {
-      auto outputTensors = mSession->Run(mInputNames, inputTensors, mOutputNames);
+      auto outputTensors = mModel->mSession->Run(mModel->mInputNames, inputTensors, mModel->mOutputNames);
 
       // Double-check the dimensions of the output tensors
       // The number of output tensors is equal to the number of output nodes specified in the Run() call
-      assert(outputTensors.size() == mOutputNames.size() && outputTensors[0].IsTensor());
+      assert(outputTensors.size() == mModel->mOutputNames.size() && outputTensors[0].IsTensor());
       LOG(debug) << "output tensor shape: " << printShape(outputTensors[0].GetTensorTypeAndShapeInfo().GetShape());
 
       const float* output_value = outputTensors[0].GetTensorData<float>();
@@ -260,17 +369,14 @@ struct PidONNXModel {
     return ss.str();
   }
 
-  std::vector<std::string> mTrainColumns;
-  std::map<std::string, std::pair<float, float>> mScalingParams;
+  // Model configuration, the model is loaded on first use
+  std::string mLocalPath;
+  std::string mCCDBPath;
+  bool mUseCCDB = false;
+  o2::ccdb::CcdbApi* mCCDBApi = nullptr;
+  uint64_t mTimestamp = 0;
 
-  std::shared_ptr<Ort::Env> mEnv = nullptr;
-  // No empty constructors for Session, we need a pointer
-  std::shared_ptr<Ort::Experimental::Session> mSession = nullptr;
-
-  std::vector<std::string> mInputNames;
-  std::vector<std::vector<int64_t>> mInputShapes;
-  std::vector<std::string> mOutputNames;
-  std::vector<std::vector<int64_t>> mOutputShapes;
+  std::shared_ptr<PidONNXSharedModel> mModel = nullptr;
 };
 
 #endif // TOOLS_PIDML_PIDONNXMODEL_H_
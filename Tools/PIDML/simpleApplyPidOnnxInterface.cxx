@@ -56,6 +56,7 @@ struct SimpleApplyOnnxInterface {
 
   o2::ccdb::CcdbApi ccdbApi;
   int currentRunNumber = -1;
+  std::vector<std::vector<float>> certainties; // Model outputs per pid and per track
 
   Produces<o2::aod::MlPidResults> pidMLResults;
 
@@ -74,35 +75,39 @@ struct SimpleApplyOnnxInterface {
     }
   }
 
+  // Evaluates all the models in one pass over the tracks and fills the results
+  void fillResults(BigTracks const& tracks)
+  {
+    pidInterface.applyModelsBatch(tracks, certainties);
+    int64_t position = 0;
+    for (auto& track : tracks) {
+      for (std::size_t i = 0; i < cfgPids.value.size(); i++) {
+        const int pid = cfgPids.value[i];
+        bool accepted = certainties[i][position] >= pidInterface.getMinCertainty(i);
+        LOGF(info, "collision id: %d track id: %d pid: %d accepted: %d p: %.3f; x: %.3f, y: %.3f, z: %.3f",
+             track.collisionId(), track.index(), pid, accepted, track.p(), track.x(), track.y(), track.z());
+        pidMLResults(track.index(), pid, accepted);
+      }
+      position++;
+    }
+  }
+
   void processCollisions(aod::Collisions const& collisions, BigTracks const& tracks, aod::BCsWithTimestamps const&)
   {
     auto bc = collisions.iteratorAt(0).bc_as<aod::BCsWithTimestamps>();
     if (cfgUseCCDB && bc.runNumber() != currentRunNumber) {
       uint64_t timestamp = cfgUseFixedTimestamp ? cfgTimestamp.value : bc.timestamp();
       pidInterface = PidONNXInterface(cfgPathLocal.value, cfgPathCCDB.value, cfgUseCCDB.value, ccdbApi, timestamp, cfgPids.value, cfgPTCuts.value, cfgCertainties.value, cfgAutoMode.value);
+      currentRunNumber = bc.runNumber();
     }
 
-    for (auto& track : tracks) {
-      for (int pid : cfgPids.value) {
-        bool accepted = pidInterface.applyModelBoolean(track, pid);
-        LOGF(info, "collision id: %d track id: %d pid: %d accepted: %d p: %.3f; x: %.3f, y: %.3f, z: %.3f",
-             track.collisionId(), track.index(), pid, accepted, track.p(), track.x(), track.y(), track.z());
-        pidMLResults(track.index(), pid, accepted);
-      }
-    }
+    fillResults(tracks);
   }
   PROCESS_SWITCH(SimpleApplyOnnxInterface, processCollisions, "Process with collisions and bcs for CCDB", true);
 
   void processTracksOnly(BigTracks const& tracks)
   {
-    for (auto& track : tracks) {
-      for (int pid : cfgPids.value) {
-        bool accepted = pidInterface.applyModelBoolean(track, pid);
-        LOGF(info, "collision id: %d track id: %d pid: %d accepted: %d p: %.3f; x: %.3f, y: %.3f, z: %.3f",
-             track.collisionId(), track.index(), pid, accepted, track.p(), track.x(), track.y(), track.z());
-        pidMLResults(track.index(), pid, accepted);
-      }
-    }
+    fillResults(tracks);
   }
   PROCESS_SWITCH(SimpleApplyOnnxInterface, processTracksOnly, "Process with tracks only -- faster but no CCDB", false);
 };
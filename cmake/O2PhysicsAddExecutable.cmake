@@ -89,7 +89,7 @@ function(o2physics_add_executable baseTargetName)
   if(A_IS_TEST)
     set(isTest "IS_TEST")
   endif()
-  if(A_IS_BENCH)
+  if(A_IS_BENCHMARK)
     set(isBench "IS_BENCH")
   endif()
 
@@ -18,4 +18,6 @@ function(o2physics_define_options)
   option(ENABLE_CASSERT "Enable asserts" OFF)
 
   option(ENABLE_UPGRADES "Enable detectors for upgrades" OFF)
+
+  option(ENABLE_PROCESS_TIMING "Enable the timing histograms of the process functions (Common/Core/ProcessTimer.h)" OFF)
 endfunction()
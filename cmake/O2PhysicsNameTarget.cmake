@@ -43,7 +43,7 @@ function(o2physics_name_target baseTargetName)
   # get the target "type" (lib or exe,test,bench)
   if(A_IS_TEST)
     set(targetType test)
-  elseif(A_IS_BENCHMARK)
+  elseif(A_IS_BENCH)
     set(targetType bench)
   elseif(A_IS_EXE)
     set(targetType exe)
@@ -17,6 +17,10 @@ IF (ENABLE_TIMETRACE)
 set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -ftime-trace")
 ENDIF()
 
+IF (ENABLE_PROCESS_TIMING)
+set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -DO2PHYSICS_PROCESS_TIMING")
+ENDIF()
+
 set(CMAKE_CXX_FLAGS_COVERAGE "-g -O2 -fprofile-arcs -ftest-coverage")
 set(CMAKE_C_FLAGS_COVERAGE "${CMAKE_CXX_FLAGS_COVERAGE}")
 set(CMAKE_Fortran_FLAGS_COVERAGE "-g -O2 -fprofile-arcs -ftest-coverage")